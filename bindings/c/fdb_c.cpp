@@ -296,6 +296,47 @@ fdb_error_t fdb_future_get_keyvalue_array_impl(FDBFuture* f,
 	                 *out_more = rrr.more;);
 }
 
+// Copies the pairs of kvs beginning at begin that fit into buffer, as fdb_future_copy_keyvalue_array describes, and
+// returns how many were copied
+static int copyKeyValues(RangeResultRef const& kvs, int begin, uint8_t* buffer, int bufferLength) {
+	if (begin < 0 || begin > kvs.size() || bufferLength < 0 ||
+	    reinterpret_cast<uintptr_t>(buffer) % alignof(FDBKeyValue) != 0) {
+		throw client_invalid_operation();
+	}
+
+	int count = 0;
+	int64_t bytes = 0;
+	for (int i = begin; i < kvs.size(); ++i) {
+		int64_t next = bytes + sizeof(FDBKeyValue) + kvs[i].key.size() + kvs[i].value.size();
+		if (next > bufferLength) {
+			break;
+		}
+		bytes = next;
+		++count;
+	}
+
+	FDBKeyValue* out = reinterpret_cast<FDBKeyValue*>(buffer);
+	uint8_t* data = buffer + count * sizeof(FDBKeyValue);
+	for (int i = 0; i < count; ++i) {
+		const KeyValueRef& kv = kvs[begin + i];
+		memcpy(data, kv.key.begin(), kv.key.size());
+		out[i].key = data;
+		out[i].key_length = kv.key.size();
+		data += kv.key.size();
+		memcpy(data, kv.value.begin(), kv.value.size());
+		out[i].value = data;
+		out[i].value_length = kv.value.size();
+		data += kv.value.size();
+	}
+	return count;
+}
+
+extern "C" DLLEXPORT fdb_error_t
+fdb_future_copy_keyvalue_array(FDBFuture* f, int begin, uint8_t* buffer, int buffer_length, int* out_count) {
+	CATCH_AND_RETURN(Standalone<RangeResultRef> rrr = TSAV(Standalone<RangeResultRef>, f)->get();
+	                 *out_count = copyKeyValues(rrr, begin, buffer, buffer_length););
+}
+
 fdb_error_t fdb_future_get_keyvalue_array_v13(FDBFuture* f, FDBKeyValue const** out_kv, int* out_count) {
 	CATCH_AND_RETURN(Standalone<RangeResultRef> rrr = TSAV(Standalone<RangeResultRef>, f)->get();
 	                 *out_kv = (FDBKeyValue*)rrr.begin();
@@ -1000,7 +1041,7 @@ FDBFuture* validate_and_update_parameters(int& limit,
 
 	/* _ITERATOR mode maps to one of the known streaming modes
 	   depending on iteration */
-	const int mode_bytes_array[] = { GetRangeLimits::BYTE_LIMIT_UNLIMITED, 256, 1000, 4096, 80000 };
+	const int mode_bytes_array[] = { GetRangeLimits::BYTE_LIMIT_UNLIMITED, 256, 1000, 4096, 80000, 640000 };
 
 	/* The progression used for FDB_STREAMING_MODE_ITERATOR.
 	   Goes 1.5 * previous. */
@@ -1019,7 +1060,7 @@ FDBFuture* validate_and_update_parameters(int& limit,
 
 		iteration = std::min(iteration, max_iteration);
 		mode_bytes = iteration_progression[iteration - 1];
-	} else if (mode >= 0 && mode <= FDB_STREAMING_MODE_SERIAL)
+	} else if (mode >= 0 && mode <= FDB_STREAMING_MODE_PARALLEL)
 		mode_bytes = mode_bytes_array[mode];
 	else
 		return TSAV_ERROR(Standalone<RangeResultRef>, client_invalid_operation);
@@ -1050,12 +1091,14 @@ FDBFuture* fdb_transaction_get_range_impl(FDBTransaction* tr,
 	FDBFuture* r = validate_and_update_parameters(limit, target_bytes, mode, iteration, reverse);
 	if (r != nullptr)
 		return r;
+	GetRangeLimits limits(limit, target_bytes);
+	limits.parallel = mode == FDB_STREAMING_MODE_PARALLEL;
 	return (
 	    FDBFuture*)(TXN(tr)
 	                    ->getRange(
 	                        KeySelectorRef(KeyRef(begin_key_name, begin_key_name_length), begin_or_equal, begin_offset),
 	                        KeySelectorRef(KeyRef(end_key_name, end_key_name_length), end_or_equal, end_offset),
-	                        GetRangeLimits(limit, target_bytes),
+	                        limits,
 	                        snapshot,
 	                        reverse)
 	                    .extractPtr());
@@ -1164,6 +1207,43 @@ extern "C" DLLEXPORT void fdb_transaction_clear_range(FDBTransaction* tr,
 	    TXN(tr)->clear(KeyRef(begin_key_name, begin_key_name_length), KeyRef(end_key_name, end_key_name_length)););
 }
 
+extern "C" DLLEXPORT FDBFuture* fdb_transaction_batch(FDBTransaction* tr,
+                                                      FDBBatchOperation const* operations,
+                                                      int operation_count,
+                                                      fdb_bool_t snapshot) {
+	Arena arena;
+	VectorRef<MutationRef> mutations;
+	VectorRef<KeyRef> reads;
+	for (int i = 0; i < operation_count; ++i) {
+		const FDBBatchOperation& op = operations[i];
+		KeyRef key(op.key, op.key_length);
+		ValueRef param(op.param, op.param_length);
+		switch (op.type) {
+		case FDB_BATCH_OPERATION_SET:
+			mutations.push_back(arena, MutationRef(MutationRef::SetValue, key, param));
+			break;
+		case FDB_BATCH_OPERATION_CLEAR:
+			mutations.push_back(arena, MutationRef(MutationRef::ClearRange, key, keyAfter(key, arena)));
+			break;
+		case FDB_BATCH_OPERATION_CLEAR_RANGE:
+			mutations.push_back(arena, MutationRef(MutationRef::ClearRange, key, param));
+			break;
+		case FDB_BATCH_OPERATION_ATOMIC_OP:
+			if (!isValidMutationType(op.atomic_type) || !isAtomicOp((MutationRef::Type)op.atomic_type)) {
+				return TSAV_ERROR(Standalone<RangeResultRef>, invalid_mutation_type);
+			}
+			mutations.push_back(arena, MutationRef((MutationRef::Type)op.atomic_type, key, param));
+			break;
+		case FDB_BATCH_OPERATION_GET:
+			reads.push_back(arena, key);
+			break;
+		default:
+			return TSAV_ERROR(Standalone<RangeResultRef>, client_invalid_operation);
+		}
+	}
+	return (FDBFuture*)(TXN(tr)->batch(mutations, reads, snapshot).extractPtr());
+}
+
 extern "C" DLLEXPORT FDBFuture* fdb_transaction_watch(FDBTransaction* tr,
                                                       uint8_t const* key_name,
                                                       int key_name_length) {
@@ -321,6 +321,12 @@ DLLEXPORT WARN_UNUSED_RESULT fdb_error_t fdb_future_get_keyvalue_array(FDBFuture
                                                                        fdb_bool_t* out_more);
 #endif
 
+/* Copies the key-value pairs of a range read result, beginning with the one at
+   index begin, into buffer: as many FDBKeyValue objects as fit, followed by the
+   keys and values they point to. */
+DLLEXPORT WARN_UNUSED_RESULT fdb_error_t
+fdb_future_copy_keyvalue_array(FDBFuture* f, int begin, uint8_t* buffer, int buffer_length, int* out_count);
+
 DLLEXPORT WARN_UNUSED_RESULT fdb_error_t fdb_future_get_mappedkeyvalue_array(FDBFuture* f,
                                                                              FDBMappedKeyValue const** out_kv,
                                                                              int* out_count,
@@ -616,6 +622,31 @@ DLLEXPORT void fdb_transaction_clear_range(FDBTransaction* tr,
                                            uint8_t const* end_key_name,
                                            int end_key_name_length);
 
+typedef enum {
+	FDB_BATCH_OPERATION_SET = 0,
+	FDB_BATCH_OPERATION_CLEAR = 1,
+	FDB_BATCH_OPERATION_CLEAR_RANGE = 2,
+	FDB_BATCH_OPERATION_ATOMIC_OP = 3,
+	FDB_BATCH_OPERATION_GET = 4
+} FDBBatchOperationType;
+
+/* An operation of fdb_transaction_batch(). param is the value of a set, the end
+   key of a clear range or the operand of an atomic operation, and is ignored
+   otherwise. atomic_type is the operation of FDB_BATCH_OPERATION_ATOMIC_OP. */
+typedef struct batchoperation {
+	FDBBatchOperationType type;
+	FDBMutationType atomic_type;
+	const uint8_t* key;
+	int key_length;
+	const uint8_t* param;
+	int param_length;
+} FDBBatchOperation;
+
+DLLEXPORT WARN_UNUSED_RESULT FDBFuture* fdb_transaction_batch(FDBTransaction* tr,
+                                                              FDBBatchOperation const* operations,
+                                                              int operation_count,
+                                                              fdb_bool_t snapshot);
+
 DLLEXPORT WARN_UNUSED_RESULT FDBFuture* fdb_transaction_watch(FDBTransaction* tr,
                                                               uint8_t const* key_name,
                                                               int key_name_length);
@@ -304,16 +304,18 @@ void updateErrorStatsRunMode(WorkflowStatistics& stats, fdb::Error err, int op)
 	}
 }
 
-/* run one iteration of configured transaction */
+/* run one iteration of configured transaction.
+ * if scheduled_start is given, the transaction latency is measured from then instead of from the actual start */
 int runOneTransaction(Transaction& tx,
                       std::optional<std::string> const& token,
                       Arguments const& args,
                       WorkflowStatistics& stats,
                       ByteString& key1,
                       ByteString& key2,
-                      ByteString& val) {
+                      ByteString& val,
+                      std::optional<timepoint_t> scheduled_start = std::nullopt) {
 	const auto do_sample = (stats.getOpCount(OP_TRANSACTION) % args.sampling) == 0;
-	auto watch_tx = Stopwatch(StartAtCtor{});
+	auto watch_tx = scheduled_start ? Stopwatch(scheduled_start.value()) : Stopwatch(StartAtCtor{});
 	auto watch_op = Stopwatch{};
 
 	auto op_iter = getOpBegin(args);
@@ -453,9 +455,27 @@ int runWorkload(Database db,
 
 	std::optional<std::vector<fdb::Tenant>> tenants = args.prepareTenants(db);
 
+	/* in open-loop mode, transactions are started on a fixed-rate schedule regardless of how long the earlier ones
+	 * took, and their latency is measured from the scheduled start. a thread that falls behind runs the late
+	 * transactions back to back, and the time they waited counts towards their latency, so a slow cluster shows up
+	 * in the latency tail instead of only lowering the throughput (coordinated omission). */
+	auto next_start = steady_clock::now();
+
 	/* main transaction loop */
 	while (1) {
-		if ((thread_tps > 0 /* iff throttling on */) && (xacts >= current_tps)) {
+		auto scheduled_start = std::optional<timepoint_t>{};
+		if (args.open_loop) {
+			const auto tps = thread_tps * throttle_factor.load();
+			if (tps > 0) {
+				scheduled_start = next_start;
+				std::this_thread::sleep_until(next_start);
+				next_start += std::chrono::duration_cast<timediff_t>(std::chrono::duration<double>(1.0 / tps));
+			} else {
+				/* nothing is scheduled while the target is zero */
+				usleep(1000);
+				next_start = steady_clock::now();
+			}
+		} else if ((thread_tps > 0 /* iff throttling on */) && (xacts >= current_tps)) {
 			/* throttle on */
 			auto time_now = steady_clock::now();
 			while (toDoubleSeconds(time_now - time_prev) < 1.0) {
@@ -471,7 +491,7 @@ int runWorkload(Database db,
 			current_tps = static_cast<int>(thread_tps * throttle_factor.load());
 		}
 
-		if (current_tps > 0 || thread_tps == 0 /* throttling off */) {
+		if (scheduled_start || (!args.open_loop && (current_tps > 0 || thread_tps == 0 /* throttling off */))) {
 			auto [tx, token] = createNewTransaction(db, args, -1, tenants);
 			setTransactionTimeoutIfEnabled(args, tx);
 
@@ -509,7 +529,7 @@ int runWorkload(Database db,
 				}
 			}
 
-			rc = runOneTransaction(tx, token, args, workflow_stats, key1, key2, val);
+			rc = runOneTransaction(tx, token, args, workflow_stats, key1, key2, val, scheduled_start);
 			if (rc) {
 				logr.warn("runOneTransaction failed ({})", rc);
 			}
@@ -849,6 +869,7 @@ Arguments::Arguments() {
 	tpsmin = -1;
 	tpsinterval = 10;
 	tpschange = TPS_SIN;
+	open_loop = false;
 	sampling = 1000;
 	key_length = 32;
 	value_length = 16;
@@ -1156,7 +1177,15 @@ void usage() {
 	printf("%-24s %s\n", "    --tps|--tpsmax=TPS", "Specify the target max TPS");
 	printf("%-24s %s\n", "    --tpsmin=TPS", "Specify the target min TPS");
 	printf("%-24s %s\n", "    --tpsinterval=SEC", "Specify the TPS change interval (Default: 10 seconds)");
-	printf("%-24s %s\n", "    --tpschange=<sin|square|pulse>", "Specify the TPS change type (Default: sin)");
+	printf("%-24s %s\n",
+	       "    --tpschange=<sin|square|pulse|ramp|step>",
+	       "Specify the TPS change type (Default: sin)");
+	printf("%-24s %s\n",
+	       "    --open_loop",
+	       "Start transactions on a fixed-rate schedule and measure latency from the scheduled start");
+	printf("%-24s %s\n",
+	       "    --slo=OP:PCTILE:US",
+	       "Report whether the PCTILE percentile latency of OP is within US microseconds (repeatable)");
 	printf("%-24s %s\n", "    --sampling=RATE", "Specify the sampling rate for latency stats");
 	printf("%-24s %s\n", "-m, --mode=MODE", "Specify the mode (build, run, clean, report)");
 	printf("%-24s %s\n", "-z, --zipf", "Use zipfian distribution instead of uniform distribution");
@@ -1207,6 +1236,33 @@ void usage() {
 	       "Duration in milliseconds after which a transaction times out in run mode. Set as transaction option");
 }
 
+/* parse a latency objective given as OP:PERCENTILE:LATENCY_US, e.g. TRANSACTION:99.9:50000 */
+int parseSlo(Arguments& args, char const* optarg) {
+	const auto spec = std::string_view(optarg);
+	const auto first = spec.find(':');
+	const auto second = first == std::string_view::npos ? first : spec.find(':', first + 1);
+	if (second == std::string_view::npos) {
+		logr.error("--slo must be OP:PERCENTILE:LATENCY_US, e.g. TRANSACTION:99.9:50000");
+		return -1;
+	}
+	auto slo = LatencySlo{ -1, atof(optarg + first + 1), strtoull(optarg + second + 1, nullptr, 10) };
+	for (auto op = 0; op < MAX_OP; op++) {
+		if (spec.substr(0, first) == opTable[op].name()) {
+			slo.op = op;
+		}
+	}
+	if (slo.op < 0) {
+		logr.error("--slo: unknown operation '{}'", spec.substr(0, first));
+		return -1;
+	}
+	if (slo.percentile <= 0 || slo.percentile >= 100 || slo.latency_us == 0) {
+		logr.error("--slo: percentile must be between 0 and 100, and latency must be positive");
+		return -1;
+	}
+	args.slos.push_back(slo);
+	return 0;
+}
+
 /* parse benchmark parameters */
 int parseArguments(int argc, char* argv[], Arguments& args) {
 	int rc;
@@ -1238,6 +1294,7 @@ int parseArguments(int argc, char* argv[], Arguments& args) {
 			{ "tpsmin", required_argument, NULL, ARG_TPSMIN },
 			{ "tpsinterval", required_argument, NULL, ARG_TPSINTERVAL },
 			{ "tpschange", required_argument, NULL, ARG_TPSCHANGE },
+			{ "slo", required_argument, NULL, ARG_SLO },
 			{ "sampling", required_argument, NULL, ARG_SAMPLING },
 			{ "verbose", required_argument, NULL, 'v' },
 			{ "mode", required_argument, NULL, 'm' },
@@ -1272,6 +1329,7 @@ int parseArguments(int argc, char* argv[], Arguments& args) {
 			{ "version", no_argument, NULL, ARG_VERSION },
 			{ "disable_client_bypass", no_argument, NULL, ARG_DISABLE_CLIENT_BYPASS },
 			{ "disable_ryw", no_argument, NULL, ARG_DISABLE_RYW },
+			{ "open_loop", no_argument, NULL, ARG_OPEN_LOOP },
 			{ "enable_token_based_authorization", no_argument, NULL, ARG_ENABLE_TOKEN_BASED_AUTHORIZATION },
 			{ NULL, 0, NULL, 0 }
 		};
@@ -1398,11 +1456,22 @@ int parseArguments(int argc, char* argv[], Arguments& args) {
 				args.tpschange = TPS_SQUARE;
 			else if (strcmp(optarg, "pulse") == 0)
 				args.tpschange = TPS_PULSE;
+			else if (strcmp(optarg, "ramp") == 0)
+				args.tpschange = TPS_RAMP;
+			else if (strcmp(optarg, "step") == 0)
+				args.tpschange = TPS_STEP;
 			else {
-				logr.error("--tpschange must be sin, square or pulse");
+				logr.error("--tpschange must be sin, square, pulse, ramp or step");
 				return -1;
 			}
 			break;
+		case ARG_OPEN_LOOP:
+			args.open_loop = true;
+			break;
+		case ARG_SLO:
+			if (parseSlo(args, optarg) < 0)
+				return -1;
+			break;
 		case ARG_SAMPLING:
 			args.sampling = atoi(optarg);
 			break;
@@ -1656,6 +1725,16 @@ int Arguments::validate() {
 		return -1;
 	}
 
+	if (tpschange == TPS_STEP && tpsmax > 0 && tpsmin == 0) {
+		logr.error("--tpschange step raises TPS by --tpsmin, which must be positive");
+		return -1;
+	}
+
+	if (open_loop && (mode != MODE_RUN || tpsmax <= 0 || async_xacts > 0)) {
+		logr.error("--open_loop requires run mode, --tpsmax|--tps and --async_xacts 0");
+		return -1;
+	}
+
 	if (mode == MODE_RUN || mode == MODE_BUILD) {
 		if (tpsmax > 0) {
 			if (async_xacts > 0) {
@@ -2074,7 +2153,42 @@ void printWorkerStats(WorkflowStatistics& final_stats, Arguments args, FILE* fp,
 	}
 	fmt::print("\n");
 	if (fp) {
-		fmt::fprintf(fp, "}}");
+		fmt::fprintf(fp, "}");
+	}
+}
+
+/* report whether each latency objective given with --slo was met */
+void printSloReport(WorkflowStatistics& final_stats, Arguments const& args, FILE* fp) {
+	if (fp) {
+		fmt::fprintf(fp, ", \"slo\": [");
+	}
+	if (!args.slos.empty()) {
+		fmt::printf("\n%-24s %12s %12s %8s\n", "SLO", "Target (us)", "Actual (us)", "Result");
+	}
+	for (size_t i = 0; i < args.slos.size(); i++) {
+		const auto& slo = args.slos[i];
+		const auto title = fmt::format("{} p{}", getOpName(slo.op), slo.percentile);
+		/* latency is only known if the op ran and was sampled */
+		const auto actual = final_stats.getLatencySampleCount(slo.op) > 0
+		                        ? std::optional<uint64_t>(final_stats.percentile(slo.op, slo.percentile / 100))
+		                        : std::nullopt;
+		const auto result = !actual ? "N/A" : actual.value() <= slo.latency_us ? "PASS" : "FAIL";
+		const auto actual_str = actual ? std::to_string(actual.value()) : std::string("N/A");
+		fmt::printf("%-24s %12lu %12s %8s\n", title, slo.latency_us, actual_str, result);
+		if (fp) {
+			fmt::fprintf(fp,
+			             "%s{\"op\": \"%s\", \"percentile\": %g, \"targetUs\": %lu, \"actualUs\": %s, "
+			             "\"result\": \"%s\"}",
+			             i == 0 ? "" : ",",
+			             getOpName(slo.op),
+			             slo.percentile,
+			             slo.latency_us,
+			             actual ? actual_str : std::string("null"),
+			             result);
+		}
+	}
+	if (fp) {
+		fmt::fprintf(fp, "]");
 	}
 }
 
@@ -2180,8 +2294,16 @@ void printReport(Arguments const& args,
 		case TPS_PULSE:
 			fmt::printf("%8s\n", "PULSE");
 			break;
+		case TPS_RAMP:
+			fmt::printf("%8s\n", "RAMP");
+			break;
+		case TPS_STEP:
+			fmt::printf("%8s\n", "STEP");
+			break;
 		}
 	}
+	if (args.open_loop)
+		fmt::printf("Open Loop:         %8s\n", "YES");
 	const auto tps_f = final_worker_stats.getOpCount(OP_TRANSACTION) / duration_sec;
 	const auto tps_i = static_cast<uint64_t>(tps_f);
 
@@ -2310,6 +2432,10 @@ void printReport(Arguments const& args,
 	final_worker_stats.updateLatencies(data_points);
 
 	printWorkerStats(final_worker_stats, args, fp);
+	printSloReport(final_worker_stats, args, fp);
+	if (fp) {
+		fmt::fprintf(fp, "}");
+	}
 
 	// export the ddsketch if the flag was set
 	if (args.stats_export_path[0] != 0) {
@@ -2360,6 +2486,7 @@ int statsProcessMain(Arguments const& args,
 		fmt::fprintf(fp, "\"tpsmin\": %d,", args.tpsmin);
 		fmt::fprintf(fp, "\"tpsinterval\": %d,", args.tpsinterval);
 		fmt::fprintf(fp, "\"tpschange\": %d,", args.tpschange);
+		fmt::fprintf(fp, "\"open_loop\": %d,", args.open_loop);
 		fmt::fprintf(fp, "\"sampling\": %d,", args.sampling);
 		fmt::fprintf(fp, "\"key_length\": %d,", args.key_length);
 		fmt::fprintf(fp, "\"value_length\": %d,", args.value_length);
@@ -2400,7 +2527,8 @@ int statsProcessMain(Arguments const& args,
 				const auto tpsinterval = static_cast<double>(args.tpsinterval);
 				const auto tpsmin = static_cast<double>(args.tpsmin);
 				const auto tpsmax = static_cast<double>(args.tpsmax);
-				const auto pos = fmod(toDoubleSeconds(time_now - time_start), tpsinterval);
+				const auto elapsed = toDoubleSeconds(time_now - time_start);
+				const auto pos = fmod(elapsed, tpsinterval);
 				auto sin_factor = 0.;
 				/* set the throttle factor between 0.0 and 1.0 */
 				switch (args.tpschange) {
@@ -2426,6 +2554,14 @@ int statsProcessMain(Arguments const& args,
 						throttle_factor = tpsmin / tpsmax;
 					}
 					break;
+				case TPS_RAMP:
+					/* rise linearly from min to max over the first interval, then stay at max */
+					throttle_factor = std::min(1.0, (tpsmin + (tpsmax - tpsmin) * elapsed / tpsinterval) / tpsmax);
+					break;
+				case TPS_STEP:
+					/* start at min and go up by min every interval, up to max */
+					throttle_factor = std::min(1.0, tpsmin * (1 + floor(elapsed / tpsinterval)) / tpsmax);
+					break;
 				}
 			}
 
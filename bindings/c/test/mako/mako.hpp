@@ -91,6 +91,8 @@ enum ArgKind {
 	ARG_ENABLE_TOKEN_BASED_AUTHORIZATION,
 	ARG_TRANSACTION_TIMEOUT_TX,
 	ARG_TRANSACTION_TIMEOUT_DB,
+	ARG_OPEN_LOOP,
+	ARG_SLO,
 };
 
 constexpr const int OP_COUNT = 0;
@@ -118,7 +120,14 @@ enum OpKind {
 	MAX_OP /* must be the last item */
 };
 
-enum TPSChangeTypes { TPS_SIN, TPS_SQUARE, TPS_PULSE };
+enum TPSChangeTypes { TPS_SIN, TPS_SQUARE, TPS_PULSE, TPS_RAMP, TPS_STEP };
+
+/* latency objective reported at the end of a run: the given percentile of op latency must not exceed latency_us */
+struct LatencySlo {
+	int op;
+	double percentile;
+	uint64_t latency_us;
+};
 
 enum DistributedTracerClient { DISABLED, NETWORK_LOSSY, LOG_FILE };
 
@@ -169,6 +178,8 @@ struct Arguments {
 	int tpsmin;
 	int tpsinterval;
 	int tpschange;
+	bool open_loop;
+	std::vector<LatencySlo> slos;
 	int sampling;
 	int key_length;
 	int value_length;
@@ -102,6 +102,10 @@ void Future::cancel() {
 	return fdb_future_get_keyvalue_array(future_, out_kv, out_count, out_more);
 }
 
+[[nodiscard]] fdb_error_t KeyValueArrayFuture::copy(int begin, uint8_t* buffer, int buffer_length, int* out_count) {
+	return fdb_future_copy_keyvalue_array(future_, begin, buffer, buffer_length, out_count);
+}
+
 // MappedKeyValueArrayFuture
 
 [[nodiscard]] fdb_error_t MappedKeyValueArrayFuture::get(const FDBMappedKeyValue** out_kv,
@@ -363,6 +367,10 @@ void Transaction::atomic_op(std::string_view key,
 	return fdb_transaction_atomic_op(tr_, (const uint8_t*)key.data(), key.size(), param, param_length, operationType);
 }
 
+KeyValueArrayFuture Transaction::batch(const FDBBatchOperation* operations, int operation_count, fdb_bool_t snapshot) {
+	return KeyValueArrayFuture(fdb_transaction_batch(tr_, operations, operation_count, snapshot));
+}
+
 [[nodiscard]] fdb_error_t Transaction::get_committed_version(int64_t* out_version) {
 	return fdb_transaction_get_committed_version(tr_, out_version);
 }
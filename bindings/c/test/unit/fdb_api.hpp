@@ -144,6 +144,9 @@ public:
 	// fdb_future_get_keyvalue_array.
 	fdb_error_t get(const FDBKeyValue** out_kv, int* out_count, fdb_bool_t* out_more);
 
+	// Wrapper around fdb_future_copy_keyvalue_array.
+	fdb_error_t copy(int begin, uint8_t* buffer, int buffer_length, int* out_count);
+
 private:
 	friend class Transaction;
 	KeyValueArrayFuture(FDBFuture* f) : Future(f) {}
@@ -371,6 +374,10 @@ public:
 	// Wrapper around fdb_transaction_atomic_op.
 	void atomic_op(std::string_view key, const uint8_t* param, int param_length, FDBMutationType operationType);
 
+	// Wrapper around fdb_transaction_batch. Returns a future which will be set
+	// to an FDBKeyValue array of the keys read that have values.
+	KeyValueArrayFuture batch(const FDBBatchOperation* operations, int operation_count, fdb_bool_t snapshot);
+
 	// Wrapper around fdb_transaction_get_committed_version.
 	fdb_error_t get_committed_version(int64_t* out_version);
 
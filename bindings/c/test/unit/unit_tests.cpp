@@ -592,6 +592,55 @@ TEST_CASE("fdb_future_get_keyvalue_array") {
 	}
 }
 
+TEST_CASE("fdb_future_copy_keyvalue_array") {
+	insert_data(db, create_data({ { "a", "1" }, { "b", "2" }, { "c", "3" } }));
+
+	fdb::Transaction tr(db);
+	while (1) {
+		fdb::KeyValueArrayFuture f1 =
+		    tr.get_range(FDB_KEYSEL_FIRST_GREATER_OR_EQUAL((const uint8_t*)key("a").c_str(), key("a").size()),
+		                 FDB_KEYSEL_FIRST_GREATER_OR_EQUAL((const uint8_t*)key("d").c_str(), key("d").size()),
+		                 /* limit */ 0,
+		                 /* target_bytes */ 0,
+		                 /* FDBStreamingMode */ FDB_STREAMING_MODE_WANT_ALL,
+		                 /* iteration */ 0,
+		                 /* snapshot */ false,
+		                 /* reverse */ 0);
+
+		fdb_error_t err = wait_future(f1);
+		if (err) {
+			fdb::EmptyFuture f2 = tr.on_error(err);
+			fdb_check(wait_future(f2));
+			continue;
+		}
+
+		FDBKeyValue const* out_kv;
+		int out_count;
+		fdb_bool_t out_more;
+		fdb_check(f1.get(&out_kv, &out_count, &out_more));
+		CHECK(out_count > 0);
+
+		// All of the pairs are the same size, and a buffer with room for one copies them one at a time
+		int pairBytes = sizeof(FDBKeyValue) + key("a").size() + 1;
+		std::vector<FDBKeyValue> buffer(pairBytes / sizeof(FDBKeyValue) + 1);
+		uint8_t* bytes = (uint8_t*)buffer.data();
+		int copied;
+		for (int i = 0; i < out_count; ++i) {
+			fdb_check(f1.copy(i, bytes, pairBytes, &copied));
+			REQUIRE(copied == 1);
+			CHECK(std::string((const char*)buffer[0].key, buffer[0].key_length) ==
+			      std::string((const char*)out_kv[i].key, out_kv[i].key_length));
+			CHECK(std::string((const char*)buffer[0].value, buffer[0].value_length) ==
+			      std::string((const char*)out_kv[i].value, out_kv[i].value_length));
+		}
+		fdb_check(f1.copy(out_count, bytes, pairBytes, &copied));
+		CHECK(copied == 0);
+		fdb_check(f1.copy(0, bytes, pairBytes - 1, &copied));
+		CHECK(copied == 0);
+		break;
+	}
+}
+
 TEST_CASE("cannot read system key") {
 	fdb::Transaction tr(db);
 
@@ -1311,6 +1360,66 @@ TEST_CASE("fdb_transaction_clear") {
 	REQUIRE(!value.has_value());
 }
 
+TEST_CASE("fdb_transaction_batch") {
+	insert_data(db, create_data({ { "a", "1" }, { "b", "2" }, { "c", "3" } }));
+
+	std::string a = key("a");
+	std::string b = key("b");
+	std::string c = key("c");
+	std::string d = key("d");
+	int8_t one = 1;
+	auto op = [](FDBBatchOperationType type, const std::string& k, const uint8_t* param, int paramLength) {
+		return FDBBatchOperation{
+			type, FDB_MUTATION_TYPE_ADD, (const uint8_t*)k.data(), (int)k.size(), param, paramLength
+		};
+	};
+	const FDBBatchOperation operations[] = {
+		op(FDB_BATCH_OPERATION_CLEAR, a, nullptr, 0),
+		op(FDB_BATCH_OPERATION_SET, d, (const uint8_t*)"4", 1),
+		op(FDB_BATCH_OPERATION_ATOMIC_OP, b, (const uint8_t*)&one, sizeof(one)),
+		op(FDB_BATCH_OPERATION_CLEAR_RANGE, c, (const uint8_t*)d.data(), (int)d.size()),
+		op(FDB_BATCH_OPERATION_GET, a, nullptr, 0),
+		op(FDB_BATCH_OPERATION_GET, b, nullptr, 0),
+		op(FDB_BATCH_OPERATION_GET, c, nullptr, 0),
+		op(FDB_BATCH_OPERATION_GET, d, nullptr, 0),
+	};
+
+	fdb::Transaction tr(db);
+	while (1) {
+		fdb::KeyValueArrayFuture f1 = tr.batch(operations, sizeof(operations) / sizeof(operations[0]), false);
+		fdb_error_t err = wait_future(f1);
+		if (err) {
+			fdb::EmptyFuture fOnError = tr.on_error(err);
+			fdb_check(wait_future(fOnError));
+			continue;
+		}
+
+		// The reads see the mutations of the batch, and keys without values aren't returned
+		const FDBKeyValue* out_kv;
+		int out_count;
+		fdb_bool_t out_more;
+		fdb_check(f1.get(&out_kv, &out_count, &out_more));
+		REQUIRE(out_count == 2);
+		CHECK(std::string((const char*)out_kv[0].key, out_kv[0].key_length) == b);
+		CHECK(std::string((const char*)out_kv[0].value, out_kv[0].value_length) == "3");
+		CHECK(std::string((const char*)out_kv[1].key, out_kv[1].key_length) == d);
+		CHECK(std::string((const char*)out_kv[1].value, out_kv[1].value_length) == "4");
+
+		fdb::EmptyFuture f2 = tr.commit();
+		err = wait_future(f2);
+		if (err) {
+			fdb::EmptyFuture fOnError = tr.on_error(err);
+			fdb_check(wait_future(fOnError));
+			continue;
+		}
+		break;
+	}
+
+	CHECK(!get_value(a, /* snapshot */ false, {}).has_value());
+	CHECK(!get_value(c, /* snapshot */ false, {}).has_value());
+	CHECK(get_value(d, /* snapshot */ false, {}) == "4");
+}
+
 TEST_CASE("fdb_transaction_atomic_op FDB_MUTATION_TYPE_ADD") {
 	insert_data(db, create_data({ { "foo", "\x00" } }));
 
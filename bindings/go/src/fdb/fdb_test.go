@@ -23,6 +23,7 @@
 package fdb_test
 
 import (
+	"bytes"
 	"fmt"
 	"os"
 	"testing"
@@ -294,6 +295,48 @@ func ExampleRangeIterator() {
 	// cherry is baz
 }
 
+func TestGetMany(t *testing.T) {
+	fdb.MustAPIVersion(API_VERSION)
+	db := fdb.MustOpenDefault()
+
+	kvs := []fdb.KeyValue{
+		{Key: fdb.Key("getMany/a"), Value: []byte("1")},
+		{Key: fdb.Key("getMany/b"), Value: []byte{}},
+		{Key: fdb.Key("getMany/c"), Value: []byte("3")},
+	}
+	_, e := db.Transact(func(tr fdb.Transaction) (interface{}, error) {
+		tr.ClearRange(fdb.KeyRange{Begin: fdb.Key("getMany/"), End: fdb.Key("getMany0")})
+		tr.SetMany(kvs)
+		return nil, nil
+	})
+	if e != nil {
+		t.Fatalf("SetMany failed: %v", e)
+	}
+
+	keys := []fdb.KeyConvertible{kvs[2].Key, fdb.Key("getMany/missing"), kvs[0].Key, kvs[1].Key}
+	expected := [][]byte{kvs[2].Value, nil, kvs[0].Value, kvs[1].Value}
+	for _, snapshot := range []bool{false, true} {
+		ret, e := db.Transact(func(tr fdb.Transaction) (interface{}, error) {
+			if snapshot {
+				return tr.Snapshot().GetMany(keys)
+			}
+			return tr.GetMany(keys)
+		})
+		if e != nil {
+			t.Fatalf("GetMany failed: %v", e)
+		}
+		values := ret.([][]byte)
+		if len(values) != len(expected) {
+			t.Fatalf("Expected %d values, got %d", len(expected), len(values))
+		}
+		for i := range expected {
+			if !bytes.Equal(values[i], expected[i]) || (values[i] == nil) != (expected[i] == nil) {
+				t.Errorf("Expected %q for %v, got %q", expected[i], keys[i], values[i])
+			}
+		}
+	}
+}
+
 func TestKeyToString(t *testing.T) {
 	cases := []struct {
 		key    fdb.Key
@@ -25,6 +25,7 @@ package fdb
 //  #cgo LDFLAGS: -lfdb_c -lm
 //  #define FDB_API_VERSION 740
 //  #include <foundationdb/fdb_c.h>
+//  #include <stdlib.h>
 //  #include <string.h>
 //
 //  extern void unlockMutex(void*);
@@ -36,6 +37,55 @@ package fdb
 //  void go_set_callback(void* f, void* m) {
 //      fdb_future_set_callback(f, (FDBCallback)&go_callback, m);
 //  }
+//
+//  typedef struct {
+//      int remaining;
+//      void* m;
+//  } go_wait_all_state;
+//
+//  void go_wait_all_callback(FDBFuture* f, void* s) {
+//      go_wait_all_state* state = (go_wait_all_state*)s;
+//      if (__atomic_sub_fetch(&state->remaining, 1, __ATOMIC_ACQ_REL) == 0) {
+//          void* m = state->m;
+//          free(state);
+//          unlockMutex(m);
+//      }
+//  }
+//
+//  // Returns 0 if all of fs are ready, and otherwise 1 after arranging for m to be
+//  // unlocked once they are. The count of the state starts at one, so that it can't
+//  // reach zero until all the callbacks have been set.
+//  int go_set_wait_all_callback(FDBFuture** fs, int count, void* m) {
+//      go_wait_all_state* state = (go_wait_all_state*)malloc(sizeof(go_wait_all_state));
+//      state->remaining = 1;
+//      state->m = m;
+//      for (int i = 0; i < count; i++) {
+//          if (!fdb_future_is_ready(fs[i])) {
+//              __atomic_add_fetch(&state->remaining, 1, __ATOMIC_ACQ_REL);
+//              if (fdb_future_set_callback(fs[i], &go_wait_all_callback, state) != 0) {
+//                  __atomic_sub_fetch(&state->remaining, 1, __ATOMIC_ACQ_REL);
+//              }
+//          }
+//      }
+//      if (__atomic_sub_fetch(&state->remaining, 1, __ATOMIC_ACQ_REL) == 0) {
+//          free(state);
+//          return 0;
+//      }
+//      return 1;
+//  }
+//
+//  void go_future_get_values(FDBFuture** fs, int count, fdb_error_t* errs, fdb_bool_t* present,
+//                            const uint8_t** values, int* lengths) {
+//      for (int i = 0; i < count; i++) {
+//          errs[i] = fdb_future_get_value(fs[i], &present[i], &values[i], &lengths[i]);
+//      }
+//  }
+//
+//  void go_future_destroy_many(FDBFuture** fs, int count) {
+//      for (int i = 0; i < count; i++) {
+//          fdb_future_destroy(fs[i]);
+//      }
+//  }
 import "C"
 
 import (
@@ -93,10 +143,70 @@ func fdb_future_block_until_ready(f *C.FDBFuture) {
 	//
 	// See https://groups.google.com/forum/#!topic/golang-nuts/SPjQEcsdORA
 	// for the history of why this pattern came to be used.
-	m := &sync.Mutex{}
+	m := waitMutexPool.Get().(*sync.Mutex)
 	m.Lock()
 	C.go_set_callback(unsafe.Pointer(f), unsafe.Pointer(m))
 	m.Lock()
+
+	// The callback has fired, so m can be reused
+	m.Unlock()
+	waitMutexPool.Put(m)
+}
+
+// The mutexes used by the callbacks of futures, which are reused rather than
+// allocated for each wait.
+var waitMutexPool = sync.Pool{
+	New: func() interface{} { return &sync.Mutex{} },
+}
+
+// blockUntilAllReady blocks the calling goroutine until all of fs are ready,
+// with a single callback for all of them.
+func blockUntilAllReady(fs []*C.FDBFuture) {
+	if len(fs) == 0 {
+		return
+	}
+
+	m := waitMutexPool.Get().(*sync.Mutex)
+	m.Lock()
+	if C.go_set_wait_all_callback(&fs[0], C.int(len(fs)), unsafe.Pointer(m)) != 0 {
+		m.Lock()
+	}
+	m.Unlock()
+	waitMutexPool.Put(m)
+}
+
+// destroyFutures destroys fs with a single call into C.
+func destroyFutures(fs []*C.FDBFuture) {
+	if len(fs) > 0 {
+		C.go_future_destroy_many(&fs[0], C.int(len(fs)))
+	}
+}
+
+// getValues returns the values of fs, which must be ready futures of values,
+// with a single call into C for all of them. The values are copied, so that fs
+// may be destroyed once it returns.
+func getValues(fs []*C.FDBFuture) ([][]byte, error) {
+	n := len(fs)
+	if n == 0 {
+		return [][]byte{}, nil
+	}
+
+	errs := make([]C.fdb_error_t, n)
+	present := make([]C.fdb_bool_t, n)
+	values := make([]*C.uint8_t, n)
+	lengths := make([]C.int, n)
+	C.go_future_get_values(&fs[0], C.int(n), &errs[0], &present[0], &values[0], &lengths[0])
+
+	res := make([][]byte, n)
+	for i := range fs {
+		if errs[i] != 0 {
+			return nil, Error{int(errs[i])}
+		}
+		if present[i] != 0 {
+			res[i] = C.GoBytes(unsafe.Pointer(values[i]), lengths[i])
+		}
+	}
+	return res, nil
 }
 
 func (f *future) BlockUntilReady() {
@@ -509,6 +509,18 @@ func (o TransactionOptions) SetReadPriorityHigh() error {
 	return o.setOpt(511, nil)
 }
 
+// Sets how long a storage server may queue each subsequent read request of this transaction before starting it. A read that waits longer than this in the queue is dropped with a read_deadline_exceeded error rather than served late. The default, 0, sets no budget.
+//
+// Parameter: value in milliseconds of the budget, or 0 for none
+func (o TransactionOptions) SetReadDeadline(param int64) error {
+	return o.setOpt(512, int64ToBytes(param))
+}
+
+// Asks the storage servers read by this transaction to keep a snapshot of the data at its read version, so that subsequent reads of the same ranges can go on after the transaction is older than the in-memory MVCC window. Only gets and range reads between two keys are served from the snapshots, and only by storage engines that support them. Snapshots are kept for a limited time, and reads of a range whose storage servers couldn't keep one, or whose shards moved, fail as they would without this option.
+func (o TransactionOptions) SetLongSnapshot() error {
+	return o.setOpt(513, nil)
+}
+
 // Not yet implemented.
 func (o TransactionOptions) SetDurabilityDatacenter() error {
 	return o.setOpt(110, nil)
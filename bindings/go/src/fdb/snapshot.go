@@ -64,6 +64,11 @@ func (s Snapshot) Get(key KeyConvertible) FutureByteSlice {
 	return s.get(key.FDBKey(), 1)
 }
 
+// GetMany is equivalent to (Transaction).GetMany, performed as a snapshot read.
+func (s Snapshot) GetMany(keys []KeyConvertible) ([][]byte, error) {
+	return s.getMany(keys, 1)
+}
+
 // GetKey is equivalent to (Transaction).GetKey, performed as a snapshot read.
 func (s Snapshot) GetKey(sel Selectable) FutureKey {
 	return s.getKey(sel.FDBKeySelector(), 1)
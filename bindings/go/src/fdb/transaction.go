@@ -24,8 +24,31 @@ package fdb
 
 // #define FDB_API_VERSION 740
 // #include <foundationdb/fdb_c.h>
+//
+// // Starts a read of each of count keys, which are concatenated in keys
+// void go_transaction_get_many(FDBTransaction* t, const uint8_t* keys, const int* lengths, int count,
+//                              fdb_bool_t snapshot, FDBFuture** fs) {
+//     for (int i = 0; i < count; i++) {
+//         fs[i] = fdb_transaction_get(t, keys, lengths[i], snapshot);
+//         keys += lengths[i];
+//     }
+// }
+//
+// // Sets each of count pairs of a key and a value, which are concatenated in buf
+// void go_transaction_set_many(FDBTransaction* t, const uint8_t* buf, const int* lengths, int count) {
+//     for (int i = 0; i < count; i++) {
+//         const uint8_t* key = buf;
+//         buf += lengths[2 * i];
+//         fdb_transaction_set(t, key, lengths[2 * i], buf, lengths[2 * i + 1]);
+//         buf += lengths[2 * i + 1];
+//     }
+// }
 import "C"
 
+import (
+	"runtime"
+)
+
 // A ReadTransaction can asynchronously read from a FoundationDB
 // database. Transaction and Snapshot both satisfy the ReadTransaction
 // interface.
@@ -260,6 +283,47 @@ func (t Transaction) Get(key KeyConvertible) FutureByteSlice {
 	return t.get(key.FDBKey(), 0)
 }
 
+func (t *transaction) getMany(keys []KeyConvertible, snapshot int) ([][]byte, error) {
+	if len(keys) == 0 {
+		return [][]byte{}, nil
+	}
+	defer runtime.KeepAlive(t)
+
+	var buf []byte
+	lengths := make([]C.int, len(keys))
+	for i, key := range keys {
+		kb := key.FDBKey()
+		buf = append(buf, kb...)
+		lengths[i] = C.int(len(kb))
+	}
+
+	fs := make([]*C.FDBFuture, len(keys))
+	C.go_transaction_get_many(
+		t.ptr,
+		byteSliceToPtr(buf),
+		&lengths[0],
+		C.int(len(keys)),
+		C.fdb_bool_t(snapshot),
+		&fs[0],
+	)
+	defer destroyFutures(fs)
+
+	blockUntilAllReady(fs)
+	return getValues(fs)
+}
+
+// GetMany returns the values associated with the specified keys, in the same
+// order, with a nil value for a key that is not present. It blocks the calling
+// goroutine until all the reads are complete, and returns an error if any of
+// them failed.
+//
+// GetMany is equivalent to calling Get for each key and then waiting on all the
+// futures, but crosses from Go into C a fixed number of times rather than
+// several times for each key, and is woken by a single callback.
+func (t Transaction) GetMany(keys []KeyConvertible) ([][]byte, error) {
+	return t.getMany(keys, 0)
+}
+
 func (t *transaction) doGetRange(r Range, options RangeOptions, snapshot bool, iteration int) futureKeyValueArray {
 	begin, end := r.FDBRangeKeySelectors()
 	bsel := begin.FDBKeySelector()
@@ -382,6 +446,25 @@ func (t Transaction) Set(key KeyConvertible, value []byte) {
 	C.fdb_transaction_set(t.ptr, byteSliceToPtr(kb), C.int(len(kb)), byteSliceToPtr(value), C.int(len(value)))
 }
 
+// SetMany is equivalent to calling Set for each of the specified pairs, in
+// order, with a single call from Go into C.
+func (t Transaction) SetMany(kvs []KeyValue) {
+	if len(kvs) == 0 {
+		return
+	}
+	defer runtime.KeepAlive(t.transaction)
+
+	var buf []byte
+	lengths := make([]C.int, 2*len(kvs))
+	for i, kv := range kvs {
+		buf = append(buf, kv.Key...)
+		buf = append(buf, kv.Value...)
+		lengths[2*i] = C.int(len(kv.Key))
+		lengths[2*i+1] = C.int(len(kv.Value))
+	}
+	C.go_transaction_set_many(t.ptr, byteSliceToPtr(buf), &lengths[0], C.int(len(kvs)))
+}
+
 // Clear removes the specified key (and any associated value), if it
 // exists. Clear returns immediately, having modified the snapshot of the
 // database represented by the transaction.
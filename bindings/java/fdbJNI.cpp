@@ -20,13 +20,19 @@
 
 #include <jni.h>
 #include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
+#include <vector>
 
 #include "com_apple_foundationdb_FDB.h"
 #include "com_apple_foundationdb_FDBDatabase.h"
 #include "com_apple_foundationdb_FDBTenant.h"
 #include "com_apple_foundationdb_FDBTransaction.h"
 #include "com_apple_foundationdb_FutureBool.h"
+#include "com_apple_foundationdb_FutureDirectValue.h"
 #include "com_apple_foundationdb_FutureInt64.h"
 #include "com_apple_foundationdb_FutureKey.h"
 #include "com_apple_foundationdb_FutureKeyArray.h"
@@ -57,6 +63,7 @@ static jclass range_result_class;
 static jclass mapped_range_result_class;
 static jclass mapped_key_value_class;
 static jclass string_class;
+static jclass runnable_class;
 static jclass key_array_result_class;
 static jclass keyrange_class;
 static jclass keyrange_array_result_class;
@@ -68,6 +75,14 @@ static jmethodID mapped_range_result_init;
 static jmethodID mapped_key_value_from_bytes;
 static jmethodID range_result_summary_init;
 
+// With batched callbacks, the callbacks of futures are queued here instead of being called on the thread completing the
+// future, and are taken in batches by the callback dispatcher thread of FDB.
+static std::atomic<bool> g_batch_callbacks{ false };
+static std::mutex g_callbacks_mutex;
+static std::condition_variable g_callbacks_cv;
+static std::vector<jobject> g_callbacks;
+static bool g_callbacks_stopped = false;
+
 void detachIfExternalThread(void* ignore) {
 	if (is_external && g_thread_jenv != nullptr) {
 		g_thread_jenv = nullptr;
@@ -153,6 +168,15 @@ static bool findCallbackMethods(JNIEnv* jenv) {
 }
 
 static void callCallback(FDBFuture* f, void* data) {
+	if (g_batch_callbacks.load(std::memory_order_relaxed)) {
+		std::lock_guard<std::mutex> lock(g_callbacks_mutex);
+		g_callbacks.push_back((jobject)data);
+		if (g_callbacks.size() == 1) {
+			g_callbacks_cv.notify_one();
+		}
+		return;
+	}
+
 	if (g_thread_jenv == nullptr) {
 		// We are on an external thread and must attach to the JVM.
 		// The shutdown hook will later detach this thread.
@@ -721,6 +745,41 @@ JNIEXPORT jbyteArray JNICALL Java_com_apple_foundationdb_FutureResult_FutureResu
 	return result;
 }
 
+// The buffer views the memory of the future, so the future must not be destroyed while the buffer is in use
+JNIEXPORT jobject JNICALL Java_com_apple_foundationdb_FutureDirectValue_FutureDirectValue_1get(JNIEnv* jenv,
+                                                                                              jobject,
+                                                                                              jlong future,
+                                                                                              jboolean isKey) {
+	if (!future) {
+		throwParamNotNull(jenv);
+		return JNI_NULL;
+	}
+	FDBFuture* f = (FDBFuture*)future;
+
+	fdb_bool_t present = true;
+	const uint8_t* value;
+	int length;
+	fdb_error_t err =
+	    isKey ? fdb_future_get_key(f, &value, &length) : fdb_future_get_value(f, &present, &value, &length);
+	if (err) {
+		safeThrow(jenv, getThrowable(jenv, err));
+		return JNI_NULL;
+	}
+
+	if (!present)
+		return JNI_NULL;
+
+	// The address of an empty buffer must not be null either
+	static const uint8_t empty = 0;
+	jobject result = jenv->NewDirectByteBuffer((void*)(length ? value : &empty), length);
+	if (!result) {
+		if (!jenv->ExceptionOccurred())
+			throwOutOfMem(jenv);
+		return JNI_NULL;
+	}
+	return result;
+}
+
 JNIEXPORT jbyteArray JNICALL Java_com_apple_foundationdb_FutureKey_FutureKey_1get(JNIEnv* jenv, jobject, jlong future) {
 	if (!future) {
 		throwParamNotNull(jenv);
@@ -2331,6 +2390,53 @@ JNIEXPORT void JNICALL Java_com_apple_foundationdb_FDB_Network_1run(JNIEnv* jenv
 	}
 }
 
+JNIEXPORT void JNICALL Java_com_apple_foundationdb_FDB_Callbacks_1enable(JNIEnv* jenv, jobject) {
+	g_batch_callbacks = true;
+}
+
+// Waits for callbacks to be queued and returns up to maxBatch of them, or null once the queue is stopped and empty
+JNIEXPORT jobjectArray JNICALL Java_com_apple_foundationdb_FDB_Callbacks_1waitForBatch(JNIEnv* jenv,
+                                                                                      jobject,
+                                                                                      jint maxBatch) {
+	std::vector<jobject> batch;
+	{
+		std::unique_lock<std::mutex> lock(g_callbacks_mutex);
+		g_callbacks_cv.wait(lock, [] { return !g_callbacks.empty() || g_callbacks_stopped; });
+		if (g_callbacks.empty()) {
+			return JNI_NULL;
+		}
+		if (g_callbacks.size() <= (size_t)maxBatch) {
+			batch.swap(g_callbacks);
+		} else {
+			batch.assign(g_callbacks.begin(), g_callbacks.begin() + maxBatch);
+			g_callbacks.erase(g_callbacks.begin(), g_callbacks.begin() + maxBatch);
+		}
+	}
+
+	jobjectArray result = jenv->NewObjectArray(batch.size(), runnable_class, JNI_NULL);
+	if (!result) {
+		// Put the batch back for the next call
+		{
+			std::lock_guard<std::mutex> lock(g_callbacks_mutex);
+			g_callbacks.insert(g_callbacks.begin(), batch.begin(), batch.end());
+		}
+		if (!jenv->ExceptionOccurred())
+			throwOutOfMem(jenv);
+		return JNI_NULL;
+	}
+	for (jsize i = 0; i < (jsize)batch.size(); i++) {
+		jenv->SetObjectArrayElement(result, i, batch[i]);
+		jenv->DeleteGlobalRef(batch[i]);
+	}
+	return result;
+}
+
+JNIEXPORT void JNICALL Java_com_apple_foundationdb_FDB_Callbacks_1stop(JNIEnv* jenv, jobject) {
+	std::lock_guard<std::mutex> lock(g_callbacks_mutex);
+	g_callbacks_stopped = true;
+	g_callbacks_cv.notify_all();
+}
+
 JNIEXPORT void JNICALL Java_com_apple_foundationdb_FDB_Network_1stop(JNIEnv* jenv, jobject) {
 	fdb_error_t err = fdb_stop_network();
 	if (err) {
@@ -2378,6 +2484,9 @@ jint JNI_OnLoad(JavaVM* vm, void* reserved) {
 		jclass local_string_class = env->FindClass("java/lang/String");
 		string_class = (jclass)(env)->NewGlobalRef(local_string_class);
 
+		jclass local_runnable_class = env->FindClass("java/lang/Runnable");
+		runnable_class = (jclass)(env)->NewGlobalRef(local_runnable_class);
+
 		return JNI_VERSION_1_6;
 	}
 }
@@ -2410,6 +2519,9 @@ void JNI_OnUnload(JavaVM* vm, void* reserved) {
 		if (string_class != JNI_NULL) {
 			env->DeleteGlobalRef(string_class);
 		}
+		if (runnable_class != JNI_NULL) {
+			env->DeleteGlobalRef(runnable_class);
+		}
 	}
 }
 
@@ -61,6 +61,36 @@ public class TransactionIntegrationTest {
         }
     }
 
+    @Test
+    public void testGetDirect() throws Exception {
+        try (Database db = fdb.open()) {
+            db.run(tr -> {
+                tr.set("directKey".getBytes(), "directValue".getBytes());
+                tr.set("directEmpty".getBytes(), new byte[0]);
+                return null;
+            });
+            db.run(tr -> {
+                try (DirectValue value = tr.getDirect("directKey".getBytes()).join()) {
+                    Assertions.assertTrue(value.getBuffer().isDirect());
+                    Assertions.assertTrue(value.getBuffer().isReadOnly());
+                    Assertions.assertArrayEquals("directValue".getBytes(), value.getBytes());
+                }
+                try (DirectValue value = tr.snapshot().getDirect("directEmpty".getBytes()).join()) {
+                    Assertions.assertEquals(0, value.size());
+                }
+                Assertions.assertNull(tr.getDirect("directMissing".getBytes()).join());
+                try (DirectValue key = tr.getKeyDirect(KeySelector.firstGreaterThan("directKey".getBytes())).join()) {
+                    Assertions.assertArrayEquals(tr.getKey(KeySelector.firstGreaterThan("directKey".getBytes())).join(),
+                                                 key.getBytes());
+                }
+                DirectValue closed = tr.getDirect("directKey".getBytes()).join();
+                closed.close();
+                Assertions.assertThrows(IllegalStateException.class, closed::getBuffer);
+                return null;
+            });
+        }
+    }
+
     private void doTestOperationsAfterCommit(Transaction tr) {
         tr.set("key1".getBytes(), "val1".getBytes());
         CompletableFuture<Void> commitFuture = tr.commit();
@@ -0,0 +1,104 @@
+/*
+ * DirectValue.java
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.apple.foundationdb;
+
+import java.nio.ByteBuffer;
+
+/**
+ * A value or key read by {@link ReadTransaction#getDirect(byte[])} or
+ *  {@link ReadTransaction#getKeyDirect(KeySelector)}. Its buffer is a read-only view of the
+ *  memory in which the native client received the result, so reading it neither copies the
+ *  result into a {@code byte[]} nor allocates on the Java heap.<br>
+ * <br>
+ * The memory is held until the {@code DirectValue} is {@linkplain #close() closed}, which
+ *  must be done once the buffer is no longer needed. The buffer must not be used after that.
+ */
+public final class DirectValue implements AutoCloseable {
+	private final ByteBuffer buffer;
+	private final AutoCloseable owner;
+	private volatile boolean closed = false;
+
+	DirectValue(ByteBuffer buffer, AutoCloseable owner) {
+		this.buffer = buffer.asReadOnlyBuffer();
+		this.owner = owner;
+	}
+
+	// Used by implementations of ReadTransaction that read into byte arrays
+	static DirectValue wrap(byte[] bytes) {
+		return bytes == null ? null : new DirectValue(ByteBuffer.wrap(bytes), null);
+	}
+
+	/**
+	 * Gets the read-only buffer of the result. The same buffer is returned by every call.
+	 *
+	 * @return the buffer holding the result
+	 *
+	 * @throws IllegalStateException if this {@code DirectValue} has been closed
+	 */
+	public ByteBuffer getBuffer() {
+		if(closed) {
+			throw new IllegalStateException("Cannot access closed object");
+		}
+		return buffer;
+	}
+
+	/**
+	 * Gets the size of the result.
+	 *
+	 * @return the number of bytes in the result
+	 */
+	public int size() {
+		return buffer.capacity();
+	}
+
+	/**
+	 * Copies the result into a new array.
+	 *
+	 * @return the bytes of the result
+	 *
+	 * @throws IllegalStateException if this {@code DirectValue} has been closed
+	 */
+	public byte[] getBytes() {
+		byte[] bytes = new byte[size()];
+		ByteBuffer view = getBuffer().duplicate();
+		view.clear();
+		view.get(bytes);
+		return bytes;
+	}
+
+	/**
+	 * Releases the memory of the result.
+	 */
+	@Override
+	public void close() {
+		if(closed) {
+			return;
+		}
+		closed = true;
+		if(owner != null) {
+			try {
+				owner.close();
+			} catch(Exception e) {
+				throw new RuntimeException(e);
+			}
+		}
+	}
+}
@@ -88,6 +88,10 @@ public class FDB {
 	private volatile boolean netStopped = false;
 	volatile boolean warnOnUnclosed = true;
 	private boolean enableDirectBufferQueries = false;
+	private boolean enableBatchedCallbacks = false;
+
+	// The most callbacks run for one call into the native library by the callback dispatcher
+	static private final int CALLBACK_BATCH_SIZE = 1024;
 
 	private boolean useShutdownHook = true;
 	private Thread shutdownHook;
@@ -252,6 +256,33 @@ public class FDB {
 		return enableDirectBufferQueries;
 	}
 
+	/**
+	 * Enables or disables batched completion callbacks. By default, the network thread calls into
+	 *  the JVM once for each future that completes. With batched callbacks, it instead queues the
+	 *  callbacks, and a dispatcher thread takes them from the queue in batches and runs them. This
+	 *  saves the network thread the calls into the JVM, at the cost of a thread handoff for
+	 *  each batch. Must be set before the network is started.
+	 *
+	 * @param enabled Whether completion callbacks should be batched.
+	 *
+	 * @throws IllegalStateException if the network has already been started
+	 */
+	public synchronized void enableBatchedCallbacks(boolean enabled) {
+		if(netStarted) {
+			throw new IllegalStateException("Batched callbacks must be set before the network is started");
+		}
+		enableBatchedCallbacks = enabled;
+	}
+
+	/**
+	 * Determines whether completion callbacks are batched.
+	 *
+	 * @return {@code true} if batched callbacks have been enabled and {@code false} otherwise
+	 */
+	public synchronized boolean isBatchedCallbacksEnabled() {
+		return enableBatchedCallbacks;
+	}
+
 	/**
 	 * Resizes the DirectBufferPool with given parameters, which is used by getRange() requests.
 	 *
@@ -497,6 +528,13 @@ public class FDB {
 		Network_setup();
 		netStarted = true;
 
+		if(enableBatchedCallbacks) {
+			Callbacks_enable();
+			Thread dispatcher = new Thread(this::dispatchCallbacks, "fdb-callback-dispatcher");
+			dispatcher.setDaemon(true);
+			dispatcher.start();
+		}
+
 		e.execute(() -> {
 			boolean acquired = false;
 			try {
@@ -522,6 +560,10 @@ public class FDB {
 					// eat this error. we have nowhere to send it.
 				}
 			} finally {
+				if(enableBatchedCallbacks) {
+					// The dispatcher runs the queued callbacks before it exits
+					Callbacks_stop();
+				}
 				if(acquired) {
 					netRunning.release();
 				}
@@ -532,6 +574,29 @@ public class FDB {
 		});
 	}
 
+	private void dispatchCallbacks() {
+		while(true) {
+			Runnable[] batch;
+			try {
+				batch = Callbacks_waitForBatch(CALLBACK_BATCH_SIZE);
+			} catch(OutOfMemoryError err) {
+				// The callbacks of the batch are still queued
+				continue;
+			}
+			if(batch == null) {
+				return;
+			}
+			for(Runnable callback : batch) {
+				try {
+					callback.run();
+				} catch(Throwable t) {
+					System.err.println("Unhandled error in FoundationDB callback dispatcher: " + t.getMessage());
+					// eat this error. we have nowhere to send it.
+				}
+			}
+		}
+	}
+
 	/**
 	 * Gets the state of the FoundationDB networking thread.
 	 *
@@ -583,6 +648,10 @@ public class FDB {
 	private native void Network_run() throws FDBException;
 	private native void Network_stop() throws FDBException;
 
+	private native void Callbacks_enable();
+	private native Runnable[] Callbacks_waitForBatch(int maxBatch);
+	private native void Callbacks_stop();
+
 	private native boolean Error_predicate(int predicate, int code);
 
 	private native long Database_create(String clusterFilePath) throws FDBException;
@@ -72,6 +72,16 @@ class FDBTransaction extends NativeObjectWrapper implements Transaction, OptionC
 			return getKey_internal(selector, true);
 		}
 
+		@Override
+		public CompletableFuture<DirectValue> getDirect(byte[] key) {
+			return getDirect_internal(key, true);
+		}
+
+		@Override
+		public CompletableFuture<DirectValue> getKeyDirect(KeySelector selector) {
+			return getKeyDirect_internal(selector, true);
+		}
+
 		@Override
 		public CompletableFuture<Long> getEstimatedRangeSizeBytes(byte[] begin, byte[] end) {
 			return FDBTransaction.this.getEstimatedRangeSizeBytes(begin, end);
@@ -318,6 +328,48 @@ class FDBTransaction extends NativeObjectWrapper implements Transaction, OptionC
 		}
 	}
 
+	/**
+	 * {@inheritDoc}
+	 */
+	@Override
+	public CompletableFuture<DirectValue> getDirect(byte[] key) {
+		return getDirect_internal(key, false);
+	}
+
+	private CompletableFuture<DirectValue> getDirect_internal(byte[] key, boolean isSnapshot) {
+		if (eventKeeper != null) {
+			eventKeeper.increment(Events.JNI_CALL);
+		}
+		pointerReadLock.lock();
+		try {
+			return new FutureDirectValue(Transaction_get(getPtr(), key, isSnapshot), false, executor, eventKeeper);
+		} finally {
+			pointerReadLock.unlock();
+		}
+	}
+
+	/**
+	 * {@inheritDoc}
+	 */
+	@Override
+	public CompletableFuture<DirectValue> getKeyDirect(KeySelector selector) {
+		return getKeyDirect_internal(selector, false);
+	}
+
+	private CompletableFuture<DirectValue> getKeyDirect_internal(KeySelector selector, boolean isSnapshot) {
+		if (eventKeeper != null) {
+			eventKeeper.increment(Events.JNI_CALL);
+		}
+		pointerReadLock.lock();
+		try {
+			return new FutureDirectValue(
+			    Transaction_getKey(getPtr(), selector.getKey(), selector.orEqual(), selector.getOffset(), isSnapshot),
+			    true, executor, eventKeeper);
+		} finally {
+			pointerReadLock.unlock();
+		}
+	}
+
 	@Override
 	public CompletableFuture<Long> getEstimatedRangeSizeBytes(byte[] begin, byte[] end) {
 		if (eventKeeper != null) {
@@ -0,0 +1,60 @@
+/*
+ * FutureDirectValue.java
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.apple.foundationdb;
+
+import java.nio.ByteBuffer;
+import java.util.concurrent.Executor;
+
+import com.apple.foundationdb.EventKeeper.Events;
+
+// The buffer of the DirectValue views the memory of the native future, so the future
+//  is closed by the DirectValue rather than once it has been marshalled.
+class FutureDirectValue extends NativeFuture<DirectValue> {
+	private final boolean isKey;
+	private final EventKeeper eventKeeper;
+
+	FutureDirectValue(long cPtr, boolean isKey, Executor executor, EventKeeper eventKeeper) {
+		super(cPtr);
+		this.isKey = isKey;
+		this.eventKeeper = eventKeeper;
+		registerMarshalCallback(executor);
+	}
+
+	@Override
+	protected DirectValue getIfDone_internal(long cPtr) throws FDBException {
+		ByteBuffer buffer = FutureDirectValue_get(cPtr, isKey);
+		return buffer == null ? null : new DirectValue(buffer, this);
+	}
+
+	@Override
+	protected void postMarshal(DirectValue value) {
+		if(value == null || isCancelled() || isCompletedExceptionally()) {
+			// Nobody will get value to close it
+			super.postMarshal(value);
+			return;
+		}
+		if(eventKeeper != null) {
+			eventKeeper.count(Events.BYTES_FETCHED, value.size());
+		}
+	}
+
+	private native ByteBuffer FutureDirectValue_get(long cPtr, boolean isKey) throws FDBException;
+}
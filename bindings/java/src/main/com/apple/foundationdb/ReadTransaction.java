@@ -136,6 +136,33 @@ public interface ReadTransaction extends ReadTransactionContext {
 	 */
 	CompletableFuture<byte[]> getKey(KeySelector selector);
 
+	/**
+	 * Gets a value from the database like {@link #get(byte[])}, as a read-only view of the
+	 *  memory in which the native client received it rather than as a copy on the Java heap.
+	 *  The returned {@link DirectValue} must be closed to release that memory.
+	 *
+	 * @param key the key whose value to fetch from the database
+	 *
+	 * @return a {@code CompletableFuture} which will be set to the value corresponding to
+	 *  the key or to null if the key does not exist.
+	 */
+	default CompletableFuture<DirectValue> getDirect(byte[] key) {
+		return get(key).thenApply(DirectValue::wrap);
+	}
+
+	/**
+	 * Returns the key referenced by the specified {@code KeySelector} like
+	 *  {@link #getKey(KeySelector)}, as a read-only view of the memory in which the native
+	 *  client received it. The returned {@link DirectValue} must be closed to release that memory.
+	 *
+	 * @param selector the relative key location to resolve
+	 *
+	 * @return a {@code CompletableFuture} which will be set to an absolute database key
+	 */
+	default CompletableFuture<DirectValue> getKeyDirect(KeySelector selector) {
+		return getKey(selector).thenApply(DirectValue::wrap);
+	}
+
 	/**
 	 * Gets an ordered range of keys and values from the database. The begin
 	 *  and end keys are specified by {@code KeySelector}s, with the begin
@@ -106,6 +106,7 @@ def api_version(ver):
         "Tenant",
         "Transaction",
         "KeyValue",
+        "RangeBuffer",
         "KeySelector",
         "open",
         "transactional",
@@ -20,6 +20,7 @@
 
 # FoundationDB Python API
 
+import array
 import atexit
 import ctypes
 import ctypes.util
@@ -447,6 +448,48 @@ class FDBRange(object):
             yield result
 
 
+class RangeBuffer(object):
+    """One batch of the results of an FDB range query, held in a single
+    buffer instead of as KeyValue objects.
+
+    keys and values are memoryviews of the concatenated keys and values of the
+    batch, and key_offsets and value_offsets are arrays of count + 1 offsets
+    into them, so that key i is keys[key_offsets[i]:key_offsets[i + 1]]. This
+    is the layout of a binary column in Arrow, so the batch can be handed to
+    numpy or pyarrow without copying it again.
+
+    """
+
+    def __init__(self, data, key_offsets, value_offsets, more):
+        self.data = memoryview(data)
+        self.keys = self.data[: key_offsets[-1]]
+        self.values = self.data[key_offsets[-1] :]
+        self.key_offsets = key_offsets
+        self.value_offsets = value_offsets
+        self.count = len(key_offsets) - 1
+        self.more = more
+
+    def key(self, i):
+        return self.keys[self.key_offsets[i] : self.key_offsets[i + 1]].tobytes()
+
+    def value(self, i):
+        return self.values[self.value_offsets[i] : self.value_offsets[i + 1]].tobytes()
+
+    def __len__(self):
+        return self.count
+
+    def __getitem__(self, i):
+        if i < 0:
+            i += self.count
+        if i < 0 or i >= self.count:
+            raise IndexError("RangeBuffer index out of range")
+        return KeyValue(self.key(i), self.value(i))
+
+    def __iter__(self):
+        for i in range(self.count):
+            yield KeyValue(self.key(i), self.value(i))
+
+
 class TransactionRead(_FDBBase):
     def __init__(self, tpointer, db, snapshot):
         self.tpointer = tpointer
@@ -482,10 +525,22 @@ class TransactionRead(_FDBBase):
         )
 
     def _get_range(self, begin, end, limit, streaming_mode, iteration, reverse):
+        return self._get_range_future(
+            FutureKeyValueArray, begin, end, limit, streaming_mode, iteration, reverse
+        )
+
+    def _get_range_buffer(self, begin, end, limit, streaming_mode, iteration, reverse):
+        return self._get_range_future(
+            FutureRangeBuffer, begin, end, limit, streaming_mode, iteration, reverse
+        )
+
+    def _get_range_future(
+        self, future_type, begin, end, limit, streaming_mode, iteration, reverse
+    ):
         beginKey = keyToBytes(begin.key)
         endKey = keyToBytes(end.key)
 
-        return FutureKeyValueArray(
+        return future_type(
             self.capi.fdb_transaction_get_range(
                 self.tpointer,
                 beginKey,
@@ -521,6 +576,43 @@ class TransactionRead(_FDBBase):
         end = self._to_selector(end)
         return FDBRange(self, begin, end, limit, reverse, streaming_mode)
 
+    def get_range_buffers(
+        self, begin, end, limit=0, reverse=False, streaming_mode=StreamingMode.want_all
+    ):
+        """Reads a range like get_range, but yields each batch returned by the
+        database as a RangeBuffer rather than each key-value pair as a KeyValue.
+        The read of the next batch is started before the current one is
+        yielded."""
+        if begin is None:
+            begin = b""
+        if end is None:
+            end = b"\xff"
+        bsel = self._to_selector(begin)
+        esel = self._to_selector(end)
+
+        iteration = 1
+        future = self._get_range_buffer(bsel, esel, limit, streaming_mode, 1, reverse)
+        while future:
+            batch = future.wait()
+            future = None
+            if not batch.count:
+                return
+
+            if batch.more and limit != batch.count:
+                iteration += 1
+                if limit > 0:
+                    limit = limit - batch.count
+                last = batch.key(batch.count - 1)
+                if reverse:
+                    esel = KeySelector.first_greater_or_equal(last)
+                else:
+                    bsel = KeySelector.first_greater_than(last)
+                future = self._get_range_buffer(
+                    bsel, esel, limit, streaming_mode, iteration, reverse
+                )
+
+            yield batch
+
     def get_range_startswith(self, prefix, *args, **kwargs):
         prefix = keyToBytes(prefix)
         return self.get_range(prefix, strinc(prefix), *args, **kwargs)
@@ -780,6 +872,29 @@ class Future(_FDBBase):
         ev.wait()
         return d["i"]
 
+    @staticmethod
+    def wait_all(*futures):
+        """Does not return until all of the given futures are ready. The
+        caller blocks once, when the last of them becomes ready, rather than
+        once for each future."""
+        pending = [f for f in futures if not f.is_ready()]
+        if not pending:
+            return
+        lock = threading.Lock()
+        remaining = [len(pending)]
+        ev = pending[0].Event()
+
+        def cb(ignore):
+            with lock:
+                remaining[0] -= 1
+                done = remaining[0] == 0
+            if done:
+                ev.set()
+
+        for f in pending:
+            f.on_ready(cb)
+        ev.wait()
+
     # asyncio future protocol
     def cancelled(self):
         if not self.done():
@@ -860,6 +975,35 @@ class FutureKeyValueArray(Future):
         # destroy the future anyway
 
 
+class FutureRangeBuffer(Future):
+    def wait(self):
+        self.block_until_ready()
+        kvs = ctypes.pointer(KeyValueStruct())
+        count = ctypes.c_int()
+        more = ctypes.c_int()
+        self.capi.fdb_future_get_keyvalue_array(
+            self.fpointer, ctypes.byref(kvs), ctypes.byref(count), ctypes.byref(more)
+        )
+        # The keys and values of the result are not contiguous in client memory,
+        # so they are copied once, into a single buffer
+        entries = kvs[0 : count.value]
+        key_offsets = array.array("i", [0])
+        value_offsets = array.array("i", [0])
+        for x in entries:
+            key_offsets.append(key_offsets[-1] + x.key_length)
+            value_offsets.append(value_offsets[-1] + x.value_length)
+        key_bytes = key_offsets[-1]
+        data = bytearray(key_bytes + value_offsets[-1])
+        if data:
+            base = ctypes.addressof((ctypes.c_char * len(data)).from_buffer(data))
+            for i, x in enumerate(entries):
+                ctypes.memmove(base + key_offsets[i], x.key, x.key_length)
+                ctypes.memmove(
+                    base + key_bytes + value_offsets[i], x.value, x.value_length
+                )
+        return RangeBuffer(data, key_offsets, value_offsets, more.value)
+
+
 class FutureKeyArray(Future):
     def wait(self):
         self.block_until_ready()
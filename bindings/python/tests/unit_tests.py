@@ -227,6 +227,47 @@ def test_get_client_status(db):
     assert status["Healthy"]
 
 
+@fdb.transactional
+def test_range_buffers(tr):
+    del tr[b"range_buffers/" : b"range_buffers0"]
+    expected = [
+        (b"range_buffers/%04d" % i, b"value" * (i % 3)) for i in range(100)
+    ]
+    for k, v in expected:
+        tr[k] = v
+
+    for reverse in (False, True):
+        kvs = []
+        for batch in tr.get_range_buffers(
+            b"range_buffers/",
+            b"range_buffers0",
+            reverse=reverse,
+            streaming_mode=fdb.StreamingMode.small,
+        ):
+            assert len(batch.key_offsets) == batch.count + 1
+            assert batch.key_offsets[-1] == len(batch.keys)
+            assert batch.value_offsets[-1] == len(batch.values)
+            kvs += [(kv.key, kv.value) for kv in batch]
+        assert kvs == (expected[::-1] if reverse else expected)
+
+    limited = list(
+        tr.get_range_buffers(b"range_buffers/", b"range_buffers0", limit=10)
+    )
+    assert sum(len(batch) for batch in limited) == 10
+    assert limited[-1][-1].key == expected[9][0]
+
+    del tr[b"range_buffers/" : b"range_buffers0"]
+
+
+@fdb.transactional
+def test_wait_all(tr):
+    futures = [tr.get(b"wait_all/%d" % i) for i in range(10)]
+    fdb.Future.wait_all(*futures)
+    assert all(f.is_ready() for f in futures)
+    fdb.Future.wait_all(*futures)
+    fdb.Future.wait_all()
+
+
 def run_unit_tests(db):
     try:
         log("test_db_options")
@@ -257,6 +298,10 @@ def run_unit_tests(db):
         test_get_approximate_size(db)
         log("test_get_client_status")
         test_get_client_status(db)
+        log("test_range_buffers")
+        test_range_buffers(db)
+        log("test_wait_all")
+        test_wait_all(db)
 
         if fdb.get_api_version() >= 710:
             log("test_tenants")
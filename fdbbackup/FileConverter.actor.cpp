@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "fdbclient/BackupAgent.actor.h"
+#include "fdbclient/BackupBlockCompression.h"
 #include "fdbclient/BackupContainer.h"
 #include "fdbclient/MutationList.h"
 #include "flow/flow.h"
@@ -170,7 +171,7 @@ struct MutationFilesReadProgress : public ReferenceCounted<MutationFilesReadProg
 
 		// Decodes the block into mutations and save them if >= minVersion and < maxVersion.
 		// Returns true if new mutations has been saved.
-		bool decodeBlock(const Standalone<StringRef>& buf, int len, Version minVersion, Version maxVersion) {
+		bool decodeBlock(Standalone<StringRef>& buf, int len, Version minVersion, Version maxVersion) {
 			StringRef block(buf.begin(), len);
 			StringRefReader reader(block, restore_corrupted_data());
 			int count = 0, inserted = 0;
@@ -178,8 +179,13 @@ struct MutationFilesReadProgress : public ReferenceCounted<MutationFilesReadProg
 
 			try {
 				// Read block header
-				if (reader.consume<int32_t>() != PARTITIONED_MLOG_VERSION)
+				int32_t fileVersion = reader.consume<int32_t>();
+				if (fileVersion == PARTITIONED_COMPRESSED_MLOG_VERSION) {
+					reader = StringRefReader(decompressBackupBlock(reader.remainder(), buf.arena()),
+					                         restore_corrupted_data());
+				} else if (fileVersion != PARTITIONED_MLOG_VERSION) {
 					throw restore_unsupported_file_version();
+				}
 
 				while (1) {
 					// If eof reached or first key len bytes is 0xFF then end of block was reached.
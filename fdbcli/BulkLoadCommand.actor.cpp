@@ -0,0 +1,87 @@
+/*
+ * BulkLoadCommand.actor.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbcli/fdbcli.actor.h"
+#include "fdbclient/BulkLoad.h"
+#include "fdbclient/BulkLoadUtils.actor.h"
+#include "flow/Arena.h"
+
+#include "flow/actorcompiler.h" // This must be the last #include.
+
+namespace fdb_cli {
+
+ACTOR Future<bool> bulkLoadCommandActor(Database cx, std::vector<StringRef> tokens) {
+	if (tokens.size() < 2) {
+		printUsage(tokens[0]);
+		return false;
+	}
+
+	if (tokencmp(tokens[1], "start")) {
+		if (tokens.size() != 5 && tokens.size() != 6) {
+			printUsage(tokens[0]);
+			return false;
+		}
+		state Version version = latestVersion;
+		if (tokens.size() == 6) {
+			char* end;
+			version = strtoll(tokens[5].toString().c_str(), &end, 10);
+			if (*end || version < 0) {
+				fprintf(stderr, "ERROR: Invalid version `%s'\n", tokens[5].toString().c_str());
+				return false;
+			}
+		}
+		UID taskId = wait(submitBulkLoad(cx, KeyRangeRef(tokens[2], tokens[3]), tokens[4].toString(), version));
+		printf("Submitted bulk load: %s\n", taskId.toString().c_str());
+	} else if (tokencmp(tokens[1], "status")) {
+		if (tokens.size() != 2 && tokens.size() != 4) {
+			printUsage(tokens[0]);
+			return false;
+		}
+		KeyRange range = tokens.size() == 4 ? KeyRangeRef(tokens[2], tokens[3]) : normalKeys;
+		std::vector<BulkLoadState> states = wait(getBulkLoadStates(cx, range));
+		for (const auto& entry : states) {
+			printf("%s\n", entry.toString().c_str());
+		}
+		printf("Found %zu bulk load entries\n", states.size());
+	} else if (tokencmp(tokens[1], "clear")) {
+		if (tokens.size() != 4) {
+			printUsage(tokens[0]);
+			return false;
+		}
+		int tasks = wait(clearBulkLoad(cx, KeyRangeRef(tokens[2], tokens[3])));
+		printf("Cleared %d bulk load tasks\n", tasks);
+	} else {
+		printUsage(tokens[0]);
+		return false;
+	}
+
+	return true;
+}
+
+CommandFactory bulkLoadFactory(
+    "bulk_load",
+    CommandHelp("bulk_load [start|status|clear] [<begin> <end>] [<url>] [<version>]",
+                "Load the snapshot of a backup into an empty range",
+                "To load the snapshot of the backup at <url> into an empty range: "
+                "`bulk_load start <begin> <end> <url> [<version>]'\n"
+                "The range must not be written until its task is Complete.\n"
+                "To list the entries of the bulk load tasks: `bulk_load status [<begin> <end>]'\n"
+                "To remove the bulk load tasks in a range: `bulk_load clear <begin> <end>'\n"));
+} // namespace fdb_cli
@@ -124,6 +124,22 @@ ACTOR Future<bool> profileCommandActor(Database db,
 			                   .removePrefix("\xff\xff/worker_interfaces/"_sr);
 			printf("%s\n", printable(ip_port).c_str());
 		}
+	} else if (tokencmp(tokens[1], "heap")) {
+		if (tokens.size() != 3) {
+			fprintf(stderr, "ERROR: Usage: profile heap <PROCESS>\n");
+			return false;
+		}
+		state Key heapPrefix = tokens[2].withPrefix("\xff\xff/metrics/heap_profile/"_sr).withSuffix("/"_sr);
+		state ThreadFuture<RangeResult> sitesFuture =
+		    tr->getRange(KeyRangeRef(heapPrefix, strinc(heapPrefix)), CLIENT_KNOBS->TOO_MANY);
+		RangeResult sites = wait(safeThreadFutureToFuture(sitesFuture));
+		if (sites.empty()) {
+			printf("No live sampled allocations. Heap profiling is enabled by setting the heap_profile_sample_bytes "
+			       "knob of the process.\n");
+		}
+		for (const auto& site : sites) {
+			printf("%s\n", site.value.toString().c_str());
+		}
 	} else {
 		fprintf(stderr, "ERROR: Unknown type: %s\n", printable(tokens[1]).c_str());
 		result = false;
@@ -132,7 +148,7 @@ ACTOR Future<bool> profileCommandActor(Database db,
 }
 
 CommandFactory profileFactory("profile",
-                              CommandHelp("profile <client|list> <action> <ARGS>",
+                              CommandHelp("profile <client|list|heap> <action> <ARGS>",
                                           "namespace for all the profiling-related commands.",
                                           "Different types support different actions.  Run `profile` to get a list of "
                                           "types, and iteratively explore the help.\n"));
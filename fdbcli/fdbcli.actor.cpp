@@ -1706,6 +1706,14 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise, Reference<ClusterCo
 					continue;
 				}
 
+				if (tokencmp(tokens[0], "bulk_load")) {
+					bool _result = wait(makeInterruptable(bulkLoadCommandActor(localDb, tokens)));
+					if (!_result) {
+						is_error = true;
+					}
+					continue;
+				}
+
 				if (tokencmp(tokens[0], "location_metadata")) {
 					bool _result = wait(makeInterruptable(locationMetadataCommandActor(localDb, tokens)));
 					if (!_result) {
@@ -0,0 +1,208 @@
+/*
+ * BackupBlockCompression.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbclient/BackupBlockCompression.h"
+
+#include <cstring>
+
+#include "fdbclient/Knobs.h"
+#include "flow/UnitTest.h"
+
+// Returns an upper bound of the compressed size of bytes bytes, which for ZSTD is at least ZSTD_COMPRESSBOUND()
+static int compressBound(CompressionFilter filter, int bytes) {
+	return filter == CompressionFilter::NONE ? bytes : bytes + bytes / 128 + 64;
+}
+
+BackupBlockCompressor::BackupBlockCompressor(CompressionFilter filter, int capacity)
+  : filter(filter), capacity(capacity), chunkBytes(CLIENT_KNOBS->BACKUP_COMPRESSION_CHUNK_BYTES),
+    payloadBytes(sizeof(uint8_t)) {
+	CompressionUtils::checkFilterSupported(filter);
+}
+
+bool BackupBlockCompressor::fits(int bytesNeeded) {
+	if (payloadBytes + sizeof(uint32_t) + compressBound(filter, chunk.size() + bytesNeeded) <= capacity) {
+		return true;
+	}
+	// The bound is loose for the bytes already added, so compress them to see how much room is really left
+	if (chunk.empty()) {
+		return false;
+	}
+	compressChunk();
+	return payloadBytes + sizeof(uint32_t) + compressBound(filter, bytesNeeded) <= capacity;
+}
+
+void BackupBlockCompressor::append(const void* data, int len) {
+	chunk.append((const char*)data, len);
+	uncompressedBytes += len;
+	if (chunk.size() >= chunkBytes) {
+		compressChunk();
+	}
+}
+
+void BackupBlockCompressor::appendStringRefWithLen(StringRef s) {
+	uint32_t lenBuf = bigEndian32((uint32_t)s.size());
+	append(&lenBuf, sizeof(lenBuf));
+	append(s.begin(), s.size());
+}
+
+void BackupBlockCompressor::compressChunk() {
+	chunks.push_back(CompressionUtils::compress(filter, StringRef(chunk), arena));
+	payloadBytes += sizeof(uint32_t) + chunks.back().size();
+	chunk.clear();
+	ASSERT(payloadBytes <= capacity);
+}
+
+Standalone<StringRef> BackupBlockCompressor::finishBlock(bool pad) {
+	if (!chunk.empty()) {
+		compressChunk();
+	}
+	Standalone<StringRef> payload = makeString(pad ? capacity : payloadBytes);
+	uint8_t* wptr = mutateString(payload);
+	*wptr++ = (uint8_t)filter;
+	for (const auto& c : chunks) {
+		uint32_t lenBuf = bigEndian32((uint32_t)c.size());
+		memcpy(wptr, &lenBuf, sizeof(lenBuf));
+		wptr += sizeof(lenBuf);
+		memcpy(wptr, c.begin(), c.size());
+		wptr += c.size();
+	}
+	memset(wptr, 0xFF, payload.end() - wptr);
+
+	compressedBytes += payload.size();
+	chunks.clear();
+	arena = Arena();
+	payloadBytes = sizeof(uint8_t);
+	return payload;
+}
+
+StringRef decompressBackupBlock(StringRef payload, Arena& arena) {
+	if (payload.empty()) {
+		throw restore_corrupted_data();
+	}
+	if (payload[0] >= (uint8_t)CompressionFilter::LAST ||
+	    !CompressionUtils::supportedFilters.count((CompressionFilter)payload[0])) {
+		throw restore_unsupported_file_version();
+	}
+	const CompressionFilter filter = (CompressionFilter)payload[0];
+
+	// Chunks end at the end of the block or at padding, which can't be the first byte of a chunk length
+	Arena chunksArena;
+	std::vector<StringRef> chunks;
+	int bytes = 0;
+	const uint8_t* rptr = payload.begin() + 1;
+	while (rptr != payload.end() && *rptr != 0xFF) {
+		uint32_t len;
+		if (payload.end() - rptr < sizeof(len)) {
+			throw restore_corrupted_data();
+		}
+		memcpy(&len, rptr, sizeof(len));
+		len = bigEndian32(len);
+		rptr += sizeof(len);
+		if (payload.end() - rptr < (int64_t)len) {
+			throw restore_corrupted_data();
+		}
+		chunks.push_back(CompressionUtils::decompress(filter, StringRef(rptr, len), chunksArena));
+		bytes += chunks.back().size();
+		rptr += len;
+	}
+	for (; rptr != payload.end(); ++rptr) {
+		if (*rptr != 0xFF) {
+			throw restore_corrupted_data_padding();
+		}
+	}
+
+	uint8_t* data = new (arena) uint8_t[bytes];
+	uint8_t* wptr = data;
+	for (const auto& c : chunks) {
+		memcpy(wptr, c.begin(), c.size());
+		wptr += c.size();
+	}
+	return StringRef(data, bytes);
+}
+
+CompressionFilter getBackupCompressionFilter() {
+	CompressionFilter filter = CompressionUtils::fromFilterString(CLIENT_KNOBS->BACKUP_COMPRESSION_FILTER);
+	// Processes built without the filter write uncompressed files rather than fail backups
+	if (!CompressionUtils::supportedFilters.count(filter)) {
+		return CompressionFilter::NONE;
+	}
+	return filter;
+}
+
+// Fills blocks with records of random, somewhat compressible bytes, and checks that each block fits its capacity and
+// decompresses to the records that were added to it
+static void testBlocks(CompressionFilter filter, int capacity) {
+	BackupBlockCompressor compressor(filter, capacity);
+	int64_t uncompressedBytes = 0;
+	int64_t compressedBytes = 0;
+	for (int block = 0; block < 5; ++block) {
+		std::string expected;
+		loop {
+			std::string record(deterministicRandom()->randomInt(0, capacity / 10),
+			                   (char)deterministicRandom()->randomInt(0, 4));
+			if (!record.empty() && deterministicRandom()->coinflip()) {
+				record[deterministicRandom()->randomInt(0, record.size())] = (char)0xFF;
+			}
+			if (!compressor.fits(sizeof(uint32_t) + record.size())) {
+				break;
+			}
+			compressor.appendStringRefWithLen(StringRef(record));
+			uint32_t lenBuf = bigEndian32((uint32_t)record.size());
+			expected.append((const char*)&lenBuf, sizeof(lenBuf));
+			expected.append(record);
+		}
+		ASSERT(!expected.empty() && !compressor.empty());
+
+		const bool pad = deterministicRandom()->coinflip();
+		Standalone<StringRef> payload = compressor.finishBlock(pad);
+		ASSERT(compressor.empty());
+		ASSERT(pad ? payload.size() == capacity : payload.size() <= capacity);
+		ASSERT(decompressBackupBlock(payload, payload.arena()) == StringRef(expected));
+		uncompressedBytes += expected.size();
+		compressedBytes += payload.size();
+		if (filter == CompressionFilter::NONE) {
+			ASSERT(expected.size() <= capacity);
+		}
+	}
+	ASSERT(compressor.getUncompressedBytes() == uncompressedBytes);
+	ASSERT(compressor.getCompressedBytes() == compressedBytes);
+	if (filter != CompressionFilter::NONE) {
+		ASSERT(uncompressedBytes > compressedBytes);
+	}
+}
+
+TEST_CASE("/backup/blockCompression") {
+	for (CompressionFilter filter : CompressionUtils::supportedFilters) {
+		testBlocks(filter, deterministicRandom()->randomInt(1000, 1e6));
+	}
+
+	// Corrupt bytes after the chunks of a block are detected
+	BackupBlockCompressor compressor(CompressionFilter::NONE, 100);
+	compressor.appendStringRefWithLen("key"_sr);
+	Standalone<StringRef> payload = compressor.finishBlock(true);
+	mutateString(payload)[payload.size() - 1] = 0;
+	try {
+		decompressBackupBlock(payload, payload.arena());
+		ASSERT(false);
+	} catch (Error& e) {
+		ASSERT(e.code() == error_code_restore_corrupted_data_padding);
+	}
+	return Void();
+}
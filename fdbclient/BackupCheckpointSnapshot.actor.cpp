@@ -0,0 +1,239 @@
+/*
+ * BackupCheckpointSnapshot.actor.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbclient/BackupCheckpointSnapshot.actor.h"
+
+#include "fdbclient/Knobs.h"
+#include "fdbclient/StorageServerInterface.h"
+#include "fdbclient/SystemData.h"
+
+#include "flow/actorcompiler.h" // has to be last include
+
+std::string checkpointSnapshotFileName(const LiveFileMetaData& file) {
+	return format("%" PRIu64 ",%" PRIu64 ".sst", file.file_number, file.size);
+}
+
+namespace {
+
+// Creates a checkpoint of each shard of ranges for actionId, and returns the version of the checkpoints
+ACTOR Future<Version> createCheckpoints(Database cx, std::vector<KeyRange> ranges, UID actionId) {
+	state Transaction tr(cx);
+	loop {
+		try {
+			tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+			tr.setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+			wait(createCheckpoint(&tr, ranges, DataMoveRocksCF, actionId));
+			wait(tr.commit());
+			return tr.getCommittedVersion();
+		} catch (Error& e) {
+			wait(tr.onError(e));
+		}
+	}
+}
+
+// Deletes the checkpoints created for actionId. Setting their state to Deleting instructs their storage servers to
+// delete the local checkpoint files.
+ACTOR Future<Void> deleteCheckpoints(Database cx, UID actionId) {
+	state Transaction tr(cx);
+	loop {
+		try {
+			tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+			tr.setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+			RangeResult checkpoints = wait(tr.getRange(prefixRange(checkpointPrefix), CLIENT_KNOBS->TOO_MANY));
+			ASSERT(!checkpoints.more && checkpoints.size() < CLIENT_KNOBS->TOO_MANY);
+			for (const auto& kv : checkpoints) {
+				CheckpointMetaData checkpoint = decodeCheckpointValue(kv.value);
+				if (checkpoint.actionId != actionId) {
+					continue;
+				}
+				checkpoint.setState(CheckpointMetaData::Deleting);
+				tr.set(kv.key, checkpointValue(checkpoint));
+				tr.clear(singleKeyRange(kv.key));
+			}
+			wait(tr.commit());
+			return Void();
+		} catch (Error& e) {
+			wait(tr.onError(e));
+		}
+	}
+}
+
+ACTOR Future<StorageServerInterface> getStorageServer(Database cx, UID serverID) {
+	state Transaction tr(cx);
+	loop {
+		try {
+			tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+			tr.setOption(FDBTransactionOptions::READ_SYSTEM_KEYS);
+			Optional<Value> ss = wait(tr.get(serverListKeyFor(serverID)));
+			if (!ss.present()) {
+				throw checkpoint_not_found();
+			}
+			return decodeServerListValue(ss.get());
+		} catch (Error& e) {
+			wait(tr.onError(e));
+		}
+	}
+}
+
+// Streams file of checkpoint checkpointID from storage server ssi into a checkpoint file of bc, and returns the path of
+// the container file
+ACTOR Future<std::string> uploadCheckpointFile(Reference<IBackupContainer> bc,
+                                               StorageServerInterface ssi,
+                                               UID checkpointID,
+                                               LiveFileMetaData file) {
+	state int attempt = 0;
+	loop {
+		state Reference<IBackupFile> outFile =
+		    wait(bc->writeCheckpointFile(ssi.id(), checkpointSnapshotFileName(file)));
+		state Optional<Error> error;
+		try {
+			state ReplyPromiseStream<FetchCheckpointReply> stream =
+			    ssi.fetchCheckpoint.getReplyStream(FetchCheckpointRequest(checkpointID, file.name));
+			loop {
+				state FetchCheckpointReply rep = waitNext(stream.getFuture());
+				wait(outFile->append(rep.data.begin(), rep.data.size()));
+			}
+		} catch (Error& e) {
+			if (e.code() == error_code_actor_cancelled) {
+				throw;
+			}
+			if (e.code() != error_code_end_of_stream) {
+				error = e;
+			} else if (outFile->size() != file.size) {
+				error = backup_error();
+			}
+		}
+
+		if (!error.present()) {
+			wait(outFile->finish());
+			return outFile->getFileName();
+		}
+		TraceEvent(SevWarn, "CheckpointSnapshotFileError")
+		    .error(error.get())
+		    .detail("CheckpointID", checkpointID)
+		    .detail("StorageServer", ssi.id())
+		    .detail("File", file.name)
+		    .detail("FileSize", file.size)
+		    .detail("BytesReceived", outFile->size())
+		    .detail("Attempt", attempt);
+		if (++attempt >= CLIENT_KNOBS->BACKUP_CHECKPOINT_FILE_ATTEMPTS) {
+			throw error.get();
+		}
+	}
+}
+
+} // namespace
+
+ACTOR Future<CheckpointSnapshotManifest> writeCheckpointSnapshot(Database cx,
+                                                                 Reference<IBackupContainer> bc,
+                                                                 std::vector<KeyRange> ranges) {
+	state UID actionId = deterministicRandom()->randomUniqueID();
+	state CheckpointSnapshotManifest manifest;
+	state std::vector<std::pair<KeyRange, CheckpointMetaData>> records;
+	// Paths of the container files of each storage server, by file name
+	state std::map<UID, std::map<std::string, std::string>> serverFiles;
+	state int i = 0;
+	state int j = 0;
+	manifest.ranges = ranges;
+
+	TraceEvent("CheckpointSnapshotBegin").detail("ActionID", actionId).detail("Ranges", describe(ranges));
+	try {
+		wait(store(manifest.version, createCheckpoints(cx, ranges, actionId)));
+
+		// Storage servers create their checkpoints once the version is durable
+		state double deadline = now() + CLIENT_KNOBS->BACKUP_CHECKPOINT_TIMEOUT;
+		loop {
+			try {
+				wait(store(records, getCheckpointMetaData(cx, ranges, manifest.version, DataMoveRocksCF, actionId)));
+				break;
+			} catch (Error& e) {
+				if (e.code() == error_code_actor_cancelled || now() > deadline) {
+					throw;
+				}
+				TraceEvent(SevDebug, "CheckpointSnapshotMetaDataRetry")
+				    .errorUnsuppressed(e)
+				    .detail("ActionID", actionId)
+				    .detail("Version", manifest.version);
+			}
+			wait(delay(1.0));
+		}
+
+		for (i = 0; i < records.size(); ++i) {
+			state CheckpointMetaData checkpoint = records[i].second;
+			ASSERT(checkpoint.src.size() == 1);
+			state UID serverID = checkpoint.src.front();
+			state StorageServerInterface ssi = wait(getStorageServer(cx, serverID));
+			if (!serverFiles.count(serverID)) {
+				std::vector<std::string> paths = wait(bc->listCheckpointFiles(serverID));
+				auto& files = serverFiles[serverID];
+				for (const auto& path : paths) {
+					files[path.substr(path.find_last_of('/') + 1)] = path;
+				}
+			}
+
+			state RocksDBColumnFamilyCheckpoint rocksCF =
+			    ObjectReader::fromStringRef<RocksDBColumnFamilyCheckpoint>(checkpoint.serializedCheckpoint,
+			                                                               IncludeVersion());
+			for (j = 0; j < rocksCF.sstFiles.size(); ++j) {
+				state std::string name = checkpointSnapshotFileName(rocksCF.sstFiles[j]);
+				state std::string path;
+				auto it = serverFiles[serverID].find(name);
+				if (it != serverFiles[serverID].end()) {
+					path = it->second;
+					manifest.reusedBytes += rocksCF.sstFiles[j].size;
+				} else {
+					wait(store(path, uploadCheckpointFile(bc, ssi, checkpoint.checkpointID, rocksCF.sstFiles[j])));
+					serverFiles[serverID][name] = path;
+					manifest.uploadedBytes += rocksCF.sstFiles[j].size;
+				}
+
+				LiveFileMetaData& file = rocksCF.sstFiles[j];
+				file.relative_filename = name;
+				file.name = "/" + name;
+				file.directory = path.substr(0, path.size() - file.name.size());
+				file.db_path = file.directory;
+				file.fetched = false;
+			}
+			checkpoint.serializedCheckpoint = ObjectWriter::toValue(rocksCF, IncludeVersion());
+			checkpoint.bytesSampleFile.reset();
+			manifest.checkpoints.push_back(checkpoint);
+		}
+
+		wait(bc->writeCheckpointSnapshotManifest(manifest.version,
+		                                         ObjectWriter::toValue(manifest, IncludeVersion()).toString()));
+	} catch (Error& e) {
+		if (e.code() == error_code_actor_cancelled) {
+			throw;
+		}
+		state Error err = e;
+		TraceEvent(SevWarn, "CheckpointSnapshotFailed").error(err).detail("ActionID", actionId);
+		wait(deleteCheckpoints(cx, actionId));
+		throw err;
+	}
+	wait(deleteCheckpoints(cx, actionId));
+
+	TraceEvent("CheckpointSnapshotEnd")
+	    .detail("ActionID", actionId)
+	    .detail("Version", manifest.version)
+	    .detail("Checkpoints", manifest.checkpoints.size())
+	    .detail("UploadedBytes", manifest.uploadedBytes)
+	    .detail("ReusedBytes", manifest.reusedBytes);
+	return manifest;
+}
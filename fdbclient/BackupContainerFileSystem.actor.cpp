@@ -1226,6 +1226,25 @@ Future<Void> BackupContainerFileSystem::writeKeyspaceSnapshotFile(const std::vec
 	    Reference<BackupContainerFileSystem>::addRef(this), fileNames, beginEndKeys, totalBytes, includeKeyRangeMap);
 };
 
+Future<Reference<IBackupFile>> BackupContainerFileSystem::writeCheckpointFile(UID serverID,
+                                                                              const std::string& fileName) {
+	return writeFile(format("checkpoints/%s/%s", serverID.toString().c_str(), fileName.c_str()));
+}
+
+Future<std::vector<std::string>> BackupContainerFileSystem::listCheckpointFiles(UID serverID) {
+	return map(listFiles(format("checkpoints/%s/", serverID.toString().c_str())), [=](const FilesAndSizesT& files) {
+		std::vector<std::string> results;
+		for (auto& f : files) {
+			results.push_back(f.first);
+		}
+		return results;
+	});
+}
+
+Future<Void> BackupContainerFileSystem::writeCheckpointSnapshotManifest(Version version, const std::string& manifest) {
+	return writeEntireFile(format("checkpoint_snapshots/snapshot,%" PRId64, version), manifest);
+}
+
 Future<std::vector<LogFile>> BackupContainerFileSystem::listLogFiles(Version beginVersion,
                                                                      Version targetVersion,
                                                                      bool partitioned) {
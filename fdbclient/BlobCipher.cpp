@@ -962,6 +962,15 @@ void EncryptBlobCipherAes265Ctr::init() {
 	}
 }
 
+void EncryptBlobCipherAes265Ctr::setIV(const uint8_t* cipherIV, const int ivLen) {
+	ASSERT_EQ(ivLen, AES_256_IV_LENGTH);
+	memcpy(&iv[0], cipherIV, ivLen);
+	// A null cipher and key keep the ones set by init(), and a new IV restarts the CTR keystream
+	if (EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, iv) != 1) {
+		throw encrypt_ops_error();
+	}
+}
+
 template <class Params>
 void EncryptBlobCipherAes265Ctr::setCipherAlgoHeaderWithAuthV1(const uint8_t* ciphertext,
                                                                const int ciphertextLen,
@@ -1738,7 +1747,7 @@ DecryptBlobCipherAes256Ctr::~DecryptBlobCipherAes256Ctr() {
 
 // HmacSha256DigestGen class methods
 
-HmacSha256DigestGen::HmacSha256DigestGen(const unsigned char* key, size_t len) : ctx(HMAC_CTX_new()) {
+HmacSha256DigestGen::HmacSha256DigestGen(const unsigned char* key, size_t len) : ctx(HMAC_CTX_new()), finished(false) {
 	if (!HMAC_Init_ex(ctx, key, len, EVP_sha256(), nullptr)) {
 		throw encrypt_ops_error();
 	}
@@ -1755,6 +1764,11 @@ unsigned int HmacSha256DigestGen::digest(const std::vector<std::pair<const uint8
                                          unsigned int bufLen) {
 	ASSERT_EQ(bufLen, HMAC_size(ctx));
 
+	// A null key restarts the digest with the key the context was initialized with
+	if (finished && HMAC_Init_ex(ctx, nullptr, 0, nullptr, nullptr) != 1) {
+		throw encrypt_ops_error();
+	}
+	finished = true;
 	for (const auto& p : payload) {
 		if (HMAC_Update(ctx, p.first, p.second) != 1) {
 			throw encrypt_ops_error();
@@ -1772,7 +1786,8 @@ unsigned int HmacSha256DigestGen::digest(const std::vector<std::pair<const uint8
 }
 
 // Aes256CtrCmacDigestGen methods
-Aes256CmacDigestGen::Aes256CmacDigestGen(const unsigned char* key, size_t keylen) : ctx(CMAC_CTX_new()) {
+Aes256CmacDigestGen::Aes256CmacDigestGen(const unsigned char* key, size_t keylen)
+  : ctx(CMAC_CTX_new()), finished(false) {
 	ASSERT_EQ(keylen, AES_256_KEY_LENGTH);
 
 	if (ctx == nullptr) {
@@ -1789,6 +1804,11 @@ size_t Aes256CmacDigestGen::digest(const std::vector<std::pair<const uint8_t*, s
 	ASSERT(ctx != nullptr);
 	ASSERT_GE(digestlen, AUTH_TOKEN_AES_CMAC_SIZE);
 
+	// A null key restarts the digest with the key the context was initialized with
+	if (finished && !CMAC_Init(ctx, nullptr, 0, nullptr, nullptr)) {
+		throw encrypt_ops_error();
+	}
+	finished = true;
 	for (const auto& p : payload) {
 		if (!CMAC_Update(ctx, p.first, p.second)) {
 			throw encrypt_ops_error();
@@ -1808,6 +1828,21 @@ Aes256CmacDigestGen::~Aes256CmacDigestGen() {
 	}
 }
 
+// Nearly all auth tokens of a process are computed with the few header cipher keys of its cluster, so each thread
+// keeps the digest context of the last key it used for each algorithm rather than initializing one for every token.
+template <class DigestGen>
+static DigestGen& getCachedDigestGen(const uint8_t* key, const int keyLen) {
+	ASSERT_EQ(keyLen, AES_256_KEY_LENGTH);
+	thread_local uint8_t cachedKey[AES_256_KEY_LENGTH];
+	thread_local std::unique_ptr<DigestGen> digestGen;
+	if (!digestGen || memcmp(cachedKey, key, keyLen) != 0) {
+		digestGen.reset();
+		digestGen = std::make_unique<DigestGen>(key, keyLen);
+		memcpy(cachedKey, key, keyLen);
+	}
+	return *digestGen;
+}
+
 void computeAuthToken(const std::vector<std::pair<const uint8_t*, size_t>>& payload,
                       const uint8_t* key,
                       const int keyLen,
@@ -1824,15 +1859,15 @@ void computeAuthToken(const std::vector<std::pair<const uint8_t*, size_t>>& payl
 	if (algo == EncryptAuthTokenAlgo::ENCRYPT_HEADER_AUTH_TOKEN_ALGO_HMAC_SHA) {
 		ASSERT_EQ(authTokenSz, AUTH_TOKEN_HMAC_SHA_SIZE);
 
-		HmacSha256DigestGen hmacGenerator(key, keyLen);
-		unsigned int digestLen = hmacGenerator.digest(payload, digestBuf, authTokenSz);
+		unsigned int digestLen =
+		    getCachedDigestGen<HmacSha256DigestGen>(key, keyLen).digest(payload, digestBuf, authTokenSz);
 
 		ASSERT_EQ(digestLen, authTokenSz);
 	} else if (algo == EncryptAuthTokenAlgo::ENCRYPT_HEADER_AUTH_TOKEN_ALGO_AES_CMAC) {
 		ASSERT_EQ(authTokenSz, AUTH_TOKEN_AES_CMAC_SIZE);
 
-		Aes256CmacDigestGen cmacGenerator(key, keyLen);
-		size_t digestLen = cmacGenerator.digest(payload, digestBuf, authTokenSz);
+		size_t digestLen =
+		    getCachedDigestGen<Aes256CmacDigestGen>(key, keyLen).digest(payload, digestBuf, authTokenSz);
 
 		ASSERT_EQ(digestLen, authTokenSz);
 	} else {
@@ -3055,6 +3090,76 @@ void testEncryptInplaceSingleAuthMode(const int minDomainId) {
 	TraceEvent("BlobCipherTestEncryptInplaceSingleAuthEnd").detail("Mode", authAlgoStr);
 }
 
+// Encrypts texts with one encryptor and a new IV for each, and checks that each ciphertext is the one an encryptor
+// created with that IV produces, and that it decrypts with the IV in its header
+void testEncryptSetIV(const int minDomainId) {
+	TraceEvent("BlobCipherTestEncryptSetIVStart");
+
+	Reference<BlobCipherKeyCache> cipherKeyCache = BlobCipherKeyCache::getInstance();
+	Reference<BlobCipherKey> cipherKey = cipherKeyCache->getLatestCipherKey(minDomainId);
+	Reference<BlobCipherKey> headerCipherKey = cipherKeyCache->getLatestCipherKey(ENCRYPT_HEADER_DOMAIN_ID);
+	Arena arena;
+	uint8_t iv[AES_256_IV_LENGTH];
+	deterministicRandom()->randomBytes(&iv[0], AES_256_IV_LENGTH);
+
+	EncryptBlobCipherAes265Ctr encryptor(cipherKey,
+	                                     headerCipherKey,
+	                                     iv,
+	                                     AES_256_IV_LENGTH,
+	                                     EncryptAuthTokenMode::ENCRYPT_HEADER_AUTH_TOKEN_MODE_SINGLE,
+	                                     BlobCipherMetrics::TEST);
+	for (int i = 0; i < 5; i++) {
+		if (i > 0) {
+			deterministicRandom()->randomBytes(&iv[0], AES_256_IV_LENGTH);
+			encryptor.setIV(iv, AES_256_IV_LENGTH);
+		}
+		const int bufLen = deterministicRandom()->randomInt(1, 2127);
+		uint8_t orgData[bufLen];
+		deterministicRandom()->randomBytes(&orgData[0], bufLen);
+
+		BlobCipherEncryptHeaderRef headerRef;
+		StringRef encrypted = encryptor.encrypt(&orgData[0], bufLen, &headerRef, arena);
+
+		EncryptBlobCipherAes265Ctr expectedEncryptor(cipherKey,
+		                                             headerCipherKey,
+		                                             iv,
+		                                             AES_256_IV_LENGTH,
+		                                             EncryptAuthTokenMode::ENCRYPT_HEADER_AUTH_TOKEN_MODE_SINGLE,
+		                                             BlobCipherMetrics::TEST);
+		BlobCipherEncryptHeaderRef expectedHeaderRef;
+		StringRef expected = expectedEncryptor.encrypt(&orgData[0], bufLen, &expectedHeaderRef, arena);
+		ASSERT(encrypted == expected);
+
+		ASSERT_EQ(memcmp(headerRef.getIV(), &iv[0], AES_256_IV_LENGTH), 0);
+
+		DecryptBlobCipherAes256Ctr decryptor(cipherKey, headerCipherKey, headerRef.getIV(), BlobCipherMetrics::TEST);
+		StringRef decrypted = decryptor.decrypt(encrypted.begin(), bufLen, headerRef, arena);
+		ASSERT(decrypted == StringRef(&orgData[0], bufLen));
+	}
+
+	TraceEvent("BlobCipherTestEncryptSetIVDone");
+}
+
+// Checks that a digest generator computes the same digests when reused as new generators do
+template <class DigestGen>
+void testDigestGenReuse() {
+	uint8_t key[AES_256_KEY_LENGTH];
+	deterministicRandom()->randomBytes(&key[0], AES_256_KEY_LENGTH);
+	DigestGen reused(&key[0], AES_256_KEY_LENGTH);
+	for (int i = 0; i < 3; i++) {
+		const int len = deterministicRandom()->randomInt(0, 2000);
+		uint8_t data[len + 1];
+		deterministicRandom()->randomBytes(&data[0], len);
+		uint8_t digest[AUTH_TOKEN_HMAC_SHA_SIZE];
+		uint8_t expected[AUTH_TOKEN_HMAC_SHA_SIZE];
+		const int digestLen = std::is_same_v<DigestGen, HmacSha256DigestGen> ? AUTH_TOKEN_HMAC_SHA_SIZE
+		                                                                      : AUTH_TOKEN_AES_CMAC_SIZE;
+		reused.digest({ { &data[0], len } }, &digest[0], digestLen);
+		DigestGen(&key[0], AES_256_KEY_LENGTH).digest({ { &data[0], len } }, &expected[0], digestLen);
+		ASSERT_EQ(memcmp(&digest[0], &expected[0], digestLen), 0);
+	}
+}
+
 void testConfigurableEncryptionInvalidEncryptionKeyNoAuth(const int minDomainId) {
 	TraceEvent("TestConfigurableEncryptionInvalidEncryptKeyNoAuthStart");
 
@@ -3243,6 +3348,9 @@ TEST_CASE("/blobCipher") {
 	testEncryptInplaceNoAuthMode(minDomainId);
 	testEncryptInplaceSingleAuthMode<AesCtrWithHmacParams>(minDomainId);
 	testEncryptInplaceSingleAuthMode<AesCtrWithCmacParams>(minDomainId);
+	testEncryptSetIV(minDomainId);
+	testDigestGenReuse<HmacSha256DigestGen>();
+	testDigestGenReuse<Aes256CmacDigestGen>();
 
 	testKeyCacheCleanup(minDomainId, maxDomainId);
 
@@ -0,0 +1,110 @@
+/*
+ * BlobGranuleFileCache.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbclient/BlobGranuleFileCache.h"
+
+#include "fdbclient/Knobs.h"
+#include "flow/UnitTest.h"
+
+// Approximate memory used by an entry besides its file name and bytes
+static constexpr int64_t entryOverhead = 128;
+
+static int64_t entryBytes(StringRef filename, StringRef bytes) {
+	return filename.size() + bytes.size() + entryOverhead;
+}
+
+BlobGranuleFileCache& BlobGranuleFileCache::global() {
+	static BlobGranuleFileCache cache(CLIENT_KNOBS->BG_CLIENT_FILE_CACHE_BYTES);
+	return cache;
+}
+
+Optional<Standalone<StringRef>> BlobGranuleFileCache::get(StringRef filename, int64_t offset) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = entries.find(Location(filename, offset));
+	if (it == entries.end()) {
+		return Optional<Standalone<StringRef>>();
+	}
+	lru.splice(lru.end(), lru, it->second.lruPosition);
+	return it->second.bytes;
+}
+
+void BlobGranuleFileCache::insert(StringRef filename, int64_t offset, Standalone<StringRef> value) {
+	const int64_t size = entryBytes(filename, value);
+	if (size > capacityBytes) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	Location location(filename, offset);
+	auto it = entries.find(location);
+	if (it != entries.end()) {
+		erase(it);
+	}
+	while (bytes + size > capacityBytes) {
+		erase(entries.find(lru.front()));
+	}
+	auto lruPosition = lru.insert(lru.end(), location);
+	entries.emplace(location, Entry{ value, lruPosition });
+	bytes += size;
+}
+
+int64_t BlobGranuleFileCache::getBytes() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return bytes;
+}
+
+int64_t BlobGranuleFileCache::getCount() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries.size();
+}
+
+void BlobGranuleFileCache::erase(std::map<Location, Entry>::iterator it) {
+	bytes -= entryBytes(it->first.first, it->second.bytes);
+	lru.erase(it->second.lruPosition);
+	entries.erase(it);
+}
+
+TEST_CASE("/fdbclient/BlobGranuleFileCache/eviction") {
+	const Standalone<StringRef> chunk = makeString(100);
+	const int64_t size = entryBytes("f"_sr, chunk);
+	BlobGranuleFileCache cache(size * 3);
+
+	cache.insert("f"_sr, 0, chunk);
+	cache.insert("f"_sr, 100, chunk);
+	cache.insert("g"_sr, 0, chunk);
+	ASSERT(cache.get("f"_sr, 0).present() && cache.get("f"_sr, 100).present() && cache.get("g"_sr, 0).present());
+	ASSERT(!cache.get("f"_sr, 200).present() && !cache.get("h"_sr, 0).present());
+
+	// Using ("f", 0) makes ("f", 100) the least recently used range
+	ASSERT(cache.get("f"_sr, 0).get() == chunk);
+	cache.insert("g"_sr, 100, chunk);
+	ASSERT(cache.getCount() == 3 && cache.getBytes() == size * 3);
+	ASSERT(!cache.get("f"_sr, 100).present());
+	ASSERT(cache.get("f"_sr, 0).present() && cache.get("g"_sr, 100).present());
+
+	// Ranges larger than the cache are not cached, and a disabled cache caches nothing
+	cache.insert("h"_sr, 0, makeString(size * 3));
+	ASSERT(!cache.get("h"_sr, 0).present() && cache.getCount() == 3);
+	BlobGranuleFileCache disabled(0);
+	ASSERT(!disabled.enabled());
+	disabled.insert("f"_sr, 0, chunk);
+	ASSERT(disabled.getCount() == 0);
+	return Void();
+}
@@ -22,10 +22,12 @@
 
 #include "fdbclient/BlobCipher.h"
 #include "fdbclient/BlobGranuleCommon.h"
+#include "fdbclient/BlobGranuleFileCache.h"
 #include "fdbclient/ClientKnobs.h"
 #include "fdbclient/CommitTransaction.h"
 #include "fdbclient/Knobs.h"
 #include "fdbclient/SystemData.h" // for allKeys unit test - could remove
+#include "fdbclient/Tuple.h"
 
 #include "flow/Arena.h"
 #include "flow/CompressionUtils.h"
@@ -53,13 +55,17 @@
 // File Format stuff
 
 // Version info for file format of chunked files.
-uint16_t LATEST_BG_FORMAT_VERSION = 1;
+uint16_t LATEST_BG_FORMAT_VERSION = 2;
 uint16_t MIN_SUPPORTED_BG_FORMAT_VERSION = 1;
+// Columnar snapshot files need format version 2. Other files are still written with version 1, so that they remain
+// readable by older readers.
+const uint16_t COLUMNAR_BG_FORMAT_VERSION = 2;
 
 // TODO combine with SystemData? These don't actually have to match though
 
 const uint8_t SNAPSHOT_FILE_TYPE = 'S';
 const uint8_t DELTA_FILE_TYPE = 'D';
+const uint8_t COLUMNAR_SNAPSHOT_FILE_TYPE = 'C';
 
 // Deltas in key order
 
@@ -166,6 +172,40 @@ struct GranuleSortedDeltas {
 	}
 };
 
+// One column of a chunk of a columnar snapshot file: an element for each row of the chunk, compressed on its own so it
+// can be read without the other columns, and the smallest and largest elements in it.
+struct SnapshotColumnRef {
+	StringRef minElement;
+	StringRef maxElement;
+	// IndexBlobGranuleFileChunkRef bytes of the elements, as a VectorRef<StringRef>
+	StringRef block;
+
+	SnapshotColumnRef() {}
+	SnapshotColumnRef(Arena& ar, const SnapshotColumnRef& copyFrom)
+	  : minElement(ar, copyFrom.minElement), maxElement(ar, copyFrom.maxElement), block(ar, copyFrom.block) {}
+
+	int expectedSize() const { return minElement.expectedSize() + maxElement.expectedSize() + block.expectedSize(); }
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, minElement, maxElement, block);
+	}
+};
+
+// A chunk of a columnar snapshot file. columns[0] holds the keys, columns[1] the values that are not tuples, and
+// columns[i + 2] element i of the values that are tuples, as packed by the tuple layer. Rows without an element in a
+// column have an empty one, since no packed tuple element is empty.
+struct SnapshotColumnsChunkRef {
+	constexpr static FileIdentifier file_identifier = 5105197;
+
+	VectorRef<SnapshotColumnRef> columns;
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, columns);
+	}
+};
+
 struct ChildBlockPointerRef {
 	StringRef key;
 	uint32_t offset;
@@ -588,7 +628,8 @@ struct IndexedBlobGranuleFile {
 	StringRef fileBytes;
 
 	void init(uint8_t fType, const Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx) {
-		formatVersion = LATEST_BG_FORMAT_VERSION;
+		formatVersion =
+		    fType == COLUMNAR_SNAPSHOT_FILE_TYPE ? COLUMNAR_BG_FORMAT_VERSION : MIN_SUPPORTED_BG_FORMAT_VERSION;
 		fileType = fType;
 		chunkStartOffset = -1;
 	}
@@ -619,11 +660,39 @@ struct IndexedBlobGranuleFile {
 			    .detail("LatestSupported", LATEST_BG_FORMAT_VERSION);
 			throw unsupported_format_version();
 		}
-		ASSERT(file.fileType == SNAPSHOT_FILE_TYPE || file.fileType == DELTA_FILE_TYPE);
+		ASSERT(file.fileType == SNAPSHOT_FILE_TYPE || file.fileType == DELTA_FILE_TYPE ||
+		       file.fileType == COLUMNAR_SNAPSHOT_FILE_TYPE);
 
 		return Standalone<IndexedBlobGranuleFile>(file, arena);
 	}
 
+	// Returns where the chunks of a file start, from the header at its start, without reading its index. Only the
+	// header has to be in fileBytes, as long as anything after it that the header would refer to reads as zeros.
+	static int chunkStartOffsetFromBytes(const StringRef& fileBytes) {
+		Arena arena;
+		IndexedBlobGranuleFile file;
+		ObjectReader dataReader(fileBytes.begin(), IncludeVersion());
+		dataReader.deserialize(FileIdentifierFor<IndexedBlobGranuleFile>::value, file, arena);
+		return file.chunkStartOffset;
+	}
+
+	// Returns the indexes [begin, end) of the blocks that are read to read keyRange from the file
+	std::pair<int, int> blocksForRange(const KeyRangeRef& keyRange) const {
+		const auto& children = indexBlockRef.block.children;
+		if (children.empty()) {
+			return { 0, 0 };
+		}
+		const ChildBlockPointerRef* startBlock = findStartBlock(keyRange.begin);
+		if (startBlock == children.end() - 1 || keyRange.end <= startBlock->key) {
+			return { 0, 0 };
+		}
+		const ChildBlockPointerRef* endBlock = startBlock + 1;
+		while (endBlock != children.end() - 1 && endBlock->key < keyRange.end) {
+			endBlock++;
+		}
+		return { startBlock - children.begin(), endBlock - children.begin() };
+	}
+
 	ChildBlockPointerRef* findStartBlock(const KeyRef& beginKey) const {
 		ChildBlockPointerRef searchKey(beginKey, 0);
 		ChildBlockPointerRef* startBlock = (ChildBlockPointerRef*)std::lower_bound(indexBlockRef.block.children.begin(),
@@ -726,15 +795,217 @@ Value serializeFileFromChunks(Standalone<IndexedBlobGranuleFile>& file,
 	return Standalone<StringRef>(StringRef(bufferStart, size), ret);
 }
 
+// Splits value into its tuple elements, or returns false if it is not a tuple
+static bool splitTupleElements(const ValueRef& value, std::vector<StringRef>& elements) {
+	elements.clear();
+	try {
+		Tuple t = Tuple::unpackView(value);
+		for (int i = 0; i < t.size(); i++) {
+			elements.push_back(t.subTupleRawString(i));
+		}
+		return true;
+	} catch (Error& e) {
+		if (e.code() != error_code_invalid_tuple_data_type) {
+			throw;
+		}
+		elements.clear();
+		return false;
+	}
+}
+
+static Value serializeColumnarChunk(const GranuleSnapshot& rows,
+                                    Optional<CompressionFilter> compressFilter,
+                                    Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx,
+                                    Arena& arena) {
+	// keys and values that are not tuples, then one column per tuple element
+	std::vector<Standalone<VectorRef<StringRef>>> columns(2);
+	std::vector<StringRef> elements;
+	for (int row = 0; row < rows.size(); row++) {
+		bool isTuple = splitTupleElements(rows[row].value, elements);
+		columns[0].push_back(columns[0].arena(), rows[row].key);
+		columns[1].push_back(columns[1].arena(), isTuple ? StringRef() : rows[row].value);
+		while (columns.size() < elements.size() + 2) {
+			// rows before this one don't have this element
+			columns.emplace_back().resize(columns.back().arena(), row);
+		}
+		for (int c = 2; c < columns.size(); c++) {
+			columns[c].push_back(columns[c].arena(), c - 2 < elements.size() ? elements[c - 2] : StringRef());
+		}
+	}
+
+	Standalone<SnapshotColumnsChunkRef> chunk;
+	for (auto& column : columns) {
+		SnapshotColumnRef& columnRef = chunk.columns.emplace_back(chunk.arena());
+		bool anyElements = false;
+		for (auto& element : column) {
+			if (element.empty()) {
+				continue;
+			}
+			if (!anyElements || element < columnRef.minElement) {
+				columnRef.minElement = element;
+			}
+			if (!anyElements || element > columnRef.maxElement) {
+				columnRef.maxElement = element;
+			}
+			anyElements = true;
+		}
+		columnRef.minElement = StringRef(chunk.arena(), columnRef.minElement);
+		columnRef.maxElement = StringRef(chunk.arena(), columnRef.maxElement);
+
+		Value serialized = BinaryWriter::toValue(column, IncludeVersion(ProtocolVersion::withBlobGranuleFile()));
+		// the chunk as a whole is encrypted, which also covers the element stats
+		Value block = IndexBlobGranuleFileChunkRef::toBytes({}, compressFilter, serialized, chunk.arena());
+		columnRef.block = StringRef(chunk.arena(), block);
+	}
+
+	Value serialized = BinaryWriter::toValue(chunk, IncludeVersion(ProtocolVersion::withBlobGranuleFile()));
+	return IndexBlobGranuleFileChunkRef::toBytes(cipherKeysCtx, {}, serialized, arena);
+}
+
 // TODO: this should probably be in actor file with yields? - move writing logic to separate actor file in server?
 // TODO: optimize memory copying
 // TODO: sanity check no oversized files
-Value serializeChunkedSnapshot(const Standalone<StringRef>& fileNameRef,
-                               const Standalone<GranuleSnapshot>& snapshot,
-                               int targetChunkBytes,
-                               Optional<CompressionFilter> compressFilter,
-                               Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx,
-                               bool isSnapshotSorted) {
+struct SnapshotFileBuilderImpl {
+	int targetChunkBytes;
+	Optional<CompressionFilter> compressFilter;
+	Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx;
+	uint8_t fileType;
+	bool isSnapshotSorted;
+
+	Standalone<IndexedBlobGranuleFile> file;
+	std::vector<Value> chunks;
+	Standalone<GranuleSnapshot> currentChunk;
+	size_t currentChunkBytesEstimate = 0;
+	size_t previousChunkBytes = 0;
+	int64_t rows = 0;
+	int64_t logicalBytes = 0;
+
+	SnapshotFileBuilderImpl(int targetChunkBytes,
+	                        Optional<CompressionFilter> compressFilter,
+	                        Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx,
+	                        uint8_t fileType,
+	                        bool isSnapshotSorted)
+	  : targetChunkBytes(targetChunkBytes), compressFilter(compressFilter), cipherKeysCtx(cipherKeysCtx),
+	    fileType(fileType), isSnapshotSorted(isSnapshotSorted) {
+		file.init(fileType, cipherKeysCtx);
+		chunks.push_back(Value()); // dummy value for index block
+	}
+
+	void writeChunk() {
+		Value chunkBytes;
+		if (fileType == COLUMNAR_SNAPSHOT_FILE_TYPE) {
+			chunkBytes = serializeColumnarChunk(currentChunk, compressFilter, cipherKeysCtx, file.arena());
+		} else {
+			Value serialized =
+			    BinaryWriter::toValue(currentChunk, IncludeVersion(ProtocolVersion::withBlobGranuleFile()));
+			chunkBytes = IndexBlobGranuleFileChunkRef::toBytes(cipherKeysCtx, compressFilter, serialized, file.arena());
+		}
+		chunks.push_back(chunkBytes);
+		// TODO remove validation
+		if (!file.indexBlockRef.block.children.empty() && isSnapshotSorted) {
+			ASSERT(file.indexBlockRef.block.children.back().key < currentChunk.begin()->key);
+		}
+		file.indexBlockRef.block.children.emplace_back_deep(
+		    file.arena(), currentChunk.begin()->key, previousChunkBytes);
+
+		if (BG_ENCRYPT_COMPRESS_DEBUG) {
+			TraceEvent(SevDebug, "ChunkSize")
+			    .detail("ChunkBytes", chunkBytes.size())
+			    .detail("PrvChunkBytes", previousChunkBytes);
+		}
+
+		previousChunkBytes += chunkBytes.size();
+		currentChunkBytesEstimate = 0;
+		currentChunk = Standalone<GranuleSnapshot>();
+	}
+
+	void add(const KeyValueRef& row) {
+		if (!currentChunk.empty()) {
+			// TODO REMOVE sanity check
+			if (isSnapshotSorted) {
+				ASSERT(currentChunk.back().key < row.key);
+			}
+			if (currentChunkBytesEstimate >= targetChunkBytes) {
+				writeChunk();
+			}
+		}
+		currentChunk.push_back_deep(currentChunk.arena(), row);
+		currentChunkBytesEstimate += row.expectedSize();
+		rows++;
+		logicalBytes += sizeof(KeyValueRef) + row.expectedSize();
+	}
+
+	Value finish() {
+		// push back dummy last chunk to get last chunk size, and to know last key in last block without having to read
+		// it
+		if (!currentChunk.empty()) {
+			Key lastKey = keyAfter(currentChunk.back().key);
+			writeChunk();
+			file.indexBlockRef.block.children.emplace_back_deep(file.arena(), lastKey, previousChunkBytes);
+		}
+		return serializeFileFromChunks(file, cipherKeysCtx, chunks, previousChunkBytes);
+	}
+
+	Key middleKey() const {
+		// chunks that were written are represented by their first keys
+		const auto& chunkKeys = file.indexBlockRef.block.children;
+		int count = chunkKeys.size() + currentChunk.size();
+		ASSERT(count > 0);
+		int middle = count / 2;
+		if (middle < chunkKeys.size()) {
+			return chunkKeys[middle].key;
+		}
+		return currentChunk[middle - chunkKeys.size()].key;
+	}
+};
+
+SnapshotFileBuilder::SnapshotFileBuilder() = default;
+
+SnapshotFileBuilder::SnapshotFileBuilder(int chunkSize,
+                                         Optional<CompressionFilter> compressFilter,
+                                         Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx,
+                                         bool columnar,
+                                         bool isSnapshotSorted)
+  : impl(PImpl<SnapshotFileBuilderImpl>::create(chunkSize,
+                                                compressFilter,
+                                                cipherKeysCtx,
+                                                columnar ? COLUMNAR_SNAPSHOT_FILE_TYPE : SNAPSHOT_FILE_TYPE,
+                                                isSnapshotSorted)) {
+	CODE_PROBE(compressFilter.present(), "serializing compressed snapshot file");
+	CODE_PROBE(cipherKeysCtx.present(), "serializing encrypted snapshot file");
+}
+
+SnapshotFileBuilder::SnapshotFileBuilder(SnapshotFileBuilder&&) = default;
+SnapshotFileBuilder& SnapshotFileBuilder::operator=(SnapshotFileBuilder&&) = default;
+SnapshotFileBuilder::~SnapshotFileBuilder() = default;
+
+void SnapshotFileBuilder::add(const KeyValueRef& row) {
+	impl->add(row);
+}
+
+Value SnapshotFileBuilder::finish() {
+	return impl->finish();
+}
+
+int64_t SnapshotFileBuilder::getRows() const {
+	return impl->rows;
+}
+
+int64_t SnapshotFileBuilder::getLogicalBytes() const {
+	return impl->logicalBytes;
+}
+
+Key SnapshotFileBuilder::middleKey() const {
+	return impl->middleKey();
+}
+
+static Value serializeSnapshotFile(const Standalone<StringRef>& fileNameRef,
+                                   const Standalone<GranuleSnapshot>& snapshot,
+                                   int targetChunkBytes,
+                                   Optional<CompressionFilter> compressFilter,
+                                   Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx,
+                                   bool isSnapshotSorted,
+                                   bool columnar) {
 
 	if (BG_ENCRYPT_COMPRESS_DEBUG) {
 		TraceEvent(SevDebug, "SerializeChunkedSnapshot")
@@ -743,60 +1014,170 @@ Value serializeChunkedSnapshot(const Standalone<StringRef>& fileNameRef,
 		    .detail("Compressed", compressFilter.present());
 	}
 
-	CODE_PROBE(compressFilter.present(), "serializing compressed snapshot file");
-	CODE_PROBE(cipherKeysCtx.present(), "serializing encrypted snapshot file");
-	Standalone<IndexedBlobGranuleFile> file;
+	SnapshotFileBuilder builder(targetChunkBytes, compressFilter, cipherKeysCtx, columnar, isSnapshotSorted);
+	for (auto& row : snapshot) {
+		builder.add(row);
+	}
+	return builder.finish();
+}
 
-	file.init(SNAPSHOT_FILE_TYPE, cipherKeysCtx);
+Value serializeChunkedSnapshot(const Standalone<StringRef>& fileNameRef,
+                               const Standalone<GranuleSnapshot>& snapshot,
+                               int targetChunkBytes,
+                               Optional<CompressionFilter> compressFilter,
+                               Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx,
+                               bool isSnapshotSorted) {
+	return serializeSnapshotFile(
+	    fileNameRef, snapshot, targetChunkBytes, compressFilter, cipherKeysCtx, isSnapshotSorted, false);
+}
 
-	size_t currentChunkBytesEstimate = 0;
-	size_t previousChunkBytes = 0;
+Value serializeColumnarSnapshot(const Standalone<StringRef>& fileNameRef,
+                                const Standalone<GranuleSnapshot>& snapshot,
+                                int targetChunkBytes,
+                                Optional<CompressionFilter> compressFilter,
+                                Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx) {
+	CODE_PROBE(true, "serializing columnar snapshot file");
+	return serializeSnapshotFile(fileNameRef, snapshot, targetChunkBytes, compressFilter, cipherKeysCtx, true, true);
+}
 
-	std::vector<Value> chunks;
-	chunks.push_back(Value()); // dummy value for index block
-	Standalone<GranuleSnapshot> currentChunk;
+// Returns the value of a row for a read of the tuple elements in columns, or of all of them if columns is absent, or an
+// absent Optional if the row doesn't pass predicate. element(i) returns element i of the row's value, or an empty
+// StringRef if it doesn't have one.
+template <class ElementFn>
+static Optional<ValueRef> projectRow(const ValueRef& rawValue,
+                                     bool isTuple,
+                                     int elementCount,
+                                     ElementFn element,
+                                     const Optional<std::vector<int>>& columns,
+                                     const Optional<BlobGranuleColumnPredicate>& predicate,
+                                     Arena& arena) {
+	if (predicate.present()) {
+		StringRef e = isTuple ? element(predicate.get().column) : StringRef();
+		if (e.empty() || !predicate.get().range.contains(e)) {
+			return Optional<ValueRef>();
+		}
+	}
+	if (!isTuple) {
+		return rawValue;
+	}
 
-	for (int i = 0; i < snapshot.size(); i++) {
-		// TODO REMOVE sanity check
-		if (i > 0 && isSnapshotSorted) {
-			ASSERT(snapshot[i - 1].key < snapshot[i].key);
+	auto forEachColumn = [&](auto f) {
+		if (columns.present()) {
+			for (int c : columns.get()) {
+				f(element(c));
+			}
+		} else {
+			for (int c = 0; c < elementCount; c++) {
+				f(element(c));
+			}
 		}
+	};
+	int size = 0;
+	int count = 0;
+	StringRef only;
+	forEachColumn([&](StringRef e) {
+		size += e.size();
+		count += e.empty() ? 0 : 1;
+		only = e.empty() ? only : e;
+	});
+	if (count <= 1) {
+		return only;
+	}
+	uint8_t* buf = new (arena) uint8_t[size];
+	uint8_t* end = buf;
+	forEachColumn([&](StringRef e) { end = e.copyTo(end); });
+	return ValueRef(buf, size);
+}
 
-		currentChunk.push_back_deep(currentChunk.arena(), snapshot[i]);
-		currentChunkBytesEstimate += snapshot[i].expectedSize();
+static Standalone<VectorRef<StringRef>> readSnapshotColumn(const SnapshotColumnRef& column) {
+	Arena arena;
+	IndexBlobGranuleFileChunkRef chunkRef = IndexBlobGranuleFileChunkRef::fromBytes({}, column.block, arena);
+	BinaryReader br(chunkRef.chunkBytes.get(), IncludeVersion());
+	Standalone<VectorRef<StringRef>> elements;
+	br >> elements;
+	return elements;
+}
 
-		if (currentChunkBytesEstimate >= targetChunkBytes || i == snapshot.size() - 1) {
-			Value serialized =
-			    BinaryWriter::toValue(currentChunk, IncludeVersion(ProtocolVersion::withBlobGranuleFile()));
-			Value chunkBytes =
-			    IndexBlobGranuleFileChunkRef::toBytes(cipherKeysCtx, compressFilter, serialized, file.arena());
-			chunks.push_back(chunkBytes);
-			// TODO remove validation
-			if (!file.indexBlockRef.block.children.empty() && isSnapshotSorted) {
-				ASSERT(file.indexBlockRef.block.children.back().key < currentChunk.begin()->key);
-			}
-			file.indexBlockRef.block.children.emplace_back_deep(
-			    file.arena(), currentChunk.begin()->key, previousChunkBytes);
+// Whether any row of a columnar chunk can pass predicate, from the stats of its columns
+static bool columnarChunkMayPass(const SnapshotColumnsChunkRef& chunk, const BlobGranuleColumnPredicate& predicate) {
+	if (predicate.column < 0 || predicate.column + 2 >= chunk.columns.size()) {
+		return false;
+	}
+	const SnapshotColumnRef& column = chunk.columns[predicate.column + 2];
+	return !column.minElement.empty() && column.maxElement >= predicate.range.begin &&
+	       column.minElement < predicate.range.end;
+}
 
-			if (BG_ENCRYPT_COMPRESS_DEBUG) {
-				TraceEvent(SevDebug, "ChunkSize")
-				    .detail("ChunkBytes", chunkBytes.size())
-				    .detail("PrvChunkBytes", previousChunkBytes);
+// Loads the rows in keyRange of a columnar snapshot file, with values made by projectRow. Only the columns that are
+// needed are decompressed, and chunks that can't pass predicate are skipped.
+static Standalone<VectorRef<ParsedDeltaBoundaryRef>> loadColumnarSnapshotFile(
+    Standalone<IndexedBlobGranuleFile>& file,
+    const KeyRangeRef& keyRange,
+    Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx,
+    const Optional<std::vector<int>>& columns,
+    const Optional<BlobGranuleColumnPredicate>& predicate) {
+	Standalone<VectorRef<ParsedDeltaBoundaryRef>> results;
+
+	// empty snapshot file
+	if (file.indexBlockRef.block.children.empty()) {
+		return results;
+	}
+
+	ASSERT(file.indexBlockRef.block.children.size() >= 2);
+
+	// find range of blocks needed to read
+	ChildBlockPointerRef* currentBlock = file.findStartBlock(keyRange.begin);
+
+	if (currentBlock == (file.indexBlockRef.block.children.end() - 1) || keyRange.end <= currentBlock->key) {
+		return results;
+	}
+
+	bool lastBlock = false;
+	while (!lastBlock) {
+		auto nextBlock = currentBlock;
+		nextBlock++;
+		lastBlock = (nextBlock == (file.indexBlockRef.block.children.end() - 1)) || (keyRange.end <= nextBlock->key);
+		Standalone<SnapshotColumnsChunkRef> chunk =
+		    file.getChild<SnapshotColumnsChunkRef>(currentBlock, cipherKeysCtx, file.chunkStartOffset);
+		currentBlock++;
+		ASSERT(chunk.columns.size() >= 2);
+		if (predicate.present() && !columnarChunkMayPass(chunk, predicate.get())) {
+			CODE_PROBE(true, "columnar snapshot chunk skipped by predicate");
+			continue;
+		}
+
+		std::vector<Standalone<VectorRef<StringRef>>> data(chunk.columns.size());
+		for (int c = 0; c < chunk.columns.size(); c++) {
+			bool needed = c < 2 || !columns.present() ||
+			              std::find(columns.get().begin(), columns.get().end(), c - 2) != columns.get().end() ||
+			              (predicate.present() && predicate.get().column == c - 2);
+			if (needed) {
+				data[c] = readSnapshotColumn(chunk.columns[c]);
+				results.arena().dependsOn(data[c].arena());
 			}
+		}
 
-			previousChunkBytes += chunkBytes.size();
-			currentChunkBytesEstimate = 0;
-			currentChunk = Standalone<GranuleSnapshot>();
+		const VectorRef<StringRef>& keys = data[0];
+		for (int row = 0; row < keys.size(); row++) {
+			if (keys[row] < keyRange.begin) {
+				continue;
+			}
+			if (lastBlock && keys[row] >= keyRange.end) {
+				break;
+			}
+			auto element = [&](int c) {
+				return c >= 0 && c + 2 < data.size() && !data[c + 2].empty() ? data[c + 2][row] : StringRef();
+			};
+			const StringRef& rawValue = data[1][row];
+			Optional<ValueRef> value = projectRow(
+			    rawValue, rawValue.empty(), data.size() - 2, element, columns, predicate, results.arena());
+			if (value.present()) {
+				results.emplace_back(results.arena(), KeyValueRef(keys[row], value.get()));
+			}
 		}
 	}
-	ASSERT(currentChunk.empty());
-	// push back dummy last chunk to get last chunk size, and to know last key in last block without having to read it
-	if (!snapshot.empty()) {
-		file.indexBlockRef.block.children.emplace_back_deep(
-		    file.arena(), keyAfter(snapshot.back().key), previousChunkBytes);
-	}
 
-	return serializeFileFromChunks(file, cipherKeysCtx, chunks, previousChunkBytes);
+	return results;
 }
 
 // TODO: use redwood prefix trick to optimize cpu comparison
@@ -817,8 +1198,11 @@ static Standalone<VectorRef<ParsedDeltaBoundaryRef>> loadSnapshotFile(
 
 	Standalone<IndexedBlobGranuleFile> file = IndexedBlobGranuleFile::fromFileBytes(snapshotData, cipherKeysCtx);
 
-	ASSERT(file.fileType == SNAPSHOT_FILE_TYPE);
 	ASSERT(file.chunkStartOffset > 0);
+	if (file.fileType == COLUMNAR_SNAPSHOT_FILE_TYPE) {
+		return loadColumnarSnapshotFile(file, keyRange, cipherKeysCtx, {}, {});
+	}
+	ASSERT(file.fileType == SNAPSHOT_FILE_TYPE);
 
 	// empty snapshot file
 	if (file.indexBlockRef.block.children.empty()) {
@@ -1258,6 +1642,51 @@ static void applyDeltasByVersion(const GranuleDeltas& deltas,
 	lastFileEndVersion = deltas.back().version;
 }
 
+// Memory deltas are usually only sets, for which the boundaries are just the last set of each key. Those are found by
+// sorting the sets into a flat vector, instead of inserting each into a map of boundaries.
+static Standalone<VectorRef<ParsedDeltaBoundaryRef>> sortMemorySets(const GranuleDeltas& memoryDeltas,
+                                                                    const KeyRangeRef& readRange,
+                                                                    Version beginVersion,
+                                                                    Version readVersion) {
+	struct VersionedSet {
+		KeyRef key;
+		ValueRef value;
+		Version version;
+	};
+	std::vector<VersionedSet> sets;
+	for (auto& it : memoryDeltas) {
+		if (it.version > readVersion) {
+			break;
+		}
+		for (auto& m : it.mutations) {
+			ASSERT(m.type == MutationRef::SetValue);
+			if (readRange.contains(m.param1)) {
+				sets.push_back(VersionedSet{ m.param1, m.param2, it.version });
+			}
+		}
+	}
+
+	// all keys in readRange share its common prefix. A stable sort keeps the sets of each key in version order.
+	int prefixLen = commonPrefixLength(readRange.begin, readRange.end);
+	std::stable_sort(sets.begin(), sets.end(), [prefixLen](VersionedSet const& a, VersionedSet const& b) {
+		return a.key.compareSuffix(b.key, prefixLen) < 0;
+	});
+
+	Standalone<VectorRef<ParsedDeltaBoundaryRef>> deltas;
+	for (int i = 0; i < sets.size(); i++) {
+		if (i + 1 < sets.size() && sets[i].key.compareSuffix(sets[i + 1].key, prefixLen) == 0) {
+			continue;
+		}
+		// a set older than beginVersion is a no-op, which is redundant without clears
+		if (sets[i].version >= beginVersion) {
+			deltas.push_back_deep(
+			    deltas.arena(),
+			    ParsedDeltaBoundaryRef(sets[i].key, false, ValueAndVersionRef(sets[i].version, sets[i].value)));
+		}
+	}
+	return deltas;
+}
+
 // TODO: could optimize this slightly to avoid tracking multiple updates for the same key at all since it's always then
 // collapsed to the last one
 Standalone<VectorRef<ParsedDeltaBoundaryRef>> sortMemoryDeltas(const GranuleDeltas& memoryDeltas,
@@ -1267,6 +1696,16 @@ Standalone<VectorRef<ParsedDeltaBoundaryRef>> sortMemoryDeltas(const GranuleDelt
                                                                Version readVersion) {
 	ASSERT(!memoryDeltas.empty());
 
+	bool anyClears = false;
+	for (auto& it : memoryDeltas) {
+		for (auto& m : it.mutations) {
+			anyClears = anyClears || m.type == MutationRef::ClearRange;
+		}
+	}
+	if (!anyClears) {
+		return sortMemorySets(memoryDeltas, readRange, beginVersion, readVersion);
+	}
+
 	// filter by request range first
 	SortedDeltasT versionedBoundaries;
 	if (versionedBoundaries.empty()) {
@@ -1320,32 +1759,70 @@ Standalone<VectorRef<ParsedDeltaBoundaryRef>> sortMemoryDeltas(const GranuleDelt
 	return deltas;
 }
 
-// does a sorted merge of the delta streams.
-// In terms of write precedence, streams[i] < streams[i+1]
-// Handles range clears by tracking the active clears when they start
-struct MergeStreamNext {
-	KeyRef key;
-	int16_t streamIdx;
-	int dataIdx;
-};
+// A loser tree over the next boundary of each delta stream, ordered by key and then from the highest stream down, so
+// that for each key the stream with write precedence comes first. Each internal node holds the stream that lost the
+// match played there, so advancing the winning stream replays only the matches on its path to the root, with one key
+// comparison per level instead of the two a binary heap needs.
+class DeltaStreamLoserTree {
+public:
+	DeltaStreamLoserTree(const std::vector<Standalone<VectorRef<ParsedDeltaBoundaryRef>>>& streams, int prefixLen)
+	  : streams(streams), prefixLen(prefixLen), positions(streams.size(), 0), tree(streams.size(), -1) {
+		for (int16_t i = streams.size() - 1; i >= 0; i--) {
+			replay(i);
+		}
+	}
 
-// the sort order is logically lower by key, and then higher by streamIdx
-// because a priority queue is backwards, we invert that
-struct OrderForPriorityQueue {
-	int commonPrefixLen;
-	OrderForPriorityQueue(int commonPrefixLen) : commonPrefixLen(commonPrefixLen) {}
+	bool empty() const { return exhausted(tree[0]); }
+
+	// The stream whose boundary is next, and the index of that boundary in the stream
+	int16_t topStream() const { return tree[0]; }
+	int topIndex() const { return positions[tree[0]]; }
+	const KeyRef& topKey() const { return streams[tree[0]][positions[tree[0]]].key; }
+
+	// Moves the winning stream to its next boundary
+	void pop() {
+		int16_t s = tree[0];
+		positions[s]++;
+		replay(s);
+	}
 
-	bool operator()(MergeStreamNext const& a, MergeStreamNext const& b) const {
-		int keyCmp = a.key.compareSuffix(b.key, commonPrefixLen);
+private:
+	const std::vector<Standalone<VectorRef<ParsedDeltaBoundaryRef>>>& streams;
+	int prefixLen;
+	std::vector<int> positions;
+	// tree[0] is the winner, tree[1..n) the losers of each match. Stream i is leaf n + i. -1 wins every match, and is
+	// only present while the tree is built.
+	std::vector<int16_t> tree;
+
+	bool exhausted(int16_t s) const { return positions[s] >= streams[s].size(); }
+
+	bool before(int16_t a, int16_t b) const {
+		if (a < 0 || b < 0) {
+			return a < 0 && b >= 0;
+		}
+		if (exhausted(a) || exhausted(b)) {
+			return !exhausted(a);
+		}
+		int keyCmp = streams[a][positions[a]].key.compareSuffix(streams[b][positions[b]].key, prefixLen);
 		if (keyCmp != 0) {
-			return keyCmp > 0; // reverse
+			return keyCmp < 0;
 		}
-		return a.streamIdx < b.streamIdx;
+		return a > b;
 	}
-};
 
-typedef std::priority_queue<MergeStreamNext, std::vector<MergeStreamNext>, OrderForPriorityQueue> MergePQ;
+	void replay(int16_t s) {
+		for (int node = (s + tree.size()) / 2; node > 0; node /= 2) {
+			if (before(tree[node], s)) {
+				std::swap(tree[node], s);
+			}
+		}
+		tree[0] = s;
+	}
+};
 
+// does a sorted merge of the delta streams.
+// In terms of write precedence, streams[i] < streams[i+1]
+// Handles range clears by tracking the active clears when they start
 static RangeResult mergeDeltaStreams(const BlobGranuleChunkRef& chunk,
                                      const std::vector<Standalone<VectorRef<ParsedDeltaBoundaryRef>>>& streams,
                                      const std::vector<bool> startClears,
@@ -1359,9 +1836,6 @@ static RangeResult mergeDeltaStreams(const BlobGranuleChunkRef& chunk,
 
 	int prefixLen = commonPrefixLength(chunk.keyRange.begin, chunk.keyRange.end);
 
-	// next element for each stream
-	MergePQ next = MergePQ(OrderForPriorityQueue(prefixLen));
-
 	// efficiently find the highest stream's active clear
 	std::set<int16_t, std::greater<int16_t>> activeClears;
 	int16_t maxActiveClear = -1;
@@ -1382,39 +1856,36 @@ static RangeResult mergeDeltaStreams(const BlobGranuleChunkRef& chunk,
 			// single clear that entirely encases partial read bounds
 			ASSERT(clearActive[i]);
 		} else {
-			MergeStreamNext item;
-			item.key = streams[i][0].key;
-			item.streamIdx = i;
-			item.dataIdx = 0;
-			next.push(item);
 			maxExpectedSize += streams[i].size();
 			result.arena().dependsOn(streams[i].arena());
 		}
 	}
 	result.reserve(result.arena(), maxExpectedSize);
 
-	std::vector<MergeStreamNext> cur;
+	// next element for each stream
+	DeltaStreamLoserTree next(streams, prefixLen);
+
+	// the boundaries of the current key, highest stream first, as (streamIdx, dataIdx)
+	std::vector<std::pair<int16_t, int>> cur;
 	cur.reserve(streams.size());
 	while (!next.empty()) {
 		cur.clear();
-		cur.push_back(next.top());
-		next.pop();
-
-		// next.top().key == cur.front().key but with suffix comparison
-		while (!next.empty() && cur.front().key.compareSuffix(next.top().key, prefixLen) == 0) {
-			cur.push_back(next.top());
+		KeyRef key = next.topKey();
+		// each stream's keys are increasing, so a stream can be advanced as soon as its boundary for key is taken
+		do {
+			cur.emplace_back(next.topStream(), next.topIndex());
 			next.pop();
-		}
+		} while (!next.empty() && key.compareSuffix(next.topKey(), prefixLen) == 0);
 
 		// un-set clears and find latest value for key (if present)
 		bool foundValue = false;
-		bool includesSnapshot = cur.back().streamIdx == 0 && chunk.snapshotFile.present();
-		for (auto& it : cur) {
-			auto& v = streams[it.streamIdx][it.dataIdx];
-			if (clearActive[it.streamIdx]) {
-				clearActive[it.streamIdx] = false;
-				activeClears.erase(it.streamIdx);
-				if (it.streamIdx == maxActiveClear) {
+		bool includesSnapshot = cur.back().first == 0 && chunk.snapshotFile.present();
+		for (auto& [streamIdx, dataIdx] : cur) {
+			auto& v = streams[streamIdx][dataIdx];
+			if (clearActive[streamIdx]) {
+				clearActive[streamIdx] = false;
+				activeClears.erase(streamIdx);
+				if (streamIdx == maxActiveClear) {
 					// re-get max active clear
 					maxActiveClear = activeClears.empty() ? -1 : *activeClears.begin();
 				}
@@ -1424,13 +1895,13 @@ static RangeResult mergeDeltaStreams(const BlobGranuleChunkRef& chunk,
 			if (!foundValue && !v.isNoOp()) {
 				foundValue = true;
 				// if it's a clear, or maxActiveClear is higher, no value for this key
-				if (v.isSet() && maxActiveClear < it.streamIdx) {
+				if (v.isSet() && maxActiveClear < streamIdx) {
 					KeyRef finalKey =
 					    chunk.tenantPrefix.present() ? v.key.removePrefix(chunk.tenantPrefix.get()) : v.key;
 					result.push_back(result.arena(), KeyValueRef(finalKey, v.value));
 					if (!includesSnapshot) {
 						stats.rowsInserted++;
-					} else if (it.streamIdx > 0) {
+					} else if (streamIdx > 0) {
 						stats.rowsUpdated++;
 					}
 				} else if (includesSnapshot) {
@@ -1439,20 +1910,15 @@ static RangeResult mergeDeltaStreams(const BlobGranuleChunkRef& chunk,
 			}
 		}
 
-		// advance streams and start clearAfter
-		for (auto& it : cur) {
-			if (streams[it.streamIdx][it.dataIdx].clearAfter) {
-				clearActive[it.streamIdx] = true;
-				activeClears.insert(it.streamIdx);
-				maxActiveClear = std::max(maxActiveClear, it.streamIdx);
+		// start clearAfter
+		for (auto& [streamIdx, dataIdx] : cur) {
+			if (streams[streamIdx][dataIdx].clearAfter) {
+				clearActive[streamIdx] = true;
+				activeClears.insert(streamIdx);
+				maxActiveClear = std::max(maxActiveClear, streamIdx);
 			}
 			// TODO: implement skipping if large clear!!
-			// if (maxClearIdx > it.streamIdx) - skip
-			it.dataIdx++;
-			if (it.dataIdx < streams[it.streamIdx].size()) {
-				it.key = streams[it.streamIdx][it.dataIdx].key;
-				next.push(it);
-			}
+			// if (maxClearIdx > streamIdx) - skip
 		}
 	}
 
@@ -1638,12 +2104,207 @@ static void startLoad(const ReadBlobGranuleContext* granuleContext,
 	}
 }
 
-ErrorOr<RangeResult> loadAndMaterializeBlobGranules(const Standalone<VectorRef<BlobGranuleChunkRef>>& files,
-                                                    const KeyRangeRef& keyRange,
-                                                    Version beginVersion,
-                                                    Version readVersion,
-                                                    ReadBlobGranuleContext granuleContext,
-                                                    GranuleMaterializeStats& stats) {
+// Starts loading bytes [offset, offset + length) of a granule file
+static int64_t startRangeLoad(const ReadBlobGranuleContext* granuleContext,
+                              const BlobFilePointerRef& file,
+                              int64_t offset,
+                              int64_t length,
+                              std::vector<Reference<GranuleLoadFreeHandle>>& freeHandles) {
+	std::string fname = file.filename.toString();
+	int64_t loadId = granuleContext->start_load_f(
+	    fname.c_str(), fname.size(), file.offset + offset, length, file.fullFileLength, granuleContext->userContext);
+	freeHandles.push_back(makeReference<GranuleLoadFreeHandle>(granuleContext, loadId));
+	return loadId;
+}
+
+// Copies the bytes of a load started by startRangeLoad to to
+static void finishRangeLoad(const ReadBlobGranuleContext* granuleContext, int64_t loadId, int64_t length, uint8_t* to) {
+	const uint8_t* data = granuleContext->get_load_f(loadId, granuleContext->userContext);
+	// null data is error
+	if (!data) {
+		throw blob_granule_file_load_error();
+	}
+	memcpy(to, data, length);
+}
+
+// The parts of a granule file that a read needs, which are the header with the index, and the chunks with rows in the
+// range read. bytes is as long as the file, but only has those parts filled in, which are all that loadSnapshotFile and
+// loadChunkedDeltaFile read.
+struct GranuleFileParts {
+	const BlobFilePointerRef* file;
+	uint8_t* bytes;
+	int64_t headerBytes = 0;
+	Optional<int64_t> headerLoadId;
+	// offset, length and load id of chunks being loaded
+	std::vector<std::tuple<int64_t, int64_t, int64_t>> chunkLoads;
+	std::vector<Reference<GranuleLoadFreeHandle>> freeHandles;
+};
+
+static void startHeaderLoad(const ReadBlobGranuleContext* granuleContext,
+                            BlobGranuleFileCache& cache,
+                            GranuleFileParts& parts,
+                            GranuleMaterializeStats& stats) {
+	Optional<Standalone<StringRef>> header = cache.get(parts.file->filename, parts.file->offset);
+	if (header.present()) {
+		parts.headerBytes = header.get().size();
+		header.get().copyTo(parts.bytes);
+		stats.fileCacheHits++;
+		stats.fileCacheHitBytes += parts.headerBytes;
+	} else {
+		// the size of the header isn't known until it is read, so read as much as it is usually at most
+		parts.headerBytes = std::min<int64_t>(parts.file->length, CLIENT_KNOBS->BG_CLIENT_FILE_HEADER_READ_BYTES);
+		parts.headerLoadId = startRangeLoad(granuleContext, *parts.file, 0, parts.headerBytes, parts.freeHandles);
+	}
+}
+
+static void finishHeaderLoad(const ReadBlobGranuleContext* granuleContext,
+                             BlobGranuleFileCache& cache,
+                             GranuleFileParts& parts,
+                             GranuleMaterializeStats& stats) {
+	if (!parts.headerLoadId.present()) {
+		return;
+	}
+	loop {
+		int64_t readBytes = parts.headerBytes;
+		finishRangeLoad(granuleContext, parts.headerLoadId.get(), readBytes, parts.bytes);
+		stats.fileCacheMisses++;
+		stats.fileCacheMissBytes += readBytes;
+		memset(parts.bytes + readBytes, 0, parts.file->length - readBytes);
+		int chunkStartOffset =
+		    IndexedBlobGranuleFile::chunkStartOffsetFromBytes(StringRef(parts.bytes, parts.file->length));
+		if (chunkStartOffset > 0 && chunkStartOffset <= readBytes) {
+			parts.headerBytes = chunkStartOffset;
+			break;
+		}
+		// The header didn't fit. If where the chunks start wasn't read either, read the whole file.
+		ASSERT(readBytes < parts.file->length);
+		CODE_PROBE(true, "granule file header larger than first read");
+		parts.headerBytes = chunkStartOffset > readBytes && chunkStartOffset <= parts.file->length
+		                        ? chunkStartOffset
+		                        : parts.file->length;
+		parts.headerLoadId = startRangeLoad(granuleContext, *parts.file, 0, parts.headerBytes, parts.freeHandles);
+	}
+	cache.insert(parts.file->filename,
+	             parts.file->offset,
+	             Standalone<StringRef>(StringRef(parts.bytes, parts.headerBytes)));
+	parts.headerLoadId.reset();
+}
+
+static void startChunkLoads(const ReadBlobGranuleContext* granuleContext,
+                            BlobGranuleFileCache& cache,
+                            GranuleFileParts& parts,
+                            const KeyRangeRef& keyRange,
+                            GranuleMaterializeStats& stats) {
+	Standalone<IndexedBlobGranuleFile> file = IndexedBlobGranuleFile::fromFileBytes(
+	    StringRef(parts.bytes, parts.file->length), parts.file->cipherKeysCtx);
+	ASSERT(file.chunkStartOffset == parts.headerBytes);
+	auto [begin, end] = file.blocksForRange(keyRange);
+	const auto& children = file.indexBlockRef.block.children;
+	for (int i = begin; i < end; i++) {
+		int64_t offset = file.chunkStartOffset + children[i].offset;
+		int64_t length = children[i + 1].offset - children[i].offset;
+		Optional<Standalone<StringRef>> chunk = cache.get(parts.file->filename, parts.file->offset + offset);
+		if (chunk.present()) {
+			ASSERT(chunk.get().size() == length);
+			chunk.get().copyTo(parts.bytes + offset);
+			stats.fileCacheHits++;
+			stats.fileCacheHitBytes += length;
+		} else {
+			int64_t loadId = startRangeLoad(granuleContext, *parts.file, offset, length, parts.freeHandles);
+			parts.chunkLoads.emplace_back(offset, length, loadId);
+		}
+	}
+}
+
+static void finishChunkLoads(const ReadBlobGranuleContext* granuleContext,
+                             BlobGranuleFileCache& cache,
+                             GranuleFileParts& parts,
+                             GranuleMaterializeStats& stats) {
+	for (auto& [offset, length, loadId] : parts.chunkLoads) {
+		finishRangeLoad(granuleContext, loadId, length, parts.bytes + offset);
+		stats.fileCacheMisses++;
+		stats.fileCacheMissBytes += length;
+		cache.insert(parts.file->filename,
+		             parts.file->offset + offset,
+		             Standalone<StringRef>(StringRef(parts.bytes + offset, length)));
+	}
+	parts.chunkLoads.clear();
+	parts.freeHandles.clear();
+}
+
+// Like loadAndMaterializeBlobGranules, but loads only the parts of files that the read needs, and only those that are
+// not in cache. All the loads for a granule are started before waiting for any, in two rounds, since which chunks are
+// needed is only known once the headers are loaded.
+static RangeResult loadAndMaterializeFileParts(const Standalone<VectorRef<BlobGranuleChunkRef>>& files,
+                                               const KeyRangeRef& keyRange,
+                                               Version beginVersion,
+                                               Version readVersion,
+                                               const ReadBlobGranuleContext* granuleContext,
+                                               BlobGranuleFileCache& cache,
+                                               GranuleMaterializeStats& stats) {
+	RangeResult results;
+	for (const BlobGranuleChunkRef& chunk : files) {
+		KeyRange requestRange;
+		if (chunk.tenantPrefix.present()) {
+			requestRange = keyRange.withPrefix(chunk.tenantPrefix.get());
+		} else {
+			requestRange = keyRange;
+		}
+		Arena arena;
+		std::vector<GranuleFileParts> parts;
+		parts.reserve(chunk.deltaFiles.size() + 1);
+		if (chunk.snapshotFile.present()) {
+			parts.push_back({ &chunk.snapshotFile.get(), new (arena) uint8_t[chunk.snapshotFile.get().length] });
+		}
+		for (auto& deltaFile : chunk.deltaFiles) {
+			parts.push_back({ &deltaFile, new (arena) uint8_t[deltaFile.length] });
+		}
+
+		for (auto& it : parts) {
+			startHeaderLoad(granuleContext, cache, it, stats);
+		}
+		for (auto& it : parts) {
+			finishHeaderLoad(granuleContext, cache, it, stats);
+			startChunkLoads(granuleContext, cache, it, requestRange, stats);
+		}
+		for (auto& it : parts) {
+			finishChunkLoads(granuleContext, cache, it, stats);
+		}
+
+		Optional<StringRef> snapshotData;
+		std::vector<StringRef> deltaData;
+		for (auto& it : parts) {
+			StringRef bytes(it.bytes, it.file->length);
+			if (chunk.snapshotFile.present() && it.file == &chunk.snapshotFile.get()) {
+				snapshotData = bytes;
+			} else {
+				deltaData.push_back(bytes);
+			}
+		}
+		RangeResult chunkRows =
+		    materializeBlobGranule(chunk, keyRange, beginVersion, readVersion, snapshotData, deltaData, stats);
+		results.arena().dependsOn(chunkRows.arena());
+		results.append(results.arena(), chunkRows.begin(), chunkRows.size());
+	}
+	return results;
+}
+
+static ErrorOr<RangeResult> loadAndMaterializeBlobGranules(const Standalone<VectorRef<BlobGranuleChunkRef>>& files,
+                                                           const KeyRangeRef& keyRange,
+                                                           Version beginVersion,
+                                                           Version readVersion,
+                                                           ReadBlobGranuleContext granuleContext,
+                                                           GranuleMaterializeStats& stats,
+                                                           BlobGranuleFileCache& cache) {
+	if (cache.enabled()) {
+		try {
+			return ErrorOr<RangeResult>(loadAndMaterializeFileParts(
+			    files, keyRange, beginVersion, readVersion, &granuleContext, cache, stats));
+		} catch (Error& e) {
+			return ErrorOr<RangeResult>(e);
+		}
+	}
+
 	int64_t parallelism = granuleContext.granuleParallelism;
 	if (parallelism < 1) {
 		parallelism = 1;
@@ -1707,6 +2368,16 @@ ErrorOr<RangeResult> loadAndMaterializeBlobGranules(const Standalone<VectorRef<B
 	}
 }
 
+ErrorOr<RangeResult> loadAndMaterializeBlobGranules(const Standalone<VectorRef<BlobGranuleChunkRef>>& files,
+                                                    const KeyRangeRef& keyRange,
+                                                    Version beginVersion,
+                                                    Version readVersion,
+                                                    ReadBlobGranuleContext granuleContext,
+                                                    GranuleMaterializeStats& stats) {
+	return loadAndMaterializeBlobGranules(
+	    files, keyRange, beginVersion, readVersion, granuleContext, stats, BlobGranuleFileCache::global());
+}
+
 // just for client passthrough. reads all key-value pairs from a snapshot file, and all mutations from a delta file
 RangeResult bgReadSnapshotFile(const StringRef& data,
                                Optional<KeyRef> tenantPrefix,
@@ -1729,6 +2400,45 @@ RangeResult bgReadSnapshotFile(const StringRef& data,
 	return snapshot;
 }
 
+RangeResult bgReadSnapshotFileColumns(const StringRef& data,
+                                      Optional<KeyRef> tenantPrefix,
+                                      Optional<BlobGranuleCipherKeysCtx> encryptionCtx,
+                                      const KeyRangeRef& keys,
+                                      const std::vector<int>& columns,
+                                      Optional<BlobGranuleColumnPredicate> predicate) {
+	Standalone<IndexedBlobGranuleFile> file = IndexedBlobGranuleFile::fromFileBytes(data, encryptionCtx);
+	Standalone<VectorRef<ParsedDeltaBoundaryRef>> results;
+	if (file.fileType == COLUMNAR_SNAPSHOT_FILE_TYPE) {
+		ASSERT(file.chunkStartOffset > 0);
+		results = loadColumnarSnapshotFile(file, keys, encryptionCtx, columns, predicate);
+	} else {
+		// row files have to be read whole, and their values split into tuple elements one by one
+		CODE_PROBE(true, "column read of row snapshot file");
+		Standalone<StringRef> fname = "f"_sr;
+		Standalone<VectorRef<ParsedDeltaBoundaryRef>> rows = loadSnapshotFile(fname, data, keys, encryptionCtx);
+		results.arena().dependsOn(rows.arena());
+		std::vector<StringRef> elements;
+		for (auto& it : rows) {
+			bool isTuple = splitTupleElements(it.value, elements);
+			auto element = [&](int c) { return c >= 0 && c < elements.size() ? elements[c] : StringRef(); };
+			Optional<ValueRef> value =
+			    projectRow(it.value, isTuple, elements.size(), element, columns, predicate, results.arena());
+			if (value.present()) {
+				results.emplace_back(results.arena(), KeyValueRef(it.key, value.get()));
+			}
+		}
+	}
+
+	RangeResult snapshot;
+	snapshot.reserve(snapshot.arena(), results.size());
+	snapshot.arena().dependsOn(results.arena());
+	for (auto& it : results) {
+		KeyRef key = tenantPrefix.present() ? it.key.removePrefix(tenantPrefix.get()) : it.key;
+		snapshot.emplace_back(snapshot.arena(), key, it.value);
+	}
+	return snapshot;
+}
+
 // FIXME: refactor if possible, just copy-pasted from loadChunkedDeltaFile for prototyping
 Standalone<VectorRef<GranuleMutationRef>> bgReadDeltaFile(const StringRef& deltaData,
                                                           Optional<KeyRef> tenantPrefix,
@@ -2463,8 +3173,11 @@ TEST_CASE("/blobgranule/files/snapshotFormatUnitTest") {
 
 	fmt::print("Constructing snapshot with {0} rows, {1} chunks\n", data.size(), targetChunks);
 
+	// columnar files must read the same as row files, whether or not the values are tuples
+	bool columnar = deterministicRandom()->coinflip();
 	Value serialized =
-	    serializeChunkedSnapshot(fnameRef, data, targetChunkSize, kvGen.compressFilter, kvGen.cipherKeys);
+	    columnar ? serializeColumnarSnapshot(fnameRef, data, targetChunkSize, kvGen.compressFilter, kvGen.cipherKeys)
+	             : serializeChunkedSnapshot(fnameRef, data, targetChunkSize, kvGen.compressFilter, kvGen.cipherKeys);
 
 	fmt::print("Snapshot serialized! {0} bytes\n", serialized.size());
 
@@ -2588,6 +3301,75 @@ static std::tuple<KeyRange, Version, Version> randomizeKeyAndVersions(const KeyV
 	return { readRange, beginVersion, readVersion };
 }
 
+TEST_CASE("/blobgranule/files/snapshotFileBuilder") {
+	KeyValueGen kvGen;
+	Standalone<GranuleSnapshot> data = genSnapshot(kvGen, deterministicRandom()->randomExp(0, 20));
+	int chunkSize = deterministicRandom()->randomExp(0, 16);
+
+	SnapshotFileBuilder builder(chunkSize, kvGen.compressFilter, kvGen.cipherKeys);
+	for (int i = 0; i < data.size(); i++) {
+		builder.add(data[i]);
+		// a split key for the rows so far must leave rows on both sides
+		Key middle = builder.middleKey();
+		ASSERT(i == 0 ? middle == data[0].key : (middle > data[0].key && middle <= data[i].key));
+	}
+	ASSERT(builder.getRows() == data.size());
+	ASSERT(builder.getLogicalBytes() == data.expectedSize());
+
+	Value serialized = builder.finish();
+	checkSnapshotRead("test"_sr, data, serialized, 0, data.size(), kvGen.cipherKeys);
+	return Void();
+}
+
+TEST_CASE("/blobgranule/files/columnarSnapshot") {
+	// values are (i % 10, "v" + i) tuples, except every 7th which is not a tuple
+	Standalone<GranuleSnapshot> data;
+	int rows = deterministicRandom()->randomInt(1, 2000);
+	for (int i = 0; i < rows; i++) {
+		Key key(format("key%06d", i));
+		Value value = i % 7 ? Tuple::makeTuple(i % 10, format("v%d", i)).pack() : Value(format("raw%d", i));
+		data.push_back_deep(data.arena(), KeyValueRef(key, value));
+	}
+	Standalone<StringRef> fnameRef = "test"_sr;
+	int chunkSize = deterministicRandom()->randomInt(100, 10000);
+	Value columnar = serializeColumnarSnapshot(fnameRef, data, chunkSize, {}, {});
+	Value rowFile = serializeChunkedSnapshot(fnameRef, data, chunkSize, {}, {});
+
+	// full reads are the same as for a row file
+	RangeResult all = bgReadSnapshotFile(columnar, {}, {}, normalKeys);
+	ASSERT(all.size() == rows);
+	for (int i = 0; i < rows; i++) {
+		ASSERT(all[i] == data[i]);
+	}
+
+	// column reads are the same for both formats, and agree with splitting the values
+	KeyRange keys = KeyRangeRef("key000100"_sr, "key001500"_sr);
+	BlobGranuleColumnPredicate predicate{ 0, singleKeyRange(Tuple::makeTuple(3).pack()) };
+	for (const Value& file : { columnar, rowFile }) {
+		RangeResult projected = bgReadSnapshotFileColumns(file, {}, {}, keys, { 1 });
+		RangeResult filtered = bgReadSnapshotFileColumns(file, {}, {}, normalKeys, { 1, 0 }, predicate);
+		int expected = 0;
+		int expectedFiltered = 0;
+		for (int i = 0; i < rows; i++) {
+			bool isTuple = i % 7;
+			if (keys.contains(data[i].key)) {
+				ASSERT(projected[expected].key == data[i].key);
+				ASSERT(projected[expected].value ==
+				       (isTuple ? Tuple::makeTuple(format("v%d", i)).pack() : data[i].value));
+				expected++;
+			}
+			if (isTuple && i % 10 == 3) {
+				ASSERT(filtered[expectedFiltered].key == data[i].key);
+				ASSERT(filtered[expectedFiltered].value == Tuple::makeTuple(format("v%d", i), 3).pack());
+				expectedFiltered++;
+			}
+		}
+		ASSERT(projected.size() == expected);
+		ASSERT(filtered.size() == expectedFiltered);
+	}
+	return Void();
+}
+
 TEST_CASE("/blobgranule/files/deltaFormatUnitTest") {
 	KeyValueGen kvGen;
 	Standalone<StringRef> fileNameRef = StringRef(std::string("test"));
@@ -2624,6 +3406,85 @@ TEST_CASE("/blobgranule/files/deltaFormatUnitTest") {
 	return Void();
 }
 
+// Loads granule files from memory, for reads through loadAndMaterializeBlobGranules
+struct TestGranuleFileLoader {
+	std::map<std::string, StringRef> files;
+	std::map<int64_t, StringRef> loads;
+	int64_t nextLoadId = 0;
+	int64_t bytesLoaded = 0;
+
+	static int64_t start(const char* filename,
+	                     int filenameLength,
+	                     int64_t offset,
+	                     int64_t length,
+	                     int64_t fullFileLength,
+	                     void* context) {
+		TestGranuleFileLoader* self = (TestGranuleFileLoader*)context;
+		StringRef file = self->files.at(std::string(filename, filenameLength));
+		ASSERT(fullFileLength == file.size() && offset + length <= file.size());
+		self->loads[self->nextLoadId] = file.substr(offset, length);
+		self->bytesLoaded += length;
+		return self->nextLoadId++;
+	}
+
+	static uint8_t* get(int64_t loadId, void* context) {
+		return const_cast<uint8_t*>(((TestGranuleFileLoader*)context)->loads.at(loadId).begin());
+	}
+
+	static void free(int64_t loadId, void* context) { ASSERT(((TestGranuleFileLoader*)context)->loads.erase(loadId)); }
+
+	ReadBlobGranuleContext context() {
+		ReadBlobGranuleContext granuleContext;
+		granuleContext.userContext = this;
+		granuleContext.start_load_f = &start;
+		granuleContext.get_load_f = &get;
+		granuleContext.free_load_f = &free;
+		granuleContext.debugNoMaterialize = false;
+		granuleContext.granuleParallelism = deterministicRandom()->randomInt(1, 4);
+		return granuleContext;
+	}
+};
+
+// Checks that reads through a file cache get the same rows as materializeBlobGranule, and that a repeated read only
+// loads what the cache had no room for
+static void checkCachedGranuleRead(const Standalone<BlobGranuleChunkRef>& chunk,
+                                   const KeyRangeRef& range,
+                                   Version beginVersion,
+                                   Version readVersion,
+                                   Optional<StringRef> snapshotData,
+                                   const std::vector<StringRef>& deltaData,
+                                   const RangeResult& expected) {
+	TestGranuleFileLoader loader;
+	if (snapshotData.present()) {
+		loader.files[chunk.snapshotFile.get().filename.toString()] = snapshotData.get();
+	}
+	for (int i = 0; i < deltaData.size(); i++) {
+		loader.files[chunk.deltaFiles[i].filename.toString()] = deltaData[i];
+	}
+	Standalone<VectorRef<BlobGranuleChunkRef>> chunks;
+	chunks.push_back(chunks.arena(), chunk);
+	chunks.arena().dependsOn(chunk.arena());
+
+	bool fitsInCache = deterministicRandom()->coinflip();
+	BlobGranuleFileCache cache(fitsInCache ? int64_t(1e9) : deterministicRandom()->randomInt(0, 1e6));
+	for (int i = 0; i < 2; i++) {
+		GranuleMaterializeStats stats;
+		loader.bytesLoaded = 0;
+		ErrorOr<RangeResult> actual = loadAndMaterializeBlobGranules(
+		    chunks, range, beginVersion, readVersion, loader.context(), stats, cache);
+		ASSERT(actual.present());
+		ASSERT(actual.get().size() == expected.size());
+		for (int j = 0; j < expected.size(); j++) {
+			ASSERT(actual.get()[j] == expected[j]);
+		}
+		ASSERT(loader.loads.empty());
+		if (cache.enabled()) {
+			ASSERT(stats.fileCacheMissBytes == loader.bytesLoaded);
+			ASSERT(i == 0 || !fitsInCache || loader.bytesLoaded == 0);
+		}
+	}
+}
+
 void checkGranuleRead(const KeyValueGen& kvGen,
                       const KeyRangeRef& range,
                       Version beginVersion,
@@ -2721,6 +3582,8 @@ void checkGranuleRead(const KeyValueGen& kvGen,
 		ASSERT(it.second == actualData[i].value);
 		i++;
 	}
+
+	checkCachedGranuleRead(chunk, range, beginVersion, readVersion, snapshotPtr, deltaPtrsVector, actualData);
 }
 
 TEST_CASE("/blobgranule/files/granuleReadUnitTest") {
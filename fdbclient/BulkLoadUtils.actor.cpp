@@ -0,0 +1,282 @@
+/*
+ * BulkLoadUtils.actor.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbclient/BulkLoadUtils.actor.h"
+
+#include "fdbclient/KeyRangeMap.h"
+#include "fdbclient/ReadYourWrites.h"
+#include "fdbclient/SystemData.h"
+#include "flow/UnitTest.h"
+
+#include "flow/actorcompiler.h" // has to be last include
+
+ACTOR Future<UID> submitBulkLoad(Database cx, KeyRange range, std::string url, Version version) {
+	if (range.empty()) {
+		throw inverted_range();
+	}
+	if (!normalKeys.contains(range)) {
+		throw key_outside_legal_range();
+	}
+	state BulkLoadState task(deterministicRandom()->randomUniqueID(), range, url, version);
+	state Transaction tr(cx);
+	state Key begin;
+
+	loop {
+		try {
+			tr.setOption(FDBTransactionOptions::PRIORITY_SYSTEM_IMMEDIATE);
+			tr.setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+			tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+			begin = range.begin;
+			while (begin < range.end) {
+				RangeResult entries = wait(krmGetRanges(&tr, bulkLoadPrefix, KeyRangeRef(begin, range.end)));
+				for (int i = 0; i < entries.size() - 1; ++i) {
+					if (!entries[i].value.empty() && !decodeBulkLoadState(entries[i].value).isFinished()) {
+						throw bulk_load_task_conflict();
+					}
+				}
+				begin = entries.back().key;
+			}
+			RangeResult existing = wait(tr.getRange(range, 1));
+			if (!existing.empty()) {
+				throw bulk_load_range_not_empty();
+			}
+			task.submitTime = task.updateTime = now();
+			wait(krmSetRange(&tr, bulkLoadPrefix, range, bulkLoadStateValue(task)));
+			wait(tr.commit());
+			break;
+		} catch (Error& e) {
+			TraceEvent(SevDebug, "BulkLoadSubmitError").errorUnsuppressed(e).detail("TaskID", task.taskId);
+			wait(tr.onError(e));
+		}
+	}
+
+	TraceEvent("BulkLoadSubmitted").detail("TaskID", task.taskId).detail("Range", range).detail("Version", version);
+	return task.taskId;
+}
+
+ACTOR Future<std::vector<BulkLoadState>> getBulkLoadStates(Database cx, KeyRange range) {
+	state std::vector<BulkLoadState> res;
+	state Key begin = range.begin;
+	state Transaction tr(cx);
+
+	while (begin < range.end) {
+		try {
+			tr.setOption(FDBTransactionOptions::PRIORITY_SYSTEM_IMMEDIATE);
+			tr.setOption(FDBTransactionOptions::READ_SYSTEM_KEYS);
+			tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+			RangeResult entries = wait(krmGetRanges(&tr, bulkLoadPrefix, KeyRangeRef(begin, range.end)));
+			for (int i = 0; i < entries.size() - 1; ++i) {
+				if (!entries[i].value.empty()) {
+					res.push_back(decodeBulkLoadState(entries[i].value));
+				}
+			}
+			begin = entries.back().key;
+			tr.reset();
+		} catch (Error& e) {
+			TraceEvent(SevDebug, "BulkLoadGetStatesError").errorUnsuppressed(e).detail("Range", range);
+			wait(tr.onError(e));
+		}
+	}
+
+	return res;
+}
+
+ACTOR Future<int> clearBulkLoad(Database cx, KeyRange range) {
+	state Reference<ReadYourWritesTransaction> tr = makeReference<ReadYourWritesTransaction>(cx);
+	state std::set<UID> tasks;
+	state std::vector<KeyRange> entriesToClear;
+	state KeyRange hull;
+	state Key begin;
+	state int i;
+
+	loop {
+		try {
+			tr->setOption(FDBTransactionOptions::PRIORITY_SYSTEM_IMMEDIATE);
+			tr->setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+			tr->setOption(FDBTransactionOptions::LOCK_AWARE);
+			tasks.clear();
+			entriesToClear.clear();
+			hull = range;
+			begin = range.begin;
+			while (begin < range.end) {
+				RangeResult entries = wait(krmGetRanges(tr, bulkLoadPrefix, KeyRangeRef(begin, range.end)));
+				for (int j = 0; j < entries.size() - 1; ++j) {
+					if (!entries[j].value.empty()) {
+						BulkLoadState task = decodeBulkLoadState(entries[j].value);
+						tasks.insert(task.taskId);
+						hull = KeyRangeRef(std::min(hull.begin, task.range.begin), std::max(hull.end, task.range.end));
+					}
+				}
+				begin = entries.back().key;
+			}
+			// The pieces of the tasks may extend past range
+			begin = hull.begin;
+			while (begin < hull.end) {
+				RangeResult entries = wait(krmGetRanges(tr, bulkLoadPrefix, KeyRangeRef(begin, hull.end)));
+				for (int j = 0; j < entries.size() - 1; ++j) {
+					if (!entries[j].value.empty() && tasks.count(decodeBulkLoadState(entries[j].value).taskId)) {
+						entriesToClear.push_back(KeyRangeRef(entries[j].key, entries[j + 1].key));
+					}
+				}
+				begin = entries.back().key;
+			}
+			for (i = 0; i < entriesToClear.size(); ++i) {
+				wait(krmSetRangeCoalescing(tr, bulkLoadPrefix, entriesToClear[i], normalKeys, Value()));
+			}
+			wait(tr->commit());
+			break;
+		} catch (Error& e) {
+			TraceEvent(SevDebug, "BulkLoadClearError").errorUnsuppressed(e).detail("Range", range);
+			wait(tr->onError(e));
+		}
+	}
+
+	for (const auto& taskId : tasks) {
+		TraceEvent("BulkLoadCleared").detail("TaskID", taskId).detail("Range", range);
+	}
+	return tasks.size();
+}
+
+ACTOR Future<bool> setBulkLoadStates(Transaction* tr, UID taskId, std::vector<BulkLoadState> states) {
+	ASSERT(!states.empty());
+	state int i = 0;
+	RangeResult entry = wait(krmGetRanges(
+	    tr, bulkLoadPrefix, KeyRangeRef(states.front().piece.begin, keyAfter(states.front().piece.begin))));
+	if (entry[0].value.empty()) {
+		return false;
+	}
+	BulkLoadState current = decodeBulkLoadState(entry[0].value);
+	if (current.taskId != taskId || current.isFinished()) {
+		return false;
+	}
+	// Each krmSetRange() restores the value after its range, which the next one overwrites
+	for (; i < states.size(); ++i) {
+		ASSERT(states[i].taskId == taskId);
+		ASSERT(i == 0 || states[i].piece.begin == states[i - 1].piece.end);
+		states[i].updateTime = now();
+		wait(krmSetRange(tr, bulkLoadPrefix, states[i].piece, bulkLoadStateValue(states[i])));
+	}
+	return true;
+}
+
+std::vector<BulkLoadState> splitBulkLoadTask(const BulkLoadState& task,
+                                             const RestorableFileSet& fileSet,
+                                             int64_t pieceBytes,
+                                             int pieceNameBytes) {
+	std::vector<std::pair<KeyRange, const RangeFile*>> files;
+	for (const auto& file : fileSet.ranges) {
+		auto it = fileSet.keyRanges.find(file.fileName);
+		if (it != fileSet.keyRanges.end() && it->second.intersects(task.range)) {
+			files.emplace_back(it->second, &file);
+		}
+	}
+	std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first.begin < b.first.begin; });
+
+	std::vector<Key> cuts{ task.range.begin };
+	int64_t bytes = 0;
+	int nameBytes = 0;
+	for (const auto& [keys, file] : files) {
+		if ((bytes >= pieceBytes || nameBytes >= pieceNameBytes) && keys.begin > cuts.back() &&
+		    keys.begin < task.range.end) {
+			cuts.push_back(keys.begin);
+			bytes = nameBytes = 0;
+		}
+		bytes += file->fileSize;
+		nameBytes += file->fileName.size() + keys.expectedSize();
+	}
+	cuts.push_back(task.range.end);
+
+	// A piece gets every file intersecting it. Files before first end before the current piece and every later one.
+	std::vector<BulkLoadState> pieces;
+	int first = 0;
+	for (int i = 0; i + 1 < cuts.size(); ++i) {
+		BulkLoadState piece = task;
+		piece.piece = KeyRangeRef(cuts[i], cuts[i + 1]);
+		piece.setPhase(BulkLoadPhase::Running);
+		piece.files.clear();
+		piece.bytes = 0;
+		while (first < files.size() && files[first].first.end <= piece.piece.begin) {
+			++first;
+		}
+		for (int j = first; j < files.size() && files[j].first.begin < piece.piece.end; ++j) {
+			if (files[j].first.intersects(piece.piece)) {
+				const RangeFile& file = *files[j].second;
+				piece.files.emplace_back(file.fileName, file.fileSize, file.blockSize, files[j].first);
+				piece.bytes += file.fileSize;
+			}
+		}
+		pieces.push_back(std::move(piece));
+	}
+	return pieces;
+}
+
+TEST_CASE("/fdbclient/BulkLoad/splitBulkLoadTask") {
+	auto key = [](int i) { return Key(format("key%04d", i)); };
+	RestorableFileSet fileSet;
+	// Ten files of 100 bytes, the first and last reaching past the task
+	for (int i = 0; i < 10; ++i) {
+		std::string name = format("range,%d,file%d,1024", i, i);
+		fileSet.ranges.push_back(RangeFile{ 1, 1024, name, 100 });
+		fileSet.keyRanges[name] = KeyRangeRef(key(i * 10), key(i * 10 + 10));
+	}
+	// and one outside it
+	fileSet.ranges.push_back(RangeFile{ 1, 1024, "outside", 100 });
+	fileSet.keyRanges["outside"] = KeyRangeRef(key(200), key(210));
+	std::reverse(fileSet.ranges.begin(), fileSet.ranges.end());
+
+	BulkLoadState task(deterministicRandom()->randomUniqueID(), KeyRangeRef(key(5), key(95)), "file://dir", 1);
+	std::vector<BulkLoadState> pieces = splitBulkLoadTask(task, fileSet, 300, 1e6);
+	ASSERT_EQ(pieces.size(), 4);
+	for (int i = 0; i < pieces.size(); ++i) {
+		ASSERT(pieces[i].taskId == task.taskId);
+		ASSERT(pieces[i].range == task.range);
+		ASSERT(pieces[i].getPhase() == BulkLoadPhase::Running);
+		ASSERT(pieces[i].piece.begin == (i == 0 ? task.range.begin : key(i * 30)));
+		ASSERT(pieces[i].piece.end == (i == 3 ? task.range.end : key(i * 30 + 30)));
+		ASSERT_EQ(pieces[i].files.size(), i == 3 ? 1 : 3);
+		ASSERT_EQ(pieces[i].bytes, pieces[i].files.size() * 100);
+		ASSERT(pieces[i].files.front().fileName == format("range,%d,file%d,1024", i * 3, i * 3));
+		ASSERT(pieces[i].files.front().range == KeyRangeRef(key(i * 30), key(i * 30 + 10)));
+	}
+
+	// The names of the files bound the pieces too
+	pieces = splitBulkLoadTask(task, fileSet, 1e9, 1);
+	ASSERT_EQ(pieces.size(), 10);
+	ASSERT(pieces.front().piece.begin == task.range.begin && pieces.back().piece.end == task.range.end);
+
+	// Files go to every piece they intersect
+	fileSet.ranges.push_back(RangeFile{ 1, 1024, "overlap", 100 });
+	fileSet.keyRanges["overlap"] = KeyRangeRef(key(25), key(65));
+	pieces = splitBulkLoadTask(task, fileSet, 300, 1e6);
+	ASSERT_EQ(pieces.size(), 4);
+	ASSERT(pieces[1].piece == KeyRangeRef(key(25), key(50)));
+	ASSERT(pieces[2].piece == KeyRangeRef(key(50), key(80)));
+	ASSERT_EQ(pieces[0].files.size(), 3);
+	ASSERT_EQ(pieces[1].files.size(), 4);
+	ASSERT_EQ(pieces[2].files.size(), 4);
+	ASSERT_EQ(pieces[3].files.size(), 2);
+
+	// A task with no files is a single empty piece
+	pieces = splitBulkLoadTask(task, RestorableFileSet(), 300, 1e6);
+	ASSERT_EQ(pieces.size(), 1);
+	ASSERT(pieces[0].piece == task.range && pieces[0].files.empty());
+
+	return Void();
+}
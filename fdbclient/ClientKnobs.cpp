@@ -22,6 +22,7 @@
 #include "fdbclient/FDBTypes.h"
 #include "fdbclient/SystemData.h"
 #include "fdbclient/Tenant.h"
+#include "flow/CompressionUtils.h"
 #include "flow/IRandom.h"
 #include "flow/UnitTest.h"
 #include "flow/flow.h"
@@ -64,15 +65,20 @@ void ClientKnobs::initialize(Randomize randomize) {
 	init( GRV_ERROR_RETRY_DELAY,                   5.0 ); if( randomize && BUGGIFY ) GRV_ERROR_RETRY_DELAY = 0.01 + 5 * deterministicRandom()->random01();
 	init( UNKNOWN_TENANT_RETRY_DELAY,              .01 ); if( randomize && BUGGIFY ) UNKNOWN_TENANT_RETRY_DELAY = 0.01 + deterministicRandom()->random01();
 	init( REPLY_BYTE_LIMIT,                      80000 );
+	init( PREFIX_COMPRESS_RANGE_REPLIES,          true ); if( randomize && BUGGIFY ) PREFIX_COMPRESS_RANGE_REPLIES = false;
 	init( DEFAULT_BACKOFF,                         .01 ); if( randomize && BUGGIFY ) DEFAULT_BACKOFF = deterministicRandom()->random01();
 	init( DEFAULT_MAX_BACKOFF,                     1.0 );
 	init( BACKOFF_GROWTH_RATE,                     2.0 );
 	init( RESOURCE_CONSTRAINED_MAX_BACKOFF,       30.0 );
 	init( PROXY_COMMIT_OVERHEAD_BYTES,              23 ); //The size of serializing 7 tags (3 primary, 3 remote, 1 log router) + 2 for the tag length
+	init( COMMIT_COMPRESSION_MIN_BYTES,              0 ); if( randomize && BUGGIFY ) COMMIT_COMPRESSION_MIN_BYTES = deterministicRandom()->randomInt(1, 10000); // 0 disables compressing the mutations sent to commit proxies
 	init( SHARD_STAT_SMOOTH_AMOUNT,                5.0 );
 	init( INIT_MID_SHARD_BYTES,               10000000 ); if( randomize && BUGGIFY ) INIT_MID_SHARD_BYTES = 40000; else if(randomize && BUGGIFY_WITH_PROB(0.75)) INIT_MID_SHARD_BYTES = 200000; // The same value as SERVER_KNOBS->MIN_SHARD_BYTES
 
 	init( TRANSACTION_SIZE_LIMIT,                  1e7 );
+	init( COALESCE_READ_CONFLICT_RANGES,          true ); if( randomize && BUGGIFY ) COALESCE_READ_CONFLICT_RANGES = false;
+	init( WIDEN_READ_CONFLICT_RANGES_ABOVE,          0 ); if( randomize && BUGGIFY ) WIDEN_READ_CONFLICT_RANGES_ABOVE = deterministicRandom()->randomInt(1, 10); // 0 never widens
+	init( WIDEN_READ_CONFLICT_RANGES_MIN_PREFIX,     1 ); if( randomize && BUGGIFY ) WIDEN_READ_CONFLICT_RANGES_MIN_PREFIX = deterministicRandom()->randomInt(1, 4);
 	init( KEY_SIZE_LIMIT,                          1e4 );
 	init( SYSTEM_KEY_SIZE_LIMIT,                   3e4 );
 	init( VALUE_SIZE_LIMIT,                        1e5 );
@@ -87,9 +93,15 @@ void ClientKnobs::initialize(Randomize randomize) {
 	init( CHANGE_FEED_CACHE_FLUSH_BYTES,          10e6 ); if( randomize && BUGGIFY ) CHANGE_FEED_CACHE_FLUSH_BYTES = deterministicRandom()->randomInt64(1, 1e6);
 	init( CHANGE_FEED_CACHE_EXPIRE_TIME,          60.0 ); if( randomize && BUGGIFY ) CHANGE_FEED_CACHE_EXPIRE_TIME = 1.0;
 	init( CHANGE_FEED_CACHE_LIMIT_BYTES,        500000 ); if( randomize && BUGGIFY ) CHANGE_FEED_CACHE_LIMIT_BYTES = 50000;
+	init( CHANGE_FEED_MULTI_STREAM_BATCH_SIZE,    1000 ); if( randomize && BUGGIFY ) CHANGE_FEED_MULTI_STREAM_BATCH_SIZE = deterministicRandom()->coinflip() ? 0 : 2;
+	init( CHANGE_FEED_MULTI_STREAM_BATCH_DELAY,   0.01 ); if( randomize && BUGGIFY ) CHANGE_FEED_MULTI_STREAM_BATCH_DELAY = 0.0;
+	init( CHANGE_FEED_MULTI_STREAM_BUFFER_BYTES,   1e7 ); if( randomize && BUGGIFY ) CHANGE_FEED_MULTI_STREAM_BUFFER_BYTES = 1e4;
+	init( CHANGE_FEED_MERGE_BATCH_BYTES,           1e6 ); if( randomize && BUGGIFY ) CHANGE_FEED_MERGE_BATCH_BYTES = 1;
 
 	init( MAX_BATCH_SIZE,                         1000 ); if( randomize && BUGGIFY ) MAX_BATCH_SIZE = 1;
 	init( GRV_BATCH_TIMEOUT,                     0.005 ); if( randomize && BUGGIFY ) GRV_BATCH_TIMEOUT = 0.1;
+	init( THREADSAFE_GRV_QUEUE,                   true ); if( randomize && BUGGIFY ) THREADSAFE_GRV_QUEUE = false;
+	init( THREADSAFE_MUTATION_BATCH_BYTES,      100000 ); if( randomize && BUGGIFY ) THREADSAFE_MUTATION_BATCH_BYTES = deterministicRandom()->coinflip() ? 0 : 100;
 	init( BROADCAST_BATCH_SIZE,                     20 ); if( randomize && BUGGIFY ) BROADCAST_BATCH_SIZE = 1;
 	init( TRANSACTION_TIMEOUT_DELAY_INTERVAL,     10.0 ); if( randomize && BUGGIFY ) TRANSACTION_TIMEOUT_DELAY_INTERVAL = 1.0;
 
@@ -97,13 +109,21 @@ void ClientKnobs::initialize(Randomize randomize) {
 	init( LOCATION_CACHE_EVICTION_SIZE_SIM,         10 ); if( randomize && BUGGIFY ) LOCATION_CACHE_EVICTION_SIZE_SIM = 3;
 	init( LOCATION_CACHE_ENDPOINT_FAILURE_GRACE_PERIOD,     60 );
 	init( LOCATION_CACHE_FAILED_ENDPOINT_RETRY_INTERVAL,    60 );
+	init( LOCATION_CACHE_SNAPSHOT_FILE,                     "" );
+	init( LOCATION_CACHE_SNAPSHOT_MAX_BYTES,             100e6 );
+	init( CLIENT_DB_INFO_CACHE_FILE,                        "" );
+	init( CLIENT_DB_INFO_CACHE_MAX_AGE,                 3600.0 );
+	init( CLIENT_DB_INFO_CACHE_MAX_BYTES,                 10e6 );
 
 	init( GET_RANGE_SHARD_LIMIT,                     2 );
 	init( WARM_RANGE_SHARD_LIMIT,                  100 );
+	init( PARALLEL_RANGE_READ_SHARDS,                8 ); if( randomize && BUGGIFY ) PARALLEL_RANGE_READ_SHARDS = 2;
 	init( STORAGE_METRICS_SHARD_LIMIT,             100 ); if( randomize && BUGGIFY ) STORAGE_METRICS_SHARD_LIMIT = 10;
 	init( SHARD_COUNT_LIMIT,                        80 ); if( randomize && BUGGIFY ) SHARD_COUNT_LIMIT = 3;
 	init( STORAGE_METRICS_UNFAIR_SPLIT_LIMIT,  2.0/3.0 );
 	init( STORAGE_METRICS_TOO_MANY_SHARDS_DELAY,  15.0 );
+	init( STORAGE_METRICS_BATCH_SIZE,             1000 ); if( randomize && BUGGIFY ) STORAGE_METRICS_BATCH_SIZE = deterministicRandom()->coinflip() ? 0 : 2;
+	init( STORAGE_METRICS_BATCH_DELAY,            0.05 ); if( randomize && BUGGIFY ) STORAGE_METRICS_BATCH_DELAY = 0.0;
 	init( AGGREGATE_HEALTH_METRICS_MAX_STALENESS,  0.5 );
 	init( DETAILED_HEALTH_METRICS_MAX_STALENESS,   5.0 );
 	init( MID_SHARD_SIZE_MAX_STALENESS,           10.0 );
@@ -134,6 +154,7 @@ void ClientKnobs::initialize(Randomize randomize) {
 	init( FORCE_GRV_CACHE_OFF,                    false );
 	init( GRV_CACHE_RK_COOLDOWN,                   60.0 );
 	init( GRV_SUSTAINED_THROTTLING_THRESHOLD,       0.1 );
+	init( RYW_DEFER_WRITES,                        true ); if( randomize && BUGGIFY ) RYW_DEFER_WRITES = false;
 
 	// TaskBucket
 	init( TASKBUCKET_LOGGING_DELAY,                5.0 );
@@ -171,6 +192,7 @@ void ClientKnobs::initialize(Randomize randomize) {
 	init( COPY_LOG_BLOCK_SIZE,              LOG_RANGE_BLOCK_SIZE ); // the maximum possible value due the getLogRanges limitations
 	init( COPY_LOG_BLOCKS_PER_TASK,               1000 );
 	init( COPY_LOG_PREFETCH_BLOCKS,                  3 );
+	init( COPY_LOG_PARALLEL_BLOCKS,                  3 ); if( randomize && BUGGIFY ) COPY_LOG_PARALLEL_BLOCKS = deterministicRandom()->randomInt(1, 6);
 	init( COPY_LOG_READ_AHEAD_BYTES,        BACKUP_LOCK_BYTES / COPY_LOG_PREFETCH_BLOCKS); // each task will use up to COPY_LOG_PREFETCH_BLOCKS * COPY_LOG_READ_AHEAD_BYTES memory
 	init( COPY_LOG_TASK_DURATION_NANOS,	      1e10 ); // 10 seconds
 	init( BACKUP_TASKS_PER_AGENT,                   10 );
@@ -180,10 +202,15 @@ void ClientKnobs::initialize(Randomize randomize) {
 	init( SIM_BACKUP_TASKS_PER_AGENT,               10 );
 	init( BACKUP_RANGEFILE_BLOCK_SIZE,      1024 * 1024);
 	init( BACKUP_LOGFILE_BLOCK_SIZE,        1024 * 1024);
+	init( BACKUP_COMPRESSION_FILTER,             "NONE" ); if( randomize && BUGGIFY ) BACKUP_COMPRESSION_FILTER = CompressionUtils::toString(CompressionUtils::getRandomFilter());
+	init( BACKUP_COMPRESSION_CHUNK_BYTES,         128e3 ); if( randomize && BUGGIFY ) BACKUP_COMPRESSION_CHUNK_BYTES = deterministicRandom()->randomInt(1, 300e3);
+	init( BACKUP_CHECKPOINT_TIMEOUT,              300.0 );
+	init( BACKUP_CHECKPOINT_FILE_ATTEMPTS,           3 );
 	init( BACKUP_DISPATCH_ADDTASK_SIZE,             50 );
 	init( RESTORE_DISPATCH_ADDTASK_SIZE,           150 );
 	init( RESTORE_DISPATCH_BATCH_SIZE,           30000 ); if( randomize && BUGGIFY ) RESTORE_DISPATCH_BATCH_SIZE = 20;
 	init( RESTORE_WRITE_TX_SIZE,            256 * 1024 );
+	init( RESTORE_WRITE_TX_PARALLELISM,              4 ); if( randomize && BUGGIFY ) RESTORE_WRITE_TX_PARALLELISM = deterministicRandom()->randomInt(1, 10);
 	init( APPLY_MAX_LOCK_BYTES,                    1e9 );
 	init( APPLY_MIN_LOCK_BYTES,                   11e6 ); //Must be bigger than TRANSACTION_SIZE_LIMIT
 	init( APPLY_BLOCK_SIZE,     LOG_RANGE_BLOCK_SIZE/5 );
@@ -225,6 +252,9 @@ void ClientKnobs::initialize(Randomize randomize) {
 	init( BLOBSTORE_CONCURRENT_UPLOADS, BACKUP_TASKS_PER_AGENT*2 );
 	init( BLOBSTORE_CONCURRENT_LISTS,               20 );
 	init( BLOBSTORE_CONCURRENT_REQUESTS, BLOBSTORE_CONCURRENT_UPLOADS + BLOBSTORE_CONCURRENT_LISTS + 5);
+	init( BLOBSTORE_MAX_CONCURRENT_UPLOADS,          0 ); // 0 keeps uploads at BLOBSTORE_CONCURRENT_UPLOADS
+	init( BLOBSTORE_UPLOAD_CONCURRENCY_INTERVAL,   5.0 );
+	init( BLOBSTORE_PREWARM_CONNECTIONS,             0 );
 
 	init( BLOBSTORE_CONCURRENT_WRITES_PER_FILE,      5 );
 	init( BLOBSTORE_CONCURRENT_READS_PER_FILE,       3 );
@@ -309,6 +339,8 @@ void ClientKnobs::initialize(Randomize randomize) {
 	// Blob granules
 	init( BG_MAX_GRANULE_PARALLELISM,                10 );
 	init( BG_TOO_MANY_GRANULES,                   20000 );
+	init( BG_CLIENT_FILE_CACHE_BYTES,                 0 ); if( randomize && BUGGIFY ) BG_CLIENT_FILE_CACHE_BYTES = 1 << deterministicRandom()->randomInt(10, 25);
+	init( BG_CLIENT_FILE_HEADER_READ_BYTES,       65536 ); if( randomize && BUGGIFY ) BG_CLIENT_FILE_HEADER_READ_BYTES = deterministicRandom()->randomInt(16, 1024);
 	init( BLOB_METADATA_REFRESH_INTERVAL,          3600 ); if ( randomize && BUGGIFY ) { BLOB_METADATA_REFRESH_INTERVAL = deterministicRandom()->randomInt(5, 120); }
 	init( DETERMINISTIC_BLOB_METADATA,            false ); if( randomize && BUGGIFY_WITH_PROB(0.01) ) DETERMINISTIC_BLOB_METADATA = true;
 	init( ENABLE_BLOB_GRANULE_FILE_LOGICAL_SIZE,  false ); if ( randomize && BUGGIFY ) { ENABLE_BLOB_GRANULE_FILE_LOGICAL_SIZE = true; }
@@ -1,6 +1,30 @@
 #include "fdbclient/CommitProxyInterface.h"
 #include "fdbclient/CoordinationInterface.h"
 #include "fdbclient/GetEncryptCipherKeys_impl.actor.h"
+#include "flow/CompressionUtils.h"
+#include "flow/UnitTest.h"
+
+bool CommitTransactionRequest::compressMutations() {
+	ASSERT(!compressedMutations.present());
+	BinaryWriter wr(IncludeVersion(ProtocolVersion::withCompressedCommit()));
+	wr << transaction.mutations;
+	StringRef compressed = CompressionUtils::compress(CompressionFilter::ZSTD, wr.toValue(), arena);
+	if (compressed.size() >= wr.getLength()) {
+		return false;
+	}
+	compressedMutations = compressed;
+	transaction.mutations = VectorRef<MutationRef>();
+	return true;
+}
+
+void CommitTransactionRequest::decompressMutations() {
+	ASSERT(transaction.mutations.empty());
+	CompressionUtils::checkFilterSupported(CompressionFilter::ZSTD);
+	StringRef serialized = CompressionUtils::decompress(CompressionFilter::ZSTD, compressedMutations.get(), arena);
+	ArenaReader rd(arena, serialized, IncludeVersion());
+	rd >> transaction.mutations;
+	compressedMutations.reset();
+}
 
 // Instantiate ClientDBInfo related templates
 template class ReplyPromise<struct ClientDBInfo>;
@@ -12,4 +36,35 @@ template struct NetNotifiedQueue<OpenDatabaseCoordRequest, true>;
 
 // Instantiate GetKeyServerLocationsReply related templates
 template class ReplyPromise<GetKeyServerLocationsReply>;
-template struct NetSAV<GetKeyServerLocationsReply>;
\ No newline at end of file
+template struct NetSAV<GetKeyServerLocationsReply>;
+TEST_CASE("/fdbclient/CommitProxyInterface/compressMutations") {
+	if (!CompressionUtils::supportedFilters.count(CompressionFilter::ZSTD)) {
+		return Void();
+	}
+	CommitTransactionRequest req;
+	Value value = makeString(1000);
+	memset(mutateString(value), 'v', value.size());
+	for (int i = 0; i < 100; i++) {
+		req.transaction.mutations.push_back_deep(req.arena,
+		                                         MutationRef(MutationRef::SetValue, StringRef(format("key%d", i)), value));
+	}
+	req.transaction.mutations.push_back_deep(req.arena, MutationRef(MutationRef::ClearRange, "a"_sr, "b"_sr));
+	const Standalone<VectorRef<MutationRef>> mutations(req.transaction.mutations, req.arena);
+
+	ASSERT(req.compressMutations());
+	ASSERT(req.transaction.mutations.empty() && req.compressedMutations.get().size() < mutations.expectedSize());
+
+	req.decompressMutations();
+	ASSERT(!req.compressedMutations.present() && req.transaction.mutations.size() == mutations.size());
+	for (int i = 0; i < mutations.size(); i++) {
+		ASSERT(req.transaction.mutations[i].type == mutations[i].type);
+		ASSERT(req.transaction.mutations[i].param1 == mutations[i].param1);
+		ASSERT(req.transaction.mutations[i].param2 == mutations[i].param2);
+	}
+
+	// Mutations that don't compress are sent as they are
+	CommitTransactionRequest small;
+	small.transaction.mutations.push_back_deep(small.arena, MutationRef(MutationRef::SetValue, "k"_sr, "v"_sr));
+	ASSERT(!small.compressMutations() && small.transaction.mutations.size() == 1);
+	return Void();
+}
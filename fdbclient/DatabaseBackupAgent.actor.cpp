@@ -35,6 +35,7 @@
 #include "fdbclient/ManagementAPI.actor.h"
 #include "fdbclient/KeyBackedTypes.actor.h"
 #include <inttypes.h>
+#include <deque>
 #include <map>
 
 #include "flow/actorcompiler.h" // has to be last include
@@ -882,6 +883,10 @@ struct CopyLogRangeTaskFunc : TaskFuncBase {
 		state std::vector<PromiseStream<RCGroup>> results;
 		state std::vector<Future<Void>> rc;
 		state std::vector<Reference<FlowLock>> locks;
+		// The copies of the ranges [rangeN, rangeN + dumps.size()), which run concurrently. The ranges hold disjoint
+		// versions, and the destination applies nothing of this task's versions until the task is done, so the
+		// order in which they are copied doesn't matter.
+		state std::deque<Future<Optional<Version>>> dumps;
 		state Version nextVersion = beginVersion;
 		state double breakTime = timer_monotonic() + CLIENT_KNOBS->COPY_LOG_TASK_DURATION_NANOS;
 		state int rangeN = 0;
@@ -891,7 +896,9 @@ struct CopyLogRangeTaskFunc : TaskFuncBase {
 				break;
 
 			// prefetch
-			int prefetchTo = std::min(rangeN + CLIENT_KNOBS->COPY_LOG_PREFETCH_BLOCKS, nRanges);
+			int prefetchTo = std::min(
+			    rangeN + std::max(CLIENT_KNOBS->COPY_LOG_PREFETCH_BLOCKS, CLIENT_KNOBS->COPY_LOG_PARALLEL_BLOCKS),
+			    nRanges);
 
 			for (int j = results.size(); j < prefetchTo; j++) {
 				results.push_back(PromiseStream<RCGroup>());
@@ -907,18 +914,26 @@ struct CopyLogRangeTaskFunc : TaskFuncBase {
 				                           LockAware::True));
 			}
 
-			// copy the range
-			Optional<Version> nextVersionBr =
-			    wait(dumpData(cx, task, results[rangeN], locks[rangeN].getPtr(), taskBucket, breakTime));
+			// copy the ranges, and wait for the first one
+			while (dumps.size() < std::max<size_t>(1, CLIENT_KNOBS->COPY_LOG_PARALLEL_BLOCKS) &&
+			       rangeN + dumps.size() < results.size()) {
+				int j = rangeN + dumps.size();
+				dumps.push_back(dumpData(cx, task, results[j], locks[j].getPtr(), taskBucket, breakTime));
+			}
+			Optional<Version> nextVersionBr = wait(dumps.front());
+			dumps.pop_front();
 
-			// exit from the task if a timeout occurs
+			// exit from the task if a timeout occurs. The later ranges are copied again by the next task, from
+			// nextVersion.
 			if (nextVersionBr.present()) {
 				nextVersion = nextVersionBr.get();
 				// cancel prefetch
 				TraceEvent(SevInfo, "CopyLogRangeTaskFuncAborted")
 				    .detail("DurationNanos", CLIENT_KNOBS->COPY_LOG_TASK_DURATION_NANOS)
 				    .detail("RangeN", rangeN)
+				    .detail("ConcurrentRanges", dumps.size())
 				    .detail("BytesWritten", Params.bytesWritten().getOrDefault(task));
+				dumps.clear();
 				for (int j = results.size(); --j >= rangeN;)
 					rc[j].cancel();
 				break;
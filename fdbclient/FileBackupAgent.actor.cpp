@@ -31,6 +31,7 @@
 #include "flow/flow.h"
 #include "fmt/format.h"
 #include "fdbclient/BackupAgent.actor.h"
+#include "fdbclient/BackupBlockCompression.h"
 #include "fdbclient/BackupContainer.h"
 #include "fdbclient/BlobCipher.h"
 #include "fdbclient/ClientBooleanParams.h"
@@ -517,6 +518,9 @@ public:
 
 	virtual Future<Void> finish() = 0;
 
+	// Returns the size the file would have had without compression
+	virtual int64_t uncompressedSize() const = 0;
+
 	virtual ~IRangeFileWriter() {}
 };
 
@@ -564,17 +568,28 @@ struct SnapshotFileBackupEncryptionKeys {
 //   when a new tenant id is encountered. If a block is split for crossing tenant boundaries then the last key will be
 //   truncated to just the tenant prefix and the value will be empty (to avoid having sensitive data of one tenant be
 //   encrypted with a key for a different tenant)
+//
+//   NOTE: With a compression filter the blocks are written with
+//   BACKUP_AGENT_ENCRYPTED_COMPRESSED_SNAPSHOT_FILE_VERSION, and what is encrypted is the compressed payload of the
+//   block, see BackupBlockCompression.h
 struct EncryptedRangeFileWriter : public IRangeFileWriter {
 	EncryptedRangeFileWriter(Database cx,
 	                         Arena* arena,
 	                         EncryptionAtRestMode encryptMode,
 	                         Optional<Reference<TenantEntryCache<Void>>> tenantCache,
 	                         Reference<IBackupFile> file = Reference<IBackupFile>(),
-	                         int blockSize = 0)
+	                         int blockSize = 0,
+	                         CompressionFilter compression = CompressionFilter::NONE)
 	  : cx(cx), arena(arena), file(file), encryptMode(encryptMode), tenantCache(tenantCache), blockSize(blockSize),
-	    blockEnd(0), fileVersion(BACKUP_AGENT_ENCRYPTED_SNAPSHOT_FILE_VERSION) {
+	    blockEnd(0), fileVersion(compression == CompressionFilter::NONE
+	                                 ? BACKUP_AGENT_ENCRYPTED_SNAPSHOT_FILE_VERSION
+	                                 : BACKUP_AGENT_ENCRYPTED_COMPRESSED_SNAPSHOT_FILE_VERSION) {
 		buffer = makeString(blockSize);
 		wPtr = mutateString(buffer);
+		if (compression != CompressionFilter::NONE) {
+			compressor = BackupBlockCompressor(
+			    compression, blockSize - (sizeof(fileVersion) + sizeof(uint32_t) + getEncryptHeaderSize()));
+		}
 	}
 
 	ACTOR static Future<StringRef> decryptImpl(Database cx,
@@ -687,6 +702,10 @@ struct EncryptedRangeFileWriter : public IRangeFileWriter {
 	}
 
 	static void appendStringRefWithLenToBuffer(EncryptedRangeFileWriter* self, StringRef* s) {
+		if (self->compressor.present()) {
+			self->compressor.get().appendStringRefWithLen(*s);
+			return;
+		}
 		// Append the string length followed by the string to the buffer
 		uint32_t lenBuf = bigEndian32((uint32_t)s->size());
 		copyToBuffer(self, &lenBuf, sizeof(lenBuf));
@@ -719,6 +738,56 @@ struct EncryptedRangeFileWriter : public IRangeFileWriter {
 		return tenantId;
 	}
 
+	static uint32_t getEncryptHeaderSize() {
+		EncryptAuthTokenMode authTokenMode =
+		    getEncryptAuthTokenMode(EncryptAuthTokenMode::ENCRYPT_HEADER_AUTH_TOKEN_MODE_SINGLE);
+		EncryptAuthTokenAlgo authTokenAlgo = getAuthTokenAlgoFromMode(authTokenMode);
+		uint32_t headerSize =
+		    BlobCipherEncryptHeaderRef::getHeaderSize(CLIENT_KNOBS->ENCRYPT_HEADER_FLAGS_VERSION,
+		                                              getEncryptCurrentAlgoHeaderVersion(authTokenMode, authTokenAlgo),
+		                                              ENCRYPT_CIPHER_MODE_AES_256_CTR,
+		                                              authTokenMode,
+		                                              authTokenAlgo);
+		ASSERT(headerSize > 0);
+		return headerSize;
+	}
+
+	// Writes the version and encryption header size of a block to the buffer and leaves space for the encryption header
+	static void writeBlockHeader(EncryptedRangeFileWriter* self) {
+		// write Header
+		copyToBuffer(self, (uint8_t*)&self->fileVersion, sizeof(self->fileVersion));
+
+		// write header size to buffer
+		uint32_t headerSize = getEncryptHeaderSize();
+		copyToBuffer(self, (uint8_t*)&headerSize, sizeof(headerSize));
+		// leave space for encryption header
+		self->encryptHeader = StringRef(self->wPtr, headerSize);
+		self->wPtr += headerSize;
+		self->dataPayloadStart = self->wPtr;
+	}
+
+	// Encrypts the current compressed block and writes it to the file, padded to a whole block size if pad is true.
+	// The block is laid out in the buffer like an uncompressed block, with the compressed payload in place of the kv
+	// pairs, so the payload is what gets encrypted.
+	ACTOR static Future<Void> writeCompressedBlock(EncryptedRangeFileWriter* self, bool pad) {
+		ASSERT(currentBufferSize(self) == 0);
+		writeBlockHeader(self);
+		Standalone<StringRef> payload = self->compressor.get().finishBlock(pad);
+		copyToBuffer(self, payload.begin(), payload.size());
+		wait(encrypt(self));
+		wait(self->file->append(self->buffer.begin(), currentBufferSize(self)));
+		self->wPtr = mutateString(self->buffer);
+		return Void();
+	}
+
+	// Returns whether bytesNeeded more bytes fit in the current block
+	static bool fits(EncryptedRangeFileWriter* self, int bytesNeeded) {
+		if (self->compressor.present()) {
+			return self->compressor.get().fits(bytesNeeded);
+		}
+		return expectedFileSize(self) + bytesNeeded <= self->blockEnd;
+	}
+
 	// Handles the first block and internal blocks.  Ends current block if needed.
 	// The final flag is used in simulation to pad the file's final block to a whole block size
 	ACTOR static Future<Void> newBlock(EncryptedRangeFileWriter* self,
@@ -726,22 +795,28 @@ struct EncryptedRangeFileWriter : public IRangeFileWriter {
 	                                   KeyRef lastKey,
 	                                   bool writeValue,
 	                                   bool final = false) {
-		// Write padding to finish current block if needed
-		int bytesLeft = self->blockEnd - expectedFileSize(self);
-		ASSERT(bytesLeft >= 0);
-		if (bytesLeft > 0) {
-			state Value paddingFFs = makePadding(bytesLeft);
-			copyToBuffer(self, paddingFFs.begin(), bytesLeft);
-		}
+		if (self->compressor.present()) {
+			if (!self->compressor.get().empty()) {
+				wait(writeCompressedBlock(self, true));
+			}
+		} else {
+			// Write padding to finish current block if needed
+			int bytesLeft = self->blockEnd - expectedFileSize(self);
+			ASSERT(bytesLeft >= 0);
+			if (bytesLeft > 0) {
+				state Value paddingFFs = makePadding(bytesLeft);
+				copyToBuffer(self, paddingFFs.begin(), bytesLeft);
+			}
 
-		if (expectedFileSize(self) > 0) {
-			// write buffer to file since block is finished
-			ASSERT(currentBufferSize(self) == self->blockSize);
-			wait(encrypt(self));
-			wait(self->file->append(self->buffer.begin(), self->blockSize));
+			if (expectedFileSize(self) > 0) {
+				// write buffer to file since block is finished
+				ASSERT(currentBufferSize(self) == self->blockSize);
+				wait(encrypt(self));
+				wait(self->file->append(self->buffer.begin(), self->blockSize));
 
-			// reset write pointer to beginning of StringRef
-			self->wPtr = mutateString(self->buffer);
+				// reset write pointer to beginning of StringRef
+				self->wPtr = mutateString(self->buffer);
+			}
 		}
 
 		if (final) {
@@ -752,27 +827,10 @@ struct EncryptedRangeFileWriter : public IRangeFileWriter {
 		// Set new blockEnd
 		self->blockEnd += self->blockSize;
 
-		// write Header
-		copyToBuffer(self, (uint8_t*)&self->fileVersion, sizeof(self->fileVersion));
-
-		// calculate encryption header size
-		uint32_t headerSize = 0;
-		EncryptAuthTokenMode authTokenMode =
-		    getEncryptAuthTokenMode(EncryptAuthTokenMode::ENCRYPT_HEADER_AUTH_TOKEN_MODE_SINGLE);
-		EncryptAuthTokenAlgo authTokenAlgo = getAuthTokenAlgoFromMode(authTokenMode);
-		headerSize =
-		    BlobCipherEncryptHeaderRef::getHeaderSize(CLIENT_KNOBS->ENCRYPT_HEADER_FLAGS_VERSION,
-		                                              getEncryptCurrentAlgoHeaderVersion(authTokenMode, authTokenAlgo),
-		                                              ENCRYPT_CIPHER_MODE_AES_256_CTR,
-		                                              authTokenMode,
-		                                              authTokenAlgo);
-		ASSERT(headerSize > 0);
-		// write header size to buffer
-		copyToBuffer(self, (uint8_t*)&headerSize, sizeof(headerSize));
-		// leave space for encryption header
-		self->encryptHeader = StringRef(self->wPtr, headerSize);
-		self->wPtr += headerSize;
-		self->dataPayloadStart = self->wPtr;
+		// Compressed blocks get their header when they are written
+		if (!self->compressor.present()) {
+			writeBlockHeader(self);
+		}
 
 		// If this is NOT the first block then write duplicate stuff needed from last block
 		if (self->blockEnd > self->blockSize) {
@@ -784,7 +842,7 @@ struct EncryptedRangeFileWriter : public IRangeFileWriter {
 		}
 
 		// There must now be room in the current block for bytesNeeded or the block size is too small
-		if (expectedFileSize(self) + bytesNeeded > self->blockEnd) {
+		if (!fits(self, bytesNeeded)) {
 			throw backup_bad_block_size();
 		}
 
@@ -792,7 +850,7 @@ struct EncryptedRangeFileWriter : public IRangeFileWriter {
 	}
 
 	Future<Void> padEnd(bool final) {
-		if (expectedFileSize(this) > 0) {
+		if (expectedFileSize(this) > 0 || (compressor.present() && !compressor.get().empty())) {
 			return newBlock(this, 0, StringRef(), true, final);
 		}
 		return Void();
@@ -800,7 +858,7 @@ struct EncryptedRangeFileWriter : public IRangeFileWriter {
 
 	// Ends the current block if necessary based on bytesNeeded.
 	ACTOR static Future<Void> newBlockIfNeeded(EncryptedRangeFileWriter* self, int bytesNeeded) {
-		if (expectedFileSize(self) + bytesNeeded > self->blockEnd) {
+		if (!fits(self, bytesNeeded)) {
 			wait(newBlock(self, bytesNeeded, self->lastKey, true));
 		}
 		return Void();
@@ -898,7 +956,11 @@ struct EncryptedRangeFileWriter : public IRangeFileWriter {
 
 	ACTOR static Future<Void> finish_impl(EncryptedRangeFileWriter* self) {
 		// Write any outstanding bytes to the file
-		if (currentBufferSize(self) > 0) {
+		if (self->compressor.present()) {
+			if (!self->compressor.get().empty()) {
+				wait(writeCompressedBlock(self, false));
+			}
+		} else if (currentBufferSize(self) > 0) {
 			wait(encrypt(self));
 			wait(self->file->append(self->buffer.begin(), currentBufferSize(self)));
 		}
@@ -907,6 +969,13 @@ struct EncryptedRangeFileWriter : public IRangeFileWriter {
 
 	Future<Void> finish() { return finish_impl(this); }
 
+	int64_t uncompressedSize() const {
+		if (compressor.present()) {
+			return file->size() + compressor.get().getUncompressedBytes() - compressor.get().getCompressedBytes();
+		}
+		return file->size();
+	}
+
 	Database cx;
 	Arena* arena;
 	EncryptionAtRestMode encryptMode;
@@ -924,6 +993,7 @@ private:
 	Key lastKey;
 	Key lastValue;
 	SnapshotFileBackupEncryptionKeys cipherKeys;
+	Optional<BackupBlockCompressor> compressor;
 };
 
 // File Format handlers.
@@ -959,18 +1029,43 @@ private:
 //   if the next KV pair wouldn't fit within the block after the value
 //   then the space after the final key to the next 1MB boundary would
 //   just be padding anyway.
+//
+//   NOTE: With a compression filter the blocks are written with BACKUP_AGENT_COMPRESSED_SNAPSHOT_FILE_VERSION, and
+//   each block holds as many kv pairs as fit once compressed, see BackupBlockCompression.h
 struct RangeFileWriter : public IRangeFileWriter {
-	RangeFileWriter(Reference<IBackupFile> file = Reference<IBackupFile>(), int blockSize = 0)
-	  : file(file), blockSize(blockSize), blockEnd(0), fileVersion(BACKUP_AGENT_SNAPSHOT_FILE_VERSION) {}
+	RangeFileWriter(Reference<IBackupFile> file = Reference<IBackupFile>(),
+	                int blockSize = 0,
+	                CompressionFilter compression = CompressionFilter::NONE)
+	  : file(file), blockSize(blockSize), blockEnd(0),
+	    fileVersion(compression == CompressionFilter::NONE ? BACKUP_AGENT_SNAPSHOT_FILE_VERSION
+	                                                       : BACKUP_AGENT_COMPRESSED_SNAPSHOT_FILE_VERSION) {
+		if (compression != CompressionFilter::NONE) {
+			compressor = BackupBlockCompressor(compression, blockSize - sizeof(fileVersion));
+		}
+	}
+
+	// Writes the current compressed block to the file, padded to a whole block size if pad is true
+	ACTOR static Future<Void> writeCompressedBlock(RangeFileWriter* self, bool pad) {
+		state Standalone<StringRef> payload = self->compressor.get().finishBlock(pad);
+		wait(self->file->append((uint8_t*)&self->fileVersion, sizeof(self->fileVersion)));
+		wait(self->file->append(payload.begin(), payload.size()));
+		return Void();
+	}
 
 	// Handles the first block and internal blocks.  Ends current block if needed.
 	// The final flag is used in simulation to pad the file's final block to a whole block size
 	ACTOR static Future<Void> newBlock(RangeFileWriter* self, int bytesNeeded, bool final = false) {
 		// Write padding to finish current block if needed
-		int bytesLeft = self->blockEnd - self->file->size();
-		if (bytesLeft > 0) {
-			state Value paddingFFs = makePadding(bytesLeft);
-			wait(self->file->append(paddingFFs.begin(), bytesLeft));
+		if (self->compressor.present()) {
+			if (!self->compressor.get().empty()) {
+				wait(writeCompressedBlock(self, true));
+			}
+		} else {
+			int bytesLeft = self->blockEnd - self->file->size();
+			if (bytesLeft > 0) {
+				state Value paddingFFs = makePadding(bytesLeft);
+				wait(self->file->append(paddingFFs.begin(), bytesLeft));
+			}
 		}
 
 		if (final) {
@@ -981,18 +1076,20 @@ struct RangeFileWriter : public IRangeFileWriter {
 		// Set new blockEnd
 		self->blockEnd += self->blockSize;
 
-		// write Header
-		wait(self->file->append((uint8_t*)&self->fileVersion, sizeof(self->fileVersion)));
+		// write Header, which compressed blocks get when they are written
+		if (!self->compressor.present()) {
+			wait(self->file->append((uint8_t*)&self->fileVersion, sizeof(self->fileVersion)));
+		}
 
 		// If this is NOT the first block then write duplicate stuff needed from last block
 		if (self->blockEnd > self->blockSize) {
-			wait(self->file->appendStringRefWithLen(self->lastKey));
-			wait(self->file->appendStringRefWithLen(self->lastKey));
-			wait(self->file->appendStringRefWithLen(self->lastValue));
+			wait(self->appendStringRefWithLen(self->lastKey));
+			wait(self->appendStringRefWithLen(self->lastKey));
+			wait(self->appendStringRefWithLen(self->lastValue));
 		}
 
 		// There must now be room in the current block for bytesNeeded or the block size is too small
-		if (self->file->size() + bytesNeeded > self->blockEnd)
+		if (!self->fits(bytesNeeded))
 			throw backup_bad_block_size();
 
 		return Void();
@@ -1001,15 +1098,31 @@ struct RangeFileWriter : public IRangeFileWriter {
 	// Used in simulation only to create backup file sizes which are an integer multiple of the block size
 	Future<Void> padEnd(bool final) {
 		ASSERT(g_network->isSimulated());
-		if (file->size() > 0) {
+		if (file->size() > 0 || (compressor.present() && !compressor.get().empty())) {
 			return newBlock(this, 0, final);
 		}
 		return Void();
 	}
 
+	// Returns whether bytesNeeded more bytes fit in the current block
+	bool fits(int bytesNeeded) {
+		if (compressor.present()) {
+			return compressor.get().fits(bytesNeeded);
+		}
+		return file->size() + bytesNeeded <= blockEnd;
+	}
+
+	Future<Void> appendStringRefWithLen(Standalone<StringRef> s) {
+		if (compressor.present()) {
+			compressor.get().appendStringRefWithLen(s);
+			return Void();
+		}
+		return file->appendStringRefWithLen(s);
+	}
+
 	// Ends the current block if necessary based on bytesNeeded.
 	Future<Void> newBlockIfNeeded(int bytesNeeded) {
-		if (file->size() + bytesNeeded > blockEnd)
+		if (!fits(bytesNeeded))
 			return newBlock(this, bytesNeeded);
 		return Void();
 	}
@@ -1018,8 +1131,8 @@ struct RangeFileWriter : public IRangeFileWriter {
 	ACTOR static Future<Void> writeKV_impl(RangeFileWriter* self, Key k, Value v) {
 		int toWrite = sizeof(int32_t) + k.size() + sizeof(int32_t) + v.size();
 		wait(self->newBlockIfNeeded(toWrite));
-		wait(self->file->appendStringRefWithLen(k));
-		wait(self->file->appendStringRefWithLen(v));
+		wait(self->appendStringRefWithLen(k));
+		wait(self->appendStringRefWithLen(v));
 		self->lastKey = k;
 		self->lastValue = v;
 		return Void();
@@ -1031,13 +1144,26 @@ struct RangeFileWriter : public IRangeFileWriter {
 	ACTOR static Future<Void> writeKey_impl(RangeFileWriter* self, Key k) {
 		int toWrite = sizeof(uint32_t) + k.size();
 		wait(self->newBlockIfNeeded(toWrite));
-		wait(self->file->appendStringRefWithLen(k));
+		wait(self->appendStringRefWithLen(k));
 		return Void();
 	}
 
 	Future<Void> writeKey(Key k) { return writeKey_impl(this, k); }
 
-	Future<Void> finish() { return Void(); }
+	// Write the last compressed block, which isn't padded
+	Future<Void> finish() {
+		if (compressor.present() && !compressor.get().empty()) {
+			return writeCompressedBlock(this, false);
+		}
+		return Void();
+	}
+
+	int64_t uncompressedSize() const {
+		if (compressor.present()) {
+			return file->size() + compressor.get().getUncompressedBytes() - compressor.get().getCompressedBytes();
+		}
+		return file->size();
+	}
 
 	Reference<IBackupFile> file;
 	int blockSize;
@@ -1047,6 +1173,7 @@ private:
 	uint32_t fileVersion;
 	Key lastKey;
 	Key lastValue;
+	Optional<BackupBlockCompressor> compressor;
 };
 
 ACTOR static Future<Void> decodeKVPairs(StringRefReader* reader,
@@ -1145,9 +1272,14 @@ Standalone<VectorRef<KeyValueRef>> decodeRangeFileBlock(const Standalone<StringR
 	Standalone<VectorRef<KeyValueRef>> results({}, buf.arena());
 	StringRefReader reader(buf, restore_corrupted_data());
 
-	// Read header, currently only decoding BACKUP_AGENT_SNAPSHOT_FILE_VERSION
-	if (reader.consume<int32_t>() != BACKUP_AGENT_SNAPSHOT_FILE_VERSION)
+	// Read header, currently only decoding BACKUP_AGENT_SNAPSHOT_FILE_VERSION or
+	// BACKUP_AGENT_COMPRESSED_SNAPSHOT_FILE_VERSION
+	int32_t fileVersion = reader.consume<int32_t>();
+	if (fileVersion == BACKUP_AGENT_COMPRESSED_SNAPSHOT_FILE_VERSION) {
+		reader = StringRefReader(decompressBackupBlock(reader.remainder(), results.arena()), restore_corrupted_data());
+	} else if (fileVersion != BACKUP_AGENT_SNAPSHOT_FILE_VERSION) {
 		throw restore_unsupported_file_version();
+	}
 
 	// Read begin key, if this fails then block was invalid.
 	uint32_t kLen = reader.consumeNetworkUInt32();
@@ -1199,13 +1331,20 @@ ACTOR Future<Standalone<VectorRef<KeyValueRef>>> decodeRangeFileBlock(Reference<
 	state int64_t blockDomainId = TenantInfo::INVALID_TENANT;
 
 	try {
-		// Read header, currently only decoding BACKUP_AGENT_SNAPSHOT_FILE_VERSION or
-		// BACKUP_AGENT_ENCRYPTED_SNAPSHOT_FILE_VERSION
-		int32_t file_version = reader.consume<int32_t>();
-		ASSERT(!encryptMode.isEncryptionEnabled() || file_version == BACKUP_AGENT_ENCRYPTED_SNAPSHOT_FILE_VERSION);
+		// Read header, currently only decoding BACKUP_AGENT_SNAPSHOT_FILE_VERSION,
+		// BACKUP_AGENT_ENCRYPTED_SNAPSHOT_FILE_VERSION or their compressed versions
+		state int32_t file_version = reader.consume<int32_t>();
+		ASSERT(!encryptMode.isEncryptionEnabled() || file_version == BACKUP_AGENT_ENCRYPTED_SNAPSHOT_FILE_VERSION ||
+		       file_version == BACKUP_AGENT_ENCRYPTED_COMPRESSED_SNAPSHOT_FILE_VERSION);
 		if (file_version == BACKUP_AGENT_SNAPSHOT_FILE_VERSION) {
 			wait(decodeKVPairs(&reader, &results, false, encryptMode, Optional<int64_t>(), tenantCache));
-		} else if (file_version == BACKUP_AGENT_ENCRYPTED_SNAPSHOT_FILE_VERSION) {
+		} else if (file_version == BACKUP_AGENT_COMPRESSED_SNAPSHOT_FILE_VERSION) {
+			CODE_PROBE(true, "decoding compressed block");
+			reader = StringRefReader(decompressBackupBlock(reader.remainder(), results.arena()),
+			                         restore_corrupted_data());
+			wait(decodeKVPairs(&reader, &results, false, encryptMode, Optional<int64_t>(), tenantCache));
+		} else if (file_version == BACKUP_AGENT_ENCRYPTED_SNAPSHOT_FILE_VERSION ||
+		           file_version == BACKUP_AGENT_ENCRYPTED_COMPRESSED_SNAPSHOT_FILE_VERSION) {
 			CODE_PROBE(true, "decoding encrypted block");
 			// read header size
 			state uint32_t headerLen = reader.consume<uint32_t>();
@@ -1231,7 +1370,13 @@ ACTOR Future<Standalone<VectorRef<KeyValueRef>>> decodeRangeFileBlock(Reference<
 			int64_t dataLen = len - bytesRead;
 			StringRef decryptedData =
 			    wait(EncryptedRangeFileWriter::decrypt(cx, encryptHeader, dataPayloadStart, dataLen, &results.arena()));
-			reader = StringRefReader(decryptedData, restore_corrupted_data());
+			if (file_version == BACKUP_AGENT_ENCRYPTED_COMPRESSED_SNAPSHOT_FILE_VERSION) {
+				CODE_PROBE(true, "decoding encrypted compressed block");
+				reader =
+				    StringRefReader(decompressBackupBlock(decryptedData, results.arena()), restore_corrupted_data());
+			} else {
+				reader = StringRefReader(decryptedData, restore_corrupted_data());
+			}
 			wait(decodeKVPairs(&reader, &results, true, encryptMode, blockDomainId, tenantCache));
 		} else {
 			throw restore_unsupported_file_version();
@@ -1260,14 +1405,41 @@ ACTOR Future<Standalone<VectorRef<KeyValueRef>>> decodeRangeFileBlock(Reference<
 
 // Very simple format compared to KeyRange files.
 // Header, [Key, Value]... Key len
+// With a compression filter the blocks are written with BACKUP_AGENT_COMPRESSED_MLOG_VERSION, see
+// BackupBlockCompression.h
 struct LogFileWriter {
-	LogFileWriter(Reference<IBackupFile> file = Reference<IBackupFile>(), int blockSize = 0)
-	  : file(file), blockSize(blockSize), blockEnd(0) {}
+	LogFileWriter(Reference<IBackupFile> file = Reference<IBackupFile>(),
+	              int blockSize = 0,
+	              CompressionFilter compression = CompressionFilter::NONE)
+	  : file(file), blockSize(blockSize), blockEnd(0) {
+		if (compression != CompressionFilter::NONE) {
+			compressor = BackupBlockCompressor(compression, blockSize - sizeof(BACKUP_AGENT_COMPRESSED_MLOG_VERSION));
+		}
+	}
+
+	// Writes the current compressed block to the file, padded to a whole block size if pad is true
+	ACTOR static Future<Void> writeCompressedBlock(LogFileWriter* self, bool pad) {
+		state Standalone<StringRef> payload = self->compressor.get().finishBlock(pad);
+		wait(self->file->append((uint8_t*)&BACKUP_AGENT_COMPRESSED_MLOG_VERSION,
+		                        sizeof(BACKUP_AGENT_COMPRESSED_MLOG_VERSION)));
+		wait(self->file->append(payload.begin(), payload.size()));
+		return Void();
+	}
 
 	// Start a new block if needed, then write the key and value
 	ACTOR static Future<Void> writeKV_impl(LogFileWriter* self, Key k, Value v) {
 		// If key and value do not fit in this block, end it and start a new one
-		int toWrite = sizeof(int32_t) + k.size() + sizeof(int32_t) + v.size();
+		state int toWrite = sizeof(int32_t) + k.size() + sizeof(int32_t) + v.size();
+		if (self->compressor.present()) {
+			if (!self->compressor.get().fits(toWrite)) {
+				wait(writeCompressedBlock(self, true));
+				if (!self->compressor.get().fits(toWrite))
+					throw backup_bad_block_size();
+			}
+			self->compressor.get().appendStringRefWithLen(k);
+			self->compressor.get().appendStringRefWithLen(v);
+			return Void();
+		}
 		if (self->file->size() + toWrite > self->blockEnd) {
 			// Write padding if needed
 			int bytesLeft = self->blockEnd - self->file->size();
@@ -1295,20 +1467,41 @@ struct LogFileWriter {
 
 	Future<Void> writeKV(Key k, Value v) { return writeKV_impl(this, k, v); }
 
+	// Write the last compressed block, which isn't padded
+	Future<Void> finish() {
+		if (compressor.present() && !compressor.get().empty()) {
+			return writeCompressedBlock(this, false);
+		}
+		return Void();
+	}
+
+	// Returns the size the file would have had without compression
+	int64_t uncompressedSize() const {
+		if (compressor.present()) {
+			return file->size() + compressor.get().getUncompressedBytes() - compressor.get().getCompressedBytes();
+		}
+		return file->size();
+	}
+
 	Reference<IBackupFile> file;
 	int blockSize;
 
 private:
 	int64_t blockEnd;
+	Optional<BackupBlockCompressor> compressor;
 };
 
 Standalone<VectorRef<KeyValueRef>> decodeMutationLogFileBlock(const Standalone<StringRef>& buf) {
 	Standalone<VectorRef<KeyValueRef>> results({}, buf.arena());
 	StringRefReader reader(buf, restore_corrupted_data());
 
-	// Read header, currently only decoding version BACKUP_AGENT_MLOG_VERSION
-	if (reader.consume<int32_t>() != BACKUP_AGENT_MLOG_VERSION)
+	// Read header, currently only decoding version BACKUP_AGENT_MLOG_VERSION or BACKUP_AGENT_COMPRESSED_MLOG_VERSION
+	int32_t fileVersion = reader.consume<int32_t>();
+	if (fileVersion == BACKUP_AGENT_COMPRESSED_MLOG_VERSION) {
+		reader = StringRefReader(decompressBackupBlock(reader.remainder(), results.arena()), restore_corrupted_data());
+	} else if (fileVersion != BACKUP_AGENT_MLOG_VERSION) {
 		throw restore_unsupported_file_version();
+	}
 
 	// Read k/v pairs.  Block ends either at end of last value exactly or with 0xFF as first key len byte.
 	while (1) {
@@ -1691,6 +1884,7 @@ struct BackupRangeTaskFunc : BackupTaskFuncBase {
 	//  - save/extend the task with the new params
 	// Returns whether or not the caller should continue executing the task.
 	ACTOR static Future<bool> finishRangeFile(Reference<IBackupFile> file,
+	                                          int64_t uncompressedSize,
 	                                          Database cx,
 	                                          Reference<Task> task,
 	                                          Reference<TaskBucket> taskBucket,
@@ -1725,6 +1919,7 @@ struct BackupRangeTaskFunc : BackupTaskFuncBase {
 
 				// Update the range bytes written in the backup config
 				backup.rangeBytesWritten().atomicOp(tr, file->size(), MutationRef::AddValue);
+				backup.uncompressedBytesWritten().atomicOp(tr, uncompressedSize, MutationRef::AddValue);
 				backup.snapshotRangeFileCount().atomicOp(tr, 1, MutationRef::AddValue);
 
 				// See if there is already a file for this key which has an earlier begin, update the map if not.
@@ -1872,8 +2067,13 @@ struct BackupRangeTaskFunc : BackupTaskFuncBase {
 
 					wait(rangeFile->finish());
 
-					bool usedFile = wait(
-					    finishRangeFile(outFile, cx, task, taskBucket, KeyRangeRef(beginKey, nextKey), outVersion));
+					bool usedFile = wait(finishRangeFile(outFile,
+					                                     rangeFile->uncompressedSize(),
+					                                     cx,
+					                                     task,
+					                                     taskBucket,
+					                                     KeyRangeRef(beginKey, nextKey),
+					                                     outVersion));
 					TraceEvent("FileBackupWroteRangeFile")
 					    .suppressFor(60)
 					    .detail("BackupUID", backup.getUid())
@@ -1930,9 +2130,9 @@ struct BackupRangeTaskFunc : BackupTaskFuncBase {
 				if (encryptMode.mode != EncryptionAtRestMode::DISABLED) {
 					CODE_PROBE(true, "using encrypted snapshot file writer");
 					rangeFile = std::make_unique<EncryptedRangeFileWriter>(
-					    cx, &arena, encryptMode, tenantCache, outFile, blockSize);
+					    cx, &arena, encryptMode, tenantCache, outFile, blockSize, getBackupCompressionFilter());
 				} else {
-					rangeFile = std::make_unique<RangeFileWriter>(outFile, blockSize);
+					rangeFile = std::make_unique<RangeFileWriter>(outFile, blockSize, getBackupCompressionFilter());
 				}
 				wait(rangeFile->writeKey(beginKey));
 			}
@@ -2607,6 +2807,7 @@ struct BackupLogRangeTaskFunc : BackupTaskFuncBase {
 	static struct {
 		static TaskParam<bool> addBackupLogRangeTasks() { return __FUNCTION__sr; }
 		static TaskParam<int64_t> fileSize() { return __FUNCTION__sr; }
+		static TaskParam<int64_t> uncompressedFileSize() { return __FUNCTION__sr; }
 		static TaskParam<Version> beginVersion() { return __FUNCTION__sr; }
 		static TaskParam<Version> endVersion() { return __FUNCTION__sr; }
 	} Params;
@@ -2684,7 +2885,7 @@ struct BackupLogRangeTaskFunc : BackupTaskFuncBase {
 		state int blockSize =
 		    BUGGIFY ? deterministicRandom()->randomInt(125e3, 4e6) : CLIENT_KNOBS->BACKUP_LOGFILE_BLOCK_SIZE;
 		state Reference<IBackupFile> outFile = wait(bc->writeLogFile(beginVersion, endVersion, blockSize));
-		state LogFileWriter logFile(outFile, blockSize);
+		state LogFileWriter logFile(outFile, blockSize, getBackupCompressionFilter());
 
 		// Query all key ranges covering (beginVersion, endVersion) in parallel, writing their results to the
 		// results promise stream as they are received.  Note that this means the records read from the results
@@ -2732,17 +2933,20 @@ struct BackupLogRangeTaskFunc : BackupTaskFuncBase {
 		// Make sure this task is still alive, if it's not then the data read above could be incomplete.
 		wait(taskBucket->keepRunning(cx, task));
 
+		wait(logFile.finish());
 		wait(outFile->finish());
 
 		TraceEvent("FileBackupWroteLogFile")
 		    .suppressFor(60)
 		    .detail("BackupUID", config.getUid())
 		    .detail("Size", outFile->size())
+		    .detail("UncompressedSize", logFile.uncompressedSize())
 		    .detail("BeginVersion", beginVersion)
 		    .detail("EndVersion", endVersion)
 		    .detail("LastReadVersion", lastVersion);
 
 		Params.fileSize().set(task, outFile->size());
+		Params.uncompressedFileSize().set(task, logFile.uncompressedSize());
 
 		return Void();
 	}
@@ -2824,6 +3028,10 @@ struct BackupLogRangeTaskFunc : BackupTaskFuncBase {
 		if (Params.fileSize().exists(task)) {
 			config.logBytesWritten().atomicOp(tr, Params.fileSize().get(task), MutationRef::AddValue);
 		}
+		if (Params.uncompressedFileSize().exists(task)) {
+			config.uncompressedBytesWritten().atomicOp(
+			    tr, Params.uncompressedFileSize().get(task), MutationRef::AddValue);
+		}
 
 		if (Params.addBackupLogRangeTasks().get(task)) {
 			wait(startBackupLogRangeInternal(tr, taskBucket, futureBucket, task, taskFuture, beginVersion, endVersion));
@@ -3683,6 +3891,116 @@ struct RestoreRangeTaskFunc : RestoreFileTaskFuncBase {
 		return Void();
 	}
 
+	// Writes data[start, end) of a block of a range file, translated by the restore's prefixes, in transactions of up
+	// to dataSizeLimit bytes. blockData holds the memory of data. fileRange is the translated range of the part of the
+	// block that is restored, which the pieces at the start and end of data clear to.
+	ACTOR static Future<Void> _writeRangeData(Database cx,
+	                                          Reference<TaskBucket> taskBucket,
+	                                          Reference<Task> task,
+	                                          Standalone<VectorRef<KeyValueRef>> blockData,
+	                                          VectorRef<KeyValueRef> data,
+	                                          int start,
+	                                          int end,
+	                                          KeyRange fileRange,
+	                                          KeyRange originalFileRange,
+	                                          Key removePrefix,
+	                                          Key addPrefix,
+	                                          int dataSizeLimit,
+	                                          Optional<Reference<TenantEntryCache<Void>>> tenantCache,
+	                                          Reference<FlowLock> writeLock) {
+		state RestoreConfig restore(task);
+		state RestoreFile rangeFile = Params.inputFile().get(task);
+		state Reference<ReadYourWritesTransaction> tr(new ReadYourWritesTransaction(cx));
+		state std::vector<Future<Void>> validTenantCheckFutures;
+		state Arena arena;
+
+		wait(writeLock->take());
+		state FlowLock::Releaser releaser(*writeLock);
+
+		loop {
+			try {
+				tr->setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+				tr->setOption(FDBTransactionOptions::LOCK_AWARE);
+
+				state int i = start;
+				state int txBytes = 0;
+				state int iend = start;
+
+				// find iend that results in the desired transaction size
+				for (; iend < end && txBytes < dataSizeLimit; ++iend) {
+					txBytes += data[iend].key.expectedSize();
+					txBytes += data[iend].value.expectedSize();
+				}
+
+				// Clear the range we are about to set.
+				// If start == 0 then use fileBegin for the start of the range, else data[start]
+				// If iend == data.size() then use fileEnd for the end of the range, else data[iend]
+				state KeyRange trRange = KeyRangeRef(
+				    (start == 0) ? fileRange.begin : data[start].key.removePrefix(removePrefix).withPrefix(addPrefix),
+				    (iend == data.size()) ? fileRange.end
+				                          : data[iend].key.removePrefix(removePrefix).withPrefix(addPrefix));
+				tr->clear(trRange);
+
+				for (; i < iend; ++i) {
+					tr->setOption(FDBTransactionOptions::NEXT_WRITE_NO_WRITE_CONFLICT_RANGE);
+					if (tenantCache.present()) {
+						validTenantCheckFutures.push_back(_validTenantAccess(
+						    StringRef(arena, data[i].key.removePrefix(removePrefix).withPrefix(addPrefix)),
+						    tenantCache.get()));
+					}
+					tr->set(data[i].key.removePrefix(removePrefix).withPrefix(addPrefix), data[i].value);
+				}
+
+				// Add to bytes written count
+				restore.bytesWritten().atomicOp(tr, txBytes, MutationRef::Type::AddValue);
+
+				state Future<Void> checkLock = checkDatabaseLock(tr, restore.getUid());
+
+				wait(taskBucket->keepRunning(tr, task));
+
+				wait(checkLock);
+
+				wait(tr->commit());
+
+				if (!validTenantCheckFutures.empty()) {
+					waitForAll(validTenantCheckFutures);
+					validTenantCheckFutures.clear();
+				}
+
+				TraceEvent("FileRestoreCommittedRange")
+				    .suppressFor(60)
+				    .detail("RestoreUID", restore.getUid())
+				    .detail("FileName", rangeFile.fileName)
+				    .detail("FileVersion", rangeFile.version)
+				    .detail("FileSize", rangeFile.fileSize)
+				    .detail("ReadOffset", Params.readOffset().get(task))
+				    .detail("ReadLen", Params.readLen().get(task))
+				    .detail("CommitVersion", tr->getCommittedVersion())
+				    .detail("BeginRange", trRange.begin)
+				    .detail("EndRange", trRange.end)
+				    .detail("StartIndex", start)
+				    .detail("EndIndex", i)
+				    .detail("DataSize", data.size())
+				    .detail("Bytes", txBytes)
+				    .detail("OriginalFileRange", originalFileRange)
+				    .detail("TaskInstance", THIS_ADDR);
+
+				// Commit succeeded, so advance starting point
+				start = i;
+
+				if (start == end)
+					break;
+				tr->reset();
+			} catch (Error& e) {
+				if (e.code() == error_code_transaction_too_large)
+					dataSizeLimit /= 2;
+				else
+					wait(tr->onError(e));
+			}
+		}
+		return Void();
+	}
+
 	ACTOR static Future<Void> _execute(Database cx,
 	                                   Reference<TaskBucket> taskBucket,
 	                                   Reference<FutureBucket> futureBucket,
@@ -3745,8 +4063,6 @@ struct RestoreRangeTaskFunc : RestoreFileTaskFuncBase {
 			throw;
 		}
 		state Optional<Reference<TenantEntryCache<Void>>> tenantCache;
-		state std::vector<Future<Void>> validTenantCheckFutures;
-		state Arena arena;
 		state DatabaseConfiguration config = wait(getDatabaseConfiguration(cx));
 		if (config.tenantMode == TenantMode::REQUIRED && g_network && g_network->isSimulated()) {
 			tenantCache = makeReference<TenantEntryCache<Void>>(cx, TenantEntryCacheRefreshMode::WATCH);
@@ -3797,96 +4113,54 @@ struct RestoreRangeTaskFunc : RestoreFileTaskFuncBase {
 			                            .withPrefix(addPrefix.get()),
 			                        fileEnd);
 
-			state int start = 0;
-			state int end = data.size();
 			state int dataSizeLimit =
 			    BUGGIFY ? deterministicRandom()->randomInt(256 * 1024, 10e6) : CLIENT_KNOBS->RESTORE_WRITE_TX_SIZE;
 
-			tr->reset();
-			loop {
-				try {
-					tr->setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
-					tr->setOption(FDBTransactionOptions::LOCK_AWARE);
-
-					state int i = start;
-					state int txBytes = 0;
-					state int iend = start;
-
-					// find iend that results in the desired transaction size
-					for (; iend < end && txBytes < dataSizeLimit; ++iend) {
-						txBytes += data[iend].key.expectedSize();
-						txBytes += data[iend].value.expectedSize();
-					}
-
-					// Clear the range we are about to set.
-					// If start == 0 then use fileBegin for the start of the range, else data[start]
-					// If iend == end then use fileEnd for the end of the range, else data[iend]
-					state KeyRange trRange = KeyRangeRef(
-					    (start == 0) ? fileRange.begin
-					                 : data[start].key.removePrefix(removePrefix.get()).withPrefix(addPrefix.get()),
-					    (iend == end) ? fileRange.end
-					                  : data[iend].key.removePrefix(removePrefix.get()).withPrefix(addPrefix.get()));
-					tr->clear(trRange);
-
-					for (; i < iend; ++i) {
-						tr->setOption(FDBTransactionOptions::NEXT_WRITE_NO_WRITE_CONFLICT_RANGE);
-						if (tenantCache.present()) {
-							validTenantCheckFutures.push_back(_validTenantAccess(
-							    StringRef(arena,
-							              data[i].key.removePrefix(removePrefix.get()).withPrefix(addPrefix.get())),
-							    tenantCache.get()));
-						}
-						tr->set(data[i].key.removePrefix(removePrefix.get()).withPrefix(addPrefix.get()),
-						        data[i].value);
-					}
-
-					// Add to bytes written count
-					restore.bytesWritten().atomicOp(tr, txBytes, MutationRef::Type::AddValue);
-
-					state Future<Void> checkLock = checkDatabaseLock(tr, restore.getUid());
-
-					wait(taskBucket->keepRunning(tr, task));
-
-					wait(checkLock);
-
-					wait(tr->commit());
-
-					if (!validTenantCheckFutures.empty()) {
-						waitForAll(validTenantCheckFutures);
-						validTenantCheckFutures.clear();
-					}
-
-					TraceEvent("FileRestoreCommittedRange")
-					    .suppressFor(60)
-					    .detail("RestoreUID", restore.getUid())
-					    .detail("FileName", rangeFile.fileName)
-					    .detail("FileVersion", rangeFile.version)
-					    .detail("FileSize", rangeFile.fileSize)
-					    .detail("ReadOffset", readOffset)
-					    .detail("ReadLen", readLen)
-					    .detail("CommitVersion", tr->getCommittedVersion())
-					    .detail("BeginRange", trRange.begin)
-					    .detail("EndRange", trRange.end)
-					    .detail("StartIndex", start)
-					    .detail("EndIndex", i)
-					    .detail("DataSize", data.size())
-					    .detail("Bytes", txBytes)
-					    .detail("OriginalFileRange", originalFileRange)
-					    .detail("TaskInstance", THIS_ADDR);
-
-					// Commit succeeded, so advance starting point
-					start = i;
-
-					if (start == end)
-						break;
-					tr->reset();
-				} catch (Error& e) {
-					if (e.code() == error_code_transaction_too_large)
-						dataSizeLimit /= 2;
-					else
-						wait(tr->onError(e));
+			// Split the data into pieces of about one transaction each, which are written in parallel since they don't
+			// overlap
+			state std::vector<Future<Void>> writes;
+			state Reference<FlowLock> writeLock(new FlowLock(CLIENT_KNOBS->RESTORE_WRITE_TX_PARALLELISM));
+			int pieceStart = 0;
+			int pieceBytes = 0;
+			for (int i = 0; i < data.size(); ++i) {
+				pieceBytes += data[i].key.expectedSize() + data[i].value.expectedSize();
+				if (pieceBytes >= dataSizeLimit || i + 1 == data.size()) {
+					writes.push_back(_writeRangeData(cx,
+					                                 taskBucket,
+					                                 task,
+					                                 blockData,
+					                                 data,
+					                                 pieceStart,
+					                                 i + 1,
+					                                 fileRange,
+					                                 originalFileRange,
+					                                 removePrefix.get(),
+					                                 addPrefix.get(),
+					                                 dataSizeLimit,
+					                                 tenantCache,
+					                                 writeLock));
+					pieceStart = i + 1;
+					pieceBytes = 0;
 				}
 			}
+			if (data.empty()) {
+				// Still clear the file's range
+				writes.push_back(_writeRangeData(cx,
+				                                 taskBucket,
+				                                 task,
+				                                 blockData,
+				                                 data,
+				                                 0,
+				                                 0,
+				                                 fileRange,
+				                                 originalFileRange,
+				                                 removePrefix.get(),
+				                                 addPrefix.get(),
+				                                 dataSizeLimit,
+				                                 tenantCache,
+				                                 writeLock));
+			}
+			wait(waitForAll(writes));
 		}
 		if (!originalFileRanges.empty()) {
 			if (BUGGIFY && restoreRanges.get().size() == 1) {
@@ -5877,6 +6151,7 @@ public:
 						state int64_t snapshotInterval;
 						state int64_t logBytesWritten;
 						state int64_t rangeBytesWritten;
+						state Optional<int64_t> uncompressedBytesWritten;
 						state bool stopWhenDone;
 						state TimestampedVersion snapshotBegin;
 						state TimestampedVersion snapshotTargetEnd;
@@ -5889,6 +6164,7 @@ public:
 						    store(snapshotInterval, config.snapshotIntervalSeconds().getOrThrow(tr)) &&
 						    store(logBytesWritten, config.logBytesWritten().getD(tr)) &&
 						    store(rangeBytesWritten, config.rangeBytesWritten().getD(tr)) &&
+						    store(uncompressedBytesWritten, config.uncompressedBytesWritten().get(tr)) &&
 						    store(stopWhenDone, config.stopWhenDone().getOrThrow(tr)) &&
 						    store(snapshotBegin, getTimestampedVersion(tr, config.snapshotBeginVersion().get(tr))) &&
 						    store(snapshotTargetEnd,
@@ -5904,6 +6180,11 @@ public:
 						doc.setKey("SnapshotIntervalSeconds", snapshotInterval);
 						doc.setKey("LogBytesWritten", logBytesWritten);
 						doc.setKey("RangeBytesWritten", rangeBytesWritten);
+						if (uncompressedBytesWritten.present() && logBytesWritten + rangeBytesWritten > 0) {
+							doc.setKey("UncompressedBytesWritten", uncompressedBytesWritten.get());
+							doc.setKey("CompressionRatio",
+							           (double)uncompressedBytesWritten.get() / (logBytesWritten + rangeBytesWritten));
+						}
 
 						if (latestLogEnd.present()) {
 							doc.setKey("LatestLogEnd", latestLogEnd.toJSON());
@@ -6039,6 +6320,7 @@ public:
 						state Optional<Version> latestLogEndVersion;
 						state Optional<int64_t> logBytesWritten;
 						state Optional<int64_t> rangeBytesWritten;
+						state Optional<int64_t> uncompressedBytesWritten;
 						state Optional<int64_t> latestSnapshotEndVersionTimestamp;
 						state Optional<int64_t> latestLogEndVersionTimestamp;
 						state Optional<int64_t> snapshotBeginVersionTimestamp;
@@ -6050,6 +6332,7 @@ public:
 						     store(snapshotInterval, config.snapshotIntervalSeconds().getOrThrow(tr)) &&
 						     store(logBytesWritten, config.logBytesWritten().get(tr)) &&
 						     store(rangeBytesWritten, config.rangeBytesWritten().get(tr)) &&
+						     store(uncompressedBytesWritten, config.uncompressedBytesWritten().get(tr)) &&
 						     store(latestLogEndVersion, config.latestLogEndVersion().get(tr)) &&
 						     store(latestSnapshotEndVersion, config.latestSnapshotEndVersion().get(tr)) &&
 						     store(stopWhenDone, config.stopWhenDone().getOrThrow(tr)));
@@ -6088,6 +6371,11 @@ public:
 						                     versionToString(snapshotTargetEndVersion).c_str(),
 						                     timeStampToString(snapshotTargetEndVersionTimestamp).c_str(),
 						                     boolToYesOrNo(stopWhenDone).c_str());
+						int64_t bytesWritten = logBytesWritten.orDefault(0) + rangeBytesWritten.orDefault(0);
+						if (uncompressedBytesWritten.present() && bytesWritten > 0) {
+							statusText += format(" Compression ratio - %.2f\n",
+							                     (double)uncompressedBytesWritten.get() / bytesWritten);
+						}
 					}
 
 					// Append the errors, if requested
@@ -19,6 +19,7 @@
  */
 
 #include "fdbclient/KeyRangeMap.h"
+#include "fdbclient/FlatKeyRangeMap.h"
 #include "fdbclient/NativeAPI.actor.h"
 #include "fdbclient/CommitTransaction.h"
 #include "fdbclient/FDBTypes.h"
@@ -417,4 +418,64 @@ TEST_CASE("/keyrangemap/decoderange/unaligned") {
 	ASSERT(decodedRanges.back().value == keyD);
 
 	return Void();
-}
\ No newline at end of file
+}
+
+namespace {
+
+// Returns a short key which often shares its first eight bytes with other keys, so that FlatKeyRangeMap has to compare
+// whole keys
+Key randomFlatMapKey() {
+	static const StringRef prefixes[] = { ""_sr, "\x01\x02\x03\x04\x05\x06\x07"_sr, "abcdefghij"_sr };
+	std::string key = prefixes[deterministicRandom()->randomInt(0, 3)].toString();
+	static const char suffixBytes[] = { '\x00', 'a', 'b' };
+	for (int i = deterministicRandom()->randomInt(0, 4); i > 0; --i) {
+		key += suffixBytes[deterministicRandom()->randomInt(0, 3)];
+	}
+	return Key(key);
+}
+
+} // namespace
+
+TEST_CASE("/keyrangemap/flat/random") {
+	// All the boundaries of the map may share a prefix
+	KeyRangeMap<int> map(-1);
+	Key sharedPrefix = deterministicRandom()->coinflip() ? "abcdefghij"_sr : ""_sr;
+	for (int i = deterministicRandom()->randomInt(0, 200); i > 0; --i) {
+		Key a = sharedPrefix.withSuffix(randomFlatMapKey()), b = sharedPrefix.withSuffix(randomFlatMapKey());
+		if (a != b) {
+			map.insert(a < b ? KeyRangeRef(a, b) : KeyRangeRef(b, a), i);
+		}
+	}
+	FlatKeyRangeMap<int> flat(map);
+	ASSERT_EQ(flat.size(), map.size());
+	ASSERT(flat.mapEnd() == map.mapEnd);
+
+	auto r = map.ranges().begin();
+	for (auto f : flat.ranges()) {
+		ASSERT(f.range() == r->range() && f.value() == r->value());
+		++r;
+	}
+	ASSERT(r == map.ranges().end());
+
+	auto randomKey = [&]() {
+		return deterministicRandom()->coinflip() ? sharedPrefix.withSuffix(randomFlatMapKey()) : randomFlatMapKey();
+	};
+	for (int i = 0; i < 1000; ++i) {
+		Key key = randomKey();
+		auto f = flat.rangeContaining(key);
+		ASSERT(f.range() == map.rangeContaining(key).range() && f.value() == map[key] && flat[key] == map[key]);
+		ASSERT(flat.rangeContainingKeyBefore(key).range() == map.rangeContainingKeyBefore(key).range());
+
+		Key end = randomKey();
+		KeyRangeRef range = key < end ? KeyRangeRef(key, end) : KeyRangeRef(end, key);
+		auto mapRanges = map.intersectingRanges(range);
+		auto flatRanges = flat.intersectingRanges(range);
+		ASSERT_EQ(std::distance(flatRanges.begin(), flatRanges.end()),
+		          std::distance(mapRanges.begin(), mapRanges.end()));
+		ASSERT(flatRanges.begin().begin() == mapRanges.begin().begin());
+	}
+	ASSERT(flat.rangeContainingKeyBefore(flat.mapEnd()).range() == map.lastItem().range());
+	ASSERT(flat.intersectingRanges(KeyRangeRef(""_sr, flat.mapEnd())).end() == flat.ranges().end());
+
+	return Void();
+}
@@ -837,6 +837,91 @@ void shrinkProxyList(ClientDBInfo& ni,
 	}
 }
 
+namespace {
+
+// The ClientDBInfo a client last got from the cluster, saved to CLIENT_DB_INFO_CACHE_FILE so that the next client
+// process can send its first requests to the proxies without waiting for the coordinators
+struct CachedClientDBInfo {
+	constexpr static FileIdentifier file_identifier = 1470327;
+
+	std::string connectionString;
+	double saveTime = 0; // timer()
+	ClientDBInfo info;
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, connectionString, saveTime, info);
+	}
+};
+
+} // namespace
+
+static void saveClientDBInfo(std::string const& file, ClusterConnectionString const& cs, ClientDBInfo const& info) {
+	try {
+		CachedClientDBInfo cached;
+		cached.connectionString = cs.toString();
+		cached.saveTime = timer();
+		cached.info = info;
+		atomicReplace(file, ObjectWriter::toValue(cached, IncludeVersion()).toString(), false);
+	} catch (Error& e) {
+		TraceEvent(SevWarnAlways, "ClientDBInfoCacheSaveFailed").error(e).detail("File", file);
+	}
+}
+
+// Returns the ClientDBInfo saved to file for the cluster of cs, unless it is older than maxAge seconds
+static Optional<ClientDBInfo> loadClientDBInfo(std::string const& file,
+                                               ClusterConnectionString const& cs,
+                                               double maxAge) {
+	if (!fileExists(file)) {
+		return Optional<ClientDBInfo>();
+	}
+	try {
+		CachedClientDBInfo cached = ObjectReader::fromStringRef<CachedClientDBInfo>(
+		    StringRef(readFileBytes(file, CLIENT_KNOBS->CLIENT_DB_INFO_CACHE_MAX_BYTES)), IncludeVersion());
+		const double age = timer() - cached.saveTime;
+		if (cached.connectionString != cs.toString() || age > maxAge || age < 0) {
+			TraceEvent("ClientDBInfoCacheIgnored")
+			    .detail("File", file)
+			    .detail("Age", age)
+			    .detail("CachedConnectionString", cached.connectionString)
+			    .detail("ConnectionString", cs.toString());
+			return Optional<ClientDBInfo>();
+		}
+		TraceEvent("ClientDBInfoCacheLoaded")
+		    .detail("File", file)
+		    .detail("Age", age)
+		    .detail("ClientInfoID", cached.info.id)
+		    .detail("CommitProxies", cached.info.commitProxies.size())
+		    .detail("GrvProxies", cached.info.grvProxies.size());
+		return cached.info;
+	} catch (Error& e) {
+		if (e.code() == error_code_actor_cancelled) {
+			throw;
+		}
+		TraceEvent(SevWarnAlways, "ClientDBInfoCacheLoadFailed").error(e).detail("File", file);
+		return Optional<ClientDBInfo>();
+	}
+}
+
+TEST_CASE("noSim/fdbclient/MonitorLeader/ClientDBInfoCache") {
+	const std::string file = "clientdbinfo.unittest.cache";
+	ClusterConnectionString cs("TestCluster:0@127.0.0.1:4500");
+	ClientDBInfo info;
+	info.id = deterministicRandom()->randomUniqueID();
+	info.clusterId = deterministicRandom()->randomUniqueID();
+
+	saveClientDBInfo(file, cs, info);
+	Optional<ClientDBInfo> loaded = loadClientDBInfo(file, cs, 60);
+	ASSERT(loaded.present() && loaded.get().id == info.id && loaded.get().clusterId == info.clusterId);
+	// Another cluster, or too old
+	ASSERT(!loadClientDBInfo(file, ClusterConnectionString("TestCluster:1@127.0.0.1:4500"), 60).present());
+	ASSERT(!loadClientDBInfo(file, cs, -1).present());
+
+	deleteFile(file);
+	ASSERT(!loadClientDBInfo(file, cs, 60).present());
+	return Void();
+}
+
 ACTOR Future<MonitorLeaderInfo> monitorProxiesOneGeneration(
     Reference<IClusterConnectionRecord> connRecord,
     Reference<AsyncVar<ClientDBInfo>> clientInfo,
@@ -961,6 +1046,10 @@ ACTOR Future<MonitorLeaderInfo> monitorProxiesOneGeneration(
 			info.hasConnected = true;
 			connRecord->notifyConnected();
 
+			if (!CLIENT_KNOBS->CLIENT_DB_INFO_CACHE_FILE.empty() && rep.get().read().id != clientInfo->get().id) {
+				saveClientDBInfo(
+				    CLIENT_KNOBS->CLIENT_DB_INFO_CACHE_FILE, connRecord->getConnectionString(), rep.get().read());
+			}
 			auto& ni = rep.get().mutate();
 			shrinkProxyList(ni, lastCommitProxyUIDs, lastCommitProxies, lastGrvProxyUIDs, lastGrvProxies);
 			clientInfo->setUnconditional(ni);
@@ -989,6 +1078,24 @@ ACTOR Future<Void> monitorProxies(
     Key traceLogGroup,
     IsInternal internal) {
 	state MonitorLeaderInfo info(connRecord->get());
+
+	// Start with the proxies the last client saw, if they are recent enough. The coordinators are asked for the
+	// ClientDBInfo as usual, and reply right away if it has changed since. Until then, requests to proxies that are
+	// gone fail with broken_promise or request_maybe_delivered and are retried once the new ClientDBInfo arrives, as
+	// after a recovery.
+	if (!CLIENT_KNOBS->CLIENT_DB_INFO_CACHE_FILE.empty() && !clientInfo->get().id.isValid()) {
+		Optional<ClientDBInfo> cached = loadClientDBInfo(CLIENT_KNOBS->CLIENT_DB_INFO_CACHE_FILE,
+		                                                 connRecord->get()->getConnectionString(),
+		                                                 CLIENT_KNOBS->CLIENT_DB_INFO_CACHE_MAX_AGE);
+		if (cached.present()) {
+			std::vector<UID> commitProxyUIDs, grvProxyUIDs;
+			std::vector<CommitProxyInterface> commitProxies;
+			std::vector<GrvProxyInterface> grvProxies;
+			shrinkProxyList(cached.get(), commitProxyUIDs, commitProxies, grvProxyUIDs, grvProxies);
+			clientInfo->set(cached.get());
+		}
+	}
+
 	loop {
 		ASSERT(connRecord->get().isValid());
 		choose {
@@ -64,6 +64,11 @@ void throwIfError(FdbCApi::fdb_error_t e) {
 	}
 }
 
+// Results from an external client are passed through without being copied, by viewing its arrays as arrays of the
+// corresponding native types
+static_assert(sizeof(FdbCApi::FDBKey) == sizeof(KeyRef), "FDBKey / KeyRef size mismatch");
+static_assert(sizeof(FdbCApi::FDBKeyValue) == sizeof(KeyValueRef), "FDBKeyValue / KeyValueRef size mismatch");
+
 // DLTransaction
 void DLTransaction::cancel() {
 	api->transactionCancel(tr);
@@ -404,6 +409,38 @@ void DLTransaction::clear(const KeyRef& key) {
 	api->transactionClear(tr, key.begin(), key.size());
 }
 
+ThreadFuture<RangeResult> DLTransaction::batch(VectorRef<MutationRef> const& mutations,
+                                              VectorRef<KeyRef> const& reads,
+                                              bool snapshot) {
+	if (!api->transactionBatch) {
+		return unsupported_operation();
+	}
+
+	// The operation types of FDBBatchOperation
+	enum { SET = 0, CLEAR_RANGE = 2, ATOMIC_OP = 3, GET = 4 };
+	std::vector<FdbCApi::FDBBatchOperation> operations;
+	operations.reserve(mutations.size() + reads.size());
+	for (const auto& m : mutations) {
+		int type = m.type == MutationRef::SetValue ? SET : m.type == MutationRef::ClearRange ? CLEAR_RANGE : ATOMIC_OP;
+		operations.push_back({ type, m.type, m.param1.begin(), m.param1.size(), m.param2.begin(), m.param2.size() });
+	}
+	for (const auto& key : reads) {
+		operations.push_back({ GET, 0, key.begin(), key.size(), nullptr, 0 });
+	}
+
+	FdbCApi::FDBFuture* f = api->transactionBatch(tr, operations.data(), operations.size(), snapshot);
+	return toThreadFuture<RangeResult>(api, f, [](FdbCApi::FDBFuture* f, FdbCApi* api) {
+		const FdbCApi::FDBKeyValue* kvs;
+		int count;
+		FdbCApi::fdb_bool_t more;
+		FdbCApi::fdb_error_t error = api->futureGetKeyValueArray(f, &kvs, &count, &more);
+		ASSERT(!error);
+
+		// The memory for this is stored in the FDBFuture and is released when the future gets destroyed
+		return RangeResult(RangeResultRef(VectorRef<KeyValueRef>((KeyValueRef*)kvs, count), more), Arena());
+	});
+}
+
 ThreadFuture<Void> DLTransaction::watch(const KeyRef& key) {
 	FdbCApi::FDBFuture* f = api->transactionWatch(tr, key.begin(), key.size());
 
@@ -1126,6 +1163,7 @@ void DLApi::init() {
 	loadClientFunction(&api->transactionClear, lib, fdbCPath, "fdb_transaction_clear", headerVersion >= 0);
 	loadClientFunction(&api->transactionClearRange, lib, fdbCPath, "fdb_transaction_clear_range", headerVersion >= 0);
 	loadClientFunction(&api->transactionAtomicOp, lib, fdbCPath, "fdb_transaction_atomic_op", headerVersion >= 0);
+	loadClientFunction(&api->transactionBatch, lib, fdbCPath, "fdb_transaction_batch", false);
 	loadClientFunction(&api->transactionCommit, lib, fdbCPath, "fdb_transaction_commit", headerVersion >= 0);
 	loadClientFunction(&api->transactionGetCommittedVersion,
 	                   lib,
@@ -1660,6 +1698,12 @@ void MultiVersionTransaction::clear(const KeyRef& key) {
 	}
 }
 
+ThreadFuture<RangeResult> MultiVersionTransaction::batch(VectorRef<MutationRef> const& mutations,
+                                                        VectorRef<KeyRef> const& reads,
+                                                        bool snapshot) {
+	return executeOperation(&ITransaction::batch, mutations, reads, std::forward<bool>(snapshot));
+}
+
 ThreadFuture<Void> MultiVersionTransaction::watch(const KeyRef& key) {
 	return executeOperation(&ITransaction::watch, key);
 }
@@ -2708,6 +2752,22 @@ void MultiVersionDatabase::LegacyVersionMonitor::close() {
 	}
 }
 
+// MultiThreadDatabase
+void MultiThreadDatabase::setOption(FDBDatabaseOptions::Option option, Optional<StringRef> value) {
+	for (auto& db : dbs) {
+		db->setOption(option, value);
+	}
+}
+
+// The busyness of the busiest client thread, which is the one that limits this database
+double MultiThreadDatabase::getMainThreadBusyness() {
+	double busyness = 0;
+	for (auto& db : dbs) {
+		busyness = std::max(busyness, db->getMainThreadBusyness());
+	}
+	return busyness;
+}
+
 // MultiVersionApi
 void MultiVersionApi::runOnExternalClientsAllThreads(std::function<void(Reference<ClientInfo>)> func,
                                                      bool runOnFailedClients,
@@ -3035,6 +3095,13 @@ void MultiVersionApi::setNetworkOptionInternal(FDBNetworkOptions::Option option,
 		// multiple client threads are not supported on windows.
 		threadCount = extractIntOption(value, 1, 1);
 #endif
+	} else if (option == FDBNetworkOptions::DISTRIBUTE_DATABASE_ACROSS_CLIENT_THREADS) {
+		MutexHolder holder(lock);
+		validateOption(value, false, true);
+		if (networkStartSetup) {
+			throw invalid_option();
+		}
+		distributeDatabases = true;
 	} else if (option == FDBNetworkOptions::CLIENT_TMP_DIR) {
 		validateOption(value, true, false, false);
 		tmpDir = abspath(value.get().toString());
@@ -3304,6 +3371,19 @@ Reference<IDatabase> MultiVersionApi::createDatabase(ClusterConnectionRecord con
 	if (localClientDisabled) {
 		ASSERT(!bypassMultiClientApi);
 
+		if (distributeDatabases && threadCount > 1) {
+			lock.leave();
+
+			// Every thread's database watches the cluster's protocol version through the same local database
+			Reference<IDatabase> localDb = connectionRecord.createDatabase(localClient->api);
+			std::vector<Reference<IDatabase>> dbs;
+			for (int i = 0; i < threadCount; i++) {
+				dbs.push_back(Reference<IDatabase>(
+				    new MultiVersionDatabase(this, i, connectionRecord, Reference<IDatabase>(), localDb)));
+			}
+			return makeReference<MultiThreadDatabase>(std::move(dbs));
+		}
+
 		int threadIdx = nextThread;
 		nextThread = (nextThread + 1) % threadCount;
 		lock.leave();
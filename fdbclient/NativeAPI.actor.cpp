@@ -48,6 +48,7 @@
 #include "fdbclient/AnnotateActor.h"
 #include "fdbclient/Atomic.h"
 #include "fdbclient/BlobGranuleCommon.h"
+#include "fdbclient/BlobGranuleFileCache.h"
 #include "fdbclient/BlobGranuleRequest.actor.h"
 #include "fdbclient/ClusterInterface.h"
 #include "fdbclient/ClusterConnectionFile.h"
@@ -81,6 +82,7 @@
 #include "fdbrpc/sim_validation.h"
 #include "flow/Arena.h"
 #include "flow/ActorCollection.h"
+#include "flow/CompressionUtils.h"
 #include "flow/DeterministicRandom.h"
 #include "flow/Error.h"
 #include "flow/FastRef.h"
@@ -694,7 +696,15 @@ ACTOR Future<Void> databaseLogger(DatabaseContext* cx) {
 			    .detail("MeanBytesPerCommit", cx->bytesPerCommit.mean())
 			    .detail("MedianBytesPerCommit", cx->bytesPerCommit.median())
 			    .detail("MaxBytesPerCommit", cx->bytesPerCommit.max())
-			    .detail("NumLocalityCacheEntries", cx->locationCache.size());
+			    .detail("NumLocalityCacheEntries", cx->locationCache.size())
+			    .detail("SecondRequests", cx->queueModel.secondRequests)
+			    .detail("SecondRequestWins", cx->queueModel.secondRequestWins)
+			    .detail("ZoneRequests", cx->queueModel.zoneRequests)
+			    .detail("InZoneRequests", cx->queueModel.inZoneRequests)
+			    .detail("InZoneFraction",
+			            cx->queueModel.zoneRequests
+			                ? double(cx->queueModel.inZoneRequests) / cx->queueModel.zoneRequests
+			                : 0.0);
 		}
 
 		if (cx->usedAnyChangeFeeds && logTraces) {
@@ -730,6 +740,13 @@ ACTOR Future<Void> databaseLogger(DatabaseContext* cx) {
 			    .detail("MeanBGGranulesPerRequest", cx->bgGranulesPerRequest.mean())
 			    .detail("MedianBGGranulesPerRequest", cx->bgGranulesPerRequest.median())
 			    .detail("MaxBGGranulesPerRequest", cx->bgGranulesPerRequest.max());
+
+			// add file cache use, which is shared by the whole process
+			int64_t fileCacheBytes = cx->bgReadFileCacheHitBytes.getValue() + cx->bgReadFileCacheMissBytes.getValue();
+			if (fileCacheBytes > 0) {
+				bgReadEv.detail("FileCacheHitRatio", (double)cx->bgReadFileCacheHitBytes.getValue() / fileCacheBytes)
+				    .detail("FileCacheBytes", BlobGranuleFileCache::global().getBytes());
+			}
 		}
 
 		cx->latencies.clear();
@@ -1543,7 +1560,10 @@ DatabaseContext::DatabaseContext(Reference<AsyncVar<Reference<IClusterConnection
     transactionGetKeyRequests("GetKeyRequests", cc), transactionGetValueRequests("GetValueRequests", cc),
     transactionGetRangeRequests("GetRangeRequests", cc),
     transactionGetMappedRangeRequests("GetMappedRangeRequests", cc),
-    transactionGetRangeStreamRequests("GetRangeStreamRequests", cc), transactionWatchRequests("WatchRequests", cc),
+    transactionGetRangeStreamRequests("GetRangeStreamRequests", cc),
+    transactionGetRangeParallelRequests("GetRangeParallelRequests", cc),
+    transactionMutationBatches("MutationBatches", cc), transactionBatchedMutations("BatchedMutations", cc),
+    transactionCompressedCommits("CompressedCommits", cc), transactionWatchRequests("WatchRequests", cc),
     transactionGetAddressesForKeyRequests("GetAddressesForKeyRequests", cc), transactionBytesRead("BytesRead", cc),
     transactionKeysRead("KeysRead", cc), transactionMetadataVersionReads("MetadataVersionReads", cc),
     transactionCommittedMutations("CommittedMutations", cc),
@@ -1565,7 +1585,10 @@ DatabaseContext::DatabaseContext(Reference<AsyncVar<Reference<IClusterConnection
     ccBG("BlobGranuleReadMetrics", dbId.toString()), bgReadInputBytes("BGReadInputBytes", ccBG),
     bgReadOutputBytes("BGReadOutputBytes", ccBG), bgReadSnapshotRows("BGReadSnapshotRows", ccBG),
     bgReadRowsCleared("BGReadRowsCleared", ccBG), bgReadRowsInserted("BGReadRowsInserted", ccBG),
-    bgReadRowsUpdated("BGReadRowsUpdated", ccBG), bgLatencies(), bgGranulesPerRequest(), usedAnyChangeFeeds(false),
+    bgReadRowsUpdated("BGReadRowsUpdated", ccBG), bgReadFileCacheHits("BGReadFileCacheHits", ccBG),
+    bgReadFileCacheMisses("BGReadFileCacheMisses", ccBG), bgReadFileCacheHitBytes("BGReadFileCacheHitBytes", ccBG),
+    bgReadFileCacheMissBytes("BGReadFileCacheMissBytes", ccBG), bgLatencies(), bgGranulesPerRequest(),
+    usedAnyChangeFeeds(false),
     ccFeed("ChangeFeedClientMetrics", dbId.toString()), feedStreamStarts("FeedStreamStarts", ccFeed),
     feedMergeStreamStarts("FeedMergeStreamStarts", ccFeed), feedErrors("FeedErrors", ccFeed),
     feedNonRetriableErrors("FeedNonRetriableErrors", ccFeed), feedPops("FeedPops", ccFeed),
@@ -1592,6 +1615,16 @@ DatabaseContext::DatabaseContext(Reference<AsyncVar<Reference<IClusterConnection
 	logger = databaseLogger(this) && tssLogger(this);
 	locationCacheSize = g_network->isSimulated() ? CLIENT_KNOBS->LOCATION_CACHE_EVICTION_SIZE_SIM
 	                                             : CLIENT_KNOBS->LOCATION_CACHE_EVICTION_SIZE;
+	if (!CLIENT_KNOBS->LOCATION_CACHE_SNAPSHOT_FILE.empty() && fileExists(CLIENT_KNOBS->LOCATION_CACHE_SNAPSHOT_FILE)) {
+		try {
+			loadLocationCache(StringRef(readFileBytes(CLIENT_KNOBS->LOCATION_CACHE_SNAPSHOT_FILE,
+			                                          CLIENT_KNOBS->LOCATION_CACHE_SNAPSHOT_MAX_BYTES)));
+		} catch (Error& e) {
+			TraceEvent(SevWarnAlways, "LocationCacheLoadFailed", dbId)
+			    .error(e)
+			    .detail("File", CLIENT_KNOBS->LOCATION_CACHE_SNAPSHOT_FILE);
+		}
+	}
 
 	getValueSubmitted.init("NativeAPI.GetValueSubmitted"_sr);
 	getValueCompleted.init("NativeAPI.GetValueCompleted"_sr);
@@ -1750,6 +1783,12 @@ DatabaseContext::DatabaseContext(Reference<AsyncVar<Reference<IClusterConnection
 		registerSpecialKeysImpl(SpecialKeySpace::MODULE::METRICS,
 		                        SpecialKeySpace::IMPLTYPE::READONLY,
 		                        std::make_unique<DDStatsRangeImpl>(ddStatsRange));
+		registerSpecialKeysImpl(SpecialKeySpace::MODULE::METRICS,
+		                        SpecialKeySpace::IMPLTYPE::READONLY,
+		                        std::make_unique<DDHeatmapRangeImpl>(ddHeatmapRange));
+		registerSpecialKeysImpl(SpecialKeySpace::MODULE::METRICS,
+		                        SpecialKeySpace::IMPLTYPE::READONLY,
+		                        std::make_unique<HeapProfileRangeImpl>(heapProfileRange));
 		registerSpecialKeysImpl(SpecialKeySpace::MODULE::METRICS,
 		                        SpecialKeySpace::IMPLTYPE::READONLY,
 		                        std::make_unique<HealthMetricsRangeImpl>(
@@ -1856,7 +1895,10 @@ DatabaseContext::DatabaseContext(const Error& err)
     transactionGetKeyRequests("GetKeyRequests", cc), transactionGetValueRequests("GetValueRequests", cc),
     transactionGetRangeRequests("GetRangeRequests", cc),
     transactionGetMappedRangeRequests("GetMappedRangeRequests", cc),
-    transactionGetRangeStreamRequests("GetRangeStreamRequests", cc), transactionWatchRequests("WatchRequests", cc),
+    transactionGetRangeStreamRequests("GetRangeStreamRequests", cc),
+    transactionGetRangeParallelRequests("GetRangeParallelRequests", cc),
+    transactionMutationBatches("MutationBatches", cc), transactionBatchedMutations("BatchedMutations", cc),
+    transactionCompressedCommits("CompressedCommits", cc), transactionWatchRequests("WatchRequests", cc),
     transactionGetAddressesForKeyRequests("GetAddressesForKeyRequests", cc), transactionBytesRead("BytesRead", cc),
     transactionKeysRead("KeysRead", cc), transactionMetadataVersionReads("MetadataVersionReads", cc),
     transactionCommittedMutations("CommittedMutations", cc),
@@ -1878,7 +1920,10 @@ DatabaseContext::DatabaseContext(const Error& err)
     ccBG("BlobGranuleReadMetrics"), bgReadInputBytes("BGReadInputBytes", ccBG),
     bgReadOutputBytes("BGReadOutputBytes", ccBG), bgReadSnapshotRows("BGReadSnapshotRows", ccBG),
     bgReadRowsCleared("BGReadRowsCleared", ccBG), bgReadRowsInserted("BGReadRowsInserted", ccBG),
-    bgReadRowsUpdated("BGReadRowsUpdated", ccBG), bgLatencies(), bgGranulesPerRequest(), usedAnyChangeFeeds(false),
+    bgReadRowsUpdated("BGReadRowsUpdated", ccBG), bgReadFileCacheHits("BGReadFileCacheHits", ccBG),
+    bgReadFileCacheMisses("BGReadFileCacheMisses", ccBG), bgReadFileCacheHitBytes("BGReadFileCacheHitBytes", ccBG),
+    bgReadFileCacheMissBytes("BGReadFileCacheMissBytes", ccBG), bgLatencies(), bgGranulesPerRequest(),
+    usedAnyChangeFeeds(false),
     ccFeed("ChangeFeedClientMetrics"), feedStreamStarts("FeedStreamStarts", ccFeed),
     feedMergeStreamStarts("FeedMergeStreamStarts", ccFeed), feedErrors("FeedErrors", ccFeed),
     feedNonRetriableErrors("FeedNonRetriableErrors", ccFeed), feedPops("FeedPops", ccFeed),
@@ -1999,27 +2044,92 @@ bool DatabaseContext::getCachedLocations(const TenantInfo& tenant,
 	return true;
 }
 
-Reference<LocationInfo> DatabaseContext::setCachedLocation(const KeyRangeRef& absoluteKeys,
-                                                           const std::vector<StorageServerInterface>& servers) {
+// Each shard gets its own LocationInfo even when it is on the same team as the shards next to it, because
+// locationCache would coalesce adjacent shards with the same value, and a read must not cross a shard boundary.
+// The interfaces of the servers are shared between shards through server_interf.
+Reference<LocationInfo> DatabaseContext::makeLocationInfo(const std::vector<StorageServerInterface>& servers) {
 	std::vector<Reference<ReferencedInterface<StorageServerInterface>>> serverRefs;
 	serverRefs.reserve(servers.size());
 	for (const auto& interf : servers) {
 		serverRefs.push_back(StorageServerInfo::getInterface(this, interf, clientLocality));
 	}
+	return makeReference<LocationInfo>(serverRefs);
+}
 
-	int maxEvictionAttempts = 100, attempts = 0;
-	auto loc = makeReference<LocationInfo>(serverRefs);
-	while (locationCache.size() > locationCacheSize && attempts < maxEvictionAttempts) {
+void DatabaseContext::evictCachedLocations(int toInsert) {
+	int maxEvictionAttempts = 100 * toInsert, attempts = 0;
+	while (locationCache.size() + toInsert > locationCacheSize + 1 && attempts < maxEvictionAttempts) {
 		CODE_PROBE(true, "NativeAPI storage server locationCache entry evicted");
 		attempts++;
 		auto r = locationCache.randomRange();
 		Key begin = r.begin(), end = r.end(); // insert invalidates r, so can't be passed a mere reference into it
 		locationCache.insert(KeyRangeRef(begin, end), Reference<LocationInfo>());
 	}
+}
+
+Reference<LocationInfo> DatabaseContext::setCachedLocation(const KeyRangeRef& absoluteKeys,
+                                                           const std::vector<StorageServerInterface>& servers) {
+	auto loc = makeLocationInfo(servers);
+	evictCachedLocations(1);
 	locationCache.insert(absoluteKeys, loc);
 	return loc;
 }
 
+std::vector<Reference<LocationInfo>> DatabaseContext::setCachedLocations(
+    const std::vector<std::pair<KeyRangeRef, std::vector<StorageServerInterface>>>& locations) {
+	std::vector<Reference<LocationInfo>> results;
+	results.reserve(locations.size());
+	for (const auto& [range, servers] : locations) {
+		results.push_back(makeLocationInfo(servers));
+	}
+	evictCachedLocations(locations.size());
+	for (int i = 0; i < locations.size(); i++) {
+		locationCache.insert(locations[i].first, results[i]);
+	}
+	return results;
+}
+
+namespace {
+struct LocationCacheSnapshot {
+	constexpr static FileIdentifier file_identifier = 4969183;
+	Arena arena;
+	std::vector<std::pair<KeyRangeRef, std::vector<StorageServerInterface>>> locations;
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, locations, arena);
+	}
+};
+} // namespace
+
+Standalone<StringRef> DatabaseContext::serializeLocationCache() {
+	LocationCacheSnapshot snapshot;
+	for (auto it : locationCache.ranges()) {
+		if (!it.value()) {
+			continue;
+		}
+		std::vector<StorageServerInterface> servers;
+		servers.reserve(it.value()->size());
+		for (int i = 0; i < it.value()->size(); i++) {
+			servers.push_back(it.value()->getInterface(i));
+		}
+		snapshot.locations.emplace_back(KeyRangeRef(snapshot.arena, it.range()), std::move(servers));
+	}
+	return ObjectWriter::toValue(snapshot, IncludeVersion());
+}
+
+void DatabaseContext::loadLocationCache(StringRef data) {
+	LocationCacheSnapshot snapshot;
+	ObjectReader reader(data.begin(), IncludeVersion());
+	reader.deserialize(snapshot);
+	// Only as much as fits without evicting, so that locations already fetched by this client are kept
+	int count = std::min<int>(snapshot.locations.size(), std::max(0, locationCacheSize - locationCache.size()));
+	for (int i = 0; i < count; i++) {
+		locationCache.insert(snapshot.locations[i].first, makeLocationInfo(snapshot.locations[i].second));
+	}
+	TraceEvent("LocationCacheLoaded", dbId).detail("Locations", count).detail("Bytes", data.size());
+}
+
 void DatabaseContext::invalidateCache(const Optional<KeyRef>& tenantPrefix, const KeyRef& key, Reverse isBackward) {
 	Arena arena;
 	KeyRef resolvedKey = key;
@@ -2635,6 +2745,8 @@ void setNetworkOption(FDBNetworkOptions::Option option, Optional<StringRef> valu
 			openTracer(TracerType::LOG_FILE);
 		} else if (tracer == "network_lossy") {
 			openTracer(TracerType::NETWORK_LOSSY);
+		} else if (tracer == "network_batched") {
+			openTracer(TracerType::NETWORK_BATCHED);
 		} else {
 			fprintf(stderr, "ERROR: Unknown or unsupported tracer: `%s'", tracer.c_str());
 			throw invalid_option_value();
@@ -3211,15 +3323,12 @@ ACTOR Future<std::vector<KeyRangeLocationInfo>> getKeyRangeLocations_internal(
 						    "TransactionDebug", debugID.get().first(), "NativeAPI.getKeyLocations.After");
 					ASSERT(rep.results.size());
 
-					state std::vector<KeyRangeLocationInfo> results;
-					state int shard = 0;
-					for (; shard < rep.results.size(); shard++) {
-						// FIXME: these shards are being inserted into the map sequentially, it would be much more CPU
-						// efficient to save the map pairs and insert them all at once.
-						results.emplace_back(
-						    (toPrefixRelativeRange(rep.results[shard].first, tenant.prefix) & keys),
-						    cx->setCachedLocation(rep.results[shard].first, rep.results[shard].second));
-						wait(yield());
+					std::vector<KeyRangeLocationInfo> results;
+					std::vector<Reference<LocationInfo>> locationInfos = cx->setCachedLocations(rep.results);
+					results.reserve(rep.results.size());
+					for (int shard = 0; shard < rep.results.size(); shard++) {
+						results.emplace_back((toPrefixRelativeRange(rep.results[shard].first, tenant.prefix) & keys),
+						                     locationInfos[shard]);
 					}
 					updateTssMappings(cx, rep);
 					updateTagMappings(cx, rep);
@@ -3462,6 +3571,18 @@ ACTOR Future<Void> warmRange_impl(Reference<TransactionState> trState, KeyRange
 		}
 	}
 
+	if (!CLIENT_KNOBS->LOCATION_CACHE_SNAPSHOT_FILE.empty()) {
+		try {
+			atomicReplace(CLIENT_KNOBS->LOCATION_CACHE_SNAPSHOT_FILE,
+			              trState->cx->serializeLocationCache().toString(),
+			              false);
+		} catch (Error& e) {
+			TraceEvent(SevWarnAlways, "LocationCacheSaveFailed", trState->cx->dbId)
+			    .error(e)
+			    .detail("File", CLIENT_KNOBS->LOCATION_CACHE_SNAPSHOT_FILE);
+		}
+	}
+
 	return Void();
 }
 
@@ -3631,6 +3752,20 @@ Future<Void> Transaction::warmRange(KeyRange keys) {
 	return warmRange_impl(trState, keys);
 }
 
+// With the long_snapshot option, asks the storage servers of locationInfo that weren't asked yet to keep a snapshot at
+// the read version. Their replies aren't waited for: a server that can't keep one fails the reads that need it.
+void registerLongSnapshot(Reference<TransactionState> const& trState, Reference<LocationInfo> const& locationInfo) {
+	if (!trState->readOptions.present() || !trState->readOptions.get().longSnapshot) {
+		return;
+	}
+	for (int i = 0; i < locationInfo->locations()->size(); i++) {
+		const StorageServerInterface& ssi = locationInfo->locations()->getInterface(i);
+		if (trState->longSnapshotServers.insert(ssi.id()).second) {
+			ssi.longSnapshot.send(LongSnapshotRequest(trState->readVersion()));
+		}
+	}
+}
+
 ACTOR Future<Optional<Value>> getValue(Reference<TransactionState> trState,
                                        Key key,
                                        UseTenant useTenant,
@@ -3658,6 +3793,7 @@ ACTOR Future<Optional<Value>> getValue(Reference<TransactionState> trState,
 		state Optional<ReadOptions> readOptions = trState->readOptions;
 
 		trState->cx->getLatestCommitVersions(locationInfo.locations, trState, ssLatestCommitVersions);
+		registerLongSnapshot(trState, locationInfo.locations);
 		try {
 			if (trState->readOptions.present() && trState->readOptions.get().debugID.present()) {
 				getValueID = nondeterministicRandom()->randomUniqueID();
@@ -4278,6 +4414,21 @@ void transformRangeLimits(GetRangeLimits limits, Reverse reverse, GetKeyValuesFa
 	}
 }
 
+// Mapped range reads can't be prefix compressed
+template <class GetKeyValuesFamilyRequest>
+void requestPrefixCompressedReply(GetKeyValuesFamilyRequest& req) {
+	if constexpr (std::is_same_v<GetKeyValuesFamilyRequest, GetKeyValuesRequest>) {
+		req.prefixCompressReply = CLIENT_KNOBS->PREFIX_COMPRESS_RANGE_REPLIES;
+	}
+}
+
+template <class GetKeyValuesFamilyReply>
+void expandPrefixCompressedReply(GetKeyValuesFamilyReply& rep) {
+	if constexpr (std::is_same_v<GetKeyValuesFamilyReply, GetKeyValuesReply>) {
+		rep.expandPrefixCompressedData();
+	}
+}
+
 template <class GetKeyValuesFamilyRequest>
 PublicRequestStream<GetKeyValuesFamilyRequest> StorageServerInterface::*getRangeRequestStream() {
 	if constexpr (std::is_same<GetKeyValuesFamilyRequest, GetKeyValuesRequest>::value) {
@@ -4333,12 +4484,14 @@ Future<RangeResultFamily> getExactRange(Reference<TransactionState> trState,
 
 			req.spanContext = span.context;
 			trState->cx->getLatestCommitVersions(locations[shard].locations, trState, req.ssLatestCommitVersions);
+			registerLongSnapshot(trState, locations[shard].locations);
 
 			// keep shard's arena around in case of async tss comparison
 			req.arena.dependsOn(locations[shard].range.arena());
 
 			transformRangeLimits(limits, reverse, req);
 			ASSERT(req.limitBytes > 0 && req.limit != 0 && req.limit < 0 == reverse);
+			requestPrefixCompressedReply(req);
 
 			// FIXME: buggify byte limits on internal functions that use them, instead of globally
 			req.tags = trState->cx->sampleReadTags() ? trState->options.readTags : Optional<TagSet>();
@@ -4379,6 +4532,7 @@ Future<RangeResultFamily> getExactRange(Reference<TransactionState> trState,
 							rep = _rep;
 						}
 					}
+					expandPrefixCompressedReply(rep);
 					++trState->cx->transactionPhysicalReadsCompleted;
 				} catch (Error&) {
 					++trState->cx->transactionPhysicalReadsCompleted;
@@ -4703,6 +4857,7 @@ Future<RangeResultFamily> getRange(Reference<TransactionState> trState,
 			req.version = trState->readVersion();
 
 			trState->cx->getLatestCommitVersions(beginServer.locations, trState, req.ssLatestCommitVersions);
+			registerLongSnapshot(trState, beginServer.locations);
 
 			// In case of async tss comparison, also make req arena depend on begin, end, and/or shard's arena depending
 			// on which  is used
@@ -4734,6 +4889,7 @@ Future<RangeResultFamily> getRange(Reference<TransactionState> trState,
 
 			transformRangeLimits(limits, reverse, req);
 			ASSERT(req.limitBytes > 0 && req.limit != 0 && req.limit < 0 == reverse);
+			requestPrefixCompressedReply(req);
 
 			req.tags = trState->cx->sampleReadTags() ? trState->options.readTags : Optional<TagSet>();
 			req.spanContext = span.context;
@@ -4783,6 +4939,7 @@ Future<RangeResultFamily> getRange(Reference<TransactionState> trState,
 					                     trState->options.enableReplicaConsistencyCheck,
 					                     trState->options.requiredReplicas));
 					rep = _rep;
+					expandPrefixCompressedReply(rep);
 					++trState->cx->transactionPhysicalReadsCompleted;
 				} catch (Error&) {
 					++trState->cx->transactionPhysicalReadsCompleted;
@@ -5014,6 +5171,10 @@ static Future<Void> tssStreamComparison(Request request,
 			choose {
 				when(REPLYSTREAM_TYPE(Request) _tssReply = waitNext(tssReplyStream.getFuture())) {
 					tssReply = _tssReply;
+					// the SS reply was expanded before it was duplicated here
+					if constexpr (std::is_same_v<REPLYSTREAM_TYPE(Request), GetKeyValuesStreamReply>) {
+						tssReply.get().expandPrefixCompressedData();
+					}
 				}
 				when(wait(delay(sleepTime))) {
 					++tssData.metrics->tssTimeouts;
@@ -5118,6 +5279,104 @@ maybeDuplicateTSSStreamFragment(Request& req, QueueModel* model, RequestStream<R
 	return Optional<TSSDuplicateStreamData<REPLYSTREAM_TYPE(Request)>>();
 }
 
+// Reads the range for GetRangeLimits::parallel, in up to PARALLEL_RANGE_READ_SHARDS shards at once. The part of the
+// range in each shard is read with an equal share of the byte limit, and the results are concatenated in key order up
+// to the first part that didn't complete, so a result never skips keys. begin and end must be firstGreaterOrEqual.
+ACTOR Future<RangeResult> getRangeParallel(Reference<TransactionState> trState,
+                                           KeySelector begin,
+                                           KeySelector end,
+                                           GetRangeLimits limits,
+                                           Promise<std::pair<Key, Key>> conflictRange,
+                                           Snapshot snapshot) {
+	state RangeResult output;
+	state Key readBegin(begin.getKey(), begin.arena());
+	state Key readEnd(end.getKey(), end.arena());
+	state std::vector<Future<RangeResult>> fragments;
+
+	try {
+		wait(trState->startTransaction());
+		loop {
+			state std::vector<KeyRangeLocationInfo> locations =
+			    wait(getKeyRangeLocations(trState,
+			                              KeyRange(KeyRangeRef(readBegin, readEnd)),
+			                              CLIENT_KNOBS->PARALLEL_RANGE_READ_SHARDS,
+			                              Reverse::False,
+			                              &StorageServerInterface::getKeyValues,
+			                              UseTenant::True));
+			GetRangeLimits fragmentLimits = limits;
+			fragmentLimits.parallel = false;
+			if (limits.hasByteLimit()) {
+				fragmentLimits.bytes = std::max(1, limits.bytes / (int)locations.size());
+			}
+			fragments.clear();
+			for (const auto& location : locations) {
+				KeyRange fragment = location.range & KeyRangeRef(readBegin, readEnd);
+				fragments.push_back(getRange<GetKeyValuesRequest, GetKeyValuesReply, RangeResult>(
+				    trState,
+				    KeySelector(firstGreaterOrEqual(fragment.begin), fragment.arena()),
+				    KeySelector(firstGreaterOrEqual(fragment.end), fragment.arena()),
+				    ""_sr,
+				    fragmentLimits,
+				    Promise<std::pair<Key, Key>>(),
+				    Snapshot::True,
+				    Reverse::False));
+			}
+			wait(waitForAll(fragments));
+
+			bool incomplete = false;
+			for (int i = 0; i < fragments.size() && !incomplete; i++) {
+				const RangeResult& fragment = fragments[i].get();
+				output.arena().dependsOn(fragment.arena());
+				for (const auto& kv : fragment) {
+					output.push_back(output.arena(), kv);
+					limits.decrement(kv);
+					if (limits.isReached()) {
+						break;
+					}
+				}
+				if (limits.isReached() || fragment.more) {
+					output.more = true;
+					if (!limits.isReached() && fragment.readThrough.present()) {
+						output.readThrough = fragment.readThrough;
+					}
+					incomplete = true;
+				}
+			}
+			if (!incomplete) {
+				if (locations.back().range.end < readEnd) {
+					readBegin = locations.back().range.end;
+				} else {
+					readBegin = readEnd;
+				}
+				if (readBegin < readEnd && limits.hasSatisfiedMinRows()) {
+					output.more = true;
+					output.readThrough = KeyRef(output.arena(), readBegin);
+				}
+			}
+			if (incomplete || readBegin >= readEnd || output.more) {
+				break;
+			}
+		}
+		fragments.clear();
+
+		if (!snapshot) {
+			Key conflictEnd(end.getKey(), end.arena());
+			if (output.readThrough.present()) {
+				conflictEnd = output.readThrough.get();
+			} else if (output.more && output.size()) {
+				conflictEnd = keyAfter(output.back().key);
+			}
+			conflictRange.send(std::make_pair(Key(begin.getKey(), begin.arena()), conflictEnd));
+		}
+		return output;
+	} catch (Error& e) {
+		if (conflictRange.canBeSet()) {
+			conflictRange.send(std::make_pair(Key(), Key()));
+		}
+		throw;
+	}
+}
+
 // Streams all of the KV pairs in a target key range into a ParallelStream fragment
 ACTOR Future<Void> getRangeStreamFragment(Reference<TransactionState> trState,
                                           ParallelStream<RangeResult>::Fragment* results,
@@ -5149,6 +5408,7 @@ ACTOR Future<Void> getRangeStreamFragment(Reference<TransactionState> trState,
 			req.limit = reverse ? -CLIENT_KNOBS->REPLY_BYTE_LIMIT : CLIENT_KNOBS->REPLY_BYTE_LIMIT;
 			req.limitBytes = std::numeric_limits<int>::max();
 			req.options = trState->readOptions;
+			req.prefixCompressReply = CLIENT_KNOBS->PREFIX_COMPRESS_RANGE_REPLIES;
 
 			trState->cx->getLatestCommitVersions(locations[shard].locations, trState, req.ssLatestCommitVersions);
 
@@ -5241,6 +5501,7 @@ ACTOR Future<Void> getRangeStreamFragment(Reference<TransactionState> trState,
 
 							when(GetKeyValuesStreamReply _rep = waitNext(replyStream.getFuture())) {
 								rep = _rep;
+								rep.expandPrefixCompressedData();
 							}
 						}
 						++trState->cx->transactionPhysicalReadsCompleted;
@@ -5902,6 +6163,13 @@ Future<RangeResultFamily> Transaction::getRangeInternal(const KeySelector& begin
 		extraConflictRanges.push_back(conflictRange.getFuture());
 	}
 
+	if constexpr (std::is_same_v<GetKeyValuesFamilyRequest, GetKeyValuesRequest>) {
+		if (limits.parallel && !reverse && b.isFirstGreaterOrEqual() && e.isFirstGreaterOrEqual()) {
+			++trState->cx->transactionGetRangeParallelRequests;
+			return getRangeParallel(trState, b, e, limits, conflictRange, snapshot);
+		}
+	}
+
 	return ::getRange<GetKeyValuesFamilyRequest, GetKeyValuesFamilyReply, RangeResultFamily>(
 	    trState, b, e, mapper, limits, conflictRange, snapshot, reverse);
 }
@@ -6294,6 +6562,61 @@ Optional<KeyRangeRef> intersects(VectorRef<KeyRangeRef> lhs, VectorRef<KeyRangeR
 	return Optional<KeyRangeRef>();
 }
 
+// Merges the overlapping and adjacent ranges of ranges, which is what the resolvers would check anyway. If more than
+// maxRanges ranges are left, also closes the gaps between the ranges whose ends share the longest prefixes, as long as
+// they share at least minPrefix bytes, until maxRanges ranges are left. Closing a gap can only add conflicts, of the
+// transaction with writes to the keys in the gap. maxRanges of 0 never closes a gap. The range of metadataVersionKey is
+// left alone, since the tenant prefix isn't added to it. Returns the number of gaps closed.
+int coalesceReadConflictRanges(Arena& arena, VectorRef<KeyRangeRef>& ranges, int maxRanges, int minPrefix) {
+	auto metadataVersionRanges = std::stable_partition(
+	    ranges.begin(), ranges.end(), [](KeyRangeRef r) { return r.begin != metadataVersionKey; });
+	const int n = metadataVersionRanges - ranges.begin();
+	if (!std::is_sorted(ranges.begin(), metadataVersionRanges, compareBegin)) {
+		std::sort(ranges.begin(), metadataVersionRanges, compareBegin);
+	}
+
+	int merged = 0;
+	for (int i = 0; i < n; i++) {
+		if (merged > 0 && ranges[i].begin <= ranges[merged - 1].end) {
+			ranges[merged - 1] = KeyRangeRef(ranges[merged - 1].begin, std::max(ranges[merged - 1].end, ranges[i].end));
+		} else {
+			ranges[merged++] = ranges[i];
+		}
+	}
+
+	int closed = 0;
+	if (maxRanges > 0 && merged > maxRanges) {
+		// The gaps between ranges that share long prefixes are the narrowest
+		std::vector<std::pair<int, int>> gaps; // (common prefix length, range before the gap)
+		for (int i = 0; i + 1 < merged; i++) {
+			int prefix = commonPrefixLength(ranges[i].end, ranges[i + 1].begin);
+			if (prefix >= minPrefix) {
+				gaps.emplace_back(prefix, i);
+			}
+		}
+		closed = std::min<int>(merged - maxRanges, gaps.size());
+		std::nth_element(gaps.begin(), gaps.begin() + closed, gaps.end(), std::greater<>());
+		std::vector<bool> closeGap(merged, false);
+		for (int i = 0; i < closed; i++) {
+			closeGap[gaps[i].second] = true;
+		}
+
+		int widened = 0;
+		for (int i = 0; i < merged; i++) {
+			if (i > 0 && closeGap[i - 1]) {
+				ranges[widened - 1] = KeyRangeRef(ranges[widened - 1].begin, ranges[i].end);
+			} else {
+				ranges[widened++] = ranges[i];
+			}
+		}
+		merged = widened;
+	}
+
+	std::copy(metadataVersionRanges, ranges.end(), ranges.begin() + merged);
+	ranges.resize(arena, merged + (ranges.end() - metadataVersionRanges));
+	return closed;
+}
+
 ACTOR void checkWrites(Reference<TransactionState> trState,
                        Future<Void> committed,
                        Promise<Void> outCommitted,
@@ -6633,6 +6956,21 @@ void applyTenantPrefix(CommitTransactionRequest& req, Key tenantPrefix) {
 	req.transaction.write_conflict_ranges = updatedWriteConflictRanges;
 }
 
+// Whether every commit proxy can be sent compressed mutations. Proxies we haven't connected to yet are assumed not to.
+static bool canCompressCommit(Reference<CommitProxyInfo> const& proxies) {
+	if (!CompressionUtils::supportedFilters.count(CompressionFilter::ZSTD)) {
+		return false;
+	}
+	for (int i = 0; i < proxies->size(); i++) {
+		auto protocol = FlowTransport::transport().getPeerProtocolAsyncVar(proxies->getInterface(i).address());
+		if (!protocol.present() || !protocol.get()->get().present() ||
+		    !protocol.get()->get().get().hasCompressedCommit()) {
+			return false;
+		}
+	}
+	return true;
+}
+
 ACTOR static Future<Void> tryCommit(Reference<TransactionState> trState, CommitTransactionRequest req) {
 	state TraceInterval interval("TransactionCommit");
 	state double startTime = now();
@@ -6707,9 +7045,16 @@ ACTOR static Future<Void> tryCommit(Reference<TransactionState> trState, CommitT
 			}
 		} else {
 			proxiesUsed = trState->cx->getCommitProxies(trState->useProvisionalProxies);
+			// The load balancer copies the request, so compressing a copy leaves req as it is for the code below
+			CommitTransactionRequest sent = req;
+			if (CLIENT_KNOBS->COMMIT_COMPRESSION_MIN_BYTES > 0 &&
+			    req.transaction.mutations.expectedSize() >= CLIENT_KNOBS->COMMIT_COMPRESSION_MIN_BYTES &&
+			    canCompressCommit(proxiesUsed) && sent.compressMutations()) {
+				++trState->cx->transactionCompressedCommits;
+			}
 			reply = basicLoadBalance(proxiesUsed,
 			                         &CommitProxyInterface::commit,
-			                         req,
+			                         sent,
 			                         TaskPriority::DefaultPromiseEndpoint,
 			                         AtMostOnce::True,
 			                         &alternativeChosen);
@@ -6915,6 +7260,16 @@ Future<Void> Transaction::commitMutations() {
 				tr.transaction.read_conflict_ranges.emplace_back(
 				    tr.arena, extraConflictRanges[i].get().first, extraConflictRanges[i].get().second);
 
+		if (CLIENT_KNOBS->COALESCE_READ_CONFLICT_RANGES) {
+			// Widened ranges would be reported instead of the ones the transaction read
+			int closed = coalesceReadConflictRanges(
+			    tr.arena,
+			    tr.transaction.read_conflict_ranges,
+			    trState->options.reportConflictingKeys ? 0 : CLIENT_KNOBS->WIDEN_READ_CONFLICT_RANGES_ABOVE,
+			    CLIENT_KNOBS->WIDEN_READ_CONFLICT_RANGES_MIN_PREFIX);
+			CODE_PROBE(closed > 0, "Read conflict ranges widened before commit");
+		}
+
 		if (tr.idempotencyId.valid()) {
 			// We need to be able confirm that this transaction is no longer in
 			// flight, and if the idempotency id is in the read and write
@@ -7299,6 +7654,18 @@ void Transaction::setOption(FDBTransactionOptions::Option option, Optional<Strin
 		trState->readOptions.withDefault(ReadOptions()).type = ReadType::HIGH;
 		break;
 
+	case FDBTransactionOptions::READ_DEADLINE: {
+		int64_t budgetMs = extractIntOption(value, 0, std::numeric_limits<int>::max());
+		trState->readOptions.withDefault(ReadOptions()).budget =
+		    budgetMs > 0 ? budgetMs / 1000.0 : Optional<double>();
+		break;
+	}
+
+	case FDBTransactionOptions::LONG_SNAPSHOT:
+		validateOptionValueNotPresent(value);
+		trState->readOptions.withDefault(ReadOptions()).longSnapshot = true;
+		break;
+
 	case FDBTransactionOptions::ENABLE_REPLICA_CONSISTENCY_CHECK:
 		validateOptionValueNotPresent(value);
 		trState->options.enableReplicaConsistencyCheck = true;
@@ -8081,7 +8448,113 @@ ACTOR Future<Standalone<VectorRef<ReadHotRangeWithMetrics>>> getReadHotRanges(Da
 	}
 }
 
-ACTOR Future<Optional<StorageMetrics>> waitStorageMetricsWithLocation(TenantInfo tenantInfo,
+// Sends one WaitShardMetricsRequest for waits, and completes the waits the reply answers. The other waits are sent
+// again with the batcher's next request.
+ACTOR Future<Void> waitShardMetricsBatch(StorageServerInterface ssi,
+                                         std::vector<DatabaseContext::ShardMetricsWait> waits,
+                                         PromiseStream<DatabaseContext::ShardMetricsWait> resend) {
+	state WaitShardMetricsRequest req;
+	for (const auto& w : waits) {
+		req.keys.push_back_deep(req.arena, w.keys);
+		req.min.push_back(w.min);
+		req.max.push_back(w.max);
+	}
+	state ErrorOr<WaitShardMetricsReply> reply =
+	    wait(ssi.waitShardMetrics.tryGetReply(req, TaskPriority::DataDistribution));
+	if (reply.isError()) {
+		// The waiters look up the shards' locations again, as when loadBalance() fails
+		for (auto& w : waits) {
+			w.reply.sendError(all_alternatives_failed());
+		}
+		return Void();
+	}
+
+	std::vector<bool> answered(waits.size(), false);
+	for (int i = 0; i < reply.get().changed.size(); i++) {
+		const int index = reply.get().changed[i];
+		answered[index] = true;
+		waits[index].reply.send(reply.get().metrics[i]);
+	}
+	for (int index : reply.get().wrongShard) {
+		answered[index] = true;
+		waits[index].reply.sendError(wrong_shard_server());
+	}
+	for (int i = 0; i < waits.size(); i++) {
+		if (!answered[i]) {
+			resend.send(waits[i]);
+		}
+	}
+	return Void();
+}
+
+// Collects the waits on the metrics of shards on one storage server for STORAGE_METRICS_BATCH_DELAY, and sends them in
+// requests of up to STORAGE_METRICS_BATCH_SIZE shards
+ACTOR Future<Void> shardMetricsBatcher(DatabaseContext::ShardMetricsBatcher* batcher) {
+	state std::vector<DatabaseContext::ShardMetricsWait> pending;
+	state Future<Void> flush = Never();
+	state ActorCollectionNoErrors batches;
+	loop {
+		choose {
+			when(DatabaseContext::ShardMetricsWait w = waitNext(batcher->stream.getFuture())) {
+				if (pending.empty()) {
+					flush = delay(CLIENT_KNOBS->STORAGE_METRICS_BATCH_DELAY, TaskPriority::DataDistribution);
+				}
+				pending.push_back(w);
+			}
+			when(wait(flush)) {
+				flush = Never();
+				std::vector<DatabaseContext::ShardMetricsWait> batch;
+				for (auto& w : pending) {
+					// Skip the waits that were cancelled
+					if (w.reply.getFutureReferenceCount() == 0) {
+						continue;
+					}
+					batch.push_back(w);
+					if (batch.size() >= CLIENT_KNOBS->STORAGE_METRICS_BATCH_SIZE) {
+						batches.add(waitShardMetricsBatch(batcher->ssi, std::move(batch), batcher->stream));
+						batch.clear();
+					}
+				}
+				if (!batch.empty()) {
+					batches.add(waitShardMetricsBatch(batcher->ssi, std::move(batch), batcher->stream));
+				}
+				pending.clear();
+			}
+		}
+	}
+}
+
+// Waits on the metrics of a shard through one of the storage servers that have it, batched with the waits on the other
+// shards of the storage server. Returns an absent Optional if none of the storage servers is available.
+Optional<Future<StorageMetrics>> waitShardMetricsBatched(DatabaseContext* cx,
+                                                         Reference<LocationInfo> location,
+                                                         KeyRange keys,
+                                                         StorageMetrics min,
+                                                         StorageMetrics max) {
+	std::vector<int> available;
+	for (int i = 0; i < location->locations()->size(); i++) {
+		const StorageServerInterface& ssi = location->locations()->getInterface(i);
+		if (IFailureMonitor::failureMonitor().getState(ssi.waitShardMetrics.getEndpoint()).isAvailable()) {
+			available.push_back(i);
+		}
+	}
+	if (available.empty()) {
+		return Optional<Future<StorageMetrics>>();
+	}
+	const StorageServerInterface& ssi =
+	    location->locations()->getInterface(available[deterministicRandom()->randomInt(0, available.size())]);
+	auto& batcher = cx->shardMetricsBatchers[ssi.id()];
+	batcher.ssi = ssi;
+	if (!batcher.actor.isValid()) {
+		batcher.actor = shardMetricsBatcher(&batcher);
+	}
+	DatabaseContext::ShardMetricsWait w{ keys, min, max, Promise<StorageMetrics>() };
+	batcher.stream.send(w);
+	return w.reply.getFuture();
+}
+
+ACTOR Future<Optional<StorageMetrics>> waitStorageMetricsWithLocation(Database cx,
+                                                                      TenantInfo tenantInfo,
                                                                       Version version,
                                                                       KeyRange keys,
                                                                       std::vector<KeyRangeLocationInfo> locations,
@@ -8089,8 +8562,15 @@ ACTOR Future<Optional<StorageMetrics>> waitStorageMetricsWithLocation(TenantInfo
                                                                       StorageMetrics max,
                                                                       StorageMetrics permittedError) {
 	Future<StorageMetrics> fx;
+	Optional<Future<StorageMetrics>> batched;
+	if (locations.size() == 1 && CLIENT_KNOBS->STORAGE_METRICS_BATCH_SIZE > 0 && !tenantInfo.hasTenant() &&
+	    version == latestVersion) {
+		batched = waitShardMetricsBatched(cx.getPtr(), locations[0].locations, keys, min, max);
+	}
 	if (locations.size() > 1) {
 		fx = waitStorageMetricsMultipleLocations(tenantInfo, version, locations, min, max, permittedError);
+	} else if (batched.present()) {
+		fx = batched.get();
 	} else {
 		WaitMetricsRequest req(tenantInfo, version, keys, min, max);
 		fx = loadBalance(locations[0].locations->locations(),
@@ -8153,8 +8633,8 @@ ACTOR Future<std::pair<Optional<StorageMetrics>, int>> waitStorageMetrics(
 		}
 
 		try {
-			Optional<StorageMetrics> res =
-			    wait(waitStorageMetricsWithLocation(tenantInfo, version, keys, locations, min, max, permittedError));
+			Optional<StorageMetrics> res = wait(
+			    waitStorageMetricsWithLocation(cx, tenantInfo, version, keys, locations, min, max, permittedError));
 			if (res.present()) {
 				return std::make_pair(res, -1);
 			}
@@ -8230,6 +8710,25 @@ ACTOR Future<Standalone<VectorRef<DDMetricsRef>>> waitDataDistributionMetricsLis
 	}
 }
 
+ACTOR Future<Standalone<VectorRef<HeatmapBucketRef>>> waitDataDistributionHeatmap(Database cx,
+                                                                                  KeyRange keys,
+                                                                                  double since) {
+	loop {
+		choose {
+			when(wait(cx->onProxiesChanged())) {}
+			when(ErrorOr<GetDDHeatmapReply> rep =
+			         wait(errorOr(basicLoadBalance(cx->getCommitProxies(UseProvisionalProxies::False),
+			                                       &CommitProxyInterface::getDDHeatmap,
+			                                       GetDDHeatmapRequest(keys, since))))) {
+				if (rep.isError()) {
+					throw rep.getError();
+				}
+				return rep.get().buckets;
+			}
+		}
+	}
+}
+
 Future<Standalone<VectorRef<ReadHotRangeWithMetrics>>> DatabaseContext::getReadHotRanges(KeyRange const& keys) {
 	return ::getReadHotRanges(Database(Reference<DatabaseContext>::addRef(this)), keys);
 }
@@ -8645,6 +9144,10 @@ void Transaction::addGranuleMaterializeStats(const GranuleMaterializeStats& stat
 	trState->cx->bgReadRowsCleared += stats.rowsCleared;
 	trState->cx->bgReadRowsInserted += stats.rowsInserted;
 	trState->cx->bgReadRowsUpdated += stats.rowsUpdated;
+	trState->cx->bgReadFileCacheHits += stats.fileCacheHits;
+	trState->cx->bgReadFileCacheMisses += stats.fileCacheMisses;
+	trState->cx->bgReadFileCacheHitBytes += stats.fileCacheHitBytes;
+	trState->cx->bgReadFileCacheMissBytes += stats.fileCacheMissBytes;
 }
 
 ACTOR Future<Version> setPerpetualStorageWiggle(Database cx, bool enable, LockAware lockAware) {
@@ -10107,7 +10610,7 @@ Future<Void> ChangeFeedData::whenAtLeast(Version version) {
 #define DEBUG_CF_CLIENT_TRACE false
 
 ACTOR Future<Void> partialChangeFeedStream(StorageServerInterface interf,
-                                           PromiseStream<Standalone<MutationsAndVersionRef>> results,
+                                           PromiseStream<Standalone<VectorRef<MutationsAndVersionRef>>> results,
                                            ReplyPromiseStream<ChangeFeedStreamReply> replyStream,
                                            Version begin,
                                            Version end,
@@ -10171,34 +10674,44 @@ ACTOR Future<Void> partialChangeFeedStream(StorageServerInterface interf,
 						lastEmpty = invalidVersion;
 					}
 
-					state int resultLoc = 0;
-					while (resultLoc < rep.mutations.size()) {
-						wait(results.onEmpty());
-						if (rep.mutations[resultLoc].version >= nextVersion) {
-							if (tssData->present() && tssData->get().shouldAddMutation(rep.mutations[resultLoc])) {
-								tssData->get().ssStreamSummary.send(rep.mutations[resultLoc].version);
+					wait(results.onEmpty());
+					// send the versions of the reply as one batch sharing its arena
+					VectorRef<MutationsAndVersionRef> batch = rep.mutations;
+					if (rep.mutations.front().version < nextVersion) {
+						batch = VectorRef<MutationsAndVersionRef>();
+						for (auto& m : rep.mutations) {
+							if (m.version >= nextVersion) {
+								batch.push_back(rep.arena, m);
+							} else {
+								ASSERT(m.mutations.empty());
+							}
+						}
+					}
+					if (!batch.empty()) {
+						if (tssData->present()) {
+							for (auto& m : batch) {
+								if (tssData->get().shouldAddMutation(m)) {
+									tssData->get().ssStreamSummary.send(m.version);
+								}
 							}
+						}
 
-							results.send(rep.mutations[resultLoc]);
+						results.send(Standalone<VectorRef<MutationsAndVersionRef>>(batch, rep.arena));
 
-							if (DEBUG_CF_CLIENT_TRACE) {
-								TraceEvent(SevDebug, "TraceChangeFeedClientMergeCursorSend", debugUID)
-								    .detail("Version", rep.mutations[resultLoc].version)
-								    .detail("Size", rep.mutations[resultLoc].mutations.size());
-							}
+						if (DEBUG_CF_CLIENT_TRACE) {
+							TraceEvent(SevDebug, "TraceChangeFeedClientMergeCursorSend", debugUID)
+							    .detail("FirstVersion", batch.front().version)
+							    .detail("LastVersion", batch.back().version)
+							    .detail("Count", batch.size());
+						}
 
-							// check refresh.canBeSet so that, if we are killed after calling one of these callbacks, we
-							// just skip to the next wait and get actor_cancelled
-							// FIXME: this is somewhat expensive to do every mutation.
-							for (auto& it : feedData->storageData) {
-								if (refresh.canBeSet() && rep.mutations[resultLoc].version > it->desired.get()) {
-									it->desired.set(rep.mutations[resultLoc].version);
-								}
+						// check refresh.canBeSet so that, if we are killed after calling one of these callbacks, we
+						// just skip to the next wait and get actor_cancelled
+						for (auto& it : feedData->storageData) {
+							if (refresh.canBeSet() && batch.back().version > it->desired.get()) {
+								it->desired.set(batch.back().version);
 							}
-						} else {
-							ASSERT(rep.mutations[resultLoc].mutations.empty());
 						}
-						resultLoc++;
 					}
 
 					// if we got the empty version that went backwards, don't decrease nextVersion
@@ -10224,15 +10737,15 @@ ACTOR Future<Void> partialChangeFeedStream(StorageServerInterface interf,
 				when(wait(atLatestVersion && replyStream.isEmpty() && results.isEmpty()
 				              ? storageData->version.whenAtLeast(nextVersion)
 				              : Future<Void>(Never()))) {
-					MutationsAndVersionRef empty;
-					empty.version = storageData->version.get();
+					Standalone<VectorRef<MutationsAndVersionRef>> empty;
+					empty.push_back(empty.arena(), MutationsAndVersionRef(storageData->version.get(), invalidVersion));
 					results.send(empty);
 					nextVersion = storageData->version.get() + 1;
 					if (DEBUG_CF_CLIENT_TRACE) {
 						TraceEvent(SevDebug, "TraceChangeFeedClientMergeCursorSendEmpty", debugUID)
-						    .detail("Version", empty.version);
+						    .detail("Version", empty.back().version);
 					}
-					lastEmpty = empty.version;
+					lastEmpty = empty.back().version;
 				}
 				when(wait(atLatestVersion && replyStream.isEmpty() && !results.isEmpty() ? results.onEmpty()
 				                                                                         : Future<Void>(Never()))) {}
@@ -10275,6 +10788,116 @@ void writeMutationsToCache(Reference<ChangeFeedCacheData> cacheData,
 	}
 }
 
+// A tournament tree over the partial streams of a merge cursor, whose winner is the stream with the smallest next
+// version. After the next version of a stream changes, replay() updates the tree in O(log(streams)).
+class ChangeFeedMergeTree {
+public:
+	explicit ChangeFeedMergeTree(std::vector<MutationAndVersionStream> const* streams) : streams(streams) {
+		while (leaves < streams->size()) {
+			leaves *= 2;
+		}
+		tree.assign(2 * leaves, -1);
+		for (int i = 0; i < streams->size(); i++) {
+			tree[leaves + i] = i;
+		}
+		for (int n = leaves - 1; n >= 1; n--) {
+			tree[n] = play(tree[2 * n], tree[2 * n + 1]);
+		}
+	}
+
+	int winner() const { return tree[1]; }
+
+	void replay(int stream) {
+		for (int n = (leaves + stream) / 2; n >= 1; n /= 2) {
+			tree[n] = play(tree[2 * n], tree[2 * n + 1]);
+		}
+	}
+
+private:
+	int play(int a, int b) const {
+		if (a < 0 || b < 0) {
+			return std::max(a, b);
+		}
+		return (*streams)[b].nextVersion() < (*streams)[a].nextVersion() ? b : a;
+	}
+
+	std::vector<MutationAndVersionStream> const* streams;
+	int leaves = 1;
+	std::vector<int> tree; // tree[1] is the root, and the children of tree[n] are tree[2n] and tree[2n+1]
+};
+
+// Merges the versions at the heads of streams, combining the mutations of each version from every stream, into one
+// batch which shares the arenas of the streams' batches instead of copying mutations. Every stream must have a next
+// version or have ended. Stops once the next version needs the next batch of a stream which hasn't arrived yet, or
+// the batch has CHANGE_FEED_MERGE_BATCH_BYTES of mutations. Adds the streams whose batches it read all of to usedUp.
+// Versions without mutations advance *begin but aren't added.
+Standalone<VectorRef<MutationsAndVersionRef>> mergeChangeFeedBatch(std::vector<MutationAndVersionStream>& streams,
+                                                                  ChangeFeedMergeTree& heads,
+                                                                  std::vector<int>& usedUp,
+                                                                  Version* begin,
+                                                                  Version lastReturnedVersion) {
+	Standalone<VectorRef<MutationsAndVersionRef>> out;
+	int64_t bytes = 0;
+	auto advance = [&](int stream) {
+		if (++streams[stream].nextIndex == streams[stream].next.size()) {
+			usedUp.push_back(stream);
+		}
+		heads.replay(stream);
+	};
+
+	while (streams[heads.winner()].nextVersion() != MAX_VERSION) {
+		MutationAndVersionStream& first = streams[heads.winner()];
+		const Version version = first.nextVersion();
+		ASSERT(version >= *begin);
+		MutationsAndVersionRef merged = first.next[first.nextIndex];
+		out.arena().dependsOn(first.next.arena());
+		advance(heads.winner());
+
+		// add the mutations other streams have at the same version
+		bool copied = false;
+		while (streams[heads.winner()].nextVersion() == version) {
+			MutationAndVersionStream& other = streams[heads.winner()];
+			VectorRef<MutationRef> const& mutations = other.next[other.nextIndex].mutations;
+			if (mutations.size() && mutations.front().param1 != lastEpochEndPrivateKey) {
+				if (!copied) {
+					VectorRef<MutationRef> all;
+					all.append(out.arena(), merged.mutations.begin(), merged.mutations.size());
+					merged.mutations = all;
+					copied = true;
+				}
+				merged.mutations.append(out.arena(), mutations.begin(), mutations.size());
+				out.arena().dependsOn(other.next.arena());
+			}
+			advance(heads.winner());
+		}
+
+		*begin = version + 1;
+		if (!merged.mutations.empty()) {
+			ASSERT(version > lastReturnedVersion);
+			out.push_back(out.arena(), merged);
+			bytes += merged.expectedSize();
+		}
+		if (bytes >= CLIENT_KNOBS->CHANGE_FEED_MERGE_BATCH_BYTES) {
+			break;
+		}
+
+		// go on while the streams read all of already have their next batch
+		for (int stream : usedUp) {
+			FutureStream<Standalone<VectorRef<MutationsAndVersionRef>>> next = streams[stream].results.getFuture();
+			if (!next.isReady() || next.isError()) {
+				return out;
+			}
+		}
+		for (int stream : usedUp) {
+			streams[stream].next = streams[stream].results.getFuture().pop();
+			streams[stream].nextIndex = 0;
+			heads.replay(stream);
+		}
+		usedUp.clear();
+	}
+	return out;
+}
+
 ACTOR Future<Void> mergeChangeFeedStreamInternal(Reference<ChangeFeedData> results,
                                                  Key rangeID,
                                                  KeyRange range,
@@ -10289,7 +10912,7 @@ ACTOR Future<Void> mergeChangeFeedStreamInternal(Reference<ChangeFeedData> resul
 	state Promise<Void> refresh = results->refresh;
 	// with empty version handling in the partial cursor, all streams will always have a next element with version >=
 	// the minimum version of any stream's next element
-	state std::priority_queue<MutationAndVersionStream, std::vector<MutationAndVersionStream>> mutations;
+	state ChangeFeedMergeTree heads(&streams);
 
 	if (DEBUG_CF_CLIENT_TRACE) {
 		TraceEvent(SevDebug, "TraceChangeFeedClientMergeCursorStart", mergeCursorUID)
@@ -10313,83 +10936,64 @@ ACTOR Future<Void> mergeChangeFeedStreamInternal(Reference<ChangeFeedData> resul
 		results->lastReturnedVersion.set(*begin - 1);
 	}
 
-	state int interfNum = 0;
+	state int usedUpNum = 0;
 
-	state std::vector<MutationAndVersionStream> streamsUsed;
+	state std::vector<int> usedUp;
 	// initially, pull from all streams
-	for (auto& stream : streams) {
-		streamsUsed.push_back(stream);
+	for (int i = 0; i < streams.size(); i++) {
+		usedUp.push_back(i);
 	}
 
-	state Version nextVersion;
+	state Version lastVersion;
 	loop {
-		// bring all of the streams up to date to ensure we have the latest element from each stream in mutations
-		interfNum = 0;
-		while (interfNum < streamsUsed.size()) {
+		// bring all of the streams whose batches were merged up to date, so that every stream's next version is known
+		usedUpNum = 0;
+		while (usedUpNum < usedUp.size()) {
+			state MutationAndVersionStream* stream = &streams[usedUp[usedUpNum]];
 			try {
-				Standalone<MutationsAndVersionRef> res = waitNext(streamsUsed[interfNum].results.getFuture());
-				streamsUsed[interfNum].next = res;
-				mutations.push(streamsUsed[interfNum]);
+				Standalone<VectorRef<MutationsAndVersionRef>> res = waitNext(stream->results.getFuture());
+				stream->next = res;
+				stream->nextIndex = 0;
 			} catch (Error& e) {
 				if (e.code() != error_code_end_of_stream) {
 					throw e;
 				}
 			}
-			interfNum++;
+			heads.replay(usedUp[usedUpNum]);
+			usedUpNum++;
 		}
 
-		if (mutations.empty()) {
+		if (streams[heads.winner()].nextVersion() == MAX_VERSION) {
 			throw end_of_stream();
 		}
 
-		streamsUsed.clear();
+		usedUp.clear();
 
 		// Without this delay, weird issues with the last stream getting on another stream's callstack can happen
 		wait(delay(0));
 
-		// pop first item off queue - this will be mutation with the lowest version
-		Standalone<VectorRef<MutationsAndVersionRef>> nextOut;
-		nextVersion = mutations.top().next.version;
-
-		streamsUsed.push_back(mutations.top());
-		nextOut.push_back_deep(nextOut.arena(), mutations.top().next);
-		mutations.pop();
-
-		// for each other stream that has mutations with the same version, add it to nextOut
-		while (!mutations.empty() && mutations.top().next.version == nextVersion) {
-			if (mutations.top().next.mutations.size() &&
-			    mutations.top().next.mutations.front().param1 != lastEpochEndPrivateKey) {
-				nextOut.back().mutations.append_deep(
-				    nextOut.arena(), mutations.top().next.mutations.begin(), mutations.top().next.mutations.size());
-			}
-			streamsUsed.push_back(mutations.top());
-			mutations.pop();
-		}
-
-		ASSERT(nextOut.size() == 1);
-		ASSERT(nextVersion >= *begin);
-
-		*begin = nextVersion + 1;
+		Standalone<VectorRef<MutationsAndVersionRef>> nextOut =
+		    mergeChangeFeedBatch(streams, heads, usedUp, begin, results->lastReturnedVersion.get());
+		lastVersion = *begin - 1;
 
 		if (DEBUG_CF_CLIENT_TRACE) {
 			TraceEvent(SevDebug, "TraceChangeFeedClientMergeCursorSending", mergeCursorUID)
-			    .detail("Count", streamsUsed.size())
-			    .detail("Version", nextVersion);
+			    .detail("Count", nextOut.size())
+			    .detail("Version", lastVersion);
 		}
 
-		// send mutations at nextVersion to the client
-		if (nextOut.back().mutations.empty()) {
+		// send the merged versions with mutations to the client
+		if (nextOut.empty()) {
 			ASSERT(results->mutations.isEmpty());
 		} else {
-			ASSERT(nextOut.back().version > results->lastReturnedVersion.get());
 			writeMutationsToCache(cacheData, db, nextOut, rangeID, range, tenantPrefix);
 			results->mutations.send(nextOut);
 			wait(results->mutations.onEmpty());
 			wait(delay(0));
 		}
 
-		if (nextVersion > results->lastReturnedVersion.get()) {
-			results->lastReturnedVersion.set(nextVersion);
+		if (lastVersion > results->lastReturnedVersion.get()) {
+			results->lastReturnedVersion.set(lastVersion);
 		}
 	}
 }
@@ -10640,6 +11244,154 @@ ACTOR Future<Void> singleChangeFeedStreamInternal(KeyRange range,
 	}
 }
 
+// Streams the feeds of subscribers over one ChangeFeedMultiStreamRequest, and forwards each feed's part of the replies
+// to its subscriber. Feeds aren't flow controlled separately, so a subscriber that doesn't keep up, or the rest of the
+// subscribers once half of them are gone, get request_maybe_delivered to restart their streams.
+ACTOR Future<Void> changeFeedMultiStream(StorageServerInterface ssi,
+                                         std::vector<DatabaseContext::ChangeFeedStreamSubscriber> subscribers) {
+	state ChangeFeedMultiStreamRequest req;
+	state std::vector<bool> live(subscribers.size(), true);
+	state std::vector<int64_t> buffered(subscribers.size(), 0);
+	state int liveCount = subscribers.size();
+	req.id = deterministicRandom()->randomUniqueID();
+	for (const auto& sub : subscribers) {
+		ChangeFeedStreamSubscription feed;
+		feed.rangeID = sub.req.rangeID;
+		feed.begin = sub.req.begin;
+		feed.end = sub.req.end;
+		feed.range = sub.req.range;
+		feed.canReadPopped = sub.req.canReadPopped;
+		feed.id = sub.req.id;
+		feed.options = sub.req.options;
+		feed.encrypted = sub.req.encrypted;
+		req.feeds.push_back(feed);
+		req.replyBufferSize = std::max(req.replyBufferSize, sub.req.replyBufferSize);
+	}
+	if (DEBUG_CF_CLIENT_TRACE) {
+		TraceEvent(SevDebug, "TraceChangeFeedClientMultiStream", req.id)
+		    .detail("Feeds", req.feeds.size())
+		    .detail("StorageServer", ssi.id());
+	}
+
+	state ReplyPromiseStream<ChangeFeedMultiStreamReply> replies = ssi.changeFeedMultiStream.getReplyStream(req);
+	try {
+		loop {
+			ChangeFeedMultiStreamReply reply = waitNext(replies.getFuture());
+			for (const auto& entry : reply.feeds) {
+				ASSERT(entry.feed >= 0 && entry.feed < subscribers.size());
+				const int i = entry.feed;
+				if (!live[i]) {
+					continue;
+				}
+				auto& sub = subscribers[i];
+				if (!entry.mutations.empty()) {
+					if (sub.req.reply.isEmpty()) {
+						buffered[i] = 0;
+					}
+					ChangeFeedStreamReply feedReply;
+					feedReply.arena = reply.arena;
+					feedReply.mutations = entry.mutations;
+					feedReply.atLatestVersion = entry.atLatestVersion;
+					feedReply.minStreamVersion = reply.minStreamVersion;
+					feedReply.popVersion = entry.popVersion;
+					buffered[i] += feedReply.expectedSize();
+					sub.req.reply.send(feedReply);
+				}
+				if (entry.error.present()) {
+					sub.req.reply.sendError(entry.error.get());
+					live[i] = false;
+					liveCount--;
+				} else if (buffered[i] > CLIENT_KNOBS->CHANGE_FEED_MULTI_STREAM_BUFFER_BYTES) {
+					CODE_PROBE(true, "Restarting change feed that fell behind its multi stream");
+					sub.req.reply.sendError(request_maybe_delivered());
+					live[i] = false;
+					liveCount--;
+				}
+			}
+			for (int i = 0; i < subscribers.size(); i++) {
+				if (live[i] && subscribers[i].active.isReady()) {
+					live[i] = false;
+					liveCount--;
+				}
+			}
+			if (liveCount * 2 < subscribers.size()) {
+				CODE_PROBE(liveCount > 0, "Restarting the remaining change feeds of a multi stream");
+				for (int i = 0; i < subscribers.size(); i++) {
+					if (live[i]) {
+						subscribers[i].req.reply.sendError(request_maybe_delivered());
+					}
+				}
+				return Void();
+			}
+		}
+	} catch (Error& e) {
+		if (e.code() == error_code_actor_cancelled) {
+			throw;
+		}
+		for (int i = 0; i < subscribers.size(); i++) {
+			if (live[i]) {
+				subscribers[i].req.reply.sendError(e);
+			}
+		}
+	}
+	return Void();
+}
+
+// Collects the change feed streams to one storage server for CHANGE_FEED_MULTI_STREAM_BATCH_DELAY, and streams them in
+// ChangeFeedMultiStreamRequests of up to CHANGE_FEED_MULTI_STREAM_BATCH_SIZE feeds
+ACTOR Future<Void> changeFeedStreamBatcher(DatabaseContext::ChangeFeedStreamBatcher* batcher) {
+	state std::vector<DatabaseContext::ChangeFeedStreamSubscriber> pending;
+	state Future<Void> flush = Never();
+	state ActorCollectionNoErrors streams;
+	loop {
+		choose {
+			when(DatabaseContext::ChangeFeedStreamSubscriber sub = waitNext(batcher->stream.getFuture())) {
+				if (pending.empty()) {
+					flush = delay(CLIENT_KNOBS->CHANGE_FEED_MULTI_STREAM_BATCH_DELAY);
+				}
+				pending.push_back(sub);
+			}
+			when(wait(flush)) {
+				flush = Never();
+				std::vector<DatabaseContext::ChangeFeedStreamSubscriber> batch;
+				for (auto& sub : pending) {
+					// Skip the streams that are no longer used
+					if (sub.active.isReady()) {
+						continue;
+					}
+					batch.push_back(sub);
+					if (batch.size() >= CLIENT_KNOBS->CHANGE_FEED_MULTI_STREAM_BATCH_SIZE) {
+						streams.add(changeFeedMultiStream(batcher->ssi, std::move(batch)));
+						batch.clear();
+					}
+				}
+				if (!batch.empty()) {
+					streams.add(changeFeedMultiStream(batcher->ssi, std::move(batch)));
+				}
+				pending.clear();
+			}
+		}
+	}
+}
+
+// Streams a change feed from a storage server together with the client's other feeds from the storage server. Returns
+// the stream that gets the feed's replies, or an absent Optional if the storage server is not available.
+Optional<ReplyPromiseStream<ChangeFeedStreamReply>> changeFeedStreamBatched(DatabaseContext* cx,
+                                                                             StorageServerInterface ssi,
+                                                                             ChangeFeedStreamRequest req,
+                                                                             Future<Void> active) {
+	if (!IFailureMonitor::failureMonitor().getState(ssi.changeFeedMultiStream.getEndpoint()).isAvailable()) {
+		return Optional<ReplyPromiseStream<ChangeFeedStreamReply>>();
+	}
+	auto& batcher = cx->changeFeedStreamBatchers[ssi.id()];
+	batcher.ssi = ssi;
+	if (!batcher.actor.isValid()) {
+		batcher.actor = changeFeedStreamBatcher(&batcher);
+	}
+	batcher.stream.send(DatabaseContext::ChangeFeedStreamSubscriber{ req, active });
+	return req.reply;
+}
+
 ACTOR Future<Void> singleChangeFeedStream(Reference<DatabaseContext> db,
                                           StorageServerInterface interf,
                                           KeyRange range,
@@ -10677,7 +11429,17 @@ ACTOR Future<Void> singleChangeFeedStream(Reference<DatabaseContext> db,
 
 	results->streams.clear();
 
-	results->streams.push_back(interf.changeFeedStream.getReplyStream(req));
+	// Broken when this stream is no longer used, so a batched stream stops forwarding the feed
+	state Promise<Void> streamActive;
+	Optional<ReplyPromiseStream<ChangeFeedStreamReply>> batched;
+	if (CLIENT_KNOBS->CHANGE_FEED_MULTI_STREAM_BATCH_SIZE > 0 && !canReadPopped) {
+		batched = changeFeedStreamBatched(db.getPtr(), interf, req, streamActive.getFuture());
+	}
+	if (batched.present()) {
+		results->streams.push_back(batched.get());
+	} else {
+		results->streams.push_back(interf.changeFeedStream.getReplyStream(req));
+	}
 
 	results->maxSeenVersion = invalidVersion;
 	results->storageData.clear();
@@ -11718,3 +12480,57 @@ ACTOR Future<std::vector<std::pair<StorageServerInterface, ProcessClass>>> getSe
 }
 
 } // namespace NativeAPI
+
+TEST_CASE("/fdbclient/NativeAPI/coalesceReadConflictRanges") {
+	auto randomKey = [](Arena& arena) {
+		return StringRef(arena, deterministicRandom()->randomAlphaNumeric(deterministicRandom()->randomInt(0, 3)));
+	};
+	auto contains = [](VectorRef<KeyRangeRef> ranges, KeyRef key) {
+		return std::any_of(ranges.begin(), ranges.end(), [key](KeyRangeRef r) { return r.contains(key); });
+	};
+
+	for (int test = 0; test < 100; test++) {
+		Arena arena;
+		VectorRef<KeyRangeRef> ranges;
+		for (int i = deterministicRandom()->randomInt(0, 50); i > 0; i--) {
+			KeyRef a = randomKey(arena), b = randomKey(arena);
+			ranges.push_back(arena, a < b ? KeyRangeRef(a, b) : KeyRangeRef(b, a));
+		}
+		if (deterministicRandom()->coinflip()) {
+			ranges.push_back(arena, singleKeyRange(metadataVersionKey, arena));
+		}
+		VectorRef<KeyRangeRef> original(arena, ranges);
+
+		const bool widen = deterministicRandom()->coinflip();
+		const int maxRanges = widen ? deterministicRandom()->randomInt(1, 10) : 0;
+		const int minPrefix = deterministicRandom()->randomInt(0, 2);
+		const int closed = coalesceReadConflictRanges(arena, ranges, maxRanges, minPrefix);
+		ASSERT(widen || closed == 0);
+
+		// The ranges are kept apart, and only the metadata version key range follows the others
+		int metadataVersionRanges = 0;
+		for (int i = 0; i < ranges.size(); i++) {
+			if (ranges[i].begin == metadataVersionKey) {
+				++metadataVersionRanges;
+			} else {
+				ASSERT(metadataVersionRanges == 0);
+				ASSERT(i == 0 || ranges[i - 1].end < ranges[i].begin);
+			}
+		}
+		ASSERT(metadataVersionRanges == std::count_if(original.begin(), original.end(), [](KeyRangeRef r) {
+			       return r.begin == metadataVersionKey;
+		       }));
+
+		for (int i = 0; i < 100; i++) {
+			Key key = StringRef(deterministicRandom()->randomAlphaNumeric(deterministicRandom()->randomInt(0, 4)));
+			if (contains(original, key)) {
+				ASSERT(contains(ranges, key));
+			} else if (!widen) {
+				ASSERT(!contains(ranges, key));
+			}
+		}
+		ASSERT(contains(original, metadataVersionKey) == contains(ranges, metadataVersionKey));
+	}
+
+	return Void();
+}
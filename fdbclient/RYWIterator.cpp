@@ -629,6 +629,27 @@ TEST_CASE("/fdbclient/WriteMap/addValue") {
 	return Void();
 }
 
+TEST_CASE("/fdbclient/WriteMap/deferredWrites") {
+	Arena arena = Arena();
+	WriteMap writes = WriteMap(&arena);
+	ASSERT(getWriteMapCount(&writes) == 1);
+	ASSERT(writes.onlyDeferredWrites() == CLIENT_KNOBS->RYW_DEFER_WRITES);
+
+	writes.mutate("apple"_sr, MutationRef::SetValue, "red"_sr, true);
+	writes.clear(KeyRangeRef("b"_sr, "c"_sr), false);
+	ASSERT(!writes.empty());
+	ASSERT(writes.getDeferredWrites().size() == (writes.onlyDeferredWrites() ? 2 : 0));
+
+	// Reading the map applies the deferred writes, and later writes are applied at once
+	ASSERT(getWriteMapCount(&writes) == 5);
+	ASSERT(!writes.onlyDeferredWrites() && writes.getDeferredWrites().empty());
+	writes.mutate("apple"_sr, MutationRef::AddValue, "1"_sr, true);
+	ASSERT(writes.getDeferredWrites().empty());
+	ASSERT(getWriteMapCount(&writes) == 5);
+
+	return Void();
+}
+
 TEST_CASE("/fdbclient/WriteMap/random") {
 	Arena arena = Arena();
 	WriteMap writes = WriteMap(&arena);
@@ -821,3 +842,81 @@ TEST_CASE("/fdbclient/WriteMap/random") {
 
 	return Void();
 }
+
+TEST_CASE("/fdbclient/SnapshotCache/random") {
+	Arena arena;
+	SnapshotCache cache(&arena);
+
+	// The snapshot has about half of the keys of getKeyForIndex()
+	std::map<KeyRef, ValueRef> snapshot;
+	for (int i = 0; i < 100; i++) {
+		if (deterministicRandom()->coinflip()) {
+			snapshot[RandomTestImpl::getKeyForIndex(arena, i)] = RandomTestImpl::getRandomValue(arena);
+		}
+	}
+	KeyRangeMap<bool> knownMap;
+
+	KeyRef lastEnd = allKeys.begin;
+	for (int i = 0; i < 100; i++) {
+		if (deterministicRandom()->random01() < 0.3) {
+			KeyRef key = deterministicRandom()->coinflip() ? lastEnd : RandomTestImpl::getRandomKey(arena);
+			auto s = snapshot.find(key);
+			cache.insert(key, s != snapshot.end() ? s->second : Optional<ValueRef>());
+			knownMap.insert(key, true);
+			lastEnd = keyAfter(key, arena);
+		} else {
+			// Reads of consecutive ranges, in either direction, are common
+			KeyRef begin = RandomTestImpl::getRandomKey(arena);
+			KeyRef end = RandomTestImpl::getRandomKey(arena);
+			if (deterministicRandom()->coinflip()) {
+				begin = lastEnd;
+			}
+			if (end < begin) {
+				std::swap(begin, end);
+			}
+			VectorRef<KeyValueRef> values;
+			for (auto s = snapshot.lower_bound(begin); s != snapshot.end() && s->first < end; ++s) {
+				values.push_back(arena, KeyValueRef(s->first, s->second));
+			}
+			cache.insert(KeyRangeRef(begin, end), values);
+			knownMap.insert(KeyRangeRef(begin, end), true);
+			lastEnd = deterministicRandom()->coinflip() ? end : begin;
+		}
+	}
+
+	for (int i = 0; i < 100; i++) {
+		KeyRef key = RandomTestImpl::getKeyForIndex(arena, i);
+		SnapshotCache::iterator it(&cache);
+		it.skip(key);
+		ASSERT(it.beginKey() <= key && key < it.endKey());
+		auto s = snapshot.find(key);
+		if (!knownMap[key]) {
+			ASSERT(it.is_unknown_range());
+		} else if (s != snapshot.end()) {
+			ASSERT(it.is_kv() && it.kv(arena)->key == key && it.kv(arena)->value == s->second);
+		} else {
+			ASSERT(it.is_empty_range());
+		}
+	}
+
+	// Iterating forwards and backwards gives the same segments
+	std::vector<std::pair<Key, Key>> segments;
+	SnapshotCache::iterator it(&cache);
+	it.skip(allKeys.begin);
+	while (true) {
+		segments.emplace_back(it.beginKey().toStandaloneStringRef(), it.endKey().toStandaloneStringRef());
+		if (it.endKey() >= allKeys.end) {
+			break;
+		}
+		ASSERT(it.endKey() > it.beginKey());
+		++it;
+		ASSERT(it.beginKey() == segments.back().second);
+	}
+	for (int i = segments.size() - 1; i > 0; i--) {
+		ASSERT(it.beginKey() == segments[i].first && it.endKey() == segments[i].second);
+		--it;
+	}
+	ASSERT(it.beginKey() == allKeys.begin);
+
+	return Void();
+}
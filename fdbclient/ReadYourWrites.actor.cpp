@@ -1389,7 +1389,7 @@ public:
 				return Void();
 			}
 
-			ryw->writeRangeToNativeTransaction(KeyRangeRef(StringRef(), allKeys.end));
+			ryw->writeToNativeTransaction();
 
 			auto conflictRanges = ryw->readConflicts.ranges();
 			for (auto iter = conflictRanges.begin(); iter != conflictRanges.end(); ++iter) {
@@ -2071,6 +2071,31 @@ void ReadYourWritesTransaction::writeRangeToNativeTransaction(KeyRangeRef const&
 	}
 }
 
+// Writes all of the writes to the native transaction. If none have been applied to the write map, they are written in
+// the order they were made, which the commit proxies apply to the same effect.
+void ReadYourWritesTransaction::writeToNativeTransaction() {
+	if (!writes.onlyDeferredWrites()) {
+		writeRangeToNativeTransaction(KeyRangeRef(StringRef(), allKeys.end));
+		return;
+	}
+
+	for (const auto& write : writes.getDeferredWrites()) {
+		const MutationRef& m = write.mutation;
+		AddConflictRange addConflict{ write.addConflict };
+		switch (m.type) {
+		case MutationRef::SetValue:
+			tr.set(m.param1, m.param2, addConflict);
+			break;
+		case MutationRef::ClearRange:
+			tr.clear(KeyRangeRef(m.param1, m.param2), addConflict);
+			break;
+		default:
+			tr.atomicOp(m.param1, m.param2, (MutationRef::Type)m.type, addConflict);
+			break;
+		}
+	}
+}
+
 ReadYourWritesTransactionOptions::ReadYourWritesTransactionOptions(Transaction const& tr) {
 	reset(tr);
 }
@@ -51,6 +51,8 @@ json_spirit::mObject S3BlobStoreEndpoint::Stats::getJSON() {
 	o["requests_failed"] = requests_failed;
 	o["requests_successful"] = requests_successful;
 	o["bytes_sent"] = bytes_sent;
+	o["connections_new"] = connections_new;
+	o["connections_reused"] = connections_reused;
 
 	return o;
 }
@@ -60,6 +62,8 @@ S3BlobStoreEndpoint::Stats S3BlobStoreEndpoint::Stats::operator-(const Stats& rh
 	r.requests_failed = requests_failed - rhs.requests_failed;
 	r.requests_successful = requests_successful - rhs.requests_successful;
 	r.bytes_sent = bytes_sent - rhs.bytes_sent;
+	r.connections_new = connections_new - rhs.connections_new;
+	r.connections_reused = connections_reused - rhs.connections_reused;
 	return r;
 }
 
@@ -99,6 +103,8 @@ S3BlobStoreEndpoint::BlobKnobs::BlobKnobs() {
 	max_delay_connection_failed = CLIENT_KNOBS->BLOBSTORE_MAX_DELAY_CONNECTION_FAILED;
 	sdk_auth = false;
 	global_connection_pool = CLIENT_KNOBS->BLOBSTORE_GLOBAL_CONNECTION_POOL;
+	max_concurrent_uploads = CLIENT_KNOBS->BLOBSTORE_MAX_CONCURRENT_UPLOADS;
+	prewarm_connections = CLIENT_KNOBS->BLOBSTORE_PREWARM_CONNECTIONS;
 }
 
 bool S3BlobStoreEndpoint::BlobKnobs::set(StringRef name, int value) {
@@ -140,6 +146,8 @@ bool S3BlobStoreEndpoint::BlobKnobs::set(StringRef name, int value) {
 	TRY_PARAM(max_delay_connection_failed, dcf);
 	TRY_PARAM(sdk_auth, sa);
 	TRY_PARAM(global_connection_pool, gcp);
+	TRY_PARAM(max_concurrent_uploads, mcu);
+	TRY_PARAM(prewarm_connections, pwc);
 #undef TRY_PARAM
 	return false;
 }
@@ -181,6 +189,8 @@ std::string S3BlobStoreEndpoint::BlobKnobs::getURLParameters() const {
 	_CHECK_PARAM(global_connection_pool, gcp);
 	_CHECK_PARAM(max_delay_retryable_error, dre);
 	_CHECK_PARAM(max_delay_connection_failed, dcf);
+	_CHECK_PARAM(max_concurrent_uploads, mcu);
+	_CHECK_PARAM(prewarm_connections, pwc);
 #undef _CHECK_PARAM
 	return r;
 }
@@ -730,28 +740,7 @@ Future<Void> S3BlobStoreEndpoint::updateSecret() {
 	return updateSecret_impl(Reference<S3BlobStoreEndpoint>::addRef(this));
 }
 
-ACTOR Future<S3BlobStoreEndpoint::ReusableConnection> connect_impl(Reference<S3BlobStoreEndpoint> b,
-                                                                   bool* reusingConn) {
-	// First try to get a connection from the pool
-	*reusingConn = false;
-	while (!b->connectionPool->pool.empty()) {
-		S3BlobStoreEndpoint::ReusableConnection rconn = b->connectionPool->pool.front();
-		b->connectionPool->pool.pop();
-
-		// If the connection expires in the future then return it
-		if (rconn.expirationTime > now()) {
-			*reusingConn = true;
-			++b->blobStats->reusedConnections;
-			TraceEvent("S3BlobStoreEndpointReusingConnected")
-			    .suppressFor(60)
-			    .detail("RemoteEndpoint", rconn.conn->getPeerAddress())
-			    .detail("ExpiresIn", rconn.expirationTime - now())
-			    .detail("Proxy", b->proxyHost.orDefault(""));
-			return rconn;
-		}
-		++b->blobStats->expiredConnections;
-	}
-	++b->blobStats->newConnections;
+ACTOR Future<S3BlobStoreEndpoint::ReusableConnection> newConnection_impl(Reference<S3BlobStoreEndpoint> b) {
 	std::string host = b->host, service = b->service;
 	TraceEvent(SevDebug, "S3BlobStoreEndpointBuildingNewConnection")
 	    .detail("UseProxy", b->useProxy)
@@ -796,6 +785,58 @@ ACTOR Future<S3BlobStoreEndpoint::ReusableConnection> connect_impl(Reference<S3B
 	return S3BlobStoreEndpoint::ReusableConnection({ conn, now() + b->knobs.max_connection_life });
 }
 
+ACTOR Future<S3BlobStoreEndpoint::ReusableConnection> connect_impl(Reference<S3BlobStoreEndpoint> b,
+                                                                   bool* reusingConn) {
+	// First try to get a connection from the pool
+	*reusingConn = false;
+	while (!b->connectionPool->pool.empty()) {
+		S3BlobStoreEndpoint::ReusableConnection rconn = b->connectionPool->pool.front();
+		b->connectionPool->pool.pop();
+
+		// If the connection expires in the future then return it
+		if (rconn.expirationTime > now()) {
+			*reusingConn = true;
+			++b->blobStats->reusedConnections;
+			b->s_stats.connections_reused++;
+			TraceEvent("S3BlobStoreEndpointReusingConnected")
+			    .suppressFor(60)
+			    .detail("RemoteEndpoint", rconn.conn->getPeerAddress())
+			    .detail("ExpiresIn", rconn.expirationTime - now())
+			    .detail("Proxy", b->proxyHost.orDefault(""));
+			b->prewarmConnections();
+			return rconn;
+		}
+		++b->blobStats->expiredConnections;
+	}
+	++b->blobStats->newConnections;
+	b->s_stats.connections_new++;
+	b->prewarmConnections();
+	S3BlobStoreEndpoint::ReusableConnection rconn = wait(newConnection_impl(b));
+	return rconn;
+}
+
+// Opens a connection ahead of the request that will use it and adds it to the pool, so that the request doesn't wait
+// for the TCP and TLS handshakes
+ACTOR static void prewarmConnection(Reference<S3BlobStoreEndpoint> b) {
+	state Reference<S3BlobStoreEndpoint::ConnectionPoolData> pool = b->connectionPool;
+	++pool->warming;
+	try {
+		state S3BlobStoreEndpoint::ReusableConnection rconn =
+		    wait(timeoutError(newConnection_impl(b), b->knobs.connect_timeout));
+		++b->blobStats->prewarmedConnections;
+		b->returnConnection(rconn);
+	} catch (Error& e) {
+		TraceEvent(SevDebug, "S3BlobStoreEndpointPrewarmConnectionFailed").errorUnsuppressed(e);
+	}
+	--pool->warming;
+}
+
+void S3BlobStoreEndpoint::prewarmConnections() {
+	while ((int)connectionPool->pool.size() + connectionPool->warming < knobs.prewarm_connections) {
+		prewarmConnection(Reference<S3BlobStoreEndpoint>::addRef(this));
+	}
+}
+
 Future<S3BlobStoreEndpoint::ReusableConnection> S3BlobStoreEndpoint::connect(bool* reusing) {
 	return connect_impl(Reference<S3BlobStoreEndpoint>::addRef(this), reusing);
 }
@@ -810,6 +851,60 @@ void S3BlobStoreEndpoint::returnConnection(ReusableConnection& rconn) {
 	rconn.conn = Reference<IConnection>();
 }
 
+// Adjusts the number of uploads in progress at once between concurrent_uploads and max_concurrent_uploads by holding
+// the permits of concurrentUploads above the limit. Each interval, the limit is halved if uploads failed with errors
+// that suggest overload, or raised by one if uploads waited for a permit and throughput didn't drop by more than a
+// tenth since the last interval. The endpoint owns the returned future, so it can't outlive the endpoint.
+ACTOR Future<Void> adaptUploadConcurrency_impl(S3BlobStoreEndpoint* b) {
+	state int minUploads = b->knobs.concurrent_uploads;
+	state int maxUploads = b->knobs.max_concurrent_uploads;
+	state FlowLock::Releaser held;
+	state double lastThroughput = 0;
+	state double intervalStart;
+	state double throughput;
+	state int previous;
+	state int decrease;
+
+	wait(b->concurrentUploads.take(TaskPriority::DefaultYield, maxUploads - minUploads));
+	held = FlowLock::Releaser(b->concurrentUploads, maxUploads - minUploads);
+	b->uploadConcurrency = minUploads;
+	loop {
+		b->uploadBytes = 0;
+		b->uploadFailures = 0;
+		intervalStart = now();
+		wait(delay(CLIENT_KNOBS->BLOBSTORE_UPLOAD_CONCURRENCY_INTERVAL));
+
+		throughput = b->uploadBytes / (now() - intervalStart);
+		previous = b->uploadConcurrency;
+		if (b->uploadFailures > 0 && b->uploadConcurrency > minUploads) {
+			decrease = b->uploadConcurrency - std::max(minUploads, b->uploadConcurrency / 2);
+			b->uploadConcurrency -= decrease;
+			++b->blobStats->uploadConcurrencyDecreases;
+			wait(b->concurrentUploads.take(TaskPriority::DefaultYield, decrease));
+			held.remaining += decrease;
+		} else if (b->uploadFailures == 0 && b->concurrentUploads.waiters() > 0 &&
+		           b->uploadConcurrency < maxUploads && throughput >= lastThroughput * 0.9) {
+			++b->uploadConcurrency;
+			++b->blobStats->uploadConcurrencyIncreases;
+			held.release(1);
+		}
+		if (b->uploadConcurrency != previous) {
+			TraceEvent("S3BlobStoreUploadConcurrency")
+			    .suppressFor(60)
+			    .detail("Host", b->host)
+			    .detail("Concurrency", b->uploadConcurrency)
+			    .detail("Previous", previous)
+			    .detail("BytesPerSecond", throughput)
+			    .detail("Failures", b->uploadFailures);
+		}
+		lastThroughput = throughput;
+	}
+}
+
+Future<Void> S3BlobStoreEndpoint::adaptUploadConcurrency() {
+	return adaptUploadConcurrency_impl(this);
+}
+
 std::string awsCanonicalURI(const std::string& resource, std::vector<std::string>& queryParameters, bool isV4) {
 	StringRef resourceRef(resource);
 	resourceRef.eat("/");
@@ -1008,6 +1103,11 @@ ACTOR Future<Reference<HTTP::IncomingResponse>> doRequest_impl(Reference<S3BlobS
 		// All errors in err are potentially retryable as well as certain HTTP response codes...
 		bool retryable = err.present() || r->code == 500 || r->code == 502 || r->code == 503 || r->code == 429;
 
+		// Uploads failing this way are a sign of too many uploads at once for the blob store or the network
+		if (retryable && contentLen > 0) {
+			++bstore->uploadFailures;
+		}
+
 		// But only if our previous attempt was not the last allowable try.
 		retryable = retryable && (thisTry < maxTries);
 
@@ -1659,6 +1759,8 @@ ACTOR Future<Void> writeEntireFileFromBuffer_impl(Reference<S3BlobStoreEndpoint>
 	if (!HTTP::verifyMD5(&r->data, false, contentMD5))
 		throw checksum_failed();
 
+	bstore->uploadBytes += contentLen;
+	bstore->blobStats->bytesUploaded += contentLen;
 	return Void();
 }
 
@@ -1808,6 +1910,8 @@ ACTOR Future<std::string> uploadPart_impl(Reference<S3BlobStoreEndpoint> bstore,
 	if (etag.empty())
 		throw http_bad_response();
 
+	bstore->uploadBytes += contentLen;
+	bstore->blobStats->bytesUploaded += contentLen;
 	return etag;
 }
 
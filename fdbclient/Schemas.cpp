@@ -114,6 +114,8 @@ const KeyRef JSONSchemas::statusSchema = R"statusSchema(
                   "kvstore_total_size":12341234,
                   "kvstore_total_nodes":12341234,
                   "kvstore_inline_keys":12341234,
+                  "kvstore_lazy_clear_pending":12341234,
+                  "kvstore_lazy_clear_freed_bytes":12341234,
                   "durable_bytes":{
                      "hz":0.0,
                      "counter":0,
@@ -391,7 +393,25 @@ const KeyRef JSONSchemas::statusSchema = R"statusSchema(
                  "hz":0.0
                }
             },
-            "run_loop_busy":0.2
+            "run_loop_busy":0.2,
+            "run_loop_ready_wait":{
+               "$map":{
+                  "count":0,
+                  "median_seconds":0.0,
+                  "p99_seconds":0.0,
+                  "max_seconds":0.0
+               }
+            },
+            "rpc_latency":{
+               "$map":{
+                  "count":0,
+                  "queue_median_seconds":0.0,
+                  "queue_p99_seconds":0.0,
+                  "service_count":0,
+                  "service_median_seconds":0.0,
+                  "service_p99_seconds":0.0
+               }
+            }
          }
       },
       "logs":[
@@ -410,11 +430,13 @@ const KeyRef JSONSchemas::statusSchema = R"statusSchema(
             "possibly_losing_data":true,
             "log_replication_factor":3,
             "log_write_anti_quorum":0,
+            "log_write_quorum":3,
             "log_fault_tolerance":2,
             "remote_log_replication_factor":3,
             "remote_log_fault_tolerance":2,
             "satellite_log_replication_factor":3,
             "satellite_log_write_anti_quorum":0,
+            "satellite_log_write_quorum":3,
             "satellite_log_fault_tolerance":2
          }
       ],
@@ -442,7 +464,8 @@ const KeyRef JSONSchemas::statusSchema = R"statusSchema(
                   "storage_server_durability_lag",
                   "storage_server_list_fetch_failed",
                   "blob_worker_lag",
-                  "blob_worker_missing"
+                  "blob_worker_missing",
+                  "storage_server_read_queue"
                ]
             },
             "description":"The database is not being saturated by the workload."
@@ -465,7 +488,8 @@ const KeyRef JSONSchemas::statusSchema = R"statusSchema(
                   "storage_server_durability_lag",
                   "storage_server_list_fetch_failed",
                   "blob_worker_lag",
-                  "blob_worker_missing"
+                  "blob_worker_missing",
+                  "storage_server_read_queue"
                ]
             },
             "description":"The database is not being saturated by the workload."
@@ -987,7 +1011,8 @@ const KeyRef JSONSchemas::statusSchema = R"statusSchema(
             "total_written_bytes":0,
             "in_flight_bytes":0,
             "in_queue_bytes":0,
-            "highest_priority":0
+            "highest_priority":0,
+            "projected_completion_seconds":0
          },
          "team_trackers":[
             {
@@ -1285,11 +1310,13 @@ const KeyRef JSONSchemas::faultToleranceStatusSchema = R"statusSchema(
             "possibly_losing_data":true,
             "log_replication_factor":3,
             "log_write_anti_quorum":0,
+            "log_write_quorum":3,
             "log_fault_tolerance":2,
             "remote_log_replication_factor":3,
             "remote_log_fault_tolerance":2,
             "satellite_log_replication_factor":3,
             "satellite_log_write_anti_quorum":0,
+            "satellite_log_write_quorum":3,
             "satellite_log_fault_tolerance":2
          }
       ],
@@ -1317,7 +1344,8 @@ const KeyRef JSONSchemas::faultToleranceStatusSchema = R"statusSchema(
                   "storage_server_durability_lag",
                   "storage_server_list_fetch_failed",
                   "blob_worker_lag",
-                  "blob_worker_missing"
+                  "blob_worker_missing",
+                  "storage_server_read_queue"
                ]
             },
             "description":"The database is not being saturated by the workload."
@@ -1340,7 +1368,8 @@ const KeyRef JSONSchemas::faultToleranceStatusSchema = R"statusSchema(
                   "storage_server_durability_lag",
                   "storage_server_list_fetch_failed",
                   "blob_worker_lag",
-                  "blob_worker_missing"
+                  "blob_worker_missing",
+                  "storage_server_read_queue"
                ]
             },
             "description":"The database is not being saturated by the workload."
@@ -1504,7 +1533,8 @@ file is writable and has not been overwritten externally."
             "total_written_bytes":0,
             "in_flight_bytes":0,
             "in_queue_bytes":0,
-            "highest_priority":0
+            "highest_priority":0,
+            "projected_completion_seconds":0
          },
          "team_trackers":[
             {
@@ -85,9 +85,23 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( TLOG_SPILL_REFERENCE_MAX_PEEK_MEMORY_BYTES,            2e9 ); if ( randomize && BUGGIFY ) TLOG_SPILL_REFERENCE_MAX_PEEK_MEMORY_BYTES = 2e6;
 	init( TLOG_SPILL_REFERENCE_MAX_BATCHES_PER_PEEK,           100 ); if ( randomize && BUGGIFY ) TLOG_SPILL_REFERENCE_MAX_BATCHES_PER_PEEK = 1;
 	init( TLOG_SPILL_REFERENCE_MAX_BYTES_PER_BATCH,           16<<10 ); if ( randomize && BUGGIFY ) TLOG_SPILL_REFERENCE_MAX_BYTES_PER_BATCH = 500;
+	init( TLOG_SPILL_REFERENCE_MESSAGE_INDEX,                  true ); if ( randomize && BUGGIFY ) TLOG_SPILL_REFERENCE_MESSAGE_INDEX = false;
+	init( TLOG_SPILL_VALUE_COMPRESSION_FILTER,                "NONE" ); if ( randomize && BUGGIFY ) TLOG_SPILL_VALUE_COMPRESSION_FILTER = CompressionUtils::toString(CompressionUtils::getRandomFilter());
+	init( TLOG_SPILL_VALUE_COMPRESSION_MIN_BYTES,              512 ); if ( randomize && BUGGIFY ) TLOG_SPILL_VALUE_COMPRESSION_MIN_BYTES = 0;
+	init( TLOG_GROUP_COMMIT_GENERATIONS,                       true ); if ( randomize && BUGGIFY ) TLOG_GROUP_COMMIT_GENERATIONS = false;
+	init( PEEK_STREAM_ADAPTIVE_FLOW_CONTROL,                   true ); if ( randomize && BUGGIFY ) PEEK_STREAM_ADAPTIVE_FLOW_CONTROL = false;
+	init( PEEK_STREAM_WINDOW_SECONDS,                           1.0 ); if ( randomize && BUGGIFY ) PEEK_STREAM_WINDOW_SECONDS = deterministicRandom()->random01();
+	init( PEEK_STREAM_DRAIN_RATE_SMOOTHING,                     1.0 );
+	init( PEEK_STREAM_MIN_WINDOW_BYTES,         DESIRED_TOTAL_BYTES );
+	init( PEEK_STREAM_MIN_REPLY_BYTES,                        10000 ); if ( randomize && BUGGIFY ) PEEK_STREAM_MIN_REPLY_BYTES = 1000;
+	init( PEEK_STREAM_MEMORY_PRESSURE_THRESHOLD,                0.5 ); if ( randomize && BUGGIFY ) PEEK_STREAM_MEMORY_PRESSURE_THRESHOLD = 0.0;
 	init( DISK_QUEUE_FILE_EXTENSION_BYTES,                    10<<20 ); // BUGGIFYd per file within the DiskQueue
 	init( DISK_QUEUE_FILE_SHRINK_BYTES,                      100<<20 ); // BUGGIFYd per file within the DiskQueue
 	init( DISK_QUEUE_MAX_TRUNCATE_BYTES,                     2LL<<30 ); if ( randomize && BUGGIFY ) DISK_QUEUE_MAX_TRUNCATE_BYTES = 0;
+	init( DISK_QUEUE_PAGE_BUFFER_POOL_SIZE,                       2 ); if ( randomize && BUGGIFY ) DISK_QUEUE_PAGE_BUFFER_POOL_SIZE = deterministicRandom()->randomInt(0, 3);
+	init( DISK_QUEUE_PAGE_BUFFER_MAX_POOLED_BYTES,            32<<20 ); if ( randomize && BUGGIFY ) DISK_QUEUE_PAGE_BUFFER_MAX_POOLED_BYTES = 64<<10;
+	init( DISK_QUEUE_RECOVERY_READ_AHEAD,                      true ); if ( randomize && BUGGIFY ) DISK_QUEUE_RECOVERY_READ_AHEAD = false;
+	init( DISK_QUEUE_RECOVERY_READ_BYTES,                      4<<20 ); if ( randomize && BUGGIFY ) DISK_QUEUE_RECOVERY_READ_BYTES = 1<<20;
 	init( TLOG_DEGRADED_DURATION,                                5.0 );
 	init( MAX_CACHE_VERSIONS,                                   10e6 );
 	init( TLOG_IGNORE_POP_AUTO_ENABLE_DELAY,                   300.0 );
@@ -144,6 +158,11 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( RELOCATION_PARALLELISM_PER_SOURCE_SERVER,                2 ); if( randomize && BUGGIFY ) RELOCATION_PARALLELISM_PER_SOURCE_SERVER = 1;
 	init( RELOCATION_PARALLELISM_PER_DEST_SERVER,                 10 ); if( randomize && BUGGIFY ) RELOCATION_PARALLELISM_PER_DEST_SERVER = 1; // Note: if this is smaller than FETCH_KEYS_PARALLELISM, this will artificially reduce performance. The current default of 10 is probably too high but is set conservatively for now.
 	init( MERGE_RELOCATION_PARALLELISM_PER_TEAM,                   6 ); if (randomize && BUGGIFY ) MERGE_RELOCATION_PARALLELISM_PER_TEAM = 1;
+	init( DD_ADAPTIVE_RELOCATION_PARALLELISM,                  false ); if( randomize && BUGGIFY ) DD_ADAPTIVE_RELOCATION_PARALLELISM = true;
+	init( DD_ADAPTIVE_RELOCATION_INTERVAL,                      10.0 ); if( randomize && BUGGIFY ) DD_ADAPTIVE_RELOCATION_INTERVAL = 1.0;
+	init( DD_ADAPTIVE_RELOCATION_MAX_MULTIPLIER,                 4.0 );
+	init( DD_ADAPTIVE_RELOCATION_TARGET_RATE,                    5e6 ); if( randomize && BUGGIFY ) DD_ADAPTIVE_RELOCATION_TARGET_RATE = 1e4;
+	init( DD_ADAPTIVE_RELOCATION_MAX_STORAGE_QUEUE,            250e6 );
 	init( DD_QUEUE_MAX_KEY_SERVERS,                              100 ); // Do not buggify
 	init( DD_REBALANCE_PARALLELISM,                               50 );
 	init( DD_REBALANCE_RESET_AMOUNT,                              30 );
@@ -158,6 +177,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( PRIORITY_REBALANCE_OVERUTILIZED_TEAM,                  122 );
 	init( PRIORITY_REBALANCE_READ_OVERUTIL_TEAM,                 123 );
 	init( PRIORITY_REBALANCE_STORAGE_QUEUE,                      124 );
+	init( PRIORITY_BULK_LOAD,                                    130 );
 	init( PRIORITY_TEAM_HEALTHY,                                 140 );
 	init( PRIORITY_PERPETUAL_STORAGE_WIGGLE,                     141 );
 	init( PRIORITY_TEAM_CONTAINS_UNDESIRED_SERVER,               150 );
@@ -193,6 +213,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( ENABLE_DD_PHYSICAL_SHARD,                            false ); // EXPERIMENTAL; If true, SHARD_ENCODE_LOCATION_METADATA must be true; When true, optimization of data move between DCs is disabled
 	init( DD_PHYSICAL_SHARD_MOVE_PROBABILITY,                    0.0 ); if( isSimulated )  DD_PHYSICAL_SHARD_MOVE_PROBABILITY = 0.5;
 	init( ENABLE_PHYSICAL_SHARD_MOVE_EXPERIMENT,               false ); if( isSimulated )  ENABLE_PHYSICAL_SHARD_MOVE_EXPERIMENT = deterministicRandom()->coinflip();
+	init( DD_PHYSICAL_SHARD_MOVE_FOR_SHARDED_ROCKSDB,           true ); if( randomize && BUGGIFY ) DD_PHYSICAL_SHARD_MOVE_FOR_SHARDED_ROCKSDB = false;
 	init( MAX_PHYSICAL_SHARD_BYTES,                         10000000 ); // 10 MB; for ENABLE_DD_PHYSICAL_SHARD; smaller leads to larger number of physicalShard per storage server
  	init( PHYSICAL_SHARD_METRICS_DELAY,                        300.0 ); // 300 seconds; for ENABLE_DD_PHYSICAL_SHARD
 	init( ANONYMOUS_PHYSICAL_SHARD_TRANSITION_TIME,            600.0 ); if( randomize && BUGGIFY )  ANONYMOUS_PHYSICAL_SHARD_TRANSITION_TIME = 0.0; // 600 seconds; for ENABLE_DD_PHYSICAL_SHARD
@@ -275,6 +296,8 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 		*/
 
 	init( ENABLE_WRITE_BASED_SHARD_SPLIT,                      false ); if( randomize && BUGGIFY ) ENABLE_WRITE_BASED_SHARD_SPLIT = true;
+	init( DD_SPLIT_READ_HOT_SHARDS,                            false ); if( randomize && BUGGIFY ) DD_SPLIT_READ_HOT_SHARDS = true;
+	init( DD_READ_HOT_SPLIT_COOLDOWN,        isSimulated ? 60.0 : 600.0 ); if( randomize && BUGGIFY ) DD_READ_HOT_SPLIT_COOLDOWN = 5.0;
 	init( STORAGE_METRIC_TIMEOUT,         isSimulated ? 60.0 : 600.0 ); if( randomize && BUGGIFY ) STORAGE_METRIC_TIMEOUT = deterministicRandom()->coinflip() ? 10.0 : 30.0;
 	init( METRIC_DELAY,                                          0.1 ); if( randomize && BUGGIFY ) METRIC_DELAY = 1.0;
 	init( ALL_DATA_REMOVED_DELAY,                                1.0 );
@@ -301,6 +324,9 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( TSS_DD_CHECK_INTERVAL,                                60.0 ); if (randomize && BUGGIFY ) TSS_DD_CHECK_INTERVAL = 1.0;    // May kill all TSS quickly
 	init( DATA_DISTRIBUTION_LOGGING_INTERVAL,                    5.0 );
 	init( DD_ENABLED_CHECK_DELAY,                                1.0 );
+	init( DD_PARALLEL_INITIAL_LOAD,                            false ); if( randomize && BUGGIFY ) DD_PARALLEL_INITIAL_LOAD = true;
+	init( DD_INITIAL_LOAD_CHUNK_BYTES,                           10e6 ); if( randomize && BUGGIFY ) DD_INITIAL_LOAD_CHUNK_BYTES = deterministicRandom()->randomInt(100, 10000);
+	init( DD_INITIAL_LOAD_PARALLELISM,                             16 ); if( randomize && BUGGIFY ) DD_INITIAL_LOAD_PARALLELISM = 1;
 	init( DD_STALL_CHECK_DELAY,                                  0.4 ); //Must be larger than 2*MAX_BUGGIFIED_DELAY
 	init( DD_LOW_BANDWIDTH_DELAY,         isSimulated ? 15.0 : 240.0 ); if( randomize && BUGGIFY ) DD_LOW_BANDWIDTH_DELAY = 0; //Because of delayJitter, this should be less than 0.9 * DD_MERGE_COALESCE_DELAY
 	init( DD_MERGE_COALESCE_DELAY,       isSimulated ?  30.0 : 300.0 ); if( randomize && BUGGIFY ) DD_MERGE_COALESCE_DELAY = 0.001;
@@ -315,6 +341,9 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( DD_FETCH_SOURCE_PARALLELISM,                          1000 ); if( randomize && BUGGIFY ) DD_FETCH_SOURCE_PARALLELISM = 1;
 	init( DD_MERGE_LIMIT,                                       2000 ); if( randomize && BUGGIFY ) DD_MERGE_LIMIT = 2;
 	init( DD_SHARD_METRICS_TIMEOUT,                             60.0 ); if( randomize && BUGGIFY ) DD_SHARD_METRICS_TIMEOUT = 0.1;
+	init( DD_HEATMAP_INTERVAL,                                  60.0 ); if( randomize && BUGGIFY ) DD_HEATMAP_INTERVAL = 1.0;
+	init( DD_HEATMAP_SLICES,                                      30 ); if( randomize && BUGGIFY ) DD_HEATMAP_SLICES = 2;
+	init( DD_HEATMAP_BUCKETS,                                    100 ); if( randomize && BUGGIFY ) DD_HEATMAP_BUCKETS = 1;
 	init( DD_LOCATION_CACHE_SIZE,                            2000000 ); if( randomize && BUGGIFY ) DD_LOCATION_CACHE_SIZE = 3;
 	init( MOVEKEYS_LOCK_POLLING_DELAY,                           5.0 );
 	init( DEBOUNCE_RECRUITING_DELAY,                             5.0 );
@@ -359,6 +388,10 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( DD_REBALANCE_STORAGE_QUEUE_TIME_INTERVAL,             30.0 ); if( isSimulated ) DD_REBALANCE_STORAGE_QUEUE_TIME_INTERVAL = 5.0;
 	init( REBALANCE_STORAGE_QUEUE_SHARD_PER_KSEC_MIN, SHARD_MIN_BYTES_PER_KSEC);
 	init( DD_ENABLE_REBALANCE_STORAGE_QUEUE_WITH_LIGHT_WRITE_SHARD, true ); if ( isSimulated ) DD_ENABLE_REBALANCE_STORAGE_QUEUE_WITH_LIGHT_WRITE_SHARD = deterministicRandom()->coinflip();
+	init( DD_BULK_LOAD_POLL_INTERVAL,                            5.0 ); if( isSimulated ) DD_BULK_LOAD_POLL_INTERVAL = 1.0;
+	init( DD_BULK_LOAD_PIECE_BYTES,                            500e6 ); if( randomize && BUGGIFY ) DD_BULK_LOAD_PIECE_BYTES = 1e6;
+	init( DD_BULK_LOAD_RELOCATE_DELAY,                         300.0 ); if( isSimulated ) DD_BULK_LOAD_RELOCATE_DELAY = 30.0;
+	init( DD_BULK_LOAD_MERGE_COOLDOWN,                          60.0 );
 
 	// Large teams are disabled when SHARD_ENCODE_LOCATION_METADATA is enabled
 	init( DD_MAX_SHARDS_ON_LARGE_TEAMS,                          100 ); if( randomize && BUGGIFY ) DD_MAX_SHARDS_ON_LARGE_TEAMS = deterministicRandom()->randomInt(0, 3);
@@ -395,6 +428,8 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( SQLITE_WRITE_WINDOW_SECONDS,                            -1 );
 	init( SQLITE_CURSOR_MAX_LIFETIME_BYTES,                      1e6 ); if (buggifySmallShards || simulationMediumShards) SQLITE_CURSOR_MAX_LIFETIME_BYTES = MIN_SHARD_BYTES; if( randomize && BUGGIFY ) SQLITE_CURSOR_MAX_LIFETIME_BYTES = 0;
 	init( SQLITE_WRITE_WINDOW_LIMIT,                              -1 );
+	init( SQLITE_READ_AHEAD_PAGES,                                16 ); if( randomize && BUGGIFY ) SQLITE_READ_AHEAD_PAGES = deterministicRandom()->randomInt(0, 33); // 0 disables read ahead
+	init( SQLITE_READ_AHEAD_FORWARD_READS,                         2 ); if( randomize && BUGGIFY ) SQLITE_READ_AHEAD_FORWARD_READS = deterministicRandom()->randomInt(1, 4);
 	if( randomize && BUGGIFY ) {
 		// Choose an window between .01 and 1.01 seconds.
 		SQLITE_WRITE_WINDOW_SECONDS = 0.01 + deterministicRandom()->random01();
@@ -452,6 +487,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( ROCKSDB_COMPACTION_THREAD_PRIORITY,                      0 );
 	init( ROCKSDB_BACKGROUND_PARALLELISM,                          3 );
 	init( ROCKSDB_READ_PARALLELISM,                isSimulated? 2: 4 );
+	init( ROCKSDB_WORK_STEALING_READ_THREADS,                  false );
 	init( ROCKSDB_CHECKPOINT_READER_PARALLELISM,                   4 );
 	// If true, do not process and store RocksDB logs
 	init( ROCKSDB_MUTE_LOGS,                                    true );
@@ -471,6 +507,8 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( ROCKSDB_BLOCK_CACHE_SIZE,                   blockCacheSize ); /* Datablocks cache + Index&filter blocks cache */
 	init( ROCKSDB_CACHE_HIGH_PRI_POOL_RATIO,                     0.5 ); /* Share of high priority Index&filter blocks in cache */
 	init( ROCKSDB_CACHE_INDEX_AND_FILTER_BLOCKS,                true );
+	init( ROCKSDB_BLOCK_CACHE_HYPER_CLOCK,                     false ); if( randomize && BUGGIFY ) ROCKSDB_BLOCK_CACHE_HYPER_CLOCK = true;
+	init( ROCKSDB_COMPRESSED_SECONDARY_CACHE_SIZE,                 0 ); if( randomize && BUGGIFY ) ROCKSDB_COMPRESSED_SECONDARY_CACHE_SIZE = 1 << 20;
 	init( ROCKSDB_METRICS_DELAY,                                60.0 );
 	// ROCKSDB_READ_VALUE_TIMEOUT, ROCKSDB_READ_VALUE_PREFIX_TIMEOUT, ROCKSDB_READ_RANGE_TIMEOUT knobs:
 	// In simulation, increasing the read operation timeouts to 5 minutes, as some of the tests have
@@ -481,6 +519,8 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( ROCKSDB_READ_CHECKPOINT_TIMEOUT, isSimulated ? 300.0 : 5.0 );
 	init( ROCKSDB_CHECKPOINT_READ_AHEAD_SIZE,                2 << 20 ); // 2M
 	init( ROCKSDB_READ_QUEUE_WAIT,                               1.0 );
+	init( ROCKSDB_READ_VALUE_COALESCE,                          true ); if( randomize && BUGGIFY ) ROCKSDB_READ_VALUE_COALESCE = false;
+	init( ROCKSDB_READ_VALUE_COALESCE_MAX_KEYS,                   64 ); if( randomize && BUGGIFY ) ROCKSDB_READ_VALUE_COALESCE_MAX_KEYS = deterministicRandom()->randomInt(1, 8);
 	init( ROCKSDB_READ_QUEUE_HARD_MAX,                          1000 );
 	init( ROCKSDB_READ_QUEUE_SOFT_MAX,                           500 );
 	init( ROCKSDB_FETCH_QUEUE_HARD_MAX,                          100 );
@@ -491,6 +531,14 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( SHARDED_ROCKSDB_REUSE_ITERATORS,                     false );
 	init( ROCKSDB_READ_RANGE_REUSE_BOUNDED_ITERATORS,          false ); if( randomize && BUGGIFY ) ROCKSDB_READ_RANGE_REUSE_BOUNDED_ITERATORS = deterministicRandom()->coinflip();
 	init( ROCKSDB_READ_RANGE_BOUNDED_ITERATORS_MAX_LIMIT,        200 );
+	init( ROCKSDB_READ_RANGE_ASYNC_IO,                         false ); if( randomize && BUGGIFY ) ROCKSDB_READ_RANGE_ASYNC_IO = deterministicRandom()->coinflip();
+	init( ROCKSDB_READ_RANGE_READAHEAD_MIN_BYTES,             131072 ); if( randomize && BUGGIFY ) ROCKSDB_READ_RANGE_READAHEAD_MIN_BYTES = deterministicRandom()->coinflip() ? 0 : 1024;
+	init( ROCKSDB_READ_RANGE_READAHEAD_MAX_SIZE,             2097152 ); if( randomize && BUGGIFY ) ROCKSDB_READ_RANGE_READAHEAD_MAX_SIZE = deterministicRandom()->randomInt(8192, 65536);
+	init( ROCKSDB_READ_RANGE_READAHEAD_HISTORY,                   16 ); if( randomize && BUGGIFY ) ROCKSDB_READ_RANGE_READAHEAD_HISTORY = deterministicRandom()->randomInt(1, 4);
+	init( ROCKSDB_FETCH_INGEST_SST,                            false ); if( randomize && BUGGIFY ) ROCKSDB_FETCH_INGEST_SST = deterministicRandom()->coinflip();
+	init( ROCKSDB_FETCH_INGEST_SST_MIN_BYTES,                 262144 ); if( randomize && BUGGIFY ) ROCKSDB_FETCH_INGEST_SST_MIN_BYTES = deterministicRandom()->randomInt(1, 10000);
+	// Only applies to stores created with it set, an existing store can't be opened with a different value.
+	init( ROCKSDB_USER_DEFINED_TIMESTAMPS,                     false );
 	// Set to 0 to disable rocksdb write rate limiting. Rate limiter unit: bytes per second.
 	init( ROCKSDB_WRITE_RATE_LIMITER_BYTES_PER_SEC,        200000000 );
 	init( ROCKSDB_WRITE_RATE_LIMITER_FAIRNESS,                    10 ); // RocksDB default 10
@@ -595,6 +643,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( SHARDED_ROCKSDB_TARGET_FILE_SIZE_BASE,            16 << 20 ); // 16MB
 	init( SHARDED_ROCKSDB_TARGET_FILE_SIZE_MULTIPLIER,             1 ); // RocksDB default.
 	init( SHARDED_ROCKSDB_SUGGEST_COMPACT_CLEAR_RANGE,          true );
+	init( SHARDED_ROCKSDB_DELETE_REMOVED_RANGE_FILES,           true ); if( randomize && BUGGIFY ) SHARDED_ROCKSDB_DELETE_REMOVED_RANGE_FILES = false;
 	init( SHARDED_ROCKSDB_MAX_BACKGROUND_JOBS,                     4 );
 	init( SHARDED_ROCKSDB_BLOCK_CACHE_SIZE, isSimulated? 16 * 1024 : 134217728 /* 128MB */);
 	// Set to 0 to disable rocksdb write rate limiting. Rate limiter unit: bytes per second.
@@ -609,6 +658,18 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( SHARDED_ROCKSDB_MAX_OPEN_FILES,                      50000 ); // Should be smaller than OS's fd limit.
 	init (SHARDED_ROCKSDB_READ_ASYNC_IO,                       false ); if (isSimulated) SHARDED_ROCKSDB_READ_ASYNC_IO = deterministicRandom()->coinflip();
 	init( SHARDED_ROCKSDB_PREFIX_LEN,                              0 ); if( randomize && BUGGIFY )  SHARDED_ROCKSDB_PREFIX_LEN = deterministicRandom()->randomInt(1, 20);
+	init( SHARDED_ROCKSDB_ADAPTIVE_FILTERS,                    false ); if( randomize && BUGGIFY ) SHARDED_ROCKSDB_ADAPTIVE_FILTERS = true;
+	init( SHARDED_ROCKSDB_FILTER_TUNE_INTERVAL,                 60.0 ); if( randomize && BUGGIFY ) SHARDED_ROCKSDB_FILTER_TUNE_INTERVAL = 1.0;
+	init( SHARDED_ROCKSDB_FILTER_TUNE_MIN_READS,                1000 ); if( randomize && BUGGIFY ) SHARDED_ROCKSDB_FILTER_TUNE_MIN_READS = 10;
+	init( SHARDED_ROCKSDB_POINT_READ_SHARD_RATIO,                0.9 );
+	init( SHARDED_ROCKSDB_SCAN_SHARD_RATIO,                      0.1 );
+	init( SHARDED_ROCKSDB_POINT_READ_FILTER_BITS,               14.0 );
+	init( SHARDED_ROCKSDB_SCAN_BLOCK_SIZE,                   64 << 10 ); // 64KB
+	init( SHARDED_ROCKSDB_COMPACTION_SCHEDULER,                false ); if( randomize && BUGGIFY ) SHARDED_ROCKSDB_COMPACTION_SCHEDULER = true;
+	init( SHARDED_ROCKSDB_COMPACTION_SCHEDULER_INTERVAL,        10.0 ); if( randomize && BUGGIFY ) SHARDED_ROCKSDB_COMPACTION_SCHEDULER_INTERVAL = 1.0;
+	init( SHARDED_ROCKSDB_COMPACTION_DEFER_DEBT,            64 << 20 ); if( randomize && BUGGIFY ) SHARDED_ROCKSDB_COMPACTION_DEFER_DEBT = 1 << 10; // 64MB
+	init( SHARDED_ROCKSDB_COMPACTION_MAX_DEFERRED_DEBT,     4LL << 30 ); if( randomize && BUGGIFY ) SHARDED_ROCKSDB_COMPACTION_MAX_DEFERRED_DEBT = 1 << 20; // 4GB
+	init( SHARDED_ROCKSDB_COMPACTION_MAX_DEFER_TIME,           600.0 ); if( randomize && BUGGIFY ) SHARDED_ROCKSDB_COMPACTION_MAX_DEFER_TIME = 5.0;
 
 
 	// Leader election
@@ -646,6 +707,10 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( COMMIT_TRANSACTION_BATCH_INTERVAL_MAX,                0.020 );
 	init( COMMIT_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION,     0.1 );
 	init( COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA,       0.1 );
+	init( COMMIT_BATCH_TARGET_P99_LATENCY,                        0.0 ); if( randomize && BUGGIFY ) COMMIT_BATCH_TARGET_P99_LATENCY = deterministicRandom()->random01() < 0.5 ? 0.05 : 0.5; // 0 falls back to the COMMIT_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION smoother
+	init( COMMIT_BATCH_CONTROLLER_WINDOW,                         1.0 ); if( randomize && BUGGIFY ) COMMIT_BATCH_CONTROLLER_WINDOW = 0.1;
+	init( COMMIT_BATCH_INTERVAL_STEP,                            1.25 );
+	init( COMMIT_BATCH_DOWNSTREAM_BOTTLENECK_FRACTION,            0.5 );
 	init( COMMIT_TRANSACTION_BATCH_COUNT_MAX,                   32768 ); if( randomize && BUGGIFY ) COMMIT_TRANSACTION_BATCH_COUNT_MAX = 1000; // Do NOT increase this number beyond 32768, as CommitIds only budget 2 bytes for storing transaction id within each batch
 	init( COMMIT_BATCHES_MEM_BYTES_HARD_LIMIT,              8LL << 30 ); if (randomize && BUGGIFY) COMMIT_BATCHES_MEM_BYTES_HARD_LIMIT = deterministicRandom()->randomInt64(100LL << 20,  8LL << 30);
 	init( COMMIT_BATCHES_MEM_FRACTION_OF_TOTAL,                   0.5 );
@@ -669,6 +734,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( ENFORCED_MIN_RECOVERY_DURATION,                       0.085 ); if( shortRecoveryDuration ) ENFORCED_MIN_RECOVERY_DURATION = 0.01;
 	init( REQUIRED_MIN_RECOVERY_DURATION,                       0.080 ); if( shortRecoveryDuration ) REQUIRED_MIN_RECOVERY_DURATION = 0.01;
 	init( ALWAYS_CAUSAL_READ_RISKY,                             false );
+	init( GRV_CACHED_VERSION_LEASE,                               0.0 ); // Not buggified, workloads may expect causal read risky reads to see their own commits
 	init( MAX_COMMIT_UPDATES,                                    2000 ); if( randomize && BUGGIFY ) MAX_COMMIT_UPDATES = 1;
 	init( MAX_PROXY_COMPUTE,                                      2.0 );
 	init( MAX_COMPUTE_PER_OPERATION,                              0.1 );
@@ -676,11 +742,18 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( PROXY_COMPUTE_BUCKETS,                                20000 );
 	init( PROXY_COMPUTE_GROWTH_RATE,                             0.01 );
 	init( TXN_STATE_SEND_AMOUNT,                                    4 );
+	init( TXN_STATE_SNAPSHOT_ENCODING,                           true ); if( randomize && BUGGIFY ) TXN_STATE_SNAPSHOT_ENCODING = false;
+	init( TXN_STATE_SNAPSHOT_COMPRESSION_FILTER,               "ZSTD" ); if( randomize && BUGGIFY ) TXN_STATE_SNAPSHOT_COMPRESSION_FILTER = CompressionUtils::toString(CompressionUtils::getRandomFilter());
 	init( REPORT_TRANSACTION_COST_ESTIMATION_DELAY,               0.1 );
 	init( PROXY_REJECT_BATCH_QUEUED_TOO_LONG,                    true );
 
 	bool buggfyUseResolverPrivateMutations = randomize && BUGGIFY && !ENABLE_VERSION_VECTOR_TLOG_UNICAST;
 	init( PROXY_USE_RESOLVER_PRIVATE_MUTATIONS,                 false ); if( buggfyUseResolverPrivateMutations ) PROXY_USE_RESOLVER_PRIVATE_MUTATIONS = deterministicRandom()->coinflip();
+	init( PROXY_ENCRYPTION_THREADS,                                 0 ); if( randomize && BUGGIFY ) PROXY_ENCRYPTION_THREADS = deterministicRandom()->randomInt(1, 4);
+	init( PROXY_ENCRYPTION_THREAD_MIN_MUTATIONS,                   64 ); if( randomize && BUGGIFY ) PROXY_ENCRYPTION_THREAD_MIN_MUTATIONS = deterministicRandom()->randomInt(0, 10);
+	init( PROXY_SORTED_KEY_TAG_LOOKUP,                           true ); if( randomize && BUGGIFY ) PROXY_SORTED_KEY_TAG_LOOKUP = false;
+	init( PROXY_KEY_TAG_CACHE_SIZE,                                 8 ); if( randomize && BUGGIFY ) PROXY_KEY_TAG_CACHE_SIZE = deterministicRandom()->randomInt(0, 3);
+	init( PROXY_FLAT_KEY_INFO_SEARCHES_PER_SHARD,                 0.1 ); if( randomize && BUGGIFY ) PROXY_FLAT_KEY_INFO_SEARCHES_PER_SHARD = deterministicRandom()->coinflip() ? 0 : -1;
 
 	init( BURSTINESS_METRICS_ENABLED  ,                         false );
 	init( BURSTINESS_METRICS_LOG_INTERVAL,                        0.1 );
@@ -706,6 +779,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( MAX_TXS_SEND_MEMORY,                                   1e7 ); if( randomize && BUGGIFY ) MAX_TXS_SEND_MEMORY = 1e5;
 	init( MAX_RECOVERY_VERSIONS,           200 * VERSIONS_PER_SECOND );
 	init( MAX_RECOVERY_TIME,                                    20.0 ); if( randomize && BUGGIFY ) MAX_RECOVERY_TIME = 1.0;
+	init( RECOVERY_EARLY_RECRUITMENT,                           true ); if( randomize && BUGGIFY ) RECOVERY_EARLY_RECRUITMENT = false;
 	init( PROVISIONAL_START_DELAY,                               1.0 );
 	init( PROVISIONAL_MAX_DELAY,                                60.0 );
 	init( PROVISIONAL_DELAY_GROWTH,                              1.5 );
@@ -717,6 +791,9 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( SAMPLE_EXPIRATION_TIME,                                1.0 );
 	init( SAMPLE_POLL_TIME,                                      0.1 );
 	init( RESOLVER_STATE_MEMORY_LIMIT,                           1e6 );
+	init( RESOLVER_CONFLICT_CHECK_THREADS,                         0 ); if( randomize && BUGGIFY ) RESOLVER_CONFLICT_CHECK_THREADS = deterministicRandom()->randomInt(2, 5);
+	init( RESOLVER_PARALLEL_CHECK_MIN_RANGES,                   2000 ); if( randomize && BUGGIFY ) RESOLVER_PARALLEL_CHECK_MIN_RANGES = deterministicRandom()->randomInt(1, 100);
+	init( RESOLVER_USE_ART_CONFLICT_SET,                       false ); if( randomize && BUGGIFY ) RESOLVER_USE_ART_CONFLICT_SET = deterministicRandom()->coinflip();
 	init( LAST_LIMITED_RATIO,                                    2.0 );
 
 	// Backup Worker
@@ -725,6 +802,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( BACKUP_FILE_BLOCK_BYTES,                       1024 * 1024 );
 	init( BACKUP_LOCK_BYTES,                                     3e9 ); if(randomize && BUGGIFY) BACKUP_LOCK_BYTES = deterministicRandom()->randomInt(1024, 4096) * 4096;
 	init( BACKUP_UPLOAD_DELAY,                                  10.0 ); if(randomize && BUGGIFY) BACKUP_UPLOAD_DELAY = deterministicRandom()->random01() * 60;
+	init( BACKUP_MAX_INFLIGHT_UPLOADS,                             3 ); if(randomize && BUGGIFY) BACKUP_MAX_INFLIGHT_UPLOADS = deterministicRandom()->randomInt(1, 6);
 
 	//Cluster Controller
 	init( CLUSTER_CONTROLLER_LOGGING_DELAY,                      5.0 );
@@ -778,6 +856,8 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( CC_SATELLITE_DEGRADATION_MIN_BAD_SERVER,                 3 );
 	init( CC_ENABLE_REMOTE_LOG_ROUTER_MONITORING,               true );
 	init( CC_THROTTLE_SINGLETON_RERECRUIT_INTERVAL,              0.5 );
+	init( CC_STANDBY_RECRUITMENT,                              false ); if( randomize && BUGGIFY ) CC_STANDBY_RECRUITMENT = true;
+	init( CC_STANDBY_RECRUITMENT_INTERVAL,                       5.0 ); if( randomize && BUGGIFY ) CC_STANDBY_RECRUITMENT_INTERVAL = 0.5;
 
 	init( INCOMPATIBLE_PEERS_LOGGING_INTERVAL,                   600 ); if( randomize && BUGGIFY ) INCOMPATIBLE_PEERS_LOGGING_INTERVAL = 60.0;
 	init( EXPECTED_MASTER_FITNESS,            ProcessClass::UnsetFit );
@@ -792,6 +872,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( POLICY_GENERATIONS,                                    100 ); if( randomize && BUGGIFY ) POLICY_GENERATIONS = 10;
 	init( DBINFO_SEND_AMOUNT,                                      5 );
 	init( DBINFO_BATCH_DELAY,                                    0.1 );
+	init( DBINFO_BROADCAST_DELTAS,                              true ); if( randomize && BUGGIFY ) DBINFO_BROADCAST_DELTAS = false;
 	init( SINGLETON_RECRUIT_BME_DELAY,                          10.0 );
 	init( RECORD_RECOVER_AT_IN_CSTATE,                         false );
 	init( TRACK_TLOG_RECOVERY,                                 false );
@@ -826,6 +907,9 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( RATEKEEPER_DEFAULT_LIMIT,                              1e6 ); if( randomize && BUGGIFY ) RATEKEEPER_DEFAULT_LIMIT = 0;
 	init( RATEKEEPER_LIMIT_REASON_SAMPLE_RATE,                   0.1 );
 	init( RATEKEEPER_PRINT_LIMIT_REASON,                       false ); if( randomize && BUGGIFY ) RATEKEEPER_PRINT_LIMIT_REASON = true;
+	init( RATEKEEPER_PREDICTIVE_CONTROL,                       false ); if( randomize && BUGGIFY ) RATEKEEPER_PREDICTIVE_CONTROL = true;
+	init( RATEKEEPER_PREDICTION_HORIZON,                         5.0 ); if( randomize && BUGGIFY ) RATEKEEPER_PREDICTION_HORIZON = deterministicRandom()->random01() * 10.0;
+	init( RATEKEEPER_RECORD_CONTROLLER_DECISIONS,              false ); if( randomize && BUGGIFY ) RATEKEEPER_RECORD_CONTROLLER_DECISIONS = true;
 	init( RATEKEEPER_MIN_RATE,                                   0.0 );
 	init( RATEKEEPER_MAX_RATE,                                   1e9 );
 	init( RATEKEEPER_BATCH_MIN_RATE,                             0.0 );
@@ -838,11 +922,18 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( AUTO_TAG_THROTTLE_SPRING_BYTES_STORAGE_SERVER,       200e6 ); if( smallStorageTarget ) AUTO_TAG_THROTTLE_SPRING_BYTES_STORAGE_SERVER = 500e3;
 	init( TARGET_BYTES_PER_STORAGE_SERVER_BATCH,               750e6 ); if( smallStorageTarget ) TARGET_BYTES_PER_STORAGE_SERVER_BATCH = 1500e3;
 	init( SPRING_BYTES_STORAGE_SERVER_BATCH,                   100e6 ); if( smallStorageTarget ) SPRING_BYTES_STORAGE_SERVER_BATCH = 150e3;
+	init( TARGET_READ_QUEUE_WAIT_BATCH,                          0.1 ); // 0 disables throttling batch transactions on the read queue wait of storage servers
+	init( SPRING_READ_QUEUE_WAIT_BATCH,                         0.05 );
 	init( STORAGE_HARD_LIMIT_BYTES,                           1500e6 ); if( smallStorageTarget ) STORAGE_HARD_LIMIT_BYTES = 4500e3;
 	init( STORAGE_HARD_LIMIT_BYTES_OVERAGE,                   5000e3 ); if( smallStorageTarget ) STORAGE_HARD_LIMIT_BYTES_OVERAGE = 100e3; // byte+version overage ensures storage server makes enough progress on freeing up storage queue memory at hard limit by ensuring it advances desiredOldestVersion enough per commit cycle.
 	init( STORAGE_HARD_LIMIT_BYTES_SPEED_UP_SIM, STORAGE_HARD_LIMIT_BYTES ); if( smallStorageTarget ) STORAGE_HARD_LIMIT_BYTES_SPEED_UP_SIM *= 10;
 	init( STORAGE_HARD_LIMIT_BYTES_OVERAGE_SPEED_UP_SIM, STORAGE_HARD_LIMIT_BYTES_OVERAGE ); if( smallStorageTarget ) STORAGE_HARD_LIMIT_BYTES_OVERAGE_SPEED_UP_SIM *= 10;
 	init( STORAGE_HARD_LIMIT_VERSION_OVERAGE, VERSIONS_PER_SECOND / 4.0 );
+	init( STORAGE_ADAPTIVE_MVCC_WINDOW_BYTES,                  500e6 ); if( smallStorageTarget ) STORAGE_ADAPTIVE_MVCC_WINDOW_BYTES = 1500e3; // 0 always keeps MAX_READ_TRANSACTION_LIFE_VERSIONS in memory
+	init( STORAGE_MIN_MVCC_WINDOW_VERSIONS,      VERSIONS_PER_SECOND ); if( randomize && BUGGIFY ) STORAGE_MIN_MVCC_WINDOW_VERSIONS = deterministicRandom()->randomInt(0, 4) * VERSIONS_PER_SECOND / 4;
+	init( STORAGE_VERSIONED_ENGINE_MVCC_WINDOW_VERSIONS, VERSIONS_PER_SECOND / 2 ); if( randomize && BUGGIFY ) STORAGE_VERSIONED_ENGINE_MVCC_WINDOW_VERSIONS = deterministicRandom()->randomInt(0, 4) * VERSIONS_PER_SECOND / 4;
+	init( STORAGE_LONG_SNAPSHOT_MAX_COUNT,                         4 ); if( randomize && BUGGIFY ) STORAGE_LONG_SNAPSHOT_MAX_COUNT = deterministicRandom()->randomInt(0, 3);
+	init( STORAGE_LONG_SNAPSHOT_MAX_AGE,                       600.0 ); if( randomize && BUGGIFY ) STORAGE_LONG_SNAPSHOT_MAX_AGE = deterministicRandom()->randomInt(1, 30);
 	init( STORAGE_DURABILITY_LAG_HARD_MAX,                    2000e6 ); if( smallStorageTarget ) STORAGE_DURABILITY_LAG_HARD_MAX = 100e6;
 	init( STORAGE_DURABILITY_LAG_SOFT_MAX,                     250e6 ); if( smallStorageTarget ) STORAGE_DURABILITY_LAG_SOFT_MAX = 10e6;
 	init( STORAGE_INCLUDE_FEED_STORAGE_QUEUE,                   true ); if ( randomize && BUGGIFY ) STORAGE_INCLUDE_FEED_STORAGE_QUEUE = false;
@@ -930,11 +1021,16 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( GLOBAL_TAG_THROTTLING_TRANSACTION_COUNT_FOLDING_TIME,   2.0 );
 	init( GLOBAL_TAG_THROTTLING_TRANSACTION_RATE_FOLDING_TIME,   10.0 );
 	init( GLOBAL_TAG_THROTTLING_COST_FOLDING_TIME,               10.0 );
+	init( GLOBAL_TAG_THROTTLING_ENGINE_READ_COST,               false ); if(randomize && BUGGIFY) GLOBAL_TAG_THROTTLING_ENGINE_READ_COST = true;
+	init( GLOBAL_TAG_THROTTLING_PAGES_PER_ENGINE_READ,            1.0 );
 
 	init( HOT_SHARD_THROTTLING_ENABLED,                         false ); if(randomize && BUGGIFY) HOT_SHARD_THROTTLING_ENABLED = true;
 	init( HOT_SHARD_THROTTLING_EXPIRE_AFTER,                      3.0 );
 	init( HOT_SHARD_THROTTLING_TRACKED,                             1 );
 	init( HOT_SHARD_MONITOR_FREQUENCY,                            5.0 );
+	init( STORAGE_WRITE_BUDGETS_ENABLED,                        false ); if(randomize && BUGGIFY) STORAGE_WRITE_BUDGETS_ENABLED = true;
+	init( STORAGE_WRITE_BUDGETS_INTERVAL,                         0.5 );
+	init( STORAGE_WRITE_BUDGETS_EXPIRE_AFTER,                     2.0 );
 
 	init( GENERATE_DATA_ENABLED,                                false );
 	init( GENERATE_DATA_PER_VERSION_MAX,                        10000 );
@@ -958,6 +1054,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	//Storage Server
 	init( STORAGE_LOGGING_DELAY,                                 5.0 );
 	init( STORAGE_SERVER_POLL_METRICS_DELAY,                     1.0 );
+	init( STORAGE_SHARD_METRICS_POLL_INTERVAL,                   0.5 ); if( randomize && BUGGIFY ) STORAGE_SHARD_METRICS_POLL_INTERVAL = 0.05;
 	init( FUTURE_VERSION_DELAY,                                  1.0 );
 	init( STORAGE_LIMIT_BYTES,                                500000 );
 	init( BUGGIFY_LIMIT_BYTES,                                  1000 );
@@ -967,9 +1064,14 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( FETCH_KEYS_PARALLELISM_BYTES,                          4e6 ); if( randomize && BUGGIFY ) FETCH_KEYS_PARALLELISM_BYTES = 3e6;
 	init( FETCH_KEYS_PARALLELISM,                                  2 );
 	init( FETCH_KEYS_PARALLELISM_CHANGE_FEED,                      6 );
+	init( FETCH_KEYS_SUBRANGE_PARALLELISM,                         8 ); if( randomize && BUGGIFY ) FETCH_KEYS_SUBRANGE_PARALLELISM = deterministicRandom()->randomInt(1, 9);
+	init( FETCH_KEYS_SUBRANGE_BYTES,                             1e7 ); if( randomize && BUGGIFY ) FETCH_KEYS_SUBRANGE_BYTES = deterministicRandom()->randomInt(1e4, 1e6);
+	init( FETCH_KEYS_BULK_LOAD_RETRY_DELAY,                      5.0 );
 	init( FETCH_KEYS_LOWER_PRIORITY,                               0 );
 	init( SERVE_FETCH_CHECKPOINT_PARALLELISM,                      4 );
 	init( SERVE_AUDIT_STORAGE_PARALLELISM,                         1 );
+	init( SERVE_AUDIT_STORAGE_REPLICA_PARALLELISM,                 4 ); if ( isSimulated ) SERVE_AUDIT_STORAGE_REPLICA_PARALLELISM = deterministicRandom()->randomInt(1, 5);
+	init( AUDIT_STORAGE_USE_CHECKSUMS,                          true ); if( randomize && BUGGIFY ) AUDIT_STORAGE_USE_CHECKSUMS = false;
 	init( PERSIST_FINISH_AUDIT_COUNT,                             10 ); if ( isSimulated ) PERSIST_FINISH_AUDIT_COUNT = deterministicRandom()->randomInt(1, PERSIST_FINISH_AUDIT_COUNT+1);
 	init( AUDIT_RETRY_COUNT_MAX,                               10000 ); if ( isSimulated ) AUDIT_RETRY_COUNT_MAX = 10;
 	init( CONCURRENT_AUDIT_TASK_COUNT_MAX,                        20 ); if ( isSimulated ) CONCURRENT_AUDIT_TASK_COUNT_MAX = deterministicRandom()->randomInt(1, CONCURRENT_AUDIT_TASK_COUNT_MAX+1);
@@ -992,6 +1094,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( STORAGE_DURABILITY_LAG_REJECT_THRESHOLD,              0.25 );
 	init( STORAGE_DURABILITY_LAG_MIN_RATE,                       0.1 );
 	init( STORAGE_COMMIT_INTERVAL,                               0.5 ); if( randomize && BUGGIFY ) STORAGE_COMMIT_INTERVAL = 2.0;
+	init( STORAGE_PIPELINED_COMMIT,                            false ); if( randomize && BUGGIFY ) STORAGE_PIPELINED_COMMIT = true;
 
 	// Constants which affect the fraction of data which is sampled
 	// by storage severs to estimate key-range sizes and splits.
@@ -1012,6 +1115,8 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( MIN_BYTE_SAMPLING_PROBABILITY,                           0 );
 
 	init( MAX_STORAGE_SERVER_WATCH_BYTES,                      100e6 ); if( randomize && BUGGIFY ) MAX_STORAGE_SERVER_WATCH_BYTES = 10e3;
+	init( STORAGE_SERVER_BATCH_WATCH_TRIGGERS,                  true ); if( randomize && BUGGIFY ) STORAGE_SERVER_BATCH_WATCH_TRIGGERS = false;
+	init( STORAGE_SERVER_SORTED_SET_BATCH,                       100 ); if( randomize && BUGGIFY ) STORAGE_SERVER_SORTED_SET_BATCH = deterministicRandom()->coinflip() ? 0 : deterministicRandom()->randomInt(1, 20);
 	init( MAX_BYTE_SAMPLE_CLEAR_MAP_SIZE,                        1e9 ); if( randomize && BUGGIFY ) MAX_BYTE_SAMPLE_CLEAR_MAP_SIZE = 1e3;
 	init( LONG_BYTE_SAMPLE_RECOVERY_DELAY,                      60.0 );
 	init( BYTE_SAMPLE_LOAD_PARALLELISM,                            8 ); if( randomize && BUGGIFY ) BYTE_SAMPLE_LOAD_PARALLELISM = 1;
@@ -1024,24 +1129,32 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( MIN_TAG_READ_PAGES_RATE,                               100 ); if( randomize && BUGGIFY ) MIN_TAG_READ_PAGES_RATE = 0;
 	init( MIN_TAG_WRITE_PAGES_RATE,                              100 ); if( randomize && BUGGIFY ) MIN_TAG_WRITE_PAGES_RATE = 0;
 	init( TAG_MEASUREMENT_INTERVAL,                              5.0 ); if( randomize && BUGGIFY ) TAG_MEASUREMENT_INTERVAL = 10.0;
+	init( STORAGE_READ_RESOURCE_SAMPLE_RATE,                    0.01 ); if( randomize && BUGGIFY ) STORAGE_READ_RESOURCE_SAMPLE_RATE = deterministicRandom()->coinflip() ? 0.0 : 1.0;
+	init( STORAGE_READ_RESOURCE_MAX_TRACKED,                      10 ); if( randomize && BUGGIFY ) STORAGE_READ_RESOURCE_MAX_TRACKED = 1;
 	init( PREFIX_COMPRESS_KVS_MEM_SNAPSHOTS,                    true ); if( randomize && BUGGIFY ) PREFIX_COMPRESS_KVS_MEM_SNAPSHOTS = false;
+	init( KVS_MEM_SNAPSHOT_WRITE_RATIO,                          1.0 ); if( randomize && BUGGIFY ) KVS_MEM_SNAPSHOT_WRITE_RATIO = deterministicRandom()->random01() * 0.75 + 0.25;
 	init( REPORT_DD_METRICS,                                    true );
 	init( DD_METRICS_REPORT_INTERVAL,                           30.0 );
 	init( FETCH_KEYS_TOO_LONG_TIME_CRITERIA,                   300.0 );
 	init( MAX_STORAGE_COMMIT_TIME,                             200.0 ); //The max fsync stall time on the storage server and tlog before marking a disk as failed
 	init( RANGESTREAM_LIMIT_BYTES,                               2e6 ); if( randomize && BUGGIFY ) RANGESTREAM_LIMIT_BYTES = 1;
+	init( RANGESTREAM_READ_AHEAD_CHUNKS,                           2 ); if( randomize && BUGGIFY ) RANGESTREAM_READ_AHEAD_CHUNKS = deterministicRandom()->randomInt(1, 5);
 	init( CHANGEFEEDSTREAM_LIMIT_BYTES,                          1e6 ); if( randomize && BUGGIFY ) CHANGEFEEDSTREAM_LIMIT_BYTES = 1;
 	init( BLOBWORKERSTATUSSTREAM_LIMIT_BYTES,                    1e4 ); if( randomize && BUGGIFY ) BLOBWORKERSTATUSSTREAM_LIMIT_BYTES = 1;
 	init( ENABLE_CLEAR_RANGE_EAGER_READS,                       true ); if( randomize && BUGGIFY ) ENABLE_CLEAR_RANGE_EAGER_READS = deterministicRandom()->coinflip();
 	init( CHECKPOINT_TRANSFER_BLOCK_BYTES,                      40e6 );
+	init( HOT_VALUE_CACHE_BYTES,                                   0 ); if( randomize && BUGGIFY ) HOT_VALUE_CACHE_BYTES = deterministicRandom()->randomInt(0, 2) * deterministicRandom()->randomInt(1, 1 << 20);
+	init( HOT_VALUE_CACHE_MIN_READ_BANDWIDTH,                    1e5 ); if( randomize && BUGGIFY ) HOT_VALUE_CACHE_MIN_READ_BANDWIDTH = 0;
 	init( QUICK_GET_VALUE_FALLBACK,                             true );
 	init( QUICK_GET_KEY_VALUES_FALLBACK,                        true );
 	init( STRICTLY_ENFORCE_BYTE_LIMIT,                          false); if( randomize && BUGGIFY ) STRICTLY_ENFORCE_BYTE_LIMIT = deterministicRandom()->coinflip();
 	init( FRACTION_INDEX_BYTELIMIT_PREFETCH,                      0.2); if( randomize && BUGGIFY ) FRACTION_INDEX_BYTELIMIT_PREFETCH = 0.01 + deterministicRandom()->random01();
+	init( QUICK_GET_VALUE_BATCHED,                              true ); if ( randomize && BUGGIFY ) QUICK_GET_VALUE_BATCHED = false;
 	init( MAX_PARALLEL_QUICK_GET_VALUE,                           10 ); if ( randomize && BUGGIFY ) MAX_PARALLEL_QUICK_GET_VALUE = deterministicRandom()->randomInt(1, 100);
 	init( QUICK_GET_KEY_VALUES_LIMIT,                           2000 );
 	init( QUICK_GET_KEY_VALUES_LIMIT_BYTES,                      1e7 );
 	init( STORAGE_FEED_QUERY_HARD_LIMIT,                      100000 );
+	init( CHANGEFEED_MULTI_STREAM_READ_PARALLELISM,              100 ); if( randomize && BUGGIFY ) CHANGEFEED_MULTI_STREAM_READ_PARALLELISM = deterministicRandom()->randomInt(1, 5);
 	// Read priority definitions in the form of a list of their relative concurrency share weights
 	init( STORAGESERVER_READ_PRIORITIES,           "120,10,20,40,60" );
 	// The total concurrency which will be shared by active priorities according to their relative weights
@@ -1050,6 +1163,9 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	// This exists for flexibility but assigning each ReadType to its own unique priority number makes the most sense
 	// The enumeration is currently: eager, fetch, low, normal, high
 	init( STORAGESERVER_READTYPE_PRIORITY_MAP,           "0,1,2,3,4" );
+	// The read rate used to turn the bytes a read is expected to return into a delay of its place in its priority's
+	// queue; 0 queues the reads of a priority in arrival order
+	init( STORAGESERVER_READ_EXPECTED_BYTES_PER_SECOND,         100e6 ); if( randomize && BUGGIFY ) STORAGESERVER_READ_EXPECTED_BYTES_PER_SECOND = deterministicRandom()->coinflip() ? 0 : 1e6;
 	init( SPLIT_METRICS_MAX_ROWS,                              10000 ); if( randomize && BUGGIFY ) SPLIT_METRICS_MAX_ROWS = 10;
 	init( PHYSICAL_SHARD_MOVE_LOG_SEVERITY,                        1 );
 	init( FETCH_SHARD_BUFFER_BYTE_LIMIT,                        20e6 ); if( randomize && BUGGIFY ) FETCH_SHARD_BUFFER_BYTE_LIMIT = 1;
@@ -1086,6 +1202,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( STORAGE_DISK_CLEANUP_MAX_RETRIES,                       10 );
 	init( STORAGE_DISK_CLEANUP_RETRY_INTERVAL,  isSimulated ? 2 : 30 );
 	init( WORKER_START_STORAGE_DELAY,                            0.0 ); if ( randomize && BUGGIFY ) WORKER_START_STORAGE_DELAY = 1.0;
+	init( WORKER_STORAGE_RECOVERY_PARALLELISM,                     0 ); if ( randomize && BUGGIFY ) WORKER_STORAGE_RECOVERY_PARALLELISM = deterministicRandom()->randomInt(1, 3);
 
 	// Test harness
 	init( WORKER_POLL_DELAY,                                     1.0 );
@@ -1110,6 +1227,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	// Status
 	init( STATUS_MIN_TIME_BETWEEN_REQUESTS,                      0.0 );
 	init( MAX_STATUS_REQUESTS_PER_SECOND,                      256.0 );
+	init( STATUS_CACHE_MAX_AGE,                                  1.0 ); if( randomize && BUGGIFY ) STATUS_CACHE_MAX_AGE = deterministicRandom()->coinflip() ? 0.0 : deterministicRandom()->random01() * 5;
 	init( CONFIGURATION_ROWS_TO_FETCH,                         20000 );
 	init( DISABLE_DUPLICATE_LOG_WARNING,                       false );
 	init( HISTOGRAM_REPORT_INTERVAL,                           300.0 );
@@ -1140,6 +1258,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( FASTRESTORE_HEARTBEAT_DELAY,                            10 ); if( randomize && BUGGIFY ) { FASTRESTORE_HEARTBEAT_DELAY = deterministicRandom()->random01() * 120 + 2; }
 	init( FASTRESTORE_HEARTBEAT_MAX_DELAY,                        10 ); if( randomize && BUGGIFY ) { FASTRESTORE_HEARTBEAT_MAX_DELAY = FASTRESTORE_HEARTBEAT_DELAY * 10; }
 	init( FASTRESTORE_APPLIER_FETCH_KEYS_SIZE,                   100 ); if( randomize && BUGGIFY ) { FASTRESTORE_APPLIER_FETCH_KEYS_SIZE = deterministicRandom()->random01() * 10240 + 1; }
+	init( FASTRESTORE_APPLIER_FETCH_RANGE_ROWS_PER_KEY,             4 ); if( randomize && BUGGIFY ) { FASTRESTORE_APPLIER_FETCH_RANGE_ROWS_PER_KEY = deterministicRandom()->randomInt(0, 3); }
 	init( FASTRESTORE_LOADER_SEND_MUTATION_MSG_BYTES, 1.0 * 1024.0 * 1024.0 ); if( randomize && BUGGIFY ) { FASTRESTORE_LOADER_SEND_MUTATION_MSG_BYTES = deterministicRandom()->random01() < 0.2 ? 1024 : deterministicRandom()->random01() * 5.0 * 1024.0 * 1024.0 + 1; }
 	init( FASTRESTORE_GET_RANGE_VERSIONS_EXPENSIVE,            false ); if( randomize && BUGGIFY ) { FASTRESTORE_GET_RANGE_VERSIONS_EXPENSIVE = deterministicRandom()->random01() < 0.5 ? true : false; }
 	init( FASTRESTORE_REQBATCH_PARALLEL,                          50 ); if( randomize && BUGGIFY ) { FASTRESTORE_REQBATCH_PARALLEL = deterministicRandom()->random01() * 100 + 1; }
@@ -1170,17 +1289,26 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( REDWOOD_DEFAULT_EXTENT_READ_SIZE,              1024 * 1024 );
 	init( REDWOOD_EXTENT_CONCURRENT_READS,                         4 );
 	init( REDWOOD_KVSTORE_RANGE_PREFETCH,                       true );
+	init( REDWOOD_RANGE_PREFETCH_QUEUE_DEPTH,                     16 ); if( randomize && BUGGIFY ) { REDWOOD_RANGE_PREFETCH_QUEUE_DEPTH = deterministicRandom()->randomInt(1, 4); }
+	init( REDWOOD_VALUE_EXTERNAL_THRESHOLD,                        0 );
 	init( REDWOOD_PAGE_REBUILD_MAX_SLACK,                       0.33 );
 	init( REDWOOD_PAGE_REBUILD_SLACK_DISTRIBUTION,              0.50 );
 	init( REDWOOD_LAZY_CLEAR_BATCH_SIZE_PAGES,                    10 );
 	init( REDWOOD_LAZY_CLEAR_MIN_PAGES,                            0 );
 	init( REDWOOD_LAZY_CLEAR_MAX_PAGES,                          1e6 );
+	init( REDWOOD_LAZY_CLEAR_PAGES_PER_SECOND,                     0 );
 	init( REDWOOD_REMAP_CLEANUP_WINDOW_BYTES, 4LL * 1024 * 1024 * 1024 );
 	init( REDWOOD_REMAP_CLEANUP_TOLERANCE_RATIO,                0.05 );
 	init( REDWOOD_PAGEFILE_GROWTH_SIZE_PAGES,                  20000 ); if( randomize && BUGGIFY ) { REDWOOD_PAGEFILE_GROWTH_SIZE_PAGES = deterministicRandom()->randomInt(200, 1000); }
 	init( REDWOOD_METRICS_INTERVAL,                              5.0 );
 	init( REDWOOD_HISTOGRAM_INTERVAL,                           30.0 );
 	init( REDWOOD_EVICT_UPDATED_PAGES,                          true ); if( randomize && BUGGIFY ) { REDWOOD_EVICT_UPDATED_PAGES = false; }
+	init( REDWOOD_PAGE_CACHE_PROTECTED_FRACTION,                0.8 ); if( randomize && BUGGIFY ) { REDWOOD_PAGE_CACHE_PROTECTED_FRACTION = deterministicRandom()->random01(); }
+	init( REDWOOD_PAGE_COMPRESSION_FILTER,                   "NONE" ); if( randomize && BUGGIFY ) { REDWOOD_PAGE_COMPRESSION_FILTER = CompressionUtils::toString(CompressionUtils::getRandomFilter()); }
+	init( REDWOOD_ENCODE_THREADS,                                 0 ); if( randomize && BUGGIFY ) { REDWOOD_ENCODE_THREADS = deterministicRandom()->randomInt(1, 4); }
+	init( REDWOOD_PAGE_CACHE_SLAB,                            false ); if( randomize && BUGGIFY ) { REDWOOD_PAGE_CACHE_SLAB = true; }
+	init( REDWOOD_RELOCATE_INTERVAL,                            0.0 ); if( randomize && BUGGIFY ) { REDWOOD_RELOCATE_INTERVAL = deterministicRandom()->random01() * 5; }
+	init( REDWOOD_RELOCATE_MIN_SCATTER,                         0.5 ); if( randomize && BUGGIFY ) { REDWOOD_RELOCATE_MIN_SCATTER = deterministicRandom()->random01(); }
 	init( REDWOOD_DECODECACHE_REUSE_MIN_HEIGHT,                    2 ); if( randomize && BUGGIFY ) { REDWOOD_DECODECACHE_REUSE_MIN_HEIGHT = deterministicRandom()->randomInt(1, 7); }
 	init( REDWOOD_NODE_MAX_UNBALANCE,                              2 );
 	init( REDWOOD_IO_PRIORITIES,                       "32,32,32,32" );
@@ -1196,6 +1324,8 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	// Encryption
 	init( SIM_KMS_MAX_KEYS,                                     4096 );
 	init( ENCRYPT_PROXY_MAX_DBG_TRACE_LENGTH,                 100000 );
+	init( ENCRYPT_PROXY_KMS_LOOKUP_BATCH_DELAY,                0.005 ); if( randomize && BUGGIFY ) ENCRYPT_PROXY_KMS_LOOKUP_BATCH_DELAY = deterministicRandom()->coinflip() ? 0.0 : 0.1;
+	init( ENCRYPT_PROXY_REFRESH_UNUSED_KEY_TIME,              3600.0 ); if( randomize && BUGGIFY ) ENCRYPT_PROXY_REFRESH_UNUSED_KEY_TIME = deterministicRandom()->coinflip() ? 0.0 : 10.0;
 
 	// encrypt key proxy
 	init( ENABLE_BLOB_GRANULE_COMPRESSION,                     false ); if ( randomize && BUGGIFY ) { ENABLE_BLOB_GRANULE_COMPRESSION = deterministicRandom()->coinflip(); }
@@ -1214,6 +1344,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( BG_USE_BLOB_RANGE_CHANGE_LOG,                        false ); if ( randomize && BUGGIFY ) BG_USE_BLOB_RANGE_CHANGE_LOG = true;
 	init( BG_SNAPSHOT_FILE_TARGET_BYTES,                    20000000 ); if ( buggifySmallShards ) BG_SNAPSHOT_FILE_TARGET_BYTES = 50000 * deterministicRandom()->randomInt(1, 4); else if (buggifyMediumGranules) BG_SNAPSHOT_FILE_TARGET_BYTES = 50000 * deterministicRandom()->randomInt(1, 20);
 	init( BG_SNAPSHOT_FILE_TARGET_CHUNK_BYTES,               64*1024 ); if ( randomize && BUGGIFY ) BG_SNAPSHOT_FILE_TARGET_CHUNK_BYTES = BG_SNAPSHOT_FILE_TARGET_BYTES / (1 << deterministicRandom()->randomInt(0, 8));
+	init( BG_SNAPSHOT_COLUMNAR,                              false ); if ( randomize && BUGGIFY ) BG_SNAPSHOT_COLUMNAR = true;
 	init( BG_DELTA_BYTES_BEFORE_COMPACT, BG_SNAPSHOT_FILE_TARGET_BYTES/2 ); if ( randomize && BUGGIFY ) BG_DELTA_BYTES_BEFORE_COMPACT *= (1.0 + deterministicRandom()->random01() * 3.0)/2.0;
 	init( BG_DELTA_FILE_TARGET_BYTES,   BG_DELTA_BYTES_BEFORE_COMPACT/10 );
 	init( BG_DELTA_FILE_TARGET_CHUNK_BYTES,                  32*1024 ); if ( randomize && BUGGIFY ) BG_DELTA_FILE_TARGET_CHUNK_BYTES = BG_DELTA_FILE_TARGET_BYTES / (1 << deterministicRandom()->randomInt(0, 7));
@@ -1228,6 +1359,7 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( BG_ENABLE_READ_DRIVEN_COMPACTION,                     true ); if (randomize && BUGGIFY) BG_ENABLE_READ_DRIVEN_COMPACTION = false;
 	init( BG_RDC_BYTES_FACTOR,                                     2 ); if (randomize && BUGGIFY) BG_RDC_BYTES_FACTOR = deterministicRandom()->randomInt(1, 10);
 	init( BG_RDC_READ_FACTOR,                                      3 ); if (randomize && BUGGIFY) BG_RDC_READ_FACTOR = deterministicRandom()->randomInt(1, 10);
+	init( BG_RDC_SAVINGS_HORIZON,                               60.0 ); if (randomize && BUGGIFY) BG_RDC_SAVINGS_HORIZON = deterministicRandom()->randomInt(1, 600);
 	init( BG_WRITE_MULTIPART,                                  false ); if (randomize && BUGGIFY) BG_WRITE_MULTIPART = true;
 	init( BG_ENABLE_DYNAMIC_WRITE_AMP,                          true ); if (randomize && BUGGIFY) BG_ENABLE_DYNAMIC_WRITE_AMP = false;
 	init( BG_DYNAMIC_WRITE_AMP_MIN_FACTOR,                       0.5 );
@@ -1242,6 +1374,8 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( BLOB_WORKER_RESNAPSHOT_PARALLELISM,                     40 ); if( randomize && BUGGIFY ) BLOB_WORKER_RESNAPSHOT_PARALLELISM = deterministicRandom()->randomInt(1, 10);
 	init( BLOB_WORKER_DELTA_FILE_WRITE_PARALLELISM,             2000 ); if( randomize && BUGGIFY ) BLOB_WORKER_DELTA_FILE_WRITE_PARALLELISM = deterministicRandom()->randomInt(10, 100);
 	init( BLOB_WORKER_RDC_PARALLELISM,                             2 ); if( randomize && BUGGIFY ) BLOB_WORKER_RDC_PARALLELISM = deterministicRandom()->randomInt(1, 6);
+	init( BLOB_WORKER_RDC_BYTES_PER_SECOND,                    100e6 ); if( randomize && BUGGIFY ) BLOB_WORKER_RDC_BYTES_PER_SECOND = deterministicRandom()->random01() * BG_SNAPSHOT_FILE_TARGET_BYTES;
+	init( BLOB_WORKER_RDC_BUDGET_SECONDS,                       10.0 );
 	init( BLOB_WORKER_RESNAPSHOT_BUDGET_BYTES,        1024*1024*1024 ); if( randomize && BUGGIFY ) BLOB_WORKER_RESNAPSHOT_BUDGET_BYTES = deterministicRandom()->random01() * 10 * BG_SNAPSHOT_FILE_TARGET_BYTES;
 	init( BLOB_WORKER_DELTA_WRITE_BUDGET_BYTES,       1024*1024*1024 ); if( randomize && BUGGIFY ) BLOB_WORKER_DELTA_WRITE_BUDGET_BYTES = (5 + 45*deterministicRandom()->random01()) * BG_DELTA_FILE_TARGET_BYTES;
 	init( BLOB_WORKER_TIMEOUT,                                  10.0 ); if( randomize && BUGGIFY ) BLOB_WORKER_TIMEOUT = 1.0;
@@ -1319,6 +1453,10 @@ void ServerKnobs::initialize(Randomize randomize, ClientKnobs* clientKnobs, IsSi
 	init( REST_KMS_STABILITY_CHECK_INTERVAL,                      5.0);
 
 	init( CONSISTENCY_SCAN_ACTIVE_THROTTLE_RATIO,                0.5 ); if( randomize && BUGGIFY ) CONSISTENCY_SCAN_ACTIVE_THROTTLE_RATIO = deterministicRandom()->random01();
+	init( CONSISTENCY_SCAN_USE_CHECKSUMS,                       true ); if( randomize && BUGGIFY ) CONSISTENCY_SCAN_USE_CHECKSUMS = deterministicRandom()->coinflip();
+	init( CONSISTENCY_SCAN_CHECKSUM_BYTES,                       1e6 ); if( randomize && BUGGIFY ) CONSISTENCY_SCAN_CHECKSUM_BYTES = deterministicRandom()->randomInt(1, 1e5);
+	init( CONSISTENCY_SCAN_MIN_LOAD_FACTOR,                     0.05 );
+	init( CONSISTENCY_SCAN_LOAD_FACTOR_RECOVERY,                 1.1 ); if( randomize && BUGGIFY ) CONSISTENCY_SCAN_LOAD_FACTOR_RECOVERY = 1.0 + deterministicRandom()->random01();
 
 
 	init( FLOW_WITH_SWIFT,                                       false);
@@ -775,6 +775,110 @@ Future<RangeResult> DDStatsRangeImpl::getRange(ReadYourWritesTransaction* ryw,
 	return ddMetricsGetRangeActor(ryw, kr);
 }
 
+ACTOR Future<RangeResult> ddHeatmapGetRangeActor(ReadYourWritesTransaction* ryw, KeyRangeRef kr) {
+	loop {
+		try {
+			state KeyRange keys = kr.removePrefix(ddHeatmapRange.begin);
+			Standalone<VectorRef<HeatmapBucketRef>> buckets =
+			    wait(waitDataDistributionHeatmap(ryw->getDatabase(), keys, 0));
+			// A key holds the slices which have a bucket beginning there, the first bucket of a slice being put at the
+			// beginning of the range read. Each bucket ends at the next key holding its slice.
+			std::map<Key, json_spirit::mArray> slicesByBegin;
+			for (const auto& bucket : buckets) {
+				json_spirit::mObject sliceObj;
+				sliceObj["time"] = bucket.time;
+				sliceObj["bytes"] = bucket.bytes;
+				sliceObj["bytes_written_per_ksecond"] = bucket.bytesWrittenPerKSecond;
+				sliceObj["bytes_read_per_ksecond"] = bucket.bytesReadPerKSecond;
+				sliceObj["ops_read_per_ksecond"] = bucket.opsReadPerKSecond;
+				slicesByBegin[Key(std::max(bucket.beginKey, keys.begin))].push_back(sliceObj);
+			}
+			RangeResult result;
+			for (const auto& [begin, slices] : slicesByBegin) {
+				json_spirit::mObject bucketsObj;
+				bucketsObj["slices"] = slices;
+				std::string bucketsString =
+				    json_spirit::write_string(json_spirit::mValue(bucketsObj), json_spirit::Output_options::raw_utf8);
+				result.push_back_deep(result.arena(),
+				                      KeyValueRef(begin.withPrefix(ddHeatmapRange.begin), ValueRef(bucketsString)));
+			}
+			return result;
+		} catch (Error& e) {
+			state Error err(e);
+			if (e.code() == error_code_dd_not_found) {
+				TraceEvent(SevWarnAlways, "DataDistributorNotPresent")
+				    .detail("Operation", "DDHeatmapRequestThroughSpecialKeys");
+				wait(delayJittered(FLOW_KNOBS->PREVENT_FAST_SPIN_DELAY));
+				continue;
+			}
+			throw err;
+		}
+	}
+}
+
+DDHeatmapRangeImpl::DDHeatmapRangeImpl(KeyRangeRef kr) : SpecialKeyRangeAsyncImpl(kr) {}
+
+Future<RangeResult> DDHeatmapRangeImpl::getRange(ReadYourWritesTransaction* ryw,
+                                                 KeyRangeRef kr,
+                                                 GetRangeLimits limitsHint) const {
+	return ddHeatmapGetRangeActor(ryw, kr);
+}
+
+ACTOR Future<RangeResult> heapProfileGetRangeActor(ReadYourWritesTransaction* ryw, KeyRangeRef kr) {
+	// A read covers the sites of the one process whose address begins it
+	state StringRef rest = kr.begin.removePrefix(heapProfileRange.begin);
+	state StringRef host = rest.eat("/"_sr);
+	state NetworkAddress address;
+	try {
+		address = NetworkAddress::parse(host.toString());
+	} catch (Error& e) {
+		if (e.code() == error_code_actor_cancelled) {
+			throw;
+		}
+	}
+	state Key hostPrefix = host.withPrefix(heapProfileRange.begin).withSuffix("/"_sr);
+	if (!address.isValid() || kr.end > strinc(hostPrefix)) {
+		ryw->setSpecialKeySpaceErrorMsg(ManagementAPIError::toJsonString(
+		    false, "read heap_profile", "the range must be within the keys of one address"));
+		throw special_keys_api_failure();
+	}
+
+	state ProcessInterface process;
+	process.getInterface =
+	    RequestStream<GetProcessInterfaceRequest>(Endpoint::wellKnown({ address }, WLTOKEN_PROCESS));
+	ProcessInterface p = wait(retryBrokenPromise(process.getInterface, GetProcessInterfaceRequest{}));
+	process = p;
+	HeapProfileReply reply = wait(process.heapProfile.getReply(HeapProfileRequest{}));
+
+	RangeResult result;
+	for (int i = 0; i < reply.sites.size(); i++) {
+		Key key = hostPrefix.withSuffix(format("%06d", i));
+		if (!kr.contains(key)) {
+			continue;
+		}
+		const HeapProfileSite& site = reply.sites[i];
+		json_spirit::mObject siteObj;
+		siteObj["sample_bytes"] = reply.sampleBytes;
+		siteObj["role"] = site.role;
+		siteObj["live_bytes"] = site.liveBytes;
+		siteObj["live_samples"] = site.liveSamples;
+		siteObj["allocated_bytes"] = site.allocatedBytes;
+		siteObj["backtrace"] = site.backtrace;
+		std::string siteString =
+		    json_spirit::write_string(json_spirit::mValue(siteObj), json_spirit::Output_options::raw_utf8);
+		result.push_back_deep(result.arena(), KeyValueRef(key, ValueRef(siteString)));
+	}
+	return result;
+}
+
+HeapProfileRangeImpl::HeapProfileRangeImpl(KeyRangeRef kr) : SpecialKeyRangeAsyncImpl(kr) {}
+
+Future<RangeResult> HeapProfileRangeImpl::getRange(ReadYourWritesTransaction* ryw,
+                                                   KeyRangeRef kr,
+                                                   GetRangeLimits limitsHint) const {
+	return heapProfileGetRangeActor(ryw, kr);
+}
+
 Key SpecialKeySpace::getManagementApiCommandOptionSpecialKey(const std::string& command, const std::string& option) {
 	Key prefix = "options/"_sr.withPrefix(moduleToBoundary[MODULE::MANAGEMENT].begin);
 	auto pair = command + "/" + option;
@@ -115,10 +115,129 @@ void TSS_traceMismatch(TraceEvent& event, const GetKeyRequest& req, const GetKey
 	            format("%s%s:%d", tss.sel.orEqual ? "=" : "", tss.sel.getKey().printable().c_str(), tss.sel.offset));
 }
 
+// Each prefix compressed row is the length of the prefix its key shares with the previous key and the length of the rest
+// of the key as uint16_t, the length of the value as uint32_t, then the rest of the key and the value
+constexpr int prefixCompressedRowHeaderBytes = 2 * sizeof(uint16_t) + sizeof(uint32_t);
+
+static Optional<StringRef> prefixCompressKeyValues(Arena& arena, VectorRef<KeyValueRef> const& data) {
+	int64_t bytes = 0, rowsBytes = 0;
+	KeyRef prevKey;
+	for (const KeyValueRef& kv : data) {
+		if (kv.key.size() > std::numeric_limits<uint16_t>::max()) {
+			return Optional<StringRef>();
+		}
+		int shared = commonPrefixLength(prevKey, kv.key);
+		bytes += prefixCompressedRowHeaderBytes + kv.key.size() - shared + kv.value.size();
+		rowsBytes += 2 * sizeof(uint32_t) + kv.key.size() + kv.value.size();
+		prevKey = kv.key;
+	}
+	if (bytes >= rowsBytes) {
+		return Optional<StringRef>();
+	}
+
+	uint8_t* begin = new (arena) uint8_t[bytes];
+	uint8_t* out = begin;
+	prevKey = KeyRef();
+	for (const KeyValueRef& kv : data) {
+		uint16_t shared = commonPrefixLength(prevKey, kv.key);
+		uint16_t suffixSize = kv.key.size() - shared;
+		uint32_t valueSize = kv.value.size();
+		memcpy(out, &shared, sizeof(shared));
+		memcpy(out + sizeof(shared), &suffixSize, sizeof(suffixSize));
+		memcpy(out + 2 * sizeof(uint16_t), &valueSize, sizeof(valueSize));
+		out += prefixCompressedRowHeaderBytes;
+		memcpy(out, kv.key.begin() + shared, suffixSize);
+		out += suffixSize;
+		memcpy(out, kv.value.begin(), valueSize);
+		out += valueSize;
+		prevKey = kv.key;
+	}
+	ASSERT(out - begin == bytes);
+	return StringRef(begin, bytes);
+}
+
+// The values of the returned rows point into compressed, which must live in arena
+static VectorRef<KeyValueRef, VecSerStrategy::String> expandPrefixCompressedKeyValues(Arena& arena,
+                                                                                      StringRef compressed) {
+	// The first pass checks the rows and sizes the keys, so that they can be restored into one allocation
+	int rows = 0;
+	int64_t keyBytes = 0;
+	int prevKeySize = 0;
+	for (const uint8_t* in = compressed.begin(); in != compressed.end();) {
+		uint16_t shared, suffixSize;
+		uint32_t valueSize;
+		if (compressed.end() - in < prefixCompressedRowHeaderBytes) {
+			throw serialization_failed();
+		}
+		memcpy(&shared, in, sizeof(shared));
+		memcpy(&suffixSize, in + sizeof(shared), sizeof(suffixSize));
+		memcpy(&valueSize, in + 2 * sizeof(uint16_t), sizeof(valueSize));
+		in += prefixCompressedRowHeaderBytes;
+		if (shared > prevKeySize || compressed.end() - in < (int64_t)suffixSize + valueSize) {
+			throw serialization_failed();
+		}
+		in += suffixSize + valueSize;
+		prevKeySize = shared + suffixSize;
+		keyBytes += prevKeySize;
+		++rows;
+	}
+
+	VectorRef<KeyValueRef, VecSerStrategy::String> data;
+	data.reserve(arena, rows);
+	uint8_t* keys = new (arena) uint8_t[keyBytes];
+	KeyRef prevKey;
+	for (const uint8_t* in = compressed.begin(); in != compressed.end();) {
+		uint16_t shared, suffixSize;
+		uint32_t valueSize;
+		memcpy(&shared, in, sizeof(shared));
+		memcpy(&suffixSize, in + sizeof(shared), sizeof(suffixSize));
+		memcpy(&valueSize, in + 2 * sizeof(uint16_t), sizeof(valueSize));
+		in += prefixCompressedRowHeaderBytes;
+		memcpy(keys, prevKey.begin(), shared);
+		memcpy(keys + shared, in, suffixSize);
+		in += suffixSize;
+		KeyRef key(keys, shared + suffixSize);
+		keys += key.size();
+		data.push_back(arena, KeyValueRef(key, ValueRef(in, valueSize)));
+		in += valueSize;
+		prevKey = key;
+	}
+	return data;
+}
+
+void GetKeyValuesReply::prefixCompressData() {
+	prefixCompressedData = prefixCompressKeyValues(arena, data);
+	if (prefixCompressedData.present()) {
+		data = VectorRef<KeyValueRef, VecSerStrategy::String>();
+	}
+}
+
+void GetKeyValuesReply::expandPrefixCompressedData() {
+	if (prefixCompressedData.present()) {
+		data = expandPrefixCompressedKeyValues(arena, prefixCompressedData.get());
+		prefixCompressedData.reset();
+	}
+}
+
+void GetKeyValuesStreamReply::prefixCompressData() {
+	prefixCompressedData = prefixCompressKeyValues(arena, data);
+	if (prefixCompressedData.present()) {
+		data = VectorRef<KeyValueRef, VecSerStrategy::String>();
+	}
+}
+
+void GetKeyValuesStreamReply::expandPrefixCompressedData() {
+	if (prefixCompressedData.present()) {
+		data = expandPrefixCompressedKeyValues(arena, prefixCompressedData.get());
+		prefixCompressedData.reset();
+	}
+}
+
 // range reads
+// Prefix compressed replies are compared as they are, which is exact since the encoding is deterministic
 template <>
 bool TSS_doCompare(const GetKeyValuesReply& src, const GetKeyValuesReply& tss) {
-	return src.more == tss.more && src.data == tss.data;
+	return src.more == tss.more && src.data == tss.data && src.prefixCompressedData == tss.prefixCompressedData;
 }
 
 template <>
@@ -200,8 +319,11 @@ static void traceKeyValuesDiff(TraceEvent& event,
 template <>
 void TSS_traceMismatch(TraceEvent& event,
                        const GetKeyValuesRequest& req,
-                       const GetKeyValuesReply& src,
-                       const GetKeyValuesReply& tss) {
+                       const GetKeyValuesReply& src_,
+                       const GetKeyValuesReply& tss_) {
+	GetKeyValuesReply src = src_, tss = tss_;
+	src.expandPrefixCompressedData();
+	tss.expandPrefixCompressedData();
 	traceKeyValuesDiff(event,
 	                   req.begin,
 	                   req.end,
@@ -248,7 +370,7 @@ void TSS_traceMismatch(TraceEvent& event,
 // streaming range reads
 template <>
 bool TSS_doCompare(const GetKeyValuesStreamReply& src, const GetKeyValuesStreamReply& tss) {
-	return src.more == tss.more && src.data == tss.data;
+	return src.more == tss.more && src.data == tss.data && src.prefixCompressedData == tss.prefixCompressedData;
 }
 
 template <>
@@ -260,8 +382,11 @@ const char* LB_mismatchTraceName(const GetKeyValuesStreamRequest& req, const Com
 template <>
 void TSS_traceMismatch(TraceEvent& event,
                        const GetKeyValuesStreamRequest& req,
-                       const GetKeyValuesStreamReply& src,
-                       const GetKeyValuesStreamReply& tss) {
+                       const GetKeyValuesStreamReply& src_,
+                       const GetKeyValuesStreamReply& tss_) {
+	GetKeyValuesStreamReply src = src_, tss = tss_;
+	src.expandPrefixCompressedData();
+	tss.expandPrefixCompressedData();
 	traceKeyValuesDiff(event,
 	                   req.begin,
 	                   req.end,
@@ -512,6 +637,12 @@ TEST_CASE("/StorageServerInterface/TSSCompare/TestComparison") {
 	ASSERT(!TSS_doCompare(gkvReplyEmpty, gkvReplyOne));
 	ASSERT(!TSS_doCompare(gkvReplyOne, gkvReplyOneMore));
 
+	// a single row shares no prefix and isn't compressed
+	GetKeyValuesReply gkvReplyOneCompressed = gkvReplyOne;
+	gkvReplyOneCompressed.prefixCompressData();
+	ASSERT(!gkvReplyOneCompressed.prefixCompressedData.present());
+	ASSERT(TSS_doCompare(gkvReplyOne, gkvReplyOneCompressed));
+
 	GetKeyReply gkReplyA(KeySelectorRef(StringRef(a, s_a), false, 20), false);
 	GetKeyReply gkReplyB(KeySelectorRef(StringRef(a, s_b), false, 10), false);
 	GetKeyReply gkReplyC(KeySelectorRef(StringRef(a, s_c), true, 0), false);
@@ -581,3 +712,36 @@ TEST_CASE("/StorageServerInterface/TSSCompare/TestComparison") {
 	ASSERT(checksumStart13 == traceChecksumValue(StringRef(s13)).substr(0, 4));
 	return Void();
 }
+
+TEST_CASE("/StorageServerInterface/GetKeyValuesReply/PrefixCompression") {
+	GetKeyValuesReply reply;
+	for (int i = 0; i < 100; ++i) {
+		KeyValueRef kv;
+		kv.key = StringRef(reply.arena,
+		                   format("tuple/layered/prefix/%d/%05d", i % 7, deterministicRandom()->randomInt(0, 1000)));
+		kv.value =
+		    StringRef(reply.arena, deterministicRandom()->randomAlphaNumeric(deterministicRandom()->randomInt(0, 20)));
+		reply.data.push_back(reply.arena, kv);
+	}
+	std::sort(reply.data.begin(), reply.data.end(), KeyValueRef::OrderByKey());
+
+	GetKeyValuesReply compressed = reply;
+	compressed.prefixCompressData();
+	ASSERT(compressed.prefixCompressedData.present() && compressed.data.empty());
+	ASSERT(compressed.prefixCompressedData.get().size() < reply.data.expectedSize());
+
+	GetKeyValuesReply expanded = compressed;
+	expanded.expandPrefixCompressedData();
+	ASSERT(!expanded.prefixCompressedData.present());
+	ASSERT(expanded.data == reply.data);
+
+	GetKeyValuesReply truncated = compressed;
+	truncated.prefixCompressedData = truncated.prefixCompressedData.get().substr(0, 10);
+	try {
+		truncated.expandPrefixCompressedData();
+		ASSERT(false);
+	} catch (Error& e) {
+		ASSERT(e.code() == error_code_serialization_failed);
+	}
+	return Void();
+}
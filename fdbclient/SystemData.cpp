@@ -409,6 +409,20 @@ AuditStorageState decodeAuditStorageState(const ValueRef& value) {
 	return auditState;
 }
 
+const KeyRangeRef bulkLoadKeys = KeyRangeRef("\xff/bulkLoad/"_sr, "\xff/bulkLoad0"_sr);
+const KeyRef bulkLoadPrefix = bulkLoadKeys.begin;
+
+const Value bulkLoadStateValue(const BulkLoadState& bulkLoadState) {
+	return ObjectWriter::toValue(bulkLoadState, IncludeVersion());
+}
+
+BulkLoadState decodeBulkLoadState(const ValueRef& value) {
+	BulkLoadState bulkLoadState;
+	ObjectReader reader(value.begin(), IncludeVersion());
+	reader.deserialize(bulkLoadState);
+	return bulkLoadState;
+}
+
 const KeyRef checkpointPrefix = "\xff/checkpoint/"_sr;
 
 const Key checkpointKeyFor(UID checkpointID) {
@@ -483,6 +497,9 @@ const Value storageCacheServerValue(const StorageServerInterface& ssi) {
 
 const KeyRangeRef ddStatsRange =
     KeyRangeRef("\xff\xff/metrics/data_distribution_stats/"_sr, "\xff\xff/metrics/data_distribution_stats/\xff\xff"_sr);
+const KeyRangeRef ddHeatmapRange = KeyRangeRef("\xff\xff/metrics/heatmap/"_sr, "\xff\xff/metrics/heatmap/\xff\xff"_sr);
+const KeyRangeRef heapProfileRange =
+    KeyRangeRef("\xff\xff/metrics/heap_profile/"_sr, "\xff\xff/metrics/heap_profile/\xff\xff"_sr);
 
 //    "\xff/storageCache/[[begin]]" := "[[vector<uint16_t>]]"
 const KeyRangeRef storageCacheKeys("\xff/storageCache/"_sr, "\xff/storageCache0"_sr);
@@ -30,10 +30,92 @@
 #include "flow/Arena.h"
 #include "flow/ProtocolVersion.h"
 
+#include <thread>
+
 // Users of ThreadSafeTransaction might share Reference<ThreadSafe...> between different threads as long as they don't
 // call addRef (e.g. C API follows this). Therefore, it is unsafe to call (explicitly or implicitly) this->addRef in any
 // of these functions.
 
+// A queued getReadVersion() call. It is also the ThreadFuture handed back to the caller, and once drained it waits for
+// the transaction's read version as a callback, so no actor or extra future is needed per call.
+class ReadVersionRequestQueue::Request final : public ThreadSingleAssignmentVar<Version>, public Callback<Version> {
+public:
+	explicit Request(ISingleThreadTransaction* tr) : tr(tr) {}
+
+	ISingleThreadTransaction* const tr;
+	Request* next = nullptr;
+
+	void fire(Version const& version) override {
+		send(version);
+		delref();
+	}
+	void fire(Version&& version) override {
+		send(version);
+		delref();
+	}
+	void error(Error e) override {
+		sendError(e);
+		delref();
+	}
+};
+
+ThreadFuture<Version> ReadVersionRequestQueue::getReadVersion(ISingleThreadTransaction* tr) {
+	Request* request = new Request(tr); // The queue's reference, released once the request is answered
+	request->addref(); // For the ThreadFuture we return
+
+	request->next = head.load(std::memory_order_relaxed);
+	while (!head.compare_exchange_weak(request->next, request)) {
+	}
+
+	// Make sure a drain that will see this request is queued on the network thread before returning, so that it runs
+	// ahead of whatever the caller does with the transaction next. Usually another caller has already done so.
+	const int64_t ticket = ++pushed;
+	while (scheduled.load() < ticket) {
+		bool expected = false;
+		if (scheduling.compare_exchange_strong(expected, true)) {
+			const int64_t upTo = pushed.load();
+			if (scheduled.load() < ticket) {
+				Reference<ReadVersionRequestQueue> self = Reference<ReadVersionRequestQueue>::addRef(this);
+				onMainThreadVoid([self]() { self->drain(); });
+				scheduled.store(upTo);
+			}
+			scheduling.store(false);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+	return ThreadFuture<Version>(request);
+}
+
+void ReadVersionRequestQueue::drain() {
+	// The stack holds the newest request first
+	Request* requests = nullptr;
+	for (Request* r = head.exchange(nullptr); r;) {
+		Request* next = r->next;
+		r->next = requests;
+		requests = r;
+		r = next;
+	}
+
+	while (requests) {
+		Request* r = requests;
+		requests = r->next;
+		try {
+			r->tr->checkDeferredError();
+			Future<Version> version = r->tr->getReadVersion();
+			if (!version.isReady()) {
+				version.addCallbackAndClear(r);
+			} else if (version.isError()) {
+				r->error(version.getError());
+			} else {
+				r->fire(version.get());
+			}
+		} catch (Error& e) {
+			r->error(e);
+		}
+	}
+}
+
 ThreadFuture<Void> ThreadSafeDatabase::onConnected() {
 	DatabaseContext* db = this->db;
 	return onMainThread([db]() -> Future<Void> {
@@ -57,7 +139,8 @@ Reference<ITenant> ThreadSafeDatabase::openTenant(TenantNameRef tenantName) {
 
 Reference<ITransaction> ThreadSafeDatabase::createTransaction() {
 	auto type = isConfigDB ? ISingleThreadTransaction::Type::PAXOS_CONFIG : ISingleThreadTransaction::Type::RYW;
-	return Reference<ITransaction>(new ThreadSafeTransaction(db, type, Optional<TenantName>(), nullptr));
+	return Reference<ITransaction>(
+	    new ThreadSafeTransaction(db, type, Optional<TenantName>(), nullptr, readVersionQueue));
 }
 
 void ThreadSafeDatabase::setOption(FDBDatabaseOptions::Option option, Optional<StringRef> value) {
@@ -260,7 +343,7 @@ ThreadSafeTenant::ThreadSafeTenant(Reference<ThreadSafeDatabase> db, TenantName
 
 Reference<ITransaction> ThreadSafeTenant::createTransaction() {
 	auto type = db->isConfigDB ? ISingleThreadTransaction::Type::PAXOS_CONFIG : ISingleThreadTransaction::Type::RYW;
-	return Reference<ITransaction>(new ThreadSafeTransaction(db->db, type, name, tenant));
+	return Reference<ITransaction>(new ThreadSafeTransaction(db->db, type, name, tenant, db->readVersionQueue));
 }
 
 ThreadFuture<int64_t> ThreadSafeTenant::getId() {
@@ -356,11 +439,42 @@ ThreadSafeTenant::~ThreadSafeTenant() {
 		onMainThreadVoid([t]() { t->delref(); });
 }
 
+// Applies mutations made through ThreadSafeTransaction in order. A mutation that fails sets the deferred error, as it
+// would if it were made on its own, and the rest are skipped. A ClearRange ending at keyAfter(begin) is a single key
+// clear.
+static void applyMutations(ISingleThreadTransaction* tr, VectorRef<MutationRef> mutations) {
+	for (const auto& mutation : mutations) {
+		if (tr->deferredError.code() != invalid_error_code) {
+			break;
+		}
+		try {
+			if (mutation.type == MutationRef::SetValue) {
+				tr->set(mutation.param1, mutation.param2);
+			} else if (mutation.type == MutationRef::ClearRange) {
+				if (mutation.param1 > mutation.param2) {
+					throw inverted_range();
+				}
+				if (equalsKeyAfter(mutation.param1, mutation.param2)) {
+					tr->clear(mutation.param1);
+				} else {
+					tr->clear(KeyRangeRef(mutation.param1, mutation.param2));
+				}
+			} else {
+				tr->atomicOp(mutation.param1, mutation.param2, mutation.type);
+			}
+		} catch (Error& e) {
+			tr->deferredError = e;
+		}
+	}
+}
+
 ThreadSafeTransaction::ThreadSafeTransaction(DatabaseContext* cx,
                                              ISingleThreadTransaction::Type type,
                                              Optional<TenantName> tenantName,
-                                             Tenant* tenantPtr)
-  : tenantName(tenantName), initialized(std::make_shared<std::atomic_bool>(false)) {
+                                             Tenant* tenantPtr,
+                                             Reference<ReadVersionRequestQueue> readVersionQueue)
+  : tenantName(tenantName), initialized(std::make_shared<std::atomic_bool>(false)),
+    readVersionQueue(std::move(readVersionQueue)), cx(cx) {
 	// Allocate memory for the transaction from this thread (so the pointer is known for subsequent method calls)
 	// but run its constructor on the main thread
 
@@ -394,7 +508,8 @@ ThreadSafeTransaction::ThreadSafeTransaction(DatabaseContext* cx,
 
 // This constructor is only used while refactoring fdbcli and only called from the main thread
 ThreadSafeTransaction::ThreadSafeTransaction(ReadYourWritesTransaction* ryw)
-  : tr(ryw), initialized(std::make_shared<std::atomic_bool>(true)) {
+  : tr(ryw), initialized(std::make_shared<std::atomic_bool>(true)),
+    cx(ryw ? ryw->getDatabase().getPtr() : nullptr) {
 	if (tr)
 		tr->addref();
 }
@@ -406,17 +521,23 @@ ThreadSafeTransaction::~ThreadSafeTransaction() {
 }
 
 void ThreadSafeTransaction::cancel() {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	onMainThreadVoid([tr]() { tr->cancel(); });
 }
 
 void ThreadSafeTransaction::setVersion(Version v) {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	onMainThreadVoid([tr, v]() { tr->setVersion(v); }, tr, &ISingleThreadTransaction::deferredError);
 }
 
 ThreadFuture<Version> ThreadSafeTransaction::getReadVersion() {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
+	if (readVersionQueue && CLIENT_KNOBS->THREADSAFE_GRV_QUEUE) {
+		return readVersionQueue->getReadVersion(tr);
+	}
 	return onMainThread([tr]() -> Future<Version> {
 		tr->checkDeferredError();
 		return tr->getReadVersion();
@@ -424,6 +545,7 @@ ThreadFuture<Version> ThreadSafeTransaction::getReadVersion() {
 }
 
 ThreadFuture<Optional<Value>> ThreadSafeTransaction::get(const KeyRef& key, bool snapshot) {
+	flushMutations();
 	Key k = key;
 
 	ISingleThreadTransaction* tr = this->tr;
@@ -434,6 +556,7 @@ ThreadFuture<Optional<Value>> ThreadSafeTransaction::get(const KeyRef& key, bool
 }
 
 ThreadFuture<Key> ThreadSafeTransaction::getKey(const KeySelectorRef& key, bool snapshot) {
+	flushMutations();
 	KeySelector k = key;
 
 	ISingleThreadTransaction* tr = this->tr;
@@ -444,6 +567,7 @@ ThreadFuture<Key> ThreadSafeTransaction::getKey(const KeySelectorRef& key, bool
 }
 
 ThreadFuture<int64_t> ThreadSafeTransaction::getEstimatedRangeSizeBytes(const KeyRangeRef& keys) {
+	flushMutations();
 	KeyRange r = keys;
 
 	ISingleThreadTransaction* tr = this->tr;
@@ -455,6 +579,7 @@ ThreadFuture<int64_t> ThreadSafeTransaction::getEstimatedRangeSizeBytes(const Ke
 
 ThreadFuture<Standalone<VectorRef<KeyRef>>> ThreadSafeTransaction::getRangeSplitPoints(const KeyRangeRef& range,
                                                                                        int64_t chunkSize) {
+	flushMutations();
 	KeyRange r = range;
 
 	ISingleThreadTransaction* tr = this->tr;
@@ -469,6 +594,7 @@ ThreadFuture<RangeResult> ThreadSafeTransaction::getRange(const KeySelectorRef&
                                                           int limit,
                                                           bool snapshot,
                                                           bool reverse) {
+	flushMutations();
 	KeySelector b = begin;
 	KeySelector e = end;
 
@@ -484,6 +610,7 @@ ThreadFuture<RangeResult> ThreadSafeTransaction::getRange(const KeySelectorRef&
                                                           GetRangeLimits limits,
                                                           bool snapshot,
                                                           bool reverse) {
+	flushMutations();
 	KeySelector b = begin;
 	KeySelector e = end;
 
@@ -500,6 +627,7 @@ ThreadFuture<MappedRangeResult> ThreadSafeTransaction::getMappedRange(const KeyS
                                                                       GetRangeLimits limits,
                                                                       bool snapshot,
                                                                       bool reverse) {
+	flushMutations();
 	KeySelector b = begin;
 	KeySelector e = end;
 	Key h = mapper;
@@ -512,6 +640,7 @@ ThreadFuture<MappedRangeResult> ThreadSafeTransaction::getMappedRange(const KeyS
 }
 
 ThreadFuture<Standalone<VectorRef<const char*>>> ThreadSafeTransaction::getAddressesForKey(const KeyRef& key) {
+	flushMutations();
 	Key k = key;
 
 	ISingleThreadTransaction* tr = this->tr;
@@ -524,6 +653,7 @@ ThreadFuture<Standalone<VectorRef<const char*>>> ThreadSafeTransaction::getAddre
 ThreadFuture<Standalone<VectorRef<KeyRangeRef>>> ThreadSafeTransaction::getBlobGranuleRanges(
     const KeyRangeRef& keyRange,
     int rangeLimit) {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	KeyRange r = keyRange;
 
@@ -546,6 +676,7 @@ ThreadFuture<Standalone<VectorRef<BlobGranuleChunkRef>>> ThreadSafeTransaction::
     Version beginVersion,
     Optional<Version> readVersion,
     Version* readVersionOut) {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	KeyRange r = keyRange;
 
@@ -577,6 +708,7 @@ ThreadFuture<Standalone<VectorRef<BlobGranuleSummaryRef>>> ThreadSafeTransaction
     const KeyRangeRef& keyRange,
     Optional<Version> summaryVersion,
     int rangeLimit) {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	KeyRange r = keyRange;
 
@@ -587,6 +719,7 @@ ThreadFuture<Standalone<VectorRef<BlobGranuleSummaryRef>>> ThreadSafeTransaction
 }
 
 void ThreadSafeTransaction::addReadConflictRange(const KeyRangeRef& keys) {
+	flushMutations();
 	KeyRange r = keys;
 
 	ISingleThreadTransaction* tr = this->tr;
@@ -594,11 +727,19 @@ void ThreadSafeTransaction::addReadConflictRange(const KeyRangeRef& keys) {
 }
 
 void ThreadSafeTransaction::makeSelfConflicting() {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	onMainThreadVoid([tr]() { tr->makeSelfConflicting(); }, tr, &ISingleThreadTransaction::deferredError);
 }
 
 void ThreadSafeTransaction::atomicOp(const KeyRef& key, const ValueRef& value, uint32_t operationType) {
+	if (isValidMutationType(operationType) && isAtomicOp(static_cast<MutationRef::Type>(operationType))) {
+		bufferMutation(MutationRef(static_cast<MutationRef::Type>(operationType), key, value));
+		return;
+	}
+
+	// Left to the transaction to reject
+	flushMutations();
 	Key k = key;
 	Value v = value;
 
@@ -609,44 +750,97 @@ void ThreadSafeTransaction::atomicOp(const KeyRef& key, const ValueRef& value, u
 }
 
 void ThreadSafeTransaction::set(const KeyRef& key, const ValueRef& value) {
-	Key k = key;
-	Value v = value;
-
-	ISingleThreadTransaction* tr = this->tr;
-	onMainThreadVoid([tr, k, v]() { tr->set(k, v); }, tr, &ISingleThreadTransaction::deferredError);
+	bufferMutation(MutationRef(MutationRef::SetValue, key, value));
 }
 
 void ThreadSafeTransaction::clear(const KeyRangeRef& range) {
-	KeyRange r = range;
-
-	ISingleThreadTransaction* tr = this->tr;
-	onMainThreadVoid([tr, r]() { tr->clear(r); }, tr, &ISingleThreadTransaction::deferredError);
+	bufferMutation(MutationRef(MutationRef::ClearRange, range.begin, range.end));
 }
 
 void ThreadSafeTransaction::clear(const KeyRef& begin, const KeyRef& end) {
-	Key b = begin;
-	Key e = end;
+	// An inverted range is rejected when the mutation is applied
+	bufferMutation(MutationRef(MutationRef::ClearRange, begin, end));
+}
 
-	ISingleThreadTransaction* tr = this->tr;
-	onMainThreadVoid(
-	    [tr, b, e]() {
-		    if (b > e)
-			    throw inverted_range();
+void ThreadSafeTransaction::clear(const KeyRef& key) {
+	Arena arena;
+	bufferMutation(MutationRef(MutationRef::ClearRange, key, keyAfter(key, arena)));
+}
 
-		    tr->clear(KeyRangeRef(b, e));
-	    },
-	    tr,
-	    &ISingleThreadTransaction::deferredError);
+void ThreadSafeTransaction::bufferMutation(MutationRef const& mutation) {
+	bool full;
+	{
+		ThreadSpinLockHolder holder(bufferedMutationsLock);
+		bufferedMutations.push_back_deep(bufferedMutations.arena(), mutation);
+		bufferedMutationBytes += mutation.expectedSize();
+		full = bufferedMutationBytes >= CLIENT_KNOBS->THREADSAFE_MUTATION_BATCH_BYTES;
+	}
+	if (full) {
+		flushMutations();
+	}
 }
 
-void ThreadSafeTransaction::clear(const KeyRef& key) {
-	Key k = key;
+void ThreadSafeTransaction::flushMutations() {
+	// The lock is held while handing the batch to the network thread, so that batches flushed by different threads
+	// are applied in the order their mutations were made
+	ThreadSpinLockHolder holder(bufferedMutationsLock);
+	if (bufferedMutations.empty()) {
+		return;
+	}
+	Standalone<VectorRef<MutationRef>> m = std::move(bufferedMutations);
+	bufferedMutations = Standalone<VectorRef<MutationRef>>();
+	bufferedMutationBytes = 0;
 
 	ISingleThreadTransaction* tr = this->tr;
-	onMainThreadVoid([tr, k]() { tr->clear(k); }, tr, &ISingleThreadTransaction::deferredError);
+	DatabaseContext* cx = this->cx;
+	onMainThreadVoid([tr, cx, m]() {
+		if (cx) {
+			++cx->transactionMutationBatches;
+			cx->transactionBatchedMutations += m.size();
+		}
+		applyMutations(tr, m);
+	});
+}
+
+ThreadFuture<RangeResult> ThreadSafeTransaction::batch(VectorRef<MutationRef> const& mutations,
+                                                      VectorRef<KeyRef> const& reads,
+                                                      bool snapshot) {
+	flushMutations();
+	Standalone<VectorRef<MutationRef>> m;
+	m.reserve(m.arena(), mutations.size());
+	for (const auto& mutation : mutations) {
+		m.push_back_deep(m.arena(), mutation);
+	}
+	Standalone<VectorRef<KeyRef>> r;
+	r.reserve(r.arena(), reads.size());
+	for (const auto& key : reads) {
+		r.push_back_deep(r.arena(), key);
+	}
+
+	ISingleThreadTransaction* tr = this->tr;
+	return onMainThread([tr, m, r, snapshot]() -> Future<RangeResult> {
+		applyMutations(tr, m);
+		tr->checkDeferredError();
+
+		std::vector<Future<Optional<Value>>> values;
+		values.reserve(r.size());
+		for (const auto& key : r) {
+			values.push_back(tr->get(key, Snapshot{ snapshot }));
+		}
+		return map(getAll(values), [r](std::vector<Optional<Value>> const& values) {
+			RangeResult result;
+			for (int i = 0; i < values.size(); ++i) {
+				if (values[i].present()) {
+					result.push_back_deep(result.arena(), KeyValueRef(r[i], values[i].get()));
+				}
+			}
+			return result;
+		});
+	});
 }
 
 ThreadFuture<Void> ThreadSafeTransaction::watch(const KeyRef& key) {
+	flushMutations();
 	Key k = key;
 
 	ISingleThreadTransaction* tr = this->tr;
@@ -657,6 +851,7 @@ ThreadFuture<Void> ThreadSafeTransaction::watch(const KeyRef& key) {
 }
 
 void ThreadSafeTransaction::addWriteConflictRange(const KeyRangeRef& keys) {
+	flushMutations();
 	KeyRange r = keys;
 
 	ISingleThreadTransaction* tr = this->tr;
@@ -664,6 +859,7 @@ void ThreadSafeTransaction::addWriteConflictRange(const KeyRangeRef& keys) {
 }
 
 ThreadFuture<Void> ThreadSafeTransaction::commit() {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	return onMainThread([tr]() -> Future<Void> {
 		tr->checkDeferredError();
@@ -680,6 +876,7 @@ Version ThreadSafeTransaction::getCommittedVersion() {
 }
 
 ThreadFuture<VersionVector> ThreadSafeTransaction::getVersionVector() {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	return onMainThread([tr]() -> Future<VersionVector> {
 		tr->checkDeferredError();
@@ -688,6 +885,7 @@ ThreadFuture<VersionVector> ThreadSafeTransaction::getVersionVector() {
 }
 
 ThreadFuture<SpanContext> ThreadSafeTransaction::getSpanContext() {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	return onMainThread([tr]() -> Future<SpanContext> {
 		tr->checkDeferredError();
@@ -696,6 +894,7 @@ ThreadFuture<SpanContext> ThreadSafeTransaction::getSpanContext() {
 }
 
 ThreadFuture<double> ThreadSafeTransaction::getTagThrottledDuration() {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	return onMainThread([tr]() -> Future<double> {
 		tr->checkDeferredError();
@@ -704,6 +903,7 @@ ThreadFuture<double> ThreadSafeTransaction::getTagThrottledDuration() {
 }
 
 ThreadFuture<int64_t> ThreadSafeTransaction::getTotalCost() {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	return onMainThread([tr]() -> Future<int64_t> {
 		tr->checkDeferredError();
@@ -712,6 +912,7 @@ ThreadFuture<int64_t> ThreadSafeTransaction::getTotalCost() {
 }
 
 ThreadFuture<int64_t> ThreadSafeTransaction::getApproximateSize() {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	return onMainThread([tr]() -> Future<int64_t> {
 		tr->checkDeferredError();
@@ -720,6 +921,7 @@ ThreadFuture<int64_t> ThreadSafeTransaction::getApproximateSize() {
 }
 
 ThreadFuture<Standalone<StringRef>> ThreadSafeTransaction::getVersionstamp() {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	return onMainThread([tr]() -> Future<Standalone<StringRef>> {
 		tr->checkDeferredError();
@@ -728,6 +930,7 @@ ThreadFuture<Standalone<StringRef>> ThreadSafeTransaction::getVersionstamp() {
 }
 
 void ThreadSafeTransaction::setOption(FDBTransactionOptions::Option option, Optional<StringRef> value) {
+	flushMutations();
 	auto itr = FDBTransactionOptions::optionInfo.find(option);
 	if (itr == FDBTransactionOptions::optionInfo.end()) {
 		TraceEvent("UnknownTransactionOption").detail("Option", option);
@@ -743,6 +946,7 @@ void ThreadSafeTransaction::setOption(FDBTransactionOptions::Option option, Opti
 }
 
 ThreadFuture<Void> ThreadSafeTransaction::checkDeferredError() {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	return onMainThread([tr]() {
 		try {
@@ -756,6 +960,7 @@ ThreadFuture<Void> ThreadSafeTransaction::checkDeferredError() {
 }
 
 ThreadFuture<Void> ThreadSafeTransaction::onError(Error const& e) {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	return onMainThread([tr, e]() { return tr->onError(e); });
 }
@@ -768,20 +973,34 @@ void ThreadSafeTransaction::operator=(ThreadSafeTransaction&& r) noexcept {
 	tr = r.tr;
 	r.tr = nullptr;
 	initialized = std::move(r.initialized);
+	readVersionQueue = std::move(r.readVersionQueue);
+	cx = r.cx;
+	bufferedMutations = std::move(r.bufferedMutations);
+	bufferedMutationBytes = r.bufferedMutationBytes;
 }
 
 ThreadSafeTransaction::ThreadSafeTransaction(ThreadSafeTransaction&& r) noexcept {
 	tr = r.tr;
 	r.tr = nullptr;
 	initialized = std::move(r.initialized);
+	readVersionQueue = std::move(r.readVersionQueue);
+	cx = r.cx;
+	bufferedMutations = std::move(r.bufferedMutations);
+	bufferedMutationBytes = r.bufferedMutationBytes;
 }
 
 void ThreadSafeTransaction::reset() {
+	{
+		ThreadSpinLockHolder holder(bufferedMutationsLock);
+		bufferedMutations = Standalone<VectorRef<MutationRef>>();
+		bufferedMutationBytes = 0;
+	}
 	ISingleThreadTransaction* tr = this->tr;
 	onMainThreadVoid([tr]() { tr->reset(); });
 }
 
 void ThreadSafeTransaction::debugTrace(BaseTraceEvent&& ev) {
+	flushMutations();
 	if (ev.isEnabled()) {
 		ISingleThreadTransaction* tr = this->tr;
 		std::shared_ptr<BaseTraceEvent> evPtr = std::make_shared<BaseTraceEvent>(std::move(ev));
@@ -790,6 +1009,7 @@ void ThreadSafeTransaction::debugTrace(BaseTraceEvent&& ev) {
 };
 
 void ThreadSafeTransaction::debugPrint(std::string const& message) {
+	flushMutations();
 	ISingleThreadTransaction* tr = this->tr;
 	onMainThreadVoid([tr, message]() { tr->debugPrint(message); });
 }
@@ -29,6 +29,7 @@
 #include <functional>
 #include <iomanip>
 #include <memory>
+#include "flow/IThreadPool.h"
 #include "flow/IUDPSocket.h"
 
 #include "flow/actorcompiler.h" // has to be last include
@@ -320,6 +321,434 @@ private:
 };
 #endif
 
+// A finished span, with its strings and vectors copied into an arena owned by whoever holds it
+struct SpanData {
+	SpanContext context;
+	uint64_t parentSpanID = 0;
+	StringRef name;
+	SpanKind kind = SpanKind::INTERNAL;
+	SpanStatus status = SpanStatus::UNSET;
+	double begin = 0.0, end = 0.0;
+	SmallVectorRef<SpanContext> links;
+	SmallVectorRef<KeyValueRef> attributes;
+	SmallVectorRef<SpanEventRef> events;
+
+	SpanData(Arena& arena, const Span& span)
+	  : context(span.context), parentSpanID(span.parentContext.spanID), name(arena, span.location.name),
+	    kind(span.kind), status(span.status), begin(span.begin), end(span.end), links(arena, span.links),
+	    attributes(arena, span.attributes), events(arena, span.events) {}
+};
+
+// Spans handed to the export thread together. The arena holds the memory of all of them, and is only ever referenced
+// by the batch, so the batch can be moved to another thread.
+struct SpanBatch {
+	Arena arena;
+	std::vector<SpanData> spans;
+};
+
+// Tail-based sampling: keeps the spans of a trace until one of them is slow or failed, and then adds them all to the
+// batch being built, or until the trace's local root span ends or the trace has waited bufferTime, and then drops them.
+// Sampling is per process, so spans of a trace that are not slow or failed are only kept by the processes that saw the
+// spans which were.
+struct TailSampler {
+	struct PendingTrace {
+		Arena arena;
+		std::vector<SpanData> spans;
+		double firstTime = 0.0;
+		bool keep = false;
+	};
+
+	TailSampler(double latency, double bufferTime, int maxPendingSpans)
+	  : latency(latency), bufferTime(bufferTime), maxPendingSpans(maxPendingSpans) {}
+
+	void add(const Span& span, SpanBatch& batch) {
+		auto [it, inserted] = traces.try_emplace(span.context.traceID);
+		PendingTrace& trace = it->second;
+		if (inserted) {
+			trace.firstTime = span.end;
+		}
+		if (!trace.keep && (span.status == SpanStatus::ERR || span.end - span.begin >= latency)) {
+			keep(trace, batch);
+		}
+
+		if (trace.keep) {
+			batch.spans.emplace_back(batch.arena, span);
+		} else if (pendingSpans >= maxPendingSpans) {
+			++droppedSpans;
+		} else {
+			trace.spans.emplace_back(trace.arena, span);
+			++pendingSpans;
+		}
+
+		// The local root span of a trace ends after its other local spans, so they have all been seen
+		if (!span.parentContext.isValid()) {
+			erase(it);
+		}
+	}
+
+	// Drops the traces that have waited bufferTime as of now
+	void expire(double now) {
+		for (auto it = traces.begin(); it != traces.end();) {
+			if (it->second.firstTime + bufferTime <= now) {
+				erase(it++);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	std::unordered_map<UID, PendingTrace> traces;
+	double latency;
+	double bufferTime;
+	int maxPendingSpans;
+	int pendingSpans = 0;
+	int64_t keptTraces = 0;
+	int64_t droppedTraces = 0;
+	int64_t droppedSpans = 0;
+
+private:
+	void keep(PendingTrace& trace, SpanBatch& batch) {
+		// The batch takes over the memory of the trace's spans; the trace stops referencing it
+		batch.arena.dependsOn(trace.arena);
+		batch.spans.insert(batch.spans.end(), trace.spans.begin(), trace.spans.end());
+		pendingSpans -= trace.spans.size();
+		trace.spans.clear();
+		trace.arena = Arena();
+		trace.keep = true;
+		++keptTraces;
+	}
+
+	void erase(std::unordered_map<UID, PendingTrace>::iterator it) {
+		if (!it->second.keep) {
+			pendingSpans -= it->second.spans.size();
+			++droppedTraces;
+		}
+		traces.erase(it);
+	}
+};
+
+// Serializes spans in the shape of an OTLP ExportTraceServiceRequest as MessagePack rather than JSON, with the field
+// names and enum values of the OTLP JSON encoding, so a collector can convert each packet with a generic MessagePack
+// to JSON step. See
+// https://github.com/open-telemetry/opentelemetry-proto/blob/main/opentelemetry/proto/trace/v1/trace.proto
+namespace OTLP {
+
+inline void serialize_string(const char* str, MsgpackBuffer& buf) {
+	::serialize_string(reinterpret_cast<const uint8_t*>(str), strlen(str), buf);
+}
+
+inline void serialize_string(StringRef str, MsgpackBuffer& buf) {
+	::serialize_string(str.begin(), str.size(), buf);
+}
+
+inline void serialize_trace_id(const UID& traceID, MsgpackBuffer& buf) {
+	serialize_string(format("%016llx%016llx", traceID.first(), traceID.second()), buf);
+}
+
+inline void serialize_span_id(uint64_t spanID, MsgpackBuffer& buf) {
+	if (spanID == 0) {
+		serialize_string("", buf);
+	} else {
+		serialize_string(format("%016llx", spanID), buf);
+	}
+}
+
+inline void serialize_time(double time, MsgpackBuffer& buf) {
+	serialize_value(static_cast<uint64_t>(time * 1e9), buf, 0xcf);
+}
+
+inline void serialize_attributes(const SmallVectorRef<KeyValueRef>& attributes, MsgpackBuffer& buf) {
+	serialize_array_header(attributes.size(), buf);
+	for (const auto& [key, value] : attributes) {
+		serialize_map_header(2, buf);
+		serialize_string("key", buf);
+		serialize_string(key, buf);
+		serialize_string("value", buf);
+		serialize_map_header(1, buf);
+		serialize_string("stringValue", buf);
+		serialize_string(value, buf);
+	}
+}
+
+// OTLP numbers span kinds from SPAN_KIND_UNSPECIFIED = 0, and puts SERVER before CLIENT
+inline uint8_t spanKind(SpanKind kind) {
+	switch (kind) {
+	case SpanKind::INTERNAL:
+		return 1;
+	case SpanKind::SERVER:
+		return 2;
+	case SpanKind::CLIENT:
+		return 3;
+	case SpanKind::PRODUCER:
+		return 4;
+	case SpanKind::CONSUMER:
+		return 5;
+	}
+	return 0;
+}
+
+inline void serialize_span(const SpanData& span, MsgpackBuffer& buf) {
+	serialize_map_header(11, buf);
+	serialize_string("traceId", buf);
+	serialize_trace_id(span.context.traceID, buf);
+	serialize_string("spanId", buf);
+	serialize_span_id(span.context.spanID, buf);
+	serialize_string("parentSpanId", buf);
+	serialize_span_id(span.parentSpanID, buf);
+	serialize_string("name", buf);
+	serialize_string(span.name, buf);
+	serialize_string("kind", buf);
+	serialize_value<uint8_t>(spanKind(span.kind), buf, 0xcc);
+	serialize_string("startTimeUnixNano", buf);
+	serialize_time(span.begin, buf);
+	serialize_string("endTimeUnixNano", buf);
+	serialize_time(span.end, buf);
+	serialize_string("attributes", buf);
+	serialize_attributes(span.attributes, buf);
+	serialize_string("events", buf);
+	serialize_array_header(span.events.size(), buf);
+	for (const auto& event : span.events) {
+		serialize_map_header(3, buf);
+		serialize_string("timeUnixNano", buf);
+		serialize_time(event.time, buf);
+		serialize_string("name", buf);
+		serialize_string(event.name, buf);
+		serialize_string("attributes", buf);
+		serialize_attributes(event.attributes, buf);
+	}
+	serialize_string("links", buf);
+	serialize_array_header(span.links.size(), buf);
+	for (const auto& link : span.links) {
+		serialize_map_header(2, buf);
+		serialize_string("traceId", buf);
+		serialize_trace_id(link.traceID, buf);
+		serialize_string("spanId", buf);
+		serialize_span_id(link.spanID, buf);
+	}
+	// SpanStatus and the OTLP status codes have the same values
+	serialize_string("status", buf);
+	serialize_map_header(1, buf);
+	serialize_string("code", buf);
+	serialize_value<uint8_t>(static_cast<uint8_t>(span.status), buf, 0xcc);
+}
+
+// Writes everything of a request up to its array of spans, whose header is written with a count of zero, and returns
+// the offset of the header for finish_request()
+inline size_t start_request(MsgpackBuffer& buf) {
+	serialize_map_header(1, buf);
+	serialize_string("resourceSpans", buf);
+	serialize_array_header(1, buf);
+	serialize_map_header(2, buf);
+	serialize_string("resource", buf);
+	serialize_map_header(1, buf);
+	serialize_string("attributes", buf);
+	serialize_array_header(1, buf);
+	serialize_map_header(2, buf);
+	serialize_string("key", buf);
+	serialize_string("service.name", buf);
+	serialize_string("value", buf);
+	serialize_map_header(1, buf);
+	serialize_string("stringValue", buf);
+	serialize_string("foundationdb", buf);
+	serialize_string("scopeSpans", buf);
+	serialize_array_header(1, buf);
+	serialize_map_header(2, buf);
+	serialize_string("scope", buf);
+	serialize_map_header(1, buf);
+	serialize_string("name", buf);
+	serialize_string("fdbclient", buf);
+	serialize_string("spans", buf);
+	size_t countOffset = buf.data_size;
+	buf.write_byte(0xdc);
+	buf.write_byte(0);
+	buf.write_byte(0);
+	return countOffset;
+}
+
+inline void finish_request(MsgpackBuffer& buf, size_t countOffset, uint16_t count) {
+	buf.edit_byte(static_cast<uint8_t>(count >> 8), countOffset + 1);
+	buf.edit_byte(static_cast<uint8_t>(count), countOffset + 2);
+}
+
+} // namespace OTLP
+
+#ifndef WIN32
+// Spans exported in one packet, short of the maximum UDP payload so that packets are never fragmented into many
+constexpr int kMaxExportPacketSize = 8192;
+
+struct SpanExportStats : ThreadSafeReferenceCounted<SpanExportStats> {
+	std::atomic<int> pendingBatches = 0;
+	std::atomic<int64_t> sentPackets = 0;
+	std::atomic<int64_t> failedPackets = 0;
+};
+
+// Serializes batches of spans and sends them to the socket of the tracer, on a thread of its own so that neither costs
+// the network thread anything
+struct SpanExporter final : IThreadPoolReceiver {
+	explicit SpanExporter(Reference<SpanExportStats> stats) : stats(stats) {
+		request = MsgpackBuffer{ .buffer = std::make_unique<uint8_t[]>(kMaxExportPacketSize),
+			                     .data_size = 0,
+			                     .buffer_size = kMaxExportPacketSize };
+		span = MsgpackBuffer{ .buffer = std::make_unique<uint8_t[]>(kTraceBufferSize),
+			                  .data_size = 0,
+			                  .buffer_size = kTraceBufferSize };
+	}
+
+	void init() override {}
+
+	struct ExportBatch final : TypedAction<SpanExporter, ExportBatch> {
+		SpanBatch batch;
+		int socketFd;
+
+		ExportBatch(SpanBatch&& batch, int socketFd) : batch(std::move(batch)), socketFd(socketFd) {}
+		double getTimeEstimate() const override { return .001; }
+	};
+
+	void action(ExportBatch& a) {
+		size_t countOffset = OTLP::start_request(request);
+		size_t emptySize = request.data_size;
+		int count = 0;
+		for (const auto& data : a.batch.spans) {
+			span.reset();
+			OTLP::serialize_span(data, span);
+			if (count > 0 && request.data_size + span.data_size > kMaxExportPacketSize) {
+				OTLP::finish_request(request, countOffset, count);
+				write(a.socketFd);
+				countOffset = OTLP::start_request(request);
+				count = 0;
+			}
+			request.write_bytes(span.buffer.get(), span.data_size);
+			++count;
+		}
+		if (request.data_size > emptySize) {
+			OTLP::finish_request(request, countOffset, count);
+			write(a.socketFd);
+		}
+		request.reset();
+		--stats->pendingBatches;
+	}
+
+	void write(int socketFd) {
+		if (send(socketFd, request.buffer.get(), request.data_size, MSG_DONTWAIT) == -1) {
+			++stats->failedPackets;
+		} else {
+			++stats->sentPackets;
+		}
+		request.reset();
+	}
+
+	Reference<SpanExportStats> stats;
+	MsgpackBuffer request;
+	MsgpackBuffer span;
+};
+
+ACTOR Future<Void> batchedTracerFlusher(std::function<void()> flush) {
+	loop {
+		wait(delay(FLOW_KNOBS->TRACING_BATCH_INTERVAL));
+		flush();
+	}
+}
+
+// Sends spans as UDP packets like FastUDPTracer, but only copies them on the network thread. They are serialized and
+// sent in batches by an export thread, in the OTLP shape of the OTLP namespace above, and with TRACING_TAIL_SAMPLING
+// only for traces which had a slow or failed span.
+struct BatchedUDPTracer final : ITracer {
+	BatchedUDPTracer()
+	  : stats(makeReference<SpanExportStats>()),
+	    sampler(FLOW_KNOBS->TRACING_TAIL_LATENCY,
+	            FLOW_KNOBS->TRACING_TAIL_BUFFER_TIME,
+	            FLOW_KNOBS->TRACING_TAIL_MAX_PENDING_SPANS) {}
+
+	~BatchedUDPTracer() override {
+		if (exporter) {
+			exporter->stop();
+		}
+	}
+
+	TracerType type() const override { return TracerType::NETWORK_BATCHED; }
+
+	void trace(Span const& span) override {
+		prepare();
+		if (FLOW_KNOBS->TRACING_TAIL_SAMPLING) {
+			sampler.add(span, batch);
+		} else {
+			batch.spans.emplace_back(batch.arena, span);
+		}
+		if (batch.spans.size() >= static_cast<size_t>(FLOW_KNOBS->TRACING_BATCH_SPANS)) {
+			flush();
+		}
+	}
+
+	void prepare() {
+		if (flusher.isValid()) {
+			return;
+		}
+		flusher = batchedTracerFlusher([this]() {
+			flush();
+			sampler.expire(g_network->now());
+			logStats();
+		});
+		std::string destAddr = g_network->isSimulated() ? "127.0.0.1" : FLOW_KNOBS->TRACING_UDP_LISTENER_ADDR;
+		socket = INetworkConnections::net()->createUDPSocket(
+		    NetworkAddress::parse(destAddr + ":" + std::to_string(FLOW_KNOBS->TRACING_UDP_LISTENER_PORT)));
+		if (g_network->isSimulated()) {
+			exporter = Reference<IThreadPool>(new DummyThreadPool());
+		} else {
+			exporter = createGenericThreadPool();
+		}
+		exporter->addThread(new SpanExporter(stats), "fdb-span-export");
+	}
+
+	void flush() {
+		if (batch.spans.empty()) {
+			return;
+		}
+		if (!socket.isReady() || socket.isError()) {
+			unreadySpans += batch.spans.size();
+		} else if (stats->pendingBatches >= FLOW_KNOBS->TRACING_MAX_PENDING_BATCHES) {
+			droppedSpans += batch.spans.size();
+		} else {
+			++stats->pendingBatches;
+			exportedSpans += batch.spans.size();
+			exporter->post(new SpanExporter::ExportBatch(std::move(batch), socket.get()->native_handle()));
+		}
+		batch = SpanBatch();
+	}
+
+	void logStats() {
+		if (g_network->now() < nextStatsTime) {
+			return;
+		}
+		nextStatsTime = g_network->now() + kQueueSizeLogInterval;
+		TraceEvent("TracingBatchedSpanStats")
+		    .detail("ExportedSpans", exportedSpans)
+		    .detail("UnreadySpans", unreadySpans)
+		    .detail("DroppedSpans", droppedSpans + sampler.droppedSpans)
+		    .detail("PendingBatches", stats->pendingBatches.load())
+		    .detail("SentPackets", stats->sentPackets.load())
+		    .detail("FailedPackets", stats->failedPackets.load())
+		    .detail("PendingTraces", sampler.traces.size())
+		    .detail("PendingTraceSpans", sampler.pendingSpans)
+		    .detail("KeptTraces", sampler.keptTraces)
+		    .detail("DroppedTraces", sampler.droppedTraces);
+	}
+
+private:
+	Reference<SpanExportStats> stats;
+	TailSampler sampler;
+	SpanBatch batch;
+
+	int64_t exportedSpans = 0;
+	int64_t unreadySpans = 0;
+	int64_t droppedSpans = 0;
+	double nextStatsTime = 0.0;
+
+	Future<Reference<IUDPSocket>> socket;
+	Reference<IThreadPool> exporter;
+	Future<Void> flusher;
+};
+#endif
+
 ITracer* g_tracer = new NoopTracer();
 
 #ifdef NO_INTELLISENSE
@@ -341,6 +770,11 @@ void openTracer(TracerType type) {
 	case TracerType::NETWORK_LOSSY:
 #ifndef WIN32
 		g_tracer = new FastUDPTracer{};
+#endif
+		break;
+	case TracerType::NETWORK_BATCHED:
+#ifndef WIN32
+		g_tracer = new BatchedUDPTracer{};
 #endif
 		break;
 	case TracerType::SIM_END:
@@ -706,3 +1140,106 @@ TEST_CASE("/flow/Tracing/FastUDPMessagePackEncoding") {
 	return Void();
 };
 #endif
+
+TEST_CASE("/flow/Tracing/TailSampling") {
+	TailSampler sampler(0.5, 5.0, 100);
+	SpanBatch batch;
+	auto finish = [&](Span& span, double duration, SpanStatus status = SpanStatus::OK) {
+		span.begin = 100.0;
+		span.end = 100.0 + duration;
+		span.status = status;
+		sampler.add(span, batch);
+	};
+
+	// A fast trace is dropped when its root span ends
+	Span fastRoot(SpanContext(UID(1, 1), 1, TraceFlags::sampled), "root"_loc);
+	Span fastChild("child"_loc, fastRoot.context);
+	finish(fastChild, 0.1);
+	ASSERT_EQ(sampler.pendingSpans, 1);
+	finish(fastRoot, 0.2);
+	ASSERT(batch.spans.empty());
+	ASSERT(sampler.traces.empty());
+	ASSERT_EQ(sampler.pendingSpans, 0);
+	ASSERT_EQ(sampler.droppedTraces, 1);
+
+	// A slow span keeps the spans of its trace seen so far, and those seen after it
+	Span slowRoot(SpanContext(UID(2, 2), 2, TraceFlags::sampled), "root"_loc);
+	Span before("before"_loc, slowRoot.context);
+	Span slow("slow"_loc, slowRoot.context);
+	Span after("after"_loc, slowRoot.context);
+	finish(before, 0.1);
+	finish(slow, 0.7);
+	ASSERT(batch.spans.size() == 2);
+	ASSERT(batch.spans[0].name == "before"_sr);
+	ASSERT(batch.spans[1].name == "slow"_sr);
+	finish(after, 0.1);
+	finish(slowRoot, 0.9);
+	ASSERT(batch.spans.size() == 4);
+	ASSERT(batch.spans[3].name == "root"_sr);
+	ASSERT_EQ(sampler.keptTraces, 1);
+
+	// So does a failed span
+	Span failedRoot(SpanContext(UID(3, 3), 3, TraceFlags::sampled), "root"_loc);
+	finish(failedRoot, 0.1, SpanStatus::ERR);
+	ASSERT(batch.spans.size() == 5);
+	ASSERT_EQ(sampler.keptTraces, 2);
+
+	// Spans whose root is in another process are dropped once they have waited long enough
+	Span remote("remote"_loc, SpanContext(UID(4, 4), 4, TraceFlags::sampled));
+	finish(remote, 0.1);
+	sampler.expire(104.0);
+	ASSERT(sampler.traces.size() == 1);
+	sampler.expire(106.0);
+	ASSERT(sampler.traces.empty());
+	ASSERT_EQ(sampler.pendingSpans, 0);
+	ASSERT_EQ(sampler.droppedTraces, 2);
+
+	// Beyond maxPendingSpans, spans are dropped rather than kept waiting
+	TailSampler small(0.5, 5.0, 1);
+	Span first("first"_loc, SpanContext(UID(5, 5), 5, TraceFlags::sampled));
+	Span second("second"_loc, SpanContext(UID(5, 5), 5, TraceFlags::sampled));
+	first.begin = second.begin = first.end = second.end = 100.0;
+	small.add(first, batch);
+	small.add(second, batch);
+	ASSERT_EQ(small.pendingSpans, 1);
+	ASSERT_EQ(small.droppedSpans, 1);
+	return Void();
+}
+
+TEST_CASE("/flow/Tracing/OTLPEncoding") {
+	Span span("otlp_span"_loc, SpanContext(UID(0x100, 0x101), 0x200, TraceFlags::sampled));
+	span.begin = 1.5;
+	span.end = 2.5;
+	Arena arena;
+	SpanData data(arena, span);
+	auto buf = MsgpackBuffer{ .buffer = std::make_unique<uint8_t[]>(kTraceBufferSize),
+		                      .data_size = 0,
+		                      .buffer_size = kTraceBufferSize };
+	OTLP::serialize_span(data, buf);
+	uint8_t* bytes = buf.buffer.get();
+	ASSERT(bytes[0] == 0b10001011); // 11 element map
+	ASSERT(readMPString(&bytes[1]) == "traceId");
+	ASSERT(bytes[9] == 0xd9 && bytes[10] == 32); // 32 character hex string
+	ASSERT(readMPString(&bytes[11], 32) == "00000000000001000000000000000101");
+	ASSERT(readMPString(&bytes[43]) == "spanId");
+	ASSERT(readMPString(&bytes[50]) == format("%016llx", span.context.spanID));
+	ASSERT(readMPString(&bytes[67]) == "parentSpanId");
+	ASSERT(readMPString(&bytes[80]) == "0000000000000200");
+	ASSERT(readMPString(&bytes[97]) == "name");
+	ASSERT(readMPString(&bytes[102]) == "otlp_span");
+	ASSERT(readMPString(&bytes[112]) == "kind");
+	ASSERT(bytes[117] == 0xcc && bytes[118] == 2); // SPAN_KIND_SERVER
+	ASSERT(readMPString(&bytes[119]) == "startTimeUnixNano");
+	ASSERT(bytes[137] == 0xcf && swapUint64BE(&bytes[138]) == 1500000000);
+	ASSERT(readMPString(&bytes[146]) == "endTimeUnixNano");
+	ASSERT(bytes[162] == 0xcf && swapUint64BE(&bytes[163]) == 2500000000);
+
+	// The count of spans in a request is filled in once they have all been written
+	buf.reset();
+	size_t countOffset = OTLP::start_request(buf);
+	ASSERT(buf.data_size == countOffset + 3);
+	OTLP::finish_request(buf, countOffset, 0x123);
+	ASSERT(bytes[countOffset] == 0xdc);
+	ASSERT(swapUint16BE(&bytes[countOffset + 1]) == 0x123);
+	return Void();
+}
@@ -38,10 +38,20 @@ static double bigEndianDouble(double orig) {
 	return *(double*)&big;
 }
 
+// Returns the position of the null ending the string that starts at offset, skipping escaped nulls. Only the nulls are
+// looked at, so memchr can skip over the bytes between them.
 static size_t findStringTerminator(const StringRef data, size_t offset) {
 	size_t i = offset;
-	while (i < data.size() - 1 && !(data[i] == '\x00' && data[i + 1] != (uint8_t)'\xff')) {
-		i += (data[i] == '\x00' ? 2 : 1);
+	while (i < data.size() - 1) {
+		const uint8_t* null = (const uint8_t*)memchr(data.begin() + i, '\x00', data.size() - 1 - i);
+		if (!null) {
+			return data.size() - 1;
+		}
+		i = null - data.begin();
+		if (data[i + 1] != (uint8_t)'\xff') {
+			return i;
+		}
+		i += 2;
 	}
 
 	return i;
@@ -61,8 +71,14 @@ static void adjustFloatingPoint(uint8_t* bytes, size_t size, bool encode) {
 	}
 }
 
-Tuple::Tuple(StringRef const& str, bool exclude_incomplete, bool include_user_type) {
-	data.append(data.arena(), str.begin(), str.size());
+Tuple::Tuple(StringRef const& str, bool exclude_incomplete, bool include_user_type, bool copy) {
+	if (copy) {
+		data.append(data.arena(), str.begin(), str.size());
+	} else {
+		// Appending to the tuple later moves it to memory of its own, since there is no spare capacity here
+		data = Standalone<VectorRef<uint8_t>>(VectorRef<uint8_t>(const_cast<uint8_t*>(str.begin()), str.size()),
+		                                      Arena());
+	}
 
 	size_t i = 0;
 	while (i < data.size()) {
@@ -99,6 +115,10 @@ Tuple Tuple::unpack(StringRef const& str, bool exclude_incomplete) {
 	return Tuple(str, exclude_incomplete);
 }
 
+Tuple Tuple::unpackView(StringRef const& str, bool exclude_incomplete) {
+	return Tuple(str, exclude_incomplete, false, false);
+}
+
 std::string Tuple::tupleToString(const Tuple& tuple) {
 	std::string str;
 	if (tuple.size() > 1) {
@@ -171,20 +191,19 @@ Tuple& Tuple::append(TupleVersionstamp const& vs) {
 Tuple& Tuple::append(StringRef const& str, bool utf8) {
 	offsets.push_back(data.size());
 
-	const uint8_t utfChar = uint8_t(utf8 ? '\x02' : '\x01');
-	data.append(data.arena(), &utfChar, 1);
+	// Room for the string with no nulls to escape, so that it is copied in runs between nulls without reallocating
+	data.reserve(data.arena(), data.size() + str.size() + 2);
+	data.push_back(data.arena(), uint8_t(utf8 ? '\x02' : '\x01'));
 
-	size_t lastPos = 0;
-	for (size_t pos = 0; pos < str.size(); ++pos) {
-		if (str[pos] == '\x00') {
-			data.append(data.arena(), str.begin() + lastPos, pos - lastPos);
-			data.push_back(data.arena(), (uint8_t)'\x00');
-			data.push_back(data.arena(), (uint8_t)'\xff');
-			lastPos = pos + 1;
-		}
+	const uint8_t* begin = str.begin();
+	const uint8_t* null;
+	while (begin != str.end() && (null = (const uint8_t*)memchr(begin, '\x00', str.end() - begin))) {
+		data.append(data.arena(), begin, null - begin + 1);
+		data.push_back(data.arena(), (uint8_t)'\xff');
+		begin = null + 1;
 	}
 
-	data.append(data.arena(), str.begin() + lastPos, str.size() - lastPos);
+	data.append(data.arena(), begin, str.end() - begin);
 	data.push_back(data.arena(), (uint8_t)'\x00');
 
 	return *this;
@@ -202,7 +221,6 @@ Tuple& Tuple::appendRaw(StringRef const& str) {
 }
 
 Tuple& Tuple::append(int64_t value) {
-	uint64_t swap = value;
 	bool neg = false;
 
 	offsets.push_back(data.size());
@@ -212,17 +230,14 @@ Tuple& Tuple::append(int64_t value) {
 		neg = true;
 	}
 
-	swap = bigEndian64(value);
+	// The encoding drops the leading bytes that are all sign bits, 0xff for negative numbers and 0 otherwise
+	const uint64_t magnitude = neg ? ~(uint64_t)value : (uint64_t)value;
+	const int len = magnitude ? (64 - clzll(magnitude) + 7) / 8 : 0;
+	const uint64_t swap = bigEndian64(value);
 
-	for (int i = 0; i < 8; i++) {
-		if (((uint8_t*)&swap)[i] != (neg ? 255 : 0)) {
-			data.push_back(data.arena(), (uint8_t)(20 + (8 - i) * (neg ? -1 : 1)));
-			data.append(data.arena(), ((const uint8_t*)&swap) + i, 8 - i);
-			return *this;
-		}
-	}
-
-	data.push_back(data.arena(), (uint8_t)'\x14');
+	data.reserve(data.arena(), data.size() + len + 1);
+	data.push_back(data.arena(), (uint8_t)(20 + len * (neg ? -1 : 1)));
+	data.append(data.arena(), ((const uint8_t*)&swap) + 8 - len, len);
 	return *this;
 }
 
@@ -330,24 +345,25 @@ Standalone<StringRef> Tuple::getString(size_t index) const {
 		e = data.size();
 	}
 
+	const uint8_t* begin = data.begin() + b;
+	const uint8_t* end = data.begin() + e;
+	const uint8_t* null = begin != end ? (const uint8_t*)memchr(begin, '\x00', end - begin) : nullptr;
+	if (!null || null + 1 == end) {
+		// Without escaped nulls the string is returned where it is, sharing the tuple's memory
+		return Standalone<StringRef>(StringRef(begin, (null ? null : end) - begin), data.arena());
+	}
+
 	Standalone<StringRef> result;
 	VectorRef<uint8_t> staging;
+	staging.reserve(result.arena(), end - begin);
 
-	for (size_t i = b; i < e; ++i) {
-		if (data[i] == '\x00') {
-			staging.append(result.arena(), data.begin() + b, i - b);
-			++i;
-			b = i + 1;
-
-			if (i < e) {
-				staging.push_back(result.arena(), '\x00');
-			}
-		}
-	}
-
-	if (b < e) {
-		staging.append(result.arena(), data.begin() + b, e - b);
+	while (null && null + 1 != end) {
+		// Keep the null and skip the \xff escaping it
+		staging.append(result.arena(), begin, null - begin + 1);
+		begin = null + 2;
+		null = begin != end ? (const uint8_t*)memchr(begin, '\x00', end - begin) : nullptr;
 	}
+	staging.append(result.arena(), begin, (null ? null : end) - begin);
 
 	result.StringRef::operator=(StringRef(staging.begin(), staging.size()));
 	return result;
@@ -601,3 +617,40 @@ TEST_CASE("/fdbclient/Tuple/unpack") {
 
 	return Void();
 }
+
+TEST_CASE("/fdbclient/Tuple/escaping") {
+	const StringRef strings[] = { ""_sr, "\x00"_sr, "a\x00"_sr, "\x00\x00"_sr, "a\x00\xff\x00"_sr, "abc"_sr };
+	const int64_t ints[] = { 0, 1, -1, 255, -255, 256, -256, std::numeric_limits<int64_t>::max(),
+		                     std::numeric_limits<int64_t>::min() + 1 };
+
+	Tuple t;
+	for (const auto& s : strings) {
+		t.append(s);
+	}
+	for (int64_t i : ints) {
+		t.append(i);
+	}
+	ASSERT(t.pack() == "\x01\x00\x01\x00\xff\x00\x01\x61\x00\xff\x00\x01\x00\xff\x00\xff\x00"
+	                   "\x01\x61\x00\xff\xff\x00\xff\x00\x01\x61\x62\x63\x00"
+	                   "\x14\x15\x01\x13\xfe\x15\xff\x13\x00\x16\x01\x00\x12\xfe\xff"
+	                   "\x1c\x7f\xff\xff\xff\xff\xff\xff\xff\x0c\x80\x00\x00\x00\x00\x00\x00\x00"_sr);
+
+	for (Tuple u : { Tuple::unpack(t.pack()), Tuple::unpackView(t.pack()) }) {
+		ASSERT(u.size() == t.size());
+		for (int i = 0; i < std::size(strings); ++i) {
+			ASSERT(u.getString(i) == strings[i]);
+		}
+		for (int i = 0; i < std::size(ints); ++i) {
+			ASSERT(u.getInt(std::size(strings) + i) == ints[i]);
+		}
+	}
+
+	// Appending to a view moves it to memory of its own rather than writing past the viewed bytes
+	Standalone<StringRef> packed = Tuple::makeTuple("a"_sr, "b"_sr).pack();
+	Tuple view = Tuple::unpackView(packed.substr(0, 3));
+	view.append("c"_sr);
+	ASSERT(view.pack() == Tuple::makeTuple("a"_sr, "c"_sr).pack());
+	ASSERT(packed == Tuple::makeTuple("a"_sr, "b"_sr).pack());
+
+	return Void();
+}
@@ -375,6 +375,49 @@ TEST_CASE("/fdbclient/VersionVector/testI") {
 	return Void();
 }
 
+TEST_CASE("/fdbclient/VersionVector/tagIdGaps") {
+	Arena arena;
+	TestContextArena context{ arena };
+
+	// 1000 storage servers with consecutive tag ids in one region. Each tag id is encoded as a one byte gap from the
+	// previous one, rather than in two bytes.
+	VersionVector denseVV;
+	Version version = 100000;
+	for (int i = 0; i < 1000; i++) {
+		denseVV.setVersion(Tag(0, i), ++version);
+	}
+	size_t size = dynamic_size_traits<VersionVector>::size(denseVV, context);
+	ASSERT_EQ(size, denseVV.getEncodedSize());
+	ASSERT_LT(size, 1000 * (sizeof(uint16_t) + sizeof(uint16_t)));
+
+	uint8_t* buf = context.allocate(size);
+	dynamic_size_traits<VersionVector>::save(buf, denseVV, context);
+	VersionVector deserializedVV;
+	dynamic_size_traits<VersionVector>::load(buf, size, deserializedVV, context);
+	ASSERT(denseVV.compare(deserializedVV));
+
+	// Gaps that take one, two and three bytes, in several localities
+	VersionVector sparseVV;
+	for (int8_t locality : { -2, 0, 1 }) {
+		std::set<Tag> tags;
+		for (int id = 0; id < 300; id++) {
+			tags.emplace(locality, id);
+		}
+		for (int id : { 1000, 20000, 65000, UINT16_MAX }) {
+			tags.emplace(locality, id);
+		}
+		sparseVV.setVersion(tags, ++version);
+	}
+	size = dynamic_size_traits<VersionVector>::size(sparseVV, context);
+	buf = context.allocate(size);
+	dynamic_size_traits<VersionVector>::save(buf, sparseVV, context);
+	VersionVector deserializedSparseVV;
+	dynamic_size_traits<VersionVector>::load(buf, size, deserializedSparseVV, context);
+	ASSERT(sparseVV.compare(deserializedSparseVV));
+
+	return Void();
+}
+
 } // namespace unit_tests
 
 void forceLinkVersionVectorTests() {}
@@ -19,12 +19,13 @@
  */
 
 #include "fdbclient/VersionedMap.h"
+#include "fdbclient/BTreeVersionedMap.h"
 #include "flow/TreeBenchmark.h"
 #include "flow/UnitTest.h"
 
-template <typename K>
+template <typename K, template <class, class> class Map = VersionedMap>
 struct VersionedMapHarness {
-	using map = VersionedMap<K, int>;
+	using map = Map<K, int>;
 	using key_type = K;
 
 	struct result {
@@ -74,4 +75,181 @@ TEST_CASE("performance/map/StringRef/VersionedMap") {
 	return Void();
 }
 
+TEST_CASE("performance/map/int/BTreeVersionedMap") {
+	VersionedMapHarness<int, BTreeVersionedMap> tree;
+
+	treeBenchmark(tree, *randomInt);
+
+	return Void();
+}
+
+TEST_CASE("performance/map/StringRef/BTreeVersionedMap") {
+	Arena arena;
+	VersionedMapHarness<StringRef, BTreeVersionedMap> tree;
+
+	treeBenchmark(tree, [&arena]() { return randomStr(arena); });
+
+	return Void();
+}
+
+namespace {
+
+template <class A, class B>
+void checkSameItems(A a, B b) {
+	auto i = a.begin();
+	auto j = b.begin();
+	for (; i != a.end(); ++i, ++j) {
+		ASSERT(j != b.end());
+		ASSERT(i.key() == j.key() && *i == *j && i.insertVersion() == j.insertVersion());
+	}
+	ASSERT(j == b.end());
+}
+
+template <class A, class B>
+void checkSameSeek(A a, B b, int key) {
+	auto same = [](auto i, auto j) { return bool(i) == bool(j) && (!i || (i.key() == j.key() && *i == *j)); };
+	ASSERT(same(a.find(key), b.find(key)));
+	ASSERT(same(a.lower_bound(key), b.lower_bound(key)));
+	ASSERT(same(a.upper_bound(key), b.upper_bound(key)));
+	ASSERT(same(a.lastLessOrEqual(key), b.lastLessOrEqual(key)));
+	ASSERT(same(a.lastLess(key), b.lastLess(key)));
+
+	auto i = a.lower_bound(key);
+	auto j = b.lower_bound(key);
+	for (int step = 0; step < 3 && i; step++) {
+		--i;
+		--j;
+		ASSERT(same(i, j));
+	}
+}
+
+} // namespace
+
+// Applies the same random inserts, point erases and range erases to a VersionedMap and a BTreeVersionedMap, and checks
+// that every retained version reads the same from both
+TEST_CASE("/fdbclient/VersionedMap/BTreeMatchesPTree") {
+	VersionedMap<int, int> ptree;
+	BTreeVersionedMap<int, int> btree;
+	const int keySpace = deterministicRandom()->randomInt(10, 5000);
+	const int versions = deterministicRandom()->randomInt(10, 200);
+	const int window = deterministicRandom()->randomInt(1, 20);
+
+	for (Version v = 1; v <= versions; v++) {
+		ptree.createNewVersion(v);
+		btree.createNewVersion(v);
+		const int mutations = deterministicRandom()->randomInt(0, 200);
+		for (int m = 0; m < mutations; m++) {
+			const int key = deterministicRandom()->randomInt(0, keySpace);
+			const double op = deterministicRandom()->random01();
+			if (op < 0.7) {
+				const int value = deterministicRandom()->randomInt(0, 1000);
+				ptree.insert(key, value);
+				btree.insert(key, value);
+			} else if (op < 0.9) {
+				if (ptree.atLatest().find(key)) {
+					ptree.erase(key);
+					btree.erase(key);
+				}
+			} else {
+				const int end = key + deterministicRandom()->randomInt(0, keySpace / 10 + 2);
+				ptree.erase(key, end);
+				btree.erase(key, end);
+			}
+		}
+
+		if (v > window) {
+			if (deterministicRandom()->coinflip()) {
+				ptree.forgetVersionsBefore(v - window);
+				btree.forgetVersionsBefore(v - window);
+			} else {
+				ptree.forgetVersionsBeforeAsync(v - window);
+				btree.forgetVersionsBeforeAsync(v - window);
+			}
+		}
+
+		btree.atLatest().validate();
+		for (Version at = btree.getOldestVersion(); at <= v; at += deterministicRandom()->randomInt(1, 4)) {
+			checkSameItems(ptree.at(at), btree.at(at));
+			checkSameSeek(ptree.at(at), btree.at(at), deterministicRandom()->randomInt(-1, keySpace + 1));
+		}
+	}
+
+	return Void();
+}
+
+// Inserts the same random batches into two VersionedMaps, one item at a time and with insertSorted(), and checks that
+// every retained version reads the same from both
+TEST_CASE("/fdbclient/VersionedMap/insertSorted") {
+	VersionedMap<int, int> inserted;
+	VersionedMap<int, int> sorted;
+	const int keySpace = deterministicRandom()->randomInt(10, 5000);
+	const int versions = deterministicRandom()->randomInt(10, 200);
+	const int window = deterministicRandom()->randomInt(1, 20);
+
+	for (Version v = 1; v <= versions; v++) {
+		inserted.createNewVersion(v);
+		sorted.createNewVersion(v);
+		const int batches = deterministicRandom()->randomInt(0, 4);
+		for (int b = 0; b < batches; b++) {
+			std::map<int, std::pair<int, Version>> batch;
+			const int items = deterministicRandom()->randomInt(0, 300);
+			for (int i = 0; i < items; i++) {
+				const int key = deterministicRandom()->randomInt(0, keySpace);
+				const int value = deterministicRandom()->randomInt(0, 1000);
+				const Version insertAt = deterministicRandom()->randomInt(1, v + 1);
+				inserted.insert(key, value, insertAt);
+				batch[key] = std::make_pair(value, insertAt);
+			}
+			std::vector<MapPair<int, std::pair<int, Version>>> batchItems;
+			for (const auto& [key, value] : batch) {
+				batchItems.emplace_back(key, value);
+			}
+			sorted.insertSorted(batchItems);
+
+			const int key = deterministicRandom()->randomInt(0, keySpace);
+			const int end = key + deterministicRandom()->randomInt(0, keySpace / 10 + 2);
+			inserted.erase(key, end);
+			sorted.erase(key, end);
+		}
+
+		if (v > window) {
+			inserted.forgetVersionsBefore(v - window);
+			sorted.forgetVersionsBefore(v - window);
+		}
+
+		sorted.atLatest().validate();
+		for (Version at = sorted.getOldestVersion(); at <= v; at += deterministicRandom()->randomInt(1, 4)) {
+			checkSameItems(inserted.at(at), sorted.at(at));
+			checkSameSeek(inserted.at(at), sorted.at(at), deterministicRandom()->randomInt(-1, keySpace + 1));
+		}
+	}
+
+	return Void();
+}
+
+// Erasing a large range of items inserted at the same version leaves their nodes to forgetVersionsBeforeAsync()
+TEST_CASE("/fdbclient/VersionedMap/eraseRetiresNodes") {
+	VersionedMap<int, int> map;
+	const int items = deterministicRandom()->randomInt(1000, 20000);
+	map.createNewVersion(1);
+	for (int i = 0; i < items; i++) {
+		map.insert(i, i);
+	}
+	map.erase(10, items - 10);
+	ASSERT(!map.retired.empty());
+
+	map.createNewVersion(2);
+	map.insert(items, items);
+	map.erase(0, 5);
+	int count = 0;
+	for (auto i = map.atLatest().begin(); i != map.atLatest().end(); ++i, ++count) {
+		ASSERT(i.key() < 10 ? i.key() >= 5 : i.key() >= items - 10);
+	}
+	ASSERT_EQ(count, 16);
+
+	Future<Void> cleanup = map.forgetVersionsBeforeAsync(2);
+	ASSERT(map.retired.empty());
+	return cleanup;
+}
+
 void forceLinkVersionedMapTests() {}
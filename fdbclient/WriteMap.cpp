@@ -77,6 +77,8 @@ bool OperationStack::operator==(const OperationStack& r) const {
 
 WriteMap& WriteMap::operator=(WriteMap&& r) noexcept {
 	writeMapEmpty = r.writeMapEmpty;
+	deferWrites = r.deferWrites;
+	deferredWrites = r.deferredWrites;
 	writes = std::move(r.writes);
 	ver = r.ver;
 	scratch_iterator = std::move(r.scratch_iterator);
@@ -84,8 +86,39 @@ WriteMap& WriteMap::operator=(WriteMap&& r) noexcept {
 	return *this;
 }
 
+WriteMap::Tree const& WriteMap::applyDeferredWrites() {
+	if (!deferredWrites.empty()) {
+		stopDeferringWrites();
+	}
+	return writes;
+}
+
+void WriteMap::stopDeferringWrites() {
+	if (!deferWrites) {
+		return;
+	}
+	deferWrites = false;
+	for (const auto& write : deferredWrites) {
+		if (write.mutation.type == MutationRef::ClearRange) {
+			clearTree(KeyRangeRef(write.mutation.param1, write.mutation.param2), write.addConflict);
+		} else {
+			const MutationRef& m = write.mutation;
+			mutateTree(m.param1, (MutationRef::Type)m.type, m.param2, write.addConflict);
+		}
+	}
+	deferredWrites = VectorRef<DeferredWrite>();
+}
+
 void WriteMap::mutate(KeyRef key, MutationRef::Type operation, ValueRef param, bool addConflict) {
 	writeMapEmpty = false;
+	if (deferWrites) {
+		deferredWrites.push_back(*arena, DeferredWrite{ MutationRef(operation, key, param), addConflict });
+		return;
+	}
+	mutateTree(key, operation, param, addConflict);
+}
+
+void WriteMap::mutateTree(KeyRef key, MutationRef::Type operation, ValueRef param, bool addConflict) {
 	auto& it = scratch_iterator;
 	it.reset(writes, ver);
 	it.skip(key);
@@ -159,6 +192,15 @@ void WriteMap::mutate(KeyRef key, MutationRef::Type operation, ValueRef param, b
 
 void WriteMap::clear(KeyRangeRef keys, bool addConflict) {
 	writeMapEmpty = false;
+	if (deferWrites) {
+		MutationRef clear(MutationRef::ClearRange, keys.begin, keys.end);
+		deferredWrites.push_back(*arena, DeferredWrite{ clear, addConflict });
+		return;
+	}
+	clearTree(keys, addConflict);
+}
+
+void WriteMap::clearTree(KeyRangeRef keys, bool addConflict) {
 	if (!addConflict) {
 		clearNoConflict(keys);
 		return;
@@ -203,6 +245,7 @@ void WriteMap::clear(KeyRangeRef keys, bool addConflict) {
 }
 
 void WriteMap::addUnmodifiedAndUnreadableRange(KeyRangeRef keys) {
+	stopDeferringWrites();
 	auto& it = scratch_iterator;
 	it.reset(writes, ver);
 	it.skip(keys.begin);
@@ -243,6 +286,7 @@ void WriteMap::addUnmodifiedAndUnreadableRange(KeyRangeRef keys) {
 
 void WriteMap::addConflictRange(KeyRangeRef keys) {
 	writeMapEmpty = false;
+	stopDeferringWrites();
 	auto& it = scratch_iterator;
 	it.reset(writes, ver);
 	it.skip(keys.begin);
@@ -54,7 +54,8 @@ struct AuditStorageState {
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		serializer(ar, id, auditServerId, range, type, phase, error, ddId, engineType);
+		serializer(
+		    ar, id, auditServerId, range, type, phase, error, ddId, engineType, validatedBytes, validationSeconds);
 	}
 
 	inline void setType(AuditType type) { this->type = static_cast<uint8_t>(type); }
@@ -70,6 +71,10 @@ struct AuditStorageState {
 		if (!error.empty()) {
 			res += "[Error]: " + error;
 		}
+		if (validatedBytes > 0) {
+			res += ", [ValidatedBytes]: " + std::to_string(validatedBytes) +
+			       ", [ValidationSeconds]: " + std::to_string(validationSeconds);
+		}
 
 		return res;
 	}
@@ -88,6 +93,9 @@ struct AuditStorageState {
 	uint8_t phase;
 	KeyValueStoreType engineType;
 	std::string error;
+	// Bytes of all replicas the audit task validated, and the time it took, from the beginning of range
+	int64_t validatedBytes = 0;
+	double validationSeconds = 0;
 };
 
 struct AuditStorageRequest {
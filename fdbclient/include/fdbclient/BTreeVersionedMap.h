@@ -0,0 +1,752 @@
+/*
+ * BTreeVersionedMap.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBCLIENT_BTREEVERSIONEDMAP_H
+#define FDBCLIENT_BTREEVERSIONEDMAP_H
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "flow/flow.h"
+#include "fdbclient/FDBTypes.h"
+#include "fdbclient/VersionedMap.h"
+
+// BTreeVersionedMap is an alternative to VersionedMap with the same interface, built on a copy on write B+tree instead
+// of a treap. Items are stored in wide leaves rather than one heap node per item, so the tree needs far fewer pointers
+// per item and a range read scans contiguous memory.
+//
+// Versions share every node they have not modified. The first modification of a node at a new version copies it and
+// its path from the root; later modifications at the same version change the copies in place. Each version therefore
+// costs memory in proportion to the number of distinct nodes it touches, not to the number of items it writes.
+namespace PBTreeImpl {
+
+// Nodes are sized to fill this many bytes, which bounds the cost of copying one
+constexpr int nodeBytes = 2048;
+constexpr int maxDepth = 16;
+
+constexpr int capacityFor(int itemBytes) {
+	return std::clamp((nodeBytes - 64) / itemBytes, 4, 64);
+}
+
+// A fixed capacity array stored inline, for item types that need not be default constructible
+template <class X, int N>
+class InlineArray : NonCopyable {
+public:
+	InlineArray() : size_(0) {}
+	~InlineArray() { clear(); }
+
+	int size() const { return size_; }
+	bool full() const { return size_ == N; }
+	X& operator[](int i) { return data()[i]; }
+	X const& operator[](int i) const { return data()[i]; }
+
+	// x must not refer into this array
+	void insert(int at, X const& x) {
+		ASSERT(at >= 0 && at <= size_ && size_ < N);
+		X* d = data();
+		if (at == size_) {
+			new (&d[size_]) X(x);
+		} else {
+			new (&d[size_]) X(std::move(d[size_ - 1]));
+			std::move_backward(d + at, d + size_ - 1, d + size_);
+			d[at] = x;
+		}
+		size_++;
+	}
+	void erase(int begin, int end) {
+		X* d = data();
+		std::move(d + end, d + size_, d + begin);
+		for (int i = size_ - (end - begin); i < size_; i++) {
+			d[i].~X();
+		}
+		size_ -= end - begin;
+	}
+	// Appends copies of other[begin, end)
+	void append(InlineArray const& other, int begin, int end) {
+		ASSERT(size_ + end - begin <= N);
+		for (int i = begin; i < end; i++) {
+			new (&data()[size_++]) X(other[i]);
+		}
+	}
+	void clear() { erase(0, size_); }
+
+private:
+	X* data() { return reinterpret_cast<X*>(storage); }
+	X const* data() const { return reinterpret_cast<X const*>(storage); }
+
+	alignas(X) uint8_t storage[sizeof(X) * N];
+	int size_;
+};
+
+template <class K, class T>
+struct Entry {
+	K key;
+	T value;
+	Version insertVersion;
+
+	Entry(K const& key, T const& value, Version insertVersion) : key(key), value(value), insertVersion(insertVersion) {}
+};
+
+} // namespace PBTreeImpl
+
+template <class K, class T>
+class BTreeVersionedMap : NonCopyable {
+public:
+	typedef PBTreeImpl::Entry<K, T> EntryT;
+	static constexpr int leafCapacity = PBTreeImpl::capacityFor(sizeof(EntryT));
+	static constexpr int internalCapacity = PBTreeImpl::capacityFor(sizeof(K) + sizeof(void*));
+
+	struct Node;
+	struct Leaf;
+	struct Internal;
+	typedef Reference<Node> Tree;
+
+	struct Node : ReferenceCounted<Node>, NonCopyable {
+		bool leaf;
+		Version version; // The version that created this node. Only nodes of the latest version are changed in place.
+
+		Node(bool leaf, Version version) : leaf(leaf), version(version) {}
+		virtual ~Node() {}
+
+		Leaf& asLeaf() { return static_cast<Leaf&>(*this); }
+		Leaf const& asLeaf() const { return static_cast<Leaf const&>(*this); }
+		Internal& asInternal() { return static_cast<Internal&>(*this); }
+		Internal const& asInternal() const { return static_cast<Internal const&>(*this); }
+
+		int size() const { return leaf ? asLeaf().entries.size() : asInternal().children.size(); }
+		int capacity() const { return leaf ? leafCapacity : internalCapacity; }
+		K const& firstKey() const { return leaf ? asLeaf().entries[0].key : asInternal().minKeys[0]; }
+		Node const* child(int i) const { return asInternal().children[i].getPtr(); }
+
+		// Moves the children only this node refers to into toFree, so that a large tree can be freed incrementally
+		void releaseSoleOwnedChildren(std::vector<Tree>& toFree) {
+			if (leaf) {
+				return;
+			}
+			auto& children = asInternal().children;
+			for (int i = 0; i < children.size(); i++) {
+				if (children[i]->isSoleOwner()) {
+					toFree.push_back(std::move(children[i]));
+				}
+			}
+		}
+	};
+
+	struct Leaf final : Node, FastAllocated<Leaf> {
+		PBTreeImpl::InlineArray<EntryT, leafCapacity> entries;
+
+		explicit Leaf(Version version) : Node(true, version) {}
+	};
+
+	struct Internal final : Node, FastAllocated<Internal> {
+		PBTreeImpl::InlineArray<K, internalCapacity> minKeys; // minKeys[i] is the smallest key below children[i]
+		PBTreeImpl::InlineArray<Tree, internalCapacity> children;
+
+		explicit Internal(Version version) : Node(false, version) {}
+	};
+
+	Version oldestVersion, latestVersion;
+
+	// The root of every version that is still readable, in increasing version order, as in VersionedMap
+	std::deque<std::pair<Version, Tree>> roots;
+
+	struct rootsComparator {
+		bool operator()(const std::pair<Version, Tree>& value, const Version& key) { return (value.first < key); }
+		bool operator()(const Version& key, const std::pair<Version, Tree>& value) { return (key < value.first); }
+	};
+
+	Tree const& getRoot(Version v) const {
+		auto r = upper_bound(roots.begin(), roots.end(), v, rootsComparator());
+		--r;
+		return r->second;
+	}
+
+	// Leaves are on average three quarters full, and each item shares the cost of its leaf's copies in recent versions
+	static const int overheadPerItem = nextFastAllocatedSize(sizeof(Leaf)) * 2 / (leafCapacity * 3 / 4);
+	struct iterator;
+
+	BTreeVersionedMap() : oldestVersion(0), latestVersion(0) { roots.emplace_back(0, Tree()); }
+	BTreeVersionedMap(BTreeVersionedMap&& v) noexcept
+	  : oldestVersion(v.oldestVersion), latestVersion(v.latestVersion), roots(std::move(v.roots)) {}
+	void operator=(BTreeVersionedMap&& v) noexcept {
+		oldestVersion = v.oldestVersion;
+		latestVersion = v.latestVersion;
+		roots = std::move(v.roots);
+	}
+
+	Version getLatestVersion() const { return latestVersion; }
+	Version getOldestVersion() const { return oldestVersion; }
+
+	// front element should be the oldest version in the deque, hence the next oldest should be at index 1
+	Version getNextOldestVersion() const { return roots[1].first; }
+
+	void forgetVersionsBefore(Version newOldestVersion) {
+		ASSERT(newOldestVersion <= latestVersion);
+		auto r = upper_bound(roots.begin(), roots.end(), newOldestVersion, rootsComparator());
+		auto upper = r;
+		--r;
+		// if the specified newOldestVersion does not exist, insert a new
+		// entry-pair with newOldestVersion and the root from next lower version
+		if (r->first != newOldestVersion) {
+			r = roots.emplace(upper, newOldestVersion, getRoot(newOldestVersion));
+		}
+
+		UNSTOPPABLE_ASSERT(r->first == newOldestVersion);
+		roots.erase(roots.begin(), r);
+		oldestVersion = newOldestVersion;
+	}
+
+	Future<Void> forgetVersionsBeforeAsync(Version newOldestVersion, TaskPriority taskID = TaskPriority::DefaultYield) {
+		ASSERT_LE(newOldestVersion, latestVersion);
+		auto r = upper_bound(roots.begin(), roots.end(), newOldestVersion, rootsComparator());
+		auto upper = r;
+		--r;
+		if (r->first != newOldestVersion) {
+			r = roots.emplace(upper, newOldestVersion, getRoot(newOldestVersion));
+		}
+
+		UNSTOPPABLE_ASSERT(r->first == newOldestVersion);
+
+		std::vector<Tree> toFree;
+		auto newBegin = r;
+		Tree* lastRoot = nullptr;
+		for (auto root = roots.begin(); root != newBegin; ++root) {
+			if (root->second) {
+				if (lastRoot != nullptr && root->second == *lastRoot) {
+					(*lastRoot).clear();
+				}
+				if (root->second->isSoleOwner()) {
+					toFree.push_back(root->second);
+				}
+				lastRoot = &root->second;
+			}
+		}
+
+		roots.erase(roots.begin(), newBegin);
+		oldestVersion = newOldestVersion;
+		return deferredNodeCleanupActor(toFree, taskID);
+	}
+
+	void createNewVersion(Version version) { // following sets and erases are into the given version, which may now be
+		                                     // passed to at().  Must be called in monotonically increasing order.
+		if (version > latestVersion) {
+			latestVersion = version;
+			Tree r = getRoot(version);
+			roots.emplace_back(version, r);
+		} else
+			ASSERT(version == latestVersion);
+	}
+
+	// insert() and erase() invalidate atLatest() and all iterators into it
+	void insert(const K& k, const T& t) { insert(k, t, latestVersion); }
+	void insert(const K& k, const T& t, Version insertAt) {
+		Tree& root = roots.back().second;
+		if (!root) {
+			root = Tree(new Leaf(latestVersion));
+		}
+		own(root);
+		Tree split = insertOwned(root, EntryT(k, t, insertAt));
+		if (split) {
+			Internal* newRoot = new Internal(latestVersion);
+			newRoot->minKeys.insert(0, root->firstKey());
+			newRoot->children.insert(0, root);
+			newRoot->minKeys.insert(1, split->firstKey());
+			newRoot->children.insert(1, split);
+			root = Tree(newRoot);
+		}
+	}
+	// Inserts items, which must be sorted by key without duplicates, as insert() would one at a time
+	void insertSorted(std::vector<MapPair<K, std::pair<T, Version>>> const& items) {
+		for (const auto& item : items) {
+			insert(item.key, item.value.first, item.value.second);
+		}
+	}
+	void erase(const K& begin, const K& end) { eraseRange(begin, end, false); }
+	void erase(const K& key) { // key must be present
+		eraseRange(key, key, true);
+	}
+	void erase(iterator const& item) { // iterator must be in latest version!
+		ASSERT_EQ(item.at, latestVersion);
+		eraseRange(item.key(), item.key(), true);
+	}
+
+	void printTree(Version at) { printTree(getRoot(at).getPtr(), 0); }
+
+	// Versions only share whole nodes, so there is never anything to compact
+	void compact(Version newOldestVersion) {}
+
+	// for(auto i = vm.at(version).lower_bound(range.begin); i < range.end; ++i)
+	struct iterator {
+		explicit iterator(Tree const& root, Version at) : root(root), at(at), depth(0) {}
+
+		K const& key() const { return entry().key; }
+		Version insertVersion() const {
+			return entry().insertVersion;
+		} // Returns the version at which the current item was inserted
+		operator bool() const { return depth != 0; }
+		bool operator<(const K& key) const { return this->key() < key; }
+
+		T const& operator*() { return entry().value; }
+		T const* operator->() { return &entry().value; }
+		void operator++() {
+			if (depth)
+				next();
+			else
+				seekEdge(false);
+		}
+		void operator--() {
+			if (depth)
+				previous();
+			else
+				seekEdge(true);
+		}
+		bool operator==(const iterator& r) const {
+			if (depth && r.depth)
+				return path[depth - 1] == r.path[r.depth - 1] && index[depth - 1] == r.index[r.depth - 1];
+			else
+				return depth == r.depth;
+		}
+		bool operator!=(const iterator& r) const { return !(*this == r); }
+
+	private:
+		friend class BTreeVersionedMap<K, T>;
+		Tree root;
+		Version at;
+		// The position in each node from the root (path[0]) to a leaf (path[depth - 1]), or depth 0 at end()
+		Node const* path[PBTreeImpl::maxDepth];
+		int index[PBTreeImpl::maxDepth];
+		int depth;
+
+		EntryT const& entry() const { return path[depth - 1]->asLeaf().entries[index[depth - 1]]; }
+
+		void push(Node const* n, int i) {
+			ASSERT(depth < PBTreeImpl::maxDepth);
+			path[depth] = n;
+			index[depth] = i;
+			depth++;
+		}
+
+		// Pushes the first or last item below n
+		void descend(Node const* n, bool last) {
+			loop {
+				const int i = last ? n->size() - 1 : 0;
+				push(n, i);
+				if (n->leaf)
+					return;
+				n = n->child(i);
+			}
+		}
+
+		void seekEdge(bool last) {
+			depth = 0;
+			if (root)
+				descend(root.getPtr(), last);
+		}
+
+		void next() {
+			while (depth) {
+				const int d = depth - 1;
+				if (index[d] + 1 < path[d]->size()) {
+					index[d]++;
+					if (!path[d]->leaf)
+						descend(path[d]->child(index[d]), false);
+					return;
+				}
+				depth--;
+			}
+		}
+
+		void previous() {
+			while (depth) {
+				const int d = depth - 1;
+				if (index[d] > 0) {
+					index[d]--;
+					if (!path[d]->leaf)
+						descend(path[d]->child(index[d]), true);
+					return;
+				}
+				depth--;
+			}
+		}
+
+		// Positions the iterator at the first item not less than x (orEqual = false) or greater than x (orEqual =
+		// true), or at end()
+		template <class X>
+		void seek(X const& x, bool orEqual) {
+			depth = 0;
+			if (!root)
+				return;
+			Node const* n = root.getPtr();
+			while (!n->leaf) {
+				const int i = childIndex(n->asInternal(), x);
+				push(n, i);
+				n = n->child(i);
+			}
+			const int i = orEqual ? upperBoundIndex(n->asLeaf(), x) : lowerBoundIndex(n->asLeaf(), x);
+			if (i < n->size()) {
+				push(n, i);
+			} else {
+				push(n, i - 1);
+				next();
+			}
+		}
+	};
+
+	class ViewAtVersion {
+	public:
+		ViewAtVersion(Tree const& root, Version at) : root(root), at(at) {}
+
+		iterator begin() const {
+			iterator i(root, at);
+			i.seekEdge(false);
+			return i;
+		}
+		iterator end() const { return iterator(root, at); }
+
+		// Returns x such that key==*x, or end()
+		template <class X>
+		iterator find(const X& key) const {
+			iterator i = lower_bound(key);
+			if (i && i.key() == key)
+				return i;
+			else
+				return end();
+		}
+
+		// Returns the smallest x such that *x>=key, or end()
+		template <class X>
+		iterator lower_bound(const X& key) const {
+			iterator i(root, at);
+			i.seek(key, false);
+			return i;
+		}
+
+		// Returns the smallest x such that *x>key, or end()
+		template <class X>
+		iterator upper_bound(const X& key) const {
+			iterator i(root, at);
+			i.seek(key, true);
+			return i;
+		}
+
+		// Returns the largest x such that *x<=key, or end()
+		template <class X>
+		iterator lastLessOrEqual(const X& key) const {
+			iterator i = upper_bound(key);
+			--i;
+			return i;
+		}
+
+		// Returns the largest x such that *x<key, or end()
+		template <class X>
+		iterator lastLess(const X& key) const {
+			iterator i = lower_bound(key);
+			--i;
+			return i;
+		}
+
+		// Checks the ordering, the minimum keys kept by internal nodes, and that no node except the root is empty
+		void validate() {
+			int count = 0, height = 0;
+			if (root) {
+				validateNode(root.getPtr(), true, nullptr, nullptr, count, height);
+			}
+			if (height > PBTreeImpl::maxDepth / 2)
+				TraceEvent(SevWarnAlways, "DiabolicalPBTreeSize").detail("Size", count).detail("Height", height);
+		}
+
+	private:
+		Tree root;
+		Version at;
+	};
+
+	ViewAtVersion at(Version v) const {
+		if (v == ::latestVersion) {
+			return atLatest();
+		}
+
+		return ViewAtVersion(getRoot(v), v);
+	}
+	ViewAtVersion atLatest() const { return ViewAtVersion(roots.back().second, latestVersion); }
+
+	bool isClearContaining(ViewAtVersion const& view, KeyRef key) {
+		auto i = view.lastLessOrEqual(key);
+		return i && i->isClearTo() && i->getEndKey() > key;
+	}
+
+private:
+	// Index of the child of n whose keys could include x
+	template <class X>
+	static int childIndex(Internal const& n, X const& x) {
+		int lo = 1, hi = n.minKeys.size();
+		while (lo < hi) {
+			const int mid = (lo + hi) / 2;
+			if (x < n.minKeys[mid])
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		return lo - 1;
+	}
+
+	// Index of the first entry of n not less than x
+	template <class X>
+	static int lowerBoundIndex(Leaf const& n, X const& x) {
+		int lo = 0, hi = n.entries.size();
+		while (lo < hi) {
+			const int mid = (lo + hi) / 2;
+			if (n.entries[mid].key < x)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+	// Index of the first entry of n greater than x
+	template <class X>
+	static int upperBoundIndex(Leaf const& n, X const& x) {
+		int lo = 0, hi = n.entries.size();
+		while (lo < hi) {
+			const int mid = (lo + hi) / 2;
+			if (x < n.entries[mid].key)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		return lo;
+	}
+
+	static Tree clone(Node const& n, Version at) {
+		if (n.leaf) {
+			Leaf* c = new Leaf(at);
+			c->entries.append(n.asLeaf().entries, 0, n.size());
+			return Tree(c);
+		}
+		Internal* c = new Internal(at);
+		c->minKeys.append(n.asInternal().minKeys, 0, n.size());
+		c->children.append(n.asInternal().children, 0, n.size());
+		return Tree(c);
+	}
+
+	// Makes n safe to change at the latest version. A node created by an older version may be shared with that
+	// version's roots, so it is replaced by a copy.
+	void own(Tree& n) {
+		if (n->version != latestVersion)
+			n = clone(*n, latestVersion);
+	}
+
+	// Inserts e below the owned node n. Returns the new right sibling of n if n had to split.
+	Tree insertOwned(Tree& n, EntryT const& e) {
+		if (n->leaf) {
+			auto& entries = n->asLeaf().entries;
+			const int i = lowerBoundIndex(n->asLeaf(), e.key);
+			if (i < entries.size() && entries[i].key == e.key) {
+				entries[i] = e;
+				return Tree();
+			}
+			if (!entries.full()) {
+				entries.insert(i, e);
+				return Tree();
+			}
+			// Appending leaves the full node behind as is, so that ascending inserts fill leaves completely
+			const int half = i == entries.size() ? i : entries.size() / 2;
+			Leaf* right = new Leaf(latestVersion);
+			right->entries.append(entries, half, entries.size());
+			entries.erase(half, entries.size());
+			if (i < half)
+				entries.insert(i, e);
+			else
+				right->entries.insert(i - half, e);
+			return Tree(right);
+		}
+
+		Internal& in = n->asInternal();
+		const int i = childIndex(in, e.key);
+		own(in.children[i]);
+		Tree split = insertOwned(in.children[i], e);
+		if (e.key < in.minKeys[i])
+			in.minKeys[i] = e.key;
+		return split ? insertChild(in, i + 1, split) : Tree();
+	}
+
+	// Inserts child at position i of the owned node in. Returns the new right sibling of in if it had to split.
+	Tree insertChild(Internal& in, int i, Tree const& child) {
+		if (!in.children.full()) {
+			in.minKeys.insert(i, child->firstKey());
+			in.children.insert(i, child);
+			return Tree();
+		}
+		const int half = i == in.children.size() ? i : in.children.size() / 2;
+		Internal* right = new Internal(latestVersion);
+		right->minKeys.append(in.minKeys, half, in.minKeys.size());
+		right->children.append(in.children, half, in.children.size());
+		in.minKeys.erase(half, in.minKeys.size());
+		in.children.erase(half, in.children.size());
+		Internal& target = i < half ? in : *right;
+		const int at = i < half ? i : i - half;
+		target.minKeys.insert(at, child->firstKey());
+		target.children.insert(at, child);
+		return Tree(right);
+	}
+
+	template <class X>
+	static bool afterEnd(K const& key, X const& end, bool inclusive) {
+		return inclusive ? end < key : !(key < end);
+	}
+
+	// Whether n has a key in [begin, end), or [begin, end] if inclusive
+	template <class X>
+	static bool intersects(Node const* n, X const& begin, X const& end, bool inclusive) {
+		if (n->leaf) {
+			const int i = lowerBoundIndex(n->asLeaf(), begin);
+			return i < n->size() && !afterEnd(n->asLeaf().entries[i].key, end, inclusive);
+		}
+		const int i = childIndex(n->asInternal(), begin);
+		return intersects(n->child(i), begin, end, inclusive) ||
+		       (i + 1 < n->size() && !afterEnd(n->asInternal().minKeys[i + 1], end, inclusive));
+	}
+
+	void eraseRange(K begin, K end, bool inclusive) {
+		Tree& root = roots.back().second;
+		if (!root || !intersects(root.getPtr(), begin, end, inclusive))
+			return;
+		own(root);
+		eraseOwned(root, begin, end, inclusive);
+		if (root->size() == 0) {
+			root = Tree();
+			return;
+		}
+		while (!root->leaf && root->size() == 1) {
+			Tree child = root->asInternal().children[0];
+			root = child;
+		}
+	}
+
+	// Erases the keys in the range from the owned node n, which may be left empty
+	void eraseOwned(Tree& n, K const& begin, K const& end, bool inclusive) {
+		if (n->leaf) {
+			Leaf& l = n->asLeaf();
+			const int from = lowerBoundIndex(l, begin);
+			const int to = inclusive ? upperBoundIndex(l, end) : lowerBoundIndex(l, end);
+			if (from < to)
+				l.entries.erase(from, to);
+			return;
+		}
+
+		Internal& in = n->asInternal();
+		const int lo = childIndex(in, begin);
+		int hi = childIndex(in, end);
+		// Children strictly between lo and hi lie entirely within the range
+		if (hi - lo > 1) {
+			in.minKeys.erase(lo + 1, hi);
+			in.children.erase(lo + 1, hi);
+			hi = lo + 1;
+		}
+		for (int i = hi; i >= lo; i--) {
+			if (!intersects(in.children[i].getPtr(), begin, end, inclusive))
+				continue;
+			own(in.children[i]);
+			eraseOwned(in.children[i], begin, end, inclusive);
+			if (in.children[i]->size() == 0) {
+				in.minKeys.erase(i, i + 1);
+				in.children.erase(i, i + 1);
+			} else {
+				in.minKeys[i] = in.children[i]->firstKey();
+			}
+		}
+		mergeChildren(in, lo - 1, lo + 1);
+	}
+
+	// Merges neighbouring children of the owned node in, starting at positions [begin, end], when at least one of
+	// them is under half full and both fit in one node, so that erasing doesn't leave the tree sparse
+	void mergeChildren(Internal& in, int begin, int end) {
+		for (int i = std::max(begin, 0); i <= end && i + 1 < in.children.size();) {
+			Node const& a = *in.children[i];
+			Node const& b = *in.children[i + 1];
+			if ((a.size() * 2 >= a.capacity() && b.size() * 2 >= b.capacity()) || a.size() + b.size() > a.capacity()) {
+				i++;
+				continue;
+			}
+			own(in.children[i]);
+			Node& merged = *in.children[i];
+			if (merged.leaf) {
+				merged.asLeaf().entries.append(b.asLeaf().entries, 0, b.size());
+			} else {
+				merged.asInternal().minKeys.append(b.asInternal().minKeys, 0, b.size());
+				merged.asInternal().children.append(b.asInternal().children, 0, b.size());
+			}
+			in.minKeys.erase(i + 1, i + 2);
+			in.children.erase(i + 1, i + 2);
+			end--;
+		}
+	}
+
+	static void validateNode(Node const* n,
+	                         bool isRoot,
+	                         K const* lowerLimit,
+	                         K const* upperLimit,
+	                         int& count,
+	                         int& height,
+	                         int depth = 1) {
+		ASSERT(isRoot || n->size() > 0);
+		height = std::max(height, depth);
+		if (n->leaf) {
+			auto const& entries = n->asLeaf().entries;
+			for (int i = 0; i < entries.size(); i++) {
+				ASSERT(i == 0 || entries[i - 1].key < entries[i].key);
+				ASSERT(!lowerLimit || !(entries[i].key < *lowerLimit));
+				ASSERT(!upperLimit || entries[i].key < *upperLimit);
+			}
+			count += entries.size();
+			return;
+		}
+		auto const& in = n->asInternal();
+		for (int i = 0; i < in.children.size(); i++) {
+			ASSERT(i == 0 || in.minKeys[i - 1] < in.minKeys[i]);
+			ASSERT(!(in.children[i]->firstKey() < in.minKeys[i]) && !(in.minKeys[i] < in.children[i]->firstKey()));
+			validateNode(in.children[i].getPtr(),
+			             false,
+			             &in.minKeys[i],
+			             i + 1 < in.children.size() ? &in.minKeys[i + 1] : upperLimit,
+			             count,
+			             height,
+			             depth + 1);
+		}
+	}
+
+	static void printTree(Node const* n, int depth) {
+		if (!n)
+			return;
+		if (n->leaf) {
+			for (int i = 0; i < n->size(); i++)
+				printf("%s%s\n", std::string(depth * 2, ' ').c_str(), describe(n->asLeaf().entries[i].key).c_str());
+			return;
+		}
+		for (int i = 0; i < n->size(); i++) {
+			printf("%s[%s]\n", std::string(depth * 2, ' ').c_str(), describe(n->asInternal().minKeys[i]).c_str());
+			printTree(n->child(i), depth + 1);
+		}
+	}
+};
+
+#endif
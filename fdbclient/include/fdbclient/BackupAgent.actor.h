@@ -874,6 +874,10 @@ public:
 
 	KeyBackedBinaryValue<int64_t> logBytesWritten() { return configSpace.pack(__FUNCTION__sr); }
 
+	// The bytes the range and log files counted by rangeBytesWritten() and logBytesWritten() would have taken if they
+	// weren't compressed. Not set by versions that didn't compress backup files.
+	KeyBackedBinaryValue<int64_t> uncompressedBytesWritten() { return configSpace.pack(__FUNCTION__sr); }
+
 	KeyBackedProperty<EBackupState> stateEnum() { return configSpace.pack(__FUNCTION__sr); }
 
 	KeyBackedProperty<Reference<IBackupContainer>> backupContainer() { return configSpace.pack(__FUNCTION__sr); }
@@ -0,0 +1,88 @@
+/*
+ * BackupBlockCompression.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBCLIENT_BACKUPBLOCKCOMPRESSION_H
+#define FDBCLIENT_BACKUPBLOCKCOMPRESSION_H
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "flow/Arena.h"
+#include "flow/CompressionUtils.h"
+
+// Compressed blocks of backup range and mutation log files.
+//
+// Backup files are made of blocks that each start at a multiple of the file's block size, so restore can find, read
+// and decode any block on its own. Compressed files keep that layout, so the block offsets still index the file. A
+// compressed block starts with its file format version, as an uncompressed block does, followed by the payload
+//
+//   filter (uint8_t) | [chunk length (big endian uint32_t) | compressed chunk]... | 0xFF padding
+//
+// The chunks decompress to the bytes an uncompressed block of the same format holds after its version, minus the
+// padding. Writers keep adding to a block until its compressed size would no longer fit, so a compressed block holds
+// several blocks' worth of data. Each chunk is compressed once as it fills, rather than recompressing the block.
+class BackupBlockCompressor {
+public:
+	// capacity is the number of bytes of each block available to the payload
+	BackupBlockCompressor(CompressionFilter filter, int capacity);
+
+	// Returns whether bytesNeeded more bytes can be added to the current block with its payload still fitting
+	bool fits(int bytesNeeded);
+
+	void append(const void* data, int len);
+	// Appends the length of s, as a big endian uint32_t, followed by s, like IBackupFile::appendStringRefWithLen()
+	void appendStringRefWithLen(StringRef s);
+
+	bool empty() const { return chunk.empty() && chunks.empty(); }
+
+	// Returns the payload of the current block, padded with 0xFF to capacity if pad is true, and begins a new block
+	Standalone<StringRef> finishBlock(bool pad);
+
+	// Total bytes added to and written out of all blocks, for reporting the compression ratio
+	int64_t getUncompressedBytes() const { return uncompressedBytes; }
+	int64_t getCompressedBytes() const { return compressedBytes; }
+
+private:
+	CompressionFilter filter;
+	int capacity;
+	int chunkBytes;
+
+	// Bytes of the current block's chunk which is not compressed yet
+	std::string chunk;
+	// Compressed chunks of the current block, and their size with their lengths and the filter
+	Arena arena;
+	std::vector<StringRef> chunks;
+	int payloadBytes;
+
+	int64_t uncompressedBytes = 0;
+	int64_t compressedBytes = 0;
+
+	void compressChunk();
+};
+
+// Returns the bytes added to the block whose payload is payload. The result is allocated in arena.
+StringRef decompressBackupBlock(StringRef payload, Arena& arena);
+
+// Returns the filter to compress new backup files with, set by BACKUP_COMPRESSION_FILTER. NONE means backup files are
+// written in the uncompressed formats.
+CompressionFilter getBackupCompressionFilter();
+
+#endif
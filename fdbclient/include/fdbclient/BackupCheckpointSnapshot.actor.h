@@ -0,0 +1,65 @@
+/*
+ * BackupCheckpointSnapshot.actor.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(NO_INTELLISENSE) && !defined(FDBCLIENT_BACKUPCHECKPOINTSNAPSHOT_ACTOR_G_H)
+#define FDBCLIENT_BACKUPCHECKPOINTSNAPSHOT_ACTOR_G_H
+#include "fdbclient/BackupCheckpointSnapshot.actor.g.h"
+#elif !defined(FDBCLIENT_BACKUPCHECKPOINTSNAPSHOT_ACTOR_H)
+#define FDBCLIENT_BACKUPCHECKPOINTSNAPSHOT_ACTOR_H
+#pragma once
+
+#include "fdbclient/BackupContainer.h"
+#include "fdbclient/NativeAPI.actor.h"
+#include "fdbclient/StorageCheckpoint.h"
+
+#include "flow/actorcompiler.h" // has to be last include
+
+// The manifest of a snapshot made of storage server checkpoints. Each checkpoint is in the DataMoveRocksCF format,
+// with the directory and file name of each of its SST files set to the file's path in the backup container, so the
+// files can be read back into a directory and imported with IKeyValueStore::restore().
+struct CheckpointSnapshotManifest {
+	constexpr static FileIdentifier file_identifier = 4510732;
+	Version version = invalidVersion;
+	std::vector<KeyRange> ranges;
+	std::vector<CheckpointMetaData> checkpoints;
+	int64_t uploadedBytes = 0; // Bytes of SST files written to the container for this snapshot
+	int64_t reusedBytes = 0; // Bytes of SST files this snapshot shares with earlier snapshots
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, version, ranges, checkpoints, uploadedBytes, reusedBytes);
+	}
+};
+
+// Returns the name of the container file of file, an SST file of a checkpoint. A RocksDB instance never reuses file
+// numbers and never changes its files, so the number and size identify the file among all checkpoints of a server.
+std::string checkpointSnapshotFileName(const LiveFileMetaData& file);
+
+// Writes a snapshot of ranges at the returned manifest's version to bc, from storage server checkpoints rather than by
+// reading the ranges with transactions. A DataMoveRocksCF checkpoint is created for each shard, and the SST files of
+// each checkpoint are streamed from its storage server into the container, except those the container already has
+// from an earlier snapshot of the same server. The checkpoints are deleted afterwards. Throws if the checkpoints can't
+// be created within BACKUP_CHECKPOINT_TIMEOUT, e.g., because storage servers don't use a RocksDB storage engine.
+ACTOR Future<CheckpointSnapshotManifest> writeCheckpointSnapshot(Database cx,
+                                                                 Reference<IBackupContainer> bc,
+                                                                 std::vector<KeyRange> ranges);
+
+#include "flow/unactorcompiler.h"
+#endif
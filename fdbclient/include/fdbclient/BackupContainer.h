@@ -72,6 +72,12 @@ static const uint32_t BACKUP_AGENT_SNAPSHOT_FILE_VERSION = 1001;
 // Encrypted Snapshot file version written by FileBackupAgent
 static const uint32_t BACKUP_AGENT_ENCRYPTED_SNAPSHOT_FILE_VERSION = 1002;
 
+// Versions of the above formats with compressed blocks, see BackupBlockCompression.h
+static const uint32_t BACKUP_AGENT_COMPRESSED_MLOG_VERSION = 2002;
+static const uint32_t PARTITIONED_COMPRESSED_MLOG_VERSION = 4111;
+static const uint32_t BACKUP_AGENT_COMPRESSED_SNAPSHOT_FILE_VERSION = 1003;
+static const uint32_t BACKUP_AGENT_ENCRYPTED_COMPRESSED_SNAPSHOT_FILE_VERSION = 1004;
+
 struct LogFile {
 	Version beginVersion;
 	Version endVersion;
@@ -251,6 +257,16 @@ public:
 	                                               int64_t totalBytes,
 	                                               IncludeKeyRangeMap includeKeyRangeMap) = 0;
 
+	// Open a file for writing fileName, an engine file (e.g., a RocksDB SST file) of a checkpoint of storage server
+	// serverID. Engine files never change once written, so snapshots of a server share the files they have in common.
+	virtual Future<Reference<IBackupFile>> writeCheckpointFile(UID serverID, const std::string& fileName) = 0;
+
+	// Returns the paths of the checkpoint files of serverID, as given by the files writeCheckpointFile() opened
+	virtual Future<std::vector<std::string>> listCheckpointFiles(UID serverID) = 0;
+
+	// Write the serialized manifest of a snapshot made of storage server checkpoints at version
+	virtual Future<Void> writeCheckpointSnapshotManifest(Version version, const std::string& manifest) = 0;
+
 	// Open a file for read by name
 	virtual Future<Reference<IAsyncFile>> readFile(const std::string& name) = 0;
 
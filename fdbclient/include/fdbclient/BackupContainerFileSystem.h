@@ -128,6 +128,12 @@ public:
 	                                       int64_t totalBytes,
 	                                       IncludeKeyRangeMap IncludeKeyRangeMap) final;
 
+	Future<Reference<IBackupFile>> writeCheckpointFile(UID serverID, const std::string& fileName) final;
+
+	Future<std::vector<std::string>> listCheckpointFiles(UID serverID) final;
+
+	Future<Void> writeCheckpointSnapshotManifest(Version version, const std::string& manifest) final;
+
 	// List log files, unsorted, which contain data at any version >= beginVersion and <= targetVersion.
 	// "partitioned" flag indicates if new partitioned mutation logs or old logs should be listed.
 	Future<std::vector<LogFile>> listLogFiles(Version beginVersion, Version targetVersion, bool partitioned);
@@ -946,6 +946,10 @@ public:
 	                    BlobCipherEncryptHeaderRef* headerRef,
 	                    double* encryptTime = nullptr);
 
+	// Sets the IV of the next text to encrypt, keeping the cipher context and its key schedule, so that one encryptor
+	// can encrypt many texts of the same domain without being created again for each one
+	void setIV(const uint8_t* iv, const int ivLen);
+
 private:
 	void init();
 
@@ -1045,6 +1049,7 @@ private:
 	                                 const BlobCipherEncryptHeader& header);
 };
 
+// Digest generators can compute any number of digests with the key they are created with
 class HmacSha256DigestGen final : NonCopyable {
 public:
 	HmacSha256DigestGen(const unsigned char* key, size_t len);
@@ -1056,6 +1061,7 @@ public:
 
 private:
 	HMAC_CTX* ctx;
+	bool finished;
 };
 
 class Aes256CmacDigestGen final : NonCopyable {
@@ -1067,6 +1073,7 @@ public:
 
 private:
 	CMAC_CTX* ctx;
+	bool finished;
 };
 
 class Sha256KCV final : NonCopyable {
@@ -83,8 +83,15 @@ struct GranuleMaterializeStats {
 	int32_t rowsInserted;
 	int32_t rowsUpdated;
 
+	// file cache stats, for ranges of files loaded through a ReadBlobGranuleContext
+	int32_t fileCacheHits;
+	int32_t fileCacheMisses;
+	int64_t fileCacheHitBytes;
+	int64_t fileCacheMissBytes;
+
 	GranuleMaterializeStats()
-	  : inputBytes(0), outputBytes(0), snapshotRows(0), rowsCleared(0), rowsInserted(0), rowsUpdated(0) {}
+	  : inputBytes(0), outputBytes(0), snapshotRows(0), rowsCleared(0), rowsInserted(0), rowsUpdated(0),
+	    fileCacheHits(0), fileCacheMisses(0), fileCacheHitBytes(0), fileCacheMissBytes(0) {}
 };
 
 struct BlobGranuleCipherKeysMeta {
@@ -0,0 +1,70 @@
+/*
+ * BlobGranuleFileCache.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBCLIENT_BLOBGRANULEFILECACHE_H
+#define FDBCLIENT_BLOBGRANULEFILECACHE_H
+#pragma once
+
+#include <list>
+#include <map>
+#include <mutex>
+
+#include "flow/Arena.h"
+
+// A bounded, least recently used cache of byte ranges of blob granule files, keyed by file name and offset, for
+// clients that materialize granules from files they load themselves. Granule files are never changed once written, so
+// cached bytes never go stale. It is used from any client thread, so all methods are thread safe.
+class BlobGranuleFileCache {
+public:
+	explicit BlobGranuleFileCache(int64_t capacityBytes) : capacityBytes(capacityBytes) {}
+
+	// The cache shared by the whole process, sized by BG_CLIENT_FILE_CACHE_BYTES when first used
+	static BlobGranuleFileCache& global();
+
+	bool enabled() const { return capacityBytes > 0; }
+
+	// Returns the bytes cached at offset of filename, or an absent Optional on a miss
+	Optional<Standalone<StringRef>> get(StringRef filename, int64_t offset);
+
+	// Caches bytes read at offset of filename, evicting the least recently used ranges to make room
+	void insert(StringRef filename, int64_t offset, Standalone<StringRef> bytes);
+
+	int64_t getBytes() const;
+	int64_t getCount() const;
+
+private:
+	// File name and offset
+	using Location = std::pair<Standalone<StringRef>, int64_t>;
+	struct Entry {
+		Standalone<StringRef> bytes;
+		std::list<Location>::iterator lruPosition;
+	};
+
+	const int64_t capacityBytes;
+	mutable std::mutex mutex;
+	int64_t bytes = 0;
+	std::map<Location, Entry> entries;
+	// Locations of entries, least recently used first
+	std::list<Location> lru;
+
+	void erase(std::map<Location, Entry>::iterator it);
+};
+
+#endif
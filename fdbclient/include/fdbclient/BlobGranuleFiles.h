@@ -24,6 +24,7 @@
 // This file contains functions for readers who want to materialize blob granules from the underlying files
 
 #include "fdbclient/BlobGranuleCommon.h"
+#include "fdbclient/PImpl.h"
 #include "fdbclient/SystemData.h"
 #include "flow/CompressionUtils.h"
 
@@ -34,6 +35,43 @@ Value serializeChunkedSnapshot(const Standalone<StringRef>& fileNameRef,
                                Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx = {},
                                bool isSnapshotSorted = true);
 
+// Like serializeChunkedSnapshot, but stores each chunk by column: the keys, and each element of the values that are
+// tuples, are compressed separately, along with the smallest and largest element of each. Reads of some elements can
+// then skip decompressing the others, and reads that filter on an element can skip chunks.
+Value serializeColumnarSnapshot(const Standalone<StringRef>& fileNameRef,
+                                const Standalone<GranuleSnapshot>& snapshot,
+                                int chunkSize,
+                                Optional<CompressionFilter> compressFilter,
+                                Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx = {});
+
+// Builds a snapshot file from rows added in key order, serializing each chunk once the next row doesn't fit in it, so
+// that compressing and encrypting chunks overlaps reading later rows and rows aren't kept once their chunk is written.
+// finish() stitches the chunks together behind the index block.
+class SnapshotFileBuilder {
+public:
+	SnapshotFileBuilder();
+	SnapshotFileBuilder(int chunkSize,
+	                    Optional<CompressionFilter> compressFilter,
+	                    Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx,
+	                    bool columnar = false,
+	                    bool isSnapshotSorted = true);
+	SnapshotFileBuilder(SnapshotFileBuilder&&);
+	SnapshotFileBuilder& operator=(SnapshotFileBuilder&&);
+	~SnapshotFileBuilder();
+
+	void add(const KeyValueRef& row);
+	Value finish();
+
+	int64_t getRows() const;
+	// the expectedSize() of a GranuleSnapshot of the rows added
+	int64_t getLogicalBytes() const;
+	// a key after the first row, around the middle of the rows added so far, or the first key if there is only one row
+	Key middleKey() const;
+
+private:
+	PImpl<struct SnapshotFileBuilderImpl> impl;
+};
+
 Value serializeChunkedDeltaFile(const Standalone<StringRef>& fileNameRef,
                                 const Standalone<GranuleDeltas>& deltas,
                                 const KeyRangeRef& fileRange,
@@ -66,6 +104,23 @@ RangeResult bgReadSnapshotFile(const StringRef& data,
                                Optional<KeyRef> tenantPrefix,
                                Optional<BlobGranuleCipherKeysCtx> encryptionCtx,
                                const KeyRangeRef& keys = normalKeys);
+
+// A filter on an element of the values, which a row passes if its value is a tuple whose packed element at index column
+// is in range. Since the tuple encoding preserves order, range can be built by packing tuples of one element.
+struct BlobGranuleColumnPredicate {
+	int column;
+	KeyRange range;
+};
+
+// Reads the rows in keys of a snapshot file that pass predicate, with values made of only the tuple elements in
+// columns, in that order. Values that are not tuples are returned whole. This is much cheaper for columnar snapshot
+// files, but any snapshot file can be read.
+RangeResult bgReadSnapshotFileColumns(const StringRef& data,
+                                      Optional<KeyRef> tenantPrefix,
+                                      Optional<BlobGranuleCipherKeysCtx> encryptionCtx,
+                                      const KeyRangeRef& keys,
+                                      const std::vector<int>& columns,
+                                      Optional<BlobGranuleColumnPredicate> predicate = {});
 Standalone<VectorRef<GranuleMutationRef>> bgReadDeltaFile(const StringRef& data,
                                                           Optional<KeyRef> tenantPrefix,
                                                           Optional<BlobGranuleCipherKeysCtx> encryptionCtx);
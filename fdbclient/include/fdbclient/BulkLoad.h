@@ -0,0 +1,130 @@
+/*
+ * BulkLoad.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBCLIENT_BULKLOAD_H
+#define FDBCLIENT_BULKLOAD_H
+#pragma once
+
+#include "fdbclient/FDBTypes.h"
+
+// A bulk load fills an empty range from the range files of a snapshot in a backup container. Data distribution splits
+// the range into pieces at file boundaries and moves each piece to new servers, which read its rows from the files
+// instead of from the servers the piece is moved away from. The rows don't go through the commit path or the logs.
+//
+// A task is tracked in a KeyRangeMap at bulkLoadPrefix, with an entry for each piece:
+//   Submitted: registered by submitBulkLoad(), for the whole range
+//   Running:   split into pieces, each listing its files; moves into a running piece load it from the files
+//   Loaded:    the servers of the piece have loaded it
+//   Complete:  every piece was loaded, for the whole range again
+//   Failed:    the task can't be run, e.g. because the range wasn't empty or the container has no suitable snapshot
+// Until the task is Complete, the range must not be written, and reads of it may return partial results.
+enum class BulkLoadPhase : uint8_t {
+	Invalid = 0,
+	Submitted = 1,
+	Running = 2,
+	Loaded = 3,
+	Complete = 4,
+	Failed = 5,
+};
+
+inline std::string bulkLoadPhaseName(BulkLoadPhase phase) {
+	switch (phase) {
+	case BulkLoadPhase::Submitted:
+		return "Submitted";
+	case BulkLoadPhase::Running:
+		return "Running";
+	case BulkLoadPhase::Loaded:
+		return "Loaded";
+	case BulkLoadPhase::Complete:
+		return "Complete";
+	case BulkLoadPhase::Failed:
+		return "Failed";
+	default:
+		return "Invalid";
+	}
+}
+
+// A range file of a backup container
+struct BulkLoadFile {
+	constexpr static FileIdentifier file_identifier = 6104688;
+
+	std::string fileName;
+	int64_t fileSize = 0;
+	uint32_t blockSize = 0;
+	KeyRange range; // of the keys in the file
+
+	BulkLoadFile() = default;
+	BulkLoadFile(std::string fileName, int64_t fileSize, uint32_t blockSize, KeyRange range)
+	  : fileName(std::move(fileName)), fileSize(fileSize), blockSize(blockSize), range(range) {}
+
+	bool operator==(const BulkLoadFile& r) const {
+		return fileName == r.fileName && fileSize == r.fileSize && blockSize == r.blockSize && range == r.range;
+	}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, fileName, fileSize, blockSize, range);
+	}
+};
+
+// The state of a piece of a bulk load task
+struct BulkLoadState {
+	constexpr static FileIdentifier file_identifier = 6104689;
+
+	UID taskId;
+	KeyRange range; // of the whole task
+	KeyRange piece; // of this entry of the task
+	std::string url; // of the backup container
+	Version version = latestVersion; // of the snapshot to load, or latestVersion for the newest usable one
+	uint8_t phase = static_cast<uint8_t>(BulkLoadPhase::Invalid);
+	std::string error; // why the task failed
+	std::vector<BulkLoadFile> files; // of the piece, once the task is running
+	int64_t bytes = 0; // of the files of the piece
+	double submitTime = 0;
+	double updateTime = 0;
+
+	BulkLoadState() = default;
+	BulkLoadState(UID taskId, KeyRange range, std::string url, Version version)
+	  : taskId(taskId), range(range), piece(range), url(std::move(url)), version(version),
+	    phase(static_cast<uint8_t>(BulkLoadPhase::Submitted)) {}
+
+	void setPhase(BulkLoadPhase phase) { this->phase = static_cast<uint8_t>(phase); }
+	BulkLoadPhase getPhase() const { return static_cast<BulkLoadPhase>(phase); }
+	bool isFinished() const { return getPhase() == BulkLoadPhase::Complete || getPhase() == BulkLoadPhase::Failed; }
+
+	std::string toString() const {
+		std::string res = "BulkLoadState: [TaskID]: " + taskId.toString() +
+		                  ", [Range]: " + Traceable<KeyRangeRef>::toString(range) +
+		                  ", [Piece]: " + Traceable<KeyRangeRef>::toString(piece) + ", [URL]: " + url +
+		                  ", [Version]: " + std::to_string(version) + ", [Phase]: " + bulkLoadPhaseName(getPhase()) +
+		                  ", [Files]: " + std::to_string(files.size()) + ", [Bytes]: " + std::to_string(bytes);
+		if (!error.empty()) {
+			res += ", [Error]: " + error;
+		}
+		return res;
+	}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, taskId, range, piece, url, version, phase, error, files, bytes, submitTime, updateTime);
+	}
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * BulkLoadUtils.actor.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(NO_INTELLISENSE) && !defined(FDBCLIENT_BULKLOADUTILS_ACTOR_G_H)
+#define FDBCLIENT_BULKLOADUTILS_ACTOR_G_H
+#include "fdbclient/BulkLoadUtils.actor.g.h"
+#elif !defined(FDBCLIENT_BULKLOADUTILS_ACTOR_H)
+#define FDBCLIENT_BULKLOADUTILS_ACTOR_H
+#pragma once
+
+#include "fdbclient/BackupContainer.h"
+#include "fdbclient/BulkLoad.h"
+#include "fdbclient/FDBTypes.h"
+#include "fdbclient/NativeAPI.actor.h"
+
+#include "flow/actorcompiler.h" // has to be last include
+
+// Registers a task to load the snapshot at version of the backup container at url into range, which must be empty.
+// Throws bulk_load_task_conflict if range overlaps an unfinished task.
+ACTOR Future<UID> submitBulkLoad(Database cx, KeyRange range, std::string url, Version version);
+
+// Returns the entries of the tasks intersecting range, in order
+ACTOR Future<std::vector<BulkLoadState>> getBulkLoadStates(Database cx, KeyRange range);
+
+// Removes the tasks intersecting range, whatever their phase, and returns how many there were. Moves already loading a
+// piece of one go on loading it from its files.
+ACTOR Future<int> clearBulkLoad(Database cx, KeyRange range);
+
+// Sets the entries of states, which are consecutive pieces of the task taskId in order, if the entry containing the
+// begin of the first one is an unfinished entry of the task. Returns whether it did.
+ACTOR Future<bool> setBulkLoadStates(Transaction* tr, UID taskId, std::vector<BulkLoadState> states);
+
+// Splits task into Running pieces that tile its range, at the begin keys of the range files of fileSet. A piece is cut
+// once its files have pieceBytes bytes or their names and key ranges have pieceNameBytes bytes, which bounds the size
+// of its entry.
+std::vector<BulkLoadState> splitBulkLoadTask(const BulkLoadState& task,
+                                             const RestorableFileSet& fileSet,
+                                             int64_t pieceBytes,
+                                             int pieceNameBytes);
+
+#include "flow/unactorcompiler.h"
+#endif
@@ -60,15 +60,23 @@ public:
 	double GRV_ERROR_RETRY_DELAY;
 	double UNKNOWN_TENANT_RETRY_DELAY;
 	int REPLY_BYTE_LIMIT;
+	bool PREFIX_COMPRESS_RANGE_REPLIES; // Ask storage servers to elide the prefixes keys share in range read replies
 	double DEFAULT_BACKOFF;
 	double DEFAULT_MAX_BACKOFF;
 	double BACKOFF_GROWTH_RATE;
 	double RESOURCE_CONSTRAINED_MAX_BACKOFF;
 	int PROXY_COMMIT_OVERHEAD_BYTES;
+	int COMMIT_COMPRESSION_MIN_BYTES; // Commits with at least this many bytes of mutations are sent compressed
 	double SHARD_STAT_SMOOTH_AMOUNT;
 	int INIT_MID_SHARD_BYTES;
 
 	int TRANSACTION_SIZE_LIMIT;
+	bool COALESCE_READ_CONFLICT_RANGES; // Merge overlapping and adjacent read conflict ranges before committing
+	// Commits with more read conflict ranges than this, after merging, close the gaps between ranges whose ends share
+	// the longest prefixes, of at least WIDEN_READ_CONFLICT_RANGES_MIN_PREFIX bytes, trading false conflicts for
+	// resolver work
+	int WIDEN_READ_CONFLICT_RANGES_ABOVE;
+	int WIDEN_READ_CONFLICT_RANGES_MIN_PREFIX;
 	int64_t KEY_SIZE_LIMIT;
 	int64_t SYSTEM_KEY_SIZE_LIMIT;
 	int64_t VALUE_SIZE_LIMIT;
@@ -83,9 +91,19 @@ public:
 	int64_t CHANGE_FEED_CACHE_FLUSH_BYTES;
 	double CHANGE_FEED_CACHE_EXPIRE_TIME;
 	int64_t CHANGE_FEED_CACHE_LIMIT_BYTES;
+	int CHANGE_FEED_MULTI_STREAM_BATCH_SIZE; // Most change feeds streamed from a storage server over one stream; 0
+	                                         // streams each feed on its own
+	double CHANGE_FEED_MULTI_STREAM_BATCH_DELAY; // How long new change feed streams are collected before they are sent
+	int64_t CHANGE_FEED_MULTI_STREAM_BUFFER_BYTES; // Bytes of a batched change feed waiting to be consumed at which
+	                                               // the feed's stream is restarted
+	int64_t CHANGE_FEED_MERGE_BATCH_BYTES; // Bytes of mutations at which a change feed merging the streams of several
+	                                       // storage servers delivers the versions merged so far
 
 	int MAX_BATCH_SIZE;
 	double GRV_BATCH_TIMEOUT;
+	bool THREADSAFE_GRV_QUEUE; // Hand ThreadSafeTransaction::getReadVersion calls to the network thread in bulk
+	int THREADSAFE_MUTATION_BATCH_BYTES; // Bytes of mutations ThreadSafeTransaction buffers for the network thread
+	                                     // before handing them over together; 0 hands each over on its own
 	int BROADCAST_BATCH_SIZE;
 	double TRANSACTION_TIMEOUT_DELAY_INTERVAL;
 
@@ -94,13 +112,25 @@ public:
 	int LOCATION_CACHE_EVICTION_SIZE_SIM;
 	double LOCATION_CACHE_ENDPOINT_FAILURE_GRACE_PERIOD;
 	double LOCATION_CACHE_FAILED_ENDPOINT_RETRY_INTERVAL;
+	// If set, the location cache is loaded from this file when a database is opened, and saved to it after warmRange()
+	std::string LOCATION_CACHE_SNAPSHOT_FILE;
+	int LOCATION_CACHE_SNAPSHOT_MAX_BYTES;
+	// If set, the ClientDBInfo from the coordinators is saved to this file, and a database opened for the same
+	// connection string starts with it if it was saved less than CLIENT_DB_INFO_CACHE_MAX_AGE seconds ago
+	std::string CLIENT_DB_INFO_CACHE_FILE;
+	double CLIENT_DB_INFO_CACHE_MAX_AGE;
+	int CLIENT_DB_INFO_CACHE_MAX_BYTES;
 
 	int GET_RANGE_SHARD_LIMIT;
 	int WARM_RANGE_SHARD_LIMIT;
+	int PARALLEL_RANGE_READ_SHARDS; // Shards read at once by a range read in the PARALLEL streaming mode
 	int STORAGE_METRICS_SHARD_LIMIT;
 	int SHARD_COUNT_LIMIT;
 	double STORAGE_METRICS_UNFAIR_SPLIT_LIMIT;
 	double STORAGE_METRICS_TOO_MANY_SHARDS_DELAY;
+	int STORAGE_METRICS_BATCH_SIZE; // Most shards whose metrics are waited on in one request to a storage server; 0
+	                                // waits on each shard in its own request
+	double STORAGE_METRICS_BATCH_DELAY; // How long waits on shard metrics are collected before they are sent
 	double AGGREGATE_HEALTH_METRICS_MAX_STALENESS;
 	double DETAILED_HEALTH_METRICS_MAX_STALENESS;
 	double MID_SHARD_SIZE_MAX_STALENESS;
@@ -135,6 +165,7 @@ public:
 	double GRV_CACHE_RK_COOLDOWN; // Required number of seconds to pass after throttling to re-allow cache use
 	double GRV_SUSTAINED_THROTTLING_THRESHOLD; // If ALL GRV requests have been throttled in the last number of seconds
 	                                           // specified here, ratekeeper is throttling and not a false positive
+	bool RYW_DEFER_WRITES; // Defer building the read-your-writes write map until a transaction reads
 
 	// Taskbucket
 	double TASKBUCKET_LOGGING_DELAY;
@@ -171,6 +202,9 @@ public:
 	int COPY_LOG_BLOCK_SIZE;
 	int COPY_LOG_BLOCKS_PER_TASK;
 	int COPY_LOG_PREFETCH_BLOCKS;
+	// The blocks a DR copy log range task writes to the destination concurrently. Blocks read ahead are bounded by this
+	// too, so more than COPY_LOG_PREFETCH_BLOCKS uses more memory.
+	int COPY_LOG_PARALLEL_BLOCKS;
 	int COPY_LOG_READ_AHEAD_BYTES;
 	double COPY_LOG_TASK_DURATION_NANOS;
 	int BACKUP_TASKS_PER_AGENT;
@@ -180,10 +214,15 @@ public:
 	int SIM_BACKUP_TASKS_PER_AGENT;
 	int BACKUP_RANGEFILE_BLOCK_SIZE;
 	int BACKUP_LOGFILE_BLOCK_SIZE;
+	std::string BACKUP_COMPRESSION_FILTER; // Filter new backup file blocks are compressed with, or NONE
+	int BACKUP_COMPRESSION_CHUNK_BYTES; // Bytes of a block compressed together
+	double BACKUP_CHECKPOINT_TIMEOUT; // Seconds to wait for the storage server checkpoints of a checkpoint snapshot
+	int BACKUP_CHECKPOINT_FILE_ATTEMPTS; // Attempts to stream each checkpoint file into the backup container
 	int BACKUP_DISPATCH_ADDTASK_SIZE;
 	int RESTORE_DISPATCH_ADDTASK_SIZE;
 	int RESTORE_DISPATCH_BATCH_SIZE;
 	int RESTORE_WRITE_TX_SIZE;
+	int RESTORE_WRITE_TX_PARALLELISM; // Transactions of a block of a range file that a restore commits at once
 	int APPLY_MAX_LOCK_BYTES;
 	int APPLY_MIN_LOCK_BYTES;
 	int APPLY_BLOCK_SIZE;
@@ -240,6 +279,9 @@ public:
 	int BLOBSTORE_MULTIPART_MIN_PART_SIZE;
 	int BLOBSTORE_CONCURRENT_UPLOADS;
 	int BLOBSTORE_CONCURRENT_LISTS;
+	int BLOBSTORE_MAX_CONCURRENT_UPLOADS; // Upper bound of upload concurrency when it adapts to throughput
+	double BLOBSTORE_UPLOAD_CONCURRENCY_INTERVAL;
+	int BLOBSTORE_PREWARM_CONNECTIONS; // Idle connections to keep open in the connection pool
 	int BLOBSTORE_CONCURRENT_WRITES_PER_FILE;
 	int BLOBSTORE_CONCURRENT_READS_PER_FILE;
 	int BLOBSTORE_ENABLE_READ_CACHE;
@@ -299,6 +341,11 @@ public:
 	// Blob Granules
 	int BG_MAX_GRANULE_PARALLELISM;
 	int BG_TOO_MANY_GRANULES;
+	// Bytes of granule file ranges that a process materializing granules from files it loads keeps cached, or 0 to load
+	// whole files on every read
+	int64_t BG_CLIENT_FILE_CACHE_BYTES;
+	// Bytes read from the start of a granule file to find its index, when it isn't cached
+	int BG_CLIENT_FILE_HEADER_READ_BYTES;
 	int64_t BLOB_METADATA_REFRESH_INTERVAL;
 	bool DETERMINISTIC_BLOB_METADATA;
 	bool ENABLE_BLOB_GRANULE_FILE_LOGICAL_SIZE;
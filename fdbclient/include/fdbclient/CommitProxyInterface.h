@@ -67,6 +67,8 @@ struct CommitProxyInterface {
 	PublicRequestStream<struct GetTenantIdRequest> getTenantId;
 	PublicRequestStream<struct GetBlobGranuleLocationsRequest> getBlobGranuleLocations;
 	RequestStream<struct SetThrottledShardRequest> setThrottledShard;
+	RequestStream<struct SetStorageWriteBudgetsRequest> setStorageWriteBudgets;
+	RequestStream<struct GetDDHeatmapRequest> getDDHeatmap;
 
 	UID id() const { return commit.getEndpoint().token; }
 	std::string toString() const { return id().shortString(); }
@@ -100,6 +102,9 @@ struct CommitProxyInterface {
 			    commit.getEndpoint().getAdjustedEndpoint(12));
 			setThrottledShard =
 			    RequestStream<struct SetThrottledShardRequest>(commit.getEndpoint().getAdjustedEndpoint(13));
+			setStorageWriteBudgets =
+			    RequestStream<struct SetStorageWriteBudgetsRequest>(commit.getEndpoint().getAdjustedEndpoint(14));
+			getDDHeatmap = RequestStream<struct GetDDHeatmapRequest>(commit.getEndpoint().getAdjustedEndpoint(15));
 		}
 	}
 
@@ -120,6 +125,8 @@ struct CommitProxyInterface {
 		streams.push_back(getTenantId.getReceiver());
 		streams.push_back(getBlobGranuleLocations.getReceiver());
 		streams.push_back(setThrottledShard.getReceiver());
+		streams.push_back(setStorageWriteBudgets.getReceiver());
+		streams.push_back(getDDHeatmap.getReceiver());
 		FlowTransport::transport().addEndpoints(streams);
 	}
 };
@@ -230,11 +237,21 @@ struct CommitTransactionRequest : TimedRequest {
 
 	TenantInfo tenantInfo;
 
+	// When present, transaction.mutations is empty and this holds the mutations serialized and compressed with ZSTD.
+	// Only sent to commit proxies whose protocol version has CompressedCommit.
+	Optional<StringRef> compressedMutations;
+
 	CommitTransactionRequest() : CommitTransactionRequest(SpanContext()) {}
 	CommitTransactionRequest(SpanContext const& context) : spanContext(context), flags(0) {}
 
 	bool verify() const { return tenantInfo.isAuthorized(); }
 
+	// Moves transaction.mutations into compressedMutations, unless compressing them doesn't save space. Returns whether
+	// the mutations were compressed.
+	bool compressMutations();
+	// Restores the mutations moved by compressMutations(). Throws if this process can't decompress them.
+	void decompressMutations();
+
 	template <class Ar>
 	void serialize(Ar& ar) {
 		serializer(ar,
@@ -247,6 +264,7 @@ struct CommitTransactionRequest : TimedRequest {
 		           spanContext,
 		           tenantInfo,
 		           idempotencyId,
+		           compressedMutations,
 		           arena);
 	}
 };
@@ -605,10 +623,12 @@ struct TxnStateRequest {
 	bool last;
 	std::vector<Endpoint> broadcastInfo;
 	ReplyPromise<Void> reply;
+	// If not empty, data is empty and the key-values are encoded in snapshot by encodeTxnStateSnapshot()
+	StringRef snapshot;
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		serializer(ar, data, sequence, last, broadcastInfo, reply, arena);
+		serializer(ar, data, sequence, last, broadcastInfo, reply, snapshot, arena);
 	}
 };
 
@@ -679,6 +699,33 @@ struct GetDDMetricsRequest {
 	}
 };
 
+struct GetDDHeatmapReply {
+	constexpr static FileIdentifier file_identifier = 4208293;
+	Standalone<VectorRef<HeatmapBucketRef>> buckets;
+
+	GetDDHeatmapReply() {}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, buckets);
+	}
+};
+
+struct GetDDHeatmapRequest {
+	constexpr static FileIdentifier file_identifier = 4208294;
+	KeyRange keys;
+	double since;
+	ReplyPromise<struct GetDDHeatmapReply> reply;
+
+	GetDDHeatmapRequest() : since(0) {}
+	explicit GetDDHeatmapRequest(KeyRange const& keys, double since) : keys(keys), since(since) {}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, keys, since, reply);
+	}
+};
+
 struct ProxySnapRequest {
 	constexpr static FileIdentifier file_identifier = 5427684;
 	Arena arena;
@@ -783,6 +830,26 @@ struct SetThrottledShardRequest {
 	}
 };
 
+// Sent by ratekeeper for the storage servers whose queues it controls through the commit proxies rather than the
+// cluster wide transaction rate
+struct SetStorageWriteBudgetsRequest {
+	constexpr static FileIdentifier file_identifier = 6390214;
+	// Storage server -> fraction of the transactions writing to it that may commit
+	std::map<UID, double> budgets;
+	// Seconds after which the budgets no longer apply, unless renewed
+	double expireAfter;
+	ReplyPromise<Void> reply;
+
+	SetStorageWriteBudgetsRequest() {}
+	SetStorageWriteBudgetsRequest(std::map<UID, double> budgets, double expireAfter)
+	  : budgets(std::move(budgets)), expireAfter(expireAfter) {}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, budgets, expireAfter, reply);
+	}
+};
+
 // Instantiated in CommitProxyInterface.cpp
 extern template class GetEncryptCipherKeys<ClientDBInfo>;
 
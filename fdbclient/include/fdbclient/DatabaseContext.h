@@ -44,7 +44,7 @@
 #include "flow/TDMetric.actor.h"
 #include "fdbclient/EventTypes.actor.h"
 #include "fdbrpc/Smoother.h"
-#include "fdbrpc/DDSketch.h"
+#include "flow/DDSketch.h"
 
 class StorageServerInfo : public ReferencedInterface<StorageServerInterface> {
 public:
@@ -157,10 +157,16 @@ public:
 	WatchMetadata(Reference<const WatchParameters> parameters) : parameters(parameters) {}
 };
 
+// The part of a merged change feed read from one storage server, in the batches of versions it replied with. The merge
+// cursor reads next from nextIndex on, and waits for the next batch from results once it has read all of it, until
+// results ends.
 struct MutationAndVersionStream {
-	Standalone<MutationsAndVersionRef> next;
-	PromiseStream<Standalone<MutationsAndVersionRef>> results;
-	bool operator<(MutationAndVersionStream const& rhs) const { return next.version > rhs.next.version; }
+	Standalone<VectorRef<MutationsAndVersionRef>> next;
+	int nextIndex = 0;
+	PromiseStream<Standalone<VectorRef<MutationsAndVersionRef>>> results;
+
+	// MAX_VERSION once all of next has been read
+	Version nextVersion() const { return nextIndex < next.size() ? next[nextIndex].version : MAX_VERSION; }
 };
 
 struct ChangeFeedStorageData : ReferenceCounted<ChangeFeedStorageData> {
@@ -306,6 +312,13 @@ public:
 	                        int limit,
 	                        Reverse reverse);
 	Reference<LocationInfo> setCachedLocation(const KeyRangeRef&, const std::vector<struct StorageServerInterface>&);
+	// Caches the locations of consecutive shards, as returned by GetKeyServerLocationsRequest
+	std::vector<Reference<LocationInfo>> setCachedLocations(
+	    const std::vector<std::pair<KeyRangeRef, std::vector<struct StorageServerInterface>>>& locations);
+	// Returns the cached locations, for a later client to warm its cache with by loadLocationCache(). Locations from a
+	// snapshot are used like any other cached locations, so stale ones are refreshed by the usual invalidation.
+	Standalone<StringRef> serializeLocationCache();
+	void loadLocationCache(StringRef snapshot);
 	void invalidateCache(const Optional<KeyRef>& tenantPrefix, const KeyRef& key, Reverse isBackward = Reverse::False);
 	void invalidateCache(const Optional<KeyRef>& tenantPrefix, const KeyRangeRef& keys);
 
@@ -524,6 +537,31 @@ public:
 	};
 	std::map<uint32_t, VersionBatcher> versionBatcher;
 
+	// Batching of waits on the metrics of shards, into WaitShardMetricsRequests to each storage server
+	struct ShardMetricsWait {
+		KeyRange keys;
+		StorageMetrics min, max;
+		Promise<StorageMetrics> reply;
+	};
+	struct ShardMetricsBatcher {
+		StorageServerInterface ssi; // The latest interface of the storage server
+		PromiseStream<ShardMetricsWait> stream;
+		Future<Void> actor;
+	};
+	std::map<UID, ShardMetricsBatcher> shardMetricsBatchers; // UID is the storage server ID
+
+	// Batching of the change feed streams to each storage server, into ChangeFeedMultiStreamRequests
+	struct ChangeFeedStreamSubscriber {
+		ChangeFeedStreamRequest req; // req.reply is a local stream that gets the feed's part of the replies
+		Future<Void> active; // Broken once the feed's stream is no longer used
+	};
+	struct ChangeFeedStreamBatcher {
+		StorageServerInterface ssi; // The latest interface of the storage server
+		PromiseStream<ChangeFeedStreamSubscriber> stream;
+		Future<Void> actor;
+	};
+	std::map<UID, ChangeFeedStreamBatcher> changeFeedStreamBatchers; // UID is the storage server ID
+
 	AsyncTrigger connectionFileChangedTrigger;
 
 	// Disallow any reads at a read version lower than minAcceptableReadVersion.  This way the client does not have to
@@ -543,6 +581,8 @@ public:
 	// Cache of location information
 	int locationCacheSize;
 	CoalescedKeyRangeMap<Reference<LocationInfo>> locationCache;
+	Reference<LocationInfo> makeLocationInfo(const std::vector<struct StorageServerInterface>& servers);
+	void evictCachedLocations(int toInsert);
 	std::unordered_map<Endpoint, EndpointFailureInfo> failedEndpointsOnHealthyServersInfo;
 
 	std::map<UID, StorageServerInfo*> server_interf;
@@ -602,6 +642,10 @@ public:
 	Counter transactionGetRangeRequests;
 	Counter transactionGetMappedRangeRequests;
 	Counter transactionGetRangeStreamRequests;
+	Counter transactionGetRangeParallelRequests;
+	Counter transactionMutationBatches; // Batches of mutations ThreadSafeTransaction handed to the network thread
+	Counter transactionBatchedMutations;
+	Counter transactionCompressedCommits;
 	Counter transactionWatchRequests;
 	Counter transactionGetAddressesForKeyRequests;
 	Counter transactionBytesRead;
@@ -642,6 +686,10 @@ public:
 	Counter bgReadRowsCleared;
 	Counter bgReadRowsInserted;
 	Counter bgReadRowsUpdated;
+	Counter bgReadFileCacheHits;
+	Counter bgReadFileCacheMisses;
+	Counter bgReadFileCacheHitBytes;
+	Counter bgReadFileCacheMissBytes;
 	DDSketch<double> bgLatencies, bgGranulesPerRequest;
 
 	// Change Feed metrics. Omit change feed metrics from logging if not used
@@ -730,6 +730,8 @@ struct GetRangeLimits {
 	int rows;
 	int minRows;
 	int bytes;
+	// Read the shards of the range in parallel, as requested by the PARALLEL streaming mode
+	bool parallel = false;
 
 	GetRangeLimits() : rows(ROW_LIMIT_UNLIMITED), minRows(1), bytes(BYTE_LIMIT_UNLIMITED) {}
 	explicit GetRangeLimits(int rowLimit) : rows(rowLimit), minRows(1), bytes(BYTE_LIMIT_UNLIMITED) {}
@@ -1349,6 +1351,32 @@ struct DDMetricsRef {
 	}
 };
 
+// The bytes and sampled traffic of a bucket of consecutive shards in a slice of the hot-range heatmap. The buckets of a
+// slice are consecutive, each ending where the next begins and the last one at the end of the keyspace.
+struct HeatmapBucketRef {
+	double time; // when the slice was taken
+	KeyRef beginKey;
+	int64_t bytes;
+	int64_t bytesWrittenPerKSecond;
+	int64_t bytesReadPerKSecond;
+	int64_t opsReadPerKSecond;
+
+	HeatmapBucketRef() : time(0), bytes(0), bytesWrittenPerKSecond(0), bytesReadPerKSecond(0), opsReadPerKSecond(0) {}
+	HeatmapBucketRef(double time, KeyRef begin) : HeatmapBucketRef() {
+		this->time = time;
+		beginKey = begin;
+	}
+	HeatmapBucketRef(Arena& a, const HeatmapBucketRef& copyFrom)
+	  : time(copyFrom.time), beginKey(a, copyFrom.beginKey), bytes(copyFrom.bytes),
+	    bytesWrittenPerKSecond(copyFrom.bytesWrittenPerKSecond), bytesReadPerKSecond(copyFrom.bytesReadPerKSecond),
+	    opsReadPerKSecond(copyFrom.opsReadPerKSecond) {}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, time, beginKey, bytes, bytesWrittenPerKSecond, bytesReadPerKSecond, opsReadPerKSecond);
+	}
+};
+
 struct WorkerBackupStatus {
 	LogEpoch epoch;
 	Version version;
@@ -1732,6 +1760,7 @@ FDB_BOOLEAN_PARAM(CacheResult);
 // cacheResult determines whether the storage engine cache for this read
 // consistencyCheckStartVersion indicates the consistency check which began at this version
 // debugID helps to trace the path of the read
+// budget is how long the storage server may queue the read for, from when it receives it, before dropping it
 struct ReadOptions {
 	ReadType type;
 	// Once CacheResult is serializable, change type from bool to CacheResult
@@ -1739,6 +1768,10 @@ struct ReadOptions {
 	bool lockAware = false;
 	Optional<UID> debugID;
 	Optional<Version> consistencyCheckStartVersion;
+	Optional<double> budget;
+	// Reads at versions older than the storage servers' in-memory window are served from the snapshot they pinned
+	// for the read version, if they did
+	bool longSnapshot = false;
 
 	ReadOptions(Optional<UID> debugID = Optional<UID>(),
 	            ReadType type = ReadType::NORMAL,
@@ -1750,7 +1783,7 @@ struct ReadOptions {
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		serializer(ar, type, cacheResult, debugID, consistencyCheckStartVersion, lockAware);
+		serializer(ar, type, cacheResult, debugID, consistencyCheckStartVersion, lockAware, budget, longSnapshot);
 	}
 };
 
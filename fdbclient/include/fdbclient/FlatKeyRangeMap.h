@@ -0,0 +1,236 @@
+/*
+ * FlatKeyRangeMap.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBCLIENT_FLATKEYRANGEMAP_H
+#define FDBCLIENT_FLATKEYRANGEMAP_H
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#include "boost/range.hpp"
+#include "fdbclient/FDBTypes.h"
+#include "flow/Arena.h"
+#include "flow/Platform.h"
+
+// FlatKeyRangeMap is a read only copy of the ranges of a KeyRangeMap, for maps that are looked up far more often than
+// they change. It is built in O(N) time and has the lookup interface of the const KeyRangeMap.
+//
+// The begin keys of the ranges are kept in a sorted array and searched through a binary search tree laid out in
+// Eytzinger (breadth first) order, so the first levels of every search share a few cache lines that stay hot and the
+// nodes two levels below the current one can be prefetched. Every key that can reach a node shares a prefix with the
+// bounds of its subtree, and the node holds the eight bytes of its key that follow that prefix. The keys themselves are
+// only compared when those bytes are equal. KeyRangeMap instead follows a pointer from tree node to tree node and
+// compares whole keys at every level.
+//
+// Values are copied into the map, so a map of iterators into a KeyRangeMap is only valid while it is unchanged.
+template <class Val>
+class FlatKeyRangeMap {
+public:
+	class const_iterator {
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = const_iterator;
+		using difference_type = int;
+		using pointer = const const_iterator*;
+		using reference = const const_iterator&;
+
+		const_iterator() : map(nullptr), index(0) {}
+
+		KeyRef begin() const { return map->keys[index]; }
+		KeyRef end() const { return map->keys[index + 1]; }
+		KeyRangeRef range() const { return KeyRangeRef(begin(), end()); }
+		const Val& value() const { return map->values[index]; }
+		const Val& cvalue() const { return value(); }
+
+		void operator++() { ++index; }
+		void operator--() { --index; }
+		bool operator==(const const_iterator& r) const { return index == r.index; }
+		bool operator!=(const const_iterator& r) const { return index != r.index; }
+
+		// operator* and -> return this, as for RangeMap iterators
+		const const_iterator& operator*() const { return *this; }
+		const const_iterator* operator->() const { return this; }
+
+	private:
+		friend class FlatKeyRangeMap;
+		const FlatKeyRangeMap* map;
+		int index;
+
+		const_iterator(const FlatKeyRangeMap* map, int index) : map(map), index(index) {}
+	};
+	using Ranges = boost::iterator_range<const_iterator>;
+
+	FlatKeyRangeMap() = default;
+	// Copies the ranges and values of map, which may be any RangeMap
+	template <class Map>
+	explicit FlatKeyRangeMap(const Map& map) {
+		reserve(map.size());
+		for (auto r : map.ranges()) {
+			push_back(r.begin(), r.cvalue());
+		}
+		finish(map.ranges().end().begin());
+	}
+
+	// To build a map, push_back() the ranges in order from the one beginning at the empty key, then finish() with the
+	// end of the last one. The map can't be searched in between.
+	void clear() {
+		keys.clear();
+		values.clear();
+		nodes.clear();
+		arena = Arena();
+	}
+	void reserve(int ranges) {
+		keys.reserve(ranges + 1);
+		values.reserve(ranges);
+	}
+	void push_back(KeyRef begin, const Val& value) {
+		ASSERT(keys.empty() ? begin.empty() : keys.back() < begin);
+		keys.push_back(KeyRef(arena, begin));
+		values.push_back(value);
+	}
+	void finish(KeyRef end);
+
+	int size() const { return values.size(); }
+	bool empty() const { return values.empty(); }
+	KeyRef mapEnd() const { return keys.back(); }
+
+	Ranges ranges() const { return Ranges(const_iterator(this, 0), const_iterator(this, size())); }
+	const_iterator rangeContaining(KeyRef key) const { return const_iterator(this, indexOf(key)); }
+	// Returns the range containing a key infinitesimally before key, or the first range if key is empty
+	const_iterator rangeContainingKeyBefore(KeyRef key) const {
+		int i = lowerBound(key);
+		return const_iterator(this, i ? i - 1 : i);
+	}
+	// Returns [begin, end] where begin <= r.begin and end >= r.end
+	Ranges intersectingRanges(KeyRangeRef r) const {
+		return Ranges(rangeContaining(r.begin), const_iterator(this, lowerBound(r.end)));
+	}
+	const Val& operator[](KeyRef key) const { return values[indexOf(key)]; }
+
+	// Returns the index of the range containing key, which must be less than mapEnd()
+	int indexOf(KeyRef key) const;
+	// Returns the index of the first range beginning at or after key, or size()
+	int lowerBound(KeyRef key) const {
+		if (!(key < mapEnd())) {
+			return size();
+		}
+		int i = indexOf(key);
+		return keys[i] == key ? i : i + 1;
+	}
+
+	int64_t getBytes() const {
+		return arena.getSize() + keys.capacity() * sizeof(KeyRef) + values.capacity() * sizeof(Val) +
+		       nodes.capacity() * sizeof(Node);
+	}
+
+private:
+	Arena arena;
+	// The begin key of each range, followed by the end of the last range
+	std::vector<KeyRef> keys;
+	std::vector<Val> values;
+	// The search tree over the begin keys of all ranges but the first, which begins at the empty key. Node k >= 1 has
+	// children 2k and 2k+1, and its key is greater than those of its left subtree and less than those of its right
+	// subtree. Node 0 is unused.
+	struct Node {
+		// The bytes of the key from offset on, zero padded to eight, as a big endian integer
+		uint64_t window;
+		// The length of the prefix shared by the bounds of the subtree, and so by every key in it or searched for in it
+		int offset;
+		int index; // of the key in keys
+	};
+	std::vector<Node> nodes;
+
+	// Comparing the windows of two keys with the same prefix of length offset orders them correctly, unless the windows
+	// are equal
+	static uint64_t keyWindow(KeyRef key, int offset) {
+		uint64_t window = 0;
+		if (key.size() >= offset + (int)sizeof(window)) {
+			memcpy(&window, key.begin() + offset, sizeof(window));
+		} else if (key.size() > offset) {
+			memcpy(&window, key.begin() + offset, key.size() - offset);
+		}
+		return bigEndian64(window);
+	}
+
+	// Assigns the keys from next on, in order, to the subtree of node k, and returns the key after them
+	int assignKeys(int k, int next);
+	// Fills in the subtree of node k, which is searched for keys in [lower, upper)
+	void fillNodes(int k, KeyRef lower, KeyRef upper);
+};
+
+template <class Val>
+void FlatKeyRangeMap<Val>::finish(KeyRef end) {
+	ASSERT(!keys.empty() && keys.back() < end);
+	keys.push_back(KeyRef(arena, end));
+	nodes.assign(size(), Node());
+	int last = assignKeys(1, 1);
+	ASSERT(last == size());
+	fillNodes(1, keys.front(), end);
+}
+
+template <class Val>
+int FlatKeyRangeMap<Val>::assignKeys(int k, int next) {
+	if (k < size()) {
+		next = assignKeys(2 * k, next);
+		nodes[k].index = next++;
+		next = assignKeys(2 * k + 1, next);
+	}
+	return next;
+}
+
+template <class Val>
+void FlatKeyRangeMap<Val>::fillNodes(int k, KeyRef lower, KeyRef upper) {
+	if (k < size()) {
+		Node& node = nodes[k];
+		node.offset = commonPrefixLength(lower, upper);
+		node.window = keyWindow(keys[node.index], node.offset);
+		fillNodes(2 * k, lower, keys[node.index]);
+		fillNodes(2 * k + 1, keys[node.index], upper);
+	}
+}
+
+template <class Val>
+int FlatKeyRangeMap<Val>::indexOf(KeyRef key) const {
+	const unsigned n = size() - 1;
+	const Node* tree = nodes.data();
+	unsigned k = 1;
+	while (k <= n) {
+		// The descendants of k two levels down are in four consecutive nodes
+		_mm_prefetch((const char*)(tree + std::min(4 * k, n)), _MM_HINT_T0);
+		const Node& node = tree[k];
+		const uint64_t window = keyWindow(key, node.offset);
+		// Which way to go is unpredictable, but equal windows are rare, so the only branch is well predicted
+		bool right = window > node.window;
+		if (window == node.window) [[unlikely]] {
+			right = !(key < keys[node.index]);
+		}
+		k = 2 * k + right;
+	}
+	// k went right (past a begin key <= key) at every level below the last node that went left, which has the first
+	// begin key greater than key. If there is none, the last range contains key.
+	k >>= std::countr_one(k) + 1;
+	return k ? tree[k].index - 1 : n;
+}
+
+#endif
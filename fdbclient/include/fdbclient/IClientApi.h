@@ -108,6 +108,12 @@ public:
 	virtual void clear(const KeyRangeRef& range) = 0;
 	virtual void clear(const KeyRef& key) = 0;
 
+	// Performs the mutations in order, then reads the keys, as a single operation. The result has the keys read that
+	// have values, with their values, in the order they were given.
+	virtual ThreadFuture<RangeResult> batch(VectorRef<MutationRef> const& mutations,
+	                                        VectorRef<KeyRef> const& reads,
+	                                        bool snapshot = false) = 0;
+
 	virtual ThreadFuture<Void> watch(const KeyRef& key) = 0;
 
 	virtual void addWriteConflictRange(const KeyRangeRef& keys) = 0;
@@ -74,6 +74,19 @@ public:
 	                                                int maxLength,
 	                                                Optional<ReadOptions> options = Optional<ReadOptions>()) = 0;
 
+	// Like readValuePrefix() for each (key, maxLength) pair, with the results in the same order as keys. The keys must
+	// remain valid until the returned future is ready. Engines that can look many keys up at once override this.
+	virtual Future<std::vector<Optional<Value>>> readValuePrefixes(
+	    std::vector<std::pair<KeyRef, int>> const& keys,
+	    Optional<ReadOptions> options = Optional<ReadOptions>()) {
+		std::vector<Future<Optional<Value>>> values;
+		values.reserve(keys.size());
+		for (auto const& [key, maxLength] : keys) {
+			values.push_back(readValuePrefix(key, maxLength, options));
+		}
+		return getAll(values);
+	}
+
 	// If rowLimit>=0, reads first rows sorted ascending, otherwise reads last rows sorted descending
 	// The total size of the returned value (less the last entry) will be less than byteLimit
 	virtual Future<RangeResult> readRange(KeyRangeRef keys,
@@ -81,6 +94,62 @@ public:
 	                                      int byteLimit = 1 << 30,
 	                                      Optional<ReadOptions> options = Optional<ReadOptions>()) = 0;
 
+	// Like readRange, for callers which only need the keys, such as key selector resolution. Values may be returned
+	// empty, and byteLimit counts the bytes returned, so engines which can skip values read fewer bytes and return more
+	// keys.
+	virtual Future<RangeResult> readKeys(KeyRangeRef keys,
+	                                     int rowLimit = 1 << 30,
+	                                     int byteLimit = 1 << 30,
+	                                     Optional<ReadOptions> options = Optional<ReadOptions>()) {
+		return readRange(keys, rowLimit, byteLimit, options);
+	}
+
+	// Pins the state of the store as of the last commit, so that readValueAtSnapshot() and readRangeAtSnapshot() can
+	// still read it after later commits, until unpinSnapshot(). Returns the id of the snapshot, or -1 if the store
+	// can't keep snapshots. Must not be called while a commit is in progress. A pinned snapshot keeps the space of what
+	// later commits overwrite or clear from being reused.
+	virtual int64_t pinSnapshot() { return -1; }
+	virtual void unpinSnapshot(int64_t snapshot) {}
+
+	// Like readValue() and readRange(), but of a snapshot returned by pinSnapshot(). Reads already started at a
+	// snapshot finish even if it is unpinned.
+	virtual Future<Optional<Value>> readValueAtSnapshot(int64_t snapshot,
+	                                                    KeyRef key,
+	                                                    Optional<ReadOptions> options = Optional<ReadOptions>()) {
+		throw not_implemented();
+	}
+	virtual Future<RangeResult> readRangeAtSnapshot(int64_t snapshot,
+	                                                KeyRangeRef keys,
+	                                                int rowLimit = 1 << 30,
+	                                                int byteLimit = 1 << 30,
+	                                                Optional<ReadOptions> options = Optional<ReadOptions>()) {
+		throw not_implemented();
+	}
+
+	// Whether the store keeps the versions it is written at, so that readValueAtVersion() and readRangeAtVersion()
+	// can read the state as of any version from setOldestReadableVersion() on. Writes are tagged with the version of
+	// the last setWriteVersion(), which must not decrease, and must be at least the largest version already written
+	// when writing resumes after a restart.
+	virtual bool keepsVersions() const { return false; }
+	virtual void setWriteVersion(Version version) {}
+	// Versions before version won't be read anymore, so the store may discard what only they can see
+	virtual void setOldestReadableVersion(Version version) {}
+
+	// Like readValue() and readRange(), but of the state as of a committed version. Throw transaction_too_old for
+	// versions the store no longer has.
+	virtual Future<Optional<Value>> readValueAtVersion(Version version,
+	                                                   KeyRef key,
+	                                                   Optional<ReadOptions> options = Optional<ReadOptions>()) {
+		throw not_implemented();
+	}
+	virtual Future<RangeResult> readRangeAtVersion(Version version,
+	                                               KeyRangeRef keys,
+	                                               int rowLimit = 1 << 30,
+	                                               int byteLimit = 1 << 30,
+	                                               Optional<ReadOptions> options = Optional<ReadOptions>()) {
+		throw not_implemented();
+	}
+
 	// Shard management APIs.
 	// Adds key range to a physical shard.
 	virtual Future<Void> addRange(KeyRangeRef range, std::string id, bool active = true) { return Void(); }
@@ -110,6 +179,13 @@ public:
 	// Returns the amount of free and total space for this store, in bytes
 	virtual StorageBytes getStorageBytes() const = 0;
 
+	// For stores which free cleared ranges in the background, returns (1) how many cleared subtrees are waiting to be
+	// freed (2) how many bytes have been freed since the store was opened
+	virtual std::pair<int64_t, int64_t> getLazyClearProgress() const { return std::make_pair(0, 0); }
+
+	// For LSM stores, returns an estimate of the bytes compaction has yet to rewrite
+	virtual int64_t getCompactionDebt() const { return 0; }
+
 	virtual void logRecentRocksDBBackgroundWorkStats(UID ssId, std::string logReason) { throw not_implemented(); }
 
 	virtual void resyncLog() {}
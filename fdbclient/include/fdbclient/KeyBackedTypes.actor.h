@@ -230,7 +230,7 @@ struct ObjectCodec {
 	VersionOptions vo;
 
 	inline Standalone<StringRef> pack(T const& val) const { return ObjectWriter::toValue<T>(val, vo); }
-	inline T unpack(Standalone<StringRef> const& val) const { return ObjectReader::fromStringRef<T>(val, vo); }
+	inline T unpack(Standalone<StringRef> const& val) const { return ArenaObjectReader::fromStringRef<T>(val, vo); }
 };
 
 template <typename ResultType>
@@ -101,6 +101,15 @@ struct FdbCApi : public ThreadSafeReferenceCounted<FdbCApi> {
 	} FDBGranuleSummary;
 #pragma pack(pop)
 
+	typedef struct batchoperation {
+		int type;
+		int atomicType;
+		const uint8_t* key;
+		int keyLength;
+		const uint8_t* param;
+		int paramLength;
+	} FDBBatchOperation;
+
 	typedef struct readgranulecontext {
 		// User context to pass along to functions
 		void* userContext;
@@ -406,6 +415,11 @@ struct FdbCApi : public ThreadSafeReferenceCounted<FdbCApi> {
 	                                               int64_t summaryVersion,
 	                                               int rangeLimit);
 
+	FDBFuture* (*transactionBatch)(FDBTransaction* tr,
+	                               FDBBatchOperation const* operations,
+	                               int operationCount,
+	                               fdb_bool_t snapshot);
+
 	FDBFuture* (*transactionCommit)(FDBTransaction* tr);
 	fdb_error_t (*transactionGetCommittedVersion)(FDBTransaction* tr, int64_t* outVersion);
 	FDBFuture* (*transactionGetTagThrottledDuration)(FDBTransaction* tr);
@@ -529,6 +543,9 @@ public:
 	void clear(const KeyRef& begin, const KeyRef& end) override;
 	void clear(const KeyRangeRef& range) override;
 	void clear(const KeyRef& key) override;
+	ThreadFuture<RangeResult> batch(VectorRef<MutationRef> const& mutations,
+	                                VectorRef<KeyRef> const& reads,
+	                                bool snapshot = false) override;
 
 	ThreadFuture<Void> watch(const KeyRef& key) override;
 
@@ -768,6 +785,9 @@ public:
 	void clear(const KeyRef& begin, const KeyRef& end) override;
 	void clear(const KeyRangeRef& range) override;
 	void clear(const KeyRef& key) override;
+	ThreadFuture<RangeResult> batch(VectorRef<MutationRef> const& mutations,
+	                                VectorRef<KeyRef> const& reads,
+	                                bool snapshot = false) override;
 
 	ThreadFuture<Void> watch(const KeyRef& key) override;
 
@@ -1165,6 +1185,75 @@ public:
 	friend class MultiVersionTransaction;
 };
 
+// An implementation of IDatabase that spreads the work of one database over every client thread, used when the
+// distribute_database_across_client_threads network option is set. It wraps one MultiVersionDatabase per client thread,
+// each with its own connections and location cache, and assigns transactions and tenants to them in turn. As with any
+// databases for the same cluster, they share cached read versions through a DatabaseSharedState. Operations on the
+// database itself go to the first thread's database; options are set on all of them.
+class MultiThreadDatabase final : public IDatabase, ThreadSafeReferenceCounted<MultiThreadDatabase> {
+public:
+	explicit MultiThreadDatabase(std::vector<Reference<IDatabase>> dbs) : dbs(std::move(dbs)) {}
+
+	Reference<ITenant> openTenant(TenantNameRef tenantName) override { return next()->openTenant(tenantName); }
+	Reference<ITransaction> createTransaction() override { return next()->createTransaction(); }
+	void setOption(FDBDatabaseOptions::Option option, Optional<StringRef> value = Optional<StringRef>()) override;
+	double getMainThreadBusyness() override;
+
+	ThreadFuture<ProtocolVersion> getServerProtocol(
+	    Optional<ProtocolVersion> expectedVersion = Optional<ProtocolVersion>()) override {
+		return dbs[0]->getServerProtocol(expectedVersion);
+	}
+
+	void addref() override { ThreadSafeReferenceCounted<MultiThreadDatabase>::addref(); }
+	void delref() override { ThreadSafeReferenceCounted<MultiThreadDatabase>::delref(); }
+
+	ThreadFuture<int64_t> rebootWorker(const StringRef& address, bool check, int duration) override {
+		return dbs[0]->rebootWorker(address, check, duration);
+	}
+	ThreadFuture<Void> forceRecoveryWithDataLoss(const StringRef& dcid) override {
+		return dbs[0]->forceRecoveryWithDataLoss(dcid);
+	}
+	ThreadFuture<Void> createSnapshot(const StringRef& uid, const StringRef& snapshot_command) override {
+		return dbs[0]->createSnapshot(uid, snapshot_command);
+	}
+
+	ThreadFuture<Key> purgeBlobGranules(const KeyRangeRef& keyRange, Version purgeVersion, bool force) override {
+		return dbs[0]->purgeBlobGranules(keyRange, purgeVersion, force);
+	}
+	ThreadFuture<Void> waitPurgeGranulesComplete(const KeyRef& purgeKey) override {
+		return dbs[0]->waitPurgeGranulesComplete(purgeKey);
+	}
+
+	ThreadFuture<bool> blobbifyRange(const KeyRangeRef& keyRange) override { return dbs[0]->blobbifyRange(keyRange); }
+	ThreadFuture<bool> blobbifyRangeBlocking(const KeyRangeRef& keyRange) override {
+		return dbs[0]->blobbifyRangeBlocking(keyRange);
+	}
+	ThreadFuture<bool> unblobbifyRange(const KeyRangeRef& keyRange) override {
+		return dbs[0]->unblobbifyRange(keyRange);
+	}
+	ThreadFuture<Standalone<VectorRef<KeyRangeRef>>> listBlobbifiedRanges(const KeyRangeRef& keyRange,
+	                                                                      int rangeLimit) override {
+		return dbs[0]->listBlobbifiedRanges(keyRange, rangeLimit);
+	}
+	ThreadFuture<Version> verifyBlobRange(const KeyRangeRef& keyRange, Optional<Version> version) override {
+		return dbs[0]->verifyBlobRange(keyRange, version);
+	}
+	ThreadFuture<bool> flushBlobRange(const KeyRangeRef& keyRange, bool compact, Optional<Version> version) override {
+		return dbs[0]->flushBlobRange(keyRange, compact, version);
+	}
+
+	ThreadFuture<DatabaseSharedState*> createSharedState() override { return dbs[0]->createSharedState(); }
+	void setSharedState(DatabaseSharedState* p) override { dbs[0]->setSharedState(p); }
+
+	ThreadFuture<Standalone<StringRef>> getClientStatus() override { return dbs[0]->getClientStatus(); }
+
+private:
+	Reference<IDatabase> const& next() { return dbs[nextDb.fetch_add(1, std::memory_order_relaxed) % dbs.size()]; }
+
+	const std::vector<Reference<IDatabase>> dbs;
+	std::atomic<unsigned> nextDb{ 0 };
+};
+
 // An implementation of IClientApi that can choose between multiple different client implementations either provided
 // locally within the primary loaded fdb_c client or through any number of dynamically loaded clients.
 //
@@ -1250,6 +1339,7 @@ private:
 
 	int nextThread = 0;
 	int threadCount;
+	bool distributeDatabases = false;
 	std::string tmpDir;
 	bool traceShareBaseNameAmongThreads;
 	std::string traceFileIdentifier;
@@ -310,6 +310,9 @@ struct TransactionState : ReferenceCounted<TransactionState> {
 
 	bool automaticIdempotency = false;
 
+	// The storage servers asked to keep a long snapshot at the read version, with the long_snapshot option
+	std::set<UID> longSnapshotServers;
+
 	Future<Void> startFuture;
 
 	// Only available so that Transaction can have a default constructor, for use in state variables
@@ -580,6 +583,10 @@ ACTOR Future<Version> waitForCommittedVersion(Database cx, Version version, Span
 ACTOR Future<Standalone<VectorRef<DDMetricsRef>>> waitDataDistributionMetricsList(Database cx,
                                                                                   KeyRange keys,
                                                                                   int shardLimit);
+// The buckets of the hot-range heatmap of data distribution intersecting keys, of the slices taken at or after since
+ACTOR Future<Standalone<VectorRef<HeatmapBucketRef>>> waitDataDistributionHeatmap(Database cx,
+                                                                                  KeyRange keys,
+                                                                                  double since);
 
 std::string unprintable(const std::string&);
 
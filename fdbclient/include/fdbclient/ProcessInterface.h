@@ -27,10 +27,11 @@ struct ProcessInterface {
 	constexpr static FileIdentifier file_identifier = 985636;
 	RequestStream<struct GetProcessInterfaceRequest> getInterface;
 	RequestStream<struct ActorLineageRequest> actorLineage;
+	RequestStream<struct HeapProfileRequest> heapProfile;
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		serializer(ar, actorLineage);
+		serializer(ar, actorLineage, heapProfile);
 	}
 };
 
@@ -78,3 +79,40 @@ struct ActorLineageRequest {
 		serializer(ar, waitStateStart, waitStateEnd, timeStart, timeEnd, reply);
 	}
 };
+
+// The live sampled allocations of one backtrace and role, as the process's heap profiler counts them
+struct HeapProfileSite {
+	constexpr static FileIdentifier file_identifier = 4213316;
+	std::string role;
+	std::string backtrace; // As platform::format_backtrace() formats it
+	int64_t liveSamples = 0;
+	int64_t liveBytes = 0;
+	int64_t allocatedBytes = 0;
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, role, backtrace, liveSamples, liveBytes, allocatedBytes);
+	}
+};
+
+struct HeapProfileReply {
+	constexpr static FileIdentifier file_identifier = 9963291;
+	int64_t sampleBytes = 0; // 0 if the profiler isn't sampling
+	std::vector<HeapProfileSite> sites; // By decreasing live bytes
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, sampleBytes, sites);
+	}
+};
+
+struct HeapProfileRequest {
+	constexpr static FileIdentifier file_identifier = 14722080;
+	int limit = std::numeric_limits<int>::max(); // The most sites to return
+	ReplyPromise<HeapProfileReply> reply;
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, limit, reply);
+	}
+};
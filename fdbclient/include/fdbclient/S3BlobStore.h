@@ -73,7 +73,8 @@ struct hash<BlobStoreConnectionPoolKey> {
 class S3BlobStoreEndpoint : public ReferenceCounted<S3BlobStoreEndpoint> {
 public:
 	struct Stats {
-		Stats() : requests_successful(0), requests_failed(0), bytes_sent(0) {}
+		Stats()
+		  : requests_successful(0), requests_failed(0), bytes_sent(0), connections_new(0), connections_reused(0) {}
 		Stats operator-(const Stats& rhs);
 		void clear() { memset(this, 0, sizeof(*this)); }
 		json_spirit::mObject getJSON();
@@ -81,6 +82,8 @@ public:
 		int64_t requests_successful;
 		int64_t requests_failed;
 		int64_t bytes_sent;
+		int64_t connections_new;
+		int64_t connections_reused;
 	};
 
 	static Stats s_stats;
@@ -94,6 +97,10 @@ public:
 		Counter expiredConnections;
 		Counter reusedConnections;
 		Counter fastRetries;
+		Counter prewarmedConnections;
+		Counter bytesUploaded;
+		Counter uploadConcurrencyIncreases;
+		Counter uploadConcurrencyDecreases;
 
 		LatencySample requestLatency;
 
@@ -104,6 +111,9 @@ public:
 		    requestsSuccessful("RequestsSuccessful", cc), requestsFailed("RequestsFailed", cc),
 		    newConnections("NewConnections", cc), expiredConnections("ExpiredConnections", cc),
 		    reusedConnections("ReusedConnections", cc), fastRetries("FastRetries", cc),
+		    prewarmedConnections("PrewarmedConnections", cc), bytesUploaded("BytesUploaded", cc),
+		    uploadConcurrencyIncreases("UploadConcurrencyIncreases", cc),
+		    uploadConcurrencyDecreases("UploadConcurrencyDecreases", cc),
 		    requestLatency("BlobStoreRequestLatency",
 		                   id,
 		                   CLIENT_KNOBS->BLOBSTORE_LATENCY_LOGGING_INTERVAL,
@@ -147,7 +157,7 @@ public:
 		    concurrent_uploads, concurrent_lists, concurrent_reads_per_file, concurrent_writes_per_file,
 		    enable_read_cache, read_block_size, read_ahead_blocks, read_cache_blocks_per_file,
 		    max_send_bytes_per_second, max_recv_bytes_per_second, sdk_auth, global_connection_pool,
-		    max_delay_retryable_error, max_delay_connection_failed;
+		    max_delay_retryable_error, max_delay_connection_failed, max_concurrent_uploads, prewarm_connections;
 
 		bool set(StringRef name, int value);
 		std::string getURLParameters() const;
@@ -172,6 +182,8 @@ public:
 				"operation-specific concurrency limits.",
 				"concurrent_uploads (or cu)            Max concurrent uploads (part or whole) that can be in progress "
 				"at once.",
+				"max_concurrent_uploads (or mcu)       If greater than concurrent_uploads, the number of uploads in "
+				"progress at once adapts to throughput and errors between the two.",
 				"concurrent_lists (or cl)              Max concurrent list operations that can be in progress at once.",
 				"concurrent_reads_per_file (or crps)   Max concurrent reads in progress for any one file.",
 				"concurrent_writes_per_file (or cwps)  Max concurrent uploads in progress for any one file.",
@@ -187,7 +199,8 @@ public:
 				"failure.",
 				"sdk_auth (or sa)                      Use AWS SDK to resolve credentials. Only valid if "
 				"BUILD_AWS_BACKUP is enabled.",
-				"global_connection_pool (or gcp)       Enable shared connection pool between all blobstore instances."
+				"global_connection_pool (or gcp)       Enable shared connection pool between all blobstore instances.",
+				"prewarm_connections (or pwc)          Number of idle connections to open ahead of requests."
 			};
 		}
 
@@ -202,6 +215,8 @@ public:
 	// basically, reference counted queue with option to add other fields
 	struct ConnectionPoolData : NonCopyable, ReferenceCounted<ConnectionPoolData> {
 		std::queue<ReusableConnection> pool;
+		// Connections being opened to refill the pool, which count towards prewarm_connections
+		int warming = 0;
 	};
 
 	// global connection pool for multiple blobstore endpoints with same connection settings and request destination
@@ -226,7 +241,8 @@ public:
 	    requestRateDelete(new SpeedLimit(knobs.delete_requests_per_second, 1)),
 	    sendRate(new SpeedLimit(knobs.max_send_bytes_per_second, 1)),
 	    recvRate(new SpeedLimit(knobs.max_recv_bytes_per_second, 1)), concurrentRequests(knobs.concurrent_requests),
-	    concurrentUploads(knobs.concurrent_uploads), concurrentLists(knobs.concurrent_lists) {
+	    concurrentUploads(std::max(knobs.concurrent_uploads, knobs.max_concurrent_uploads)),
+	    concurrentLists(knobs.concurrent_lists), uploadConcurrency(knobs.concurrent_uploads) {
 
 		if (host.empty() || (proxyHost.present() != proxyPort.present()))
 			throw connection_string_invalid();
@@ -249,6 +265,9 @@ public:
 		ASSERT(connectionPool.isValid());
 
 		maybeStartStatsLogger();
+		if (knobs.max_concurrent_uploads > knobs.concurrent_uploads) {
+			uploadConcurrencyControl = adaptUploadConcurrency();
+		}
 	}
 
 	static std::string getURLFormat(bool withResource = false) {
@@ -280,6 +299,8 @@ public:
 	Reference<ConnectionPoolData> connectionPool;
 	Future<ReusableConnection> connect(bool* reusingConn);
 	void returnConnection(ReusableConnection& conn);
+	// Starts opening connections until the pool and the connections being opened reach prewarm_connections
+	void prewarmConnections();
 
 	std::string host;
 	std::string service;
@@ -306,6 +327,15 @@ public:
 	FlowLock concurrentUploads;
 	FlowLock concurrentLists;
 
+	// When max_concurrent_uploads is greater than concurrent_uploads, concurrentUploads has max_concurrent_uploads
+	// permits and uploadConcurrencyControl holds the ones above the current limit, uploadConcurrency. Uploads count
+	// the bytes they complete and the requests that fail, for each adjustment of the limit.
+	int uploadConcurrency;
+	int64_t uploadBytes = 0;
+	int64_t uploadFailures = 0;
+	Future<Void> uploadConcurrencyControl;
+	Future<Void> adaptUploadConcurrency();
+
 	Future<Void> updateSecret();
 
 	// Calculates the authentication string from the secret key
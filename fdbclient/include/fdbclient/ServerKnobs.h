@@ -88,9 +88,23 @@ public:
 	int64_t TLOG_SPILL_REFERENCE_MAX_PEEK_MEMORY_BYTES;
 	int64_t TLOG_SPILL_REFERENCE_MAX_BATCHES_PER_PEEK;
 	int64_t TLOG_SPILL_REFERENCE_MAX_BYTES_PER_BATCH;
+	bool TLOG_SPILL_REFERENCE_MESSAGE_INDEX; // Record where each tag's messages are in reference spilled commits
+	std::string TLOG_SPILL_VALUE_COMPRESSION_FILTER; // Compression for tags spilled by value, see CompressionUtils.h
+	int TLOG_SPILL_VALUE_COMPRESSION_MIN_BYTES; // Values smaller than this are spilled uncompressed
+	bool TLOG_GROUP_COMMIT_GENERATIONS; // One DiskQueue commit covers every generation with pending versions
+	bool PEEK_STREAM_ADAPTIVE_FLOW_CONTROL; // Size peek stream windows and replies from consumer drain rate
+	double PEEK_STREAM_WINDOW_SECONDS; // Seconds of a peek stream consumer's drain rate allowed unacknowledged
+	double PEEK_STREAM_DRAIN_RATE_SMOOTHING;
+	int64_t PEEK_STREAM_MIN_WINDOW_BYTES;
+	int PEEK_STREAM_MIN_REPLY_BYTES;
+	double PEEK_STREAM_MEMORY_PRESSURE_THRESHOLD; // Fraction of log memory above which peek streams are shrunk
 	int64_t DISK_QUEUE_FILE_EXTENSION_BYTES; // When we grow the disk queue, by how many bytes should it grow?
 	int64_t DISK_QUEUE_FILE_SHRINK_BYTES; // When we shrink the disk queue, by how many bytes should it shrink?
 	int64_t DISK_QUEUE_MAX_TRUNCATE_BYTES; // A truncate larger than this will cause the file to be replaced instead.
+	int DISK_QUEUE_PAGE_BUFFER_POOL_SIZE; // Committed page buffers a DiskQueue keeps to reuse for later commits
+	int64_t DISK_QUEUE_PAGE_BUFFER_MAX_POOLED_BYTES; // Larger page buffers are freed instead of kept for reuse
+	bool DISK_QUEUE_RECOVERY_READ_AHEAD; // Read the next chunk of a DiskQueue while recovery consumes the current one
+	int DISK_QUEUE_RECOVERY_READ_BYTES; // Size of each read of a DiskQueue during recovery
 	double TLOG_DEGRADED_DURATION;
 	int64_t MAX_CACHE_VERSIONS;
 	double TXS_POPPED_MAX_DELAY;
@@ -133,6 +147,13 @@ public:
 	double RELOCATION_PARALLELISM_PER_SOURCE_SERVER;
 	double RELOCATION_PARALLELISM_PER_DEST_SERVER;
 	double MERGE_RELOCATION_PARALLELISM_PER_TEAM;
+	bool DD_ADAPTIVE_RELOCATION_PARALLELISM; // Raise the relocation parallelism of servers that keep up with moves
+	double DD_ADAPTIVE_RELOCATION_INTERVAL; // How often the relocation parallelism of servers is adjusted
+	double DD_ADAPTIVE_RELOCATION_MAX_MULTIPLIER; // Most a server's relocation parallelism can be raised, as a multiple
+	                                              // of the configured parallelism
+	double DD_ADAPTIVE_RELOCATION_TARGET_RATE; // Bytes/sec a relocation must reach to raise its servers' parallelism
+	int64_t DD_ADAPTIVE_RELOCATION_MAX_STORAGE_QUEUE; // Servers with a longer storage queue get the configured
+	                                                  // relocation parallelism
 	int DD_QUEUE_MAX_KEY_SERVERS;
 	int DD_REBALANCE_PARALLELISM;
 	int DD_REBALANCE_RESET_AMOUNT;
@@ -162,6 +183,8 @@ public:
 	int PRIORITY_REBALANCE_READ_UNDERUTIL_TEAM;
 	// A load-balance priority storage queue too long
 	int PRIORITY_REBALANCE_STORAGE_QUEUE;
+	// A priority for moving a piece of a bulk load to the servers that load it from its files
+	int PRIORITY_BULK_LOAD;
 	// A team healthy priority for wiggle a storage server
 	int PRIORITY_PERPETUAL_STORAGE_WIGGLE;
 	// A team healthy priority when all servers in a team are healthy. When a team changes from any unhealthy states to
@@ -223,6 +246,8 @@ public:
 	bool ENABLE_DD_PHYSICAL_SHARD; // EXPERIMENTAL; If true, SHARD_ENCODE_LOCATION_METADATA must be true.
 	double DD_PHYSICAL_SHARD_MOVE_PROBABILITY; // Percentage of physical shard move, in the range of [0, 1].
 	bool ENABLE_PHYSICAL_SHARD_MOVE_EXPERIMENT;
+	bool DD_PHYSICAL_SHARD_MOVE_FOR_SHARDED_ROCKSDB; // If true, data moves are physical shard moves when all storage
+	                                                 // servers are configured to use sharded RocksDB
 	int64_t MAX_PHYSICAL_SHARD_BYTES;
 	double PHYSICAL_SHARD_METRICS_DELAY;
 	double ANONYMOUS_PHYSICAL_SHARD_TRANSITION_TIME;
@@ -249,6 +274,8 @@ public:
 	// shard metrics will update immediately
 	int64_t SHARD_READ_OPS_CHANGE_THRESHOLD;
 	bool ENABLE_WRITE_BASED_SHARD_SPLIT; // Experimental. Enable to enforce shard split when write traffic is high
+	bool DD_SPLIT_READ_HOT_SHARDS; // Experimental. Split read hot shards by their sampled read bandwidth
+	double DD_READ_HOT_SPLIT_COOLDOWN; // A shard split for being read hot isn't split again or merged for this long
 
 	double SHARD_MAX_READ_DENSITY_RATIO;
 	int64_t SHARD_READ_HOT_BANDWIDTH_MIN_PER_KSECONDS;
@@ -284,6 +311,11 @@ public:
 	double TSS_DD_CHECK_INTERVAL;
 	double DATA_DISTRIBUTION_LOGGING_INTERVAL;
 	double DD_ENABLED_CHECK_DELAY;
+	// Read the shard map at data distributor startup as ranges of about DD_INITIAL_LOAD_CHUNK_BYTES, with up to
+	// DD_INITIAL_LOAD_PARALLELISM of them read at once
+	bool DD_PARALLEL_INITIAL_LOAD;
+	int64_t DD_INITIAL_LOAD_CHUNK_BYTES;
+	int DD_INITIAL_LOAD_PARALLELISM;
 	double DD_STALL_CHECK_DELAY;
 	double DD_LOW_BANDWIDTH_DELAY;
 	double DD_MERGE_COALESCE_DELAY;
@@ -298,6 +330,9 @@ public:
 	int DD_FETCH_SOURCE_PARALLELISM;
 	int DD_MERGE_LIMIT;
 	double DD_SHARD_METRICS_TIMEOUT;
+	double DD_HEATMAP_INTERVAL; // How often the hot-range heatmap takes a slice of the shard metrics
+	int DD_HEATMAP_SLICES; // How many slices of the heatmap are kept
+	int DD_HEATMAP_BUCKETS; // How many buckets of about equal bytes a slice groups the shards into
 	int64_t DD_LOCATION_CACHE_SIZE;
 	double MOVEKEYS_LOCK_POLLING_DELAY;
 	double DEBOUNCE_RECRUITING_DELAY;
@@ -344,6 +379,10 @@ public:
 	int64_t REBALANCE_STORAGE_QUEUE_SHARD_PER_KSEC_MIN;
 	bool DD_ENABLE_REBALANCE_STORAGE_QUEUE_WITH_LIGHT_WRITE_SHARD; // Enable to allow storage queue rebalancer to move
 	                                                               // light-traffic shards out of the overloading server
+	double DD_BULK_LOAD_POLL_INTERVAL; // How often data distribution checks the progress of bulk loads
+	int64_t DD_BULK_LOAD_PIECE_BYTES; // Target size of the files of a piece of a bulk load, which is moved as a shard
+	double DD_BULK_LOAD_RELOCATE_DELAY; // How long to wait for a piece of a bulk load to move before moving it again
+	double DD_BULK_LOAD_MERGE_COOLDOWN; // How long shards of a bulk load can't be merged after it was last moved
 
 	// TeamRemover to remove redundant teams
 	bool TR_FLAG_DISABLE_MACHINE_TEAM_REMOVER; // disable the machineTeamRemover actor
@@ -409,6 +448,8 @@ public:
 	int SQLITE_WRITE_WINDOW_LIMIT;
 	double SQLITE_WRITE_WINDOW_SECONDS;
 	int64_t SQLITE_CURSOR_MAX_LIFETIME_BYTES;
+	int SQLITE_READ_AHEAD_PAGES; // Pages of the database file read ahead of a connection reading forward through it
+	int SQLITE_READ_AHEAD_FORWARD_READS; // Consecutive forward page reads that start read ahead
 
 	// KeyValueStoreSqlite spring cleaning
 	double SPRING_CLEANING_NO_ACTION_INTERVAL;
@@ -436,6 +477,7 @@ public:
 	int ROCKSDB_COMPACTION_THREAD_PRIORITY;
 	int ROCKSDB_BACKGROUND_PARALLELISM;
 	int ROCKSDB_READ_PARALLELISM;
+	bool ROCKSDB_WORK_STEALING_READ_THREADS; // Read threads take reads queued for other read threads when idle
 	int ROCKSDB_CHECKPOINT_READER_PARALLELISM;
 	int64_t ROCKSDB_MEMTABLE_BYTES;
 	bool ROCKSDB_LEVEL_STYLE_COMPACTION;
@@ -450,6 +492,10 @@ public:
 	int64_t ROCKSDB_BLOCK_CACHE_SIZE;
 	double ROCKSDB_CACHE_HIGH_PRI_POOL_RATIO;
 	bool ROCKSDB_CACHE_INDEX_AND_FILTER_BLOCKS;
+	// The block caches of both RocksDB engines are HyperClockCaches instead of LRUCaches
+	bool ROCKSDB_BLOCK_CACHE_HYPER_CLOCK;
+	// Size of the compressed secondary cache behind the block caches of both RocksDB engines, 0 to disable
+	int64_t ROCKSDB_COMPRESSED_SECONDARY_CACHE_SIZE;
 	double ROCKSDB_METRICS_DELAY;
 	double ROCKSDB_READ_VALUE_TIMEOUT;
 	double ROCKSDB_READ_VALUE_PREFIX_TIMEOUT;
@@ -457,6 +503,8 @@ public:
 	double ROCKSDB_READ_CHECKPOINT_TIMEOUT;
 	int64_t ROCKSDB_CHECKPOINT_READ_AHEAD_SIZE;
 	double ROCKSDB_READ_QUEUE_WAIT;
+	bool ROCKSDB_READ_VALUE_COALESCE; // Point reads issued in the same run loop task share one MultiGet
+	int ROCKSDB_READ_VALUE_COALESCE_MAX_KEYS; // A coalesced batch is posted as soon as it holds this many reads
 	int ROCKSDB_READ_QUEUE_SOFT_MAX;
 	int ROCKSDB_READ_QUEUE_HARD_MAX;
 	int ROCKSDB_FETCH_QUEUE_SOFT_MAX;
@@ -469,6 +517,14 @@ public:
 	bool SHARDED_ROCKSDB_REUSE_ITERATORS;
 	bool ROCKSDB_READ_RANGE_REUSE_BOUNDED_ITERATORS;
 	int ROCKSDB_READ_RANGE_BOUNDED_ITERATORS_MAX_LIMIT;
+	bool ROCKSDB_READ_RANGE_ASYNC_IO; // Range reads with readahead prefetch their next blocks asynchronously
+	// Forward range reads with at least this byte limit, or that continue an earlier read, get readahead; 0 disables
+	int64_t ROCKSDB_READ_RANGE_READAHEAD_MIN_BYTES;
+	int64_t ROCKSDB_READ_RANGE_READAHEAD_MAX_SIZE;
+	int ROCKSDB_READ_RANGE_READAHEAD_HISTORY; // Number of recent unfinished range reads remembered to detect scans
+	bool ROCKSDB_FETCH_INGEST_SST; // Fetched blocks are ingested as SST files instead of written through the memtable
+	int ROCKSDB_FETCH_INGEST_SST_MIN_BYTES; // Smaller fetched blocks are still written through the memtable
+	bool ROCKSDB_USER_DEFINED_TIMESTAMPS; // Writes are tagged with their versions, so old versions are read from disk
 	int64_t ROCKSDB_WRITE_RATE_LIMITER_BYTES_PER_SEC;
 	int ROCKSDB_WRITE_RATE_LIMITER_FAIRNESS;
 	bool ROCKSDB_WRITE_RATE_LIMITER_AUTO_TUNE;
@@ -560,6 +616,9 @@ public:
 	int SHARDED_ROCKSDB_TARGET_FILE_SIZE_BASE;
 	int SHARDED_ROCKSDB_TARGET_FILE_SIZE_MULTIPLIER;
 	bool SHARDED_ROCKSDB_SUGGEST_COMPACT_CLEAR_RANGE;
+	// Deletes the files wholly in a range removed from a physical shard which keeps other ranges, instead of leaving
+	// them to compactions
+	bool SHARDED_ROCKSDB_DELETE_REMOVED_RANGE_FILES;
 	int SHARDED_ROCKSDB_MAX_BACKGROUND_JOBS;
 	int64_t SHARDED_ROCKSDB_BLOCK_CACHE_SIZE;
 	int64_t SHARDED_ROCKSDB_WRITE_RATE_LIMITER_BYTES_PER_SEC;
@@ -573,6 +632,20 @@ public:
 	int SHARDED_ROCKSDB_MAX_OPEN_FILES;
 	bool SHARDED_ROCKSDB_READ_ASYNC_IO;
 	int SHARDED_ROCKSDB_PREFIX_LEN;
+	// Picks the filter and block size of each physical shard from the shard's mix of point reads and range reads
+	bool SHARDED_ROCKSDB_ADAPTIVE_FILTERS;
+	double SHARDED_ROCKSDB_FILTER_TUNE_INTERVAL;
+	int SHARDED_ROCKSDB_FILTER_TUNE_MIN_READS; // Shards with fewer recent reads keep their current options
+	double SHARDED_ROCKSDB_POINT_READ_SHARD_RATIO; // Shards with at least this fraction of point reads are point read
+	double SHARDED_ROCKSDB_SCAN_SHARD_RATIO; // Shards with at most this fraction of point reads are scanned
+	double SHARDED_ROCKSDB_POINT_READ_FILTER_BITS; // Bloom equivalent bits per key of point read shards' ribbon filters
+	int SHARDED_ROCKSDB_SCAN_BLOCK_SIZE;
+	// Defers the compactions of physical shards which have compaction debt but serve no reads, such as bulk loaded ones
+	bool SHARDED_ROCKSDB_COMPACTION_SCHEDULER;
+	double SHARDED_ROCKSDB_COMPACTION_SCHEDULER_INTERVAL;
+	int64_t SHARDED_ROCKSDB_COMPACTION_DEFER_DEBT; // Pending compaction bytes from which an unread shard is deferred
+	int64_t SHARDED_ROCKSDB_COMPACTION_MAX_DEFERRED_DEBT; // Pending compaction bytes at which a shard is resumed
+	double SHARDED_ROCKSDB_COMPACTION_MAX_DEFER_TIME;
 
 	// Leader election
 	int MAX_NOTIFICATIONS;
@@ -608,6 +681,13 @@ public:
 	double COMMIT_TRANSACTION_BATCH_INTERVAL_MAX;
 	double COMMIT_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION;
 	double COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA;
+	// p99 commit latency the commit batching interval is adjusted to meet; 0 disables the latency target
+	double COMMIT_BATCH_TARGET_P99_LATENCY;
+	double COMMIT_BATCH_CONTROLLER_WINDOW; // Seconds of commits each batching interval adjustment is based on
+	double COMMIT_BATCH_INTERVAL_STEP; // Factor the batching interval grows or shrinks by per adjustment
+	// Fraction of batch latency spent on resolvers and tlogs (or of batches queued behind the previous one) above
+	// which they, rather than the proxy, are considered the bottleneck
+	double COMMIT_BATCH_DOWNSTREAM_BOTTLENECK_FRACTION;
 	int COMMIT_TRANSACTION_BATCH_COUNT_MAX;
 	int COMMIT_TRANSACTION_BATCH_BYTES_MIN;
 	int COMMIT_TRANSACTION_BATCH_BYTES_MAX;
@@ -627,6 +707,9 @@ public:
 	double ENFORCED_MIN_RECOVERY_DURATION;
 	double REQUIRED_MIN_RECOVERY_DURATION;
 	bool ALWAYS_CAUSAL_READ_RISKY;
+	// Seconds for which a GRV proxy may answer causal read risky requests with the last committed version it got from
+	// the master instead of asking again; 0 asks the master for every batch
+	double GRV_CACHED_VERSION_LEASE;
 	int MAX_COMMIT_UPDATES;
 	double MAX_PROXY_COMPUTE;
 	double MAX_COMPUTE_PER_OPERATION;
@@ -634,9 +717,25 @@ public:
 	int PROXY_COMPUTE_BUCKETS;
 	double PROXY_COMPUTE_GROWTH_RATE;
 	int TXN_STATE_SEND_AMOUNT;
+	// Send the txnStateStore to commit proxies and resolvers in the TxnStateSnapshot encoding, compressed with
+	// TXN_STATE_SNAPSHOT_COMPRESSION_FILTER, rather than as key-values
+	bool TXN_STATE_SNAPSHOT_ENCODING;
+	std::string TXN_STATE_SNAPSHOT_COMPRESSION_FILTER;
 	double REPORT_TRANSACTION_COST_ESTIMATION_DELAY;
 	bool PROXY_REJECT_BATCH_QUEUED_TOO_LONG;
 	bool PROXY_USE_RESOLVER_PRIVATE_MUTATIONS;
+	// Number of helper threads that encrypt a resolved batch's mutations ahead of tag assignment; 0 encrypts
+	// mutations inline during tag assignment
+	int PROXY_ENCRYPTION_THREADS;
+	// Parts of a batch with fewer mutations are encrypted on the proxy thread rather than handed to a helper thread
+	int PROXY_ENCRYPTION_THREAD_MIN_MUTATIONS;
+	// Look up the tags of a batch's single key mutations in key order, walking the shard map once per batch
+	bool PROXY_SORTED_KEY_TAG_LOOKUP;
+	// Number of recently used shards the commit proxy checks before searching the shard map for a key's tags
+	int PROXY_KEY_TAG_CACHE_SIZE;
+	// The commit proxy searches a flat copy of the shard map once the map has gone unchanged for this many searches
+	// per shard, which pays for building the copy. Negative to always search the map itself.
+	double PROXY_FLAT_KEY_INFO_SEARCHES_PER_SHARD;
 	bool BURSTINESS_METRICS_ENABLED;
 	// Interval on which to emit burstiness metrics on the commit proxy (in
 	// seconds).
@@ -659,6 +758,10 @@ public:
 	int64_t MAX_TXS_SEND_MEMORY;
 	int64_t MAX_RECOVERY_VERSIONS;
 	double MAX_RECOVERY_TIME;
+	// Recruit the new transaction system from the cluster controller's configuration as soon as recovery has read the
+	// coordinated state, while it locks the old TLogs and reads the txnStateStore. The recruitment is used if the
+	// configuration read from the txnStateStore is the same and the workers are still available.
+	bool RECOVERY_EARLY_RECRUITMENT;
 	double PROVISIONAL_START_DELAY;
 	double PROVISIONAL_DELAY_GROWTH;
 	double PROVISIONAL_MAX_DELAY;
@@ -671,6 +774,9 @@ public:
 	double SAMPLE_EXPIRATION_TIME;
 	double SAMPLE_POLL_TIME;
 	int64_t RESOLVER_STATE_MEMORY_LIMIT;
+	int RESOLVER_CONFLICT_CHECK_THREADS; // Number of threads checking read conflict ranges, <= 1 checks inline
+	int RESOLVER_PARALLEL_CHECK_MIN_RANGES; // Batches with fewer read conflict ranges are always checked inline
+	bool RESOLVER_USE_ART_CONFLICT_SET; // Keep the resolver's version history in an adaptive radix tree instead of a SkipList
 
 	// Backup Worker
 	double BACKUP_TIMEOUT; // master's reaction time for backup failure
@@ -678,6 +784,7 @@ public:
 	int BACKUP_FILE_BLOCK_BYTES;
 	int64_t BACKUP_LOCK_BYTES;
 	double BACKUP_UPLOAD_DELAY;
+	int BACKUP_MAX_INFLIGHT_UPLOADS; // Mutation log uploads a backup worker runs at once, each for a version range
 
 	// Cluster Controller
 	double CLUSTER_CONTROLLER_LOGGING_DELAY;
@@ -752,6 +859,10 @@ public:
 	                                             // router is degraded and may use trigger recovery to recover from it.
 	double CC_THROTTLE_SINGLETON_RERECRUIT_INTERVAL; // The interval to prevent re-recruiting the same singleton if a
 	                                                 // recruiting fight between two cluster controllers occurs.
+	bool CC_STANDBY_RECRUITMENT; // When enabled, the cluster controller recruits the transaction system of the next
+	                             // recovery ahead of time, which the recovery uses if its workers are still available.
+	double CC_STANDBY_RECRUITMENT_INTERVAL; // How often the standby recruitment is refreshed. A standby recruitment
+	                                        // older than twice the interval is not used.
 
 	// Knobs used to select the best policy (via monte carlo)
 	int POLICY_RATING_TESTS; // number of tests per policy (in order to compare)
@@ -766,6 +877,7 @@ public:
 	double RECRUITMENT_TIMEOUT;
 	int DBINFO_SEND_AMOUNT;
 	double DBINFO_BATCH_DELAY;
+	bool DBINFO_BROADCAST_DELTAS; // Leave the unchanged large fields of ServerDBInfo out of broadcasts
 	double SINGLETON_RECRUIT_BME_DELAY;
 	bool RECORD_RECOVER_AT_IN_CSTATE;
 	bool TRACK_TLOG_RECOVERY;
@@ -802,6 +914,11 @@ public:
 	double RATEKEEPER_DEFAULT_LIMIT;
 	double RATEKEEPER_LIMIT_REASON_SAMPLE_RATE;
 	bool RATEKEEPER_PRINT_LIMIT_REASON;
+	// Control on the storage server and tlog queues forecast RATEKEEPER_PREDICTION_HORIZON seconds ahead from their
+	// input and durable rates, rather than on the current queues
+	bool RATEKEEPER_PREDICTIVE_CONTROL;
+	double RATEKEEPER_PREDICTION_HORIZON;
+	bool RATEKEEPER_RECORD_CONTROLLER_DECISIONS; // Trace the inputs and result of every rate update
 	double RATEKEEPER_MIN_RATE;
 	double RATEKEEPER_MAX_RATE;
 	double RATEKEEPER_BATCH_MIN_RATE;
@@ -813,11 +930,21 @@ public:
 	int64_t AUTO_TAG_THROTTLE_SPRING_BYTES_STORAGE_SERVER;
 	int64_t TARGET_BYTES_PER_STORAGE_SERVER_BATCH;
 	int64_t SPRING_BYTES_STORAGE_SERVER_BATCH;
+	double TARGET_READ_QUEUE_WAIT_BATCH; // seconds that normal and high priority reads wait for the read lock
+	double SPRING_READ_QUEUE_WAIT_BATCH;
 	int64_t STORAGE_HARD_LIMIT_BYTES;
 	int64_t STORAGE_HARD_LIMIT_BYTES_OVERAGE;
 	int64_t STORAGE_HARD_LIMIT_BYTES_SPEED_UP_SIM;
 	int64_t STORAGE_HARD_LIMIT_BYTES_OVERAGE_SPEED_UP_SIM;
 	int64_t STORAGE_HARD_LIMIT_VERSION_OVERAGE;
+	int64_t STORAGE_ADAPTIVE_MVCC_WINDOW_BYTES; // Storage queue bytes above which a storage server keeps fewer versions
+	                                            // in memory, down to STORAGE_MIN_MVCC_WINDOW_VERSIONS once the queue
+	                                            // reaches TARGET_BYTES_PER_STORAGE_SERVER
+	int64_t STORAGE_MIN_MVCC_WINDOW_VERSIONS;
+	int64_t STORAGE_VERSIONED_ENGINE_MVCC_WINDOW_VERSIONS; // Versions kept in memory with a storage engine which
+	                                                       // keeps versions itself
+	int STORAGE_LONG_SNAPSHOT_MAX_COUNT; // Long snapshots a storage server keeps pinned at once
+	double STORAGE_LONG_SNAPSHOT_MAX_AGE; // Seconds after which a storage server unpins a long snapshot
 	int64_t STORAGE_DURABILITY_LAG_HARD_MAX;
 	int64_t STORAGE_DURABILITY_LAG_SOFT_MAX;
 	bool STORAGE_INCLUDE_FEED_STORAGE_QUEUE;
@@ -892,11 +1019,20 @@ public:
 	double GLOBAL_TAG_THROTTLING_TRANSACTION_COUNT_FOLDING_TIME;
 	double GLOBAL_TAG_THROTTLING_TRANSACTION_RATE_FOLDING_TIME;
 	double GLOBAL_TAG_THROTTLING_COST_FOLDING_TIME;
+	// Charge tags for the bytes storage servers read from their engines, and for each engine call, instead of only for
+	// the bytes they return
+	bool GLOBAL_TAG_THROTTLING_ENGINE_READ_COST;
+	double GLOBAL_TAG_THROTTLING_PAGES_PER_ENGINE_READ; // Pages charged for each call into the storage engine
 
 	bool HOT_SHARD_THROTTLING_ENABLED;
 	double HOT_SHARD_THROTTLING_EXPIRE_AFTER;
 	int64_t HOT_SHARD_THROTTLING_TRACKED;
 	double HOT_SHARD_MONITOR_FREQUENCY;
+	// Throttle the transactions that write to a storage server whose queue is growing at the commit proxies, instead of
+	// lowering the cluster wide rate, until the queue passes its spring
+	bool STORAGE_WRITE_BUDGETS_ENABLED;
+	double STORAGE_WRITE_BUDGETS_INTERVAL; // How often ratekeeper sends the budgets to the commit proxies
+	double STORAGE_WRITE_BUDGETS_EXPIRE_AFTER; // How long commit proxies apply the budgets they receive
 
 	// allow generating synthetic data for test clusters
 	bool GENERATE_DATA_ENABLED;
@@ -976,6 +1112,7 @@ public:
 	// Storage Server
 	double STORAGE_LOGGING_DELAY;
 	double STORAGE_SERVER_POLL_METRICS_DELAY;
+	double STORAGE_SHARD_METRICS_POLL_INTERVAL; // How often the shards of a WaitShardMetricsRequest are checked
 	double FUTURE_VERSION_DELAY;
 	int STORAGE_LIMIT_BYTES;
 	int BUGGIFY_LIMIT_BYTES;
@@ -985,9 +1122,15 @@ public:
 	int FETCH_KEYS_PARALLELISM_BYTES;
 	int FETCH_KEYS_PARALLELISM;
 	int FETCH_KEYS_PARALLELISM_CHANGE_FEED;
+	int FETCH_KEYS_SUBRANGE_PARALLELISM; // Sub-range reads shared by the fetches holding fetchKeysParallelismLock
+	int64_t FETCH_KEYS_SUBRANGE_BYTES; // Size of the sub-ranges a fetch reads in parallel
+	double FETCH_KEYS_BULK_LOAD_RETRY_DELAY; // How long a fetch waits to retry after failing to read a bulk load file
 	int FETCH_KEYS_LOWER_PRIORITY;
 	int SERVE_FETCH_CHECKPOINT_PARALLELISM;
 	int SERVE_AUDIT_STORAGE_PARALLELISM;
+	int SERVE_AUDIT_STORAGE_REPLICA_PARALLELISM; // Replica audits a storage server runs at once
+	// Whether replica audits compare checksums of ranges first, and read the data of a range only when they differ
+	bool AUDIT_STORAGE_USE_CHECKSUMS;
 	int PERSIST_FINISH_AUDIT_COUNT; // Num of persist complete/failed audits for each type
 	int AUDIT_RETRY_COUNT_MAX;
 	int CONCURRENT_AUDIT_TASK_COUNT_MAX;
@@ -1010,11 +1153,17 @@ public:
 	int STORAGE_FETCH_BYTES;
 	int STORAGE_ROCKSDB_FETCH_BYTES;
 	double STORAGE_COMMIT_INTERVAL;
+	bool STORAGE_PIPELINED_COMMIT; // If true, storage servers on Redwood or RocksDB write the mutations of the next
+	                               // commit to the engine while the previous commit is in flight
 	int BYTE_SAMPLING_FACTOR;
 	int BYTE_SAMPLING_OVERHEAD;
 	double MIN_BYTE_SAMPLING_PROBABILITY; // Adjustable only for test of PhysicalShardMove. Should always be 0 for other
 	                                      // cases
 	int MAX_STORAGE_SERVER_WATCH_BYTES;
+	bool STORAGE_SERVER_BATCH_WATCH_TRIGGERS; // Trigger the watches of an update batch in one pass over sorted keys
+	// Runs of at least this many set mutations in a version are sorted and inserted into versioned data together. 0
+	// disables batching.
+	int STORAGE_SERVER_SORTED_SET_BATCH;
 	int MAX_BYTE_SAMPLE_CLEAR_MAP_SIZE;
 	double LONG_BYTE_SAMPLE_RECOVERY_DELAY;
 	int BYTE_SAMPLE_LOAD_PARALLELISM;
@@ -1033,27 +1182,40 @@ public:
 	// track the write throughput of this tag on the storage server.
 	int64_t MIN_TAG_WRITE_PAGES_RATE;
 	double TAG_MEASUREMENT_INTERVAL;
+	// Fraction of storage server reads whose CPU time, engine reads and bytes are accounted per type of read, tenant
+	// and tag, and how many of the busiest tenants and tags are traced every TAG_MEASUREMENT_INTERVAL
+	double STORAGE_READ_RESOURCE_SAMPLE_RATE;
+	int STORAGE_READ_RESOURCE_MAX_TRACKED;
 	bool PREFIX_COMPRESS_KVS_MEM_SNAPSHOTS;
+	// Bytes of rolling snapshot a memory storage engine writes for every byte of mutations committed. Lower values
+	// write less in the background at the cost of a longer disk queue, which makes recovery read more.
+	double KVS_MEM_SNAPSHOT_WRITE_RATIO;
 	bool REPORT_DD_METRICS;
 	double DD_METRICS_REPORT_INTERVAL;
 	double FETCH_KEYS_TOO_LONG_TIME_CRITERIA;
 	double MAX_STORAGE_COMMIT_TIME;
 	int64_t RANGESTREAM_LIMIT_BYTES;
+	int RANGESTREAM_READ_AHEAD_CHUNKS; // Chunks of a range stream read ahead of the one being sent
 	int64_t CHANGEFEEDSTREAM_LIMIT_BYTES;
 	int64_t BLOBWORKERSTATUSSTREAM_LIMIT_BYTES;
 	bool ENABLE_CLEAR_RANGE_EAGER_READS;
+	int64_t HOT_VALUE_CACHE_BYTES; // Capacity of the storage server's hot value cache, 0 to disable it
+	double HOT_VALUE_CACHE_MIN_READ_BANDWIDTH; // Sampled read bytes per second at which a key is admitted to the cache
 	bool QUICK_GET_VALUE_FALLBACK;
 	bool QUICK_GET_KEY_VALUES_FALLBACK;
 	bool STRICTLY_ENFORCE_BYTE_LIMIT;
 	double FRACTION_INDEX_BYTELIMIT_PREFETCH;
+	bool QUICK_GET_VALUE_BATCHED; // Read the point lookups of a getMappedRange batch together, deduplicated
 	int MAX_PARALLEL_QUICK_GET_VALUE;
 	int CHECKPOINT_TRANSFER_BLOCK_BYTES;
 	int QUICK_GET_KEY_VALUES_LIMIT;
 	int QUICK_GET_KEY_VALUES_LIMIT_BYTES;
 	int STORAGE_FEED_QUERY_HARD_LIMIT;
+	int CHANGEFEED_MULTI_STREAM_READ_PARALLELISM; // Most feeds of a change feed multi stream read for one reply
 	std::string STORAGESERVER_READ_PRIORITIES;
 	int STORAGE_SERVER_READ_CONCURRENCY;
 	std::string STORAGESERVER_READTYPE_PRIORITY_MAP;
+	double STORAGESERVER_READ_EXPECTED_BYTES_PER_SECOND;
 	int SPLIT_METRICS_MAX_ROWS;
 	double STORAGE_SHARD_CONSISTENCY_CHECK_INTERVAL;
 	int PHYSICAL_SHARD_MOVE_LOG_SEVERITY;
@@ -1103,6 +1265,8 @@ public:
 	int STORAGE_DISK_CLEANUP_MAX_RETRIES; // Max retries to cleanup left-over disk files from last storage server
 	int STORAGE_DISK_CLEANUP_RETRY_INTERVAL; // Sleep interval between cleanup retries
 	double WORKER_START_STORAGE_DELAY;
+	// The storage servers a rebooted worker lets recover their files at once, 0 for all of them
+	int WORKER_STORAGE_RECOVERY_PARALLELISM;
 
 	// Test harness
 	double WORKER_POLL_DELAY;
@@ -1128,6 +1292,9 @@ public:
 	// Status
 	double STATUS_MIN_TIME_BETWEEN_REQUESTS;
 	double MAX_STATUS_REQUESTS_PER_SECOND;
+	// Status requests are answered with the last status document until it is this many seconds old, so concurrent
+	// callers share one status computation
+	double STATUS_CACHE_MAX_AGE;
 	int CONFIGURATION_ROWS_TO_FETCH;
 	bool DISABLE_DUPLICATE_LOG_WARNING;
 	double HISTOGRAM_REPORT_INTERVAL;
@@ -1163,6 +1330,9 @@ public:
 	int64_t
 	    FASTRESTORE_HEARTBEAT_MAX_DELAY; // master claim a node is down if no heart beat from the node for this delay
 	int64_t FASTRESTORE_APPLIER_FETCH_KEYS_SIZE; // number of keys to fetch in a txn on applier
+	// The applier reads the keys it fetches in a txn with one range read of up to this many rows per key, and reads
+	// the keys past its rows one by one. 0 reads every key by itself.
+	int64_t FASTRESTORE_APPLIER_FETCH_RANGE_ROWS_PER_KEY;
 	int64_t FASTRESTORE_LOADER_SEND_MUTATION_MSG_BYTES; // desired size of mutation message sent from loader to appliers
 	bool FASTRESTORE_GET_RANGE_VERSIONS_EXPENSIVE; // parse each range file to get (range, version) it has?
 	int64_t FASTRESTORE_REQBATCH_PARALLEL; // number of requests to wait on for getBatchReplies()
@@ -1194,6 +1364,10 @@ public:
 	int REDWOOD_DEFAULT_EXTENT_READ_SIZE; // Extent read size for Redwood files
 	int REDWOOD_EXTENT_CONCURRENT_READS; // Max number of simultaneous extent disk reads in progress.
 	bool REDWOOD_KVSTORE_RANGE_PREFETCH; // Whether to use range read prefetching
+	int REDWOOD_RANGE_PREFETCH_QUEUE_DEPTH; // Maximum number of leaf reads outstanding for one range prefetch
+	int REDWOOD_VALUE_EXTERNAL_THRESHOLD; // Values of at least this many bytes are stored in pages of their own
+	                                      // instead of in leaves, 0 to store all values in leaves.  Once a value has
+	                                      // been stored this way, versions without this option can't read the file.
 	double REDWOOD_PAGE_REBUILD_MAX_SLACK; // When rebuilding pages, max slack to allow in page before extending it
 	double REDWOOD_PAGE_REBUILD_SLACK_DISTRIBUTION; // When rebuilding pages, use this ratio of slack distribution
 	                                                // between the rightmost (new) page and the previous page. Defaults
@@ -1208,6 +1382,7 @@ public:
 	                                  // queue is empty
 	int REDWOOD_LAZY_CLEAR_MAX_PAGES; // Maximum number of pages to free before ending a lazy clear cycle, unless the
 	                                  // queue is empty
+	double REDWOOD_LAZY_CLEAR_PAGES_PER_SECOND; // Maximum average rate at which lazy clear frees pages, 0 for no limit
 	int64_t REDWOOD_REMAP_CLEANUP_WINDOW_BYTES; // Total size of remapped pages to keep before being removed by
 	                                            // remap cleanup
 	double REDWOOD_REMAP_CLEANUP_TOLERANCE_RATIO; // Maximum ratio of the remap cleanup window that remap cleanup is
@@ -1216,6 +1391,12 @@ public:
 	double REDWOOD_METRICS_INTERVAL;
 	double REDWOOD_HISTOGRAM_INTERVAL;
 	bool REDWOOD_EVICT_UPDATED_PAGES; // Whether to prioritize eviction of updated pages from cache.
+	double REDWOOD_PAGE_CACHE_PROTECTED_FRACTION; // Share of the page cache for pages hit outside of scans
+	std::string REDWOOD_PAGE_COMPRESSION_FILTER; // Compression for multi-block BTree nodes written, NONE to disable
+	int REDWOOD_ENCODE_THREADS; // Helper threads encrypting pages written by a Redwood instance, 0 to encrypt inline
+	bool REDWOOD_PAGE_CACHE_SLAB; // Reserve the page cache up front as a huge page backed slab of page sized slots
+	double REDWOOD_RELOCATE_INTERVAL; // Seconds between scans for scattered leaves to relocate, 0 disables
+	double REDWOOD_RELOCATE_MIN_SCATTER; // Min fraction of out of place leaves under a page to relocate
 	int REDWOOD_DECODECACHE_REUSE_MIN_HEIGHT; // Minimum height for which to keep and reuse page decode caches
 	int REDWOOD_NODE_MAX_UNBALANCE; // Maximum imbalance in a node before it should be rebuilt instead of updated
 
@@ -1232,6 +1413,11 @@ public:
 	// Encryption
 	int SIM_KMS_MAX_KEYS;
 	int ENCRYPT_PROXY_MAX_DBG_TRACE_LENGTH;
+	// Cache misses of the requests the encrypt key proxy receives within this delay are looked up in one KMS call
+	double ENCRYPT_PROXY_KMS_LOOKUP_BATCH_DELAY;
+	// Latest cipher keys not requested for this long are left to expire rather than refreshed ahead of time; 0
+	// refreshes all of them
+	double ENCRYPT_PROXY_REFRESH_UNUSED_KEY_TIME;
 	double ENCRYPTION_LOGGING_INTERVAL;
 
 	// Compression
@@ -1252,6 +1438,7 @@ public:
 
 	int BG_SNAPSHOT_FILE_TARGET_BYTES;
 	int BG_SNAPSHOT_FILE_TARGET_CHUNK_BYTES;
+	bool BG_SNAPSHOT_COLUMNAR; // write snapshot files with the keys and tuple elements of values in separate blocks
 	int BG_DELTA_FILE_TARGET_BYTES;
 	int BG_DELTA_FILE_TARGET_CHUNK_BYTES;
 	int BG_DELTA_BYTES_BEFORE_COMPACT;
@@ -1268,6 +1455,7 @@ public:
 	bool BG_ENABLE_READ_DRIVEN_COMPACTION;
 	int BG_RDC_BYTES_FACTOR;
 	int BG_RDC_READ_FACTOR;
+	double BG_RDC_SAVINGS_HORIZON; // seconds of reads that read-driven compaction savings are projected over
 	bool BG_WRITE_MULTIPART;
 	bool BG_ENABLE_DYNAMIC_WRITE_AMP;
 	double BG_DYNAMIC_WRITE_AMP_MIN_FACTOR;
@@ -1277,6 +1465,9 @@ public:
 	int BLOB_WORKER_RESNAPSHOT_PARALLELISM;
 	int BLOB_WORKER_DELTA_FILE_WRITE_PARALLELISM;
 	int BLOB_WORKER_RDC_PARALLELISM;
+	// bytes per second a blob worker may write for read-driven re-snapshots, and seconds of those it may save up
+	double BLOB_WORKER_RDC_BYTES_PER_SECOND;
+	double BLOB_WORKER_RDC_BUDGET_SECONDS;
 	// The resnapshot/delta parallelism knobs are deprecated and replaced by the budget_bytes knobs! FIXME: remove after
 	// next release
 	int64_t BLOB_WORKER_RESNAPSHOT_BUDGET_BYTES;
@@ -1346,6 +1537,14 @@ public:
 	double REST_KMS_STABILITY_CHECK_INTERVAL;
 
 	double CONSISTENCY_SCAN_ACTIVE_THROTTLE_RATIO;
+	// Whether the consistency scan compares storage server checksums of ranges, reading the data of a range from all
+	// replicas only when their checksums differ
+	bool CONSISTENCY_SCAN_USE_CHECKSUMS;
+	int CONSISTENCY_SCAN_CHECKSUM_BYTES; // KV bytes a storage server checksums for one GetStorageCheckSumRequest
+	// The consistency scan slows down to this fraction of its configured rate at most while storage servers report a
+	// read penalty, and speeds back up by the recovery factor after each read without one
+	double CONSISTENCY_SCAN_MIN_LOAD_FACTOR;
+	double CONSISTENCY_SCAN_LOAD_FACTOR_RECOVERY;
 
 	// Idempotency ids
 	double IDEMPOTENCY_ID_IN_MEMORY_LIFETIME;
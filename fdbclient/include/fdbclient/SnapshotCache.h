@@ -156,15 +156,31 @@ private:
 		KeyRef beginKey;
 		ExtStringRef endKey;
 		VectorRef<KeyValueRef> values;
+		// Whether values was allocated by the cache, rather than being the results of a read, so that appending to it
+		// can't overwrite anything else
+		bool ownsValues;
 
 		Entry(KeyRef const& beginKey, ExtStringRef const& endKey, VectorRef<KeyValueRef> const& values)
-		  : beginKey(beginKey), endKey(endKey), values(values) {}
-		Entry(KeyValueRef const& kv, Arena& arena) : beginKey(kv.key), endKey(kv.key, 1) {
+		  : beginKey(beginKey), endKey(endKey), values(values), ownsValues(false) {}
+		Entry(KeyValueRef const& kv, Arena& arena) : beginKey(kv.key), endKey(kv.key, 1), ownsValues(true) {
 			values.push_back(arena, kv);
 		}
 		int compare(Entry const& r) const { return ::compare(beginKey, r.beginKey); }
 		bool operator<(Entry const& r) const { return beginKey < r.beginKey; }
 		int segments() const { return 2 * (values.size() + 1); }
+
+		// Extends this entry, which ends where more begins, to the end of more with the values of more
+		void append(Arena& arena, ExtStringRef const& end, VectorRef<KeyValueRef> const& more) {
+			if (!ownsValues && more.size()) {
+				VectorRef<KeyValueRef> copy;
+				copy.reserve(arena, 2 * (values.size() + more.size()));
+				copy.append(arena, values.begin(), values.size());
+				values = copy;
+				ownsValues = true;
+			}
+			values.append(arena, more.begin(), more.size());
+			endKey = end;
+		}
 	};
 
 	friend class ReadYourWritesTransaction;
@@ -329,11 +345,21 @@ public:
 	bool insert(KeyRef key, Optional<ValueRef> value) {
 		// Asserts that, in the snapshot, the given key has the given value (or is not present, if !value.present())
 
-		iterator it(this);
-		it.skip(key);
-
-		if (it.is_unknown_range()) {
-			if (value.present())
+		if (key == allKeys.end) {
+			return false;
+		}
+		auto prev = entries.lastLessOrEqual(Entry(key, key, VectorRef<KeyValueRef>()));
+		if (key >= prev->endKey) {
+			if (prev->endKey == key) {
+				// Extend the known range ending at key rather than adding an entry
+				KeyValueRef kv;
+				VectorRef<KeyValueRef> values;
+				if (value.present()) {
+					kv = KeyValueRef(key, value.get());
+					values = VectorRef<KeyValueRef>(&kv, 1);
+				}
+				prev->append(*arena, ExtStringRef(key, 1), values);
+			} else if (value.present())
 				entries.insert(Entry(KeyValueRef(key, value.get()), *arena), NoMetric(), true);
 			else
 				entries.insert(Entry(key, ExtStringRef(key, 1), VectorRef<KeyValueRef>()), NoMetric(), true);
@@ -371,6 +397,29 @@ public:
 		}
 
 		if (begin < end) {
+			// Known ranges adjacent to the new one are merged with it, so that consecutive reads of a range don't leave
+			// an entry each. The values of the following range are copied only if it has no more than the new one, so
+			// that each value is copied O(log n) times.
+			Entry& next = *ite.it;
+			if (next.beginKey == end && end < allKeys.end && next.values.size() <= values.size()) {
+				VectorRef<KeyValueRef> merged;
+				merged.reserve(*arena, values.size() + next.values.size());
+				merged.append(*arena, values.begin(), values.size());
+				merged.append(*arena, next.values.begin(), next.values.size());
+				values = merged;
+				end = next.endKey;
+				++ite.it;
+			}
+			if (itb.it->beginKey != allKeys.begin) {
+				auto prev = itb.it;
+				prev.decrementNonEnd();
+				if (prev->endKey == begin) {
+					entries.erase(itb.it, ite.it);
+					prev->append(*arena, end, values);
+					return true;
+				}
+			}
+
 			bool addBegin = begin != allKeys.begin && itb.it->beginKey == allKeys.begin;
 			entries.erase(itb.it, ite.it);
 			entries.insert(Entry(begin, end, values), NoMetric(), true);
@@ -341,6 +341,23 @@ public:
 	                             GetRangeLimits limitsHint) const override;
 };
 
+class DDHeatmapRangeImpl : public SpecialKeyRangeAsyncImpl {
+public:
+	explicit DDHeatmapRangeImpl(KeyRangeRef kr);
+	Future<RangeResult> getRange(ReadYourWritesTransaction* ryw,
+	                             KeyRangeRef kr,
+	                             GetRangeLimits limitsHint) const override;
+};
+
+// The live sites of the heap profiler of one process, at <prefix><ip:port>/<rank> by decreasing live bytes
+class HeapProfileRangeImpl : public SpecialKeyRangeAsyncImpl {
+public:
+	explicit HeapProfileRangeImpl(KeyRangeRef kr);
+	Future<RangeResult> getRange(ReadYourWritesTransaction* ryw,
+	                             KeyRangeRef kr,
+	                             GetRangeLimits limitsHint) const override;
+};
+
 class ManagementCommandsOptionsImpl : public SpecialKeyRangeRWImpl {
 public:
 	explicit ManagementCommandsOptionsImpl(KeyRangeRef kr);
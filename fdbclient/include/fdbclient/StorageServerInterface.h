@@ -125,6 +125,9 @@ struct StorageServerInterface {
 	RequestStream<struct AuditStorageRequest> auditStorage;
 	RequestStream<struct GetHotShardsRequest> getHotShards;
 	RequestStream<struct GetStorageCheckSumRequest> getCheckSum;
+	RequestStream<struct WaitShardMetricsRequest> waitShardMetrics;
+	RequestStream<struct ChangeFeedMultiStreamRequest> changeFeedMultiStream;
+	RequestStream<struct LongSnapshotRequest> longSnapshot;
 
 private:
 	bool acceptingRequests;
@@ -204,6 +207,12 @@ public:
 				    RequestStream<struct GetHotShardsRequest>(getValue.getEndpoint().getAdjustedEndpoint(24));
 				getCheckSum =
 				    RequestStream<struct GetStorageCheckSumRequest>(getValue.getEndpoint().getAdjustedEndpoint(25));
+				waitShardMetrics =
+				    RequestStream<struct WaitShardMetricsRequest>(getValue.getEndpoint().getAdjustedEndpoint(26));
+				changeFeedMultiStream =
+				    RequestStream<struct ChangeFeedMultiStreamRequest>(getValue.getEndpoint().getAdjustedEndpoint(27));
+				longSnapshot =
+				    RequestStream<struct LongSnapshotRequest>(getValue.getEndpoint().getAdjustedEndpoint(28));
 			}
 		} else {
 			ASSERT(Ar::isDeserializing);
@@ -258,6 +267,9 @@ public:
 		streams.push_back(auditStorage.getReceiver());
 		streams.push_back(getHotShards.getReceiver());
 		streams.push_back(getCheckSum.getReceiver());
+		streams.push_back(waitShardMetrics.getReceiver());
+		streams.push_back(changeFeedMultiStream.getReceiver());
+		streams.push_back(longSnapshot.getReceiver());
 		FlowTransport::transport().addEndpoints(streams);
 	}
 };
@@ -305,7 +317,8 @@ struct GetValueReply : public LoadBalancedReply {
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		serializer(ar, LoadBalancedReply::penalty, LoadBalancedReply::error, value, cached);
+		serializer(
+		    ar, LoadBalancedReply::penalty, LoadBalancedReply::error, value, cached, LoadBalancedReply::versionLag);
 	}
 };
 
@@ -393,12 +406,29 @@ struct GetKeyValuesReply : public LoadBalancedReply {
 	Version version; // useful when latestVersion was requested
 	bool more;
 	bool cached = false;
+	// When present, data is empty and this holds its rows with the prefix each key shares with the previous one elided.
+	// Only sent in reply to requests with prefixCompressReply set.
+	Optional<StringRef> prefixCompressedData;
 
 	GetKeyValuesReply() : version(invalidVersion), more(false), cached(false) {}
 
+	// Moves data into prefixCompressedData, unless that doesn't save space
+	void prefixCompressData();
+	// Restores the data moved by prefixCompressData(). Throws serialization_failed if it is malformed.
+	void expandPrefixCompressedData();
+
 	template <class Ar>
 	void serialize(Ar& ar) {
-		serializer(ar, LoadBalancedReply::penalty, LoadBalancedReply::error, data, version, more, cached, arena);
+		serializer(ar,
+		           LoadBalancedReply::penalty,
+		           LoadBalancedReply::error,
+		           data,
+		           version,
+		           more,
+		           cached,
+		           LoadBalancedReply::versionLag,
+		           prefixCompressedData,
+		           arena);
 	}
 };
 
@@ -419,6 +449,8 @@ struct GetKeyValuesRequest : TimedRequest {
 	VersionVector ssLatestCommitVersions; // includes the latest commit versions, as known
 	                                      // to this client, of all storage replicas that
 	                                      // serve the given key
+	// Whether the client expands prefixCompressedData. Storage servers that predate it ignore it and send data.
+	bool prefixCompressReply = false;
 
 	GetKeyValuesRequest() {}
 
@@ -438,6 +470,7 @@ struct GetKeyValuesRequest : TimedRequest {
 		           tenantInfo,
 		           options,
 		           ssLatestCommitVersions,
+		           prefixCompressReply,
 		           arena);
 	}
 };
@@ -456,7 +489,15 @@ struct GetMappedKeyValuesReply : public LoadBalancedReply {
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		serializer(ar, LoadBalancedReply::penalty, LoadBalancedReply::error, data, version, more, cached, arena);
+		serializer(ar,
+		           LoadBalancedReply::penalty,
+		           LoadBalancedReply::error,
+		           data,
+		           version,
+		           more,
+		           cached,
+		           LoadBalancedReply::versionLag,
+		           arena);
 	}
 };
 
@@ -506,12 +547,20 @@ struct GetKeyValuesStreamReply : public ReplyPromiseStreamReply {
 	Version version; // useful when latestVersion was requested
 	bool more;
 	bool cached = false;
+	Optional<StringRef> prefixCompressedData; // as in GetKeyValuesReply
 
 	GetKeyValuesStreamReply() : version(invalidVersion), more(false), cached(false) {}
 	GetKeyValuesStreamReply(GetKeyValuesReply r)
-	  : arena(r.arena), data(r.data), version(r.version), more(r.more), cached(r.cached) {}
+	  : arena(r.arena), data(r.data), version(r.version), more(r.more), cached(r.cached),
+	    prefixCompressedData(r.prefixCompressedData) {}
+
+	int expectedSize() const {
+		return sizeof(GetKeyValuesStreamReply) + data.expectedSize() +
+		       (prefixCompressedData.present() ? prefixCompressedData.get().size() : 0);
+	}
 
-	int expectedSize() const { return sizeof(GetKeyValuesStreamReply) + data.expectedSize(); }
+	void prefixCompressData();
+	void expandPrefixCompressedData();
 
 	template <class Ar>
 	void serialize(Ar& ar) {
@@ -522,6 +571,7 @@ struct GetKeyValuesStreamReply : public ReplyPromiseStreamReply {
 		           version,
 		           more,
 		           cached,
+		           prefixCompressedData,
 		           arena);
 	}
 };
@@ -540,6 +590,7 @@ struct GetKeyValuesStreamRequest {
 	VersionVector ssLatestCommitVersions; // includes the latest commit versions, as known
 	                                      // to this client, of all storage replicas that
 	                                      // serve the given key range
+	bool prefixCompressReply = false; // as in GetKeyValuesRequest
 
 	GetKeyValuesStreamRequest() {}
 
@@ -559,6 +610,7 @@ struct GetKeyValuesStreamRequest {
 		           tenantInfo,
 		           options,
 		           ssLatestCommitVersions,
+		           prefixCompressReply,
 		           arena);
 	}
 };
@@ -573,7 +625,8 @@ struct GetKeyReply : public LoadBalancedReply {
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		serializer(ar, LoadBalancedReply::penalty, LoadBalancedReply::error, sel, cached);
+		serializer(
+		    ar, LoadBalancedReply::penalty, LoadBalancedReply::error, sel, cached, LoadBalancedReply::versionLag);
 	}
 };
 
@@ -765,6 +818,53 @@ struct WaitMetricsRequest {
 	}
 };
 
+struct WaitShardMetricsReply {
+	constexpr static FileIdentifier file_identifier = 2298571;
+	// The indices in the request of the shards whose metrics are out of their bounds, and the shards' metrics
+	std::vector<int> changed;
+	std::vector<StorageMetrics> metrics;
+	// The indices in the request of the shards that are not readable on the storage server
+	std::vector<int> wrongShard;
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, changed, metrics, wrongShard);
+	}
+};
+
+struct WaitShardMetricsRequest {
+	// Like WaitMetricsRequest for many shards at once: waits for the metrics of any of the shards to exceed their
+	// bounds, and then returns the metrics of those shards. Returns the metrics of all the shards on timeout.
+	constexpr static FileIdentifier file_identifier = 6170279;
+	Arena arena;
+	VectorRef<KeyRangeRef> keys;
+	std::vector<StorageMetrics> min, max;
+	ReplyPromise<WaitShardMetricsReply> reply;
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, keys, min, max, reply, arena);
+	}
+};
+
+// Asks a storage server to pin its storage engine's state at version, which must not be durable yet, so that reads at
+// version with ReadOptions::longSnapshot can be served after it leaves the in-memory window. Replies once the state is
+// pinned, with transaction_too_old if version was already made durable or server_overloaded if the server has as
+// many long snapshots as it keeps.
+struct LongSnapshotRequest {
+	constexpr static FileIdentifier file_identifier = 7513092;
+	Version version;
+	ReplyPromise<Void> reply;
+
+	LongSnapshotRequest() {}
+	explicit LongSnapshotRequest(Version version) : version(version) {}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, version, reply);
+	}
+};
+
 struct SplitMetricsReply {
 	constexpr static FileIdentifier file_identifier = 11530792;
 	Standalone<VectorRef<KeyRef>> splits;
@@ -961,6 +1061,86 @@ struct ChangeFeedStreamRequest {
 	}
 };
 
+// One feed of a ChangeFeedMultiStreamRequest, with the fields of a ChangeFeedStreamRequest for the feed
+struct ChangeFeedStreamSubscription {
+	constexpr static FileIdentifier file_identifier = 4770918;
+	Key rangeID;
+	Version begin = 0;
+	Version end = 0;
+	KeyRange range;
+	bool canReadPopped = true;
+	UID id; // The ChangeFeedStreamRequest::id of the feed's stream
+	Optional<ReadOptions> options;
+	bool encrypted = false;
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, rangeID, begin, end, range, canReadPopped, id, options, encrypted);
+	}
+};
+
+// What a ChangeFeedStreamReply would have for one of the feeds of a ChangeFeedMultiStreamRequest
+struct ChangeFeedMultiStreamEntry {
+	constexpr static FileIdentifier file_identifier = 9317045;
+	int feed = -1; // The index of the feed in the request
+	VectorRef<MutationsAndVersionRef> mutations;
+	bool atLatestVersion = false;
+	Version popVersion = invalidVersion;
+	// The error that ended the feed's stream, end_of_stream once it reached its end version. The feed has no more
+	// entries after this one.
+	Optional<Error> error;
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, feed, mutations, atLatestVersion, popVersion, error);
+	}
+};
+
+struct ChangeFeedMultiStreamReply : public ReplyPromiseStreamReply {
+	constexpr static FileIdentifier file_identifier = 5264913;
+	Arena arena;
+	std::vector<ChangeFeedMultiStreamEntry> feeds;
+	Version minStreamVersion = invalidVersion;
+
+	ChangeFeedMultiStreamReply() {}
+
+	int expectedSize() const {
+		int size = sizeof(ChangeFeedMultiStreamReply);
+		for (const auto& f : feeds) {
+			size += sizeof(ChangeFeedMultiStreamEntry) + f.mutations.expectedSize();
+		}
+		return size;
+	}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar,
+		           ReplyPromiseStreamReply::acknowledgeToken,
+		           ReplyPromiseStreamReply::sequence,
+		           feeds,
+		           minStreamVersion,
+		           arena);
+	}
+};
+
+// Streams many change feeds of one storage server over one reply stream. Each reply has entries for the feeds that
+// made progress, and the stream ends once all of the feeds have ended.
+struct ChangeFeedMultiStreamRequest {
+	constexpr static FileIdentifier file_identifier = 1039550;
+	SpanContext spanContext;
+	std::vector<ChangeFeedStreamSubscription> feeds;
+	int replyBufferSize = -1;
+	UID id; // This must be globally unique among ChangeFeedStreamRequest and ChangeFeedMultiStreamRequest instances
+
+	ReplyPromiseStream<ChangeFeedMultiStreamReply> reply;
+
+	ChangeFeedMultiStreamRequest() {}
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, feeds, replyBufferSize, id, reply, spanContext);
+	}
+};
+
 struct ChangeFeedPopRequest {
 	constexpr static FileIdentifier file_identifier = 10726174;
 	Key rangeID;
@@ -1217,6 +1397,13 @@ struct StorageQueuingMetricsReply {
 	double diskUsage{ 0.0 };
 	double localRateLimit;
 	std::vector<BusyTagInfo> busiestTags;
+	int64_t compactionDebtBytes{ 0 }; // bytes the storage engine has yet to compact, if it compacts
+	// Indexed by ReadType: the reads queued for the read lock, and the longest queue wait since the last reply
+	std::vector<int> readLaneWaiters;
+	std::vector<double> readLaneQueueWaits;
+	// Versions kept in memory, which is fewer than MAX_READ_TRANSACTION_LIFE_VERSIONS under memory pressure, or 0 if
+	// not reported
+	Version mvccWindowVersions{ 0 };
 
 	template <class Ar>
 	void serialize(Ar& ar) {
@@ -1231,7 +1418,11 @@ struct StorageQueuingMetricsReply {
 		           cpuUsage,
 		           diskUsage,
 		           localRateLimit,
-		           busiestTags);
+		           busiestTags,
+		           compactionDebtBytes,
+		           readLaneWaiters,
+		           readLaneQueueWaits,
+		           mvccWindowVersions);
 	}
 };
 
@@ -1273,21 +1464,26 @@ struct GetHotShardsRequest {
 
 enum class CheckSumMethod : uint8_t {
 	Invalid = 0,
+	// XXH3 64 bit hashes chained over the keys and values of the range, in key order
+	XXHash3 = 1,
 };
 
 struct CheckSumMetaData {
 	constexpr static FileIdentifier file_identifier = 3828142;
+	// The part of the requested range the checksum covers, which ends early if the storage server's byte limit for
+	// one request was reached
 	KeyRange range;
 	Version version;
 	StringRef checkSumValue;
+	int64_t checkedBytes = 0; // KV bytes the checksum covers
 
 	CheckSumMetaData() {}
-	CheckSumMetaData(KeyRange range, Version version, StringRef checkSumValue)
-	  : range(range), version(version), checkSumValue(checkSumValue) {}
+	CheckSumMetaData(KeyRange range, Version version, StringRef checkSumValue, int64_t checkedBytes)
+	  : range(range), version(version), checkSumValue(checkSumValue), checkedBytes(checkedBytes) {}
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		serializer(ar, range, version, checkSumValue);
+		serializer(ar, range, version, checkSumValue, checkedBytes);
 	}
 };
 
@@ -1295,6 +1491,8 @@ struct GetStorageCheckSumReply {
 	constexpr static FileIdentifier file_identifier = 3828143;
 	std::vector<CheckSumMetaData> checkSums;
 	uint8_t checkSumMethod;
+	double penalty = 1.0;
+	Arena arena;
 
 	GetStorageCheckSumReply() {}
 	GetStorageCheckSumReply(const std::vector<CheckSumMetaData>& checkSums, CheckSumMethod checkSumMethod)
@@ -1302,7 +1500,7 @@ struct GetStorageCheckSumReply {
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		serializer(ar, checkSums, checkSumMethod);
+		serializer(ar, checkSums, checkSumMethod, penalty, arena);
 	}
 };
 
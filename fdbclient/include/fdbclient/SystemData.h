@@ -25,6 +25,7 @@
 // Functions and constants documenting the organization of the reserved keyspace in the database beginning with "\xFF"
 
 #include "fdbclient/AccumulativeChecksum.h"
+#include "fdbclient/BulkLoad.h"
 #include "fdbclient/FDBTypes.h"
 #include "fdbclient/BlobWorkerInterface.h" // TODO move the functions that depend on this out of here and into BlobWorkerInterface.h to remove this dependency
 #include "fdbclient/StorageServerInterface.h"
@@ -69,7 +70,8 @@ enum class DataMovementReason : uint8_t {
 	REBALANCE_STORAGE_QUEUE = 19,
 	ASSIGN_EMPTY_RANGE = 20, // dummy reason, no corresponding data move priority
 	SEED_SHARD_SERVER = 21, // dummy reason, no corresponding data move priority
-	NUMBER_OF_REASONS = 22, // dummy reason, no corresponding data move priority
+	BULK_LOAD = 22,
+	NUMBER_OF_REASONS = 23, // dummy reason, no corresponding data move priority
 };
 
 // SystemKey is just a Key but with a special type so that instances of it can be found easily throughput the code base
@@ -161,6 +163,14 @@ const KeyRange auditServerBasedProgressRangeFor(const AuditType type);
 const Value auditStorageStateValue(const AuditStorageState& auditStorageState);
 AuditStorageState decodeAuditStorageState(const ValueRef& value);
 
+// "\xff/bulkLoad/[[begin]]" := "[[BulkLoadState]]"
+// A KeyRangeMap over normalKeys of the pieces of bulk load tasks. Ranges with no task have an empty value.
+extern const KeyRangeRef bulkLoadKeys;
+extern const KeyRef bulkLoadPrefix;
+
+const Value bulkLoadStateValue(const BulkLoadState& bulkLoadState);
+BulkLoadState decodeBulkLoadState(const ValueRef& value);
+
 // "\xff/checkpoint/[[UID]] := [[CheckpointMetaData]]"
 extern const KeyRef checkpointPrefix;
 const Key checkpointKeyFor(UID checkpointID);
@@ -228,6 +238,8 @@ extern const ValueRef conflictingKeysTrue, conflictingKeysFalse;
 extern const KeyRangeRef writeConflictRangeKeysRange;
 extern const KeyRangeRef readConflictRangeKeysRange;
 extern const KeyRangeRef ddStatsRange;
+extern const KeyRangeRef ddHeatmapRange;
+extern const KeyRangeRef heapProfileRange;
 
 extern const KeyRef cacheKeysPrefix;
 
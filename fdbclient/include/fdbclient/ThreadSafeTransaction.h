@@ -30,6 +30,27 @@
 #include "fdbclient/IClientApi.h"
 #include "fdbclient/ISingleThreadTransaction.h"
 
+// Hands getReadVersion() calls from client threads to the network thread in bulk. A call pushes itself onto a lock-free
+// stack and only schedules a drain on the network thread if none is pending yet, so that transactions started from many
+// threads at once share a single network thread hop. There the drained requests reach readVersionBatcher together.
+class ReadVersionRequestQueue : public ThreadSafeReferenceCounted<ReadVersionRequestQueue>, NonCopyable {
+public:
+	ThreadFuture<Version> getReadVersion(ISingleThreadTransaction* tr);
+
+private:
+	class Request;
+
+	void drain();
+
+	std::atomic<Request*> head{ nullptr };
+	// Requests are numbered in the order they were pushed. A drain covering every request up to `scheduled` has been
+	// handed to the network thread, so anything the pusher does on the network thread afterwards runs after its
+	// request was drained.
+	std::atomic<int64_t> pushed{ 0 };
+	std::atomic<int64_t> scheduled{ 0 };
+	std::atomic<bool> scheduling{ false };
+};
+
 // An implementation of IDatabase that serializes operations onto the network thread and interacts with the lower-level
 // client APIs exposed by NativeAPI and ReadYourWrites.
 class ThreadSafeDatabase : public IDatabase, public ThreadSafeReferenceCounted<ThreadSafeDatabase> {
@@ -83,6 +104,7 @@ private:
 	friend class ThreadSafeTransaction;
 	bool isConfigDB{ false };
 	DatabaseContext* db;
+	Reference<ReadVersionRequestQueue> readVersionQueue = makeReference<ReadVersionRequestQueue>();
 
 public: // Internal use only
 	enum class ConnectionRecordType { FILE, CONNECTION_STRING };
@@ -127,7 +149,8 @@ public:
 	explicit ThreadSafeTransaction(DatabaseContext* cx,
 	                               ISingleThreadTransaction::Type type,
 	                               Optional<TenantName> tenantName,
-	                               Tenant* tenantPtr);
+	                               Tenant* tenantPtr,
+	                               Reference<ReadVersionRequestQueue> readVersionQueue = {});
 	~ThreadSafeTransaction() override;
 
 	// Note: used while refactoring fdbcli, need to be removed later
@@ -205,6 +228,9 @@ public:
 	void clear(const KeyRef& begin, const KeyRef& end) override;
 	void clear(const KeyRangeRef& range) override;
 	void clear(const KeyRef& key) override;
+	ThreadFuture<RangeResult> batch(VectorRef<MutationRef> const& mutations,
+	                                VectorRef<KeyRef> const& reads,
+	                                bool snapshot = false) override;
 
 	ThreadFuture<Void> watch(const KeyRef& key) override;
 
@@ -241,9 +267,20 @@ public:
 	void debugPrint(std::string const& message) override;
 
 private:
+	// Sets, clears and atomic operations are buffered and handed to the network thread together, when the buffer grows
+	// past THREADSAFE_MUTATION_BATCH_BYTES or ahead of any other operation on the transaction
+	void bufferMutation(MutationRef const& mutation);
+	void flushMutations();
+
 	ISingleThreadTransaction* tr;
 	const Optional<TenantName> tenantName;
 	std::shared_ptr<std::atomic_bool> initialized;
+	Reference<ReadVersionRequestQueue> readVersionQueue;
+	DatabaseContext* cx = nullptr; // Only used on the network thread, to count mutation batches
+
+	ThreadSpinLock bufferedMutationsLock;
+	Standalone<VectorRef<MutationRef>> bufferedMutations;
+	int64_t bufferedMutationBytes = 0;
 };
 
 // An implementation of IClientApi that serializes operations onto the network thread and interacts with the lower-level
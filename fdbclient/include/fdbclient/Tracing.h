@@ -261,7 +261,8 @@ enum class TracerType {
 	DISABLED = 0,
 	NETWORK_LOSSY = 1,
 	SIM_END = 2, // Any tracers that come after SIM_END will not be tested in simulation
-	LOG_FILE = 3
+	LOG_FILE = 3,
+	NETWORK_BATCHED = 4
 };
 
 struct ITracer {
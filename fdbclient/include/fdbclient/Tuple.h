@@ -48,6 +48,9 @@ struct Tuple {
 	// Note that strings can't be incomplete because they are parsed such that the end of the packed
 	// byte string is considered the end of the string in lieu of a specific end.
 	static Tuple unpack(StringRef const& str, bool exclude_incomplete = false);
+	// Like unpack, but the tuple refers to str instead of copying it. str must outlive the tuple and anything returned
+	// by it, such as pack() or getString(), unless they are copied first.
+	static Tuple unpackView(StringRef const& str, bool exclude_incomplete = false);
 	static std::string tupleToString(Tuple const& tuple);
 	static Tuple unpackUserType(StringRef const& str, bool exclude_incomplete = false);
 
@@ -121,7 +124,7 @@ struct Tuple {
 	}
 
 private:
-	Tuple(const StringRef& data, bool exclude_incomplete = false, bool exclude_user_type = false);
+	Tuple(const StringRef& data, bool exclude_incomplete = false, bool exclude_user_type = false, bool copy = true);
 	Standalone<VectorRef<uint8_t>> data;
 	std::vector<size_t> offsets;
 };
@@ -25,6 +25,7 @@
 
 #include <boost/container/flat_map.hpp>
 #include <set>
+#include <type_traits>
 
 #include "fdbclient/FDBTypes.h"
 #include "fdbclient/Knobs.h"
@@ -213,32 +214,59 @@ public:
 	// Encoding methods used:
 	//
 	// - Tag localities: Run-length encoding
-	// - Tag ids: Compact representation (depending on the max tag id value)
+	// - Tag ids: Compact representation (depending on the max tag id value), or gap encoding
 	// - Commit versions: Delta encoding
 	//
+	// Gap encoded tag ids are the differences between each tag id and the previous one of the same locality (or 0,
+	// for the first), in 7 bits per byte. This is used when it takes fewer bytes than fixed size tag ids, which is
+	// the case for the dense tag ids of a cluster with more than UINT8_MAX storage servers, and is marked by a tag id
+	// size of TagIdGapsEncodedSize.
+	//
+
+	// Used as the tag id type of the methods below for gap encoded tag ids
+	struct TagIdGaps {};
+	static constexpr uint8_t TagIdGapsEncodedSize = 0;
+
+	template <typename T>
+	static constexpr uint8_t getTagIdEncodedSize() {
+		return std::is_same_v<T, TagIdGaps> ? TagIdGapsEncodedSize : sizeof(T);
+	}
+
+	static size_t getTagIdGapSize(uint16_t gap) { return gap < (1 << 7) ? 1 : gap < (1 << 14) ? 2 : 3; }
+
+	// Returns whether tag ids are gap encoded, given the highest tag id and the total size of the gap encoded tag ids
+	bool useTagIdGaps(uint16_t maxTagId, size_t tagIdGapBytes) const {
+		return tagIdGapBytes < this->size() * (maxTagId <= UINT8_MAX ? sizeof(uint8_t) : sizeof(uint16_t));
+	}
 
 	// Extracts information about tag ids, tag localities, and commit versions that are
 	// captured in the version vector. This will avoid the need to make multiple iterations
 	// over the contents of the version vector while (encoding and) serializing it.
 	void getTagAndCommitVersionInfo(size_t& utlCount,
 	                                uint16_t& maxTagId,
+	                                size_t& tagIdGapBytes,
 	                                Version& minCommitVersion,
 	                                Version& maxCommitVersion) const {
 		// Initialization
 		utlCount = 0; // unique tag locality count
 		maxTagId = 0; // the highest tag id in the version vector
+		tagIdGapBytes = 0; // the size of the gap encoded tag ids
 		minCommitVersion = MAX_VERSION; // the lowest commit version in "VersionVector::versions"
 		maxCommitVersion = invalidVersion; // the highest commit version in "VersionVector::versions"
 
 		// Population
 		int8_t locality = tagLocalityInvalid;
+		uint16_t prevTagId = 0;
 		for (const auto& [tag, version] : versions) {
 			if (locality != tag.locality) {
 				locality = tag.locality;
 				utlCount++;
+				prevTagId = 0;
 			}
 
 			maxTagId = std::max(maxTagId, tag.id);
+			tagIdGapBytes += getTagIdGapSize(tag.id - prevTagId);
+			prevTagId = tag.id;
 			minCommitVersion = std::min(minCommitVersion, version);
 			maxCommitVersion = std::max(maxCommitVersion, version);
 		}
@@ -248,9 +276,10 @@ public:
 	size_t getEncodedSize() const {
 		size_t utlCount; // unique tag locality count
 		uint16_t maxTagId; // the highest tag id in the version vector
+		size_t tagIdGapBytes; // the size of the gap encoded tag ids
 		Version minVersion; // the lowest commit version in the version vector
 		Version maxVersion; // the highest commit version in the version vector
-		getTagAndCommitVersionInfo(utlCount, maxTagId, minVersion, maxVersion);
+		getTagAndCommitVersionInfo(utlCount, maxTagId, tagIdGapBytes, minVersion, maxVersion);
 
 		// Is the version vector empty?
 		if (utlCount == 0) {
@@ -258,8 +287,12 @@ public:
 			       sizeof(Version); /* captures VersionVector::maxVersion */
 		}
 
-		size_t tagIdSize = 0; // number of bytes needed to serialize an individual (potentially compacted) tag id
-		tagIdSize = (maxTagId <= UINT8_MAX) ? sizeof(uint8_t) : sizeof(uint16_t);
+		size_t tagIdBytes = 0; // number of bytes needed to serialize the (potentially compacted) tag ids
+		if (useTagIdGaps(maxTagId, tagIdGapBytes)) {
+			tagIdBytes = tagIdGapBytes;
+		} else {
+			tagIdBytes = this->size() * ((maxTagId <= UINT8_MAX) ? sizeof(uint8_t) : sizeof(uint16_t));
+		}
 
 		size_t commitVersionSize = 0; // number of bytes needed to serialize an individual commit version
 		if ((maxVersion - minVersion) <= UINT8_MAX) {
@@ -278,7 +311,7 @@ public:
 		       sizeof(uint8_t) + /* number of bytes needed to serialize an individual commit version */
 		       sizeof(Version) + /* the lowest commit version in the version vector */
 		       sizeof(size_t) + /* number of <tagid, version> pairs */
-		       this->size() * (tagIdSize + commitVersionSize) + /* encoded <tagid, version> pairs */
+		       tagIdBytes + this->size() * commitVersionSize + /* encoded <tagid, version> pairs */
 		       sizeof(Version); /* VersionVector::maxVersion */
 	}
 
@@ -289,6 +322,15 @@ public:
 		out += sizeof(T);
 	}
 
+	// Copy a gap between tag ids into the serialization buffer, 7 bits per byte, lowest bits first.
+	void serializeTagIdGap(uint8_t*& out, uint16_t gap) const {
+		while (gap >= 0x80) {
+			*out++ = uint8_t(gap | 0x80);
+			gap >>= 7;
+		}
+		*out++ = uint8_t(gap);
+	}
+
 	// Copy RLE encoded tag locality values into the serialization buffer.
 	void serializeTagLocalities(size_t utlCount, uint8_t*& out) const {
 		serialize<size_t>(out, utlCount); // unique tag locality count
@@ -320,12 +362,12 @@ public:
 	}
 
 	// Copy encoded tag id and commit version values into the serialization buffer.
-	// T: Type to be used to serialize tag ids (uint8_t/uint16_t)
+	// T: Type to be used to serialize tag ids (uint8_t/uint16_t/TagIdGaps)
 	// V: Type to be used to serialize commit version deltas (uint8_t/uint16_t/uint32_t/uint64_t)
 	template <typename T, typename V>
 	void serializeSizedTagIdsAndSizedCommitVersions(Version minCommitVersion, uint8_t*& out) const {
 		// Number of bytes that will be used to serialize an individual tag id.
-		serialize<uint8_t>(out, (uint8_t)sizeof(T));
+		serialize<uint8_t>(out, getTagIdEncodedSize<T>());
 		// Number of bytes that will be used to serialize an individual commit version delta value.
 		serialize<uint8_t>(out, (uint8_t)sizeof(V));
 		// The lowest commit version in the version vector.
@@ -333,9 +375,20 @@ public:
 		// The number of <tagId, commitVersion> pairs.
 		serialize<size_t>(out, (this->size()));
 
+		int8_t locality = tagLocalityInvalid;
+		uint16_t prevTagId = 0;
 		for (const auto& [tag, version] : versions) {
 			// Serialize tag id.
-			serialize<T>(out, (T)tag.id);
+			if constexpr (std::is_same_v<T, TagIdGaps>) {
+				if (locality != tag.locality) {
+					locality = tag.locality;
+					prevTagId = 0;
+				}
+				serializeTagIdGap(out, tag.id - prevTagId);
+				prevTagId = tag.id;
+			} else {
+				serialize<T>(out, (T)tag.id);
+			}
 
 			// Serialize commit version delta.
 			serialize<V>(out, (V)(version - minCommitVersion));
@@ -344,7 +397,7 @@ public:
 
 	// Figure out the type to be used to serialize delta encoded commit version values,
 	// and call the above method to do the serialization.
-	// T: Type to be used to serialize tag ids (uint8_t/uint16_t)
+	// T: Type to be used to serialize tag ids (uint8_t/uint16_t/TagIdGaps)
 	template <typename T>
 	void serializeSizedTagIdsAndCommitVersions(Version minVersion, Version maxVersion, uint8_t*& out) const {
 		if ((maxVersion - minVersion) <= UINT8_MAX) {
@@ -361,11 +414,14 @@ public:
 	// Figure out the types to be used to serialize (potentially compacted) tag ids and delta
 	// encoded commit version values, and call the above methods to do the serialization.
 	void serializeTagIdsAndCommitVersions(uint16_t maxTagId,
+	                                      size_t tagIdGapBytes,
 	                                      Version minVersion,
 	                                      Version maxVersion,
 	                                      uint8_t*& out) const {
 		ASSERT(!this->empty());
-		if (maxTagId <= UINT8_MAX) {
+		if (useTagIdGaps(maxTagId, tagIdGapBytes)) {
+			serializeSizedTagIdsAndCommitVersions<TagIdGaps>(minVersion, maxVersion, out);
+		} else if (maxTagId <= UINT8_MAX) {
 			serializeSizedTagIdsAndCommitVersions<uint8_t>(minVersion, maxVersion, out);
 		} else {
 			serializeSizedTagIdsAndCommitVersions<uint16_t>(minVersion, maxVersion, out);
@@ -383,6 +439,18 @@ public:
 		data += sizeof(T);
 	}
 
+	// Extract a gap between tag ids from the serialization buffer.
+	void deserializeTagIdGap(const uint8_t*& data, uint16_t& gap) const {
+		gap = 0;
+		for (int shift = 0;; shift += 7) {
+			uint8_t byte = *data++;
+			gap |= uint16_t(byte & 0x7f) << shift;
+			if (!(byte & 0x80)) {
+				break;
+			}
+		}
+	}
+
 	// Deserialize RLE encoded tag locality values.
 	void deserializeLocalities(const uint8_t*& data,
 	                           size_t& utlCount,
@@ -413,7 +481,7 @@ public:
 	}
 
 	// Deserialize tag ids and commit version values.
-	// T: Type that was used to serialize tag ids (uint8_t/uint16_t)
+	// T: Type that was used to serialize tag ids (uint8_t/uint16_t/TagIdGaps)
 	// V: Type that was used to serialize commit version deltas (uint8_t/uint16_t/uint32_t/uint64_t)
 	template <typename T, typename V>
 	void deserializeSizedTagIdsAndSizedCommitVersions(const uint8_t*& data,
@@ -425,12 +493,22 @@ public:
 		size_t pairCount; // number of serialized <tag id, commit version> pairs
 		deserialize<size_t>(data, pairCount);
 
-		T tagId;
+		uint16_t tagId;
 		V versionDelta;
 		for (size_t i = 0; i < localities.size(); i++) {
+			uint16_t prevTagId = 0;
 			for (size_t j = 0; j < localityCounts[i]; j++) {
 				// Deserialize tag id.
-				deserialize<T>(data, tagId);
+				if constexpr (std::is_same_v<T, TagIdGaps>) {
+					uint16_t gap;
+					deserializeTagIdGap(data, gap);
+					tagId = prevTagId + gap;
+					prevTagId = tagId;
+				} else {
+					T id;
+					deserialize<T>(data, id);
+					tagId = id;
+				}
 
 				// Deserialize commit version delta.
 				deserialize<V>(data, versionDelta);
@@ -443,7 +521,7 @@ public:
 
 	// Figrue out the type that was used to serialize commit version deltas and call the above
 	// method to do the deserialization.
-	// T: Type that was used to serialize tag ids (uint8_t/uint16_t)
+	// T: Type that was used to serialize tag ids (uint8_t/uint16_t/TagIdGaps)
 	template <typename T>
 	void deserializeSizedTagIdsAndCommitVersions(const uint8_t*& data,
 	                                             std::vector<int8_t>& localities,
@@ -472,7 +550,9 @@ public:
 		uint8_t tagIdSize; // number of bytes that were used to serialize an individual tag id
 		deserialize<uint8_t>(data, tagIdSize);
 
-		if (tagIdSize == sizeof(uint8_t)) {
+		if (tagIdSize == TagIdGapsEncodedSize) {
+			deserializeSizedTagIdsAndCommitVersions<TagIdGaps>(data, localities, localityCounts);
+		} else if (tagIdSize == sizeof(uint8_t)) {
 			deserializeSizedTagIdsAndCommitVersions<uint8_t>(data, localities, localityCounts);
 		} else {
 			ASSERT(tagIdSize == sizeof(uint16_t));
@@ -520,13 +600,14 @@ struct dynamic_size_traits<VersionVector> : std::true_type {
 
 		size_t utlCount; // unique tag locality count
 		uint16_t maxTagId; // the highest tag id in the version vector
+		size_t tagIdGapBytes; // the size of the gap encoded tag ids
 		Version minCommitVersion; // the lowest commit version in the version vector (in "VersionVector::versions")
 		Version maxCommitVersion; // the highest commit version in the version vector (in "VersionVector::versions")
-		vv.getTagAndCommitVersionInfo(utlCount, maxTagId, minCommitVersion, maxCommitVersion);
+		vv.getTagAndCommitVersionInfo(utlCount, maxTagId, tagIdGapBytes, minCommitVersion, maxCommitVersion);
 
 		vv.serializeTagLocalities(utlCount, out);
 		if (!vv.empty()) {
-			vv.serializeTagIdsAndCommitVersions(maxTagId, minCommitVersion, maxCommitVersion, out);
+			vv.serializeTagIdsAndCommitVersions(maxTagId, tagIdGapBytes, minCommitVersion, maxCommitVersion, out);
 		}
 
 		// Serialize vv::maxVersion.
@@ -130,6 +130,33 @@ public:
 	void trim_to_bound() { size_ = bound_sz_; }
 };
 
+// While a VersionedMap is being modified, the nodes update() drops the last reference to are moved to its list of
+// retired nodes instead of being destroyed, so that a large subtree cut off by a range remove is freed a few nodes at
+// a time by VersionedMap::forgetVersionsBeforeAsync() rather than all at once by a recursive destructor.
+template <class Node>
+struct RetiredNodes {
+	static thread_local std::vector<Reference<Node>>* sink;
+
+	// Retires into to until destroyed
+	struct Scope : NonCopyable {
+		explicit Scope(std::vector<Reference<Node>>& to) : outer(std::exchange(sink, &to)) {}
+		~Scope() { sink = outer; }
+		std::vector<Reference<Node>>* outer;
+	};
+};
+
+template <class Node>
+thread_local std::vector<Reference<Node>>* RetiredNodes<Node>::sink = nullptr;
+
+template <class T>
+void replacePointer(Reference<PTree<T>>& pointer, Reference<PTree<T>> const& ptr) {
+	auto* sink = RetiredNodes<PTree<T>>::sink;
+	if (sink && pointer && pointer->isSoleOwner()) {
+		sink->push_back(std::move(pointer));
+	}
+	pointer = ptr;
+}
+
 template <class T>
 static Reference<PTree<T>> update(Reference<PTree<T>> const& node,
                                   bool which,
@@ -151,10 +178,7 @@ static Reference<PTree<T>> update(Reference<PTree<T>> const& node,
 			node->pointer[2].clear();
 			return r;
 		} else {
-			if (node->updated)
-				node->pointer[2] = ptr;
-			else
-				node->pointer[which] = ptr;
+			replacePointer(node->pointer[node->updated ? 2 : which], ptr);
 			return node;
 		}
 	}
@@ -491,6 +515,52 @@ void demoteRoot(Reference<PTree<T>>& p, Version at) {
 	p = update(p, !higherDirection, child, at);
 }
 
+// Modifies p to point to a PTree with the sorted, distinct items [begin, end) inserted, as if by calling insert() for
+// each. Every node on the search paths of the items is visited and updated once, rather than once per item below it.
+template <class T>
+void insertSorted(Reference<PTree<T>>& p, Version at, const T* begin, const T* end) {
+	if (begin == end)
+		return;
+	if (!p) {
+		// Build the treap of new nodes directly: each node's left child is the last node popped off the stack of
+		// nodes on the right spine with lower priorities
+		std::vector<Reference<PTree<T>>> spine;
+		for (const T* x = begin; x != end; ++x) {
+			auto node = makeReference<PTree<T>>(*x, at);
+			Reference<PTree<T>> last;
+			while (!spine.empty() && spine.back()->priority < node->priority) {
+				last = std::move(spine.back());
+				spine.pop_back();
+			}
+			node->pointer[0] = std::move(last);
+			if (!spine.empty())
+				spine.back()->pointer[1] = node;
+			spine.push_back(std::move(node));
+		}
+		p = spine.front();
+		return;
+	}
+
+	const T* lo = std::partition_point(begin, end, [&](const T& x) { return ::compare(x, p->data) < 0; });
+	const T* hi = lo;
+	if (hi != end && ::compare(*hi, p->data) == 0) {
+		p = makeReference<PTree<T>>(p->priority, *hi, p->left(at), p->right(at), at);
+		++hi;
+	}
+	if (begin != lo) {
+		Reference<PTree<T>> child = p->child(false, at);
+		insertSorted(child, at, begin, lo);
+		p = update(p, false, child, at);
+	}
+	if (hi != end) {
+		Reference<PTree<T>> child = p->child(true, at);
+		insertSorted(child, at, hi, end);
+		p = update(p, true, child, at);
+	}
+	// Both subtrees are valid treaps, but their new roots may outrank p
+	demoteRoot(p, at);
+}
+
 template <class T>
 Reference<PTree<T>> append(const Reference<PTree<T>>& left, const Reference<PTree<T>>& right, Version at) {
 	if (!left)
@@ -676,6 +746,10 @@ public:
 	// binary-searchable.
 	std::deque<std::pair<Version, Tree>> roots;
 
+	// Nodes the latest version stopped referencing while being modified, which no version references. They are freed
+	// by the next forgetVersionsBefore() or forgetVersionsBeforeAsync().
+	std::vector<Tree> retired;
+
 	struct rootsComparator {
 		bool operator()(const std::pair<Version, Tree>& value, const Version& key) { return (value.first < key); }
 		bool operator()(const Version& key, const std::pair<Version, Tree>& value) { return (key < value.first); }
@@ -693,11 +767,13 @@ public:
 
 	VersionedMap() : oldestVersion(0), latestVersion(0) { roots.emplace_back(0, Tree()); }
 	VersionedMap(VersionedMap&& v) noexcept
-	  : oldestVersion(v.oldestVersion), latestVersion(v.latestVersion), roots(std::move(v.roots)) {}
+	  : oldestVersion(v.oldestVersion), latestVersion(v.latestVersion), roots(std::move(v.roots)),
+	    retired(std::move(v.retired)) {}
 	void operator=(VersionedMap&& v) noexcept {
 		oldestVersion = v.oldestVersion;
 		latestVersion = v.latestVersion;
 		roots = std::move(v.roots);
+		retired = std::move(v.retired);
 	}
 
 	Version getLatestVersion() const { return latestVersion; }
@@ -720,6 +796,7 @@ public:
 		UNSTOPPABLE_ASSERT(r->first == newOldestVersion);
 		roots.erase(roots.begin(), r);
 		oldestVersion = newOldestVersion;
+		retired.clear();
 	}
 
 	Future<Void> forgetVersionsBeforeAsync(Version newOldestVersion, TaskPriority taskID = TaskPriority::DefaultYield) {
@@ -751,6 +828,11 @@ public:
 			}
 		}
 
+		for (auto& node : retired) {
+			toFree.push_back(std::move(node));
+		}
+		retired.clear();
+
 		roots.erase(roots.begin(), newBegin);
 		oldestVersion = newOldestVersion;
 		return deferredCleanupActor(toFree, taskID);
@@ -770,18 +852,43 @@ public:
 	// insert() and erase() invalidate atLatest() and all iterators into it
 	void insert(const K& k, const T& t) { insert(k, t, latestVersion); }
 	void insert(const K& k, const T& t, Version insertAt) {
+		RetireScope scope(retired);
 		PTreeImpl::insert(
 		    roots.back().second, latestVersion, MapPair<K, std::pair<T, Version>>(k, std::make_pair(t, insertAt)));
 	}
-	void erase(const K& begin, const K& end) { PTreeImpl::remove(roots.back().second, latestVersion, begin, end); }
+	// Inserts items, which must be sorted by key without duplicates, as insert() would one at a time. The value of
+	// each item is its value and insert version.
+	void insertSorted(std::vector<MapPair<K, std::pair<T, Version>>> const& items) {
+		PTreeImpl::insertSorted(roots.back().second, latestVersion, items.data(), items.data() + items.size());
+	}
+	// Takes O(log n) time however large the range is; the nodes of the items erased are freed later. See retired.
+	void erase(const K& begin, const K& end) {
+		RetireScope scope(retired);
+		Tree before = roots.back().second;
+		PTreeImpl::remove(roots.back().second, latestVersion, begin, end);
+		retireRoot(before);
+	}
 	void erase(const K& key) { // key must be present
+		RetireScope scope(retired);
 		PTreeImpl::remove(roots.back().second, latestVersion, key);
 	}
 	void erase(iterator const& item) { // iterator must be in latest version!
 		ASSERT_EQ(item.at, latestVersion);
+		RetireScope scope(retired);
 		PTreeImpl::removeFinger(roots.back().second, latestVersion, item.finger);
 	}
 
+private:
+	typedef typename PTreeImpl::RetiredNodes<PTreeT>::Scope RetireScope;
+
+	// The root of the latest version is replaced outside of PTreeImpl::update()
+	void retireRoot(Tree& before) {
+		if (before && before != roots.back().second && before->isSoleOwner()) {
+			retired.push_back(std::move(before));
+		}
+	}
+
+public:
 	void printDetail() { PTreeImpl::printTreeDetails(roots.back().second, 0); }
 
 	void printTree(Version at) { PTreeImpl::printTree(roots.back().second, at, 0); }
@@ -26,6 +26,7 @@
 #include "fdbclient/VersionedMap.h"
 #include "fdbclient/SnapshotCache.h"
 #include "fdbclient/Atomic.h"
+#include "fdbclient/Knobs.h"
 
 struct RYWMutation {
 	Optional<ValueRef> value;
@@ -126,7 +127,9 @@ private:
 	typedef Reference<PTreeT> Tree;
 
 public:
-	explicit WriteMap(Arena* arena) : arena(arena), writeMapEmpty(true), ver(-1), scratch_iterator(this) {
+	explicit WriteMap(Arena* arena)
+	  : arena(arena), writeMapEmpty(true), deferWrites(CLIENT_KNOBS->RYW_DEFER_WRITES), ver(-1),
+	    scratch_iterator(this) {
 		PTreeImpl::insert(
 		    writes, ver, WriteMapEntry(allKeys.begin, OperationStack(), false, false, false, false, false));
 		PTreeImpl::insert(writes, ver, WriteMapEntry(allKeys.end, OperationStack(), false, false, false, false, false));
@@ -135,8 +138,8 @@ public:
 	}
 
 	WriteMap(WriteMap&& r) noexcept
-	  : arena(r.arena), writeMapEmpty(r.writeMapEmpty), writes(std::move(r.writes)), ver(r.ver),
-	    scratch_iterator(std::move(r.scratch_iterator)) {}
+	  : arena(r.arena), writeMapEmpty(r.writeMapEmpty), deferWrites(r.deferWrites), deferredWrites(r.deferredWrites),
+	    writes(std::move(r.writes)), ver(r.ver), scratch_iterator(std::move(r.scratch_iterator)) {}
 
 	WriteMap& operator=(WriteMap&& r) noexcept;
 
@@ -155,9 +158,10 @@ public:
 		// regardless of the snapshot value) Every key will belong to exactly one segment.  The first segment begins at
 		// "" and the last segment ends at \xff\xff.
 
-		explicit iterator(WriteMap* map) : tree(map->writes), at(map->ver), offset(false) { ++map->ver; }
+		explicit iterator(WriteMap* map) : tree(map->applyDeferredWrites()), at(map->ver), offset(false) { ++map->ver; }
 		// Creates an iterator which is conceptually before the beginning of map (you may essentially only call skip()
 		// or ++ on it) This iterator also represents a snapshot (will be unaffected by future writes)
+		// Any deferred writes are applied to the map first.
 
 		enum SEGMENT_TYPE { UNMODIFIED_RANGE, CLEARED_RANGE, INDEPENDENT_WRITE, DEPENDENT_WRITE };
 
@@ -206,6 +210,18 @@ public:
 
 	bool empty() const { return writeMapEmpty; }
 
+	// A write to the map is first only appended to a list of deferred writes, and the list is applied to the tree when
+	// an iterator is next created, so a transaction that doesn't read its own writes doesn't pay for the tree. Once
+	// the tree is modified, writes are applied to it at once.
+	struct DeferredWrite {
+		MutationRef mutation; // A ClearRange for clear()
+		bool addConflict;
+	};
+
+	// Returns whether every write to the map is in getDeferredWrites(), in the order made
+	bool onlyDeferredWrites() const { return deferWrites; }
+	VectorRef<DeferredWrite> const& getDeferredWrites() const { return deferredWrites; }
+
 	static RYWMutation coalesce(RYWMutation existingEntry, RYWMutation newEntry, Arena& arena);
 	static void coalesceOver(OperationStack& stack, RYWMutation newEntry, Arena& arena);
 	static RYWMutation coalesceUnder(OperationStack const& stack, Optional<ValueRef> const& value, Arena& arena);
@@ -214,6 +230,8 @@ private:
 	friend class ReadYourWritesTransaction;
 	Arena* arena;
 	bool writeMapEmpty;
+	bool deferWrites;
+	VectorRef<DeferredWrite> deferredWrites; // In *arena
 	Tree writes;
 	// an internal version number for the tree - no connection to database versions!  Currently this is
 	// incremented after reads, so that consecutive writes have the same version and those separated by
@@ -223,6 +241,14 @@ private:
 
 	void dump();
 
+	// Returns the tree with any deferred writes applied
+	Tree const& applyDeferredWrites();
+	// Applies deferred writes and stops deferring them, before a change to the tree that isn't a write
+	void stopDeferringWrites();
+
+	void mutateTree(KeyRef key, MutationRef::Type operation, ValueRef param, bool addConflict);
+	void clearTree(KeyRangeRef keys, bool addConflict);
+
 	// SOMEDAY: clearNoConflict replaces cleared sets with two map entries for everyone one item cleared
 	void clearNoConflict(KeyRangeRef keys);
 };
@@ -39,7 +39,8 @@ EvictablePage::~EvictablePage() {
 		}
 	} else {
 		// remove it from the LRU
-		pageCache->lruPages.erase(EvictablePageCache::List::s_iterator_to(*this));
+		(protectedPage ? pageCache->protectedPages : pageCache->lruPages)
+		    .erase(EvictablePageCache::List::s_iterator_to(*this));
 	}
 }
 
@@ -97,6 +98,7 @@ Future<Void> AsyncFileCached::read_write_impl(AsyncFileCached* self,
 	int64_t pageOffset = offset - offsetInPage;
 
 	int remaining = length;
+	bool missed = false;
 
 	while (remaining) {
 		++self->countFileCacheFinds;
@@ -105,6 +107,7 @@ Future<Void> AsyncFileCached::read_write_impl(AsyncFileCached* self,
 		if (p == self->pages.end()) {
 			AFCPage* page = new AFCPage(self, pageOffset);
 			p = self->pages.insert(std::make_pair(pageOffset, page)).first;
+			missed = true;
 		} else {
 			self->pageCache->updateHit(p->second);
 		}
@@ -127,6 +130,24 @@ Future<Void> AsyncFileCached::read_write_impl(AsyncFileCached* self,
 		remaining -= bytesInPage;
 	}
 
+	if constexpr (!writing) {
+		// A read that misses the cache right where the previous read ended is likely part of a scan, so start reading
+		// the pages that follow it too, up to the end of the file
+		if (missed && offset == self->prevReadEnd) {
+			for (int i = 0; i < FLOW_KNOBS->FLOW_CACHEDFILE_PREFETCH_PAGES && pageOffset < self->length; ++i) {
+				if (self->pages.find(pageOffset) == self->pages.end()) {
+					AFCPage* page = new AFCPage(self, pageOffset);
+					self->pages.insert(std::make_pair(pageOffset, page));
+					page->notReading = AFCPage::readThrough(page);
+					++self->countFileCachePagePrefetches;
+					++self->countCachePagePrefetches;
+				}
+				pageOffset += self->pageCache->pageSize;
+			}
+		}
+		self->prevReadEnd = offset + length;
+	}
+
 	// This is susceptible to the introduction of waits on the read/write path: no wait can occur prior to
 	// AFCPage::readThrough or prevLength will be set prematurely
 	self->prevLength = self->length;
@@ -23,6 +23,7 @@
 #include "fdbrpc/fdbrpc.h"
 #include "flow/TLSConfig.actor.h"
 
+#include <array>
 #include <sstream>
 #include <cstdint>
 #include <ranges>
@@ -324,6 +325,44 @@ TEST_CASE("/flow/coro/cancel2") {
 	return Void();
 }
 
+namespace {
+
+// Holds Size bytes across a wait, so its frame is at least that large
+template <size_t Size>
+Future<int> sumAfterWait(Future<Void> f, uint8_t fill) {
+	std::array<uint8_t, Size> arr;
+	arr.fill(fill);
+	co_await f;
+	int sum = 0;
+	for (auto b : arr) {
+		sum += b;
+	}
+	co_return sum;
+}
+
+} // namespace
+
+TEST_CASE("/flow/coro/frameSizes") {
+	// Frames are allocated from each size class of FastAllocator, and from new beyond them
+	Promise<Void> p;
+	std::vector<Future<int>> sums;
+	for (int i = 0; i < 10; ++i) {
+		sums.push_back(sumAfterWait<16>(p.getFuture(), i));
+		sums.push_back(sumAfterWait<300>(p.getFuture(), i));
+		sums.push_back(sumAfterWait<3000>(p.getFuture(), i));
+		sums.push_back(sumAfterWait<20000>(p.getFuture(), i));
+	}
+	// Frames that are cancelled are freed too
+	Future<int> cancelled = sumAfterWait<3000>(p.getFuture(), 1);
+	cancelled = Future<int>();
+	p.send(Void());
+	for (int i = 0; i < sums.size(); ++i) {
+		const int sizes[] = { 16, 300, 3000, 20000 };
+		ASSERT(sums[i].isReady() && sums[i].get() == sizes[i % 4] * (i / 4));
+	}
+	return Void();
+}
+
 TEST_CASE("/flow/coro/trivial_actors") {
 	ASSERT(expectActorCount(0));
 
@@ -825,7 +864,7 @@ struct YAMRandom {
 				;
 
 		int k = deterministicRandom()->randomInt(0, kmax);
-		int op = deterministicRandom()->randomInt(0, 7);
+		int op = deterministicRandom()->randomInt(0, 8);
 		// printf("%d",op);
 		if (op == 0) {
 			onchanges.push_back(yam.onChange(k));
@@ -848,6 +887,14 @@ struct YAMRandom {
 			int a = deterministicRandom()->randomInt(0, kmax);
 			int b = deterministicRandom()->randomInt(0, kmax);
 			yam.triggerRange(std::min(a, b), std::max(a, b) + 1);
+		} else if (op == 7) {
+			std::vector<int> keys;
+			for (int i = 0; i < kmax; i++) {
+				if (deterministicRandom()->coinflip()) {
+					keys.push_back(i);
+				}
+			}
+			yam.triggerSorted(keys);
 		}
 	}
 };
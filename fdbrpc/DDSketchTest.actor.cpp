@@ -1,4 +1,4 @@
-#include "fdbrpc/DDSketch.h"
+#include "flow/DDSketch.h"
 #include "flow/Error.h"
 #include "flow/IRandom.h"
 #include "flow/UnitTest.h"
@@ -60,3 +60,64 @@ TEST_CASE("/fdbrpc/ddsketch/correctness") {
 	ASSERT(p999 > 0 && p999 != std::numeric_limits<double>::infinity());
 	return Void{};
 }
+
+template <class Sketch, class T>
+static void checkSameSketch(Sketch& a, Sketch& b) {
+	ASSERT(a.getSamples() == b.getSamples());
+	ASSERT(a.getPopulationSize() == b.getPopulationSize());
+	ASSERT(a.min() == b.min() && a.max() == b.max() && a.getSum() == b.getSum());
+	for (double p : { 0.0, 0.01, 0.5, 0.9, 0.99, 1.0 }) {
+		ASSERT(a.percentile(p) == b.percentile(p));
+	}
+}
+
+// addSamples() and mergeWith() must give exactly the same sketch as adding each sample to one sketch
+template <class Sketch, class T, class Fn>
+static void testAddSamples(Sketch makeSketch(), Fn genSample) {
+	std::vector<T> samples;
+	const int count = deterministicRandom()->randomInt(1, 1000);
+	for (int i = 0; i < count; i++) {
+		samples.push_back(deterministicRandom()->random01() < 0.05 ? T(0) : genSample());
+	}
+	const size_t split = deterministicRandom()->randomInt(0, count + 1);
+
+	Sketch one = makeSketch(), bulk = makeSketch(), first = makeSketch(), second = makeSketch();
+	for (T sample : samples) {
+		one.addSample(sample);
+	}
+	bulk.addSamples(samples);
+	checkSameSketch<Sketch, T>(one, bulk);
+
+	first.addSamples(std::span<const T>(samples).first(split));
+	second.addSamples(std::span<const T>(samples).subspan(split));
+	first.mergeWith(second);
+	ASSERT(first.getSamples() == one.getSamples());
+	ASSERT(first.getPopulationSize() == one.getPopulationSize());
+	ASSERT(first.min() == one.min() && first.max() == one.max());
+}
+
+TEST_CASE("/fdbrpc/ddsketch/addSamples") {
+	for (int i = 0; i < 100; i++) {
+		testAddSamples<DDSketch<double>, double>([]() { return DDSketch<double>(); },
+		                                         []() { return deterministicRandom()->random01() * 2.0; });
+		testAddSamples<DDSketch<double>, double>([]() { return DDSketch<double>(0.05); },
+		                                         []() { return pow(10, deterministicRandom()->random01() * 24 - 12); });
+		testAddSamples<DDSketch<int64_t>, int64_t>([]() { return DDSketch<int64_t>(0.01); },
+		                                           []() { return deterministicRandom()->randomInt64(1, 1e9); });
+		testAddSamples<DDSketchFastUnsigned, unsigned>([]() { return DDSketchFastUnsigned(); },
+		                                               []() { return deterministicRandom()->randomUInt32(); });
+	}
+	return Void();
+}
+
+TEST_CASE("/fdbrpc/ddsketch/fastlog") {
+	// fastlog() reads the exponent and significand from the bits of a double, which must match what frexp() returns
+	for (int i = 0; i < 10000; i++) {
+		double value = pow(10, deterministicRandom()->random01() * 600 - 300);
+		int e;
+		double s = frexp(value, &e) * 2 - 1;
+		double expected = ((fastLogger::A * s + fastLogger::B) * s + fastLogger::C) * s + e - 1;
+		ASSERT(fastLogger::fastlog(value) == expected);
+	}
+	return Void();
+}
@@ -29,6 +29,7 @@
 #include "fdbrpc/fdbrpc.h"
 #include "flow/IAsyncFile.h"
 #include "flow/TLSConfig.actor.h"
+#include "flow/PriorityMultiLock.actor.h"
 #include "flow/actorcompiler.h" // This must be the last #include.
 
 void forceLinkFlowTests() {}
@@ -1143,7 +1144,7 @@ struct YAMRandom {
 				;
 
 		int k = deterministicRandom()->randomInt(0, kmax);
-		int op = deterministicRandom()->randomInt(0, 7);
+		int op = deterministicRandom()->randomInt(0, 8);
 		// printf("%d",op);
 		if (op == 0) {
 			onchanges.push_back(yam.onChange(k));
@@ -1166,6 +1167,14 @@ struct YAMRandom {
 			int a = deterministicRandom()->randomInt(0, kmax);
 			int b = deterministicRandom()->randomInt(0, kmax);
 			yam.triggerRange(std::min(a, b), std::max(a, b) + 1);
+		} else if (op == 7) {
+			std::vector<int> keys;
+			for (int i = 0; i < kmax; i++) {
+				if (deterministicRandom()->coinflip()) {
+					keys.push_back(i);
+				}
+			}
+			yam.triggerSorted(keys);
 		}
 	}
 };
@@ -1617,3 +1626,166 @@ TEST_CASE("/flow/flow/FlowMutex") {
 
 	return Void();
 }
+
+TEST_CASE("/flow/flow/PriorityMultiLock/slots") {
+	state Reference<PriorityMultiLock> pml = makeReference<PriorityMultiLock>(4, std::vector<int>{ 1 });
+
+	state Future<PriorityMultiLock::Lock> a = pml->lock(0);
+	state Future<PriorityMultiLock::Lock> b = pml->lock(0, 3);
+	ASSERT(a.isReady() && b.isReady());
+	ASSERT(b.get().slots == 3 && pml->getRunnersCount() == 4);
+
+	// c needs more slots than will be available when a is released, and d, which would fit, has to wait behind it
+	state Future<PriorityMultiLock::Lock> c = pml->lock(0, 2);
+	state Future<PriorityMultiLock::Lock> d = pml->lock(0);
+	a.get().release();
+	wait(delay(0));
+	ASSERT(!c.isReady() && !d.isReady());
+	ASSERT(pml->getRunnersCount() == 3);
+
+	// A new request can't take the slot that is held for c either
+	state Future<PriorityMultiLock::Lock> e = pml->lock(0);
+	ASSERT(!e.isReady());
+
+	b.get().release();
+	wait(delay(0));
+	ASSERT(c.isReady() && d.isReady() && e.isReady());
+	ASSERT(c.get().slots == 2 && pml->getRunnersCount() == 4 && pml->getWaitersCount() == 0);
+
+	// A request for more slots than the concurrency limit gets all of them
+	state Future<PriorityMultiLock::Lock> f = pml->lock(0, 10);
+	c.get().release();
+	d.get().release();
+	e.get().release();
+	wait(delay(0));
+	ASSERT(f.isReady() && f.get().slots == 4 && pml->getRunnersCount() == 4);
+	f.get().release();
+	ASSERT(pml->getRunnersCount() == 0);
+
+	return Void();
+}
+
+TEST_CASE("/flow/flow/PriorityMultiLock/lockFor") {
+	state Reference<PriorityMultiLock> pml = makeReference<PriorityMultiLock>(2, std::vector<int>{ 1, 4 });
+
+	state Future<PriorityMultiLock::Lock> parent = pml->lock(1);
+	state Future<PriorityMultiLock::Lock> other = pml->lock(1);
+	ASSERT(parent.isReady() && other.isReady());
+	ASSERT(parent.get().priority == 1);
+
+	// The child of parent is queued at parent's priority, which is weighted more, ahead of the waiters already there
+	state Future<PriorityMultiLock::Lock> waiter = pml->lock(1);
+	state Future<PriorityMultiLock::Lock> child = pml->lockFor(parent.get(), 0);
+	ASSERT(!waiter.isReady() && !child.isReady());
+	ASSERT(pml->getWaitersCount(0) == 0 && pml->getWaitersCount(1) == 2);
+
+	other.get().release();
+	wait(delay(0));
+	ASSERT(child.isReady() && !waiter.isReady());
+	ASSERT(child.get().priority == 1);
+
+	// Once parent has released its lock, a child request keeps its own priority
+	parent.get().release();
+	wait(delay(0));
+	ASSERT(waiter.isReady());
+	state Future<PriorityMultiLock::Lock> orphan = pml->lockFor(parent.get(), 0);
+	ASSERT(!orphan.isReady() && pml->getWaitersCount(0) == 1);
+
+	child.get().release();
+	wait(delay(0));
+	ASSERT(orphan.isReady() && orphan.get().priority == 0);
+
+	return Void();
+}
+
+TEST_CASE("/flow/flow/PriorityMultiLock/order") {
+	state Reference<PriorityMultiLock> pml = makeReference<PriorityMultiLock>(1, std::vector<int>{ 1 });
+
+	state Future<PriorityMultiLock::Lock> holder = pml->lock(0);
+	ASSERT(holder.isReady());
+
+	// Waiters are granted in increasing order, and first come first served within an order
+	state Future<PriorityMultiLock::Lock> late = pml->lock(0, 1, 2.0);
+	state Future<PriorityMultiLock::Lock> early1 = pml->lock(0, 1, 1.0);
+	state Future<PriorityMultiLock::Lock> early2 = pml->lock(0, 1, 1.0);
+	// Work for the holder still goes ahead of all of them
+	state Future<PriorityMultiLock::Lock> child = pml->lockFor(holder.get(), 0);
+
+	holder.get().release();
+	wait(delay(0));
+	ASSERT(child.isReady() && !early1.isReady() && !early2.isReady() && !late.isReady());
+
+	child.get().release();
+	wait(delay(0));
+	ASSERT(early1.isReady() && !early2.isReady() && !late.isReady());
+
+	early1.get().release();
+	wait(delay(0));
+	ASSERT(early2.isReady() && !late.isReady());
+
+	early2.get().release();
+	wait(delay(0));
+	ASSERT(late.isReady());
+	late.get().release();
+	ASSERT(pml->getRunnersCount() == 0 && pml->getWaitersCount() == 0);
+
+	return Void();
+}
+
+TEST_CASE("/flow/flow/PriorityMultiLock/random") {
+	state int concurrency = deterministicRandom()->randomInt(1, 10);
+	state std::vector<int> weights;
+	state int i;
+	for (i = deterministicRandom()->randomInt(1, 4); i > 0; --i) {
+		weights.push_back(deterministicRandom()->randomInt(1, 10));
+	}
+	state Reference<PriorityMultiLock> pml = makeReference<PriorityMultiLock>(concurrency, weights);
+	state std::vector<Future<PriorityMultiLock::Lock>> locks;
+
+	for (i = 0; i < 10000; ++i) {
+		const int r = deterministicRandom()->randomInt(0, 3);
+		if (r == 0 || locks.empty()) {
+			const int priority = deterministicRandom()->randomInt(0, weights.size());
+			const int slots = deterministicRandom()->randomInt(1, concurrency + 2);
+			auto held = std::find_if(locks.begin(), locks.end(), [](auto& f) { return f.isReady(); });
+			if (held != locks.end() && deterministicRandom()->coinflip()) {
+				locks.push_back(pml->lockFor(held->get(), priority, slots));
+			} else {
+				locks.push_back(pml->lock(priority, slots));
+			}
+		} else {
+			// Release a lock that has been granted, or drop a request
+			const int j = deterministicRandom()->randomInt(0, locks.size());
+			if (locks[j].isReady()) {
+				locks[j].get().release();
+			}
+			locks[j] = locks.back();
+			locks.pop_back();
+		}
+		if (deterministicRandom()->random01() < 0.1) {
+			wait(delay(0));
+		}
+
+		int held = 0;
+		for (auto& f : locks) {
+			if (f.isReady()) {
+				held += f.get().slots;
+			}
+		}
+		ASSERT(pml->getRunnersCount() <= concurrency);
+		ASSERT(held <= pml->getRunnersCount());
+	}
+
+	// Every request is granted once the others are released
+	while (!locks.empty()) {
+		wait(delay(0));
+		auto granted = std::find_if(locks.begin(), locks.end(), [](auto& f) { return f.isReady(); });
+		ASSERT(granted != locks.end());
+		granted->get().release();
+		locks.erase(granted);
+	}
+	wait(delay(0));
+	ASSERT(pml->getRunnersCount() == 0 && pml->getWaitersCount() == 0);
+
+	return Void();
+}
@@ -23,11 +23,13 @@
 #include "flow/network.h"
 
 #include <cstdint>
+#include <typeindex>
 #include <unordered_map>
 #if VALGRIND
 #include <memcheck.h>
 #endif
 
+#include <boost/core/demangle.hpp>
 #include <boost/unordered_map.hpp>
 
 #include "fdbrpc/TokenSign.h"
@@ -40,6 +42,7 @@
 #include "fdbrpc/TokenCache.h"
 #include "fdbrpc/simulator.h"
 #include "flow/ActorCollection.h"
+#include "flow/CompressionUtils.h"
 #include "flow/Error.h"
 #include "flow/flow.h"
 #include "flow/Net2Packet.h"
@@ -63,10 +66,21 @@ namespace {
 NetworkAddressList g_currentDeliveryPeerAddress = NetworkAddressList();
 bool g_currentDeliverPeerAddressTrusted = false;
 Future<Void> g_currentDeliveryPeerDisconnect;
+const std::type_info* g_currentDeliverySampledReceiver = nullptr;
 
 } // namespace
 
 constexpr int PACKET_LEN_WIDTH = sizeof(uint32_t);
+// Set in the packet length of a packet whose message, after the token, is compressed with zstd
+constexpr uint32_t PACKET_COMPRESSED_FLAG = 1u << 31;
+
+static bool packetCompressionSupported() {
+#ifdef ZSTD_LIB_SUPPORTED
+	return true;
+#else
+	return false;
+#endif
+}
 const uint64_t TOKEN_STREAM_FLAG = 1;
 
 FDB_BOOLEAN_PARAM(InReadSocket);
@@ -352,8 +366,100 @@ public:
 	Future<Void> publicKeyFileWatch;
 
 	std::unordered_map<Standalone<StringRef>, PublicKey> publicKeys;
+
+	// The latencies of a sample of the messages received, by the type of their receiver
+	struct RpcLatencyStats {
+		std::string name;
+		// From a message being read off its connection to its receiver being called, mostly waiting to be run
+		DDSketch<double> queueLatencies;
+		// From a request being given to its receiver to its reply being sent
+		DDSketch<double> serviceLatencies;
+
+		explicit RpcLatencyStats(std::string name) : name(std::move(name)) {}
+	};
+	std::unordered_map<std::type_index, std::unique_ptr<RpcLatencyStats>> rpcLatencies;
+	uint64_t rpcLatencyMessages;
+	double rpcLatencyLoggedTime;
+	Future<Void> rpcLatencyLogger;
+
+	RpcLatencyStats* getRpcLatencyStats(const std::type_info& receiverType);
 };
 
+// Names the messages given to a receiver by the message type, e.g. GetValueRequest for a
+// NetNotifiedQueue<GetValueRequest, false>, so that the name can be used as a trace event field name
+static std::string rpcTypeName(const std::type_info& receiverType) {
+	std::string name = boost::core::demangle(receiverType.name());
+	size_t begin = name.find('<');
+	if (begin != std::string::npos) {
+		size_t end = name.find_first_of(",>", begin);
+		name = name.substr(begin + 1, end - begin - 1);
+	}
+	for (char& c : name) {
+		if (!isalnum(static_cast<unsigned char>(c))) {
+			c = '_';
+		}
+	}
+	return name;
+}
+
+TransportData::RpcLatencyStats* TransportData::getRpcLatencyStats(const std::type_info& receiverType) {
+	auto& stats = rpcLatencies[std::type_index(receiverType)];
+	if (!stats) {
+		stats = std::make_unique<RpcLatencyStats>(rpcTypeName(receiverType));
+	}
+	return stats.get();
+}
+
+// Logs the latencies of each type of message received in an RpcLatency event, and those of the most common types in an
+// RpcLatencyMetrics event for status
+ACTOR Future<Void> rpcLatencyLogger(TransportData* self) {
+	loop {
+		wait(delay(FLOW_KNOBS->RPC_LATENCY_LOGGING_INTERVAL));
+
+		std::vector<TransportData::RpcLatencyStats*> sampled;
+		for (auto& [_, stats] : self->rpcLatencies) {
+			if (stats->queueLatencies.getPopulationSize()) {
+				sampled.push_back(stats.get());
+			}
+		}
+		std::sort(sampled.begin(), sampled.end(), [](auto const* a, auto const* b) {
+			return std::make_pair(b->queueLatencies.getPopulationSize(), a->name) <
+			       std::make_pair(a->queueLatencies.getPopulationSize(), b->name);
+		});
+
+		double elapsed = now() - self->rpcLatencyLoggedTime;
+		TraceEvent metrics("RpcLatencyMetrics");
+		metrics.detail("Elapsed", elapsed);
+		for (int i = 0; i < sampled.size(); ++i) {
+			auto* stats = sampled[i];
+			TraceEvent("RpcLatency")
+			    .detail("Type", stats->name)
+			    .detail("Elapsed", elapsed)
+			    .detail("Count", stats->queueLatencies.getPopulationSize())
+			    .detail("QueueMedian", stats->queueLatencies.median())
+			    .detail("QueueP99", stats->queueLatencies.percentile(0.99))
+			    .detail("QueueMax", stats->queueLatencies.max())
+			    .detail("ServiceCount", stats->serviceLatencies.getPopulationSize())
+			    .detail("ServiceMedian", stats->serviceLatencies.median())
+			    .detail("ServiceP99", stats->serviceLatencies.percentile(0.99))
+			    .detail("ServiceMax",
+			            stats->serviceLatencies.getPopulationSize() ? stats->serviceLatencies.max() : 0.0);
+			if (i < FLOW_KNOBS->RPC_LATENCY_STATUS_TYPES) {
+				metrics.detail(stats->name + ".Count", stats->queueLatencies.getPopulationSize())
+				    .detail(stats->name + ".QueueMedian", stats->queueLatencies.median())
+				    .detail(stats->name + ".QueueP99", stats->queueLatencies.percentile(0.99))
+				    .detail(stats->name + ".ServiceCount", stats->serviceLatencies.getPopulationSize())
+				    .detail(stats->name + ".ServiceMedian", stats->serviceLatencies.median())
+				    .detail(stats->name + ".ServiceP99", stats->serviceLatencies.percentile(0.99));
+			}
+			stats->queueLatencies.clear();
+			stats->serviceLatencies.clear();
+		}
+		metrics.trackLatest("RpcLatencyMetrics");
+		self->rpcLatencyLoggedTime = now();
+	}
+}
+
 ACTOR Future<Void> pingLatencyLogger(TransportData* self) {
 	state NetworkAddress lastAddress = NetworkAddress();
 	loop {
@@ -392,13 +498,19 @@ ACTOR Future<Void> pingLatencyLogger(TransportData* self) {
 				    .detail("ConnectMaxLatency", peer->connectLatencies.max())
 				    .detail("ConnectMeanLatency", peer->connectLatencies.mean())
 				    .detail("ConnectMedianLatency", peer->connectLatencies.median())
-				    .detail("ConnectP90Latency", peer->connectLatencies.percentile(0.90));
+				    .detail("ConnectP90Latency", peer->connectLatencies.percentile(0.90))
+				    .detail("CompressionInputBytes", peer->compressionInputBytes)
+				    .detail("CompressionOutputBytes", peer->compressionOutputBytes)
+				    .detail("CompressionTime", peer->compressionTime);
 				peer->lastLoggedTime = now();
 				peer->connectOutgoingCount = 0;
 				peer->connectIncomingCount = 0;
 				peer->connectFailedCount = 0;
 				peer->pingLatencies.clear();
 				peer->connectLatencies.clear();
+				peer->compressionInputBytes = 0;
+				peer->compressionOutputBytes = 0;
+				peer->compressionTime = 0;
 				peer->lastLoggedBytesReceived = peer->bytesReceived;
 				peer->lastLoggedBytesSent = peer->bytesSent;
 				peer->timeoutCount = 0;
@@ -415,9 +527,12 @@ ACTOR Future<Void> pingLatencyLogger(TransportData* self) {
 TransportData::TransportData(uint64_t transportId, int maxWellKnownEndpoints, IPAllowList const* allowList)
   : endpoints(maxWellKnownEndpoints), endpointNotFoundReceiver(endpoints), pingReceiver(endpoints),
     numIncompatibleConnections(0), lastIncompatibleMessage(0), transportId(transportId),
-    allowList(allowList == nullptr ? IPAllowList() : *allowList) {
+    allowList(allowList == nullptr ? IPAllowList() : *allowList), rpcLatencyMessages(0), rpcLatencyLoggedTime(now()) {
 	degraded = makeReference<AsyncVar<bool>>(false);
 	pingLogger = pingLatencyLogger(this);
+	if (FLOW_KNOBS->RPC_LATENCY_SAMPLE_INTERVAL > 0) {
+		rpcLatencyLogger = ::rpcLatencyLogger(this);
+	}
 }
 
 #define CONNECT_PACKET_V0 0x0FDB00A444020001LL
@@ -437,7 +552,7 @@ struct ConnectPacket {
 	// IP Address to reconnect to the originating process. Only one of these must be populated.
 	uint32_t canonicalRemoteIp4 = 0;
 
-	enum ConnectPacketFlags { FLAG_IPV6 = 1 };
+	enum ConnectPacketFlags { FLAG_IPV6 = 1, FLAG_ACCEPTS_COMPRESSION = 2 };
 	uint16_t flags = 0;
 	uint8_t canonicalRemoteIp6[16] = { 0 };
 
@@ -465,6 +580,8 @@ struct ConnectPacket {
 
 	bool isIPv6() const { return flags & FLAG_IPV6; }
 
+	bool acceptsCompression() const { return flags & FLAG_ACCEPTS_COMPRESSION; }
+
 	uint32_t totalPacketSize() const { return connectPacketLength + sizeof(connectPacketLength); }
 
 	template <class Ar>
@@ -589,15 +706,22 @@ ACTOR Future<Void> connectionMonitor(Reference<Peer> peer) {
 
 ACTOR Future<Void> connectionWriter(Reference<Peer> self, Reference<IConnection> conn) {
 	state double lastWriteTime = now();
+	// The least time between writes. With MAX_ADAPTIVE_COALESCE_DELAY, it grows while a busy connection only gets small
+	// writes, so that more packets go out per write call.
+	state double coalesceDelay = FLOW_KNOBS->MAX_COALESCE_DELAY;
+	state bool busy;
+	state int64_t written;
 	loop {
+		// The connection is busy if there was data to send again before the delay since the last write passed
+		busy = coalesceDelay - (now() - lastWriteTime) > FLOW_KNOBS->MIN_COALESCE_DELAY;
 		// wait( delay(0, TaskPriority::WriteSocket) );
-		wait(delayJittered(
-		    std::max<double>(FLOW_KNOBS->MIN_COALESCE_DELAY, FLOW_KNOBS->MAX_COALESCE_DELAY - (now() - lastWriteTime)),
-		    TaskPriority::WriteSocket));
+		wait(delayJittered(std::max<double>(FLOW_KNOBS->MIN_COALESCE_DELAY, coalesceDelay - (now() - lastWriteTime)),
+		                   TaskPriority::WriteSocket));
 		// wait( delay(500e-6, TaskPriority::WriteSocket) );
 		// wait( yield(TaskPriority::WriteSocket) );
 
 		// Send until there is nothing left to send
+		written = 0;
 		loop {
 			lastWriteTime = now();
 
@@ -606,6 +730,7 @@ ACTOR Future<Void> connectionWriter(Reference<Peer> self, Reference<IConnection>
 				self->bytesSent += sent;
 				self->transport->bytesSent += sent;
 				self->unsent.sent(sent);
+				written += sent;
 			}
 
 			if (self->unsent.empty()) {
@@ -618,6 +743,14 @@ ACTOR Future<Void> connectionWriter(Reference<Peer> self, Reference<IConnection>
 			wait(yield(TaskPriority::WriteSocket));
 		}
 
+		if (FLOW_KNOBS->MAX_ADAPTIVE_COALESCE_DELAY > FLOW_KNOBS->MAX_COALESCE_DELAY) {
+			if (busy && written < FLOW_KNOBS->COALESCE_TARGET_BYTES) {
+				coalesceDelay = std::min(std::max(coalesceDelay, 1e-6) * 2, FLOW_KNOBS->MAX_ADAPTIVE_COALESCE_DELAY);
+			} else {
+				coalesceDelay = std::max(coalesceDelay / 2, FLOW_KNOBS->MAX_COALESCE_DELAY);
+			}
+		}
+
 		// Wait until there is something to send
 		while (self->unsent.empty())
 			wait(self->dataToSend.onTrigger());
@@ -804,6 +937,7 @@ ACTOR Future<Void> connectionKeeper(Reference<Peer> self,
 			}
 
 			self->discardUnreliablePackets();
+			self->acceptsCompression = false;
 			reader = Future<Void>();
 			bool ok = e.code() == error_code_connection_failed || e.code() == error_code_actor_cancelled ||
 			          e.code() == error_code_connection_unreferenced || e.code() == error_code_connection_idle ||
@@ -890,14 +1024,15 @@ ACTOR Future<Void> connectionKeeper(Reference<Peer> self,
 }
 
 Peer::Peer(TransportData* transport, NetworkAddress const& destination)
-  : transport(transport), destination(destination), compatible(true), connected(false), outgoingConnectionIdle(true),
-    lastConnectTime(0.0), reconnectionDelay(FLOW_KNOBS->INITIAL_RECONNECTION_TIME), peerReferences(-1),
-    bytesReceived(0), bytesSent(0), lastDataPacketSentTime(now()), outstandingReplies(0),
+  : transport(transport), destination(destination), compatible(true), connected(false), acceptsCompression(false),
+    outgoingConnectionIdle(true), lastConnectTime(0.0), reconnectionDelay(FLOW_KNOBS->INITIAL_RECONNECTION_TIME),
+    peerReferences(-1), bytesReceived(0), bytesSent(0), lastDataPacketSentTime(now()), outstandingReplies(0),
     pingLatencies(destination.isPublic() ? FLOW_KNOBS->PING_SKETCH_ACCURACY : 0.1), lastLoggedTime(0.0),
     lastLoggedBytesReceived(0), lastLoggedBytesSent(0), timeoutCount(0),
     protocolVersion(Reference<AsyncVar<Optional<ProtocolVersion>>>(new AsyncVar<Optional<ProtocolVersion>>())),
     connectOutgoingCount(0), connectIncomingCount(0), connectFailedCount(0),
-    connectLatencies(destination.isPublic() ? FLOW_KNOBS->PING_SKETCH_ACCURACY : 0.1) {
+    connectLatencies(destination.isPublic() ? FLOW_KNOBS->PING_SKETCH_ACCURACY : 0.1), compressionInputBytes(0),
+    compressionOutputBytes(0), compressionTime(0) {
 	IFailureMonitor::failureMonitor().setStatus(destination, FailureStatus(false));
 }
 
@@ -928,6 +1063,9 @@ void Peer::prependConnectPacket() {
 	pkt.protocolVersion = g_network->protocolVersion();
 	pkt.protocolVersion.addObjectSerializerFlag();
 	pkt.connectionId = transport->transportId;
+	if (packetCompressionSupported()) {
+		pkt.flags |= ConnectPacket::FLAG_ACCEPTS_COMPRESSION;
+	}
 
 	PacketBuffer *pb_first = PacketBuffer::create(), *pb_end = nullptr;
 	PacketWriter wr(pb_first, nullptr, Unversioned());
@@ -1029,6 +1167,8 @@ ACTOR static void deliver(TransportData* self,
                           bool isTrustedPeer,
                           InReadSocket inReadSocket,
                           Future<Void> disconnect) {
+	state double received = now();
+
 	// We want to run the task at the right priority. If the priority is higher than the current priority (which is
 	// ReadSocket) we can just upgrade. Otherwise we'll context switch so that we don't block other tasks that might run
 	// with a higher priority. ReplyPromiseStream needs to guarantee that messages are received in the order they were
@@ -1045,6 +1185,11 @@ ACTOR static void deliver(TransportData* self,
 		if (!checkCompatible(receiver->peerCompatibilityPolicy(), reader.protocolVersion())) {
 			return;
 		}
+		if (FLOW_KNOBS->RPC_LATENCY_SAMPLE_INTERVAL > 0 &&
+		    ++self->rpcLatencyMessages % FLOW_KNOBS->RPC_LATENCY_SAMPLE_INTERVAL == 0) {
+			g_currentDeliverySampledReceiver = &typeid(*receiver);
+			self->getRpcLatencyStats(*g_currentDeliverySampledReceiver)->queueLatencies.addSample(now() - received);
+		}
 		try {
 			ASSERT(g_currentDeliveryPeerAddress == NetworkAddressList());
 			ASSERT(!g_currentDeliverPeerAddressTrusted);
@@ -1058,10 +1203,12 @@ ACTOR static void deliver(TransportData* self,
 			g_currentDeliveryPeerAddress = NetworkAddressList();
 			g_currentDeliverPeerAddressTrusted = false;
 			g_currentDeliveryPeerDisconnect = Future<Void>();
+			g_currentDeliverySampledReceiver = nullptr;
 		} catch (Error& e) {
 			g_currentDeliveryPeerAddress = NetworkAddressList();
 			g_currentDeliverPeerAddressTrusted = false;
 			g_currentDeliveryPeerDisconnect = Future<Void>();
+			g_currentDeliverySampledReceiver = nullptr;
 			TraceEvent(SevError, "ReceiverError")
 			    .error(e)
 			    .detail("Token", destination.token.toString())
@@ -1128,6 +1275,8 @@ static void scanPackets(TransportData* transport,
 			break;
 		packetLen = *(uint32_t*)p;
 		p += PACKET_LEN_WIDTH;
+		const bool compressed = packetLen & PACKET_COMPRESSED_FLAG;
+		packetLen &= ~PACKET_COMPRESSED_FLAG;
 
 		// Read checksum if present
 		if (checksumEnabled) {
@@ -1215,6 +1364,16 @@ static void scanPackets(TransportData* transport,
 		ArenaReader reader(arena, StringRef(p, packetLen), AssumeVersion(peerProtocolVersion));
 		UID token;
 		reader >> token;
+		if (compressed) {
+			StringRef message = CompressionUtils::decompress(CompressionFilter::ZSTD, reader.arenaReadAll(), arena);
+			if (message.size() > FLOW_KNOBS->PACKET_LIMIT) {
+				TraceEvent(SevError, "PacketLimitExceeded")
+				    .detail("FromPeer", peerAddress.toString())
+				    .detail("Length", message.size());
+				throw platform_error();
+			}
+			reader = ArenaReader(arena, message, AssumeVersion(peerProtocolVersion));
+		}
 
 		++transport->countPacketsReceived;
 
@@ -1260,7 +1419,7 @@ static int getNewBufferSize(const uint8_t* begin,
 	if (len < PACKET_LEN_WIDTH) {
 		return FLOW_KNOBS->MIN_PACKET_BUFFER_BYTES;
 	}
-	const uint32_t packetLen = *(uint32_t*)begin;
+	const uint32_t packetLen = *(uint32_t*)begin & ~PACKET_COMPRESSED_FLAG;
 	if (packetLen > FLOW_KNOBS->PACKET_LIMIT) {
 		TraceEvent(SevError, "PacketLimitExceeded")
 		    .detail("FromPeer", peerAddress.toString())
@@ -1285,6 +1444,7 @@ ACTOR static Future<Void> connectionReader(TransportData* transport,
 	state bool expectConnectPacket = true;
 	state bool compatible = false;
 	state bool incompatiblePeerCounted = false;
+	state bool peerAcceptsCompression = false;
 	state NetworkAddress peerAddress;
 	state ProtocolVersion peerProtocolVersion;
 	state bool trusted = transport->allowList(conn->getPeerAddress().ip) && conn->hasTrustedPeer();
@@ -1341,6 +1501,7 @@ ACTOR static Future<Void> connectionReader(TransportData* transport,
 						BinaryReader pktReader(unprocessed_begin, connectPacketSize, AssumeVersion(protocolVersion));
 						ConnectPacket pkt;
 						serializer(pktReader, pkt);
+						peerAcceptsCompression = pkt.acceptsCompression();
 
 						uint64_t connectionId = pkt.connectionId;
 						if (!pkt.protocolVersion.hasObjectSerializerFlag() ||
@@ -1429,6 +1590,7 @@ ACTOR static Future<Void> connectionReader(TransportData* transport,
 							wait(delay(0)); // Check for cancellation
 						}
 						peer->protocolVersion->set(peerProtocolVersion);
+						peer->acceptsCompression = peerAcceptsCompression;
 					}
 				}
 
@@ -1775,6 +1937,30 @@ static void sendLocal(TransportData* self, ISerializeSource const& what, const E
 	}
 }
 
+// Compresses the message serialized last into wr in place, if it is at least FLOW_KNOBS->PACKET_COMPRESSION_THRESHOLD
+// bytes and compression makes it smaller. The object serializer writes a message contiguously into one packet buffer,
+// so the message is the last messageSize bytes of wr's current buffer. Returns whether the message was compressed.
+static bool compressMessage(Peer* peer, PacketWriter& wr, int messageSize) {
+	if (!packetCompressionSupported() || messageSize < FLOW_KNOBS->PACKET_COMPRESSION_THRESHOLD) {
+		return false;
+	}
+	uint8_t* message = wr.buffer->data() + wr.buffer->bytes_written - messageSize;
+	const double start = timer_monotonic();
+	Arena arena;
+	StringRef compressed = CompressionUtils::compress(
+	    CompressionFilter::ZSTD, StringRef(message, messageSize), FLOW_KNOBS->PACKET_COMPRESSION_LEVEL, arena);
+	peer->compressionTime += timer_monotonic() - start;
+	peer->compressionInputBytes += messageSize;
+	if (compressed.size() >= messageSize) {
+		peer->compressionOutputBytes += messageSize;
+		return false;
+	}
+	peer->compressionOutputBytes += compressed.size();
+	memcpy(message, compressed.begin(), compressed.size());
+	wr.buffer->bytes_written -= messageSize - compressed.size();
+	return true;
+}
+
 static ReliablePacket* sendPacket(TransportData* self,
                                   Reference<Peer> peer,
                                   ISerializeSource const& what,
@@ -1820,7 +2006,16 @@ static ReliablePacket* sendPacket(TransportData* self,
 
 	wr.writeAhead(packetInfoSize, &packetInfoBuffer);
 	wr << destination.token;
+	PacketBuffer* messagePb = wr.buffer;
+	const int messageBegin = messagePb->bytes_written;
 	what.serializePacketWriter(wr);
+	// Reliable packets aren't compressed, since they may be resent on a later connection, to a peer that doesn't accept
+	// compressed packets
+	const bool compressed =
+	    !reliable && peer->acceptsCompression && FLOW_KNOBS->PACKET_COMPRESSION_THRESHOLD > 0 &&
+	    compressMessage(peer.getPtr(),
+	                    wr,
+	                    wr.buffer == messagePb ? wr.buffer->bytes_written - messageBegin : wr.buffer->bytes_written);
 	pb = wr.finish();
 	len = wr.size() - packetInfoSize;
 
@@ -1872,7 +2067,8 @@ static ReliablePacket* sendPacket(TransportData* self,
 	}
 
 	// Write packet length and checksum into packet buffer
-	packetInfoBuffer.write(&len, sizeof(len));
+	const uint32_t lenAndFlags = compressed ? len | PACKET_COMPRESSED_FLAG : len;
+	packetInfoBuffer.write(&lenAndFlags, sizeof(lenAndFlags));
 	if (checksumEnabled) {
 		packetInfoBuffer.write(&checksum, sizeof(checksum), sizeof(len));
 	}
@@ -2006,6 +2202,14 @@ bool FlowTransport::currentDeliveryPeerIsTrusted() const {
 	return g_currentDeliverPeerAddressTrusted;
 }
 
+const std::type_info* FlowTransport::currentDeliverySampledReceiver() const {
+	return g_currentDeliverySampledReceiver;
+}
+
+void FlowTransport::addRpcServiceLatency(const std::type_info& receiverType, double latency) {
+	self->getRpcLatencyStats(receiverType)->serviceLatencies.addSample(latency);
+}
+
 void FlowTransport::addPublicKey(StringRef name, PublicKey key) {
 	self->publicKeys[name] = key;
 }
@@ -21,6 +21,9 @@
 #include "fdbrpc/QueueModel.h"
 #include "fdbrpc/LoadBalance.h"
 
+// The relative step by which QueueData::latencyQuantile moves toward each latency
+static constexpr double latencyQuantileStep = 0.05;
+
 void QueueModel::endRequest(uint64_t id, double latency, double penalty, double delta, bool clean, bool futureVersion) {
 	auto& d = data[id];
 
@@ -29,6 +32,13 @@ void QueueModel::endRequest(uint64_t id, double latency, double penalty, double
 
 	if (clean) {
 		d.latency = latency;
+		// Moving up by a fraction p of a step on latencies above the estimate, and down by 1 - p of a step otherwise,
+		// settles where a fraction 1 - p of latencies are above it
+		const double p = FLOW_KNOBS->LOAD_BALANCE_HEDGE_PERCENTILE;
+		if (p > 0) {
+			d.latencyQuantile *=
+			    latency > d.latencyQuantile ? 1 + latencyQuantileStep * p : 1 - latencyQuantileStep * (1 - p);
+		}
 	} else {
 		d.latency = std::max(d.latency, latency);
 	}
@@ -54,6 +64,12 @@ QueueData const& QueueModel::getMeasurement(uint64_t id) {
 	return data[id]; // return smoothed penalty
 }
 
+void QueueModel::updateVersionLag(uint64_t id, int64_t versionLag) {
+	auto& d = data[id];
+	d.versionLag = versionLag;
+	d.versionLagTime = now();
+}
+
 double QueueModel::addRequest(uint64_t id) {
 	auto& d = data[id];
 	d.smoothOutstanding.addDelta(d.penalty);
@@ -106,6 +106,10 @@ void CounterCollection::logToTraceEvent(TraceEvent& te) {
 				}
 				metrics->sumMap[c->id].points.back().addAttribute("ip", ip_str);
 				metrics->sumMap[c->id].points.back().addAttribute("port", port_str);
+				metrics->sumMap[c->id].points.back().addAttribute("role", name);
+				if (!id.empty()) {
+					metrics->sumMap[c->id].points.back().addAttribute("id", id);
+				}
 				metrics->sumMap[c->id].points.back().startTime = logTime;
 			}
 			case MetricsDataModel::STATSD: {
@@ -282,13 +286,15 @@ void LatencySample::logSample() {
 				}
 				metrics->histMap[IMetric::id].points.back().addAttribute("ip", ip_str);
 				metrics->histMap[IMetric::id].points.back().addAttribute("port", port_str);
+				metrics->histMap[IMetric::id].points.back().addAttribute("id", id.toString());
 				metrics->histMap[IMetric::id].points.back().startTime = sampleEmit;
 			}
-			createOtelGauge(p50id, name + "p50", p50);
-			createOtelGauge(p90id, name + "p90", p90);
-			createOtelGauge(p95id, name + "p95", p95);
-			createOtelGauge(p99id, name + "p99", p99);
-			createOtelGauge(p999id, name + "p99_9", p99_9);
+			const std::vector<OTEL::Attribute> idAttribute{ OTEL::Attribute("id", id.toString()) };
+			createOtelGauge(p50id, name + "p50", p50, idAttribute);
+			createOtelGauge(p90id, name + "p90", p90, idAttribute);
+			createOtelGauge(p95id, name + "p95", p95, idAttribute);
+			createOtelGauge(p99id, name + "p99", p99, idAttribute);
+			createOtelGauge(p999id, name + "p99_9", p99_9, idAttribute);
 		}
 		case MetricsDataModel::STATSD: {
 			std::vector<std::pair<std::string, std::string>> statsd_attributes{ { "ip", ip_str },
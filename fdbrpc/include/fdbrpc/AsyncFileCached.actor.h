@@ -44,27 +44,33 @@ struct EvictablePage {
 	int index;
 	class Reference<struct EvictablePageCache> pageCache;
 	bi::list_member_hook<> member_hook;
+	bool protectedPage; // With SLRU eviction, whether the page is in protectedPages rather than lruPages
 
 	virtual bool evict() = 0; // true if page was evicted, false if it isn't immediately evictable (but will be evicted
 	                          // regardless if possible)
 
-	EvictablePage(Reference<EvictablePageCache> pageCache) : data(0), index(-1), pageCache(pageCache) {}
+	EvictablePage(Reference<EvictablePageCache> pageCache)
+	  : data(0), index(-1), pageCache(pageCache), protectedPage(false) {}
 	virtual ~EvictablePage();
 };
 
 struct EvictablePageCache : ReferenceCounted<EvictablePageCache> {
 	using List =
 	    bi::list<EvictablePage, bi::member_hook<EvictablePage, bi::list_member_hook<>, &EvictablePage::member_hook>>;
-	enum CacheEvictionType { RANDOM = 0, LRU = 1 };
+	// SLRU is a segmented LRU: new pages are put on a probationary LRU list and move to a protected LRU list when they
+	// are hit, so that a scan of pages read once only evicts other pages read once
+	enum CacheEvictionType { RANDOM = 0, LRU = 1, SLRU = 2 };
 
 	static CacheEvictionType evictionPolicyStringToEnum(const std::string& policy) {
 		std::string cep = policy;
 		std::transform(cep.begin(), cep.end(), cep.begin(), ::tolower);
-		if (cep != "random" && cep != "lru")
+		if (cep != "random" && cep != "lru" && cep != "slru")
 			throw invalid_cache_eviction_policy();
 
 		if (cep == "random")
 			return RANDOM;
+		if (cep == "slru")
+			return SLRU;
 		return LRU;
 	}
 
@@ -91,10 +97,22 @@ struct EvictablePageCache : ReferenceCounted<EvictablePageCache> {
 	}
 
 	void updateHit(EvictablePage* page) {
-		if (RANDOM != cacheEvictionType) {
+		if (LRU == cacheEvictionType) {
 			// on a hit, update page's location in the LRU so that it's most recent (tail)
 			lruPages.erase(List::s_iterator_to(*page));
 			lruPages.push_back(*page);
+		} else if (SLRU == cacheEvictionType) {
+			// on a hit, the page becomes the most recent protected page, and if that makes too many protected pages,
+			// the least recent one goes back to being the most recent probationary page
+			(page->protectedPage ? protectedPages : lruPages).erase(List::s_iterator_to(*page));
+			page->protectedPage = true;
+			protectedPages.push_back(*page);
+			if (protectedPages.size() > maxPages * FLOW_KNOBS->PAGE_CACHE_PROTECTED_FRACTION) {
+				EvictablePage& demoted = protectedPages.front();
+				protectedPages.pop_front();
+				demoted.protectedPage = false;
+				lruPages.push_back(demoted);
+			}
 		}
 	}
 
@@ -110,16 +128,16 @@ struct EvictablePageCache : ReferenceCounted<EvictablePageCache> {
 					}
 				}
 			}
-		} else {
-			// For now, LRU is the only other CACHE_EVICTION option
-			if (lruPages.size() >= (uint64_t)maxPages) {
-				int i = 0;
-				// try the least recently used pages first (starting at head of the LRU list)
-				for (List::iterator it = lruPages.begin(); it != lruPages.end() && i < FLOW_KNOBS->MAX_EVICT_ATTEMPTS;
+		} else if (lruPages.size() + protectedPages.size() >= (uint64_t)maxPages) {
+			// try the least recently used pages first (starting at head of the LRU list), and with SLRU, probationary
+			// pages before protected ones
+			int i = 0;
+			for (List* list : { &lruPages, &protectedPages }) {
+				for (List::iterator it = list->begin(); it != list->end() && i < FLOW_KNOBS->MAX_EVICT_ATTEMPTS;
 				     ++it, ++i) { // If we don't manage to evict anything, just go ahead and exceed the cache limit
 					if (it->evict()) {
 						++cacheEvictions;
-						break;
+						return;
 					}
 				}
 			}
@@ -127,7 +145,8 @@ struct EvictablePageCache : ReferenceCounted<EvictablePageCache> {
 	}
 
 	std::vector<EvictablePage*> pages;
-	List lruPages;
+	List lruPages; // With SLRU eviction, the probationary pages
+	List protectedPages;
 	int pageSize;
 	int64_t maxPages;
 	Int64MetricHandle cacheEvictions;
@@ -267,6 +286,7 @@ private:
 	Reference<IAsyncFile> uncached;
 	int64_t length;
 	int64_t prevLength;
+	int64_t prevReadEnd; // The offset just past the last read, to detect sequential reads for prefetching
 	std::unordered_map<int64_t, AFCPage*> pages;
 	std::vector<AFCPage*> flushable;
 	Reference<EvictablePageCache> pageCache;
@@ -287,6 +307,7 @@ private:
 	Int64MetricHandle countFileCachePageReadsMissed;
 	Int64MetricHandle countFileCachePageReadsMerged;
 	Int64MetricHandle countFileCacheReadBytes;
+	Int64MetricHandle countFileCachePagePrefetches;
 
 	Int64MetricHandle countCacheFinds;
 	Int64MetricHandle countCacheReads;
@@ -297,13 +318,14 @@ private:
 	Int64MetricHandle countCachePageReadsMissed;
 	Int64MetricHandle countCachePageReadsMerged;
 	Int64MetricHandle countCacheReadBytes;
+	Int64MetricHandle countCachePagePrefetches;
 
 	AsyncFileCached(Reference<IAsyncFile> uncached,
 	                const std::string& filename,
 	                int64_t length,
 	                Reference<EvictablePageCache> pageCache)
-	  : filename(filename), uncached(uncached), length(length), prevLength(length), pageCache(pageCache),
-	    currentTruncate(Void()), currentTruncateSize(0), rateControl(nullptr) {
+	  : filename(filename), uncached(uncached), length(length), prevLength(length), prevReadEnd(-1),
+	    pageCache(pageCache), currentTruncate(Void()), currentTruncateSize(0), rateControl(nullptr) {
 		if (!g_network->isSimulated()) {
 			countFileCacheWrites.init("AsyncFile.CountFileCacheWrites"_sr, filename);
 			countFileCacheReads.init("AsyncFile.CountFileCacheReads"_sr, filename);
@@ -314,6 +336,7 @@ private:
 			countFileCachePageReadsMerged.init("AsyncFile.CountFileCachePageReadsMerged"_sr, filename);
 			countFileCacheFinds.init("AsyncFile.CountFileCacheFinds"_sr, filename);
 			countFileCacheReadBytes.init("AsyncFile.CountFileCacheReadBytes"_sr, filename);
+			countFileCachePagePrefetches.init("AsyncFile.CountFileCachePagePrefetches"_sr, filename);
 
 			countCacheWrites.init("AsyncFile.CountCacheWrites"_sr);
 			countCacheReads.init("AsyncFile.CountCacheReads"_sr);
@@ -324,6 +347,7 @@ private:
 			countCachePageReadsMerged.init("AsyncFile.CountCachePageReadsMerged"_sr);
 			countCacheFinds.init("AsyncFile.CountCacheFinds"_sr);
 			countCacheReadBytes.init("AsyncFile.CountCacheReadBytes"_sr);
+			countCachePagePrefetches.init("AsyncFile.CountCachePagePrefetches"_sr);
 		}
 	}
 
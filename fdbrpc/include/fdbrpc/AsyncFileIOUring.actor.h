@@ -0,0 +1,787 @@
+/*
+ * AsyncFileIOUring.actor.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ASYNC_FILE_IO_URING_SUPPORTED 1
+
+// When actually compiled (NO_INTELLISENSE), include the generated version of this file.  In intellisense use the source
+// version.
+#if defined(NO_INTELLISENSE) && !defined(FLOW_ASYNCFILEIOURING_ACTOR_G_H)
+#define FLOW_ASYNCFILEIOURING_ACTOR_G_H
+#include "fdbrpc/AsyncFileIOUring.actor.g.h"
+#elif !defined(FLOW_ASYNCFILEIOURING_ACTOR_H)
+#define FLOW_ASYNCFILEIOURING_ACTOR_H
+
+#include "flow/IAsyncFile.h"
+
+#include <deque>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "flow/Knobs.h"
+#include "fdbrpc/AsyncFileEIO.actor.h"
+#include "fdbrpc/AsyncFileKAIO.actor.h"
+#include "fdbrpc/Stats.h"
+#include "flow/UnitTest.h"
+#include "flow/genericactors.actor.h"
+#include "flow/actorcompiler.h" // This must be the last #include.
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+
+// An IAsyncFile for unbuffered (O_DIRECT) files that submits reads, writes and fdatasyncs through a single io_uring
+// shared by all files in the process. It is a drop in replacement for AsyncFileKAIO, selected by the USE_IO_URING
+// knob, with two differences:
+//  - sync() is an IORING_OP_FSYNC submitted on the ring rather than an fdatasync on an EIO thread. When a sync is
+//    queued directly behind a write to the same file, the two are linked (IOSQE_IO_LINK) so that the kernel only
+//    starts the fdatasync once the write has completed.
+//  - Submission and completion reaping both happen in the Net2 run cycle function, so a completion that arrives while
+//    the network thread is busy is collected on the next loop iteration without a trip through the eventfd reactor.
+class AsyncFileIOUring final : public IAsyncFile, public ReferenceCounted<AsyncFileIOUring> {
+public:
+	virtual StringRef getClassName() override { return "AsyncFileIOUring"_sr; }
+
+	struct AsyncFileIOUringMetrics {
+		LatencySample readLatencySample = { "AsyncFileIOUringReadLatency",
+			                                UID(),
+			                                FLOW_KNOBS->KAIO_LATENCY_LOGGING_INTERVAL,
+			                                FLOW_KNOBS->KAIO_LATENCY_SKETCH_ACCURACY };
+		LatencySample writeLatencySample = { "AsyncFileIOUringWriteLatency",
+			                                 UID(),
+			                                 FLOW_KNOBS->KAIO_LATENCY_LOGGING_INTERVAL,
+			                                 FLOW_KNOBS->KAIO_LATENCY_SKETCH_ACCURACY };
+		LatencySample syncLatencySample = { "AsyncFileIOUringSyncLatency",
+			                                UID(),
+			                                FLOW_KNOBS->KAIO_LATENCY_LOGGING_INTERVAL,
+			                                FLOW_KNOBS->KAIO_LATENCY_SKETCH_ACCURACY };
+	};
+
+	static AsyncFileIOUringMetrics& getMetrics() {
+		static AsyncFileIOUringMetrics metrics;
+		return metrics;
+	}
+
+	static Future<Reference<IAsyncFile>> open(std::string filename, int flags, int mode, void* ignore) {
+		ASSERT(ctx.enabled);
+		ASSERT(flags & OPEN_UNBUFFERED);
+
+		if (flags & OPEN_LOCK)
+			mode |= 02000; // Enable mandatory locking for this file if it is supported by the filesystem
+
+		std::string open_filename = filename;
+		if (flags & OPEN_ATOMIC_WRITE_AND_CREATE) {
+			ASSERT((flags & OPEN_CREATE) && (flags & OPEN_READWRITE) && !(flags & OPEN_EXCLUSIVE));
+			open_filename = filename + ".part";
+		}
+
+		int fd = ::open(open_filename.c_str(), openFlags(flags), mode);
+		if (fd < 0) {
+			Error e = errno == ENOENT ? file_not_found() : io_error();
+			TraceEvent("AsyncFileIOUringOpenFailed")
+			    .error(e)
+			    .detail("Filename", filename)
+			    .detailf("Flags", "%x", flags)
+			    .detailf("OSFlags", "%x", openFlags(flags))
+			    .detailf("Mode", "0%o", mode)
+			    .GetLastError();
+			return e;
+		} else {
+			TraceEvent("AsyncFileIOUringOpen")
+			    .detail("Filename", filename)
+			    .detail("Flags", flags)
+			    .detail("Mode", mode)
+			    .detail("Fd", fd);
+		}
+
+		Reference<AsyncFileIOUring> r(new AsyncFileIOUring(fd, flags, filename));
+
+		if (flags & OPEN_LOCK) {
+			// Acquire a "write" lock for the entire file
+			flock lockDesc;
+			lockDesc.l_type = F_WRLCK;
+			lockDesc.l_whence = SEEK_SET;
+			lockDesc.l_start = 0;
+			lockDesc.l_len = 0;
+			lockDesc.l_pid = 0;
+			if (fcntl(fd, F_SETLK, &lockDesc) == -1) {
+				TraceEvent(SevWarn, "UnableToLockFile").detail("Filename", filename).GetLastError();
+				return lock_file_failure();
+			}
+		}
+
+		struct stat buf;
+		if (fstat(fd, &buf)) {
+			TraceEvent("AsyncFileIOUringFStatError").detail("Fd", fd).detail("Filename", filename).GetLastError();
+			return io_error();
+		}
+
+		r->lastFileSize = r->nextFileSize = buf.st_size;
+		return Reference<IAsyncFile>(std::move(r));
+	}
+
+	// Sets up the process wide ring. Returns false, leaving the caller to fall back to AsyncFileKAIO, if the kernel
+	// does not support io_uring or it is disallowed (e.g. by a seccomp policy).
+	static bool init(Reference<IEventFD> ev, double ioTimeout) {
+		ASSERT(!ctx.enabled);
+		if (!ctx.ring.setup(FLOW_KNOBS->IO_URING_QUEUE_DEPTH)) {
+			TraceEvent(SevWarnAlways, "AsyncFileIOUringSetupError")
+			    .detail("QueueDepth", FLOW_KNOBS->IO_URING_QUEUE_DEPTH)
+			    .GetLastError();
+			return false;
+		}
+		int evfd = ev->getFD();
+		if (syscall(__NR_io_uring_register, ctx.ring.fd, IORING_REGISTER_EVENTFD, &evfd, 1) < 0) {
+			TraceEvent(SevWarnAlways, "AsyncFileIOUringRegisterEventFDError").GetLastError();
+			ctx.ring.teardown();
+			return false;
+		}
+
+		if (!g_network->isSimulated()) {
+			ctx.countSubmit.init("AsyncFile.CountIOUringSubmit"_sr);
+			ctx.countCollect.init("AsyncFile.CountIOUringCollect"_sr);
+			ctx.countLinkedSync.init("AsyncFile.CountIOUringLinkedSync"_sr);
+			ctx.countPreSubmitTruncate.init("AsyncFile.CountPreIOUringSubmitTruncate"_sr);
+			ctx.preSubmitTruncateBytes.init("AsyncFile.PreIOUringSubmitTruncateBytes"_sr);
+		}
+
+		TraceEvent("AsyncFileIOUringInit")
+		    .detail("SubmissionEntries", ctx.ring.sqEntries)
+		    .detail("CompletionEntries", ctx.ring.cqEntries);
+
+		ctx.enabled = true;
+		setTimeout(ioTimeout);
+		poll(ev);
+
+		g_network->setGlobal(INetwork::enRunCycleFunc, (flowGlobalType)&AsyncFileIOUring::launch);
+		return true;
+	}
+
+	static bool enabled() { return ctx.enabled; }
+	static void setTimeout(double ioTimeout) { ctx.setIOTimeout(ioTimeout); }
+
+	void addref() override { ReferenceCounted<AsyncFileIOUring>::addref(); }
+	void delref() override { ReferenceCounted<AsyncFileIOUring>::delref(); }
+
+	Future<int> read(void* data, int length, int64_t offset) override {
+		++countFileLogicalReads;
+		++countLogicalReads;
+
+		if (failed) {
+			return io_timeout();
+		}
+
+		IOBlock* io = new IOBlock(IORING_OP_READ, fd);
+		io->buf = data;
+		io->nbytes = length;
+		io->offset = offset;
+
+		enqueue(io);
+		return io->result.getFuture();
+	}
+
+	Future<Void> write(void const* data, int length, int64_t offset) override {
+		++countFileLogicalWrites;
+		++countLogicalWrites;
+
+		if (failed) {
+			return io_timeout();
+		}
+
+		IOBlock* io = new IOBlock(IORING_OP_WRITE, fd);
+		io->buf = (void*)data;
+		io->nbytes = length;
+		io->offset = offset;
+
+		nextFileSize = std::max(nextFileSize, offset + length);
+
+		enqueue(io);
+		return success(io->result.getFuture());
+	}
+
+	Future<Void> zeroRange(int64_t offset, int64_t length) override {
+		bool success = false;
+		if (ctx.fallocateZeroSupported) {
+			int rc = fallocate(fd, FALLOC_FL_ZERO_RANGE, offset, length);
+			if (rc == EOPNOTSUPP) {
+				ctx.fallocateZeroSupported = false;
+			}
+			if (rc == 0) {
+				success = true;
+			}
+		}
+		return success ? Void() : IAsyncFile::zeroRange(offset, length);
+	}
+
+	Future<Void> truncate(int64_t size) override {
+		++countFileLogicalWrites;
+		++countLogicalWrites;
+
+		if (failed) {
+			return io_timeout();
+		}
+
+		int result = -1;
+		bool completed = false;
+		double begin = timer_monotonic();
+
+		if (ctx.fallocateSupported && size >= lastFileSize) {
+			result = fallocate(fd, 0, 0, size);
+			if (result != 0) {
+				int fallocateErrCode = errno;
+				TraceEvent("AsyncFileIOUringAllocateError")
+				    .detail("Fd", fd)
+				    .detail("Filename", filename)
+				    .detail("Size", size)
+				    .GetLastError();
+				if (fallocateErrCode == EOPNOTSUPP) {
+					// Mark fallocate as unsupported. Try again with truncate.
+					ctx.fallocateSupported = false;
+				} else {
+					return io_error();
+				}
+			} else {
+				completed = true;
+			}
+		}
+		if (!completed)
+			result = ftruncate(fd, size);
+
+		double end = timer_monotonic();
+		if (nondeterministicRandom()->random01() < end - begin) {
+			TraceEvent("SlowIOUringTruncate")
+			    .detail("TruncateTime", end - begin)
+			    .detail("TruncateBytes", size - lastFileSize);
+		}
+
+		if (result != 0) {
+			TraceEvent("AsyncFileIOUringTruncateError").detail("Fd", fd).detail("Filename", filename).GetLastError();
+			return io_error();
+		}
+
+		lastFileSize = nextFileSize = size;
+
+		return Void();
+	}
+
+	Future<Void> sync() override {
+		++countFileLogicalWrites;
+		++countLogicalWrites;
+
+		if (failed) {
+			return io_timeout();
+		}
+
+		double start_time = timer();
+		IOBlock* io = new IOBlock(IORING_OP_FSYNC, fd);
+		enqueue(io);
+
+		Future<Void> fsync = map(io->result.getFuture(), [start_time](int r) {
+			getMetrics().syncLatencySample.addMeasurement(timer() - start_time);
+			return Void();
+		});
+
+		if (flags & OPEN_ATOMIC_WRITE_AND_CREATE) {
+			flags &= ~OPEN_ATOMIC_WRITE_AND_CREATE;
+
+			return AsyncFileEIO::waitAndAtomicRename(fsync, filename + ".part", filename);
+		}
+
+		return fsync;
+	}
+
+	Future<int64_t> size() const override { return nextFileSize; }
+	int64_t debugFD() const override { return fd; }
+	std::string getFilename() const override { return filename; }
+	~AsyncFileIOUring() override { close(fd); }
+
+	// Run once per Net2 loop iteration: collects any completions the kernel has posted and then submits queued
+	// requests, all with a single io_uring_enter.
+	static void launch() {
+		reap();
+
+		// Entries left behind by a failed io_uring_enter are still in the submission ring and are retried here
+		unsigned tail = *ctx.ring.sqTail;
+		unsigned unconsumed = tail - __atomic_load_n(ctx.ring.sqHead, __ATOMIC_ACQUIRE);
+		// outstanding counts those entries too, and is kept within the submission ring size so the completion ring
+		// (twice as large) can never overflow
+		int n = std::min<size_t>(ctx.queue.size(), ctx.ring.sqEntries - ctx.outstanding);
+		if (!n && !unconsumed) {
+			return;
+		}
+
+		double begin = timer_monotonic();
+		if (!ctx.outstanding)
+			ctx.ioStallBegin = begin;
+
+		double start = timer();
+		IOBlock* previous = nullptr;
+		io_uring_sqe* previousSqe = nullptr;
+		for (int i = 0; i < n; i++) {
+			IOBlock* io = ctx.queue.front();
+			ctx.queue.pop_front();
+			io->startTime = start;
+
+			if (ctx.ioTimeout > 0) {
+				ctx.appendToRequestList(io);
+			}
+
+			if (io->opcode == IORING_OP_WRITE && io->owner->lastFileSize != io->owner->nextFileSize) {
+				++ctx.countPreSubmitTruncate;
+				int64_t truncateSize = io->owner->nextFileSize - io->owner->lastFileSize;
+				ASSERT(truncateSize > 0);
+				ctx.preSubmitTruncateBytes += truncateSize;
+				io->owner->truncate(io->owner->nextFileSize);
+			}
+
+			unsigned index = tail & *ctx.ring.sqMask;
+			io_uring_sqe* sqe = &ctx.ring.sqes[index];
+			io->prepare(sqe);
+			if (io->opcode == IORING_OP_FSYNC && previous && previous->opcode == IORING_OP_WRITE &&
+			    previous->fd == io->fd) {
+				previousSqe->flags |= IOSQE_IO_LINK;
+				++ctx.countLinkedSync;
+			}
+			ctx.ring.sqArray[index] = index;
+			++tail;
+			previous = io;
+			previousSqe = sqe;
+		}
+		__atomic_store_n(ctx.ring.sqTail, tail, __ATOMIC_RELEASE);
+		ctx.outstanding += n;
+
+		int rc;
+		loop {
+			rc = syscall(__NR_io_uring_enter, ctx.ring.fd, unconsumed + n, 0, 0, nullptr, 0);
+			if (rc >= 0 || errno != EINTR)
+				break;
+		}
+		++ctx.countSubmit;
+
+		if (rc < 0 && errno != EAGAIN && errno != EBUSY) {
+			TraceEvent(SevError, "AsyncFileIOUringSubmitError").suppressFor(1.0).GetLastError();
+		}
+
+		double elapsed = timer_monotonic() - begin;
+		g_network->networkInfo.metrics.secSquaredSubmit += elapsed * elapsed / 2;
+	}
+
+	bool failed;
+
+private:
+	int fd, flags;
+	int64_t lastFileSize, nextFileSize;
+	std::string filename;
+	Int64MetricHandle countFileLogicalWrites;
+	Int64MetricHandle countFileLogicalReads;
+
+	Int64MetricHandle countLogicalWrites;
+	Int64MetricHandle countLogicalReads;
+
+	struct IOBlock : FastAllocated<IOBlock> {
+		uint8_t opcode;
+		int fd;
+		void* buf;
+		uint32_t nbytes;
+		int64_t offset;
+		Promise<int> result;
+		Reference<AsyncFileIOUring> owner;
+		TaskPriority task;
+		IOBlock* prev;
+		IOBlock* next;
+		double startTime;
+
+		IOBlock(uint8_t opcode, int fd)
+		  : opcode(opcode), fd(fd), buf(nullptr), nbytes(0), offset(0), task(TaskPriority::DefaultYield),
+		    prev(nullptr), next(nullptr), startTime(0) {}
+
+		void prepare(io_uring_sqe* sqe) {
+			memset(sqe, 0, sizeof(io_uring_sqe));
+			sqe->opcode = opcode;
+			sqe->fd = fd;
+			sqe->user_data = (uint64_t)this;
+			if (opcode == IORING_OP_FSYNC) {
+				sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+			} else {
+				sqe->addr = (uint64_t)buf;
+				sqe->len = nbytes;
+				sqe->off = offset;
+			}
+		}
+
+		ACTOR static void deliver(Promise<int> result, bool failed, int r, TaskPriority task) {
+			wait(delay(0, task));
+			if (failed)
+				result.sendError(io_timeout());
+			else if (r < 0)
+				result.sendError(io_error());
+			else
+				result.send(r);
+		}
+
+		void setResult(int r) {
+			if (r < 0) {
+				errno = -r;
+				TraceEvent("AsyncFileIOUringIOError")
+				    .GetLastError()
+				    .detail("Fd", fd)
+				    .detail("Op", opcode)
+				    .detail("Nbytes", nbytes)
+				    .detail("Offset", offset)
+				    .detail("Ptr", int64_t(buf))
+				    .detail("Filename", owner->filename);
+			}
+			deliver(result, owner->failed, r, task);
+			delete this;
+		}
+
+		void timeout(bool warnOnly) {
+			TraceEvent(SevWarnAlways, "AsyncFileIOUringTimeout")
+			    .detail("Fd", fd)
+			    .detail("Op", opcode)
+			    .detail("Nbytes", nbytes)
+			    .detail("Offset", offset)
+			    .detail("Ptr", int64_t(buf))
+			    .detail("Filename", owner->filename);
+			g_network->setGlobal(INetwork::enASIOTimedOut, (flowGlobalType) true);
+
+			if (!warnOnly)
+				owner->failed = true;
+		}
+	};
+
+	// The shared memory submission and completion rings of one io_uring instance
+	struct Ring {
+		int fd = -1;
+		void* sqRing = nullptr;
+		void* cqRing = nullptr;
+		size_t sqRingSize = 0;
+		size_t cqRingSize = 0;
+		size_t sqesSize = 0;
+
+		unsigned* sqHead = nullptr;
+		unsigned* sqTail = nullptr;
+		unsigned* sqMask = nullptr;
+		unsigned* sqArray = nullptr;
+		unsigned sqEntries = 0;
+		io_uring_sqe* sqes = nullptr;
+
+		unsigned* cqHead = nullptr;
+		unsigned* cqTail = nullptr;
+		unsigned* cqMask = nullptr;
+		io_uring_cqe* cqes = nullptr;
+		unsigned cqEntries = 0;
+
+		bool setup(unsigned entries) {
+			io_uring_params p;
+			memset(&p, 0, sizeof(p));
+			fd = syscall(__NR_io_uring_setup, entries, &p);
+			if (fd < 0) {
+				return false;
+			}
+
+			sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+			cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+			bool singleMmap = p.features & IORING_FEAT_SINGLE_MMAP;
+			if (singleMmap) {
+				sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+			}
+
+			sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+			if (sqRing == MAP_FAILED) {
+				sqRing = nullptr;
+				teardown();
+				return false;
+			}
+			if (singleMmap) {
+				cqRing = sqRing;
+			} else {
+				cqRing =
+				    mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+				if (cqRing == MAP_FAILED) {
+					cqRing = nullptr;
+					teardown();
+					return false;
+				}
+			}
+			sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+			void* sqesMem =
+			    mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+			if (sqesMem == MAP_FAILED) {
+				teardown();
+				return false;
+			}
+			sqes = (io_uring_sqe*)sqesMem;
+
+			uint8_t* sq = (uint8_t*)sqRing;
+			sqHead = (unsigned*)(sq + p.sq_off.head);
+			sqTail = (unsigned*)(sq + p.sq_off.tail);
+			sqMask = (unsigned*)(sq + p.sq_off.ring_mask);
+			sqArray = (unsigned*)(sq + p.sq_off.array);
+			sqEntries = p.sq_entries;
+
+			uint8_t* cq = (uint8_t*)cqRing;
+			cqHead = (unsigned*)(cq + p.cq_off.head);
+			cqTail = (unsigned*)(cq + p.cq_off.tail);
+			cqMask = (unsigned*)(cq + p.cq_off.ring_mask);
+			cqes = (io_uring_cqe*)(cq + p.cq_off.cqes);
+			cqEntries = p.cq_entries;
+			return true;
+		}
+
+		void teardown() {
+			if (sqes)
+				munmap(sqes, sqesSize);
+			if (cqRing && cqRing != sqRing)
+				munmap(cqRing, cqRingSize);
+			if (sqRing)
+				munmap(sqRing, sqRingSize);
+			if (fd >= 0)
+				close(fd);
+			*this = Ring();
+		}
+	};
+
+	struct Context {
+		bool enabled;
+		Ring ring;
+		// Submission is in arrival order (unlike AsyncFileKAIO's priority order) so that a sync can be linked to the
+		// write queued immediately before it
+		std::deque<IOBlock*> queue;
+		unsigned outstanding;
+		double ioStallBegin;
+		bool fallocateSupported;
+		bool fallocateZeroSupported;
+		Int64MetricHandle countSubmit;
+		Int64MetricHandle countCollect;
+		Int64MetricHandle countLinkedSync;
+		Int64MetricHandle countPreSubmitTruncate;
+		Int64MetricHandle preSubmitTruncateBytes;
+
+		double ioTimeout;
+		bool timeoutWarnOnly;
+		IOBlock* submittedRequestList;
+
+		Context()
+		  : enabled(false), outstanding(0), ioStallBegin(0), fallocateSupported(true), fallocateZeroSupported(true),
+		    submittedRequestList(nullptr) {
+			setIOTimeout(0);
+		}
+
+		void setIOTimeout(double timeout) {
+			ioTimeout = fabs(timeout);
+			timeoutWarnOnly = timeout < 0;
+		}
+
+		void appendToRequestList(IOBlock* io) {
+			ASSERT(!io->next && !io->prev);
+
+			if (submittedRequestList) {
+				io->prev = submittedRequestList->prev;
+				io->prev->next = io;
+
+				submittedRequestList->prev = io;
+				io->next = submittedRequestList;
+			} else {
+				submittedRequestList = io;
+				io->next = io->prev = io;
+			}
+		}
+
+		void removeFromRequestList(IOBlock* io) {
+			if (io->next == nullptr) {
+				ASSERT(io->prev == nullptr);
+				return;
+			}
+
+			ASSERT(io->prev != nullptr);
+
+			if (io == io->next) {
+				ASSERT(io == submittedRequestList && io == io->prev);
+				submittedRequestList = nullptr;
+			} else {
+				io->next->prev = io->prev;
+				io->prev->next = io->next;
+
+				if (submittedRequestList == io) {
+					submittedRequestList = io->next;
+				}
+			}
+
+			io->next = io->prev = nullptr;
+		}
+	};
+	static Context ctx;
+
+	explicit AsyncFileIOUring(int fd, int flags, std::string const& filename)
+	  : failed(false), fd(fd), flags(flags), filename(filename) {
+		if (!g_network->isSimulated()) {
+			countFileLogicalWrites.init("AsyncFile.CountFileLogicalWrites"_sr, filename);
+			countFileLogicalReads.init("AsyncFile.CountFileLogicalReads"_sr, filename);
+			countLogicalWrites.init("AsyncFile.CountLogicalWrites"_sr);
+			countLogicalReads.init("AsyncFile.CountLogicalReads"_sr);
+		}
+	}
+
+	void enqueue(IOBlock* io) {
+		ASSERT(io->opcode == IORING_OP_FSYNC ||
+		       (int64_t(io->buf) % 4096 == 0 && io->offset % 4096 == 0 && io->nbytes % 4096 == 0));
+
+		io->task = g_network->getCurrentTask();
+		io->owner = Reference<AsyncFileIOUring>::addRef(this);
+
+		ctx.queue.push_back(io);
+	}
+
+	static int openFlags(int flags) {
+		int oflags = O_DIRECT | O_CLOEXEC;
+		ASSERT(bool(flags & OPEN_READONLY) != bool(flags & OPEN_READWRITE)); // readonly xor readwrite
+		if (flags & OPEN_EXCLUSIVE)
+			oflags |= O_EXCL;
+		if (flags & OPEN_CREATE)
+			oflags |= O_CREAT;
+		if (flags & OPEN_READONLY)
+			oflags |= O_RDONLY;
+		if (flags & OPEN_READWRITE)
+			oflags |= O_RDWR;
+		if (flags & OPEN_ATOMIC_WRITE_AND_CREATE)
+			oflags |= O_TRUNC;
+		return oflags;
+	}
+
+	// Consumes every completion currently in the completion ring. Returns the number of completions collected.
+	static int reap() {
+		double currentTime = timer();
+		unsigned head = *ctx.ring.cqHead;
+		unsigned tail = __atomic_load_n(ctx.ring.cqTail, __ATOMIC_ACQUIRE);
+		int n = tail - head;
+
+		if (n) {
+			double t = timer_monotonic();
+			double elapsed = t - ctx.ioStallBegin;
+			ctx.ioStallBegin = t;
+			g_network->networkInfo.metrics.secSquaredDiskStall += elapsed * elapsed / 2;
+			++ctx.countCollect;
+		}
+
+		for (; head != tail; ++head) {
+			io_uring_cqe* cqe = &ctx.ring.cqes[head & *ctx.ring.cqMask];
+			IOBlock* iob = (IOBlock*)cqe->user_data;
+			int result = cqe->res;
+
+			if (ctx.ioTimeout > 0) {
+				ctx.removeFromRequestList(iob);
+			}
+
+			switch (iob->opcode) {
+			case IORING_OP_READ:
+				getMetrics().readLatencySample.addMeasurement(currentTime - iob->startTime);
+				break;
+			case IORING_OP_WRITE:
+				getMetrics().writeLatencySample.addMeasurement(currentTime - iob->startTime);
+				break;
+			}
+
+			iob->setResult(result);
+		}
+		// Release the completion entries to the kernel only after they have been read
+		__atomic_store_n(ctx.ring.cqHead, head, __ATOMIC_RELEASE);
+		ctx.outstanding -= n;
+
+		if (ctx.ioTimeout > 0) {
+			while (ctx.submittedRequestList && currentTime - ctx.submittedRequestList->startTime > ctx.ioTimeout) {
+				ctx.submittedRequestList->timeout(ctx.timeoutWarnOnly);
+				ctx.removeFromRequestList(ctx.submittedRequestList);
+			}
+		}
+
+		return n;
+	}
+
+	// Completions are normally collected by launch(), but the eventfd registered with the ring wakes the network
+	// thread when it would otherwise be sleeping
+	ACTOR static void poll(Reference<IEventFD> ev) {
+		loop {
+			wait(success(ev->read()));
+
+			wait(delay(0, TaskPriority::DiskIOComplete));
+
+			reap();
+		}
+	}
+};
+
+TEST_CASE("/fdbrpc/AsyncFileIOUring/ReadWriteSync") {
+	// This test does nothing in simulation, or when the io_uring backend is not in use
+	if (!g_network->isSimulated() && AsyncFileIOUring::enabled()) {
+		state Reference<IAsyncFile> f;
+		try {
+			Reference<IAsyncFile> f_ = wait(AsyncFileIOUring::open(
+			    "/tmp/__IO_URING_TEST_FILE__",
+			    IAsyncFile::OPEN_UNBUFFERED | IAsyncFile::OPEN_READWRITE | IAsyncFile::OPEN_CREATE,
+			    0666,
+			    nullptr));
+			f = f_;
+			state int fileSize = 2 << 27; // ~100MB
+			wait(f->truncate(fileSize));
+
+			AsyncFileIOUring::setTimeout(0.0);
+			wait(runTestOps(f, 100, fileSize, true));
+			ASSERT(!((AsyncFileIOUring*)f.getPtr())->failed);
+
+			// A write followed immediately by a sync is submitted as a linked pair, and the written data must
+			// read back once the sync is complete
+			state void* buf = FastAllocator<4096>::allocate();
+			state void* readBuf = FastAllocator<4096>::allocate();
+			memset(buf, 0x5a, 4096);
+			memset(readBuf, 0, 4096);
+			wait(f->write(buf, 4096, 4096) && f->sync());
+			int bytesRead = wait(f->read(readBuf, 4096, 4096));
+			ASSERT(bytesRead == 4096 && memcmp(buf, readBuf, 4096) == 0);
+			FastAllocator<4096>::release(buf);
+			FastAllocator<4096>::release(readBuf);
+		} catch (Error& e) {
+			state Error err = e;
+			if (f) {
+				wait(AsyncFileEIO::deleteFile(f->getFilename(), true));
+			}
+			throw err;
+		}
+
+		wait(AsyncFileEIO::deleteFile(f->getFilename(), true));
+	}
+
+	return Void();
+}
+
+AsyncFileIOUring::Context AsyncFileIOUring::ctx;
+
+#include "flow/unactorcompiler.h"
+#endif
+#endif
@@ -24,8 +24,9 @@
 
 #include <algorithm>
 #include <map>
+#include <typeinfo>
 
-#include "fdbrpc/DDSketch.h"
+#include "flow/DDSketch.h"
 #include "fdbrpc/HealthMonitor.h"
 #include "flow/genericactors.actor.h"
 #include "flow/network.h"
@@ -155,6 +156,7 @@ struct Peer : public ReferenceCounted<Peer> {
 	AsyncTrigger resetConnection;
 	bool compatible;
 	bool connected;
+	bool acceptsCompression; // The current connection's peer said it can decompress packets
 	bool outgoingConnectionIdle; // We don't actually have a connection open and aren't trying to open one because we
 	                             // don't have anything to send
 	double lastConnectTime;
@@ -177,6 +179,9 @@ struct Peer : public ReferenceCounted<Peer> {
 	int connectIncomingCount;
 	int connectFailedCount;
 	DDSketch<double> connectLatencies;
+	int64_t compressionInputBytes;
+	int64_t compressionOutputBytes;
+	double compressionTime;
 	Promise<Void> disconnect;
 
 	explicit Peer(TransportData* transport, NetworkAddress const& destination);
@@ -297,6 +302,11 @@ public:
 	bool currentDeliveryPeerIsTrusted() const;
 	NetworkAddress currentDeliveryPeerAddress() const;
 
+	// The type of the receiver of the message being delivered if the message was sampled for its latency, so that the
+	// reply to it can add its service latency with addRpcServiceLatency()
+	const std::type_info* currentDeliverySampledReceiver() const;
+	void addRpcServiceLatency(const std::type_info& receiverType, double latency);
+
 	Optional<PublicKey> getPublicKeyByName(StringRef name) const;
 	// Adds or replaces a public key
 	void addPublicKey(StringRef name, PublicKey key);
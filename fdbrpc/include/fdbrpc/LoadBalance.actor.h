@@ -76,12 +76,26 @@ struct ModelHolder : NonCopyable, public ReferenceCounted<ModelHolder> {
 struct LoadBalancedReply {
 	double penalty;
 	Optional<Error> error;
-	LoadBalancedReply() : penalty(1.0) {}
+	// How many versions the server was behind the version the request had to wait for when the request arrived
+	int64_t versionLag;
+	LoadBalancedReply() : penalty(1.0), versionLag(0) {}
 };
 
 Optional<LoadBalancedReply> getLoadBalancedReply(const LoadBalancedReply* reply);
 Optional<LoadBalancedReply> getLoadBalancedReply(const void*);
 
+// Returns what loadBalance() adds to the outstanding requests of a server when choosing a server: a large amount if a
+// recent reply from the server showed that it was well behind the versions being read, so that reads go to replicas
+// that already have the version rather than wait for it, unless every replica is lagging.
+inline double laggingReplicaMetric(QueueData const& qd) {
+	if (FLOW_KNOBS->LOAD_BALANCE_LAGGING_REPLICA_VERSIONS > 0 &&
+	    qd.versionLag > FLOW_KNOBS->LOAD_BALANCE_LAGGING_REPLICA_VERSIONS &&
+	    now() < qd.versionLagTime + FLOW_KNOBS->LOAD_BALANCE_LAGGING_REPLICA_TIME) {
+		return 1e6;
+	}
+	return 0;
+}
+
 ACTOR template <class Req, class Resp, class Interface, class Multi, bool P>
 Future<Void> tssComparison(Req req,
                            Future<ErrorOr<Resp>> fSource,
@@ -527,6 +541,9 @@ struct RequestData : NonCopyable {
 		receivedResponse = receivedResponse || (!maybeDelivered && errCode != error_code_process_behind);
 		bool futureVersion = errCode == error_code_future_version || errCode == error_code_process_behind;
 
+		if (loadBalancedReply.present() && !loadBalancedReply.get().error.present() && modelHolder->model) {
+			modelHolder->model->updateVersionLag(modelHolder->token, loadBalancedReply.get().versionLag);
+		}
 		modelHolder->release(
 		    receivedResponse, futureVersion, loadBalancedReply.present() ? loadBalancedReply.get().penalty : -1.0);
 
@@ -659,6 +676,7 @@ Future<REPLY_TYPE(Request)> loadBalance(
 		double nextMetric = 1e9;
 		double bestTime = 1e9; // The latency to the server with the least outstanding requests.
 		double nextTime = 1e9;
+		double bestQuantile = 1e9; // The estimated latency percentile of the server with the least outstanding requests
 		int badServers = 0;
 
 		for (int i = 0; i < alternatives->size(); i++) {
@@ -682,7 +700,7 @@ Future<REPLY_TYPE(Request)> loadBalance(
 			if (!IFailureMonitor::failureMonitor().getState(thisStream->getEndpoint()).failed) {
 				auto const& qd = model->getMeasurement(thisStream->getEndpoint().token.first());
 				if (now() > qd.failedUntil) {
-					double thisMetric = qd.smoothOutstanding.smoothTotal();
+					double thisMetric = qd.smoothOutstanding.smoothTotal() + laggingReplicaMetric(qd);
 					double thisTime = qd.latency;
 					if (FLOW_KNOBS->LOAD_BALANCE_PENALTY_IS_BAD && qd.penalty > 1.001) {
 						// When a server wants to penalize itself (the default
@@ -700,6 +718,7 @@ Future<REPLY_TYPE(Request)> loadBalance(
 						bestAlt = i;
 						bestMetric = thisMetric;
 						bestTime = thisTime;
+						bestQuantile = qd.latencyQuantile;
 					} else if (thisMetric < nextMetric) {
 						nextAlt = i;
 						nextMetric = thisMetric;
@@ -721,7 +740,7 @@ Future<REPLY_TYPE(Request)> loadBalance(
 				if (!IFailureMonitor::failureMonitor().getState(thisStream->getEndpoint()).failed) {
 					auto const& qd = model->getMeasurement(thisStream->getEndpoint().token.first());
 					if (now() > qd.failedUntil) {
-						double thisMetric = qd.smoothOutstanding.smoothTotal();
+						double thisMetric = qd.smoothOutstanding.smoothTotal() + laggingReplicaMetric(qd);
 						double thisTime = qd.latency;
 
 						if (thisMetric < nextMetric) {
@@ -734,9 +753,50 @@ Future<REPLY_TYPE(Request)> loadBalance(
 			}
 		}
 
+		if (alternatives->bestDistance() == LBDistance::SAME_MACHINE && bestAlt < alternatives->countBest()) {
+			// The best alternative is in the client's zone. Reads from the other zones of the DC cost more, so only
+			// spill over to one of them once the read is expected to take longer, by more than
+			// LOAD_BALANCE_ZONE_SPILLOVER_LATENCY, from the client's zone: when a request waits for the ones
+			// outstanding to the server to be answered, it takes about (1 + outstanding) * latency
+			double spillTime = (1 + bestMetric) * bestTime - FLOW_KNOBS->LOAD_BALANCE_ZONE_SPILLOVER_LATENCY;
+			int spillAlt = -1;
+			double spillMetric = 0;
+			double spillLatency = 0;
+			double spillQuantile = 0;
+			for (int i = alternatives->countBest();
+			     i < alternatives->size() && alternatives->getDistance(i) == LBDistance::SAME_DC;
+			     i++) {
+				RequestStream<Request, P> const* thisStream = &alternatives->get(i, channel);
+				if (!IFailureMonitor::failureMonitor().getState(thisStream->getEndpoint()).failed) {
+					auto const& qd = model->getMeasurement(thisStream->getEndpoint().token.first());
+					double thisMetric = qd.smoothOutstanding.smoothTotal() + laggingReplicaMetric(qd);
+					if (now() > qd.failedUntil && (1 + thisMetric) * qd.latency < spillTime) {
+						spillAlt = i;
+						spillTime = (1 + thisMetric) * qd.latency;
+						spillMetric = thisMetric;
+						spillLatency = qd.latency;
+						spillQuantile = qd.latencyQuantile;
+					}
+				}
+			}
+			if (spillAlt >= 0) {
+				CODE_PROBE(true, "Load balance spilling over to another zone");
+				nextAlt = bestAlt;
+				nextMetric = bestMetric;
+				nextTime = bestTime;
+				bestAlt = spillAlt;
+				bestMetric = spillMetric;
+				bestTime = spillLatency;
+				bestQuantile = spillQuantile;
+			}
+		}
+
 		if (nextTime < 1e9) {
 			// Decide when to send the request to the second best choice.
-			if (bestTime > FLOW_KNOBS->INSTANT_SECOND_REQUEST_MULTIPLIER *
+			if (FLOW_KNOBS->LOAD_BALANCE_HEDGE_PERCENTILE > 0 && bestQuantile < 1e9) {
+				// Once the request has taken longer than most requests to the best choice do
+				secondDelay = delay(model->secondMultiplier * bestQuantile + FLOW_KNOBS->BASE_SECOND_REQUEST_TIME);
+			} else if (bestTime > FLOW_KNOBS->INSTANT_SECOND_REQUEST_MULTIPLIER *
 			                   (model->secondMultiplier * (nextTime) + FLOW_KNOBS->BASE_SECOND_REQUEST_TIME)) {
 				secondDelay = Void();
 			} else {
@@ -848,6 +908,9 @@ Future<REPLY_TYPE(Request)> loadBalance(
 				    .detail("Attempts", numAttempts);
 			}
 			secondRequestData.startRequest(backoff, triedAllOptions, stream, request, model, alternatives, channel);
+			if (model) {
+				++model->secondRequests;
+			}
 
 			state bool firstRequestSuccessful = false;
 			state bool secondRequestSuccessful = false;
@@ -864,6 +927,9 @@ Future<REPLY_TYPE(Request)> loadBalance(
 				when(wait(success(secondRequestData.response))) {
 					if (secondRequestData.checkAndProcessResult(atMostOnce)) {
 						secondRequestSuccessful = true;
+						if (model) {
+							++model->secondRequestWins;
+						}
 					}
 
 					break;
@@ -901,6 +967,12 @@ Future<REPLY_TYPE(Request)> loadBalance(
 			}
 			firstRequestData.startRequest(backoff, triedAllOptions, stream, request, model, alternatives, channel);
 			firstRequestEndpoint = stream->getEndpoint().token.first();
+			if (model && alternatives->bestDistance() == LBDistance::SAME_MACHINE) {
+				++model->zoneRequests;
+				if (distance == LBDistance::SAME_MACHINE) {
+					++model->inZoneRequests;
+				}
+			}
 
 			loop {
 				choose {
@@ -50,6 +50,10 @@ struct QueueData {
 	// The last client perceived latency to this storage server.
 	double latency;
 
+	// An estimate of the FLOW_KNOBS->LOAD_BALANCE_HEDGE_PERCENTILE percentile of clean client perceived latencies to
+	// this storage server, if that knob is set
+	double latencyQuantile;
+
 	// Represents the "cost" of each storage request. By default, the penalty is
 	// 1 indicating that each outstanding request corresponds 1 outstanding
 	// request. However, storage server can also increase the penalty if it
@@ -71,12 +75,18 @@ struct QueueData {
 	// to increase the future backoff amount.
 	double increaseBackoffTime;
 
+	// How many versions this storage server was behind the version its last successful reply had to wait for, and
+	// when that reply was received
+	int64_t versionLag;
+	double versionLagTime;
+
 	// a bit of a hack to store this here, but it's the only centralized place for per-endpoint tracking
 	Optional<TSSEndpointData> tssData;
 
 	QueueData()
-	  : smoothOutstanding(FLOW_KNOBS->QUEUE_MODEL_SMOOTHING_AMOUNT), latency(0.001), penalty(1.0), failedUntil(0),
-	    futureVersionBackoff(FLOW_KNOBS->FUTURE_VERSION_INITIAL_BACKOFF), increaseBackoffTime(0) {}
+	  : smoothOutstanding(FLOW_KNOBS->QUEUE_MODEL_SMOOTHING_AMOUNT), latency(0.001), latencyQuantile(0.001),
+	    penalty(1.0), failedUntil(0), futureVersionBackoff(FLOW_KNOBS->FUTURE_VERSION_INITIAL_BACKOFF),
+	    increaseBackoffTime(0), versionLag(0), versionLagTime(0) {}
 };
 
 typedef double TimeEstimate;
@@ -95,6 +105,9 @@ public:
 	void endRequest(uint64_t id, double latency, double penalty, double delta, bool clean, bool futureVersion);
 	QueueData const& getMeasurement(uint64_t id);
 
+	// Records the version lag reported by a reply from storage server with `id`
+	void updateVersionLag(uint64_t id, int64_t versionLag);
+
 	// Starts a new request to storage server with `id`. If the storage
 	// server contains a penalty, add it to the queue size, and return the
 	// penalty. The returned penalty should be passed as `delta` to `endRequest`
@@ -102,6 +115,12 @@ public:
 	double addRequest(uint64_t id);
 	double secondMultiplier;
 	double secondBudget;
+	// Requests sent to a second alternative while the first was outstanding, and how many of those answered first
+	int64_t secondRequests;
+	int64_t secondRequestWins;
+	// Requests with alternatives in the client's zone, and how many of those were sent to the client's zone
+	int64_t zoneRequests;
+	int64_t inZoneRequests;
 	PromiseStream<Future<Void>> addActor;
 	Future<Void> laggingRequests; // requests for which a different recipient already answered
 	PromiseStream<Future<Void>> addTSSActor;
@@ -118,7 +137,9 @@ public:
 	// Retrieves the data for this endpoint's pair TSS endpoint, if present
 	Optional<TSSEndpointData> getTssData(uint64_t endpointId);
 
-	QueueModel() : secondMultiplier(1.0), secondBudget(0), laggingRequestCount(0) {
+	QueueModel()
+	  : secondMultiplier(1.0), secondBudget(0), secondRequests(0), secondRequestWins(0), zoneRequests(0),
+	    inZoneRequests(0), laggingRequestCount(0) {
 		laggingRequests = actorCollection(addActor.getFuture(), &laggingRequestCount);
 		tssComparisons = actorCollection(addTSSActor.getFuture(), &laggingTSSCompareCount);
 	}
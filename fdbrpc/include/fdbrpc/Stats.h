@@ -45,7 +45,7 @@ MyCounters() : foo("foo", cc), bar("bar", cc), baz("baz", cc) {}
 #include <cstddef>
 #include "flow/flow.h"
 #include "flow/TDMetric.actor.h"
-#include "fdbrpc/DDSketch.h"
+#include "flow/DDSketch.h"
 
 struct ICounter : public IMetric {
 	// All counters have a name and value
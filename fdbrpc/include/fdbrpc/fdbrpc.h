@@ -604,8 +604,23 @@ public:
 	}
 
 	// Must be called on the server before using a ReplyPromiseStream to limit the amount of outstanding bytes to the
-	// client
-	void setByteLimit(int64_t byteLimit) { queue->acknowledgements.bytesLimit = byteLimit; }
+	// client. May also be called later to resize the window, which releases a waiting onReady() if it now fits.
+	void setByteLimit(int64_t byteLimit) {
+		auto& acknowledgements = queue->acknowledgements;
+		acknowledgements.bytesLimit = byteLimit;
+		if (acknowledgements.ready.isValid() && !acknowledgements.ready.isSet() &&
+		    acknowledgements.bytesSent - acknowledgements.bytesAcknowledged < byteLimit) {
+			Promise<Void> hold = acknowledgements.ready;
+			acknowledgements.ready = Promise<Void>(nullptr);
+			hold.send(Void());
+		}
+	}
+
+	// The bytes the client has acknowledged receiving, and the bytes sent which it has not yet acknowledged
+	int64_t getBytesAcknowledged() const { return queue->acknowledgements.bytesAcknowledged; }
+	int64_t getBytesOutstanding() const {
+		return queue->acknowledgements.bytesSent - queue->acknowledgements.bytesAcknowledged;
+	}
 
 	void operator=(const ReplyPromiseStream& rhs) {
 		rhs.queue->addPromiseRef();
@@ -33,8 +33,13 @@
 // This actor is used by FlowTransport to serialize the response to a ReplyPromise across the network
 ACTOR template <class T>
 void networkSender(Future<T> input, Endpoint endpoint) {
+	state const std::type_info* sampledReceiver = FlowTransport::transport().currentDeliverySampledReceiver();
+	state double dispatched = now();
 	try {
 		T value = wait(input);
+		if (sampledReceiver) {
+			FlowTransport::transport().addRpcServiceLatency(*sampledReceiver, now() - dispatched);
+		}
 		FlowTransport::transport().sendUnreliable(SerializeSource<ErrorOr<EnsureTable<T>>>(value), endpoint, false);
 	} catch (Error& err) {
 		// if (err.code() == error_code_broken_promise) return;
@@ -42,6 +47,9 @@ void networkSender(Future<T> input, Endpoint endpoint) {
 			return;
 		}
 		ASSERT(err.code() != error_code_actor_cancelled);
+		if (sampledReceiver) {
+			FlowTransport::transport().addRpcServiceLatency(*sampledReceiver, now() - dispatched);
+		}
 		FlowTransport::transport().sendUnreliable(SerializeSource<ErrorOr<EnsureTable<T>>>(err), endpoint, false);
 	}
 }
@@ -82,13 +82,14 @@ public:
 	    txnStateStore(proxyCommitData_.txnStateStore), toCommit(toCommit_), cipherKeys(cipherKeys_),
 	    encryptMode(encryptMode), confChange(confChange_), logSystem(logSystem_), version(version),
 	    popVersion(popVersion_), vecBackupKeys(&proxyCommitData_.vecBackupKeys), keyInfo(&proxyCommitData_.keyInfo),
-	    cacheInfo(&proxyCommitData_.cacheInfo),
+	    keyInfoGeneration(&proxyCommitData_.keyInfoGeneration), cacheInfo(&proxyCommitData_.cacheInfo),
 	    uid_applyMutationsData(proxyCommitData_.firstProxy ? &proxyCommitData_.uid_applyMutationsData : nullptr),
 	    commit(proxyCommitData_.commit), cx(proxyCommitData_.cx), committedVersion(&proxyCommitData_.committedVersion),
 	    storageCache(&proxyCommitData_.storageCache), tag_popped(&proxyCommitData_.tag_popped),
 	    tssMapping(&proxyCommitData_.tssMapping), tenantMap(&proxyCommitData_.tenantMap),
 	    tenantNameIndex(&proxyCommitData_.tenantNameIndex), lockedTenants(&proxyCommitData_.lockedTenants),
-	    initialCommit(initialCommit_), provisionalCommitProxy(provisionalCommitProxy_),
+	    tenantMapGeneration(&proxyCommitData_.tenantMapGeneration), initialCommit(initialCommit_),
+	    provisionalCommitProxy(provisionalCommitProxy_),
 	    accumulativeChecksumIndex(getCommitProxyAccumulativeChecksumIndex(proxyCommitData_.commitProxyIndex)),
 	    acsBuilder(proxyCommitData_.acsBuilder), epoch(proxyCommitData_.epoch) {
 		if (encryptMode.isEncryptionEnabled()) {
@@ -150,6 +151,7 @@ private:
 	Version popVersion = 0;
 	KeyRangeMap<std::set<Key>>* vecBackupKeys = nullptr;
 	KeyRangeMap<ServerCacheInfo>* keyInfo = nullptr;
+	uint64_t* keyInfoGeneration = nullptr;
 	KeyRangeMap<bool>* cacheInfo = nullptr;
 	std::map<Key, ApplyMutationsData>* uid_applyMutationsData = nullptr;
 	PublicRequestStream<CommitTransactionRequest> commit = PublicRequestStream<CommitTransactionRequest>();
@@ -162,6 +164,7 @@ private:
 	std::map<int64_t, TenantName>* tenantMap = nullptr;
 	std::unordered_map<TenantName, int64_t>* tenantNameIndex = nullptr;
 	std::set<int64_t>* lockedTenants = nullptr;
+	uint64_t* tenantMapGeneration = nullptr;
 	EncryptionAtRestMode encryptMode;
 
 	// true if the mutations were already written to the txnStateStore as part of recovery
@@ -211,6 +214,20 @@ private:
 		}
 	}
 
+	// Invalidates the commit proxy's cached lookups into keyInfo
+	void keyInfoChanged() {
+		if (keyInfoGeneration) {
+			++*keyInfoGeneration;
+		}
+	}
+
+	// Invalidates the commit proxy's cached lookups into tenantMap and lockedTenants
+	void tenantMapChanged() {
+		if (tenantMapGeneration) {
+			++*tenantMapGeneration;
+		}
+	}
+
 	void checkSetKeyServersPrefix(MutationRef m) {
 		if (!m.param1.startsWith(keyServersPrefix)) {
 			return;
@@ -257,6 +274,7 @@ private:
 		}
 		uniquify(info.tags);
 		keyInfo->insert(insertRange, info);
+		keyInfoChanged();
 		if (toCommit && SERVER_KNOBS->ENABLE_VERSION_VECTOR_TLOG_UNICAST) {
 			toCommit->setShardChanged();
 		}
@@ -338,6 +356,7 @@ private:
 					for (auto& it : keyInfo->ranges()) {
 						it.value().tags.clear();
 					}
+					keyInfoChanged();
 				}
 			}
 		}
@@ -849,6 +868,7 @@ private:
 					lockedTenants->insert(tenantEntry.id);
 				}
 			}
+			tenantMapChanged();
 
 			if (!initialCommit) {
 				txnStateStore->set(KeyValueRef(m.param1, tenantEntry.toTxnStateStoreEntry().encode()));
@@ -927,6 +947,7 @@ private:
 			                clearRange.begin == StringRef()
 			                    ? ServerCacheInfo()
 			                    : keyInfo->rangeContainingKeyBefore(clearRange.begin).value());
+			keyInfoChanged();
 			if (toCommit && SERVER_KNOBS->ENABLE_VERSION_VECTOR_TLOG_UNICAST) {
 				toCommit->setShardChanged();
 			}
@@ -1347,6 +1368,7 @@ private:
 					CODE_PROBE(startItr != endItr, "Deleting locked tenant");
 					lockedTenants->erase(startItr, endItr);
 				}
+				tenantMapChanged();
 			}
 
 			if (!initialCommit) {
@@ -19,6 +19,7 @@
  */
 
 #include "fdbclient/BackupAgent.actor.h"
+#include "fdbclient/BackupBlockCompression.h"
 #include "fdbclient/BackupContainer.h"
 #include "fdbclient/BlobCipher.h"
 #include "fdbclient/DatabaseContext.h"
@@ -34,6 +35,7 @@
 #include "fdbserver/ServerDBInfo.h"
 #include "fdbserver/WaitFailure.h"
 #include "fdbserver/WorkerInterface.actor.h"
+#include "flow/Deque.h"
 #include "flow/Error.h"
 
 #include "flow/IRandom.h"
@@ -123,6 +125,7 @@ struct BackupData {
 	Version minKnownCommittedVersion;
 	Version savedVersion; // Largest version saved to blob storage
 	Version popVersion; // Largest version popped in NOOP mode, can be larger than savedVersion.
+	Version uploadVersion; // Largest version handed to mutation log uploads, can be larger than savedVersion.
 	Reference<AsyncVar<ServerDBInfo> const> db;
 	AsyncVar<Reference<ILogSystem>> logSystem;
 	Database cx;
@@ -273,6 +276,9 @@ struct BackupData {
 	AsyncTrigger changedTrigger;
 	AsyncTrigger doneTrigger;
 
+	int pendingUploads = 0; // Mutation log uploads in progress, i.e., the depth of the upload pipeline
+	LatencySample uploadLatency; // Time to write and finish the mutation log files of a version range
+
 	CounterCollection cc;
 	Future<Void> logger;
 
@@ -280,7 +286,12 @@ struct BackupData {
 	  : myId(id), tag(req.routerTag), totalTags(req.totalTags), startVersion(req.startVersion),
 	    endVersion(req.endVersion), recruitedEpoch(req.recruitedEpoch), backupEpoch(req.backupEpoch),
 	    minKnownCommittedVersion(invalidVersion), savedVersion(req.startVersion - 1), popVersion(req.startVersion - 1),
-	    db(db), pulledVersion(0), paused(false), lock(new FlowLock(SERVER_KNOBS->BACKUP_LOCK_BYTES)),
+	    uploadVersion(req.startVersion - 1), db(db), pulledVersion(0), paused(false),
+	    lock(new FlowLock(SERVER_KNOBS->BACKUP_LOCK_BYTES)),
+	    uploadLatency("BackupWorkerUploadLatency",
+	                  id,
+	                  SERVER_KNOBS->LATENCY_METRICS_LOGGING_INTERVAL,
+	                  SERVER_KNOBS->LATENCY_SKETCH_ACCURACY),
 	    cc("BackupWorker", myId.toString()) {
 		cx = openDBOnServer(db, TaskPriority::DefaultEndpoint, LockAware::True);
 
@@ -289,6 +300,8 @@ struct BackupData {
 		specialCounter(cc, "MsgQ", [this]() { return this->messages.size(); });
 		specialCounter(cc, "BufferedBytes", [this]() { return this->lock->activePermits(); });
 		specialCounter(cc, "AvailableBytes", [this]() { return this->lock->available(); });
+		specialCounter(cc, "PendingUploads", [this]() { return this->pendingUploads; });
+		specialCounter(cc, "UploadVersion", [this]() { return this->uploadVersion; });
 		logger =
 		    cc.traceCounters("BackupWorkerMetrics", myId, SERVER_KNOBS->WORKER_LOGGING_INTERVAL, "BackupWorkerMetrics");
 	}
@@ -664,13 +677,23 @@ ACTOR Future<Void> saveProgress(BackupData* self, Version backupVersion) {
 	}
 }
 
+// Writes the current block of compressor to a log file, padded to a whole block size if pad is true
+ACTOR Future<Void> writeCompressedBlock(Reference<IBackupFile> logFile, BackupBlockCompressor* compressor, bool pad) {
+	state Standalone<StringRef> payload = compressor->finishBlock(pad);
+	wait(logFile->append((uint8_t*)&PARTITIONED_COMPRESSED_MLOG_VERSION, sizeof(PARTITIONED_COMPRESSED_MLOG_VERSION)));
+	wait(logFile->append(payload.begin(), payload.size()));
+	return Void();
+}
+
 // Write a mutation to a log file. Note the mutation can be different from
-// message.message for clear mutations.
+// message.message for clear mutations. If compressor is set the mutation is added to its block instead, and blocks are
+// written with PARTITIONED_COMPRESSED_MLOG_VERSION when they are full.
 ACTOR Future<Void> addMutation(Reference<IBackupFile> logFile,
                                VersionedMessage message,
                                StringRef mutation,
                                int64_t* blockEnd,
-                               int blockSize) {
+                               int blockSize,
+                               BackupBlockCompressor* compressor) {
 	state int bytes = sizeof(Version) + sizeof(uint32_t) + sizeof(int) + mutation.size();
 
 	// Convert to big Endianness for version.version, version.sub, and msgSize
@@ -681,6 +704,18 @@ ACTOR Future<Void> addMutation(Reference<IBackupFile> logFile,
 	wr << bigEndian64(message.version.version) << bigEndian32(message.version.sub) << bigEndian32(mutation.size());
 	state Standalone<StringRef> header = wr.toValue();
 
+	if (compressor) {
+		if (!compressor->fits(bytes)) {
+			wait(writeCompressedBlock(logFile, compressor, true));
+			if (!compressor->fits(bytes)) {
+				throw backup_bad_block_size();
+			}
+		}
+		compressor->append(header.begin(), header.size());
+		compressor->append(mutation.begin(), mutation.size());
+		return Void();
+	}
+
 	// Start a new block if needed
 	if (logFile->size() + bytes > *blockEnd) {
 		// Write padding if needed
@@ -702,7 +737,8 @@ ACTOR Future<Void> addMutation(Reference<IBackupFile> logFile,
 
 ACTOR static Future<Void> updateLogBytesWritten(BackupData* self,
                                                 std::vector<UID> backupUids,
-                                                std::vector<Reference<IBackupFile>> logFiles) {
+                                                std::vector<Reference<IBackupFile>> logFiles,
+                                                std::vector<int64_t> uncompressedSizes) {
 	state Reference<ReadYourWritesTransaction> tr(new ReadYourWritesTransaction(self->cx));
 
 	ASSERT(backupUids.size() == logFiles.size());
@@ -715,6 +751,7 @@ ACTOR static Future<Void> updateLogBytesWritten(BackupData* self,
 			for (int i = 0; i < backupUids.size(); i++) {
 				BackupConfig config(backupUids[i]);
 				config.logBytesWritten().atomicOp(tr, logFiles[i]->size(), MutationRef::AddValue);
+				config.uncompressedBytesWritten().atomicOp(tr, uncompressedSizes[i], MutationRef::AddValue);
 			}
 			wait(tr->commit());
 			return Void();
@@ -724,17 +761,20 @@ ACTOR static Future<Void> updateLogBytesWritten(BackupData* self,
 	}
 }
 
-// Saves messages in the range of [0, numMsg) to a file and then remove these
-// messages. The file content format is a sequence of (Version, sub#, msgSize, message).
-// Note only ready backups are saved.
+// Saves messages, which are the next messages of self->messages after those of earlier uploads, to a file. The file
+// content format is a sequence of (Version, sub#, msgSize, message). Note only ready backups are saved.
+// The files of each backup are opened before the first wait, with the begin version after the end of the previous
+// upload's file, so uploads of consecutive version ranges can run concurrently.
 ACTOR Future<Void> saveMutationsToFile(BackupData* self,
                                        Version popVersion,
-                                       int numMsg,
+                                       std::vector<VersionedMessage> messages,
                                        std::unordered_set<BlobCipherDetails> cipherDetails) {
+	state double startTime = now();
 	state int blockSize = SERVER_KNOBS->BACKUP_FILE_BLOCK_BYTES;
 	state std::vector<Future<Reference<IBackupFile>>> logFileFutures;
 	state std::vector<Reference<IBackupFile>> logFiles;
 	state std::vector<int64_t> blockEnds;
+	state std::vector<BackupBlockCompressor> compressors; // empty if files are not compressed
 	state std::vector<UID> activeUids; // active Backups' UIDs
 	state std::vector<Version> beginVersions; // logFiles' begin versions
 	state KeyRangeMap<std::set<int>> keyRangeMap; // range to index in logFileFutures, logFiles, & blockEnds
@@ -758,11 +798,13 @@ ACTOR Future<Void> saveMutationsToFile(BackupData* self,
 		self->insertRanges(keyRangeMap, it->second.ranges.get(), index);
 
 		if (it->second.lastSavedVersion == invalidVersion) {
-			if (it->second.startVersion > self->startVersion && !self->messages.empty()) {
+			if (it->second.startVersion > self->startVersion && !messages.empty()) {
 				// True-up first mutation log's begin version
-				it->second.lastSavedVersion = self->messages[0].getVersion();
+				it->second.lastSavedVersion = messages[0].getVersion();
 			} else {
-				it->second.lastSavedVersion = std::max({ self->popVersion, self->savedVersion, self->startVersion });
+				// Mutations handed to earlier uploads are not in their files for this backup
+				it->second.lastSavedVersion =
+				    std::max({ self->popVersion, self->savedVersion, self->uploadVersion, self->startVersion });
 			}
 			TraceEvent("BackupWorkerTrueUp", self->myId).detail("LastSavedVersion", it->second.lastSavedVersion);
 		}
@@ -772,8 +814,10 @@ ACTOR Future<Void> saveMutationsToFile(BackupData* self,
 
 		logFileFutures.push_back(it->second.container.get().get()->writeTaggedLogFile(
 		    it->second.lastSavedVersion, popVersion + 1, blockSize, self->tag.id, self->totalTags));
+		it->second.lastSavedVersion = popVersion + 1;
 		it++;
 	}
+	self->uploadVersion = std::max(self->uploadVersion, popVersion);
 
 	keyRangeMap.coalesce(allKeys);
 	wait(waitForAll(logFileFutures));
@@ -800,8 +844,14 @@ ACTOR Future<Void> saveMutationsToFile(BackupData* self,
 	}
 
 	blockEnds = std::vector<int64_t>(logFiles.size(), 0);
-	for (idx = 0; idx < numMsg; idx++) {
-		auto& message = self->messages[idx];
+	state CompressionFilter compression = getBackupCompressionFilter();
+	if (compression != CompressionFilter::NONE) {
+		compressors = std::vector<BackupBlockCompressor>(
+		    logFiles.size(),
+		    BackupBlockCompressor(compression, blockSize - sizeof(PARTITIONED_COMPRESSED_MLOG_VERSION)));
+	}
+	for (idx = 0; idx < messages.size(); idx++) {
+		auto& message = messages[idx];
 		MutationRef m;
 		if (!message.isCandidateBackupMessage(&m, cipherKeys))
 			continue;
@@ -814,8 +864,12 @@ ACTOR Future<Void> saveMutationsToFile(BackupData* self,
 		if (m.type != MutationRef::Type::ClearRange) {
 			for (int index : keyRangeMap[m.param1]) {
 				if (message.getVersion() >= beginVersions[index]) {
-					adds.push_back(
-					    addMutation(logFiles[index], message, message.message, &blockEnds[index], blockSize));
+					adds.push_back(addMutation(logFiles[index],
+					                           message,
+					                           message.message,
+					                           &blockEnds[index],
+					                           blockSize,
+					                           compressors.empty() ? nullptr : &compressors[index]));
 				}
 			}
 		} else {
@@ -832,8 +886,12 @@ ACTOR Future<Void> saveMutationsToFile(BackupData* self,
 				mutations.push_back(wr.toValue());
 				for (int index : range.value()) {
 					if (message.getVersion() >= beginVersions[index]) {
-						adds.push_back(
-						    addMutation(logFiles[index], message, mutations.back(), &blockEnds[index], blockSize));
+						adds.push_back(addMutation(logFiles[index],
+						                           message,
+						                           mutations.back(),
+						                           &blockEnds[index],
+						                           blockSize,
+						                           compressors.empty() ? nullptr : &compressors[index]));
 					}
 				}
 			}
@@ -842,6 +900,25 @@ ACTOR Future<Void> saveMutationsToFile(BackupData* self,
 		mutations.clear();
 	}
 
+	// Write the last compressed blocks, which aren't padded
+	state std::vector<int64_t> uncompressedSizes;
+	if (!compressors.empty()) {
+		std::vector<Future<Void>> lastBlocks;
+		for (int i = 0; i < logFiles.size(); i++) {
+			if (!compressors[i].empty()) {
+				lastBlocks.push_back(writeCompressedBlock(logFiles[i], &compressors[i], false));
+			}
+		}
+		wait(waitForAll(lastBlocks));
+	}
+	for (int i = 0; i < logFiles.size(); i++) {
+		int64_t size = logFiles[i]->size();
+		if (!compressors.empty()) {
+			size += compressors[i].getUncompressedBytes() - compressors[i].getCompressedBytes();
+		}
+		uncompressedSizes.push_back(size);
+	}
+
 	std::vector<Future<Void>> finished;
 	std::transform(logFiles.begin(), logFiles.end(), std::back_inserter(finished), [](const Reference<IBackupFile>& f) {
 		return f->finish();
@@ -855,73 +932,127 @@ ACTOR Future<Void> saveMutationsToFile(BackupData* self,
 		    .detail("TagId", self->tag.id)
 		    .detail("File", file->getFileName());
 	}
-	for (const UID& uid : activeUids) {
-		self->backups[uid].lastSavedVersion = popVersion + 1;
-	}
 
-	wait(updateLogBytesWritten(self, activeUids, logFiles));
+	wait(updateLogBytesWritten(self, activeUids, logFiles, uncompressedSizes));
+	self->uploadLatency.addMeasurement(now() - startTime);
 	return Void();
 }
 
-// Uploads self->messages to cloud storage and updates savedVersion.
+// A mutation log upload started by uploadData(), which saves the messages before popVersion that are not in earlier
+// uploads. Uploads are completed in the order they are started.
+struct PendingUpload {
+	Future<Void> done;
+	Version popVersion;
+	int numMsg; // number of messages of the upload at the front of self->messages once earlier uploads complete
+
+	PendingUpload(Future<Void> done, Version popVersion, int numMsg)
+	  : done(done), popVersion(popVersion), numMsg(numMsg) {}
+};
+
+// Uploads self->messages to cloud storage and updates savedVersion. Up to BACKUP_MAX_INFLIGHT_UPLOADS uploads of
+// consecutive version ranges run at once, while pullAsyncData() keeps pulling. Messages stay in self->messages, holding
+// their bytes of self->lock, until their upload completes, so the lock bounds the memory of the whole pipeline.
 ACTOR Future<Void> uploadData(BackupData* self) {
 	state Version popVersion = invalidVersion;
+	state Deque<PendingUpload> pending;
+	state int uploadingMsgs = 0; // number of messages at the front of self->messages in pending uploads
+	state Future<Void> uploadDelay = Void();
 
 	loop {
-		// Too large uploadDelay will delay popping tLog data for too long.
-		state Future<Void> uploadDelay = delay(SERVER_KNOBS->BACKUP_UPLOAD_DELAY);
-
-		state int numMsg = 0;
-		state std::unordered_set<BlobCipherDetails> cipherDetails;
-		Version lastPopVersion = popVersion;
-		// index of last version's end position in self->messages
-		int lastVersionIndex = 0;
-		Version lastVersion = invalidVersion;
-
-		for (auto& message : self->messages) {
-			// message may be prefetched in peek; uncommitted message should not be uploaded.
-			const Version version = message.getVersion();
-			if (version > self->maxPopVersion()) {
-				break;
+		// Uploads are started once every BACKUP_UPLOAD_DELAY, or right away once the pull is finished. In between,
+		// the loop completes uploads as they finish.
+		if (uploadDelay.isReady() || self->pullFinished()) {
+			// Too large uploadDelay will delay popping tLog data for too long.
+			uploadDelay = delay(SERVER_KNOBS->BACKUP_UPLOAD_DELAY);
+
+			state int numMsg = 0;
+			state std::unordered_set<BlobCipherDetails> cipherDetails;
+			state Version lastPopVersion = popVersion;
+			// index of last version's end position in self->messages, after the messages of pending uploads
+			int lastVersionIndex = 0;
+			Version lastVersion = invalidVersion;
+
+			for (int i = uploadingMsgs; i < self->messages.size(); i++) {
+				auto& message = self->messages[i];
+				// message may be prefetched in peek; uncommitted message should not be uploaded.
+				const Version version = message.getVersion();
+				if (version > self->maxPopVersion()) {
+					break;
+				}
+				if (version > popVersion) {
+					lastVersionIndex = numMsg;
+					lastVersion = popVersion;
+					popVersion = version;
+				}
+				message.collectCipherDetailIfEncrypted(cipherDetails);
+				numMsg++;
+			}
+			if (self->pullFinished()) {
+				popVersion = self->endVersion.get();
+			} else {
+				// make sure file is saved on version boundary
+				popVersion = lastVersion;
+				numMsg = lastVersionIndex;
+
+				// If we aren't able to process any messages and the lock is blocking us from
+				// queuing more, then we are stuck. This could suggest the lock capacity is too small.
+				ASSERT(numMsg > 0 || !pending.empty() || self->lock->waiters() == 0);
 			}
-			if (version > popVersion) {
-				lastVersionIndex = numMsg;
-				lastVersion = popVersion;
-				popVersion = version;
+			if (((numMsg > 0 || popVersion > lastPopVersion) && self->pulling) || self->pullFinished()) {
+				// Make sure all backups are ready, so that the upload opens its files before its first wait.
+				// Messages are only appended to self->messages meanwhile, so numMsg is still valid.
+				while (!self->isAllInfoReady()) {
+					wait(self->waitAllInfoReady());
+				}
+				TraceEvent("BackupWorkerSave", self->myId)
+				    .detail("Version", popVersion)
+				    .detail("LastPopVersion", lastPopVersion)
+				    .detail("Pulling", self->pulling)
+				    .detail("SavedVersion", self->savedVersion)
+				    .detail("NumMsg", numMsg)
+				    .detail("MsgQ", self->messages.size())
+				    .detail("PendingUploads", pending.size());
+				// save an empty file for old epochs so that log file versions are continuous
+				std::vector<VersionedMessage> messages(self->messages.begin() + uploadingMsgs,
+				                                       self->messages.begin() + uploadingMsgs + numMsg);
+				pending.emplace_back(
+				    saveMutationsToFile(self, popVersion, messages, cipherDetails), popVersion, numMsg);
+				uploadingMsgs += numMsg;
+				self->pendingUploads = pending.size();
 			}
-			message.collectCipherDetailIfEncrypted(cipherDetails);
-			numMsg++;
 		}
-		if (self->pullFinished()) {
-			popVersion = self->endVersion.get();
-		} else {
-			// make sure file is saved on version boundary
-			popVersion = lastVersion;
-			numMsg = lastVersionIndex;
 
-			// If we aren't able to process any messages and the lock is blocking us from
-			// queuing more, then we are stuck. This could suggest the lock capacity is too small.
-			ASSERT(numMsg > 0 || self->lock->waiters() == 0);
-		}
-		if (((numMsg > 0 || popVersion > lastPopVersion) && self->pulling) || self->pullFinished()) {
-			TraceEvent("BackupWorkerSave", self->myId)
-			    .detail("Version", popVersion)
-			    .detail("LastPopVersion", lastPopVersion)
-			    .detail("Pulling", self->pulling)
-			    .detail("SavedVersion", self->savedVersion)
-			    .detail("NumMsg", numMsg)
-			    .detail("MsgQ", self->messages.size());
-			// save an empty file for old epochs so that log file versions are continuous
-			wait(saveMutationsToFile(self, popVersion, numMsg, cipherDetails));
-			self->eraseMessages(numMsg);
+		// Complete uploads in order, waiting for them if the pipeline is full or must be drained.
+		while (!pending.empty() &&
+		       (pending.front().done.isReady() || pending.size() >= SERVER_KNOBS->BACKUP_MAX_INFLIGHT_UPLOADS ||
+		        !self->pulling || self->pullFinished())) {
+			wait(pending.front().done);
+			state Version savedVersion = pending.front().popVersion;
+			self->eraseMessages(pending.front().numMsg);
+			uploadingMsgs -= pending.front().numMsg;
+			pending.pop_front();
+			self->pendingUploads = pending.size();
+
+			if (savedVersion > self->savedVersion && savedVersion > self->popVersion) {
+				wait(saveProgress(self, savedVersion));
+				TraceEvent("BackupWorkerSavedProgress", self->myId)
+				    .detail("Tag", self->tag.toString())
+				    .detail("Version", savedVersion)
+				    .detail("MsgQ", self->messages.size());
+				self->savedVersion = std::max(savedVersion, self->savedVersion);
+				self->pop();
+			}
 		}
 
 		// If transition into NOOP mode, should clear messages
 		if (!self->pulling && self->backupEpoch == self->recruitedEpoch) {
+			ASSERT(pending.empty());
 			self->eraseMessages(self->messages.size());
+			uploadingMsgs = 0;
 		}
 
-		if (popVersion > self->savedVersion && popVersion > self->popVersion) {
+		// Save progress of versions without mutation files, e.g., in NOOP mode
+		if (pending.empty() && popVersion > self->savedVersion && popVersion > self->popVersion) {
 			wait(saveProgress(self, popVersion));
 			TraceEvent("BackupWorkerSavedProgress", self->myId)
 			    .detail("Tag", self->tag.toString())
@@ -936,7 +1067,7 @@ ACTOR Future<Void> uploadData(BackupData* self) {
 		}
 
 		if (!self->pullFinished()) {
-			wait(uploadDelay || self->doneTrigger.onTrigger());
+			wait(uploadDelay || self->doneTrigger.onTrigger() || (pending.empty() ? Never() : pending.front().done));
 		}
 	}
 }
@@ -82,15 +82,28 @@ void GranuleMetadata::resetReadStats() {
 	runRDC.reset();
 }
 
-double GranuleMetadata::weightRDC() {
-	// ratio of read amp to write amp that would be incurred by re-snapshotting now
+int64_t GranuleMetadata::writeCostRDC() const {
 	int64_t lastSnapshotSize = (files.snapshotFiles.empty()) ? 0 : files.snapshotFiles.back().length;
 	int64_t minSnapshotSize = SERVER_KNOBS->BG_SNAPSHOT_FILE_TARGET_BYTES / 2;
 	lastSnapshotSize = std::max(minSnapshotSize, lastSnapshotSize);
 
-	int64_t writeAmp = lastSnapshotSize + bufferedDeltaBytes + bytesInNewDeltaFiles;
+	return lastSnapshotSize + bufferedDeltaBytes + bytesInNewDeltaFiles;
+}
+
+double GranuleMetadata::weightRDC() const {
+	// ratio of read amp to write amp that would be incurred by re-snapshotting now
 	// read amp is deltaBytesRead. Read amp must be READ_FACTOR times larger than write amp
-	return (1.0 * readStats.deltaBytesRead) / (writeAmp * SERVER_KNOBS->BG_RDC_READ_FACTOR);
+	return (1.0 * readStats.deltaBytesRead) / (writeCostRDC() * SERVER_KNOBS->BG_RDC_READ_FACTOR);
+}
+
+double GranuleMetadata::projectedSavingsRDC() const {
+	if (readStats.reads == 0) {
+		return 0;
+	}
+	// the delta chain only grows until the next snapshot, so the bytes merged per read so far are a lower bound
+	double readsPerSecond = readStats.reads / std::max(1.0, now() - readStats.firstReadTime);
+	double deltaBytesPerRead = (1.0 * readStats.deltaBytesRead) / readStats.reads;
+	return readsPerSecond * deltaBytesPerRead * SERVER_KNOBS->BG_RDC_SAVINGS_HORIZON;
 }
 
 bool GranuleMetadata::isEligibleRDC() const {
@@ -110,6 +123,9 @@ bool GranuleMetadata::updateReadStats(Version readVersion, const BlobGranuleChun
 		return false;
 	}
 
+	if (readStats.reads++ == 0) {
+		readStats.firstReadTime = now();
+	}
 	// any memory deltas must be newer than snapshot
 	readStats.deltaBytesRead += chunk.newDeltas.expectedSize();
 	for (auto& it : chunk.deltaFiles) {
@@ -939,24 +955,46 @@ ACTOR Future<BlobFileIndex> writeSnapshot(Reference<BlobWorkerData> bwData,
                                           PromiseStream<RangeResult> rows,
                                           bool initialSnapshot) {
 	state std::string fileName = randomBGFilename(bwData->id, granuleID, version, ".snapshot");
-	state Standalone<GranuleSnapshot> snapshot;
 	state int64_t bytesRead = 0;
 	state bool canStopEarly =
 	    (SERVER_KNOBS->BG_KEY_TUPLE_TRUNCATE_OFFSET == 0 || SERVER_KNOBS->BG_ENABLE_SPLIT_TRUNCATED);
 	state bool injectTooBig = initialSnapshot && g_network->isSimulated() && BUGGIFY_WITH_PROB(0.1);
 
+	state Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx;
+	state Optional<BlobGranuleCipherKeysMeta> cipherKeysMeta;
+	state Arena arena;
+
+	if (bwData->encryptMode.isEncryptionEnabled()) {
+		BlobGranuleCipherKeysCtx ciphKeysCtx = wait(getLatestGranuleCipherKeys(bwData, keyRange, &arena));
+		cipherKeysCtx = std::move(ciphKeysCtx);
+		cipherKeysMeta = BlobGranuleCipherKeysCtx::toCipherKeysMeta(cipherKeysCtx.get());
+	}
+
+	state Optional<CompressionFilter> compressFilter = getBlobFileCompressFilter();
+	ASSERT(!bwData->encryptMode.isEncryptionEnabled() || cipherKeysCtx.present());
+	// chunks are compressed and encrypted as rows arrive, so that it overlaps reading the rest
+	state SnapshotFileBuilder snapshot(SERVER_KNOBS->BG_SNAPSHOT_FILE_TARGET_CHUNK_BYTES,
+	                                   compressFilter,
+	                                   cipherKeysCtx,
+	                                   SERVER_KNOBS->BG_SNAPSHOT_COLUMNAR);
+
 	wait(delay(0, TaskPriority::BlobWorkerUpdateStorage));
 
 	loop {
 		try {
-			if (initialSnapshot && snapshot.size() > 3 && canStopEarly &&
+			if (initialSnapshot && snapshot.getRows() > 3 && canStopEarly &&
 			    (injectTooBig || bytesRead >= 3 * SERVER_KNOBS->BG_SNAPSHOT_FILE_TARGET_BYTES)) {
 				// throw transaction too old either on injection for simulation, or if snapshot would be too large now
 				throw transaction_too_old();
 			}
 			RangeResult res = waitNext(rows.getFuture());
-			snapshot.arena().dependsOn(res.arena());
-			snapshot.append(snapshot.arena(), res.begin(), res.size());
+			for (auto& row : res) {
+				// sort order is checked by the builder
+				if (g_network->isSimulated()) {
+					ASSERT(keyRange.contains(row.key));
+				}
+				snapshot.add(row);
+			}
 			bytesRead += res.expectedSize();
 			wait(yield(TaskPriority::BlobWorkerUpdateStorage));
 		} catch (Error& e) {
@@ -964,7 +1002,7 @@ ACTOR Future<BlobFileIndex> writeSnapshot(Reference<BlobWorkerData> bwData,
 				break;
 			}
 			// if we got transaction_too_old naturally, have lower threshold for re-evaluating (2xlimit)
-			if (initialSnapshot && snapshot.size() > 3 && e.code() == error_code_transaction_too_old &&
+			if (initialSnapshot && snapshot.getRows() > 3 && e.code() == error_code_transaction_too_old &&
 			    (injectTooBig || bytesRead >= 2 * SERVER_KNOBS->BG_SNAPSHOT_FILE_TARGET_BYTES)) {
 				// idle this actor, while we tell the manager this is too big and to re-evaluate granules and revoke us
 				if (BW_DEBUG) {
@@ -975,8 +1013,7 @@ ACTOR Future<BlobFileIndex> writeSnapshot(Reference<BlobWorkerData> bwData,
 					           SERVER_KNOBS->BG_SNAPSHOT_FILE_TARGET_BYTES,
 					           injectTooBig ? "(injected)" : "");
 				}
-				wait(reevaluateInitialSplit(
-				    bwData, granuleID, keyRange, epoch, seqno, snapshot[snapshot.size() / 2].key));
+				wait(reevaluateInitialSplit(bwData, granuleID, keyRange, epoch, seqno, snapshot.middleKey()));
 				ASSERT(false);
 			} else {
 				throw e;
@@ -990,49 +1027,18 @@ ACTOR Future<BlobFileIndex> writeSnapshot(Reference<BlobWorkerData> bwData,
 		fmt::print("Granule [{0} - {1}) read {2} snapshot rows ({3} bytes)\n",
 		           keyRange.begin.printable(),
 		           keyRange.end.printable(),
-		           snapshot.size(),
+		           snapshot.getRows(),
 		           bytesRead);
 	}
 
-	if (g_network->isSimulated()) {
-		if (snapshot.size() > 0) {
-			ASSERT(keyRange.begin <= snapshot[0].key);
-			ASSERT(keyRange.end > snapshot[snapshot.size() - 1].key);
-		}
-		for (int i = 0; i < snapshot.size() - 1; i++) {
-			if (snapshot[i].key >= snapshot[i + 1].key) {
-				fmt::print("SORT ORDER VIOLATION IN SNAPSHOT FILE: {0}, {1}\n",
-				           snapshot[i].key.printable(),
-				           snapshot[i + 1].key.printable());
-			}
-			ASSERT(snapshot[i].key < snapshot[i + 1].key);
-		}
-	}
-
-	state Optional<BlobGranuleCipherKeysCtx> cipherKeysCtx;
-	state Optional<BlobGranuleCipherKeysMeta> cipherKeysMeta;
-	state Arena arena;
-
-	if (bwData->encryptMode.isEncryptionEnabled()) {
-		BlobGranuleCipherKeysCtx ciphKeysCtx = wait(getLatestGranuleCipherKeys(bwData, keyRange, &arena));
-		cipherKeysCtx = std::move(ciphKeysCtx);
-		cipherKeysMeta = BlobGranuleCipherKeysCtx::toCipherKeysMeta(cipherKeysCtx.get());
-	}
-
-	state Optional<CompressionFilter> compressFilter = getBlobFileCompressFilter();
-	ASSERT(!bwData->encryptMode.isEncryptionEnabled() || cipherKeysCtx.present());
-	state Value serialized = serializeChunkedSnapshot(StringRef(fileName),
-	                                                  snapshot,
-	                                                  SERVER_KNOBS->BG_SNAPSHOT_FILE_TARGET_CHUNK_BYTES,
-	                                                  compressFilter,
-	                                                  cipherKeysCtx);
-	state size_t logicalSize = snapshot.expectedSize();
+	state Value serialized = snapshot.finish();
+	state size_t logicalSize = snapshot.getLogicalBytes();
 	state size_t serializedSize = serialized.size();
 	bwData->stats.compressionBytesRaw += logicalSize;
 	bwData->stats.compressionBytesFinal += serializedSize;
 
 	// free snapshot to reduce memory
-	snapshot = Standalone<GranuleSnapshot>();
+	snapshot = SnapshotFileBuilder();
 
 	if (serializedSize >= 5 * SERVER_KNOBS->BG_SNAPSHOT_FILE_TARGET_BYTES) {
 		// TODO REMOVE key range from log
@@ -4985,20 +4991,24 @@ ACTOR Future<Void> runGRVChecks(Reference<BlobWorkerData> bwData) {
 }
 
 struct RDCEntry {
-	double weight;
+	// projected delta bytes saved for readers per byte written
+	double priority;
+	int64_t writeBytes;
+	double projectedSavings;
 	Reference<GranuleMetadata> granule;
-	RDCEntry(double weight, Reference<GranuleMetadata> granule) : weight(weight), granule(granule) {}
-};
-
-// for a top-k algorithm, we actually want a min-heap, so reverse the sort order
-struct OrderForTopK {
-	bool operator()(RDCEntry const& a, RDCEntry const& b) const { return b.weight - a.weight; }
+	RDCEntry(double priority, int64_t writeBytes, double projectedSavings, Reference<GranuleMetadata> granule)
+	  : priority(priority), writeBytes(writeBytes), projectedSavings(projectedSavings), granule(granule) {}
 };
 
-typedef std::priority_queue<RDCEntry, std::vector<RDCEntry>, OrderForTopK> TopKPQ;
-
+// Re-snapshots the read-driven compaction candidates that save readers the most merging per byte written first, as
+// long as the bytes written stay within BLOB_WORKER_RDC_BYTES_PER_SECOND, and at most BLOB_WORKER_RDC_PARALLELISM at a
+// time.
 ACTOR Future<Void> runReadDrivenCompaction(Reference<BlobWorkerData> bwData) {
 	state bool processedAll = true;
+	// bytes this worker may still write for read-driven re-snapshots; may go negative to always allow one
+	state double budgetBytes =
+	    SERVER_KNOBS->BLOB_WORKER_RDC_BYTES_PER_SECOND * SERVER_KNOBS->BLOB_WORKER_RDC_BUDGET_SECONDS;
+	state double lastBudgetTime = now();
 	loop {
 		if (processedAll) {
 			wait(bwData->doReadDrivenCompaction.getFuture());
@@ -5006,48 +5016,73 @@ ACTOR Future<Void> runReadDrivenCompaction(Reference<BlobWorkerData> bwData) {
 			wait(delay(0));
 		}
 
-		TopKPQ topK;
+		budgetBytes = std::min(budgetBytes + (now() - lastBudgetTime) * SERVER_KNOBS->BLOB_WORKER_RDC_BYTES_PER_SECOND,
+		                       SERVER_KNOBS->BLOB_WORKER_RDC_BYTES_PER_SECOND *
+		                           SERVER_KNOBS->BLOB_WORKER_RDC_BUDGET_SECONDS);
+		lastBudgetTime = now();
 
 		// FIXME: possible to scan candidates instead of all granules?
-		int candidates = 0;
+		std::vector<RDCEntry> candidates;
 		auto allRanges = bwData->granuleMetadata.intersectingRanges(normalKeys);
 		for (auto& it : allRanges) {
 			if (it.value().activeMetadata.isValid() && it.value().activeMetadata->cancelled.canBeSet()) {
 				auto metadata = it.value().activeMetadata;
 				if (metadata->rdcCandidate && metadata->isEligibleRDC() && metadata->runRDC.canBeSet() &&
-				    metadata->pendingSnapshotVersion == metadata->durableSnapshotVersion.get()) {
-					candidates++;
-					double weight = metadata->weightRDC();
-					if (weight > 1.0 &&
-					    (topK.size() < SERVER_KNOBS->BLOB_WORKER_RDC_PARALLELISM || weight > topK.top().weight)) {
-						if (topK.size() == SERVER_KNOBS->BLOB_WORKER_RDC_PARALLELISM) {
-							topK.pop();
-						}
-						topK.push(RDCEntry(weight, metadata));
-					}
+				    metadata->pendingSnapshotVersion == metadata->durableSnapshotVersion.get() &&
+				    metadata->weightRDC() > 1.0) {
+					int64_t writeBytes = metadata->writeCostRDC();
+					double savings = metadata->projectedSavingsRDC();
+					candidates.emplace_back(savings / writeBytes, writeBytes, savings, metadata);
 				}
 			}
 		}
-
-		CODE_PROBE(candidates > topK.size(), "Too many read-driven compaction candidates for one cycle");
+		std::sort(candidates.begin(), candidates.end(), [](RDCEntry const& a, RDCEntry const& b) {
+			return a.priority > b.priority;
+		});
 
 		std::vector<Future<Void>> futures;
-		futures.reserve(topK.size());
-		while (!topK.empty()) {
+		int deferred = 0;
+		double projectedSavings = 0;
+		for (auto& candidate : candidates) {
+			if (futures.size() >= SERVER_KNOBS->BLOB_WORKER_RDC_PARALLELISM || budgetBytes <= 0) {
+				deferred++;
+				continue;
+			}
 			++bwData->stats.readDrivenCompactions;
-			Promise<Void> runRDC = topK.top().granule->runRDC;
+			budgetBytes -= candidate.writeBytes;
+			projectedSavings += candidate.projectedSavings;
+			Reference<GranuleMetadata> granule = candidate.granule;
+			TraceEvent(SevDebug, "BlobWorkerReadDrivenCompaction", bwData->id)
+			    .detail("Granule", granule->keyRange)
+			    .detail("Reads", granule->readStats.reads)
+			    .detail("DeltaBytesRead", granule->readStats.deltaBytesRead)
+			    .detail("WriteBytes", candidate.writeBytes)
+			    .detail("ProjectedSavedBytes", candidate.projectedSavings)
+			    .detail("Priority", candidate.priority);
+			Promise<Void> runRDC = granule->runRDC;
 			ASSERT(runRDC.canBeSet());
-			Future<Void> waitForSnapshotComplete = topK.top().granule->durableSnapshotVersion.whenAtLeast(
-			                                           topK.top().granule->durableSnapshotVersion.get() + 1) ||
-			                                       topK.top().granule->cancelled.getFuture();
-			futures.push_back(waitForSnapshotComplete);
-			topK.pop();
+			futures.push_back(granule->durableSnapshotVersion.whenAtLeast(granule->durableSnapshotVersion.get() + 1) ||
+			                  granule->cancelled.getFuture());
 			runRDC.send(Void());
 		}
-		processedAll = futures.empty();
+
+		CODE_PROBE(deferred > 0, "Read-driven compaction candidates deferred to a later cycle");
+		if (!candidates.empty()) {
+			TraceEvent("BlobWorkerReadDrivenCompactionCycle", bwData->id)
+			    .detail("Candidates", candidates.size())
+			    .detail("Scheduled", futures.size())
+			    .detail("Deferred", deferred)
+			    .detail("ProjectedSavedBytes", projectedSavings)
+			    .detail("BudgetBytes", budgetBytes);
+		}
+
+		processedAll = futures.empty() && deferred == 0;
 		if (!futures.empty()) {
 			// wait at least one second to throttle this actor a bit
 			wait(waitForAll(futures) && delay(1.0));
+		} else if (deferred > 0) {
+			// wait for the budget to refill
+			wait(delay(1.0));
 		}
 	}
 }
@@ -1455,6 +1455,22 @@ ACTOR Future<Void> timeKeeper(ClusterControllerData* self) {
 	}
 }
 
+// Adds the status requests that are ready to batch, or rejects them if more than MAX_STATUS_REQUESTS_PER_SECOND
+// requests per second would be answered
+static void batchReadyStatusRequests(FutureStream<StatusRequest>& requests, std::vector<StatusRequest>& batch) {
+	while (requests.isReady()) {
+		auto req = requests.pop();
+		if (SERVER_KNOBS->STATUS_MIN_TIME_BETWEEN_REQUESTS > 0.0 &&
+		    batch.size() + 1 >
+		        SERVER_KNOBS->STATUS_MIN_TIME_BETWEEN_REQUESTS * SERVER_KNOBS->MAX_STATUS_REQUESTS_PER_SECOND) {
+			TraceEvent(SevWarnAlways, "TooManyStatusRequests").suppressFor(1.0).detail("BatchSize", batch.size());
+			req.reply.sendError(server_overloaded());
+		} else {
+			batch.push_back(req);
+		}
+	}
+}
+
 ACTOR Future<Void> statusServer(FutureStream<StatusRequest> requests,
                                 ClusterControllerData* self,
                                 ServerCoordinators coordinators,
@@ -1465,6 +1481,13 @@ ACTOR Future<Void> statusServer(FutureStream<StatusRequest> requests,
 	// Place to accumulate a batch of requests to respond to
 	state std::vector<StatusRequest> requests_batch;
 
+	// The last status, and the time its GetStatus began. Requests are answered with it until it is older than
+	// STATUS_CACHE_MAX_AGE, rather than each rebuilding the status from all workers.
+	state Optional<StatusReply> cachedStatus;
+	state double cachedStatusTime = 0.0;
+	// Parts of cachedStatus that were requested with a status field, by field
+	state std::map<std::string, StatusReply> cachedStatusSections;
+
 	loop {
 		try {
 			// Wait til first request is ready
@@ -1472,91 +1495,103 @@ ACTOR Future<Void> statusServer(FutureStream<StatusRequest> requests,
 			++self->statusRequests;
 			requests_batch.push_back(req);
 
-			// Earliest time at which we may begin a new request
-			double next_allowed_request_time = last_request_time + SERVER_KNOBS->STATUS_MIN_TIME_BETWEEN_REQUESTS;
-
-			// Wait if needed to satisfy min_time knob, also allows more requests to queue up.
-			double minwait = std::max(next_allowed_request_time - now(), 0.0);
-			wait(delay(minwait));
-
-			// Get all requests that are ready right *now*, before GetStatus() begins.
-			// All of these requests will be responded to with the next GetStatus() result.
-			// If requests are batched, do not respond to more than MAX_STATUS_REQUESTS_PER_SECOND
-			// requests per second
-			while (requests.isReady()) {
-				auto req = requests.pop();
-				if (SERVER_KNOBS->STATUS_MIN_TIME_BETWEEN_REQUESTS > 0.0 &&
-				    requests_batch.size() + 1 >
-				        SERVER_KNOBS->STATUS_MIN_TIME_BETWEEN_REQUESTS * SERVER_KNOBS->MAX_STATUS_REQUESTS_PER_SECOND) {
-					TraceEvent(SevWarnAlways, "TooManyStatusRequests")
-					    .suppressFor(1.0)
-					    .detail("BatchSize", requests_batch.size());
-					req.reply.sendError(server_overloaded());
-				} else {
-					requests_batch.push_back(req);
+			state ErrorOr<StatusReply> result;
+			if (cachedStatus.present() && now() - cachedStatusTime <= SERVER_KNOBS->STATUS_CACHE_MAX_AGE) {
+				++self->statusCacheHits;
+				batchReadyStatusRequests(requests, requests_batch);
+				result = cachedStatus.get();
+			} else {
+				// Earliest time at which we may begin a new request
+				double next_allowed_request_time = last_request_time + SERVER_KNOBS->STATUS_MIN_TIME_BETWEEN_REQUESTS;
+
+				// Wait if needed to satisfy min_time knob, also allows more requests to queue up.
+				double minwait = std::max(next_allowed_request_time - now(), 0.0);
+				wait(delay(minwait));
+
+				// Get all requests that are ready right *now*, before GetStatus() begins.
+				// All of these requests will be responded to with the next GetStatus() result.
+				// If requests are batched, do not respond to more than MAX_STATUS_REQUESTS_PER_SECOND
+				// requests per second
+				batchReadyStatusRequests(requests, requests_batch);
+
+				// Get status but trap errors to send back to client.
+				std::vector<WorkerDetails> workers;
+				std::vector<ProcessIssues> workerIssues;
+
+				for (auto& it : self->id_worker) {
+					workers.push_back(it.second.details);
+					if (it.second.issues.size()) {
+						workerIssues.emplace_back(it.second.details.interf.address(), it.second.issues);
+					}
 				}
-			}
 
-			// Get status but trap errors to send back to client.
-			std::vector<WorkerDetails> workers;
-			std::vector<ProcessIssues> workerIssues;
+				std::vector<NetworkAddress> incompatibleConnections;
+				for (auto it = self->db.incompatibleConnections.begin();
+				     it != self->db.incompatibleConnections.end();) {
+					if (it->second < now()) {
+						it = self->db.incompatibleConnections.erase(it);
+					} else {
+						incompatibleConnections.push_back(it->first);
+						it++;
+					}
+				}
 
-			for (auto& it : self->id_worker) {
-				workers.push_back(it.second.details);
-				if (it.second.issues.size()) {
-					workerIssues.emplace_back(it.second.details.interf.address(), it.second.issues);
+				state double statusStartTime = now();
+				wait(store(result,
+				           errorOr(clusterGetStatus(self->db.serverInfo,
+				                                    self->cx,
+				                                    workers,
+				                                    workerIssues,
+				                                    self->storageStatusInfos,
+				                                    &self->db.clientStatus,
+				                                    coordinators,
+				                                    incompatibleConnections,
+				                                    self->datacenterVersionDifference,
+				                                    self->dcLogServerVersionDifference,
+				                                    self->dcStorageServerVersionDifference,
+				                                    configBroadcaster,
+				                                    self->db.metaclusterRegistration,
+				                                    self->db.metaclusterMetrics))));
+
+				if (result.isError() && result.getError().code() == error_code_actor_cancelled)
+					throw result.getError();
+
+				// Update last_request_time now because GetStatus is finished and the delay is to be measured between
+				// requests
+				last_request_time = now();
+
+				if (result.present()) {
+					cachedStatus = result.get();
+					cachedStatusTime = statusStartTime;
+					cachedStatusSections.clear();
+					// Requests that came in during GetStatus() share its result if it is still recent enough
+					if (now() - statusStartTime <= SERVER_KNOBS->STATUS_CACHE_MAX_AGE) {
+						batchReadyStatusRequests(requests, requests_batch);
+					}
 				}
 			}
 
-			std::vector<NetworkAddress> incompatibleConnections;
-			for (auto it = self->db.incompatibleConnections.begin(); it != self->db.incompatibleConnections.end();) {
-				if (it->second < now()) {
-					it = self->db.incompatibleConnections.erase(it);
-				} else {
-					incompatibleConnections.push_back(it->first);
-					it++;
-				}
-			}
-
-			state ErrorOr<StatusReply> result = wait(errorOr(clusterGetStatus(self->db.serverInfo,
-			                                                                  self->cx,
-			                                                                  workers,
-			                                                                  workerIssues,
-			                                                                  self->storageStatusInfos,
-			                                                                  &self->db.clientStatus,
-			                                                                  coordinators,
-			                                                                  incompatibleConnections,
-			                                                                  self->datacenterVersionDifference,
-			                                                                  self->dcLogServerVersionDifference,
-			                                                                  self->dcStorageServerVersionDifference,
-			                                                                  configBroadcaster,
-			                                                                  self->db.metaclusterRegistration,
-			                                                                  self->db.metaclusterMetrics)));
-
-			if (result.isError() && result.getError().code() == error_code_actor_cancelled)
-				throw result.getError();
-
-			// Update last_request_time now because GetStatus is finished and the delay is to be measured between
-			// requests
-			last_request_time = now();
-
-			state Optional<StatusReply> faultToleranceRelatedStatus;
 			while (!requests_batch.empty()) {
-				if (result.isError())
+				const std::string& statusField = requests_batch.back().statusField;
+				if (result.isError()) {
 					requests_batch.back().reply.sendError(result.getError());
-				else if (requests_batch.back().statusField.empty())
+				} else if (statusField.empty()) {
 					requests_batch.back().reply.send(result.get());
-				else {
-					ASSERT(requests_batch.back().statusField == "fault_tolerance");
-					if (!faultToleranceRelatedStatus.present()) {
-						faultToleranceRelatedStatus = clusterGetFaultToleranceStatus(result.get().statusStr);
+				} else {
+					auto section = cachedStatusSections.find(statusField);
+					if (section == cachedStatusSections.end()) {
+						section = cachedStatusSections
+						              .emplace(statusField,
+						                       statusField == "fault_tolerance"
+						                           ? clusterGetFaultToleranceStatus(result.get().statusStr)
+						                           : clusterGetStatusSections(result.get().statusStr, statusField))
+						              .first;
 					}
-					requests_batch.back().reply.send(faultToleranceRelatedStatus.get());
+					requests_batch.back().reply.send(section->second);
 				}
 				requests_batch.pop_back();
 				wait(yield());
 			}
-			faultToleranceRelatedStatus.reset();
 		} catch (Error& e) {
 			TraceEvent(SevError, "StatusServerError").error(e);
 			throw e;
@@ -1946,6 +1981,39 @@ ACTOR Future<Void> updatedChangedDatacenters(ClusterControllerData* self) {
 	}
 }
 
+// Recruits the transaction system for the next recovery while the database is fully recovered, so that the recovery
+// can skip recruiting if the workers are still available when it starts.
+ACTOR Future<Void> maintainStandbyRecruitment(ClusterControllerData* self) {
+	loop {
+		wait(lowPriorityDelay(SERVER_KNOBS->CC_STANDBY_RECRUITMENT_INTERVAL));
+		const ServerDBInfo& dbi = self->db.serverInfo->get();
+		if (dbi.recoveryState < RecoveryState::FULLY_RECOVERED || !self->db.config.isValid() ||
+		    !self->goodRecruitmentTime.isReady()) {
+			self->standbyRecruitment.reset();
+			continue;
+		}
+
+		// The next recovery recruits log routers for the generations of the current log system
+		int maxLogRouters = dbi.logSystemConfig.logRouterTags;
+		for (const auto& old : dbi.logSystemConfig.oldTLogs) {
+			maxLogRouters = std::max(maxLogRouters, old.logRouterTags);
+		}
+		state StandbyRecruitment standby;
+		standby.req = RecruitFromConfigurationRequest(self->db.config, false, maxLogRouters);
+		try {
+			standby.rep = self->findWorkersForConfiguration(standby.req);
+		} catch (Error& e) {
+			if (e.code() != error_code_no_more_servers && e.code() != error_code_operation_failed) {
+				throw;
+			}
+			self->standbyRecruitment.reset();
+			continue;
+		}
+		standby.time = now();
+		self->standbyRecruitment = std::move(standby);
+	}
+}
+
 ACTOR Future<Void> updateDatacenterVersionDifference(ClusterControllerData* self) {
 	state double lastLogTime = 0;
 	loop {
@@ -2900,6 +2968,8 @@ ACTOR Future<Void> monitorBlobManager(ClusterControllerData* self) {
 ACTOR Future<Void> dbInfoUpdater(ClusterControllerData* self) {
 	state Future<Void> dbInfoChange = self->db.serverInfo->onChange();
 	state Future<Void> updateDBInfo = self->updateDBInfo.onTrigger();
+	// The ServerDBInfo of the last broadcast, which most workers have, so later broadcasts to all workers can be deltas
+	state ServerDBInfo lastBroadcastInfo;
 	loop {
 		choose {
 			when(wait(updateDBInfo)) {
@@ -2909,7 +2979,8 @@ ACTOR Future<Void> dbInfoUpdater(ClusterControllerData* self) {
 		}
 
 		state UpdateServerDBInfoRequest req;
-		if (dbInfoChange.isReady()) {
+		state bool allWorkers = dbInfoChange.isReady();
+		if (allWorkers) {
 			for (auto& it : self->id_worker) {
 				req.broadcastInfo.push_back(it.second.details.interf.updateServerDBInfo.getEndpoint());
 			}
@@ -2927,11 +2998,22 @@ ACTOR Future<Void> dbInfoUpdater(ClusterControllerData* self) {
 		dbInfoChange = self->db.serverInfo->onChange();
 		updateDBInfo = self->updateDBInfo.onTrigger();
 
-		req.serializedDbInfo =
-		    BinaryWriter::toValue(self->db.serverInfo->get(), AssumeVersion(g_network->protocolVersion()));
+		// Workers which were sent the last broadcast get a delta from it. Those which don't have it reply that they
+		// weren't updated and get the whole ServerDBInfo from the next broadcast, to only the workers not updated.
+		ServerDBInfo info = self->db.serverInfo->get();
+		if (SERVER_KNOBS->DBINFO_BROADCAST_DELTAS && allWorkers && lastBroadcastInfo.id.isValid() &&
+		    lastBroadcastInfo.clusterInterface == info.clusterInterface) {
+			req.deltaBaseID = lastBroadcastInfo.id;
+			req.unchangedFields = clearUnchangedDBInfoFields(info, lastBroadcastInfo);
+		}
+		lastBroadcastInfo = self->db.serverInfo->get();
+		req.serializedDbInfo = BinaryWriter::toValue(info, AssumeVersion(g_network->protocolVersion()));
 
 		TraceEvent("DBInfoStartBroadcast", self->id)
-		    .detail("MasterLifetime", self->db.serverInfo->get().masterLifetime.toString());
+		    .detail("MasterLifetime", self->db.serverInfo->get().masterLifetime.toString())
+		    .detail("DeltaBaseID", req.deltaBaseID)
+		    .detail("UnchangedFields", req.unchangedFields)
+		    .detail("Bytes", req.serializedDbInfo.size());
 		choose {
 			when(std::vector<Endpoint> notUpdated =
 			         wait(broadcastDBInfoRequest(req, SERVER_KNOBS->DBINFO_SEND_AMOUNT, Optional<Endpoint>(), false))) {
@@ -3161,6 +3243,9 @@ ACTOR Future<Void> clusterControllerCore(ClusterControllerFullInterface interf,
 	self.addActor.send(updatedChangingDatacenters(&self));
 	self.addActor.send(updatedChangedDatacenters(&self));
 	self.addActor.send(updateDatacenterVersionDifference(&self));
+	if (SERVER_KNOBS->CC_STANDBY_RECRUITMENT) {
+		self.addActor.send(maintainStandbyRecruitment(&self));
+	}
 	self.addActor.send(handleForcedRecoveries(&self, interf));
 	self.addActor.send(handleTriggerAuditStorage(&self, interf));
 	self.addActor.send(monitorDataDistributor(&self));
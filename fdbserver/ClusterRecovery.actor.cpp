@@ -26,6 +26,7 @@
 #include "fdbserver/ClusterRecovery.actor.h"
 #include "fdbserver/Knobs.h"
 #include "fdbserver/MasterInterface.h"
+#include "fdbserver/TxnStateSnapshot.h"
 #include "fdbserver/WaitFailure.h"
 #include "flow/ProtocolVersion.h"
 
@@ -938,6 +939,44 @@ ACTOR Future<Standalone<CommitTransactionRef>> provisionalMaster(Reference<Clust
 	}
 }
 
+// Returns the number of log routers to recruit for the old generations of prevDBState
+static int getMaxOldLogRouters(DBCoreState const& prevDBState) {
+	// FIXME: we only need log routers for the same locality as the master
+	int maxLogRouters = prevDBState.logRouterTags;
+	for (auto& old : prevDBState.oldTLogData) {
+		maxLogRouters = std::max(maxLogRouters, old.logRouterTags);
+	}
+	return maxLogRouters;
+}
+
+// Returns the workers of the recruitment started when recovery began if it has finished and can be used to recruit
+// for req. The early recruitment is discarded either way.
+static Optional<RecruitFromConfigurationReply> takeEarlyRecruitment(Reference<ClusterRecoveryData> self,
+                                                                    RecruitFromConfigurationRequest const& req) {
+	if (!self->earlyRecruitment) {
+		return Optional<RecruitFromConfigurationReply>();
+	}
+	Reference<RecruitWorkersInfo> early = self->earlyRecruitment;
+	Future<Void> done = self->earlyRecruitmentDone;
+	self->earlyRecruitment = Reference<RecruitWorkersInfo>();
+	self->earlyRecruitmentDone = Future<Void>();
+
+	std::string reason;
+	if (!done.isReady() || done.isError()) {
+		reason = "NotReady";
+	} else {
+		self->controllerData->canUseEarlierRecruitment(early->req, early->rep, req, reason);
+	}
+	TraceEvent("EarlyRecruitment", self->dbgid)
+	    .detail("Used", reason.empty())
+	    .detail("Reason", reason)
+	    .detail("Age", now() - self->earlyRecruitmentStartTime);
+	if (!reason.empty()) {
+		return Optional<RecruitFromConfigurationReply>();
+	}
+	return early->rep;
+}
+
 ACTOR Future<std::vector<Standalone<CommitTransactionRef>>> recruitEverything(
     Reference<ClusterRecoveryData> self,
     std::vector<StorageServerInterface>* seedServers,
@@ -982,16 +1021,22 @@ ACTOR Future<std::vector<Standalone<CommitTransactionRef>>> recruitEverything(
 		}
 	}
 
-	// FIXME: we only need log routers for the same locality as the master
-	int maxLogRouters = self->cstate.prevDBState.logRouterTags;
-	for (auto& old : self->cstate.prevDBState.oldTLogData) {
-		maxLogRouters = std::max(maxLogRouters, old.logRouterTags);
-	}
-
-	RecruitFromConfigurationRequest recruitReq(self->configuration, self->lastEpochEnd == 0, maxLogRouters);
+	RecruitFromConfigurationRequest recruitReq(
+	    self->configuration, self->lastEpochEnd == 0, getMaxOldLogRouters(self->cstate.prevDBState));
 	state Reference<RecruitWorkersInfo> recruitWorkersInfo = makeReference<RecruitWorkersInfo>(recruitReq);
 	recruitWorkersInfo->dbgId = self->dbgid;
-	wait(clusterRecruitFromConfiguration(self->controllerData, recruitWorkersInfo));
+	state double recruitStartTime = now();
+	state Optional<RecruitFromConfigurationReply> standby = self->controllerData->takeStandbyRecruitment(recruitReq);
+	state Optional<RecruitFromConfigurationReply> early = takeEarlyRecruitment(self, recruitReq);
+	if (standby.present()) {
+		CODE_PROBE(true, "Recovery uses the standby recruitment");
+		recruitWorkersInfo->rep = standby.get();
+	} else if (early.present()) {
+		CODE_PROBE(true, "Recovery uses the early recruitment");
+		recruitWorkersInfo->rep = early.get();
+	} else {
+		wait(clusterRecruitFromConfiguration(self->controllerData, recruitWorkersInfo));
+	}
 	state RecruitFromConfigurationReply recruits = recruitWorkersInfo->rep;
 
 	std::string primaryDcIds, remoteDcIds;
@@ -1034,6 +1079,9 @@ ACTOR Future<std::vector<Standalone<CommitTransactionRef>>> recruitEverything(
 	    .detail("BackupWorkers", self->backupWorkers.size())
 	    .detail("PrimaryDcIds", primaryDcIds)
 	    .detail("RemoteDcIds", remoteDcIds)
+	    .detail("StandbyRecruitment", standby.present())
+	    .detail("EarlyRecruitment", early.present())
+	    .detail("RecruitmentDuration", now() - recruitStartTime)
 	    .trackLatest(self->clusterRecoveryStateEventHolder->trackingKey);
 
 	// Actually, newSeedServers does both the recruiting and initialization of the seed servers; so if this is a brand
@@ -1041,8 +1089,15 @@ ACTOR Future<std::vector<Standalone<CommitTransactionRef>>> recruitEverything(
 	// up so that the recruitment part happens above (in parallel with recruiting the transaction servers?).
 	wait(newSeedServers(self, recruits, seedServers));
 	state std::vector<Standalone<CommitTransactionRef>> confChanges;
+	state double initStartTime = now();
 	wait(newCommitProxies(self, recruits) && newGrvProxies(self, recruits) && newResolvers(self, recruits) &&
 	     newTLogServers(self, recruits, oldLogSystem, &confChanges));
+	TraceEvent("RecoveryInternal", self->dbgid)
+	    .detail("StatusCode", RecoveryStatus::initializing_transaction_servers)
+	    .detail("Status", RecoveryStatus::names[RecoveryStatus::initializing_transaction_servers])
+	    .detail("Step", "InitializedTransactionServers")
+	    .detail("StandbyRecruitment", standby.present())
+	    .detail("Duration", now() - initStartTime);
 
 	// Update recovery related information to the newly elected sequencer (master) process.
 	wait(brokenPromiseToNever(
@@ -1264,6 +1319,11 @@ ACTOR Future<Void> sendInitialCommitToResolvers(Reference<ClusterRecoveryData> s
 	        .get();
 	state std::vector<Future<Void>> txnReplies;
 	state int64_t dataOutstanding = 0;
+	state CompressionFilter filter = getTxnStateSnapshotCompressionFilter();
+	state double startTime = now();
+	state double encodeSeconds = 0;
+	state int64_t bytes = 0;
+	state int64_t sentBytes = 0;
 
 	state std::vector<Endpoint> endpoints;
 	for (auto& it : self->commitProxies) {
@@ -1285,13 +1345,23 @@ ACTOR Future<Void> sendInitialCommitToResolvers(Reference<ClusterRecoveryData> s
 		        .get();
 
 		TxnStateRequest req;
-		req.arena = data.arena();
-		req.data = data;
+		if (SERVER_KNOBS->TXN_STATE_SNAPSHOT_ENCODING) {
+			const double encodeStart = timer();
+			Standalone<StringRef> snapshot = encodeTxnStateSnapshot(data, filter);
+			encodeSeconds += timer() - encodeStart;
+			req.arena = snapshot.arena();
+			req.snapshot = snapshot;
+		} else {
+			req.arena = data.arena();
+			req.data = data;
+		}
 		req.sequence = txnSequence;
 		req.last = !nextData.size();
 		req.broadcastInfo = endpoints;
 		txnReplies.push_back(broadcastTxnRequest(req, SERVER_KNOBS->TXN_STATE_SEND_AMOUNT, false));
-		dataOutstanding += SERVER_KNOBS->TXN_STATE_SEND_AMOUNT * data.arena().getSize();
+		dataOutstanding += SERVER_KNOBS->TXN_STATE_SEND_AMOUNT * req.arena.getSize();
+		bytes += data.expectedSize();
+		sentBytes += req.arena.getSize();
 		data = nextData;
 		txnSequence++;
 
@@ -1309,8 +1379,16 @@ ACTOR Future<Void> sendInitialCommitToResolvers(Reference<ClusterRecoveryData> s
 	    .detail("Status", RecoveryStatus::names[RecoveryStatus::recovery_transaction])
 	    .detail("RecoveryTxnVersion", self->recoveryTransactionVersion)
 	    .detail("LastEpochEnd", self->lastEpochEnd)
-	    .detail("Step", "SentTxnStateStoreToCommitProxies");
-
+	    .detail("Step", "SentTxnStateStoreToCommitProxies")
+	    .detail("Parts", txnSequence)
+	    .detail("Bytes", bytes)
+	    .detail("SentBytes", sentBytes)
+	    .detail("Encoded", SERVER_KNOBS->TXN_STATE_SNAPSHOT_ENCODING)
+	    .detail("Filter", CompressionUtils::toString(filter))
+	    .detail("EncodeSeconds", encodeSeconds)
+	    .detail("Duration", now() - startTime);
+
+	state double resolverStartTime = now();
 	std::vector<Future<ResolveTransactionBatchReply>> replies;
 	for (auto& r : self->resolvers) {
 		ResolveTransactionBatchRequest req;
@@ -1327,7 +1405,8 @@ ACTOR Future<Void> sendInitialCommitToResolvers(Reference<ClusterRecoveryData> s
 	    .detail("Status", RecoveryStatus::names[RecoveryStatus::recovery_transaction])
 	    .detail("RecoveryTxnVersion", self->recoveryTransactionVersion)
 	    .detail("LastEpochEnd", self->lastEpochEnd)
-	    .detail("Step", "InitializedAllResolvers");
+	    .detail("Step", "InitializedAllResolvers")
+	    .detail("Duration", now() - resolverStartTime);
 	return Void();
 }
 
@@ -1546,6 +1625,18 @@ ACTOR Future<Void> clusterRecoveryCore(Reference<ClusterRecoveryData> self) {
 		}
 	}
 
+	// Recruiting only depends on the configuration, which rarely changes across recoveries, so start it from the
+	// cluster controller's configuration rather than after reading the configuration from the old TLogs
+	if (SERVER_KNOBS->RECOVERY_EARLY_RECRUITMENT && !self->cstate.prevDBState.tLogs.empty() &&
+	    self->controllerData->db.config.isValid()) {
+		self->earlyRecruitment = makeReference<RecruitWorkersInfo>(RecruitFromConfigurationRequest(
+		    self->controllerData->db.config, false, getMaxOldLogRouters(self->cstate.prevDBState)));
+		self->earlyRecruitment->dbgId = self->dbgid;
+		self->earlyRecruitmentDone = clusterRecruitFromConfiguration(self->controllerData, self->earlyRecruitment);
+		self->earlyRecruitmentStartTime = now();
+	}
+
+	state double lockStartTime = now();
 	state Reference<AsyncVar<Reference<ILogSystem>>> oldLogSystems(new AsyncVar<Reference<ILogSystem>>);
 	state Future<Void> recoverAndEndEpoch =
 	    ILogSystem::recoverAndEndEpoch(oldLogSystems,
@@ -1565,6 +1656,12 @@ ACTOR Future<Void> clusterRecoveryCore(Reference<ClusterRecoveryData> self) {
 		newState.lowestCompatibleProtocolVersion = minCompatibleProtocolVersion;
 	}
 	wait(self->cstate.write(newState) || recoverAndEndEpoch);
+	TraceEvent("RecoveryInternal", self->dbgid)
+	    .detail("StatusCode", RecoveryStatus::locking_coordinated_state)
+	    .detail("Status", RecoveryStatus::names[RecoveryStatus::locking_coordinated_state])
+	    .detail("Step", "WroteCoordinatedState")
+	    .detail("OldTLogsLocked", oldLogSystems->get().isValid())
+	    .detail("Duration", now() - lockStartTime);
 
 	TraceEvent("ProtocolVersionCompatibilityChecked", self->dbgid)
 	    .detail("NewestProtocolVersion", self->cstate.myDBState.newestProtocolVersion)
@@ -1583,6 +1680,12 @@ ACTOR Future<Void> clusterRecoveryCore(Reference<ClusterRecoveryData> self) {
 		Reference<ILogSystem> oldLogSystem = oldLogSystems->get();
 		if (oldLogSystem) {
 			logChanges = triggerUpdates(self, oldLogSystem);
+			TraceEvent("RecoveryInternal", self->dbgid)
+			    .detail("StatusCode", RecoveryStatus::reading_transaction_system_state)
+			    .detail("Status", RecoveryStatus::names[RecoveryStatus::reading_transaction_system_state])
+			    .detail("Step", "LockedOldTLogs")
+			    .detail("End", oldLogSystem->getEnd())
+			    .detail("Duration", now() - lockStartTime);
 			if (!minRecoveryDuration.isValid()) {
 				minRecoveryDuration = delay(SERVER_KNOBS->ENFORCED_MIN_RECOVERY_DURATION);
 				poppedTxsVersion = oldLogSystem->getTxsPoppedVersion();
@@ -58,6 +58,7 @@
 #include "fdbserver/RecoveryState.h"
 #include "fdbserver/RestoreUtil.h"
 #include "fdbserver/ServerDBInfo.actor.h"
+#include "fdbserver/TxnStateSnapshot.h"
 #include "fdbserver/WaitFailure.h"
 #include "fdbserver/WorkerInterface.actor.h"
 #include "flow/ActorCollection.h"
@@ -65,7 +66,9 @@
 #include "flow/EncryptUtils.h"
 #include "flow/Error.h"
 #include "flow/IRandom.h"
+#include "flow/IThreadPool.h"
 #include "flow/Knobs.h"
+#include "flow/ThreadHelper.actor.h"
 #include "flow/Trace.h"
 #include "flow/network.h"
 
@@ -262,10 +265,61 @@ struct ResolutionRequestBuilder {
 	}
 };
 
-bool checkTenantNoWait(ProxyCommitData* commitData, int64_t tenant, const char* context, bool logOnFailure) {
+// The tenants of a commit batch, looked up in tenantMap and lockedTenants once per distinct tenant rather than once per
+// transaction. The lookups are kept in a sorted array, which is only used while the proxy's tenantMapGeneration is
+// unchanged, i.e., until a transaction of the batch changes the tenant map.
+class BatchTenants {
+public:
+	struct Entry {
+		int64_t id;
+		bool exists;
+		bool locked;
+	};
+
+	BatchTenants(const ProxyCommitData* commitData, const std::vector<CommitTransactionRequest>& trs)
+	  : generation(commitData->tenantMapGeneration) {
+		std::vector<int64_t> ids;
+		for (const auto& tr : trs) {
+			if (tr.tenantInfo.tenantId != TenantInfo::INVALID_TENANT) {
+				ids.push_back(tr.tenantInfo.tenantId);
+			}
+		}
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+		entries.reserve(ids.size());
+		for (int64_t id : ids) {
+			Entry& entry = entries.emplace_back();
+			entry.id = id;
+			entry.exists = commitData->tenantMap.count(id) > 0;
+			entry.locked = entry.exists && commitData->lockedTenants.count(id) > 0;
+		}
+	}
+
+	// Returns the lookup of tenant, or nullptr if it has to be looked up in commitData because the tenant map has
+	// changed since the batch was looked up or tenant is not in the batch
+	const Entry* find(const ProxyCommitData* commitData, int64_t tenant) const {
+		if (commitData->tenantMapGeneration != generation) {
+			return nullptr;
+		}
+		auto itr = std::lower_bound(
+		    entries.begin(), entries.end(), tenant, [](const Entry& e, int64_t id) { return e.id < id; });
+		return itr != entries.end() && itr->id == tenant ? &*itr : nullptr;
+	}
+
+private:
+	uint64_t generation;
+	std::vector<Entry> entries;
+};
+
+bool checkTenantNoWait(ProxyCommitData* commitData,
+                       int64_t tenant,
+                       const char* context,
+                       bool logOnFailure,
+                       const BatchTenants* batch = nullptr) {
 	if (tenant != TenantInfo::INVALID_TENANT) {
-		auto itr = commitData->tenantMap.find(tenant);
-		if (itr == commitData->tenantMap.end()) {
+		const BatchTenants::Entry* entry = batch ? batch->find(commitData, tenant) : nullptr;
+		if (entry ? !entry->exists : commitData->tenantMap.find(tenant) == commitData->tenantMap.end()) {
 			if (logOnFailure) {
 				TraceEvent(SevWarn, "CommitProxyTenantNotFound", commitData->dbgid)
 				    .detail("Tenant", tenant)
@@ -371,6 +425,18 @@ bool verifyTenantPrefix(ProxyCommitData* const commitData, const CommitTransacti
 	return true;
 }
 
+// Restores the mutations of a request sent with compressed mutations, or replies with an error and returns false
+static bool decompressMutations(ProxyCommitData* commitData, CommitTransactionRequest& req) {
+	try {
+		req.decompressMutations();
+		return true;
+	} catch (Error& e) {
+		++commitData->stats.txnCommitErrors;
+		req.reply.sendError(e);
+		return false;
+	}
+}
+
 ACTOR Future<Void> commitBatcher(ProxyCommitData* commitData,
                                  PromiseStream<std::pair<std::vector<CommitTransactionRequest>, int>> out,
                                  FutureStream<CommitTransactionRequest> in,
@@ -398,6 +464,10 @@ ACTOR Future<Void> commitBatcher(ProxyCommitData* commitData,
 			choose {
 				when(CommitTransactionRequest req = waitNext(in)) {
 					// WARNING: this code is run at a high priority, so it needs to do as little work as possible
+					if (req.compressedMutations.present() &&
+					    !decompressMutations(commitData, const_cast<CommitTransactionRequest&>(req))) {
+						continue;
+					}
 					int bytes = getBytes(req);
 
 					// Drop requests if memory is under severe pressure
@@ -625,6 +695,87 @@ ACTOR static Future<ResolveTransactionBatchReply> trackResolutionMetrics(Referen
 
 namespace CommitBatch {
 
+// Encrypting a batch's mutations only depends on its resolution and cipher keys, not on the batches before it. It is
+// started as soon as the batch is resolved and split into parts, each encrypted on a helper thread with
+// PROXY_ENCRYPTION_THREADS set, while the proxy thread may still be assigning the previous batch's mutations to
+// storage servers. assignMutationsToStorageServers() then finds the results in the requests' encryptedMutations.
+//
+// A part has one cipher context per encryption domain, set to a new IV for each mutation rather than created and keyed
+// again, and serializes its mutations into a single buffer which they are encrypted in place in.
+//
+// Flow reference counts are not thread safe, so everything a helper thread touches is set up by the proxy thread, and
+// the helper thread's reference is released back on the proxy thread.
+struct PreEncryptedMutations : ReferenceCounted<PreEncryptedMutations>, NonCopyable {
+	struct Pending {
+		int transaction;
+		int index;
+		MutationRef mutation;
+		EncryptBlobCipherAes265Ctr* cipher;
+		uint8_t iv[AES_256_IV_LENGTH];
+		MutationRef encrypted;
+	};
+
+	// Depends on the source requests' arenas and holds the encrypted mutations
+	Arena arena;
+	std::unordered_map<EncryptCipherDomainId, std::unique_ptr<EncryptBlobCipherAes265Ctr>> ciphers;
+	std::vector<Pending> mutations;
+	// Upper bound of the serialized size of mutations
+	int bytes = 0;
+	Optional<Error> error;
+
+	// Mirrors MutationRef::encrypt(), with the IVs picked up front
+	void encrypt() {
+		try {
+			BinaryWriter bw(AssumeVersion(ProtocolVersion::withEncryptionAtRest()));
+			bw.reserve(bytes);
+			std::vector<int> ends;
+			ends.reserve(mutations.size());
+			for (auto& p : mutations) {
+				bw << p.mutation;
+				ends.push_back(bw.getLength());
+			}
+			Standalone<StringRef> buf = bw.toValue();
+			arena.dependsOn(buf.arena());
+
+			int begin = 0;
+			for (int i = 0; i < mutations.size(); i++) {
+				Pending& p = mutations[i];
+				uint8_t* plaintext = mutateString(buf) + begin;
+				const int len = ends[i] - begin;
+				p.cipher->setIV(p.iv, AES_256_IV_LENGTH);
+				BlobCipherEncryptHeaderRef header;
+				p.cipher->encryptInplace(plaintext, len, &header);
+				Standalone<StringRef> serializedHeader = BlobCipherEncryptHeaderRef::toStringRef(header);
+				arena.dependsOn(serializedHeader.arena());
+				p.encrypted = MutationRef(MutationRef::Encrypted, serializedHeader, StringRef(plaintext, len));
+				begin = ends[i];
+			}
+		} catch (Error& e) {
+			error = e;
+		}
+	}
+};
+
+class MutationEncryptor final : public IThreadPoolReceiver {
+public:
+	void init() override {}
+
+	struct EncryptAction final : TypedAction<MutationEncryptor, EncryptAction> {
+		Reference<PreEncryptedMutations> work;
+		ThreadReturnPromise<Void> done;
+
+		explicit EncryptAction(Reference<PreEncryptedMutations> work) : work(std::move(work)) {}
+		double getTimeEstimate() const override { return 0; }
+	};
+
+	void action(EncryptAction& a) {
+		a.work->encrypt();
+		PreEncryptedMutations* work = a.work.extractPtr();
+		a.done.send(Void());
+		onMainThreadVoid([work]() { work->delref(); });
+	}
+};
+
 struct CommitBatchContext {
 	using StoreCommit_t = std::vector<std::pair<Future<LogSystemDiskQueueAdapter::CommitMessage>, Future<Void>>>;
 
@@ -669,6 +820,12 @@ struct CommitBatchContext {
 	double computeStart;
 	double computeDuration = 0;
 
+	// Time spent waiting on the resolvers, on the tlogs, and whether post resolution processing had to wait for the
+	// previous batch; fed to the commit batching interval controller
+	double resolutionDuration = 0;
+	double loggingDuration = 0;
+	bool queuedPostResolution = false;
+
 	Arena arena;
 
 	/// true if the batch is the 1st batch for this proxy, additional metadata
@@ -715,6 +872,16 @@ struct CommitBatchContext {
 	// Cipher keys to be used to encrypt mutations
 	std::unordered_map<EncryptCipherDomainId, Reference<BlobCipherKey>> cipherKeys;
 
+	// Mutations being encrypted ahead of assignMutationsToStorageServers(), see PreEncryptedMutations
+	std::vector<Reference<PreEncryptedMutations>> preEncrypted;
+	std::vector<Future<Void>> preEncryptedReady;
+
+	// Tags of the committed single key mutations, looked up in key order by lookupBatchKeyTags(). The entry for
+	// mutation m of transaction t is keyTags[keyTagsOffset[t] + m]; nullptr for other mutations.
+	std::vector<const std::vector<Tag>*> keyTags;
+	std::vector<int> keyTagsOffset;
+	uint64_t keyTagsGeneration = 0;
+
 	IdempotencyIdKVBuilder idempotencyKVBuilder;
 
 	CommitBatchContext(ProxyCommitData*, const std::vector<CommitTransactionRequest>*, const int);
@@ -725,6 +892,8 @@ struct CommitBatchContext {
 
 	void checkHotShards();
 
+	void checkStorageWriteBudgets();
+
 private:
 	void evaluateBatchSize();
 };
@@ -782,6 +951,63 @@ void CommitBatchContext::checkHotShards() {
 	return;
 }
 
+// Rejects each transaction that writes to storage servers with a write budget with a probability of one minus the
+// smallest of their budgets, so that only the transactions writing to lagging storage teams are throttled
+void CommitBatchContext::checkStorageWriteBudgets() {
+	if (now() > pProxyCommitData->storageWriteBudgetsExpiration) {
+		pProxyCommitData->storageWriteBudgets.clear();
+		return;
+	}
+
+	auto budgetOf = [this](ServerCacheInfo const& info) {
+		double budget = 1.0;
+		for (const auto* servers : { &info.src_info, &info.dest_info }) {
+			for (const auto& server : *servers) {
+				auto it = pProxyCommitData->storageWriteBudgets.find(server->interf.id());
+				if (it != pProxyCommitData->storageWriteBudgets.end()) {
+					budget = std::min(budget, it->second);
+				}
+			}
+		}
+		return budget;
+	};
+
+	auto trsBegin = trs.begin();
+	std::vector<size_t> transactionsToRemove;
+	for (int transactionNum = 0; transactionNum < trs.size(); transactionNum++) {
+		VectorRef<MutationRef>* pMutations = &trs[transactionNum].transaction.mutations;
+		double budget = 1.0;
+		bool systemMutation = false;
+		for (int mutationNum = 0; mutationNum < pMutations->size() && !systemMutation; mutationNum++) {
+			auto& m = (*pMutations)[mutationNum];
+			if (isSingleKeyMutation((MutationRef::Type)m.type)) {
+				systemMutation = m.param1 >= systemKeys.begin;
+				budget = std::min(budget, budgetOf(pProxyCommitData->cachedRangeContaining(m.param1).value()));
+			} else if (m.type == MutationRef::ClearRange) {
+				systemMutation = m.param2 > systemKeys.begin;
+				for (auto r : pProxyCommitData->keyInfo.intersectingRanges(KeyRangeRef(m.param1, m.param2))) {
+					budget = std::min(budget, budgetOf(r.value()));
+				}
+			} else {
+				UNREACHABLE();
+			}
+		}
+		// Metadata changes are never throttled, since recovering a lagging storage server may depend on them
+		if (!systemMutation && budget < 1.0 && deterministicRandom()->random01() >= budget) {
+			trs[transactionNum].reply.sendError(transaction_throttled_hot_shard());
+			transactionsToRemove.push_back(transactionNum);
+		}
+	}
+	if (transactionsToRemove.empty()) {
+		return;
+	}
+	CODE_PROBE(true, "Transactions throttled by storage write budgets");
+	for (auto it = transactionsToRemove.rbegin(); it != transactionsToRemove.rend(); ++it) {
+		trs.erase(trsBegin + *it);
+	}
+	committed.resize(trs.size());
+}
+
 std::set<Tag> CommitBatchContext::getWrittenTagsPreResolution() {
 	std::set<Tag> transactionTags;
 	std::vector<Tag> cacheVector = { cacheTag };
@@ -960,6 +1186,10 @@ ACTOR Future<Void> preresolutionProcessing(CommitBatchContext* self) {
 		self->checkHotShards();
 	}
 
+	if (!pProxyCommitData->storageWriteBudgets.empty()) {
+		self->checkStorageWriteBudgets();
+	}
+
 	GetCommitVersionRequest req(span.context,
 	                            pProxyCommitData->commitVersionRequestNumber++,
 	                            pProxyCommitData->mostRecentProcessedRequestNumber,
@@ -1127,7 +1357,8 @@ ACTOR Future<Void> getResolution(CommitBatchContext* self) {
 	std::vector<ResolveTransactionBatchReply> resolutionResp = wait(getAll(replies));
 	self->resolution.swap(*const_cast<std::vector<ResolveTransactionBatchReply>*>(&resolutionResp));
 
-	self->pProxyCommitData->stats.resolutionDist->sampleSeconds(g_network->timer_monotonic() - resolutionStart);
+	self->resolutionDuration = g_network->timer_monotonic() - resolutionStart;
+	self->pProxyCommitData->stats.resolutionDist->sampleSeconds(self->resolutionDuration);
 	if (self->debugID.present()) {
 		g_traceBatch.addEvent(
 		    "CommitDebug", self->debugID.get().first(), "CommitProxyServer.commitBatch.AfterResolution");
@@ -1526,12 +1757,15 @@ Error validateAndProcessTenantAccess(Arena& arena,
 // If the validation success, return the list of tenant Ids referred by the transaction via tenantIds.
 Error validateAndProcessTenantAccess(CommitTransactionRequest& tr,
                                      ProxyCommitData* const pProxyCommitData,
-                                     std::unordered_set<int64_t>& rawAccessTenantIds) {
-	bool isValid = checkTenantNoWait(pProxyCommitData, tr.tenantInfo.tenantId, "Commit", true);
+                                     std::unordered_set<int64_t>& rawAccessTenantIds,
+                                     const BatchTenants* batch = nullptr) {
+	bool isValid = checkTenantNoWait(pProxyCommitData, tr.tenantInfo.tenantId, "Commit", true, batch);
 	if (!isValid) {
 		return tenant_not_found();
 	}
-	if (!tr.isLockAware() && pProxyCommitData->lockedTenants.count(tr.tenantInfo.tenantId) > 0) {
+	const BatchTenants::Entry* entry = batch ? batch->find(pProxyCommitData, tr.tenantInfo.tenantId) : nullptr;
+	if (!tr.isLockAware() &&
+	    (entry ? entry->locked : pProxyCommitData->lockedTenants.count(tr.tenantInfo.tenantId) > 0)) {
 		CODE_PROBE(true, "Attempt access to locked tenant without lock awareness");
 		return tenant_locked();
 	}
@@ -1689,10 +1923,11 @@ ACTOR Future<Void> applyMetadataToCommittedTransactions(CommitBatchContext* self
 	state ProxyCommitData* const pProxyCommitData = self->pProxyCommitData;
 	state std::unordered_set<int64_t> rawAccessTenantIds;
 	auto& trs = self->trs;
+	BatchTenants batchTenants(pProxyCommitData, trs);
 
 	int t;
 	for (t = 0; t < trs.size() && !self->forceRecovery; t++) {
-		Error e = validateAndProcessTenantAccess(trs[t], pProxyCommitData, rawAccessTenantIds);
+		Error e = validateAndProcessTenantAccess(trs[t], pProxyCommitData, rawAccessTenantIds, &batchTenants);
 		if (e.code() != error_code_success) {
 			trs[t].reply.sendError(e);
 			self->committed[t] = ConflictBatch::TransactionTenantFailure;
@@ -1983,12 +2218,217 @@ void addAccumulativeChecksumMutations(CommitBatchContext* self) {
 
 /// This second pass through committed transactions assigns the actual mutations to the appropriate storage servers'
 /// tags
+// Starts encrypting the mutations of the transactions that the resolvers committed, see PreEncryptedMutations.
+// Transactions whose encryption domain is only known after applying metadata (raw access) are left to
+// assignMutationsToStorageServers().
+void startMutationEncryption(CommitBatchContext* self) {
+	ProxyCommitData* const pProxyCommitData = self->pProxyCommitData;
+	const int parts = SERVER_KNOBS->PROXY_ENCRYPTION_THREADS;
+	if (parts <= 0 || !pProxyCommitData->encryptMode.isEncryptionEnabled()) {
+		return;
+	}
+
+	Reference<BlobCipherKey> headerCipherKey;
+	if (FLOW_KNOBS->ENCRYPT_HEADER_AUTH_TOKEN_ENABLED) {
+		auto it = self->cipherKeys.find(ENCRYPT_HEADER_DOMAIN_ID);
+		if (it == self->cipherKeys.end()) {
+			return;
+		}
+		headerCipherKey = it->second;
+	}
+
+	std::vector<Reference<PreEncryptedMutations>> work;
+	for (int i = 0; i < parts; i++) {
+		work.push_back(makeReference<PreEncryptedMutations>());
+	}
+
+	std::vector<int> nextTr(self->resolution.size());
+	int nextPart = 0;
+	for (int t = 0; t < self->trs.size(); t++) {
+		uint8_t commit = ConflictBatch::TransactionCommitted;
+		for (int r : self->transactionResolverMap[t]) {
+			commit = std::min(self->resolution[r].committed[nextTr[r]++], commit);
+		}
+		const CommitTransactionRef& tr = self->trs[t].transaction;
+		if (commit != ConflictBatch::TransactionCommitted || !tr.encryptedMutations.empty() || tr.mutations.empty()) {
+			continue;
+		}
+
+		// Same domain selection as assignMutationsToStorageServers()
+		int64_t encryptDomain = self->trs[t].tenantInfo.tenantId;
+		if (pProxyCommitData->encryptMode.mode == EncryptionAtRestMode::CLUSTER_AWARE &&
+		    encryptDomain != SYSTEM_KEYSPACE_ENCRYPT_DOMAIN_ID) {
+			encryptDomain = FDB_DEFAULT_ENCRYPT_DOMAIN_ID;
+		}
+		auto textCipherKey = self->cipherKeys.find(encryptDomain);
+		if (encryptDomain == INVALID_ENCRYPT_DOMAIN_ID || textCipherKey == self->cipherKeys.end()) {
+			continue;
+		}
+
+		Reference<PreEncryptedMutations>& part = work[nextPart++ % parts];
+		part->arena.dependsOn(self->trs[t].arena);
+		std::unique_ptr<EncryptBlobCipherAes265Ctr>& cipher = part->ciphers[encryptDomain];
+		if (!cipher) {
+			cipher = std::make_unique<EncryptBlobCipherAes265Ctr>(
+			    textCipherKey->second,
+			    headerCipherKey,
+			    getEncryptAuthTokenMode(EncryptAuthTokenMode::ENCRYPT_HEADER_AUTH_TOKEN_MODE_SINGLE),
+			    BlobCipherMetrics::TLOG);
+		}
+		for (int m = 0; m < tr.mutations.size(); m++) {
+			if (tr.mutations[m].type == MutationRef::NoOp) {
+				continue;
+			}
+			PreEncryptedMutations::Pending& p = part->mutations.emplace_back();
+			p.transaction = t;
+			p.index = m;
+			p.mutation = tr.mutations[m];
+			p.cipher = cipher.get();
+			deterministicRandom()->randomBytes(p.iv, AES_256_IV_LENGTH);
+			// The type, the lengths of the params and a checksum
+			part->bytes += p.mutation.expectedSize() + 16;
+		}
+	}
+
+	for (auto& part : work) {
+		if (part->mutations.empty()) {
+			continue;
+		}
+		if (!pProxyCommitData->encryptionThreads ||
+		    part->mutations.size() < SERVER_KNOBS->PROXY_ENCRYPTION_THREAD_MIN_MUTATIONS) {
+			// Small parts aren't worth handing off to another thread, and simulation runs the same path inline
+			part->encrypt();
+			self->preEncryptedReady.push_back(Void());
+		} else {
+			auto action = new MutationEncryptor::EncryptAction(part);
+			self->preEncryptedReady.push_back(action->done.getFuture());
+			pProxyCommitData->encryptionThreads->post(action);
+		}
+		self->preEncrypted.push_back(part);
+	}
+}
+
+static bool isSameMutation(const MutationRef& a, const MutationRef& b) {
+	return a.type == b.type && a.param1.begin() == b.param1.begin() && a.param1.size() == b.param1.size() &&
+	       a.param2.begin() == b.param2.begin() && a.param2.size() == b.param2.size();
+}
+
+// Stores the results of startMutationEncryption() in the requests' encryptedMutations. Mutations that were rewritten
+// since encryption started (e.g. clear ranges split by tenant) are skipped and encrypted inline instead.
+void usePreEncryptedMutations(CommitBatchContext* self) {
+	for (const auto& part : self->preEncrypted) {
+		if (part->error.present()) {
+			TraceEvent(SevWarn, "ProxyPreEncryptionFailed", self->pProxyCommitData->dbgid).error(part->error.get());
+			continue;
+		}
+		int lastTransaction = -1;
+		for (const auto& p : part->mutations) {
+			CommitTransactionRequest& req = self->trs[p.transaction];
+			const VectorRef<MutationRef>& mutations = req.transaction.mutations;
+			VectorRef<Optional<MutationRef>>& encrypted = req.transaction.encryptedMutations;
+			if (p.index >= mutations.size() || !isSameMutation(mutations[p.index], p.mutation)) {
+				CODE_PROBE(true, "Pre-encrypted mutation rewritten after resolution");
+				continue;
+			}
+			if (encrypted.empty()) {
+				encrypted.resize(req.arena, mutations.size());
+			}
+			if (encrypted.size() != mutations.size()) {
+				continue;
+			}
+			encrypted[p.index] = p.encrypted;
+			if (p.transaction != lastTransaction) {
+				req.arena.dependsOn(part->arena);
+				lastTransaction = p.transaction;
+			}
+		}
+	}
+	self->preEncrypted.clear();
+	self->preEncryptedReady.clear();
+}
+
+// Looks up the tags of every committed single key mutation in key order, so that keyInfo is walked once from shard
+// to shard instead of being searched again for every mutation.
+void lookupBatchKeyTags(CommitBatchContext* self) {
+	ProxyCommitData* const pProxyCommitData = self->pProxyCommitData;
+	auto& trs = self->trs;
+
+	self->keyTags.clear();
+	self->keyTagsOffset.assign(trs.size(), 0);
+	std::vector<std::pair<StringRef, int>> keys;
+	int numMutations = 0;
+	for (int t = 0; t < trs.size(); t++) {
+		self->keyTagsOffset[t] = numMutations;
+		if (!(self->committed[t] == ConflictBatch::TransactionCommitted && (!self->locked || trs[t].isLockAware()))) {
+			continue;
+		}
+		const auto& mutations = trs[t].transaction.mutations;
+		for (int m = 0; m < mutations.size(); m++) {
+			if (isSingleKeyMutation((MutationRef::Type)mutations[m].type)) {
+				keys.emplace_back(mutations[m].param1, numMutations + m);
+			}
+		}
+		numMutations += mutations.size();
+	}
+	if (keys.empty()) {
+		return;
+	}
+	std::sort(keys.begin(), keys.end());
+
+	self->keyTags.assign(numMutations, nullptr);
+	self->keyTagsGeneration = pProxyCommitData->keyInfoGeneration;
+	const auto lastShard = pProxyCommitData->keyInfo.ranges().end();
+	auto shard = pProxyCommitData->cachedRangeContaining(keys[0].first);
+	shard->value().populateTags();
+	self->keyTags[keys[0].second] = &shard->value().tags;
+	for (int i = 1; i < keys.size(); i++) {
+		const auto& [key, index] = keys[i];
+		if (!(key < shard->end())) {
+			auto next = shard;
+			++next;
+			if (next != lastShard && key < next->end()) {
+				shard = next;
+				++pProxyCommitData->stats.keyTagBatchHits;
+			} else {
+				shard = pProxyCommitData->cachedRangeContaining(key);
+			}
+			shard->value().populateTags();
+		} else {
+			++pProxyCommitData->stats.keyTagBatchHits;
+		}
+		self->keyTags[index] = &shard->value().tags;
+	}
+	pProxyCommitData->stats.keyTagLookups += keys.size();
+}
+
+// Returns the tags of single key mutation mutationNum of the current transaction
+const std::vector<Tag>& tagsForMutation(CommitBatchContext* self, int mutationNum, StringRef key) {
+	if (self->keyTags.empty() || self->keyTagsGeneration != self->pProxyCommitData->keyInfoGeneration) {
+		++self->pProxyCommitData->stats.keyTagLookups;
+		auto shard = self->pProxyCommitData->cachedRangeContaining(key);
+		shard->value().populateTags();
+		return shard->value().tags;
+	}
+	const std::vector<Tag>* tags = self->keyTags[self->keyTagsOffset[self->transactionNum] + mutationNum];
+	ASSERT(tags != nullptr);
+	return *tags;
+}
+
 ACTOR Future<Void> assignMutationsToStorageServers(CommitBatchContext* self) {
 	state ProxyCommitData* const pProxyCommitData = self->pProxyCommitData;
 	state std::vector<CommitTransactionRequest>& trs = self->trs;
 	state double curEncryptionTime = 0;
 	state double totalEncryptionTime = 0;
 
+	if (!self->preEncryptedReady.empty()) {
+		wait(waitForAll(self->preEncryptedReady));
+		usePreEncryptedMutations(self);
+	}
+
+	if (SERVER_KNOBS->PROXY_SORTED_KEY_TAG_LOOKUP) {
+		lookupBatchKeyTags(self);
+	}
+
 	for (; self->transactionNum < trs.size(); self->transactionNum++) {
 		if (!(self->committed[self->transactionNum] == ConflictBatch::TransactionCommitted &&
 		      (!self->locked || trs[self->transactionNum].isLockAware()))) {
@@ -2036,7 +2476,7 @@ ACTOR Future<Void> assignMutationsToStorageServers(CommitBatchContext* self) {
 			// Determine the set of tags (responsible storage servers) for the mutation, splitting it
 			// if necessary.  Serialize (splits of) the mutation into the message buffer and add the tags.
 			if (isSingleKeyMutation((MutationRef::Type)m.type)) {
-				auto& tags = pProxyCommitData->tagsForKey(m.param1);
+				auto& tags = tagsForMutation(self, mutationNum, m.param1);
 
 				// sample single key mutation based on cost
 				// the expectation of sampling is every COMMIT_SAMPLE_COST sample once
@@ -2226,8 +2666,11 @@ ACTOR Future<Void> postResolution(CommitBatchContext* self) {
 	state const Optional<UID>& debugID = self->debugID;
 	state Span span("MP:postResolution"_loc, self->span.context);
 
+	startMutationEncryption(self);
+
 	bool queuedCommits = pProxyCommitData->latestLocalCommitBatchLogging.get() < localBatchNumber - 1;
 	CODE_PROBE(queuedCommits, "Queuing post-resolution commit processing");
+	self->queuedPostResolution = queuedCommits;
 	wait(pProxyCommitData->latestLocalCommitBatchLogging.whenAtLeast(localBatchNumber - 1));
 	state double postResolutionQueuing = g_network->timer_monotonic();
 	pProxyCommitData->stats.postResolutionDist->sampleSeconds(postResolutionQueuing - postResolutionStart);
@@ -2529,7 +2972,8 @@ ACTOR Future<Void> transactionLogging(CommitBatchContext* self) {
 		pProxyCommitData->txsPopVersions.emplace_back(self->commitVersion, self->msg.popTo);
 	}
 	pProxyCommitData->logSystem->popTxs(self->msg.popTo);
-	pProxyCommitData->stats.tlogLoggingDist->sampleSeconds(g_network->timer_monotonic() - tLoggingStart);
+	self->loggingDuration = g_network->timer_monotonic() - tLoggingStart;
+	pProxyCommitData->stats.tlogLoggingDist->sampleSeconds(self->loggingDuration);
 	return Void();
 }
 
@@ -2700,14 +3144,29 @@ ACTOR Future<Void> reply(CommitBatchContext* self) {
 	}
 
 	// Dynamic batching for commits
-	double target_latency =
-	    (now() - self->startTime) * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION;
-	pProxyCommitData->commitBatchInterval =
-	    std::max(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN,
-	             std::min(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MAX,
-	                      target_latency * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA +
-	                          pProxyCommitData->commitBatchInterval *
-	                              (1 - SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA)));
+	if (SERVER_KNOBS->COMMIT_BATCH_TARGET_P99_LATENCY > 0) {
+		auto& controller = pProxyCommitData->commitBatchIntervalController;
+		controller.addBatch(now() - self->startTime,
+		                    self->resolutionDuration + self->loggingDuration,
+		                    self->trs.size(),
+		                    self->queuedPostResolution);
+		const double interval = controller.update(now(), pProxyCommitData->commitBatchInterval);
+		if (interval != pProxyCommitData->commitBatchInterval) {
+			TraceEvent(SevDebug, "CommitBatchIntervalChanged", pProxyCommitData->dbgid)
+			    .detail("From", pProxyCommitData->commitBatchInterval)
+			    .detail("To", interval);
+			pProxyCommitData->commitBatchInterval = interval;
+		}
+	} else {
+		double target_latency =
+		    (now() - self->startTime) * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION;
+		pProxyCommitData->commitBatchInterval =
+		    std::max(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN,
+		             std::min(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MAX,
+		                      target_latency * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA +
+		                          pProxyCommitData->commitBatchInterval *
+		                              (1 - SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA)));
+	}
 
 	pProxyCommitData->stats.commitBatchingWindowSize.addMeasurement(pProxyCommitData->commitBatchInterval);
 	pProxyCommitData->commitBatchesMemBytesCount -= self->currentBatchMemBytesCount;
@@ -2719,6 +3178,30 @@ ACTOR Future<Void> reply(CommitBatchContext* self) {
 
 } // namespace CommitBatch
 
+TEST_CASE("/CommitProxy/CommitBatchIntervalController") {
+	const double interval = 0.005;
+	const double target = 0.1;
+	auto clamp = [](double i) {
+		return std::max(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN,
+		                std::min(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MAX, i));
+	};
+	const double grown = clamp(interval * SERVER_KNOBS->COMMIT_BATCH_INTERVAL_STEP);
+	const double shrunk = clamp(interval / SERVER_KNOBS->COMMIT_BATCH_INTERVAL_STEP);
+
+	// Missing the target: grow if the resolvers or tlogs are the bottleneck, otherwise stop waiting so long
+	ASSERT_EQ(CommitBatchIntervalController::nextInterval(interval, target, 0.2, 0.9, 0, 100), grown);
+	ASSERT_EQ(CommitBatchIntervalController::nextInterval(interval, target, 0.2, 0.1, 0.9, 100), grown);
+	ASSERT_EQ(CommitBatchIntervalController::nextInterval(interval, target, 0.2, 0.1, 0, 100), shrunk);
+
+	// Meeting the target: an idle proxy gains nothing from batching, a busy one batches more with latency to spare
+	ASSERT_EQ(CommitBatchIntervalController::nextInterval(interval, target, 0.01, 0.1, 0, 1), shrunk);
+	ASSERT_EQ(CommitBatchIntervalController::nextInterval(interval, target, 0.01, 0.1, 0, 100), grown);
+	ASSERT_EQ(CommitBatchIntervalController::nextInterval(interval, target, 0.08, 0.1, 0, 100), clamp(interval));
+	ASSERT_EQ(CommitBatchIntervalController::nextInterval(interval, target, 0.08, 0.9, 0, 100), grown);
+
+	return Void();
+}
+
 // Commit one batch of transactions trs
 ACTOR Future<Void> commitBatch(ProxyCommitData* self,
                                std::vector<CommitTransactionRequest>* trs,
@@ -3226,6 +3709,26 @@ ACTOR Future<Void> ddMetricsRequestServer(CommitProxyInterface proxy, Reference<
 	}
 }
 
+ACTOR Future<Void> ddHeatmapRequestServer(CommitProxyInterface proxy, Reference<AsyncVar<ServerDBInfo> const> db) {
+	loop {
+		state GetDDHeatmapRequest req = waitNext(proxy.getDDHeatmap.getFuture());
+		if (!db->get().distributor.present()) {
+			req.reply.sendError(dd_not_found());
+			continue;
+		}
+		ErrorOr<GetDataDistributorHeatmapReply> reply =
+		    wait(errorOr(db->get().distributor.get().dataDistributorHeatmap.getReply(
+		        GetDataDistributorHeatmapRequest(req.keys, req.since))));
+		if (reply.isError()) {
+			req.reply.sendError(reply.getError());
+		} else {
+			GetDDHeatmapReply newReply;
+			newReply.buckets = reply.get().buckets;
+			req.reply.send(newReply);
+		}
+	}
+}
+
 ACTOR Future<Void> monitorRemoteCommitted(ProxyCommitData* self) {
 	loop {
 		wait(delay(0)); // allow this actor to be cancelled if we are removed after db changes.
@@ -3592,6 +4095,11 @@ struct TransactionStateResolveContext {
 	// Actor streams
 	PromiseStream<Future<Void>>* pActors = nullptr;
 
+	// Bytes of the encoded parts received, time spent decoding them, and when the first part arrived
+	int64_t snapshotBytes = 0;
+	double decodeSeconds = 0;
+	double firstPartTime = 0;
+
 	// Flag reports if the transaction state request is complete. This request should only happen during recover, i.e.
 	// once per commit proxy.
 	bool processed = false;
@@ -3677,6 +4185,7 @@ ACTOR Future<Void> processCompleteTransactionStateRequest(TransactionStateResolv
 		// insert keyTag data separately from metadata mutations so that we can do one bulk insert which
 		// avoids a lot of map lookups.
 		pContext->pCommitData->keyInfo.rawInsert(keyInfoData);
+		pContext->pCommitData->keyInfoGeneration++;
 
 		Arena arena;
 		bool confChanges;
@@ -3726,13 +4235,28 @@ ACTOR Future<Void> processTransactionStateRequestPart(TransactionStateResolveCon
 		// This is the last piece of subsequence, yet other pieces might still on the way.
 		pContext->maxSequence = request.sequence + 1;
 	}
+	if (pContext->receivedSequences.empty()) {
+		pContext->firstPartTime = now();
+	}
 	pContext->receivedSequences.insert(request.sequence);
 
+	// Relay the part to the rest of its subtree before applying it, so that every level of the broadcast tree receives
+	// and processes the parts at the same time rather than after its parent has processed them. The reply is still only
+	// sent once both the subtree and this process have the part.
+	state ReplyPromise<Void> reply = request.reply;
+	state Future<Void> relayed = broadcastTxnRequest(request, SERVER_KNOBS->TXN_STATE_SEND_AMOUNT, false);
+
 	// Although we may receive the CommitTransactionRequest for the recovery transaction before all of the
 	// TxnStateRequest, we will not get a resolution result from any resolver until the master has submitted its initial
 	// (sequence 0) resolution request, which it doesn't do until we have acknowledged all TxnStateRequests
 	ASSERT(!pContext->pCommitData->validState.isSet());
 
+	if (!request.snapshot.empty()) {
+		const double decodeStart = timer();
+		request.data = decodeTxnStateSnapshot(request.snapshot, request.arena);
+		pContext->decodeSeconds += timer() - decodeStart;
+		pContext->snapshotBytes += request.snapshot.size();
+	}
 	for (auto& kv : request.data) {
 		pContext->pTxnStateStore->set(kv, &request.arena);
 	}
@@ -3741,13 +4265,20 @@ ACTOR Future<Void> processTransactionStateRequestPart(TransactionStateResolveCon
 	if (pContext->receivedSequences.size() == pContext->maxSequence) {
 		// Received all components of the txnStateRequest
 		ASSERT(!pContext->processed);
+		state double processStart = now();
 		pContext->txnRecovery = processCompleteTransactionStateRequest(pContext);
 		wait(pContext->txnRecovery);
 		pContext->processed = true;
+		TraceEvent("CommitProxyTxnStateReceived", pContext->pCommitData->dbgid)
+		    .detail("Parts", pContext->maxSequence)
+		    .detail("SnapshotBytes", pContext->snapshotBytes)
+		    .detail("DecodeSeconds", pContext->decodeSeconds)
+		    .detail("ReceiveDuration", processStart - pContext->firstPartTime)
+		    .detail("ProcessDuration", now() - processStart);
 	}
 
-	pContext->pActors->send(broadcastTxnRequest(request, SERVER_KNOBS->TXN_STATE_SEND_AMOUNT, true));
-	wait(yield());
+	wait(relayed);
+	reply.send(Void());
 	return Void();
 }
 
@@ -3845,6 +4376,13 @@ ACTOR Future<Void> commitProxyServerCore(CommitProxyInterface proxy,
 	state Future<Void> onError = transformError(actorCollection(addActor.getFuture()), broken_promise(), tlog_failed());
 
 	TraceEvent("CPEncryptionAtRestMode", proxy.id()).detail("Mode", commitData.encryptMode);
+	if (SERVER_KNOBS->PROXY_ENCRYPTION_THREADS > 0 && commitData.encryptMode.isEncryptionEnabled() &&
+	    !g_network->isSimulated()) {
+		commitData.encryptionThreads = createGenericThreadPool();
+		for (int i = 0; i < SERVER_KNOBS->PROXY_ENCRYPTION_THREADS; i++) {
+			commitData.encryptionThreads->addThread(new CommitBatch::MutationEncryptor(), "fdb-proxy-encrypt");
+		}
+	}
 
 	addActor.send(waitFailureServer(proxy.waitFailure.getFuture()));
 	addActor.send(traceRole(Role::COMMIT_PROXY, proxy.id()));
@@ -3904,6 +4442,7 @@ ACTOR Future<Void> commitProxyServerCore(CommitProxyInterface proxy,
 	addActor.send(bgReadRequestServer(proxy, addActor, &commitData));
 	addActor.send(rejoinServer(proxy, &commitData));
 	addActor.send(ddMetricsRequestServer(proxy, db));
+	addActor.send(ddHeatmapRequestServer(proxy, db));
 	addActor.send(reportTxnTagCommitCost(proxy.id(), db, &commitData.ssTrTagCommitCost));
 	addActor.send(logDetailedMetrics(&commitData));
 
@@ -4010,6 +4549,10 @@ ACTOR Future<Void> commitProxyServerCore(CommitProxyInterface proxy,
 			}
 			// TraceEvent(SevDebug, "ReceivedSetThrottledShards").detail("NumHotShards", commitData.hotShards.size());
 		}
+		when(SetStorageWriteBudgetsRequest request = waitNext(proxy.setStorageWriteBudgets.getFuture())) {
+			commitData.storageWriteBudgets = request.budgets;
+			commitData.storageWriteBudgetsExpiration = now() + request.expireAfter;
+		}
 	}
 }
 
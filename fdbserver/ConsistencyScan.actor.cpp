@@ -59,19 +59,24 @@ struct ConsistencyScanStats {
 	Counter failedRequests;
 	Counter scanLoops;
 	Counter inconsistencies;
+	Counter checkSumMismatches;
 	Counter databasePollSuccesses;
 	Counter databasePollErrors;
 
 	bool waitingBetweenRounds = false;
 	int targetRate = 0;
+	// Fraction of targetRate the scan reads at, lowered while storage servers are busy
+	double loadFactor = 1.0;
 
 	explicit ConsistencyScanStats(UID id, double interval)
 	  : cc("ConsistencyScanStats", id.toString()), logicalBytesScanned("LogicalBytesScanned", cc),
 	    replicatedBytesRead("ReplicatedBytesRead", cc), requests("Requests", cc), failedRequests("FailedRequests", cc),
 	    scanLoops("ScanLoops", cc), inconsistencies("Inconsistencies", cc),
-	    databasePollSuccesses("DatabasePollSuccesses", cc), databasePollErrors("DatabasePollErrors", cc) {
+	    checkSumMismatches("CheckSumMismatches", cc), databasePollSuccesses("DatabasePollSuccesses", cc),
+	    databasePollErrors("DatabasePollErrors", cc) {
 		specialCounter(cc, "WaitingBetweenRounds", [this]() { return this->waitingBetweenRounds; });
 		specialCounter(cc, "TargetRate", [this]() { return this->targetRate; });
+		specialCounter(cc, "LoadFactorPercent", [this]() { return (int64_t)(this->loadFactor * 100); });
 		logger = cc.traceCounters("ConsistencyScanMetrics", id, interval, "ConsistencyScanMetrics");
 	}
 };
@@ -86,6 +91,22 @@ struct ConsistencyScanMemoryState : public ReferenceCounted<ConsistencyScanMemor
 
 	explicit ConsistencyScanMemoryState(Reference<AsyncVar<ServerDBInfo> const> dbInfo, UID csId)
 	  : dbInfo(dbInfo), csId(csId), stats(csId, SERVER_KNOBS->WORKER_LOGGING_INTERVAL) {}
+
+	// Slows the scan down while the storage servers it reads from report a read penalty, i.e., are busy, and speeds it
+	// back up after reads without one
+	void updateLoadFactor(double maxPenalty) {
+		if (maxPenalty > 1.0) {
+			CODE_PROBE(true, "Consistency Scan slowing down for busy storage servers");
+			stats.loadFactor = std::max(SERVER_KNOBS->CONSISTENCY_SCAN_MIN_LOAD_FACTOR, stats.loadFactor / maxPenalty);
+		} else {
+			stats.loadFactor = std::min(1.0, stats.loadFactor * SERVER_KNOBS->CONSISTENCY_SCAN_LOAD_FACTOR_RECOVERY);
+		}
+	}
+
+	// Returns the rate control budget to spend for reading bytes at the current load factor
+	unsigned int throttledBytes(int64_t bytes) const {
+		return (unsigned int)std::min<double>(bytes / stats.loadFactor, std::numeric_limits<unsigned int>::max());
+	}
 };
 
 // TODO: test the test and write a canary key that the storage servers intentionally get wrong
@@ -176,6 +197,57 @@ ACTOR Future<std::vector<StorageServerInterface>> loadShardInterfaces(Reference<
 	return storageServerInterfaces;
 }
 
+// The result of comparing the checksums of a range from all of its replicas
+struct CheckSumComparison {
+	Optional<Error> error; // Set if a replica could not checksum the range
+	bool match = false;
+	// The end of the part of the range the checksums cover. If they don't match, the furthest end of any of them.
+	Key end;
+	int64_t logicalBytes = 0;
+	int64_t replicatedBytes = 0;
+	double maxPenalty = 1.0;
+};
+
+// Compares checksums of the beginning of range at version from all replicas, which read the range locally and reply
+// with a digest of it rather than its data
+ACTOR Future<CheckSumComparison> consistencyCheckCompareCheckSums(
+    KeyRange range,
+    Version version,
+    std::vector<StorageServerInterface>* storageServerInterfaces) {
+	state GetStorageCheckSumRequest req({ { range, version } }, Optional<UID>(), CheckSumMethod::XXHash3);
+	state std::vector<Future<ErrorOr<GetStorageCheckSumReply>>> replies;
+	for (const auto& ssi : *storageServerInterfaces) {
+		resetReply(req);
+		replies.push_back(ssi.getCheckSum.getReplyUnlessFailedFor(req, 2, 0));
+	}
+	wait(waitForAll(replies));
+
+	CheckSumComparison result;
+	const CheckSumMetaData* first = nullptr;
+	for (const auto& reply : replies) {
+		if (!reply.get().present()) {
+			result.error = reply.get().getError();
+			return result;
+		}
+		ASSERT(reply.get().get().checkSums.size() == 1);
+		const CheckSumMetaData& checkSum = reply.get().get().checkSums[0];
+		result.maxPenalty = std::max(result.maxPenalty, reply.get().get().penalty);
+		result.replicatedBytes += checkSum.checkedBytes;
+		if (!first) {
+			first = &checkSum;
+			result.match = true;
+			result.end = checkSum.range.end;
+			result.logicalBytes = checkSum.checkedBytes;
+		} else if (checkSum.range != first->range || checkSum.checkSumValue != first->checkSumValue) {
+			result.match = false;
+			if (checkSum.range.end > result.end) {
+				result.end = checkSum.range.end;
+			}
+		}
+	}
+	return result;
+}
+
 // returns error count
 ACTOR Future<int> consistencyCheckReadData(UID myId,
                                            Database cx,
@@ -524,6 +596,8 @@ ACTOR Future<Void> consistencyScanCore(Database db,
 
 	state int64_t readRateLimit = 0;
 	state Reference<IRateControl> readRateControl;
+	// Cleared if storage servers can't checksum ranges, e.g., while the cluster is being upgraded
+	state bool checkSumsSupported = true;
 
 	CODE_PROBE(true, "Running Consistency Scan");
 
@@ -829,6 +903,9 @@ ACTOR Future<Void> consistencyScanCore(Database db,
 						state int64_t logicalBytesRead = 0;
 						// Number of key differences found (essentially a count of comparisons that failed)
 						state int errors = 0;
+						// The replicas' checksums of the range before this key differed, so its data must be read and
+						// compared to find the differences
+						state Key dataReadEnd;
 						// FIXME: break the round after some amount of time or number of failed requests regardless of
 						// progress
 
@@ -843,6 +920,66 @@ ACTOR Future<Void> consistencyScanCore(Database db,
 						// where blob disagrees from the other replicas, which would also be a general ++error
 
 						loop {
+							// we want to make a decent amount of progress per transaction here to reduce overhead, but
+							// we also don't want to alternate bursting for 5 seconds and then sleeping for many seconds
+							// As a compromise, only sleep for some tunable percentage of the target here, and sleep the
+							// rest at the end
+							if (totalReadBytesFromStorageServers > 0) {
+								double ratio = SERVER_KNOBS->CONSISTENCY_SCAN_ACTIVE_THROTTLE_RATIO;
+								ratio = std::max(0.0, std::min(1.0, ratio));
+								int sleepBytes = (int)(totalReadBytesFromStorageServers * ratio);
+								totalReadBytesFromStorageServers -= sleepBytes;
+								wait(readRateControl->getAllowance(memState->throttledBytes(sleepBytes)));
+							}
+
+							// Compare checksums of the range first, which the storage servers compute locally, and only
+							// read the data from all replicas if they differ. Injected corruption is in read replies.
+							if (SERVER_KNOBS->CONSISTENCY_SCAN_USE_CHECKSUMS && checkSumsSupported &&
+							    !SERVER_KNOBS->ENABLE_VERSION_VECTOR && targetRange.begin >= dataReadEnd &&
+							    !(g_network->isSimulated() &&
+							      g_simulator->consistencyScanState ==
+							          ISimulator::SimConsistencyScanState::Enabled_InjectCorruption)) {
+								memState->stats.requests += storageServerInterfaces.size();
+								state CheckSumComparison comparison = wait(consistencyCheckCompareCheckSums(
+								    targetRange, tr->getReadVersion().get(), &storageServerInterfaces));
+								totalReadBytesFromStorageServers += comparison.replicatedBytes;
+								if (comparison.error.present()) {
+									if (comparison.error.get().code() == error_code_not_implemented) {
+										CODE_PROBE(true, "Consistency Scan storage server can't checksum ranges");
+										checkSumsSupported = false;
+										continue;
+									}
+									failedRequest = comparison.error;
+									if (failedRequest.get().code() != error_code_transaction_too_old) {
+										TraceEvent("ConsistencyScan_FailedRequest", memState->csId)
+										    .errorUnsuppressed(failedRequest.get())
+										    .suppressFor(5.0);
+										++memState->stats.failedRequests;
+									}
+									totalReadBytesFromStorageServers += 100000;
+									break;
+								}
+								memState->updateLoadFactor(comparison.maxPenalty);
+								if (!comparison.match) {
+									CODE_PROBE(true, "Consistency Scan checksums differ");
+									TraceEvent("ConsistencyScan_CheckSumMismatch", memState->csId)
+									    .detail("Range", KeyRangeRef(targetRange.begin, comparison.end))
+									    .detail("Version", tr->getReadVersion().get());
+									++memState->stats.checkSumMismatches;
+									dataReadEnd = comparison.end;
+									continue;
+								}
+								logicalBytesRead += comparison.logicalBytes;
+								replicatedBytesRead += comparison.replicatedBytes;
+								statsCurrentRound.lastEndKey = comparison.end;
+								if (comparison.end == targetRange.end) {
+									noMoreRecords = comparison.end == allKeys.end;
+									break;
+								}
+								targetRange = KeyRangeRef(comparison.end, targetRange.end);
+								continue;
+							}
+
 							state std::vector<Future<ErrorOr<GetKeyValuesReply>>> keyValueFutures;
 							state Optional<int> firstValidServer;
 							memState->stats.requests += storageServerInterfaces.size();
@@ -873,6 +1010,13 @@ ACTOR Future<Void> consistencyScanCore(Database db,
 
 							// throttle always includes replicated bytes read in total read bytes for throttling
 							totalReadBytesFromStorageServers += replicatedBytesReadThisLoop;
+							if (!failedRequest.present()) {
+								double maxPenalty = 1.0;
+								for (const auto& rangeResult : keyValueFutures) {
+									maxPenalty = std::max(maxPenalty, rangeResult.get().get().penalty);
+								}
+								memState->updateLoadFactor(maxPenalty);
+							}
 							if (!failedRequest.present() && !newErrors) {
 								ASSERT(firstValidServer.present());
 								GetKeyValuesReply rangeResult = keyValueFutures[firstValidServer.get()].get().get();
@@ -934,16 +1078,6 @@ ACTOR Future<Void> consistencyScanCore(Database db,
 								totalReadBytesFromStorageServers += 100000;
 								break;
 							}
-
-							// we want to make a decent amount of progress per transaction here to reduce overhead, but
-							// we also don't want to alternate bursting for 5 seconds and then sleeping for many seconds
-							// As a compromise, only sleep for some tunable percentage of the target here, and sleep the
-							// rest at the end
-							double ratio = SERVER_KNOBS->CONSISTENCY_SCAN_ACTIVE_THROTTLE_RATIO;
-							ratio = std::max(0.0, std::min(1.0, ratio));
-							int sleepBytes = (int)(totalReadBytesFromStorageServers * ratio);
-							totalReadBytesFromStorageServers -= sleepBytes;
-							wait(readRateControl->getAllowance(sleepBytes));
 						}
 
 						statsCurrentRound.errorCount += errors;
@@ -1060,7 +1194,7 @@ ACTOR Future<Void> consistencyScanCore(Database db,
 			}
 
 			// Wait for the rate control to generate enough budget to match what we read.
-			wait(readRateControl->getAllowance(totalReadBytesFromStorageServers));
+			wait(readRateControl->getAllowance(memState->throttledBytes(totalReadBytesFromStorageServers)));
 
 			if (DEBUG_SCAN_PROGRESS) {
 				TraceEvent(SevDebug, "ConsistencyScanProgressRateLimited", memState->csId);
@@ -96,6 +96,7 @@ std::pair<const DmReasonPriorityMapping*, const PriorityDmReasonMapping*> buildP
 		{ DataMovementReason::ENFORCE_MOVE_OUT_OF_PHYSICAL_SHARD,
 		  SERVER_KNOBS->PRIORITY_ENFORCE_MOVE_OUT_OF_PHYSICAL_SHARD },
 		{ DataMovementReason::REBALANCE_STORAGE_QUEUE, SERVER_KNOBS->PRIORITY_REBALANCE_STORAGE_QUEUE },
+		{ DataMovementReason::BULK_LOAD, SERVER_KNOBS->PRIORITY_BULK_LOAD },
 		{ DataMovementReason::ASSIGN_EMPTY_RANGE, -2 }, // dummy reason, no corresponding actual data move
 		{ DataMovementReason::SEED_SHARD_SERVER, -3 }, // dummy reason, no corresponding actual data move
 		{ DataMovementReason::NUMBER_OF_REASONS, -4 }, // dummy reason, no corresponding actual data move
@@ -149,7 +150,8 @@ RelocateData::RelocateData(RelocateShard const& rs)
     wantsNewServers(isDataMovementForMountainChopper(rs.moveReason) || isDataMovementForValleyFiller(rs.moveReason) ||
                     rs.moveReason == DataMovementReason::SPLIT_SHARD ||
                     rs.moveReason == DataMovementReason::TEAM_REDUNDANT ||
-                    rs.moveReason == DataMovementReason::REBALANCE_STORAGE_QUEUE),
+                    rs.moveReason == DataMovementReason::REBALANCE_STORAGE_QUEUE ||
+                    rs.moveReason == DataMovementReason::BULK_LOAD),
     cancellable(true), interval("QueuedRelocation", randomId), dataMove(rs.dataMove) {
 	if (dataMove != nullptr) {
 		this->src.insert(this->src.end(), dataMove->meta.src.begin(), dataMove->meta.src.end());
@@ -392,9 +394,11 @@ public:
 	}
 };
 
+Busyness::Busyness() : ledger(10, 0), capacity(WORK_FULL_UTILIZATION) {}
+
 bool Busyness::canLaunch(int prio, int work) const {
 	ASSERT(prio > 0 && prio < 1000);
-	return ledger[prio / 100] <= WORK_FULL_UTILIZATION - work; // allow for rounding errors in double division
+	return ledger[prio / 100] <= capacity - work; // allow for rounding errors in double division
 }
 
 void Busyness::addWork(int prio, int work) {
@@ -416,7 +420,7 @@ std::string Busyness::toString() {
 		if (i != 1)
 			result += ", ";
 		result += i + 1 == j ? format("%03d", i * 100) : format("%03d/%03d", i * 100, (j - 1) * 100);
-		result += format("=%1.02f (%d/%d)", (float)ledger[i] / WORK_FULL_UTILIZATION, ledger[i], WORK_FULL_UTILIZATION);
+		result += format("=%1.02f (%d/%d)", (float)ledger[i] / WORK_FULL_UTILIZATION, ledger[i], capacity);
 		i = j;
 	}
 	return result;
@@ -591,7 +595,9 @@ DDQueue::DDQueue(DDQueueInitParams const& params)
     unhealthyRelocations(0), movedKeyServersEventHolder(makeReference<EventCacheHolder>("MovedKeyServers")),
     moveReusePhysicalShard(0), moveCreateNewPhysicalShard(0),
     retryFindDstReasonCount(static_cast<int>(RetryFindDstReason::NumberOfTypes), 0),
-    moveBytesRate(SERVER_KNOBS->DD_TRACE_MOVE_BYTES_AVERAGE_INTERVAL) {}
+    moveBytesRate(SERVER_KNOBS->DD_TRACE_MOVE_BYTES_AVERAGE_INTERVAL),
+    relocatedBytesRate(SERVER_KNOBS->DD_TRACE_MOVE_BYTES_AVERAGE_INTERVAL),
+    preferPhysicalShardMove(params.shardedRocksDBOnly && SERVER_KNOBS->DD_PHYSICAL_SHARD_MOVE_FOR_SHARDED_ROCKSDB) {}
 
 void DDQueue::startRelocation(int priority, int healthPriority) {
 	// Although PRIORITY_TEAM_REDUNDANT has lower priority than split and merge shard movement,
@@ -988,9 +994,15 @@ void DDQueue::launchQueuedWork(RelocateData launchData, const DDEnabledState* dd
 	launchQueuedWork(combined, ddEnabledState);
 }
 
-DataMoveType newDataMoveType() {
+// Storage servers that don't support physical shard moves, and moves that fail to fetch checkpoints, fall back to
+// fetching keys, so a physical move is never worse than trying one
+// A bulk load move is always logical, as its servers load it from files rather than from the source servers
+DataMoveType newDataMoveType(bool preferPhysical, DataMovementReason reason) {
 	DataMoveType type = DataMoveType::LOGICAL;
-	if (deterministicRandom()->random01() < SERVER_KNOBS->DD_PHYSICAL_SHARD_MOVE_PROBABILITY) {
+	if (reason == DataMovementReason::BULK_LOAD) {
+		return type;
+	}
+	if (preferPhysical || deterministicRandom()->random01() < SERVER_KNOBS->DD_PHYSICAL_SHARD_MOVE_PROBABILITY) {
 		type = DataMoveType::PHYSICAL;
 	}
 	if (type != DataMoveType::PHYSICAL && SERVER_KNOBS->ENABLE_PHYSICAL_SHARD_MOVE_EXPERIMENT) {
@@ -1114,7 +1126,7 @@ void DDQueue::launchQueuedWork(std::set<RelocateData, std::greater<RelocateData>
 					} else {
 						rrs.dataMoveId = newDataMoveId(deterministicRandom()->randomUInt64(),
 						                               AssignEmptyRange::False,
-						                               newDataMoveType(),
+						                               newDataMoveType(preferPhysicalShardMove, rrs.dmReason),
 						                               rrs.dmReason);
 						TraceEvent(SevInfo, "NewDataMoveWithRandomDestID")
 						    .detail("DataMoveID", rrs.dataMoveId.toString())
@@ -1217,6 +1229,66 @@ Future<Void> DDQueue::periodicalRefreshCounter() {
 	return recurring(f, SERVER_KNOBS->DD_QUEUE_COUNTER_REFRESH_INTERVAL);
 }
 
+void DDQueue::recordMoveThroughput(const std::vector<UID>& src,
+                                   const std::vector<UID>& dest,
+                                   int64_t bytes,
+                                   double seconds) {
+	for (const UID& id : src) {
+		srcMoveThroughput[id].bytes += bytes;
+		srcMoveThroughput[id].seconds += seconds;
+	}
+	for (const UID& id : dest) {
+		destMoveThroughput[id].bytes += bytes;
+		destMoveThroughput[id].seconds += seconds;
+	}
+}
+
+// A server whose relocations ran at the target rate gets half a relocation's worth more capacity each interval, up to
+// the maximum multiplier. One whose relocations were slow has its extra capacity halved, and one with a long storage
+// queue or busy CPU, or with no metrics, goes back to the configured parallelism.
+static bool adaptCapacity(UID id,
+                          Busyness& busy,
+                          const DDQueue::MoveThroughput* throughput,
+                          const HealthMetrics& metrics) {
+	const int maxCapacity = WORK_FULL_UTILIZATION * SERVER_KNOBS->DD_ADAPTIVE_RELOCATION_MAX_MULTIPLIER;
+	auto stats = metrics.storageStats.find(id);
+	if (stats == metrics.storageStats.end() ||
+	    stats->second.storageQueue > SERVER_KNOBS->DD_ADAPTIVE_RELOCATION_MAX_STORAGE_QUEUE ||
+	    stats->second.cpuUsage > SERVER_KNOBS->MAX_DEST_CPU_PERCENT) {
+		busy.capacity = WORK_FULL_UTILIZATION;
+		return false;
+	}
+	if (throughput == nullptr || throughput->seconds <= 0) {
+		return false;
+	}
+	double rate = throughput->bytes / throughput->seconds;
+	if (rate >= SERVER_KNOBS->DD_ADAPTIVE_RELOCATION_TARGET_RATE && busy.capacity < maxCapacity) {
+		busy.capacity = std::min(maxCapacity, busy.capacity + WORK_FULL_UTILIZATION / 2);
+		return true;
+	}
+	if (rate < SERVER_KNOBS->DD_ADAPTIVE_RELOCATION_TARGET_RATE / 2) {
+		busy.capacity = WORK_FULL_UTILIZATION + (busy.capacity - WORK_FULL_UTILIZATION) / 2;
+	}
+	return false;
+}
+
+std::set<UID> DDQueue::adaptRelocationParallelism(const HealthMetrics& metrics) {
+	std::set<UID> raised;
+	auto adapt = [&](std::map<UID, Busyness>& busyness, const std::map<UID, MoveThroughput>& throughput) {
+		for (auto& [id, busy] : busyness) {
+			auto it = throughput.find(id);
+			if (adaptCapacity(id, busy, it == throughput.end() ? nullptr : &it->second, metrics)) {
+				raised.insert(id);
+			}
+		}
+	};
+	adapt(busymap, srcMoveThroughput);
+	adapt(destBusymap, destMoveThroughput);
+	srcMoveThroughput.clear();
+	destMoveThroughput.clear();
+	return raised;
+}
+
 int DDQueue::getUnhealthyRelocationCount() const {
 	return unhealthyRelocations;
 }
@@ -1318,6 +1390,9 @@ void traceRelocateDecision(TraceEvent& ev, const UID& pairId, const RelocateDeci
 		    .detail("ParentShardWriteBytes", decision.parentMetrics.get().bytesWrittenPerKSecond);
 	} else if (decision.rd.reason == RelocateReason::SIZE_SPLIT) {
 		ev.detail("ShardSize", decision.metrics.bytes).detail("ParentShardSize", decision.parentMetrics.get().bytes);
+	} else if (decision.rd.reason == RelocateReason::READ_SPLIT) {
+		ev.detail("ShardReadBytes", decision.metrics.bytesReadPerKSecond)
+		    .detail("ParentShardReadBytes", decision.parentMetrics.get().bytesReadPerKSecond);
 	}
 }
 
@@ -1489,7 +1564,8 @@ ACTOR Future<Void> dataDistributionRelocator(DDQueue* self,
 							destTeamSelect = TeamSelect::ANY;
 						}
 						PreferLowerReadUtil preferLowerReadTeam =
-						    SERVER_KNOBS->DD_PREFER_LOW_READ_UTIL_TEAM || rd.reason == RelocateReason::REBALANCE_READ
+						    SERVER_KNOBS->DD_PREFER_LOW_READ_UTIL_TEAM || rd.reason == RelocateReason::REBALANCE_READ ||
+						            rd.reason == RelocateReason::READ_SPLIT
 						        ? PreferLowerReadUtil::True
 						        : PreferLowerReadUtil::False;
 						auto req = GetTeamRequest(destTeamSelect,
@@ -1561,6 +1637,19 @@ ACTOR Future<Void> dataDistributionRelocator(DDQueue* self,
 							anyWithSource = true;
 						}
 
+						// Only the servers a bulk load move adds load its piece from the files, so it must move the
+						// piece away from all of its servers
+						if (rd.dmReason == DataMovementReason::BULK_LOAD) {
+							const std::vector<UID>& servers = bestTeam.first.get()->getServerIDs();
+							if (std::any_of(servers.begin(), servers.end(), [&](const UID& id) {
+								    return std::find(rd.src.begin(), rd.src.end(), id) != rd.src.end();
+							    })) {
+								self->retryFindDstReasonCount[DDQueue::RetryFindDstReason::BulkLoadSourceInTeam]++;
+								foundTeams = false;
+								break;
+							}
+						}
+
 						if (enableShardMove) {
 							if (tciIndex == 1 && !forceToUseNewPhysicalShard) {
 								// critical to the correctness of team selection by PhysicalShardCollection
@@ -1709,8 +1798,10 @@ ACTOR Future<Void> dataDistributionRelocator(DDQueue* self,
 					} else {
 						self->moveCreateNewPhysicalShard++;
 					}
-					rd.dataMoveId = newDataMoveId(
-					    physicalShardIDCandidate, AssignEmptyRange::False, newDataMoveType(), rd.dmReason);
+					rd.dataMoveId = newDataMoveId(physicalShardIDCandidate,
+					                              AssignEmptyRange::False,
+					                              newDataMoveType(self->preferPhysicalShardMove, rd.dmReason),
+					                              rd.dmReason);
 					TraceEvent(SevInfo, "NewDataMoveWithPhysicalShard")
 					    .detail("DataMoveID", rd.dataMoveId.toString())
 					    .detail("Reason", rd.reason.toString())
@@ -1978,6 +2069,15 @@ ACTOR Future<Void> dataDistributionRelocator(DDQueue* self,
 					const int nonOverlappingCount = nonOverlappedServerCount(rd.completeSources, destIds);
 					self->bytesWritten += metrics.bytes;
 					self->moveBytesRate.addSample(metrics.bytes * nonOverlappingCount);
+					self->relocatedBytesRate.addSample(metrics.bytes);
+					DDQueue::MoveThroughput& typeThroughput = getDataMoveType(rd.dataMoveId) == DataMoveType::PHYSICAL
+					                                              ? self->physicalMoveThroughput
+					                                              : self->logicalMoveThroughput;
+					typeThroughput.bytes += metrics.bytes;
+					typeThroughput.seconds += now() - startTime;
+					if (SERVER_KNOBS->DD_ADAPTIVE_RELOCATION_PARALLELISM) {
+						self->recordMoveThroughput(rd.src, destIds, metrics.bytes, now() - startTime);
+					}
 					self->shardsAffectedByTeamFailure->finishMove(rd.keys);
 					relocationComplete.send(rd);
 
@@ -2410,6 +2510,20 @@ ACTOR Future<Void> BgDDLoadRebalance(DDQueue* self, int teamCollectionIndex, Dat
 }
 
 struct DDQueueImpl {
+	// Periodically adjusts how many relocations each server may be a source or destination of at once, based on how
+	// fast its recent relocations went and on its storage queue and CPU
+	ACTOR static Future<Void> adaptRelocationParallelism(DDQueue* self) {
+		loop {
+			wait(delay(SERVER_KNOBS->DD_ADAPTIVE_RELOCATION_INTERVAL, TaskPriority::DataDistributionLaunch));
+			HealthMetrics metrics = wait(self->txnProcessor->getHealthMetrics(true));
+			std::set<UID> raised = self->adaptRelocationParallelism(metrics);
+			if (!raised.empty()) {
+				TraceEvent("DDRelocationParallelismRaised", self->distributorId).detail("Servers", raised.size());
+				self->launchQueuedWork(raised, self->ddEnabledState);
+			}
+		}
+	}
+
 	ACTOR static Future<Void> run(Reference<DDQueue> self,
 	                              Reference<AsyncVar<bool>> processingUnhealthy,
 	                              Reference<AsyncVar<bool>> processingWiggle,
@@ -2442,6 +2556,9 @@ struct DDQueueImpl {
 		ddQueueFutures.push_back(delayedAsyncVar(self->rawProcessingUnhealthy, processingUnhealthy, 0));
 		ddQueueFutures.push_back(delayedAsyncVar(self->rawProcessingWiggle, processingWiggle, 0));
 		ddQueueFutures.push_back(self->periodicalRefreshCounter());
+		if (SERVER_KNOBS->DD_ADAPTIVE_RELOCATION_PARALLELISM) {
+			ddQueueFutures.push_back(adaptRelocationParallelism(self.getPtr()));
+		}
 
 		try {
 			loop {
@@ -2519,11 +2636,24 @@ struct DDQueueImpl {
 						recordMetrics = delay(SERVER_KNOBS->DD_QUEUE_LOGGING_INTERVAL, TaskPriority::FlushTrace);
 
 						auto const highestPriorityRelocation = self->getHighestPriorityRelocation();
+						int64_t const averageShardSize = req.getFuture().isReady() ? req.getFuture().get() : -1;
+						// Assumes the pending relocations are of average size and are relocated at the recent rate
+						double const relocatedBytesRate = self->relocatedBytesRate.getAverage();
+						double const projectedCompletionSeconds =
+						    averageShardSize >= 0 && relocatedBytesRate > 0
+						        ? (self->activeRelocations + self->queuedRelocations) * averageShardSize /
+						              relocatedBytesRate
+						        : -1;
 
 						TraceEvent("MovingData", self->distributorId)
 						    .detail("InFlight", self->activeRelocations)
 						    .detail("InQueue", self->queuedRelocations)
-						    .detail("AverageShardSize", req.getFuture().isReady() ? req.getFuture().get() : -1)
+						    .detail("AverageShardSize", averageShardSize)
+						    .detail("ProjectedCompletionSeconds", projectedCompletionSeconds)
+						    .detail("PhysicalMoveBytes", self->physicalMoveThroughput.bytes)
+						    .detail("PhysicalMoveSeconds", self->physicalMoveThroughput.seconds)
+						    .detail("LogicalMoveBytes", self->logicalMoveThroughput.bytes)
+						    .detail("LogicalMoveSeconds", self->logicalMoveThroughput.seconds)
 						    .detail("UnhealthyRelocations", self->unhealthyRelocations)
 						    .detail("HighestPriority", highestPriorityRelocation)
 						    .detail("BytesWritten", self->moveBytesRate.getTotal())
@@ -2588,7 +2718,10 @@ struct DDQueueImpl {
 							            self->retryFindDstReasonCount
 							                [DDQueue::RetryFindDstReason::NoAvailablePhysicalShard])
 							    .detail("RetryLimitReached",
-							            self->retryFindDstReasonCount[DDQueue::RetryFindDstReason::RetryLimitReached]);
+							            self->retryFindDstReasonCount[DDQueue::RetryFindDstReason::RetryLimitReached])
+							    .detail(
+							        "BulkLoadSourceInTeam",
+							        self->retryFindDstReasonCount[DDQueue::RetryFindDstReason::BulkLoadSourceInTeam]);
 							self->moveCreateNewPhysicalShard = 0;
 							self->moveReusePhysicalShard = 0;
 							for (int i = 0; i < self->retryFindDstReasonCount.size(); ++i) {
@@ -2648,3 +2781,39 @@ TEST_CASE("/DataDistribution/DDQueue/ServerCounterTrace") {
 	std::cout << "Finished.";
 	return Void();
 }
+
+TEST_CASE("/DataDistribution/DDQueue/AdaptRelocationParallelism") {
+	DDQueue self;
+	UID src(1, 0), dest(2, 0), overloaded(3, 0);
+	HealthMetrics metrics;
+	for (UID id : { src, dest, overloaded }) {
+		metrics.storageStats[id].storageQueue = 0;
+		metrics.storageStats[id].cpuUsage = 0;
+	}
+	metrics.storageStats[overloaded].storageQueue = SERVER_KNOBS->DD_ADAPTIVE_RELOCATION_MAX_STORAGE_QUEUE + 1;
+	self.busymap[src];
+	self.busymap[overloaded];
+	self.destBusymap[dest];
+
+	// Relocations at the target rate raise the capacity of their servers, up to the maximum
+	const int64_t bytes = SERVER_KNOBS->DD_ADAPTIVE_RELOCATION_TARGET_RATE * 10;
+	const int maxCapacity = WORK_FULL_UTILIZATION * SERVER_KNOBS->DD_ADAPTIVE_RELOCATION_MAX_MULTIPLIER;
+	std::set<UID> raised = { src };
+	while (!raised.empty()) {
+		self.recordMoveThroughput({ src, overloaded }, { dest }, bytes, 1.0);
+		raised = self.adaptRelocationParallelism(metrics);
+		ASSERT(!raised.count(overloaded));
+		ASSERT(self.busymap[overloaded].capacity == WORK_FULL_UTILIZATION);
+	}
+	ASSERT(self.busymap[src].capacity == maxCapacity);
+	ASSERT(self.destBusymap[dest].capacity == maxCapacity);
+	ASSERT(self.busymap[src].canLaunch(SERVER_KNOBS->PRIORITY_TEAM_HEALTHY, maxCapacity - WORK_FULL_UTILIZATION));
+
+	// Slow relocations halve the extra capacity, and a server without metrics goes back to the configured parallelism
+	self.recordMoveThroughput({ src }, { dest }, 1, 1.0);
+	metrics.storageStats.erase(dest);
+	ASSERT(self.adaptRelocationParallelism(metrics).empty());
+	ASSERT(self.busymap[src].capacity == WORK_FULL_UTILIZATION + (maxCapacity - WORK_FULL_UTILIZATION) / 2);
+	ASSERT(self.destBusymap[dest].capacity == WORK_FULL_UTILIZATION);
+	return Void();
+}
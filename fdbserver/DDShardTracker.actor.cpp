@@ -79,6 +79,13 @@ void restartShardTrackers(DataDistributionTracker* self,
                           Optional<ShardMetrics> startingMetrics = Optional<ShardMetrics>(),
                           bool whenDDInit = false);
 
+void executeShardSplit(DataDistributionTracker* self,
+                       KeyRange keys,
+                       Standalone<VectorRef<KeyRef>> splitKeys,
+                       Reference<AsyncVar<Optional<ShardMetrics>>> shardSize,
+                       bool relocate,
+                       RelocateReason reason);
+
 // Gets the permitted size and IO bounds for a shard. A shard that starts at allKeys.begin
 //  (i.e. '') will have a permitted size of 0, since the database can contain no data.
 ShardSizeBounds getShardSizeBounds(KeyRangeRef shard, int64_t maxShardSize) {
@@ -321,6 +328,66 @@ ACTOR Future<Void> trackShardMetrics(DataDistributionTracker::SafeAccessor self,
 	}
 }
 
+// Returns whether any part of keys is part of a bulk load that was last moved within DD_BULK_LOAD_MERGE_COOLDOWN
+static bool bulkLoadCoolingDown(DataDistributionTracker* self, KeyRangeRef keys) {
+	for (auto it : self->bulkLoadTimes.intersectingRanges(keys)) {
+		if (it.value() > 0 && now() - it.value() < SERVER_KNOBS->DD_BULK_LOAD_MERGE_COOLDOWN) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Returns whether any part of keys was considered for a read hot split within DD_READ_HOT_SPLIT_COOLDOWN
+static bool readHotSplitCoolingDown(DataDistributionTracker* self, KeyRangeRef keys) {
+	for (auto it : self->readHotSplitTimes.intersectingRanges(keys)) {
+		if (it.value() > 0 && now() - it.value() < SERVER_KNOBS->DD_READ_HOT_SPLIT_COOLDOWN) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Splits a read hot shard at the points that divide its sampled read bandwidth, and relocates all but one of the
+// resulting shards so the reads are spread over several teams
+ACTOR Future<Void> readHotShardSplitter(DataDistributionTracker* self, KeyRange keys) {
+	auto shard = self->shards->rangeContaining(keys.begin);
+	if (shard->range() != keys || !shard->value().stats->get().present() || keys.begin >= keyServersKeys.begin ||
+	    readHotSplitCoolingDown(self, keys)) {
+		return Void();
+	}
+	state StorageMetrics metrics = shard->value().stats->get().get().metrics;
+	self->readHotSplitTimes.insert(keys, now());
+
+	// Aim for about three shards, each with a third of the read bandwidth
+	StorageMetrics splitMetrics;
+	splitMetrics.bytes = splitMetrics.infinity;
+	splitMetrics.bytesWrittenPerKSecond = splitMetrics.infinity;
+	splitMetrics.iosPerKSecond = splitMetrics.infinity;
+	splitMetrics.bytesReadPerKSecond = std::max<int64_t>(metrics.bytesReadPerKSecond / 3, 1);
+	splitMetrics.opsReadPerKSecond = splitMetrics.infinity;
+
+	state Standalone<VectorRef<KeyRef>> splitKeys =
+	    wait(self->db->splitStorageMetrics(keys, splitMetrics, metrics, SERVER_KNOBS->MIN_SHARD_BYTES));
+	int numShards = splitKeys.size() - 1;
+
+	TraceEvent("RelocateShardStartReadSplit", self->distributorId)
+	    .suppressFor(1.0)
+	    .detail("Begin", keys.begin)
+	    .detail("End", keys.end)
+	    .detail("MetricsBytes", metrics.bytes)
+	    .detail("BytesReadPerKSec", metrics.bytesReadPerKSecond)
+	    .detail("NumShards", numShards);
+
+	// The shard may have been split or merged while the split points were computed
+	auto current = self->shards->rangeContaining(keys.begin);
+	if (numShards > 1 && current->range() == keys && current->value().stats->get().present()) {
+		CODE_PROBE(true, "read hot shard split");
+		executeShardSplit(self, keys, splitKeys, current->value().stats, true, RelocateReason::READ_SPLIT);
+	}
+	return Void();
+}
+
 ACTOR Future<Void> readHotDetector(DataDistributionTracker* self) {
 	try {
 		loop {
@@ -335,6 +402,10 @@ ACTOR Future<Void> readHotDetector(DataDistributionTracker* self) {
 				    .detail("KeyRangeBegin", keyRange.keys.begin)
 				    .detail("KeyRangeEnd", keyRange.keys.end);
 			}
+
+			if (SERVER_KNOBS->DD_SPLIT_READ_HOT_SHARDS) {
+				wait(readHotShardSplitter(self, keys));
+			}
 		}
 	} catch (Error& e) {
 		if (e.code() != error_code_actor_cancelled) {
@@ -889,6 +960,17 @@ ACTOR Future<Void> brokenPromiseToReady(Future<Void> f) {
 }
 
 static bool shardMergeFeasible(DataDistributionTracker* self, KeyRange const& keys, KeyRangeRef adjRange) {
+	// Merging the shards of a recent read hot split would undo it
+	if (SERVER_KNOBS->DD_SPLIT_READ_HOT_SHARDS &&
+	    (readHotSplitCoolingDown(self, keys) || readHotSplitCoolingDown(self, adjRange))) {
+		return false;
+	}
+
+	// A merge would move a piece of a bulk load along with other data, which its new servers fetch as usual
+	if (bulkLoadCoolingDown(self, keys) || bulkLoadCoolingDown(self, adjRange)) {
+		return false;
+	}
+
 	if (!SERVER_KNOBS->DD_TENANT_AWARENESS_ENABLED) {
 		return true;
 	}
@@ -1469,6 +1551,90 @@ ACTOR Future<Void> fetchShardMetricsList(DataDistributionTracker* self, GetMetri
 	return Void();
 }
 
+ShardHeatmap::SliceBuilder::SliceBuilder(double time, int64_t totalBytes, int maxBuckets)
+  : time(time), bucketBytes(std::max<int64_t>(totalBytes / std::max(maxBuckets, 1), 1)) {}
+
+void ShardHeatmap::SliceBuilder::addShard(KeyRef begin, StorageMetrics const& metrics) {
+	if (bucketFull) {
+		buckets.push_back_deep(buckets.arena(), HeatmapBucketRef(time, begin));
+		bucketFull = false;
+	}
+	HeatmapBucketRef& bucket = buckets.back();
+	bucket.bytes += metrics.bytes;
+	bucket.bytesWrittenPerKSecond += metrics.bytesWrittenPerKSecond;
+	bucket.bytesReadPerKSecond += metrics.bytesReadPerKSecond;
+	bucket.opsReadPerKSecond += metrics.opsReadPerKSecond;
+	bucketFull = bucket.bytes >= bucketBytes;
+}
+
+Standalone<VectorRef<HeatmapBucketRef>> ShardHeatmap::SliceBuilder::finish() {
+	return std::move(buckets);
+}
+
+void ShardHeatmap::addSlice(Standalone<VectorRef<HeatmapBucketRef>> slice) {
+	if (history.size() >= std::max(maxSlices, 1)) {
+		history.pop_front();
+	}
+	history.push_back(std::move(slice));
+}
+
+Standalone<VectorRef<HeatmapBucketRef>> ShardHeatmap::get(KeyRangeRef keys, double since) const {
+	Standalone<VectorRef<HeatmapBucketRef>> result;
+	for (auto const& slice : history) {
+		if (slice.empty() || slice[0].time < since) {
+			continue;
+		}
+		for (int i = 0; i < slice.size(); ++i) {
+			KeyRef end = i + 1 < slice.size() ? slice[i + 1].beginKey : allKeys.end;
+			if (slice[i].beginKey < keys.end && keys.begin < end) {
+				result.push_back_deep(result.arena(), slice[i]);
+			}
+		}
+	}
+	return result;
+}
+
+// Takes a slice of the shard metrics for the heatmap every DD_HEATMAP_INTERVAL. Shards whose metrics aren't known yet
+// count as empty and idle.
+ACTOR Future<Void> shardHeatmapSampler(DataDistributionTracker* self) {
+	loop {
+		wait(delay(SERVER_KNOBS->DD_HEATMAP_INTERVAL, TaskPriority::DataDistributionLow));
+		std::vector<StorageMetrics> metrics;
+		int64_t totalBytes = 0;
+		for (auto shard : self->shards->ranges()) {
+			auto const& stats = shard.value().stats;
+			metrics.push_back(stats && stats->get().present() ? stats->get().get().metrics : StorageMetrics());
+			totalBytes += metrics.back().bytes;
+		}
+		ShardHeatmap::SliceBuilder builder(now(), totalBytes, SERVER_KNOBS->DD_HEATMAP_BUCKETS);
+		int i = 0;
+		for (auto shard : self->shards->ranges()) {
+			builder.addShard(shard.begin(), metrics[i++]);
+		}
+		self->heatmap->addSlice(builder.finish());
+	}
+}
+
+// Moves the shards of a piece of a bulk load to servers that load it from its files, after splitting the shards that
+// straddle its bounds. The split is skipped while their sizes are unknown, leaving data distribution to ask again.
+void bulkLoadShards(DataDistributionTracker* self, BulkLoadShardRequest req) {
+	self->bulkLoadTimes.insert(req.keys, now());
+	if (!req.relocate) {
+		return;
+	}
+	for (auto& range : findTenantShardBoundaries(self->shards, req.keys)) {
+		KeyRangeRef keys = KeyRangeRef(range.shard->begin(), range.shard->end());
+		traceSplit(keys, range.faultLines);
+		executeShardSplit(self, keys, range.faultLines, range.shard->value().stats, false, RelocateReason::OTHER);
+	}
+	for (auto shard : self->shards->intersectingRanges(req.keys)) {
+		if (req.keys.contains(shard.range())) {
+			self->output.send(RelocateShard(shard.range(), DataMovementReason::BULK_LOAD, RelocateReason::OTHER));
+		}
+	}
+	TraceEvent("DDTrackerBulkLoadShards", self->distributorId).detail("Range", req.keys);
+}
+
 void triggerStorageQueueRebalance(DataDistributionTracker* self, RebalanceStorageQueueRequest req) {
 	TraceEvent e("TriggerDataMoveStorageQueueRebalance", self->distributorId);
 	e.detail("Server", req.serverId);
@@ -1513,7 +1679,7 @@ DataDistributionTracker::DataDistributionTracker(DataDistributionTrackerInitPara
     output(params.output), shardsAffectedByTeamFailure(params.shardsAffectedByTeamFailure),
     physicalShardCollection(params.physicalShardCollection), readyToStart(params.readyToStart),
     anyZeroHealthyTeams(params.anyZeroHealthyTeams), trackerCancelled(params.trackerCancelled),
-    ddTenantCache(params.ddTenantCache) {}
+    ddTenantCache(params.ddTenantCache), heatmap(params.heatmap) {}
 
 DataDistributionTracker::~DataDistributionTracker() {
 	if (trackerCancelled) {
@@ -1533,6 +1699,10 @@ struct DataDistributionTrackerImpl {
 			wait(trackInitialShards(self, initData));
 			initData.clear(); // Release reference count.
 
+			if (self->heatmap) {
+				self->actors.add(shardHeatmapSampler(self));
+			}
+
 			state PromiseStream<TenantCacheTenantCreated> tenantCreationSignal;
 			if (SERVER_KNOBS->DD_TENANT_AWARENESS_ENABLED) {
 				ASSERT(self->ddTenantCache.present());
@@ -1564,6 +1734,9 @@ struct DataDistributionTrackerImpl {
 				when(RebalanceStorageQueueRequest req = waitNext(self->triggerStorageQueueRebalance)) {
 					triggerStorageQueueRebalance(self, req);
 				}
+				when(BulkLoadShardRequest req = waitNext(self->bulkLoadShards)) {
+					bulkLoadShards(self, req);
+				}
 				when(wait(self->actors.getResult())) {}
 				when(TenantCacheTenantCreated newTenant = waitNext(tenantCreationSignal.getFuture())) {
 					self->actors.add(tenantCreationHandling(self, newTenant));
@@ -1586,12 +1759,14 @@ Future<Void> DataDistributionTracker::run(
     const FutureStream<GetTopKMetricsRequest>& getTopKMetrics,
     const FutureStream<GetMetricsListRequest>& getShardMetricsList,
     const FutureStream<Promise<int64_t>>& getAverageShardBytes,
-    const FutureStream<RebalanceStorageQueueRequest>& triggerStorageQueueRebalance) {
+    const FutureStream<RebalanceStorageQueueRequest>& triggerStorageQueueRebalance,
+    const FutureStream<BulkLoadShardRequest>& bulkLoadShards) {
 	self->getShardMetrics = getShardMetrics;
 	self->getTopKMetrics = getTopKMetrics;
 	self->getShardMetricsList = getShardMetricsList;
 	self->averageShardBytes = getAverageShardBytes;
 	self->triggerStorageQueueRebalance = triggerStorageQueueRebalance;
+	self->bulkLoadShards = bulkLoadShards;
 	self->userRangeConfig = initData->userRangeConfig;
 	return holdWhile(self, DataDistributionTrackerImpl::run(self.getPtr(), initData));
 }
@@ -2295,3 +2470,51 @@ TEST_CASE("/DataDistributor/Tracker/FetchTopK") {
 
 	return Void();
 }
+
+TEST_CASE("/DataDistributor/Tracker/Heatmap") {
+	StorageMetrics small, big;
+	small.bytes = 10;
+	small.bytesWrittenPerKSecond = 1;
+	small.opsReadPerKSecond = 2;
+	big.bytes = 100;
+	big.bytesReadPerKSecond = 50;
+
+	// Shards are grouped until a bucket holds a third of the bytes
+	ShardHeatmap heatmap(2);
+	ShardHeatmap::SliceBuilder first(1.0, 150, 3);
+	first.addShard(""_sr, small);
+	first.addShard("b"_sr, small);
+	first.addShard("c"_sr, small);
+	first.addShard("d"_sr, small);
+	first.addShard("e"_sr, small);
+	first.addShard("f"_sr, big);
+	first.addShard("g"_sr, small);
+	heatmap.addSlice(first.finish());
+
+	Standalone<VectorRef<HeatmapBucketRef>> buckets = heatmap.get(allKeys, 0);
+	ASSERT(buckets.size() == 3);
+	ASSERT(buckets[0].beginKey == ""_sr && buckets[0].bytes == 50 && buckets[0].bytesWrittenPerKSecond == 5 &&
+	       buckets[0].opsReadPerKSecond == 10);
+	ASSERT(buckets[1].beginKey == "f"_sr && buckets[1].bytes == 100 && buckets[1].bytesReadPerKSecond == 50);
+	ASSERT(buckets[2].beginKey == "g"_sr && buckets[2].bytes == 10 && buckets[2].time == 1.0);
+
+	// A bucket is returned if it intersects the keys, though it begins before them
+	buckets = heatmap.get(KeyRangeRef("c"_sr, "f\x00"_sr), 0);
+	ASSERT(buckets.size() == 2);
+	ASSERT(buckets[0].beginKey == ""_sr && buckets[1].beginKey == "f"_sr);
+
+	// Only the newest maxSlices slices are kept
+	for (double time : { 2.0, 3.0 }) {
+		ShardHeatmap::SliceBuilder builder(time, 0, 3);
+		builder.addShard(""_sr, StorageMetrics());
+		heatmap.addSlice(builder.finish());
+	}
+	ASSERT(heatmap.slices() == 2);
+	buckets = heatmap.get(allKeys, 0);
+	ASSERT(buckets.size() == 2);
+	ASSERT(buckets[0].time == 2.0 && buckets[1].time == 3.0);
+	buckets = heatmap.get(allKeys, 2.5);
+	ASSERT(buckets.size() == 1 && buckets[0].time == 3.0);
+
+	return Void();
+}
@@ -4909,36 +4909,35 @@ int DDTeamCollection::addBestMachineTeams(int machineTeamsToBuild) {
 	// Step 1: Create machineLocalityMap which will be used in building machine team
 	rebuildMachineLocalityMap();
 
-	// Add a team in each iteration
-	while (addedMachineTeams < machineTeamsToBuild || notEnoughMachineTeamsForAMachine()) {
-		// Step 2: Get least used machines from which we choose machines as a machine team
-		std::vector<Reference<TCMachineInfo>> leastUsedMachines; // A less used machine has less number of teams
-		int minTeamCount = std::numeric_limits<int>::max();
-		for (auto& machine : machine_info) {
-			// Skip invalid machine whose representative server is not in server_info
-			ASSERT_WE_THINK(server_info.find(machine.second->serversOnMachine[0]->getId()) != server_info.end());
-			// Skip unhealthy machines
-			if (!isMachineHealthy(machine.second))
-				continue;
-			// Skip machine with incomplete locality
-			if (!isValidLocality(configuration.storagePolicy,
-			                     machine.second->serversOnMachine[0]->getLastKnownInterface().locality)) {
-				continue;
-			}
-
-			// Invariant: We only create correct size machine teams.
-			// When configuration (e.g., team size) is changed, the DDTeamCollection will be destroyed and rebuilt
-			// so that the invariant will not be violated.
-			int teamCount = machine.second->machineTeams.size();
+	// Step 2: Index the healthy machines by their number of machine teams. Machines with incomplete locality can't be
+	// chosen for a team, but still count towards notEnoughMachineTeamsForAMachine().
+	// Invariant: We only create correct size machine teams.
+	// When configuration (e.g., team size) is changed, the DDTeamCollection will be destroyed and rebuilt
+	// so that the invariant will not be violated.
+	TeamCountIndex<TCMachineInfo> healthyMachines;
+	TeamCountIndex<TCMachineInfo> candidateMachines;
+	for (auto& [_, machine] : machine_info) {
+		// Skip invalid machine whose representative server is not in server_info
+		ASSERT_WE_THINK(server_info.find(machine->serversOnMachine[0]->getId()) != server_info.end());
+		// Skip unhealthy machines
+		if (!isMachineHealthy(machine))
+			continue;
+		healthyMachines.add(machine, machine->machineTeams.size());
+		if (isValidLocality(configuration.storagePolicy,
+		                    machine->serversOnMachine[0]->getLastKnownInterface().locality)) {
+			candidateMachines.add(machine, machine->machineTeams.size());
+		}
+	}
 
-			if (teamCount < minTeamCount) {
-				leastUsedMachines.clear();
-				minTeamCount = teamCount;
-			}
-			if (teamCount == minTeamCount) {
-				leastUsedMachines.push_back(machine.second);
-			}
+	// Add a team in each iteration
+	while (addedMachineTeams < machineTeamsToBuild || notEnoughMachineTeamsForAMachine(healthyMachines)) {
+		// when there is no candidate machine, we will never find a team, so we can simply return.
+		if (candidateMachines.empty()) {
+			return addedMachineTeams;
 		}
+		// Get least used machines from which we choose machines as a machine team
+		// A less used machine has less number of teams
+		std::vector<Reference<TCMachineInfo>> const& leastUsedMachines = candidateMachines.leastUsed();
 
 		std::vector<UID*> team;
 		std::vector<LocalityEntry> forcedAttributes;
@@ -4949,22 +4948,17 @@ int DDTeamCollection::addBestMachineTeams(int machineTeamsToBuild) {
 			// Step 3: Create a representative process for each machine.
 			// Construct forcedAttribute from leastUsedMachines.
 			// We will use forcedAttribute to call existing function to form a team
-			if (leastUsedMachines.size()) {
-				forcedAttributes.clear();
-				// Randomly choose 1 least used machine
-				Reference<TCMachineInfo> tcMachineInfo = deterministicRandom()->randomChoice(leastUsedMachines);
-				ASSERT(!tcMachineInfo->serversOnMachine.empty());
-				LocalityEntry process = tcMachineInfo->localityEntry;
-				forcedAttributes.push_back(process);
-				TraceEvent("ChosenMachine")
-				    .suppressFor(30.0)
-				    .detail("MachineInfo", tcMachineInfo->machineID)
-				    .detail("LeaseUsedMachinesSize", leastUsedMachines.size())
-				    .detail("ForcedAttributesSize", forcedAttributes.size());
-			} else {
-				// when leastUsedMachine is empty, we will never find a team later, so we can simply return.
-				return addedMachineTeams;
-			}
+			forcedAttributes.clear();
+			// Randomly choose 1 least used machine
+			Reference<TCMachineInfo> tcMachineInfo = deterministicRandom()->randomChoice(leastUsedMachines);
+			ASSERT(!tcMachineInfo->serversOnMachine.empty());
+			LocalityEntry process = tcMachineInfo->localityEntry;
+			forcedAttributes.push_back(process);
+			TraceEvent("ChosenMachine")
+			    .suppressFor(30.0)
+			    .detail("MachineInfo", tcMachineInfo->machineID)
+			    .detail("LeaseUsedMachinesSize", leastUsedMachines.size())
+			    .detail("ForcedAttributesSize", forcedAttributes.size());
 
 			// Choose a team that balances the # of teams per server among the teams
 			// that have the least-utilized server
@@ -5029,6 +5023,10 @@ int DDTeamCollection::addBestMachineTeams(int machineTeamsToBuild) {
 
 			addMachineTeam(machines);
 			addedMachineTeams++;
+			for (auto& machine : machines) {
+				healthyMachines.update(machine, machine->machineTeams.size());
+				candidateMachines.update(machine, machine->machineTeams.size());
+			}
 		} else {
 			// When too many teams exist in simulation, traceAllInfo will buffer too many trace logs before
 			// trace has a chance to flush its buffer, which causes assertion failure.
@@ -5045,34 +5043,15 @@ int DDTeamCollection::addBestMachineTeams(int machineTeamsToBuild) {
 	return addedMachineTeams;
 }
 
-Reference<TCServerInfo> DDTeamCollection::findOneLeastUsedServer() const {
-	std::vector<Reference<TCServerInfo>> leastUsedServers;
-	int minTeams = std::numeric_limits<int>::max();
-	for (auto& [serverID, server] : server_info) {
-		// Only pick healthy server, which is not failed or excluded.
-		if (server_status.get(serverID).isUnhealthy())
-			continue;
-		if (!isValidLocality(configuration.storagePolicy, server->getLastKnownInterface().locality))
-			continue;
-
-		int numTeams = server->getTeams().size();
-		if (numTeams < minTeams) {
-			minTeams = numTeams;
-			leastUsedServers.clear();
-		}
-		if (minTeams == numTeams) {
-			leastUsedServers.push_back(server);
-		}
-	}
-
-	if (leastUsedServers.empty()) {
+Reference<TCServerInfo> DDTeamCollection::findOneLeastUsedServer(TeamCountIndex<TCServerInfo> const& candidates) const {
+	if (candidates.empty()) {
 		// If we cannot find a healthy server with valid locality
 		TraceEvent("NoHealthyAndValidLocalityServers")
 		    .detail("Servers", server_info.size())
 		    .detail("UnhealthyServers", unhealthyServers);
 		return Reference<TCServerInfo>();
 	} else {
-		return deterministicRandom()->randomChoice(leastUsedServers);
+		return deterministicRandom()->randomChoice(candidates.leastUsed());
 	}
 }
 
@@ -5268,13 +5247,16 @@ int DDTeamCollection::getHealthyMachineTeamCount() const {
 	return healthyTeamCount;
 }
 
-bool DDTeamCollection::notEnoughMachineTeamsForAMachine() const {
+int DDTeamCollection::targetMachineTeamNumPerMachine() const {
 	// If we want to remove the machine team with most machine teams, we use the same logic as
 	// notEnoughTeamsForAServer
-	int targetMachineTeamNumPerMachine =
-	    SERVER_KNOBS->TR_FLAG_REMOVE_MT_WITH_MOST_TEAMS
-	        ? (SERVER_KNOBS->DESIRED_TEAMS_PER_SERVER * (configuration.storageTeamSize + 1)) / 2
-	        : SERVER_KNOBS->DESIRED_TEAMS_PER_SERVER;
+	return SERVER_KNOBS->TR_FLAG_REMOVE_MT_WITH_MOST_TEAMS
+	           ? (SERVER_KNOBS->DESIRED_TEAMS_PER_SERVER * (configuration.storageTeamSize + 1)) / 2
+	           : SERVER_KNOBS->DESIRED_TEAMS_PER_SERVER;
+}
+
+bool DDTeamCollection::notEnoughMachineTeamsForAMachine() const {
+	int targetMachineTeamNumPerMachine = this->targetMachineTeamNumPerMachine();
 	for (auto& [_, machine] : machine_info) {
 		// If SERVER_KNOBS->TR_FLAG_REMOVE_MT_WITH_MOST_TEAMS is false,
 		// The desired machine team number is not the same with the desired server team number
@@ -5288,7 +5270,11 @@ bool DDTeamCollection::notEnoughMachineTeamsForAMachine() const {
 	return false;
 }
 
-bool DDTeamCollection::notEnoughTeamsForAServer() const {
+bool DDTeamCollection::notEnoughMachineTeamsForAMachine(TeamCountIndex<TCMachineInfo> const& healthyMachines) const {
+	return !healthyMachines.empty() && healthyMachines.minTeamCount() < targetMachineTeamNumPerMachine();
+}
+
+int DDTeamCollection::targetTeamNumPerServer() const {
 	// We build more teams than we finally want so that we can use serverTeamRemover() actor to remove the teams
 	// whose member belong to too many teams. This allows us to get a more balanced number of teams per server.
 	// We want to ensure every server has targetTeamNumPerServer teams.
@@ -5298,6 +5284,15 @@ bool DDTeamCollection::notEnoughTeamsForAServer() const {
 	// (#servers * DESIRED_TEAMS_PER_SERVER * storageTeamSize) / #servers.
 	int targetTeamNumPerServer = (SERVER_KNOBS->DESIRED_TEAMS_PER_SERVER * (configuration.storageTeamSize + 1)) / 2;
 	ASSERT_GT(targetTeamNumPerServer, 0);
+	return targetTeamNumPerServer;
+}
+
+bool DDTeamCollection::notEnoughTeamsForAServer(TeamCountIndex<TCServerInfo> const& healthyServers) const {
+	return !healthyServers.empty() && healthyServers.minTeamCount() < targetTeamNumPerServer();
+}
+
+bool DDTeamCollection::notEnoughTeamsForAServer() const {
+	int targetTeamNumPerServer = this->targetTeamNumPerServer();
 	for (auto& [serverID, server] : server_info) {
 		if (server->getTeams().size() < targetTeamNumPerServer && !server_status.get(serverID).isUnhealthy()) {
 			return true;
@@ -5361,14 +5356,27 @@ int DDTeamCollection::addTeamsBestOf(int teamsToBuild, int desiredTeams, int max
 		}
 	}
 
-	while (addedTeams < teamsToBuild || notEnoughTeamsForAServer()) {
+	// Index the healthy servers, which are not failed or excluded, by their number of teams. Only those with a valid
+	// locality can be chosen for a team.
+	TeamCountIndex<TCServerInfo> healthyServers;
+	TeamCountIndex<TCServerInfo> candidateServers;
+	for (auto& [serverID, server] : server_info) {
+		if (server_status.get(serverID).isUnhealthy())
+			continue;
+		healthyServers.add(server, server->getTeams().size());
+		if (isValidLocality(configuration.storagePolicy, server->getLastKnownInterface().locality)) {
+			candidateServers.add(server, server->getTeams().size());
+		}
+	}
+
+	while (addedTeams < teamsToBuild || notEnoughTeamsForAServer(healthyServers)) {
 		std::vector<UID> bestServerTeam;
 		int bestScore = std::numeric_limits<int>::max();
 		int maxAttempts = SERVER_KNOBS->BEST_OF_AMT; // BEST_OF_AMT = 4
 		bool earlyQuitBuild = false;
 		for (int i = 0; i < maxAttempts && i < 100; ++i) {
 			// Step 1: Choose 1 least used server and then choose 1 least used machine team from the server
-			Reference<TCServerInfo> chosenServer = findOneLeastUsedServer();
+			Reference<TCServerInfo> chosenServer = findOneLeastUsedServer(candidateServers);
 			if (!chosenServer.isValid()) {
 				TraceEvent(SevWarn, "NoValidServer").detail("Primary", primary);
 				earlyQuitBuild = true;
@@ -5451,6 +5459,11 @@ int DDTeamCollection::addTeamsBestOf(int teamsToBuild, int desiredTeams, int max
 		// Step 4: Add the server team
 		addTeam(bestServerTeam.begin(), bestServerTeam.end(), IsInitialTeam::False);
 		addedTeams++;
+		for (auto& serverID : bestServerTeam) {
+			const Reference<TCServerInfo>& server = server_info[serverID];
+			healthyServers.update(server, server->getTeams().size());
+			candidateServers.update(server, server->getTeams().size());
+		}
 	}
 
 	healthyMachineTeamCount = getHealthyMachineTeamCount();
@@ -6977,4 +6990,30 @@ TEST_CASE("/DataDistribution/GetTeam/PreferWithinShardRange") {
 	}
 	wait(DDTeamCollectionUnitTest::GetTeam_PreferShardsWithinLimit());
 	return Void();
-}
\ No newline at end of file
+}
+TEST_CASE("/DataDistribution/TeamCountIndex") {
+	struct Candidate : ReferenceCounted<Candidate> {};
+	std::vector<Reference<Candidate>> candidates;
+	TeamCountIndex<Candidate> index;
+	ASSERT(index.empty());
+	for (int i = 0; i < 4; i++) {
+		candidates.push_back(makeReference<Candidate>());
+		index.add(candidates.back(), i % 2);
+	}
+	ASSERT(index.size() == 4 && index.minTeamCount() == 0 && index.leastUsed().size() == 2);
+
+	// Updating a candidate through a reference into the index itself must work
+	index.update(index.leastUsed()[0], 1);
+	ASSERT(index.minTeamCount() == 0 && index.leastUsed().size() == 1);
+	index.update(index.leastUsed()[0], 3);
+	ASSERT(index.minTeamCount() == 1 && index.leastUsed().size() == 3);
+	for (auto& candidate : candidates) {
+		index.update(candidate, 5);
+	}
+	ASSERT(index.size() == 4 && index.minTeamCount() == 5 && index.leastUsed().size() == 4);
+
+	// Updating something that isn't a candidate does nothing
+	index.update(makeReference<Candidate>(), 0);
+	ASSERT(index.size() == 4 && index.minTeamCount() == 5);
+	return Void();
+}
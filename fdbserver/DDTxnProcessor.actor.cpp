@@ -42,6 +42,15 @@ static void updateServersAndCompleteSources(std::set<UID>& servers,
 	}
 }
 
+// A keyServers entry: the beginning of a shard and the servers that hold it
+struct InitialShardLocation {
+	Key key;
+	std::vector<UID> src;
+	std::vector<UID> dest;
+	UID srcId;
+	UID destId;
+};
+
 class DDTxnProcessorImpl {
 	friend class DDTxnProcessor;
 
@@ -233,6 +242,152 @@ class DDTxnProcessorImpl {
 		}
 	}
 
+	// Appends the shard beginning at key to result, splitting its teams by DC and adding them to the team sets
+	static void addInitialShard(Reference<InitialDataDistribution> const& result,
+	                            Key const& key,
+	                            std::vector<UID> const& src,
+	                            std::vector<UID> const& dest,
+	                            UID srcId,
+	                            UID destId,
+	                            std::vector<Optional<Key>> const& remoteDcIds,
+	                            std::map<UID, Optional<Key>>& server_dc,
+	                            std::map<std::vector<UID>, std::pair<std::vector<UID>, std::vector<UID>>>& team_cache) {
+		DDShardInfo info(key, srcId, destId);
+		if (remoteDcIds.size()) {
+			auto srcIter = team_cache.find(src);
+			if (srcIter == team_cache.end()) {
+				for (auto& id : src) {
+					auto& dc = server_dc[id];
+					if (std::find(remoteDcIds.begin(), remoteDcIds.end(), dc) != remoteDcIds.end()) {
+						info.remoteSrc.push_back(id);
+					} else {
+						info.primarySrc.push_back(id);
+					}
+				}
+				result->primaryTeams.insert(info.primarySrc);
+				result->remoteTeams.insert(info.remoteSrc);
+				team_cache[src] = std::make_pair(info.primarySrc, info.remoteSrc);
+			} else {
+				info.primarySrc = srcIter->second.first;
+				info.remoteSrc = srcIter->second.second;
+			}
+			if (dest.size()) {
+				info.hasDest = true;
+				auto destIter = team_cache.find(dest);
+				if (destIter == team_cache.end()) {
+					for (auto& id : dest) {
+						auto& dc = server_dc[id];
+						if (std::find(remoteDcIds.begin(), remoteDcIds.end(), dc) != remoteDcIds.end()) {
+							info.remoteDest.push_back(id);
+						} else {
+							info.primaryDest.push_back(id);
+						}
+					}
+					result->primaryTeams.insert(info.primaryDest);
+					result->remoteTeams.insert(info.remoteDest);
+					team_cache[dest] = std::make_pair(info.primaryDest, info.remoteDest);
+				} else {
+					info.primaryDest = destIter->second.first;
+					info.remoteDest = destIter->second.second;
+				}
+			}
+		} else {
+			info.primarySrc = src;
+			auto srcIter = team_cache.find(src);
+			if (srcIter == team_cache.end()) {
+				result->primaryTeams.insert(src);
+				team_cache[src] = std::pair<std::vector<UID>, std::vector<UID>>();
+			}
+			if (dest.size()) {
+				info.hasDest = true;
+				info.primaryDest = dest;
+				auto destIter = team_cache.find(dest);
+				if (destIter == team_cache.end()) {
+					result->primaryTeams.insert(dest);
+					team_cache[dest] = std::pair<std::vector<UID>, std::vector<UID>>();
+				}
+			}
+		}
+		result->shards.push_back(info);
+	}
+
+	// Returns keys that split the shard map into ranges of about DD_INITIAL_LOAD_CHUNK_BYTES of keyServers, including
+	// allKeys.begin and allKeys.end
+	ACTOR static Future<std::vector<Key>> getShardMapSplitPoints(Database cx) {
+		state Transaction tr(cx);
+		loop {
+			tr.setOption(FDBTransactionOptions::READ_SYSTEM_KEYS);
+			tr.setOption(FDBTransactionOptions::READ_LOCK_AWARE);
+			tr.setOption(FDBTransactionOptions::PRIORITY_SYSTEM_IMMEDIATE);
+			try {
+				Standalone<VectorRef<KeyRef>> splitPoints =
+				    wait(tr.getRangeSplitPoints(keyServersKeys, SERVER_KNOBS->DD_INITIAL_LOAD_CHUNK_BYTES));
+				std::vector<Key> result{ allKeys.begin };
+				for (auto const& splitPoint : splitPoints) {
+					if (!splitPoint.startsWith(keyServersPrefix)) {
+						continue;
+					}
+					Key key = splitPoint.removePrefix(keyServersPrefix);
+					if (key > result.back() && key < allKeys.end) {
+						result.push_back(key);
+					}
+				}
+				result.push_back(allKeys.end);
+				return result;
+			} catch (Error& e) {
+				wait(tr.onError(e));
+			}
+		}
+	}
+
+	// Reads and decodes the keyServers entries in keys, each the beginning of a shard, in as many transactions as
+	// needed
+	ACTOR static Future<std::vector<InitialShardLocation>> readShardLocations(Database cx,
+	                                                                          UID distributorId,
+	                                                                          MoveKeysLock moveKeysLock,
+	                                                                          const DDEnabledState* ddEnabledState,
+	                                                                          FlowLock* readLock,
+	                                                                          KeyRange keys) {
+		state std::vector<InitialShardLocation> locations;
+		state Key beginKey = keys.begin;
+		state Transaction tr(cx);
+
+		wait(readLock->take(TaskPriority::DataDistribution));
+		state FlowLock::Releaser releaser(*readLock);
+
+		while (beginKey < keys.end) {
+			loop {
+				try {
+					tr.setOption(FDBTransactionOptions::READ_SYSTEM_KEYS);
+					tr.setOption(FDBTransactionOptions::READ_LOCK_AWARE);
+					tr.setOption(FDBTransactionOptions::PRIORITY_SYSTEM_IMMEDIATE);
+					wait(checkMoveKeysLockReadOnly(&tr, moveKeysLock, ddEnabledState));
+					state RangeResult UIDtoTagMap = wait(tr.getRange(serverTagKeys, CLIENT_KNOBS->TOO_MANY));
+					ASSERT(!UIDtoTagMap.more && UIDtoTagMap.size() < CLIENT_KNOBS->TOO_MANY);
+					RangeResult keyServers =
+					    wait(tr.getRange(KeyRangeRef(beginKey.withPrefix(keyServersPrefix),
+					                                 keys.end.withPrefix(keyServersPrefix)),
+					                     GetRangeLimits(SERVER_KNOBS->MOVE_KEYS_KRM_LIMIT,
+					                                    SERVER_KNOBS->MOVE_KEYS_KRM_LIMIT_BYTES)));
+
+					for (auto const& kv : keyServers) {
+						InitialShardLocation& location = locations.emplace_back();
+						location.key = kv.key.removePrefix(keyServersPrefix);
+						decodeKeyServersValue(
+						    UIDtoTagMap, kv.value, location.src, location.dest, location.srcId, location.destId);
+					}
+					beginKey = keyServers.more ? keyAfter(locations.back().key) : keys.end;
+					break;
+				} catch (Error& e) {
+					TraceEvent("GetInitialTeamsKeyServersRetry", distributorId).error(e);
+					wait(tr.onError(e));
+				}
+			}
+			tr.reset();
+		}
+		return locations;
+	}
+
 	// Read keyservers, return unique set of teams
 	ACTOR static Future<Reference<InitialDataDistribution>> getInitialDataDistribution(
 	    Database cx,
@@ -375,6 +530,44 @@ class DDTxnProcessorImpl {
 			}
 		}
 
+		// Read the shard map as ranges of about equal size in parallel, then build the shards from them in key order
+		if (SERVER_KNOBS->DD_PARALLEL_INITIAL_LOAD) {
+			state double loadStart = now();
+			state std::vector<Key> splitPoints = wait(getShardMapSplitPoints(cx));
+			state Reference<FlowLock> readLock = makeReference<FlowLock>(SERVER_KNOBS->DD_INITIAL_LOAD_PARALLELISM);
+			state std::vector<Future<std::vector<InitialShardLocation>>> reads;
+			for (int i = 0; i < splitPoints.size() - 1; i++) {
+				reads.push_back(readShardLocations(cx,
+				                                   distributorId,
+				                                   moveKeysLock,
+				                                   ddEnabledState,
+				                                   readLock.getPtr(),
+				                                   KeyRangeRef(splitPoints[i], splitPoints[i + 1])));
+			}
+			wait(waitForAll(reads));
+			CODE_PROBE(reads.size() > 1, "Parallel getInitialDataDistribution");
+
+			for (auto const& read : reads) {
+				for (auto const& location : read.get()) {
+					addInitialShard(result,
+					                location.key,
+					                location.src,
+					                location.dest,
+					                location.srcId,
+					                location.destId,
+					                remoteDcIds,
+					                server_dc,
+					                team_cache);
+				}
+			}
+			ASSERT(!result->shards.empty() && result->shards.front().key == allKeys.begin);
+			TraceEvent("DDInitialShardMapLoaded", distributorId)
+			    .detail("Ranges", reads.size())
+			    .detail("Shards", result->shards.size())
+			    .detail("Duration", now() - loadStart);
+			beginKey = allKeys.end;
+		}
+
 		// If keyServers is too large to read in a single transaction, then we will have to break this process up into
 		// multiple transactions. In that case, each iteration should begin where the previous left off
 		while (beginKey < allKeys.end) {
@@ -395,70 +588,14 @@ class DDTxnProcessorImpl {
 					                                           SERVER_KNOBS->MOVE_KEYS_KRM_LIMIT_BYTES));
 					succeeded = true;
 
-					std::vector<UID> src, dest, last;
+					std::vector<UID> src, dest;
 					UID srcId, destId;
 
 					// for each range
 					for (int i = 0; i < keyServers.size() - 1; i++) {
 						decodeKeyServersValue(UIDtoTagMap, keyServers[i].value, src, dest, srcId, destId);
-						DDShardInfo info(keyServers[i].key, srcId, destId);
-						if (remoteDcIds.size()) {
-							auto srcIter = team_cache.find(src);
-							if (srcIter == team_cache.end()) {
-								for (auto& id : src) {
-									auto& dc = server_dc[id];
-									if (std::find(remoteDcIds.begin(), remoteDcIds.end(), dc) != remoteDcIds.end()) {
-										info.remoteSrc.push_back(id);
-									} else {
-										info.primarySrc.push_back(id);
-									}
-								}
-								result->primaryTeams.insert(info.primarySrc);
-								result->remoteTeams.insert(info.remoteSrc);
-								team_cache[src] = std::make_pair(info.primarySrc, info.remoteSrc);
-							} else {
-								info.primarySrc = srcIter->second.first;
-								info.remoteSrc = srcIter->second.second;
-							}
-							if (dest.size()) {
-								info.hasDest = true;
-								auto destIter = team_cache.find(dest);
-								if (destIter == team_cache.end()) {
-									for (auto& id : dest) {
-										auto& dc = server_dc[id];
-										if (std::find(remoteDcIds.begin(), remoteDcIds.end(), dc) !=
-										    remoteDcIds.end()) {
-											info.remoteDest.push_back(id);
-										} else {
-											info.primaryDest.push_back(id);
-										}
-									}
-									result->primaryTeams.insert(info.primaryDest);
-									result->remoteTeams.insert(info.remoteDest);
-									team_cache[dest] = std::make_pair(info.primaryDest, info.remoteDest);
-								} else {
-									info.primaryDest = destIter->second.first;
-									info.remoteDest = destIter->second.second;
-								}
-							}
-						} else {
-							info.primarySrc = src;
-							auto srcIter = team_cache.find(src);
-							if (srcIter == team_cache.end()) {
-								result->primaryTeams.insert(src);
-								team_cache[src] = std::pair<std::vector<UID>, std::vector<UID>>();
-							}
-							if (dest.size()) {
-								info.hasDest = true;
-								info.primaryDest = dest;
-								auto destIter = team_cache.find(dest);
-								if (destIter == team_cache.end()) {
-									result->primaryTeams.insert(dest);
-									team_cache[dest] = std::pair<std::vector<UID>, std::vector<UID>>();
-								}
-							}
-						}
-						result->shards.push_back(info);
+						addInitialShard(
+						    result, keyServers[i].key, src, dest, srcId, destId, remoteDcIds, server_dc, team_cache);
 					}
 
 					ASSERT_GT(keyServers.size(), 0);
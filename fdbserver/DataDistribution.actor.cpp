@@ -23,6 +23,8 @@
 
 #include "fdbclient/Audit.h"
 #include "fdbclient/AuditUtils.actor.h"
+#include "fdbclient/BackupContainer.h"
+#include "fdbclient/BulkLoadUtils.actor.h"
 #include "fdbclient/DatabaseContext.h"
 #include "fdbclient/FDBOptions.g.h"
 #include "fdbclient/FDBTypes.h"
@@ -56,7 +58,8 @@
 #include "flow/actorcompiler.h" // This must be the last #include.
 
 void RelocateShard::setParentRange(KeyRange const& parent) {
-	ASSERT(reason == RelocateReason::WRITE_SPLIT || reason == RelocateReason::SIZE_SPLIT);
+	ASSERT(reason == RelocateReason::WRITE_SPLIT || reason == RelocateReason::SIZE_SPLIT ||
+	       reason == RelocateReason::READ_SPLIT);
 	parent_range = parent;
 }
 
@@ -321,6 +324,13 @@ ACTOR Future<Void> debugCheckCoalescing(Database cx) {
 	}
 }
 
+// Returns whether every storage server uses sharded RocksDB, and is not being migrated to another storage engine
+static bool shardedRocksDBOnly(const DatabaseConfiguration& configuration) {
+	return configuration.storageServerStoreType == KeyValueStoreType::SSD_SHARDED_ROCKSDB &&
+	       (!configuration.perpetualStoreType.isValid() ||
+	        configuration.perpetualStoreType == KeyValueStoreType::SSD_SHARDED_ROCKSDB);
+}
+
 struct DataDistributor;
 void runAuditStorage(
     Reference<DataDistributor> self,
@@ -401,6 +411,8 @@ public:
 
 	Optional<Reference<TenantCache>> ddTenantCache;
 
+	ShardHeatmap heatmap;
+
 	// monitor DD configuration change
 	Promise<Version> configChangeWatching;
 	Future<Void> onConfigChange;
@@ -413,7 +425,7 @@ public:
 	    totalDataInFlightRemoteEventHolder(makeReference<EventCacheHolder>("TotalDataInFlightRemote")),
 	    teamCollection(nullptr), auditStorageHaLaunchingLock(1), auditStorageReplicaLaunchingLock(1),
 	    auditStorageLocationMetadataLaunchingLock(1), auditStorageSsShardLaunchingLock(1),
-	    auditStorageInitStarted(false) {}
+	    auditStorageInitStarted(false), heatmap(SERVER_KNOBS->DD_HEATMAP_SLICES) {}
 
 	// bootstrap steps
 
@@ -994,6 +1006,314 @@ ACTOR Future<Void> serveBlobMigratorRequests(Reference<DataDistributor> self,
 	}
 }
 
+// Writes task as Failed over its range
+ACTOR Future<Void> failBulkLoadTask(Database cx, BulkLoadState task, std::string error) {
+	state Transaction tr(cx);
+	task.setPhase(BulkLoadPhase::Failed);
+	task.error = error;
+	task.piece = task.range;
+	task.files.clear();
+	task.bytes = 0;
+	loop {
+		try {
+			tr.setOption(FDBTransactionOptions::PRIORITY_SYSTEM_IMMEDIATE);
+			tr.setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+			tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+			bool set = wait(setBulkLoadStates(&tr, task.taskId, { task }));
+			if (!set) {
+				return Void();
+			}
+			wait(tr.commit());
+			break;
+		} catch (Error& e) {
+			wait(tr.onError(e));
+		}
+	}
+	TraceEvent(SevWarn, "DDBulkLoadFailed")
+	    .detail("TaskID", task.taskId)
+	    .detail("Range", task.range)
+	    .detail("Error", error);
+	return Void();
+}
+
+// Selects the range files of a submitted task and splits it into running pieces. A task that can't be run is failed,
+// while other errors are retried at the next poll.
+ACTOR Future<Void> startBulkLoadTask(Database cx, BulkLoadState task) {
+	state Reference<IBackupContainer> bc;
+	state Optional<RestorableFileSet> fileSet;
+	state std::vector<BulkLoadState> pieces;
+	state Transaction tr(cx);
+	state int i = 0;
+	state int batchEnd;
+
+	if (!SERVER_KNOBS->SHARD_ENCODE_LOCATION_METADATA) {
+		wait(failBulkLoadTask(cx, task, "Bulk loading needs SHARD_ENCODE_LOCATION_METADATA"));
+		return Void();
+	}
+
+	try {
+		bc = IBackupContainer::openContainer(task.url, {}, {});
+		wait(store(fileSet, bc->getRestoreSet(task.version, VectorRef<KeyRangeRef>(&task.range, 1))));
+	} catch (Error& e) {
+		if (e.code() != error_code_backup_invalid_url &&
+		    e.code() != error_code_backup_not_overlapped_with_keys_filter &&
+		    e.code() != error_code_backup_does_not_exist) {
+			throw;
+		}
+		wait(failBulkLoadTask(cx, task, e.what()));
+		return Void();
+	}
+
+	// The pieces are loaded from range files alone, so they must all be at the version of the snapshot
+	if (!fileSet.present() || !fileSet.get().logs.empty() || fileSet.get().continuousBeginVersion != invalidVersion ||
+	    fileSet.get().keyRanges.empty()) {
+		wait(failBulkLoadTask(cx, task, "The backup has no snapshot of the range at a single version"));
+		return Void();
+	}
+	std::vector<KeyRange> fileRanges;
+	for (const auto& [fileName, keys] : fileSet.get().keyRanges) {
+		fileRanges.push_back(keys);
+	}
+	std::sort(fileRanges.begin(), fileRanges.end(), [](const auto& a, const auto& b) { return a.begin < b.begin; });
+	bool overlap = false;
+	for (int j = 1; j < fileRanges.size(); ++j) {
+		overlap = overlap || fileRanges[j].begin < fileRanges[j - 1].end;
+	}
+	if (overlap) {
+		wait(failBulkLoadTask(cx, task, "The range files of the backup overlap"));
+		return Void();
+	}
+
+	pieces = splitBulkLoadTask(
+	    task, fileSet.get(), SERVER_KNOBS->DD_BULK_LOAD_PIECE_BYTES, CLIENT_KNOBS->VALUE_SIZE_LIMIT / 2);
+	for (auto& piece : pieces) {
+		piece.version = fileSet.get().targetVersion;
+	}
+
+	// The entries of a transaction are bounded by a fraction of its size limit, so pieces are written in batches
+	while (i < pieces.size()) {
+		int64_t batchBytes = 0;
+		for (batchEnd = i; batchEnd < pieces.size() &&
+		                   (batchEnd == i || batchBytes < CLIENT_KNOBS->TRANSACTION_SIZE_LIMIT / 4);
+		     ++batchEnd) {
+			batchBytes += bulkLoadStateValue(pieces[batchEnd]).size();
+		}
+		loop {
+			try {
+				tr.setOption(FDBTransactionOptions::PRIORITY_SYSTEM_IMMEDIATE);
+				tr.setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+				tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+				RangeResult existing = wait(tr.getRange(task.range, 1));
+				if (!existing.empty()) {
+					break;
+				}
+				bool set = wait(setBulkLoadStates(
+				    &tr, task.taskId, std::vector<BulkLoadState>(pieces.begin() + i, pieces.begin() + batchEnd)));
+				if (!set) {
+					return Void();
+				}
+				wait(tr.commit());
+				i = batchEnd;
+				tr.reset();
+				break;
+			} catch (Error& e) {
+				wait(tr.onError(e));
+			}
+		}
+		if (i < batchEnd) {
+			wait(failBulkLoadTask(cx, task, "The range is not empty"));
+			return Void();
+		}
+	}
+
+	TraceEvent("DDBulkLoadStarted")
+	    .detail("TaskID", task.taskId)
+	    .detail("Range", task.range)
+	    .detail("Version", fileSet.get().targetVersion)
+	    .detail("Pieces", pieces.size())
+	    .detail("Files", fileSet.get().ranges.size());
+	return Void();
+}
+
+enum class BulkLoadPieceStatus { Idle, Moving, Loaded };
+
+// A piece is loaded once every shard of it has been moved for the bulk load, which is recorded in the ID of the data
+// move of its source servers
+ACTOR Future<BulkLoadPieceStatus> getBulkLoadPieceStatus(Database cx, KeyRange piece) {
+	state Transaction tr(cx);
+	state BulkLoadPieceStatus status;
+	state Key begin;
+
+	loop {
+		try {
+			tr.setOption(FDBTransactionOptions::PRIORITY_SYSTEM_IMMEDIATE);
+			tr.setOption(FDBTransactionOptions::READ_SYSTEM_KEYS);
+			tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+			status = BulkLoadPieceStatus::Loaded;
+			begin = piece.begin;
+			state RangeResult UIDtoTagMap = wait(tr.getRange(serverTagKeys, CLIENT_KNOBS->TOO_MANY));
+			ASSERT(!UIDtoTagMap.more && UIDtoTagMap.size() < CLIENT_KNOBS->TOO_MANY);
+			while (begin < piece.end && status != BulkLoadPieceStatus::Moving) {
+				RangeResult shards = wait(krmGetRanges(&tr,
+				                                       keyServersPrefix,
+				                                       KeyRangeRef(begin, piece.end),
+				                                       SERVER_KNOBS->MOVE_KEYS_KRM_LIMIT,
+				                                       SERVER_KNOBS->MOVE_KEYS_KRM_LIMIT_BYTES));
+				for (int i = 0; i < shards.size() - 1 && status != BulkLoadPieceStatus::Moving; ++i) {
+					std::vector<UID> src, dest;
+					UID srcId, destId;
+					decodeKeyServersValue(UIDtoTagMap, shards[i].value, src, dest, srcId, destId);
+					if (!dest.empty()) {
+						status = BulkLoadPieceStatus::Moving;
+						break;
+					}
+					bool assigned, emptyRange;
+					DataMoveType type;
+					DataMovementReason reason = DataMovementReason::INVALID;
+					decodeDataMoveId(srcId, assigned, emptyRange, type, reason);
+					if (reason != DataMovementReason::BULK_LOAD) {
+						status = BulkLoadPieceStatus::Idle;
+					}
+				}
+				begin = shards.back().key;
+			}
+			return status;
+		} catch (Error& e) {
+			wait(tr.onError(e));
+		}
+	}
+}
+
+ACTOR Future<Void> markBulkLoadPieceLoaded(Database cx, BulkLoadState piece) {
+	state Transaction tr(cx);
+	piece.setPhase(BulkLoadPhase::Loaded);
+	loop {
+		try {
+			tr.setOption(FDBTransactionOptions::PRIORITY_SYSTEM_IMMEDIATE);
+			tr.setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+			tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+			bool set = wait(setBulkLoadStates(&tr, piece.taskId, { piece }));
+			if (set) {
+				wait(tr.commit());
+			}
+			return Void();
+		} catch (Error& e) {
+			wait(tr.onError(e));
+		}
+	}
+}
+
+// Moves the idle pieces of a running task to new servers, which load them from their files, keeps the pieces being
+// moved from merging, and completes the task once every piece is loaded. A piece that stays idle after its move, e.g.
+// because the move was merged into another one, is moved again after DD_BULK_LOAD_RELOCATE_DELAY.
+ACTOR Future<Void> checkBulkLoadPieces(Database cx,
+                                       std::vector<BulkLoadState> pieces,
+                                       PromiseStream<BulkLoadShardRequest> bulkLoadShards,
+                                       std::map<std::pair<UID, Key>, double>* relocateTimes) {
+	state int i = 0;
+	state bool complete = true;
+	state BulkLoadPieceStatus status;
+	state Transaction tr(cx);
+	state BulkLoadState task;
+
+	for (; i < pieces.size(); ++i) {
+		if (pieces[i].getPhase() == BulkLoadPhase::Loaded) {
+			continue;
+		}
+		wait(store(status, getBulkLoadPieceStatus(cx, pieces[i].piece)));
+		if (status == BulkLoadPieceStatus::Loaded) {
+			wait(markBulkLoadPieceLoaded(cx, pieces[i]));
+			continue;
+		}
+		complete = false;
+		if (status == BulkLoadPieceStatus::Moving) {
+			bulkLoadShards.send(BulkLoadShardRequest(pieces[i].piece, false));
+			continue;
+		}
+		auto key = std::make_pair(pieces[i].taskId, pieces[i].piece.begin);
+		auto it = relocateTimes->find(key);
+		bool relocate = it == relocateTimes->end() || now() - it->second >= SERVER_KNOBS->DD_BULK_LOAD_RELOCATE_DELAY;
+		if (relocate) {
+			(*relocateTimes)[key] = now();
+		}
+		bulkLoadShards.send(BulkLoadShardRequest(pieces[i].piece, relocate));
+	}
+	if (!complete) {
+		return Void();
+	}
+
+	task = pieces.front();
+	task.setPhase(BulkLoadPhase::Complete);
+	task.piece = task.range;
+	task.files.clear();
+	task.bytes = 0;
+	for (const auto& piece : pieces) {
+		task.bytes += piece.bytes;
+	}
+	loop {
+		try {
+			tr.setOption(FDBTransactionOptions::PRIORITY_SYSTEM_IMMEDIATE);
+			tr.setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+			tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+			bool set = wait(setBulkLoadStates(&tr, task.taskId, { task }));
+			if (!set) {
+				return Void();
+			}
+			wait(tr.commit());
+			break;
+		} catch (Error& e) {
+			wait(tr.onError(e));
+		}
+	}
+	for (const auto& piece : pieces) {
+		relocateTimes->erase(std::make_pair(piece.taskId, piece.piece.begin));
+	}
+	TraceEvent("DDBulkLoadComplete")
+	    .detail("TaskID", task.taskId)
+	    .detail("Range", task.range)
+	    .detail("Pieces", pieces.size())
+	    .detail("Bytes", task.bytes)
+	    .detail("Duration", now() - task.submitTime);
+	return Void();
+}
+
+// Drives the bulk load tasks in the map at bulkLoadPrefix
+ACTOR Future<Void> bulkLoadCore(Reference<DataDistributor> self, PromiseStream<BulkLoadShardRequest> bulkLoadShards) {
+	state Database cx = self->txnProcessor->context();
+	state std::map<std::pair<UID, Key>, double> relocateTimes;
+	state std::map<UID, std::vector<BulkLoadState>> tasks;
+	state std::map<UID, std::vector<BulkLoadState>>::iterator task;
+
+	wait(self->initialized.getFuture());
+	loop {
+		wait(delay(SERVER_KNOBS->DD_BULK_LOAD_POLL_INTERVAL));
+		try {
+			std::vector<BulkLoadState> entries = wait(getBulkLoadStates(cx, normalKeys));
+			tasks.clear();
+			for (auto& entry : entries) {
+				if (!entry.isFinished()) {
+					tasks[entry.taskId].push_back(std::move(entry));
+				}
+			}
+			for (task = tasks.begin(); task != tasks.end(); ++task) {
+				bool submitted = std::any_of(task->second.begin(), task->second.end(), [](const auto& entry) {
+					return entry.getPhase() == BulkLoadPhase::Submitted;
+				});
+				if (submitted) {
+					wait(startBulkLoadTask(cx, task->second.front()));
+				} else {
+					wait(checkBulkLoadPieces(cx, task->second, bulkLoadShards, &relocateTimes));
+				}
+			}
+		} catch (Error& e) {
+			if (e.code() == error_code_actor_cancelled) {
+				throw;
+			}
+			TraceEvent(SevWarn, "DDBulkLoadCoreError", self->ddId).error(e);
+		}
+	}
+}
+
 // Runs the data distribution algorithm for FDB, including the DD Queue, DD tracker, and DD team collection
 ACTOR Future<Void> dataDistribution(Reference<DataDistributor> self,
                                     PromiseStream<GetMetricsListRequest> getShardMetricsList,
@@ -1034,6 +1354,7 @@ ACTOR Future<Void> dataDistribution(Reference<DataDistributor> self,
 
 			state PromiseStream<Promise<int64_t>> getAverageShardBytes;
 			state PromiseStream<RebalanceStorageQueueRequest> triggerStorageQueueRebalance;
+			state PromiseStream<BulkLoadShardRequest> bulkLoadShards;
 			state PromiseStream<Promise<int>> getUnhealthyRelocationCount;
 			state PromiseStream<GetMetricsRequest> getShardMetrics;
 			state PromiseStream<GetTopKMetricsRequest> getTopKShardMetrics;
@@ -1082,14 +1403,16 @@ ACTOR Future<Void> dataDistribution(Reference<DataDistributor> self,
 			                                       .anyZeroHealthyTeams = anyZeroHealthyTeams,
 			                                       .shards = &shards,
 			                                       .trackerCancelled = &self->context->trackerCancelled,
-			                                       .ddTenantCache = self->ddTenantCache });
+			                                       .ddTenantCache = self->ddTenantCache,
+			                                       .heatmap = &self->heatmap });
 			actors.push_back(reportErrorsExcept(DataDistributionTracker::run(self->context->tracker,
 			                                                                 self->initData,
 			                                                                 getShardMetrics.getFuture(),
 			                                                                 getTopKShardMetrics.getFuture(),
 			                                                                 getShardMetricsList.getFuture(),
 			                                                                 getAverageShardBytes.getFuture(),
-			                                                                 triggerStorageQueueRebalance.getFuture()),
+			                                                                 triggerStorageQueueRebalance.getFuture(),
+			                                                                 bulkLoadShards.getFuture()),
 			                                    "DDTracker",
 			                                    self->ddId,
 			                                    &normalDDQueueErrors()));
@@ -1107,7 +1430,8 @@ ACTOR Future<Void> dataDistribution(Reference<DataDistributor> self,
 			                       .relocationProducer = self->relocationProducer,
 			                       .relocationConsumer = self->relocationConsumer.getFuture(),
 			                       .getShardMetrics = getShardMetrics,
-			                       .getTopKMetrics = getTopKShardMetrics });
+			                       .getTopKMetrics = getTopKShardMetrics,
+			                       .shardedRocksDBOnly = shardedRocksDBOnly(self->configuration) });
 			actors.push_back(reportErrorsExcept(DDQueue::run(self->context->ddQueue,
 			                                                 processingUnhealthy,
 			                                                 processingWiggle,
@@ -1210,6 +1534,10 @@ ACTOR Future<Void> dataDistribution(Reference<DataDistributor> self,
 			}
 
 			actors.push_back(serveBlobMigratorRequests(self, self->context->tracker, self->context->ddQueue));
+			if (!isMocked) {
+				actors.push_back(reportErrorsExcept(
+				    bulkLoadCore(self, bulkLoadShards), "DDBulkLoad", self->ddId, &normalDDQueueErrors()));
+			}
 
 			wait(waitForAll(actors));
 			ASSERT_WE_THINK(false);
@@ -3425,6 +3753,11 @@ ACTOR Future<Void> dataDistributor_impl(DataDistributorInterface di,
 			when(GetDataDistributorMetricsRequest req = waitNext(di.dataDistributorMetrics.getFuture())) {
 				actors.add(ddGetMetrics(req, getShardMetricsList));
 			}
+			when(GetDataDistributorHeatmapRequest req = waitNext(di.dataDistributorHeatmap.getFuture())) {
+				GetDataDistributorHeatmapReply rep;
+				rep.buckets = self->heatmap.get(req.keys, req.since);
+				req.reply.send(rep);
+			}
 			when(DistributorSnapRequest snapReq = waitNext(di.distributorSnapReq.getFuture())) {
 				auto& snapUID = snapReq.snapUID;
 				if (ddSnapReqResultMap.count(snapUID)) {
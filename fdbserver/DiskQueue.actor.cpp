@@ -49,6 +49,7 @@ struct StringBuffer {
 	Standalone<StringRef> str;
 	int reserved;
 	UID id;
+	bool grown = false; // Whether alignReserve() has replaced an earlier allocation since the last reuse()
 
 	StringBuffer(UID fromFileID) : reserved(0), id(fromFileID) {}
 
@@ -63,6 +64,18 @@ struct StringBuffer {
 		reserved = size;
 		str.contents() = StringRef(new (str.arena()) uint8_t[size], 0);
 	}
+	// Empties the buffer while keeping its reserved memory, which is moved into a single allocation if growing left
+	// earlier, smaller allocations behind in the arena.
+	void reuse(int alignment) {
+		if (grown) {
+			const int size = reserved;
+			clear();
+			alignReserve(alignment, size);
+			grown = false;
+		} else {
+			str.contents() = StringRef(str.begin(), 0);
+		}
+	}
 	void append(StringRef x) { memcpy(append(x.size()), x.begin(), x.size()); }
 	void* append(int bytes) {
 		ASSERT(str.size() + bytes <= reserved);
@@ -99,6 +112,7 @@ struct StringBuffer {
 			if (str.size() > 0) {
 				memcpy(p, str.begin(), str.size());
 			}
+			grown = grown || str.begin() != nullptr;
 			str.contents() = StringRef(p, str.size());
 		}
 	}
@@ -171,7 +185,8 @@ public:
 	  : basename(basename), fileExtension(fileExtension), dbgid(dbgid), dbg_file0BeginSeq(0),
 	    fileSizeWarningLimit(fileSizeWarningLimit), onError(delayed(error.getFuture())), onStopped(stopped.getFuture()),
 	    readyToPush(Void()), lastCommit(Void()), isFirstCommit(true), readingBuffer(dbgid), readingFile(-1),
-	    readingPage(-1), writingPos(-1), fileExtensionBytes(SERVER_KNOBS->DISK_QUEUE_FILE_EXTENSION_BYTES),
+	    readingPage(-1), readAheadBuffer(dbgid), readAheadFile(-1), readAheadPage(-1), writingPos(-1),
+	    fileExtensionBytes(SERVER_KNOBS->DISK_QUEUE_FILE_EXTENSION_BYTES),
 	    fileShrinkBytes(SERVER_KNOBS->DISK_QUEUE_FILE_SHRINK_BYTES) {
 		if (BUGGIFY)
 			fileExtensionBytes = _PAGE_SIZE * deterministicRandom()->randomSkewedUInt32(1, 10 << 10);
@@ -198,6 +213,28 @@ public:
 		return pushAndCommit(this, pageData, pageMem, poppedPages);
 	}
 
+	// Returns an empty, page aligned buffer for the pages of the next pushAndCommit(), reusing the memory of earlier
+	// commits when possible.
+	StringBuffer* getPageBuffer() {
+		if (pageBufferPool.empty()) {
+			return new StringBuffer(dbgid);
+		}
+		StringBuffer* buffer = pageBufferPool.back().release();
+		pageBufferPool.pop_back();
+		return buffer;
+	}
+
+	// Takes back the buffer of a pushAndCommit() once its pages are written
+	void recyclePageBuffer(StringBuffer* buffer) {
+		if (pageBufferPool.size() < SERVER_KNOBS->DISK_QUEUE_PAGE_BUFFER_POOL_SIZE &&
+		    buffer->reserved <= SERVER_KNOBS->DISK_QUEUE_PAGE_BUFFER_MAX_POOLED_BYTES) {
+			buffer->reuse(sizeof(Page));
+			pageBufferPool.emplace_back(buffer);
+		} else {
+			delete buffer;
+		}
+	}
+
 	void stall() {
 		stallCount++;
 		readyToPush = lastCommit;
@@ -282,9 +319,15 @@ public:
 	bool isFirstCommit;
 
 	StringBuffer readingBuffer; // Pages that have been read and not yet returned
+	std::vector<std::unique_ptr<StringBuffer>> pageBufferPool; // See getPageBuffer()
 	int readingFile; // File index where the next page (after readingBuffer) should be read from, i.e.,
 	                 // files[readingFile]. readingFile = 2 if recovery is complete (all files have been read).
 	int64_t readingPage; // Page within readingFile that is the next page after readingBuffer
+	// During recovery, the chunk following readingBuffer is read into readAheadBuffer while readingBuffer is consumed
+	StringBuffer readAheadBuffer;
+	Future<int> readAhead;
+	int readAheadFile; // The readingFile and readingPage to use once readAheadBuffer becomes readingBuffer
+	int64_t readAheadPage;
 
 	int64_t writingPos; // Position within files[1] that will be next written
 
@@ -432,7 +475,7 @@ public:
 		return waitForAllReadyThenThrow(waitfor);
 	}
 
-	// Write the given data (pageData) to the queue files of self, sync data to disk, and delete the memory (pageMem)
+	// Write the given data (pageData) to the queue files of self, sync data to disk, and recycle the memory (pageMem)
 	// that hold the pageData
 	ACTOR static UNCANCELLABLE Future<Void> pushAndCommit(RawDiskQueue_TwoFiles* self,
 	                                                      Standalone<StringRef> pageData,
@@ -468,7 +511,7 @@ public:
 			CODE_PROBE(2 == syncFiles.size(), "push spans both files");
 			wait(pushed);
 
-			delete pageMem;
+			self->recyclePageBuffer(pageMem);
 			pageMem = 0;
 
 			Future<Void> sync = syncFiles[0]->onSync();
@@ -758,31 +801,72 @@ public:
 		return result;
 	}
 
-	Future<int> fillReadingBuffer() {
+	// Starts reading the chunk of pages that follows readingBuffer into readAheadBuffer, unless every page has been read
+	void startReadAhead() {
+		int file = readingFile;
+		int64_t page = readingPage;
 		// If we're right at the end of a file...
-		if (readingPage * sizeof(Page) >= (size_t)files[readingFile].size) {
-			readingFile++;
-			readingPage = 0;
-			if (readingFile >= 2) {
-				// Recovery complete
-				readingBuffer.clear();
-				writingPos = files[1].size;
-				return 0;
+		if (page * sizeof(Page) >= (size_t)files[file].size) {
+			file++;
+			page = 0;
+			if (file >= 2) {
+				readAhead = Future<int>();
+				return;
 			}
 		}
 
-		// Read up to 1MB into readingBuffer
-		int len = std::min<int64_t>((files[readingFile].size / sizeof(Page) - readingPage) * sizeof(Page),
+		int len = std::min<int64_t>((files[file].size / sizeof(Page) - page) * sizeof(Page),
 		                            BUGGIFY_WITH_PROB(1.0) ? sizeof(Page) * deterministicRandom()->randomInt(1, 4)
-		                                                   : (1 << 20));
-		readingBuffer.clear();
-		readingBuffer.alignReserve(sizeof(Page), len);
-		void* p = readingBuffer.append(len);
-
-		auto pos = readingPage * sizeof(Page);
-		readingPage += len / sizeof(Page);
+		                                                   : SERVER_KNOBS->DISK_QUEUE_RECOVERY_READ_BYTES);
+		readAheadBuffer.clear();
+		readAheadBuffer.alignReserve(sizeof(Page), len);
+		void* p = readAheadBuffer.append(len);
 		ASSERT(int64_t(p) % sizeof(Page) == 0);
-		return files[readingFile].f->read(p, len, pos);
+
+		readAheadFile = file;
+		readAheadPage = page + len / sizeof(Page);
+		readAhead = readChunk(this, files[file].f, readAheadBuffer.get(), page * sizeof(Page));
+	}
+
+	// The buffer is held until the read completes, even if the readAheadBuffer it was taken from is cleared
+	ACTOR static UNCANCELLABLE Future<int> readChunk(RawDiskQueue_TwoFiles* self,
+	                                                 Reference<IAsyncFile> file,
+	                                                 Standalone<StringRef> buffer,
+	                                                 int64_t pos) {
+		state TrackMe trackMe(self);
+		int read = wait(file->read(mutateString(buffer), buffer.size(), pos));
+		return read;
+	}
+
+	// Waits for any outstanding read ahead, so that recovery can change the files without a read racing with it
+	Future<Void> stopReadAhead() {
+		Future<Void> f = readAhead.isValid() ? ready(readAhead) : Future<Void>(Void());
+		readAhead = Future<int>();
+		readAheadBuffer.clear();
+		return f;
+	}
+
+	ACTOR static Future<int> fillReadingBuffer(RawDiskQueue_TwoFiles* self) {
+		if (!self->readAhead.isValid()) {
+			self->startReadAhead();
+			if (!self->readAhead.isValid()) {
+				// Recovery complete
+				self->readingFile = 2;
+				self->readingBuffer.clear();
+				self->writingPos = self->files[1].size;
+				return 0;
+			}
+		}
+
+		int read = wait(self->readAhead);
+		std::swap(self->readingBuffer, self->readAheadBuffer);
+		self->readingFile = self->readAheadFile;
+		self->readingPage = self->readAheadPage;
+		self->readAhead = Future<int>();
+		if (SERVER_KNOBS->DISK_QUEUE_RECOVERY_READ_AHEAD) {
+			self->startReadAhead();
+		}
+		return read;
 	}
 
 	ACTOR static UNCANCELLABLE Future<Standalone<StringRef>> readNextPage(RawDiskQueue_TwoFiles* self) {
@@ -796,7 +880,7 @@ public:
 				state Future<Void> f = Void();
 				// if (BUGGIFY) f = delay( deterministicRandom()->random01() * 0.1 );
 
-				int read = wait(self->fillReadingBuffer());
+				int read = wait(fillReadingBuffer(self));
 				ASSERT(read == self->readingBuffer.size());
 
 				wait(f);
@@ -843,6 +927,8 @@ public:
 			state std::vector<Future<Void>> commits;
 			state bool swap = file == 0;
 
+			wait(self->stopReadAhead());
+
 			CODE_PROBE(file == 0, "truncate before last read page on file 0");
 			CODE_PROBE(file == 1 && pos != self->files[1].size, "truncate before last read page on file 1");
 
@@ -1132,7 +1218,7 @@ private:
 
 		// pushed_pages.resize( pushed_pages.arena(), pushed_pages.size()+1 );
 		if (!pushed_page_buffer)
-			pushed_page_buffer = new StringBuffer(dbgid);
+			pushed_page_buffer = rawQueue->getPageBuffer();
 		pushed_page_buffer->alignReserve(sizeof(Page), pushed_page_buffer->size() + sizeof(Page));
 		pushed_page_buffer->append(sizeof(Page));
 
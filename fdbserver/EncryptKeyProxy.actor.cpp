@@ -169,9 +169,12 @@ struct EncryptBaseCipherKey {
 	// leverage already cached CipherKey iff it is 'Non-revocable CipherKey'. PerpetualWiggle would update old/retired
 	// CipherKeys with the latest CipherKeys sometime soon in the future.
 	int64_t expireAt;
+	// Time the CipherKey was last looked up or served; only CipherKeys in use are refreshed ahead of time
+	double lastUsedAt;
 
 	EncryptBaseCipherKey()
-	  : domainId(0), baseCipherId(0), baseCipherKey(StringRef()), baseCipherKCV(0), refreshAt(0), expireAt(0) {}
+	  : domainId(0), baseCipherId(0), baseCipherKey(StringRef()), baseCipherKCV(0), refreshAt(0), expireAt(0),
+	    lastUsedAt(0) {}
 	explicit EncryptBaseCipherKey(EncryptCipherDomainId dId,
 	                              EncryptCipherBaseKeyId cipherId,
 	                              Standalone<StringRef> cipherKey,
@@ -179,7 +182,7 @@ struct EncryptBaseCipherKey {
 	                              int64_t refAtTS,
 	                              int64_t expAtTS)
 	  : domainId(dId), baseCipherId(cipherId), baseCipherKey(cipherKey), baseCipherKCV(cipherKCV), refreshAt(refAtTS),
-	    expireAt(expAtTS) {}
+	    expireAt(expAtTS), lastUsedAt(now()) {}
 
 	bool needsRefresh() const {
 		bool shouldRefresh = now() > refreshAt;
@@ -216,6 +219,65 @@ using EncryptBaseCipherDomainIdKeyIdCache = std::unordered_map<EncryptBaseCipher
                                                                EncryptBaseCipherDomainIdKeyIdCacheKeyHash>;
 using BlobMetadataDomainIdCache = std::unordered_map<BlobMetadataDomainId, BlobMetadataCacheEntry>;
 
+// Concurrent requests often miss the cache for the same cipher keys, e.g. when many storage servers start at once.
+// Their misses are coalesced: a key already being looked up in the KMS isn't looked up again, and the keys missed
+// within ENCRYPT_PROXY_KMS_LOOKUP_BATCH_DELAY are looked up together in one KMS call.
+template <class Key, class Rep, class Hash = std::hash<Key>>
+struct KmsLookupBatcher {
+	// Keys being looked up, and the reply of the KMS call each is looked up in
+	std::unordered_map<Key, Future<Rep>, Hash> inFlight;
+	// Keys of the next KMS call, which has been scheduled if there are any
+	std::vector<Key> pending;
+	Promise<Rep> pendingReply;
+	Optional<UID> pendingDebugId;
+
+	// Returns the reply of the KMS call key is looked up in. Sets schedule if the next call has to be started.
+	Future<Rep> lookup(const Key& key, Optional<UID> debugId, Counter& coalesced, bool& schedule) {
+		auto it = inFlight.find(key);
+		if (it != inFlight.end()) {
+			++coalesced;
+			return it->second;
+		}
+		schedule = schedule || pending.empty();
+		pending.push_back(key);
+		if (!pendingDebugId.present()) {
+			pendingDebugId = debugId;
+		}
+		Future<Rep> reply = pendingReply.getFuture();
+		inFlight.emplace(key, reply);
+		return reply;
+	}
+
+	// Takes the keys of the next KMS call, and the promise of its reply
+	std::vector<Key> take(Promise<Rep>& reply, Optional<UID>& debugId) {
+		reply = pendingReply;
+		pendingReply = Promise<Rep>();
+		debugId = pendingDebugId;
+		pendingDebugId.reset();
+		std::vector<Key> keys;
+		keys.swap(pending);
+		return keys;
+	}
+
+	void finish(const std::vector<Key>& keys) {
+		for (const auto& key : keys) {
+			inFlight.erase(key);
+		}
+	}
+};
+
+// Returns the distinct futures of lookups
+template <class Rep>
+std::vector<Future<Rep>> distinctLookups(const std::vector<Future<Rep>>& lookups) {
+	std::vector<Future<Rep>> distinct;
+	for (Future<Rep> lookup : lookups) {
+		if (std::none_of(distinct.begin(), distinct.end(), [&](Future<Rep> f) { return f == lookup; })) {
+			distinct.push_back(lookup);
+		}
+	}
+	return distinct;
+}
+
 struct EncryptKeyProxyData : NonCopyable, ReferenceCounted<EncryptKeyProxyData> {
 public:
 	UID myId;
@@ -229,6 +291,13 @@ public:
 	EncryptBaseCipherDomainIdKeyIdCache baseCipherDomainIdKeyIdCache;
 	BlobMetadataDomainIdCache blobMetadataDomainIdCache;
 
+	// Cache misses being looked up in the KMS
+	KmsLookupBatcher<EncryptCipherDomainId, KmsConnLookupEKsByDomainIdsRep> latestCipherKeyLookups;
+	KmsLookupBatcher<EncryptBaseCipherDomainIdKeyIdCacheKey,
+	                 KmsConnLookupEKsByKeyIdsRep,
+	                 boost::hash<EncryptBaseCipherDomainIdKeyIdCacheKey>>
+	    cipherKeyByIdLookups;
+
 	std::unique_ptr<KmsConnector> kmsConnector;
 
 	bool canConnectToKms = true;
@@ -249,6 +318,7 @@ public:
 	Counter numBlobMetadataRefreshErrors;
 	Counter numHealthCheckErrors;
 	Counter numHealthCheckRequests;
+	Counter kmsLookupsCoalesced;
 
 	LatencySample kmsLookupByIdsReqLatency;
 	LatencySample kmsLookupByDomainIdsReqLatency;
@@ -269,6 +339,7 @@ public:
 	    numBlobMetadataRefreshErrors("EKPBlobMetadataRefreshErrors", ekpCacheMetrics),
 	    numHealthCheckErrors("KMSHealthCheckErrors", ekpCacheMetrics),
 	    numHealthCheckRequests("KMSHealthCheckRequests", ekpCacheMetrics),
+	    kmsLookupsCoalesced("EKPKmsLookupsCoalesced", ekpCacheMetrics),
 	    kmsLookupByIdsReqLatency("EKPKmsLookupByIdsReqLatency",
 	                             id,
 	                             SERVER_KNOBS->LATENCY_METRICS_LOGGING_INTERVAL,
@@ -422,6 +493,61 @@ getLookupDetails(
 	return lookupCipherInfoMap;
 }
 
+// Looks up the cipher keys of the pending lookups by key id in one KMS call, and records them in the cache
+ACTOR Future<Void> lookupCipherKeysByIds(Reference<EncryptKeyProxyData> ekpProxyData,
+                                         KmsConnectorInterface kmsConnectorInf) {
+	wait(delay(SERVER_KNOBS->ENCRYPT_PROXY_KMS_LOOKUP_BATCH_DELAY));
+	state Promise<KmsConnLookupEKsByKeyIdsRep> reply;
+	state KmsConnLookupEKsByKeyIdsReq keysByIdsReq;
+	state std::vector<EncryptBaseCipherDomainIdKeyIdCacheKey> keys =
+	    ekpProxyData->cipherKeyByIdLookups.take(reply, keysByIdsReq.debugId);
+	for (const auto& key : keys) {
+		keysByIdsReq.encryptKeyInfos.emplace_back(key.first, key.second);
+	}
+
+	try {
+		state double startTime = now();
+		KmsConnLookupEKsByKeyIdsRep keysByIdsRep = wait(kmsConnectorInf.ekLookupByIds.getReply(keysByIdsReq));
+		ekpProxyData->kmsLookupByIdsReqLatency.addMeasurement(now() - startTime);
+
+		// Record the fetched cipher details to the local cache for the future references
+		for (const auto& item : keysByIdsRep.cipherKeyDetails) {
+			// KMS governs lifetime of a given CipherKey, however, for non-latest CipherKey there isn't a necessity
+			// to 'refresh' cipher (rotation is not applicable). But, 'expireInterval' is still valid if CipherKey
+			// is a 'revocable key'
+			CipherKeyValidityTS validityTS = getCipherKeyValidityTS(Optional<int64_t>(-1), item.expireAfterSec);
+
+			if (!ekpProxyData->cipherKeyByIdLookups.inFlight.count(
+			        std::make_pair(item.encryptDomainId, item.encryptKeyId))) {
+				TraceEvent(SevError, "GetCipherKeysByKeyIdsMappingNotFound", ekpProxyData->myId)
+				    .detail("DomainId", item.encryptDomainId);
+				throw encrypt_keys_fetch_failed();
+			}
+			ekpProxyData->insertIntoBaseCipherIdCache(item.encryptDomainId,
+			                                          item.encryptKeyId,
+			                                          item.encryptKey,
+			                                          item.encryptKCV,
+			                                          validityTS.refreshAtTS,
+			                                          validityTS.expAtTS);
+		}
+		if (keysByIdsRep.cipherKeyDetails.size() > 0) {
+			ekpProxyData->setKMSHealthiness(true);
+		}
+		ekpProxyData->cipherKeyByIdLookups.finish(keys);
+		reply.send(keysByIdsRep);
+	} catch (Error& e) {
+		if (e.code() == error_code_actor_cancelled) {
+			throw;
+		}
+		if (isKmsConnectionError(e)) {
+			ekpProxyData->setKMSHealthiness(false);
+		}
+		ekpProxyData->cipherKeyByIdLookups.finish(keys);
+		reply.sendError(e);
+	}
+	return Void();
+}
+
 ACTOR Future<Void> getCipherKeysByBaseCipherKeyIds(Reference<EncryptKeyProxyData> ekpProxyData,
                                                    KmsConnectorInterface kmsConnectorInf,
                                                    EKPGetBaseCipherKeysByIdsRequest req) {
@@ -451,56 +577,42 @@ ACTOR Future<Void> getCipherKeysByBaseCipherKeyIds(Reference<EncryptKeyProxyData
 	    lookupCipherInfoMap = getLookupDetails(ekpProxyData, dbgTrace, keyIdsReply, numHits, dedupedCipherInfos);
 	if (!lookupCipherInfoMap.empty()) {
 		try {
-			KmsConnLookupEKsByKeyIdsReq keysByIdsReq;
+			state std::vector<Future<KmsConnLookupEKsByKeyIdsRep>> lookups;
+			bool schedule = false;
 			for (const auto& item : lookupCipherInfoMap) {
-				keysByIdsReq.encryptKeyInfos.emplace_back(item.second.domainId, item.second.baseCipherId);
+				lookups.push_back(ekpProxyData->cipherKeyByIdLookups.lookup(
+				    item.first, keysByIds.debugId, ekpProxyData->kmsLookupsCoalesced, schedule));
 			}
-			keysByIdsReq.debugId = keysByIds.debugId;
-			state double startTime = now();
-			KmsConnLookupEKsByKeyIdsRep keysByIdsRep = wait(kmsConnectorInf.ekLookupByIds.getReply(keysByIdsReq));
-			ekpProxyData->kmsLookupByIdsReqLatency.addMeasurement(now() - startTime);
-
-			for (const auto& item : keysByIdsRep.cipherKeyDetails) {
-				keyIdsReply.baseCipherDetails.emplace_back(
-				    item.encryptDomainId, item.encryptKeyId, item.encryptKey, item.encryptKCV);
+			if (schedule) {
+				ekpProxyData->addActor.send(lookupCipherKeysByIds(ekpProxyData, kmsConnectorInf));
 			}
-
-			// Record the fetched cipher details to the local cache for the future references
-			// Note: cache warm-up is done after responding to the caller
-
-			for (auto& item : keysByIdsRep.cipherKeyDetails) {
-				// KMS governs lifetime of a given CipherKey, however, for non-latest CipherKey there isn't a necessity
-				// to 'refresh' cipher (rotation is not applicable). But, 'expireInterval' is still valid if CipherKey
-				// is a 'revocable key'
-
-				CipherKeyValidityTS validityTS = getCipherKeyValidityTS(Optional<int64_t>(-1), item.expireAfterSec);
-
-				const auto itr = lookupCipherInfoMap.find(std::make_pair(item.encryptDomainId, item.encryptKeyId));
-				if (itr == lookupCipherInfoMap.end()) {
-					TraceEvent(SevError, "GetCipherKeysByKeyIdsMappingNotFound", ekpProxyData->myId)
-					    .detail("DomainId", item.encryptDomainId);
-					throw encrypt_keys_fetch_failed();
-				}
-				ekpProxyData->insertIntoBaseCipherIdCache(item.encryptDomainId,
-				                                          item.encryptKeyId,
-				                                          item.encryptKey,
-				                                          item.encryptKCV,
-				                                          validityTS.refreshAtTS,
-				                                          validityTS.expAtTS);
-
-				if (dbgTrace.present()) {
-					// {encryptId, baseCipherId} forms a unique tuple across encryption domains
-					dbgTrace.get().detail(getEncryptDbgTraceKeyWithTS(ENCRYPT_DBG_TRACE_INSERT_PREFIX,
-					                                                  item.encryptDomainId,
-					                                                  item.encryptKeyId,
-					                                                  validityTS.refreshAtTS,
-					                                                  validityTS.expAtTS),
-					                      "");
+			wait(waitForAll(lookups));
+
+			std::unordered_set<EncryptBaseCipherDomainIdKeyIdCacheKey,
+			                   boost::hash<EncryptBaseCipherDomainIdKeyIdCacheKey>>
+			    found;
+			for (const auto& lookup : distinctLookups(lookups)) {
+				for (const auto& item : lookup.get().cipherKeyDetails) {
+					const auto key = std::make_pair(item.encryptDomainId, item.encryptKeyId);
+					if (!lookupCipherInfoMap.count(key) || !found.insert(key).second) {
+						continue;
+					}
+					keyIdsReply.baseCipherDetails.emplace_back(
+					    item.encryptDomainId, item.encryptKeyId, item.encryptKey, item.encryptKCV);
+
+					if (dbgTrace.present()) {
+						CipherKeyValidityTS validityTS =
+						    getCipherKeyValidityTS(Optional<int64_t>(-1), item.expireAfterSec);
+						// {encryptId, baseCipherId} forms a unique tuple across encryption domains
+						dbgTrace.get().detail(getEncryptDbgTraceKeyWithTS(ENCRYPT_DBG_TRACE_INSERT_PREFIX,
+						                                                  item.encryptDomainId,
+						                                                  item.encryptKeyId,
+						                                                  validityTS.refreshAtTS,
+						                                                  validityTS.expAtTS),
+						                      "");
+					}
 				}
 			}
-			if (keysByIdsRep.cipherKeyDetails.size() > 0) {
-				ekpProxyData->setKMSHealthiness(true);
-			}
 		} catch (Error& e) {
 			if (isKmsConnectionError(e)) {
 				ekpProxyData->setKMSHealthiness(false);
@@ -535,6 +647,7 @@ std::unordered_set<EncryptCipherDomainId> getLookupDetailsLatest(
 		const auto itr = ekpProxyData->baseCipherDomainIdCache.find(domainId);
 		if (itr != ekpProxyData->baseCipherDomainIdCache.end() && !itr->second.needsRefresh() &&
 		    !itr->second.isExpired()) {
+			itr->second.lastUsedAt = now();
 			latestCipherReply.baseCipherDetails.emplace_back(domainId,
 			                                                 itr->second.baseCipherId,
 			                                                 itr->second.baseCipherKey,
@@ -564,6 +677,55 @@ std::unordered_set<EncryptCipherDomainId> getLookupDetailsLatest(
 	return lookupCipherDomainIds;
 }
 
+// Looks up the latest cipher keys of the domains of the pending lookups in one KMS call, and records them in the cache
+ACTOR Future<Void> lookupLatestCipherKeys(Reference<EncryptKeyProxyData> ekpProxyData,
+                                          KmsConnectorInterface kmsConnectorInf) {
+	wait(delay(SERVER_KNOBS->ENCRYPT_PROXY_KMS_LOOKUP_BATCH_DELAY));
+	state Promise<KmsConnLookupEKsByDomainIdsRep> reply;
+	state KmsConnLookupEKsByDomainIdsReq keysByDomainIdReq;
+	state std::vector<EncryptCipherDomainId> domainIds =
+	    ekpProxyData->latestCipherKeyLookups.take(reply, keysByDomainIdReq.debugId);
+	keysByDomainIdReq.encryptDomainIds = domainIds;
+
+	try {
+		state double startTime = now();
+		KmsConnLookupEKsByDomainIdsRep keysByDomainIdRep =
+		    wait(kmsConnectorInf.ekLookupByDomainIds.getReply(keysByDomainIdReq));
+		ekpProxyData->kmsLookupByDomainIdsReqLatency.addMeasurement(now() - startTime);
+
+		// Record the fetched cipher details to the local cache for the future references
+		for (const auto& item : keysByDomainIdRep.cipherKeyDetails) {
+			CipherKeyValidityTS validityTS = getCipherKeyValidityTS(item.refreshAfterSec, item.expireAfterSec);
+			if (!ekpProxyData->latestCipherKeyLookups.inFlight.count(item.encryptDomainId)) {
+				TraceEvent(SevError, "GetLatestCipherKeysDomainIdNotFound", ekpProxyData->myId)
+				    .detail("DomainId", item.encryptDomainId);
+				throw encrypt_keys_fetch_failed();
+			}
+			ekpProxyData->insertIntoBaseDomainIdCache(item.encryptDomainId,
+			                                          item.encryptKeyId,
+			                                          item.encryptKey,
+			                                          item.encryptKCV,
+			                                          validityTS.refreshAtTS,
+			                                          validityTS.expAtTS);
+		}
+		if (keysByDomainIdRep.cipherKeyDetails.size() > 0) {
+			ekpProxyData->setKMSHealthiness(true);
+		}
+		ekpProxyData->latestCipherKeyLookups.finish(domainIds);
+		reply.send(keysByDomainIdRep);
+	} catch (Error& e) {
+		if (e.code() == error_code_actor_cancelled) {
+			throw;
+		}
+		if (isKmsConnectionError(e)) {
+			ekpProxyData->setKMSHealthiness(false);
+		}
+		ekpProxyData->latestCipherKeyLookups.finish(domainIds);
+		reply.sendError(e);
+	}
+	return Void();
+}
+
 ACTOR Future<Void> getLatestCipherKeys(Reference<EncryptKeyProxyData> ekpProxyData,
                                        KmsConnectorInterface kmsConnectorInf,
                                        EKPGetLatestBaseCipherKeysRequest req) {
@@ -601,53 +763,42 @@ ACTOR Future<Void> getLatestCipherKeys(Reference<EncryptKeyProxyData> ekpProxyDa
 	    getLookupDetailsLatest(ekpProxyData, dbgTrace, latestCipherReply, numHits, dedupedDomainIds);
 	if (!lookupCipherDomainIds.empty()) {
 		try {
-			KmsConnLookupEKsByDomainIdsReq keysByDomainIdReq;
+			state std::vector<Future<KmsConnLookupEKsByDomainIdsRep>> lookups;
+			bool schedule = false;
 			for (const auto domainId : lookupCipherDomainIds) {
-				keysByDomainIdReq.encryptDomainIds.emplace_back(domainId);
+				lookups.push_back(ekpProxyData->latestCipherKeyLookups.lookup(
+				    domainId, latestKeysReq.debugId, ekpProxyData->kmsLookupsCoalesced, schedule));
 			}
-			keysByDomainIdReq.debugId = latestKeysReq.debugId;
-
-			state double startTime = now();
-			KmsConnLookupEKsByDomainIdsRep keysByDomainIdRep =
-			    wait(kmsConnectorInf.ekLookupByDomainIds.getReply(keysByDomainIdReq));
-			ekpProxyData->kmsLookupByDomainIdsReqLatency.addMeasurement(now() - startTime);
-
-			for (auto& item : keysByDomainIdRep.cipherKeyDetails) {
-				CipherKeyValidityTS validityTS = getCipherKeyValidityTS(item.refreshAfterSec, item.expireAfterSec);
-
-				latestCipherReply.baseCipherDetails.emplace_back(item.encryptDomainId,
-				                                                 item.encryptKeyId,
-				                                                 item.encryptKey,
-				                                                 item.encryptKCV,
-				                                                 validityTS.refreshAtTS,
-				                                                 validityTS.expAtTS);
-
-				// Record the fetched cipher details to the local cache for the future references
-				const auto itr = lookupCipherDomainIds.find(item.encryptDomainId);
-				if (itr == lookupCipherDomainIds.end()) {
-					TraceEvent(SevError, "GetLatestCipherKeysDomainIdNotFound", ekpProxyData->myId)
-					    .detail("DomainId", item.encryptDomainId);
-					throw encrypt_keys_fetch_failed();
-				}
-				ekpProxyData->insertIntoBaseDomainIdCache(item.encryptDomainId,
-				                                          item.encryptKeyId,
-				                                          item.encryptKey,
-				                                          item.encryptKCV,
-				                                          validityTS.refreshAtTS,
-				                                          validityTS.expAtTS);
-
-				if (dbgTrace.present()) {
-					// {encryptDomainId, baseCipherId} forms a unique tuple across encryption domains
-					dbgTrace.get().detail(getEncryptDbgTraceKeyWithTS(ENCRYPT_DBG_TRACE_INSERT_PREFIX,
-					                                                  item.encryptDomainId,
-					                                                  item.encryptKeyId,
-					                                                  validityTS.refreshAtTS,
-					                                                  validityTS.expAtTS),
-					                      "");
-				}
+			if (schedule) {
+				ekpProxyData->addActor.send(lookupLatestCipherKeys(ekpProxyData, kmsConnectorInf));
 			}
-			if (keysByDomainIdRep.cipherKeyDetails.size() > 0) {
-				ekpProxyData->setKMSHealthiness(true);
+			wait(waitForAll(lookups));
+
+			std::unordered_set<EncryptCipherDomainId> found;
+			for (const auto& lookup : distinctLookups(lookups)) {
+				for (const auto& item : lookup.get().cipherKeyDetails) {
+					if (!lookupCipherDomainIds.count(item.encryptDomainId) ||
+					    !found.insert(item.encryptDomainId).second) {
+						continue;
+					}
+					CipherKeyValidityTS validityTS = getCipherKeyValidityTS(item.refreshAfterSec, item.expireAfterSec);
+					latestCipherReply.baseCipherDetails.emplace_back(item.encryptDomainId,
+					                                                 item.encryptKeyId,
+					                                                 item.encryptKey,
+					                                                 item.encryptKCV,
+					                                                 validityTS.refreshAtTS,
+					                                                 validityTS.expAtTS);
+
+					if (dbgTrace.present()) {
+						// {encryptDomainId, baseCipherId} forms a unique tuple across encryption domains
+						dbgTrace.get().detail(getEncryptDbgTraceKeyWithTS(ENCRYPT_DBG_TRACE_INSERT_PREFIX,
+						                                                  item.encryptDomainId,
+						                                                  item.encryptKeyId,
+						                                                  validityTS.refreshAtTS,
+						                                                  validityTS.expAtTS),
+						                      "");
+					}
+				}
 			}
 		} catch (Error& e) {
 			if (isKmsConnectionError(e)) {
@@ -682,6 +833,12 @@ bool isCipherKeyEligibleForRefresh(const EncryptBaseCipherKey& cipherKey, int64_
 	return nextRefreshCycleTS > cipherKey.expireAt || nextRefreshCycleTS > cipherKey.refreshAt;
 }
 
+// Latest CipherKeys nobody asked for lately are left to expire, and looked up again if they are asked for
+bool isCipherKeyInUse(const EncryptBaseCipherKey& cipherKey) {
+	return SERVER_KNOBS->ENCRYPT_PROXY_REFRESH_UNUSED_KEY_TIME <= 0 ||
+	       now() - cipherKey.lastUsedAt < SERVER_KNOBS->ENCRYPT_PROXY_REFRESH_UNUSED_KEY_TIME;
+}
+
 bool isBlobMetadataEligibleForRefresh(const BlobMetadataDetailsRef& blobMetadata, int64_t currTS) {
 	if (BUGGIFY_WITH_PROB(0.01)) {
 		return true;
@@ -792,7 +949,7 @@ ACTOR Future<Void> refreshEncryptionKeysImpl(Reference<EncryptKeyProxyData> ekpP
 		int64_t currTS = (int64_t)now();
 		for (auto itr = ekpProxyData->baseCipherDomainIdCache.begin();
 		     itr != ekpProxyData->baseCipherDomainIdCache.end();) {
-			if (isCipherKeyEligibleForRefresh(itr->second, currTS)) {
+			if (isCipherKeyEligibleForRefresh(itr->second, currTS) && isCipherKeyInUse(itr->second)) {
 				TraceEvent("RefreshEKs").detail("Id", itr->first);
 				req.encryptDomainIds.push_back(itr->first);
 			}
@@ -824,12 +981,15 @@ ACTOR Future<Void> refreshEncryptionKeysImpl(Reference<EncryptKeyProxyData> ekpP
 			}
 
 			CipherKeyValidityTS validityTS = getCipherKeyValidityTS(item.refreshAfterSec, item.expireAfterSec);
+			// A refresh isn't a use of the CipherKey
+			const double lastUsedAt = itr->second.lastUsedAt;
 			ekpProxyData->insertIntoBaseDomainIdCache(item.encryptDomainId,
 			                                          item.encryptKeyId,
 			                                          item.encryptKey,
 			                                          item.encryptKCV,
 			                                          validityTS.refreshAtTS,
 			                                          validityTS.expAtTS);
+			itr->second.lastUsedAt = lastUsedAt;
 			// {encryptDomainId, baseCipherId} forms a unique tuple across encryption domains
 			t.detail(getEncryptDbgTraceKeyWithTS(ENCRYPT_DBG_TRACE_INSERT_PREFIX,
 			                                     item.encryptDomainId,
@@ -50,6 +50,7 @@ struct GrvProxyStats {
 	Counter txnTagThrottlerIn, txnTagThrottlerOut;
 	Counter txnThrottled;
 	Counter updatesFromRatekeeper, leaseTimeouts;
+	Counter txnStartBatchCachedVersion; // Batches answered from GRV_CACHED_VERSION_LEASE without asking the master
 	int systemGRVQueueSize, defaultGRVQueueSize, batchGRVQueueSize;
 	int tagThrottlerGRVQueueSize;
 	double transactionRateAllowed, batchTransactionRateAllowed;
@@ -131,7 +132,8 @@ struct GrvProxyStats {
 	    txnDefaultPriorityStartIn("TxnDefaultPriorityStartIn", cc),
 	    txnDefaultPriorityStartOut("TxnDefaultPriorityStartOut", cc), txnTagThrottlerIn("TxnTagThrottlerIn", cc),
 	    txnTagThrottlerOut("TxnTagThrottlerOut", cc), txnThrottled("TxnThrottled", cc),
-	    updatesFromRatekeeper("UpdatesFromRatekeeper", cc), leaseTimeouts("LeaseTimeouts", cc), systemGRVQueueSize(0),
+	    updatesFromRatekeeper("UpdatesFromRatekeeper", cc), leaseTimeouts("LeaseTimeouts", cc),
+	    txnStartBatchCachedVersion("TxnStartBatchCachedVersion", cc), systemGRVQueueSize(0),
 	    defaultGRVQueueSize(0), batchGRVQueueSize(0), tagThrottlerGRVQueueSize(0), transactionRateAllowed(0),
 	    batchTransactionRateAllowed(0), transactionLimit(0), batchTransactionLimit(0),
 	    percentageOfDefaultGRVQueueProcessed(0), percentageOfBatchGRVQueueProcessed(0), lastBatchQueueThrottled(false),
@@ -206,6 +208,10 @@ struct GrvProxyData {
 	Version version;
 	Version minKnownCommittedVersion; // we should ask master for this version.
 
+	// The newest reply from the master and when it was asked for, see GRV_CACHED_VERSION_LEASE
+	Optional<GetRawCommittedVersionReply> cachedCommittedVersion;
+	double cachedCommittedVersionTime = 0;
+
 	GrvProxyTagThrottler tagThrottler;
 
 	// Cache of the latest commit versions of storage servers.
@@ -639,6 +645,39 @@ ACTOR Future<Void> lastCommitUpdater(GrvProxyData* self, PromiseStream<Future<Vo
 	}
 }
 
+GetReadVersionReply makeReadVersionReply(GrvProxyData* grvProxyData, const GetRawCommittedVersionReply& repFromMaster) {
+	GetReadVersionReply rep;
+	rep.version = repFromMaster.version;
+	rep.locked = repFromMaster.locked;
+	rep.metadataVersion = repFromMaster.metadataVersion;
+	rep.processBusyTime =
+	    FLOW_KNOBS->BASIC_LOAD_BALANCE_COMPUTE_PRECISION *
+	    std::min((std::numeric_limits<int>::max() / FLOW_KNOBS->BASIC_LOAD_BALANCE_COMPUTE_PRECISION) - 1,
+	             grvProxyData->stats.getRecentRequests());
+	rep.processBusyTime += FLOW_KNOBS->BASIC_LOAD_BALANCE_COMPUTE_PRECISION *
+	                       (g_network->isSimulated() ? deterministicRandom()->random01()
+	                                                 : g_network->networkInfo.metrics.lastRunLoopBusyness);
+	return rep;
+}
+
+// A causal read risky request may be answered with a version the master handed out up to GRV_CACHED_VERSION_LEASE
+// seconds ago, as long as the epoch is known to be live. Such a version is committed, but can be older than commits
+// acknowledged since, which is the staleness those requests opt into.
+bool canUseCachedVersion(GrvProxyData* grvProxyData, uint32_t flags) {
+	if (SERVER_KNOBS->GRV_CACHED_VERSION_LEASE <= 0 || SERVER_KNOBS->ENABLE_VERSION_VECTOR ||
+	    !grvProxyData->cachedCommittedVersion.present()) {
+		return false;
+	}
+	if (!SERVER_KNOBS->ALWAYS_CAUSAL_READ_RISKY && !(flags & GetReadVersionRequest::FLAG_CAUSAL_READ_RISKY)) {
+		return false;
+	}
+	if (now() - grvProxyData->cachedCommittedVersionTime > SERVER_KNOBS->GRV_CACHED_VERSION_LEASE) {
+		return false;
+	}
+	return SERVER_KNOBS->REQUIRED_MIN_RECOVERY_DURATION <= 0 ||
+	       now() - SERVER_KNOBS->REQUIRED_MIN_RECOVERY_DURATION <= grvProxyData->lastCommitTime.get();
+}
+
 ACTOR Future<GetReadVersionReply> getLiveCommittedVersion(std::vector<SpanContext> spanContexts,
                                                           GrvProxyData* grvProxyData,
                                                           uint32_t flags,
@@ -658,6 +697,16 @@ ACTOR Future<GetReadVersionReply> getLiveCommittedVersion(std::vector<SpanContex
 	}
 	++grvProxyData->stats.txnStartBatch;
 
+	if (canUseCachedVersion(grvProxyData, flags)) {
+		++grvProxyData->stats.txnStartBatchCachedVersion;
+		GetReadVersionReply rep = makeReadVersionReply(grvProxyData, grvProxyData->cachedCommittedVersion.get());
+		grvProxyData->stats.txnStartOut += transactionCount;
+		grvProxyData->stats.txnSystemPriorityStartOut += systemTransactionCount;
+		grvProxyData->stats.txnDefaultPriorityStartOut += defaultPriTransactionCount;
+		grvProxyData->stats.txnBatchPriorityStartOut += batchPriTransactionCount;
+		return rep;
+	}
+
 	state double grvStart = now();
 	state Future<GetRawCommittedVersionReply> replyFromMasterFuture;
 	replyFromMasterFuture = grvProxyData->master.getLiveCommittedVersion.getReply(
@@ -688,17 +737,11 @@ ACTOR Future<GetReadVersionReply> getLiveCommittedVersion(std::vector<SpanContex
 		grvProxyData->ssVersionVectorCache.applyDelta(repFromMaster.ssVersionVectorDelta);
 	}
 	grvProxyData->stats.grvGetCommittedVersionRpcDist->sampleSeconds(now() - grvConfirmEpochLive);
-	GetReadVersionReply rep;
-	rep.version = repFromMaster.version;
-	rep.locked = repFromMaster.locked;
-	rep.metadataVersion = repFromMaster.metadataVersion;
-	rep.processBusyTime =
-	    FLOW_KNOBS->BASIC_LOAD_BALANCE_COMPUTE_PRECISION *
-	    std::min((std::numeric_limits<int>::max() / FLOW_KNOBS->BASIC_LOAD_BALANCE_COMPUTE_PRECISION) - 1,
-	             grvProxyData->stats.getRecentRequests());
-	rep.processBusyTime += FLOW_KNOBS->BASIC_LOAD_BALANCE_COMPUTE_PRECISION *
-	                       (g_network->isSimulated() ? deterministicRandom()->random01()
-	                                                 : g_network->networkInfo.metrics.lastRunLoopBusyness);
+	if (grvStart >= grvProxyData->cachedCommittedVersionTime) {
+		grvProxyData->cachedCommittedVersion = repFromMaster;
+		grvProxyData->cachedCommittedVersionTime = grvStart;
+	}
+	GetReadVersionReply rep = makeReadVersionReply(grvProxyData, repFromMaster);
 
 	if (debugID.present()) {
 		g_traceBatch.addEvent(
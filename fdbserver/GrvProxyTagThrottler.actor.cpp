@@ -67,6 +67,14 @@ void GrvProxyTagThrottler::TagQueue::endReleaseWindow(int64_t numStarted, double
 	}
 }
 
+void GrvProxyTagThrottler::TagQueue::catchUp(double releasedElapsed) {
+	if (rateInfo.present() && releasedElapsed > windowsEnd) {
+		rateInfo.get().startReleaseWindow();
+		rateInfo.get().endReleaseWindow(0, true, releasedElapsed - windowsEnd);
+	}
+	windowsEnd = releasedElapsed;
+}
+
 GrvProxyTagThrottler::GrvProxyTagThrottler(double maxThrottleDuration)
   : maxThrottleDuration(maxThrottleDuration),
     latencyBandsMap("GrvProxyTagThrottler",
@@ -79,7 +87,11 @@ void GrvProxyTagThrottler::updateRates(TransactionTagMap<double> const& newRates
 		auto it = queues.find(tag);
 		if (it == queues.end()) {
 			queues[tag] = TagQueue(rate);
+			queues[tag].windowsEnd = releasedElapsed;
 		} else {
+			if (!it->second.rateInfo.present()) {
+				it->second.windowsEnd = releasedElapsed;
+			}
 			it->second.setRate(rate);
 		}
 	}
@@ -115,7 +127,12 @@ void GrvProxyTagThrottler::addRequest(GetReadVersionRequest const& req) {
 		    .detail("NumTags", req.tags.size())
 		    .detail("UsingTag", tag);
 	}
-	queues[tag].requests.emplace_back(req);
+	auto& queue = queues[tag];
+	if (queue.requests.empty()) {
+		queue.catchUp(releasedElapsed);
+		activeQueues.push_back(&queue);
+	}
+	queue.requests.emplace_back(req);
 }
 
 GrvProxyTagThrottler::ReleaseTransactionsResult GrvProxyTagThrottler::releaseTransactions(
@@ -126,14 +143,11 @@ GrvProxyTagThrottler::ReleaseTransactionsResult GrvProxyTagThrottler::releaseTra
 
 	// Pointer to a TagQueue with some extra metadata stored alongside
 	struct TagQueueHandle {
-		// Store pointers here to avoid frequent std::unordered_map lookups
 		TagQueue* queue;
-		// Cannot be stored directly because we need to
-		uint32_t* numReleased;
 		// Sequence number of the first queued request
 		int64_t nextSeqNo;
 		bool operator>(TagQueueHandle const& rhs) const { return nextSeqNo > rhs.nextSeqNo; }
-		explicit TagQueueHandle(TagQueue& queue, uint32_t& numReleased) : queue(&queue), numReleased(&numReleased) {
+		explicit TagQueueHandle(TagQueue& queue) : queue(&queue) {
 			ASSERT(!this->queue->requests.empty());
 			nextSeqNo = this->queue->requests.front().sequenceNumber;
 		}
@@ -143,27 +157,12 @@ GrvProxyTagThrottler::ReleaseTransactionsResult GrvProxyTagThrottler::releaseTra
 	// next request to process in each queue
 	std::priority_queue<TagQueueHandle, std::vector<TagQueueHandle>, std::greater<TagQueueHandle>> pqOfQueues;
 
-	// Track transactions released for each tag
-	std::vector<std::pair<TransactionTag, uint32_t>> transactionsReleased;
-	transactionsReleased.reserve(queues.size());
-	auto const transactionsReleasedInitialCapacity = transactionsReleased.capacity();
-
-	for (auto& [tag, queue] : queues) {
-		if (queue.rateInfo.present()) {
-			queue.rateInfo.get().startReleaseWindow();
-		}
-		if (!queue.requests.empty()) {
-			// First place the count in the transactionsReleased object,
-			// then pass a reference to the count to the TagQueueHandle object
-			// emplaced into pqOfQueues.
-			//
-			// Because we've reserved enough space in transactionsReleased
-			// to avoid resizing, this reference should remain valid.
-			// This allows each TagQueueHandle to update its number of
-			// numReleased counter without incurring the cost of a std::unordered_map lookup.
-			auto& [_, count] = transactionsReleased.emplace_back(tag, 0);
-			pqOfQueues.emplace(queue, count);
+	for (TagQueue* queue : activeQueues) {
+		if (queue->rateInfo.present()) {
+			queue->rateInfo.get().startReleaseWindow();
 		}
+		queue->numReleased = 0;
+		pqOfQueues.emplace(*queue);
 	}
 
 	while (!pqOfQueues.empty()) {
@@ -178,7 +177,7 @@ GrvProxyTagThrottler::ReleaseTransactionsResult GrvProxyTagThrottler::releaseTra
 			auto count = delayedReq.req.tags.begin()->second;
 			ASSERT_EQ(tagQueueHandle.nextSeqNo, delayedReq.sequenceNumber);
 			if (tagQueueHandle.queue->rateInfo.present() &&
-			    !tagQueueHandle.queue->rateInfo.get().canStart(*(tagQueueHandle.numReleased), count)) {
+			    !tagQueueHandle.queue->rateInfo.get().canStart(tagQueueHandle.queue->numReleased, count)) {
 				// Cannot release any more transaction from this tag (don't push the tag queue handle back into
 				// pqOfQueues)
 				CODE_PROBE(true, "GrvProxyTagThrottler throttling transaction");
@@ -192,7 +191,7 @@ GrvProxyTagThrottler::ReleaseTransactionsResult GrvProxyTagThrottler::releaseTra
 			} else {
 				if (tagQueueHandle.nextSeqNo < nextQueueSeqNo) {
 					// Releasing transaction
-					*(tagQueueHandle.numReleased) += count;
+					tagQueueHandle.queue->numReleased += count;
 					delayedReq.updateProxyTagThrottledDuration(latencyBandsMap);
 					if (delayedReq.req.priority == TransactionPriority::BATCH) {
 						result.batchPriorityTransactionsReleased += delayedReq.req.transactionCount;
@@ -219,19 +218,17 @@ GrvProxyTagThrottler::ReleaseTransactionsResult GrvProxyTagThrottler::releaseTra
 		}
 	}
 
-	// End release windows for all tag queues
-	{
-		TransactionTagMap<uint32_t> transactionsReleasedMap;
-		for (const auto& [tag, count] : transactionsReleased) {
-			transactionsReleasedMap[tag] = count;
-		}
-		for (auto& [tag, queue] : queues) {
-			queue.endReleaseWindow(transactionsReleasedMap[tag], elapsed);
+	// End the release windows of the active tag queues, and keep those still holding requests active
+	releasedElapsed += elapsed;
+	size_t stillActive = 0;
+	for (TagQueue* queue : activeQueues) {
+		queue->endReleaseWindow(queue->numReleased, elapsed);
+		queue->windowsEnd = releasedElapsed;
+		if (!queue->requests.empty()) {
+			activeQueues[stillActive++] = queue;
 		}
 	}
-	// If the capacity is increased, that means the vector has been illegally resized, potentially
-	// corrupting memory
-	ASSERT_EQ(transactionsReleased.capacity(), transactionsReleasedInitialCapacity);
+	activeQueues.resize(stillActive);
 
 	return result;
 }
@@ -436,6 +433,29 @@ TEST_CASE("/GrvProxyTagThrottler/Batch") {
 	return Void();
 }
 
+// Many tags have rates but no requests. The one tag in use still gets its rate.
+TEST_CASE("/GrvProxyTagThrottler/IdleTags") {
+	state GrvProxyTagThrottler throttler(5.0);
+	state TagSet tagSet;
+	state TransactionTagMap<uint32_t> counters;
+	{
+		TransactionTagMap<double> rates;
+		for (int i = 0; i < 10000; ++i) {
+			rates[getRandomTag()] = 10.0;
+		}
+		rates["sampleTag"_sr] = 10.0;
+		throttler.updateRates(rates);
+	}
+	tagSet.addTag("sampleTag"_sr);
+
+	state Future<Void> client = mockClient(&throttler, TransactionPriority::DEFAULT, tagSet, 1, 20.0, &counters);
+	state Future<Void> server = mockServer(&throttler);
+	wait(timeout(client && server, 60.0, Void()));
+	TraceEvent("TagQuotaTest_IdleTags").detail("Counter", counters["sampleTag"_sr]);
+	ASSERT(isNear(counters["sampleTag"_sr], 60.0 * 10.0));
+	return Void();
+}
+
 // Tests cleanup of tags that are no longer throttled.
 TEST_CASE("/GrvProxyTagThrottler/Cleanup1") {
 	GrvProxyTagThrottler throttler(5.0);
@@ -0,0 +1,148 @@
+/*
+ * HotValueCache.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbserver/HotValueCache.h"
+
+#include "flow/UnitTest.h"
+
+// Approximate memory used by an entry besides its key and value
+static constexpr int64_t entryOverhead = 96;
+
+Optional<Optional<Value>> HotValueCache::get(KeyRef key) {
+	auto it = entries.find(key);
+	if (it == entries.end()) {
+		return Optional<Optional<Value>>();
+	}
+	lru.splice(lru.end(), lru, it->second.lruPosition);
+	return it->second.value;
+}
+
+bool HotValueCache::insert(KeyRef key, Optional<Value> const& value, uint64_t token) {
+	if (token != writes || committedWrites < writes) {
+		return false;
+	}
+	const int64_t entryBytes = key.size() + value.expectedSize() + entryOverhead;
+	if (entryBytes > capacityBytes) {
+		return false;
+	}
+
+	auto it = entries.find(key);
+	if (it != entries.end()) {
+		erase(it);
+	}
+	while (bytes + entryBytes > capacityBytes) {
+		erase(entries.find(lru.front()));
+		++evictions;
+	}
+	it = entries.emplace(Key(key), Entry{ value, lru.end(), entryBytes }).first;
+	it->second.lruPosition = lru.insert(lru.end(), it->first);
+	bytes += entryBytes;
+	return true;
+}
+
+void HotValueCache::invalidate(KeyRef key) {
+	++writes;
+	auto it = entries.find(key);
+	if (it != entries.end()) {
+		erase(it);
+	}
+}
+
+void HotValueCache::invalidate(KeyRangeRef range) {
+	if (range.singleKeyRange()) {
+		invalidate(range.begin);
+		return;
+	}
+	++writes;
+	auto it = entries.lower_bound(range.begin);
+	while (it != entries.end() && it->first < range.end) {
+		erase(it++);
+	}
+}
+
+void HotValueCache::invalidateAll() {
+	++writes;
+	entries.clear();
+	lru.clear();
+	bytes = 0;
+}
+
+void HotValueCache::erase(std::map<Key, Entry, std::less<>>::iterator it) {
+	bytes -= it->second.bytes;
+	lru.erase(it->second.lruPosition);
+	entries.erase(it);
+}
+
+TEST_CASE("/fdbserver/HotValueCache/invalidation") {
+	HotValueCache cache(1 << 20);
+
+	uint64_t token = cache.beginRead();
+	ASSERT(cache.insert("a"_sr, Optional<Value>("1"_sr), token));
+	ASSERT(cache.insert("b"_sr, Optional<Value>(), token));
+	ASSERT(cache.get("a"_sr).get() == Optional<Value>("1"_sr));
+	ASSERT(cache.get("b"_sr).present() && !cache.get("b"_sr).get().present());
+	ASSERT(!cache.get("c"_sr).present());
+
+	// A read that began before a write can't be cached, nor can any read until the write is committed
+	token = cache.beginRead();
+	cache.invalidate("a"_sr);
+	ASSERT(!cache.get("a"_sr).present());
+	ASSERT(!cache.insert("a"_sr, Optional<Value>("1"_sr), token));
+	uint64_t commit = cache.beginCommit();
+	ASSERT(!cache.insert("a"_sr, Optional<Value>("2"_sr), cache.beginRead()));
+	cache.committed(commit);
+	ASSERT(cache.insert("a"_sr, Optional<Value>("2"_sr), cache.beginRead()));
+	ASSERT(cache.get("a"_sr).get() == Optional<Value>("2"_sr));
+
+	// A write during a commit is only committed by a later one
+	commit = cache.beginCommit();
+	cache.invalidate(KeyRangeRef("a"_sr, "c"_sr));
+	cache.committed(commit);
+	ASSERT(!cache.get("a"_sr).present() && !cache.get("b"_sr).present());
+	ASSERT(!cache.insert("a"_sr, Optional<Value>("3"_sr), cache.beginRead()));
+	cache.committed(cache.beginCommit());
+	ASSERT(cache.insert("a"_sr, Optional<Value>("3"_sr), cache.beginRead()));
+
+	cache.invalidateAll();
+	ASSERT(cache.getCount() == 0 && cache.getBytes() == 0);
+	return Void();
+}
+
+TEST_CASE("/fdbserver/HotValueCache/eviction") {
+	const Value value = makeString(100);
+	const int64_t entryBytes = 1 + value.size() + entryOverhead;
+	HotValueCache cache(entryBytes * 3);
+
+	for (char k = 'a'; k <= 'c'; k++) {
+		ASSERT(cache.insert(StringRef((const uint8_t*)&k, 1), value, cache.beginRead()));
+	}
+	// Using "a" makes "b" the least recently used entry
+	ASSERT(cache.get("a"_sr).present());
+	ASSERT(cache.insert("d"_sr, value, cache.beginRead()));
+	ASSERT(cache.getCount() == 3 && cache.getBytes() == entryBytes * 3 && cache.getEvictions() == 1);
+	ASSERT(!cache.get("b"_sr).present());
+	ASSERT(cache.get("a"_sr).present() && cache.get("c"_sr).present() && cache.get("d"_sr).present());
+
+	// Replacing an entry doesn't evict others, and an entry larger than the cache isn't admitted
+	ASSERT(cache.insert("a"_sr, value, cache.beginRead()));
+	ASSERT(cache.getCount() == 3 && cache.getEvictions() == 1);
+	ASSERT(!cache.insert("e"_sr, makeString(entryBytes * 3), cache.beginRead()));
+	return Void();
+}
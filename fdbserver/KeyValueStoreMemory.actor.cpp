@@ -92,10 +92,14 @@ public:
 		// Try to bound how many in-memory bytes we might need to write to disk if we commit() now
 		int64_t uncommittedBytes = queue.totalSize() + transactionSize;
 
-		// Check that we have enough space in memory and on disk
-		int64_t freeSize = std::min(getAvailableSize(), diskQueueBytes.free / 4 - uncommittedBytes);
-		int64_t availableSize = std::min(getAvailableSize(), diskQueueBytes.available / 4 - uncommittedBytes);
-		int64_t totalSize = std::min(memoryLimit, diskQueueBytes.total / 4 - uncommittedBytes);
+		// Check that we have enough space in memory and on disk. The disk queue holds up to two snapshots and the
+		// mutations committed while writing them, which take 1 / KVS_MEM_SNAPSHOT_WRITE_RATIO times as many bytes.
+		const double diskBytesPerByte = 2 + 2 / snapshotWriteRatio();
+		int64_t freeSize =
+		    std::min(getAvailableSize(), int64_t(diskQueueBytes.free / diskBytesPerByte) - uncommittedBytes);
+		int64_t availableSize =
+		    std::min(getAvailableSize(), int64_t(diskQueueBytes.available / diskBytesPerByte) - uncommittedBytes);
+		int64_t totalSize = std::min(memoryLimit, int64_t(diskQueueBytes.total / diskBytesPerByte) - uncommittedBytes);
 
 		return StorageBytes(std::max((int64_t)0, freeSize),
 		                    std::max((int64_t)0, totalSize),
@@ -430,6 +434,25 @@ private:
 					data.insert(dataSets);
 					dataSets.clear();
 				}
+				const OpRef* runEnd = log ? o : snapshotRunEnd(o, ops.end());
+				if (runEnd != o) {
+					// When recovering, the clears and sets of a run of snapshot items are together the replacement of
+					// everything in the run's range by its items. Erasing the range first lets the items, which are
+					// sorted, be inserted one after the other instead of each through a search from the root.
+					data.erase(data.lower_bound(o->p1), data.lower_bound(keyAfter((runEnd - 1)->p1)));
+					for (auto item = o + 1; item < runEnd; ++item) {
+						++count;
+						total += item->p1.size() + item->p2.size() + OP_DISK_OVERHEAD;
+						if (item->op == OpSet) {
+							KeyValueMapPair pair(item->p1, item->p2);
+							dataSets.emplace_back(pair, pair.arena.getSize() + data.getElementBytes());
+						}
+					}
+					data.insert(dataSets);
+					dataSets.clear();
+					o = runEnd - 1;
+					continue;
+				}
 				data.erase(data.lower_bound(o->p1), data.lower_bound(o->p2));
 			} else if (o->op == OpClearToEnd) {
 				if (sequential) {
@@ -461,6 +484,27 @@ private:
 		return total;
 	}
 
+	// Returns the end of the run of alternating clears and sets starting at the clear o, in which each clear ends at
+	// the key set right after it and begins right after the key set before it, as recovered snapshot items are. Returns
+	// o if the run would be shorter than a clear and a set.
+	static const OpRef* snapshotRunEnd(const OpRef* o, const OpRef* end) {
+		const OpRef* runEnd = o;
+		while (runEnd + 1 < end && runEnd->op == OpClear && (runEnd + 1)->op == OpSet &&
+		       runEnd->p2 == (runEnd + 1)->p1) {
+			if (runEnd != o) {
+				const KeyRef previous = (runEnd - 1)->p1;
+				const KeyRef begin = runEnd->p1;
+				if (begin.size() != previous.size() + 1 || !begin.startsWith(previous) || begin[previous.size()] != 0) {
+					break;
+				}
+			}
+			runEnd += 2;
+		}
+		return runEnd;
+	}
+
+	static double snapshotWriteRatio() { return std::max(SERVER_KNOBS->KVS_MEM_SNAPSHOT_WRITE_RATIO, 0.01); }
+
 	static bool isOpEncrypted(OpHeader* header) { return header->op >> ENCRYPTION_ENABLED_BIT == 1; }
 
 	static void setEncryptFlag(OpHeader* header, bool set) {
@@ -842,6 +886,7 @@ private:
 
 		state Key nextKey = self->recoveredSnapshotKey;
 		state bool nextKeyAfter = false; // setting this to true is equilvent to setting nextKey = keyAfter(nextKey)
+		// Snapshot bytes written, scaled by 1 / KVS_MEM_SNAPSHOT_WRITE_RATIO to compare with committed write bytes
 		state uint64_t snapshotTotalWrittenBytes = 0;
 		state int lastDiff = 0;
 		state int snapItems = 0;
@@ -909,7 +954,7 @@ private:
 
 					snapItems = 0;
 					snapshotBytes = 0;
-					snapshotTotalWrittenBytes += OP_DISK_OVERHEAD;
+					snapshotTotalWrittenBytes += OP_DISK_OVERHEAD / snapshotWriteRatio();
 
 					// If we're not stopping now, reset next
 					if (snapshotTotalWrittenBytes < self->notifiedCommittedWriteBytes.get()) {
@@ -975,7 +1020,7 @@ private:
 					snapItems++;
 					uint64_t opBytes = opKeySize + next.getValue().size() + OP_DISK_OVERHEAD;
 					snapshotBytes += opBytes;
-					snapshotTotalWrittenBytes += opBytes;
+					snapshotTotalWrittenBytes += opBytes / snapshotWriteRatio();
 					lastSnapshotKeyUsingA = !lastSnapshotKeyUsingA;
 
 					// If we're not stopping now, increment next
@@ -50,6 +50,7 @@
 #include "fdbclient/SystemData.h"
 #include "fdbserver/CoroFlow.h"
 #include "fdbserver/FDBRocksDBVersion.h"
+#include "fdbserver/RocksDBBlockCache.h"
 #include "fdbserver/RocksDBLogForwarder.h"
 #include "flow/ActorCollection.h"
 #include "flow/flow.h"
@@ -57,6 +58,7 @@
 #include "flow/ThreadHelper.actor.h"
 #include "flow/Histogram.h"
 
+#include <deque>
 #include <memory>
 #include <tuple>
 #include <vector>
@@ -94,6 +96,33 @@ rocksdb::WALRecoveryMode getWalRecoveryMode() {
 		return rocksdb::WALRecoveryMode::kPointInTimeRecovery;
 	}
 }
+
+// With ROCKSDB_USER_DEFINED_TIMESTAMPS, keys are tagged with the version they are written at, as the little endian
+// 64 bit timestamps of BytewiseComparatorWithU64Ts()
+std::string versionTimestamp(uint64_t version) {
+	std::string ts(sizeof(uint64_t), '\0');
+	for (size_t i = 0; i < sizeof(uint64_t); i++) {
+		ts[i] = static_cast<char>(version >> (8 * i));
+	}
+	return ts;
+}
+
+// Reads of the latest state read at the largest timestamp
+const rocksdb::Slice* latestTimestamp() {
+	static const std::string ts = versionTimestamp(std::numeric_limits<uint64_t>::max());
+	static const rocksdb::Slice slice(ts);
+	return &slice;
+}
+
+// Keys given to write batch handlers end with their timestamps
+rocksdb::Slice withoutTimestamp(const rocksdb::Slice& key) {
+	if (!SERVER_KNOBS->ROCKSDB_USER_DEFINED_TIMESTAMPS) {
+		return key;
+	}
+	ASSERT(key.size() >= sizeof(uint64_t));
+	return rocksdb::Slice(key.data(), key.size() - sizeof(uint64_t));
+}
+
 class SharedRocksDBState {
 public:
 	SharedRocksDBState(UID id);
@@ -124,6 +153,9 @@ SharedRocksDBState::SharedRocksDBState(UID id)
 
 rocksdb::ColumnFamilyOptions SharedRocksDBState::initialCfOptions() {
 	rocksdb::ColumnFamilyOptions options;
+	if (SERVER_KNOBS->ROCKSDB_USER_DEFINED_TIMESTAMPS) {
+		options.comparator = rocksdb::BytewiseComparatorWithU64Ts();
+	}
 	options.level_compaction_dynamic_level_bytes = SERVER_KNOBS->ROCKSDB_LEVEL_COMPACTION_DYNAMIC_LEVEL_BYTES;
 	if (SERVER_KNOBS->ROCKSDB_LEVEL_STYLE_COMPACTION) {
 		options.OptimizeLevelStyleCompaction(SERVER_KNOBS->ROCKSDB_MEMTABLE_BYTES);
@@ -204,11 +236,8 @@ rocksdb::ColumnFamilyOptions SharedRocksDBState::initialCfOptions() {
 	}
 
 	if (SERVER_KNOBS->ROCKSDB_BLOCK_CACHE_SIZE > 0) {
-		bbOpts.block_cache =
-		    rocksdb::NewLRUCache(SERVER_KNOBS->ROCKSDB_BLOCK_CACHE_SIZE,
-		                         -1, /* num_shard_bits, default value:-1*/
-		                         false, /* strict_capacity_limit, default value:false */
-		                         SERVER_KNOBS->ROCKSDB_CACHE_HIGH_PRI_POOL_RATIO /* high_pri_pool_ratio */);
+		bbOpts.block_cache = newRocksDBBlockCache(SERVER_KNOBS->ROCKSDB_BLOCK_CACHE_SIZE,
+		                                          SERVER_KNOBS->ROCKSDB_CACHE_HIGH_PRI_POOL_RATIO);
 		bbOpts.cache_index_and_filter_blocks = SERVER_KNOBS->ROCKSDB_CACHE_INDEX_AND_FILTER_BLOCKS;
 		bbOpts.pin_l0_filter_and_index_blocks_in_cache = SERVER_KNOBS->ROCKSDB_CACHE_INDEX_AND_FILTER_BLOCKS;
 		bbOpts.cache_index_and_filter_blocks_with_high_priority = SERVER_KNOBS->ROCKSDB_CACHE_INDEX_AND_FILTER_BLOCKS;
@@ -291,6 +320,9 @@ rocksdb::ReadOptions SharedRocksDBState::initialReadOptions() {
 	rocksdb::ReadOptions options;
 	options.background_purge_on_iterator_cleanup = true;
 	options.auto_prefix_mode = (SERVER_KNOBS->ROCKSDB_PREFIX_LEN > 0);
+	if (SERVER_KNOBS->ROCKSDB_USER_DEFINED_TIMESTAMPS) {
+		options.timestamp = latestTimestamp();
+	}
 	return options;
 }
 
@@ -482,27 +514,74 @@ struct Counters {
 	Counter convertedDeleteRangeReqs;
 	Counter rocksdbReadRangeQueries;
 	Counter commitDelayed;
+	Counter coalescedReadBatches;
+	Counter coalescedReads;
+	Counter fetchIngestedRanges;
+	Counter fetchIngestedBytes;
 
 	Counters()
 	  : cc("RocksDBThrottle"), immediateThrottle("ImmediateThrottle", cc), failedToAcquire("FailedToAcquire", cc),
 	    deleteKeyReqs("DeleteKeyRequests", cc), deleteRangeReqs("DeleteRangeRequests", cc),
 	    convertedDeleteKeyReqs("ConvertedDeleteKeyRequests", cc),
 	    convertedDeleteRangeReqs("ConvertedDeleteRangeRequests", cc),
-	    rocksdbReadRangeQueries("RocksdbReadRangeQueries", cc), commitDelayed("CommitDelayed", cc) {}
+	    rocksdbReadRangeQueries("RocksdbReadRangeQueries", cc), commitDelayed("CommitDelayed", cc),
+	    coalescedReadBatches("CoalescedReadBatches", cc), coalescedReads("CoalescedReads", cc),
+	    fetchIngestedRanges("FetchIngestedRanges", cc), fetchIngestedBytes("FetchIngestedBytes", cc) {}
+};
+
+// A range replaced by fetchKeys, written as an SST file and ingested at commit instead of through the write batch.
+struct IngestedRange {
+	KeyRange range;
+	Standalone<VectorRef<KeyValueRef>> data;
+	// Number of write batch entries written before the range was replaced. The batch is written after all ingestions
+	// of a commit, so those of its first batchPosition entries falling in the range are dropped from it.
+	uint32_t batchPosition;
 };
 
+// Prefix of the names of the SST files written for IngestedRanges in a RocksDB directory
+const std::string fetchIngestFilePrefix = "fetch-ingest-";
+
+// Read options for an iterator reading ahead readaheadSize bytes, or relying on RocksDB's auto readahead if 0.
+rocksdb::ReadOptions getIteratorReadOptions(std::shared_ptr<SharedRocksDBState> sharedState, size_t readaheadSize) {
+	rocksdb::ReadOptions readOptions = sharedState->getReadOptions();
+	if (readaheadSize > 0) {
+		readOptions.readahead_size = readaheadSize;
+		// Carries the readahead size over from one file to the next instead of starting small in each.
+		readOptions.adaptive_readahead = true;
+		readOptions.async_io = SERVER_KNOBS->ROCKSDB_READ_RANGE_ASYNC_IO;
+	}
+	return readOptions;
+}
+
 struct ReadIterator {
 	uint64_t index; // incrementing counter to uniquely identify read iterator.
 	bool inUse;
 	std::shared_ptr<rocksdb::Iterator> iter;
 	double creationTime;
 	KeyRange keyRange;
+	size_t readaheadSize;
 	std::shared_ptr<rocksdb::Slice> beginSlice, endSlice;
-	ReadIterator(CF& cf, uint64_t index, DB& db, std::shared_ptr<SharedRocksDBState> sharedState)
-	  : index(index), inUse(true), creationTime(now()), iter(db->NewIterator(sharedState->getReadOptions(), cf)) {}
-	ReadIterator(CF& cf, uint64_t index, DB& db, std::shared_ptr<SharedRocksDBState> sharedState, KeyRange keyRange)
-	  : index(index), inUse(true), creationTime(now()), keyRange(keyRange) {
-		rocksdb::ReadOptions readOptions = sharedState->getReadOptions();
+	std::shared_ptr<std::string> timestamp; // to read at, if not the latest
+	std::shared_ptr<rocksdb::Slice> timestampSlice;
+	ReadIterator(CF& cf, uint64_t index, DB& db, std::shared_ptr<SharedRocksDBState> sharedState, size_t readaheadSize)
+	  : index(index), inUse(true), creationTime(now()), readaheadSize(readaheadSize),
+	    iter(db->NewIterator(getIteratorReadOptions(sharedState, readaheadSize), cf)) {}
+	ReadIterator(CF& cf,
+	             uint64_t index,
+	             DB& db,
+	             std::shared_ptr<SharedRocksDBState> sharedState,
+	             KeyRange keyRange,
+	             size_t readaheadSize,
+	             const rocksdb::Snapshot* snapshot = nullptr,
+	             Version version = invalidVersion)
+	  : index(index), inUse(true), creationTime(now()), keyRange(keyRange), readaheadSize(readaheadSize) {
+		rocksdb::ReadOptions readOptions = getIteratorReadOptions(sharedState, readaheadSize);
+		readOptions.snapshot = snapshot;
+		if (version != invalidVersion) {
+			timestamp = std::make_shared<std::string>(versionTimestamp(version));
+			timestampSlice = std::make_shared<rocksdb::Slice>(*timestamp);
+			readOptions.timestamp = timestampSlice.get();
+		}
 		beginSlice = std::shared_ptr<rocksdb::Slice>(new rocksdb::Slice(toSlice(keyRange.begin)));
 		readOptions.iterate_lower_bound = beginSlice.get();
 		endSlice = std::shared_ptr<rocksdb::Slice>(new rocksdb::Slice(toSlice(keyRange.end)));
@@ -523,6 +602,10 @@ Write: Iterators in the pool are deleted, forcing new iterator creation on next
 which are currently used by the reads can continue using the iterator as it is a shared_ptr. Once
 the read is processed, shared_ptr goes out of scope and gets deleted. Eventually the iterator object
 gets deleted as the ref count becomes 0.
+
+Readahead: Forward range reads which are large, or which continue a recent read that stopped at its
+limit, get iterators reading ahead by a power of two bytes. Iterators are only reused by reads wanting
+the same readahead.
 */
 class ReadIteratorPool {
 public:
@@ -554,12 +637,60 @@ public:
 		}
 	}
 
+	// Called before getIterator() for forward range reads. Returns the readahead size to read keyRange with, 0 for
+	// none. A read continuing a recent one is part of a scan and reads ahead twice what its byte limit alone would.
+	size_t getReadaheadSize(KeyRange keyRange, int byteLimit) {
+		if (SERVER_KNOBS->ROCKSDB_READ_RANGE_READAHEAD_MIN_BYTES <= 0) {
+			return 0;
+		}
+		bool sequential = false;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto resumeKey = std::find(resumeKeys.begin(), resumeKeys.end(), keyRange.begin);
+			if (resumeKey != resumeKeys.end()) {
+				resumeKeys.erase(resumeKey);
+				sequential = true;
+			}
+		}
+		if (sequential) {
+			++sequentialRangeReads;
+		} else if (byteLimit < SERVER_KNOBS->ROCKSDB_READ_RANGE_READAHEAD_MIN_BYTES) {
+			return 0;
+		}
+		const int64_t wanted = std::min<int64_t>(std::max<int64_t>(byteLimit, 1) * (sequential ? 2 : 1),
+		                                         SERVER_KNOBS->ROCKSDB_READ_RANGE_READAHEAD_MAX_SIZE);
+		// Rounding down to a power of two keeps the number of distinct readahead sizes, and so of iterators, small.
+		size_t readaheadSize = 1;
+		while (readaheadSize * 2 <= wanted) {
+			readaheadSize *= 2;
+		}
+		return readaheadSize;
+	}
+
+	// Called after every range read. resumeKey is where the next read continuing this one would begin, if any.
+	void recordRangeRead(int64_t bytes, double seconds, Optional<Key> resumeKey) {
+		rangeReadBytes += bytes;
+		rangeReadMicros += static_cast<uint64_t>(seconds * 1e6);
+		if (resumeKey.present() && SERVER_KNOBS->ROCKSDB_READ_RANGE_READAHEAD_MIN_BYTES > 0) {
+			std::lock_guard<std::mutex> lock(mutex);
+			resumeKeys.push_back(resumeKey.get());
+			const size_t history = std::max(SERVER_KNOBS->ROCKSDB_READ_RANGE_READAHEAD_HISTORY, 0);
+			while (resumeKeys.size() > history) {
+				resumeKeys.pop_front();
+			}
+		}
+	}
+
 	// Called on every read operation.
-	ReadIterator getIterator(KeyRange keyRange) {
+	ReadIterator getIterator(KeyRange keyRange, size_t readaheadSize = 0) {
+		if (readaheadSize > 0) {
+			++readaheadIteratorsUsed;
+		}
 		if (SERVER_KNOBS->ROCKSDB_READ_RANGE_REUSE_ITERATORS) {
 			mutex.lock();
 			for (it = iteratorsMap.begin(); it != iteratorsMap.end(); it++) {
-				if (!it->second.inUse && it->second.index > deletedUptoIndex) {
+				if (!it->second.inUse && it->second.index > deletedUptoIndex &&
+				    it->second.readaheadSize == readaheadSize) {
 					it->second.inUse = true;
 					iteratorsReuseCount++;
 					ReadIterator iter = it->second;
@@ -571,7 +702,7 @@ public:
 			uint64_t readIteratorIndex = index;
 			mutex.unlock();
 
-			ReadIterator iter(cf, readIteratorIndex, db, sharedState);
+			ReadIterator iter(cf, readIteratorIndex, db, sharedState, readaheadSize);
 			mutex.lock();
 			iteratorsMap.insert({ readIteratorIndex, iter });
 			mutex.unlock();
@@ -581,7 +712,7 @@ public:
 			mutex.lock();
 			for (it = iteratorsMap.begin(); it != iteratorsMap.end(); it++) {
 				if (!it->second.inUse && it->second.index > deletedUptoIndex &&
-				    it->second.keyRange.contains(keyRange)) {
+				    it->second.keyRange.contains(keyRange) && it->second.readaheadSize == readaheadSize) {
 					it->second.inUse = true;
 					iteratorsReuseCount++;
 					ReadIterator iter = it->second;
@@ -593,7 +724,7 @@ public:
 			uint64_t readIteratorIndex = index;
 			mutex.unlock();
 
-			ReadIterator iter(cf, readIteratorIndex, db, sharedState, keyRange);
+			ReadIterator iter(cf, readIteratorIndex, db, sharedState, keyRange, readaheadSize);
 			if (iteratorsMap.size() < SERVER_KNOBS->ROCKSDB_READ_RANGE_BOUNDED_ITERATORS_MAX_LIMIT) {
 				// Not storing more than ROCKSDB_READ_RANGE_BOUNDED_ITERATORS_MAX_LIMIT of iterators
 				// to avoid 'out of memory' issues.
@@ -604,7 +735,7 @@ public:
 			return iter;
 		} else {
 			index++;
-			ReadIterator iter(cf, index, db, sharedState, keyRange);
+			ReadIterator iter(cf, index, db, sharedState, keyRange, readaheadSize);
 			return iter;
 		}
 	}
@@ -643,6 +774,14 @@ public:
 
 	uint64_t numTimesReadIteratorsReused() { return iteratorsReuseCount; }
 
+	uint64_t numReadaheadIteratorsUsed() { return readaheadIteratorsUsed; }
+
+	uint64_t numSequentialRangeReads() { return sequentialRangeReads; }
+
+	uint64_t numRangeReadBytes() { return rangeReadBytes; }
+
+	uint64_t numRangeReadMicros() { return rangeReadMicros; }
+
 	FutureStream<Void> getDeleteIteratorsFutureStream() { return deleteIteratorsPromise.getFuture(); }
 
 private:
@@ -657,6 +796,22 @@ private:
 	uint64_t deletedUptoIndex;
 	uint64_t iteratorsReuseCount;
 	ThreadReturnPromiseStream<Void> deleteIteratorsPromise;
+	// Where recent forward range reads which stopped at their limit would continue, oldest first.
+	std::deque<Key> resumeKeys;
+	std::atomic<uint64_t> readaheadIteratorsUsed = 0;
+	std::atomic<uint64_t> sequentialRangeReads = 0;
+	std::atomic<uint64_t> rangeReadBytes = 0;
+	std::atomic<uint64_t> rangeReadMicros = 0;
+};
+
+// Perf context fields that the RocksDB C API has no metric number for, numbered below the ones it has
+enum ExtraPerfContextMetric {
+	perfcontext_block_cache_index_hit_count = -1,
+	perfcontext_index_block_read_count = -2,
+	perfcontext_block_cache_filter_hit_count = -3,
+	perfcontext_filter_block_read_count = -4,
+	perfcontext_get_cpu_nanos = -5,
+	perfcontext_secondary_cache_hit_count = -6,
 };
 
 class PerfContextMetrics {
@@ -741,6 +896,12 @@ PerfContextMetrics::PerfContextMetrics() {
 		{ "EnvLockFileNanos", rocksdb_env_lock_file_nanos, {} },
 		{ "EnvUnlockFileNanos", rocksdb_env_unlock_file_nanos, {} },
 		{ "EnvNewLoggerNanos", rocksdb_env_new_logger_nanos, {} },
+		{ "BlockCacheIndexHitCount", perfcontext_block_cache_index_hit_count, {} },
+		{ "IndexBlockReadCount", perfcontext_index_block_read_count, {} },
+		{ "BlockCacheFilterHitCount", perfcontext_block_cache_filter_hit_count, {} },
+		{ "FilterBlockReadCount", perfcontext_filter_block_read_count, {} },
+		{ "GetCpuNanos", perfcontext_get_cpu_nanos, {} },
+		{ "SecondaryCacheHitCount", perfcontext_secondary_cache_hit_count, {} },
 	};
 	for (auto& [name, metric, vals] : metrics) { // readers, then writer
 		for (int i = 0; i < SERVER_KNOBS->ROCKSDB_READ_PARALLELISM; i++) {
@@ -918,6 +1079,18 @@ uint64_t PerfContextMetrics::getRocksdbPerfcontextMetric(int metric) {
 		return rocksdb::get_perf_context()->env_unlock_file_nanos;
 	case rocksdb_env_new_logger_nanos:
 		return rocksdb::get_perf_context()->env_new_logger_nanos;
+	case perfcontext_block_cache_index_hit_count:
+		return rocksdb::get_perf_context()->block_cache_index_hit_count;
+	case perfcontext_index_block_read_count:
+		return rocksdb::get_perf_context()->index_block_read_count;
+	case perfcontext_block_cache_filter_hit_count:
+		return rocksdb::get_perf_context()->block_cache_filter_hit_count;
+	case perfcontext_filter_block_read_count:
+		return rocksdb::get_perf_context()->filter_block_read_count;
+	case perfcontext_get_cpu_nanos:
+		return rocksdb::get_perf_context()->get_cpu_nanos;
+	case perfcontext_secondary_cache_hit_count:
+		return rocksdb::get_perf_context()->secondary_cache_hit_count;
 	default:
 		break;
 	}
@@ -980,6 +1153,9 @@ ACTOR Future<Void> rocksDBMetricLogger(UID id,
 		{ "BlockCacheDataHits", rocksdb::BLOCK_CACHE_DATA_HIT, 0 },
 		{ "BlockCacheBytesRead", rocksdb::BLOCK_CACHE_BYTES_READ, 0 },
 		{ "BlockCacheBytesWrite", rocksdb::BLOCK_CACHE_BYTES_WRITE, 0 },
+		{ "SecondaryCacheHits", rocksdb::SECONDARY_CACHE_HITS, 0 },
+		{ "CompressedSecondaryCacheHits", rocksdb::COMPRESSED_SECONDARY_CACHE_HITS, 0 },
+		{ "CompressedSecondaryCachePromotions", rocksdb::COMPRESSED_SECONDARY_CACHE_PROMOTIONS, 0 },
 		{ "BloomFilterUseful", rocksdb::BLOOM_FILTER_USEFUL, 0 },
 		{ "BloomFilterFullPositive", rocksdb::BLOOM_FILTER_FULL_POSITIVE, 0 },
 		{ "BloomFilterTruePositive", rocksdb::BLOOM_FILTER_FULL_TRUE_POSITIVE, 0 },
@@ -1076,6 +1252,10 @@ ACTOR Future<Void> rocksDBMetricLogger(UID id,
 	state std::unordered_map<std::string, uint64_t> readIteratorPoolStats = {
 		{ "NumReadIteratorsCreated", 0 },
 		{ "NumTimesReadIteratorsReused", 0 },
+		{ "NumReadaheadIteratorsUsed", 0 },
+		{ "NumSequentialRangeReads", 0 },
+		{ "RangeReadBytes", 0 },
+		{ "RangeReadMicros", 0 },
 	};
 
 	state std::string rocksdbMetricsTrackingKey = id.toString() + "/RocksDBMetrics";
@@ -1141,6 +1321,25 @@ ACTOR Future<Void> rocksDBMetricLogger(UID id,
 		e.detail("NumTimesReadIteratorsReused", stat - readIteratorPoolStats["NumTimesReadIteratorsReused"]);
 		readIteratorPoolStats["NumTimesReadIteratorsReused"] = stat;
 
+		stat = readIterPool->numReadaheadIteratorsUsed();
+		e.detail("NumReadaheadIteratorsUsed", stat - readIteratorPoolStats["NumReadaheadIteratorsUsed"]);
+		readIteratorPoolStats["NumReadaheadIteratorsUsed"] = stat;
+
+		stat = readIterPool->numSequentialRangeReads();
+		e.detail("NumSequentialRangeReads", stat - readIteratorPoolStats["NumSequentialRangeReads"]);
+		readIteratorPoolStats["NumSequentialRangeReads"] = stat;
+
+		// Scan throughput is the rate at which range reads return bytes while they run, regardless of how many
+		// run at once or how long they waited in the queue.
+		stat = readIterPool->numRangeReadBytes();
+		uint64_t rangeReadBytes = stat - readIteratorPoolStats["RangeReadBytes"];
+		e.detail("RangeReadBytes", rangeReadBytes);
+		readIteratorPoolStats["RangeReadBytes"] = stat;
+		stat = readIterPool->numRangeReadMicros();
+		uint64_t rangeReadMicros = stat - readIteratorPoolStats["RangeReadMicros"];
+		e.detail("RangeReadBytesPerSecond", rangeReadMicros > 0 ? rangeReadBytes * 1e6 / rangeReadMicros : 0);
+		readIteratorPoolStats["RangeReadMicros"] = stat;
+
 		counters->cc.logToTraceEvent(e);
 
 		if (SERVER_KNOBS->ROCKSDB_PERFCONTEXT_ENABLE) {
@@ -1291,6 +1490,13 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 				}
 			}
 
+			// Files of ranges not ingested before a crash
+			for (const std::string& file : platform::listFiles(a.path, ".sst")) {
+				if (file.rfind(fetchIngestFilePrefix, 0) == 0) {
+					deleteFile(joinPath(a.path, file));
+				}
+			}
+
 			TraceEvent(SevInfo, "RocksDB", id)
 			    .detail("Path", a.path)
 			    .detail("Method", "Open")
@@ -1332,7 +1538,7 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 			rocksdb::Status DeleteRangeCF(uint32_t /*column_family_id*/,
 			                              const rocksdb::Slice& begin,
 			                              const rocksdb::Slice& end) override {
-				KeyRangeRef kr(toStringRef(begin), toStringRef(end));
+				KeyRangeRef kr(toStringRef(withoutTimestamp(begin)), toStringRef(withoutTimestamp(end)));
 				deletes.push_back_deep(arena, kr);
 				return rocksdb::Status::OK();
 			}
@@ -1358,8 +1564,98 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 			}
 		};
 
+		// Rebuilds a write batch without the entries superseded by the ranges ingested before it is written.
+		struct SupersededWriteFilter : public rocksdb::WriteBatch::Handler {
+			rocksdb::WriteBatch& filtered;
+			rocksdb::ColumnFamilyHandle* cf;
+			const std::vector<IngestedRange>& ingests;
+			uint32_t position = 0;
+
+			SupersededWriteFilter(rocksdb::WriteBatch& filtered,
+			                      rocksdb::ColumnFamilyHandle* cf,
+			                      const std::vector<IngestedRange>& ingests)
+			  : filtered(filtered), cf(cf), ingests(ingests) {}
+
+			bool superseded(const rocksdb::Slice& key) const {
+				for (const auto& ingest : ingests) {
+					if (ingest.batchPosition > position && ingest.range.contains(toStringRef(key))) {
+						return true;
+					}
+				}
+				return false;
+			}
+
+			rocksdb::Status DeleteRangeCF(uint32_t /*column_family_id*/,
+			                              const rocksdb::Slice& begin,
+			                              const rocksdb::Slice& end) override {
+				// Only the parts of the cleared range outside of all later ingested ranges are still cleared.
+				std::vector<std::pair<rocksdb::Slice, rocksdb::Slice>> pieces = { { begin, end } };
+				for (const auto& ingest : ingests) {
+					if (ingest.batchPosition <= position) {
+						continue;
+					}
+					const rocksdb::Slice ingestBegin = toSlice(ingest.range.begin);
+					const rocksdb::Slice ingestEnd = toSlice(ingest.range.end);
+					std::vector<std::pair<rocksdb::Slice, rocksdb::Slice>> remaining;
+					for (const auto& [pieceBegin, pieceEnd] : pieces) {
+						if (pieceBegin.compare(ingestBegin) < 0) {
+							remaining.emplace_back(pieceBegin,
+							                       pieceEnd.compare(ingestBegin) < 0 ? pieceEnd : ingestBegin);
+						}
+						if (pieceEnd.compare(ingestEnd) > 0) {
+							remaining.emplace_back(pieceBegin.compare(ingestEnd) > 0 ? pieceBegin : ingestEnd,
+							                       pieceEnd);
+						}
+					}
+					pieces = std::move(remaining);
+				}
+				rocksdb::Status s;
+				for (const auto& [pieceBegin, pieceEnd] : pieces) {
+					if (s.ok() && pieceBegin.compare(pieceEnd) < 0) {
+						s = filtered.DeleteRange(cf, pieceBegin, pieceEnd);
+					}
+				}
+				++position;
+				return s;
+			}
+
+			rocksdb::Status PutCF(uint32_t /*column_family_id*/,
+			                      const rocksdb::Slice& key,
+			                      const rocksdb::Slice& value) override {
+				rocksdb::Status s = superseded(key) ? rocksdb::Status::OK() : filtered.Put(cf, key, value);
+				++position;
+				return s;
+			}
+
+			rocksdb::Status DeleteCF(uint32_t /*column_family_id*/, const rocksdb::Slice& key) override {
+				rocksdb::Status s = superseded(key) ? rocksdb::Status::OK() : filtered.Delete(cf, key);
+				++position;
+				return s;
+			}
+
+			rocksdb::Status SingleDeleteCF(uint32_t /*column_family_id*/, const rocksdb::Slice& key) override {
+				rocksdb::Status s = superseded(key) ? rocksdb::Status::OK() : filtered.SingleDelete(cf, key);
+				++position;
+				return s;
+			}
+
+			rocksdb::Status MergeCF(uint32_t /*column_family_id*/,
+			                        const rocksdb::Slice& key,
+			                        const rocksdb::Slice& value) override {
+				rocksdb::Status s = superseded(key) ? rocksdb::Status::OK() : filtered.Merge(cf, key, value);
+				++position;
+				return s;
+			}
+		};
+
 		struct CommitAction : TypedAction<Writer, CommitAction> {
 			std::unique_ptr<rocksdb::WriteBatch> batchToCommit;
+			// Ranges to ingest, in the order they were replaced, before batchToCommit is written
+			std::vector<IngestedRange> ingests;
+			// Prefix of the paths of the SST files written for ingests
+			std::string ingestFilePathPrefix;
+			// Timestamp to raise the oldest readable one of the database to after the write, if not empty
+			std::string fullHistoryTsLow;
 			ThreadReturnPromise<Void> done;
 			double startTime;
 			bool getHistograms;
@@ -1368,6 +1664,61 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 			  : startTime(timer_monotonic()),
 			    getHistograms(deterministicRandom()->random01() < SERVER_KNOBS->ROCKSDB_HISTOGRAMS_SAMPLE_RATE) {}
 		};
+		// Writes each range in a.ingests to an SST file and ingests it, then drops the writes superseded by them from
+		// a.batchToCommit. Ingested files are durable on their own, ahead of the batch, which is fine as fetched
+		// ranges don't become available until later commits.
+		rocksdb::Status ingestRanges(CommitAction& a) {
+			rocksdb::Status s;
+			for (int i = 0; i < a.ingests.size(); i++) {
+				const IngestedRange& ingest = a.ingests[i];
+				const std::string file = a.ingestFilePathPrefix + std::to_string(i) + ".sst";
+				rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), sharedState->getOptions(), cf);
+				s = writer.Open(file);
+				// The range deletion clears what the range held before, but not the keys written with it to the file.
+				if (s.ok()) {
+					s = writer.DeleteRange(toSlice(ingest.range.begin), toSlice(ingest.range.end));
+				}
+				for (const KeyValueRef& kv : ingest.data) {
+					if (!s.ok()) {
+						break;
+					}
+					s = writer.Put(toSlice(kv.key), toSlice(kv.value));
+				}
+				if (s.ok()) {
+					s = writer.Finish();
+				}
+				if (s.ok()) {
+					rocksdb::IngestExternalFileOptions ingestOptions;
+					ingestOptions.move_files = true;
+					s = db->IngestExternalFile(cf, { file }, ingestOptions);
+				}
+				if (!s.ok()) {
+					if (fileExists(file)) {
+						deleteFile(file);
+					}
+					return s;
+				}
+			}
+
+			bool anySuperseded = false;
+			for (const auto& ingest : a.ingests) {
+				anySuperseded = anySuperseded || ingest.batchPosition > 0;
+			}
+			if (anySuperseded) {
+				auto filtered = std::make_unique<rocksdb::WriteBatch>(
+				    0, // reserved_bytes default:0
+				    0, // max_bytes default:0
+				    SERVER_KNOBS->ROCKSDB_WRITEBATCH_PROTECTION_BYTES_PER_KEY, // protection_bytes_per_key
+				    0 /* default_cf_ts_sz default:0 */);
+				SupersededWriteFilter filter(*filtered, cf, a.ingests);
+				s = a.batchToCommit->Iterate(&filter);
+				if (s.ok()) {
+					a.batchToCommit = std::move(filtered);
+				}
+			}
+			return s;
+		}
+
 		void action(CommitAction& a) {
 			bool doPerfContextMetrics =
 			    SERVER_KNOBS->ROCKSDB_PERFCONTEXT_ENABLE &&
@@ -1380,6 +1731,14 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 				metricPromiseStream->send(
 				    std::make_pair(ROCKSDB_COMMIT_QUEUEWAIT_HISTOGRAM.toString(), commitBeginTime - a.startTime));
 			}
+			if (!a.ingests.empty()) {
+				rocksdb::Status s = ingestRanges(a);
+				if (!s.ok()) {
+					logRocksDBError(id, s, "IngestFetchedRanges");
+					a.done.sendError(statusToError(s));
+					return;
+				}
+			}
 			Standalone<VectorRef<KeyRangeRef>> deletes;
 			if (SERVER_KNOBS->ROCKSDB_SUGGEST_COMPACT_CLEAR_RANGE) {
 				DeleteVisitor dv(deletes, deletes.arena());
@@ -1411,6 +1770,14 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 			} else {
 				a.done.send(Void());
 
+				if (!a.fullHistoryTsLow.empty()) {
+					// Compactions may then drop the versions of keys only older timestamps can see
+					s = db->IncreaseFullHistoryTsLow(cf, a.fullHistoryTsLow);
+					if (!s.ok()) {
+						logRocksDBError(id, s, "IncreaseFullHistoryTsLow", SevWarn);
+					}
+				}
+
 				if (SERVER_KNOBS->ROCKSDB_SUGGEST_COMPACT_CLEAR_RANGE) {
 					double compactRangeBeginTime = a.getHistograms ? timer_monotonic() : 0;
 					for (const auto& keyRange : deletes) {
@@ -1542,6 +1909,8 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 			Optional<UID> debugID;
 			double startTime;
 			bool getHistograms;
+			std::shared_ptr<const rocksdb::Snapshot> snapshot; // to read, or null for the latest commit
+			Version version = invalidVersion; // to read at with ROCKSDB_USER_DEFINED_TIMESTAMPS, if not the latest
 			ThreadReturnPromise<Optional<Value>> result;
 			ReadValueAction(KeyRef key, ReadType type, Optional<UID> debugID)
 			  : key(key), type(type), debugID(debugID), startTime(timer_monotonic()),
@@ -1578,6 +1947,14 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 
 			rocksdb::PinnableSlice value;
 			rocksdb::ReadOptions readOptions = sharedState->getReadOptions();
+			readOptions.snapshot = a.snapshot.get();
+			std::string timestamp;
+			rocksdb::Slice timestampSlice;
+			if (a.version != invalidVersion) {
+				timestamp = versionTimestamp(a.version);
+				timestampSlice = timestamp;
+				readOptions.timestamp = &timestampSlice;
+			}
 			if (shouldThrottle(a.type, a.key) && SERVER_KNOBS->ROCKSDB_SET_READ_TIMEOUT) {
 				uint64_t deadlineMircos =
 				    db->GetEnv()->NowMicros() + (readValueTimeout - (readBeginTime - a.startTime)) * 1000000;
@@ -1587,6 +1964,11 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 
 			double dbGetBeginTime = a.getHistograms ? timer_monotonic() : 0;
 			auto s = db->Get(readOptions, cf, toSlice(a.key), &value);
+			if (a.version != invalidVersion && s.IsInvalidArgument()) {
+				// The history of the version was already discarded
+				a.result.sendError(transaction_too_old());
+				return;
+			}
 			if (!s.ok() && !s.IsNotFound()) {
 				logRocksDBError(id, s, "ReadValue");
 				a.result.sendError(statusToError(s));
@@ -1708,12 +2090,161 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 			}
 		}
 
+		// Reads the prefixes of many values with one MultiGet
+		struct ReadValuePrefixesAction : TypedAction<Reader, ReadValuePrefixesAction> {
+			Arena arena;
+			std::vector<rocksdb::Slice> keys;
+			std::vector<int> maxLengths;
+			ThreadReturnPromise<std::vector<Optional<Value>>> result;
+			explicit ReadValuePrefixesAction(std::vector<std::pair<KeyRef, int>> const& keyPrefixes) {
+				keys.reserve(keyPrefixes.size());
+				maxLengths.reserve(keyPrefixes.size());
+				for (auto const& [key, maxLength] : keyPrefixes) {
+					keys.push_back(toSlice(StringRef(arena, key)));
+					maxLengths.push_back(maxLength);
+				}
+			}
+			double getTimeEstimate() const override { return SERVER_KNOBS->READ_VALUE_TIME_ESTIMATE * keys.size(); }
+		};
+		void action(ReadValuePrefixesAction& a) {
+			bool doPerfContextMetrics =
+			    SERVER_KNOBS->ROCKSDB_PERFCONTEXT_ENABLE &&
+			    (deterministicRandom()->random01() < SERVER_KNOBS->ROCKSDB_PERFCONTEXT_SAMPLE_RATE);
+			if (doPerfContextMetrics) {
+				perfContextMetrics->reset();
+			}
+
+			std::vector<rocksdb::PinnableSlice> values(a.keys.size());
+			std::vector<rocksdb::Status> statuses(a.keys.size());
+			db->MultiGet(
+			    sharedState->getReadOptions(), cf, a.keys.size(), a.keys.data(), values.data(), statuses.data());
+
+			std::vector<Optional<Value>> results(a.keys.size());
+			for (int i = 0; i < a.keys.size(); i++) {
+				if (statuses[i].ok()) {
+					results[i] = Value(StringRef(reinterpret_cast<const uint8_t*>(values[i].data()),
+					                             std::min(values[i].size(), size_t(a.maxLengths[i]))));
+				} else if (!statuses[i].IsNotFound()) {
+					logRocksDBError(id, statuses[i], "ReadValuePrefixes");
+					a.result.sendError(statusToError(statuses[i]));
+					return;
+				}
+			}
+			a.result.send(std::move(results));
+			if (doPerfContextMetrics) {
+				perfContextMetrics->set(threadIndex);
+			}
+		}
+
+		// Point reads queued on the network thread during the same run loop task, looked up with one MultiGet
+		struct ReadValueBatchAction : TypedAction<Reader, ReadValueBatchAction> {
+			struct Read {
+				Key key;
+				int maxLength;
+				ReadType type;
+				double startTime;
+				ThreadReturnPromise<Optional<Value>> result;
+				Read(KeyRef key, int maxLength, ReadType type, double startTime)
+				  : key(key), maxLength(maxLength), type(type), startTime(startTime) {}
+			};
+			// A deque because the promises can't be moved
+			std::deque<Read> reads;
+			bool getHistograms;
+			ReadValueBatchAction()
+			  : getHistograms(deterministicRandom()->random01() < SERVER_KNOBS->ROCKSDB_HISTOGRAMS_SAMPLE_RATE) {}
+			double getTimeEstimate() const override { return SERVER_KNOBS->READ_VALUE_TIME_ESTIMATE * reads.size(); }
+		};
+		void action(ReadValueBatchAction& a) {
+			ASSERT(cf != nullptr);
+			bool doPerfContextMetrics =
+			    SERVER_KNOBS->ROCKSDB_PERFCONTEXT_ENABLE &&
+			    (deterministicRandom()->random01() < SERVER_KNOBS->ROCKSDB_PERFCONTEXT_SAMPLE_RATE);
+			if (doPerfContextMetrics) {
+				perfContextMetrics->reset();
+			}
+			const double readBeginTime = timer_monotonic();
+
+			// Reads that may be throttled fail if they have already waited too long, and the rest must finish by the
+			// earliest of their deadlines
+			std::vector<Read*> reads;
+			std::vector<rocksdb::Slice> keys;
+			double oldestStartTime = readBeginTime;
+			Optional<double> deadline;
+			for (auto& r : a.reads) {
+				oldestStartTime = std::min(oldestStartTime, r.startTime);
+				if (shouldThrottle(r.type, r.key) && SERVER_KNOBS->ROCKSDB_SET_READ_TIMEOUT) {
+					double timeout =
+					    r.maxLength == std::numeric_limits<int>::max() ? readValueTimeout : readValuePrefixTimeout;
+					if (readBeginTime - r.startTime > timeout) {
+						TraceEvent(SevWarn, "KVSTimeout", id)
+						    .detail("Error", "Read value request timedout")
+						    .detail("Method", "ReadValueBatchAction")
+						    .detail("TimeoutValue", timeout);
+						r.result.sendError(transaction_too_old());
+						continue;
+					}
+					double end = r.startTime + timeout;
+					deadline = deadline.present() ? std::min(deadline.get(), end) : end;
+				}
+				reads.push_back(&r);
+				keys.push_back(toSlice(r.key));
+			}
+			if (a.getHistograms) {
+				metricPromiseStream->send(
+				    std::make_pair(ROCKSDB_READVALUE_QUEUEWAIT_HISTOGRAM.toString(), readBeginTime - oldestStartTime));
+			}
+			if (reads.empty()) {
+				return;
+			}
+
+			rocksdb::ReadOptions readOptions = sharedState->getReadOptions();
+			if (deadline.present()) {
+				uint64_t deadlineMircos = db->GetEnv()->NowMicros() + (deadline.get() - readBeginTime) * 1000000;
+				std::chrono::seconds deadlineSeconds(deadlineMircos / 1000000);
+				readOptions.deadline = std::chrono::duration_cast<std::chrono::microseconds>(deadlineSeconds);
+			}
+
+			double dbGetBeginTime = a.getHistograms ? timer_monotonic() : 0;
+			std::vector<rocksdb::PinnableSlice> values(keys.size());
+			std::vector<rocksdb::Status> statuses(keys.size());
+			db->MultiGet(readOptions, cf, keys.size(), keys.data(), values.data(), statuses.data());
+			if (a.getHistograms) {
+				metricPromiseStream->send(
+				    std::make_pair(ROCKSDB_READVALUE_GET_HISTOGRAM.toString(), timer_monotonic() - dbGetBeginTime));
+			}
+
+			for (int i = 0; i < reads.size(); i++) {
+				if (statuses[i].ok()) {
+					reads[i]->result.send(Value(StringRef(reinterpret_cast<const uint8_t*>(values[i].data()),
+					                                      std::min(values[i].size(), size_t(reads[i]->maxLength)))));
+				} else if (statuses[i].IsNotFound()) {
+					reads[i]->result.send(Optional<Value>());
+				} else {
+					logRocksDBError(id, statuses[i], "ReadValueBatch");
+					reads[i]->result.sendError(statusToError(statuses[i]));
+				}
+			}
+
+			const double endTime = timer_monotonic();
+			if (a.getHistograms) {
+				metricPromiseStream->send(
+				    std::make_pair(ROCKSDB_READVALUE_ACTION_HISTOGRAM.toString(), endTime - readBeginTime));
+				metricPromiseStream->send(
+				    std::make_pair(ROCKSDB_READVALUE_LATENCY_HISTOGRAM.toString(), endTime - oldestStartTime));
+			}
+			if (doPerfContextMetrics) {
+				perfContextMetrics->set(threadIndex);
+			}
+		}
+
 		struct ReadRangeAction : TypedAction<Reader, ReadRangeAction>, FastAllocated<ReadRangeAction> {
 			KeyRange keys;
 			int rowLimit, byteLimit;
 			ReadType type;
 			double startTime;
 			bool getHistograms;
+			std::shared_ptr<const rocksdb::Snapshot> snapshot; // to read, or null for the latest commit
+			Version version = invalidVersion; // to read at with ROCKSDB_USER_DEFINED_TIMESTAMPS, if not the latest
 			ThreadReturnPromise<RangeResult> result;
 			Counters& counters;
 			ReadRangeAction(KeyRange keys, int rowLimit, int byteLimit, ReadType type, Counters& counters)
@@ -1751,9 +2282,13 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 			}
 			int accumulatedBytes = 0;
 			rocksdb::Status s;
+			const bool pooled = !a.snapshot && a.version == invalidVersion;
 			if (a.rowLimit >= 0) {
 				double iterCreationBeginTime = a.getHistograms ? timer_monotonic() : 0;
-				ReadIterator readIter = readIterPool->getIterator(a.keys);
+				// Iterators of snapshots and old versions aren't pooled, as they are rarely reused
+				ReadIterator readIter =
+				    pooled ? readIterPool->getIterator(a.keys, readIterPool->getReadaheadSize(a.keys, a.byteLimit))
+				           : ReadIterator(cf, 0, db, sharedState, a.keys, 0, a.snapshot.get(), a.version);
 				if (a.getHistograms) {
 					metricPromiseStream->send(std::make_pair(ROCKSDB_READRANGE_NEWITERATOR_HISTOGRAM.toString(),
 					                                         timer_monotonic() - iterCreationBeginTime));
@@ -1780,10 +2315,14 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 					cursor->Next();
 				}
 				s = cursor->status();
-				readIterPool->returnIterator(readIter);
+				if (pooled) {
+					readIterPool->returnIterator(readIter);
+				}
 			} else {
 				double iterCreationBeginTime = a.getHistograms ? timer_monotonic() : 0;
-				ReadIterator readIter = readIterPool->getIterator(a.keys);
+				ReadIterator readIter =
+				    pooled ? readIterPool->getIterator(a.keys)
+				           : ReadIterator(cf, 0, db, sharedState, a.keys, 0, a.snapshot.get(), a.version);
 				if (a.getHistograms) {
 					metricPromiseStream->send(std::make_pair(ROCKSDB_READRANGE_NEWITERATOR_HISTOGRAM.toString(),
 					                                         timer_monotonic() - iterCreationBeginTime));
@@ -1813,9 +2352,15 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 					cursor->Prev();
 				}
 				s = cursor->status();
-				readIterPool->returnIterator(readIter);
+				if (pooled) {
+					readIterPool->returnIterator(readIter);
+				}
 			}
 
+			if (a.version != invalidVersion && s.IsInvalidArgument()) {
+				a.result.sendError(transaction_too_old());
+				return;
+			}
 			if (!s.ok()) {
 				logRocksDBError(id, s, "ReadRange");
 				a.result.sendError(statusToError(s));
@@ -1823,6 +2368,11 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 			}
 			result.more =
 			    (result.size() == a.rowLimit) || (result.size() == -a.rowLimit) || (accumulatedBytes >= a.byteLimit);
+			Optional<Key> resumeKey;
+			if (result.more && a.rowLimit > 0 && !result.empty()) {
+				resumeKey = keyAfter(result.back().key);
+			}
+			readIterPool->recordRangeRead(accumulatedBytes, timer_monotonic() - readBeginTime, resumeKey);
 			a.result.send(result);
 			if (a.getHistograms) {
 				metricPromiseStream->send(
@@ -1867,7 +2417,10 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 			readThreads = CoroThreadPool::createThreadPool();
 		} else {
 			writeThread = createGenericThreadPool(/*stackSize=*/0, SERVER_KNOBS->ROCKSDB_WRITER_THREAD_PRIORITY);
-			readThreads = createGenericThreadPool(/*stackSize=*/0, SERVER_KNOBS->ROCKSDB_READER_THREAD_PRIORITY);
+			const int readerPriority = SERVER_KNOBS->ROCKSDB_READER_THREAD_PRIORITY;
+			readThreads = SERVER_KNOBS->ROCKSDB_WORK_STEALING_READ_THREADS
+			                  ? createWorkStealingThreadPool(/*stackSize=*/0, readerPriority)
+			                  : createGenericThreadPool(/*stackSize=*/0, readerPriority);
 		}
 		if (SERVER_KNOBS->ROCKSDB_HISTOGRAMS_SAMPLE_RATE > 0) {
 			collection = actorCollection(addActor.getFuture());
@@ -2016,8 +2569,11 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 		// The metrics future retains a reference to the DB, so stop it before we delete it.
 		self->metrics.reset();
 
+		self->pendingReadsPosted = Void();
+		self->postPendingReadsNow();
 		wait(self->readThreads->stop());
 		self->readIterPool.reset();
+		self->snapshots.clear();
 		auto a = new Writer::CloseAction(self->path, deleteOnClose);
 		auto f = a->done.getFuture();
 		self->writeThread->post(a);
@@ -2069,7 +2625,7 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 			maxDeletes = SERVER_KNOBS->ROCKSDB_SINGLEKEY_DELETES_MAX;
 		}
 		ASSERT(defaultFdbCF != nullptr);
-		writeBatch->Put(defaultFdbCF, toSlice(kv.key), toSlice(kv.value));
+		batchPut(toSlice(kv.key), toSlice(kv.value));
 		if (SERVER_KNOBS->ROCKSDB_SINGLEKEY_DELETES_ON_CLEARRANGE) {
 			keysSet.insert(kv.key);
 		}
@@ -2090,13 +2646,14 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 		// Number of deletes to rocksdb = counters.deleteKeyReqs + convertedDeleteKeyReqs;
 		// Number of deleteRanges to rocksdb = counters.deleteRangeReqs - counters.convertedDeleteRangeReqs;
 		if (keyRange.singleKeyRange() && !SERVER_KNOBS->ROCKSDB_FORCE_DELETERANGE_FOR_CLEARRANGE) {
-			writeBatch->Delete(defaultFdbCF, toSlice(keyRange.begin));
+			batchDelete(toSlice(keyRange.begin));
 			++counters.deleteKeyReqs;
 			--maxDeletes;
 		} else {
 			++counters.deleteRangeReqs;
 			if (SERVER_KNOBS->ROCKSDB_SINGLEKEY_DELETES_ON_CLEARRANGE &&
-			    !SERVER_KNOBS->ROCKSDB_FORCE_DELETERANGE_FOR_CLEARRANGE && maxDeletes > 0) {
+			    !SERVER_KNOBS->ROCKSDB_FORCE_DELETERANGE_FOR_CLEARRANGE && maxDeletes > 0 &&
+			    !overlapsIngestedRange(keyRange)) {
 				++counters.convertedDeleteRangeReqs;
 				rocksdb::ReadOptions readOptions = sharedState->getReadOptions();
 				auto beginSlice = toSlice(keyRange.begin);
@@ -2106,34 +2663,97 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 				auto cursor = std::unique_ptr<rocksdb::Iterator>(db->NewIterator(readOptions, defaultFdbCF));
 				cursor->Seek(toSlice(keyRange.begin));
 				while (cursor->Valid() && toStringRef(cursor->key()) < keyRange.end && maxDeletes > 0) {
-					writeBatch->Delete(defaultFdbCF, cursor->key());
+					batchDelete(cursor->key());
 					++counters.convertedDeleteKeyReqs;
 					--maxDeletes;
 					cursor->Next();
 				}
 				if (!cursor->status().ok() || maxDeletes <= 0) {
 					// if readrange iteration fails, then do a deleteRange.
-					writeBatch->DeleteRange(defaultFdbCF, toSlice(keyRange.begin), toSlice(keyRange.end));
+					batchDeleteRange(toSlice(keyRange.begin), toSlice(keyRange.end));
 				} else {
 					auto it = keysSet.lower_bound(keyRange.begin);
 					while (it != keysSet.end() && *it < keyRange.end) {
-						writeBatch->Delete(defaultFdbCF, toSlice(*it));
+						batchDelete(toSlice(*it));
 						++counters.convertedDeleteKeyReqs;
 						--maxDeletes;
 						it++;
 					}
 					it = previousCommitKeysSet.lower_bound(keyRange.begin);
 					while (it != previousCommitKeysSet.end() && *it < keyRange.end) {
-						writeBatch->Delete(defaultFdbCF, toSlice(*it));
+						batchDelete(toSlice(*it));
 						++counters.convertedDeleteKeyReqs;
 						--maxDeletes;
 						it++;
 					}
 				}
 			} else {
-				writeBatch->DeleteRange(defaultFdbCF, toSlice(keyRange.begin), toSlice(keyRange.end));
+				batchDeleteRange(toSlice(keyRange.begin), toSlice(keyRange.end));
+			}
+		}
+	}
+
+	// The writes of set() and clear(), tagged with the write version if the store keeps versions
+	void batchPut(const rocksdb::Slice& key, const rocksdb::Slice& value) {
+		if (keepsVersions()) {
+			writeBatch->Put(defaultFdbCF, key, writeTimestamp, value);
+		} else {
+			writeBatch->Put(defaultFdbCF, key, value);
+		}
+	}
+	void batchDelete(const rocksdb::Slice& key) {
+		if (keepsVersions()) {
+			writeBatch->Delete(defaultFdbCF, key, writeTimestamp);
+		} else {
+			writeBatch->Delete(defaultFdbCF, key);
+		}
+	}
+	void batchDeleteRange(const rocksdb::Slice& begin, const rocksdb::Slice& end) {
+		if (keepsVersions()) {
+			writeBatch->DeleteRange(defaultFdbCF, begin, end, writeTimestamp);
+		} else {
+			writeBatch->DeleteRange(defaultFdbCF, begin, end);
+		}
+	}
+
+	// Large blocks of fetched data are written as SST files ingested into the bottommost level they fit in, skipping
+	// the memtable, the WAL and the compactions which would otherwise rewrite them several times.
+	Future<Void> replaceRange(KeyRange range, Standalone<VectorRef<KeyValueRef>> data) override {
+		// Ingested files aren't tagged with versions
+		if (!SERVER_KNOBS->ROCKSDB_FETCH_INGEST_SST || keepsVersions() || range.empty() ||
+		    data.expectedSize() < SERVER_KNOBS->ROCKSDB_FETCH_INGEST_SST_MIN_BYTES) {
+			return IKeyValueStore::replaceRange(range, data);
+		}
+		++counters.fetchIngestedRanges;
+		counters.fetchIngestedBytes += data.expectedSize();
+		const uint32_t batchPosition = writeBatch == nullptr ? 0 : writeBatch->Count();
+		// A range continuing the last one with nothing written in between goes into the same file.
+		if (!pendingIngests.empty() && pendingIngests.back().range.end == range.begin &&
+		    pendingIngests.back().batchPosition == batchPosition) {
+			IngestedRange& last = pendingIngests.back();
+			last.range = KeyRangeRef(last.range.begin, range.end);
+			last.data.append(last.data.arena(), data.begin(), data.size());
+			last.data.arena().dependsOn(data.arena());
+		} else {
+			pendingIngests.push_back(IngestedRange{ range, data, batchPosition });
+		}
+		return Void();
+	}
+
+	// Returns whether keyRange overlaps a range ingested by the pending or the in-flight commit. Clears of such ranges
+	// can't be turned into single key deletes, as neither the database nor keysSet have the ingested keys yet.
+	bool overlapsIngestedRange(KeyRangeRef keyRange) const {
+		for (const auto& ingest : pendingIngests) {
+			if (ingest.range.intersects(keyRange)) {
+				return true;
+			}
+		}
+		for (const auto& range : previousCommitIngestedRanges) {
+			if (range.intersects(keyRange)) {
+				return true;
 			}
 		}
+		return false;
 	}
 
 	// Checks and waits for few seconds if rocskdb is overloaded.
@@ -2163,22 +2783,52 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 
 	ACTOR Future<Void> commitInRocksDB(RocksDBKeyValueStore* self) {
 		// If there is nothing to write, don't write.
-		if (self->writeBatch == nullptr) {
+		if (self->writeBatch == nullptr && self->pendingIngests.empty()) {
 			return Void();
 		}
 		auto a = new Writer::CommitAction();
-		a->batchToCommit = std::move(self->writeBatch);
+		a->batchToCommit = self->writeBatch != nullptr ? std::move(self->writeBatch)
+		                                               : std::make_unique<rocksdb::WriteBatch>();
 		self->previousCommitKeysSet = std::move(self->keysSet);
 		self->maxDeletes = SERVER_KNOBS->ROCKSDB_SINGLEKEY_DELETES_MAX;
+		self->previousCommitIngestedRanges.clear();
+		for (const auto& ingest : self->pendingIngests) {
+			self->previousCommitIngestedRanges.push_back(ingest.range);
+		}
+		a->ingests = std::move(self->pendingIngests);
+		self->pendingIngests.clear();
+		a->ingestFilePathPrefix =
+		    joinPath(self->path, fetchIngestFilePrefix + std::to_string(++self->ingestCommits) + "-");
+		// Raising the database's oldest readable timestamp writes its manifest, so it is raised about once a second
+		if (self->oldestReadableVersion >= self->historyLowVersion + SERVER_KNOBS->VERSIONS_PER_SECOND) {
+			self->historyLowVersion = self->oldestReadableVersion;
+			a->fullHistoryTsLow = versionTimestamp(self->historyLowVersion);
+		}
 		state Future<Void> fut = a->done.getFuture();
 		self->writeThread->post(a);
 		wait(fut);
 		self->previousCommitKeysSet.clear();
+		self->previousCommitIngestedRanges.clear();
 		return Void();
 	}
 
 	Future<Void> commit(bool) override { return commitInRocksDB(this); }
 
+	bool keepsVersions() const override { return SERVER_KNOBS->ROCKSDB_USER_DEFINED_TIMESTAMPS; }
+
+	void setWriteVersion(Version version) override {
+		if (keepsVersions() && version > writeVersion) {
+			writeVersion = version;
+			writeTimestamp = versionTimestamp(version);
+		}
+	}
+
+	void setOldestReadableVersion(Version version) override {
+		if (keepsVersions()) {
+			oldestReadableVersion = std::max(oldestReadableVersion, version);
+		}
+	}
+
 	void checkWaiters(const FlowLock& semaphore, int maxWaiters) {
 		if (semaphore.waiters() > maxWaiters) {
 			++counters.immediateThrottle;
@@ -2192,6 +2842,17 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 		return type != ReadType::EAGER && !(key.startsWith(systemKeys.begin));
 	}
 
+	// Queues a point read to be coalesced with others, taking a slot first if it may be throttled
+	Future<Optional<Value>> readCoalesced(KeyRef key, int maxLength, ReadType type) {
+		if (!shouldThrottle(type, key)) {
+			return queueRead(key, maxLength, type, timer_monotonic());
+		}
+		auto& semaphore = (type == ReadType::FETCH) ? fetchSemaphore : readSemaphore;
+		int maxWaiters = (type == ReadType::FETCH) ? numFetchWaiters : numReadWaiters;
+		checkWaiters(semaphore, maxWaiters);
+		return readCoalescedThrottled(this, key, maxLength, type, &semaphore);
+	}
+
 	ACTOR template <class Action>
 	static Future<Optional<Value>> read(Action* action, FlowLock* semaphore, IThreadPool* pool, Counter* counter) {
 		state std::unique_ptr<Action> a(action);
@@ -2210,6 +2871,54 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 		return result;
 	}
 
+	// Adds a point read to the batch to be posted to the reader threads at the end of the current run loop task, or
+	// once it is full
+	Future<Optional<Value>> queueRead(KeyRef key, int maxLength, ReadType type, double startTime) {
+		if (!pendingReads) {
+			pendingReads = std::make_unique<Reader::ReadValueBatchAction>();
+			pendingReadsPosted = postPendingReads(this);
+		}
+		Future<Optional<Value>> result =
+		    pendingReads->reads.emplace_back(key, maxLength, type, startTime).result.getFuture();
+		if (pendingReads->reads.size() >= (size_t)SERVER_KNOBS->ROCKSDB_READ_VALUE_COALESCE_MAX_KEYS) {
+			pendingReadsPosted = Void();
+			postPendingReadsNow();
+		}
+		return result;
+	}
+
+	void postPendingReadsNow() {
+		if (pendingReads) {
+			++counters.coalescedReadBatches;
+			counters.coalescedReads += pendingReads->reads.size();
+			readThreads->post(pendingReads.release());
+		}
+	}
+
+	ACTOR static Future<Void> postPendingReads(RocksDBKeyValueStore* self) {
+		wait(delay(0));
+		self->postPendingReadsNow();
+		return Void();
+	}
+
+	// Like read(), but for a read that is coalesced with others once it has taken its slot
+	ACTOR static Future<Optional<Value>> readCoalescedThrottled(RocksDBKeyValueStore* self,
+	                                                            Key key,
+	                                                            int maxLength,
+	                                                            ReadType type,
+	                                                            FlowLock* semaphore) {
+		state double startTime = timer_monotonic();
+		state Optional<Void> slot = wait(timeout(semaphore->take(), SERVER_KNOBS->ROCKSDB_READ_QUEUE_WAIT));
+		if (!slot.present()) {
+			++self->counters.failedToAcquire;
+			throw server_overloaded();
+		}
+
+		state FlowLock::Releaser release(*semaphore);
+		Optional<Value> result = wait(self->queueRead(key, maxLength, type, startTime));
+		return result;
+	}
+
 	Future<Optional<Value>> readValue(KeyRef key, Optional<ReadOptions> options) override {
 		ReadType type = ReadType::NORMAL;
 		Optional<UID> debugID;
@@ -2219,6 +2928,11 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 			debugID = options.get().debugID;
 		}
 
+		// Reads being traced keep their own action so that the trace shows their time on the reader thread
+		if (SERVER_KNOBS->ROCKSDB_READ_VALUE_COALESCE && !debugID.present()) {
+			return readCoalesced(key, std::numeric_limits<int>::max(), type);
+		}
+
 		if (!shouldThrottle(type, key)) {
 			auto a = new Reader::ReadValueAction(key, type, debugID);
 			auto res = a->result.getFuture();
@@ -2243,6 +2957,10 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 			debugID = options.get().debugID;
 		}
 
+		if (SERVER_KNOBS->ROCKSDB_READ_VALUE_COALESCE && !debugID.present()) {
+			return readCoalesced(key, maxLength, type);
+		}
+
 		if (!shouldThrottle(type, key)) {
 			auto a = new Reader::ReadValuePrefixAction(key, maxLength, type, debugID);
 			auto res = a->result.getFuture();
@@ -2258,6 +2976,21 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 		return read(a.release(), &semaphore, readThreads.getPtr(), &counters.failedToAcquire);
 	}
 
+	Future<std::vector<Optional<Value>>> readValuePrefixes(std::vector<std::pair<KeyRef, int>> const& keys,
+	                                                       Optional<ReadOptions> options) override {
+		// Only reads that are never throttled, such as eager reads, are batched; the rest queue up key by key
+		ReadType type = options.present() ? options.get().type : ReadType::NORMAL;
+		if (keys.empty() || std::any_of(keys.begin(), keys.end(), [type](auto const& k) {
+			    return shouldThrottle(type, k.first);
+		    })) {
+			return IKeyValueStore::readValuePrefixes(keys, options);
+		}
+		auto a = new Reader::ReadValuePrefixesAction(keys);
+		auto res = a->result.getFuture();
+		readThreads->post(a);
+		return res;
+	}
+
 	ACTOR static Future<Standalone<RangeResultRef>> read(Reader::ReadRangeAction* action,
 	                                                     FlowLock* semaphore,
 	                                                     IThreadPool* pool,
@@ -2303,6 +3036,78 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 		return read(a.release(), &semaphore, readThreads.getPtr(), &counters.failedToAcquire);
 	}
 
+	// Snapshots are released once they are unpinned and the reads holding them are done
+	int64_t pinSnapshot() override {
+		DB snapshotDB = db;
+		snapshots[++lastSnapshot] = std::shared_ptr<const rocksdb::Snapshot>(
+		    db->GetSnapshot(), [snapshotDB](const rocksdb::Snapshot* s) { snapshotDB->ReleaseSnapshot(s); });
+		return lastSnapshot;
+	}
+
+	void unpinSnapshot(int64_t snapshot) override { ASSERT(snapshots.erase(snapshot) == 1); }
+
+	Future<Optional<Value>> readValueAtSnapshot(int64_t snapshot, KeyRef key, Optional<ReadOptions> options) override {
+		auto a = readValueOf(key, options);
+		a->snapshot = snapshots.at(snapshot);
+		return postRead(std::move(a), key);
+	}
+
+	Future<RangeResult> readRangeAtSnapshot(int64_t snapshot,
+	                                        KeyRangeRef keys,
+	                                        int rowLimit,
+	                                        int byteLimit,
+	                                        Optional<ReadOptions> options) override {
+		auto a = readRangeOf(keys, rowLimit, byteLimit, options);
+		a->snapshot = snapshots.at(snapshot);
+		return postRead(std::move(a), keys.begin);
+	}
+
+	Future<Optional<Value>> readValueAtVersion(Version version, KeyRef key, Optional<ReadOptions> options) override {
+		ASSERT(keepsVersions());
+		auto a = readValueOf(key, options);
+		a->version = version;
+		return postRead(std::move(a), key);
+	}
+
+	Future<RangeResult> readRangeAtVersion(Version version,
+	                                       KeyRangeRef keys,
+	                                       int rowLimit,
+	                                       int byteLimit,
+	                                       Optional<ReadOptions> options) override {
+		ASSERT(keepsVersions());
+		auto a = readRangeOf(keys, rowLimit, byteLimit, options);
+		a->version = version;
+		return postRead(std::move(a), keys.begin);
+	}
+
+	std::unique_ptr<Reader::ReadValueAction> readValueOf(KeyRef key, Optional<ReadOptions> options) {
+		ReadType type = options.present() ? options.get().type : ReadType::NORMAL;
+		Optional<UID> debugID = options.present() ? options.get().debugID : Optional<UID>();
+		return std::make_unique<Reader::ReadValueAction>(key, type, debugID);
+	}
+
+	std::unique_ptr<Reader::ReadRangeAction> readRangeOf(KeyRangeRef keys,
+	                                                     int rowLimit,
+	                                                     int byteLimit,
+	                                                     Optional<ReadOptions> options) {
+		ReadType type = options.present() ? options.get().type : ReadType::NORMAL;
+		return std::make_unique<Reader::ReadRangeAction>(keys, rowLimit, byteLimit, type, counters);
+	}
+
+	// Posts a read of a snapshot or of an old version, throttled like the reads of the latest commit
+	template <class Action>
+	auto postRead(std::unique_ptr<Action> a, KeyRef key) {
+		if (!shouldThrottle(a->type, key)) {
+			auto res = a->result.getFuture();
+			readThreads->post(a.release());
+			return res;
+		}
+
+		auto& semaphore = (a->type == ReadType::FETCH) ? fetchSemaphore : readSemaphore;
+		checkWaiters(semaphore, (a->type == ReadType::FETCH) ? numFetchWaiters : numReadWaiters);
+		return read(a.release(), &semaphore, readThreads.getPtr(), &counters.failedToAcquire);
+	}
+
 	StorageBytes getStorageBytes() const override {
 		uint64_t live = 0;
 		ASSERT(db->GetAggregatedIntProperty(rocksdb::DB::Properties::kLiveSstFilesSize, &live));
@@ -2359,6 +3164,15 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 	}
 
 	DB db = nullptr;
+	// The pinned snapshots, by id
+	std::map<int64_t, std::shared_ptr<const rocksdb::Snapshot>> snapshots;
+	int64_t lastSnapshot = 0;
+	// With ROCKSDB_USER_DEFINED_TIMESTAMPS, the version writes are tagged with, and the oldest one reads may still
+	// want, which the database's oldest readable timestamp lags behind
+	Version writeVersion = 0;
+	std::string writeTimestamp = versionTimestamp(0);
+	Version oldestReadableVersion = 0;
+	Version historyLowVersion = 0;
 	std::shared_ptr<SharedRocksDBState> sharedState;
 	std::shared_ptr<PerfContextMetrics> perfContextMetrics;
 	std::string path;
@@ -2378,6 +3192,10 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 	// maintain the previousCommitKeysSet until the rocksdb commit is processed and returned.
 	std::set<Key> keysSet;
 	std::set<Key> previousCommitKeysSet;
+	// Ranges replaced through SST ingestion by the pending commit, and those of the commit in the rocksdb commit path
+	std::vector<IngestedRange> pendingIngests;
+	std::vector<KeyRange> previousCommitIngestedRanges;
+	uint64_t ingestCommits = 0;
 	// maximum number of single key deletes in a commit, if ROCKSDB_SINGLEKEY_DELETES_ON_CLEARRANGE is enabled.
 	int maxDeletes;
 	Optional<Future<Void>> metrics;
@@ -2393,6 +3211,9 @@ struct RocksDBKeyValueStore : IKeyValueStore {
 	Future<Void> collection;
 	PromiseStream<Future<Void>> addActor;
 	Counters counters;
+	// Point reads to be looked up together, and the actor which posts them at the end of the run loop task
+	std::unique_ptr<Reader::ReadValueBatchAction> pendingReads;
+	Future<Void> pendingReadsPosted;
 };
 
 void RocksDBKeyValueStore::Writer::action(CheckpointAction& a) {
@@ -2797,6 +3618,106 @@ TEST_CASE("noSim/fdbserver/KeyValueStoreRocksDB/CheckpointRestoreKeyValues") {
 	return Void();
 }
 
+TEST_CASE("noSim/RocksDB/RangeReadahead") {
+	state const std::string rocksDBTestDir = "rocksdb-kvstore-readahead-test-db";
+	platform::eraseDirectoryRecursive(rocksDBTestDir);
+	IKnobCollection::getMutableGlobalKnobCollection().setKnob("rocksdb_read_range_readahead_min_bytes",
+	                                                          KnobValueRef::create(int64_t{ 4096 }));
+
+	state RocksDBKeyValueStore* kvStore =
+	    new RocksDBKeyValueStore(rocksDBTestDir, deterministicRandom()->randomUniqueID());
+	wait(kvStore->init());
+
+	state int i = 0;
+	for (; i < 1000; ++i) {
+		kvStore->set({ Key(format("key/%04d", i)), Value(std::string(100, 'v')) });
+	}
+	wait(kvStore->commit(false));
+
+	// Reading the range a page at a time continues each read where the last one stopped, so all but the first are
+	// sequential and read ahead whatever their byte limit.
+	state Key begin = "key/"_sr;
+	state int pages = 0;
+	i = 0;
+	loop {
+		RangeResult result = wait(kvStore->readRange(KeyRangeRef(begin, "key0"_sr), 1000, 1000));
+		for (const auto& kv : result) {
+			ASSERT(kv.key == Key(format("key/%04d", i++)));
+		}
+		++pages;
+		if (!result.more) {
+			break;
+		}
+		begin = keyAfter(result.back().key);
+	}
+	ASSERT(i == 1000);
+	ASSERT(kvStore->readIterPool->numSequentialRangeReads() == pages - 1);
+
+	// Readahead only applies to forward reads; reverse reads still see every key.
+	RangeResult result = wait(kvStore->readRange(KeyRangeRef("key/"_sr, "key0"_sr), -1000, 1 << 20));
+	ASSERT(result.size() == 1000 && result[0].key == "key/0999"_sr);
+
+	IKnobCollection::getMutableGlobalKnobCollection().setKnob("rocksdb_read_range_readahead_min_bytes",
+	                                                          KnobValueRef::create(int64_t{ 131072 }));
+	Future<Void> closed = kvStore->onClosed();
+	kvStore->dispose();
+	wait(closed);
+	return Void();
+}
+
+TEST_CASE("noSim/RocksDB/FetchIngestSst") {
+	state const std::string rocksDBTestDir = "rocksdb-kvstore-fetch-ingest-test-db";
+	platform::eraseDirectoryRecursive(rocksDBTestDir);
+	IKnobCollection::getMutableGlobalKnobCollection().setKnob("rocksdb_fetch_ingest_sst",
+	                                                          KnobValueRef::create(bool{ true }));
+	IKnobCollection::getMutableGlobalKnobCollection().setKnob("rocksdb_fetch_ingest_sst_min_bytes",
+	                                                          KnobValueRef::create(int{ 1 }));
+
+	state RocksDBKeyValueStore* kvStore =
+	    new RocksDBKeyValueStore(rocksDBTestDir, deterministicRandom()->randomUniqueID());
+	wait(kvStore->init());
+
+	kvStore->set({ "a"_sr, "old"_sr });
+	kvStore->set({ "b/stale"_sr, "old"_sr });
+	kvStore->set({ "c"_sr, "old"_sr });
+	wait(kvStore->commit(false));
+
+	// Writes before a replaced range are superseded by it, and writes after it are applied on top of it.
+	kvStore->set({ "b/"_sr, "superseded"_sr });
+	kvStore->clear(KeyRangeRef("a"_sr, "c0"_sr));
+	state Standalone<VectorRef<KeyValueRef>> block1;
+	block1.push_back_deep(block1.arena(), KeyValueRef("b/0"_sr, "fetched"_sr));
+	block1.push_back_deep(block1.arena(), KeyValueRef("b/1"_sr, "fetched"_sr));
+	state Standalone<VectorRef<KeyValueRef>> block2;
+	block2.push_back_deep(block2.arena(), KeyValueRef("b/2"_sr, "fetched"_sr));
+	block2.push_back_deep(block2.arena(), KeyValueRef("b/3"_sr, "fetched"_sr));
+	wait(kvStore->replaceRange(KeyRangeRef("b/"_sr, "b/2"_sr), block1));
+	wait(kvStore->replaceRange(KeyRangeRef("b/2"_sr, "c"_sr), block2));
+	ASSERT(kvStore->pendingIngests.size() == 1);
+	kvStore->set({ "b/3"_sr, "updated"_sr });
+	kvStore->clear(singleKeyRange("b/0"_sr));
+	wait(kvStore->commit(false));
+
+	RangeResult result = wait(kvStore->readRange(KeyRangeRef(""_sr, "\xff"_sr), 100, 1 << 20));
+	ASSERT(result.size() == 3);
+	ASSERT(result[0].key == "b/1"_sr && result[0].value == "fetched"_sr);
+	ASSERT(result[1].key == "b/2"_sr && result[1].value == "fetched"_sr);
+	ASSERT(result[2].key == "b/3"_sr && result[2].value == "updated"_sr);
+	// Ingested files are moved into the database
+	for (const std::string& file : platform::listFiles(rocksDBTestDir, ".sst")) {
+		ASSERT(file.rfind(fetchIngestFilePrefix, 0) != 0);
+	}
+
+	IKnobCollection::getMutableGlobalKnobCollection().setKnob("rocksdb_fetch_ingest_sst",
+	                                                          KnobValueRef::create(bool{ false }));
+	IKnobCollection::getMutableGlobalKnobCollection().setKnob("rocksdb_fetch_ingest_sst_min_bytes",
+	                                                          KnobValueRef::create(int{ 262144 }));
+	Future<Void> closed = kvStore->onClosed();
+	kvStore->dispose();
+	wait(closed);
+	return Void();
+}
+
 TEST_CASE("noSim/RocksDB/RangeClear") {
 	state const std::string rocksDBTestDir = "rocksdb-perf-db";
 	platform::eraseDirectoryRecursive(rocksDBTestDir);
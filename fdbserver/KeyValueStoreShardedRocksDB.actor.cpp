@@ -8,6 +8,7 @@
 #include <rocksdb/c.h>
 #include <rocksdb/cache.h>
 #include <rocksdb/advanced_cache.h>
+#include <rocksdb/convenience.h>
 #include <rocksdb/db.h>
 #include <rocksdb/filter_policy.h>
 #include <rocksdb/listener.h>
@@ -30,6 +31,7 @@
 #include "fdbclient/SystemData.h"
 #include "fdbserver/CoroFlow.h"
 #include "fdbserver/FDBRocksDBVersion.h"
+#include "fdbserver/RocksDBBlockCache.h"
 #include "flow/flow.h"
 #include "flow/IThreadPool.h"
 #include "flow/ThreadHelper.actor.h"
@@ -487,7 +489,62 @@ rocksdb::WALRecoveryMode getWalRecoveryMode() {
 	}
 }
 
-rocksdb::ColumnFamilyOptions getCFOptions() {
+// The filter policy of one physical shard, switched by the shard manager as the shard's reads change. It only decides
+// the filters of files written from then on; bloom and ribbon filters are read by any built-in policy, so the filters
+// of files written before a switch stay usable.
+class ShardFilterPolicy : public rocksdb::FilterPolicy {
+public:
+	enum class Profile { MIXED, POINT_READ, SCAN };
+
+	ShardFilterPolicy()
+	  : profile(Profile::MIXED), bloom(rocksdb::NewBloomFilterPolicy(10)),
+	    ribbon(rocksdb::NewRibbonFilterPolicy(SERVER_KNOBS->SHARDED_ROCKSDB_POINT_READ_FILTER_BITS)) {}
+
+	const char* Name() const override { return "fdb.ShardFilterPolicy"; }
+	const char* CompatibilityName() const override { return bloom->CompatibilityName(); }
+
+	rocksdb::FilterBitsBuilder* GetBuilderWithContext(const rocksdb::FilterBuildingContext& context) const override {
+		switch (profile.load()) {
+		case Profile::POINT_READ:
+			// Ribbon filters take about 30% less memory than bloom filters for the same false positive rate, at the
+			// cost of more CPU when building them.
+			return ribbon->GetBuilderWithContext(context);
+		case Profile::SCAN:
+			// Scans don't use whole key filters, so don't spend memory on them.
+			return nullptr;
+		default:
+			return bloom->GetBuilderWithContext(context);
+		}
+	}
+
+	rocksdb::FilterBitsReader* GetFilterBitsReader(const rocksdb::Slice& contents) const override {
+		return bloom->GetFilterBitsReader(contents);
+	}
+
+	Profile getProfile() const { return profile.load(); }
+	void setProfile(Profile p) { profile.store(p); }
+
+	static const char* toString(Profile p) {
+		switch (p) {
+		case Profile::POINT_READ:
+			return "PointRead";
+		case Profile::SCAN:
+			return "Scan";
+		default:
+			return "Mixed";
+		}
+	}
+
+private:
+	// Written on the network thread, read by RocksDB's flush and compaction threads.
+	std::atomic<Profile> profile;
+	std::shared_ptr<const rocksdb::FilterPolicy> bloom;
+	std::shared_ptr<const rocksdb::FilterPolicy> ribbon;
+};
+
+// Returns the column family options of a physical shard. The options of a shard with its own filter policy have their
+// own table factory, so that its block size can be changed separately.
+rocksdb::ColumnFamilyOptions getCFOptions(std::shared_ptr<ShardFilterPolicy> filterPolicy = nullptr) {
 	rocksdb::ColumnFamilyOptions options;
 
 	if (SERVER_KNOBS->ROCKSDB_LEVEL_COMPACTION_DYNAMIC_LEVEL_BYTES) {
@@ -559,13 +616,21 @@ rocksdb::ColumnFamilyOptions getCFOptions() {
 		// https://github.com/facebook/rocksdb/wiki/RocksDB-Bloom-Filter#prefix-vs-whole-key
 		bbOpts.whole_key_filtering = false;
 	}
+	if (filterPolicy) {
+		bbOpts.format_version = 5;
+		bbOpts.filter_policy = filterPolicy;
+		if (filterPolicy->getProfile() == ShardFilterPolicy::Profile::SCAN) {
+			bbOpts.block_size = SERVER_KNOBS->SHARDED_ROCKSDB_SCAN_BLOCK_SIZE;
+		}
+	}
 
 	options.level0_file_num_compaction_trigger = SERVER_KNOBS->SHARDED_ROCKSDB_LEVEL0_FILENUM_COMPACTION_TRIGGER;
 	options.level0_slowdown_writes_trigger = SERVER_KNOBS->SHARDED_ROCKSDB_LEVEL0_SLOWDOWN_WRITES_TRIGGER;
 	options.level0_stop_writes_trigger = SERVER_KNOBS->SHARDED_ROCKSDB_LEVEL0_STOP_WRITES_TRIGGER;
 
 	if (rocksdb_block_cache == nullptr && SERVER_KNOBS->SHARDED_ROCKSDB_BLOCK_CACHE_SIZE > 0) {
-		rocksdb_block_cache = rocksdb::NewLRUCache(SERVER_KNOBS->SHARDED_ROCKSDB_BLOCK_CACHE_SIZE);
+		rocksdb_block_cache = newRocksDBBlockCache(SERVER_KNOBS->SHARDED_ROCKSDB_BLOCK_CACHE_SIZE,
+		                                           rocksdb::LRUCacheOptions().high_pri_pool_ratio);
 	}
 	bbOpts.block_cache = rocksdb_block_cache;
 
@@ -576,8 +641,8 @@ rocksdb::ColumnFamilyOptions getCFOptions() {
 	return options;
 }
 
-rocksdb::ColumnFamilyOptions getCFOptionsForInactiveShard() {
-	auto options = getCFOptions();
+rocksdb::ColumnFamilyOptions getCFOptionsForInactiveShard(std::shared_ptr<ShardFilterPolicy> filterPolicy = nullptr) {
+	auto options = getCFOptions(filterPolicy);
 	// never slowdown ingest.
 	options.level0_file_num_compaction_trigger = (1 << 30);
 	options.level0_slowdown_writes_trigger = (1 << 30);
@@ -806,10 +871,16 @@ struct DataShard {
 // PhysicalShard represent a collection of logical shards. A PhysicalShard could have one or more DataShards. A
 // PhysicalShard is stored as a column family in rocksdb. Each PhysicalShard has its own iterator pool.
 struct PhysicalShard {
-	PhysicalShard(rocksdb::DB* db, std::string id, const rocksdb::ColumnFamilyOptions& options)
-	  : db(db), id(id), cfOptions(options), isInitialized(false) {}
-	PhysicalShard(rocksdb::DB* db, std::string id, rocksdb::ColumnFamilyHandle* handle)
-	  : db(db), id(id), cf(handle), isInitialized(true) {
+	PhysicalShard(rocksdb::DB* db,
+	              std::string id,
+	              const rocksdb::ColumnFamilyOptions& options,
+	              std::shared_ptr<ShardFilterPolicy> filterPolicy = nullptr)
+	  : db(db), id(id), cfOptions(options), filterPolicy(filterPolicy), isInitialized(false) {}
+	PhysicalShard(rocksdb::DB* db,
+	              std::string id,
+	              rocksdb::ColumnFamilyHandle* handle,
+	              std::shared_ptr<ShardFilterPolicy> filterPolicy = nullptr)
+	  : db(db), id(id), cf(handle), filterPolicy(filterPolicy), isInitialized(true) {
 		ASSERT(cf);
 		readIterPool = std::make_shared<ReadIteratorPool>(db, cf, id);
 	}
@@ -839,12 +910,13 @@ struct PhysicalShard {
 				TraceEvent(SevInfo, "RocksDBRestoreEmptyShard")
 				    .detail("ShardId", id)
 				    .detail("CheckpointID", checkpoint.checkpointID);
-				status = db->CreateColumnFamily(getCFOptions(), id, &cf);
+				status = db->CreateColumnFamily(getCFOptions(filterPolicy), id, &cf);
 			} else {
 				TraceEvent(SevInfo, "RocksDBRestoreCF");
 				rocksdb::ImportColumnFamilyOptions importOptions;
 				importOptions.move_files = SERVER_KNOBS->ROCKSDB_IMPORT_MOVE_FILES;
-				status = db->CreateColumnFamilyWithImport(getCFOptions(), id, importOptions, metaData, &cf);
+				status =
+				    db->CreateColumnFamilyWithImport(getCFOptions(filterPolicy), id, importOptions, metaData, &cf);
 				TraceEvent(SevInfo, "RocksDBRestoreCFEnd").detail("Status", status.ToString());
 			}
 		} else if (format == RocksDBKeyValues) {
@@ -958,13 +1030,32 @@ struct PhysicalShard {
 	std::string id;
 	rocksdb::ColumnFamilyOptions cfOptions;
 	rocksdb::ColumnFamilyHandle* cf = nullptr;
+	// Set when the shard's filters and block size follow its reads
+	std::shared_ptr<ShardFilterPolicy> filterPolicy;
 	std::unordered_map<std::string, std::unique_ptr<DataShard>> dataShards;
 	std::shared_ptr<ReadIteratorPool> readIterPool;
 	bool deletePending = false;
+	// Set while the shard has no data shards left and waits to be dropped, so compacting it would be wasted
+	bool dropPending = false;
 	std::atomic<bool> isInitialized;
 	uint64_t numRangeDeletions = 0;
 	double deleteTimeSec = 0.0;
 	double lastCompactionTime = 0.0;
+	// Reads issued to the shard, decayed each time its options are tuned
+	uint64_t pointReads = 0;
+	uint64_t rangeReads = 0;
+	// State of the compaction scheduler. A shard added as inactive has compactions disabled until it is marked active.
+	bool ingesting = false;
+	bool compactionDeferred = false;
+	double compactionDeferTime = 0.0;
+	double compactionResumeTime = 0.0;
+	uint64_t compactionDebt = 0;
+	uint64_t readsSinceCompactionSchedule = 0;
+
+	void recordRead(bool pointRead) {
+		++(pointRead ? pointReads : rangeReads);
+		++readsSinceCompactionSchedule;
+	}
 };
 
 int readRangeInDb(PhysicalShard* shard, const KeyRangeRef range, int rowLimit, int byteLimit, RangeResult* result) {
@@ -1028,10 +1119,17 @@ struct Counters {
 	Counter immediateThrottle;
 	Counter failedToAcquire;
 	Counter convertedRangeDeletions;
+	// Removed data which was deleted by dropping column families or deleting whole files, not by compactions
+	Counter droppedShards;
+	Counter droppedShardBytes;
+	Counter removedRangeFileDeletions;
+	Counter removedRangeFileBytes;
 
 	Counters()
 	  : cc("RocksDBCounters"), immediateThrottle("ImmediateThrottle", cc), failedToAcquire("FailedToAcquire", cc),
-	    convertedRangeDeletions("ConvertedRangeDeletions", cc) {}
+	    convertedRangeDeletions("ConvertedRangeDeletions", cc), droppedShards("DroppedShards", cc),
+	    droppedShardBytes("DroppedShardBytes", cc), removedRangeFileDeletions("RemovedRangeFileDeletions", cc),
+	    removedRangeFileBytes("RemovedRangeFileBytes", cc) {}
 };
 
 // Manages physical shards and maintains logical shard mapping.
@@ -1081,6 +1179,10 @@ public:
 
 					TraceEvent e(SevInfo, "PhysicalShardStats");
 					e.detail("ShardId", id).detail("LiveDataSize", liveDataSize);
+					if (SERVER_KNOBS->SHARDED_ROCKSDB_COMPACTION_SCHEDULER) {
+						e.detail("CompactionDebt", shard->compactionDebt)
+						    .detail("CompactionDeferred", shard->compactionDeferred);
+					}
 
 					// Get compression ratio for each level.
 					rocksdb::ColumnFamilyMetaData cfMetadata;
@@ -1116,6 +1218,189 @@ public:
 		return Void();
 	}
 
+	// Periodically matches the options of each physical shard with its own filter policy to its recent reads.
+	ACTOR static Future<Void> shardOptionsTuner(std::shared_ptr<ShardedRocksDBState> rState,
+	                                            Future<Void> openFuture,
+	                                            ShardManager* shardManager) {
+		state std::unordered_map<std::string, std::shared_ptr<PhysicalShard>>* physicalShards =
+		    shardManager->getAllShards();
+
+		try {
+			wait(openFuture);
+			loop {
+				wait(delay(SERVER_KNOBS->SHARDED_ROCKSDB_FILTER_TUNE_INTERVAL));
+				if (rState->closing) {
+					break;
+				}
+				for (auto& [id, shard] : *physicalShards) {
+					if (shard->filterPolicy && shard->initialized()) {
+						shardManager->tuneShardOptions(shard.get());
+					}
+				}
+			}
+		} catch (Error& e) {
+			if (e.code() != error_code_actor_cancelled) {
+				TraceEvent(SevError, "ShardedRocksShardOptionsTunerError").errorUnsuppressed(e);
+			}
+		}
+		return Void();
+	}
+
+	// Shards that are mostly point read get ribbon filters, shards that are mostly scanned get no filters and larger
+	// blocks, and the rest get bloom filters. Only files written from now on are affected.
+	void tuneShardOptions(PhysicalShard* shard) {
+		const uint64_t reads = shard->pointReads + shard->rangeReads;
+		if (reads < SERVER_KNOBS->SHARDED_ROCKSDB_FILTER_TUNE_MIN_READS) {
+			return;
+		}
+
+		const double pointReadRatio = (double)shard->pointReads / reads;
+		ShardFilterPolicy::Profile profile = ShardFilterPolicy::Profile::MIXED;
+		if (pointReadRatio >= SERVER_KNOBS->SHARDED_ROCKSDB_POINT_READ_SHARD_RATIO) {
+			profile = ShardFilterPolicy::Profile::POINT_READ;
+		} else if (pointReadRatio <= SERVER_KNOBS->SHARDED_ROCKSDB_SCAN_SHARD_RATIO) {
+			profile = ShardFilterPolicy::Profile::SCAN;
+		}
+
+		const ShardFilterPolicy::Profile current = shard->filterPolicy->getProfile();
+		if (profile != current) {
+			shard->filterPolicy->setProfile(profile);
+			TraceEvent e(SevInfo, "ShardedRocksDBShardOptionsTuned", logId);
+			e.detail("ShardId", shard->id)
+			    .detail("Profile", ShardFilterPolicy::toString(profile))
+			    .detail("PreviousProfile", ShardFilterPolicy::toString(current))
+			    .detail("PointReads", shard->pointReads)
+			    .detail("RangeReads", shard->rangeReads);
+
+			if ((profile == ShardFilterPolicy::Profile::SCAN) != (current == ShardFilterPolicy::Profile::SCAN)) {
+				const size_t blockSize = profile == ShardFilterPolicy::Profile::SCAN
+				                             ? SERVER_KNOBS->SHARDED_ROCKSDB_SCAN_BLOCK_SIZE
+				                             : rocksdb::BlockBasedTableOptions().block_size;
+				auto s = db->SetOptions(
+				    shard->cf, { { "block_based_table_factory", "{block_size=" + std::to_string(blockSize) + ";}" } });
+				e.detail("BlockSize", blockSize).detail("SetOptionsStatus", s.ToString());
+			}
+		}
+
+		// Halve the counts so that the profile follows changes in the shard's reads.
+		shard->pointReads /= 2;
+		shard->rangeReads /= 2;
+	}
+
+	ACTOR static Future<Void> compactionScheduler(std::shared_ptr<ShardedRocksDBState> rState,
+	                                              Future<Void> openFuture,
+	                                              ShardManager* shardManager) {
+		try {
+			wait(openFuture);
+			loop {
+				wait(delay(SERVER_KNOBS->SHARDED_ROCKSDB_COMPACTION_SCHEDULER_INTERVAL));
+				if (rState->closing) {
+					break;
+				}
+				shardManager->scheduleCompactions();
+			}
+		} catch (Error& e) {
+			if (e.code() != error_code_actor_cancelled) {
+				TraceEvent(SevError, "ShardedRocksCompactionSchedulerError").errorUnsuppressed(e);
+			}
+		}
+		return Void();
+	}
+
+	// RocksDB gives every column family the same share of the compaction threads, and stalls writes to all of them
+	// when any one has too much compaction debt. A shard being bulk loaded, while nobody reads it yet, can so slow
+	// down the compactions and the writes of the shards which serve reads. Such a shard has its automatic compactions
+	// deferred: it is compacted later, and in the meantime its debt doesn't stall writes. It is resumed once it is
+	// read, its debt reaches SHARDED_ROCKSDB_COMPACTION_MAX_DEFERRED_DEBT, or it has been deferred for
+	// SHARDED_ROCKSDB_COMPACTION_MAX_DEFER_TIME, after which it isn't deferred again for as long.
+	void scheduleCompactions() {
+		const double currentTime = now();
+		int numDeferred = 0;
+		for (auto& [id, shard] : physicalShards) {
+			if (!shard->initialized() || shard->deletePending || shard->dropPending || shard->ingesting) {
+				continue;
+			}
+			uint64_t debt = 0;
+			ASSERT(db->GetIntProperty(shard->cf, rocksdb::DB::Properties::kEstimatePendingCompactionBytes, &debt));
+			shard->compactionDebt = debt;
+			const uint64_t reads = shard->readsSinceCompactionSchedule;
+			shard->readsSinceCompactionSchedule = 0;
+
+			if (shard->compactionDeferred) {
+				const char* reason = nullptr;
+				if (reads > 0) {
+					reason = "Read";
+				} else if (debt >= SERVER_KNOBS->SHARDED_ROCKSDB_COMPACTION_MAX_DEFERRED_DEBT) {
+					reason = "MaxDebt";
+				} else if (currentTime - shard->compactionDeferTime >=
+				           SERVER_KNOBS->SHARDED_ROCKSDB_COMPACTION_MAX_DEFER_TIME) {
+					reason = "MaxTime";
+				}
+				if (reason != nullptr && setCompactionDeferred(shard.get(), false)) {
+					shard->compactionResumeTime = currentTime;
+					TraceEvent("ShardedRocksDBCompactionResumed", logId)
+					    .detail("ShardId", id)
+					    .detail("Reason", reason)
+					    .detail("CompactionDebt", debt)
+					    .detail("DeferredSeconds", currentTime - shard->compactionDeferTime);
+				} else {
+					++numDeferred;
+				}
+			} else if (reads == 0 && id != METADATA_SHARD_ID && id != DEFAULT_CF_NAME &&
+			           debt >= SERVER_KNOBS->SHARDED_ROCKSDB_COMPACTION_DEFER_DEBT &&
+			           debt < SERVER_KNOBS->SHARDED_ROCKSDB_COMPACTION_MAX_DEFERRED_DEBT &&
+			           (shard->compactionResumeTime <= 0.0 ||
+			            currentTime - shard->compactionResumeTime >=
+			                SERVER_KNOBS->SHARDED_ROCKSDB_COMPACTION_MAX_DEFER_TIME) &&
+			           setCompactionDeferred(shard.get(), true)) {
+				shard->compactionDeferTime = currentTime;
+				++numDeferred;
+				TraceEvent("ShardedRocksDBCompactionDeferred", logId)
+				    .detail("ShardId", id)
+				    .detail("CompactionDebt", debt);
+			}
+		}
+		TraceEvent(SevDebug, "ShardedRocksDBCompactionSchedule", logId).detail("NumDeferred", numDeferred);
+	}
+
+	bool setCompactionDeferred(PhysicalShard* shard, bool deferred) {
+		std::unordered_map<std::string, std::string> options;
+		if (deferred) {
+			options = { { "disable_auto_compactions", "true" },
+				        { "level0_slowdown_writes_trigger", std::to_string(1 << 30) },
+				        { "level0_stop_writes_trigger", std::to_string(1 << 30) },
+				        { "soft_pending_compaction_bytes_limit", "0" },
+				        { "hard_pending_compaction_bytes_limit", "0" } };
+		} else {
+			const rocksdb::ColumnFamilyOptions active = getCFOptions();
+			options = { { "disable_auto_compactions", active.disable_auto_compactions ? "true" : "false" },
+				        { "level0_slowdown_writes_trigger", std::to_string(active.level0_slowdown_writes_trigger) },
+				        { "level0_stop_writes_trigger", std::to_string(active.level0_stop_writes_trigger) },
+				        { "soft_pending_compaction_bytes_limit",
+				          std::to_string(active.soft_pending_compaction_bytes_limit) },
+				        { "hard_pending_compaction_bytes_limit",
+				          std::to_string(active.hard_pending_compaction_bytes_limit) } };
+		}
+		auto s = db->SetOptions(shard->cf, options);
+		if (!s.ok()) {
+			TraceEvent(SevWarn, "ShardedRocksDBSetCompactionOptionsError", logId)
+			    .detail("ShardId", shard->id)
+			    .detail("Deferred", deferred)
+			    .detail("Status", s.ToString());
+			return false;
+		}
+		shard->compactionDeferred = deferred;
+		return true;
+	}
+
+	uint64_t getCompactionDebt() const {
+		uint64_t debt = 0;
+		if (db != nullptr) {
+			db->GetAggregatedIntProperty(rocksdb::DB::Properties::kEstimatePendingCompactionBytes, &debt);
+		}
+		return debt;
+	}
+
 	rocksdb::Status init() {
 		const double start = now();
 		// Open instance.
@@ -1150,12 +1435,20 @@ public:
 		rocksdb::Status status = rocksdb::DB::ListColumnFamilies(dbOptions, path, &columnFamilies);
 
 		std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+		std::unordered_map<std::string, std::shared_ptr<ShardFilterPolicy>> filterPolicies;
 		bool foundMetadata = false;
 		for (const auto& name : columnFamilies) {
 			if (name == METADATA_SHARD_ID) {
 				foundMetadata = true;
 			}
-			descriptors.push_back(rocksdb::ColumnFamilyDescriptor(name, cfOptions));
+			if (SERVER_KNOBS->SHARDED_ROCKSDB_ADAPTIVE_FILTERS && name != METADATA_SHARD_ID &&
+			    name != DEFAULT_CF_NAME) {
+				auto filterPolicy = std::make_shared<ShardFilterPolicy>();
+				filterPolicies[name] = filterPolicy;
+				descriptors.push_back(rocksdb::ColumnFamilyDescriptor(name, getCFOptions(filterPolicy)));
+			} else {
+				descriptors.push_back(rocksdb::ColumnFamilyDescriptor(name, cfOptions));
+			}
 		}
 
 		// Add default column family if it's a newly opened database.
@@ -1178,7 +1471,9 @@ public:
 
 			std::shared_ptr<PhysicalShard> metadataShard = nullptr;
 			for (auto handle : handles) {
-				auto shard = std::make_shared<PhysicalShard>(db, handle->GetName(), handle);
+				auto policy = filterPolicies.find(handle->GetName());
+				auto shard = std::make_shared<PhysicalShard>(
+				    db, handle->GetName(), handle, policy == filterPolicies.end() ? nullptr : policy->second);
 				if (shard->id == METADATA_SHARD_ID) {
 					metadataShard = shard;
 				}
@@ -1400,9 +1695,24 @@ public:
 			}
 		}
 
-		auto cfOptions = active ? getCFOptions() : getCFOptionsForInactiveShard();
-		auto [it, inserted] = physicalShards.emplace(id, std::make_shared<PhysicalShard>(db, id, cfOptions));
+		std::shared_ptr<ShardFilterPolicy> filterPolicy;
+		if (SERVER_KNOBS->SHARDED_ROCKSDB_ADAPTIVE_FILTERS) {
+			filterPolicy = std::make_shared<ShardFilterPolicy>();
+		}
+		auto cfOptions = active ? getCFOptions(filterPolicy) : getCFOptionsForInactiveShard(filterPolicy);
+		auto [it, inserted] =
+		    physicalShards.emplace(id, std::make_shared<PhysicalShard>(db, id, cfOptions, filterPolicy));
 		std::shared_ptr<PhysicalShard>& shard = it->second;
+		if (inserted && !active) {
+			shard->ingesting = true;
+		}
+		if (shard->dropPending) {
+			// The shard is reused before it was dropped
+			shard->dropPending = false;
+			if (shard->compactionDeferred) {
+				setCompactionDeferred(shard.get(), false);
+			}
+		}
 
 		activePhysicalShardIds.emplace(id);
 
@@ -1466,12 +1776,21 @@ public:
 					existingShard->deleteTimeSec = now();
 					pendingDeletionShards.push_back(existingShard->id);
 					activePhysicalShardIds.erase(existingShard->id);
+					// Its range deletes needn't be compacted, as the column family is dropped as a whole.
+					existingShard->dropPending = true;
+					if (existingShard->initialized() && !existingShard->compactionDeferred &&
+					    existingShard->id != METADATA_SHARD_ID && existingShard->id != DEFAULT_CF_NAME) {
+						setCompactionDeferred(existingShard, true);
+					}
+				} else {
+					addRemovedRange(existingShard, shardRange);
 				}
 				continue;
 			}
 
 			// Range modification could result in more than one segments. Remove the original segment key here.
 			existingShard->dataShards.erase(shardRange.begin.toString());
+			addRemovedRange(existingShard, shardRange & range);
 			if (shardRange.begin < range.begin) {
 				auto dataShard =
 				    std::make_unique<DataShard>(KeyRange(KeyRangeRef(shardRange.begin, range.begin)), existingShard);
@@ -1536,10 +1855,46 @@ public:
 				{ "num_levels", "-1" }
 			};
 			db->SetOptions(it.value()->physicalShard->cf, options);
+			it.value()->physicalShard->ingesting = false;
+			it.value()->physicalShard->compactionDeferred = false;
 			TraceEvent("ShardedRocksDBRangeActive", logId).detail("ShardId", it.value()->physicalShard->id);
 		}
 	}
 
+	// The files wholly in a range removed from a physical shard which still has other ranges can be deleted instead of
+	// compacted with the range's deletes, once reads of the range are done.
+	void addRemovedRange(PhysicalShard* shard, KeyRange range) {
+		if (SERVER_KNOBS->SHARDED_ROCKSDB_DELETE_REMOVED_RANGE_FILES && shard->id != METADATA_SHARD_ID &&
+		    shard->id != DEFAULT_CF_NAME) {
+			pendingRemovedRanges.push_back({ shard->id, range, now() });
+		}
+	}
+
+	// Returns the removed ranges older than cleanUpDelay whose shards still exist and haven't got them back
+	std::vector<std::pair<std::shared_ptr<PhysicalShard>, KeyRange>> getPendingRemovedRanges(double cleanUpDelay) {
+		std::vector<std::pair<std::shared_ptr<PhysicalShard>, KeyRange>> removedRanges;
+		const double currentTime = now();
+		while (!pendingRemovedRanges.empty() && currentTime - pendingRemovedRanges.front().removeTime > cleanUpDelay) {
+			const RemovedRange& removed = pendingRemovedRanges.front();
+			auto it = physicalShards.find(removed.shardId);
+			if (it != physicalShards.end() && it->second->initialized() && !it->second->dropPending) {
+				bool reused = false;
+				auto ranges = dataShardMap.intersectingRanges(removed.range);
+				for (auto r = ranges.begin(); r != ranges.end(); ++r) {
+					if (r.value() && r.value()->physicalShard == it->second.get()) {
+						reused = true;
+						break;
+					}
+				}
+				if (!reused) {
+					removedRanges.emplace_back(it->second, removed.range);
+				}
+			}
+			pendingRemovedRanges.pop_front();
+		}
+		return removedRanges;
+	}
+
 	std::vector<std::shared_ptr<PhysicalShard>> getPendingDeletionShards(double cleanUpDelay) {
 		std::vector<std::shared_ptr<PhysicalShard>> emptyShards;
 		double currentTime = now();
@@ -1860,9 +2215,20 @@ private:
 	std::unique_ptr<std::set<PhysicalShard*>> dirtyShards;
 	KeyRangeMap<DataShard*> dataShardMap;
 	std::deque<std::string> pendingDeletionShards;
+	struct RemovedRange {
+		std::string shardId;
+		KeyRange range;
+		double removeTime;
+	};
+	std::deque<RemovedRange> pendingRemovedRanges;
 	Counters* counters;
 };
 
+// Perf context fields that the RocksDB C API has no metric number for, numbered below the ones it has
+enum ExtraPerfContextMetric {
+	perfcontext_secondary_cache_hit_count = -1,
+};
+
 class RocksDBMetrics {
 public:
 	RocksDBMetrics(UID debugID, std::shared_ptr<rocksdb::Statistics> stats);
@@ -1892,6 +2258,7 @@ public:
 	Reference<Histogram> getDeleteCompactRangeHistogram();
 	// Stat for Memory Usage
 	void logMemUsage(rocksdb::DB* db);
+	void logShardFilterUsage(const std::unordered_map<std::string, std::shared_ptr<PhysicalShard>>& shards);
 	std::vector<std::pair<std::string, int64_t>> getManifestBytes(std::string manifestDirectory);
 
 private:
@@ -2003,6 +2370,9 @@ RocksDBMetrics::RocksDBMetrics(UID debugID, std::shared_ptr<rocksdb::Statistics>
 		{ "BytesWritten", rocksdb::BYTES_WRITTEN, 0 },
 		{ "BlockCacheMisses", rocksdb::BLOCK_CACHE_MISS, 0 },
 		{ "BlockCacheHits", rocksdb::BLOCK_CACHE_HIT, 0 },
+		{ "SecondaryCacheHits", rocksdb::SECONDARY_CACHE_HITS, 0 },
+		{ "CompressedSecondaryCacheHits", rocksdb::COMPRESSED_SECONDARY_CACHE_HITS, 0 },
+		{ "CompressedSecondaryCachePromotions", rocksdb::COMPRESSED_SECONDARY_CACHE_PROMOTIONS, 0 },
 		{ "BloomFilterUseful", rocksdb::BLOOM_FILTER_USEFUL, 0 },
 		{ "BloomFilterFullPositive", rocksdb::BLOOM_FILTER_FULL_POSITIVE, 0 },
 		{ "BloomFilterTruePositive", rocksdb::BLOOM_FILTER_FULL_TRUE_POSITIVE, 0 },
@@ -2133,6 +2503,7 @@ RocksDBMetrics::RocksDBMetrics(UID debugID, std::shared_ptr<rocksdb::Statistics>
 		{ "EnvLockFileNanos", rocksdb_env_lock_file_nanos, {} },
 		{ "EnvUnlockFileNanos", rocksdb_env_unlock_file_nanos, {} },
 		{ "EnvNewLoggerNanos", rocksdb_env_new_logger_nanos, {} },
+		{ "SecondaryCacheHitCount", perfcontext_secondary_cache_hit_count, {} },
 	};
 	for (auto& [name, metric, vals] : perfContextMetrics) { // readers, then writer
 		for (int i = 0; i < SERVER_KNOBS->ROCKSDB_READ_PARALLELISM; i++) {
@@ -2225,6 +2596,41 @@ void RocksDBMetrics::logMemUsage(rocksdb::DB* db) {
 	e.detail("BlockCachePinnedUsage", stat);
 }
 
+// Logs the filter and index size of each physical shard whose filters follow its reads.
+void RocksDBMetrics::logShardFilterUsage(
+    const std::unordered_map<std::string, std::shared_ptr<PhysicalShard>>& shards) {
+	uint64_t totalFilterBytes = 0;
+	for (const auto& [id, shard] : shards) {
+		if (!shard->filterPolicy || !shard->initialized()) {
+			continue;
+		}
+		rocksdb::TablePropertiesCollection properties;
+		auto s = shard->db->GetPropertiesOfAllTables(shard->cf, &properties);
+		if (!s.ok()) {
+			TraceEvent(SevWarn, "ShardedRocksDBShardFilterMetricsError", debugID)
+			    .detail("ShardId", id)
+			    .detail("Status", s.ToString());
+			continue;
+		}
+		uint64_t filterBytes = 0;
+		uint64_t indexBytes = 0;
+		for (const auto& [file, props] : properties) {
+			filterBytes += props->filter_size;
+			indexBytes += props->index_size;
+		}
+		totalFilterBytes += filterBytes;
+		TraceEvent(SevInfo, "ShardedRocksDBShardFilterMetrics", debugID)
+		    .detail("ShardId", id)
+		    .detail("Profile", ShardFilterPolicy::toString(shard->filterPolicy->getProfile()))
+		    .detail("NumFiles", properties.size())
+		    .detail("FilterBytes", filterBytes)
+		    .detail("IndexBytes", indexBytes)
+		    .detail("PointReads", shard->pointReads)
+		    .detail("RangeReads", shard->rangeReads);
+	}
+	TraceEvent(SevInfo, "ShardedRocksDBFilterMetrics", debugID).detail("FilterBytes", totalFilterBytes);
+}
+
 void RocksDBMetrics::resetPerfContext() {
 	rocksdb::SetPerfLevel(rocksdb::PerfLevel::kEnableCount);
 	rocksdb::get_perf_context()->Reset();
@@ -2388,6 +2794,8 @@ uint64_t RocksDBMetrics::getRocksdbPerfcontextMetric(int metric) {
 		return rocksdb::get_perf_context()->env_unlock_file_nanos;
 	case rocksdb_env_new_logger_nanos:
 		return rocksdb::get_perf_context()->env_new_logger_nanos;
+	case perfcontext_secondary_cache_hit_count:
+		return rocksdb::get_perf_context()->secondary_cache_hit_count;
 	default:
 		break;
 	}
@@ -2409,6 +2817,9 @@ ACTOR Future<Void> rocksDBAggregatedMetricsLogger(std::shared_ptr<ShardedRocksDB
 			}
 			rocksDBMetrics->logStats(db, manifestDirectory);
 			rocksDBMetrics->logMemUsage(db);
+			if (SERVER_KNOBS->SHARDED_ROCKSDB_ADAPTIVE_FILTERS) {
+				rocksDBMetrics->logShardFilterUsage(*shardManager->getAllShards());
+			}
 			if (SERVER_KNOBS->ROCKSDB_PERFCONTEXT_SAMPLE_RATE != 0) {
 				rocksDBMetrics->logPerfContext(true);
 			}
@@ -2690,6 +3101,38 @@ struct ShardedRocksDBKeyValueStore : IKeyValueStore {
 			a.done.send(Void());
 		}
 
+		struct DeleteRangeFilesAction : TypedAction<Writer, DeleteRangeFilesAction> {
+			std::vector<std::pair<std::shared_ptr<PhysicalShard>, KeyRange>> ranges;
+			ThreadReturnPromise<int64_t> done; // Sends the bytes of the deleted files
+
+			DeleteRangeFilesAction(std::vector<std::pair<std::shared_ptr<PhysicalShard>, KeyRange>> ranges)
+			  : ranges(std::move(ranges)) {}
+			double getTimeEstimate() const override { return SERVER_KNOBS->COMMIT_TIME_ESTIMATE; }
+		};
+
+		// Runs on the write thread, so the writes of ranges added to the shards again are committed after this.
+		void action(DeleteRangeFilesAction& a) {
+			int64_t deletedBytes = 0;
+			for (const auto& [shard, range] : a.ranges) {
+				rocksdb::ColumnFamilyMetaData before;
+				shard->db->GetColumnFamilyMetaData(shard->cf, &before);
+				auto begin = toSlice(range.begin);
+				auto end = toSlice(range.end);
+				// Files in level 0 and files partly in the range are left to compactions.
+				auto s = rocksdb::DeleteFilesInRange(shard->db, shard->cf, &begin, &end, /*include_end=*/false);
+				if (!s.ok()) {
+					logRocksDBError(s, "DeleteRangeFiles");
+					continue;
+				}
+				rocksdb::ColumnFamilyMetaData after;
+				shard->db->GetColumnFamilyMetaData(shard->cf, &after);
+				if (before.size > after.size) {
+					deletedBytes += before.size - after.size;
+				}
+			}
+			a.done.send(deletedBytes);
+		}
+
 		struct CommitAction : TypedAction<Writer, CommitAction> {
 			rocksdb::DB* db;
 			std::unique_ptr<rocksdb::WriteBatch> writeBatch;
@@ -3596,7 +4039,10 @@ struct ShardedRocksDBKeyValueStore : IKeyValueStore {
 		} else {
 			writeThread = createGenericThreadPool(/*stackSize=*/0, SERVER_KNOBS->ROCKSDB_WRITER_THREAD_PRIORITY);
 			compactionThread = createGenericThreadPool(0, SERVER_KNOBS->ROCKSDB_COMPACTION_THREAD_PRIORITY);
-			readThreads = createGenericThreadPool(/*stackSize=*/0, SERVER_KNOBS->ROCKSDB_READER_THREAD_PRIORITY);
+			const int readerPriority = SERVER_KNOBS->ROCKSDB_READER_THREAD_PRIORITY;
+			readThreads = SERVER_KNOBS->ROCKSDB_WORK_STEALING_READ_THREADS
+			                  ? createWorkStealingThreadPool(/*stackSize=*/0, readerPriority)
+			                  : createGenericThreadPool(/*stackSize=*/0, readerPriority);
 		}
 		writeThread->addThread(new Writer(id, 0, shardManager.getColumnFamilyMap(), rocksDBMetrics), "fdb-rocksdb-wr");
 		compactionThread->addThread(new CompactionWorker(id), "fdb-rocksdb-cw");
@@ -3678,7 +4124,14 @@ struct ShardedRocksDBKeyValueStore : IKeyValueStore {
 			this->refreshHolder = refreshReadIteratorPools(this->rState, openFuture, shardManager.getAllShards());
 			this->refreshRocksDBBackgroundWorkHolder =
 			    refreshRocksDBBackgroundEventCounter(this->id, this->eventListener);
-			this->cleanUpJob = emptyShardCleaner(this->rState, openFuture, &shardManager, writeThread);
+			this->cleanUpJob = emptyShardCleaner(this->rState, openFuture, &shardManager, writeThread, &counters);
+			if (SERVER_KNOBS->SHARDED_ROCKSDB_ADAPTIVE_FILTERS) {
+				this->shardOptionsTuneJob = ShardManager::shardOptionsTuner(this->rState, openFuture, &shardManager);
+			}
+			if (SERVER_KNOBS->SHARDED_ROCKSDB_COMPACTION_SCHEDULER) {
+				this->compactionScheduleJob =
+				    ShardManager::compactionScheduler(this->rState, openFuture, &shardManager);
+			}
 			writeThread->post(a.release());
 			counterLogger = counters.cc.traceCounters("RocksDBCounters", id, SERVER_KNOBS->ROCKSDB_METRICS_DELAY);
 			return openFuture;
@@ -3792,6 +4245,7 @@ struct ShardedRocksDBKeyValueStore : IKeyValueStore {
 			type = options.get().type;
 			debugID = options.get().debugID;
 		}
+		shard->physicalShard->recordRead(true);
 
 		if (!shouldThrottle(type, key)) {
 			auto a = new Reader::ReadValueAction(key, shard->physicalShard, type, debugID);
@@ -3825,6 +4279,7 @@ struct ShardedRocksDBKeyValueStore : IKeyValueStore {
 			type = options.get().type;
 			debugID = options.get().debugID;
 		}
+		shard->physicalShard->recordRead(true);
 
 		if (!shouldThrottle(type, key)) {
 			auto a = new Reader::ReadValuePrefixAction(key, maxLength, shard->physicalShard, type, debugID);
@@ -3867,6 +4322,9 @@ struct ShardedRocksDBKeyValueStore : IKeyValueStore {
 	                              Optional<ReadOptions> options = Optional<ReadOptions>()) override {
 		TraceEvent(SevVerbose, "ShardedRocksReadRangeBegin", this->id).detail("Range", keys);
 		auto shards = shardManager.getDataShardsByRange(keys);
+		for (DataShard* shard : shards) {
+			shard->physicalShard->recordRead(false);
+		}
 
 		ReadType type = ReadType::NORMAL;
 		if (options.present()) {
@@ -3953,10 +4411,33 @@ struct ShardedRocksDBKeyValueStore : IKeyValueStore {
 		}
 		return Void();
 	}
+	// Deletes the files of the ranges removed cleanUpDelay ago from physical shards which are kept
+	ACTOR static Future<Void> deleteRemovedRangeFiles(ShardManager* shardManager,
+	                                                  Reference<IThreadPool> writeThread,
+	                                                  Counters* counters,
+	                                                  double cleanUpDelay) {
+		auto removedRanges = shardManager->getPendingRemovedRanges(cleanUpDelay);
+		if (removedRanges.empty()) {
+			return Void();
+		}
+		state int numRanges = removedRanges.size();
+		auto a = new Writer::DeleteRangeFilesAction(std::move(removedRanges));
+		Future<int64_t> f = a->done.getFuture();
+		writeThread->post(a);
+		int64_t deletedBytes = wait(f);
+		counters->removedRangeFileDeletions += numRanges;
+		counters->removedRangeFileBytes += deletedBytes;
+		TraceEvent(SevInfo, "ShardedRocksDBRemovedRangeFilesDeleted")
+		    .detail("Ranges", numRanges)
+		    .detail("Bytes", deletedBytes);
+		return Void();
+	}
+
 	ACTOR static Future<Void> emptyShardCleaner(std::shared_ptr<ShardedRocksDBState> rState,
 	                                            Future<Void> openFuture,
 	                                            ShardManager* shardManager,
-	                                            Reference<IThreadPool> writeThread) {
+	                                            Reference<IThreadPool> writeThread,
+	                                            Counters* counters) {
 		state double cleanUpDelay = SERVER_KNOBS->ROCKSDB_PHYSICAL_SHARD_CLEAN_UP_DELAY;
 		state double cleanUpPeriod = cleanUpDelay * 2;
 		try {
@@ -3968,12 +4449,26 @@ struct ShardedRocksDBKeyValueStore : IKeyValueStore {
 				}
 				auto shards = shardManager->getPendingDeletionShards(cleanUpDelay);
 				if (shards.size() > 0) {
+					// The data of these shards is deleted by dropping their column families, without compactions
+					for (const auto& shard : shards) {
+						uint64_t liveBytes = 0;
+						if (shard->initialized() &&
+						    shard->db->GetIntProperty(
+						        shard->cf, rocksdb::DB::Properties::kLiveSstFilesSize, &liveBytes)) {
+							counters->droppedShardBytes += liveBytes;
+						}
+					}
+					counters->droppedShards += shards.size();
 					auto a = new Writer::RemoveShardAction(shards, shardManager->getMetaDataShard());
 					Future<Void> f = a->done.getFuture();
 					writeThread->post(a);
 					TraceEvent(SevInfo, "ShardedRocksDB").detail("DeleteEmptyShards", shards.size());
 					wait(f);
 				}
+				if (rState->closing) {
+					break;
+				}
+				wait(deleteRemovedRangeFiles(shardManager, writeThread, counters, cleanUpDelay));
 			}
 		} catch (Error& e) {
 			if (e.code() != error_code_actor_cancelled) {
@@ -3983,6 +4478,8 @@ struct ShardedRocksDBKeyValueStore : IKeyValueStore {
 		return Void();
 	}
 
+	int64_t getCompactionDebt() const override { return shardManager.getCompactionDebt(); }
+
 	StorageBytes getStorageBytes() const override {
 		uint64_t live = 0;
 		ASSERT(shardManager.getDb()->GetAggregatedIntProperty(rocksdb::DB::Properties::kLiveSstFilesSize, &live));
@@ -4051,6 +4548,8 @@ struct ShardedRocksDBKeyValueStore : IKeyValueStore {
 	Future<Void> refreshHolder;
 	Future<Void> refreshRocksDBBackgroundWorkHolder;
 	Future<Void> cleanUpJob;
+	Future<Void> shardOptionsTuneJob;
+	Future<Void> compactionScheduleJob;
 	Future<Void> counterLogger;
 };
 
@@ -4169,6 +4668,156 @@ TEST_CASE("noSim/ShardedRocksDB/SingleShardRead") {
 	return Void();
 }
 
+TEST_CASE("noSim/ShardedRocksDB/AdaptiveFilters") {
+	state const std::string rocksDBTestDir = "sharded-rocksdb-test-db";
+	platform::eraseDirectoryRecursive(rocksDBTestDir);
+	IKnobCollection::getMutableGlobalKnobCollection().setKnob("sharded_rocksdb_adaptive_filters",
+	                                                          KnobValueRef::create(bool{ true }));
+
+	state ShardedRocksDBKeyValueStore* kvStore =
+	    new ShardedRocksDBKeyValueStore(rocksDBTestDir, deterministicRandom()->randomUniqueID());
+	wait(kvStore->init());
+
+	wait(kvStore->addRange(KeyRangeRef("a"_sr, "b"_sr), "shard-1"));
+	state PhysicalShard* shard = kvStore->shardManager.getDataShard("a"_sr)->physicalShard;
+	ASSERT(shard->filterPolicy && shard->filterPolicy->getProfile() == ShardFilterPolicy::Profile::MIXED);
+
+	state int i = 0;
+	for (; i < SERVER_KNOBS->SHARDED_ROCKSDB_FILTER_TUNE_MIN_READS; ++i) {
+		kvStore->set({ "a"_sr.withSuffix(BinaryWriter::toValue(i, Unversioned())), "foo"_sr });
+	}
+	wait(kvStore->commit(false));
+
+	// Point reads switch the shard to ribbon filters
+	for (i = 0; i < SERVER_KNOBS->SHARDED_ROCKSDB_FILTER_TUNE_MIN_READS; ++i) {
+		Optional<Value> val = wait(kvStore->readValue("a"_sr.withSuffix(BinaryWriter::toValue(i, Unversioned()))));
+		ASSERT(val.present());
+	}
+	kvStore->shardManager.tuneShardOptions(shard);
+	ASSERT(shard->filterPolicy->getProfile() == ShardFilterPolicy::Profile::POINT_READ);
+
+	// Once scans dominate, the shard stops building filters, and data written before and after the switch is read
+	for (i = 0; i < 10 * SERVER_KNOBS->SHARDED_ROCKSDB_FILTER_TUNE_MIN_READS; ++i) {
+		RangeResult result = wait(kvStore->readRange(KeyRangeRef("a"_sr, "b"_sr), 1, 1 << 20));
+		ASSERT_EQ(result.size(), 1);
+	}
+	kvStore->shardManager.tuneShardOptions(shard);
+	ASSERT(shard->filterPolicy->getProfile() == ShardFilterPolicy::Profile::SCAN);
+	kvStore->set({ "ab"_sr, "bar"_sr });
+	wait(kvStore->commit(false));
+	{
+		Optional<Value> val = wait(kvStore->readValue("ab"_sr));
+		ASSERT(Optional<Value>("bar"_sr) == val);
+	}
+	{
+		Optional<Value> val = wait(kvStore->readValue("a"_sr.withSuffix(BinaryWriter::toValue(0, Unversioned()))));
+		ASSERT(Optional<Value>("foo"_sr) == val);
+	}
+
+	IKnobCollection::getMutableGlobalKnobCollection().setKnob("sharded_rocksdb_adaptive_filters",
+	                                                          KnobValueRef::create(bool{ false }));
+	Future<Void> closed = kvStore->onClosed();
+	kvStore->dispose();
+	wait(closed);
+	ASSERT(!directoryExists(rocksDBTestDir));
+	return Void();
+}
+
+TEST_CASE("noSim/ShardedRocksDB/CompactionScheduler") {
+	state const std::string rocksDBTestDir = "sharded-rocksdb-test-db";
+	platform::eraseDirectoryRecursive(rocksDBTestDir);
+	// Any unread shard is deferred
+	IKnobCollection::getMutableGlobalKnobCollection().setKnob("sharded_rocksdb_compaction_defer_debt",
+	                                                          KnobValueRef::create(int64_t{ 0 }));
+
+	state ShardedRocksDBKeyValueStore* kvStore =
+	    new ShardedRocksDBKeyValueStore(rocksDBTestDir, deterministicRandom()->randomUniqueID());
+	wait(kvStore->init());
+
+	wait(kvStore->addRange(KeyRangeRef("a"_sr, "b"_sr), "shard-1"));
+	wait(kvStore->addRange(KeyRangeRef("b"_sr, "c"_sr), "shard-2", false));
+	state PhysicalShard* shard1 = kvStore->shardManager.getDataShard("a"_sr)->physicalShard;
+	state PhysicalShard* shard2 = kvStore->shardManager.getDataShard("b"_sr)->physicalShard;
+	kvStore->set({ "a"_sr, "foo"_sr });
+	kvStore->set({ "b"_sr, "bar"_sr });
+	wait(kvStore->commit(false));
+
+	// A shard which is still being ingested keeps its own options, and the metadata shard is never deferred
+	kvStore->shardManager.scheduleCompactions();
+	ASSERT(shard1->compactionDeferred);
+	ASSERT(!shard2->compactionDeferred);
+	ASSERT(!kvStore->shardManager.getMetaDataShard()->compactionDeferred);
+
+	// Reading a deferred shard resumes it, and it isn't deferred again right away
+	Optional<Value> val = wait(kvStore->readValue("a"_sr));
+	ASSERT(Optional<Value>("foo"_sr) == val);
+	kvStore->shardManager.scheduleCompactions();
+	ASSERT(!shard1->compactionDeferred);
+	kvStore->shardManager.scheduleCompactions();
+	ASSERT(!shard1->compactionDeferred);
+
+	// An ingested shard can be deferred once it is active
+	kvStore->markRangeAsActive(KeyRangeRef("b"_sr, "c"_sr));
+	kvStore->shardManager.scheduleCompactions();
+	ASSERT(shard2->compactionDeferred);
+	ASSERT_GE(kvStore->getCompactionDebt(), 0);
+
+	IKnobCollection::getMutableGlobalKnobCollection().setKnob("sharded_rocksdb_compaction_defer_debt",
+	                                                          KnobValueRef::create(int64_t{ 64 << 20 }));
+	Future<Void> closed = kvStore->onClosed();
+	kvStore->dispose();
+	wait(closed);
+	ASSERT(!directoryExists(rocksDBTestDir));
+	return Void();
+}
+
+TEST_CASE("noSim/ShardedRocksDB/RemovedRangeCleanUp") {
+	state const std::string rocksDBTestDir = "sharded-rocksdb-test-db";
+	platform::eraseDirectoryRecursive(rocksDBTestDir);
+
+	state ShardedRocksDBKeyValueStore* kvStore =
+	    new ShardedRocksDBKeyValueStore(rocksDBTestDir, deterministicRandom()->randomUniqueID());
+	wait(kvStore->init());
+
+	wait(kvStore->addRange(KeyRangeRef("a"_sr, "b"_sr), "shard-1"));
+	wait(kvStore->addRange(KeyRangeRef("b"_sr, "c"_sr), "shard-1"));
+	wait(kvStore->addRange(KeyRangeRef("c"_sr, "d"_sr), "shard-2"));
+	state PhysicalShard* shard1 = kvStore->shardManager.getDataShard("a"_sr)->physicalShard;
+	state PhysicalShard* shard2 = kvStore->shardManager.getDataShard("c"_sr)->physicalShard;
+	kvStore->set({ "a1"_sr, "foo"_sr });
+	kvStore->set({ "b1"_sr, "bar"_sr });
+	kvStore->set({ "c1"_sr, "baz"_sr });
+	wait(kvStore->commit(false));
+
+	// A range moved away from a shard which keeps other ranges has its files deleted
+	kvStore->clear(KeyRangeRef("a"_sr, "b"_sr));
+	wait(kvStore->commit(false));
+	ASSERT(kvStore->removeRange(KeyRangeRef("a"_sr, "b"_sr)).empty());
+	ASSERT(!shard1->dropPending);
+	wait(ShardedRocksDBKeyValueStore::deleteRemovedRangeFiles(
+	    &kvStore->shardManager, kvStore->writeThread, &kvStore->counters, -1.0));
+	ASSERT_EQ(kvStore->counters.removedRangeFileDeletions.getValue(),
+	          SERVER_KNOBS->SHARDED_ROCKSDB_DELETE_REMOVED_RANGE_FILES ? 1 : 0);
+	Optional<Value> val = wait(kvStore->readValue("b1"_sr));
+	ASSERT(Optional<Value>("bar"_sr) == val);
+
+	// An emptied shard isn't compacted until it's dropped, unless it's reused first
+	ASSERT_EQ(kvStore->removeRange(KeyRangeRef("c"_sr, "d"_sr)).size(), 1);
+	ASSERT(shard2->dropPending);
+	ASSERT(shard2->compactionDeferred);
+	kvStore->shardManager.scheduleCompactions();
+	ASSERT(shard2->compactionDeferred);
+	wait(kvStore->addRange(KeyRangeRef("c"_sr, "d"_sr), "shard-2"));
+	ASSERT(!shard2->dropPending);
+	ASSERT(!shard2->compactionDeferred);
+
+	Future<Void> closed = kvStore->onClosed();
+	kvStore->dispose();
+	wait(closed);
+	ASSERT(!directoryExists(rocksDBTestDir));
+	return Void();
+}
+
 TEST_CASE("noSim/ShardedRocksDB/RangeOps") {
 	state std::string rocksDBTestDir = "sharded-rocksdb-kvs-test-db";
 	platform::eraseDirectoryRecursive(rocksDBTestDir);
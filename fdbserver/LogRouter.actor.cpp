@@ -22,6 +22,7 @@
 #include "fdbrpc/Stats.h"
 #include "fdbserver/Knobs.h"
 #include "fdbserver/LogSystem.h"
+#include "fdbserver/PeekStreamFlowControl.h"
 #include "fdbserver/WorkerInterface.actor.h"
 #include "fdbserver/RecoveryState.h"
 #include "fdbserver/TLogInterface.h"
@@ -118,6 +119,13 @@ struct LogRouterData {
 
 	std::vector<Reference<TagData>> tag_data; // we only store data for the remote tag locality
 
+	// The memory held in buffered message blocks against TLOG_HARD_LIMIT_BYTES, from 0 to 1
+	double peekMemoryPressure() const {
+		return std::min(1.0,
+		                double(messageBlocks.size()) * SERVER_KNOBS->TLOG_MESSAGE_BLOCK_BYTES /
+		                    SERVER_KNOBS->TLOG_HARD_LIMIT_BYTES);
+	}
+
 	Reference<TagData> getTagData(Tag tag) {
 		ASSERT(tag.locality == tagLocalityRemoteLog);
 		if (tag.id >= tag_data.size()) {
@@ -450,7 +458,12 @@ std::deque<std::pair<Version, LengthPrefixedStringRef>>& get_version_messages(Lo
 	return tagData->version_messages;
 };
 
-void peekMessagesFromMemory(LogRouterData* self, Tag tag, Version begin, BinaryWriter& messages, Version& endVersion) {
+void peekMessagesFromMemory(LogRouterData* self,
+                            Tag tag,
+                            Version begin,
+                            BinaryWriter& messages,
+                            Version& endVersion,
+                            int replyByteLimit) {
 	ASSERT(!messages.getLength());
 
 	auto& deque = get_version_messages(self, tag);
@@ -461,10 +474,25 @@ void peekMessagesFromMemory(LogRouterData* self, Tag tag, Version begin, BinaryW
 	                           std::make_pair(begin, LengthPrefixedStringRef()),
 	                           [](const auto& l, const auto& r) -> bool { return l.first < r.first; });
 
+	// Size the reply with the same limit as the loop below before copying into it, so the messages are copied once
+	int replyBytes = 0;
 	Version currentVersion = -1;
+	for (auto sizeIt = it; sizeIt != deque.end(); ++sizeIt) {
+		if (sizeIt->first != currentVersion) {
+			if (replyBytes >= replyByteLimit) {
+				break;
+			}
+			currentVersion = sizeIt->first;
+			replyBytes += sizeof(VERSION_HEADER) + sizeof(Version);
+		}
+		replyBytes += sizeof(uint32_t) + sizeIt->second.expectedSize();
+	}
+	messages.reserve(replyBytes);
+
+	currentVersion = -1;
 	for (; it != deque.end(); ++it) {
 		if (it->first != currentVersion) {
-			if (messages.getLength() >= SERVER_KNOBS->DESIRED_TOTAL_BYTES) {
+			if (messages.getLength() >= replyByteLimit) {
 				endVersion = currentVersion + 1;
 				//TraceEvent("TLogPeekMessagesReached2", self->dbgid);
 				break;
@@ -485,7 +513,8 @@ Version poppedVersion(LogRouterData* self, Tag tag) {
 	return tagData->popped;
 }
 
-// Common logics to peek TLog and create TLogPeekReply that serves both streaming peek or normal peek request
+// Common logics to peek TLog and create TLogPeekReply that serves both streaming peek or normal peek request. Replies
+// are limited to DESIRED_TOTAL_BYTES, or to reqReplyBytes if that is smaller.
 ACTOR template <typename PromiseType>
 Future<Void> logRouterPeekMessages(PromiseType replyPromise,
                                    LogRouterData* self,
@@ -493,7 +522,8 @@ Future<Void> logRouterPeekMessages(PromiseType replyPromise,
                                    Tag reqTag,
                                    bool reqReturnIfBlocked = false,
                                    bool reqOnlySpilled = false,
-                                   Optional<std::pair<UID, int>> reqSequence = Optional<std::pair<UID, int>>()) {
+                                   Optional<std::pair<UID, int>> reqSequence = Optional<std::pair<UID, int>>(),
+                                   int reqReplyBytes = std::numeric_limits<int>::max()) {
 	state BinaryWriter messages(Unversioned());
 	state int sequence = -1;
 	state UID peekId;
@@ -609,7 +639,8 @@ Future<Void> logRouterPeekMessages(PromiseType replyPromise,
 		ASSERT(reqBegin >= poppedVersion(self, reqTag) && reqBegin >= self->startVersion);
 
 		endVersion = self->version.get() + 1;
-		peekMessagesFromMemory(self, reqTag, reqBegin, messages, endVersion);
+		peekMessagesFromMemory(
+		    self, reqTag, reqBegin, messages, endVersion, std::min(reqReplyBytes, SERVER_KNOBS->DESIRED_TOTAL_BYTES));
 
 		// Reply the peek request when
 		//   - Have data return to the caller, or
@@ -680,17 +711,30 @@ ACTOR Future<Void> logRouterPeekStream(LogRouterData* self, TLogPeekStreamReques
 
 	state Version begin = req.begin;
 	state bool onlySpilled = false;
-	req.reply.setByteLimit(std::min(SERVER_KNOBS->MAXIMUM_PEEK_BYTES, req.limitBytes));
+	state PeekStreamFlowControl flowControl(std::min<int64_t>(SERVER_KNOBS->MAXIMUM_PEEK_BYTES, req.limitBytes));
+	req.reply.setByteLimit(flowControl.getWindow());
 	loop {
 		state TLogPeekStreamReply reply;
 		state Promise<TLogPeekReply> promise;
 		state Future<TLogPeekReply> future(promise.getFuture());
+		state double readyStart = now();
 		try {
-			wait(req.reply.onReady() && store(reply.rep, future) &&
-			     logRouterPeekMessages(promise, self, begin, req.tag, req.returnIfBlocked, onlySpilled));
+			req.reply.setByteLimit(flowControl.update(req.reply.getBytesAcknowledged(), self->peekMemoryPressure()));
+			wait(req.reply.onReady());
+			state double readyWait = now() - readyStart;
+			wait(store(reply.rep, future) && logRouterPeekMessages(promise,
+			                                                       self,
+			                                                       begin,
+			                                                       req.tag,
+			                                                       req.returnIfBlocked,
+			                                                       onlySpilled,
+			                                                       Optional<std::pair<UID, int>>(),
+			                                                       flowControl.getReplyLimit()));
 
 			reply.rep.begin = begin;
 			req.reply.send(reply);
+			flowControl.addReply(reply.expectedSize(), readyWait);
+			flowControl.logMetrics(self->dbgid, req.tag, req.reply.getEndpoint().getPrimaryAddress());
 			begin = reply.rep.end;
 			onlySpilled = reply.rep.onlySpilled;
 			if (reply.rep.end > self->version.get()) {
@@ -610,6 +610,7 @@ ILogSystem::MergedPeekCursor::MergedPeekCursor(std::vector<Reference<ILogSystem:
 }
 
 Reference<ILogSystem::IPeekCursor> ILogSystem::MergedPeekCursor::cloneNoMore() {
+	catchUpCursors();
 	std::vector<Reference<ILogSystem::IPeekCursor>> cursors;
 	for (auto it : serverCursors) {
 		cursors.push_back(it->cloneNoMore());
@@ -619,6 +620,7 @@ Reference<ILogSystem::IPeekCursor> ILogSystem::MergedPeekCursor::cloneNoMore() {
 }
 
 void ILogSystem::MergedPeekCursor::setProtocolVersion(ProtocolVersion version) {
+	catchUpCursors();
 	for (auto it : serverCursors)
 		if (it->hasMessage())
 			it->setProtocolVersion(version);
@@ -640,16 +642,14 @@ void ILogSystem::MergedPeekCursor::calcHasMessage() {
 			messageVersion = serverCursors[bestServer]->version();
 			currentCursor = bestServer;
 			hasNextMessage = true;
-
-			for (auto& c : serverCursors)
-				c->advanceTo(messageVersion);
-
+			cursorsBehind = serverCursors.size() > 1;
 			return;
 		}
 
 		auto bestVersion = serverCursors[bestServer]->version();
 		for (auto& c : serverCursors)
 			c->advanceTo(bestVersion);
+		cursorsBehind = false;
 	}
 
 	hasNextMessage = false;
@@ -660,6 +660,16 @@ void ILogSystem::MergedPeekCursor::calcHasMessage() {
 	}
 }
 
+// Advancing every cursor for each message from bestServer made merging O(cursors) per message, so the other cursors are
+// brought up to messageVersion only before their positions are used.
+void ILogSystem::MergedPeekCursor::catchUpCursors() {
+	if (cursorsBehind) {
+		for (auto& c : serverCursors)
+			c->advanceTo(messageVersion);
+		cursorsBehind = false;
+	}
+}
+
 void ILogSystem::MergedPeekCursor::updateMessage(bool usePolicy) {
 	loop {
 		bool advancedPast = false;
@@ -881,6 +891,7 @@ ILogSystem::SetPeekCursor::SetPeekCursor(std::vector<Reference<LogSet>> const& l
 }
 
 Reference<ILogSystem::IPeekCursor> ILogSystem::SetPeekCursor::cloneNoMore() {
+	catchUpCursors();
 	std::vector<std::vector<Reference<ILogSystem::IPeekCursor>>> cursors;
 	cursors.resize(logSets.size());
 	for (int i = 0; i < logSets.size(); i++) {
@@ -893,6 +904,7 @@ Reference<ILogSystem::IPeekCursor> ILogSystem::SetPeekCursor::cloneNoMore() {
 }
 
 void ILogSystem::SetPeekCursor::setProtocolVersion(ProtocolVersion version) {
+	catchUpCursors();
 	for (auto& cursors : serverCursors) {
 		for (auto& it : cursors) {
 			if (it->hasMessage()) {
@@ -924,12 +936,7 @@ void ILogSystem::SetPeekCursor::calcHasMessage() {
 
 			//TraceEvent("LPC_Calc1").detail("Ver", messageVersion.toString()).detail("Tag", tag.toString()).detail("HasNextMessage", hasNextMessage);
 
-			for (auto& cursors : serverCursors) {
-				for (auto& c : cursors) {
-					c->advanceTo(messageVersion);
-				}
-			}
-
+			cursorsBehind = true;
 			return;
 		}
 
@@ -939,6 +946,7 @@ void ILogSystem::SetPeekCursor::calcHasMessage() {
 				c->advanceTo(bestVersion);
 			}
 		}
+		cursorsBehind = false;
 	}
 
 	hasNextMessage = false;
@@ -966,6 +974,19 @@ void ILogSystem::SetPeekCursor::calcHasMessage() {
 	}
 }
 
+// As in MergedPeekCursor, the cursors other than the best one are only advanced to messageVersion before their
+// positions are used.
+void ILogSystem::SetPeekCursor::catchUpCursors() {
+	if (cursorsBehind) {
+		for (auto& cursors : serverCursors) {
+			for (auto& c : cursors) {
+				c->advanceTo(messageVersion);
+			}
+		}
+		cursorsBehind = false;
+	}
+}
+
 void ILogSystem::SetPeekCursor::updateMessage(int logIdx, bool usePolicy) {
 	loop {
 		bool advancedPast = false;
@@ -34,6 +34,7 @@
 #include "flow/network.h"
 #include "flow/IUDPSocket.h"
 #include "flow/IConnection.h"
+#include "flow/UnitTest.h"
 #include "flow/actorcompiler.h"
 
 UDPMetricClient::UDPMetricClient()
@@ -146,4 +147,253 @@ void UDPMetricClient::send(MetricCollection* metrics) {
 		}
 		metrics->statsd_message.clear();
 	}
-}
\ No newline at end of file
+}
+
+namespace {
+
+// Prometheus metric and label names may only have letters, digits, underscores and, for metrics, colons
+std::string prometheusName(const std::string& name) {
+	std::string res = "fdb_";
+	for (char c : name) {
+		res += (isalnum(static_cast<unsigned char>(c)) || c == '_') ? c : '_';
+	}
+	return res;
+}
+
+std::string prometheusLabels(const std::vector<OTEL::Attribute>& attributes) {
+	std::vector<std::pair<std::string, std::string>> labels;
+	for (const auto& attr : attributes) {
+		std::string key;
+		for (char c : attr.key) {
+			key += (isalnum(static_cast<unsigned char>(c)) || c == '_') ? c : '_';
+		}
+		std::string value;
+		for (char c : attr.value) {
+			if (c == '\\' || c == '"') {
+				value += '\\';
+				value += c;
+			} else if (c == '\n') {
+				value += "\\n";
+			} else {
+				value += c;
+			}
+		}
+		labels.emplace_back(std::move(key), std::move(value));
+	}
+	std::sort(labels.begin(), labels.end());
+	std::string res;
+	for (const auto& [key, value] : labels) {
+		res += (res.empty() ? "{" : ",") + key + "=\"" + value + "\"";
+	}
+	return res.empty() ? res : res + "}";
+}
+
+} // namespace
+
+PrometheusMetrics::Series& PrometheusMetrics::getSeries(const std::string& name,
+                                                        const char* type,
+                                                        const std::vector<OTEL::Attribute>& attributes,
+                                                        double now) {
+	Family& family = families[prometheusName(name)];
+	family.type = type;
+	Series& series = family.series[prometheusLabels(attributes)];
+	series.values.clear();
+	series.updated = now;
+	return series;
+}
+
+void PrometheusMetrics::update(std::unordered_map<UID, OTEL::OTELSum>& sums,
+                               std::unordered_map<UID, OTEL::OTELGauge>& gauges,
+                               std::unordered_map<UID, OTEL::OTELHistogram>& hists,
+                               double now) {
+	for (const auto& [_, sum] : sums) {
+		if (!sum.points.empty()) {
+			const auto& point = sum.points.back();
+			double value = std::holds_alternative<int64_t>(point.val) ? std::get<int64_t>(point.val)
+			                                                           : std::get<double>(point.val);
+			getSeries(sum.name + "_total", "counter", point.attributes, now).values.emplace_back("", value);
+		}
+	}
+	for (const auto& [_, gauge] : gauges) {
+		if (!gauge.points.empty()) {
+			const auto& point = gauge.points.back();
+			double value = std::holds_alternative<int64_t>(point.val) ? std::get<int64_t>(point.val)
+			                                                           : std::get<double>(point.val);
+			getSeries(gauge.name, "gauge", point.attributes, now).values.emplace_back("", value);
+		}
+	}
+	for (const auto& [_, hist] : hists) {
+		if (!hist.points.empty()) {
+			const auto& point = hist.points.back();
+			uint64_t count = 0;
+			for (uint32_t bucket : point.buckets) {
+				count += bucket;
+			}
+			Series& series = getSeries(hist.name, "summary", point.attributes, now);
+			series.values.emplace_back("_sum", point.sum);
+			series.values.emplace_back("_count", count);
+		}
+	}
+	sums.clear();
+	gauges.clear();
+	hists.clear();
+}
+
+void PrometheusMetrics::expire(double time) {
+	for (auto family = families.begin(); family != families.end();) {
+		auto& series = family->second.series;
+		for (auto it = series.begin(); it != series.end();) {
+			it = it->second.updated < time ? series.erase(it) : std::next(it);
+		}
+		family = series.empty() ? families.erase(family) : std::next(family);
+	}
+}
+
+std::string PrometheusMetrics::render() const {
+	std::string res;
+	for (const auto& [name, family] : families) {
+		res += "# TYPE " + name + " " + family.type + "\n";
+		for (const auto& [labels, series] : family.series) {
+			for (const auto& [suffix, value] : series.values) {
+				res += name + suffix + labels + " " + format("%.17g", value) + "\n";
+			}
+		}
+	}
+	return res;
+}
+
+namespace {
+
+// Owns the PrometheusMetrics of the process, on the render thread
+struct PrometheusRenderer final : IThreadPoolReceiver {
+	void init() override {}
+
+	struct Render final : TypedAction<PrometheusRenderer, Render> {
+		std::unordered_map<UID, OTEL::OTELSum> sums;
+		std::unordered_map<UID, OTEL::OTELGauge> gauges;
+		std::unordered_map<UID, OTEL::OTELHistogram> hists;
+		double now;
+		double expireBefore;
+		ThreadReturnPromise<std::string> result;
+
+		double getTimeEstimate() const override { return .001; }
+	};
+
+	void action(Render& a) {
+		metrics.update(a.sums, a.gauges, a.hists, a.now);
+		metrics.expire(a.expireBefore);
+		a.result.send(metrics.render());
+	}
+
+	PrometheusMetrics metrics;
+};
+
+struct PrometheusMetricsHandler final : HTTP::IRequestHandler, ReferenceCounted<PrometheusMetricsHandler> {
+	explicit PrometheusMetricsHandler(Reference<PrometheusMetricClient::RenderedText> rendered) : rendered(rendered) {}
+
+	Future<Void> handleRequest(Reference<HTTP::IncomingRequest> req,
+	                           Reference<HTTP::OutgoingResponse> response) override {
+		if (req->verb != HTTP::HTTP_VERB_GET ||
+		    (req->resource != "/metrics" && !StringRef(req->resource).startsWith("/metrics?"_sr))) {
+			response->code = 404;
+			response->data.contentLen = 0;
+			return Void();
+		}
+		const std::string& text = rendered->text;
+		response->code = 200;
+		response->data.headers["Content-Type"] = "text/plain; version=0.0.4";
+		PacketWriter pw(response->data.content->getWriteBuffer(text.size()), nullptr, Unversioned());
+		pw.serializeBytes(text);
+		response->data.contentLen = text.size();
+		return Void();
+	}
+
+	Reference<HTTP::IRequestHandler> clone() override { return makeReference<PrometheusMetricsHandler>(rendered); }
+
+	void addref() override { ReferenceCounted<PrometheusMetricsHandler>::addref(); }
+	void delref() override { ReferenceCounted<PrometheusMetricsHandler>::delref(); }
+
+	Reference<PrometheusMetricClient::RenderedText> rendered;
+};
+
+} // namespace
+
+ACTOR static Future<Void> storeRendered(Future<std::string> text,
+                                        Reference<PrometheusMetricClient::RenderedText> rendered) {
+	std::string t = wait(text);
+	rendered->text = std::move(t);
+	return Void();
+}
+
+PrometheusMetricClient::PrometheusMetricClient()
+  : server(makeReference<HTTP::SimServerContext>()), rendered(makeReference<RenderedText>()) {
+	model = MetricsDataModel::OTLP;
+	if (g_network->isSimulated()) {
+		renderer = Reference<IThreadPool>(new DummyThreadPool());
+	} else {
+		renderer = createGenericThreadPool();
+	}
+	renderer->addThread(new PrometheusRenderer(), "fdb-metrics-render");
+	NetworkAddress addr(g_network->getLocalAddress().ip, FLOW_KNOBS->METRICS_PROMETHEUS_PORT);
+	server->registerNewServer(addr, makeReference<PrometheusMetricsHandler>(rendered));
+	TraceEvent("PrometheusMetricsListening").detail("Address", addr);
+}
+
+PrometheusMetricClient::~PrometheusMetricClient() {
+	server->stop();
+	renderer->stop();
+}
+
+void PrometheusMetricClient::send(MetricCollection* metrics) {
+	auto a = new PrometheusRenderer::Render();
+	a->sums = std::move(metrics->sumMap);
+	a->gauges = std::move(metrics->gaugeMap);
+	a->hists = std::move(metrics->histMap);
+	metrics->sumMap.clear();
+	metrics->gaugeMap.clear();
+	metrics->histMap.clear();
+	metrics->statsd_message.clear();
+	a->now = now();
+	// Series which were not updated by several sends in a row belong to roles that are gone
+	a->expireBefore = now() - 5 * FLOW_KNOBS->METRICS_EMISSION_INTERVAL;
+	pendingRender = storeRendered(a->result.getFuture(), rendered);
+	renderer->post(a);
+}
+
+TEST_CASE("/fdbserver/metrics/Prometheus") {
+	PrometheusMetrics metrics;
+	std::unordered_map<UID, OTEL::OTELSum> sums;
+	std::unordered_map<UID, OTEL::OTELGauge> gauges;
+	std::unordered_map<UID, OTEL::OTELHistogram> hists;
+
+	UID counterId = deterministicRandom()->randomUniqueID();
+	sums[counterId] = OTEL::OTELSum("StorageMetrics.BytesInput", 10);
+	sums[counterId].points.emplace_back(static_cast<int64_t>(25));
+	sums[counterId].points.back().addAttribute("role", "StorageMetrics").addAttribute("ip", "1.2.3.4");
+	gauges[deterministicRandom()->randomUniqueID()] = OTEL::OTELGauge("ReadLatencyp99", 0.25);
+	UID histId = deterministicRandom()->randomUniqueID();
+	hists[histId] = OTEL::OTELHistogram("ReadLatency", 0.01, { 1, 2, 3 }, 0.1, 0.5, 1.5);
+	hists[histId].points.back().addAttribute("id", "a\"b");
+	metrics.update(sums, gauges, hists, 100.0);
+	ASSERT(sums.empty() && gauges.empty() && hists.empty());
+
+	std::string text = metrics.render();
+	ASSERT_EQ(text,
+	          "# TYPE fdb_ReadLatency summary\n"
+	          "fdb_ReadLatency_sum{id=\"a\\\"b\"} 1.5\n"
+	          "fdb_ReadLatency_count{id=\"a\\\"b\"} 6\n"
+	          "# TYPE fdb_ReadLatencyp99 gauge\n"
+	          "fdb_ReadLatencyp99 0.25\n"
+	          "# TYPE fdb_StorageMetrics_BytesInput_total counter\n"
+	          "fdb_StorageMetrics_BytesInput_total{ip=\"1.2.3.4\",role=\"StorageMetrics\"} 25\n");
+
+	// Series not updated since a time are dropped, along with families left empty
+	sums[counterId] = OTEL::OTELSum("StorageMetrics.BytesInput", 30);
+	sums[counterId].points.back().addAttribute("role", "StorageMetrics").addAttribute("ip", "1.2.3.4");
+	metrics.update(sums, gauges, hists, 200.0);
+	metrics.expire(150.0);
+	ASSERT_EQ(metrics.render(),
+	          "# TYPE fdb_StorageMetrics_BytesInput_total counter\n"
+	          "fdb_StorageMetrics_BytesInput_total{ip=\"1.2.3.4\",role=\"StorageMetrics\"} 30\n");
+	return Void();
+}
@@ -464,16 +464,21 @@ ACTOR Future<Void> runMetrics() {
 	if (model == MetricsDataModel::NONE) {
 		return Void{};
 	}
-	state UDPMetricClient metricClient;
+	state std::unique_ptr<IMetricClient> metricClient;
 	state Future<Void> metricsActor;
-	if (g_network->isSimulated()) {
-		metricsActor = startMetricsSimulationServer(model);
+	if (model == MetricsDataModel::OTLP && FLOW_KNOBS->METRICS_PROMETHEUS_PORT > 0) {
+		metricClient = std::make_unique<PrometheusMetricClient>();
+	} else {
+		metricClient = std::make_unique<UDPMetricClient>();
+		if (g_network->isSimulated()) {
+			metricsActor = startMetricsSimulationServer(model);
+		}
 	}
 	loop {
 		metrics = MetricCollection::getMetricCollection();
 		if (metrics != nullptr) {
 
-			metricClient.send(metrics);
+			metricClient->send(metrics);
 		}
 		wait(delay(FLOW_KNOBS->METRICS_EMISSION_INTERVAL));
 	}
@@ -589,7 +589,7 @@ void MockStorageServer::byteSampleApplyClear(KeyRangeRef const& range) {
 		any = true;
 
 	if (any) {
-		byteSample.eraseAsync(range.begin, range.end);
+		byteSample.erase(range.begin, range.end);
 	}
 }
 
@@ -26,6 +26,7 @@
 #include "fdbserver/WaitFailure.h"
 #include "fdbserver/QuietDatabase.h"
 #include "flow/OwningResource.h"
+#include "flow/UnitTest.h"
 
 #include "flow/actorcompiler.h" // must be last include
 
@@ -42,7 +43,8 @@ const char* limitReasonName[] = { "workload",
 	                              "storage_server_durability_lag",
 	                              "storage_server_list_fetch_failed",
 	                              "blob_worker_lag",
-	                              "blob_worker_missing" };
+	                              "blob_worker_missing",
+	                              "storage_server_read_queue" };
 static_assert(sizeof(limitReasonName) / sizeof(limitReasonName[0]) == limitReason_t_end, "limitReasonDesc table size");
 
 int limitReasonEnd = limitReason_t_end;
@@ -62,7 +64,8 @@ const char* limitReasonDesc[] = { "Workload or read performance.",
 	                              "Storage server durable version falling behind.",
 	                              "Unable to fetch storage server list.",
 	                              "Blob worker granule version falling behind.",
-	                              "No blob workers are reporting metrics." };
+	                              "No blob workers are reporting metrics.",
+	                              "Storage server reads waiting too long to be served." };
 
 static_assert(sizeof(limitReasonDesc) / sizeof(limitReasonDesc[0]) == limitReason_t_end, "limitReasonDesc table size");
 
@@ -381,6 +384,29 @@ public:
 		}
 	}
 
+	ACTOR static Future<Void> sendStorageWriteBudgets(Ratekeeper* self,
+	                                                  Reference<AsyncVar<ServerDBInfo> const> dbInfo) {
+		loop {
+			wait(delay(SERVER_KNOBS->STORAGE_WRITE_BUDGETS_INTERVAL));
+			if (self->storageWriteBudgets.empty()) {
+				continue;
+			}
+			SetStorageWriteBudgetsRequest req(self->storageWriteBudgets,
+			                                  SERVER_KNOBS->STORAGE_WRITE_BUDGETS_EXPIRE_AFTER);
+			for (const auto& cpi : dbInfo->get().client.commitProxies) {
+				cpi.setStorageWriteBudgets.send(req);
+			}
+			TraceEvent("RkSendStorageWriteBudgets", self->id)
+			    .suppressFor(5.0)
+			    .detail("StorageServers", self->storageWriteBudgets.size())
+			    .detail("MinBudget",
+			            std::min_element(self->storageWriteBudgets.begin(),
+			                             self->storageWriteBudgets.end(),
+			                             [](auto const& a, auto const& b) { return a.second < b.second; })
+			                ->second);
+		}
+	}
+
 	ACTOR static Future<Void> monitorBlobWorkers(Ratekeeper* self, Reference<AsyncVar<ServerDBInfo> const> dbInfo) {
 		state std::vector<BlobWorkerInterface> blobWorkers;
 		state int workerFetchCount = 0;
@@ -507,6 +533,10 @@ public:
 			self.addActor.send(self.monitorHotShards(dbInfo));
 		}
 
+		if (SERVER_KNOBS->STORAGE_WRITE_BUDGETS_ENABLED) {
+			self.addActor.send(self.sendStorageWriteBudgets(dbInfo));
+		}
+
 		self.addActor.send(self.refreshStorageServerCommitCosts());
 
 		TraceEvent("RkTLogQueueSizeParameters", rkInterf.id())
@@ -762,6 +792,10 @@ Future<Void> Ratekeeper::monitorHotShards(Reference<AsyncVar<ServerDBInfo> const
 	return RatekeeperImpl::monitorHotShards(this, dbInfo);
 }
 
+Future<Void> Ratekeeper::sendStorageWriteBudgets(Reference<AsyncVar<ServerDBInfo> const> dbInfo) {
+	return RatekeeperImpl::sendStorageWriteBudgets(this, dbInfo);
+}
+
 Future<Void> Ratekeeper::monitorBlobWorkers(Reference<AsyncVar<ServerDBInfo> const> dbInfo) {
 	return RatekeeperImpl::monitorBlobWorkers(this, dbInfo);
 }
@@ -827,6 +861,13 @@ static std::string getIgnoredZonesReasons(
 	return ignoredZoneReasons.length() ? ignoredZoneReasons : "None";
 }
 
+// Returns the queue bytes expected after horizon seconds if the input and durable rates stay the same. Controlling on
+// this rather than the current queue throttles a growing queue before it passes its target, and stops throttling a
+// draining queue before it falls far below it.
+static int64_t predictQueueBytes(int64_t queue, double inputRate, double durableRate, double horizon) {
+	return std::max<int64_t>(0, queue + (int64_t)((inputRate - durableRate) * horizon));
+}
+
 void Ratekeeper::updateRate(RatekeeperLimits* limits) {
 	// double controlFactor = ;  // dt / eFoldingTime
 
@@ -853,6 +894,7 @@ void Ratekeeper::updateRate(RatekeeperLimits* limits) {
 
 	std::map<UID, limitReason_t> ssReasons;
 	std::map<Optional<Standalone<StringRef>>, std::set<limitReason_t>> zoneReasons;
+	std::map<UID, double> writeBudgets;
 
 	bool printRateKeepLimitReasonDetails =
 	    SERVER_KNOBS->RATEKEEPER_PRINT_LIMIT_REASON &&
@@ -904,7 +946,14 @@ void Ratekeeper::updateRate(RatekeeperLimits* limits) {
 
 		storageDurabilityLagReverseIndex.insert(std::make_pair(-1 * storageDurabilityLag, &ss));
 
-		double targetRateRatio = std::min((storageQueue - targetBytes + springBytes) / (double)springBytes, 2.0);
+		int64_t controlledQueue = storageQueue;
+		if (SERVER_KNOBS->RATEKEEPER_PREDICTIVE_CONTROL) {
+			controlledQueue = predictQueueBytes(storageQueue,
+			                                    ss.getSmoothInputBytesRate(),
+			                                    ss.getSmoothDurableBytesRate(),
+			                                    SERVER_KNOBS->RATEKEEPER_PREDICTION_HORIZON);
+		}
+		double targetRateRatio = std::min((controlledQueue - targetBytes + springBytes) / (double)springBytes, 2.0);
 
 		if (limits->priority == TransactionPriority::DEFAULT) {
 			addActor.send(tagThrottler->tryUpdateAutoThrottling(ss));
@@ -931,10 +980,11 @@ void Ratekeeper::updateRate(RatekeeperLimits* limits) {
 		  .detail("B", b);
 		  }*/
 
-		// Don't let any storage server use up its target bytes faster than its MVCC window!
+		// Don't let any storage server use up its target bytes faster than its MVCC window!  The window is shorter
+		// while the server discards versions early under memory pressure, so it can take writes faster.
 		double maxBytesPerSecond =
 		    (targetBytes - springBytes) /
-		    ((((double)SERVER_KNOBS->MAX_READ_TRANSACTION_LIFE_VERSIONS) / SERVER_KNOBS->VERSIONS_PER_SECOND) + 2.0);
+		    ((((double)ss.getMvccWindowVersions()) / SERVER_KNOBS->VERSIONS_PER_SECOND) + 2.0);
 		double limitTps = std::min(actualTps * maxBytesPerSecond / std::max(1.0e-8, inputRate),
 		                           maxBytesPerSecond * SERVER_KNOBS->MAX_TRANSACTIONS_PER_BYTE);
 		if (ssLimitReason == limitReason_t::unlimited)
@@ -980,7 +1030,38 @@ void Ratekeeper::updateRate(RatekeeperLimits* limits) {
 			}
 		}
 
-		storageTpsLimitReverseIndex.insert(std::make_pair(limitTps, &ss));
+		// Batch transactions give way to the interactive reads of a storage server once they queue for too long
+		if (limits->priority == TransactionPriority::BATCH && SERVER_KNOBS->TARGET_READ_QUEUE_WAIT_BATCH > 0) {
+			double readQueueWait = ss.getSmoothInteractiveReadQueueWait();
+			double readRateRatio = std::min((readQueueWait - SERVER_KNOBS->TARGET_READ_QUEUE_WAIT_BATCH +
+			                                 SERVER_KNOBS->SPRING_READ_QUEUE_WAIT_BATCH) /
+			                                    SERVER_KNOBS->SPRING_READ_QUEUE_WAIT_BATCH,
+			                                2.0);
+			if (readRateRatio > 0 && actualTps / readRateRatio < limitTps) {
+				limitTps = actualTps / readRateRatio;
+				ssLimitReason = limitReason_t::storage_server_read_queue;
+				if (printRateKeepLimitReasonDetails) {
+					TraceEvent("RatekeeperLimitReasonDetails")
+					    .detail("Reason", ssLimitReason)
+					    .detail("SSID", ss.id)
+					    .detail("ReadQueueWait", readQueueWait)
+					    .detail("ReadRateRatio", readRateRatio)
+					    .detail("ActualTps", actualTps)
+					    .detail("LimitTps", limitTps);
+				}
+			}
+		}
+
+		// A storage server that is only limited by how fast it is written is left to the commit proxies, which throttle
+		// just the transactions writing to it, as long as its queue is within the spring
+		if (SERVER_KNOBS->STORAGE_WRITE_BUDGETS_ENABLED && limits->priority == TransactionPriority::DEFAULT &&
+		    (ssLimitReason == limitReason_t::storage_server_write_queue_size ||
+		     ssLimitReason == limitReason_t::storage_server_write_bandwidth_mvcc) &&
+		    targetRateRatio < 2.0 && limitTps < actualTps) {
+			writeBudgets[ss.id] = limitTps / actualTps;
+		} else {
+			storageTpsLimitReverseIndex.insert(std::make_pair(limitTps, &ss));
+		}
 
 		if (limitTps < limits->tpsLimit && (ssLimitReason == limitReason_t::storage_server_min_free_space ||
 		                                    ssLimitReason == limitReason_t::storage_server_min_free_space_ratio)) {
@@ -1284,7 +1365,14 @@ void Ratekeeper::updateRate(RatekeeperLimits* limits) {
 
 		int64_t queue = tl.lastReply.bytesInput - tl.getSmoothDurableBytes();
 		healthMetrics.tLogQueue[tl.id] = queue;
-		int64_t b = queue - targetBytes;
+		int64_t controlledQueue = queue;
+		if (SERVER_KNOBS->RATEKEEPER_PREDICTIVE_CONTROL) {
+			controlledQueue = predictQueueBytes(queue,
+			                                    tl.getSmoothInputBytesRate(),
+			                                    tl.getSmoothDurableBytesRate(),
+			                                    SERVER_KNOBS->RATEKEEPER_PREDICTION_HORIZON);
+		}
+		int64_t b = controlledQueue - targetBytes;
 		worstStorageQueueTLog = std::max(worstStorageQueueTLog, queue);
 
 		if (tl.lastReply.bytesInput - tl.lastReply.bytesDurable > tl.lastReply.storageBytes.free - minFreeSpace / 2) {
@@ -1403,6 +1491,10 @@ void Ratekeeper::updateRate(RatekeeperLimits* limits) {
 	limits->tpsLimitMetric = std::min(limits->tpsLimit, 1e6);
 	limits->reasonMetric = limitReason;
 
+	if (limits->priority == TransactionPriority::DEFAULT) {
+		storageWriteBudgets = std::move(writeBudgets);
+	}
+
 	if (limits->priority == TransactionPriority::DEFAULT) {
 		limits->tpsLimit = std::max(limits->tpsLimit, SERVER_KNOBS->RATEKEEPER_MIN_RATE);
 		limits->tpsLimit = std::min(limits->tpsLimit, SERVER_KNOBS->RATEKEEPER_MAX_RATE);
@@ -1411,6 +1503,41 @@ void Ratekeeper::updateRate(RatekeeperLimits* limits) {
 		limits->tpsLimit = std::min(limits->tpsLimit, SERVER_KNOBS->RATEKEEPER_BATCH_MAX_RATE);
 	}
 
+	if (SERVER_KNOBS->RATEKEEPER_RECORD_CONTROLLER_DECISIONS) {
+		// Everything needed to replay the decision offline, including the queue model of the limiting server
+		TraceEvent ev("RkControllerDecision", id);
+		ev.detail("Context", limits->context)
+		    .detail("Predictive", SERVER_KNOBS->RATEKEEPER_PREDICTIVE_CONTROL)
+		    .detail("Horizon", SERVER_KNOBS->RATEKEEPER_PREDICTION_HORIZON)
+		    .detail("TPSLimit", limits->tpsLimit)
+		    .detail("Reason", limitReason)
+		    .detail("ReasonServerID", reasonID)
+		    .detail("ReleasedTPS", smoothReleasedTransactions.smoothRate())
+		    .detail("TPSBasis", actualTps)
+		    .detail("WorstStorageServerQueue", worstStorageQueueStorageServer)
+		    .detail("LimitingStorageServerQueue", limitingStorageQueueStorageServer)
+		    .detail("WorstTLogQueue", worstStorageQueueTLog)
+		    .detail("LimitingStorageServerDurabilityLag", limitingDurabilityLag);
+		int64_t queue = -1;
+		double inputRate = 0, durableRate = 0;
+		if (auto ss = storageQueueInfo.find(reasonID); ss != storageQueueInfo.end()) {
+			queue = ss->value.getStorageQueueBytes();
+			inputRate = ss->value.getSmoothInputBytesRate();
+			durableRate = ss->value.getSmoothDurableBytesRate();
+		} else if (auto tl = tlogQueueInfo.find(reasonID); tl != tlogQueueInfo.end()) {
+			queue = tl->value.lastReply.bytesInput - tl->value.getSmoothDurableBytes();
+			inputRate = tl->value.getSmoothInputBytesRate();
+			durableRate = tl->value.getSmoothDurableBytesRate();
+		}
+		if (queue >= 0) {
+			ev.detail("ReasonQueue", queue)
+			    .detail("ReasonPredictedQueue",
+			            predictQueueBytes(queue, inputRate, durableRate, SERVER_KNOBS->RATEKEEPER_PREDICTION_HORIZON))
+			    .detail("ReasonInputBytesRate", inputRate)
+			    .detail("ReasonDurableBytesRate", durableRate);
+		}
+	}
+
 	if (deterministicRandom()->random01() < 0.1) {
 		const std::string& name = limits->rkUpdateEventCacheHolder.getPtr()->trackingKey;
 		TraceEvent(name.c_str(), id)
@@ -1439,6 +1566,7 @@ void Ratekeeper::updateRate(RatekeeperLimits* limits) {
 		    .detail("TagsAutoThrottledBusyWrite", tagThrottler->busyWriteTagCount())
 		    .detail("TagsManuallyThrottled", tagThrottler->manualThrottleCount())
 		    .detail("AutoThrottlingEnabled", tagThrottler->isAutoThrottlingEnabled())
+		    .detail("StorageWriteBudgets", storageWriteBudgets.size())
 		    .trackLatest(name);
 	}
 	ssHighWriteQueue.reset();
@@ -1474,7 +1602,9 @@ ACTOR Future<Void> ratekeeper(RatekeeperInterface rkInterf, Reference<AsyncVar<S
 StorageQueueInfo::StorageQueueInfo(const UID& ratekeeperID_, const UID& id_, const LocalityData& locality_)
   : valid(false), ratekeeperID(ratekeeperID_), id(id_), locality(locality_), acceptingRequests(false),
     smoothDurableBytes(SERVER_KNOBS->SMOOTHING_AMOUNT), smoothInputBytes(SERVER_KNOBS->SMOOTHING_AMOUNT),
-    verySmoothDurableBytes(SERVER_KNOBS->SLOW_SMOOTHING_AMOUNT), smoothDurableVersion(SERVER_KNOBS->SMOOTHING_AMOUNT),
+    verySmoothDurableBytes(SERVER_KNOBS->SLOW_SMOOTHING_AMOUNT),
+    smoothInteractiveReadQueueWait(SERVER_KNOBS->SMOOTHING_AMOUNT),
+    smoothDurableVersion(SERVER_KNOBS->SMOOTHING_AMOUNT),
     smoothLatestVersion(SERVER_KNOBS->SMOOTHING_AMOUNT), smoothFreeSpace(SERVER_KNOBS->SMOOTHING_AMOUNT),
     smoothTotalSpace(SERVER_KNOBS->SMOOTHING_AMOUNT), limitReason(limitReason_t::unlimited) {
 	// FIXME: this is a tacky workaround for a potential uninitialized use in trackStorageServerQueueInfo
@@ -1494,6 +1624,12 @@ void StorageQueueInfo::update(StorageQueuingMetricsReply const& reply, Smoother&
 	valid = true;
 	auto prevReply = std::move(lastReply);
 	lastReply = reply;
+	double interactiveReadQueueWait = 0;
+	for (ReadType type : { ReadType::NORMAL, ReadType::HIGH }) {
+		if ((int)type < reply.readLaneQueueWaits.size()) {
+			interactiveReadQueueWait = std::max(interactiveReadQueueWait, reply.readLaneQueueWaits[(int)type]);
+		}
+	}
 	if (prevReply.instanceID != reply.instanceID) {
 		smoothDurableBytes.reset(reply.bytesDurable);
 		verySmoothDurableBytes.reset(reply.bytesDurable);
@@ -1502,6 +1638,7 @@ void StorageQueueInfo::update(StorageQueuingMetricsReply const& reply, Smoother&
 		smoothTotalSpace.reset(reply.storageBytes.total);
 		smoothDurableVersion.reset(reply.durableVersion);
 		smoothLatestVersion.reset(reply.version);
+		smoothInteractiveReadQueueWait.reset(interactiveReadQueueWait);
 	} else {
 		smoothTotalDurableBytes.addDelta(reply.bytesDurable - prevReply.bytesDurable);
 		smoothDurableBytes.setTotal(reply.bytesDurable);
@@ -1511,11 +1648,22 @@ void StorageQueueInfo::update(StorageQueuingMetricsReply const& reply, Smoother&
 		smoothTotalSpace.setTotal(reply.storageBytes.total);
 		smoothDurableVersion.setTotal(reply.durableVersion);
 		smoothLatestVersion.setTotal(reply.version);
+		smoothInteractiveReadQueueWait.setTotal(interactiveReadQueueWait);
 	}
 
 	busiestReadTags = reply.busiestTags;
 }
 
+Version StorageQueueInfo::getMvccWindowVersions() const {
+	if (lastReply.mvccWindowVersions <= 0) {
+		return SERVER_KNOBS->MAX_READ_TRANSACTION_LIFE_VERSIONS;
+	}
+	return std::clamp<Version>(lastReply.mvccWindowVersions,
+	                           std::min(SERVER_KNOBS->STORAGE_MIN_MVCC_WINDOW_VERSIONS,
+	                                    SERVER_KNOBS->MAX_READ_TRANSACTION_LIFE_VERSIONS),
+	                           SERVER_KNOBS->MAX_READ_TRANSACTION_LIFE_VERSIONS);
+}
+
 UpdateCommitCostRequest StorageQueueInfo::refreshCommitCost(double elapsed) {
 	busiestWriteTags.clear();
 	TransactionTag busiestTag;
@@ -1626,3 +1774,14 @@ RatekeeperLimits::RatekeeperLimits(TransactionPriority priority,
     lastDurabilityLag(0), durabilityLagLimit(std::numeric_limits<double>::infinity()), bwLagTarget(bwLagTarget),
     priority(priority), context(context),
     rkUpdateEventCacheHolder(makeReference<EventCacheHolder>("RkUpdate" + context)) {}
+
+TEST_CASE("/fdbserver/Ratekeeper/PredictQueueBytes") {
+	// A queue growing at 10MB/s is forecast to pass a 1GB target 5 seconds before it does
+	ASSERT_EQ(predictQueueBytes(950e6, 110e6, 100e6, 5.0), (int64_t)1000e6);
+	// A draining queue is forecast to shrink, but never below empty
+	ASSERT_EQ(predictQueueBytes(100e6, 50e6, 70e6, 5.0), (int64_t)0);
+	ASSERT_EQ(predictQueueBytes(500e6, 50e6, 70e6, 5.0), (int64_t)400e6);
+	// Without a horizon the controller acts on the current queue
+	ASSERT_EQ(predictQueueBytes(500e6, 50e6, 70e6, 0.0), (int64_t)500e6);
+	return Void();
+}
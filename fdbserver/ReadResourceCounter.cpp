@@ -0,0 +1,182 @@
+/*
+ * ReadResourceCounter.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbserver/ReadResourceCounter.h"
+#include "flow/Trace.h"
+#include "flow/UnitTest.h"
+
+namespace {
+
+const char* readTypeName(ReadRequestType type) {
+	switch (type) {
+	case ReadRequestType::GET_VALUE:
+		return "GetValue";
+	case ReadRequestType::GET_KEY_VALUES:
+		return "GetKeyValues";
+	default:
+		return "Unknown";
+	}
+}
+
+ReadResourceUsage estimate(ReadResourceUsage const& sampled, double sampleRate) {
+	ReadResourceUsage result;
+	result.requests = sampled.requests / sampleRate;
+	result.cpuSeconds = sampled.cpuSeconds / sampleRate;
+	result.engineReads = sampled.engineReads / sampleRate;
+	result.bytesScanned = sampled.bytesScanned / sampleRate;
+	result.bytesReturned = sampled.bytesReturned / sampleRate;
+	return result;
+}
+
+bool usesMore(ReadResourceUsage const& a, ReadResourceUsage const& b) {
+	if (a.cpuSeconds != b.cpuSeconds) {
+		return a.cpuSeconds > b.cpuSeconds;
+	}
+	return a.bytesScanned > b.bytesScanned;
+}
+
+// The maxTracked entries of usage using the most, estimated for all reads
+template <class K, class Map>
+std::vector<std::pair<K, ReadResourceUsage>> busiest(Map const& usage, int maxTracked, double sampleRate) {
+	std::vector<std::pair<K, ReadResourceUsage>> result;
+	result.reserve(usage.size());
+	for (auto const& [key, sampled] : usage) {
+		result.emplace_back(key, estimate(sampled, sampleRate));
+	}
+	auto byUsage = [](auto const& a, auto const& b) { return usesMore(a.second, b.second); };
+	if (result.size() > static_cast<size_t>(maxTracked)) {
+		std::partial_sort(result.begin(), result.begin() + maxTracked, result.end(), byUsage);
+		result.resize(maxTracked);
+	} else {
+		std::sort(result.begin(), result.end(), byUsage);
+	}
+	return result;
+}
+
+void traceUsage(TraceEvent& event, ReadResourceUsage const& usage, double elapsed) {
+	event.detail("Requests", usage.requests / elapsed)
+	    .detail("CPUSeconds", usage.cpuSeconds / elapsed)
+	    .detail("EngineReads", usage.engineReads / elapsed)
+	    .detail("BytesScanned", usage.bytesScanned / elapsed)
+	    .detail("BytesReturned", usage.bytesReturned / elapsed)
+	    .detail("Elapsed", elapsed);
+}
+
+} // namespace
+
+ReadResourceCounter::ReadResourceCounter(UID thisServerID, double sampleRate, int maxTracked)
+  : thisServerID(thisServerID), sampleRate(sampleRate), maxTracked(maxTracked) {}
+
+bool ReadResourceCounter::sampleRead() const {
+	return sampleRate > 0 && (sampleRate >= 1 || deterministicRandom()->random01() < sampleRate);
+}
+
+void ReadResourceCounter::addRequest(ReadRequestType type,
+                                     int64_t tenantId,
+                                     Optional<TagSet> const& tags,
+                                     double cpuSeconds,
+                                     ReadEngineCost const& engineCost,
+                                     int64_t bytesReturned) {
+	intervalTypes[static_cast<int>(type)].add(cpuSeconds, engineCost, bytesReturned);
+	if (tenantId != TenantInfo::INVALID_TENANT) {
+		intervalTenants[tenantId].add(cpuSeconds, engineCost, bytesReturned);
+	}
+	if (tags.present()) {
+		for (auto const& tag : tags.get()) {
+			intervalTags[TransactionTag(tag, tags.get().getArena())].add(cpuSeconds, engineCost, bytesReturned);
+		}
+	}
+}
+
+void ReadResourceCounter::startNewInterval() {
+	if (sampleRate > 0) {
+		for (int type = 0; type < static_cast<int>(ReadRequestType::MAX); ++type) {
+			previousTypes[type] = estimate(intervalTypes[type], sampleRate);
+		}
+		previousTenants = busiest<int64_t>(intervalTenants, maxTracked, sampleRate);
+		previousTags = busiest<TransactionTag>(intervalTags, maxTracked, sampleRate);
+	}
+
+	double elapsed = now() - intervalStart;
+	if (intervalStart > 0 && sampleRate > 0 && elapsed > 0) {
+		for (int type = 0; type < static_cast<int>(ReadRequestType::MAX); ++type) {
+			TraceEvent event("ReadResourceUsage", thisServerID);
+			event.detail("Type", readTypeName(static_cast<ReadRequestType>(type)));
+			traceUsage(event, previousTypes[type], elapsed);
+		}
+		for (auto const& [tenantId, usage] : previousTenants) {
+			TraceEvent event("ReadResourceUsageByTenant", thisServerID);
+			event.detail("Tenant", tenantId);
+			traceUsage(event, usage, elapsed);
+		}
+		for (auto const& [tag, usage] : previousTags) {
+			TraceEvent event("ReadResourceUsageByTag", thisServerID);
+			event.detail("Tag", printable(tag));
+			traceUsage(event, usage, elapsed);
+		}
+	}
+
+	for (auto& usage : intervalTypes) {
+		usage = ReadResourceUsage();
+	}
+	intervalTenants.clear();
+	intervalTags.clear();
+	intervalStart = now();
+}
+
+TEST_CASE("/fdbserver/ReadResourceCounter/Aggregates") {
+	ReadResourceCounter counter(UID(), /*sampleRate=*/0.5, /*maxTracked=*/2);
+	counter.startNewInterval();
+	ASSERT(ReadResourceCounter(UID(), 1.0, 2).sampleRead());
+	ASSERT(!ReadResourceCounter(UID(), 0.0, 2).sampleRead());
+
+	TagSet tags;
+	tags.addTag("tagA"_sr);
+	ReadEngineCost small, large;
+	small.bytesScanned = 100;
+	small.reads = 1;
+	large.bytesScanned = 10000;
+	large.reads = 3;
+
+	counter.addRequest(ReadRequestType::GET_VALUE, 1, tags, 0.001, small, 50);
+	counter.addRequest(ReadRequestType::GET_KEY_VALUES, 2, tags, 0.002, large, 5000);
+	counter.addRequest(ReadRequestType::GET_KEY_VALUES, 3, Optional<TagSet>(), 0.0, large, 5000);
+	counter.addRequest(ReadRequestType::GET_KEY_VALUES, TenantInfo::INVALID_TENANT, Optional<TagSet>(), 0.0, small, 0);
+	counter.startNewInterval();
+
+	// The sampled usage is scaled up by the sample rate
+	ReadResourceUsage const& getValue = counter.getTypeUsage(ReadRequestType::GET_VALUE);
+	ASSERT(getValue.requests == 2 && getValue.engineReads == 2 && getValue.bytesScanned == 200);
+	ASSERT(getValue.bytesReturned == 100 && getValue.cpuSeconds == 0.002);
+	ReadResourceUsage const& getKeyValues = counter.getTypeUsage(ReadRequestType::GET_KEY_VALUES);
+	ASSERT(getKeyValues.requests == 6 && getKeyValues.engineReads == 14 && getKeyValues.bytesScanned == 40200);
+
+	// Only the maxTracked tenants using the most CPU are kept, then those scanning the most
+	auto const& tenants = counter.getBusiestTenants();
+	ASSERT(tenants.size() == 2);
+	ASSERT(tenants[0].first == 2 && tenants[1].first == 1);
+
+	auto const& busiestTags = counter.getBusiestTags();
+	ASSERT(busiestTags.size() == 1);
+	ASSERT(busiestTags[0].first == "tagA"_sr && busiestTags[0].second.requests == 4);
+	ASSERT(busiestTags[0].second.bytesReturned == 10100);
+
+	return Void();
+}
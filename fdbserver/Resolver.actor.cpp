@@ -36,6 +36,7 @@
 #include "fdbserver/ResolverInterface.h"
 #include "fdbserver/RestoreUtil.h"
 #include "fdbserver/ServerDBInfo.h"
+#include "fdbserver/TxnStateSnapshot.h"
 #include "fdbserver/StorageMetrics.actor.h"
 #include "fdbserver/WaitFailure.h"
 #include "fdbserver/WorkerInterface.actor.h"
@@ -564,6 +565,11 @@ struct TransactionStateResolveContext {
 	// Actor streams
 	PromiseStream<Future<Void>>* pActors = nullptr;
 
+	// Bytes of the encoded parts received, time spent decoding them, and when the first part arrived
+	int64_t snapshotBytes = 0;
+	double decodeSeconds = 0;
+	double firstPartTime = 0;
+
 	// Flag reports if the transaction state request is complete. This request should only happen during recover, i.e.
 	// once per Resolver.
 	bool processed = false;
@@ -677,10 +683,25 @@ ACTOR Future<Void> processTransactionStateRequestPart(Reference<Resolver> self,
 		// This is the last piece of subsequence, yet other pieces might still on the way.
 		pContext->maxSequence = request.sequence + 1;
 	}
+	if (pContext->receivedSequences.empty()) {
+		pContext->firstPartTime = now();
+	}
 	pContext->receivedSequences.insert(request.sequence);
 
+	// Relay the part to the rest of its subtree before applying it, so that every level of the broadcast tree receives
+	// and processes the parts at the same time rather than after its parent has processed them. The reply is still only
+	// sent once both the subtree and this process have the part.
+	state ReplyPromise<Void> reply = request.reply;
+	state Future<Void> relayed = broadcastTxnRequest(request, SERVER_KNOBS->TXN_STATE_SEND_AMOUNT, false);
+
 	// ASSERT(!pContext->pResolverData->validState.isSet());
 
+	if (!request.snapshot.empty()) {
+		const double decodeStart = timer();
+		request.data = decodeTxnStateSnapshot(request.snapshot, request.arena);
+		pContext->decodeSeconds += timer() - decodeStart;
+		pContext->snapshotBytes += request.snapshot.size();
+	}
 	for (auto& kv : request.data) {
 		pContext->pTxnStateStore->set(kv, &request.arena);
 	}
@@ -689,6 +710,7 @@ ACTOR Future<Void> processTransactionStateRequestPart(Reference<Resolver> self,
 	if (pContext->receivedSequences.size() == pContext->maxSequence) {
 		// Received all components of the txnStateRequest
 		ASSERT(!pContext->processed);
+		state double processStart = now();
 		state std::unordered_map<EncryptCipherDomainId, Reference<BlobCipherKey>> cipherKeys;
 		if (self->encryptMode.isEncryptionEnabled()) {
 			static const std::unordered_set<EncryptCipherDomainId> metadataDomainIds = {
@@ -702,10 +724,16 @@ ACTOR Future<Void> processTransactionStateRequestPart(Reference<Resolver> self,
 		wait(processCompleteTransactionStateRequest(
 		    self, pContext, db, self->encryptMode.isEncryptionEnabled() ? &cipherKeys : nullptr));
 		pContext->processed = true;
+		TraceEvent("ResolverTxnStateReceived", self->dbgid)
+		    .detail("Parts", pContext->maxSequence)
+		    .detail("SnapshotBytes", pContext->snapshotBytes)
+		    .detail("DecodeSeconds", pContext->decodeSeconds)
+		    .detail("ReceiveDuration", processStart - pContext->firstPartTime)
+		    .detail("ProcessDuration", now() - processStart);
 	}
 
-	pContext->pActors->send(broadcastTxnRequest(request, SERVER_KNOBS->TXN_STATE_SEND_AMOUNT, true));
-	wait(yield());
+	wait(relayed);
+	reply.send(Void());
 	return Void();
 }
 
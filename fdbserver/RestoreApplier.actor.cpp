@@ -262,16 +262,22 @@ ACTOR static Future<Void> applyClearRangeMutations(Standalone<VectorRef<KeyRange
 	return Void();
 }
 
-// Get keys in incompleteStagingKeys and precompute the stagingKey which is stored in batchData->stagingKeys
-ACTOR static Future<Void> getAndComputeStagingKeys(
-    std::map<Key, std::map<Key, StagingKey>::iterator> incompleteStagingKeys,
-    double delayTime,
-    Database cx,
-    UID applierID,
-    int batchIndex,
-    ApplierBatchData::Counters* cc) {
+// Get keys in incompleteStagingKeys and precompute the stagingKey which is stored in batchData->stagingKeys.
+// incompleteStagingKeys is sorted by key, so the values are read with one range read over the keys, limited to
+// FASTRESTORE_APPLIER_FETCH_RANGE_ROWS_PER_KEY rows per key. The keys past the rows it returns, when the keys are too
+// far apart for the limit, are read one by one.
+ACTOR static Future<Void> getAndComputeStagingKeys(std::vector<std::vector<StagingKey>::iterator> incompleteStagingKeys,
+                                                   double delayTime,
+                                                   Database cx,
+                                                   UID applierID,
+                                                   int batchIndex,
+                                                   ApplierBatchData::Counters* cc) {
 	state Reference<ReadYourWritesTransaction> tr(new ReadYourWritesTransaction(cx));
-	state std::vector<Future<Optional<Value>>> fValues(incompleteStagingKeys.size(), Never());
+	state std::vector<Optional<Value>> values(incompleteStagingKeys.size());
+	state std::vector<Future<Optional<Value>>> fValues;
+	state KeyRange range(
+	    KeyRangeRef(incompleteStagingKeys.front()->key, keyAfter(incompleteStagingKeys.back()->key)));
+	state int rangeKeys = 0; // the number of keys, from the first one, whose values came from the range read
 	state int retries = 0;
 	state UID randomID = deterministicRandom()->randomUniqueID();
 
@@ -284,10 +290,10 @@ ACTOR static Future<Void> getAndComputeStagingKeys(
 		    .detail("GetKeys", incompleteStagingKeys.size())
 		    .detail("DelayTime", delayTime);
 		ASSERT(!g_network->isSimulated());
-		for (auto& key : incompleteStagingKeys) {
-			MutationRef m(MutationRef::SetValue, key.first, "0"_sr);
-			key.second->second.add(m, LogMessageVersion(1));
-			key.second->second.precomputeResult("GetAndComputeStagingKeys", applierID, batchIndex);
+		for (auto& stagingKey : incompleteStagingKeys) {
+			MutationRef m(MutationRef::SetValue, stagingKey->key, "0"_sr);
+			stagingKey->add(m, LogMessageVersion(1));
+			stagingKey->precomputeResult("GetAndComputeStagingKeys", applierID, batchIndex);
 		}
 		return Void();
 	}
@@ -300,14 +306,41 @@ ACTOR static Future<Void> getAndComputeStagingKeys(
 
 	loop {
 		try {
-			int i = 0;
 			tr->setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
 			tr->setOption(FDBTransactionOptions::LOCK_AWARE);
-			for (auto& key : incompleteStagingKeys) {
-				fValues[i++] = tr->get(key.first);
-				cc->fetchKeys += 1;
+			rangeKeys = 0;
+			if (SERVER_KNOBS->FASTRESTORE_APPLIER_FETCH_RANGE_ROWS_PER_KEY > 0) {
+				RangeResult rows = wait(tr->getRange(
+				    range,
+				    GetRangeLimits(static_cast<int>(SERVER_KNOBS->FASTRESTORE_APPLIER_FETCH_RANGE_ROWS_PER_KEY *
+				                                    incompleteStagingKeys.size()),
+				                   static_cast<int>(SERVER_KNOBS->FASTRESTORE_TXN_BATCH_MAX_BYTES))));
+				// The rows cover the range up to the last one if there are more
+				Key readEnd = range.end;
+				if (rows.more) {
+					readEnd = rows.empty() ? Key(range.begin) : keyAfter(rows.back().key);
+				}
+				int row = 0;
+				for (; rangeKeys < incompleteStagingKeys.size() && incompleteStagingKeys[rangeKeys]->key < readEnd;
+				     rangeKeys++) {
+					const KeyRef key = incompleteStagingKeys[rangeKeys]->key;
+					while (row < rows.size() && rows[row].key < key) {
+						row++;
+					}
+					if (row < rows.size() && rows[row].key == key) {
+						values[rangeKeys] = Value(rows[row].value);
+					} else {
+						values[rangeKeys] = Optional<Value>();
+					}
+				}
+				cc->fetchRangeKeys += rangeKeys;
+			}
+			fValues.clear();
+			for (int i = rangeKeys; i < incompleteStagingKeys.size(); i++) {
+				fValues.push_back(tr->get(incompleteStagingKeys[i]->key));
 			}
 			wait(waitForAll(fValues));
+			cc->fetchKeys += incompleteStagingKeys.size();
 			cc->fetchTxns += 1;
 			break;
 		} catch (Error& e) {
@@ -325,38 +358,39 @@ ACTOR static Future<Void> getAndComputeStagingKeys(
 		}
 	}
 
-	ASSERT(fValues.size() == incompleteStagingKeys.size());
-	int i = 0;
-	for (auto& key : incompleteStagingKeys) {
-		if (!fValues[i].get().present()) { // Key not exist in DB
-			// if condition: fValues[i].Valid() && fValues[i].isReady() && !fValues[i].isError() &&
+	for (int i = rangeKeys; i < incompleteStagingKeys.size(); i++) {
+		values[i] = fValues[i - rangeKeys].get();
+	}
+	for (int i = 0; i < incompleteStagingKeys.size(); i++) {
+		StagingKey& stagingKey = *incompleteStagingKeys[i];
+		if (!values[i].present()) { // Key not exist in DB
 			TraceEvent(SevDebug, "FastRestoreApplierGetAndComputeStagingKeysNoBaseValueInDB", applierID)
 			    .suppressFor(5.0)
 			    .detail("BatchIndex", batchIndex)
-			    .detail("Key", key.first)
-			    .detail("IsReady", fValues[i].isReady())
-			    .detail("PendingMutations", key.second->second.pendingMutations.size())
-			    .detail("StagingKeyType", getTypeString(key.second->second.type));
-			for (auto& vm : key.second->second.pendingMutations) {
+			    .detail("Key", stagingKey.key)
+			    .detail("FromRangeRead", i < rangeKeys)
+			    .detail("PendingMutations", stagingKey.pendingMutations.size())
+			    .detail("StagingKeyType", getTypeString(stagingKey.type));
+			for (auto& vm : stagingKey.pendingMutations) {
 				TraceEvent(SevDebug, "FastRestoreApplierGetAndComputeStagingKeysNoBaseValueInDB")
 				    .detail("PendingMutationVersion", vm.first.toString())
 				    .detail("PendingMutation", vm.second.toString());
 			}
-			key.second->second.precomputeResult("GetAndComputeStagingKeysNoBaseValueInDB", applierID, batchIndex);
+			stagingKey.precomputeResult("GetAndComputeStagingKeysNoBaseValueInDB", applierID, batchIndex);
 		} else {
 			// The key's version ideally should be the most recently committed version.
 			// But as long as it is > 1 and less than the start version of the version batch, it is the same result.
-			MutationRef m(MutationRef::SetValue, key.first, fValues[i].get().get());
-			key.second->second.add(m, LogMessageVersion(1));
-			key.second->second.precomputeResult("GetAndComputeStagingKeys", applierID, batchIndex);
+			MutationRef m(MutationRef::SetValue, stagingKey.key, values[i].get());
+			stagingKey.add(m, LogMessageVersion(1));
+			stagingKey.precomputeResult("GetAndComputeStagingKeys", applierID, batchIndex);
 		}
-		i++;
 	}
 
 	TraceEvent("FastRestoreApplierGetAndComputeStagingKeysDone", applierID)
 	    .detail("RandomUID", randomID)
 	    .detail("BatchIndex", batchIndex)
 	    .detail("GetKeys", incompleteStagingKeys.size())
+	    .detail("RangeReadKeys", rangeKeys)
 	    .detail("DelayTime", delayTime);
 
 	return Void();
@@ -366,6 +400,8 @@ ACTOR static Future<Void> precomputeMutationsResult(Reference<ApplierBatchData>
                                                     UID applierID,
                                                     int64_t batchIndex,
                                                     Database cx) {
+	batchData->buildStagingKeys();
+
 	// Apply range mutations (i.e., clearRange) to database cx
 	TraceEvent("FastRestoreApplerPhasePrecomputeMutationsResultStart", applierID)
 	    .detail("BatchIndex", batchIndex)
@@ -405,19 +441,19 @@ ACTOR static Future<Void> precomputeMutationsResult(Reference<ApplierBatchData>
 	    .detail("FutureClearRanges", fClearRanges.size());
 	for (auto& rangeMutation : batchData->stagingKeyRanges) {
 		ASSERT(rangeMutation.mutation.param1 <= rangeMutation.mutation.param2);
-		std::map<Key, StagingKey>::iterator lb = batchData->stagingKeys.lower_bound(rangeMutation.mutation.param1);
-		std::map<Key, StagingKey>::iterator ub = batchData->stagingKeys.lower_bound(rangeMutation.mutation.param2);
+		std::vector<StagingKey>::iterator lb = batchData->lowerBoundStagingKey(rangeMutation.mutation.param1);
+		std::vector<StagingKey>::iterator ub = batchData->lowerBoundStagingKey(rangeMutation.mutation.param2);
 		while (lb != ub) {
-			if (lb->first >= rangeMutation.mutation.param2) {
+			if (lb->key >= rangeMutation.mutation.param2) {
 				TraceEvent(SevError, "FastRestoreApplerPhasePrecomputeMutationsResultIncorrectUpperBound")
-				    .detail("Key", lb->first)
+				    .detail("Key", lb->key)
 				    .detail("ClearRangeUpperBound", rangeMutation.mutation.param2)
-				    .detail("UsedUpperBound", ub->first);
+				    .detail("UsedUpperBound", ub->key);
 			}
 			// We make the beginKey = endKey for the ClearRange on purpose so that
 			// we can sanity check ClearRange mutation when we apply it to DB.
-			MutationRef clearKey(MutationRef::ClearRange, lb->first, lb->first);
-			lb->second.add(clearKey, rangeMutation.version);
+			MutationRef clearKey(MutationRef::ClearRange, lb->key, lb->key);
+			lb->add(clearKey, rangeMutation.version);
 			lb++;
 		}
 	}
@@ -434,15 +470,15 @@ ACTOR static Future<Void> precomputeMutationsResult(Reference<ApplierBatchData>
 
 	// Get keys in stagingKeys which does not have a baseline key by reading database cx, and precompute the key's value
 	std::vector<Future<Void>> fGetAndComputeKeys;
-	std::map<Key, std::map<Key, StagingKey>::iterator> incompleteStagingKeys;
-	std::map<Key, StagingKey>::iterator stagingKeyIter = batchData->stagingKeys.begin();
+	std::vector<std::vector<StagingKey>::iterator> incompleteStagingKeys;
+	std::vector<StagingKey>::iterator stagingKeyIter = batchData->stagingKeys.begin();
 	int numKeysInBatch = 0;
 	int numGetTxns = 0;
 	{
 		double delayTime = 0; // Start transactions at different time to avoid overwhelming FDB.
 		for (; stagingKeyIter != batchData->stagingKeys.end(); stagingKeyIter++) {
-			if (!stagingKeyIter->second.hasBaseValue()) {
-				incompleteStagingKeys.emplace(stagingKeyIter->first, stagingKeyIter);
+			if (!stagingKeyIter->hasBaseValue()) {
+				incompleteStagingKeys.push_back(stagingKeyIter);
 				numKeysInBatch++;
 			}
 			if (numKeysInBatch == SERVER_KNOBS->FASTRESTORE_APPLIER_FETCH_KEYS_SIZE) {
@@ -469,8 +505,8 @@ ACTOR static Future<Void> precomputeMutationsResult(Reference<ApplierBatchData>
 	// Pre-compute pendingMutations to other keys in stagingKeys that has base value
 	for (stagingKeyIter = batchData->stagingKeys.begin(); stagingKeyIter != batchData->stagingKeys.end();
 	     stagingKeyIter++) {
-		if (stagingKeyIter->second.hasBaseValue()) {
-			stagingKeyIter->second.precomputeResult("HasBaseValue", applierID, batchIndex);
+		if (stagingKeyIter->hasBaseValue()) {
+			stagingKeyIter->precomputeResult("HasBaseValue", applierID, batchIndex);
 		}
 	}
 
@@ -505,8 +541,8 @@ ACTOR static Future<Void> shouldReleaseTransaction(double* targetMB,
 }
 
 // Apply mutations in batchData->stagingKeys [begin, end).
-ACTOR static Future<Void> applyStagingKeysBatch(std::map<Key, StagingKey>::iterator begin,
-                                                std::map<Key, StagingKey>::iterator end,
+ACTOR static Future<Void> applyStagingKeysBatch(std::vector<StagingKey>::iterator begin,
+                                                std::vector<StagingKey>::iterator end,
                                                 Database cx,
                                                 UID applierID,
                                                 ApplierBatchData::Counters* cc,
@@ -515,7 +551,7 @@ ACTOR static Future<Void> applyStagingKeysBatch(std::map<Key, StagingKey>::itera
                                                 double* targetMB,
                                                 AsyncTrigger* releaseTxnTrigger) {
 	if (SERVER_KNOBS->FASTRESTORE_NOT_WRITE_DB) {
-		TraceEvent("FastRestoreApplierPhaseApplyStagingKeysBatchSkipped", applierID).detail("Begin", begin->first);
+		TraceEvent("FastRestoreApplierPhaseApplyStagingKeysBatchSkipped", applierID).detail("Begin", begin->key);
 		ASSERT(!g_network->isSimulated());
 		return Void();
 	}
@@ -524,57 +560,57 @@ ACTOR static Future<Void> applyStagingKeysBatch(std::map<Key, StagingKey>::itera
 	state Reference<ReadYourWritesTransaction> tr(new ReadYourWritesTransaction(cx));
 	state int sets = 0;
 	state int clears = 0;
-	state Key endKey = begin->first;
+	state Key endKey = begin->key;
 	state double txnSize = 0;
 	state double txnSizeUsed = 0; // txn size accounted in applyingDataBytes
-	TraceEvent(SevFRDebugInfo, "FastRestoreApplierPhaseApplyStagingKeysBatch", applierID).detail("Begin", begin->first);
+	TraceEvent(SevFRDebugInfo, "FastRestoreApplierPhaseApplyStagingKeysBatch", applierID).detail("Begin", begin->key);
 	loop {
 		try {
 			txnSize = 0;
 			txnSizeUsed = 0;
 			tr->setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
 			tr->setOption(FDBTransactionOptions::LOCK_AWARE);
-			std::map<Key, StagingKey>::iterator iter = begin;
+			std::vector<StagingKey>::iterator iter = begin;
 			while (iter != end) {
-				if (iter->second.type == MutationRef::SetValue) {
-					tr->set(iter->second.key, iter->second.val);
-					txnSize += iter->second.totalSize();
+				if (iter->type == MutationRef::SetValue) {
+					tr->set(iter->key, iter->val);
+					txnSize += iter->totalSize();
 					cc->appliedMutations += 1;
 					TraceEvent(SevFRMutationInfo, "FastRestoreApplierPhaseApplyStagingKeysBatch", applierID)
-					    .detail("SetKey", iter->second.key);
+					    .detail("SetKey", iter->key);
 					sets++;
-				} else if (iter->second.type == MutationRef::ClearRange) {
-					if (iter->second.key != iter->second.val) {
+				} else if (iter->type == MutationRef::ClearRange) {
+					if (iter->key != iter->val) {
 						TraceEvent(SevError, "FastRestoreApplierPhaseApplyStagingKeysBatchClearTooMuchData", applierID)
-						    .detail("KeyBegin", iter->second.key)
-						    .detail("KeyEnd", iter->second.val)
-						    .detail("Version", iter->second.version.version)
-						    .detail("SubVersion", iter->second.version.sub);
+						    .detail("KeyBegin", iter->key)
+						    .detail("KeyEnd", iter->val)
+						    .detail("Version", iter->version.version)
+						    .detail("SubVersion", iter->version.sub);
 					}
-					tr->clear(singleKeyRange(iter->second.key));
-					txnSize += iter->second.totalSize();
+					tr->clear(singleKeyRange(iter->key));
+					txnSize += iter->totalSize();
 					cc->appliedMutations += 1;
 					TraceEvent(SevFRMutationInfo, "FastRestoreApplierPhaseApplyStagingKeysBatch", applierID)
-					    .detail("ClearKey", iter->second.key);
+					    .detail("ClearKey", iter->key);
 					clears++;
 				} else {
 					ASSERT(false);
 				}
-				endKey = iter != end ? iter->first : endKey;
+				endKey = iter != end ? iter->key : endKey;
 				iter++;
 				if (sets > 10000000 || clears > 10000000) {
 					TraceEvent(SevError, "FastRestoreApplierPhaseApplyStagingKeysBatchInfiniteLoop", applierID)
-					    .detail("Begin", begin->first)
+					    .detail("Begin", begin->key)
 					    .detail("Sets", sets)
 					    .detail("Clears", clears);
 				}
 			}
 			TraceEvent(SevFRDebugInfo, "FastRestoreApplierPhaseApplyStagingKeysBatchPrecommit", applierID)
-			    .detail("Begin", begin->first)
+			    .detail("Begin", begin->key)
 			    .detail("End", endKey)
 			    .detail("Sets", sets)
 			    .detail("Clears", clears);
-			tr->addWriteConflictRange(KeyRangeRef(begin->first, keyAfter(endKey))); // Reduce resolver load
+			tr->addWriteConflictRange(KeyRangeRef(begin->key, keyAfter(endKey))); // Reduce resolver load
 			txnSizeUsed = txnSize;
 			*applyingDataBytes += txnSizeUsed; // Must account for applying bytes before wait for write traffic control
 			wait(tr->commit());
@@ -600,8 +636,8 @@ ACTOR static Future<Void> applyStagingKeys(Reference<ApplierBatchData> batchData
                                            UID applierID,
                                            int64_t batchIndex,
                                            Database cx) {
-	std::map<Key, StagingKey>::iterator begin = batchData->stagingKeys.begin();
-	std::map<Key, StagingKey>::iterator cur = begin;
+	std::vector<StagingKey>::iterator begin = batchData->stagingKeys.begin();
+	std::vector<StagingKey>::iterator cur = begin;
 	state int txnBatches = 0;
 	double txnSize = 0;
 	std::vector<Future<Void>> fBatches;
@@ -610,7 +646,7 @@ ACTOR static Future<Void> applyStagingKeys(Reference<ApplierBatchData> batchData
 	    .detail("StagingKeys", batchData->stagingKeys.size());
 	batchData->totalBytesToWrite = 0;
 	while (cur != batchData->stagingKeys.end()) {
-		txnSize += cur->second.totalSize(); // should be consistent with receivedBytes accounting method
+		txnSize += cur->totalSize(); // should be consistent with receivedBytes accounting method
 		if (txnSize > SERVER_KNOBS->FASTRESTORE_TXN_BATCH_MAX_BYTES) {
 			fBatches.push_back(applyStagingKeysBatch(begin,
 			                                         cur,
@@ -25,6 +25,7 @@
 
 // Backup agent header
 #include "fdbclient/BackupAgent.actor.h"
+#include "fdbclient/BackupBlockCompression.h"
 #include "fdbclient/BackupContainer.h"
 #include "fdbclient/KeyBackedTypes.actor.h"
 #include "fdbclient/ManagementAPI.actor.h"
@@ -326,9 +327,15 @@ ACTOR Future<Standalone<VectorRef<KeyValueRef>>> decodeLogFileBlock(Reference<IA
 	state StringRefReader reader(buf, restore_corrupted_data());
 
 	try {
-		// Read header, currently only decoding version BACKUP_AGENT_MLOG_VERSION
-		if (reader.consume<int32_t>() != BACKUP_AGENT_MLOG_VERSION)
+		// Read header, currently only decoding version BACKUP_AGENT_MLOG_VERSION or
+		// BACKUP_AGENT_COMPRESSED_MLOG_VERSION
+		int32_t fileVersion = reader.consume<int32_t>();
+		if (fileVersion == BACKUP_AGENT_COMPRESSED_MLOG_VERSION) {
+			reader =
+			    StringRefReader(decompressBackupBlock(reader.remainder(), results.arena()), restore_corrupted_data());
+		} else if (fileVersion != BACKUP_AGENT_MLOG_VERSION) {
 			throw restore_unsupported_file_version();
+		}
 
 		// Read k/v pairs.  Block ends either at end of last value exactly or with 0xFF as first key len byte.
 		while (1) {
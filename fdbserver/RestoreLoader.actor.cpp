@@ -24,6 +24,7 @@
 #include "fdbclient/BlobCipher.h"
 #include "fdbclient/CommitProxyInterface.h"
 #include "flow/UnitTest.h"
+#include "fdbclient/BackupBlockCompression.h"
 #include "fdbclient/BackupContainer.h"
 #include "fdbclient/BackupAgent.actor.h"
 #include "fdbclient/GetEncryptCipherKeys.h"
@@ -411,8 +412,12 @@ ACTOR static Future<Void> _parsePartitionedLogFileOnLoader(
 	state StringRefReader reader(buf, restore_corrupted_data());
 	try {
 		// Read block header
-		if (reader.consume<int32_t>() != PARTITIONED_MLOG_VERSION)
+		int32_t fileVersion = reader.consume<int32_t>();
+		if (fileVersion == PARTITIONED_COMPRESSED_MLOG_VERSION) {
+			reader = StringRefReader(decompressBackupBlock(reader.remainder(), buf.arena()), restore_corrupted_data());
+		} else if (fileVersion != PARTITIONED_MLOG_VERSION) {
 			throw restore_unsupported_file_version();
+		}
 
 		state VersionedMutationsMap* kvOps = &kvOpsIter->second;
 		while (1) {
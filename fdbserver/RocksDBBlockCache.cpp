@@ -0,0 +1,50 @@
+/*
+ * RocksDBBlockCache.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbserver/RocksDBBlockCache.h"
+
+#ifdef WITH_ROCKSDB
+#include <rocksdb/secondary_cache.h>
+
+#include "fdbserver/Knobs.h"
+
+std::shared_ptr<rocksdb::Cache> newRocksDBBlockCache(size_t capacity, double highPriPoolRatio) {
+	std::shared_ptr<rocksdb::SecondaryCache> secondaryCache;
+	if (SERVER_KNOBS->ROCKSDB_COMPRESSED_SECONDARY_CACHE_SIZE > 0) {
+		rocksdb::CompressedSecondaryCacheOptions options;
+		options.capacity = SERVER_KNOBS->ROCKSDB_COMPRESSED_SECONDARY_CACHE_SIZE;
+		secondaryCache = rocksdb::NewCompressedSecondaryCache(options);
+	}
+
+	if (SERVER_KNOBS->ROCKSDB_BLOCK_CACHE_HYPER_CLOCK) {
+		// An estimated entry charge of 0 lets the cache grow its table as it fills instead of sizing it up front
+		rocksdb::HyperClockCacheOptions options(capacity, 0 /* estimated_entry_charge */);
+		options.secondary_cache = secondaryCache;
+		return options.MakeSharedCache();
+	}
+
+	rocksdb::LRUCacheOptions options;
+	options.capacity = capacity;
+	options.high_pri_pool_ratio = highPriPoolRatio;
+	options.secondary_cache = secondaryCache;
+	return rocksdb::NewLRUCache(options);
+}
+
+#endif // WITH_ROCKSDB
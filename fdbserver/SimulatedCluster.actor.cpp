@@ -1769,6 +1769,10 @@ void redwoodStorageEngineConfig(SimulationConfig* simCfg) {
 	CODE_PROBE(true, "Simulated cluster using redwood storage engine");
 	// The experimental suffix is still supported so test it randomly
 	simCfg->set_config(BUGGIFY ? "ssd-redwood-1" : "ssd-redwood-1-experimental");
+	if (deterministicRandom()->coinflip()) {
+		CODE_PROBE(true, "Simulated cluster spilling TLog data to redwood");
+		simCfg->set_config(format("log_engine:=%d", KeyValueStoreType::SSD_REDWOOD_V1));
+	}
 }
 
 void rocksdbStorageEngineConfig(SimulationConfig* simCfg) {
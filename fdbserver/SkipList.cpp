@@ -22,17 +22,29 @@
 #include <memory.h>
 #include <stdio.h>
 #include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <numeric>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "flow/Platform.h"
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include "flow/sse2neon.h"
+#endif
 #include "fdbrpc/fdbrpc.h"
 #include "fdbrpc/PerfMetric.h"
 #include "fdbclient/FDBTypes.h"
 #include "fdbclient/KeyRangeMap.h"
 #include "fdbclient/SystemData.h"
 #include "fdbserver/ConflictSet.h"
+#include "fdbserver/Knobs.h"
+#include "fdbserver/art.h"
+#include "flow/UnitTest.h"
 
 static std::vector<PerfDoubleCounter*> skc;
 
@@ -47,17 +59,44 @@ PerfDoubleCounter g_buildTest("Build", skc), g_add("Add", skc), g_detectConflict
     g_combine("D.Combine", skc), g_checkRead("D.CheckRead", skc), g_checkBatch("D.CheckIntraBatch", skc),
     g_merge("D.MergeWrite", skc), g_removeBefore("D.RemoveBefore", skc);
 
+// Returns the number of leading bytes that a and b, which both have at least len bytes, have in common. Resolver keys are
+// short and sorted batches share long prefixes, so comparing 16 (or 32) bytes per step inline beats calling memcmp.
+static force_inline int keyCommonPrefixLength(const uint8_t* a, const uint8_t* b, int len) {
+	int i = 0;
+#if defined(__AVX2__)
+	for (; i + 32 <= len; i += 32) {
+		const uint32_t equal = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + i)),
+		                                                                _mm256_loadu_si256((const __m256i*)(b + i))));
+		if (equal != 0xffffffff) {
+			return i + ctz(~equal);
+		}
+	}
+#endif
+#if defined(__x86_64__) || defined(__aarch64__)
+	for (; i + 16 <= len; i += 16) {
+		const uint32_t equal = _mm_movemask_epi8(
+		    _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i))));
+		if (equal != 0xffff) {
+			return i + ctz(~equal);
+		}
+	}
+#endif
+	return i + commonPrefixLength(a + i, b + i, len - i);
+}
+
+// Three way comparison of a and b. The first skip bytes of a and b are known to be equal, and skip must not exceed
+// either length.
+static force_inline int compareKeys(const uint8_t* a, int aLen, const uint8_t* b, int bLen, int skip = 0) {
+	const int len = std::min(aLen, bLen);
+	const int prefix = skip + keyCommonPrefixLength(a + skip, b + skip, len - skip);
+	if (prefix < len) {
+		return a[prefix] < b[prefix] ? -1 : +1;
+	}
+	return (aLen > bLen) - (aLen < bLen);
+}
+
 static force_inline int compare(const StringRef& a, const StringRef& b) {
-	int c = memcmp(a.begin(), b.begin(), std::min(a.size(), b.size()));
-	if (c < 0)
-		return -1;
-	if (c > 0)
-		return +1;
-	if (a.size() < b.size())
-		return -1;
-	if (a.size() == b.size())
-		return 0;
-	return +1;
+	return compareKeys(a.begin(), a.size(), b.begin(), b.size());
 }
 
 struct ReadConflictRange {
@@ -120,24 +159,22 @@ force_inline bool getCharacter(const KeyInfo& ki, int character, int& outputChar
 	return true;
 }
 
-bool operator<(const KeyInfo& lhs, const KeyInfo& rhs) {
-	int i = std::min(lhs.key.size(), rhs.key.size());
-	int c = memcmp(lhs.key.begin(), rhs.key.begin(), i);
+// Orders lhs and rhs, whose keys are known to share their first skip bytes
+force_inline bool lessSkippingPrefix(const KeyInfo& lhs, const KeyInfo& rhs, int skip) {
+	skip = std::min(skip, std::min(lhs.key.size(), rhs.key.size()));
+	// Always sort shorter keys before longer keys.
+	int c = compareKeys(lhs.key.begin(), lhs.key.size(), rhs.key.begin(), rhs.key.size(), skip);
 	if (c != 0)
 		return c < 0;
 
-	// Always sort shorter keys before longer keys.
-	if (lhs.key.size() < rhs.key.size()) {
-		return true;
-	}
-	if (lhs.key.size() > rhs.key.size()) {
-		return false;
-	}
-
-	// When the keys are the same length, use the extra ordering constraint.
+	// When the keys are the same, use the extra ordering constraint.
 	return extra_ordering(lhs) < extra_ordering(rhs);
 }
 
+bool operator<(const KeyInfo& lhs, const KeyInfo& rhs) {
+	return lessSkippingPrefix(lhs, rhs, 0);
+}
+
 bool operator==(const KeyInfo& lhs, const KeyInfo& rhs) {
 	return !(lhs < rhs || rhs < lhs);
 }
@@ -180,7 +217,12 @@ void sortPoints(std::vector<KeyInfo>& points) {
 
 		if (st.size < 10) {
 			// smallSort(points, st.begin, st.size);
-			std::sort(points.begin() + st.begin, points.begin() + st.begin + st.size);
+			// Every key in the task agrees on its first st.character bytes, so the comparisons can skip them
+			std::sort(points.begin() + st.begin,
+			          points.begin() + st.begin + st.size,
+			          [skip = st.character](const KeyInfo& lhs, const KeyInfo& rhs) {
+				          return lessSkippingPrefix(lhs, rhs, skip);
+			          });
 			continue;
 		}
 
@@ -309,12 +351,7 @@ private:
 	};
 
 	static force_inline bool less(const uint8_t* a, int aLen, const uint8_t* b, int bLen) {
-		int c = memcmp(a, b, std::min(aLen, bLen));
-		if (c < 0)
-			return true;
-		if (c > 0)
-			return false;
-		return aLen < bLen;
+		return compareKeys(a, aLen, b, bLen) < 0;
 	}
 
 	Node* header;
@@ -440,21 +477,33 @@ public:
 		}
 	}
 
-	void detectConflicts(ReadConflictRange* ranges, int count, bool* transactionConflictStatus) {
+	// Checks each of the given read conflict ranges against the version history. If perRangeStatus is false, a
+	// conflict marks conflictStatus[range.transaction] and records the conflicting key range (if requested);
+	// otherwise only conflictStatus[i] is set for the i-th range, which lets disjoint slices of ranges be checked
+	// concurrently since the SkipList is only read here.
+	void detectConflicts(ReadConflictRange* ranges, int count, bool* conflictStatus, bool perRangeStatus = false) {
 		const int M = 16;
 		int nextJob[M];
 		CheckMax inProgress[M];
 		if (!count)
 			return;
 
+		auto initJob = [&](CheckMax& job, int r) {
+			if (perRangeStatus) {
+				job.init(ranges[r], header, &conflictStatus[r], ranges[r].indexInTx, nullptr, nullptr);
+			} else {
+				job.init(ranges[r],
+				         header,
+				         &conflictStatus[ranges[r].transaction],
+				         ranges[r].indexInTx,
+				         ranges[r].conflictingKeyRange,
+				         ranges[r].cKRArena);
+			}
+		};
+
 		int started = std::min(M, count);
 		for (int i = 0; i < started; i++) {
-			inProgress[i].init(ranges[i],
-			                   header,
-			                   transactionConflictStatus,
-			                   ranges[i].indexInTx,
-			                   ranges[i].conflictingKeyRange,
-			                   ranges[i].cKRArena);
+			initJob(inProgress[i], i);
 			nextJob[i] = i + 1;
 		}
 		nextJob[started - 1] = 0;
@@ -470,13 +519,7 @@ public:
 					nextJob[prevJob] = nextJob[job];
 					job = prevJob;
 				} else {
-					int temp = started++;
-					inProgress[job].init(ranges[temp],
-					                     header,
-					                     transactionConflictStatus,
-					                     ranges[temp].indexInTx,
-					                     ranges[temp].conflictingKeyRange,
-					                     ranges[temp].cKRArena);
+					initJob(inProgress[job], started++);
 				}
 			}
 			prevJob = job;
@@ -669,7 +712,7 @@ private:
 
 		void init(const ReadConflictRange& r,
 		          Node* header,
-		          bool* tCS,
+		          bool* result,
 		          int indexInTx,
 		          VectorRef<int>* cKR,
 		          Arena* cKRArena) {
@@ -678,7 +721,7 @@ private:
 			this->version = r.version;
 			this->indexInTx = indexInTx;
 			this->cKRArena = cKRArena;
-			result = &tCS[r.transaction];
+			this->result = result;
 			conflictingKeyRange = cKR;
 			this->state = 0;
 		}
@@ -782,20 +825,275 @@ private:
 	}
 };
 
+// A version history with the same semantics as SkipList, backed by the adaptive radix tree from art.h. It is used
+// instead of the SkipList when RESOLVER_USE_ART_CONFLICT_SET is set. Each leaf is a range boundary whose value is the
+// version of the range [leaf, next leaf). Keys sharing long prefixes (e.g. tenant prefixes) share inner nodes, so a
+// lookup touches far fewer cache lines than the SkipList's pointer chasing, and a range check walks the ordered leaves.
+// The art_tree allocates from an Arena and never frees erased nodes, so the tree is rebuilt into a fresh arena once
+// more boundaries have been erased than remain.
+//
+// Note that art_tree::lower_bound() uses a static stack, so this history must only be used from one thread.
+class ARTVersionHistory : NonCopyable {
+public:
+	explicit ARTVersionHistory(Version version = 0) { reset(version); }
+
+	void reset(Version version) {
+		arena = Arena();
+		tree = new (arena) art_tree(arena);
+		KeyRef empty;
+		first = last = tree->insert(empty, toValue(version));
+		liveCount = 1;
+		erasedCount = 0;
+	}
+
+	int count() const { return liveCount; }
+
+	void detectConflicts(ReadConflictRange* ranges, int count, bool* transactionConflictStatus) {
+		for (int i = 0; i < count; i++) {
+			const ReadConflictRange& range = ranges[i];
+			// Once a transaction conflicts its remaining ranges only matter if it wants the conflicting keys
+			if (transactionConflictStatus[range.transaction] && range.conflictingKeyRange == nullptr) {
+				continue;
+			}
+			if (hasVersionAfter(range.begin, range.end, range.version)) {
+				transactionConflictStatus[range.transaction] = true;
+				if (range.conflictingKeyRange != nullptr) {
+					range.conflictingKeyRange->push_back(*range.cKRArena, range.indexInTx);
+				}
+			}
+		}
+	}
+
+	// pre: the ranges are sorted and do not overlap
+	void addConflictRanges(std::vector<std::pair<StringRef, StringRef>>::iterator begin,
+	                       std::vector<std::pair<StringRef, StringRef>>::iterator end,
+	                       Version version) {
+		for (auto r = begin; r != end; ++r) {
+			const StringRef& rangeBegin = r->first;
+			const StringRef& rangeEnd = r->second;
+			if (!(rangeBegin < rangeEnd)) {
+				continue;
+			}
+
+			// Keys at and after rangeEnd keep the version they had before this range was written
+			art_iterator endFloor = floor(rangeEnd);
+			if (endFloor.key() != rangeEnd) {
+				insert(rangeEnd, versionOf(endFloor));
+			}
+
+			art_iterator it = tree->lower_bound(rangeBegin);
+			if (it.key() == rangeBegin) {
+				*it.value_ptr() = toValue(version);
+				++it;
+			} else {
+				insert(rangeBegin, version);
+			}
+			while (it.key() < rangeEnd) {
+				art_iterator next = it;
+				++next;
+				erase(it);
+				it = next;
+			}
+		}
+	}
+
+	// Visits up to nodeCount boundaries starting at removalKey and removes those which, like the range before them,
+	// are older than oldestVersion. removalKey is updated to where the next call should resume.
+	void removeBefore(Version oldestVersion, Key& removalKey, int nodeCount) {
+		art_iterator it = tree->lower_bound(removalKey);
+		bool wasAbove = true;
+		while (nodeCount-- && it != art_iterator()) {
+			art_iterator next = it;
+			++next;
+			bool isAbove = versionOf(it) >= oldestVersion;
+			if (!isAbove && !wasAbove) {
+				erase(it);
+			}
+			wasAbove = isAbove;
+			it = next;
+		}
+		removalKey = it == art_iterator() ? Key() : Key(it.key());
+
+		if (erasedCount > std::max(liveCount, 10000)) {
+			rebuild();
+		}
+	}
+
+private:
+	static_assert(sizeof(void*) >= sizeof(Version), "Versions are stored in art_leaf value pointers");
+	static void* toValue(Version v) { return reinterpret_cast<void*>(static_cast<intptr_t>(v)); }
+	static Version versionOf(const art_iterator& it) { return static_cast<Version>(reinterpret_cast<intptr_t>(it.value())); }
+
+	// Returns the last boundary <= key, which always exists because of the boundary at the empty key.
+	art_iterator floor(const StringRef& key) {
+		art_iterator it = tree->lower_bound(key);
+		if (it == art_iterator()) {
+			return last;
+		}
+		if (it.key() != key) {
+			--it;
+		}
+		return it;
+	}
+
+	// Returns true if any key in [begin, end) was written after version.
+	bool hasVersionAfter(const StringRef& begin, const StringRef& end, Version version) {
+		art_iterator it = floor(begin);
+		if (versionOf(it) > version) {
+			return true;
+		}
+		for (++it; it != art_iterator() && it.key() < end; ++it) {
+			if (versionOf(it) > version) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void insert(StringRef key, Version version) {
+		art_iterator it = tree->insert(key, toValue(version));
+		art_iterator next = it;
+		++next;
+		if (next == art_iterator()) {
+			last = it;
+		}
+		liveCount++;
+	}
+
+	// pre: it is not the boundary at the empty key
+	void erase(const art_iterator& it) {
+		if (it == last) {
+			--last;
+		}
+		tree->erase(it);
+		liveCount--;
+		erasedCount++;
+	}
+
+	void rebuild() {
+		// Keep the old tree's memory alive until all of its boundaries have been copied
+		Arena oldArena = arena;
+		art_iterator it = first;
+
+		arena = Arena();
+		tree = new (arena) art_tree(arena);
+		liveCount = 0;
+		erasedCount = 0;
+		for (; it != art_iterator(); ++it) {
+			KeyRef key = it.key();
+			last = tree->insert(key, it.value());
+			if (liveCount++ == 0) {
+				first = last;
+			}
+		}
+	}
+
+	Arena arena;
+	art_tree* tree;
+	art_iterator first, last;
+	int liveCount;
+	int erasedCount;
+};
+
+// A small fork-join pool of threads used by ConflictBatch::checkReadConflictRanges(). The calling thread takes part
+// in the work, and run() only returns once every part has finished, so workers never outlive the data they read.
+class ConflictCheckThreadPool : NonCopyable {
+public:
+	explicit ConflictCheckThreadPool(int workerCount) {
+		for (int i = 0; i < workerCount; i++) {
+			std::thread([this]() { workerLoop(); }).detach();
+		}
+	}
+
+	// Calls work(part) for every part in [0, parts) and waits for all of them to complete.
+	void run(int parts, const std::function<void(int)>& work) {
+		std::unique_lock<std::mutex> lock(mutex);
+		this->work = &work;
+		nextPart = 0;
+		totalParts = parts;
+		pendingParts = parts;
+		generation++;
+		workReady.notify_all();
+
+		runParts(lock);
+		workDone.wait(lock, [this]() { return pendingParts == 0; });
+		this->work = nullptr;
+	}
+
+private:
+	// pre: lock is held
+	void runParts(std::unique_lock<std::mutex>& lock) {
+		while (nextPart < totalParts) {
+			const int part = nextPart++;
+			const std::function<void(int)>* w = work;
+			lock.unlock();
+			(*w)(part);
+			lock.lock();
+			if (--pendingParts == 0) {
+				workDone.notify_all();
+			}
+		}
+	}
+
+	void workerLoop() {
+		uint64_t seenGeneration = 0;
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			workReady.wait(lock, [&]() { return generation != seenGeneration; });
+			seenGeneration = generation;
+			runParts(lock);
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable workReady, workDone;
+	const std::function<void(int)>* work = nullptr;
+	uint64_t generation = 0;
+	int nextPart = 0, totalParts = 0, pendingParts = 0;
+};
+
+// The pool is sized by the knob value seen on first use and intentionally never destroyed.
+static ConflictCheckThreadPool* getConflictCheckThreadPool(int threads) {
+	static ConflictCheckThreadPool* pool = new ConflictCheckThreadPool(threads - 1);
+	return pool;
+}
+
 struct ConflictSet {
-	ConflictSet() : removalKey(makeString(0)), oldestVersion(0) {}
+	ConflictSet(bool useART, int checkThreads, int parallelCheckMinRanges)
+	  : removalKey(makeString(0)), oldestVersion(0), checkThreads(checkThreads),
+	    parallelCheckMinRanges(parallelCheckMinRanges) {
+		if (useART) {
+			artVersionHistory = std::make_unique<ARTVersionHistory>();
+		}
+	}
 	~ConflictSet() {}
 
+	int historySize() const { return artVersionHistory ? artVersionHistory->count() : versionHistory.count(); }
+
+	// Only one of the version histories is in use; artVersionHistory is set when the ART implementation is selected.
 	SkipList versionHistory;
+	std::unique_ptr<ARTVersionHistory> artVersionHistory;
 	Key removalKey;
 	Version oldestVersion;
+	// Read conflict checks are split across checkThreads threads once a batch has parallelCheckMinRanges ranges
+	int checkThreads;
+	int parallelCheckMinRanges;
 };
 
 ConflictSet* newConflictSet() {
-	return new ConflictSet;
+	return newConflictSet(SERVER_KNOBS->RESOLVER_USE_ART_CONFLICT_SET,
+	                      SERVER_KNOBS->RESOLVER_CONFLICT_CHECK_THREADS,
+	                      SERVER_KNOBS->RESOLVER_PARALLEL_CHECK_MIN_RANGES);
+}
+ConflictSet* newConflictSet(bool useART, int checkThreads, int parallelCheckMinRanges) {
+	return new ConflictSet(useART, checkThreads, parallelCheckMinRanges);
 }
 void clearConflictSet(ConflictSet* cs, Version v) {
-	SkipList(v).swap(cs->versionHistory);
+	if (cs->artVersionHistory) {
+		cs->artVersionHistory->reset(v);
+	} else {
+		SkipList(v).swap(cs->versionHistory);
+	}
 }
 void destroyConflictSet(ConflictSet* cs) {
 	delete cs;
@@ -969,7 +1267,11 @@ void ConflictBatch::detectConflicts(Version now,
 	delete[] transactionConflictStatus;
 
 	t = timer();
-	if (newOldestVersion > cs->oldestVersion) {
+	if (newOldestVersion > cs->oldestVersion && cs->artVersionHistory) {
+		cs->oldestVersion = newOldestVersion;
+		cs->artVersionHistory->removeBefore(
+		    cs->oldestVersion, cs->removalKey, combinedWriteConflictRanges.size() * 3 + 10);
+	} else if (newOldestVersion > cs->oldestVersion) {
 		cs->oldestVersion = newOldestVersion;
 		SkipList::Finger finger;
 		int temp;
@@ -984,8 +1286,47 @@ void ConflictBatch::checkReadConflictRanges() {
 	if (combinedReadConflictRanges.empty())
 		return;
 
-	cs->versionHistory.detectConflicts(
-	    &combinedReadConflictRanges[0], combinedReadConflictRanges.size(), transactionConflictStatus);
+	const int count = combinedReadConflictRanges.size();
+	if (cs->artVersionHistory) {
+		cs->artVersionHistory->detectConflicts(&combinedReadConflictRanges[0], count, transactionConflictStatus);
+		return;
+	}
+
+	const int threads = cs->checkThreads;
+	if (threads <= 1 || count < cs->parallelCheckMinRanges) {
+		cs->versionHistory.detectConflicts(&combinedReadConflictRanges[0], count, transactionConflictStatus);
+		return;
+	}
+
+	// Each part checks a contiguous slice of the read ranges against the (unmodified) version history and records
+	// its results per range; the results are merged into the transaction status on this thread afterwards.
+	const int parts = std::min(threads, count);
+	std::unique_ptr<bool[]> rangeConflict(new bool[count]());
+	std::function<void(int)> checkPart = [&](int part) {
+		const int begin = (int64_t)count * part / parts;
+		const int end = (int64_t)count * (part + 1) / parts;
+		cs->versionHistory.detectConflicts(
+		    &combinedReadConflictRanges[begin], end - begin, &rangeConflict[begin], /*perRangeStatus=*/true);
+	};
+
+	if (g_network->isSimulated()) {
+		// Keep simulation single threaded, but still exercise the partitioning and merging
+		for (int part = 0; part < parts; part++) {
+			checkPart(part);
+		}
+	} else {
+		getConflictCheckThreadPool(threads)->run(parts, checkPart);
+	}
+
+	for (int i = 0; i < count; i++) {
+		if (rangeConflict[i]) {
+			const ReadConflictRange& range = combinedReadConflictRanges[i];
+			transactionConflictStatus[range.transaction] = true;
+			if (range.conflictingKeyRange != nullptr) {
+				range.conflictingKeyRange->push_back(*range.cKRArena, range.indexInTx);
+			}
+		}
+	}
 }
 
 void ConflictBatch::addConflictRanges(Version now,
@@ -1015,6 +1356,12 @@ void ConflictBatch::mergeWriteConflictRanges(Version now) {
 	if (combinedWriteConflictRanges.empty())
 		return;
 
+	if (cs->artVersionHistory) {
+		cs->artVersionHistory->addConflictRanges(
+		    combinedWriteConflictRanges.begin(), combinedWriteConflictRanges.end(), now);
+		return;
+	}
+
 	addConflictRanges(now, combinedWriteConflictRanges.begin(), combinedWriteConflictRanges.end(), &cs->versionHistory);
 }
 
@@ -1198,5 +1545,127 @@ void skipListTest() {
 		printf("%20s: %s\n", counter->getMetric().name().c_str(), counter->getMetric().formatted().c_str());
 	}
 
-	printf("%d entries in version history\n", cs->versionHistory.count());
+	printf("%d entries in version history\n", cs->historySize());
+}
+
+namespace {
+StringRef randomConflictKey(Arena& arena) {
+	// A few long shared prefixes with short, colliding suffixes
+	std::string key = format("tenant/%04d/", deterministicRandom()->randomInt(0, 3));
+	int suffixLength = deterministicRandom()->randomInt(0, 4);
+	for (int i = 0; i < suffixLength; i++) {
+		key.push_back('a' + deterministicRandom()->randomInt(0, 4));
+	}
+	return StringRef(arena, key);
+}
+
+KeyRangeRef randomConflictRange(Arena& arena) {
+	StringRef a = randomConflictKey(arena);
+	StringRef b = randomConflictKey(arena);
+	if (b < a) {
+		std::swap(a, b);
+	}
+	if (a == b) {
+		b = b.withSuffix("\x00"_sr, arena);
+	}
+	return KeyRangeRef(a, b);
+}
+
+std::vector<std::pair<int, std::vector<int>>> sortedConflictingKeyRanges(const std::map<int, VectorRef<int>>& m) {
+	std::vector<std::pair<int, std::vector<int>>> result;
+	for (const auto& [t, ranges] : m) {
+		result.emplace_back(t, std::vector<int>(ranges.begin(), ranges.end()));
+		std::sort(result.back().second.begin(), result.back().second.end());
+	}
+	return result;
+}
+} // namespace
+
+TEST_CASE("/fdbserver/ConflictSet/ARTMatchesSkipList") {
+	ConflictSet* skipListSet = newConflictSet(
+	    false, SERVER_KNOBS->RESOLVER_CONFLICT_CHECK_THREADS, SERVER_KNOBS->RESOLVER_PARALLEL_CHECK_MIN_RANGES);
+	ConflictSet* artSet = newConflictSet(true);
+
+	Version version = 100;
+	for (int batch = 0; batch < 1000; batch++) {
+		Arena arena;
+		std::vector<CommitTransactionRef> trs;
+		const int transactions = deterministicRandom()->randomInt(1, 50);
+		for (int t = 0; t < transactions; t++) {
+			CommitTransactionRef tr;
+			tr.read_snapshot = version - deterministicRandom()->randomInt(1, 30);
+			tr.report_conflicting_keys = deterministicRandom()->coinflip();
+			const int reads = deterministicRandom()->randomInt(0, 4);
+			for (int r = 0; r < reads; r++) {
+				tr.read_conflict_ranges.push_back(arena, randomConflictRange(arena));
+			}
+			const int writes = deterministicRandom()->randomInt(0, 4);
+			for (int w = 0; w < writes; w++) {
+				tr.write_conflict_ranges.push_back(arena, randomConflictRange(arena));
+			}
+			trs.push_back(tr);
+		}
+
+		const Version newOldestVersion = version - 20;
+		std::map<int, VectorRef<int>> skipListConflicts, artConflicts;
+		Arena skipListConflictsArena, artConflictsArena;
+		ConflictBatch skipListBatch(skipListSet, &skipListConflicts, &skipListConflictsArena);
+		ConflictBatch artBatch(artSet, &artConflicts, &artConflictsArena);
+		for (const auto& tr : trs) {
+			skipListBatch.addTransaction(tr, newOldestVersion);
+			artBatch.addTransaction(tr, newOldestVersion);
+		}
+
+		std::vector<int> skipListCommitted, artCommitted, skipListTooOld, artTooOld;
+		skipListBatch.detectConflicts(version, newOldestVersion, skipListCommitted, &skipListTooOld);
+		artBatch.detectConflicts(version, newOldestVersion, artCommitted, &artTooOld);
+		ASSERT(skipListCommitted == artCommitted);
+		ASSERT(skipListTooOld == artTooOld);
+		ASSERT(sortedConflictingKeyRanges(skipListConflicts) == sortedConflictingKeyRanges(artConflicts));
+
+		version += deterministicRandom()->randomInt(1, 5);
+	}
+
+	destroyConflictSet(skipListSet);
+	destroyConflictSet(artSet);
+	return Void();
+}
+
+TEST_CASE("/fdbserver/ConflictSet/compareKeys") {
+	Arena arena;
+	for (int i = 0; i < 100000; i++) {
+		// Long, mostly equal keys exercise every width of the comparison kernel
+		const int prefixLength = deterministicRandom()->randomInt(0, 80);
+		const int aLength = prefixLength + deterministicRandom()->randomInt(0, 3);
+		const int bLength = prefixLength + deterministicRandom()->randomInt(0, 3);
+		uint8_t* a = new (arena) uint8_t[aLength];
+		uint8_t* b = new (arena) uint8_t[bLength];
+		for (int j = 0; j < std::max(aLength, bLength); j++) {
+			const uint8_t c = j < prefixLength ? 'a' + j % 3 : deterministicRandom()->randomInt(0, 256);
+			if (j < aLength)
+				a[j] = c;
+			if (j < bLength)
+				b[j] = j < prefixLength || deterministicRandom()->coinflip() ? c : deterministicRandom()->randomInt(0, 256);
+		}
+
+		const StringRef aRef(a, aLength), bRef(b, bLength);
+		const int expected = aRef < bRef ? -1 : (bRef < aRef ? +1 : 0);
+		ASSERT_EQ(compare(aRef, bRef), expected);
+		ASSERT_EQ(compareKeys(a, aLength, b, bLength, std::min(prefixLength, std::min(aLength, bLength))), expected);
+		ASSERT_EQ(keyCommonPrefixLength(a, b, std::min(aLength, bLength)), commonPrefixLength(aRef, bRef));
+	}
+
+	// sortPoints() skips shared prefixes when sorting small buckets, which must not change the order
+	std::vector<KeyInfo> points;
+	for (int i = 0; i < 2000; i++) {
+		const StringRef key = randomConflictKey(arena);
+		points.emplace_back(key, deterministicRandom()->coinflip(), deterministicRandom()->coinflip(), i, nullptr);
+	}
+	std::vector<KeyInfo> expected = points;
+	std::sort(expected.begin(), expected.end());
+	sortPoints(points);
+	for (int i = 0; i < points.size(); i++) {
+		ASSERT(points[i] == expected[i]);
+	}
+	return Void();
 }
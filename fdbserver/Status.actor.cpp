@@ -531,6 +531,9 @@ struct RolesInfo {
 			obj.setKeyRawNumber("kvstore_total_size", storageMetrics.getValue("KvstoreSizeTotal"));
 			obj.setKeyRawNumber("kvstore_total_nodes", storageMetrics.getValue("KvstoreNodeTotal"));
 			obj.setKeyRawNumber("kvstore_inline_keys", storageMetrics.getValue("KvstoreInlineKey"));
+			obj.setKeyRawNumber("kvstore_lazy_clear_pending", storageMetrics.getValue("KvstoreLazyClearPending"));
+			obj.setKeyRawNumber("kvstore_lazy_clear_freed_bytes",
+			                    storageMetrics.getValue("KvstoreLazyClearFreedBytes"));
 			obj["input_bytes"] = StatusCounter(storageMetrics.getValue("BytesInput")).getStatus();
 			obj["durable_bytes"] = StatusCounter(storageMetrics.getValue("BytesDurable")).getStatus();
 			obj.setKeyRawNumber("query_queue_max", storageMetrics.getValue("QueryQueueMax"));
@@ -758,12 +761,61 @@ struct RolesInfo {
 	}
 };
 
+// Builds the latencies of the most common types of messages a process receives from its RpcLatencyMetrics event, whose
+// fields are named <type>.<metric>
+static JsonBuilderObject rpcLatencyStatus(TraceEventFields const& metrics) {
+	static const std::map<std::string, std::string> metricKeys = {
+		{ "Count", "count" },
+		{ "QueueMedian", "queue_median_seconds" },
+		{ "QueueP99", "queue_p99_seconds" },
+		{ "ServiceCount", "service_count" },
+		{ "ServiceMedian", "service_median_seconds" },
+		{ "ServiceP99", "service_p99_seconds" },
+	};
+	std::map<std::string, JsonBuilderObject> types;
+	for (auto const& [field, value] : metrics) {
+		size_t dot = field.rfind('.');
+		if (dot == std::string::npos) {
+			continue;
+		}
+		auto key = metricKeys.find(field.substr(dot + 1));
+		if (key != metricKeys.end()) {
+			types[field.substr(0, dot)].setKeyRawNumber(key->second, value);
+		}
+	}
+	JsonBuilderObject obj;
+	for (auto& [type, typeObj] : types) {
+		obj[type] = typeObj;
+	}
+	return obj;
+}
+
+// The waits of the sampled run loop tasks from becoming ready until they ran, keyed by the lowest priority of each of
+// the NetworkMetrics starvation bins
+static JsonBuilderObject runLoopReadyWaitStatus(TraceEventFields const& metrics) {
+	JsonBuilderObject obj;
+	for (int priority : NetworkMetrics::starvationBins) {
+		int64_t count;
+		if (!metrics.tryGetInt64(format("PriorityReadyWaitCount%d", priority), count)) {
+			continue; // Not logged by processes of older versions
+		}
+		JsonBuilderObject bin;
+		bin["count"] = count;
+		bin["median_seconds"] = metrics.getDouble(format("PriorityReadyWaitMedian%d", priority));
+		bin["p99_seconds"] = metrics.getDouble(format("PriorityReadyWaitP99%d", priority));
+		bin["max_seconds"] = metrics.getDouble(format("PriorityReadyWaitMax%d", priority));
+		obj[std::to_string(priority)] = bin;
+	}
+	return obj;
+}
+
 ACTOR static Future<JsonBuilderObject> processStatusFetcher(
     Reference<AsyncVar<ServerDBInfo>> db,
     std::vector<WorkerDetails> workers,
     WorkerEvents pMetrics,
     WorkerEvents mMetrics,
     WorkerEvents nMetrics,
+    WorkerEvents rpcLatencyMetrics,
     WorkerEvents errors,
     WorkerEvents traceFileOpenErrors,
     WorkerEvents programStarts,
@@ -1128,6 +1180,12 @@ ACTOR static Future<JsonBuilderObject> processStatusFetcher(
 				incomplete_reasons->insert("Cannot retrieve run loop busyness.");
 			}
 
+			statusObj["run_loop_ready_wait"] = runLoopReadyWaitStatus(nMetrics[workerItr->interf.address()]);
+
+			if (rpcLatencyMetrics.count(workerItr->interf.address())) {
+				statusObj["rpc_latency"] = rpcLatencyStatus(rpcLatencyMetrics.at(workerItr->interf.address()));
+			}
+
 		} catch (Error& e) {
 			if (e.code() == error_code_actor_cancelled) {
 				throw;
@@ -1842,6 +1900,11 @@ ACTOR static Future<JsonBuilderObject> dataStatusFetcher(WorkerDetails ddWorker,
 				moving_data["in_flight_bytes"] = partitionsInFlight * averagePartitionSize;
 				moving_data.setKeyRawNumber("total_written_bytes", md.getValue("BytesWritten"));
 				moving_data["highest_priority"] = movingHighestPriority;
+				double projectedCompletionSeconds;
+				if (md.tryGetDouble("ProjectedCompletionSeconds", projectedCompletionSeconds) &&
+				    projectedCompletionSeconds >= 0) {
+					moving_data["projected_completion_seconds"] = projectedCompletionSeconds;
+				}
 
 				// TODO: moving_data["rate_bytes"] = makeCounter(hz, c, r);
 				statusObjData["moving_data"] = moving_data;
@@ -2530,9 +2593,9 @@ static JsonBuilderObject tlogFetcher(int* logFaultTolerance,
                                      std::unordered_map<NetworkAddress, WorkerInterface> const& address_workers) {
 	JsonBuilderObject statusObj;
 	JsonBuilderArray logsObj;
-	Optional<int32_t> sat_log_replication_factor, sat_log_write_anti_quorum, sat_log_fault_tolerance,
-	    log_replication_factor, log_write_anti_quorum, log_fault_tolerance, remote_log_replication_factor,
-	    remote_log_fault_tolerance;
+	Optional<int32_t> sat_log_replication_factor, sat_log_write_anti_quorum, sat_log_write_quorum,
+	    sat_log_fault_tolerance, log_replication_factor, log_write_anti_quorum, log_write_quorum, log_fault_tolerance,
+	    remote_log_replication_factor, remote_log_fault_tolerance;
 
 	int minFaultTolerance = 1000;
 	int localSetsWithNonNegativeFaultTolerance = 0;
@@ -2579,10 +2642,13 @@ static JsonBuilderObject tlogFetcher(int* logFaultTolerance,
 		if (tLogSet.isLocal && tLogSet.locality == tagLocalitySatellite) {
 			sat_log_replication_factor = tLogSet.tLogReplicationFactor;
 			sat_log_write_anti_quorum = tLogSet.tLogWriteAntiQuorum;
+			// Commits are acknowledged once this many of the logs, whichever reply first, have made them durable
+			sat_log_write_quorum = tLogSet.tLogs.size() - tLogSet.tLogWriteAntiQuorum;
 			sat_log_fault_tolerance = tLogSet.tLogReplicationFactor - 1 - tLogSet.tLogWriteAntiQuorum - failedLogs;
 		} else if (tLogSet.isLocal) {
 			log_replication_factor = tLogSet.tLogReplicationFactor;
 			log_write_anti_quorum = tLogSet.tLogWriteAntiQuorum;
+			log_write_quorum = tLogSet.tLogs.size() - tLogSet.tLogWriteAntiQuorum;
 			log_fault_tolerance = tLogSet.tLogReplicationFactor - 1 - tLogSet.tLogWriteAntiQuorum - failedLogs;
 		} else {
 			remote_log_replication_factor = tLogSet.tLogReplicationFactor;
@@ -2606,6 +2672,8 @@ static JsonBuilderObject tlogFetcher(int* logFaultTolerance,
 		statusObj["satellite_log_replication_factor"] = sat_log_replication_factor.get();
 	if (sat_log_write_anti_quorum.present())
 		statusObj["satellite_log_write_anti_quorum"] = sat_log_write_anti_quorum.get();
+	if (sat_log_write_quorum.present())
+		statusObj["satellite_log_write_quorum"] = sat_log_write_quorum.get();
 	if (sat_log_fault_tolerance.present())
 		statusObj["satellite_log_fault_tolerance"] = sat_log_fault_tolerance.get();
 
@@ -2613,6 +2681,8 @@ static JsonBuilderObject tlogFetcher(int* logFaultTolerance,
 		statusObj["log_replication_factor"] = log_replication_factor.get();
 	if (log_write_anti_quorum.present())
 		statusObj["log_write_anti_quorum"] = log_write_anti_quorum.get();
+	if (log_write_quorum.present())
+		statusObj["log_write_quorum"] = log_write_quorum.get();
 	if (log_fault_tolerance.present())
 		statusObj["log_fault_tolerance"] = log_fault_tolerance.get();
 
@@ -3158,6 +3228,7 @@ ACTOR Future<StatusReply> clusterGetStatus(
 		futures.push_back(latestErrorOnWorkers(workers)); // Get all latest errors.
 		futures.push_back(latestEventOnWorkers(workers, "TraceFileOpenError"));
 		futures.push_back(latestEventOnWorkers(workers, "ProgramStart"));
+		futures.push_back(latestEventOnWorkers(workers, "RpcLatencyMetrics"));
 
 		// Wait for all response pairs.
 		state std::vector<Optional<std::pair<WorkerEvents, std::set<std::string>>>> workerEventsVec =
@@ -3218,6 +3289,8 @@ ACTOR Future<StatusReply> clusterGetStatus(
 		    workerEventsVec[4].present() ? workerEventsVec[4].get().first : WorkerEvents();
 		state WorkerEvents programStarts =
 		    workerEventsVec[5].present() ? workerEventsVec[5].get().first : WorkerEvents();
+		state WorkerEvents rpcLatencyMetrics =
+		    workerEventsVec[6].present() ? workerEventsVec[6].get().first : WorkerEvents();
 
 		if (db->get().recoveryCount > 0) {
 			statusObj["generation"] = db->get().recoveryCount;
@@ -3536,6 +3609,7 @@ ACTOR Future<StatusReply> clusterGetStatus(
 		                              pMetrics,
 		                              mMetrics,
 		                              networkMetrics,
+		                              rpcLatencyMetrics,
 		                              latestError,
 		                              traceFileOpenErrors,
 		                              programStarts,
@@ -3695,28 +3769,23 @@ ACTOR Future<StatusReply> clusterGetStatus(
 	}
 }
 
-StatusReply clusterGetFaultToleranceStatus(const std::string& statusStr) {
+static StatusReply getStatusFields(const std::string& statusStr,
+                                   const std::vector<std::string>& fields,
+                                   const char* context) {
 	double tStart = timer();
 
 	try {
 		json_spirit::mValue mv = readJSONStrictly(statusStr);
 		JSONDoc jsonDoc(mv);
 
-		std::string faultToleranceRelatedFields[] = {
-			"fault_tolerance", "data",    "logs", "maintenance_zone", "maintenance_seconds_remaining", "qos",
-			"recovery_state",  "messages"
-		};
-
 		JsonBuilderObject statusObj;
-		for (std::string& field : faultToleranceRelatedFields) {
+		for (const std::string& field : fields) {
 			if (jsonDoc.has(field)) {
 				statusObj[field] = jsonDoc.last();
 			}
 		}
 
-		TraceEvent("ClusterGetFaultToleranceStatus")
-		    .detail("Duration", timer() - tStart)
-		    .detail("StatusSize", statusObj.getFinalLength());
+		TraceEvent(context).detail("Duration", timer() - tStart).detail("StatusSize", statusObj.getFinalLength());
 
 		return StatusReply(statusObj.getJson());
 	} catch (Error& e) {
@@ -3725,6 +3794,27 @@ StatusReply clusterGetFaultToleranceStatus(const std::string& statusStr) {
 	}
 }
 
+StatusReply clusterGetFaultToleranceStatus(const std::string& statusStr) {
+	return getStatusFields(statusStr,
+	                       { "fault_tolerance",
+	                         "data",
+	                         "logs",
+	                         "maintenance_zone",
+	                         "maintenance_seconds_remaining",
+	                         "qos",
+	                         "recovery_state",
+	                         "messages" },
+	                       "ClusterGetFaultToleranceStatus");
+}
+
+StatusReply clusterGetStatusSections(const std::string& statusStr, const std::string& statusField) {
+	std::vector<std::string> fields;
+	for (auto& field : StringRef(statusField).splitAny(","_sr)) {
+		fields.push_back(field.toString());
+	}
+	return getStatusFields(statusStr, fields, "ClusterGetStatusSections");
+}
+
 bool checkAsciiNumber(const char* s) {
 	JsonBuilderObject number;
 	number.setKeyRawNumber("number", s);
@@ -295,11 +295,16 @@ void StorageServerMetrics::splitMetrics(SplitMetricsRequest req) const {
 		//TraceEvent("SplitMetrics").detail("Begin", req.keys.begin).detail("End", req.keys.end).detail("Remaining", remaining.bytes).detail("Used", used.bytes).detail("MinSplitBytes", minSplitBytes);
 
 		while (true) {
-			if (remaining.bytes < 2 * minSplitBytes && (!SERVER_KNOBS->ENABLE_WRITE_BASED_SHARD_SPLIT ||
-			                                            remaining.bytesWrittenPerKSecond < minSplitWriteTraffic))
+			// A read bandwidth limit is only set to split read hot shards, which may be small
+			bool readSplit = req.limits.bytesReadPerKSecond < req.limits.infinity / 2 &&
+			                 remaining.bytesReadPerKSecond >= 2 * req.limits.bytesReadPerKSecond;
+			if (remaining.bytes < 2 * minSplitBytes && !readSplit &&
+			    (!SERVER_KNOBS->ENABLE_WRITE_BASED_SHARD_SPLIT ||
+			     remaining.bytesWrittenPerKSecond < minSplitWriteTraffic))
 				break;
 			KeyRef key = req.keys.end;
-			bool hasUsed = used.bytes != 0 || used.bytesWrittenPerKSecond != 0 || used.iosPerKSecond != 0;
+			bool hasUsed = used.bytes != 0 || used.bytesWrittenPerKSecond != 0 || used.iosPerKSecond != 0 ||
+			               used.bytesReadPerKSecond != 0;
 			key = getSplitKey(remaining.bytes,
 			                  estimated.bytes,
 			                  req.limits.bytes,
@@ -336,6 +341,17 @@ void StorageServerMetrics::splitMetrics(SplitMetricsRequest req) const {
 			                  lastKey,
 			                  key,
 			                  hasUsed);
+			key = getSplitKey(remaining.bytesReadPerKSecond,
+			                  estimated.bytesReadPerKSecond,
+			                  req.limits.bytesReadPerKSecond,
+			                  used.bytesReadPerKSecond,
+			                  req.limits.infinity,
+			                  req.isLastShard,
+			                  bytesReadSample,
+			                  SERVER_KNOBS->STORAGE_METRICS_AVERAGE_INTERVAL_PER_KSECONDS,
+			                  lastKey,
+			                  key,
+			                  hasUsed);
 			ASSERT(key != lastKey || hasUsed);
 			if (key == req.keys.end)
 				break;
@@ -555,7 +571,7 @@ std::vector<KeyRef> StorageServerMetrics::getSplitPoints(KeyRangeRef range,
                                                          Optional<KeyRef> prefixToRemove) const {
 	std::vector<KeyRef> toReturn;
 	KeyRef beginKey = range.begin;
-	IndexedSet<Key, int64_t>::const_iterator endKey =
+	PackedIndexedSet::const_iterator endKey =
 	    byteSample.sample.index(byteSample.sample.sumTo(byteSample.sample.lower_bound(beginKey)) + chunkSize);
 	while (endKey != byteSample.sample.end()) {
 		if (*endKey > range.end) {
@@ -929,3 +945,44 @@ TEST_CASE("/fdbserver/StorageMetricSample/readHotDetect/equalDivide") {
 	ASSERT_EQ(t.at(3).bytes, 0);
 	return Void();
 }
+
+TEST_CASE("/fdbserver/StorageMetricSample/splitMetrics/readBandwidth") {
+	int64_t sampleUnit = SERVER_KNOBS->BYTES_READ_UNITS_PER_SAMPLE;
+	state StorageServerMetrics ssm;
+
+	ssm.bytesReadSample.sample.insert("Apple"_sr, 1000 * sampleUnit);
+	ssm.bytesReadSample.sample.insert("Banana"_sr, 1000 * sampleUnit);
+	ssm.bytesReadSample.sample.insert("Cat"_sr, 1000 * sampleUnit);
+	ssm.bytesReadSample.sample.insert("Dog"_sr, 1000 * sampleUnit);
+	ssm.byteSample.sample.insert("Apple"_sr, 100);
+	ssm.byteSample.sample.insert("Dog"_sr, 100);
+
+	state KeyRange range = KeyRangeRef("A"_sr, "E"_sr);
+	state StorageMetrics total = ssm.getMetrics(range);
+	state StorageMetrics limits;
+	limits.bytes = limits.infinity;
+	limits.bytesWrittenPerKSecond = limits.infinity;
+	limits.iosPerKSecond = limits.infinity;
+	limits.bytesReadPerKSecond = limits.infinity;
+	limits.opsReadPerKSecond = limits.infinity;
+
+	// Without a read bandwidth limit the shard is too small to split
+	state SplitMetricsRequest req(range, limits, StorageMetrics(), total, true, 0);
+	ssm.splitMetrics(req);
+	SplitMetricsReply reply = wait(req.reply.getFuture());
+	ASSERT_EQ(reply.splits.size(), 0);
+
+	// Split points divide the read bandwidth, regardless of the size of the pieces
+	limits.bytesReadPerKSecond = total.bytesReadPerKSecond / 4;
+	req = SplitMetricsRequest(range, limits, StorageMetrics(), total, true, 0);
+	ssm.splitMetrics(req);
+	SplitMetricsReply readReply = wait(req.reply.getFuture());
+	ASSERT_GE(readReply.splits.size(), 2);
+	KeyRef lastKey = range.begin;
+	for (auto split : readReply.splits) {
+		ASSERT(split > lastKey && split < range.end);
+		ASSERT_LT(ssm.getMetrics(KeyRangeRef(lastKey, split)).bytesReadPerKSecond, total.bytesReadPerKSecond);
+		lastKey = split;
+	}
+	return Void();
+}
@@ -18,6 +18,7 @@
  * limitations under the License.
  */
 
+#include "flow/CompressionUtils.h"
 #include "flow/Hash3.h"
 #include "flow/UnitTest.h"
 #include "fdbclient/NativeAPI.actor.h"
@@ -32,6 +33,8 @@
 #include "fdbserver/Knobs.h"
 #include "fdbserver/IKeyValueStore.h"
 #include "fdbserver/MutationTracking.h"
+#include "fdbserver/PeekStreamFlowControl.h"
+#include "fdbserver/TagMessageIndex.h"
 #include "flow/ActorCollection.h"
 #include "fdbrpc/FailureMonitor.h"
 #include "fdbserver/IDiskQueue.h"
@@ -269,6 +272,41 @@ static Version decodeTagMessagesKey(StringRef key) {
 	return bigEndian64(BinaryReader::fromStringRef<Version>(stripTagMessagesKey(key), Unversioned()));
 }
 
+// A value of persistTagMessagesKeys is normally one tag's messages at one version, each prefixed with its length.
+// When TLOG_SPILL_VALUE_COMPRESSION_FILTER is set, large values are instead stored as
+//   [uint32_t 0][uint8_t CompressionFilter][compressed messages]
+// No message is empty, so a value starting with a zero length can not be an uncompressed one. Each version is
+// compressed on its own, so a peek only decompresses the versions it returns.
+static constexpr uint32_t compressedTagMessagesMarker = 0;
+static constexpr int compressedTagMessagesHeaderSize = sizeof(uint32_t) + sizeof(uint8_t);
+
+static StringRef compressTagMessages(CompressionFilter filter, StringRef messages, Arena& arena) {
+	if (filter == CompressionFilter::NONE || messages.size() < SERVER_KNOBS->TLOG_SPILL_VALUE_COMPRESSION_MIN_BYTES) {
+		return messages;
+	}
+	StringRef compressed = CompressionUtils::compress(filter, messages, arena);
+	if (compressed.size() + compressedTagMessagesHeaderSize >= messages.size()) {
+		return messages;
+	}
+	BinaryWriter wr(Unversioned());
+	wr << compressedTagMessagesMarker << uint8_t(filter);
+	wr.serializeBytes(compressed);
+	return StringRef(arena, wr.toValue());
+}
+
+static StringRef decompressTagMessages(StringRef value, Arena& arena) {
+	uint32_t prefix;
+	if (value.size() < compressedTagMessagesHeaderSize) {
+		return value;
+	}
+	memcpy(&prefix, value.begin(), sizeof(prefix));
+	if (prefix != compressedTagMessagesMarker) {
+		return value;
+	}
+	const CompressionFilter filter = static_cast<CompressionFilter>(value[sizeof(prefix)]);
+	return CompressionUtils::decompress(filter, value.substr(compressedTagMessagesHeaderSize), arena);
+}
+
 struct SpilledData {
 	SpilledData() = default;
 	SpilledData(Version version, IDiskQueue::location start, uint32_t length, uint32_t mutationBytes)
@@ -400,11 +438,22 @@ struct TLogData : NonCopyable {
 	    enablePrimaryTxnSystemHealthCheck(enablePrimaryTxnSystemHealthCheck) {
 		cx = openDBOnServer(dbInfo, TaskPriority::DefaultEndpoint, LockAware::True);
 	}
+
+	// How close this TLog is to its memory limits, from 0 to 1: the larger of its unspilled bytes against
+	// TLOG_HARD_LIMIT_BYTES and the memory held by spilled peeks against their limit.
+	double peekMemoryPressure() const {
+		const double volatileBytes = double(bytesInput - bytesDurable) / SERVER_KNOBS->TLOG_HARD_LIMIT_BYTES;
+		const double peekBytes =
+		    peekMemoryLimiter.waiters() > 0
+		        ? 1.0
+		        : double(peekMemoryLimiter.activePermits()) / SERVER_KNOBS->TLOG_SPILL_REFERENCE_MAX_PEEK_MEMORY_BYTES;
+		return std::min(1.0, std::max(volatileBytes, peekBytes));
+	}
 };
 
 struct LogData : NonCopyable, public ReferenceCounted<LogData> {
 	struct TagData : NonCopyable, public ReferenceCounted<TagData> {
-		std::deque<std::pair<Version, LengthPrefixedStringRef>> versionMessages;
+		TagMessageIndex versionMessages;
 		bool
 		    nothingPersistent; // true means tag is *known* to have no messages in persistentData.  false means nothing.
 		bool poppedRecently; // `popped` has changed since last updatePersistentData
@@ -448,25 +497,24 @@ struct LogData : NonCopyable, public ReferenceCounted<LogData> {
 		                                       TLogData* tlogData,
 		                                       Reference<LogData> logData,
 		                                       TaskPriority taskID) {
-			while (!self->versionMessages.empty() && self->versionMessages.front().first < before) {
-				Version version = self->versionMessages.front().first;
+			while (!self->versionMessages.empty() && self->versionMessages.frontVersion() < before) {
+				Version version = self->versionMessages.frontVersion();
 				std::pair<int, int>& sizes = logData->version_sizes[version];
-				int64_t messagesErased = 0;
-
-				while (!self->versionMessages.empty() && self->versionMessages.front().first == version) {
-					auto const& m = self->versionMessages.front();
-					++messagesErased;
+				const int64_t indexBytes = self->versionMessages.allocatedBytes();
 
+				while (!self->versionMessages.empty() && self->versionMessages.frontVersion() == version) {
+					const int messageSize = self->versionMessages.frontMessage().expectedSize();
 					if (self->tag.locality != tagLocalityTxs && self->tag != txsTag) {
-						sizes.first -= m.second.expectedSize();
+						sizes.first -= messageSize;
 					} else {
-						sizes.second -= m.second.expectedSize();
+						sizes.second -= messageSize;
 					}
 
 					self->versionMessages.pop_front();
 				}
 
-				int64_t bytesErased = messagesErased * SERVER_KNOBS->VERSION_MESSAGES_ENTRY_BYTES_WITH_OVERHEAD;
+				// The index memory is accounted as its blocks are allocated and freed
+				int64_t bytesErased = indexBytes - self->versionMessages.allocatedBytes();
 				logData->bytesDurable += bytesErased;
 				tlogData->bytesDurable += bytesErased;
 				tlogData->overheadBytesDurable += bytesErased;
@@ -527,6 +575,30 @@ struct LogData : NonCopyable, public ReferenceCounted<LogData> {
 	Tag minPoppedTag; // The tag that makes tLog hold its data and cause tLog's disk queue increasing.
 
 	Deque<std::pair<Version, Standalone<VectorRef<uint8_t>>>> messageBlocks;
+
+	// Returns the offset of a message committed at version within that version's commit blob
+	// (TLogQueueEntryRef::messages). commitMessages() copies every message of a commit, in order, into the blocks
+	// recorded under its version, so the offset is the number of bytes in the version's blocks that precede it.
+	Optional<uint32_t> messageOffsetInCommit(Version version, const uint8_t* message) const {
+		int lo = 0, hi = messageBlocks.size();
+		while (lo < hi) {
+			int mid = lo + (hi - lo) / 2;
+			if (messageBlocks[mid].first < version) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		uint32_t offset = 0;
+		for (int i = lo; i < messageBlocks.size() && messageBlocks[i].first == version; i++) {
+			const Standalone<VectorRef<uint8_t>>& block = messageBlocks[i].second;
+			if (message >= block.begin() && message < block.end()) {
+				return offset + static_cast<uint32_t>(message - block.begin());
+			}
+			offset += block.size();
+		}
+		return Optional<uint32_t>();
+	}
 	std::vector<std::vector<Reference<TagData>>> tag_data; // tag.locality | tag.id
 	int unpoppedRecoveredTagCount;
 	std::set<Tag> unpoppedRecoveredTags;
@@ -569,6 +641,9 @@ struct LogData : NonCopyable, public ReferenceCounted<LogData> {
 	Counter blockingPeekTimeouts;
 	Counter emptyPeeks;
 	Counter nonEmptyPeeks;
+	Counter indexedSpilledPeekCommits; // Spilled commits served from the message index rather than by parsing
+	Counter spilledValueBytes; // Bytes of messages spilled by value, before compression
+	Counter spilledValueStoredBytes; // Bytes written to persistentData for them
 	std::map<Tag, LatencySample> blockingPeekLatencies;
 	std::map<Tag, LatencySample> peekVersionCounts;
 
@@ -658,7 +733,9 @@ struct LogData : NonCopyable, public ReferenceCounted<LogData> {
 	    unpoppedRecoveredTagCount(0), cc("TLog", interf.id().toString()), bytesInput("BytesInput", cc),
 	    bytesDurable("BytesDurable", cc), blockingPeeks("BlockingPeeks", cc),
 	    blockingPeekTimeouts("BlockingPeekTimeouts", cc), emptyPeeks("EmptyPeeks", cc),
-	    nonEmptyPeeks("NonEmptyPeeks", cc), logId(interf.id()), protocolVersion(protocolVersion),
+	    nonEmptyPeeks("NonEmptyPeeks", cc), indexedSpilledPeekCommits("IndexedSpilledPeekCommits", cc),
+	    spilledValueBytes("SpilledValueBytes", cc), spilledValueStoredBytes("SpilledValueStoredBytes", cc),
+	    logId(interf.id()), protocolVersion(protocolVersion),
 	    newPersistentDataVersion(invalidVersion), tLogData(tLogData), unrecoveredBefore(1), recoveredAt(1),
 	    recoveryTxnVersion(1), logSystem(new AsyncVar<Reference<ILogSystem>>()), remoteTag(remoteTag),
 	    isPrimary(isPrimary), logRouterTags(logRouterTags), logRouterPoppedVersion(0), logRouterPopToVersion(0),
@@ -681,6 +758,10 @@ struct LogData : NonCopyable, public ReferenceCounted<LogData> {
 		specialCounter(cc, "QueueCommittedVersion", [this]() { return this->queueCommittedVersion.get(); });
 		specialCounter(cc, "PersistentDataVersion", [this]() { return this->persistentDataVersion; });
 		specialCounter(cc, "PersistentDataDurableVersion", [this]() { return this->persistentDataDurableVersion; });
+		specialCounter(cc, "SpilledValueCompressionPercent", [this]() {
+			int64_t bytes = this->spilledValueBytes.getValue();
+			return bytes > 0 ? this->spilledValueStoredBytes.getValue() * 100 / bytes : int64_t(100);
+		});
 		specialCounter(cc, "KnownCommittedVersion", [this]() { return this->knownCommittedVersion; });
 		specialCounter(cc, "QueuePoppedVersion", [this]() { return this->queuePoppedVersion; });
 		specialCounter(cc, "MinPoppedTagVersion", [this]() { return this->minPoppedTagVersion; });
@@ -1001,6 +1082,18 @@ ACTOR Future<Void> popDiskQueue(TLogData* self, Reference<LogData> logData) {
 
 ACTOR Future<Void> updatePersistentData(TLogData* self, Reference<LogData> logData, Version newPersistentDataVersion) {
 	state BinaryWriter wr(Unversioned());
+	// The message index of the reference spilled batch being built in wr, see messagesAtOffsets(). The knob is read
+	// once so that every batch either has an index entry for each of its SpilledData or none at all.
+	state BinaryWriter indexWr(Unversioned());
+	state bool writeMessageIndex = SERVER_KNOBS->TLOG_SPILL_REFERENCE_MESSAGE_INDEX;
+	state CompressionFilter valueCompression =
+	    CompressionUtils::fromFilterString(SERVER_KNOBS->TLOG_SPILL_VALUE_COMPRESSION_FILTER);
+	if (!CompressionUtils::supportedFilters.count(valueCompression)) {
+		TraceEvent(SevWarnAlways, "TLogSpillCompressionUnsupported", self->dbgid)
+		    .suppressFor(60.0)
+		    .detail("Filter", SERVER_KNOBS->TLOG_SPILL_VALUE_COMPRESSION_FILTER);
+		valueCompression = CompressionFilter::NONE;
+	}
 	// PERSIST: Changes self->persistentDataVersion and writes and commits the relevant changes
 	ASSERT(newPersistentDataVersion <= logData->version.get());
 	ASSERT(newPersistentDataVersion <= logData->queueCommittedVersion.get());
@@ -1027,24 +1120,28 @@ ACTOR Future<Void> updatePersistentData(TLogData* self, Reference<LogData> logDa
 				state Version lastVersion = std::numeric_limits<Version>::min();
 				state IDiskQueue::location firstLocation = std::numeric_limits<IDiskQueue::location>::max();
 				// Transfer unpopped messages with version numbers less than newPersistentDataVersion to persistentData
-				state std::deque<std::pair<Version, LengthPrefixedStringRef>>::iterator msg =
-				    tagData->versionMessages.begin();
+				state TagMessageIndex::iterator msg = tagData->versionMessages.begin();
 				state int refSpilledTagCount = 0;
 				wr = BinaryWriter(AssumeVersion(logData->protocolVersion));
+				indexWr = BinaryWriter(AssumeVersion(logData->protocolVersion));
 				// We prefix our spilled locations with a count, so that we can read this back out as a VectorRef.
 				wr << uint32_t(0);
-				while (msg != tagData->versionMessages.end() && msg->first <= newPersistentDataVersion) {
-					currentVersion = msg->first;
+				while (msg != tagData->versionMessages.end() && msg.version() <= newPersistentDataVersion) {
+					currentVersion = msg.version();
 					anyData = true;
 					tagData->nothingPersistent = false;
 
 					if (logData->shouldSpillByValue(tagData->tag)) {
 						wr = BinaryWriter(Unversioned());
-						for (; msg != tagData->versionMessages.end() && msg->first == currentVersion; ++msg) {
-							wr << msg->second.toStringRef();
+						for (; msg != tagData->versionMessages.end() && msg.version() == currentVersion; ++msg) {
+							wr << msg.message().toStringRef();
 						}
+						Arena arena;
+						StringRef value = compressTagMessages(valueCompression, wr.toValue(), arena);
+						logData->spilledValueBytes += wr.getLength();
+						logData->spilledValueStoredBytes += value.size();
 						self->persistentData->set(KeyValueRef(
-						    persistTagMessagesKey(logData->logId, tagData->tag, currentVersion), wr.toValue()));
+						    persistTagMessagesKey(logData->logId, tagData->tag, currentVersion), value));
 					} else {
 						// spill everything else by reference
 						const IDiskQueue::location begin = logData->versionLocation[currentVersion].first;
@@ -1054,41 +1151,57 @@ ACTOR Future<Void> updatePersistentData(TLogData* self, Reference<LogData> logDa
 						refSpilledTagCount++;
 
 						uint32_t size = 0;
-						for (; msg != tagData->versionMessages.end() && msg->first == currentVersion; ++msg) {
+						std::vector<uint32_t> offsets;
+						bool indexed = writeMessageIndex;
+						for (; msg != tagData->versionMessages.end() && msg.version() == currentVersion; ++msg) {
 							// Fast forward until we find a new version.
-							size += msg->second.expectedSize();
+							size += msg.message().expectedSize();
+							if (indexed) {
+								Optional<uint32_t> offset = logData->messageOffsetInCommit(
+								    currentVersion, (const uint8_t*)msg.message().getLengthPtr());
+								indexed = offset.present();
+								if (indexed) {
+									offsets.push_back(offset.get());
+								}
+							}
 						}
 
 						SpilledData spilledData(currentVersion, begin, length, size);
 						wr << spilledData;
+						if (writeMessageIndex) {
+							// An empty entry makes peeks fall back to parsing this commit
+							if (!indexed) {
+								offsets.clear();
+							}
+							indexWr << offsets;
+						}
 
 						lastVersion = std::max(currentVersion, lastVersion);
 						firstLocation = std::min(begin, firstLocation);
 
-						if ((wr.getLength() + sizeof(SpilledData) >
+						if ((wr.getLength() + indexWr.getLength() + sizeof(SpilledData) >
 						     SERVER_KNOBS->TLOG_SPILL_REFERENCE_MAX_BYTES_PER_BATCH)) {
 							*(uint32_t*)wr.getData() = refSpilledTagCount;
+							wr.serializeBytes(indexWr.getData(), indexWr.getLength());
 							self->persistentData->set(KeyValueRef(
 							    persistTagMessageRefsKey(logData->logId, tagData->tag, lastVersion), wr.toValue()));
 							tagData->poppedLocation = std::min(tagData->poppedLocation, firstLocation);
 							refSpilledTagCount = 0;
 							wr = BinaryWriter(AssumeVersion(logData->protocolVersion));
+							indexWr = BinaryWriter(AssumeVersion(logData->protocolVersion));
 							wr << uint32_t(0);
 						}
 
 						Future<Void> f = yield(TaskPriority::UpdateStorage);
 						if (!f.isReady()) {
 							wait(f);
-							msg = std::upper_bound(
-							    tagData->versionMessages.begin(),
-							    tagData->versionMessages.end(),
-							    std::make_pair(currentVersion, LengthPrefixedStringRef()),
-							    [](const auto& l, const auto& r) -> bool { return l.first < r.first; });
+							msg = tagData->versionMessages.upperBound(currentVersion);
 						}
 					}
 				}
 				if (refSpilledTagCount > 0) {
 					*(uint32_t*)wr.getData() = refSpilledTagCount;
+					wr.serializeBytes(indexWr.getData(), indexWr.getLength());
 					self->persistentData->set(
 					    KeyValueRef(persistTagMessageRefsKey(logData->logId, tagData->tag, lastVersion), wr.toValue()));
 					tagData->poppedLocation = std::min(tagData->poppedLocation, firstLocation);
@@ -1565,16 +1678,16 @@ void commitMessages(TLogData* self,
 			}
 
 			if (version >= tagData->popped) {
-				tagData->versionMessages.emplace_back(
-				    version, LengthPrefixedStringRef((uint32_t*)(block.end() - msg.message.size())));
-				if (tagData->versionMessages.back().second.expectedSize() > SERVER_KNOBS->MAX_MESSAGE_SIZE) {
-					TraceEvent(SevWarnAlways, "LargeMessage")
-					    .detail("Size", tagData->versionMessages.back().second.expectedSize());
+				const int64_t indexBytes = tagData->versionMessages.allocatedBytes();
+				LengthPrefixedStringRef message((uint32_t*)(block.end() - msg.message.size()));
+				tagData->versionMessages.push_back(version, message);
+				if (message.expectedSize() > SERVER_KNOBS->MAX_MESSAGE_SIZE) {
+					TraceEvent(SevWarnAlways, "LargeMessage").detail("Size", message.expectedSize());
 				}
 				if (tag.locality != tagLocalityTxs && tag != txsTag) {
-					expectedBytes += tagData->versionMessages.back().second.expectedSize();
+					expectedBytes += message.expectedSize();
 				} else {
-					txsBytes += tagData->versionMessages.back().second.expectedSize();
+					txsBytes += message.expectedSize();
 				}
 				if (SERVER_KNOBS->ENABLE_VERSION_VECTOR) {
 					auto iter = logData->waitingTags.find(tag);
@@ -1585,12 +1698,10 @@ void commitMessages(TLogData* self,
 					}
 				}
 
-				// The factor of VERSION_MESSAGES_OVERHEAD is intended to be an overestimate of the actual memory used
-				// to store this data in a std::deque. In practice, this number is probably something like 528/512
-				// ~= 1.03, but this could vary based on the implementation. There will also be a fixed overhead per
-				// std::deque, but its size should be trivial relative to the size of the TLog queue and can be thought
-				// of as increasing the capacity of the queue slightly.
-				overheadBytes += SERVER_KNOBS->VERSION_MESSAGES_ENTRY_BYTES_WITH_OVERHEAD;
+				// The index memory of the tag is counted as its blocks are allocated, so a message costs about 8 bytes
+				// when its tag has many messages and up to a small block when it doesn't. The deque of block pointers
+				// of each tag is a fixed overhead that is trivial relative to the size of the TLog queue.
+				overheadBytes += tagData->versionMessages.allocatedBytes() - indexBytes;
 			}
 		}
 
@@ -1630,10 +1741,10 @@ Version poppedVersion(Reference<LogData> self, Tag tag) {
 	return tagData->popped;
 }
 
-std::deque<std::pair<Version, LengthPrefixedStringRef>>& getVersionMessages(Reference<LogData> self, Tag tag) {
+TagMessageIndex& getVersionMessages(Reference<LogData> self, Tag tag) {
 	auto tagData = self->getTagData(tag);
 	if (!tagData) {
-		static std::deque<std::pair<Version, LengthPrefixedStringRef>> empty;
+		static TagMessageIndex empty;
 		return empty;
 	}
 	return tagData->versionMessages;
@@ -1642,7 +1753,7 @@ std::deque<std::pair<Version, LengthPrefixedStringRef>>& getVersionMessages(Refe
 ACTOR Future<Void> waitForMessagesForTag(Reference<LogData> self, Tag reqTag, Version reqBegin, double timeout) {
 	self->blockingPeeks += 1;
 	auto tagData = self->getTagData(reqTag);
-	if (tagData.isValid() && !tagData->versionMessages.empty() && tagData->versionMessages.back().first >= reqBegin) {
+	if (tagData.isValid() && !tagData->versionMessages.empty() && tagData->versionMessages.backVersion() >= reqBegin) {
 		return Void();
 	}
 	choose {
@@ -1661,36 +1772,49 @@ void peekMessagesFromMemory(Reference<LogData> self,
                             Tag tag,
                             Version begin,
                             BinaryWriter& messages,
-                            Version& endVersion) {
+                            Version& endVersion,
+                            int replyByteLimit) {
 	ASSERT(!messages.getLength());
 
 	int versionCount = 0;
-	auto& deque = getVersionMessages(self, tag);
+	auto& versionMessages = getVersionMessages(self, tag);
 	//TraceEvent("TLogPeekMem", self->dbgid).detail("Tag", req.tag1).detail("PDS", self->persistentDataSequence).detail("PDDS", self->persistentDataDurableSequence).detail("Oldest", map1.empty() ? 0 : map1.begin()->key ).detail("OldestMsgCount", map1.empty() ? 0 : map1.begin()->value.size());
 
 	begin = std::max(begin, self->persistentDataDurableVersion + 1);
-	auto it = std::lower_bound(deque.begin(),
-	                           deque.end(),
-	                           std::make_pair(begin, LengthPrefixedStringRef()),
-	                           [](const auto& l, const auto& r) -> bool { return l.first < r.first; });
+	auto it = versionMessages.lowerBound(begin);
 
+	// Size the reply with the same limit as the loop below before copying into it, so the messages are copied once
+	int replyBytes = 0;
 	Version currentVersion = -1;
-	for (; it != deque.end(); ++it) {
-		if (it->first != currentVersion) {
-			if (messages.getLength() >= SERVER_KNOBS->DESIRED_TOTAL_BYTES) {
+	for (auto sizeIt = it; sizeIt != versionMessages.end(); ++sizeIt) {
+		if (sizeIt.version() != currentVersion) {
+			if (replyBytes >= replyByteLimit) {
+				break;
+			}
+			currentVersion = sizeIt.version();
+			replyBytes += sizeof(VERSION_HEADER) + sizeof(Version);
+		}
+		replyBytes += sizeof(uint32_t) + sizeIt.message().expectedSize();
+	}
+	messages.reserve(replyBytes);
+
+	currentVersion = -1;
+	for (; it != versionMessages.end(); ++it) {
+		if (it.version() != currentVersion) {
+			if (messages.getLength() >= replyByteLimit) {
 				endVersion = currentVersion + 1;
 				//TraceEvent("TLogPeekMessagesReached2", self->dbgid);
 				break;
 			}
 
-			currentVersion = it->first;
+			currentVersion = it.version();
 			messages << VERSION_HEADER << currentVersion;
 		}
 
 		// We need the 4 byte length prefix to be a TagsAndMessage format, but that prefix is added as part of StringRef
 		// serialization.
 		int offset = messages.getLength();
-		messages << it->second.toStringRef();
+		messages << it.message().toStringRef();
 		void* data = messages.getData();
 		DEBUG_TAGS_AND_MESSAGE(
 		    "TLogPeek", currentVersion, StringRef((uint8_t*)data + offset, messages.getLength() - offset), self->logId)
@@ -1737,7 +1861,25 @@ ACTOR Future<std::vector<StringRef>> parseMessagesForTag(StringRef commitBlob, T
 	return relevantMessages;
 }
 
-// Common logics to peek TLog and create TLogPeekReply that serves both streaming peek or normal peek request
+// Returns the messages at the given offsets of a commit blob, as recorded in the message index of a reference spilled
+// batch by updatePersistentData(). This is equivalent to parseMessagesForTag() for the tag the index was written for,
+// without decoding the tags of every other message in the commit.
+std::vector<StringRef> messagesAtOffsets(StringRef commitBlob, const std::vector<uint32_t>& offsets) {
+	std::vector<StringRef> relevantMessages;
+	relevantMessages.reserve(offsets.size());
+	for (uint32_t offset : offsets) {
+		ASSERT(int64_t(offset) + sizeof(uint32_t) <= commitBlob.size());
+		uint32_t messageLength;
+		memcpy(&messageLength, commitBlob.begin() + offset, sizeof(messageLength));
+		const int64_t rawLength = int64_t(messageLength) + sizeof(messageLength);
+		ASSERT(offset + rawLength <= commitBlob.size());
+		relevantMessages.push_back(commitBlob.substr(offset, rawLength));
+	}
+	return relevantMessages;
+}
+
+// Common logics to peek TLog and create TLogPeekReply that serves both streaming peek or normal peek request. Replies
+// are limited to DESIRED_TOTAL_BYTES, or to reqReplyBytes if that is smaller.
 ACTOR template <typename PromiseType>
 Future<Void> tLogPeekMessages(PromiseType replyPromise,
                               TLogData* self,
@@ -1746,7 +1888,9 @@ Future<Void> tLogPeekMessages(PromiseType replyPromise,
                               Tag reqTag,
                               bool reqReturnIfBlocked = false,
                               bool reqOnlySpilled = false,
-                              Optional<std::pair<UID, int>> reqSequence = Optional<std::pair<UID, int>>()) {
+                              Optional<std::pair<UID, int>> reqSequence = Optional<std::pair<UID, int>>(),
+                              int reqReplyBytes = std::numeric_limits<int>::max()) {
+	state int replyByteLimit = std::min(reqReplyBytes, SERVER_KNOBS->DESIRED_TOTAL_BYTES);
 	state BinaryWriter messages(Unversioned());
 	state BinaryWriter messages2(Unversioned());
 	state int sequence = -1;
@@ -1958,7 +2102,7 @@ Future<Void> tLogPeekMessages(PromiseType replyPromise,
 			if (reqOnlySpilled) {
 				endVersion = logData->persistentDataDurableVersion + 1;
 			} else {
-				peekMessagesFromMemory(logData, reqTag, reqBegin, messages2, endVersion);
+				peekMessagesFromMemory(logData, reqTag, reqBegin, messages2, endVersion, replyByteLimit);
 			}
 
 			if (logData->shouldSpillByValue(reqTag)) {
@@ -1966,17 +2110,27 @@ Future<Void> tLogPeekMessages(PromiseType replyPromise,
 				    KeyRangeRef(
 				        persistTagMessagesKey(logData->logId, reqTag, reqBegin),
 				        persistTagMessagesKey(logData->logId, reqTag, logData->persistentDataDurableVersion + 1)),
-				    SERVER_KNOBS->DESIRED_TOTAL_BYTES,
-				    SERVER_KNOBS->DESIRED_TOTAL_BYTES));
-
+				    replyByteLimit,
+				    replyByteLimit));
+
+				// The read is limited by stored bytes, so compressed values also need to be limited as they expand
+				bool limited = kvs.expectedSize() >= replyByteLimit;
+				Version lastVersion = invalidVersion;
+				Arena arena;
+				messages.reserve(kvs.expectedSize() + kvs.size() * (sizeof(VERSION_HEADER) + sizeof(Version)) +
+				                 messages2.getLength());
 				for (auto& kv : kvs) {
-					auto ver = decodeTagMessagesKey(kv.key);
-					messages << VERSION_HEADER << ver;
-					messages.serializeBytes(kv.value);
+					if (messages.getLength() >= replyByteLimit) {
+						limited = true;
+						break;
+					}
+					lastVersion = decodeTagMessagesKey(kv.key);
+					messages << VERSION_HEADER << lastVersion;
+					messages.serializeBytes(decompressTagMessages(kv.value, arena));
 				}
 
-				if (kvs.expectedSize() >= SERVER_KNOBS->DESIRED_TOTAL_BYTES) {
-					endVersion = decodeTagMessagesKey(kvs.end()[-1].key) + 1;
+				if (limited) {
+					endVersion = lastVersion + 1;
 					onlySpilled = true;
 				} else {
 					messages.serializeBytes(messages2.toValue());
@@ -1992,8 +2146,9 @@ Future<Void> tLogPeekMessages(PromiseType replyPromise,
 				//TraceEvent("TLogPeekResults", self->dbgid).detail("ForAddress", replyPromise.getEndpoint().getPrimaryAddress()).detail("Tag1Results", s1).detail("Tag2Results", s2).detail("Tag1ResultsLim", kv1.size()).detail("Tag2ResultsLim", kv2.size()).detail("Tag1ResultsLast", kv1.size() ? kv1[0].key : "").detail("Tag2ResultsLast", kv2.size() ? kv2[0].key : "").detail("Limited", limited).detail("NextEpoch", next_pos.epoch).detail("NextSeq", next_pos.sequence).detail("NowEpoch", self->epoch()).detail("NowSeq", self->sequence.getNextSequence());
 
 				state std::vector<std::pair<IDiskQueue::location, IDiskQueue::location>> commitLocations;
+				state std::vector<std::vector<uint32_t>> commitMessageOffsets;
 				state bool earlyEnd = false;
-				uint32_t mutationBytes = 0;
+				state uint32_t mutationBytes = 0;
 				state uint64_t commitBytes = 0;
 				state Version firstVersion = std::numeric_limits<Version>::max();
 				for (int i = 0; i < kvrefs.size() && i < SERVER_KNOBS->TLOG_SPILL_REFERENCE_MAX_BATCHES_PER_PEEK; i++) {
@@ -2001,8 +2156,15 @@ Future<Void> tLogPeekMessages(PromiseType replyPromise,
 					VectorRef<SpilledData> spilledData;
 					BinaryReader r(kv.value, AssumeVersion(logData->protocolVersion));
 					r >> spilledData;
+					// Batches spilled with TLOG_SPILL_REFERENCE_MESSAGE_INDEX are followed by the offsets of this tag's
+					// messages in each commit
+					const bool hasMessageIndex = !r.empty();
 					for (const SpilledData& sd : spilledData) {
-						if (mutationBytes >= SERVER_KNOBS->DESIRED_TOTAL_BYTES) {
+						std::vector<uint32_t> offsets;
+						if (hasMessageIndex) {
+							r >> offsets;
+						}
+						if (mutationBytes >= replyByteLimit) {
 							earlyEnd = true;
 							break;
 						}
@@ -2010,6 +2172,7 @@ Future<Void> tLogPeekMessages(PromiseType replyPromise,
 							firstVersion = std::min(firstVersion, sd.version);
 							const IDiskQueue::location end = sd.start.lo + sd.length;
 							commitLocations.emplace_back(sd.start, end);
+							commitMessageOffsets.push_back(std::move(offsets));
 							// This isn't perfect, because we aren't accounting for page boundaries, but should be
 							// close enough.
 							commitBytes += sd.length;
@@ -2030,6 +2193,10 @@ Future<Void> tLogPeekMessages(PromiseType replyPromise,
 				commitLocations.clear();
 				wait(waitForAll(messageReads));
 
+				// mutationBytes excludes the per message length prefixes, so this can still fall a little short
+				messages.reserve(mutationBytes + messageReads.size() * (sizeof(VERSION_HEADER) + sizeof(Version)) +
+				                 messages2.getLength());
+
 				state Version lastRefMessageVersion = 0;
 				state int index = 0;
 				loop {
@@ -2047,8 +2214,13 @@ Future<Void> tLogPeekMessages(PromiseType replyPromise,
 
 					messages << VERSION_HEADER << entry.version;
 
-					std::vector<StringRef> rawMessages =
-					    wait(parseMessagesForTag(entry.messages, reqTag, logData->logRouterTags));
+					state std::vector<StringRef> rawMessages;
+					if (!commitMessageOffsets[index].empty()) {
+						++logData->indexedSpilledPeekCommits;
+						rawMessages = messagesAtOffsets(entry.messages, commitMessageOffsets[index]);
+					} else {
+						wait(store(rawMessages, parseMessagesForTag(entry.messages, reqTag, logData->logRouterTags)));
+					}
 					for (const StringRef& msg : rawMessages) {
 						messages.serializeBytes(msg);
 						DEBUG_TAGS_AND_MESSAGE("TLogPeekFromDisk", entry.version, msg, logData->logId)
@@ -2061,6 +2233,7 @@ Future<Void> tLogPeekMessages(PromiseType replyPromise,
 				}
 
 				messageReads.clear();
+				commitMessageOffsets.clear();
 				memoryReservation.release();
 
 				if (earlyEnd) {
@@ -2074,7 +2247,7 @@ Future<Void> tLogPeekMessages(PromiseType replyPromise,
 			if (reqOnlySpilled) {
 				endVersion = logData->persistentDataDurableVersion + 1;
 			} else {
-				peekMessagesFromMemory(logData, reqTag, reqBegin, messages, endVersion);
+				peekMessagesFromMemory(logData, reqTag, reqBegin, messages, endVersion, replyByteLimit);
 			}
 
 			//TraceEvent("TLogPeekResults", self->dbgid).detail("ForAddress", replyPromise.getEndpoint().getPrimaryAddress()).detail("MessageBytes", messages.getLength()).detail("NextEpoch", next_pos.epoch).detail("NextSeq", next_pos.sequence).detail("NowSeq", self->sequence.getNextSequence());
@@ -2174,17 +2347,32 @@ ACTOR Future<Void> tLogPeekStream(TLogData* self, TLogPeekStreamRequest req, Ref
 
 	state Version begin = req.begin;
 	state bool onlySpilled = false;
-	req.reply.setByteLimit(std::min(SERVER_KNOBS->MAXIMUM_PEEK_BYTES, req.limitBytes));
+	state PeekStreamFlowControl flowControl(std::min<int64_t>(SERVER_KNOBS->MAXIMUM_PEEK_BYTES, req.limitBytes));
+	req.reply.setByteLimit(flowControl.getWindow());
 	loop {
 		state TLogPeekStreamReply reply;
 		state Promise<TLogPeekReply> promise;
 		state Future<TLogPeekReply> future(promise.getFuture());
+		state double readyStart = now();
 		try {
-			wait(req.reply.onReady() && store(reply.rep, future) &&
-			     tLogPeekMessages(promise, self, logData, begin, req.tag, req.returnIfBlocked, onlySpilled));
+			req.reply.setByteLimit(flowControl.update(req.reply.getBytesAcknowledged(), self->peekMemoryPressure()));
+			// Waiting for the window before peeking keeps a stalled consumer from holding peek memory as well
+			wait(req.reply.onReady());
+			state double readyWait = now() - readyStart;
+			wait(store(reply.rep, future) && tLogPeekMessages(promise,
+			                                                  self,
+			                                                  logData,
+			                                                  begin,
+			                                                  req.tag,
+			                                                  req.returnIfBlocked,
+			                                                  onlySpilled,
+			                                                  Optional<std::pair<UID, int>>(),
+			                                                  flowControl.getReplyLimit()));
 
 			reply.rep.begin = begin;
 			req.reply.send(reply);
+			flowControl.addReply(reply.expectedSize(), readyWait);
+			flowControl.logMetrics(logData->logId, req.tag, req.reply.getEndpoint().getPrimaryAddress());
 			begin = reply.rep.end;
 			onlySpilled = reply.rep.onlySpilled;
 			if (reply.rep.end > logData->version.get()) {
@@ -2209,6 +2397,55 @@ ACTOR Future<Void> tLogPeekStream(TLogData* self, TLogPeekStreamRequest req, Ref
 	}
 }
 
+// Each generation's pushes precede the version.set() that makes them visible, so every version a generation has set
+// when a DiskQueue commit is issued will be durable once that commit is. Returns the generations other than logData
+// whose versions are waiting to be committed, along with the versions the commit will make durable for them.
+std::vector<std::pair<Reference<LogData>, Version>> groupCommitGenerations(
+    TLogData* self,
+    Reference<LogData> logData,
+    const std::vector<Reference<LogData>>& missingFinalCommit) {
+	std::vector<std::pair<Reference<LogData>, Version>> generations;
+	if (!SERVER_KNOBS->TLOG_GROUP_COMMIT_GENERATIONS) {
+		return generations;
+	}
+	for (const auto& [id, other] : self->id_data) {
+		if (other == logData ||
+		    std::find(missingFinalCommit.begin(), missingFinalCommit.end(), other) != missingFinalCommit.end()) {
+			continue;
+		}
+		const Version ver = other->version.get();
+		if (ver > std::max(other->queueCommittingVersion, other->queueCommittedVersion.get())) {
+			generations.emplace_back(other, ver);
+		}
+	}
+	return generations;
+}
+
+// Updates logData once its versions up to ver are durable in the DiskQueue
+void queueCommitDurable(TLogData* self, Reference<LogData> logData, Version ver, Version knownCommittedVersion) {
+	logData->durableKnownCommittedVersion = knownCommittedVersion;
+	if (logData->unpoppedRecoveredTagCount == 0 && knownCommittedVersion >= logData->recoveredAt &&
+	    logData->recoveryComplete.canBeSet()) {
+		TraceEvent("TLogRecoveryComplete", logData->logId)
+		    .detail("Tags", logData->unpoppedRecoveredTagCount)
+		    .detail("DurableKCVer", logData->durableKnownCommittedVersion)
+		    .detail("RecoveredAt", logData->recoveredAt);
+		logData->recoveryComplete.send(Void());
+	}
+
+	//TraceEvent("TLogCommitDurable", self->dbgid).detail("Version", ver);
+	if (logData->logSystem->get() &&
+	    (!logData->isPrimary || logData->logRouterPoppedVersion < logData->logRouterPopToVersion)) {
+		logData->logRouterPoppedVersion = ver;
+		DebugLogTraceEvent("LogPop", self->dbgid)
+		    .detail("Tag", logData->remoteTag.toString())
+		    .detail("Version", knownCommittedVersion);
+		logData->logSystem->get()->pop(ver, logData->remoteTag, knownCommittedVersion, logData->locality);
+	}
+
+	logData->queueCommittedVersion.set(ver);
+}
+
 ACTOR Future<Void> doQueueCommit(TLogData* self,
                                  Reference<LogData> logData,
                                  std::vector<Reference<LogData>> missingFinalCommit) {
@@ -2218,6 +2455,15 @@ ACTOR Future<Void> doQueueCommit(TLogData* self,
 	self->queueCommitBegin = commitNumber;
 	logData->queueCommittingVersion = ver;
 
+	// Other generations sharing the DiskQueue ride along on this commit instead of each issuing their own
+	state std::vector<std::pair<Reference<LogData>, Version>> grouped =
+	    groupCommitGenerations(self, logData, missingFinalCommit);
+	state std::vector<Version> groupedKnownCommittedVersions;
+	for (auto& [other, otherVer] : grouped) {
+		other->queueCommittingVersion = otherVer;
+		groupedKnownCommittedVersions.push_back(other->knownCommittedVersion);
+	}
+
 	g_network->setCurrentTask(TaskPriority::TLogCommitReply);
 	Future<Void> c = self->persistentQueue->commit();
 	self->diskQueueCommitBytes = 0;
@@ -2237,27 +2483,20 @@ ACTOR Future<Void> doQueueCommit(TLogData* self,
 
 	ASSERT(ver > logData->queueCommittedVersion.get());
 
-	logData->durableKnownCommittedVersion = knownCommittedVersion;
-	if (logData->unpoppedRecoveredTagCount == 0 && knownCommittedVersion >= logData->recoveredAt &&
-	    logData->recoveryComplete.canBeSet()) {
-		TraceEvent("TLogRecoveryComplete", logData->logId)
-		    .detail("Tags", logData->unpoppedRecoveredTagCount)
-		    .detail("DurableKCVer", logData->durableKnownCommittedVersion)
-		    .detail("RecoveredAt", logData->recoveredAt);
-		logData->recoveryComplete.send(Void());
-	}
-
-	//TraceEvent("TLogCommitDurable", self->dbgid).detail("Version", ver);
-	if (logData->logSystem->get() &&
-	    (!logData->isPrimary || logData->logRouterPoppedVersion < logData->logRouterPopToVersion)) {
-		logData->logRouterPoppedVersion = ver;
-		DebugLogTraceEvent("LogPop", self->dbgid)
-		    .detail("Tag", logData->remoteTag.toString())
-		    .detail("Version", knownCommittedVersion);
-		logData->logSystem->get()->pop(ver, logData->remoteTag, knownCommittedVersion, logData->locality);
+	queueCommitDurable(self, logData, ver, knownCommittedVersion);
+	for (int i = 0; i < grouped.size(); i++) {
+		auto& [other, otherVer] = grouped[i];
+		if (otherVer <= other->queueCommittedVersion.get()) {
+			continue;
+		}
+		CODE_PROBE(true, "TLog generation made durable by another generation's queue commit");
+		if (self->id_data.count(other->logId)) {
+			queueCommitDurable(self, other, otherVer, groupedKnownCommittedVersions[i]);
+		} else {
+			// Removed while the commit was in flight, so only unblock anything still waiting on it
+			other->queueCommittedVersion.set(otherVer);
+		}
 	}
-
-	logData->queueCommittedVersion.set(ver);
 	self->queueCommitEnd.set(commitNumber);
 
 	for (auto& it : missingFinalCommit) {
@@ -3865,6 +4104,173 @@ struct DequeAllocator : std::allocator<T> {
 	}
 };
 
+TEST_CASE("/fdbserver/tlogserver/SpilledValueCompression") {
+	Arena arena;
+	BinaryWriter wr(Unversioned());
+	int messageCount = deterministicRandom()->randomInt(1, 100);
+	for (int i = 0; i < messageCount; i++) {
+		wr << StringRef(std::string(deterministicRandom()->randomInt(1, 200), 'a' + i % 26));
+	}
+	Standalone<StringRef> messages = wr.toValue();
+
+	// Uncompressed values, which always start with a non-zero message length, are returned as is
+	ASSERT(decompressTagMessages(messages, arena) == messages);
+	ASSERT(compressTagMessages(CompressionFilter::NONE, messages, arena) == messages);
+
+	CompressionFilter filter = CompressionUtils::getRandomFilter();
+	StringRef stored = compressTagMessages(filter, messages, arena);
+	ASSERT(stored.size() <= messages.size());
+	ASSERT(decompressTagMessages(stored, arena) == messages);
+
+	return Void();
+}
+
+TEST_CASE("/fdbserver/tlogserver/SpilledMessageIndex") {
+	state Tag tag(1, deterministicRandom()->randomInt(0, 4));
+	state std::vector<uint32_t> offsets;
+	state Standalone<StringRef> commitBlob;
+
+	// Build a commit blob in the format described in LogSystem.h, recording where the messages for tag start
+	BinaryWriter wr(Unversioned());
+	int messageCount = deterministicRandom()->randomInt(1, 50);
+	for (int i = 0; i < messageCount; i++) {
+		std::vector<Tag> tags;
+		for (int t = 0; t < 4; t++) {
+			if (deterministicRandom()->coinflip()) {
+				tags.emplace_back(1, t);
+			}
+		}
+		std::string payload(deterministicRandom()->randomInt(0, 100), 'a' + i % 26);
+		if (std::find(tags.begin(), tags.end(), tag) != tags.end()) {
+			offsets.push_back(wr.getLength());
+		}
+		int32_t messageLength = sizeof(uint32_t) + sizeof(uint16_t) + tags.size() * sizeof(Tag) + payload.size();
+		wr << messageLength << uint32_t(i) << uint16_t(tags.size());
+		for (const Tag& t : tags) {
+			wr.serializeBytes(&t, sizeof(Tag));
+		}
+		wr.serializeBytes(payload.data(), payload.size());
+	}
+	commitBlob = wr.toValue();
+
+	std::vector<StringRef> parsed = wait(parseMessagesForTag(commitBlob, tag, 0));
+	std::vector<StringRef> indexed = messagesAtOffsets(commitBlob, offsets);
+	ASSERT(parsed.size() == indexed.size());
+	for (int i = 0; i < parsed.size(); i++) {
+		ASSERT(parsed[i] == indexed[i]);
+		ASSERT(parsed[i].begin() == indexed[i].begin());
+	}
+
+	return Void();
+}
+
+TEST_CASE("/fdbserver/tlogserver/PeekStreamFlowControl") {
+	if (!SERVER_KNOBS->PEEK_STREAM_ADAPTIVE_FLOW_CONTROL) {
+		return Void();
+	}
+	const int64_t requested = 10e6;
+	const int64_t minWindow = std::min(requested, SERVER_KNOBS->PEEK_STREAM_MIN_WINDOW_BYTES);
+	PeekStreamFlowControl flowControl(requested);
+
+	// A consumer that has not acknowledged anything is held to the minimum window
+	ASSERT(flowControl.update(0, 0) == minWindow);
+	ASSERT(flowControl.getReplyLimit() ==
+	       std::max(SERVER_KNOBS->DESIRED_TOTAL_BYTES, SERVER_KNOBS->PEEK_STREAM_MIN_REPLY_BYTES));
+
+	// A fast consumer grows the window, but never past what it asked for
+	const int64_t acknowledged = 1e12;
+	ASSERT(flowControl.update(acknowledged, 0) == requested);
+
+	// Full memory pressure shrinks both the window and the replies to their minimums
+	ASSERT(flowControl.update(acknowledged, 1.0) == minWindow);
+	ASSERT(flowControl.getReplyLimit() == SERVER_KNOBS->PEEK_STREAM_MIN_REPLY_BYTES);
+
+	return Void();
+}
+
+TEST_CASE("/fdbserver/tlogserver/TagMessageIndex") {
+	typedef std::pair<Version, LengthPrefixedStringRef> TestType; // what versionMessages used to hold
+
+	// Messages in a few separate buffers, as they are in a TLog's message blocks
+	std::vector<std::vector<uint32_t>> buffers(deterministicRandom()->randomInt(1, 4));
+	for (auto& buffer : buffers) {
+		buffer.resize(1000);
+	}
+	DequeAllocatorStats::allocatedBytes = 0;
+	std::deque<TestType, DequeAllocator<TestType>> expected;
+	TagMessageIndex index;
+	Version version = deterministicRandom()->randomInt64(0, 1e12);
+	int buffer = 0;
+	int position = 0;
+	for (int i = 0; i < 20000; i++) {
+		if (deterministicRandom()->random01() < 0.3) {
+			// Mostly a few versions at a time, sometimes a big gap
+			version += deterministicRandom()->random01() < 0.001 ? deterministicRandom()->randomInt64(1, 1e11)
+			                                                    : deterministicRandom()->randomInt(1, 100);
+		}
+		if (deterministicRandom()->random01() < 0.001) {
+			buffer = deterministicRandom()->randomInt(0, buffers.size());
+			position = 0;
+		}
+		position = std::min<int>(position + deterministicRandom()->randomInt(0, 3), buffers[buffer].size() - 1);
+		LengthPrefixedStringRef message(&buffers[buffer][position]);
+		expected.emplace_back(version, message);
+		index.push_back(version, message);
+
+		if (deterministicRandom()->random01() < 0.4) {
+			expected.pop_front();
+			index.pop_front();
+		}
+		ASSERT_EQ(index.size(), expected.size());
+		if (!expected.empty()) {
+			ASSERT_EQ(index.frontVersion(), expected.front().first);
+			ASSERT(index.frontMessage().getLengthPtr() == expected.front().second.getLengthPtr());
+			ASSERT_EQ(index.backVersion(), expected.back().first);
+		}
+	}
+
+	// Iteration and searches see what a deque holds
+	auto it = index.begin();
+	for (const auto& [v, m] : expected) {
+		ASSERT(it != index.end());
+		ASSERT(it.version() == v && it.message().getLengthPtr() == m.getLengthPtr());
+		++it;
+	}
+	ASSERT(it == index.end());
+	for (int i = 0; i < 100; i++) {
+		const Version front = expected.front().first;
+		Version v = front + deterministicRandom()->randomInt64(-1, version - front + 2);
+		auto lower = std::lower_bound(
+		    expected.begin(), expected.end(), v, [](const TestType& l, Version r) { return l.first < r; });
+		auto upper = std::upper_bound(
+		    expected.begin(), expected.end(), v, [](Version l, const TestType& r) { return l < r.first; });
+		auto indexLower = index.lowerBound(v);
+		auto indexUpper = index.upperBound(v);
+		ASSERT((lower == expected.end()) == (indexLower == index.end()));
+		ASSERT((upper == expected.end()) == (indexUpper == index.end()));
+		if (lower != expected.end()) {
+			ASSERT(indexLower.message().getLengthPtr() == lower->second.getLengthPtr());
+		}
+		if (upper != expected.end()) {
+			ASSERT(indexUpper.message().getLengthPtr() == upper->second.getLengthPtr());
+		}
+	}
+
+	// A tag with many messages takes about half the memory it took in a deque
+	int64_t dequeBytes = DequeAllocatorStats::allocatedBytes + sizeof(std::deque<TestType>);
+	TraceEvent("TagMessageIndexBytes")
+	    .detail("Messages", expected.size())
+	    .detail("DequeBytes", dequeBytes)
+	    .detail("IndexBytes", index.allocatedBytes());
+	ASSERT_LT(index.allocatedBytes() * 3, dequeBytes * 2);
+
+	while (!index.empty()) {
+		index.pop_front();
+	}
+	ASSERT_EQ(index.allocatedBytes(), 0);
+	return Void();
+}
+
 TEST_CASE("Lfdbserver/tlogserver/VersionMessagesOverheadFactor") {
 
 	typedef std::pair<Version, LengthPrefixedStringRef> TestType; // type used by versionMessages
@@ -2210,6 +2210,7 @@ ACTOR Future<Void> TagPartitionedLogSystem::epochEnd(Reference<AsyncVar<Referenc
 	}
 
 	CODE_PROBE(true, "Master recovery from pre-existing database");
+	state double startTime = now();
 
 	// trackRejoins listens for rejoin requests from the tLogs that we are recovering from, to learn their
 	// TLogInterfaces
@@ -2355,6 +2356,7 @@ ACTOR Future<Void> TagPartitionedLogSystem::epochEnd(Reference<AsyncVar<Referenc
 		}
 		if (maxEnd > 0 && (!lastEnd.present() || maxEnd < lastEnd.get())) {
 			CODE_PROBE(lastEnd.present(), "Restarting recovery at an earlier point");
+			const bool restarted = lastEnd.present();
 
 			auto logSystem = makeReference<TagPartitionedLogSystem>(dbgid, locality, prevState.recoveryCount);
 
@@ -2377,9 +2379,22 @@ ACTOR Future<Void> TagPartitionedLogSystem::epochEnd(Reference<AsyncVar<Referenc
 				knownCommittedVersion = minEnd;
 			}
 			logSystem->knownCommittedVersion = knownCommittedVersion;
-			TraceEvent(SevDebug, "FinalRecoveryVersionInfo")
+			int locked = 0;
+			int lockRequests = 0;
+			for (const auto& lockResult : lockResults) {
+				for (const auto& reply : lockResult.replies) {
+					locked += reply.isReady() && !reply.isError();
+					++lockRequests;
+				}
+			}
+			TraceEvent("FinalRecoveryVersionInfo", dbgid)
 			    .detail("KCV", knownCommittedVersion)
-			    .detail("MinEnd", minEnd);
+			    .detail("MinEnd", minEnd)
+			    .detail("RecoverAt", logSystem->recoverAt)
+			    .detail("Locked", locked)
+			    .detail("LockRequests", lockRequests)
+			    .detail("Restarted", restarted)
+			    .detail("Duration", now() - startTime);
 			logSystem->remoteLogsWrittenToCoreState = true;
 			logSystem->stopped = true;
 			logSystem->pseudoLocalities = prevState.pseudoLocalities;
@@ -3254,13 +3269,17 @@ ACTOR Future<TLogLockResult> TagPartitionedLogSystem::lockTLog(
     UID myID,
     Reference<AsyncVar<OptionalInterface<TLogInterface>>> tlog) {
 
+	state double startTime = now();
 	TraceEvent("TLogLockStarted", myID).detail("TLog", tlog->get().id()).detail("InfPresent", tlog->get().present());
 	loop {
 		choose {
 			when(TLogLockResult data = wait(
 			         tlog->get().present() ? brokenPromiseToNever(tlog->get().interf().lock.getReply<TLogLockResult>())
 			                               : Never())) {
-				TraceEvent("TLogLocked", myID).detail("TLog", tlog->get().id()).detail("End", data.end);
+				TraceEvent("TLogLocked", myID)
+				    .detail("TLog", tlog->get().id())
+				    .detail("End", data.end)
+				    .detail("Latency", now() - startTime);
 				return data;
 			}
 			when(wait(tlog->onChange())) {}
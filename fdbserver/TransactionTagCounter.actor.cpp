@@ -62,8 +62,13 @@ public:
 	  : thisServerID(thisServerID), maxTagsTracked(maxTagsTracked), minRateTracked(minRateTracked),
 	    busiestReadTagEventHolder(makeReference<EventCacheHolder>(thisServerID.toString() + "/BusiestReadTag")) {}
 
-	void addRequest(Optional<TagSet> const& tags, int64_t bytes) {
-		auto const cost = getReadOperationCost(bytes);
+	void addRequest(Optional<TagSet> const& tags, int64_t bytes, ReadEngineCost const& engineCost) {
+		double cost = getReadOperationCost(bytes);
+		if (SERVER_KNOBS->GLOBAL_TAG_THROTTLING_ENGINE_READ_COST) {
+			cost = getReadOperationCost(std::max(bytes, engineCost.bytesScanned)) +
+			       engineCost.reads * SERVER_KNOBS->GLOBAL_TAG_THROTTLING_PAGES_PER_ENGINE_READ *
+			           CLIENT_KNOBS->TAG_THROTTLING_PAGE_SIZE;
+		}
 		intervalTotalCost += cost;
 		if (tags.present()) {
 			for (auto const& tag : tags.get()) {
@@ -118,7 +123,13 @@ TransactionTagCounter::TransactionTagCounter(UID thisServerID, int maxTagsTracke
 TransactionTagCounter::~TransactionTagCounter() = default;
 
 void TransactionTagCounter::addRequest(Optional<TagSet> const& tags, int64_t bytes) {
-	return impl->addRequest(tags, bytes);
+	return impl->addRequest(tags, bytes, ReadEngineCost());
+}
+
+void TransactionTagCounter::addRequest(Optional<TagSet> const& tags,
+                                       int64_t bytes,
+                                       ReadEngineCost const& engineCost) {
+	return impl->addRequest(tags, bytes, engineCost);
 }
 
 void TransactionTagCounter::startNewInterval() {
@@ -183,3 +194,25 @@ TEST_CASE("/fdbserver/TransactionTagCounter/IgnoreBelowMinRate") {
 	}
 	return Void();
 }
+
+TEST_CASE("/fdbserver/TransactionTagCounter/EngineReadCost") {
+	state TransactionTagCounter counter(UID(),
+	                                    /*maxTagsTracked=*/2,
+	                                    /*minRateTracked=*/10.0 * CLIENT_KNOBS->TAG_THROTTLING_PAGE_SIZE /
+	                                        CLIENT_KNOBS->READ_TAG_SAMPLE_RATE);
+	state bool engineReadCost = SERVER_KNOBS->GLOBAL_TAG_THROTTLING_ENGINE_READ_COST;
+	counter.startNewInterval();
+	{
+		wait(delay(1.0));
+		// A scan that returns little but reads a lot from the engine is only busy if engine work is counted
+		ReadEngineCost engineCost;
+		engineCost.bytesScanned = 20 * CLIENT_KNOBS->TAG_THROTTLING_PAGE_SIZE;
+		engineCost.reads = 1;
+		counter.addRequest(getTagSet("tagA"_sr), CLIENT_KNOBS->TAG_THROTTLING_PAGE_SIZE, engineCost);
+		counter.startNewInterval();
+		auto const busiestTags = counter.getBusiestTags();
+		ASSERT_EQ(busiestTags.size(), engineReadCost ? 1 : 0);
+		ASSERT_EQ(containsTag(busiestTags, "tagA"_sr), engineReadCost);
+	}
+	return Void();
+}
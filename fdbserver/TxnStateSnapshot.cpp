@@ -0,0 +1,138 @@
+/*
+ * TxnStateSnapshot.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbserver/TxnStateSnapshot.h"
+
+#include <cstring>
+
+#include "fdbclient/SystemData.h"
+#include "fdbserver/Knobs.h"
+#include "flow/UnitTest.h"
+
+Standalone<StringRef> encodeTxnStateSnapshot(VectorRef<KeyValueRef> data, CompressionFilter filter) {
+	BinaryWriter wr(Unversioned());
+	wr << (uint32_t)data.size();
+	KeyRef prev;
+	for (const auto& kv : data) {
+		const int shared = commonPrefixLength(prev, kv.key);
+		wr << (uint32_t)shared << kv.key.substr(shared) << kv.value;
+		prev = kv.key;
+	}
+
+	Standalone<StringRef> snapshot;
+	StringRef payload = filter == CompressionFilter::NONE
+	                        ? wr.toValue()
+	                        : CompressionUtils::compress(filter, wr.toValue(), snapshot.arena());
+	uint8_t* buf = new (snapshot.arena()) uint8_t[sizeof(uint8_t) + payload.size()];
+	buf[0] = (uint8_t)filter;
+	memcpy(buf + sizeof(uint8_t), payload.begin(), payload.size());
+	((StringRef&)snapshot) = StringRef(buf, sizeof(uint8_t) + payload.size());
+	return snapshot;
+}
+
+VectorRef<KeyValueRef> decodeTxnStateSnapshot(StringRef snapshot, Arena& arena) {
+	if (snapshot.empty() || snapshot[0] >= (uint8_t)CompressionFilter::LAST) {
+		throw serialization_failed();
+	}
+	const CompressionFilter filter = (CompressionFilter)snapshot[0];
+	CompressionUtils::checkFilterSupported(filter);
+	StringRef payload = snapshot.substr(sizeof(uint8_t));
+	if (filter != CompressionFilter::NONE) {
+		payload = CompressionUtils::decompress(filter, payload, arena);
+	}
+
+	// Suffixes and values point into payload, which is in arena or outlives it along with snapshot, and keys are
+	// rebuilt from them in arena
+	ArenaReader rd(arena, payload, Unversioned());
+	uint32_t count;
+	rd >> count;
+	VectorRef<KeyValueRef> data;
+	data.resize(arena, count);
+	KeyRef prev;
+	for (auto& kv : data) {
+		uint32_t shared;
+		StringRef suffix;
+		rd >> shared >> suffix >> kv.value;
+		if (shared > prev.size()) {
+			throw serialization_failed();
+		}
+		uint8_t* key = new (arena) uint8_t[shared + suffix.size()];
+		memcpy(key, prev.begin(), shared);
+		memcpy(key + shared, suffix.begin(), suffix.size());
+		kv.key = KeyRef(key, shared + suffix.size());
+		prev = kv.key;
+	}
+	if (!rd.empty()) {
+		throw serialization_failed();
+	}
+	return data;
+}
+
+CompressionFilter getTxnStateSnapshotCompressionFilter() {
+	CompressionFilter filter = CompressionUtils::fromFilterString(SERVER_KNOBS->TXN_STATE_SNAPSHOT_COMPRESSION_FILTER);
+	// Recovery sends uncompressed snapshots rather than fail if the filter isn't built in
+	if (!CompressionUtils::supportedFilters.count(filter)) {
+		return CompressionFilter::NONE;
+	}
+	return filter;
+}
+
+TEST_CASE("/fdbserver/TxnStateSnapshot/encoding") {
+	Arena arena;
+	std::vector<KeyValueRef> kvs;
+	const int count = deterministicRandom()->randomInt(0, 1000);
+	for (int i = 0; i < count; ++i) {
+		Key key = deterministicRandom()->coinflip()
+		              ? keyServersKey(StringRef(deterministicRandom()->randomAlphaNumeric(10)))
+		              : serverKeysKey(deterministicRandom()->randomUniqueID(),
+		                              StringRef(deterministicRandom()->randomAlphaNumeric(10)));
+		kvs.emplace_back(arena, KeyValueRef(key, StringRef(deterministicRandom()->randomAlphaNumeric(20))));
+	}
+	std::sort(kvs.begin(), kvs.end(), KeyValueRef::OrderByKey());
+	kvs.erase(std::unique(kvs.begin(),
+	                      kvs.end(),
+	                      [](const KeyValueRef& a, const KeyValueRef& b) { return a.key == b.key; }),
+	          kvs.end());
+	if (!kvs.empty() && deterministicRandom()->coinflip()) {
+		// The empty key and empty values are kept
+		kvs.front() = KeyValueRef();
+	}
+	VectorRef<KeyValueRef> data(kvs.data(), kvs.size());
+
+	int64_t bytes = 0;
+	for (const auto& kv : data) {
+		bytes += kv.expectedSize();
+	}
+	for (CompressionFilter filter : CompressionUtils::supportedFilters) {
+		Standalone<StringRef> snapshot = encodeTxnStateSnapshot(data, filter);
+		Arena decodeArena;
+		VectorRef<KeyValueRef> decoded = decodeTxnStateSnapshot(snapshot, decodeArena);
+		ASSERT(decoded.size() == data.size());
+		for (int i = 0; i < data.size(); ++i) {
+			ASSERT(decoded[i] == data[i]);
+		}
+		TraceEvent("TxnStateSnapshotEncoding")
+		    .detail("Filter", CompressionUtils::toString(filter))
+		    .detail("Count", data.size())
+		    .detail("Bytes", bytes)
+		    .detail("SnapshotBytes", snapshot.size());
+	}
+	return Void();
+}
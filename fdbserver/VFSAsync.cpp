@@ -28,6 +28,7 @@
 #include "fdbrpc/simulator.h"
 #include "fdbrpc/SimulatorProcessInfo.h"
 #include "fdbrpc/AsyncFileReadAhead.actor.h"
+#include "fdbserver/Knobs.h"
 
 #include <assert.h>
 #include <string.h>
@@ -63,7 +64,7 @@ const uint32_t RESERVED_COUNT = 1U << 29;
 
 VFSAsyncFile::VFSAsyncFile(std::string const& filename, int flags)
   : flags(flags), filename(filename), pLockCount(&filename_lockCount_openCount[filename].first), debug_zcrefs(0),
-    debug_zcreads(0), debug_reads(0), chunkSize(0) {
+    debug_zcreads(0), debug_reads(0), chunkSize(0), readAheadNextOffset(0), readAheadForwardReads(0), readAheadEnd(0) {
 	filename_lockCount_openCount[filename].second++;
 
 	TraceEvent(SevDebug, "VFSAsyncFileConstruct")
@@ -88,10 +89,48 @@ static int asyncClose(sqlite3_file* pFile) {
 	return SQLITE_OK;
 }
 
+// Called before each read of the database file. Once a connection has read forward through the file a few times, the
+// pages after its read are read ahead so that they are in the page cache by the time SQLite asks for them. A forward
+// read may skip pages, because SQLite doesn't reread the interior pages it has cached and leaf pages are not always
+// contiguous. Errors are left to the reads SQLite issues for those pages.
+static void readAhead(VFSAsyncFile* p, int iAmt, sqlite_int64 iOfst) {
+	if ((p->flags & SQLITE_OPEN_WAL) || SERVER_KNOBS->SQLITE_READ_AHEAD_PAGES <= 0) {
+		return;
+	}
+	const int64_t readAheadBytes = (int64_t)SERVER_KNOBS->SQLITE_READ_AHEAD_PAGES * iAmt;
+	if (iOfst >= p->readAheadNextOffset && iOfst < p->readAheadNextOffset + readAheadBytes) {
+		++p->readAheadForwardReads;
+	} else {
+		p->readAheadForwardReads = 0;
+		p->readAheadEnd = 0;
+	}
+	p->readAheadNextOffset = iOfst + iAmt;
+
+	// Read ahead again once half of the previous read ahead has been used up
+	if (p->readAheadForwardReads < SERVER_KNOBS->SQLITE_READ_AHEAD_FORWARD_READS ||
+	    p->readAheadEnd - p->readAheadNextOffset >= readAheadBytes / 2 ||
+	    (p->readAhead.isValid() && !p->readAhead.isReady())) {
+		return;
+	}
+	Future<int64_t> fileSize = p->file->size();
+	if (!fileSize.isReady() || fileSize.isError()) {
+		return;
+	}
+	const int64_t begin = std::max(p->readAheadEnd, p->readAheadNextOffset);
+	const int64_t end = std::min(p->readAheadNextOffset + readAheadBytes, fileSize.get());
+	if (end <= begin) {
+		return;
+	}
+	Standalone<StringRef> buffer = makeString(end - begin);
+	p->readAhead = success(errorOr(holdWhile(buffer, p->file->read(mutateString(buffer), end - begin, begin))));
+	p->readAheadEnd = end;
+}
+
 static int asyncRead(sqlite3_file* pFile, void* zBuf, int iAmt, sqlite_int64 iOfst) {
 	VFSAsyncFile* p = (VFSAsyncFile*)pFile;
 	try {
 		++p->debug_reads;
+		readAhead(p, iAmt, iOfst);
 		int readBytes = waitForAndGet(p->file->read(zBuf, iAmt, iOfst));
 		if (readBytes < iAmt) {
 			memset((uint8_t*)zBuf + readBytes, 0, iAmt - readBytes); // When reading past the EOF, sqlite expects the
@@ -126,6 +165,7 @@ static int asyncReadZeroCopy(sqlite3_file* pFile, void** data, int iAmt, sqlite_
 	VFSAsyncFile* p = (VFSAsyncFile*)pFile;
 	try {
 		int readBytes = iAmt;
+		readAhead(p, iAmt, iOfst);
 		Future<Void> readFuture = p->file->readZeroCopy(data, &readBytes, iOfst);
 		if (pDataWasCached)
 			*pDataWasCached = readFuture.isReady() ? 1 : 0;
@@ -21,10 +21,12 @@
 #include "fdbclient/CommitTransaction.h"
 #include "fdbclient/FDBTypes.h"
 #include "fdbclient/GetEncryptCipherKeys.h"
+#include "fdbclient/JsonBuilder.h"
 #include "fdbclient/RandomKeyValueUtils.h"
 #include "fdbclient/Tuple.h"
-#include "fdbrpc/DDSketch.h"
+#include "flow/DDSketch.h"
 #include "fdbrpc/simulator.h"
+#include "fdbserver/art.h"
 #include "fdbserver/DeltaTree.h"
 #include "fdbserver/IKeyValueStore.h"
 #include "fdbserver/IPager.h"
@@ -33,6 +35,7 @@
 #include "fdbserver/VersionedBTreeDebug.h"
 #include "fdbserver/WorkerInterface.actor.h"
 #include "flow/ActorCollection.h"
+#include "flow/CompressionUtils.h"
 #include "flow/Error.h"
 #include "flow/FastRef.h"
 #include "flow/flow.h"
@@ -40,11 +43,13 @@
 #include "flow/Histogram.h"
 #include "flow/IAsyncFile.h"
 #include "flow/IRandom.h"
+#include "flow/IThreadPool.h"
 #include "flow/Knobs.h"
 #include "flow/ObjectSerializer.h"
 #include "flow/PriorityMultiLock.actor.h"
 #include "flow/network.h"
 #include "flow/serialize.h"
+#include "flow/ThreadHelper.actor.h"
 #include "flow/Trace.h"
 #include "flow/UnitTest.h"
 #include "fmt/format.h"
@@ -53,6 +58,7 @@
 #include <cinttypes>
 #include <limits>
 #include <map>
+#include <numeric>
 #include <random>
 #include <string>
 #include <unordered_map>
@@ -1459,8 +1465,29 @@ struct RedwoodMetrics {
 		unsigned int pagerProbeMiss;
 		unsigned int pagerEvictUnhit;
 		unsigned int pagerEvictFail;
+		unsigned int pagerCacheProbationHit;
+		unsigned int pagerCacheProtectedHit;
+		unsigned int pagerCacheDemote;
+		unsigned int pagerCompressedWrite;
+		// Blocks not written because multi-block nodes were compressed into fewer blocks
+		unsigned int pagerCompressSavedBlocks;
+		unsigned int pagerDecompress;
+		// Pages encrypted on helper threads
+		unsigned int pagerEncodeOffload;
 		unsigned int btreeLeafPreload;
 		unsigned int btreeLeafPreloadExt;
+		unsigned int btreeLeafPreloadUsed;
+		// Bytes of preloaded leaves that the cursor did not reach
+		unsigned int btreeLeafPreloadWasted;
+		// Level 2 pages whose leaves were checked for scattering, the ones whose leaves were moved together, and the
+		// leaves moved
+		unsigned int btreeRelocateScan;
+		unsigned int btreeRelocateSubtree;
+		unsigned int btreeRelocateLeaf;
+		// Values stored outside of their leaf records that were written, read, and freed
+		unsigned int btreeValueExternalWrite;
+		unsigned int btreeValueExternalRead;
+		unsigned int btreeValueExternalFree;
 		unsigned int readRequestDecryptTimeNS;
 	};
 
@@ -1636,12 +1663,14 @@ class ObjectCache : NonCopyable {
 	typedef std::unordered_map<IndexType, Entry> CacheT;
 
 	struct Entry : public boost::intrusive::list_base_hook<> {
-		Entry() : hits(0), size(0) {}
+		Entry() : hits(0), size(0), probationary(false) {}
 		IndexType index;
 		ObjectType item;
 		int hits;
 		int size;
 		bool ownedByEvictor;
+		// If owned by the evictor, whether the entry is in its probationary segment
+		bool probationary;
 		CacheT* pCache;
 	};
 
@@ -1652,6 +1681,11 @@ public:
 	// Not all objects tracked by the Evictor are in its evictionOrder, as ObjectCaches
 	// using this Evictor can temporarily remove entries to an external order but they
 	// must eventually give them back with moveIn() or remove them with reclaim().
+	//
+	// The eviction order is a segmented LRU. Entries are evicted from the probationary segment first, which holds
+	// entries admitted by scans, entries given back with moveIn(), and entries demoted from the protected segment
+	// once it holds more than REDWOOD_PAGE_CACHE_PROTECTED_FRACTION of sizeLimit. An entry is promoted to the
+	// protected segment by a hit which is not itself part of a scan, so a scan can't evict the working set.
 	class Evictor : NonCopyable {
 	public:
 		Evictor(int64_t sizeLimit = 0) : sizeLimit(sizeLimit) {}
@@ -1672,15 +1706,27 @@ public:
 		// but the entry size is still counted against the evictor
 		void moveOut(Entry& e, EvictionOrderT& dest) {
 			ASSERT(e.ownedByEvictor);
-			dest.splice(dest.end(), evictionOrder, EvictionOrderT::s_iterator_to(e));
+			dest.splice(dest.end(), segmentOf(e), EvictionOrderT::s_iterator_to(e));
+			if (!e.probationary) {
+				protectedSize -= e.size;
+			}
 			e.ownedByEvictor = false;
 			++movedOutCount;
 		}
 
-		// Move an entry to the back of the eviction order if it is in the eviction order
-		void moveToBack(Entry& e) {
+		// Move an entry to the back of its segment of the eviction order, promoting it to the protected segment
+		// unless the access is part of a scan
+		void moveToBack(Entry& e, bool scan = false) {
 			ASSERT(e.ownedByEvictor);
-			evictionOrder.splice(evictionOrder.end(), evictionOrder, EvictionOrderT::s_iterator_to(e));
+			if (e.probationary && !scan) {
+				evictionOrder.splice(evictionOrder.end(), probation, EvictionOrderT::s_iterator_to(e));
+				e.probationary = false;
+				protectedSize += e.size;
+				demoteExcess();
+			} else {
+				EvictionOrderT& segment = segmentOf(e);
+				segment.splice(segment.end(), segment, EvictionOrderT::s_iterator_to(e));
+			}
 		}
 
 		// Move entire contents of an external eviction order containing entries whose size is part of
@@ -1689,25 +1735,45 @@ public:
 			for (auto& e : otherOrder) {
 				ASSERT(!e.ownedByEvictor);
 				e.ownedByEvictor = true;
+				e.probationary = true;
 				--movedOutCount;
 			}
-			evictionOrder.splice(evictionOrder.begin(), otherOrder);
+			probation.splice(probation.begin(), otherOrder);
 		}
 
-		// Add a new item to the back of the eviction order
-		void addNew(Entry& e) {
+		// Add a new item to the back of the eviction order, in the probationary segment if scan is set
+		void addNew(Entry& e, bool scan = false) {
 			sizeUsed += e.size;
-			evictionOrder.push_back(e);
 			e.ownedByEvictor = true;
+			e.probationary = scan;
+			if (scan) {
+				probation.push_back(e);
+			} else {
+				evictionOrder.push_back(e);
+				protectedSize += e.size;
+				demoteExcess();
+			}
+		}
+
+		// Change the size counted for an entry, which may be in an external eviction order
+		void resize(Entry& e, int size) {
+			sizeUsed += size - e.size;
+			if (e.ownedByEvictor && !e.probationary) {
+				protectedSize += size - e.size;
+			}
+			e.size = size;
 		}
 
 		// Claim ownership of an entry, removing its size from the current size and removing it
 		// from the eviction order if it exists there
 		void reclaim(Entry& e) {
 			sizeUsed -= e.size;
-			// If e is in evictionOrder then remove it
+			// If e is in the eviction order then remove it
 			if (e.ownedByEvictor) {
-				evictionOrder.erase(EvictionOrderT::s_iterator_to(e));
+				segmentOf(e).erase(EvictionOrderT::s_iterator_to(e));
+				if (!e.probationary) {
+					protectedSize -= e.size;
+				}
 				e.ownedByEvictor = false;
 			} else {
 				// Otherwise, it wasn't so it had to be a movedOut item so decrement the count
@@ -1719,12 +1785,13 @@ public:
 			int attemptsLeft = FLOW_KNOBS->MAX_EVICT_ATTEMPTS;
 			// While the cache is too big, evict the oldest entry until the oldest entry can't be evicted.
 			while (attemptsLeft-- > 0 && sizeUsed > (sizeLimit - reservedSize - additionalSpaceNeeded) &&
-			       !evictionOrder.empty()) {
-				Entry& toEvict = evictionOrder.front();
+			       (!probation.empty() || !evictionOrder.empty())) {
+				EvictionOrderT& segment = probation.empty() ? evictionOrder : probation;
+				Entry& toEvict = segment.front();
 
 				debug_printf("Evictor count=%d sizeUsed=%" PRId64 " sizeLimit=%" PRId64 " sizePenalty=%" PRId64
 				             " needed=%d  Trying to evict %s evictable %d\n",
-				             (int)evictionOrder.size(),
+				             (int)getCountUsed(),
 				             sizeUsed,
 				             sizeLimit,
 				             reservedSize,
@@ -1734,7 +1801,7 @@ public:
 
 				if (!toEvict.item.evictable()) {
 					// shift the front to the back
-					evictionOrder.shift_forward(1);
+					segment.shift_forward(1);
 					++g_redwoodMetrics.metric.pagerEvictFail;
 					break;
 				} else {
@@ -1742,16 +1809,20 @@ public:
 						++g_redwoodMetrics.metric.pagerEvictUnhit;
 					}
 					sizeUsed -= toEvict.size;
+					if (!toEvict.probationary) {
+						protectedSize -= toEvict.size;
+					}
 					debug_printf("Evicting %s\n", ::toString(toEvict.index).c_str());
-					evictionOrder.pop_front();
+					segment.pop_front();
 					toEvict.pCache->erase(toEvict.index);
 				}
 			}
 		}
 
-		int64_t getCountUsed() const { return evictionOrder.size() + movedOutCount; }
+		int64_t getCountUsed() const { return probation.size() + evictionOrder.size() + movedOutCount; }
 		int64_t getCountMoved() const { return movedOutCount; }
 		int64_t getSizeUsed() const { return sizeUsed + reservedSize; }
+		int64_t getProtectedSize() const { return protectedSize; }
 
 		// Only to be used in tests at a point where all ObjectCache instances should be destroyed.
 		bool empty() const { return reservedSize == 0 && sizeUsed == 0 && getCountUsed() == 0; }
@@ -1764,11 +1835,14 @@ public:
 			                       getCountUsed(),
 			                       reservedSize,
 			                       movedOutCount);
-			for (auto& entry : evictionOrder) {
-				s += format("\n\tindex %s  size %d  evictable %d\n",
-				            ::toString(entry.index).c_str(),
-				            entry.size,
-				            entry.item.evictable());
+			for (auto const* segment : { &probation, &evictionOrder }) {
+				for (auto& entry : *segment) {
+					s += format("\n\tindex %s  size %d  evictable %d  probationary %d\n",
+					            ::toString(entry.index).c_str(),
+					            entry.size,
+					            entry.item.evictable(),
+					            entry.probationary);
+				}
 			}
 			s += "}\n";
 			return s;
@@ -1780,11 +1854,30 @@ public:
 		int64_t sizeLimit;
 
 	private:
+		// The probationary and protected segments of the eviction order
+		EvictionOrderT probation;
 		EvictionOrderT evictionOrder;
 		// Size of all entries in the eviction order or held in external eviction orders
 		int64_t sizeUsed = 0;
+		// Size of the entries in the protected segment
+		int64_t protectedSize = 0;
 		// Number of items that have been moveOut()'d to other evictionOrders and aren't back yet
 		int64_t movedOutCount = 0;
+
+		EvictionOrderT& segmentOf(Entry& e) { return e.probationary ? probation : evictionOrder; }
+
+		// Demote the least recently used protected entries to the back of the probationary segment while the
+		// protected segment is over its share of the size limit
+		void demoteExcess() {
+			const int64_t protectedLimit = sizeLimit * SERVER_KNOBS->REDWOOD_PAGE_CACHE_PROTECTED_FRACTION;
+			while (protectedSize > protectedLimit && evictionOrder.size() > 1) {
+				Entry& e = evictionOrder.front();
+				probation.splice(probation.end(), evictionOrder, EvictionOrderT::s_iterator_to(e));
+				e.probationary = true;
+				protectedSize -= e.size;
+				++g_redwoodMetrics.metric.pagerCacheDemote;
+			}
+		}
 	};
 
 	ObjectCache(Evictor* evictor = nullptr) : pEvictor(evictor) {
@@ -1819,10 +1912,11 @@ public:
 	}
 
 	// Get the object for i or create a new one.
-	// After a get(), the object for i is the last in evictionOrder.
+	// After a get(), the object for i is the last in its segment of the eviction order.
 	// If noHit is set, do not consider this access to be cache hit if the object is present
-	// If noMiss is set, do not consider this access to be a cache miss if the object is not present
-	ObjectType& get(const IndexType& index, int size, bool noHit = false) {
+	// If scan is set, the access is part of a scan, so a new object is admitted to the probationary segment and a
+	// hit does not promote the object to the protected segment
+	ObjectType& get(const IndexType& index, int size, bool noHit = false, bool scan = false) {
 		Entry& entry = cache[index];
 
 		// If entry is linked into an evictionOrder
@@ -1832,7 +1926,12 @@ public:
 				++entry.hits;
 				// If item eviction is not prioritized, move to end of eviction order
 				if (entry.ownedByEvictor) {
-					pEvictor->moveToBack(entry);
+					if (entry.probationary) {
+						++g_redwoodMetrics.metric.pagerCacheProbationHit;
+					} else {
+						++g_redwoodMetrics.metric.pagerCacheProtectedHit;
+					}
+					pEvictor->moveToBack(entry, scan);
 				}
 			}
 		} else {
@@ -1845,12 +1944,21 @@ public:
 			entry.size = size;
 
 			pEvictor->trim(entry.size);
-			pEvictor->addNew(entry);
+			pEvictor->addNew(entry, scan);
 		}
 
 		return entry.item;
 	}
 
+	// Change the size counted for the object for index if it exists, such as once the object's actual size is known.
+	// The cache is trimmed to its size limit by the next get() of a new object.
+	void resize(const IndexType& index, int size) {
+		auto i = cache.find(index);
+		if (i != cache.end()) {
+			pEvictor->resize(i->second, size);
+		}
+	}
+
 	// Clears the cache, saving the entries to second cache, then waits for each item to be evictable and evicts it.
 	ACTOR static Future<Void> clear_impl(ObjectCache* self, bool waitForSafeEviction) {
 		// Claim ownership of all of our cached items, removing them from the evictor's control and quota.
@@ -2024,11 +2132,19 @@ public:
 	  : ioLock(makeReference<PriorityMultiLock>(FLOW_KNOBS->MAX_OUTSTANDING, SERVER_KNOBS->REDWOOD_IO_PRIORITIES)),
 	    pageCacheBytes(pageCacheSizeBytes), desiredPageSize(desiredPageSize), desiredExtentSize(desiredExtentSize),
 	    filename(filename), memoryOnly(memoryOnly), remapCleanupWindowBytes(remapCleanupWindowBytes),
-	    concurrentExtentReads(new FlowLock(concurrentExtentReads)) {
+	    concurrentExtentReads(new FlowLock(concurrentExtentReads)),
+	    compressionFilter(CompressionUtils::fromFilterString(SERVER_KNOBS->REDWOOD_PAGE_COMPRESSION_FILTER)) {
 
 		// This sets the page cache size for all PageCacheT instances using the same evictor
 		pageCache.evictor().sizeLimit = pageCacheBytes;
 
+		if (SERVER_KNOBS->REDWOOD_ENCODE_THREADS > 0 && !memoryOnly && !g_network->isSimulated()) {
+			encodeThreads = createGenericThreadPool();
+			for (int i = 0; i < SERVER_KNOBS->REDWOOD_ENCODE_THREADS; ++i) {
+				encodeThreads->addThread(new PageEncoder(), "fdb-redwood-encode");
+			}
+		}
+
 		g_redwoodMetrics.ioLock = ioLock.getPtr();
 		if (!g_redwoodMetricsActor.isValid()) {
 			g_redwoodMetricsActor = redwoodMetricsLogger();
@@ -2057,6 +2173,18 @@ public:
 		header.pageSize = logicalPageSize;
 	}
 
+	// Reserves the process's page slab with slots of the physical page size, which only the first pager to recover
+	// does.  Pages of other sizes are allocated as usual.
+	void reservePageSlab() {
+		if (SERVER_KNOBS->REDWOOD_PAGE_CACHE_SLAB && !memoryOnly) {
+			int64_t slabBytes = pageCacheBytes;
+			if (g_network->isSimulated()) {
+				slabBytes = std::min<int64_t>(slabBytes, 64 << 20);
+			}
+			PageSlab::reserve(slabBytes, physicalPageSize);
+		}
+	}
+
 	void setExtentSize(int size) {
 		// if the specified extent size is smaller than the physical page size, round it off to one physical page size
 		// physical extent size has to be a multiple of physical page size
@@ -2192,6 +2320,7 @@ public:
 			}
 
 			self->setPageSize(self->header.pageSize);
+			self->reservePageSlab();
 			self->filePageCount = fileSize / self->physicalPageSize;
 			self->filePageCountPending = self->filePageCount;
 
@@ -2293,6 +2422,7 @@ public:
 
 			// Now that the header page has been allocated, set page size to desired
 			self->setPageSize(self->desiredPageSize);
+			self->reservePageSlab();
 			self->filePageCount = 0;
 			self->filePageCountPending = 0;
 
@@ -2418,6 +2548,73 @@ public:
 		return makeReference<ArenaPage>(logicalPageSize * blocks, physicalPageSize * blocks);
 	}
 
+	int compressPage(Reference<ArenaPage> page) override {
+		const int blocks = page->rawSize() / physicalPageSize;
+		if (memoryOnly || blocks < 2 || compressionFilter == CompressionFilter::NONE) {
+			return blocks;
+		}
+
+		Arena arena;
+		StringRef payload = CompressionUtils::compress(compressionFilter, page->dataAsStringRef(), arena);
+		const int storedSize = page->getPayloadOffset() + sizeof(CompressedNodeHeader) + payload.size();
+		const int storedBlocks = (storedSize + logicalPageSize - 1) / logicalPageSize;
+		if (storedBlocks >= blocks) {
+			return blocks;
+		}
+
+		Reference<ArenaPage> stored = newPageBuffer(storedBlocks);
+		stored->init(page->getEncodingType(),
+		             PageType::CompressedBTreeNode,
+		             page->getPageSubType(),
+		             static_cast<uint8_t>(compressionFilter));
+		stored->encryptionKey = page->encryptionKey;
+		CompressedNodeHeader* h = (CompressedNodeHeader*)stored->mutateData();
+		h->pageType = page->getPageType();
+		h->blocks = blocks;
+		h->compressedSize = payload.size();
+		uint8_t* end = stored->mutateData() + sizeof(CompressedNodeHeader);
+		memcpy(end, payload.begin(), payload.size());
+		end += payload.size();
+		memset(end, 0, stored->mutateData() + stored->dataSize() - end);
+		page->compressed = stored;
+
+		++g_redwoodMetrics.metric.pagerCompressedWrite;
+		g_redwoodMetrics.metric.pagerCompressSavedBlocks += blocks - storedBlocks;
+		return storedBlocks;
+	}
+
+	// If page was read from a CompressedBTreeNode, returns the node it holds, otherwise returns page.
+	// Pre: postReadPayload() has been called for page
+	Reference<ArenaPage> decompressPage(Reference<ArenaPage> page) {
+		if (page->getPageType() != PageType::CompressedBTreeNode) {
+			return page;
+		}
+
+		const CompressedNodeHeader* h = (const CompressedNodeHeader*)page->data();
+		if (sizeof(CompressedNodeHeader) + h->compressedSize > page->dataSize()) {
+			throw page_decoding_failed();
+		}
+		Arena arena;
+		StringRef payload = CompressionUtils::decompress(
+		    static_cast<CompressionFilter>(page->getPageFormat()),
+		    StringRef(page->data() + sizeof(CompressedNodeHeader), h->compressedSize),
+		    arena);
+
+		// The node's headers are the stored page's, with its own page type
+		Reference<ArenaPage> node = newPageBuffer(h->blocks);
+		memcpy(node->rawData(), page->rawData(), page->getPayloadOffset());
+		node->postReadHeader(invalidPhysicalPageID, false);
+		node->setPageType(h->pageType);
+		if (payload.size() != node->dataSize()) {
+			throw page_decoding_failed();
+		}
+		memcpy(node->mutateData(), payload.begin(), payload.size());
+		node->encryptionKey = page->encryptionKey;
+
+		++g_redwoodMetrics.metric.pagerDecompress;
+		return node;
+	}
+
 	int getPhysicalPageSize() const override { return physicalPageSize; }
 	int getLogicalPageSize() const override { return logicalPageSize; }
 	int getPagesPerExtent() const override { return pagesPerExtent; }
@@ -2461,6 +2658,13 @@ public:
 
 	Future<LogicalPageID> newPageID() override { return newPageID_impl(this); }
 
+	// Free pages are not tracked by location, so consecutive pages can only be taken from the end of the file
+	LogicalPageID newContiguousPageIDs(int count) override {
+		LogicalPageID id = header.pageCount;
+		growPager(count);
+		return id;
+	}
+
 	void growPager(int64_t pages) { header.pageCount += pages; }
 
 	// Get a new, previously available extent and it's first page ID.  The page will be considered in-use after the next
@@ -2558,6 +2762,67 @@ public:
 		return Void();
 	}
 
+	// Encrypting a page only depends on the page and its cipher, so with REDWOOD_ENCODE_THREADS set the encryption of a
+	// page being written is done on a helper thread, leaving the network thread free to build the next pages of the
+	// commit. Flow reference counts are not thread safe, so the work's cipher is created and its references are
+	// released on the network thread, and the helper thread only uses it through a raw pointer.
+	struct EncodeWork : ReferenceCounted<EncodeWork>, NonCopyable {
+		EncodeWork(Reference<ArenaPage> page, PhysicalPageID pageID)
+		  : page(page), pageID(pageID), cipher(page->newCipher()) {}
+
+		Reference<ArenaPage> page;
+		PhysicalPageID pageID;
+		std::unique_ptr<EncryptBlobCipherAes265Ctr> cipher;
+	};
+
+	class PageEncoder final : public IThreadPoolReceiver {
+	public:
+		void init() override {}
+
+		struct EncodeAction final : TypedAction<PageEncoder, EncodeAction> {
+			EncodeWork* work;
+			ThreadReturnPromise<Void> done;
+
+			explicit EncodeAction(Reference<EncodeWork> work) : work(work.extractPtr()) {}
+			// The action is destroyed on the helper thread, or by the pool if it is stopped first
+			~EncodeAction() {
+				EncodeWork* w = work;
+				onMainThreadVoid([w]() { w->delref(); });
+			}
+			double getTimeEstimate() const override { return 0; }
+		};
+
+		void action(EncodeAction& a) {
+			try {
+				a.work->page->preWrite(a.work->pageID, a.work->cipher.get());
+				a.done.send(Void());
+			} catch (Error& e) {
+				a.done.sendError(e);
+			}
+		}
+	};
+
+	// Encrypts page on a helper thread, then writes its blocks
+	ACTOR static Future<Void> encodeAndWritePhysicalPage(DWALPager* self,
+	                                                     Reference<ArenaPage> page,
+	                                                     Standalone<VectorRef<PhysicalPageID>> pageIDs,
+	                                                     PagerEventReasons reason,
+	                                                     unsigned int level) {
+		auto* action = new PageEncoder::EncodeAction(makeReference<EncodeWork>(page, pageIDs.front()));
+		state Future<Void> encoded = action->done.getFuture();
+		self->encodeThreads->post(action);
+		++g_redwoodMetrics.metric.pagerEncodeOffload;
+		wait(encoded);
+
+		std::vector<Future<Void>> writers;
+		for (int i = 0; i < pageIDs.size(); ++i) {
+			writers.push_back(
+			    writePhysicalBlock(self, page, i, self->physicalPageSize, pageIDs[i], reason, level, false));
+		}
+		wait(waitForAll(writers));
+		return Void();
+	}
+
 	// All returned futures are added to the operations vector
 	Future<Void> writePhysicalPage(PagerEventReasons reason,
 	                               unsigned int level,
@@ -2576,12 +2841,25 @@ public:
 		// last committed version + 1
 		page->setWriteInfo(pageIDs.front(), this->getLastCommittedVersion() + 1);
 
+		// A compressed page is written in place of the page, which stays in cache as is
+		if (page->compressed.isValid()) {
+			page = page->compressed;
+		}
+		ASSERT(header || page->rawSize() == pageIDs.size() * physicalPageSize);
+
 		// Copy the page if preWrite will encrypt/modify the payload
 		bool copy = page->isEncrypted();
 		if (copy) {
 			page = page->clone();
 		}
 
+		// The copy is only referenced here, so it can be encrypted on a helper thread
+		if (copy && encodeThreads.isValid() && isEncodingTypeAESEncrypted(page->getEncodingType())) {
+			Future<Void> f = encodeAndWritePhysicalPage(this, page, pageIDs, reason, level);
+			operations.push_back(f);
+			return f;
+		}
+
 		page->preWrite(pageIDs.front());
 
 		int blockSize = header ? smallestPhysicalBlock : physicalPageSize;
@@ -2614,7 +2892,8 @@ public:
 		// or as a cache miss because there is no benefit to the page already being in cache
 		// Similarly, this does not count as a point lookup for reason.
 		ASSERT(pageIDs.front() != invalidLogicalPageID);
-		PageCacheEntry& cacheEntry = pageCache.get(pageIDs.front(), pageIDs.size() * physicalPageSize, true);
+		// The cache holds data as is, which is larger than the blocks written if it is compressed
+		PageCacheEntry& cacheEntry = pageCache.get(pageIDs.front(), data->rawSize(), true);
 		debug_printf("DWALPager(%s) op=write %s cached=%d reading=%d writing=%d\n",
 		             filename.c_str(),
 		             toString(pageIDs).c_str(),
@@ -2843,6 +3122,10 @@ public:
 			if (isReadRequest(reason)) {
 				g_redwoodMetrics.metric.readRequestDecryptTimeNS += int64_t(decryptTime * 1e9);
 			}
+			if (!header && page->getPageType() == PageType::CompressedBTreeNode) {
+				page = self->decompressPage(page);
+				self->pageCache.resize(pageID, page->rawSize());
+			}
 			debug_printf("DWALPager(%s) op=readPhysicalVerified %s ptr=%p\n",
 			             self->filename.c_str(),
 			             toString(pageID).c_str(),
@@ -2927,6 +3210,10 @@ public:
 			if (reason.present() && isReadRequest(reason.get())) {
 				g_redwoodMetrics.metric.readRequestDecryptTimeNS += int64_t(decryptTime * 1e9);
 			}
+			if (page->getPageType() == PageType::CompressedBTreeNode) {
+				page = self->decompressPage(page);
+				self->pageCache.resize(pageIDs.front(), page->rawSize());
+			}
 
 			debug_printf("DWALPager(%s) op=readPhysicalVerified %s ptr=%p bytes=%d\n",
 			             self->filename.c_str(),
@@ -2962,6 +3249,12 @@ public:
 		       reason == PagerEventReasons::RangeRead || reason == PagerEventReasons::RangePrefetch;
 	}
 
+	// Pages read by scans are admitted to the page cache's probationary segment
+	static bool isScanRequest(PagerEventReasons reason) {
+		return reason == PagerEventReasons::FetchRange || reason == PagerEventReasons::RangeRead ||
+		       reason == PagerEventReasons::RangePrefetch;
+	}
+
 	// Reads the most recent version of pageID, either previously committed or written using updatePage()
 	// in the current commit
 	Future<Reference<ArenaPage>> readPage(PagerEventReasons reason,
@@ -2991,7 +3284,7 @@ public:
 			debug_printf("DWALPager(%s) op=readUncachedMiss %s\n", filename.c_str(), toString(pageID).c_str());
 			return forwardError(readPhysicalPage(this, pageID, priority, false, reason), errorPromise);
 		}
-		PageCacheEntry& cacheEntry = pageCache.get(pageID, physicalPageSize, noHit);
+		PageCacheEntry& cacheEntry = pageCache.get(pageID, physicalPageSize, noHit, isScanRequest(reason));
 		debug_printf("DWALPager(%s) op=read %s cached=%d reading=%d writing=%d noHit=%d\n",
 		             filename.c_str(),
 		             toString(pageID).c_str(),
@@ -3041,7 +3334,8 @@ public:
 			return forwardError(readPhysicalMultiPage(this, pageIDs, priority, reason), errorPromise);
 		}
 
-		PageCacheEntry& cacheEntry = pageCache.get(pageIDs.front(), pageIDs.size() * physicalPageSize, noHit);
+		PageCacheEntry& cacheEntry =
+		    pageCache.get(pageIDs.front(), pageIDs.size() * physicalPageSize, noHit, isScanRequest(reason));
 		debug_printf("DWALPager(%s) op=read %s cached=%d reading=%d writing=%d noHit=%d\n",
 		             filename.c_str(),
 		             toString(pageIDs).c_str(),
@@ -3666,6 +3960,11 @@ public:
 		}
 		self->operations.clear();
 
+		if (self->encodeThreads.isValid()) {
+			debug_printf("DWALPager(%s) shutdown stop encode threads\n", self->filename.c_str());
+			wait(self->encodeThreads->stop());
+		}
+
 		debug_printf("DWALPager(%s) shutdown cancel queues\n", self->filename.c_str());
 		self->freeList.cancel();
 		self->delayedFreeList.cancel();
@@ -3940,6 +4239,22 @@ private:
 	ExtentUsedListQueueT extentUsedList;
 	uint64_t remapCleanupWindowBytes;
 	Reference<FlowLock> concurrentExtentReads;
+
+	// Filter used to compress multi-block nodes written, see compressPage()
+	CompressionFilter compressionFilter;
+	// Helper threads encrypting pages written, if REDWOOD_ENCODE_THREADS is set
+	Reference<IThreadPool> encodeThreads;
+
+#pragma pack(push, 1)
+	// Payload header of a CompressedBTreeNode page, followed by the compressed payload of the node
+	struct CompressedNodeHeader {
+		PageType pageType;
+		// Blocks of the node when decompressed
+		uint32_t blocks;
+		uint32_t compressedSize;
+	};
+#pragma pack(pop)
+
 	std::unordered_set<PhysicalPageID> remapDestinationsSimOnly;
 
 	struct SnapshotEntry {
@@ -4137,7 +4452,8 @@ struct RedwoodRecordRef {
 
 	RedwoodRecordRef(KeyRef key = KeyRef(), Optional<ValueRef> value = {}) : key(key), value(value) {}
 
-	RedwoodRecordRef(Arena& arena, const RedwoodRecordRef& toCopy) : key(arena, toCopy.key) {
+	RedwoodRecordRef(Arena& arena, const RedwoodRecordRef& toCopy)
+	  : key(arena, toCopy.key), valueExternal(toCopy.valueExternal) {
 		if (toCopy.value.present()) {
 			value = ValueRef(arena, toCopy.value.get());
 		}
@@ -4171,6 +4487,13 @@ struct RedwoodRecordRef {
 
 	inline RedwoodRecordRef withoutValue() const { return RedwoodRecordRef(key); }
 
+	// Returns a copy of a leaf record whose value is stored outside of its page, with ref as its value
+	inline RedwoodRecordRef withExternalValue(ValueRef ref) const {
+		RedwoodRecordRef r(key, ref);
+		r.valueExternal = true;
+		return r;
+	}
+
 	inline RedwoodRecordRef withMaxPageID() const {
 		return RedwoodRecordRef(key, StringRef((uint8_t*)&maxPageID, sizeof(maxPageID)));
 	}
@@ -4198,6 +4521,36 @@ struct RedwoodRecordRef {
 		return cmp;
 	}
 
+	// Compares keys only, setting common to the length of their common prefix
+	int compareKey(const RedwoodRecordRef& rhs, int& common) const {
+		common = commonPrefixLength(key, rhs.key);
+		return compareAfterCommon(key.begin(), key.size(), rhs.key.begin(), rhs.key.size(), common);
+	}
+
+	struct Delta;
+
+	// Compares to the record delta creates from a base record, given the common key prefix length and key comparison
+	// of this record and the base, which are updated to those of this record and the created one.  The created
+	// record's key is the base key's first prefixLength bytes followed by the delta's key suffix, so
+	//   - if those prefix bytes are common with this key, only the suffix needs to be compared
+	//   - otherwise the created key differs from this key where the base key does, in the same way
+	int compareToDelta(const Delta& delta, int& common, int& keyCmp) const {
+		const int prefixLen = delta.getKeyPrefixLength();
+		if (prefixLen <= common) {
+			const uint8_t* suffix = delta.data() + (delta.hasValue() ? delta.getValueLength() : 0);
+			const int suffixLen = delta.getKeySuffixLength();
+			const uint8_t* rest = key.begin() + prefixLen;
+			const int restLen = key.size() - prefixLen;
+			const int suffixCommon = commonPrefixLength(rest, suffix, std::min(restLen, suffixLen));
+			common = prefixLen + suffixCommon;
+			keyCmp = compareAfterCommon(rest, restLen, suffix, suffixLen, suffixCommon);
+		}
+		if (keyCmp != 0) {
+			return keyCmp;
+		}
+		return value.compare(delta.hasValue() ? Optional<ValueRef>(delta.getValue()) : Optional<ValueRef>());
+	}
+
 	bool sameUserKey(const StringRef& k, int skipLen) const {
 		// Keys are the same if the sizes are the same and either the skipLen is longer or the non-skipped suffixes are
 		// the same.
@@ -4206,9 +4559,22 @@ struct RedwoodRecordRef {
 
 	bool sameExceptValue(const RedwoodRecordRef& rhs, int skipLen = 0) const { return sameUserKey(rhs.key, skipLen); }
 
+private:
+	// Compares byte strings a and b, whose first common bytes are the same
+	static int compareAfterCommon(const uint8_t* a, int aLen, const uint8_t* b, int bLen, int common) {
+		if (common < aLen && common < bLen) {
+			return a[common] < b[common] ? -1 : 1;
+		}
+		return aLen < bLen ? -1 : (aLen > bLen ? 1 : 0);
+	}
+
+public:
+
 	// TODO: Use SplitStringRef (unless it ends up being slower)
 	KeyRef key;
 	Optional<ValueRef> value;
+	// Whether value is a reference to the value stored outside of the leaf, see VersionedBTree::ExternalValue
+	bool valueExternal = false;
 
 	int expectedSize() const { return key.expectedSize() + value.expectedSize(); }
 	int kvBytes() const { return expectedSize(); }
@@ -4256,7 +4622,8 @@ struct RedwoodRecordRef {
 		//    1 bit - borrow source is prev ancestor (otherwise next ancestor)
 		//    1 bit - item is deleted
 		//    1 bit - has value (different from a zero-length value, which is still a value)
-		//    3 unused bits
+		//    1 bit - value is external (value bytes reference the value, which is stored outside of the page)
+		//    2 unused bits
 		//    2 bits - length fields format
 		//
 		// Length fields using 3 to 8 bytes total depending on length fields format
@@ -4269,7 +4636,8 @@ struct RedwoodRecordRef {
 			PREFIX_SOURCE_PREV = 0x80,
 			IS_DELETED = 0x40,
 			HAS_VALUE = 0x20,
-			// 3 unused bits
+			VALUE_EXTERNAL = 0x10,
+			// 2 unused bits
 			LENGTHS_FORMAT = 0x03
 		};
 
@@ -4350,6 +4718,14 @@ struct RedwoodRecordRef {
 
 		bool hasValue() const { return flags & HAS_VALUE; }
 
+		bool isValueExternal() const { return flags & VALUE_EXTERNAL; }
+
+		// Returns r, marked as having an external value if the delta's value is external
+		RedwoodRecordRef withValueFlags(RedwoodRecordRef r) const {
+			r.valueExternal = isValueExternal();
+			return r;
+		}
+
 		void setPrefixSource(bool val) {
 			if (val) {
 				flags |= PREFIX_SOURCE_PREV;
@@ -4388,12 +4764,13 @@ struct RedwoodRecordRef {
 				k = base.key.substr(0, keyPrefixLen);
 			}
 
-			return RedwoodRecordRef(k, hasValue() ? ValueRef(pData, valueLen) : Optional<ValueRef>());
+			return withValueFlags(RedwoodRecordRef(k, hasValue() ? ValueRef(pData, valueLen) : Optional<ValueRef>()));
 		}
 
 		// DeltaTree interface
 		RedwoodRecordRef apply(const Partial& cache) {
-			return RedwoodRecordRef(cache, hasValue() ? Optional<ValueRef>(getValue()) : Optional<ValueRef>());
+			return withValueFlags(
+			    RedwoodRecordRef(cache, hasValue() ? Optional<ValueRef>(getValue()) : Optional<ValueRef>()));
 		}
 
 		RedwoodRecordRef apply(Arena& arena, const Partial& baseKey, Optional<Partial>& cache) {
@@ -4414,7 +4791,7 @@ struct RedwoodRecordRef {
 			}
 			cache = k;
 
-			return RedwoodRecordRef(k, hasValue() ? ValueRef(pData, valueLen) : Optional<ValueRef>());
+			return withValueFlags(RedwoodRecordRef(k, hasValue() ? ValueRef(pData, valueLen) : Optional<ValueRef>()));
 		}
 
 		RedwoodRecordRef apply(Arena& arena, const RedwoodRecordRef& base, Optional<Partial>& cache) {
@@ -4447,6 +4824,9 @@ struct RedwoodRecordRef {
 			if (hasValue()) {
 				flagString += "HasValue|";
 			}
+			if (isValueExternal()) {
+				flagString += "ValueExternal|";
+			}
 			int lengthFormat = flags & LENGTHS_FORMAT;
 
 			int prefixLen = getKeyPrefixLength();
@@ -4469,16 +4849,19 @@ struct RedwoodRecordRef {
 	// its values, so the Reader does not require the original prev/next ancestors.
 	struct DeltaValueOnly : Delta {
 		RedwoodRecordRef apply(const RedwoodRecordRef& base, Arena& arena) const {
-			return RedwoodRecordRef(KeyRef(), hasValue() ? Optional<ValueRef>(getValue()) : Optional<ValueRef>());
+			return withValueFlags(
+			    RedwoodRecordRef(KeyRef(), hasValue() ? Optional<ValueRef>(getValue()) : Optional<ValueRef>()));
 		}
 
 		RedwoodRecordRef apply(const Partial& cache) {
-			return RedwoodRecordRef(KeyRef(), hasValue() ? Optional<ValueRef>(getValue()) : Optional<ValueRef>());
+			return withValueFlags(
+			    RedwoodRecordRef(KeyRef(), hasValue() ? Optional<ValueRef>(getValue()) : Optional<ValueRef>()));
 		}
 
 		RedwoodRecordRef apply(Arena& arena, const RedwoodRecordRef& base, Optional<Partial>& cache) {
 			cache = KeyRef();
-			return RedwoodRecordRef(KeyRef(), hasValue() ? Optional<ValueRef>(getValue()) : Optional<ValueRef>());
+			return withValueFlags(
+			    RedwoodRecordRef(KeyRef(), hasValue() ? Optional<ValueRef>(getValue()) : Optional<ValueRef>()));
 		}
 	};
 #pragma pack(pop)
@@ -4515,6 +4898,9 @@ struct RedwoodRecordRef {
 	// commonPrefix between *this and base can be passed if known
 	int writeDelta(Delta& d, const RedwoodRecordRef& base, int keyPrefixLen = -1) const {
 		d.flags = value.present() ? Delta::HAS_VALUE : 0;
+		if (valueExternal) {
+			d.flags |= Delta::VALUE_EXTERNAL;
+		}
 
 		if (keyPrefixLen < 0) {
 			keyPrefixLen = getCommonPrefixLen(base, 0);
@@ -4580,7 +4966,9 @@ struct RedwoodRecordRef {
 		std::string r;
 		r += format("'%s' => ", key.printable().c_str());
 		if (value.present()) {
-			if (leaf) {
+			if (leaf && valueExternal) {
+				r += format("[external %s]", value.get().toHexString().c_str());
+			} else if (leaf) {
 				r += format("'%s'", kvformat(value.get()).c_str());
 			} else {
 				r += format("[%s]", ::toString(getChildPage()).c_str());
@@ -4965,19 +5353,23 @@ public:
 		LazyClearQueueT::QueueState lazyDeleteQueue;
 		BTreeNodeLink root;
 		EncryptionAtRestMode encryptionMode = EncryptionAtRestMode::DISABLED; // since 7.3
+		// Whether any leaf record has ever had its value stored outside of the leaf, see ExternalValue
+		bool externalValues = false;
 
 		std::string toString() {
-			return format("{formatVersion=%d  height=%d  root=%s  lazyDeleteQueue=%s encryptionMode=%s}",
+			return format("{formatVersion=%d  height=%d  root=%s  lazyDeleteQueue=%s encryptionMode=%s "
+			              "externalValues=%d}",
 			              (int)formatVersion,
 			              (int)height,
 			              ::toString(root).c_str(),
 			              lazyDeleteQueue.toString().c_str(),
-			              encryptionMode.toString().c_str());
+			              encryptionMode.toString().c_str(),
+			              (int)externalValues);
 		}
 
 		template <class Ar>
 		void serialize(Ar& ar) {
-			serializer(ar, formatVersion, encodingType, height, lazyDeleteQueue, root, encryptionMode);
+			serializer(ar, formatVersion, encodingType, height, lazyDeleteQueue, root, encryptionMode, externalValues);
 		}
 	};
 
@@ -5002,6 +5394,12 @@ public:
 
 	StorageBytes getStorageBytes() const { return m_pager->getStorageBytes(); }
 
+	// Returns the number of cleared subtrees waiting to be freed and the bytes freed so far by lazy clear
+	std::pair<int64_t, int64_t> getLazyClearProgress() const {
+		return std::make_pair(m_lazyClearQueue.numEntries,
+		                      m_lazyClearFreedPages * m_pager->getPhysicalPageSize());
+	}
+
 	// Set key to value as of the next commit
 	// The new value is not readable until after the next commit is completed.
 	void set(KeyValueRef keyValue) {
@@ -5012,6 +5410,19 @@ public:
 		m_pBuffer->insert(keyValue.key).mutation().setBoundaryValue(m_pBuffer->copyToArena(keyValue.value));
 	}
 
+	// Like set() for each of records, except that their values are referenced rather than copied into the mutation
+	// buffer, which depends on arena instead.
+	void setAll(VectorRef<KeyValueRef> records, Arena const& arena) {
+		m_pBuffer->dependsOn(arena);
+		for (const KeyValueRef& kv : records) {
+			++m_mutationCount;
+			++g_redwoodMetrics.metric.opSet;
+			g_redwoodMetrics.metric.opSetKeyBytes += kv.key.size();
+			g_redwoodMetrics.metric.opSetValueBytes += kv.value.size();
+			m_pBuffer->insert(kv.key).mutation().setBoundaryValue(kv.value);
+		}
+	}
+
 	void clear(KeyRangeRef clearedRange) {
 		++m_mutationCount;
 		ASSERT(!clearedRange.empty());
@@ -5037,6 +5448,9 @@ public:
 
 	Version getLastCommittedVersion() const { return m_pager->getLastCommittedVersion(); }
 
+	// Values set later with at least bytes bytes are stored in pages of their own, or none are if bytes is 0
+	void setValueExternalThreshold(int bytes) { m_valueExternalThreshold = bytes; }
+
 	// VersionedBTree takes ownership of pager
 	VersionedBTree(IPager2* pager,
 	               std::string name,
@@ -5052,6 +5466,7 @@ public:
 	    m_pBoundaryVerifier(DecodeBoundaryVerifier::getVerifier(name)) {
 		m_pDecodeCacheMemory = m_pager->getPageCachePenaltySource();
 		m_lazyClearActor = 0;
+		m_lazyClearTime = now();
 		m_init = init_impl(this);
 		m_latestCommit = m_init;
 	}
@@ -5086,13 +5501,24 @@ public:
 		    self->m_pager->getReadSnapshot(self->m_pager->getLastCommittedVersion());
 		state int freedPages = 0;
 
+		// Under REDWOOD_LAZY_CLEAR_PAGES_PER_SECOND, each cycle may free the pages accrued since the last cycle, up to
+		// one second's worth
+		state int64_t maxPages = SERVER_KNOBS->REDWOOD_LAZY_CLEAR_MAX_PAGES;
+		const double rate = SERVER_KNOBS->REDWOOD_LAZY_CLEAR_PAGES_PER_SECOND;
+		if (rate > 0) {
+			self->m_lazyClearAllowance =
+			    std::min(rate, self->m_lazyClearAllowance + rate * (now() - self->m_lazyClearTime));
+			maxPages = std::min<int64_t>(maxPages, self->m_lazyClearAllowance);
+		}
+		self->m_lazyClearTime = now();
+
+		// Interior pages are read ahead of the one being processed, with up to REDWOOD_LAZY_CLEAR_BATCH_SIZE_PAGES
+		// reads outstanding.  Children queued by a page are pushed to the front of the queue, so they are the next to
+		// be read and the clear proceeds depth first.
+		state Deque<std::pair<LazyClearQueueEntry, Future<Reference<const ArenaPage>>>> entries;
+		state bool stopping = maxPages <= 0;
 		loop {
-			state int toPop = SERVER_KNOBS->REDWOOD_LAZY_CLEAR_BATCH_SIZE_PAGES;
-			state std::vector<std::pair<LazyClearQueueEntry, Future<Reference<const ArenaPage>>>> entries;
-			entries.reserve(toPop);
-
-			// Take up to batchSize pages from front of queue
-			while (toPop > 0) {
+			while (!stopping && entries.size() < (size_t)SERVER_KNOBS->REDWOOD_LAZY_CLEAR_BATCH_SIZE_PAGES) {
 				Optional<LazyClearQueueEntry> q = wait(self->m_lazyClearQueue.pop());
 				debug_printf("LazyClear: popped %s\n", toString(q).c_str());
 				if (!q.present()) {
@@ -5109,70 +5535,76 @@ public:
 				                                    ioLeafPriority,
 				                                    true,
 				                                    false));
-				--toPop;
 			}
 
-			state int i;
-			for (i = 0; i < entries.size(); ++i) {
-				Reference<const ArenaPage> p = wait(entries[i].second);
-				const LazyClearQueueEntry& entry = entries[i].first;
-				const BTreePage& btPage = *(const BTreePage*)p->data();
-				ASSERT(btPage.height == entry.height);
-				auto& metrics = g_redwoodMetrics.level(entry.height).metrics;
+			// Stop once the pages already being read are done if the queue is exhausted
+			if (entries.empty()) {
+				break;
+			}
 
-				debug_printf("LazyClear: processing %s\n", toString(entry).c_str());
+			Reference<const ArenaPage> p = wait(entries.front().second);
+			const LazyClearQueueEntry& entry = entries.front().first;
+			const BTreePage& btPage = *(const BTreePage*)p->data();
+			ASSERT(btPage.height == entry.height);
+			auto& metrics = g_redwoodMetrics.level(entry.height).metrics;
 
-				// Level 1 (leaf) nodes should never be in the lazy delete queue
-				ASSERT(entry.height > 1);
+			debug_printf("LazyClear: processing %s\n", toString(entry).c_str());
 
-				// Iterate over page entries, skipping key decoding using BTreePage::ValueTree which uses
-				// RedwoodRecordRef::DeltaValueOnly as the delta type type to skip key decoding
-				BTreePage::ValueTree::Cursor c(makeReference<BTreePage::ValueTree::DecodeCache>(dbBegin, dbEnd),
-				                               btPage.valueTree());
-				ASSERT(c.moveFirst());
-				Version v = entry.version;
-				while (1) {
-					if (c.get().value.present()) {
-						BTreeNodeLinkRef btChildPageID = c.get().getChildPage();
-						// If this page is height 2, then the children are leaves so free them directly
-						if (entry.height == 2) {
-							debug_printf("LazyClear: freeing leaf child %s\n", toString(btChildPageID).c_str());
-							self->freeBTreePage(1, btChildPageID, v);
-							freedPages += btChildPageID.size();
-							metrics.lazyClearFree += 1;
-							metrics.lazyClearFreeExt += (btChildPageID.size() - 1);
-						} else {
-							// Otherwise, queue them for lazy delete.
-							debug_printf("LazyClear: queuing child %s\n", toString(btChildPageID).c_str());
-							self->m_lazyClearQueue.pushFront(
-							    LazyClearQueueEntry{ (uint8_t)(entry.height - 1), v, btChildPageID });
-							metrics.lazyClearRequeue += 1;
-							metrics.lazyClearRequeueExt += (btChildPageID.size() - 1);
-						}
-					}
-					if (!c.moveNext()) {
-						break;
+			// Level 1 (leaf) nodes are only in the lazy delete queue if they may have external values to free
+			ASSERT(entry.height > 1 || self->m_header.externalValues);
+
+			// Iterate over page entries, skipping key decoding using BTreePage::ValueTree which uses
+			// RedwoodRecordRef::DeltaValueOnly as the delta type type to skip key decoding
+			BTreePage::ValueTree::Cursor c(makeReference<BTreePage::ValueTree::DecodeCache>(dbBegin, dbEnd),
+			                               btPage.valueTree());
+			ASSERT(c.moveFirst());
+			Version v = entry.version;
+			while (1) {
+				if (entry.height == 1) {
+					self->freeExternalValue(c.get(), v);
+				} else if (c.get().value.present()) {
+					BTreeNodeLinkRef btChildPageID = c.get().getChildPage();
+					// If this page is height 2, then the children are leaves so free them directly, unless they must
+					// be read to free their external values
+					if (entry.height == 2 && !self->m_header.externalValues) {
+						debug_printf("LazyClear: freeing leaf child %s\n", toString(btChildPageID).c_str());
+						self->freeBTreePage(1, btChildPageID, v);
+						freedPages += btChildPageID.size();
+						metrics.lazyClearFree += 1;
+						metrics.lazyClearFreeExt += (btChildPageID.size() - 1);
+					} else {
+						// Otherwise, queue them for lazy delete.
+						debug_printf("LazyClear: queuing child %s\n", toString(btChildPageID).c_str());
+						self->m_lazyClearQueue.pushFront(
+						    LazyClearQueueEntry{ (uint8_t)(entry.height - 1), v, btChildPageID });
+						metrics.lazyClearRequeue += 1;
+						metrics.lazyClearRequeueExt += (btChildPageID.size() - 1);
 					}
 				}
-
-				// Free the page, now that its children have either been freed or queued
-				debug_printf("LazyClear: freeing queue entry %s\n", toString(entry.pageID).c_str());
-				self->freeBTreePage(entry.height, entry.pageID, v);
-				freedPages += entry.pageID.size();
-				metrics.lazyClearFree += 1;
-				metrics.lazyClearFreeExt += entry.pageID.size() - 1;
+				if (!c.moveNext()) {
+					break;
+				}
 			}
 
-			// Stop if
-			//   - the poppable items in the queue have already been exhausted
+			// Free the page, now that its children have either been freed or queued
+			debug_printf("LazyClear: freeing queue entry %s\n", toString(entry.pageID).c_str());
+			self->freeBTreePage(entry.height, entry.pageID, v);
+			freedPages += entry.pageID.size();
+			metrics.lazyClearFree += 1;
+			metrics.lazyClearFreeExt += entry.pageID.size() - 1;
+			entries.pop_front();
+
+			// Stop reading more pages if
 			//   - stop flag is set and we've freed the minimum number of pages required
 			//   - maximum number of pages to free met or exceeded
-			if (toPop > 0 || (freedPages >= SERVER_KNOBS->REDWOOD_LAZY_CLEAR_MIN_PAGES && self->m_lazyClearStop) ||
-			    (freedPages >= SERVER_KNOBS->REDWOOD_LAZY_CLEAR_MAX_PAGES)) {
-				break;
+			if ((freedPages >= SERVER_KNOBS->REDWOOD_LAZY_CLEAR_MIN_PAGES && self->m_lazyClearStop) ||
+			    freedPages >= maxPages) {
+				stopping = true;
 			}
 		}
 
+		self->m_lazyClearAllowance -= freedPages;
+		self->m_lazyClearFreedPages += freedPages;
 		debug_printf("LazyClear: freed %d pages, %s has %" PRId64 " entries\n",
 		             freedPages,
 		             self->m_lazyClearQueue.name.c_str(),
@@ -5180,6 +5612,100 @@ public:
 		return freedPages;
 	}
 
+	// Pages written over time land wherever free pages happen to be, so the leaves of a subtree end up scattered
+	// across the file and range reads over them become random IO.  Every REDWOOD_RELOCATE_INTERVAL this visits the
+	// next level 2 page in key order, reading internal pages at the lowest IO priority, and if the leaves it links to
+	// are scattered it schedules them to be rewritten next to each other by the next commit.
+	ACTOR static Future<Void> relocateScanner(VersionedBTree* self) {
+		loop {
+			wait(delay(SERVER_KNOBS->REDWOOD_RELOCATE_INTERVAL, TaskPriority::Low));
+			if (self->m_relocation.present()) {
+				continue;
+			}
+
+			// The root must come from the snapshot as the header's root may be for a commit still in progress
+			state Reference<IPagerSnapshot> snapshot =
+			    self->m_pager->getReadSnapshot(self->m_pager->getLastCommittedVersion());
+			if (snapshot->getMetaKey().empty()) {
+				continue;
+			}
+			state BTreeCommitHeader header =
+			    ObjectReader::fromStringRef<BTreeCommitHeader>(snapshot->getMetaKey(), Unversioned());
+			if (header.height < 2) {
+				continue;
+			}
+
+			// Pages from the root down to a level 2 page, each with a cursor at the link to the next one
+			state std::vector<std::pair<Reference<const ArenaPage>, BTreePage::BinaryTree::Cursor>> path;
+			state BTreeNodeLinkRef link = header.root;
+			state unsigned int height = header.height;
+			loop {
+				Reference<const ArenaPage> page = wait(self->readPage(
+				    self, PagerEventReasons::Commit, height, snapshot.getPtr(), link, ioMinPriority, false, true));
+				path.emplace_back(page,
+				                  path.empty() ? self->getCursor(page.getPtr(), dbBegin, dbEnd)
+				                               : self->getCursor(page.getPtr(), path.back().second));
+				if (height == 2) {
+					break;
+				}
+
+				// Follow the link to the subtree containing m_relocateNext, or the next one if that was cleared
+				BTreePage::BinaryTree::Cursor& c = path.back().second;
+				c.seekLessThanOrEqual(RedwoodRecordRef(self->m_relocateNext));
+				while (c.valid() && !c.get().value.present()) {
+					c.moveNext();
+				}
+				if (!c.valid()) {
+					break;
+				}
+				link = c.get().getChildPage();
+				--height;
+			}
+
+			// The scanned range ends where the subtree at the last link followed ends
+			KeyRef begin = dbBegin.key;
+			KeyRef end = dbEnd.key;
+			if (path.size() > 1) {
+				BTreePage::BinaryTree::Cursor c = path[path.size() - 2].second;
+				begin = c.get().key;
+				end = c.next().getOrUpperBound().key;
+			}
+
+			if (height == 2) {
+				++g_redwoodMetrics.metric.btreeRelocateScan;
+
+				// A leaf is out of place unless it starts on the page after the previous leaf ends
+				int leaves = 0;
+				int outOfPlace = 0;
+				LogicalPageID previous = invalidLogicalPageID;
+				BTreePage::BinaryTree::Cursor c = path.back().second;
+				c.moveFirst();
+				while (c.valid()) {
+					if (c.get().value.present()) {
+						BTreeNodeLinkRef leaf = c.get().getChildPage();
+						if (leaves++ > 0 && leaf.front() != previous + 1) {
+							++outOfPlace;
+						}
+						previous = leaf.back();
+					}
+					c.moveNext();
+				}
+
+				if (link.size() == 1 && leaves > 1 &&
+				    outOfPlace >= (leaves - 1) * SERVER_KNOBS->REDWOOD_RELOCATE_MIN_SCATTER) {
+					debug_printf("%s: relocating %d leaves, %d out of place, of %s\n",
+					             self->m_name.c_str(),
+					             leaves,
+					             outOfPlace,
+					             toString(link).c_str());
+					self->m_relocation = Relocation{ link.front(), Key(begin), Key(end) };
+				}
+			}
+
+			self->m_relocateNext = end == dbEnd.key ? Key() : Key(end);
+		}
+	}
+
 	void checkOrUpdateEncodingType(const std::string& event,
 	                               const EncryptionAtRestMode& encryptionMode,
 	                               EncodingType& encodingType) {
@@ -5367,6 +5893,10 @@ public:
 		             self->m_pager->getLastCommittedVersion(),
 		             self->m_header.toString().c_str());
 
+		if (SERVER_KNOBS->REDWOOD_RELOCATE_INTERVAL > 0) {
+			self->m_relocateActor = forwardError(relocateScanner(self), self->m_errorPromise);
+		}
+
 		return Void();
 	}
 
@@ -5387,6 +5917,7 @@ public:
 		// uncommitted writes so it should not be committed.
 		m_latestCommit.cancel();
 		m_lazyClearActor.cancel();
+		m_relocateActor.cancel();
 		m_init.cancel();
 	}
 
@@ -5411,7 +5942,8 @@ public:
 			// If the lazy delete queue is completely processed then the last time the lazy delete actor
 			// was started it, after the last commit, it would exist immediately and do no work, so its
 			// future would be ready and its value would be 0.
-			if (self->m_lazyClearActor.isReady() && self->m_lazyClearActor.get() == 0) {
+			if (self->m_lazyClearActor.isReady() && self->m_lazyClearActor.get() == 0 &&
+			    self->m_lazyClearQueue.numEntries == 0) {
 				break;
 			}
 		}
@@ -5557,6 +6089,9 @@ public:
 			return T(arena, object);
 		}
 
+		// Keeps other alive for as long as the buffer, so that mutations can refer to memory it owns
+		void dependsOn(Arena const& other) { arena.dependsOn(other); }
+
 		const_iterator upper_bound(const KeyRef& k) const { return mutations.upper_bound(k); }
 
 		const_iterator lower_bound(const KeyRef& k) const { return mutations.lower_bound(k); }
@@ -5671,6 +6206,14 @@ private:
 	int64_t m_mutationCount;
 	DecodeBoundaryVerifier* m_pBoundaryVerifier;
 
+	// A level 2 page, and the key range it covered when it was found, whose leaves are to be rewritten next to each
+	// other at the end of the file.  The range leads commitSubtree() to the page even if nothing in it has changed.
+	struct Relocation {
+		LogicalPageID pageID;
+		Key begin;
+		Key end;
+	};
+
 	struct CommitBatch {
 		Version readVersion;
 		Version writeVersion;
@@ -5678,6 +6221,27 @@ private:
 		std::unique_ptr<MutationBuffer> mutations;
 		int64_t mutationCount;
 		Reference<IPagerSnapshot> snapshot;
+		Optional<Relocation> relocation;
+		// References to the values of the batch that were written to pages of their own, by key
+		std::map<KeyRef, ValueRef> externalValues;
+		Arena externalValuesArena;
+
+		// Returns the reference to the value being set for key if it was written to a page of its own
+		Optional<ValueRef> externalValue(KeyRef key) const {
+			if (externalValues.empty()) {
+				return {};
+			}
+			auto i = externalValues.find(key);
+			if (i == externalValues.end()) {
+				return {};
+			}
+			return i->second;
+		}
+
+		// Returns whether the subtree covering [begin, end) must be visited for the relocation
+		bool relocationIntersects(KeyRef begin, KeyRef end) const {
+			return relocation.present() && begin < relocation.get().end && relocation.get().begin < end;
+		}
 	};
 
 	Version m_newOldestVersion;
@@ -5690,9 +6254,21 @@ private:
 	ParentInfoMapT childUpdateTracker;
 
 	BTreeCommitHeader m_header;
+	// Values set with at least this many bytes are written to pages of their own, unless it is 0
+	int m_valueExternalThreshold = 0;
 	LazyClearQueueT m_lazyClearQueue;
 	Future<int> m_lazyClearActor;
 	bool m_lazyClearStop;
+	// Pages freed by lazy clear since opening, and the pages it may still free under its rate limit as of
+	// m_lazyClearTime
+	int64_t m_lazyClearFreedPages = 0;
+	double m_lazyClearAllowance = 0;
+	double m_lazyClearTime = 0;
+
+	// The relocation for the next commit, and where the search for the next one continues
+	Optional<Relocation> m_relocation;
+	Key m_relocateNext;
+	Future<Void> m_relocateActor;
 
 	// Describes a range of a vector of records that should be built into a single BTreePage
 	struct PageToBuild {
@@ -6001,7 +6577,8 @@ private:
 	                                                                        unsigned int height,
 	                                                                        Version v,
 	                                                                        BTreeNodeLinkRef previousID,
-	                                                                        LogicalPageID parentID) {
+	                                                                        LogicalPageID parentID,
+	                                                                        LogicalPageID relocateID) {
 		ASSERT(entries.size() > 0);
 
 		state Standalone<VectorRef<RedwoodRecordRef>> records;
@@ -6018,6 +6595,13 @@ private:
 		ASSERT(pagesToBuild.size() > 0);
 		debug_printf("splitPages returning %s\n", toString(pagesToBuild).c_str());
 
+		// A relocated page is written to relocateID if it is still built as a single one block page
+		state bool relocate =
+		    relocateID != invalidLogicalPageID && pagesToBuild.size() == 1 && pagesToBuild[0].blockCount == 1;
+		if (relocateID != invalidLogicalPageID && !relocate) {
+			self->m_pager->freePage(relocateID, v);
+		}
+
 		// Lower bound of the page being added to
 		state RedwoodRecordRef pageLowerBound = lowerBound->withoutValue();
 		state RedwoodRecordRef pageUpperBound;
@@ -6158,9 +6742,16 @@ private:
 			// Write this btree page, which is made of 1 or more pager pages.
 			state BTreeNodeLinkRef childPageID;
 
-			// If we are only writing 1 BTree node and its block count is 1 and the original node also had 1 block
-			// then try to update the page atomically so its logical page ID does not change
-			if (pagesToBuild.size() == 1 && p->blockCount == 1 && previousID.size() == 1) {
+			if (relocate) {
+				// The page replaces the original node at a new location, so the original is freed
+				self->freeBTreePage(height, previousID, v);
+				childPageID.push_back(records.arena(), relocateID);
+				page->setLogicalPageInfo(relocateID, parentID);
+				self->m_pager->updatePage(PagerEventReasons::Commit, height, childPageID, page);
+				++g_redwoodMetrics.metric.btreeRelocateLeaf;
+			} else if (pagesToBuild.size() == 1 && p->blockCount == 1 && previousID.size() == 1) {
+				// If we are only writing 1 BTree node and its block count is 1 and the original node also had 1 block
+				// then try to update the page atomically so its logical page ID does not change
 				page->setLogicalPageInfo(previousID.front(), parentID);
 				LogicalPageID id = wait(
 				    self->m_pager->atomicUpdatePage(PagerEventReasons::Commit, height, previousID.front(), page, v));
@@ -6194,7 +6785,8 @@ private:
 					self->freeBTreePage(height, previousID, v);
 				}
 
-				childPageID.resize(records.arena(), p->blockCount);
+				// The node may be compressed to fewer blocks, which are all that are allocated
+				childPageID.resize(records.arena(), self->m_pager->compressPage(page));
 				state int i = 0;
 				for (i = 0; i < childPageID.size(); ++i) {
 					LogicalPageID id = wait(self->m_pager->newPageID());
@@ -6281,7 +6873,15 @@ private:
 			self->m_header.height = ++height;
 			ASSERT(height < std::numeric_limits<int8_t>::max());
 			Standalone<VectorRef<RedwoodRecordRef>> newRecords = wait(
-			    writePages(self, &dbBegin, &dbEnd, records, height, version, BTreeNodeLinkRef(), invalidLogicalPageID));
+			    writePages(self,
+			               &dbBegin,
+			               &dbEnd,
+			               records,
+			               height,
+			               version,
+			               BTreeNodeLinkRef(),
+			               invalidLogicalPageID,
+			               invalidLogicalPageID));
 			debug_printf("Wrote a new root level at version %" PRId64 " height %d size %d pages\n",
 			             version,
 			             height,
@@ -6326,6 +6926,11 @@ private:
 		return std::move(page);
 	}
 
+	// Bytes available to a node, which may be stored in fewer blocks than this if it is compressed
+	int nodeCapacity(Reference<const ArenaPage> const& page) const {
+		return page->rawSize() / m_pager->getPhysicalPageSize() * m_blockSize;
+	}
+
 	// Get cursor into a BTree node, creating decode cache from boundaries if needed
 	inline BTreePage::BinaryTree::Cursor getCursor(const ArenaPage* page,
 	                                               const RedwoodRecordRef& lowerBound,
@@ -6369,18 +6974,128 @@ private:
 		                                     ((BTreePage*)page->mutateData())->tree());
 	}
 
-	static void preLoadPage(IPagerSnapshot* snapshot, BTreeNodeLinkRef pageIDs, int priority) {
+	static Future<Reference<const ArenaPage>> preLoadPage(IPagerSnapshot* snapshot,
+	                                                      BTreeNodeLinkRef pageIDs,
+	                                                      int priority) {
 		g_redwoodMetrics.metric.btreeLeafPreload += 1;
 		g_redwoodMetrics.metric.btreeLeafPreloadExt += (pageIDs.size() - 1);
 		if (pageIDs.size() == 1) {
-			snapshot->getPhysicalPage(
+			return snapshot->getPhysicalPage(
 			    PagerEventReasons::RangePrefetch, nonBtreeLevel, pageIDs.front(), priority, true, true);
 		} else {
-			snapshot->getMultiPhysicalPage(
+			return snapshot->getMultiPhysicalPage(
 			    PagerEventReasons::RangePrefetch, nonBtreeLevel, pageIDs, priority, true, true);
 		}
 	}
 
+	// A value of at least m_valueExternalThreshold bytes is stored in a page of its own, written in the commit that
+	// sets it, instead of in its leaf record.  The record is marked as having an external value, and its value is a
+	// reference to the page: the value's size followed by the IDs of the page's blocks.  The page is freed as of the
+	// commit that clears or replaces the record, so older snapshots can still read it, and leaves with such records
+	// are read by lazy clear to free them.
+	struct ExternalValue {
+		static int size(ValueRef ref) {
+			uint32_t size;
+			memcpy(&size, ref.begin(), sizeof(size));
+			return size;
+		}
+
+		static Standalone<VectorRef<LogicalPageID>> pageIDs(ValueRef ref) {
+			Standalone<VectorRef<LogicalPageID>> ids;
+			ids.resize(ids.arena(), (ref.size() - sizeof(uint32_t)) / sizeof(LogicalPageID));
+			memcpy(ids.begin(), ref.begin() + sizeof(uint32_t), ids.size() * sizeof(LogicalPageID));
+			return ids;
+		}
+
+		static ValueRef makeRef(Arena& arena, uint32_t size, VectorRef<LogicalPageID> ids) {
+			ValueRef ref = makeString(sizeof(size) + ids.size() * sizeof(LogicalPageID), arena);
+			memcpy(mutateString(ref), &size, sizeof(size));
+			memcpy(mutateString(ref) + sizeof(size), ids.begin(), ids.size() * sizeof(LogicalPageID));
+			return ref;
+		}
+	};
+
+	// Writes value, which batch sets key to, to a page of its own and adds its reference to batch
+	ACTOR static Future<Void> writeExternalValue(VersionedBTree* self, CommitBatch* batch, KeyRef key, ValueRef value) {
+		const int overhead = self->m_blockSize - ArenaPage::getUsableSize(self->m_blockSize, self->m_encodingType);
+		state Reference<ArenaPage> page =
+		    self->m_pager->newPageBuffer((value.size() + overhead + self->m_blockSize - 1) / self->m_blockSize);
+		page->init(self->m_encodingType, PageType::ExternalValue, 0);
+		if (page->isEncrypted()) {
+			ArenaPage::EncryptionKey k =
+			    wait(self->m_keyProvider->enableEncryptionDomain()
+			             ? self->m_keyProvider->getLatestEncryptionKey(
+			                   std::get<0>(self->m_keyProvider->getEncryptionDomain(key)))
+			             : self->m_keyProvider->getLatestDefaultEncryptionKey());
+			page->encryptionKey = k;
+		}
+		ASSERT(page->dataSize() >= value.size());
+		memcpy(page->mutateData(), value.begin(), value.size());
+		memset(page->mutateData() + value.size(), 0, page->dataSize() - value.size());
+
+		state Standalone<VectorRef<LogicalPageID>> ids;
+		ids.resize(ids.arena(), self->m_pager->compressPage(page));
+		state int i = 0;
+		for (; i < ids.size(); ++i) {
+			LogicalPageID id = wait(self->m_pager->newPageID());
+			ids[i] = id;
+		}
+		page->setLogicalPageInfo(ids.front(), invalidLogicalPageID);
+		self->m_pager->updatePage(PagerEventReasons::Commit, nonBtreeLevel, ids, page);
+
+		batch->externalValues[key] = ExternalValue::makeRef(batch->externalValuesArena, value.size(), ids);
+		++g_redwoodMetrics.metric.btreeValueExternalWrite;
+		return Void();
+	}
+
+	// Writes the values batch sets that are large enough to pages of their own
+	ACTOR static Future<Void> writeExternalValues(VersionedBTree* self, CommitBatch* batch) {
+		state std::vector<Future<Void>> writes;
+		MutationBuffer::const_iterator i = batch->mutations->lower_bound(dbBegin.key);
+		MutationBuffer::const_iterator iEnd = batch->mutations->lower_bound(dbEnd.key);
+		for (; i != iEnd; ++i) {
+			if (i.mutation().boundarySet() &&
+			    i.mutation().boundaryValue.get().size() >= self->m_valueExternalThreshold) {
+				writes.push_back(writeExternalValue(self, batch, i.key(), i.mutation().boundaryValue.get()));
+			}
+		}
+		wait(waitForAll(writes));
+		return Void();
+	}
+
+	// Reads the value that ref, an external value reference, refers to, from snapshot
+	static Future<Value> readExternalValue(IPagerSnapshot* snapshot,
+	                                       PagerEventReasons reason,
+	                                       ValueRef ref,
+	                                       bool cacheable) {
+		Standalone<VectorRef<LogicalPageID>> ids = ExternalValue::pageIDs(ref);
+		const int size = ExternalValue::size(ref);
+		Future<Reference<const ArenaPage>> page =
+		    ids.size() == 1
+		        ? snapshot->getPhysicalPage(reason, nonBtreeLevel, ids.front(), ioMaxPriority, cacheable, false)
+		        : snapshot->getMultiPhysicalPage(reason, nonBtreeLevel, ids, ioMaxPriority, cacheable, false);
+		return map(page, [ids, size](Reference<const ArenaPage> p) {
+			if (p->getPageType() != PageType::ExternalValue || size > p->dataSize()) {
+				throw page_decoding_failed();
+			}
+			++g_redwoodMetrics.metric.btreeValueExternalRead;
+			Value v;
+			v.arena().dependsOn(p->getArena());
+			v.contents() = StringRef(p->data(), size);
+			return v;
+		});
+	}
+
+	// Frees the page holding rec's value as of v if the value is external
+	void freeExternalValue(const RedwoodRecordRef& rec, Version v) {
+		if (rec.valueExternal) {
+			for (LogicalPageID id : ExternalValue::pageIDs(rec.value.get())) {
+				m_pager->freePage(id, v);
+			}
+			++g_redwoodMetrics.metric.btreeValueExternalFree;
+		}
+	}
+
 	void freeBTreePage(int height, BTreeNodeLinkRef btPageID, Version v) {
 		// Free individual pages at v
 		for (LogicalPageID id : btPageID) {
@@ -6404,7 +7119,6 @@ private:
 	                                                      Reference<ArenaPage> page,
 	                                                      Version writeVersion) {
 		state BTreeNodeLinkRef newID;
-		newID.resize(*arena, oldID.size());
 
 		if (REDWOOD_DEBUG) {
 			const BTreePage* btPage = (const BTreePage*)page->mutateData();
@@ -6421,7 +7135,9 @@ private:
 		}
 
 		state unsigned int height = (unsigned int)((const BTreePage*)page->data())->height;
-		if (oldID.size() == 1) {
+		// A node read from a compressed page has more blocks than its link, so it can't be updated atomically
+		if (oldID.size() == 1 && page->rawSize() == self->m_pager->getPhysicalPageSize()) {
+			newID.resize(*arena, 1);
 			page->setLogicalPageInfo(oldID.front(), parentID);
 			LogicalPageID id = wait(
 			    self->m_pager->atomicUpdatePage(PagerEventReasons::Commit, height, oldID.front(), page, writeVersion));
@@ -6429,8 +7145,9 @@ private:
 			return newID;
 		}
 
+		newID.resize(*arena, self->m_pager->compressPage(page));
 		state int i = 0;
-		for (i = 0; i < oldID.size(); ++i) {
+		for (i = 0; i < newID.size(); ++i) {
 			LogicalPageID id = wait(self->m_pager->newPageID());
 			newID[i] = id;
 		}
@@ -6506,6 +7223,9 @@ private:
 		// actual items in the page.
 		int skipLen;
 
+		// If valid, the subtree is a leaf being relocated, to be rebuilt at this page ID if it still fits in one page
+		LogicalPageID relocateID = invalidLogicalPageID;
+
 		// Members below this point are "output" members, set by function calls from commitSubtree() once it decides
 		// what is happening with this slice of the tree.
 
@@ -6880,8 +7600,10 @@ private:
 		if (btPage->isLeaf()) {
 			// When true, we are modifying the existing DeltaTree
 			// When false, we are accumulating retained and added records in merged vector to build pages from them.
-			bool updatingDeltaTree = tryToUpdate;
-			bool changesMade = false;
+			// A leaf being relocated is always rebuilt.
+			bool relocatingLeaf = update->relocateID != invalidLogicalPageID;
+			bool updatingDeltaTree = tryToUpdate && !relocatingLeaf;
+			bool changesMade = relocatingLeaf;
 
 			// Copy page for modification if not already copied
 			auto copyForUpdate = [&]() {
@@ -6924,11 +7646,17 @@ private:
 				if (applyBoundaryChange) {
 					// If the boundary is being set to a value, the new KV record will be inserted
 					bool shouldInsertBoundary = mBegin.mutation().boundarySet();
+					Optional<ValueRef> externalValue;
+					if (shouldInsertBoundary) {
+						externalValue = batch->externalValue(mBegin.key());
+					}
 
 					// Optimization:  In-place value update of new same-sized value
 					// If the boundary exists in the page and we're in update mode and the boundary is being set to a
-					// new value of the same length as the old value then just update the value bytes.
-					if (boundaryExists && updatingDeltaTree && shouldInsertBoundary &&
+					// new value of the same length as the old value then just update the value bytes.  Neither value
+					// can be external, as the old one's page must be freed and the new one is a reference.
+					if (boundaryExists && updatingDeltaTree && shouldInsertBoundary && !externalValue.present() &&
+					    !cursor.get().valueExternal &&
 					    mBegin.mutation().boundaryValue.get().size() == cursor.get().value.get().size()) {
 						changesMade = true;
 						shouldInsertBoundary = false;
@@ -6945,6 +7673,7 @@ private:
 					} else if (boundaryExists) {
 						// An in place update can't be done, so if the boundary exists then erase or skip the record
 						changesMade = true;
+						self->freeExternalValue(cursor.get(), batch->writeVersion);
 
 						// If updating, erase from the page, otherwise do not add to the output set
 						if (updatingDeltaTree) {
@@ -6966,6 +7695,9 @@ private:
 					// If the boundary value is being set and we must insert it, add it to the page or the output set
 					if (shouldInsertBoundary) {
 						RedwoodRecordRef rec(mBegin.key(), mBegin.mutation().boundaryValue.get());
+						if (externalValue.present()) {
+							rec = rec.withExternalValue(externalValue.get());
+						}
 						changesMade = true;
 
 						// If updating, first try to add the record to the page
@@ -7053,7 +7785,15 @@ private:
 					             remove,
 					             updatingDeltaTree,
 					             mBegin.key().toString().c_str());
-					cursor.seekGreaterThanOrEqual(end, update->skipLen);
+					if (remove && self->m_header.externalValues) {
+						// The records being removed must be visited to free their external values
+						while (cursor.valid() && cursor.get().compare(end, update->skipLen) < 0) {
+							self->freeExternalValue(cursor.get(), batch->writeVersion);
+							cursor.moveNext();
+						}
+					} else {
+						cursor.seekGreaterThanOrEqual(end, update->skipLen);
+					}
 				} else {
 					// Otherwise we must visit the records.  If updating, the visit is to erase them, and if doing a
 					// linear merge than the visit is to add them to the output set.
@@ -7063,6 +7803,7 @@ private:
 							             context.c_str(),
 							             cursor.get().toString().c_str());
 
+							self->freeExternalValue(cursor.get(), batch->writeVersion);
 							copyForUpdate();
 							btPage->kvBytes -= cursor.get().kvBytes();
 							cursor.erase();
@@ -7092,6 +7833,12 @@ private:
 					             context.c_str(),
 					             remove,
 					             updatingDeltaTree);
+					// Records being removed must still be visited to free their external values
+					if (remove && self->m_header.externalValues) {
+						for (auto c = cursor; c.valid(); c.moveNext()) {
+							self->freeExternalValue(c.get(), batch->writeVersion);
+						}
+					}
 				} else {
 					// If updating and the key is changing, we must visit the records to erase them.
 					// If not updating and the key is not changing, we must visit the records to add them to the output
@@ -7103,6 +7850,7 @@ private:
 							    context.c_str(),
 							    cursor.get().toString().c_str());
 
+							self->freeExternalValue(cursor.get(), batch->writeVersion);
 							copyForUpdate();
 							btPage->kvBytes -= cursor.get().kvBytes();
 							cursor.erase();
@@ -7156,7 +7904,7 @@ private:
 					                                       update->decodeLowerBound,
 					                                       update->decodeUpperBound)));
 
-					update->updatedInPlace(newID, btPage, newID.size() * self->m_blockSize);
+					update->updatedInPlace(newID, btPage, self->nodeCapacity(pageCopy));
 					debug_printf("%s Leaf node updated in-place, returning slice:\n", context.c_str());
 					debug_print(addPrefix(context, update->toString()));
 				}
@@ -7167,6 +7915,9 @@ private:
 			if (merged.empty()) {
 				update->cleared();
 				self->freeBTreePage(height, rootID, batch->writeVersion);
+				if (update->relocateID != invalidLogicalPageID) {
+					self->m_pager->freePage(update->relocateID, batch->writeVersion);
+				}
 
 				debug_printf("%s All leaf page contents were cleared, returning slice:\n", context.c_str());
 				debug_print(addPrefix(context, update->toString()));
@@ -7181,7 +7932,8 @@ private:
 			                                                                        height,
 			                                                                        batch->writeVersion,
 			                                                                        rootID,
-			                                                                        parentID));
+			                                                                        parentID,
+			                                                                        update->relocateID));
 
 			// Put new links into update and tell update that pages were rebuilt
 			update->rebuilt(entries);
@@ -7194,6 +7946,18 @@ private:
 			std::vector<Future<Void>> recursions;
 			state std::vector<std::unique_ptr<InternalPageSliceUpdate>> slices;
 
+			// If this is the level 2 page being relocated, its leaves are visited whether or not they have changed and
+			// are given consecutive new pages, in key order.  Any pages not used are freed after the recursions.
+			state bool relocating = height == 2 && rootID.size() == 1 && batch->relocation.present() &&
+			                        batch->relocation.get().pageID == rootID.front();
+			state LogicalPageID relocateNext = invalidLogicalPageID;
+			state LogicalPageID relocateEnd = invalidLogicalPageID;
+			if (relocating) {
+				relocateNext = self->m_pager->newContiguousPageIDs(btPage->tree()->numItems);
+				relocateEnd = relocateNext + btPage->tree()->numItems;
+				++g_redwoodMetrics.metric.btreeRelocateSubtree;
+			}
+
 			cursor.moveFirst();
 
 			bool first = true;
@@ -7274,6 +8038,13 @@ private:
 						// must be also unchanged or must be different than the subtree lower bound key so that it
 						// doesn't matter
 						uniform = !range.boundaryChanged || mutationBoundaryKey != u.subtreeLowerBound.key;
+
+						// Unchanged subtrees are still visited to reach the page being relocated and its leaves
+						if (relocating ||
+						    (height > 2 &&
+						     batch->relocationIntersects(u.subtreeLowerBound.key, u.subtreeUpperBound.key))) {
+							uniform = false;
+						}
 					}
 
 					// If u's subtree is either all cleared or all unchanged
@@ -7323,7 +8094,8 @@ private:
 							while (c != u.cEnd) {
 								RedwoodRecordRef rec = c.get();
 								if (rec.value.present()) {
-									if (height == 2) {
+									// Leaves that may have external values are cleared lazily, as they must be read
+									if (height == 2 && !self->m_header.externalValues) {
 										debug_printf("%s freeing child page in cleared subtree range: %s\n",
 										             context.c_str(),
 										             ::toString(rec.getChildPage()).c_str());
@@ -7355,6 +8127,9 @@ private:
 				debug_printf("%s Recursing for %s\n", context.c_str(), toString(pageID).c_str());
 				debug_print(addPrefix(context, u.toString()));
 
+				if (relocating) {
+					u.relocateID = relocateNext++;
+				}
 				recursions.push_back(
 				    self->commitSubtree(self, batch, pageID, rootID.front(), height - 1, mBegin, mEnd, &u));
 			}
@@ -7371,6 +8146,10 @@ private:
 			wait(waitForAll(recursions));
 			debug_printf("%s Recursions done, processing slice updates.\n", context.c_str());
 
+			while (relocateNext != relocateEnd) {
+				self->m_pager->freePage(relocateNext++, batch->writeVersion);
+			}
+
 			// ParentInfo could be invalid after a wait and must be re-initialized.
 			// All uses below occur before waits so no reinitialization is done.
 			state ParentInfo* parentInfo = &self->childUpdateTracker[rootID.front()];
@@ -7506,7 +8285,7 @@ private:
 						                                       update->decodeLowerBound,
 						                                       update->decodeUpperBound)));
 
-						update->updatedInPlace(newID, btPage, newID.size() * self->m_blockSize);
+						update->updatedInPlace(newID, btPage, self->nodeCapacity(pageCopy));
 						debug_printf("%s Internal node updated in-place, returning slice:\n", context.c_str());
 						debug_print(addPrefix(context, update->toString()));
 					} else {
@@ -7553,7 +8332,8 @@ private:
 						                    height,
 						                    batch->writeVersion,
 						                    rootID,
-						                    parentID));
+						                    parentID,
+						                    invalidLogicalPageID));
 						update->rebuilt(newChildEntries);
 
 						debug_printf("%s Internal page rebuilt, returning slice:\n", context.c_str());
@@ -7578,6 +8358,8 @@ private:
 
 		batch.writeVersion = writeVersion;
 		batch.newOldestVersion = self->m_newOldestVersion;
+		batch.relocation = std::move(self->m_relocation);
+		self->m_relocation.reset();
 
 		// Wait for the latest commit to be finished.
 		wait(previousCommit);
@@ -7603,6 +8385,13 @@ private:
 
 		batch.snapshot = self->m_pager->getReadSnapshot(batch.readVersion);
 
+		if (self->m_valueExternalThreshold > 0) {
+			wait(writeExternalValues(self, &batch));
+			if (!batch.externalValues.empty()) {
+				self->m_header.externalValues = true;
+			}
+		}
+
 		state BTreeNodeLink rootNodeLink = self->m_header.root;
 		state InternalPageSliceUpdate all;
 		state RedwoodRecordRef rootLink = dbBegin.withPageID(rootNodeLink);
@@ -7677,21 +8466,176 @@ public:
 		};
 
 	private:
+		// State of a prefetch started by prefetch(), which runs ahead of the cursor as it moves through leaves
+		struct Prefetcher {
+			Key rangeEnd;
+			bool forward;
+			int estRecordsPerPage;
+			// Remaining budget, estimated for leaves that have not been read yet
+			int recordsLeft;
+			int bytesLeft;
+			// Internal pages from level 2 up, with cursors at the links most recently prefetched
+			std::vector<PathEntry> path;
+			// An internal page being read to replace path[pendingIndex], whose link is pendingLink
+			Future<Reference<const ArenaPage>> pendingPage;
+			BTreePage::BinaryTree::Cursor pendingLink;
+			int pendingIndex;
+			// Whether path[0] was just replaced so its cursor is at a link that has not been prefetched yet
+			bool atUnvisitedLink = false;
+			// Leaves prefetched but not yet reached by the cursor, as their first page ID and size
+			std::deque<std::pair<LogicalPageID, int>> unreached;
+			std::vector<Future<Reference<const ArenaPage>>> inFlight;
+
+			~Prefetcher() {
+				for (auto const& leaf : unreached) {
+					g_redwoodMetrics.metric.btreeLeafPreloadWasted += leaf.second;
+				}
+			}
+		};
+
 		PagerEventReasons reason;
 		Optional<ReadOptions> options;
 		VersionedBTree* btree;
 		Reference<IPagerSnapshot> pager;
 		bool valid;
 		std::vector<PathEntry> path;
+		std::unique_ptr<Prefetcher> prefetcher;
 
-	public:
-		BTreeCursor() : reason(PagerEventReasons::MAXEVENTREASONS) {}
+		// Returns whether key is within the key range of the page at path[index]
+		bool pathCovers(int index, KeyRef key) const {
+			if (index == 0) {
+				return true;
+			}
+			const BTreePage::BinaryTree::Cursor& link = path[index - 1].cursor;
+			return link.get().key <= key && key < link.next().getOrUpperBound().key;
+		}
 
-		bool initialized() const { return pager.isValid(); }
-		bool isValid() const { return valid; }
+		// Moves c to the next link in the prefetch direction which is not null and is not past the range end
+		bool advancePrefetchLink(BTreePage::BinaryTree::Cursor& c) const {
+			const Prefetcher& p = *prefetcher;
+			do {
+				if (p.forward) {
+					// If there is no right sibling or its lower boundary is greater
+					// or equal to than the range end then stop.
+					if (!c.moveNext() || c.get().key >= p.rangeEnd) {
+						return false;
+					}
+				} else {
+					// If the current lower boundary is less than or equal to the range end
+					// or there is no left sibling then stop
+					if (c.get().key <= p.rangeEnd || !c.movePrev()) {
+						return false;
+					}
+				}
+			} while (!c.get().value.present());
+			return true;
+		}
 
-		// path entries at dumpHeight or below will have their entire pages printed
-		std::string toString(int dumpHeight = 0) const {
+		// Read the internal page linked to from p.path[index + 1], which replaces p.path[index] once read
+		void readPrefetchPage(int index) {
+			Prefetcher& p = *prefetcher;
+			p.pendingLink = p.path[index + 1].cursor;
+			p.pendingIndex = index;
+			p.pendingPage = readPage(btree,
+			                         PagerEventReasons::RangePrefetch,
+			                         index + 2,
+			                         pager.getPtr(),
+			                         p.pendingLink.get().getChildPage(),
+			                         ioLeafPriority,
+			                         false,
+			                         true);
+		}
+
+		// Counts the prefetch of the cursor's leaf as used, and prefetches more leaves while the budget and queue
+		// depth allow
+		void prefetchMore() {
+			Prefetcher& p = *prefetcher;
+
+			if (path.size() >= 2) {
+				LogicalPageID leaf = path[path.size() - 2].cursor.get().getChildPage().front();
+				auto it = std::find_if(p.unreached.begin(), p.unreached.end(), [=](auto const& l) {
+					return l.first == leaf;
+				});
+				if (it != p.unreached.end()) {
+					// Prefetched leaves the cursor moved past were not needed
+					for (auto i = p.unreached.begin(); i != it; ++i) {
+						g_redwoodMetrics.metric.btreeLeafPreloadWasted += i->second;
+					}
+					++g_redwoodMetrics.metric.btreeLeafPreloadUsed;
+					p.unreached.erase(p.unreached.begin(), it + 1);
+				}
+			}
+
+			p.inFlight.erase(std::remove_if(p.inFlight.begin(), p.inFlight.end(), [](auto const& f) {
+				                 return f.isReady();
+			                 }),
+			                 p.inFlight.end());
+
+			// While query limits are not exceeded and the queue has room
+			while (p.recordsLeft > 0 && p.bytesLeft > 0 &&
+			       p.inFlight.size() < SERVER_KNOBS->REDWOOD_RANGE_PREFETCH_QUEUE_DEPTH) {
+				if (p.pendingPage.isValid()) {
+					if (!p.pendingPage.isReady()) {
+						break;
+					}
+					if (p.pendingPage.isError()) {
+						p.recordsLeft = 0;
+						break;
+					}
+					// Continue the walk from the first or last link of the new internal page
+					Reference<const ArenaPage> page = p.pendingPage.get();
+					p.pendingPage = Future<Reference<const ArenaPage>>();
+					PathEntry& entry = p.path[p.pendingIndex];
+					entry.page = page;
+					entry.cursor = btree->getCursor(page.getPtr(), p.pendingLink);
+					UNSTOPPABLE_ASSERT(p.forward ? entry.cursor.moveFirst() : entry.cursor.moveLast());
+					if (!entry.cursor.get().value.present() && !advancePrefetchLink(entry.cursor)) {
+						p.recordsLeft = 0;
+						break;
+					}
+					if (p.pendingIndex > 0) {
+						readPrefetchPage(p.pendingIndex - 1);
+						continue;
+					}
+					p.atUnvisitedLink = true;
+				}
+
+				BTreePage::BinaryTree::Cursor& c = p.path[0].cursor;
+				if (!p.atUnvisitedLink && !advancePrefetchLink(c)) {
+					// The level 2 page has no more links in range, so continue with the next subtree of the
+					// lowest ancestor that has one
+					int index = 1;
+					while (index < p.path.size() && !advancePrefetchLink(p.path[index].cursor)) {
+						++index;
+					}
+					if (index == p.path.size()) {
+						p.recordsLeft = 0;
+						break;
+					}
+					readPrefetchPage(index - 1);
+					continue;
+				}
+				p.atUnvisitedLink = false;
+
+				BTreeNodeLinkRef childPage = c.get().getChildPage();
+				if (childPage.size() > 0) {
+					p.inFlight.push_back(preLoadPage(pager.getPtr(), childPage, ioLeafPriority));
+					p.unreached.emplace_back(childPage.front(), childPage.size() * btree->m_blockSize);
+				}
+				p.recordsLeft -= p.estRecordsPerPage;
+				// Use leaf node capacity as an estimate of bytes read.
+				p.bytesLeft -= childPage.size() * btree->m_blockSize;
+			}
+		}
+
+	public:
+		BTreeCursor() : reason(PagerEventReasons::MAXEVENTREASONS) {}
+
+		bool initialized() const { return pager.isValid(); }
+		bool isValid() const { return valid; }
+
+		// path entries at dumpHeight or below will have their entire pages printed
+		std::string toString(int dumpHeight = 0) const {
 			std::string r = format("{ptr=%p reason=%s %s ",
 			                       this,
 			                       PagerEventReasonsStrings[(int)reason],
@@ -7728,6 +8672,19 @@ public:
 
 		const RedwoodRecordRef get() { return path.back().cursor.get(); }
 
+		// Returns the size of the value of rec, a leaf record read through the cursor, without reading the value if
+		// it is external
+		static int valueSize(const RedwoodRecordRef& rec) {
+			return rec.valueExternal ? ExternalValue::size(rec.value.get()) : rec.value.get().size();
+		}
+
+		// Reads the value of rec, a leaf record read through the cursor whose value is external
+		Future<Value> readExternalValue(const RedwoodRecordRef& rec) const {
+			ASSERT(rec.valueExternal);
+			return VersionedBTree::readExternalValue(
+			    pager.getPtr(), reason, rec.value.get(), !options.present() || options.get().cacheResult);
+		}
+
 		bool inRoot() const { return path.size() == 1; }
 
 		// To enable more efficient range scans, caller can read the lowest page
@@ -7792,6 +8749,7 @@ public:
 			reason = reason_in;
 			options = options_in;
 			pager = pager_in;
+			prefetcher.reset();
 			path.clear();
 			path.reserve(6);
 			valid = false;
@@ -7807,9 +8765,17 @@ public:
 		//     If there is a record in the tree > query then moveNext() will move to it.
 		// If non-zero is returned then the cursor is valid and the return value is logically equivalent
 		// to query.compare(cursor.get())
-		ACTOR Future<int> seek_impl(BTreeCursor* self, RedwoodRecordRef query) {
+		// If keepPath is true, the search starts from the lowest page on the current path whose key range contains
+		// query instead of from the root.
+		ACTOR Future<int> seek_impl(BTreeCursor* self, RedwoodRecordRef query, bool keepPath) {
 			state RedwoodRecordRef internalPageQuery = query.withMaxPageID();
-			self->path.resize(1);
+			if (keepPath) {
+				while (self->path.size() > 1 && !self->pathCovers(self->path.size() - 1, query.key)) {
+					self->path.pop_back();
+				}
+			} else {
+				self->path.resize(1);
+			}
 			debug_printf("seek(%s) start cursor = %s\n", query.toString().c_str(), self->toString().c_str());
 
 			loop {
@@ -7842,73 +8808,75 @@ public:
 			}
 		}
 
-		Future<int> seek(RedwoodRecordRef query) { return path.empty() ? 0 : seek_impl(this, query); }
+		Future<int> seek(RedwoodRecordRef query, bool keepPath = false) {
+			return path.empty() ? 0 : seek_impl(this, query, keepPath);
+		}
 
-		ACTOR Future<Void> seekGTE_impl(BTreeCursor* self, RedwoodRecordRef query) {
+		ACTOR Future<Void> seekGTE_impl(BTreeCursor* self, RedwoodRecordRef query, bool keepPath) {
 			debug_printf("seekGTE(%s) start\n", query.toString().c_str());
-			int cmp = wait(self->seek(query));
+			int cmp = wait(self->seek(query, keepPath));
 			if (cmp > 0 || (cmp == 0 && !self->isValid())) {
 				wait(self->moveNext());
 			}
 			return Void();
 		}
 
-		Future<Void> seekGTE(RedwoodRecordRef query) { return seekGTE_impl(this, query); }
+		Future<Void> seekGTE(RedwoodRecordRef query) { return seekGTE_impl(this, query, false); }
+
+		// Like seekGTE(), but keeps the pages on the cursor's path whose key ranges contain query, so a sequence of
+		// nearby queries only searches the pages below where their paths diverge
+		Future<Void> seekGTEFromPath(RedwoodRecordRef query) { return seekGTE_impl(this, query, true); }
+
+		// Starts reading the leaf which would contain key into the page cache, if key is under the level 2 page on the
+		// cursor's path and the leaf is not lastLeaf, which is then set to it.  Returns false if key is not under that
+		// level 2 page.
+		bool preloadLeaf(KeyRef key, LogicalPageID& lastLeaf, std::vector<Future<Reference<const ArenaPage>>>& reads) {
+			if (path.size() < 2 || path[path.size() - 2].btPage()->height != 2 || !pathCovers(path.size() - 2, key)) {
+				return false;
+			}
+			BTreePage::BinaryTree::Cursor c = path[path.size() - 2].cursor;
+			if (c.seekLessThan(RedwoodRecordRef(key).withMaxPageID()) && c.get().value.present()) {
+				BTreeNodeLinkRef childPage = c.get().getChildPage();
+				if (childPage.front() != lastLeaf) {
+					lastLeaf = childPage.front();
+					reads.push_back(preLoadPage(pager.getPtr(), childPage, ioLeafPriority));
+				}
+			}
+			return true;
+		}
 
-		// Start fetching sibling nodes in the forward or backward direction, stopping after recordLimit or byteLimit
+		// Start fetching the leaves after the cursor's leaf in the forward or backward direction, stopping after
+		// recordLimit or byteLimit. The prefetch continues across parent boundaries as the cursor moves to new leaves,
+		// with at most REDWOOD_RANGE_PREFETCH_QUEUE_DEPTH leaf reads outstanding.
 		void prefetch(KeyRef rangeEnd, bool directionForward, int recordLimit, int byteLimit) {
 			// Prefetch scans level 2 so if there are less than 2 nodes in the path there is no level 2
 			if (path.size() < 2) {
 				return;
 			}
+			ASSERT(path[path.size() - 2].btPage()->height == 2);
 
 			auto firstLeaf = path.back().btPage();
+			prefetcher = std::make_unique<Prefetcher>();
+			Prefetcher& p = *prefetcher;
+			p.rangeEnd = rangeEnd;
+			p.forward = directionForward;
 
 			// We know the first leaf's record count, so assume they are all relevant to the query,
 			// even though some may not be.
-			int recordsRead = firstLeaf->tree()->numItems;
-
 			// We can't know for sure how many records are in a node without reading it, so just guess
-			// that siblings have about the same record count as the first leaf.
-			int estRecordsPerPage = recordsRead;
-
-			// Use actual KVBytes stored for the first leaf, but use node capacity for siblings below
-			int bytesRead = firstLeaf->kvBytes;
+			// that other leaves have about the same record count as the first leaf.
+			p.estRecordsPerPage = firstLeaf->tree()->numItems;
+			p.recordsLeft = recordLimit - p.estRecordsPerPage;
 
-			// Cursor for moving through siblings.
-			// Note that only immediate siblings under the same parent are considered for prefetch so far.
-			BTreePage::BinaryTree::Cursor c = path[path.size() - 2].cursor;
-			ASSERT(path[path.size() - 2].btPage()->height == 2);
+			// Use actual KVBytes stored for the first leaf, but use node capacity for other leaves
+			p.bytesLeft = byteLimit - firstLeaf->kvBytes;
 
-			// The loop conditions are split apart into different if blocks for readability.
-			// While query limits are not exceeded
-			while (recordsRead < recordLimit && bytesRead < byteLimit) {
-				// If prefetching right siblings
-				if (directionForward) {
-					// If there is no right sibling or its lower boundary is greater
-					// or equal to than the range end then stop.
-					if (!c.moveNext() || c.get().key >= rangeEnd) {
-						break;
-					}
-				} else {
-					// Prefetching left siblings
-					// If the current leaf lower boundary is less than or equal to the range end
-					// or there is no left sibling then stop
-					if (c.get().key <= rangeEnd || !c.movePrev()) {
-						break;
-					}
-				}
-
-				// Prefetch the sibling if the link is not null
-				if (c.get().value.present()) {
-					BTreeNodeLinkRef childPage = c.get().getChildPage();
-					if (childPage.size() > 0)
-						preLoadPage(pager.getPtr(), childPage, ioLeafPriority);
-					recordsRead += estRecordsPerPage;
-					// Use sibling node capacity as an estimate of bytes read.
-					bytesRead += childPage.size() * this->btree->m_blockSize;
-				}
+			// The prefetch walks its own copy of the cursor's internal pages, the first of which is at level 2
+			for (int i = path.size() - 2; i >= 0; --i) {
+				p.path.push_back(path[i]);
 			}
+
+			prefetchMore();
 		}
 
 		ACTOR Future<Void> seekLT_impl(BTreeCursor* self, RedwoodRecordRef query) {
@@ -7923,6 +8891,7 @@ public:
 		Future<Void> seekLT(RedwoodRecordRef query) { return seekLT_impl(this, query); }
 
 		ACTOR Future<Void> move_impl(BTreeCursor* self, bool forward) {
+			state bool newLeaf = false;
 			// Try to the move cursor at the end of the path in the correct direction
 			debug_printf("move%s() start cursor=%s\n", forward ? "Next" : "Prev", self->toString().c_str());
 			while (1) {
@@ -7973,9 +8942,13 @@ public:
 				wait(self->pushPage(entry.cursor));
 				auto& newEntry = self->path.back();
 				UNSTOPPABLE_ASSERT(forward ? newEntry.cursor.moveFirst() : newEntry.cursor.moveLast());
+				newLeaf = true;
 			}
 
 			self->valid = true;
+			if (newLeaf && self->prefetcher) {
+				self->prefetchMore();
+			}
 
 			debug_printf("move%s() exit cursor=%s\n", forward ? "Next" : "Prev", self->toString(1).c_str());
 			return Void();
@@ -8009,8 +8982,6 @@ public:
 	}
 };
 
-#include "fdbserver/art_impl.h"
-
 RedwoodRecordRef VersionedBTree::dbBegin(""_sr);
 RedwoodRecordRef VersionedBTree::dbEnd("\xff\xff\xff\xff\xff"_sr);
 
@@ -8057,6 +9028,7 @@ public:
 		                               false);
 		m_tree = new VersionedBTree(
 		    pager, filename, logID, db, encryptionMode, encodingType, keyProvider, encryptionMonitor);
+		m_tree->setValueExternalThreshold(SERVER_KNOBS->REDWOOD_VALUE_EXTERNAL_THRESHOLD);
 		m_init = catchError(init_impl(this));
 	}
 
@@ -8121,8 +9093,10 @@ public:
 
 	Future<Void> commit(bool sequential = false) override {
 		m_lastCommit = catchError(m_tree->commit(m_nextCommitVersion));
-		// Currently not keeping history
-		m_tree->setOldestReadableVersion(m_nextCommitVersion);
+		// History is only kept from the oldest pinned snapshot on
+		m_tree->setOldestReadableVersion(m_pinnedVersions.empty()
+		                                     ? m_nextCommitVersion
+		                                     : std::min(m_nextCommitVersion, m_pinnedVersions.begin()->first));
 		++m_nextCommitVersion;
 		return m_lastCommit;
 	}
@@ -8131,6 +9105,8 @@ public:
 
 	StorageBytes getStorageBytes() const override { return m_tree->getStorageBytes(); }
 
+	std::pair<int64_t, int64_t> getLazyClearProgress() const override { return m_tree->getLazyClearProgress(); }
+
 	Future<Void> getError() const override { return delayed(getErrorNoDelay()); }
 
 	Future<Void> getErrorNoDelay() const { return m_errorPromise.getFuture() || m_tree->getError(); };
@@ -8145,25 +9121,95 @@ public:
 		m_tree->set(keyValue);
 	}
 
+	// Unlike the default, which sets the records one at a time, this hands them to the mutation buffer by reference to
+	// data's arena, so that fetched values are not copied again before the commit builds them into pages.
+	Future<Void> replaceRange(KeyRange range, Standalone<VectorRef<KeyValueRef>> data) override {
+		return ingestRange_impl(this, range, data);
+	}
+
+	ACTOR static Future<Void> ingestRange_impl(KeyValueStoreRedwood* self,
+	                                           KeyRange range,
+	                                           Standalone<VectorRef<KeyValueRef>> data) {
+		state int begin = 0;
+		if (range.empty()) {
+			return Void();
+		}
+		debug_printf("REPLACERANGE %s records=%d\n", printable(range).c_str(), data.size());
+		self->m_tree->clear(range);
+		while (begin < data.size()) {
+			// Only whole batches go into a mutation buffer, since a commit during the yield starts a new one
+			const int end = std::min(begin + 1000, data.size());
+			self->m_tree->setAll(data.slice(begin, end), data.arena());
+			begin = end;
+			if (begin < data.size()) {
+				wait(yield());
+			}
+		}
+		return Void();
+	}
+
 	Future<RangeResult> readRange(KeyRangeRef keys,
 	                              int rowLimit,
 	                              int byteLimit,
 	                              Optional<ReadOptions> options) override {
 		debug_printf("READRANGE %s\n", printable(keys).c_str());
-		return catchError(readRange_impl(this, keys, rowLimit, byteLimit, options));
+		return catchError(
+		    readRange_impl(this, keys, rowLimit, byteLimit, options, false, m_tree->getLastCommittedVersion()));
+	}
+
+	// Returns the keys with empty values, which doesn't read external values or count any value bytes
+	Future<RangeResult> readKeys(KeyRangeRef keys,
+	                             int rowLimit,
+	                             int byteLimit,
+	                             Optional<ReadOptions> options) override {
+		debug_printf("READKEYS %s\n", printable(keys).c_str());
+		return catchError(
+		    readRange_impl(this, keys, rowLimit, byteLimit, options, true, m_tree->getLastCommittedVersion()));
+	}
+
+	// A snapshot is the version of the commit it was pinned after. The pager keeps the versions from the oldest pinned
+	// one on readable, and reads of an unpinned version which were already started hold their pager snapshot.
+	int64_t pinSnapshot() override {
+		Version v = m_tree->getLastCommittedVersion();
+		++m_pinnedVersions[v];
+		return v;
+	}
+
+	void unpinSnapshot(int64_t snapshot) override {
+		auto i = m_pinnedVersions.find(snapshot);
+		ASSERT(i != m_pinnedVersions.end());
+		if (--i->second == 0) {
+			m_pinnedVersions.erase(i);
+		}
+	}
+
+	Future<Optional<Value>> readValueAtSnapshot(int64_t snapshot, KeyRef key, Optional<ReadOptions> options) override {
+		ASSERT(m_pinnedVersions.count(snapshot));
+		return catchError(readValue_impl(this, key, options, snapshot));
+	}
+
+	Future<RangeResult> readRangeAtSnapshot(int64_t snapshot,
+	                                        KeyRangeRef keys,
+	                                        int rowLimit,
+	                                        int byteLimit,
+	                                        Optional<ReadOptions> options) override {
+		ASSERT(m_pinnedVersions.count(snapshot));
+		return catchError(readRange_impl(this, keys, rowLimit, byteLimit, options, false, snapshot));
 	}
 
 	ACTOR static Future<RangeResult> readRange_impl(KeyValueStoreRedwood* self,
 	                                                KeyRange keys,
 	                                                int rowLimit,
 	                                                int byteLimit,
-	                                                Optional<ReadOptions> options) {
+	                                                Optional<ReadOptions> options,
+	                                                bool keysOnly,
+	                                                Version version) {
 		state PagerEventReasons reason = PagerEventReasons::RangeRead;
 		state VersionedBTree::BTreeCursor cur;
 		if (options.present() && options.get().type == ReadType::FETCH) {
 			reason = PagerEventReasons::FetchRange;
 		}
-		wait(self->m_tree->initBTreeCursor(&cur, self->m_tree->getLastCommittedVersion(), reason, options));
+		wait(self->m_tree->initBTreeCursor(&cur, version, reason, options));
 
 		state PriorityMultiLock::Lock lock;
 		state Future<Void> f;
@@ -8171,6 +9217,8 @@ public:
 
 		state RangeResult result;
 		state int accumulatedBytes = 0;
+		// External values of the results, which are read once all of the leaves have been, by result index
+		state std::vector<std::pair<int, Future<Value>>> externalReads;
 		ASSERT(byteLimit > 0);
 
 		if (rowLimit == 0) {
@@ -8204,11 +9252,21 @@ public:
 				bool usedPage = false;
 
 				while (leafCursor.valid()) {
-					KeyValueRef kv = leafCursor.get().toKeyValueRef();
+					const RedwoodRecordRef rec = leafCursor.get();
+					KeyValueRef kv = rec.toKeyValueRef();
 					if (checkBounds && kv.key.compare(keys.end) >= 0) {
 						break;
 					}
-					accumulatedBytes += kv.expectedSize();
+					if (keysOnly) {
+						accumulatedBytes += kv.key.expectedSize();
+						kv.value = ValueRef();
+					} else {
+						accumulatedBytes += kv.key.expectedSize() + VersionedBTree::BTreeCursor::valueSize(rec);
+					}
+					if (rec.valueExternal && !keysOnly) {
+						externalReads.emplace_back(result.size(), cur.readExternalValue(rec));
+						kv.value = ValueRef();
+					}
 					result.push_back(result.arena(), kv);
 					usedPage = true;
 					if (--rowLimit == 0 || accumulatedBytes >= byteLimit) {
@@ -8259,11 +9317,21 @@ public:
 				bool usedPage = false;
 
 				while (leafCursor.valid()) {
-					KeyValueRef kv = leafCursor.get().toKeyValueRef();
+					const RedwoodRecordRef rec = leafCursor.get();
+					KeyValueRef kv = rec.toKeyValueRef();
 					if (checkBounds && kv.key.compare(keys.begin) < 0) {
 						break;
 					}
-					accumulatedBytes += kv.expectedSize();
+					if (keysOnly) {
+						accumulatedBytes += kv.key.expectedSize();
+						kv.value = ValueRef();
+					} else {
+						accumulatedBytes += kv.key.expectedSize() + VersionedBTree::BTreeCursor::valueSize(rec);
+					}
+					if (rec.valueExternal && !keysOnly) {
+						externalReads.emplace_back(result.size(), cur.readExternalValue(rec));
+						kv.value = ValueRef();
+					}
 					result.push_back(result.arena(), kv);
 					usedPage = true;
 					if (++rowLimit == 0 || accumulatedBytes >= byteLimit) {
@@ -8289,6 +9357,13 @@ public:
 			}
 		}
 
+		state int i = 0;
+		for (; i < externalReads.size(); ++i) {
+			Value v = wait(externalReads[i].second);
+			result.arena().dependsOn(v.arena());
+			result[externalReads[i].first].value = v;
+		}
+
 		result.more = rowLimit == 0 || accumulatedBytes >= byteLimit;
 		g_redwoodMetrics.kvSizeReadByGetRange->sample(accumulatedBytes);
 		return result;
@@ -8296,14 +9371,20 @@ public:
 
 	ACTOR static Future<Optional<Value>> readValue_impl(KeyValueStoreRedwood* self,
 	                                                    Key key,
-	                                                    Optional<ReadOptions> options) {
+	                                                    Optional<ReadOptions> options,
+	                                                    Version version) {
 		state VersionedBTree::BTreeCursor cur;
-		wait(self->m_tree->initBTreeCursor(
-		    &cur, self->m_tree->getLastCommittedVersion(), PagerEventReasons::PointRead, options));
+		wait(self->m_tree->initBTreeCursor(&cur, version, PagerEventReasons::PointRead, options));
 
 		++g_redwoodMetrics.metric.opGet;
 		wait(cur.seekGTE(key));
 		if (cur.isValid() && cur.get().key == key) {
+			if (cur.get().valueExternal) {
+				Value v = wait(cur.readExternalValue(cur.get()));
+				g_redwoodMetrics.kvSizeReadByGet->sample(key.expectedSize() + v.expectedSize());
+				return v;
+			}
+
 			// Return a Value whose arena depends on the source page arena
 			Value v;
 			v.arena().dependsOn(cur.back().page->getArena());
@@ -8316,11 +9397,12 @@ public:
 	}
 
 	Future<Optional<Value>> readValue(KeyRef key, Optional<ReadOptions> options) override {
-		return catchError(readValue_impl(this, key, options));
+		return catchError(readValue_impl(this, key, options, m_tree->getLastCommittedVersion()));
 	}
 
 	Future<Optional<Value>> readValuePrefix(KeyRef key, int maxLength, Optional<ReadOptions> options) override {
-		return catchError(map(readValue_impl(this, key, options), [maxLength](Optional<Value> v) {
+		Future<Optional<Value>> value = readValue_impl(this, key, options, m_tree->getLastCommittedVersion());
+		return catchError(map(value, [maxLength](Optional<Value> v) {
 			if (v.present() && v.get().size() > maxLength) {
 				v.get().contents() = v.get().substr(0, maxLength);
 			}
@@ -8328,6 +9410,84 @@ public:
 		}));
 	}
 
+	// Looks every key up through one cursor at one committed version, visiting the keys in order.  Each seek starts
+	// from the part of the previous key's path that contains its key, so internal pages are searched once for all of
+	// the keys under them, and the leaves of the next keys under the same level 2 page are read concurrently ahead of
+	// the seeks.
+	ACTOR static Future<std::vector<Optional<Value>>> readValuePrefixes_impl(KeyValueStoreRedwood* self,
+	                                                                         std::vector<std::pair<KeyRef, int>> keys,
+	                                                                         Optional<ReadOptions> options) {
+		state VersionedBTree::BTreeCursor cur;
+		state std::vector<Optional<Value>> results(keys.size());
+		if (keys.empty()) {
+			return results;
+		}
+		wait(self->m_tree->initBTreeCursor(
+		    &cur, self->m_tree->getLastCommittedVersion(), PagerEventReasons::PointRead, options));
+
+		state std::vector<int> order(keys.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&k = keys](int a, int b) { return k[a].first < k[b].first; });
+
+		// Leaves are only read ahead if they would be cached by the seeks
+		state bool preload = !options.present() || options.get().cacheResult;
+		state std::vector<Future<Reference<const ArenaPage>>> leafReads;
+		// External values of the keys, which are read once all of the keys have been looked up, by key index
+		state std::vector<std::pair<int, Future<Value>>> externalReads;
+		state LogicalPageID lastLeaf = invalidLogicalPageID;
+		state int preloaded = 0;
+
+		state int i = 0;
+		for (; i < order.size(); ++i) {
+			++g_redwoodMetrics.metric.opGet;
+			Future<Void> f = cur.seekGTEFromPath(keys[order[i]].first);
+			if (f.isReady()) {
+				f.get();
+			} else {
+				wait(f);
+			}
+			if (preload) {
+				leafReads.erase(
+				    std::remove_if(leafReads.begin(), leafReads.end(), [](auto const& r) { return r.isReady(); }),
+				    leafReads.end());
+				preloaded = std::max(preloaded, i + 1);
+				while (preloaded < order.size() &&
+				       leafReads.size() < (size_t)SERVER_KNOBS->REDWOOD_RANGE_PREFETCH_QUEUE_DEPTH &&
+				       cur.preloadLeaf(keys[order[preloaded]].first, lastLeaf, leafReads)) {
+					++preloaded;
+				}
+			}
+			const int maxLength = keys[order[i]].second;
+			if (cur.isValid() && cur.get().key == keys[order[i]].first && cur.get().valueExternal) {
+				externalReads.emplace_back(order[i], cur.readExternalValue(cur.get()));
+			} else if (cur.isValid() && cur.get().key == keys[order[i]].first) {
+				// Return a Value whose arena depends on the source page arena
+				Value v;
+				v.arena().dependsOn(cur.back().page->getArena());
+				v.contents() = cur.get().value.get();
+				if (v.size() > maxLength) {
+					v.contents() = v.substr(0, maxLength);
+				}
+				g_redwoodMetrics.kvSizeReadByGet->sample(cur.get().kvBytes());
+				results[order[i]] = v;
+			}
+		}
+
+		for (i = 0; i < externalReads.size(); ++i) {
+			Value v = wait(externalReads[i].second);
+			const int k = externalReads[i].first;
+			g_redwoodMetrics.kvSizeReadByGet->sample(keys[k].first.expectedSize() + v.expectedSize());
+			results[k] = v.size() > keys[k].second ? Value(v.substr(0, keys[k].second), v.arena()) : v;
+		}
+
+		return results;
+	}
+
+	Future<std::vector<Optional<Value>>> readValuePrefixes(std::vector<std::pair<KeyRef, int>> const& keys,
+	                                                       Optional<ReadOptions> options) override {
+		return catchError(readValuePrefixes_impl(this, keys, options));
+	}
+
 	~KeyValueStoreRedwood() override{};
 
 private:
@@ -8338,6 +9498,7 @@ private:
 	Promise<Void> m_errorPromise;
 	bool prefetch;
 	Version m_nextCommitVersion;
+	std::map<Version, int> m_pinnedVersions; // The pins of each pinned snapshot
 	Reference<IPageEncryptionKeyProvider> m_keyProvider;
 	Future<Void> m_lastCommit = Void();
 
@@ -8857,6 +10018,16 @@ RedwoodRecordRef randomRedwoodRecordRef(const std::string& keyBuffer, const std:
 void RedwoodMetrics::getFields(TraceEvent* e, std::string* s, bool skipZeroes) {
 	std::pair<const char*, unsigned int> metrics[] = { { "BTreePreload", metric.btreeLeafPreload },
 		                                               { "BTreePreloadExt", metric.btreeLeafPreloadExt },
+		                                               { "BTreePreloadUsed", metric.btreeLeafPreloadUsed },
+		                                               { "BTreePreloadWasted", metric.btreeLeafPreloadWasted },
+		                                               { "", 0 },
+		                                               { "BTreeRelocateScan", metric.btreeRelocateScan },
+		                                               { "BTreeRelocateSubtree", metric.btreeRelocateSubtree },
+		                                               { "BTreeRelocateLeaf", metric.btreeRelocateLeaf },
+		                                               { "", 0 },
+		                                               { "BTreeValueExternalWrite", metric.btreeValueExternalWrite },
+		                                               { "BTreeValueExternalRead", metric.btreeValueExternalRead },
+		                                               { "BTreeValueExternalFree", metric.btreeValueExternalFree },
 		                                               { "", 0 },
 		                                               { "OpSet", metric.opSet },
 		                                               { "OpSetKeyBytes", metric.opSetKeyBytes },
@@ -8878,6 +10049,15 @@ void RedwoodMetrics::getFields(TraceEvent* e, std::string* s, bool skipZeroes) {
 		                                               { "PagerEvictUnhit", metric.pagerEvictUnhit },
 		                                               { "PagerEvictFail", metric.pagerEvictFail },
 		                                               { "", 0 },
+		                                               { "PagerCacheProbationHit", metric.pagerCacheProbationHit },
+		                                               { "PagerCacheProtectedHit", metric.pagerCacheProtectedHit },
+		                                               { "PagerCacheDemote", metric.pagerCacheDemote },
+		                                               { "", 0 },
+		                                               { "PagerCompressedWrite", metric.pagerCompressedWrite },
+		                                               { "PagerCompressSavedBlocks", metric.pagerCompressSavedBlocks },
+		                                               { "PagerDecompress", metric.pagerDecompress },
+		                                               { "PagerEncodeOffload", metric.pagerEncodeOffload },
+		                                               { "", 0 },
 		                                               { "PagerRemapFree", metric.pagerRemapFree },
 		                                               { "PagerRemapCopy", metric.pagerRemapCopy },
 		                                               { "PagerRemapSkip", metric.pagerRemapSkip },
@@ -8916,7 +10096,10 @@ void RedwoodMetrics::getFields(TraceEvent* e, std::string* s, bool skipZeroes) {
 	std::pair<const char*, int64_t> cacheMetrics[] = { { "PageCacheCount", evictor->getCountUsed() },
 		                                               { "PageCacheMoved", evictor->getCountMoved() },
 		                                               { "PageCacheSize", evictor->getSizeUsed() },
-		                                               { "DecodeCacheSize", evictor->reservedSize } };
+		                                               { "PageCacheProtectedSize", evictor->getProtectedSize() },
+		                                               { "DecodeCacheSize", evictor->reservedSize },
+		                                               { "PageSlabUsed", PageSlab::getUsedMemory() },
+		                                               { "PageSlabResident", PageSlab::getTouchedMemory() } };
 
 	if (e != nullptr) {
 		for (auto& m : cacheMetrics) {
@@ -9016,6 +10199,45 @@ void RedwoodMetrics::getIOLockFields(TraceEvent* e, std::string* s) {
 	}
 }
 
+namespace {
+struct TestCacheObject {
+	bool evictable() const { return true; }
+	Future<Void> onEvictable() const { return Void(); }
+	Future<Void> cancel() { return Void(); }
+};
+} // namespace
+
+TEST_CASE("/redwood/correctness/unit/ObjectCache/scanResistance") {
+	state ObjectCache<LogicalPageID, TestCacheObject>::Evictor evictor(10);
+	state ObjectCache<LogicalPageID, TestCacheObject> cache(&evictor);
+
+	// A hot working set, read twice by point reads
+	for (int hit = 0; hit < 2; ++hit) {
+		for (LogicalPageID id = 0; id < 5; ++id) {
+			cache.get(id, 1);
+		}
+	}
+	// A scan many times larger than the cache, which rereads each page as a range read does after a prefetch
+	for (LogicalPageID id = 100; id < 200; ++id) {
+		cache.get(id, 1, false, true);
+		cache.get(id, 1, false, true);
+	}
+
+	// The working set survives, except for what was demoted from the protected segment to honor its limit
+	const int64_t protectedLimit = 10 * SERVER_KNOBS->REDWOOD_PAGE_CACHE_PROTECTED_FRACTION;
+	int survivors = 0;
+	for (LogicalPageID id = 0; id < 5; ++id) {
+		survivors += cache.getIfExists(id) != nullptr;
+	}
+	ASSERT_EQ(survivors, std::min<int64_t>(5, std::max<int64_t>(1, protectedLimit)));
+	ASSERT_EQ(evictor.getCountUsed(), 10);
+	ASSERT_EQ(evictor.getProtectedSize(), survivors);
+
+	wait(cache.clear());
+	ASSERT(evictor.empty());
+	return Void();
+}
+
 TEST_CASE("/redwood/correctness/unit/RedwoodRecordRef") {
 	ASSERT(RedwoodRecordRef::Delta::LengthFormatSizes[0] == 3);
 	ASSERT(RedwoodRecordRef::Delta::LengthFormatSizes[1] == 4);
@@ -9473,7 +10695,40 @@ TEST_CASE("Lredwood/correctness/unit/deltaTree/RedwoodRecordRef2") {
 			}
 		}
 		double elapsed = timer() - start;
-		printf("Elapsed %f\n", elapsed);
+		printf("Elapsed %f  (%f ns/seek)\n", elapsed, elapsed * 1e9 / 20000000);
+	}
+
+	{
+		DeltaTree2<RedwoodRecordRef>::Cursor c(makeReference<DeltaTree2<RedwoodRecordRef>::DecodeCache>(prev, next),
+		                                       tree);
+
+		printf("Doing 1M random seeks for keys near but not necessarily in the tree.\n");
+		for (int i = 0; i < 1000000; ++i) {
+			// Truncate, extend, or change the last byte of an item so that seeks end at all distances from it
+			RedwoodRecordRef query = items[deterministicRandom()->randomInt(0, items.size())];
+			std::string k = query.key.toString();
+			k.resize(deterministicRandom()->randomInt(0, k.size() + 1));
+			if (deterministicRandom()->coinflip()) {
+				k.append(deterministicRandom()->randomAlphaNumeric(deterministicRandom()->randomInt(0, 3)));
+			} else if (!k.empty()) {
+				k.back() += deterministicRandom()->randomInt(-1, 2);
+			}
+			Arena queryArena;
+			query.key = StringRef(queryArena, k);
+			if (deterministicRandom()->coinflip()) {
+				query.value.reset();
+			}
+
+			auto expected = std::upper_bound(items.begin(), items.end(), query);
+			if (c.seekLessThanOrEqual(query) != (expected != items.begin()) ||
+			    (c.valid() && c.get() != *(expected - 1))) {
+				printf("Found incorrect node!  query=%s  found=%s  expected=%s\n",
+				       query.toString().c_str(),
+				       c.valid() ? c.get().toString().c_str() : "<none>",
+				       expected != items.begin() ? (expected - 1)->toString().c_str() : "<none>");
+				ASSERT(false);
+			}
+		}
 	}
 
 	// {
@@ -11564,6 +12819,210 @@ TEST_CASE(":/redwood/performance/histograms") {
 	return Void();
 }
 
+namespace {
+// State shared by the actors of the :/redwood/performance/kvstore workload
+struct KVStoreWorkload {
+	enum Op { SET, CLEAR, CLEAR_RANGE, READ, READ_RANGE, COMMIT, OP_COUNT };
+	static constexpr const char* opNames[OP_COUNT] = { "set", "clear", "clear_range", "read", "read_range", "commit" };
+
+	IKeyValueStore* kvs;
+	RandomKeySetGenerator keys;
+	RandomValueGenerator values;
+	// Relative frequency of each operation type other than COMMIT, which happens after every commitOps writes
+	double weights[COMMIT];
+	int rangeWidth;
+	int commitOps;
+
+	int64_t opsLeft = 0;
+	int writesSinceCommit = 0;
+	int64_t logicalBytesWritten = 0;
+	Future<Void> commit = Void();
+	std::vector<DDSketch<double>> latencies = std::vector<DDSketch<double>>(OP_COUNT);
+	int64_t counts[OP_COUNT] = {};
+
+	KVStoreWorkload(IKeyValueStore* kvs, std::string keyGenerator, std::string valueGenerator)
+	  : kvs(kvs), keys(keyGenerator), values(valueGenerator) {}
+
+	Op chooseOp() const {
+		double total = 0;
+		for (double w : weights) {
+			total += w;
+		}
+		double r = deterministicRandom()->random01() * total;
+		int op = 0;
+		while (op < COMMIT - 1 && r >= weights[op]) {
+			r -= weights[op++];
+		}
+		return (Op)op;
+	}
+
+	void record(Op op, double seconds) {
+		latencies[op].addSample(seconds);
+		++counts[op];
+	}
+
+	JsonBuilderObject latencyStats(Op op) {
+		JsonBuilderObject o;
+		o["count"] = counts[op];
+		o["mean"] = latencies[op].mean();
+		o["p50"] = latencies[op].percentile(0.5);
+		o["p90"] = latencies[op].percentile(0.9);
+		o["p99"] = latencies[op].percentile(0.99);
+		o["p99.9"] = latencies[op].percentile(0.999);
+		o["max"] = counts[op] > 0 ? latencies[op].max() : 0.0;
+		return o;
+	}
+};
+
+ACTOR Future<Void> kvstoreWorkloadCommit(KVStoreWorkload* w) {
+	state double start = timer();
+	wait(w->kvs->commit());
+	w->record(KVStoreWorkload::COMMIT, timer() - start);
+	return Void();
+}
+
+ACTOR Future<Void> kvstoreWorkloadClient(KVStoreWorkload* w) {
+	state KVStoreWorkload::Op op;
+	state double start;
+	state KeyRange range;
+	while (w->opsLeft > 0) {
+		--w->opsLeft;
+		op = w->chooseOp();
+		start = timer();
+		if (op == KVStoreWorkload::READ) {
+			Optional<Value> v = wait(w->kvs->readValue(w->keys.next()));
+		} else if (op == KVStoreWorkload::READ_RANGE) {
+			range = w->keys.nextRange(w->rangeWidth);
+			RangeResult r = wait(w->kvs->readRange(range));
+		} else {
+			if (op == KVStoreWorkload::SET) {
+				KeyValueRef kv(w->keys.next(), w->values.next());
+				w->kvs->set(kv);
+				w->logicalBytesWritten += kv.expectedSize();
+			} else if (op == KVStoreWorkload::CLEAR) {
+				w->kvs->clear(singleKeyRange(w->keys.next()));
+			} else {
+				w->kvs->clear(w->keys.nextRange(w->rangeWidth));
+			}
+			if (++w->writesSinceCommit >= w->commitOps && w->commit.isReady()) {
+				w->writesSinceCommit = 0;
+				w->commit = kvstoreWorkloadCommit(w);
+			}
+		}
+		w->record(op, timer() - start);
+		wait(yield());
+	}
+	return Void();
+}
+} // anonymous namespace
+
+// Drives a KeyValueStoreRedwood on a real file with a configurable mix of operations, for comparing releases and knob
+// settings on real devices.  Outside of simulation, run it with
+//   fdbserver -r unittests -f :/redwood/performance/kvstore --test_file=/mnt/nvme/bench.redwood-v1 ...
+// keyGenerator is a RandomKeySetGenerator definition, whose index range skews toward its first key if it starts with
+// ^, and valueGenerator is a RandomStringGenerator definition.  Results are printed as JSON and, if jsonFile is given,
+// written to it.
+TEST_CASE(":/redwood/performance/kvstore") {
+	state std::string file = params.get("file").orDefault("unittest.redwood-v1");
+	state bool openExisting = params.getInt("openExisting").orDefault(0);
+	state bool populate = params.getInt("populate").orDefault(!openExisting);
+	state int64_t pageCacheBytes = params.getInt("pageCacheBytes").orDefault(FLOW_KNOBS->PAGE_CACHE_4K);
+	state std::string keyGenerator = params.get("keyGenerator").orDefault("1000000::16..32/a..z");
+	state std::string valueGenerator = params.get("valueGenerator").orDefault("100..500/a..z");
+	state int64_t operations = params.getInt("operations").orDefault(1e6);
+	state int concurrency = params.getInt("concurrency").orDefault(64);
+	state Optional<std::string> jsonFile = params.get("jsonFile");
+
+	if (!openExisting) {
+		deleteFile(file);
+	}
+
+	// Report metrics accumulated over the run rather than logging and clearing them periodically
+	g_redwoodMetricsActor = Void();
+
+	state IKeyValueStore* kvs = new KeyValueStoreRedwood(file,
+	                                                     UID(),
+	                                                     {}, // db
+	                                                     EncryptionAtRestMode::DISABLED,
+	                                                     XXHash64,
+	                                                     makeReference<NullEncryptionKeyProvider>(),
+	                                                     pageCacheBytes);
+	state std::unique_ptr<KVStoreWorkload> w =
+	    std::make_unique<KVStoreWorkload>(kvs, keyGenerator, valueGenerator);
+	w->weights[KVStoreWorkload::SET] = params.getDouble("setWeight").orDefault(10);
+	w->weights[KVStoreWorkload::CLEAR] = params.getDouble("clearWeight").orDefault(1);
+	w->weights[KVStoreWorkload::CLEAR_RANGE] = params.getDouble("clearRangeWeight").orDefault(0);
+	w->weights[KVStoreWorkload::READ] = params.getDouble("readWeight").orDefault(80);
+	w->weights[KVStoreWorkload::READ_RANGE] = params.getDouble("readRangeWeight").orDefault(10);
+	w->rangeWidth = params.getInt("rangeWidth").orDefault(20);
+	w->commitOps = params.getInt("commitOps").orDefault(10000);
+	printf("keyGenerator: %s\n", w->keys.toString().c_str());
+	printf("valueGenerator: %s\n", w->values.toString().c_str());
+	wait(kvs->init());
+
+	// Write every key once, outside of the measured run
+	state int i = 0;
+	if (populate) {
+		for (i = 0; i < w->keys.keys.size(); ++i) {
+			kvs->set(KeyValueRef(w->keys.keys[i], w->values.next()));
+			if ((i + 1) % w->commitOps == 0) {
+				wait(kvs->commit());
+			}
+		}
+		wait(kvs->commit());
+		printf("Populated %d keys\n", i);
+	}
+	g_redwoodMetrics.clear();
+
+	state double start = timer();
+	w->opsLeft = operations;
+	state std::vector<Future<Void>> clients;
+	for (i = 0; i < concurrency; ++i) {
+		clients.push_back(kvstoreWorkloadClient(w.get()));
+	}
+	wait(waitForAll(clients));
+	wait(w->commit);
+	wait(kvstoreWorkloadCommit(w.get()));
+	state double elapsed = timer() - start;
+
+	const auto& m = g_redwoodMetrics.metric;
+	int64_t diskWriteBytes = (int64_t)m.pagerDiskWrite * SERVER_KNOBS->REDWOOD_DEFAULT_PAGE_SIZE;
+	JsonBuilderObject result;
+	result["file"] = file;
+	result["key_generator"] = w->keys.toString();
+	result["value_generator"] = w->values.toString();
+	result["concurrency"] = concurrency;
+	result["operations"] = operations;
+	result["elapsed_seconds"] = elapsed;
+	result["operations_per_second"] = operations / elapsed;
+	JsonBuilderObject latency;
+	for (i = 0; i < KVStoreWorkload::OP_COUNT; ++i) {
+		latency[KVStoreWorkload::opNames[i]] = w->latencyStats((KVStoreWorkload::Op)i);
+	}
+	result["latency_seconds"] = latency;
+	result["logical_write_bytes"] = w->logicalBytesWritten;
+	result["disk_write_bytes"] = diskWriteBytes;
+	result["disk_read_bytes"] = (int64_t)m.pagerDiskRead * SERVER_KNOBS->REDWOOD_DEFAULT_PAGE_SIZE;
+	result["write_amplification"] =
+	    w->logicalBytesWritten > 0 ? (double)diskWriteBytes / w->logicalBytesWritten : 0.0;
+	result["cache_hit_rate"] = m.pagerCacheHit + m.pagerCacheMiss > 0
+	                               ? (double)m.pagerCacheHit / (m.pagerCacheHit + m.pagerCacheMiss)
+	                               : 0.0;
+	result["storage_bytes_used"] = kvs->getStorageBytes().used;
+
+	std::string json = result.getJson();
+	printf("%s\n", json.c_str());
+	if (jsonFile.present()) {
+		FILE* f = fopen(jsonFile.get().c_str(), "w");
+		ASSERT(f != nullptr);
+		fprintf(f, "%s\n", json.c_str());
+		fclose(f);
+	}
+
+	wait(closeKVS(kvs));
+	return Void();
+}
+
 namespace {
 void setAuthMode(EncodingType encodingType) {
 	auto& g_knobs = IKnobCollection::getMutableGlobalKnobCollection();
@@ -11576,6 +13035,237 @@ void setAuthMode(EncodingType encodingType) {
 }
 } // anonymous namespace
 
+TEST_CASE("/redwood/correctness/replaceRange") {
+	state IKeyValueStore* kvs = nullptr;
+	deleteFile("test.redwood-v1");
+	kvs = new KeyValueStoreRedwood("test.redwood-v1",
+	                               UID(),
+	                               {}, // db
+	                               EncryptionAtRestMode::DISABLED,
+	                               XXHash64,
+	                               makeReference<NullEncryptionKeyProvider>());
+	wait(kvs->init());
+
+	state int i = 0;
+	for (i = 0; i < 26; i++) {
+		kvs->set(KeyValueRef(StringRef(std::string(1, 'a' + i)), "old"_sr));
+	}
+	wait(kvs->commit());
+
+	// Replace [c, w) with more records than fit in one batch, whose block is released before the commit
+	{
+		Standalone<VectorRef<KeyValueRef>> block;
+		for (i = 0; i < 2500; i++) {
+			block.push_back_deep(block.arena(), KeyValueRef(StringRef(format("d%05d", i)), StringRef(format("%d", i))));
+		}
+		Future<Void> replaced = kvs->replaceRange(KeyRangeRef("c"_sr, "w"_sr), block);
+		wait(replaced);
+	}
+	wait(kvs->commit());
+
+	RangeResult result = wait(kvs->readRange(allKeys));
+	ASSERT_EQ(result.size(), 2 + 2500 + 4);
+	ASSERT(result[0].key == "a"_sr && result[1].key == "b"_sr && result[1].value == "old"_sr);
+	for (i = 0; i < 2500; i++) {
+		ASSERT(result[2 + i].key == StringRef(format("d%05d", i)));
+		ASSERT(result[2 + i].value == StringRef(format("%d", i)));
+	}
+	ASSERT(result[2502].key == "w"_sr && result[2502].value == "old"_sr);
+
+	wait(closeKVS(kvs, true /*dispose*/));
+	return Void();
+}
+
+TEST_CASE("/redwood/correctness/pinnedSnapshot") {
+	state IKeyValueStore* kvs = nullptr;
+	deleteFile("test.redwood-v1");
+	kvs = new KeyValueStoreRedwood("test.redwood-v1",
+	                               UID(),
+	                               {}, // db
+	                               EncryptionAtRestMode::DISABLED,
+	                               XXHash64,
+	                               makeReference<NullEncryptionKeyProvider>());
+	wait(kvs->init());
+
+	state int i = 0;
+	for (i = 0; i < 26; i++) {
+		kvs->set(KeyValueRef(StringRef(std::string(1, 'a' + i)), "0"_sr));
+	}
+	wait(kvs->commit());
+	state int64_t snapshot = kvs->pinSnapshot();
+	ASSERT(snapshot >= 0);
+
+	// Overwrite and clear what the snapshot has over enough commits for unpinned versions to be forgotten
+	state int round = 1;
+	for (; round <= 20; round++) {
+		for (i = 0; i < 26; i++) {
+			kvs->set(KeyValueRef(StringRef(std::string(1, 'a' + i)), StringRef(format("%d", round))));
+		}
+		kvs->clear(KeyRangeRef("m"_sr, "p"_sr));
+		wait(kvs->commit());
+	}
+
+	RangeResult atSnapshot = wait(kvs->readRangeAtSnapshot(snapshot, allKeys));
+	ASSERT_EQ(atSnapshot.size(), 26);
+	for (i = 0; i < 26; i++) {
+		ASSERT(atSnapshot[i].key == StringRef(std::string(1, 'a' + i)) && atSnapshot[i].value == "0"_sr);
+	}
+	RangeResult reversed = wait(kvs->readRangeAtSnapshot(snapshot, KeyRangeRef("l"_sr, "q"_sr), -2));
+	ASSERT(reversed.size() == 2 && reversed.more && reversed[0].key == "p"_sr && reversed[1].key == "o"_sr);
+	Optional<Value> cleared = wait(kvs->readValueAtSnapshot(snapshot, "n"_sr));
+	ASSERT(cleared.present() && cleared.get() == "0"_sr);
+
+	RangeResult latest = wait(kvs->readRange(allKeys));
+	ASSERT_EQ(latest.size(), 23);
+	ASSERT(latest[0].value == "20"_sr);
+	Optional<Value> latestCleared = wait(kvs->readValue("n"_sr));
+	ASSERT(!latestCleared.present());
+
+	kvs->unpinSnapshot(snapshot);
+	wait(kvs->commit());
+	RangeResult afterUnpin = wait(kvs->readRange(allKeys));
+	ASSERT_EQ(afterUnpin.size(), 23);
+
+	wait(closeKVS(kvs, true /*dispose*/));
+	return Void();
+}
+
+TEST_CASE("/redwood/correctness/readValuePrefixes") {
+	state IKeyValueStore* kvs = nullptr;
+	deleteFile("test.redwood-v1");
+	kvs = new KeyValueStoreRedwood("test.redwood-v1",
+	                               UID(),
+	                               {}, // db
+	                               EncryptionAtRestMode::DISABLED,
+	                               XXHash64,
+	                               makeReference<NullEncryptionKeyProvider>());
+	wait(kvs->init());
+
+	// Even numbered keys exist, with values long enough to span many leaves
+	state int i = 0;
+	for (i = 0; i < 20000; i += 2) {
+		kvs->set(KeyValueRef(StringRef(format("k%06d", i)), StringRef(format("%0100d", i))));
+	}
+	wait(kvs->commit());
+
+	// Unsorted keys, both present and absent, some repeated, and some past either end of the keyspace
+	state Standalone<VectorRef<KeyRef>> keyStorage;
+	state std::vector<std::pair<KeyRef, int>> keys;
+	state std::vector<int> numbers;
+	for (i = 0; i < 2000; i++) {
+		int n = deterministicRandom()->randomInt(-10, 20010);
+		keyStorage.push_back_deep(keyStorage.arena(), StringRef(n < 0 ? "a" : format("k%06d", n)));
+		numbers.push_back(n);
+	}
+	for (i = 0; i < keyStorage.size(); i++) {
+		keys.emplace_back(keyStorage[i], deterministicRandom()->randomInt(0, 120));
+	}
+
+	state std::vector<Optional<Value>> values = wait(kvs->readValuePrefixes(keys));
+	ASSERT_EQ(values.size(), keys.size());
+	for (i = 0; i < keys.size(); i++) {
+		int n = numbers[i];
+		if (n >= 0 && n < 20000 && n % 2 == 0) {
+			ASSERT(values[i].present());
+			ASSERT(values[i].get() == StringRef(format("%0100d", n)).substr(0, std::min(100, keys[i].second)));
+		} else {
+			ASSERT(!values[i].present());
+		}
+	}
+
+	wait(closeKVS(kvs, true /*dispose*/));
+	return Void();
+}
+
+TEST_CASE("/redwood/correctness/externalValues") {
+	state IKeyValueStore* kvs = nullptr;
+	deleteFile("test.redwood-v1");
+	IKnobCollection::getMutableGlobalKnobCollection().setKnob("redwood_value_external_threshold",
+	                                                          KnobValueRef::create(int{ 1000 }));
+	kvs = new KeyValueStoreRedwood("test.redwood-v1",
+	                               UID(),
+	                               {}, // db
+	                               EncryptionAtRestMode::DISABLED,
+	                               XXHash64,
+	                               makeReference<NullEncryptionKeyProvider>());
+	wait(kvs->init());
+
+	// Values of some keys are stored with their records and those of the others are external, and each commit
+	// replaces some of them with values of either kind and clears a range of them
+	state std::map<Key, Value> expected;
+	state std::map<Key, Value>::iterator e;
+	state int commit = 0;
+	state int i = 0;
+	state bool reverse = false;
+	state int rows = 0;
+	state Key begin;
+	state Key end;
+	for (commit = 0; commit < 5; commit++) {
+		for (i = 0; i < 300; i++) {
+			Key k = StringRef(format("k%04d", deterministicRandom()->randomInt(0, 1000)));
+			int size = deterministicRandom()->coinflip() ? deterministicRandom()->randomInt(0, 1000)
+			                                             : deterministicRandom()->randomInt(1000, 20000);
+			Value v = StringRef(std::string(size, 'a' + commit) + k.toString());
+			kvs->set(KeyValueRef(k, v));
+			expected[k] = v;
+		}
+		i = deterministicRandom()->randomInt(0, 1000);
+		KeyRange cleared(KeyRangeRef(StringRef(format("k%04d", i)), StringRef(format("k%04d", i + 50))));
+		kvs->clear(cleared);
+		expected.erase(expected.lower_bound(cleared.begin), expected.lower_bound(cleared.end));
+		wait(kvs->commit());
+
+		for (e = expected.begin(); e != expected.end(); ++e) {
+			Optional<Value> v = wait(kvs->readValue(e->first));
+			ASSERT(v.present() && v.get() == e->second);
+		}
+		Optional<Value> prefix = wait(kvs->readValuePrefix(expected.begin()->first, 10));
+		ASSERT(prefix.present() && prefix.get() == expected.begin()->second.substr(0, 10));
+
+		// Range reads in both directions, stopping at byte limits that fall in the middle of external values
+		for (i = 0; i < 2; i++) {
+			reverse = i == 1;
+			rows = 0;
+			begin = ""_sr;
+			end = "\xff"_sr;
+			loop {
+				RangeResult r = wait(kvs->readRange(KeyRangeRef(begin, end), reverse ? -1000 : 1000, 30000));
+				for (auto const& kv : r) {
+					auto x = expected.find(kv.key);
+					ASSERT(x != expected.end() && kv.value == x->second);
+				}
+				rows += r.size();
+				if (!r.more) {
+					break;
+				}
+				if (reverse) {
+					end = r.back().key;
+				} else {
+					begin = keyAfter(r.back().key);
+				}
+			}
+			ASSERT_EQ(rows, expected.size());
+		}
+
+		// Reading only the keys counts them alone towards the byte limit
+		{
+			RangeResult r = wait(kvs->readKeys(KeyRangeRef(""_sr, "\xff"_sr), 1 << 30, 30000));
+			ASSERT(!r.more);
+			ASSERT_EQ(r.size(), expected.size());
+			e = expected.begin();
+			for (auto const& kv : r) {
+				ASSERT(kv.key == e->first && kv.value.empty());
+				++e;
+			}
+		}
+	}
+
+	wait(closeKVS(kvs, true /*dispose*/));
+	IKnobCollection::getMutableGlobalKnobCollection().setKnob("redwood_value_external_threshold",
+	                                                          KnobValueRef::create(int{ 0 }));
+	return Void();
+}
+
 TEST_CASE("/redwood/correctness/EnforceEncodingType") {
 	state const std::vector<std::pair<EncodingType, EncodingType>> testCases = {
 		{ XXHash64, XOREncryption_TestOnly }, { AESEncryption, AESEncryptionWithAuth }
@@ -75,6 +75,7 @@
 #include "flow/ArgParseUtil.h"
 #include "flow/DeterministicRandom.h"
 #include "flow/Platform.h"
+#include "flow/Profiler.h"
 #include "flow/ProtocolVersion.h"
 #include "SimpleOpt/SimpleOpt.h"
 #include "flow/SystemMonitor.h"
@@ -134,7 +135,7 @@ enum {
 	OPT_METRICSPREFIX, OPT_LOGGROUP, OPT_LOCALITY, OPT_IO_TRUST_SECONDS, OPT_IO_TRUST_WARN_ONLY, OPT_FILESYSTEM, OPT_PROFILER_RSS_SIZE, OPT_KVFILE,
 	OPT_TRACE_FORMAT, OPT_WHITELIST_BINPATH, OPT_BLOB_CREDENTIAL_FILE, OPT_CONFIG_PATH, OPT_USE_TEST_CONFIG_DB, OPT_NO_CONFIG_DB, OPT_FAULT_INJECTION, OPT_PROFILER, OPT_PRINT_SIMTIME,
 	OPT_FLOW_PROCESS_NAME, OPT_FLOW_PROCESS_ENDPOINT, OPT_IP_TRUSTED_MASK, OPT_KMS_CONN_DISCOVERY_URL_FILE, OPT_KMS_CONNECTOR_TYPE, OPT_KMS_REST_ALLOW_NOT_SECURE_CONECTION, OPT_KMS_CONN_VALIDATION_TOKEN_DETAILS,
-	OPT_KMS_CONN_GET_ENCRYPTION_KEYS_ENDPOINT, OPT_KMS_CONN_GET_LATEST_ENCRYPTION_KEYS_ENDPOINT, OPT_KMS_CONN_GET_BLOB_METADATA_ENDPOINT, OPT_NEW_CLUSTER_KEY, OPT_AUTHZ_PUBLIC_KEY_FILE, OPT_USE_FUTURE_PROTOCOL_VERSION
+	OPT_KMS_CONN_GET_ENCRYPTION_KEYS_ENDPOINT, OPT_KMS_CONN_GET_LATEST_ENCRYPTION_KEYS_ENDPOINT, OPT_KMS_CONN_GET_BLOB_METADATA_ENDPOINT, OPT_NEW_CLUSTER_KEY, OPT_AUTHZ_PUBLIC_KEY_FILE, OPT_USE_FUTURE_PROTOCOL_VERSION, OPT_NUMA_NODE
 };
 
 CSimpleOpt::SOption g_rgOptions[] = {
@@ -184,6 +185,7 @@ CSimpleOpt::SOption g_rgOptions[] = {
 	{ OPT_STORAGEMEMLIMIT,       "-M",                          SO_REQ_SEP },
 	{ OPT_STORAGEMEMLIMIT,       "--storage-memory",            SO_REQ_SEP },
 	{ OPT_CACHEMEMLIMIT,         "--cache-memory",              SO_REQ_SEP },
+	{ OPT_NUMA_NODE,             "--numa-node",                 SO_REQ_SEP },
 	{ OPT_MACHINEID,             "-i",                          SO_REQ_SEP },
 	{ OPT_MACHINEID,             "--machine-id",                SO_REQ_SEP },
 	{ OPT_DCID,                  "-a",                          SO_REQ_SEP },
@@ -691,6 +693,10 @@ static void printUsage(const char* name, bool devhelp) {
 	                 " The amount of memory to use for caching disk pages."
 	                 " The default value is 2GiB. When specified without a unit,"
 	                 " MiB is assumed.");
+	printOptionUsage("--numa-node NODE",
+	                 " Run the process on the CPUs of the given NUMA node and prefer"
+	                 " memory from it. Used to keep each of several log processes on"
+	                 " a multi-socket host on one node. Linux only.");
 	printOptionUsage("-c CLASS, --class CLASS",
 	                 " Machine class (valid options are storage, transaction,"
 	                 " resolution, grv_proxy, commit_proxy, master, test, unset, stateless, log, router,"
@@ -1083,6 +1089,7 @@ struct CLIOptions {
 	               // SERVER_KNOBS->COMMIT_BATCHES_MEM_BYTES_HARD_LIMIT
 	uint64_t virtualMemLimit = 0; // unlimited
 	uint64_t storageMemLimit = 1LL << 30;
+	int numaNode = -1;
 	bool buggifyEnabled = false, faultInjectionEnabled = true, restarting = false;
 	Optional<Standalone<StringRef>> zoneId;
 	Optional<Standalone<StringRef>> dcId;
@@ -1494,6 +1501,8 @@ private:
 					openTracer(TracerType::LOG_FILE);
 				} else if (tracer == "network_lossy") {
 					openTracer(TracerType::NETWORK_LOSSY);
+				} else if (tracer == "network_batched") {
+					openTracer(TracerType::NETWORK_BATCHED);
 				} else {
 					fprintf(stderr, "ERROR: Unknown or unsupported tracer: `%s'", args.OptionArg());
 					printHelpTeaser(argv[0]);
@@ -1567,6 +1576,13 @@ private:
 				}
 				storageMemLimit = ti.get();
 				break;
+			case OPT_NUMA_NODE:
+				if (sscanf(args.OptionArg(), "%d", &numaNode) != 1 || numaNode < 0) {
+					fprintf(stderr, "ERROR: Could not parse NUMA node from `%s'\n", args.OptionArg());
+					printHelpTeaser(argv[0]);
+					flushAndExit(FDB_EXIT_ERROR);
+				}
+				break;
 			case OPT_CACHEMEMLIMIT:
 				ti = parse_with_suffix(args.OptionArg(), "MiB");
 				if (!ti.present()) {
@@ -2043,6 +2059,12 @@ int main(int argc, char* argv[]) {
 			flushAndExit(FDB_EXIT_SUCCESS);
 		}
 
+		// Threads and memory inherit the NUMA placement, so bind before starting any of them
+		if (opts.numaNode >= 0 && role != ServerRole::Simulation && !bindToNumaNode(opts.numaNode)) {
+			fprintf(stderr, "ERROR: Could not bind to NUMA node %d\n", opts.numaNode);
+			flushAndExit(FDB_EXIT_ERROR);
+		}
+
 		// Initialize the thread pool
 		CoroThreadPool::init();
 		// Ordinarily, this is done when the network is run. However, network thread should be set before TraceEvents
@@ -2195,6 +2217,7 @@ int main(int argc, char* argv[]) {
 		    .detail("BuggifyEnabled", opts.buggifyEnabled)
 		    .detail("FaultInjectionEnabled", opts.faultInjectionEnabled)
 		    .detail("MemoryLimit", opts.memLimit)
+		    .detail("NumaNode", opts.numaNode)
 		    .detail("VirtualMemoryLimit", opts.virtualMemLimit)
 		    .detail("ProtocolVersion", currentProtocolVersion())
 		    .trackLatest("ProgramStart");
@@ -2392,6 +2415,7 @@ int main(int argc, char* argv[]) {
 				                      opts.manualKnobOverrides,
 				                      opts.configDBType));
 				actors.push_back(histogramReport());
+				actors.push_back(cpuSampler(g_network));
 				// actors.push_back( recurring( []{}, .001 ) );  // for ASIO latency measurement
 
 				f = stopAfter(waitForAll(actors));
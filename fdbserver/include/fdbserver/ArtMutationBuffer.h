@@ -112,6 +112,9 @@ public:
 		return T(arena, object);
 	}
 
+	// Keeps other alive for as long as the buffer, so that mutations can refer to memory it owns
+	void dependsOn(Arena const& other) { arena.dependsOn(other); }
+
 	const_iterator upper_bound(const KeyRef& k) const { return const_iterator(mutations->upper_bound(k)); }
 
 	const_iterator lower_bound(const KeyRef& k) const { return const_iterator(mutations->lower_bound(k)); }
@@ -43,9 +43,17 @@ struct GranuleStartState {
 
 // TODO: add more (blob file request cost, in-memory mutations vs blob delta file, etc...)
 struct GranuleReadStats {
+	// delta bytes that reads since the last snapshot had to merge with the snapshot
 	int64_t deltaBytesRead;
-
-	void reset() { deltaBytesRead = 0; }
+	int64_t reads;
+	// when the first of those reads happened
+	double firstReadTime;
+
+	void reset() {
+		deltaBytesRead = 0;
+		reads = 0;
+		firstReadTime = 0;
+	}
 
 	GranuleReadStats() { reset(); }
 };
@@ -95,8 +103,15 @@ struct GranuleMetadata : NonCopyable, ReferenceCounted<GranuleMetadata> {
 	void resume();
 	void resetReadStats();
 
-	// determine eligibility (>1) and priority for re-snapshotting this granule
-	double weightRDC();
+	// determine eligibility (>1) for re-snapshotting this granule
+	double weightRDC() const;
+
+	// bytes that re-snapshotting this granule now would write
+	int64_t writeCostRDC() const;
+
+	// delta bytes that re-snapshotting this granule now would spare readers from merging over the next
+	// BG_RDC_SAVINGS_HORIZON seconds, if reads continue at the rate they have since the last snapshot
+	double projectedSavingsRDC() const;
 
 	bool isEligibleRDC() const;
 
@@ -115,6 +115,14 @@ struct RecruitWorkersInfo : ReferenceCounted<RecruitWorkersInfo> {
 	RecruitWorkersInfo(RecruitFromConfigurationRequest const& req) : req(req) {}
 };
 
+// The transaction system workers the cluster controller recruited for the next recovery while the database was fully
+// recovered, see CC_STANDBY_RECRUITMENT
+struct StandbyRecruitment {
+	RecruitFromConfigurationRequest req;
+	RecruitFromConfigurationReply rep;
+	double time = 0;
+};
+
 struct RecruitRemoteWorkersInfo : ReferenceCounted<RecruitRemoteWorkersInfo> {
 	RecruitRemoteFromConfigurationRequest req;
 	RecruitRemoteFromConfigurationReply rep;
@@ -3302,6 +3310,69 @@ public:
 		return recentHealthTriggeredRecoveryTime.size();
 	}
 
+	// Returns whether rep, recruited earlier for planned, can be used by a recovery recruiting for req: the requests
+	// are the same, and the workers are all still registered with the same interfaces, available and not colocated
+	// with the new master. Sets reason otherwise.
+	bool canUseEarlierRecruitment(RecruitFromConfigurationRequest const& planned,
+	                              RecruitFromConfigurationReply const& rep,
+	                              RecruitFromConfigurationRequest const& req,
+	                              std::string& reason) const {
+		if (planned.configuration != req.configuration || planned.recruitSeedServers != req.recruitSeedServers ||
+		    planned.maxOldLogRouters != req.maxOldLogRouters) {
+			reason = "RequestChanged";
+			return false;
+		}
+		for (const auto* workers : { &rep.tLogs,
+		                             &rep.satelliteTLogs,
+		                             &rep.commitProxies,
+		                             &rep.grvProxies,
+		                             &rep.resolvers,
+		                             &rep.storageServers,
+		                             &rep.oldLogRouters,
+		                             &rep.backupWorkers }) {
+			for (const auto& worker : *workers) {
+				auto it = id_worker.find(worker.locality.processId());
+				if (it == id_worker.end() || it->second.details.interf.id() != worker.id() ||
+				    !workerAvailable(it->second, false) || isExcludedDegradedServer(worker.addresses())) {
+					reason = "WorkerUnavailable";
+					return false;
+				}
+				if (worker.locality.processId() == masterProcessId) {
+					reason = "MasterColocated";
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	// Returns the workers of the standby recruitment if a recovery recruiting for req can use them, see
+	// canUseEarlierRecruitment(). The standby recruitment is discarded either way, since its workers are then in use or
+	// it is no longer valid.
+	Optional<RecruitFromConfigurationReply> takeStandbyRecruitment(RecruitFromConfigurationRequest const& req) {
+		if (!standbyRecruitment.present()) {
+			return Optional<RecruitFromConfigurationReply>();
+		}
+		StandbyRecruitment standby = std::move(standbyRecruitment.get());
+		standbyRecruitment.reset();
+
+		std::string reason;
+		if (now() - standby.time > 2 * SERVER_KNOBS->CC_STANDBY_RECRUITMENT_INTERVAL) {
+			reason = "Stale";
+		} else {
+			canUseEarlierRecruitment(standby.req, standby.rep, req, reason);
+		}
+
+		TraceEvent("StandbyRecruitment", id)
+		    .detail("Used", reason.empty())
+		    .detail("Reason", reason)
+		    .detail("Age", now() - standby.time);
+		if (!reason.empty()) {
+			return Optional<RecruitFromConfigurationReply>();
+		}
+		return standby.rep;
+	}
+
 	bool isExcludedDegradedServer(const NetworkAddressList& a) const {
 		for (const auto& server : excludedDegradedServers) {
 			if (a.contains(server))
@@ -3331,6 +3402,7 @@ public:
 	std::vector<Reference<RecruitRemoteWorkersInfo>> outstandingRemoteRecruitmentRequests;
 	std::vector<std::pair<RecruitStorageRequest, double>> outstandingStorageRequests;
 	std::vector<std::pair<RecruitBlobWorkerRequest, double>> outstandingBlobWorkerRequests;
+	Optional<StandbyRecruitment> standbyRecruitment;
 	ActorCollection ac;
 	UpdateWorkerList updateWorkerList;
 	Future<Void> outstandingRequestChecker;
@@ -3405,6 +3477,7 @@ public:
 	Counter getClientWorkersRequests;
 	Counter registerMasterRequests;
 	Counter statusRequests;
+	Counter statusCacheHits;
 
 	Reference<EventCacheHolder> recruitedMasterWorkerEventHolder;
 
@@ -3427,6 +3500,7 @@ public:
 	    getClientWorkersRequests("GetClientWorkersRequests", clusterControllerMetrics),
 	    registerMasterRequests("RegisterMasterRequests", clusterControllerMetrics),
 	    statusRequests("StatusRequests", clusterControllerMetrics),
+	    statusCacheHits("StatusCacheHits", clusterControllerMetrics),
 	    recruitedMasterWorkerEventHolder(makeReference<EventCacheHolder>("RecruitedMasterWorker")) {
 		auto serverInfo = ServerDBInfo();
 		serverInfo.id = deterministicRandom()->randomUniqueID();
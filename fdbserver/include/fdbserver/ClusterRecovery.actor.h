@@ -208,6 +208,11 @@ struct ClusterRecoveryData : NonCopyable, ReferenceCounted<ClusterRecoveryData>
 
 	RecruitFromConfigurationReply primaryRecruitment;
 
+	// The recruitment started when recovery begins, see RECOVERY_EARLY_RECRUITMENT
+	Reference<RecruitWorkersInfo> earlyRecruitment;
+	Future<Void> earlyRecruitmentDone;
+	double earlyRecruitmentStartTime = 0;
+
 	int8_t getNextLocality() {
 		int8_t maxLocality = -1;
 		for (auto it : dcId_locality) {
@@ -29,7 +29,11 @@
 #include "fdbserver/ResolverBug.h"
 
 struct ConflictSet;
+// Creates the implementation selected by RESOLVER_USE_ART_CONFLICT_SET, configured from the resolver knobs
 ConflictSet* newConflictSet();
+// Creates an ART backed conflict set if useART, otherwise a SkipList backed one. Does not read any knobs, so it can
+// be used outside of a server process (e.g. by flowbench).
+ConflictSet* newConflictSet(bool useART, int checkThreads = 0, int parallelCheckMinRanges = 0);
 void clearConflictSet(ConflictSet*, Version);
 void destroyConflictSet(ConflictSet*);
 
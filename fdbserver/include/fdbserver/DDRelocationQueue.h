@@ -94,8 +94,11 @@ struct RelocateDecision {
 // DDQueue uses Busyness to throttle too many movement to/from a same server
 struct Busyness {
 	std::vector<int> ledger;
+	// The work the server may have in flight. Adaptive relocation parallelism raises it above WORK_FULL_UTILIZATION for
+	// servers that keep up with their moves.
+	int capacity;
 
-	Busyness() : ledger(10, 0) {}
+	Busyness();
 	bool canLaunch(int prio, int work) const;
 	void addWork(int prio, int work);
 	void removeWork(int prio, int work);
@@ -116,6 +119,8 @@ struct DDQueueInitParams {
 	FutureStream<RelocateShard> const& relocationConsumer;
 	PromiseStream<GetMetricsRequest> const& getShardMetrics;
 	PromiseStream<GetTopKMetricsRequest> const& getTopKMetrics;
+	// Whether every storage server is configured to use sharded RocksDB, so that shards can be moved physically
+	bool shardedRocksDBOnly;
 };
 
 // DDQueue receives RelocateShard from any other DD components and schedules the actual movements
@@ -311,11 +316,29 @@ public:
 		NoAnyHealthy,
 		DstOverloaded,
 		RetryLimitReached,
+		BulkLoadSourceInTeam,
 		NumberOfTypes,
 	};
 	std::vector<int> retryFindDstReasonCount;
 
 	MovingWindow<int64_t> moveBytesRate;
+	// Bytes of shards relocated, for projecting when the queued and in-flight relocations complete
+	MovingWindow<int64_t> relocatedBytesRate;
+
+	// The bytes and seconds of the relocations each server was a source or destination of, since adaptive relocation
+	// parallelism last adjusted the servers' Busyness capacity
+	struct MoveThroughput {
+		int64_t bytes = 0;
+		double seconds = 0;
+	};
+	std::map<UID, MoveThroughput> srcMoveThroughput;
+	std::map<UID, MoveThroughput> destMoveThroughput;
+	// The bytes and seconds of the completed physical and logical relocations, to compare the two
+	MoveThroughput physicalMoveThroughput;
+	MoveThroughput logicalMoveThroughput;
+
+	// If true, relocations move physical shards by transferring checkpoints, when the storage servers support it
+	bool preferPhysicalShardMove = false;
 
 	DDQueue() = default;
 
@@ -356,6 +379,13 @@ public:
 
 	Future<Void> periodicalRefreshCounter();
 
+	// Records a completed relocation of bytes that took seconds, for adaptive relocation parallelism
+	void recordMoveThroughput(const std::vector<UID>& src, const std::vector<UID>& dest, int64_t bytes, double seconds);
+
+	// Adjusts the Busyness capacity of the servers that relocations recently moved data from or to, and returns the
+	// servers whose capacity was raised
+	std::set<UID> adaptRelocationParallelism(const HealthMetrics& metrics);
+
 	int getUnhealthyRelocationCount() const override;
 
 	Future<SrcDestTeamPair> getSrcDestTeams(const int& teamCollectionIndex,
@@ -21,6 +21,8 @@
 #define FOUNDATIONDB_DDSHARDTRACKER_H
 #include "fdbserver/DataDistribution.actor.h"
 
+#include <deque>
+
 // send request/signal to DDTracker through interface
 // call synchronous method from components outside DDShardTracker
 class IDDShardTracker {
@@ -31,11 +33,46 @@ public:
 	FutureStream<GetMetricsListRequest> getShardMetricsList;
 	FutureStream<Promise<int64_t>> averageShardBytes;
 	FutureStream<RebalanceStorageQueueRequest> triggerStorageQueueRebalance;
+	FutureStream<BulkLoadShardRequest> bulkLoadShards;
 
 	virtual double getAverageShardBytes() = 0;
 	virtual ~IDDShardTracker() = default;
 };
 
+// The recent history of where in the keyspace the bytes and the traffic sampled by the storage servers are. Each slice
+// groups the shards, in order, into buckets of about equal bytes, so that hot ranges stand out however the data is
+// spread. The data distributor owns it, so it outlives restarts of the tracker that fills it.
+class ShardHeatmap {
+public:
+	// Builds a slice from the shards, which must be given in order from the beginning of the keyspace
+	class SliceBuilder {
+	public:
+		SliceBuilder(double time, int64_t totalBytes, int maxBuckets);
+		void addShard(KeyRef begin, StorageMetrics const& metrics);
+		Standalone<VectorRef<HeatmapBucketRef>> finish();
+
+	private:
+		double time;
+		int64_t bucketBytes; // once a bucket has this many, the next shard starts a new one
+		Standalone<VectorRef<HeatmapBucketRef>> buckets;
+		bool bucketFull = true;
+	};
+
+	explicit ShardHeatmap(int maxSlices) : maxSlices(maxSlices) {}
+
+	// Drops the oldest slice once there are maxSlices
+	void addSlice(Standalone<VectorRef<HeatmapBucketRef>> slice);
+
+	// The buckets intersecting keys of the slices taken at or after since, oldest first
+	Standalone<VectorRef<HeatmapBucketRef>> get(KeyRangeRef keys, double since) const;
+
+	int slices() const { return history.size(); }
+
+private:
+	int maxSlices;
+	std::deque<Standalone<VectorRef<HeatmapBucketRef>>> history;
+};
+
 struct DataDistributionTrackerInitParams {
 	Reference<IDDTxnProcessor> db;
 	UID const& distributorId;
@@ -47,6 +84,7 @@ struct DataDistributionTrackerInitParams {
 	KeyRangeMap<ShardTrackedData>* shards = nullptr;
 	bool* trackerCancelled = nullptr;
 	Optional<Reference<TenantCache>> ddTenantCache;
+	ShardHeatmap* heatmap = nullptr;
 };
 
 // track the status of shards
@@ -78,6 +116,10 @@ public:
 
 	// Read hot detection
 	PromiseStream<KeyRange> readHotShard;
+	// When each range was last considered for a split because it was read hot
+	KeyRangeMap<double> readHotSplitTimes;
+	// When the shards of each piece of a bulk load were last asked to be moved
+	KeyRangeMap<double> bulkLoadTimes;
 
 	// The reference to trackerCancelled must be extracted by actors,
 	// because by the time (trackerCancelled == true) this memory cannot
@@ -109,6 +151,9 @@ public:
 
 	Optional<Reference<TenantCache>> ddTenantCache;
 
+	// Filled every DD_HEATMAP_INTERVAL, if not null
+	ShardHeatmap* heatmap = nullptr;
+
 	Reference<DDConfiguration::RangeConfigMapSnapshot> userRangeConfig;
 
 	DataDistributionTracker() = default;
@@ -123,7 +168,8 @@ public:
 	                        FutureStream<GetTopKMetricsRequest> const& getTopKMetrics,
 	                        FutureStream<GetMetricsListRequest> const& getShardMetricsList,
 	                        FutureStream<Promise<int64_t>> const& getAverageShardBytes,
-	                        FutureStream<RebalanceStorageQueueRequest> const& triggerStorageQueueRebalance);
+	                        FutureStream<RebalanceStorageQueueRequest> const& triggerStorageQueueRebalance,
+	                        FutureStream<BulkLoadShardRequest> const& bulkLoadShards);
 
 	explicit DataDistributionTracker(DataDistributionTrackerInitParams const& params);
 };
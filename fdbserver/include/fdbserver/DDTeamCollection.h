@@ -20,8 +20,10 @@
 
 #pragma once
 
+#include <map>
 #include <set>
 #include <sstream>
+#include <unordered_map>
 #include "fdbclient/FDBOptions.g.h"
 #include "fdbclient/FDBTypes.h"
 #include "fdbclient/KeyBackedTypes.actor.h"
@@ -202,6 +204,55 @@ struct DDTeamCollectionInitParams {
 	PromiseStream<RebalanceStorageQueueRequest> triggerStorageQueueRebalance;
 };
 
+// Candidates for new teams (servers or machines), indexed by the number of teams each one is on, so that team building
+// can find the least used candidates without scanning all of them for every team it adds. It is built at the start of a
+// build pass, when the health and locality of the candidates are known, and a candidate's count is updated whenever a
+// team it is on is added.
+template <class T>
+class TeamCountIndex {
+public:
+	void add(Reference<T> const& candidate, int teamCount) {
+		auto& bucket = byTeamCount[teamCount];
+		positions[candidate.getPtr()] = Position{ teamCount, static_cast<int>(bucket.size()) };
+		bucket.push_back(candidate);
+	}
+
+	// Does nothing for a server or machine that isn't a candidate
+	void update(Reference<T> const& candidate, int teamCount) {
+		auto it = positions.find(candidate.getPtr());
+		if (it == positions.end() || it->second.teamCount == teamCount) {
+			return;
+		}
+		// candidate may refer to an entry of the bucket it is removed from
+		Reference<T> updated = candidate;
+		auto bucket = byTeamCount.find(it->second.teamCount);
+		Reference<T>& moved = bucket->second.back();
+		positions[moved.getPtr()].index = it->second.index;
+		std::swap(bucket->second[it->second.index], moved);
+		bucket->second.pop_back();
+		if (bucket->second.empty()) {
+			byTeamCount.erase(bucket);
+		}
+		positions.erase(it);
+		add(updated, teamCount);
+	}
+
+	bool empty() const { return positions.empty(); }
+	int size() const { return positions.size(); }
+
+	// The candidates on the fewest teams. The index must not be empty.
+	int minTeamCount() const { return byTeamCount.begin()->first; }
+	std::vector<Reference<T>> const& leastUsed() const { return byTeamCount.begin()->second; }
+
+private:
+	struct Position {
+		int teamCount;
+		int index;
+	};
+	std::map<int, std::vector<Reference<T>>> byTeamCount;
+	std::unordered_map<T*, Position> positions;
+};
+
 class DDTeamCollection : public ReferenceCounted<DDTeamCollection> {
 	friend class DDTeamCollectionImpl;
 	friend class DDTeamCollectionUnitTest;
@@ -386,8 +437,8 @@ protected:
 
 	bool isMachineHealthy(Reference<TCMachineInfo> const& machine) const;
 
-	// Return the healthy server with the least number of correct-size server teams
-	Reference<TCServerInfo> findOneLeastUsedServer() const;
+	// Return one of the candidates with the least number of correct-size server teams
+	Reference<TCServerInfo> findOneLeastUsedServer(TeamCountIndex<TCServerInfo> const& candidates) const;
 
 	// A server team should always come from servers on a machine team
 	// Check if it is true
@@ -418,10 +469,16 @@ protected:
 	// Each machine is expected to have targetMachineTeamNumPerMachine
 	// Return true if there exists a machine that does not have enough teams.
 	bool notEnoughMachineTeamsForAMachine() const;
+	// Same, given all healthy machines indexed by their number of machine teams
+	bool notEnoughMachineTeamsForAMachine(TeamCountIndex<TCMachineInfo> const& healthyMachines) const;
+	int targetMachineTeamNumPerMachine() const;
 
 	// Each server is expected to have targetTeamNumPerServer teams.
 	// Return true if there exists a server that does not have enough teams.
 	bool notEnoughTeamsForAServer() const;
+	// Same, given all healthy servers indexed by their number of teams
+	bool notEnoughTeamsForAServer(TeamCountIndex<TCServerInfo> const& healthyServers) const;
+	int targetTeamNumPerServer() const;
 
 	// Use the current set of known processes (from server_info) to compute an optimized set of storage server teams.
 	// The following are guarantees of the process:
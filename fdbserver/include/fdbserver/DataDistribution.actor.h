@@ -59,6 +59,7 @@ public:
 		SIZE_SPLIT,
 		WRITE_SPLIT,
 		TENANT_SPLIT,
+		READ_SPLIT,
 		__COUNT
 	};
 	RelocateReason(Value v) : value(v) { ASSERT(value != __COUNT); }
@@ -81,6 +82,8 @@ public:
 			return "WriteSplit";
 		case TENANT_SPLIT:
 			return "TenantSplit";
+		case READ_SPLIT:
+			return "ReadSplit";
 		case __COUNT:
 			ASSERT(false);
 		}
@@ -461,6 +464,15 @@ struct RebalanceStorageQueueRequest {
 	  : serverId(serverId), teams(teams), primary(primary) {}
 };
 
+// Asks the tracker to move the shards of a piece of a bulk load, which it keeps from merging for a while
+struct BulkLoadShardRequest {
+	KeyRange keys;
+	bool relocate; // whether to move the shards of keys, or only keep them from merging
+
+	BulkLoadShardRequest() : relocate(false) {}
+	BulkLoadShardRequest(KeyRange keys, bool relocate) : keys(keys), relocate(relocate) {}
+};
+
 // DDShardInfo is so named to avoid link-time name collision with ShardInfo within the StorageServer
 struct DDShardInfo {
 	Key key;
@@ -43,6 +43,7 @@ struct DataDistributorInterface {
 	RequestStream<struct TriggerAuditRequest> triggerAudit;
 	RequestStream<struct TenantsOverStorageQuotaRequest> tenantsOverStorageQuota;
 	RequestStream<struct PrepareBlobRestoreRequest> prepareBlobRestoreReq;
+	RequestStream<struct GetDataDistributorHeatmapRequest> dataDistributorHeatmap;
 
 	DataDistributorInterface() = default;
 	explicit DataDistributorInterface(const struct LocalityData& l, UID id) : locality(l), myId(id) {}
@@ -67,7 +68,8 @@ struct DataDistributorInterface {
 		           storageWigglerState,
 		           triggerAudit,
 		           tenantsOverStorageQuota,
-		           prepareBlobRestoreReq);
+		           prepareBlobRestoreReq,
+		           dataDistributorHeatmap);
 	}
 };
 
@@ -162,6 +164,34 @@ struct GetDataDistributorMetricsRequest {
 	}
 };
 
+struct GetDataDistributorHeatmapReply {
+	constexpr static FileIdentifier file_identifier = 4208291;
+	Standalone<VectorRef<HeatmapBucketRef>> buckets;
+
+	GetDataDistributorHeatmapReply() = default;
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, buckets);
+	}
+};
+
+// Asks for the buckets of the hot-range heatmap intersecting keys, of the slices taken at or after since
+struct GetDataDistributorHeatmapRequest {
+	constexpr static FileIdentifier file_identifier = 4208292;
+	KeyRange keys;
+	double since = 0;
+	ReplyPromise<struct GetDataDistributorHeatmapReply> reply;
+
+	GetDataDistributorHeatmapRequest() = default;
+	GetDataDistributorHeatmapRequest(KeyRange const& keys, double since) : keys(keys), since(since) {}
+
+	template <class Ar>
+	void serialize(Ar& ar) {
+		serializer(ar, keys, since, reply);
+	}
+};
+
 struct DistributorSnapRequest {
 	constexpr static FileIdentifier file_identifier = 5427684;
 	Arena arena;
@@ -25,6 +25,7 @@
 #include "fdbclient/FDBTypes.h"
 #include "fdbserver/Knobs.h"
 #include <string.h>
+#include <type_traits>
 
 #define DELTATREE_DEBUG 0
 
@@ -914,6 +915,15 @@ private:
 //    // For debugging, return a useful human-readable string representation of *this
 //    std::string toString() const;
 //
+//    Optionally, T can implement the following so that seeks compare *this to nodes' deltas without decoding them:
+//
+//    // Compare the keys of *this and rhs, setting common to the length of their common key prefix
+//    int compareKey(const T& rhs, int& common) const;
+//
+//    // Compare *this to the T which delta creates from a base, given the common key prefix length and the key
+//    // comparison of *this and the base, which are updated to those of *this and the created T
+//    int compareToDelta(const DeltaT& delta, int& common, int& keyCmp) const;
+//
 // DeltaT requirements
 //
 //    DeltaT can be variable sized, larger than sizeof(DeltaT), and implement the following:
@@ -939,6 +949,16 @@ private:
 //    // For debugging, return a useful human-readable string representation of *this
 //    std::string toString() const;
 //
+template <typename T, typename DeltaT, typename = void>
+struct CanCompareToDelta : std::false_type {};
+
+template <typename T, typename DeltaT>
+struct CanCompareToDelta<T,
+                         DeltaT,
+                         std::void_t<decltype(std::declval<const T&>().compareToDelta(
+                             std::declval<const DeltaT&>(), std::declval<int&>(), std::declval<int&>()))>>
+  : std::true_type {};
+
 #pragma pack(push, 1)
 template <typename T, typename DeltaT = typename T::Delta>
 struct DeltaTree2 {
@@ -1351,6 +1371,10 @@ public:
 		// Otherwise, returns the result of s.compare(item at cursor position)
 		// Does not skip/avoid deleted nodes.
 		int seek(const T& s, int skipLen = 0) {
+			if constexpr (CanCompareToDelta<T, DeltaT>::value) {
+				return seekDeltas(s);
+			}
+
 			nodeIndex = -1;
 			item.reset();
 			deltatree_printf("seek(%s) start %s\n", s.toString().c_str(), toString().c_str());
@@ -1376,6 +1400,59 @@ public:
 			return cmp;
 		}
 
+		// seek() for a T which can compare itself to deltas, so nodes visited are not decoded.  A node's delta is
+		// based on its nearest lesser or greater ancestor, which are the last nodes the seek went right or left from,
+		// so only the common key prefix length and key comparison of s with those two nodes need to be tracked.
+		// When a base is one of the tree's bounds, they are computed from the bound the first time they are needed.
+		int seekDeltas(const T& s) {
+			nodeIndex = -1;
+			item.reset();
+			int nIndex = rootIndex();
+			int cmp = 0;
+			int lesserCommon = -1;
+			int lesserCmp = 0;
+			int greaterCommon = -1;
+			int greaterCmp = 0;
+
+			while (nIndex != -1) {
+				nodeIndex = nIndex;
+				const DeltaT& delta = cache->get(nIndex).node(tree)->delta(tree->largeNodes);
+				int common;
+				int keyCmp;
+				if (delta.getPrefixSource()) {
+					if (lesserCommon < 0) {
+						lesserCmp = s.compareKey(cache->lowerBound, lesserCommon);
+					}
+					common = lesserCommon;
+					keyCmp = lesserCmp;
+				} else {
+					if (greaterCommon < 0) {
+						greaterCmp = s.compareKey(cache->upperBound, greaterCommon);
+					}
+					common = greaterCommon;
+					keyCmp = greaterCmp;
+				}
+
+				cmp = s.compareToDelta(delta, common, keyCmp);
+				deltatree_printf("seekDeltas(%s) loop cmp=%d %s\n", s.toString().c_str(), cmp, toString().c_str());
+				if (cmp == 0) {
+					break;
+				}
+
+				if (cmp > 0) {
+					lesserCommon = common;
+					lesserCmp = keyCmp;
+					nIndex = getRightChildIndex(nIndex);
+				} else {
+					greaterCommon = common;
+					greaterCmp = keyCmp;
+					nIndex = getLeftChildIndex(nIndex);
+				}
+			}
+
+			return cmp;
+		}
+
 		bool moveFirst() {
 			nodeIndex = -1;
 			item.reset();
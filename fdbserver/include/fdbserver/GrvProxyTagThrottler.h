@@ -34,6 +34,10 @@
 // Between each set of waits, releaseTransactions is run, releasing queued transactions
 // that have passed the tag throttling stage. Transactions that are not yet ready
 // are requeued during releaseTransactions.
+//
+// Only the tags with queued requests take part in a release window, so releaseTransactions
+// takes time in the number of active tags rather than of all the tags with rates. A tag which
+// becomes active again catches up on the release windows it sat out in one step.
 class GrvProxyTagThrottler {
 	class DelayedRequest {
 		static uint64_t lastSequenceNumber;
@@ -53,6 +57,10 @@ class GrvProxyTagThrottler {
 	struct TagQueue {
 		Optional<GrvTransactionRateInfo> rateInfo;
 		Deque<DelayedRequest> requests;
+		// releasedElapsed as of the end of the last release window this queue took part in
+		double windowsEnd{ 0.0 };
+		// Transactions released in the current release window
+		uint32_t numReleased{ 0 };
 
 		TagQueue() = default;
 		explicit TagQueue(double rate)
@@ -64,10 +72,16 @@ class GrvProxyTagThrottler {
 		bool isMaxThrottled(double maxThrottleDuration) const;
 		void rejectRequests(LatencyBandsMap&);
 		void endReleaseWindow(int64_t numStarted, double elapsed);
+		// Ends the release windows since windowsEnd, in which the queue was empty, as one window
+		void catchUp(double releasedElapsed);
 	};
 
 	// Track the budgets for each tag
 	TransactionTagMap<TagQueue> queues;
+	// The queues with requests. They are values of queues, whose addresses don't change.
+	std::vector<TagQueue*> activeQueues;
+	// The sum of the elapsed times of all release windows
+	double releasedElapsed{ 0.0 };
 	double maxThrottleDuration;
 
 	// Track latency bands for each tag
@@ -0,0 +1,87 @@
+/*
+ * HotValueCache.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBSERVER_HOTVALUECACHE_H
+#define FDBSERVER_HOTVALUECACHE_H
+#pragma once
+
+#include <list>
+#include <map>
+
+#include "fdbclient/FDBTypes.h"
+
+// A bounded, least recently used cache of values as they are in a storage server's storage engine, for the few keys
+// that are read far more often than the rest. It holds committed engine values only, so a hit answers exactly the reads
+// that would otherwise have gone to the engine, at any version the storage server can serve.
+//
+// Writes to the engine must invalidate the keys they touch, and every commit must be bracketed by beginCommit() and
+// committed(). A value read from the engine can be cached only if no write happened since the read began and all
+// earlier writes were committed, because an engine may or may not return uncommitted writes to readers.
+class HotValueCache {
+public:
+	explicit HotValueCache(int64_t capacityBytes) : capacityBytes(capacityBytes) {}
+
+	// Returns the cached value of key, or an absent Optional on a miss
+	Optional<Optional<Value>> get(KeyRef key);
+
+	// Returns the token to pass to insert() for a value read from the engine from now on
+	uint64_t beginRead() const { return writes; }
+
+	// Caches the value read for key, unless the engine has been written since token was returned or has uncommitted
+	// writes. Returns whether the value was cached.
+	bool insert(KeyRef key, Optional<Value> const& value, uint64_t token);
+
+	// Called for every write to the engine, before the write
+	void invalidate(KeyRef key);
+	void invalidate(KeyRangeRef range);
+
+	// Called for changes to the engine that are not tracked key by key, such as restoring a checkpoint
+	void invalidateAll();
+
+	// Returns the token to pass to committed() once the commit started now completes
+	uint64_t beginCommit() const { return writes; }
+	void committed(uint64_t token) { committedWrites = std::max(committedWrites, token); }
+
+	int64_t getBytes() const { return bytes; }
+	int64_t getCount() const { return entries.size(); }
+	int64_t getEvictions() const { return evictions; }
+
+private:
+	struct Entry {
+		Optional<Value> value;
+		std::list<KeyRef>::iterator lruPosition;
+		int64_t bytes;
+	};
+
+	int64_t capacityBytes;
+	int64_t bytes = 0;
+	int64_t evictions = 0;
+	// Counts engine writes; committedWrites is the count of writes known to be committed
+	uint64_t writes = 0;
+	uint64_t committedWrites = 0;
+
+	std::map<Key, Entry, std::less<>> entries;
+	// Keys of entries, least recently used first, referring to the keys owned by entries
+	std::list<KeyRef> lru;
+
+	void erase(std::map<Key, Entry, std::less<>>::iterator it);
+};
+
+#endif
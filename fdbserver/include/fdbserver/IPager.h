@@ -120,7 +120,11 @@ enum PageType : uint8_t {
 	BTreeNode = 2,
 	BTreeSuperNode = 3,
 	QueuePageStandalone = 4,
-	QueuePageInExtent = 5
+	QueuePageInExtent = 5,
+	// A multi-block BTree node stored compressed in fewer blocks, see ArenaPage::compressed
+	CompressedBTreeNode = 6,
+	// A BTree leaf record's value stored outside of the leaf
+	ExternalValue = 7
 };
 
 // This is a hacky way to attach an additional object of an arbitrary type at runtime to another object.
@@ -219,7 +223,7 @@ public:
 
 	ArenaPage(int logicalSize, int bufferSize) : logicalSize(logicalSize), bufferSize(bufferSize), pPayload(nullptr) {
 		if (bufferSize > 0) {
-			buffer = (uint8_t*)arena.allocate4kAlignedBuffer(bufferSize);
+			buffer = (uint8_t*)arena.allocate4kAlignedBuffer(bufferSize, FromPageSlab::True);
 
 			// Zero unused region
 			memset(buffer + logicalSize, 0, bufferSize - logicalSize);
@@ -291,6 +295,7 @@ public:
 		//   For BTree nodes, pageSubType is Height (also stored in BTreeNode)
 		uint8_t pageSubType;
 		// Format identifier, normally specific to the page Type and SubType
+		//   For compressed BTree nodes, pageFormat is the CompressionFilter of the payload
 		uint8_t pageFormat;
 		XXH64_hash_t checksum;
 
@@ -422,16 +427,28 @@ public:
 
 		static constexpr size_t headerSize = sizeof(Header);
 
+		static std::unique_ptr<EncryptBlobCipherAes265Ctr> newCipher(const TextAndHeaderCipherKeys& cipherKeys) {
+			return std::make_unique<EncryptBlobCipherAes265Ctr>(
+			    cipherKeys.cipherTextKey,
+			    cipherKeys.cipherHeaderKey,
+			    getEncryptAuthTokenMode(ENCRYPT_HEADER_AUTH_TOKEN_MODE_SINGLE),
+			    BlobCipherMetrics::KV_REDWOOD);
+		}
+
 		static void encode(void* header,
 		                   const TextAndHeaderCipherKeys& cipherKeys,
 		                   uint8_t* payload,
 		                   int len,
 		                   PhysicalPageID seed) {
+			encode(header, *newCipher(cipherKeys), payload, len, seed);
+		}
+
+		static void encode(void* header,
+		                   EncryptBlobCipherAes265Ctr& cipher,
+		                   uint8_t* payload,
+		                   int len,
+		                   PhysicalPageID seed) {
 			Header* h = reinterpret_cast<Header*>(header);
-			EncryptBlobCipherAes265Ctr cipher(cipherKeys.cipherTextKey,
-			                                  cipherKeys.cipherHeaderKey,
-			                                  getEncryptAuthTokenMode(ENCRYPT_HEADER_AUTH_TOKEN_MODE_SINGLE),
-			                                  BlobCipherMetrics::KV_REDWOOD);
 			Arena arena;
 
 			BlobCipherEncryptHeaderRef headerRef;
@@ -569,6 +586,9 @@ public:
 			h->writeVersion = writeVersion;
 			h->writeTime = now();
 		}
+		if (compressed.isValid()) {
+			compressed->setWriteInfo(pageID, writeVersion);
+		}
 	}
 
 	// These should be updated before writing a BTree page.  Note that the logical ID that refers to a page can change
@@ -580,14 +600,30 @@ public:
 			h->lastKnownLogicalPageID = lastKnownLogicalPageID;
 			h->lastKnownParentLogicalPageID = lastKnownParentLogicalPageID;
 		}
+		if (compressed.isValid()) {
+			compressed->setLogicalPageInfo(lastKnownLogicalPageID, lastKnownParentLogicalPageID);
+		}
+	}
+
+	// Returns the cipher preWrite() encrypts an AES encrypted page with, or nullptr for other encodings.  Creating a
+	// cipher references the page's cipher keys, so this must be called on the network thread, while the preWrite()
+	// given the cipher can run on any thread.
+	std::unique_ptr<EncryptBlobCipherAes265Ctr> newCipher() const {
+		if (page->encodingType == EncodingType::AESEncryption) {
+			return AESEncryptionEncoder<AESEncryption>::newCipher(encryptionKey.aesKey);
+		} else if (page->encodingType == EncodingType::AESEncryptionWithAuth) {
+			return AESEncryptionEncoder<AESEncryptionWithAuth>::newCipher(encryptionKey.aesKey);
+		}
+		return nullptr;
 	}
 
 	// Must be called before writing to disk to update headers and encrypt page
 	// Pre:   Encoding-specific header fields are set if needed
 	//        Secret is set if needed
+	//        cipher, if given, is from newCipher()
 	// Post:  Main and Encoding subheaders are updated
 	//        Payload is possibly encrypted
-	void preWrite(PhysicalPageID pageID) {
+	void preWrite(PhysicalPageID pageID, EncryptBlobCipherAes265Ctr* cipher = nullptr) {
 		// Explicitly check payload definedness to make the source of valgrind errors more clear.
 		// Without this check, calculating a checksum on a payload with undefined bytes does not
 		// cause a valgrind error but the resulting checksum is undefined which causes errors later.
@@ -598,11 +634,21 @@ public:
 		} else if (page->encodingType == EncodingType::XOREncryption_TestOnly) {
 			XOREncryptionEncoder::encode(page->getEncodingHeader(), encryptionKey, pPayload, payloadSize, pageID);
 		} else if (page->encodingType == EncodingType::AESEncryption) {
-			AESEncryptionEncoder<AESEncryption>::encode(
-			    page->getEncodingHeader(), encryptionKey.aesKey, pPayload, payloadSize, pageID);
+			if (cipher != nullptr) {
+				AESEncryptionEncoder<AESEncryption>::encode(
+				    page->getEncodingHeader(), *cipher, pPayload, payloadSize, pageID);
+			} else {
+				AESEncryptionEncoder<AESEncryption>::encode(
+				    page->getEncodingHeader(), encryptionKey.aesKey, pPayload, payloadSize, pageID);
+			}
 		} else if (page->encodingType == EncodingType::AESEncryptionWithAuth) {
-			AESEncryptionEncoder<AESEncryptionWithAuth>::encode(
-			    page->getEncodingHeader(), encryptionKey.aesKey, pPayload, payloadSize, pageID);
+			if (cipher != nullptr) {
+				AESEncryptionEncoder<AESEncryptionWithAuth>::encode(
+				    page->getEncodingHeader(), *cipher, pPayload, payloadSize, pageID);
+			} else {
+				AESEncryptionEncoder<AESEncryptionWithAuth>::encode(
+				    page->getEncodingHeader(), encryptionKey.aesKey, pPayload, payloadSize, pageID);
+			}
 		} else {
 			throw page_encoding_not_supported();
 		}
@@ -704,6 +750,41 @@ private:
 public:
 	EncodingType getEncodingType() const { return page->encodingType; }
 
+	PageType getPageType() const {
+		if (page->headerVersion == 1) {
+			return page->getMainHeader<RedwoodHeaderV1>()->pageType;
+		} else {
+			throw page_header_version_not_supported();
+		}
+	}
+
+	uint8_t getPageSubType() const {
+		if (page->headerVersion == 1) {
+			return page->getMainHeader<RedwoodHeaderV1>()->pageSubType;
+		} else {
+			throw page_header_version_not_supported();
+		}
+	}
+
+	uint8_t getPageFormat() const {
+		if (page->headerVersion == 1) {
+			return page->getMainHeader<RedwoodHeaderV1>()->pageFormat;
+		} else {
+			throw page_header_version_not_supported();
+		}
+	}
+
+	void setPageType(PageType pageType) {
+		if (page->headerVersion == 1) {
+			page->getMainHeader<RedwoodHeaderV1>()->pageType = pageType;
+		} else {
+			throw page_header_version_not_supported();
+		}
+	}
+
+	// Offset of the payload within the raw buffer, which is the size of all headers
+	int getPayloadOffset() const { return pPayload - buffer; }
+
 	PhysicalPageID getPhysicalPageID() const {
 		if (page->headerVersion == 1) {
 			return page->getMainHeader<RedwoodHeaderV1>()->firstPhysicalPageID;
@@ -718,6 +799,11 @@ public:
 	// Whether encoding header is set
 	bool encodingHeaderAvailable = false;
 
+	// If valid, a CompressedBTreeNode page of fewer blocks holding this page's payload, which is written to disk in
+	// place of this page. Its header and encoding are maintained along with this page's by setWriteInfo(),
+	// setLogicalPageInfo(), and the pager's write path. Not copied by clone().
+	Reference<ArenaPage> compressed;
+
 	mutable ArbitraryObject extra;
 };
 
@@ -760,6 +846,11 @@ public:
 	// Returns an ArenaPage that can be passed to writePage. The data in the returned ArenaPage might not be zeroed.
 	virtual Reference<ArenaPage> newPageBuffer(size_t blocks = 1) = 0;
 
+	// Compresses a multi-block page returned by newPageBuffer() and initialized, if the pager is configured to and the
+	// result needs fewer blocks, by setting page->compressed.  Must be called after the payload is final and before
+	// allocating page IDs for it.  Returns the number of page IDs the page must be written to with updatePage().
+	virtual int compressPage(Reference<ArenaPage> page) = 0;
+
 	// Returns the usable size of pages returned by the pager (i.e. the size of the page that isn't pager overhead).
 	// For a given pager instance, separate calls to this function must return the same value.
 	// Only valid to call after recovery is complete.
@@ -774,6 +865,10 @@ public:
 	// regardless of whether or not it was written to.
 	virtual Future<LogicalPageID> newPageID() = 0;
 
+	// Allocate count consecutive new page IDs, returning the first, for pages which should be stored next to each
+	// other.  The pages are in-use after the next commit in the same way as pages from newPageID().
+	virtual LogicalPageID newContiguousPageIDs(int count) = 0;
+
 	virtual Future<LogicalPageID> newExtentPageID(QueueID queueID) = 0;
 	virtual QueueID newLastQueueID() = 0;
 
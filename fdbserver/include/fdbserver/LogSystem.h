@@ -277,6 +277,9 @@ struct ILogSystem {
 		Optional<LogMessageVersion> nextVersion;
 		LogMessageVersion messageVersion;
 		bool hasNextMessage;
+		// While messages come from bestServer, the other cursors are only advanced to messageVersion when they are
+		// needed, rather than on every message
+		bool cursorsBehind = false;
 		UID randomID;
 		int tLogReplicationFactor;
 		Future<Void> more;
@@ -305,6 +308,7 @@ struct ILogSystem {
 		Arena& arena() override;
 		ArenaReader* reader() override;
 		void calcHasMessage();
+		void catchUpCursors();
 		void updateMessage(bool usePolicy);
 		bool hasMessage() const override;
 		void nextMessage() override;
@@ -338,6 +342,9 @@ struct ILogSystem {
 		LogMessageVersion messageVersion;
 		bool hasNextMessage;
 		bool useBestSet;
+		// While messages come from the best server, the other cursors are only advanced to messageVersion when they
+		// are needed, rather than on every message
+		bool cursorsBehind = false;
 		UID randomID;
 		Future<Void> more;
 
@@ -361,6 +368,7 @@ struct ILogSystem {
 		Arena& arena() override;
 		ArenaReader* reader() override;
 		void calcHasMessage();
+		void catchUpCursors();
 		void updateMessage(int logIdx, bool usePolicy);
 		bool hasMessage() const override;
 		void nextMessage() override;
@@ -132,6 +132,9 @@ struct SWIFT_CXX_REF_MASTERDATA MasterData : NonCopyable, ReferenceCounted<Maste
 	CounterValue nonWaitForPrevCommitRequests;
 	std::unique_ptr<LatencySample> versionVectorSizeOnCVReply;
 	std::unique_ptr<LatencySample> waitForPrevLatencies;
+	// Commit version requests that had to wait for earlier requests of their proxy, and how long requests waited
+	CounterValue queuedCommitVersionRequests;
+	std::unique_ptr<LatencySample> commitVersionQueueTime;
 
 	PromiseStream<Future<Void>> addActor;
 
@@ -21,10 +21,13 @@
 #ifndef METRIC_CLIENT_H
 #define METRIC_CLIENT_H
 
+#include "fdbrpc/HTTP.h"
 #include "flow/TDMetric.actor.h"
+#include "flow/IThreadPool.h"
 #include "flow/Msgpack.h"
 #include "flow/network.h"
 #include "flow/IUDPSocket.h"
+#include <map>
 
 class IMetricClient {
 protected:
@@ -52,4 +55,56 @@ public:
 	UDPMetricClient();
 	void send(MetricCollection*) override;
 };
+
+// The latest point of each series of the metrics of a process, rendered in the Prometheus text exposition format.
+// Families are named fdb_ followed by the metric name, and labelled with the attributes of the point: ip, port and,
+// for counters, the role and id of their CounterCollection. Counters are cumulative, and latency samples are
+// summaries of their DDSketch, whose quantiles are the gauges of the sample.
+class PrometheusMetrics {
+public:
+	// Replaces the series of the given metrics, which are consumed
+	void update(std::unordered_map<UID, OTEL::OTELSum>& sums,
+	            std::unordered_map<UID, OTEL::OTELGauge>& gauges,
+	            std::unordered_map<UID, OTEL::OTELHistogram>& hists,
+	            double now);
+	// Drops the series last updated before time, i.e. of roles which stopped
+	void expire(double time);
+	std::string render() const;
+
+private:
+	struct Series {
+		std::vector<std::pair<std::string, double>> values; // by suffix of the family name
+		double updated = 0.0;
+	};
+	struct Family {
+		std::string type;
+		std::map<std::string, Series> series; // by rendered labels
+	};
+	std::map<std::string, Family> families;
+
+	Series& getSeries(const std::string& name,
+	                  const char* type,
+	                  const std::vector<OTEL::Attribute>& attributes,
+	                  double now);
+};
+
+// Serves the metrics of the process to Prometheus scrapes of /metrics on METRICS_PROMETHEUS_PORT. Each send() moves
+// the points collected since the last one to a thread which renders them, so the network thread neither formats
+// metrics nor does more per scrape than copy the text rendered last.
+class PrometheusMetricClient : public IMetricClient {
+public:
+	struct RenderedText : ReferenceCounted<RenderedText> {
+		std::string text;
+	};
+
+	PrometheusMetricClient();
+	~PrometheusMetricClient() override;
+	void send(MetricCollection*) override;
+
+private:
+	Reference<IThreadPool> renderer;
+	Reference<HTTP::SimServerContext> server;
+	Reference<RenderedText> rendered;
+	Future<Void> pendingRender;
+};
 #endif
\ No newline at end of file
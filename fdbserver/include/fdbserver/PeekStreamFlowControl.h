@@ -0,0 +1,138 @@
+/*
+ * PeekStreamFlowControl.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBSERVER_PEEKSTREAMFLOWCONTROL_H
+#define FDBSERVER_PEEKSTREAMFLOWCONTROL_H
+#pragma once
+
+#include <algorithm>
+
+#include "fdbrpc/Smoother.h"
+#include "fdbserver/Knobs.h"
+#include "flow/Trace.h"
+
+// Sizes the unacknowledged bytes (window) and the reply size of one TLogPeekStreamRequest stream. A consumer is allowed
+// PEEK_STREAM_WINDOW_SECONDS of its own acknowledgement rate in flight, up to the limit it asked for, so a slow or
+// stalled peer no longer pins MAXIMUM_PEEK_BYTES of replies on the server. Once the server's memory pressure passes
+// PEEK_STREAM_MEMORY_PRESSURE_THRESHOLD both the window and the reply size shrink towards their minimums.
+class PeekStreamFlowControl {
+public:
+	PeekStreamFlowControl() : PeekStreamFlowControl(SERVER_KNOBS->MAXIMUM_PEEK_BYTES) {}
+	explicit PeekStreamFlowControl(int64_t requestedLimit)
+	  : requestedLimit(requestedLimit), window(requestedLimit), replyLimit(SERVER_KNOBS->DESIRED_TOTAL_BYTES),
+	    drained(SERVER_KNOBS->PEEK_STREAM_DRAIN_RATE_SMOOTHING), lastAcknowledged(0), lastLogged(now()) {
+		resetMetrics();
+	}
+
+	// Recomputes the window and reply size from the stream's acknowledged bytes and the server's memory pressure, a
+	// fraction of its memory budget in use. Returns the window to pass to ReplyPromiseStream::setByteLimit().
+	int64_t update(int64_t bytesAcknowledged, double memoryPressure) {
+		if (!SERVER_KNOBS->PEEK_STREAM_ADAPTIVE_FLOW_CONTROL) {
+			return window;
+		}
+		// The acknowledged byte count can wrap around, in which case only the bytes since the wrap are counted
+		drained.addDelta(bytesAcknowledged >= lastAcknowledged ? bytesAcknowledged - lastAcknowledged
+		                                                       : std::max<int64_t>(bytesAcknowledged, 0));
+		lastAcknowledged = bytesAcknowledged;
+		pressure = std::clamp(memoryPressure, 0.0, 1.0);
+
+		const int64_t minWindow = std::min(requestedLimit, SERVER_KNOBS->PEEK_STREAM_MIN_WINDOW_BYTES);
+		const double scale = pressureScale();
+		window = std::clamp<int64_t>(
+		    drained.smoothRate() * SERVER_KNOBS->PEEK_STREAM_WINDOW_SECONDS * scale, minWindow, requestedLimit);
+		replyLimit = std::max<int>(SERVER_KNOBS->PEEK_STREAM_MIN_REPLY_BYTES, SERVER_KNOBS->DESIRED_TOTAL_BYTES * scale);
+		minWindowSeen = std::min(minWindowSeen, window);
+		maxWindowSeen = std::max(maxWindowSeen, window);
+		return window;
+	}
+
+	int64_t getWindow() const { return window; }
+
+	// The byte limit for the next reply, at most DESIRED_TOTAL_BYTES
+	int getReplyLimit() const { return replyLimit; }
+
+	void addReply(int64_t bytes, double readyWait) {
+		replies++;
+		replyBytes += bytes;
+		readyWaitTime += readyWait;
+		if (readyWait > 0) {
+			stalledReplies++;
+		}
+	}
+
+	// Logs the stream's metrics every PEEK_LOGGING_DELAY
+	void logMetrics(UID id, Tag tag, NetworkAddress peer) {
+		if (now() - lastLogged < SERVER_KNOBS->PEEK_LOGGING_DELAY) {
+			return;
+		}
+		TraceEvent("PeekStreamMetrics", id)
+		    .detail("Tag", tag)
+		    .detail("PeerAddr", peer)
+		    .detail("Elapsed", now() - lastLogged)
+		    .detail("Replies", replies)
+		    .detail("ReplyBytes", replyBytes)
+		    .detail("StalledReplies", stalledReplies)
+		    .detail("ReadyWaitSeconds", readyWaitTime)
+		    .detail("DrainRate", drained.smoothRate())
+		    .detail("MemoryPressure", pressure)
+		    .detail("Window", window)
+		    .detail("MinWindow", minWindowSeen)
+		    .detail("MaxWindow", maxWindowSeen)
+		    .detail("ReplyLimit", replyLimit);
+		lastLogged = now();
+		resetMetrics();
+	}
+
+private:
+	int64_t requestedLimit;
+	int64_t window;
+	int replyLimit;
+	Smoother drained;
+	int64_t lastAcknowledged;
+	double pressure = 0;
+
+	double lastLogged;
+	int64_t replies;
+	int64_t replyBytes;
+	int64_t stalledReplies;
+	double readyWaitTime;
+	int64_t minWindowSeen;
+	int64_t maxWindowSeen;
+
+	// 1 below the pressure threshold, falling linearly to 0 at full pressure
+	double pressureScale() const {
+		const double threshold = SERVER_KNOBS->PEEK_STREAM_MEMORY_PRESSURE_THRESHOLD;
+		if (pressure <= threshold) {
+			return 1.0;
+		}
+		return threshold < 1.0 ? std::max(0.0, (1.0 - pressure) / (1.0 - threshold)) : 1.0;
+	}
+
+	void resetMetrics() {
+		replies = 0;
+		replyBytes = 0;
+		stalledReplies = 0;
+		readyWaitTime = 0;
+		minWindowSeen = window;
+		maxWindowSeen = window;
+	}
+};
+
+#endif
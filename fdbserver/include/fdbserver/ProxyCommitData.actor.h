@@ -26,6 +26,7 @@
 #define FDBSERVER_PROXYCOMMITDATA_ACTOR_H
 
 #include "fdbclient/FDBTypes.h"
+#include "fdbclient/FlatKeyRangeMap.h"
 #include "fdbclient/GetEncryptCipherKeys.h"
 #include "fdbclient/Tenant.h"
 #include "fdbrpc/Stats.h"
@@ -36,6 +37,7 @@
 #include "fdbserver/MasterInterface.h"
 #include "fdbserver/ResolverInterface.h"
 #include "flow/IRandom.h"
+#include "flow/IThreadPool.h"
 
 #include "flow/actorcompiler.h" // This must be the last #include.
 
@@ -69,6 +71,11 @@ struct ProxyStats {
 	Counter tenantIdRequestErrors;
 	Counter blobGranuleLocationIn, blobGranuleLocationOut, blobGranuleLocationErrors;
 	Counter txnExpensiveClearCostEstCount;
+	// Single key tag lookups, and how many were served by the batch's key ordered walk of keyInfo or by the
+	// recently used shard cache instead of a search of keyInfo
+	Counter keyTagLookups, keyTagBatchHits, keyTagCacheHits, keyTagCacheMisses;
+	// Searches of keyInfo served by its flat copy, and how many times the copy was built
+	Counter keyInfoFlatSearches, keyInfoFlatBuilds;
 	Version lastCommitVersionAssigned;
 
 	LatencySample commitLatencySample;
@@ -137,7 +144,10 @@ struct ProxyStats {
 	    tenantIdRequestOut("TenantIdRequestOut", cc), tenantIdRequestErrors("TenantIdRequestErrors", cc),
 	    blobGranuleLocationIn("BlobGranuleLocationIn", cc), blobGranuleLocationOut("BlobGranuleLocationOut", cc),
 	    blobGranuleLocationErrors("BlobGranuleLocationErrors", cc),
-	    txnExpensiveClearCostEstCount("ExpensiveClearCostEstCount", cc), lastCommitVersionAssigned(0),
+	    txnExpensiveClearCostEstCount("ExpensiveClearCostEstCount", cc), keyTagLookups("KeyTagLookups", cc),
+	    keyTagBatchHits("KeyTagBatchHits", cc), keyTagCacheHits("KeyTagCacheHits", cc),
+	    keyTagCacheMisses("KeyTagCacheMisses", cc), keyInfoFlatSearches("KeyInfoFlatSearches", cc),
+	    keyInfoFlatBuilds("KeyInfoFlatBuilds", cc), lastCommitVersionAssigned(0),
 	    commitLatencySample("CommitLatencyMetrics",
 	                        id,
 	                        SERVER_KNOBS->LATENCY_METRICS_LOGGING_INTERVAL,
@@ -184,6 +194,72 @@ struct ProxyStats {
 	}
 };
 
+// Adjusts the commit batching interval so that the p99 commit latency stays under COMMIT_BATCH_TARGET_P99_LATENCY.
+// Every COMMIT_BATCH_CONTROLLER_WINDOW seconds the finished batches are looked at: batches grow while the resolvers or
+// tlogs are the bottleneck, since larger batches amortize their per batch cost, and shrink when the target is missed
+// for other reasons or the proxy is close to idle, where waiting for more transactions only adds latency.
+class CommitBatchIntervalController {
+public:
+	// Records a finished batch. latency covers the whole batch, downstream the part spent waiting on resolvers and
+	// tlogs, and queued is whether the batch had to wait for the previous batch's post resolution processing.
+	void addBatch(double latency, double downstream, int transactions, bool queued) {
+		latencies.addSample(latency);
+		latencySum += latency;
+		downstreamSum += downstream;
+		transactionCount += transactions;
+		queuedBatches += queued;
+	}
+
+	// Returns the batching interval to use from now on, which is interval unless a window has just finished
+	double update(double now, double interval) {
+		if (now - windowStart < SERVER_KNOBS->COMMIT_BATCH_CONTROLLER_WINDOW) {
+			return interval;
+		}
+		const int64_t batches = latencies.getPopulationSize();
+		if (batches > 0) {
+			interval = nextInterval(interval,
+			                        SERVER_KNOBS->COMMIT_BATCH_TARGET_P99_LATENCY,
+			                        latencies.percentile(0.99),
+			                        latencySum > 0 ? downstreamSum / latencySum : 0,
+			                        (double)queuedBatches / batches,
+			                        (double)transactionCount / batches);
+		}
+		windowStart = now;
+		latencies.clear();
+		latencySum = downstreamSum = 0;
+		transactionCount = queuedBatches = 0;
+		return interval;
+	}
+
+	static double nextInterval(double interval,
+	                           double target,
+	                           double p99Latency,
+	                           double downstreamFraction,
+	                           double queuedFraction,
+	                           double transactionsPerBatch) {
+		const double step = SERVER_KNOBS->COMMIT_BATCH_INTERVAL_STEP;
+		const bool downstreamBound = downstreamFraction >= SERVER_KNOBS->COMMIT_BATCH_DOWNSTREAM_BOTTLENECK_FRACTION ||
+		                             queuedFraction >= SERVER_KNOBS->COMMIT_BATCH_DOWNSTREAM_BOTTLENECK_FRACTION;
+		if (p99Latency > target) {
+			interval = downstreamBound ? interval * step : interval / step;
+		} else if (transactionsPerBatch < 2) {
+			interval /= step;
+		} else if (downstreamBound || p99Latency < target / 2) {
+			interval *= step;
+		}
+		return std::max(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN,
+		                std::min(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MAX, interval));
+	}
+
+private:
+	DDSketch<double> latencies;
+	double windowStart = 0;
+	double latencySum = 0;
+	double downstreamSum = 0;
+	int64_t transactionCount = 0;
+	int64_t queuedBatches = 0;
+};
+
 struct ExpectedIdempotencyIdCountForKey {
 	Version commitVersion = invalidVersion;
 	int16_t idempotencyIdCount = 0;
@@ -200,6 +276,8 @@ struct ProxyCommitData {
 	std::unordered_map<TenantName, int64_t> tenantNameIndex;
 	std::map<int64_t, TenantName> tenantMap;
 	std::set<int64_t> lockedTenants;
+	// Bumped whenever tenantMap or lockedTenants change, so that lookups cached from them can tell they are stale
+	uint64_t tenantMapGeneration = 0;
 	std::unordered_set<int64_t> tenantsOverStorageQuota;
 	ProxyStats stats;
 	MasterInterface master;
@@ -222,6 +300,18 @@ struct ProxyCommitData {
 	// only tracks normalKeys. This is used for tracking versions for systemKeys.
 	Deque<Version> systemKeyVersions;
 	KeyRangeMap<ServerCacheInfo> keyInfo; // keyrange -> all storage servers in all DCs for the keyrange
+	// Bumped whenever keyInfo's ranges or tags change, so that cached iterators into it can tell they are stale
+	uint64_t keyInfoGeneration = 0;
+	// Recently used keyInfo ranges, valid while hotKeyInfoGeneration == keyInfoGeneration
+	std::vector<KeyRangeMap<ServerCacheInfo>::iterator> hotKeyInfoRanges;
+	uint64_t hotKeyInfoGeneration = 0;
+	int hotKeyInfoNext = 0;
+	// A flat copy of keyInfo for faster searches, valid while flatKeyInfoValid and flatKeyInfoGeneration ==
+	// keyInfoGeneration, and the number of searches of keyInfo since it last changed
+	FlatKeyRangeMap<KeyRangeMap<ServerCacheInfo>::iterator> flatKeyInfo;
+	uint64_t flatKeyInfoGeneration = 0;
+	bool flatKeyInfoValid = false;
+	int64_t keyInfoSearches = 0;
 	KeyRangeMap<bool> cacheInfo;
 	std::map<Key, ApplyMutationsData> uid_applyMutationsData;
 	bool firstProxy;
@@ -229,6 +319,7 @@ struct ProxyCommitData {
 	bool locked;
 	Optional<Value> metadataVersion;
 	double commitBatchInterval;
+	CommitBatchIntervalController commitBatchIntervalController; // Used when COMMIT_BATCH_TARGET_P99_LATENCY > 0
 	bool provisional;
 
 	int64_t localCommitBatchesStarted;
@@ -250,6 +341,9 @@ struct ProxyCommitData {
 	bool popRemoteTxs;
 	std::vector<Standalone<StringRef>> whitelistedBinPathVec;
 	std::vector<std::pair<KeyRange, double>> hotShards;
+	// Storage server -> fraction of the transactions writing to it that may commit, as set by ratekeeper
+	std::map<UID, double> storageWriteBudgets;
+	double storageWriteBudgetsExpiration = 0;
 
 	Optional<LatencyBandConfig> latencyBandConfig;
 	double lastStartCommit;
@@ -265,6 +359,8 @@ struct ProxyCommitData {
 
 	EncryptionAtRestMode encryptMode;
 	Reference<GetEncryptCipherKeysMonitor> encryptionMonitor;
+	// Helper threads for PROXY_ENCRYPTION_THREADS; not created in simulation, which encrypts on the proxy thread
+	Reference<IThreadPool> encryptionThreads;
 
 	PromiseStream<ExpectedIdempotencyIdCountForKey> expectedIdempotencyIdCountForKey;
 	Standalone<VectorRef<MutationRef>> idempotencyClears;
@@ -288,6 +384,59 @@ struct ProxyCommitData {
 		return tags;
 	}
 
+	// Returns the keyInfo range containing key, checking the PROXY_KEY_TAG_CACHE_SIZE most recently used ranges before
+	// searching keyInfo. Small transactions tend to hit the same few shards over and over.
+	KeyRangeMap<ServerCacheInfo>::iterator cachedRangeContaining(StringRef key) {
+		if (hotKeyInfoGeneration != keyInfoGeneration) {
+			hotKeyInfoRanges.clear();
+			hotKeyInfoNext = 0;
+			hotKeyInfoGeneration = keyInfoGeneration;
+		}
+		for (auto& r : hotKeyInfoRanges) {
+			if (r.begin() <= key && key < r.end()) {
+				++stats.keyTagCacheHits;
+				return r;
+			}
+		}
+		++stats.keyTagCacheMisses;
+		auto r = searchKeyInfo(key);
+		if ((int)hotKeyInfoRanges.size() < SERVER_KNOBS->PROXY_KEY_TAG_CACHE_SIZE) {
+			hotKeyInfoRanges.push_back(r);
+		} else if (!hotKeyInfoRanges.empty()) {
+			hotKeyInfoRanges[hotKeyInfoNext] = r;
+			hotKeyInfoNext = (hotKeyInfoNext + 1) % hotKeyInfoRanges.size();
+		}
+		return r;
+	}
+
+	// Returns the keyInfo range containing key. Once keyInfo has gone unchanged for
+	// PROXY_FLAT_KEY_INFO_SEARCHES_PER_SHARD searches per range, it is copied into flatKeyInfo, which is searched
+	// instead until keyInfo changes again.
+	KeyRangeMap<ServerCacheInfo>::iterator searchKeyInfo(StringRef key) {
+		if (flatKeyInfoGeneration != keyInfoGeneration) {
+			flatKeyInfoGeneration = keyInfoGeneration;
+			flatKeyInfoValid = false;
+			keyInfoSearches = 0;
+		}
+		if (!flatKeyInfoValid) {
+			const double searchesPerShard = SERVER_KNOBS->PROXY_FLAT_KEY_INFO_SEARCHES_PER_SHARD;
+			if (searchesPerShard < 0 || ++keyInfoSearches < searchesPerShard * keyInfo.size()) {
+				return keyInfo.rangeContaining(key);
+			}
+			flatKeyInfo.clear();
+			flatKeyInfo.reserve(keyInfo.size());
+			auto ranges = keyInfo.ranges();
+			for (auto r = ranges.begin(); r != ranges.end(); ++r) {
+				flatKeyInfo.push_back(r.begin(), r);
+			}
+			flatKeyInfo.finish(ranges.end().begin());
+			flatKeyInfoValid = true;
+			++stats.keyInfoFlatBuilds;
+		}
+		++stats.keyInfoFlatSearches;
+		return flatKeyInfo[key];
+	}
+
 	bool needsCacheTag(KeyRangeRef range) {
 		auto ranges = cacheInfo.intersectingRanges(range);
 		for (auto r : ranges) {
@@ -339,6 +339,7 @@ private:
 	void delete_child4(node* parent, node* child);
 	// access
 	static int find_child(node* parent, int16_t ch); // return index
+	static int lower_bound_child(node* parent, int16_t ch); // return index of first child whose first byte >= ch
 	static int child_size(node* parent); // how many children does parent node have
 	static node* get_child(node* parent, int index); // return node pointer
 
@@ -502,11 +503,28 @@ int radix_tree::find_child(radix_tree::node* parent, int16_t ch) {
 				return i;
 		}
 	} else {
+		// children are ordered by first byte, and there can be up to 257 of them
+		i = lower_bound_child(parent, ch);
 		internalNode* parent_ref = (internalNode*)parent;
-		for (; i != parent_ref->m_children.size(); ++i) {
-			if (parent_ref->m_children[i].first == ch)
-				return i;
-		}
+		if (i != parent_ref->m_children.size() && parent_ref->m_children[i].first != ch)
+			i = parent_ref->m_children.size();
+	}
+	return i;
+}
+
+int radix_tree::lower_bound_child(radix_tree::node* parent, int16_t ch) {
+	int i = 0;
+	if (parent->m_is_fixed) {
+		internalNode4* parent_ref = (internalNode4*)parent;
+		while (i < parent_ref->num_children && parent_ref->keys[i] < ch)
+			++i;
+	} else {
+		internalNode* parent_ref = (internalNode*)parent;
+		i = std::lower_bound(parent_ref->m_children.begin(),
+		                     parent_ref->m_children.end(),
+		                     ch,
+		                     [](const std::pair<int16_t, node*>& child, int16_t ch) { return child.first < ch; }) -
+		    parent_ref->m_children.begin();
 	}
 	return i;
 }
@@ -640,7 +658,9 @@ radix_tree::node* radix_tree::find_node(const StringRef& key, node* node, int de
 
 	int size = child_size(node);
 	//	printf("try to find key %s on node %s [%d]\n", printable(key).c_str(), printable(node->getKey()).c_str(), size);
-	for (int it = 0; it < size; ++it) {
+	// Only the child starting with the next byte of key, or the leaf with an empty key once key is used up, can match
+	int it = find_child(node, depth < key.size() ? key[depth] : LEAF_BYTE);
+	if (it < size) {
 		auto current = get_child(node, it);
 		// for leaf node with empty key, exact match
 		if (depth == key.size() && current->getKeySize() == 0) {
@@ -680,8 +700,11 @@ radix_tree::iterator radix_tree::lower_bound(const StringRef& key) {
 radix_tree::iterator radix_tree::lower_bound(const StringRef& key, node* node) {
 	iterator result(nullptr);
 	int size = child_size(node);
+	// Children starting with a byte below the next byte of key are all smaller than it
+	int depth = node->m_depth + node->getKeySize();
+	int first = depth < key.size() ? lower_bound_child(node, key[depth]) : 0;
 
-	for (int it = 0; it < size; ++it) {
+	for (int it = first; it < size; ++it) {
 		auto current = get_child(node, it);
 		// short cut as find_node
 		if (key.size() == current->m_depth && current->getKeySize() == 0) {
@@ -721,8 +744,10 @@ radix_tree::iterator radix_tree::upper_bound(const StringRef& key, node* node) {
 
 	iterator result(nullptr);
 	int size = child_size(node);
+	int depth = node->m_depth + node->getKeySize();
+	int first = depth < key.size() ? lower_bound_child(node, key[depth]) : 0;
 
-	for (int it = 0; it < size; ++it) {
+	for (int it = first; it < size; ++it) {
 		auto current = get_child(node, it);
 		StringRef key_sub = radix_substr(key, current->m_depth, current->getKeySize());
 		StringRef node_data = current->getKey();
@@ -751,9 +776,8 @@ radix_tree::iterator radix_tree::previous(radix_tree::iterator i) {
 	if (i == end()) {
 		// for iterator == end(), find the largest element
 		return descend<1>(m_root);
-	} else if (i == begin()) {
-		return iterator(nullptr);
 	} else {
+		// decrementing begin() gives end()
 		--i;
 		return i;
 	}
@@ -48,6 +48,7 @@ enum limitReason_t {
 	storage_server_list_fetch_failed,
 	blob_worker_lag,
 	blob_worker_missing,
+	storage_server_read_queue, // batch transactions are being limited by the read queue wait of a storage server
 	limitReason_t_end
 };
 
@@ -61,6 +62,7 @@ class StorageQueueInfo {
 	UID ratekeeperID;
 	Smoother smoothFreeSpace, smoothTotalSpace;
 	Smoother smoothDurableBytes, smoothInputBytes, verySmoothDurableBytes;
+	Smoother smoothInteractiveReadQueueWait; // of the normal and high priority reads
 
 	// Currently unused
 	Smoother smoothDurableVersion, smoothLatestVersion;
@@ -88,10 +90,15 @@ public:
 	double getSmoothTotalSpace() const { return smoothTotalSpace.smoothTotal(); }
 	double getSmoothDurableBytes() const { return smoothDurableBytes.smoothTotal(); }
 	double getSmoothInputBytesRate() const { return smoothInputBytes.smoothRate(); }
+	double getSmoothDurableBytesRate() const { return smoothDurableBytes.smoothRate(); }
 	double getVerySmoothDurableBytesRate() const { return verySmoothDurableBytes.smoothRate(); }
+	double getSmoothInteractiveReadQueueWait() const { return smoothInteractiveReadQueueWait.smoothTotal(); }
 
 	Version getLatestVersion() const { return lastReply.version; }
 
+	// The versions the storage server keeps in memory, which bound how long its queued bytes stay in memory
+	Version getMvccWindowVersions() const;
+
 	// Determine the ratio (limit / current throughput) for throttling based on write queue size
 	Optional<double> getTagThrottlingRatio(int64_t storageTargetBytes, int64_t storageSpringBytes) const;
 };
@@ -111,6 +118,7 @@ public:
 	double getSmoothTotalSpace() const { return smoothTotalSpace.smoothTotal(); }
 	double getSmoothDurableBytes() const { return smoothDurableBytes.smoothTotal(); }
 	double getSmoothInputBytesRate() const { return smoothInputBytes.smoothRate(); }
+	double getSmoothDurableBytesRate() const { return smoothDurableBytes.smoothRate(); }
 	double getVerySmoothDurableBytesRate() const { return verySmoothDurableBytes.smoothRate(); }
 
 	TLogQueueInfo(UID id);
@@ -211,6 +219,9 @@ class Ratekeeper {
 	bool anyBlobRanges;
 	Optional<Key> remoteDC;
 	Optional<UID> ssHighWriteQueue;
+	// Storage server -> fraction of the transactions writing to it that the commit proxies should let commit, for the
+	// storage servers left out of the cluster wide limit
+	std::map<UID, double> storageWriteBudgets;
 
 	double getRecoveryDuration(Version ver) const {
 		auto it = version_recovery.lower_bound(ver);
@@ -243,6 +254,7 @@ class Ratekeeper {
 	Future<Void> monitorThrottlingChanges();
 	Future<Void> monitorBlobWorkers(Reference<AsyncVar<ServerDBInfo> const> dbInfo);
 	Future<Void> monitorHotShards(Reference<AsyncVar<ServerDBInfo> const> dbInfo);
+	Future<Void> sendStorageWriteBudgets(Reference<AsyncVar<ServerDBInfo> const> dbInfo);
 
 	void getSSVersionLag(Version& maxSSPrimaryVersion, Version& maxSSRemoteVersion);
 
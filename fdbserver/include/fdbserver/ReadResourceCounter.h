@@ -0,0 +1,116 @@
+/*
+ * ReadResourceCounter.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <unordered_map>
+
+#include "fdbserver/TransactionTagCounter.h"
+#include "flow/Platform.h"
+
+// Thread CPU time spent in the segments of a read between its waits. The actors serving a read share its timer, each
+// starting it when it resumes and stopping it before it waits. Starting a running timer or stopping a stopped one does
+// nothing, so the time an actor spends after a nested actor returns to it is counted once. Only sampled reads are
+// timed, since reading the CPU time of the thread is a system call.
+class ReadCpuTimer {
+public:
+	explicit ReadCpuTimer(bool sampled = false) : sampled(sampled) {}
+
+	bool isSampled() const { return sampled; }
+
+	void start() {
+		if (sampled && startTime < 0) {
+			startTime = getProcessorTimeThread();
+		}
+	}
+
+	void stop() {
+		if (startTime >= 0) {
+			seconds += std::max(getProcessorTimeThread() - startTime, 0.0);
+			startTime = -1;
+		}
+	}
+
+	double getSeconds() const { return seconds; }
+
+private:
+	bool sampled;
+	double startTime = -1;
+	double seconds = 0;
+};
+
+enum class ReadRequestType : uint8_t { GET_VALUE, GET_KEY_VALUES, MAX };
+
+struct ReadResourceUsage {
+	int64_t requests = 0;
+	double cpuSeconds = 0;
+	int64_t engineReads = 0;
+	int64_t bytesScanned = 0;
+	int64_t bytesReturned = 0;
+
+	void add(double cpuSeconds, ReadEngineCost const& engineCost, int64_t bytesReturned) {
+		++requests;
+		this->cpuSeconds += cpuSeconds;
+		engineReads += engineCost.reads;
+		bytesScanned += engineCost.bytesScanned;
+		this->bytesReturned += bytesReturned;
+	}
+};
+
+// Aggregates the resources used by a sample of the reads of a storage server, per type of read, tenant and tag, so that
+// they can be attributed for throttling and capacity planning. Every interval it traces the usage of each type of read
+// and of the tenants and tags which used the most CPU, estimated for all reads from the sampled ones.
+class ReadResourceCounter {
+public:
+	ReadResourceCounter(UID thisServerID, double sampleRate, int maxTracked);
+
+	// Whether a new read should be sampled
+	bool sampleRead() const;
+
+	// Adds a sampled read
+	void addRequest(ReadRequestType type,
+	                int64_t tenantId,
+	                Optional<TagSet> const& tags,
+	                double cpuSeconds,
+	                ReadEngineCost const& engineCost,
+	                int64_t bytesReturned);
+
+	// Traces the usage of the current interval and starts the next one
+	void startNewInterval();
+
+	// The estimated usage of the last interval, the tenants and tags using the most CPU first
+	ReadResourceUsage const& getTypeUsage(ReadRequestType type) const { return previousTypes[static_cast<int>(type)]; }
+	std::vector<std::pair<int64_t, ReadResourceUsage>> const& getBusiestTenants() const { return previousTenants; }
+	std::vector<std::pair<TransactionTag, ReadResourceUsage>> const& getBusiestTags() const { return previousTags; }
+
+private:
+	UID thisServerID;
+	double sampleRate;
+	int maxTracked;
+
+	ReadResourceUsage intervalTypes[static_cast<int>(ReadRequestType::MAX)];
+	std::unordered_map<int64_t, ReadResourceUsage> intervalTenants;
+	TransactionTagMap<ReadResourceUsage> intervalTags;
+	double intervalStart = 0;
+
+	ReadResourceUsage previousTypes[static_cast<int>(ReadRequestType::MAX)];
+	std::vector<std::pair<int64_t, ReadResourceUsage>> previousTenants;
+	std::vector<std::pair<TransactionTag, ReadResourceUsage>> previousTags;
+};
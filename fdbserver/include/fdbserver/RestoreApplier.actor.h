@@ -239,7 +239,10 @@ struct ApplierBatchData : public ReferenceCounted<ApplierBatchData> {
 	std::map<RestoreAsset, NotifiedVersion> processedFileState;
 	Optional<Future<Void>> dbApplier;
 	VersionedMutationsMap kvOps; // Mutations at each version
-	std::map<Key, StagingKey> stagingKeys;
+	// Point mutations as they were received, until buildStagingKeys() sorts and merges them into stagingKeys,
+	// which is sorted by key
+	Standalone<VectorRef<VersionedMutation>> receivedPointMutations;
+	std::vector<StagingKey> stagingKeys;
 	std::set<StagingKeyRange> stagingKeyRanges;
 
 	Future<Void> pollMetrics;
@@ -264,6 +267,7 @@ struct ApplierBatchData : public ReferenceCounted<ApplierBatchData> {
 		Counter appliedBytes, appliedWeightedBytes, appliedMutations, appliedAtomicOps;
 		Counter appliedTxns, appliedTxnRetries;
 		Counter fetchKeys, fetchTxns, fetchTxnRetries; // number of keys to fetch from dest. FDB cluster.
+		Counter fetchRangeKeys; // fetched keys whose values came from a range read
 		Counter clearOps, clearTxns;
 
 		Counters(ApplierBatchData* self, UID applierInterfID, int batchIndex)
@@ -273,8 +277,8 @@ struct ApplierBatchData : public ReferenceCounted<ApplierBatchData> {
 		    appliedBytes("AppliedBytes", cc), appliedWeightedBytes("AppliedWeightedBytes", cc),
 		    appliedMutations("AppliedMutations", cc), appliedAtomicOps("AppliedAtomicOps", cc),
 		    appliedTxns("AppliedTxns", cc), appliedTxnRetries("AppliedTxnRetries", cc), fetchKeys("FetchKeys", cc),
-		    fetchTxns("FetchTxns", cc), fetchTxnRetries("FetchTxnRetries", cc), clearOps("ClearOps", cc),
-		    clearTxns("ClearTxns", cc) {}
+		    fetchTxns("FetchTxns", cc), fetchTxnRetries("FetchTxnRetries", cc), fetchRangeKeys("FetchRangeKeys", cc),
+		    clearOps("ClearOps", cc), clearTxns("ClearTxns", cc) {}
 	} counters;
 
 	void addref() { return ReferenceCounted<ApplierBatchData>::addref(); }
@@ -297,21 +301,45 @@ struct ApplierBatchData : public ReferenceCounted<ApplierBatchData> {
 
 	void addMutation(MutationRef m, LogMessageVersion ver) {
 		if (!isRangeMutation(m)) {
-			auto item = stagingKeys.emplace(m.param1, StagingKey(m.param1));
-			item.first->second.add(m, ver);
+			receivedPointMutations.push_back_deep(receivedPointMutations.arena(), VersionedMutation(m, ver));
 		} else {
 			stagingKeyRanges.insert(StagingKeyRange(m, ver));
 		}
 	}
 
+	// Sorts the received point mutations by key and merges the mutations of each key into its StagingKey, instead of
+	// looking up the key in a map for every mutation as it arrives
+	void buildStagingKeys() {
+		ASSERT(stagingKeys.empty());
+		std::sort(receivedPointMutations.begin(),
+		          receivedPointMutations.end(),
+		          [](const VersionedMutation& a, const VersionedMutation& b) {
+			          return std::tie(a.mutation.param1, a.version) < std::tie(b.mutation.param1, b.version);
+		          });
+		for (const VersionedMutation& vm : receivedPointMutations) {
+			if (stagingKeys.empty() || stagingKeys.back().key != vm.mutation.param1) {
+				stagingKeys.emplace_back(vm.mutation.param1);
+			}
+			stagingKeys.back().add(vm.mutation, vm.version);
+		}
+		stagingKeys.shrink_to_fit();
+		receivedPointMutations = Standalone<VectorRef<VersionedMutation>>();
+	}
+
+	// The first staging key not less than key
+	std::vector<StagingKey>::iterator lowerBoundStagingKey(KeyRef key) {
+		return std::lower_bound(
+		    stagingKeys.begin(), stagingKeys.end(), key, [](const StagingKey& sk, KeyRef k) { return sk.key < k; });
+	}
+
 	// Return true if all staging keys have been precomputed
 	bool allKeysPrecomputed() {
 		for (auto& stagingKey : stagingKeys) {
-			if (!stagingKey.second.hasPrecomputed()) {
+			if (!stagingKey.hasPrecomputed()) {
 				TraceEvent("FastRestoreApplierAllKeysPrecomputedFalse")
-				    .detail("Key", stagingKey.first)
-				    .detail("BufferedVersion", stagingKey.second.version.toString())
-				    .detail("MaxPendingVersion", stagingKey.second.pendingMutations.rbegin()->first.toString());
+				    .detail("Key", stagingKey.key)
+				    .detail("BufferedVersion", stagingKey.version.toString())
+				    .detail("MaxPendingVersion", stagingKey.pendingMutations.rbegin()->first.toString());
 				return false;
 			}
 		}
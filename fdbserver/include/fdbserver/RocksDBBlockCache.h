@@ -0,0 +1,42 @@
+/*
+ * RocksDBBlockCache.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBSERVER_ROCKSDBBLOCKCACHE_H
+#define FDBSERVER_ROCKSDBBLOCKCACHE_H
+#pragma once
+
+#ifdef WITH_ROCKSDB
+#include <memory>
+
+#include <rocksdb/cache.h>
+
+// Returns a block cache of the given capacity for the RocksDB storage engines.
+//
+// With ROCKSDB_BLOCK_CACHE_HYPER_CLOCK the cache is a HyperClockCache, whose lookups don't take the per shard mutexes
+// of an LRUCache, so that many reader threads hitting the same hot blocks don't serialize. It has no priority pools,
+// so highPriPoolRatio only applies to an LRUCache.
+//
+// With ROCKSDB_COMPRESSED_SECONDARY_CACHE_SIZE the cache is backed by a compressed secondary cache in memory, which
+// holds blocks evicted from it at their compressed size, so that a working set larger than the block cache is still
+// mostly read without going to disk.
+std::shared_ptr<rocksdb::Cache> newRocksDBBlockCache(size_t capacity, double highPriPoolRatio);
+
+#endif // WITH_ROCKSDB
+#endif
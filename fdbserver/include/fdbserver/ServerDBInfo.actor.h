@@ -99,15 +99,34 @@ struct ServerDBInfo {
 };
 using AsyncVar_ServerDBInfo = AsyncVar<ServerDBInfo>;
 
+// The fields of ServerDBInfo that are large and change much less often than the rest, which
+// UpdateServerDBInfoRequest leaves out when they are unchanged
+enum ServerDBInfoField : uint8_t {
+	DBINFO_FIELD_CLIENT = 1 << 0,
+	DBINFO_FIELD_LOG_SYSTEM_CONFIG = 1 << 1,
+	DBINFO_FIELD_RESOLVERS = 1 << 2,
+	DBINFO_FIELD_PRIOR_COMMITTED_LOG_SERVERS = 1 << 3,
+};
+
+// Clears the fields of info that are the same in base, and returns them as a set of ServerDBInfoField
+uint8_t clearUnchangedDBInfoFields(ServerDBInfo& info, ServerDBInfo const& base);
+
+// Copies the fields cleared by clearUnchangedDBInfoFields() back from base
+void restoreUnchangedDBInfoFields(ServerDBInfo& info, ServerDBInfo const& base, uint8_t unchangedFields);
+
 struct UpdateServerDBInfoRequest {
 	constexpr static FileIdentifier file_identifier = 9467438;
 	Standalone<StringRef> serializedDbInfo;
 	std::vector<Endpoint> broadcastInfo;
 	ReplyPromise<std::vector<Endpoint>> reply;
+	// If valid, serializedDbInfo is a delta: the fields in unchangedFields were cleared from it and are the same as in
+	// the ServerDBInfo with this id. Workers which don't have that ServerDBInfo reply that they weren't updated.
+	UID deltaBaseID;
+	uint8_t unchangedFields = 0;
 
 	template <class Ar>
 	void serialize(Ar& ar) {
-		serializer(ar, serializedDbInfo, broadcastInfo, reply);
+		serializer(ar, serializedDbInfo, broadcastInfo, reply, deltaBaseID, unchangedFields);
 	}
 };
 
@@ -61,6 +61,9 @@ Future<StatusReply> clusterGetStatus(
 
 StatusReply clusterGetFaultToleranceStatus(const std::string& statusString);
 
+// Returns the status document with only the top level fields listed in statusField, separated by commas
+StatusReply clusterGetStatusSections(const std::string& statusString, const std::string& statusField);
+
 struct WorkerEvents : std::map<NetworkAddress, TraceEventFields> {};
 ACTOR Future<Optional<std::pair<WorkerEvents, std::set<std::string>>>> latestEventOnWorkers(
     std::vector<WorkerDetails> workers,
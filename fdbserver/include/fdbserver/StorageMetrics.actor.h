@@ -30,6 +30,7 @@
 #include "fdbclient/StorageServerInterface.h"
 #include "fdbclient/KeyRangeMap.h"
 #include "fdbserver/Knobs.h"
+#include "flow/PackedIndexedSet.h"
 #include "flow/actorcompiler.h"
 
 const StringRef STORAGESERVER_HISTOGRAM_GROUP = "StorageServer"_sr;
@@ -50,7 +51,7 @@ const StringRef SS_READ_RANGE_BYTES_LIMIT_HISTOGRAM = "SSReadRangeBytesLimit"_sr
 const StringRef SS_READ_RANGE_KV_PAIRS_RETURNED_HISTOGRAM = "SSReadRangeKVPairsReturned"_sr;
 
 struct StorageMetricSample {
-	IndexedSet<Key, int64_t> sample;
+	PackedIndexedSet sample;
 	int64_t metricUnitsPerSample;
 
 	explicit StorageMetricSample(int64_t metricUnitsPerSample) : metricUnitsPerSample(metricUnitsPerSample) {}
@@ -240,6 +241,33 @@ public:
 	// void sendErrorWithPenalty(const ReplyPromise<Reply>& promise, const Error& err, double penalty);
 };
 
+// Rather than registering each shard in waitMetricsMap, polls the metrics of the shards, which costs less for the many
+// shards a data distributor tracks on one storage server
+ACTOR template <class ServiceType>
+Future<Void> waitShardMetrics(ServiceType* self, WaitShardMetricsRequest req) {
+	state Future<Void> timeout = delayJittered(SERVER_KNOBS->STORAGE_METRIC_TIMEOUT);
+	loop {
+		bool timedOut = timeout.isReady();
+		WaitShardMetricsReply reply;
+		for (int i = 0; i < req.keys.size(); i++) {
+			if (!self->isReadable(req.keys[i])) {
+				reply.wrongShard.push_back(i);
+				continue;
+			}
+			StorageMetrics metrics = self->metrics.getMetrics(req.keys[i]);
+			if (timedOut || !req.min[i].allLessOrEqual(metrics) || !metrics.allLessOrEqual(req.max[i])) {
+				reply.changed.push_back(i);
+				reply.metrics.push_back(metrics);
+			}
+		}
+		if (!reply.changed.empty() || !reply.wrongShard.empty()) {
+			req.reply.send(reply);
+			return Void();
+		}
+		wait(delay(SERVER_KNOBS->STORAGE_SHARD_METRICS_POLL_INTERVAL) || timeout);
+	}
+}
+
 ACTOR template <class ServiceType>
 Future<Void> serveStorageMetricsRequests(ServiceType* self, StorageServerInterface ssi) {
 	state Future<Void> doPollMetrics = Void();
@@ -253,6 +281,13 @@ Future<Void> serveStorageMetricsRequests(ServiceType* self, StorageServerInterfa
 					self->addActor(self->waitMetricsTenantAware(req));
 				}
 			}
+			when(WaitShardMetricsRequest req = waitNext(ssi.waitShardMetrics.getFuture())) {
+				if (req.keys.size() != req.min.size() || req.keys.size() != req.max.size()) {
+					req.reply.sendError(client_invalid_operation());
+				} else {
+					self->addActor(waitShardMetrics(self, req));
+				}
+			}
 			when(SplitMetricsRequest req = waitNext(ssi.splitMetrics.getFuture())) {
 				if (!self->isReadable(req.keys)) {
 					CODE_PROBE(true, "splitMetrics immediate wrong_shard_server()");
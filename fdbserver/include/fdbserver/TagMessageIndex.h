@@ -0,0 +1,249 @@
+/*
+ * TagMessageIndex.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBSERVER_TAGMESSAGEINDEX_H
+#define FDBSERVER_TAGMESSAGEINDEX_H
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+
+#include "fdbserver/LogSystem.h"
+#include "flow/FastAlloc.h"
+
+// The messages of one tag in a TLog's memory, in version order, each a version and a pointer into one of the TLog's
+// message blocks. Instead of a std::deque of (Version, LengthPrefixedStringRef) pairs, which takes 16 bytes per message
+// and then some, the messages are packed into blocks from the fast allocator's pools. An entry is a 32 bit version
+// delta from its block's first version and a 32 bit offset from its block's first message, so a block only holds the
+// messages close enough to its first one. Blocks grow from MIN_BLOCK_BYTES to MAX_BLOCK_BYTES while they fill up and
+// shrink for tags whose messages are far apart, so a full block costs about 8 bytes per message and a sparse tag
+// doesn't hold a large block for a few messages.
+//
+// Iterators stay valid as messages are appended and as messages before them are popped.
+class TagMessageIndex : NonCopyable {
+	struct Entry {
+		uint32_t versionDelta;
+		uint32_t offset;
+	};
+
+	struct Block {
+		Version baseVersion;
+		uintptr_t base;
+		uint16_t count; // including the popped entries of the front block
+		uint16_t capacity;
+		int blockBytes;
+
+		Entry* entries() { return reinterpret_cast<Entry*>(this + 1); }
+		const Entry* entries() const { return reinterpret_cast<const Entry*>(this + 1); }
+		Version version(int i) const { return baseVersion + entries()[i].versionDelta; }
+		LengthPrefixedStringRef message(int i) const {
+			return LengthPrefixedStringRef(reinterpret_cast<uint32_t*>(base + entries()[i].offset));
+		}
+	};
+
+public:
+	static constexpr int MIN_BLOCK_BYTES = 64;
+	static constexpr int MAX_BLOCK_BYTES = 1024;
+
+	class iterator {
+	public:
+		iterator() : index(nullptr), block(0), entry(0) {}
+
+		Version version() const { return getBlock()->version(entry); }
+		LengthPrefixedStringRef message() const { return getBlock()->message(entry); }
+
+		iterator& operator++() {
+			if (++entry == getBlock()->count) {
+				++block;
+				entry = 0;
+			}
+			return *this;
+		}
+		bool operator==(const iterator& r) const { return block == r.block && entry == r.entry; }
+		bool operator!=(const iterator& r) const { return !(*this == r); }
+
+	private:
+		friend class TagMessageIndex;
+		iterator(const TagMessageIndex* index, int64_t block, int entry) : index(index), block(block), entry(entry) {}
+		const Block* getBlock() const { return index->blocks[block - index->firstBlock]; }
+
+		const TagMessageIndex* index;
+		int64_t block; // Numbered from the first block the index ever had, so popping doesn't move it
+		int entry;
+	};
+
+	TagMessageIndex() = default;
+	TagMessageIndex(TagMessageIndex&& r) noexcept { swap(r); }
+	TagMessageIndex& operator=(TagMessageIndex&& r) noexcept {
+		TagMessageIndex empty;
+		swap(empty);
+		swap(r);
+		return *this;
+	}
+	~TagMessageIndex() {
+		for (Block* b : blocks) {
+			freeBlock(b);
+		}
+	}
+
+	bool empty() const { return numMessages == 0; }
+	size_t size() const { return numMessages; }
+	// The bytes of the blocks holding the messages
+	int64_t allocatedBytes() const { return bytes; }
+
+	Version frontVersion() const { return blocks.front()->version(frontEntry); }
+	LengthPrefixedStringRef frontMessage() const { return blocks.front()->message(frontEntry); }
+	Version backVersion() const { return blocks.back()->version(blocks.back()->count - 1); }
+	LengthPrefixedStringRef backMessage() const { return blocks.back()->message(blocks.back()->count - 1); }
+
+	// Versions must not decrease
+	void push_back(Version version, LengthPrefixedStringRef message) {
+		const uintptr_t p = reinterpret_cast<uintptr_t>(message.getLengthPtr());
+		Block* b = blocks.empty() ? nullptr : blocks.back();
+		if (b == nullptr || b->count == b->capacity || !fits(b, version, p)) {
+			b = newBlock(b, version, p);
+		}
+		b->entries()[b->count++] = { static_cast<uint32_t>(version - b->baseVersion),
+			                         static_cast<uint32_t>(p - b->base) };
+		++numMessages;
+	}
+
+	void pop_front() {
+		--numMessages;
+		if (++frontEntry == blocks.front()->count) {
+			bytes -= blocks.front()->blockBytes;
+			freeBlock(blocks.front());
+			blocks.pop_front();
+			++firstBlock;
+			frontEntry = 0;
+		}
+	}
+
+	iterator begin() const { return empty() ? end() : iterator(this, firstBlock, frontEntry); }
+	iterator end() const { return iterator(this, firstBlock + blocks.size(), 0); }
+
+	// The first message with a version >= version
+	iterator lowerBound(Version version) const { return bound(version, false); }
+	// The first message with a version > version
+	iterator upperBound(Version version) const { return bound(version, true); }
+
+private:
+	static bool fits(const Block* b, Version version, uintptr_t p) {
+		return version >= b->baseVersion && version - b->baseVersion <= std::numeric_limits<uint32_t>::max() &&
+		       p >= b->base && p - b->base <= std::numeric_limits<uint32_t>::max();
+	}
+
+	static int capacityOf(int blockBytes) { return (blockBytes - sizeof(Block)) / sizeof(Entry); }
+
+	// The next block holds twice as many messages as the last one did before it had to be replaced
+	Block* newBlock(const Block* last, Version version, uintptr_t p) {
+		int blockBytes = MIN_BLOCK_BYTES;
+		const int wanted = last ? 2 * last->count : 0;
+		while (blockBytes < MAX_BLOCK_BYTES && capacityOf(blockBytes) < wanted) {
+			blockBytes *= 2;
+		}
+		Block* b = static_cast<Block*>(allocateBlock(blockBytes));
+		b->baseVersion = version;
+		b->base = p;
+		b->count = 0;
+		b->capacity = capacityOf(blockBytes);
+		b->blockBytes = blockBytes;
+		blocks.push_back(b);
+		bytes += blockBytes;
+		return b;
+	}
+
+	static void* allocateBlock(int blockBytes) {
+		switch (blockBytes) {
+		case 64:
+			return FastAllocator<64>::allocate();
+		case 128:
+			return FastAllocator<128>::allocate();
+		case 256:
+			return FastAllocator<256>::allocate();
+		case 512:
+			return FastAllocator<512>::allocate();
+		default:
+			ASSERT(blockBytes == 1024);
+			return FastAllocator<1024>::allocate();
+		}
+	}
+
+	static void freeBlock(Block* b) {
+		switch (b->blockBytes) {
+		case 64:
+			return FastAllocator<64>::release(b);
+		case 128:
+			return FastAllocator<128>::release(b);
+		case 256:
+			return FastAllocator<256>::release(b);
+		case 512:
+			return FastAllocator<512>::release(b);
+		default:
+			return FastAllocator<1024>::release(b);
+		}
+	}
+
+	iterator bound(Version version, bool strict) const {
+		auto before = [version, strict](Version v) { return strict ? v <= version : v < version; };
+		// The first block whose last message isn't before version
+		size_t lo = 0, hi = blocks.size();
+		while (lo < hi) {
+			const size_t mid = (lo + hi) / 2;
+			if (before(blocks[mid]->version(blocks[mid]->count - 1))) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		if (lo == blocks.size()) {
+			return end();
+		}
+		const Block* b = blocks[lo];
+		int first = lo == 0 ? frontEntry : 0;
+		int last = b->count;
+		while (first < last) {
+			const int mid = (first + last) / 2;
+			if (before(b->version(mid))) {
+				first = mid + 1;
+			} else {
+				last = mid;
+			}
+		}
+		return iterator(this, firstBlock + lo, first);
+	}
+
+	void swap(TagMessageIndex& r) {
+		std::swap(blocks, r.blocks);
+		std::swap(firstBlock, r.firstBlock);
+		std::swap(frontEntry, r.frontEntry);
+		std::swap(numMessages, r.numMessages);
+		std::swap(bytes, r.bytes);
+	}
+
+	std::deque<Block*> blocks;
+	int64_t firstBlock = 0; // The number of blocks popped
+	int frontEntry = 0; // The first entry of the front block which hasn't been popped
+	size_t numMessages = 0;
+	int64_t bytes = 0;
+};
+
+#endif
@@ -24,6 +24,15 @@
 #include "fdbclient/StorageServerInterface.h"
 #include "fdbclient/TagThrottle.actor.h"
 
+// Work the storage engine did to serve a read, which can be much more than the bytes returned to the client, e.g. for a
+// range read over many cleared or not yet visible rows
+struct ReadEngineCost {
+	// Logical bytes read from the engine
+	int64_t bytesScanned = 0;
+	// Calls into the engine, each of which costs at least a page lookup
+	int reads = 0;
+};
+
 class TransactionTagCounter {
 	PImpl<class TransactionTagCounterImpl> impl;
 
@@ -33,6 +42,7 @@ public:
 
 	// Update counters tracking the busyness of each tag in the current interval
 	void addRequest(Optional<TagSet> const& tags, int64_t bytes);
+	void addRequest(Optional<TagSet> const& tags, int64_t bytes, ReadEngineCost const& engineCost);
 
 	// Save current set of busy tags and reset counters for next interval
 	void startNewInterval();
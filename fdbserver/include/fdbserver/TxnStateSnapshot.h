@@ -0,0 +1,47 @@
+/*
+ * TxnStateSnapshot.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FDBSERVER_TXNSTATESNAPSHOT_H
+#define FDBSERVER_TXNSTATESNAPSHOT_H
+#pragma once
+
+#include "fdbclient/FDBTypes.h"
+#include "flow/Arena.h"
+#include "flow/CompressionUtils.h"
+
+// The encoding of the key-values of a TxnStateRequest, which recovery uses to send the txnStateStore to the commit
+// proxies and resolvers. Each part holds a sorted range of the store, whose keys mostly share long prefixes (e.g.,
+// \xff/keyServers/, \xff/serverKeys/<UID>/), so each key is stored as the length of the prefix it shares with the
+// previous key and its remaining suffix. The snapshot is
+//
+//   filter (uint8_t) | compressed( count (uint32_t) | [shared (uint32_t) | suffix | value]... )
+//
+// where suffix and value are each a uint32_t length followed by the bytes.
+
+// Returns the encoding of data compressed with filter. Keys are encoded in their order in data.
+Standalone<StringRef> encodeTxnStateSnapshot(VectorRef<KeyValueRef> data, CompressionFilter filter);
+
+// Returns the key-values encoded in snapshot. The result is allocated in arena.
+VectorRef<KeyValueRef> decodeTxnStateSnapshot(StringRef snapshot, Arena& arena);
+
+// Returns the filter to compress txnStateStore snapshots with, set by TXN_STATE_SNAPSHOT_COMPRESSION_FILTER
+CompressionFilter getTxnStateSnapshotCompressionFilter();
+
+#endif
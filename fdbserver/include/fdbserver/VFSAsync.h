@@ -88,6 +88,13 @@ struct VFSAsyncFile {
 
 	int chunkSize;
 
+	// Pages are read ahead into the page cache while SQLite reads forward through the database file, as B-tree scans
+	// do, so that a scan doesn't wait on one page read at a time
+	int64_t readAheadNextOffset; // Offset just past the last page read
+	int readAheadForwardReads; // Number of consecutive page reads that moved forward through the file
+	int64_t readAheadEnd; // Offset just past the last page read ahead
+	Future<Void> readAhead;
+
 	VFSAsyncFile(std::string const& filename, int flags);
 	~VFSAsyncFile();
 
@@ -21,7 +21,6 @@
 #ifndef ART_IMPL_H
 #define ART_IMPL_H
 
-using art_tree = VersionedBTree::art_tree;
 using art_leaf = art_tree::art_leaf;
 #define art_node art_tree::art_node
 
@@ -38,7 +37,7 @@ int art_tree::node_sizes[] = { 0,
 	                           sizeof(art_node48_kv),
 	                           sizeof(art_node256_kv) };
 
-VersionedBTree::art_iterator art_tree::insert(KeyRef& k, void* value) {
+art_iterator art_tree::insert(KeyRef& k, void* value) {
 #define INIT_DEPTH 0
 #define REPLACE 1
 	int old_val = 0;
@@ -46,19 +45,19 @@ VersionedBTree::art_iterator art_tree::insert(KeyRef& k, void* value) {
 
 	if (!old_val)
 		this->size++;
-	return VersionedBTree::art_iterator(l);
+	return art_iterator(l);
 }
 
-VersionedBTree::art_iterator art_tree::insert_if_absent(KeyRef& k, void* value, int* existing) {
+art_iterator art_tree::insert_if_absent(KeyRef& k, void* value, int* existing) {
 #define INIT_DEPTH 0
 #define DONTREPLACE 0
 	art_leaf* l = iterative_insert(this->root, &this->root, k, value, INIT_DEPTH, existing, DONTREPLACE);
 	if (!existing)
 		this->size++;
-	return VersionedBTree::art_iterator(l);
+	return art_iterator(l);
 }
 
-VersionedBTree::art_iterator art_tree::lower_bound(const KeyRef& key) {
+art_iterator art_tree::lower_bound(const KeyRef& key) {
 	if (!size)
 		return art_iterator(nullptr);
 	art_node* n = root;
@@ -70,7 +69,7 @@ VersionedBTree::art_iterator art_tree::lower_bound(const KeyRef& key) {
 	return art_iterator(res);
 }
 
-VersionedBTree::art_iterator art_tree::upper_bound(const KeyRef& key) {
+art_iterator art_tree::upper_bound(const KeyRef& key) {
 	if (!size)
 		return art_iterator(nullptr);
 	art_node* n = root;
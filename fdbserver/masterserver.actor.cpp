@@ -130,24 +130,10 @@ SWIFT_ACTOR Future<Void> getVersionSwift(Reference<MasterData> self, GetCommitVe
 }
 #endif
 
-ACTOR Future<Void> getVersionCxx(Reference<MasterData> self, GetCommitVersionRequest req) {
-	state Span span("M:getVersion"_loc, req.spanContext);
-	state std::map<UID, CommitProxyVersionReplies>::iterator proxyItr =
-	    self->lastCommitProxyVersionReplies.find(req.requestingProxy); // lastCommitProxyVersionReplies never changes
-
-	++self->getCommitVersionRequests;
-
-	if (proxyItr == self->lastCommitProxyVersionReplies.end()) {
-		// Request from invalid proxy (e.g. from duplicate recruitment request)
-		req.reply.send(Never());
-		return Void();
-	}
-
-	CODE_PROBE(proxyItr->second.latestRequestNum.get() < req.requestNum - 1,
-	           "Commit version request queued up",
-	           probe::decoration::rare);
-	wait(proxyItr->second.latestRequestNum.whenAtLeast(req.requestNum - 1));
-
+// Replies to req, whose proxy has had replies to all of its earlier requests
+void replyToCommitVersionRequest(MasterData* self,
+                                 std::map<UID, CommitProxyVersionReplies>::iterator proxyItr,
+                                 GetCommitVersionRequest const& req) {
 	auto itr = proxyItr->second.replies.find(req.requestNum);
 	if (itr != proxyItr->second.replies.end()) {
 		CODE_PROBE(true, "Duplicate request for sequence");
@@ -213,7 +199,30 @@ ACTOR Future<Void> getVersionCxx(Reference<MasterData> self, GetCommitVersionReq
 		ASSERT(proxyItr->second.latestRequestNum.get() == req.requestNum - 1);
 		proxyItr->second.latestRequestNum.set(req.requestNum);
 	}
+}
+
+ACTOR Future<Void> getVersionCxx(Reference<MasterData> self, GetCommitVersionRequest req) {
+	state Span span("M:getVersion"_loc, req.spanContext);
+	state std::map<UID, CommitProxyVersionReplies>::iterator proxyItr =
+	    self->lastCommitProxyVersionReplies.find(req.requestingProxy); // lastCommitProxyVersionReplies never changes
+	state double queueStart = now();
+
+	++self->getCommitVersionRequests;
+
+	if (proxyItr == self->lastCommitProxyVersionReplies.end()) {
+		// Request from invalid proxy (e.g. from duplicate recruitment request)
+		req.reply.send(Never());
+		return Void();
+	}
 
+	if (proxyItr->second.latestRequestNum.get() < req.requestNum - 1) {
+		CODE_PROBE(true, "Commit version request queued up", probe::decoration::rare);
+		++self->queuedCommitVersionRequests;
+		wait(proxyItr->second.latestRequestNum.whenAtLeast(req.requestNum - 1));
+	}
+	self->commitVersionQueueTime->addMeasurement(now() - queueStart);
+
+	replyToCommitVersionRequest(self.getPtr(), proxyItr, req);
 	return Void();
 }
 
@@ -263,7 +272,8 @@ MasterData::MasterData(Reference<AsyncVar<ServerDBInfo> const> const& dbInfo,
     getLiveCommittedVersionRequests("GetLiveCommittedVersionRequests", cc),
     reportLiveCommittedVersionRequests("ReportLiveCommittedVersionRequests", cc),
     waitForPrevCommitRequests("WaitForPrevCommitRequests", cc),
-    nonWaitForPrevCommitRequests("NonWaitForPrevCommitRequests", cc), addActor(addActor) {
+    nonWaitForPrevCommitRequests("NonWaitForPrevCommitRequests", cc),
+    queuedCommitVersionRequests("QueuedCommitVersionRequests", cc), addActor(addActor) {
 	logger = cc.traceCounters("MasterMetrics", dbgid, SERVER_KNOBS->WORKER_LOGGING_INTERVAL, "MasterMetrics");
 	if (forceRecovery && !myInterface.locality.dcId().present()) {
 		TraceEvent(SevError, "ForcedRecoveryRequiresDcID").log();
@@ -271,6 +281,10 @@ MasterData::MasterData(Reference<AsyncVar<ServerDBInfo> const> const& dbInfo,
 	}
 	balancer = resolutionBalancer.resolutionBalancing();
 	locality = tagLocalityInvalid;
+	commitVersionQueueTime = std::make_unique<LatencySample>("GetCommitVersionQueueTime",
+	                                                         dbgid,
+	                                                         SERVER_KNOBS->LATENCY_METRICS_LOGGING_INTERVAL,
+	                                                         SERVER_KNOBS->LATENCY_SKETCH_ACCURACY);
 
 	if (SERVER_KNOBS->ENABLE_VERSION_VECTOR) {
 		versionVectorTagUpdates = std::make_unique<LatencySample>("VersionVectorTagUpdates",
@@ -307,7 +321,19 @@ ACTOR Future<Void> provideVersionsCxx(Reference<MasterData> self) {
 
 	loop choose {
 		when(GetCommitVersionRequest req = waitNext(self->myInterface.getCommitVersion.getFuture())) {
-			versionActors.add(getVersion(self, req));
+			// A request that doesn't have to wait for earlier ones of its proxy, which is nearly every request, is
+			// answered right away rather than by an actor of its own. All the requests arriving in a tick then get
+			// consecutive versions from one pass over them.
+			auto proxyItr = self->lastCommitProxyVersionReplies.find(req.requestingProxy);
+			if (proxyItr != self->lastCommitProxyVersionReplies.end() &&
+			    proxyItr->second.latestRequestNum.get() >= req.requestNum - 1) {
+				Span span("M:getVersion"_loc, req.spanContext);
+				++self->getCommitVersionRequests;
+				self->commitVersionQueueTime->addMeasurement(0);
+				replyToCommitVersionRequest(self.getPtr(), proxyItr, req);
+			} else {
+				versionActors.add(getVersion(self, req));
+			}
 		}
 		when(wait(versionActors.getResult())) {}
 	}
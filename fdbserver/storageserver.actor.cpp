@@ -51,6 +51,8 @@
 #include "flow/Util.h"
 #include "fdbclient/Atomic.h"
 #include "fdbclient/AuditUtils.actor.h"
+#include "fdbclient/BackupAgent.actor.h"
+#include "fdbclient/BackupContainer.h"
 #include "fdbclient/BlobConnectionProvider.h"
 #include "fdbclient/BlobGranuleReader.actor.h"
 #include "fdbclient/CommitProxyInterface.h"
@@ -73,6 +75,7 @@
 #include "fdbserver/AccumulativeChecksumUtil.h"
 #include "fdbserver/DataDistribution.actor.h"
 #include "fdbserver/FDBExecHelper.actor.h"
+#include "fdbserver/HotValueCache.h"
 #include "fdbclient/GetEncryptCipherKeys.h"
 #include "fdbserver/IKeyValueStore.h"
 #include "fdbserver/Knobs.h"
@@ -91,6 +94,7 @@
 #include "fdbserver/StorageMetrics.actor.h"
 #include "fdbserver/TLogInterface.h"
 #include "fdbserver/TransactionTagCounter.h"
+#include "fdbserver/ReadResourceCounter.h"
 #include "fdbserver/WaitFailure.h"
 #include "fdbserver/WorkerInterface.actor.h"
 #include "fdbserver/BlobGranuleServerCommon.actor.h"
@@ -108,6 +112,7 @@
 #include "flow/Trace.h"
 #include "flow/Util.h"
 #include "flow/genericactors.actor.h"
+#include "flow/xxhash.h"
 
 #include "flow/actorcompiler.h" // This must be the last #include.
 
@@ -145,6 +150,7 @@ bool canReplyWith(Error e) {
 	case error_code_watch_cancelled:
 	case error_code_unknown_change_feed:
 	case error_code_server_overloaded:
+	case error_code_read_deadline_exceeded:
 	case error_code_change_feed_popped:
 	case error_code_tenant_name_required:
 	case error_code_tenant_removed:
@@ -557,7 +563,8 @@ public:
 };
 
 struct StorageServerDisk {
-	explicit StorageServerDisk(struct StorageServer* data, IKeyValueStore* storage) : data(data), storage(storage) {}
+	explicit StorageServerDisk(struct StorageServer* data, IKeyValueStore* storage)
+	  : hotValues(SERVER_KNOBS->HOT_VALUE_CACHE_BYTES), data(data), storage(storage) {}
 
 	IKeyValueStore* getKeyValueStore() const { return this->storage; }
 
@@ -582,11 +589,15 @@ struct StorageServerDisk {
 		return storage->addRange(range, id, !SERVER_KNOBS->SHARDED_ROCKSDB_DELAY_COMPACTION_FOR_DATA_MOVE);
 	}
 
-	std::vector<std::string> removeRange(KeyRangeRef range) { return storage->removeRange(range); }
+	std::vector<std::string> removeRange(KeyRangeRef range) {
+		hotValues.invalidate(range);
+		return storage->removeRange(range);
+	}
 
 	void markRangeAsActive(KeyRangeRef range) { storage->markRangeAsActive(range); }
 
 	Future<Void> replaceRange(KeyRange range, Standalone<VectorRef<KeyValueRef>> data) {
+		hotValues.invalidate(range);
 		return storage->replaceRange(range, data);
 	}
 
@@ -597,7 +608,13 @@ struct StorageServerDisk {
 	Future<Void> getError() { return storage->getError(); }
 	Future<Void> init() { return storage->init(); }
 	Future<Void> canCommit() { return storage->canCommit(); }
-	Future<Void> commit() { return storage->commit(); }
+	Future<Void> commit() {
+		const uint64_t hotValuesToken = hotValues.beginCommit();
+		return map(storage->commit(), [this, hotValuesToken](Void) {
+			hotValues.committed(hotValuesToken);
+			return Void();
+		});
+	}
 
 	void logRecentRocksDBBackgroundWorkStats(UID ssId, std::string logReason) {
 		return storage->logRecentRocksDBBackgroundWorkStats(ssId, logReason);
@@ -623,6 +640,11 @@ struct StorageServerDisk {
 		++(*kvGets);
 		return storage->readValuePrefix(key, maxLength, options);
 	}
+	Future<std::vector<Optional<Value>>> readValuePrefixes(std::vector<std::pair<KeyRef, int>> const& keys,
+	                                                       Optional<ReadOptions> options = Optional<ReadOptions>()) {
+		(*kvGets) += keys.size();
+		return storage->readValuePrefixes(keys, options);
+	}
 	Future<RangeResult> readRange(KeyRangeRef keys,
 	                              int rowLimit = 1 << 30,
 	                              int byteLimit = 1 << 30,
@@ -630,14 +652,60 @@ struct StorageServerDisk {
 		++(*kvScans);
 		return storage->readRange(keys, rowLimit, byteLimit, options);
 	}
+	Future<RangeResult> readKeys(KeyRangeRef keys,
+	                             int rowLimit = 1 << 30,
+	                             int byteLimit = 1 << 30,
+	                             Optional<ReadOptions> options = Optional<ReadOptions>()) {
+		++(*kvScans);
+		return storage->readKeys(keys, rowLimit, byteLimit, options);
+	}
+
+	int64_t pinSnapshot() { return storage->pinSnapshot(); }
+	void unpinSnapshot(int64_t snapshot) { storage->unpinSnapshot(snapshot); }
+	Future<Optional<Value>> readValueAtSnapshot(int64_t snapshot,
+	                                            KeyRef key,
+	                                            Optional<ReadOptions> options = Optional<ReadOptions>()) {
+		++(*kvGets);
+		return storage->readValueAtSnapshot(snapshot, key, options);
+	}
+	Future<RangeResult> readRangeAtSnapshot(int64_t snapshot,
+	                                        KeyRangeRef keys,
+	                                        int rowLimit = 1 << 30,
+	                                        int byteLimit = 1 << 30,
+	                                        Optional<ReadOptions> options = Optional<ReadOptions>()) {
+		++(*kvScans);
+		return storage->readRangeAtSnapshot(snapshot, keys, rowLimit, byteLimit, options);
+	}
+
+	bool keepsVersions() const { return storage->keepsVersions(); }
+	void setWriteVersion(Version version) { storage->setWriteVersion(version); }
+	void setOldestReadableVersion(Version version) { storage->setOldestReadableVersion(version); }
+	Future<Optional<Value>> readValueAtVersion(Version version,
+	                                           KeyRef key,
+	                                           Optional<ReadOptions> options = Optional<ReadOptions>()) {
+		++(*kvGets);
+		return storage->readValueAtVersion(version, key, options);
+	}
+	Future<RangeResult> readRangeAtVersion(Version version,
+	                                       KeyRangeRef keys,
+	                                       int rowLimit = 1 << 30,
+	                                       int byteLimit = 1 << 30,
+	                                       Optional<ReadOptions> options = Optional<ReadOptions>()) {
+		++(*kvScans);
+		return storage->readRangeAtVersion(version, keys, rowLimit, byteLimit, options);
+	}
 
 	Future<CheckpointMetaData> checkpoint(const CheckpointRequest& request) { return storage->checkpoint(request); }
 
-	Future<Void> restore(const std::vector<CheckpointMetaData>& checkpoints) { return storage->restore(checkpoints); }
+	Future<Void> restore(const std::vector<CheckpointMetaData>& checkpoints) {
+		hotValues.invalidateAll();
+		return storage->restore(checkpoints);
+	}
 
 	Future<Void> restore(const std::string& shardId,
 	                     const std::vector<KeyRange>& ranges,
 	                     const std::vector<CheckpointMetaData>& checkpoints) {
+		hotValues.invalidateAll();
 		return storage->restore(shardId, ranges, checkpoints);
 	}
 
@@ -648,9 +716,14 @@ struct StorageServerDisk {
 	KeyValueStoreType getKeyValueStoreType() const { return storage->getType(); }
 	StorageBytes getStorageBytes() const { return storage->getStorageBytes(); }
 	std::tuple<size_t, size_t, size_t> getSize() const { return storage->getSize(); }
+	std::pair<int64_t, int64_t> getLazyClearProgress() const { return storage->getLazyClearProgress(); }
+	int64_t getCompactionDebt() const { return storage->getCompactionDebt(); }
 
 	Future<EncryptionAtRestMode> encryptionMode() { return storage->encryptionMode(); }
 
+	// Values of hot keys as they are in the storage engine, kept in step with the writes made through this class
+	HotValueCache hotValues;
+
 	// The following are pointers to the Counters in StorageServer::counters of the same names.
 	Counter* kvCommitLogicalBytes;
 	Counter* kvClearRanges;
@@ -844,6 +917,45 @@ struct ChangeFeedInfo : ReferenceCounted<ChangeFeedInfo> {
 	}
 };
 
+// The versions of the reads in progress on a storage server.  Under memory pressure versions are discarded early, but
+// not those a read in progress may still need.
+struct ActiveReadVersions : ReferenceCounted<ActiveReadVersions> {
+	// Registers a read at a version for as long as it is alive
+	class Read : NonCopyable {
+	public:
+		Read() = default;
+		Read(Reference<ActiveReadVersions> reads, Version version) : reads(reads) {
+			i = reads->counts.emplace(version, 0).first;
+			++i->second;
+		}
+		Read(Read&& r) noexcept : reads(std::move(r.reads)), i(r.i) {}
+		Read& operator=(Read&& r) noexcept {
+			release();
+			reads = std::move(r.reads);
+			i = r.i;
+			return *this;
+		}
+		~Read() { release(); }
+
+	private:
+		void release() {
+			if (reads.isValid() && --i->second == 0) {
+				reads->counts.erase(i);
+			}
+			reads.clear();
+		}
+
+		Reference<ActiveReadVersions> reads;
+		std::map<Version, int>::iterator i;
+	};
+
+	// The oldest version of a read in progress, or latestVersion if there are none
+	Version oldest() const { return counts.empty() ? latestVersion : counts.begin()->first; }
+
+private:
+	std::map<Version, int> counts;
+};
+
 class ServerWatchMetadata : public ReferenceCounted<ServerWatchMetadata> {
 public:
 	Key key;
@@ -1031,6 +1143,21 @@ public:
 	};
 
 	std::map<Version, std::vector<CheckpointMetaData>> pendingCheckpoints; // Pending checkpoint requests
+	// The storage engine's state at a version, pinned once the version is durable for reads with
+	// ReadOptions::longSnapshot that are older than the in-memory window
+	struct LongSnapshot {
+		int64_t engineSnapshot = -1; // Once pinned
+		Promise<Void> pinned;
+		uint64_t changeCounter = 0; // shardChangeCounter when it was registered
+	};
+	std::map<Version, LongSnapshot> longSnapshots;
+	bool longSnapshotsUnsupported = false; // The storage engine can't pin snapshots
+	// With a storage engine which keeps versions, reads older than the in-memory window are served by the engine from
+	// engineOldestVersion on. Such reads check that their shards haven't changed since against the shardChangeCounter
+	// as of their version, which is kept for the versions the shards changed at, from the last one before
+	// engineOldestVersion on.
+	Version engineOldestVersion = 0;
+	std::map<Version, uint64_t> shardChangeCounters;
 	std::unordered_map<UID, CheckpointMetaData> checkpoints; // Existing and deleting checkpoints
 	std::unordered_map<UID, ICheckpointReader*> liveCheckpointReaders; // Active checkpoint readers
 	VersionedMap<int64_t, TenantSSInfo> tenantMap;
@@ -1082,6 +1209,8 @@ public:
 	KeyRef setWatchMetadata(Reference<ServerWatchMetadata> metadata);
 	void deleteWatchMetadata(KeyRef key, int64_t tenantId);
 	void clearWatchMetadata();
+	void triggerPendingWatches();
+	void applyPendingSets();
 
 	// tenant map operations
 	void insertTenant(TenantMapEntry const& tenant, Version version, bool persist);
@@ -1303,6 +1432,8 @@ public:
 	NotifiedVersion version;
 	NotifiedVersion desiredOldestVersion; // We can increase oldestVersion (and then durableVersion) to this version
 	                                      // when the disk permits
+	Reference<ActiveReadVersions> activeReads = makeReference<ActiveReadVersions>();
+	Version mvccWindowVersions = 0; // version - desiredOldestVersion as of the latest update, reported to Ratekeeper
 	NotifiedVersion oldestVersion; // See also storageVersion()
 	NotifiedVersion durableVersion; // At least this version will be readable from storage after a power failure
 	// In the event of the disk corruption, sqlite and redwood will either not recover, recover to durableVersion
@@ -1345,6 +1476,17 @@ public:
 	Future<Void> durableInProgress;
 
 	AsyncMap<Key, bool> watches;
+	// Keys set and ranges cleared by the mutations applied in the current update(), whose watches are triggered
+	// together by triggerPendingWatches() once all of them are applied. They refer to the mutation log, which keeps
+	// them at least until the versions that wrote them are durable.
+	std::vector<KeyRef> pendingWatchKeys;
+	std::vector<KeyRangeRef> pendingWatchRanges;
+	// Set mutations applied in the current update() but not yet inserted into versionedData, in the order they were
+	// applied. applyPendingSets() inserts them before anything else reads or changes the latest version, so they are
+	// all of one version and refer to its mutation log, pendingSetsArena.
+	std::vector<MutationRef> pendingSets;
+	Arena pendingSetsArena;
+	bool batchPendingSets = false;
 	AsyncMap<int64_t, bool> tenantWatches;
 	int64_t watchBytes;
 	int64_t numWatches;
@@ -1377,13 +1519,56 @@ public:
 	Reference<PriorityMultiLock> ssLock;
 	std::vector<int> readPriorityRanks;
 
-	Future<PriorityMultiLock::Lock> getReadLock(const Optional<ReadOptions>& options) {
+	// The longest queue wait of the reads of each ReadType since the last queuing metrics reply
+	std::vector<double> readLaneQueueWaits = std::vector<double>((int)ReadType::MAX + 1, 0.0);
+
+	static int readLane(const Optional<ReadOptions>& options) {
 		int readType = (int)(options.present() ? options.get().type : ReadType::NORMAL);
-		readType = std::clamp<int>(readType, 0, readPriorityRanks.size() - 1);
-		return ssLock->lock(readPriorityRanks[readType]);
+		return std::clamp<int>(readType, 0, (int)ReadType::MAX);
+	}
+
+	// Reads of each ReadType queue in their own priority of ssLock. Within it, a read is ordered by when it arrived
+	// plus the time its expected bytes take to read at STORAGESERVER_READ_EXPECTED_BYTES_PER_SECOND, so short reads go
+	// ahead of long ones that arrived shortly before them without starving them.
+	Future<PriorityMultiLock::Lock> getReadLock(const Optional<ReadOptions>& options, int64_t expectedBytes = 0) {
+		double order = SERVER_KNOBS->STORAGESERVER_READ_EXPECTED_BYTES_PER_SECOND > 0
+		                   ? now() + expectedBytes / SERVER_KNOBS->STORAGESERVER_READ_EXPECTED_BYTES_PER_SECOND
+		                   : 0;
+		return ssLock->lock(readPriorityRanks[readLane(options)], 1, order);
+	}
+
+	// The bytes expected to be read from [begin, end) with the given limit, according to the byte sample
+	int64_t expectedReadBytes(const TenantInfo& tenantInfo, KeyRef begin, KeyRef end, int limitBytes) const {
+		if (SERVER_KNOBS->STORAGESERVER_READ_EXPECTED_BYTES_PER_SECOND <= 0 || begin >= end) {
+			return 0;
+		}
+		Arena arena;
+		if (tenantInfo.prefix.present()) {
+			begin = begin.withPrefix(tenantInfo.prefix.get(), arena);
+			end = end.withPrefix(tenantInfo.prefix.get(), arena);
+		}
+		return std::min<int64_t>(std::max(limitBytes, 0), metrics.byteSample.getEstimate(KeyRangeRef(begin, end)));
+	}
+
+	void recordReadQueueWait(const Optional<ReadOptions>& options, double queueWait) {
+		counters.readQueueWaitSample.addMeasurement(queueWait);
+		double& laneWait = readLaneQueueWaits[readLane(options)];
+		laneWait = std::max(laneWait, queueWait);
+	}
+
+	// Drops a read that waited in the queue for longer than the budget its client gave it, rather than serve it late
+	void checkReadBudget(const Optional<ReadOptions>& options, double queueWait) {
+		if (options.present() && options.get().budget.present() && queueWait > options.get().budget.get()) {
+			++counters.readsPastBudget;
+			throw read_deadline_exceeded();
+		}
 	}
 
 	FlowLock serveAuditStorageParallelismLock;
+	// Replica audits don't track shard assignments, so more of them can run at once than of other audits
+	FlowLock serveAuditStorageReplicaParallelismLock;
+	// Shared by all audits of the server, so together they read at most AUDIT_STORAGE_RATE_PER_SERVER_MAX
+	Reference<IRateControl> auditStorageRateLimiter;
 
 	int64_t instanceID;
 
@@ -1411,6 +1596,7 @@ public:
 	}
 
 	TransactionTagCounter transactionTagCounter;
+	ReadResourceCounter readResourceCounter;
 	BusiestWriteTagContext busiestWriteTagContext;
 
 	Optional<LatencyBandConfig> latencyBandConfig;
@@ -1422,7 +1608,8 @@ public:
 
 		Counter allQueries, systemKeyQueries, getKeyQueries, getValueQueries, getRangeQueries, getRangeSystemKeyQueries,
 		    getRangeStreamQueries, lowPriorityQueries, rowsQueried, watchQueries, emptyQueries, feedRowsQueried,
-		    feedBytesQueried, feedStreamQueries, rejectedFeedStreamQueries, feedVersionQueries;
+		    feedBytesQueried, feedStreamQueries, rejectedFeedStreamQueries, feedVersionQueries, feedMultiStreamQueries,
+		    feedMultiStreamFeeds, readsPastBudget;
 
 		// counters related to getMappedRange queries
 		Counter getMappedRangeBytesQueried, finishedGetMappedRangeSecondaryQueries, getMappedRangeQueries,
@@ -1464,6 +1651,14 @@ public:
 		// means fallback if fallback is enabled, otherwise means failure (so that another layer could implement
 		// fallback).
 		Counter quickGetValueHit, quickGetValueMiss, quickGetKeyValuesHit, quickGetKeyValuesMiss;
+		// The fan-out of getMappedRange point lookups: the distinct secondary keys looked up, the rows whose secondary
+		// key was shared with an earlier row of the same batch, and the batched local reads issued for them.
+		Counter mappedRangePointLookups, mappedRangeDuplicateLookups, mappedRangeBatchedReads;
+		// Point reads answered by, and values admitted to, the hot value cache in front of the storage engine
+		Counter hotValueCacheHits, hotValueCacheInsertions;
+		// Bytes of checkpoints fetched by physical shard moves, and the physical shard moves that fell back to fetching
+		// keys
+		Counter checkpointBytesFetched, physicalShardMoveFallbacks;
 
 		// The number of logical bytes returned from storage engine, in response to readRange operations.
 		Counter kvScanBytes;
@@ -1491,6 +1686,11 @@ public:
 		// If set is within a range of clear, the clear is split. It's tracking the number of splits, the split could be
 		// expensive.
 		Counter pTreeClearSplits;
+		// The count of runs of sets sorted and inserted into pTree together, see STORAGE_SERVER_SORTED_SET_BATCH
+		Counter pTreeSortedSetBatches;
+		// The count of watched keys triggered by mutations when STORAGE_SERVER_BATCH_WATCH_TRIGGERS is set, counting a
+		// key once per update batch
+		Counter watchTriggers;
 
 		LatencySample readLatencySample;
 		LatencySample readKeyLatencySample;
@@ -1517,6 +1717,8 @@ public:
 		    watchQueries("WatchQueries", cc), emptyQueries("EmptyQueries", cc), feedRowsQueried("FeedRowsQueried", cc),
 		    feedBytesQueried("FeedBytesQueried", cc), feedStreamQueries("FeedStreamQueries", cc),
 		    rejectedFeedStreamQueries("RejectedFeedStreamQueries", cc), feedVersionQueries("FeedVersionQueries", cc),
+		    feedMultiStreamQueries("FeedMultiStreamQueries", cc), feedMultiStreamFeeds("FeedMultiStreamFeeds", cc),
+		    readsPastBudget("ReadsPastBudget", cc),
 		    logicalBytesInput("LogicalBytesInput", cc), logicalBytesMoveInOverhead("LogicalBytesMoveInOverhead", cc),
 		    kvCommitLogicalBytes("KVCommitLogicalBytes", cc), kvClearRanges("KVClearRanges", cc),
 		    kvClearSingleKey("KVClearSingleKey", cc), kvSystemClearRanges("KVSystemClearRanges", cc),
@@ -1530,13 +1732,19 @@ public:
 		    wrongShardServer("WrongShardServer", cc), fetchedVersions("FetchedVersions", cc),
 		    fetchesFromLogs("FetchesFromLogs", cc), quickGetValueHit("QuickGetValueHit", cc),
 		    quickGetValueMiss("QuickGetValueMiss", cc), quickGetKeyValuesHit("QuickGetKeyValuesHit", cc),
-		    quickGetKeyValuesMiss("QuickGetKeyValuesMiss", cc), kvScanBytes("KVScanBytes", cc),
+		    quickGetKeyValuesMiss("QuickGetKeyValuesMiss", cc), mappedRangePointLookups("MappedRangePointLookups", cc),
+		    mappedRangeDuplicateLookups("MappedRangeDuplicateLookups", cc),
+		    mappedRangeBatchedReads("MappedRangeBatchedReads", cc), hotValueCacheHits("HotValueCacheHits", cc),
+		    hotValueCacheInsertions("HotValueCacheInsertions", cc),
+		    checkpointBytesFetched("CheckpointBytesFetched", cc),
+		    physicalShardMoveFallbacks("PhysicalShardMoveFallbacks", cc), kvScanBytes("KVScanBytes", cc),
 		    kvGetBytes("KVGetBytes", cc), eagerReadsKeys("EagerReadsKeys", cc), kvGets("KVGets", cc),
 		    kvScans("KVScans", cc), kvCommits("KVCommits", cc), changeFeedDiskReads("ChangeFeedDiskReads", cc),
 		    getMappedRangeBytesQueried("GetMappedRangeBytesQueried", cc),
 		    finishedGetMappedRangeQueries("FinishedGetMappedRangeQueries", cc),
 		    finishedGetMappedRangeSecondaryQueries("FinishedGetMappedRangeSecondaryQueries", cc),
 		    pTreeSets("PTreeSets", cc), pTreeClears("PTreeClears", cc), pTreeClearSplits("PTreeClearSplits", cc),
+		    pTreeSortedSetBatches("PTreeSortedSetBatches", cc), watchTriggers("WatchTriggers", cc),
 		    changeServerKeysAssigned("ChangeServerKeysAssigned", cc),
 		    changeServerKeysUnassigned("ChangeServerKeysUnassigned", cc),
 		    readLatencySample("ReadLatencyMetrics",
@@ -1593,6 +1801,7 @@ public:
 			specialCounter(cc, "StorageVersion", [self]() { return self->storageVersion(); });
 			specialCounter(cc, "DurableVersion", [self]() { return self->durableVersion.get(); });
 			specialCounter(cc, "DesiredOldestVersion", [self]() { return self->desiredOldestVersion.get(); });
+			specialCounter(cc, "MvccWindowVersions", [self]() { return self->mvccWindowVersions; });
 			specialCounter(cc, "VersionLag", [self]() { return self->versionLag; });
 			specialCounter(cc, "LocalRate", [self] { return int64_t(self->currentRate() * 100); });
 
@@ -1617,12 +1826,29 @@ public:
 			specialCounter(cc, "ServeValidateStorageWaiting", [self]() {
 				return self->serveAuditStorageParallelismLock.waiters();
 			});
+			specialCounter(cc, "ServeValidateReplicaActive", [self]() {
+				return self->serveAuditStorageReplicaParallelismLock.activePermits();
+			});
+			specialCounter(cc, "ServeValidateReplicaWaiting", [self]() {
+				return self->serveAuditStorageReplicaParallelismLock.waiters();
+			});
 			specialCounter(cc, "QueryQueueMax", [self]() { return self->getAndResetMaxQueryQueueSize(); });
 			specialCounter(cc, "ActiveWatches", [self]() { return self->numWatches; });
 			specialCounter(cc, "WatchBytes", [self]() { return self->watchBytes; });
+			specialCounter(cc, "WatchedKeys", [self]() { return self->watchMap.size(); });
+			specialCounter(cc, "WatchBytesPerWatch", [self]() {
+				return self->numWatches > 0 ? self->watchBytes / self->numWatches : 0;
+			});
 			specialCounter(cc, "KvstoreSizeTotal", [self]() { return std::get<0>(self->storage.getSize()); });
 			specialCounter(cc, "KvstoreNodeTotal", [self]() { return std::get<1>(self->storage.getSize()); });
 			specialCounter(cc, "KvstoreInlineKey", [self]() { return std::get<2>(self->storage.getSize()); });
+			specialCounter(
+			    cc, "KvstoreLazyClearPending", [self]() { return self->storage.getLazyClearProgress().first; });
+			specialCounter(
+			    cc, "KvstoreLazyClearFreedBytes", [self]() { return self->storage.getLazyClearProgress().second; });
+			specialCounter(cc, "KvstoreCompactionDebt", [self]() { return self->storage.getCompactionDebt(); });
+			specialCounter(cc, "HotValueCacheBytes", [self]() { return self->storage.hotValues.getBytes(); });
+			specialCounter(cc, "HotValueCacheEvictions", [self]() { return self->storage.hotValues.getEvictions(); });
 			specialCounter(cc, "ActiveChangeFeeds", [self]() { return self->uidChangeFeed.size(); });
 			specialCounter(cc, "ActiveChangeFeedQueries", [self]() { return self->activeFeedQueries; });
 			specialCounter(cc, "ChangeFeedMemoryBytes", [self]() { return self->changeFeedMemoryBytes; });
@@ -1691,6 +1917,8 @@ public:
 	    ssLock(makeReference<PriorityMultiLock>(SERVER_KNOBS->STORAGE_SERVER_READ_CONCURRENCY,
 	                                            SERVER_KNOBS->STORAGESERVER_READ_PRIORITIES)),
 	    serveAuditStorageParallelismLock(SERVER_KNOBS->SERVE_AUDIT_STORAGE_PARALLELISM),
+	    serveAuditStorageReplicaParallelismLock(SERVER_KNOBS->SERVE_AUDIT_STORAGE_REPLICA_PARALLELISM),
+	    auditStorageRateLimiter(new SpeedLimit(SERVER_KNOBS->AUDIT_STORAGE_RATE_PER_SERVER_MAX, 1)),
 	    instanceID(deterministicRandom()->randomUniqueID().first()), shuttingDown(false), behind(false),
 	    versionBehind(false), debug_inApplyUpdate(false), debug_lastValidateTime(0), lastBytesInputEBrake(0),
 	    lastDurableVersionEBrake(0), maxQueryQueue(0),
@@ -1698,6 +1926,9 @@ public:
 	                          /*maxTagsTracked=*/SERVER_KNOBS->SS_THROTTLE_TAGS_TRACKED,
 	                          /*minRateTracked=*/SERVER_KNOBS->MIN_TAG_READ_PAGES_RATE *
 	                              CLIENT_KNOBS->TAG_THROTTLING_PAGE_SIZE),
+	    readResourceCounter(ssi.id(),
+	                        SERVER_KNOBS->STORAGE_READ_RESOURCE_SAMPLE_RATE,
+	                        SERVER_KNOBS->STORAGE_READ_RESOURCE_MAX_TRACKED),
 	    busiestWriteTagContext(ssi.id()), getEncryptCipherKeysMonitor(encryptionMonitor), counters(this),
 	    storageServerSourceTLogIDEventHolder(
 	        makeReference<EventCacheHolder>(ssi.id().toString() + "/StorageServerSourceTLogID")),
@@ -1757,6 +1988,10 @@ public:
 	void addShard(ShardInfo* newShard) {
 		ASSERT(!newShard->keys.empty());
 		newShard->changeCounter = ++shardChangeCounter;
+		if (storage.keepsVersions()) {
+			// Reads of the engine at the current version or before still see the shards as they were
+			shardChangeCounters[version.get() + 1] = shardChangeCounter;
+		}
 		// TraceEvent("AddShard", this->thisServerID).detail("KeyBegin", newShard->keys.begin).detail("KeyEnd", newShard->keys.end).detail("State",newShard->isReadable() ? "Readable" : newShard->notAssigned() ? "NotAssigned" : "Adding").detail("Version", this->version.get());
 		/*auto affected = shards.getAffectedRangesAfterInsertion( newShard->keys, Reference<ShardInfo>() );
 		for(auto i = affected.begin(); i != affected.end(); ++i)
@@ -1795,6 +2030,9 @@ public:
 		storageMinRecoverVersion = ver;
 		lastVersionWithData = ver;
 		restoredVersion = ver;
+		engineOldestVersion = ver;
+		// Nothing in the engine is tagged with a later version
+		storage.setWriteVersion(ver);
 
 		mutableData().createNewVersion(ver);
 		mutableData().forgetVersionsBefore(ver);
@@ -1819,6 +2057,37 @@ public:
 		return true;
 	}
 
+	// Admits a value just read from the storage engine to the hot value cache if read sampling shows its key is hot
+	void maybeCacheHotValue(KeyRef key, Optional<Value> const& value, uint64_t hotValueToken) {
+		if (SERVER_KNOBS->HOT_VALUE_CACHE_BYTES <= 0 || !SERVER_KNOBS->READ_SAMPLING_ENABLED) {
+			return;
+		}
+		Arena arena;
+		const double readBandwidth = (double)metrics.bytesReadSample.getEstimate(singleKeyRange(key, arena)) /
+		                             SERVER_KNOBS->STORAGE_METRICS_AVERAGE_INTERVAL;
+		if (readBandwidth >= SERVER_KNOBS->HOT_VALUE_CACHE_MIN_READ_BANDWIDTH &&
+		    storage.hotValues.insert(key, value, hotValueToken)) {
+			++counters.hotValueCacheInsertions;
+		}
+	}
+
+	// The engine snapshot of the long snapshot at version, or -1 if there is no pinned one
+	int64_t longSnapshotAt(Version version) const {
+		auto it = longSnapshots.find(version);
+		return it == longSnapshots.end() ? -1 : it->second.engineSnapshot;
+	}
+
+	// The shardChangeCounter as of a version older than the in-memory window: that of when the long snapshot at
+	// version was registered, or otherwise that of the last shard change at or before version
+	uint64_t changeCounterAt(Version version) const {
+		auto snapshot = longSnapshots.find(version);
+		if (snapshot != longSnapshots.end()) {
+			return snapshot->second.changeCounter;
+		}
+		auto it = shardChangeCounters.upper_bound(version);
+		return it == shardChangeCounters.begin() ? 0 : std::prev(it)->second;
+	}
+
 	void checkChangeCounter(uint64_t oldShardChangeCounter, KeyRef const& key) {
 		if (oldShardChangeCounter != shardChangeCounter && shards[key]->changeCounter > oldShardChangeCounter) {
 			CODE_PROBE(true, "shard change during getValueQ");
@@ -1839,6 +2108,20 @@ public:
 
 	Counter::Value queueSize() const { return counters.bytesInput.getValue() - counters.bytesDurable.getValue(); }
 
+	// The versions to keep in memory when full are normally kept.  Once the queue exceeds
+	// STORAGE_ADAPTIVE_MVCC_WINDOW_BYTES, fewer are kept so that they become durable and free their memory sooner, down
+	// to STORAGE_MIN_MVCC_WINDOW_VERSIONS when it reaches TARGET_BYTES_PER_STORAGE_SERVER, where Ratekeeper throttles.
+	Version mvccWindow(Version full) const {
+		const int64_t start = SERVER_KNOBS->STORAGE_ADAPTIVE_MVCC_WINDOW_BYTES;
+		const int64_t target = SERVER_KNOBS->TARGET_BYTES_PER_STORAGE_SERVER;
+		const Version least = SERVER_KNOBS->STORAGE_MIN_MVCC_WINDOW_VERSIONS;
+		if (start <= 0 || queueSize() <= start || full <= least) {
+			return full;
+		}
+		const double pressure = start < target ? std::min(1.0, double(queueSize() - start) / (target - start)) : 1.0;
+		return full - Version(pressure * (full - least));
+	}
+
 	// penalty used by loadBalance() to balance requests among SSes. We prefer SS with less write queue size.
 	double getPenalty() const override {
 		return std::max(std::max(1.0,
@@ -2081,6 +2364,29 @@ void StorageServer::clearWatchMetadata() {
 	watchMap.clear();
 }
 
+void StorageServer::triggerPendingWatches() {
+	if (!pendingWatchRanges.empty()) {
+		std::sort(pendingWatchRanges.begin(), pendingWatchRanges.end(), KeyRangeRef::ArbitraryOrder());
+		KeyRangeRef merged = pendingWatchRanges.front();
+		for (auto const& range : pendingWatchRanges) {
+			if (range.begin > merged.end) {
+				counters.watchTriggers += watches.triggerRange(merged.begin, merged.end);
+				merged = range;
+			} else if (range.end > merged.end) {
+				merged = KeyRangeRef(merged.begin, range.end);
+			}
+		}
+		counters.watchTriggers += watches.triggerRange(merged.begin, merged.end);
+		pendingWatchRanges.clear();
+	}
+	if (!pendingWatchKeys.empty()) {
+		std::sort(pendingWatchKeys.begin(), pendingWatchKeys.end());
+		pendingWatchKeys.erase(std::unique(pendingWatchKeys.begin(), pendingWatchKeys.end()), pendingWatchKeys.end());
+		counters.watchTriggers += watches.triggerSorted(pendingWatchKeys);
+		pendingWatchKeys.clear();
+	}
+}
+
 #ifndef __INTEL_COMPILER
 #pragma endregion
 #endif
@@ -2346,6 +2652,13 @@ Future<Version> waitForVersion(StorageServer* data,
 	return waitForVersionActor(data, std::max(commitVersion, data->oldestVersion.get()), spanContext);
 }
 
+// Returns how many versions data is behind the version that a read at readVersion, with the given commit version hint,
+// waits for, or 0 if the read doesn't have to wait
+Version getReadVersionLag(StorageServer const* data, Version commitVersion, Version readVersion) {
+	Version required = commitVersion != invalidVersion ? commitVersion : readVersion;
+	return required == latestVersion ? 0 : std::max<Version>(0, required - data->version.get());
+}
+
 ACTOR Future<Version> waitForVersionNoTooOld(StorageServer* data, Version version) {
 	// This could become an Actor transparently, but for now it just does the lookup
 	if (version == latestVersion)
@@ -2391,6 +2704,94 @@ ACTOR Future<Version> waitForMinVersion(StorageServer* data, Version version) {
 	}
 }
 
+// Returns true if a read at version is older than the in-memory window but can be served by the storage engine, from a
+// long snapshot or from the versions the engine keeps
+bool readsOldVersion(StorageServer* data, Version version, Optional<ReadOptions> const& options) {
+	if (version >= data->oldestVersion.get()) {
+		return false;
+	}
+	if (options.present() && options.get().longSnapshot && data->longSnapshots.count(version)) {
+		return true;
+	}
+	return data->storage.keepsVersions() && version >= data->engineOldestVersion;
+}
+
+// Waits for the long snapshot at version to be pinned if there is one, and otherwise for the version to be durable
+ACTOR Future<Version> waitForOldVersion(StorageServer* data, Version version) {
+	auto it = data->longSnapshots.find(version);
+	if (it != data->longSnapshots.end()) {
+		wait(it->second.pinned.getFuture());
+	} else {
+		wait(data->durableVersion.whenAtLeast(version));
+	}
+	return version;
+}
+
+// Reads from the long snapshot at version if there is one, and otherwise from the versions the engine keeps
+Future<Optional<Value>> readValueAtOldVersion(StorageServer* data,
+                                              Version version,
+                                              KeyRef key,
+                                              Optional<ReadOptions> const& options) {
+	const int64_t snapshot = data->longSnapshotAt(version);
+	if (snapshot >= 0) {
+		return data->storage.readValueAtSnapshot(snapshot, key, options);
+	}
+	if (!data->storage.keepsVersions() || version < data->engineOldestVersion) {
+		throw transaction_too_old();
+	}
+	return data->storage.readValueAtVersion(version, key, options);
+}
+
+Future<RangeResult> readEngineRangeAtOldVersion(StorageServer* data,
+                                                Version version,
+                                                KeyRangeRef range,
+                                                int limit,
+                                                int limitBytes,
+                                                Optional<ReadOptions> const& options) {
+	const int64_t snapshot = data->longSnapshotAt(version);
+	if (snapshot >= 0) {
+		return data->storage.readRangeAtSnapshot(snapshot, range, limit, limitBytes, options);
+	}
+	if (!data->storage.keepsVersions() || version < data->engineOldestVersion) {
+		throw transaction_too_old();
+	}
+	return data->storage.readRangeAtVersion(version, range, limit, limitBytes, options);
+}
+
+// Reads range at a version older than the in-memory window from the storage engine, like readRange() does from the
+// versioned data and the storage engine
+ACTOR Future<GetKeyValuesReply> readRangeAtOldVersion(StorageServer* data,
+                                                      Version version,
+                                                      KeyRange range,
+                                                      int limit,
+                                                      int* pLimitBytes,
+                                                      Optional<ReadOptions> options,
+                                                      Optional<KeyRef> tenantPrefix,
+                                                      ReadEngineCost* engineCost,
+                                                      ReadCpuTimer* cpuTimer) {
+	state GetKeyValuesReply result;
+	Future<RangeResult> fRange = readEngineRangeAtOldVersion(data, version, range, limit, *pLimitBytes, options);
+	cpuTimer->stop();
+	RangeResult atSnapshot = wait(fRange);
+	cpuTimer->start();
+	data->counters.kvScanBytes += atSnapshot.logicalSize();
+	engineCost->bytesScanned += atSnapshot.logicalSize();
+	++engineCost->reads;
+
+	result.arena.dependsOn(atSnapshot.arena());
+	result.data.reserve(result.arena, atSnapshot.size());
+	for (const KeyValueRef& kv : atSnapshot) {
+		result.data.push_back(result.arena,
+		                      tenantPrefix.present() ? KeyValueRef(kv.key.removePrefix(tenantPrefix.get()), kv.value)
+		                                             : kv);
+		*pLimitBytes -= sizeof(KeyValueRef) + result.data.back().expectedSize();
+	}
+	result.more = atSnapshot.more;
+	result.cached = false;
+	result.version = version;
+	return result;
+}
+
 void StorageServer::checkTenantEntry(Version version, TenantInfo tenantInfo, bool lockAware) {
 	if (tenantInfo.hasTenant()) {
 		ASSERT(version == latestVersion || (version >= tenantMap.oldestVersion && version <= this->version.get()));
@@ -2434,6 +2835,8 @@ std::shared_ptr<MoveInShard> StorageServer::getMoveInShard(const UID& dataMoveId
 
 ACTOR Future<Void> getValueQ(StorageServer* data, GetValueRequest req) {
 	state int64_t resultSize = 0;
+	state ReadEngineCost engineCost;
+	state ReadCpuTimer cpuTimer(data->readResourceCounter.sampleRead());
 	Span span("SS:getValue"_loc, req.spanContext);
 	// Temporarily disabled -- this path is hit a lot
 	// getCurrentLineage()->modify(&TransactionLineage::txID) = req.spanContext.first();
@@ -2451,10 +2854,12 @@ ACTOR Future<Void> getValueQ(StorageServer* data, GetValueRequest req) {
 		// so we need to downgrade here
 		wait(data->getQueryDelay());
 		state PriorityMultiLock::Lock readLock = wait(data->getReadLock(req.options));
+		cpuTimer.start();
 
 		// Track time from requestTime through now as read queueing wait time
 		state double queueWaitEnd = g_network->timer();
-		data->counters.readQueueWaitSample.addMeasurement(queueWaitEnd - req.requestTime());
+		data->recordReadQueueWait(req.options, queueWaitEnd - req.requestTime());
+		data->checkReadBudget(req.options, queueWaitEnd - req.requestTime());
 
 		if (req.options.present() && req.options.get().debugID.present())
 			g_traceBatch.addEvent("GetValueDebug",
@@ -2463,7 +2868,15 @@ ACTOR Future<Void> getValueQ(StorageServer* data, GetValueRequest req) {
 
 		state Optional<Value> v;
 		Version commitVersion = getLatestCommitVersion(req.ssLatestCommitVersions, data->tag);
-		state Version version = wait(waitForVersion(data, commitVersion, req.version, req.spanContext));
+		state Version readLag = getReadVersionLag(data, commitVersion, req.version);
+		state bool oldVersion = readsOldVersion(data, req.version, req.options);
+		cpuTimer.stop();
+		state Version version = wait(oldVersion ? waitForOldVersion(data, req.version)
+		                                        : waitForVersion(data, commitVersion, req.version, req.spanContext));
+		// Reads of old versions don't hold back the discarding of versions from memory, which they don't read
+		state ActiveReadVersions::Read activeRead =
+		    oldVersion ? ActiveReadVersions::Read() : ActiveReadVersions::Read(data->activeReads, version);
+		cpuTimer.start();
 		data->counters.readVersionWaitSample.addMeasurement(g_network->timer() - queueWaitEnd);
 
 		if (req.options.present() && req.options.get().debugID.present())
@@ -2471,11 +2884,15 @@ ACTOR Future<Void> getValueQ(StorageServer* data, GetValueRequest req) {
 			                      req.options.get().debugID.get().first(),
 			                      "getValueQ.AfterVersion"); //.detail("TaskID", g_network->getCurrentTask());
 
-		data->checkTenantEntry(version, req.tenantInfo, req.options.present() ? req.options.get().lockAware : false);
+		// The tenant map doesn't go back as far as an old version, so its tenant is checked at the latest version
+		data->checkTenantEntry(oldVersion ? latestVersion : version,
+		                       req.tenantInfo,
+		                       req.options.present() ? req.options.get().lockAware : false);
 		if (req.tenantInfo.hasTenant()) {
 			req.key = req.key.withPrefix(req.tenantInfo.prefix.get());
 		}
-		state uint64_t changeCounter = data->shardChangeCounter;
+		// The shards of an old version must not have changed since
+		state uint64_t changeCounter = oldVersion ? data->changeCounterAt(version) : data->shardChangeCounter;
 
 		if (!data->shards[req.key]->isReadable()) {
 			//TraceEvent("WrongShardServer", data->thisServerID).detail("Key", req.key).detail("Version", version).detail("In", "getValueQ");
@@ -2483,21 +2900,47 @@ ACTOR Future<Void> getValueQ(StorageServer* data, GetValueRequest req) {
 		}
 
 		state int path = 0;
-		auto i = data->data().at(version).lastLessOrEqual(req.key);
-		if (i && i->isValue() && i.key() == req.key) {
-			v = (Value)i->getValue();
-			path = 1;
-		} else if (!i || !i->isClearTo() || i->getEndKey() <= req.key) {
+		if (oldVersion) {
 			path = 2;
-			Optional<Value> vv = wait(data->storage.readValue(req.key, req.options));
+			Future<Optional<Value>> fValue = readValueAtOldVersion(data, version, req.key, req.options);
+			cpuTimer.stop();
+			Optional<Value> vv = wait(fValue);
+			cpuTimer.start();
 			data->counters.kvGetBytes += vv.expectedSize();
-			// Validate that while we were reading the data we didn't lose the version or shard
-			if (version < data->storageVersion()) {
-				CODE_PROBE(true, "transaction_too_old after readValue");
-				throw transaction_too_old();
-			}
+			engineCost.bytesScanned += vv.expectedSize();
+			++engineCost.reads;
 			data->checkChangeCounter(changeCounter, req.key);
 			v = vv;
+		} else {
+			auto i = data->data().at(version).lastLessOrEqual(req.key);
+			if (i && i->isValue() && i.key() == req.key) {
+				v = (Value)i->getValue();
+				path = 1;
+			} else if (!i || !i->isClearTo() || i->getEndKey() <= req.key) {
+				path = 2;
+				state Optional<Optional<Value>> hotValue = data->storage.hotValues.get(req.key);
+				if (hotValue.present()) {
+					++data->counters.hotValueCacheHits;
+					v = hotValue.get();
+				} else {
+					state uint64_t hotValueToken = data->storage.hotValues.beginRead();
+					Future<Optional<Value>> fValue = data->storage.readValue(req.key, req.options);
+					cpuTimer.stop();
+					Optional<Value> vv = wait(fValue);
+					cpuTimer.start();
+					data->counters.kvGetBytes += vv.expectedSize();
+					engineCost.bytesScanned += vv.expectedSize();
+					++engineCost.reads;
+					// Validate that while we were reading the data we didn't lose the version or shard
+					if (version < data->storageVersion()) {
+						CODE_PROBE(true, "transaction_too_old after readValue");
+						throw transaction_too_old();
+					}
+					data->checkChangeCounter(changeCounter, req.key);
+					v = vv;
+					data->maybeCacheHotValue(req.key, v, hotValueToken);
+				}
+			}
 		}
 
 		DEBUG_MUTATION("ShardGetValue",
@@ -2548,6 +2991,7 @@ ACTOR Future<Void> getValueQ(StorageServer* data, GetValueRequest req) {
 
 		GetValueReply reply(v, cached);
 		reply.penalty = data->getPenalty();
+		reply.versionLag = readLag;
 		req.reply.send(reply);
 	} catch (Error& e) {
 		if (!canReplyWith(e))
@@ -2557,7 +3001,16 @@ ACTOR Future<Void> getValueQ(StorageServer* data, GetValueRequest req) {
 
 	// Key size is not included in "BytesQueried", but still contributes to cost,
 	// so it must be accounted for here.
-	data->transactionTagCounter.addRequest(req.tags, req.key.size() + resultSize);
+	data->transactionTagCounter.addRequest(req.tags, req.key.size() + resultSize, engineCost);
+	cpuTimer.stop();
+	if (cpuTimer.isSampled()) {
+		data->readResourceCounter.addRequest(ReadRequestType::GET_VALUE,
+		                                     req.tenantInfo.tenantId,
+		                                     req.tags,
+		                                     cpuTimer.getSeconds(),
+		                                     engineCost,
+		                                     req.key.size() + resultSize);
+	}
 
 	++data->counters.finishedQueries;
 
@@ -3223,7 +3676,8 @@ ACTOR Future<std::pair<ChangeFeedStreamReply, bool>> getChangeFeedMutations(Stor
                                                                             bool atLatest,
                                                                             bool doFilterMutations,
                                                                             int commonFeedPrefixLength,
-                                                                            FeedDiskReadState* feedDiskReadState) {
+                                                                            FeedDiskReadState* feedDiskReadState,
+                                                                            NetworkAddress peer) {
 	state ChangeFeedStreamReply reply;
 	state ChangeFeedStreamReply memoryReply;
 	state int remainingLimitBytes = CLIENT_KNOBS->REPLY_BYTE_LIMIT;
@@ -3237,7 +3691,7 @@ ACTOR Future<std::pair<ChangeFeedStreamReply, bool>> getChangeFeedMutations(Stor
 		    .detail("Range", req.range)
 		    .detail("Begin", req.begin)
 		    .detail("End", req.end)
-		    .detail("PeerAddr", req.reply.getEndpoint().getPrimaryAddress());
+		    .detail("PeerAddr", peer);
 	}
 
 	if (data->version.get() < req.begin) {
@@ -3284,7 +3738,7 @@ ACTOR Future<std::pair<ChangeFeedStreamReply, bool>> getChangeFeedMutations(Stor
 		    .detail("FetchVersion", feedInfo->fetchVersion)
 		    .detail("DurableFetchVersion", feedInfo->durableFetchVersion.get())
 		    .detail("DurableValidationVersion", durableValidationVersion)
-		    .detail("PeerAddr", req.reply.getEndpoint().getPrimaryAddress());
+		    .detail("PeerAddr", peer);
 	}
 
 	if (req.end > emptyVersion + 1) {
@@ -3616,7 +4070,7 @@ ACTOR Future<std::pair<ChangeFeedStreamReply, bool>> getChangeFeedMutations(Stor
 		// was popped. We can check by confirming that the client was sent empty versions as part of another feed's
 		// response's minStorageVersion, or a ChangeFeedUpdateRequest. If this was the case, we know no updates could
 		// have happened between req.begin and minVersion.
-		Version minVersion = data->minFeedVersionForAddress(req.reply.getEndpoint().getPrimaryAddress());
+		Version minVersion = data->minFeedVersionForAddress(peer);
 		bool ok = atLatest && minVersion > feedInfo->emptyVersion;
 		CODE_PROBE(ok, "feed popped while valid read waiting");
 		CODE_PROBE(!ok, "feed popped while invalid read waiting");
@@ -3711,7 +4165,7 @@ ACTOR Future<std::pair<ChangeFeedStreamReply, bool>> getChangeFeedMutations(Stor
 		    .detail("PopVersion", reply.popVersion)
 		    .detail("Count", reply.mutations.size())
 		    .detail("GotAll", gotAll)
-		    .detail("PeerAddr", req.reply.getEndpoint().getPrimaryAddress());
+		    .detail("PeerAddr", peer);
 	}
 
 	// If the SS's version advanced at all during any of the waits, the read from memory may have missed some
@@ -3860,7 +4314,14 @@ ACTOR Future<Void> changeFeedStreamQ(StorageServer* data, ChangeFeedStreamReques
 
 			// keep this as not state variable so it is freed after sending to reduce memory
 			Future<std::pair<ChangeFeedStreamReply, bool>> feedReplyFuture = getChangeFeedMutations(
-			    data, feedInfo, req, atLatest, doFilterMutations, commonFeedPrefixLength, &feedDiskReadState);
+			    data,
+			    feedInfo,
+			    req,
+			    atLatest,
+			    doFilterMutations,
+			    commonFeedPrefixLength,
+			    &feedDiskReadState,
+			    req.reply.getEndpoint().getPrimaryAddress());
 			if (atLatest && !removeUID && !feedReplyFuture.isReady()) {
 				data->changeFeedClientVersions[req.reply.getEndpoint().getPrimaryAddress()][req.id] =
 				    blockedVersion.present() ? blockedVersion.get() : data->prevVersion;
@@ -3959,6 +4420,322 @@ ACTOR Future<Void> changeFeedStreamQ(StorageServer* data, ChangeFeedStreamReques
 	return Void();
 }
 
+// The state of one of the feeds of a ChangeFeedMultiStreamRequest
+struct MultiStreamFeed {
+	ChangeFeedStreamRequest req; // The feed's part of the request, with begin advanced as the feed is sent
+	Reference<ChangeFeedInfo> feedInfo;
+	bool doFilterMutations = false;
+	int commonFeedPrefixLength = 0;
+	FeedDiskReadState feedDiskReadState = STARTING;
+	bool atLatest = false;
+	// Whether the feed may have mutations that were not sent yet: it is not at the latest version, or it got new
+	// mutations since it was last read
+	bool pending = true;
+	bool ended = false; // Whether the entry that ended the feed's stream was sent
+	Promise<Void> moved;
+	Future<Void> watcher;
+};
+
+// Stops tracking a feed of a multi stream whose stream ended
+void endMultiStreamFeed(StorageServer* data, MultiStreamFeed& feed) {
+	feed.ended = true;
+	feed.watcher = Future<Void>();
+	// Move triggers are cleared when they fire
+	if (feed.feedInfo && feed.moved.canBeSet()) {
+		auto it = data->uidChangeFeed.find(feed.req.rangeID);
+		if (it != data->uidChangeFeed.end()) {
+			it->second->removeOnMoveTrigger(feed.req.range, feed.req.id);
+		}
+	}
+}
+
+// The version through which any feed of a multi stream that is at the latest version has been sent
+Version multiStreamSentVersion(StorageServer* data, const std::vector<MultiStreamFeed>& feeds) {
+	Version sent = data->version.get();
+	for (const auto& f : feeds) {
+		if (!f.ended && f.atLatest && f.pending) {
+			sent = std::min(sent, f.req.begin - 1);
+		}
+	}
+	return sent;
+}
+
+// Marks a feed of a multi stream as pending when it gets new mutations or reaches its end version, and wakes the
+// stream. A feed that moves away is ended right away, regardless of how far behind the client is.
+ACTOR Future<Void> watchMultiStreamFeed(StorageServer* data,
+                                        MultiStreamFeed* feed,
+                                        int index,
+                                        UID streamID,
+                                        NetworkAddress peer,
+                                        ReplyPromiseStream<ChangeFeedMultiStreamReply> reply,
+                                        AsyncTrigger* wake) {
+	state Future<Void> endReached =
+	    feed->req.end == MAX_VERSION ? Never() : data->version.whenAtLeast(feed->req.end);
+	loop {
+		choose {
+			when(wait(feed->feedInfo->newMutations.onTrigger())) {}
+			when(wait(endReached)) {
+				endReached = Never();
+			}
+			when(wait(feed->moved.getFuture())) {
+				CODE_PROBE(true, "Change feed of multi stream moved away");
+				ChangeFeedMultiStreamReply moved;
+				moved.feeds.emplace_back();
+				moved.feeds.back().feed = index;
+				moved.feeds.back().error = wrong_shard_server();
+				reply.send(moved);
+				feed->ended = true;
+				wake->trigger();
+				return Void();
+			}
+		}
+		if (feed->atLatest && !feed->pending) {
+			// Like a single feed stream that is blocked after the trigger, hold back the version sent to the client
+			// in the replies of its other streams until these mutations are sent
+			auto& clientVersions = data->changeFeedClientVersions[peer];
+			if (!clientVersions.count(streamID)) {
+				clientVersions[streamID] = data->prevVersion;
+			}
+		}
+		feed->pending = true;
+		wake->trigger();
+	}
+}
+
+// Streams the feeds of a ChangeFeedMultiStreamRequest with one actor, instead of one changeFeedStreamQ per feed. Each
+// reply has entries for up to CHANGEFEED_MULTI_STREAM_READ_PARALLELISM of the feeds with mutations to send.
+ACTOR Future<Void> changeFeedMultiStreamQ(StorageServer* data, ChangeFeedMultiStreamRequest req) {
+	state Span span("SS:getChangeFeedMultiStream"_loc, req.spanContext);
+	state NetworkAddress peer = req.reply.getEndpoint().getPrimaryAddress();
+	state std::vector<MultiStreamFeed> feeds;
+	state AsyncTrigger wake;
+	state int cursor = 0;
+	state std::vector<int> readFeeds;
+	state std::vector<Future<ErrorOr<std::pair<ChangeFeedStreamReply, bool>>>> reads;
+
+	try {
+		++data->counters.feedMultiStreamQueries;
+		data->counters.feedMultiStreamFeeds += req.feeds.size();
+
+		bool anyCanReadPopped = false;
+		for (const auto& sub : req.feeds) {
+			anyCanReadPopped = anyCanReadPopped || sub.canReadPopped;
+		}
+		if (!anyCanReadPopped && (data->activeFeedQueries >= SERVER_KNOBS->STORAGE_FEED_QUERY_HARD_LIMIT ||
+		                          (g_network->isSimulated() && BUGGIFY_WITH_PROB(0.005)))) {
+			req.reply.sendError(storage_too_many_feed_streams());
+			++data->counters.rejectedFeedStreamQueries;
+			return Void();
+		}
+
+		data->activeFeedQueries++;
+
+		if (req.replyBufferSize <= 0) {
+			req.reply.setByteLimit(SERVER_KNOBS->CHANGEFEEDSTREAM_LIMIT_BYTES);
+		} else {
+			req.reply.setByteLimit(std::min((int64_t)req.replyBufferSize, SERVER_KNOBS->CHANGEFEEDSTREAM_LIMIT_BYTES));
+		}
+
+		// See changeFeedStreamQ
+		wait(delay(0, TaskPriority::SSSpilledChangeFeedReply));
+
+		Version checkTooOldVersion = 0;
+		for (const auto& sub : req.feeds) {
+			checkTooOldVersion = std::max(checkTooOldVersion,
+			                              (!sub.canReadPopped || sub.end == MAX_VERSION) ? sub.begin : sub.end);
+		}
+		wait(success(waitForVersionNoTooOld(data, checkTooOldVersion)));
+
+		// send an empty version at begin - 1 of each feed to establish the streams quickly
+		feeds.resize(req.feeds.size());
+		ChangeFeedMultiStreamReply initialReply;
+		for (int i = 0; i < feeds.size(); i++) {
+			const ChangeFeedStreamSubscription& sub = req.feeds[i];
+			MultiStreamFeed& f = feeds[i];
+			f.req.spanContext = req.spanContext;
+			f.req.rangeID = sub.rangeID;
+			f.req.begin = sub.begin;
+			f.req.end = sub.end;
+			f.req.range = sub.range;
+			f.req.canReadPopped = sub.canReadPopped;
+			f.req.id = sub.id;
+			f.req.options = sub.options;
+			f.req.encrypted = sub.encrypted;
+
+			initialReply.feeds.emplace_back();
+			ChangeFeedMultiStreamEntry& entry = initialReply.feeds.back();
+			entry.feed = i;
+			auto feed = data->uidChangeFeed.find(sub.rangeID);
+			if (feed == data->uidChangeFeed.end() || feed->second->removing) {
+				entry.error = unknown_change_feed();
+				f.ended = true;
+				continue;
+			}
+			f.feedInfo = feed->second;
+			f.doFilterMutations = !sub.range.contains(f.feedInfo->range);
+			if (f.doFilterMutations) {
+				f.commonFeedPrefixLength = commonPrefixLength(f.feedInfo->range.begin, f.feedInfo->range.end);
+			}
+			f.feedInfo->triggerOnMove(sub.range, sub.id, f.moved);
+			f.watcher = watchMultiStreamFeed(data, &f, i, req.id, peer, req.reply, &wake);
+
+			MutationsAndVersionRef emptyInitialVersion;
+			emptyInitialVersion.version = sub.begin - 1;
+			entry.mutations.push_back_deep(initialReply.arena, emptyInitialVersion);
+		}
+		req.reply.send(initialReply);
+
+		loop {
+			bool anyPending = false;
+			bool allEnded = true;
+			for (const auto& f : feeds) {
+				anyPending = anyPending || (!f.ended && f.pending);
+				allEnded = allEnded && f.ended;
+			}
+			if (allEnded) {
+				data->changeFeedClientVersions[peer].erase(req.id);
+				data->activeFeedQueries--;
+				req.reply.sendError(end_of_stream());
+				return Void();
+			}
+			if (!anyPending) {
+				// Every feed is at the latest version, so this stream doesn't hold back the client's other streams
+				// until a feed gets new mutations
+				data->changeFeedClientVersions[peer].erase(req.id);
+				wait(wake.onTrigger());
+				// The watchers trigger wake synchronously, so don't end the stream before they are done
+				wait(delay(0));
+				continue;
+			}
+			{
+				auto& clientVersions = data->changeFeedClientVersions[peer];
+				auto it = clientVersions.find(req.id);
+				if (it != clientVersions.end()) {
+					it->second = std::min(it->second, multiStreamSentVersion(data, feeds));
+				} else {
+					clientVersions[req.id] = multiStreamSentVersion(data, feeds);
+				}
+			}
+
+			wait(req.reply.onReady());
+			// Let the other feeds that get mutations at this version become pending, to send them in one reply
+			wait(delay(0));
+
+			readFeeds.clear();
+			reads.clear();
+			state ChangeFeedMultiStreamReply reply;
+			reply = ChangeFeedMultiStreamReply();
+			for (int n = 0; n < feeds.size() && reads.size() < SERVER_KNOBS->CHANGEFEED_MULTI_STREAM_READ_PARALLELISM;
+			     n++) {
+				const int i = (cursor + n) % feeds.size();
+				MultiStreamFeed& f = feeds[i];
+				if (!f.ended && f.pending) {
+					f.pending = false;
+					readFeeds.push_back(i);
+					reads.push_back(errorOr(getChangeFeedMutations(data,
+					                                               f.feedInfo,
+					                                               f.req,
+					                                               f.atLatest,
+					                                               f.doFilterMutations,
+					                                               f.commonFeedPrefixLength,
+					                                               &f.feedDiskReadState,
+					                                               peer)));
+				}
+				cursor = (i + 1) % feeds.size();
+			}
+			wait(waitForAll(reads));
+
+			for (int k = 0; k < readFeeds.size(); k++) {
+				const int i = readFeeds[k];
+				MultiStreamFeed& f = feeds[i];
+				if (f.ended) {
+					// moved away while it was read
+					continue;
+				}
+				reply.feeds.emplace_back();
+				ChangeFeedMultiStreamEntry& entry = reply.feeds.back();
+				entry.feed = i;
+				if (reads[k].get().isError()) {
+					Error e = reads[k].get().getError();
+					if (!canReplyWith(e)) {
+						throw e;
+					}
+					entry.error = e;
+					endMultiStreamFeed(data, f);
+					continue;
+				}
+
+				const ChangeFeedStreamReply& feedReply = reads[k].get().get().first;
+				const bool gotAll = reads[k].get().get().second;
+				ASSERT(feedReply.mutations.size() > 0);
+				f.req.begin = feedReply.mutations.back().version + 1;
+				if (!f.atLatest && gotAll) {
+					f.atLatest = true;
+				}
+				if (!gotAll) {
+					f.pending = true;
+				}
+				reply.arena.dependsOn(feedReply.arena);
+				entry.mutations = feedReply.mutations;
+				entry.atLatestVersion = f.atLatest;
+				entry.popVersion = feedReply.popVersion;
+				data->counters.feedRowsQueried += feedReply.mutations.size();
+				data->counters.feedBytesQueried += feedReply.mutations.expectedSize();
+
+				if (f.req.begin == f.req.end) {
+					entry.error = end_of_stream();
+				} else if (gotAll && f.feedInfo->removing) {
+					entry.error = unknown_change_feed();
+				}
+				if (entry.error.present()) {
+					endMultiStreamFeed(data, f);
+				}
+			}
+
+			// See changeFeedStreamQ. This actor was blocked after the feeds were triggered, so all of the triggers
+			// are done.
+			auto& replyClientVersions = data->changeFeedClientVersions[peer];
+			replyClientVersions.erase(req.id);
+			bool holdBack = false;
+			for (const auto& f : feeds) {
+				holdBack = holdBack || (!f.ended && f.atLatest && f.pending);
+			}
+			if (holdBack) {
+				replyClientVersions[req.id] = multiStreamSentVersion(data, feeds);
+			}
+			Version minVersion = data->version.get();
+			for (auto& it : replyClientVersions) {
+				minVersion = std::min(minVersion, it.second);
+			}
+			reply.minStreamVersion = minVersion;
+
+			if (!reply.feeds.empty()) {
+				req.reply.send(reply);
+			}
+		}
+	} catch (Error& e) {
+		data->activeFeedQueries--;
+		for (auto& f : feeds) {
+			if (!f.ended) {
+				endMultiStreamFeed(data, f);
+			}
+		}
+		auto it = data->changeFeedClientVersions.find(peer);
+		if (it != data->changeFeedClientVersions.end()) {
+			it->second.erase(req.id);
+			if (it->second.empty()) {
+				data->changeFeedClientVersions.erase(it);
+			}
+		}
+		if (e.code() != error_code_operation_obsolete) {
+			if (!canReplyWith(e))
+				throw;
+			req.reply.sendError(e);
+		}
+	}
+	return Void();
+}
+
 ACTOR Future<Void> changeFeedVersionUpdateQ(StorageServer* data, ChangeFeedVersionUpdateRequest req) {
 	++data->counters.feedVersionQueries;
 	wait(data->version.whenAtLeast(req.minVersion));
@@ -4075,6 +4852,7 @@ void merge(Arena& arena,
 	int accumulatedBytes = 0;
 	KeyValueRef const* baseStart = base.begin();
 	KeyValueRef const* baseEnd = base.end();
+	output.reserve(arena, output.size() + std::min(limit, base.size() + std::max(vCount, 0)));
 	while (baseStart != baseEnd && vCount > 0 && output.size() < adjustedLimit && accumulatedBytes < limitBytes) {
 		if (forward ? baseStart->key < vm_output[pos].key : baseStart->key > vm_output[pos].key) {
 			output.push_back(arena, removePrefix(*baseStart++, tenantPrefix));
@@ -4087,6 +4865,17 @@ void merge(Arena& arena,
 		}
 		accumulatedBytes += sizeof(KeyValueRef) + output.end()[-1].expectedSize();
 	}
+	if (!tenantPrefix.present()) {
+		// Nothing to strip from the remaining rows of base, so they are appended at once rather than one by one
+		KeyValueRef const* baseTake = baseStart;
+		while (baseTake != baseEnd && output.size() + (baseTake - baseStart) < adjustedLimit &&
+		       accumulatedBytes < limitBytes) {
+			accumulatedBytes += sizeof(KeyValueRef) + baseTake->expectedSize();
+			++baseTake;
+		}
+		output.append(arena, baseStart, baseTake - baseStart);
+		baseStart = baseTake;
+	}
 	while (baseStart != baseEnd && output.size() < adjustedLimit && accumulatedBytes < limitBytes) {
 		output.push_back(arena, removePrefix(*baseStart++, tenantPrefix));
 		accumulatedBytes += sizeof(KeyValueRef) + output.end()[-1].expectedSize();
@@ -4169,8 +4958,102 @@ ACTOR Future<GetValueReqAndResultRef> quickGetValue(StorageServer* data,
 	}
 }
 
+// Serves the distinct point lookups of one getMappedRange batch from this storage server: keys found in the versioned
+// data are answered from it, and the rest with a single readValuePrefixes() on the storage engine. A key this server
+// could not answer, e.g. because its shard is not readable here or moved during the read, is left absent so that the
+// caller falls back to quickGetValue() for it.
+ACTOR Future<std::vector<Optional<Optional<Value>>>> localGetValues(StorageServer* data,
+                                                                     std::vector<Key> keys,
+                                                                     Version version,
+                                                                     GetMappedKeyValuesRequest* pOriginalReq) {
+	state std::vector<Optional<Optional<Value>>> results(keys.size());
+	state std::vector<int> diskIndexes;
+	state std::vector<std::pair<KeyRef, int>> diskKeys;
+	state double getValuesStart = g_network->timer();
+	state uint64_t changeCounter = data->shardChangeCounter;
+	state bool tenantValid = true;
+
+	if (version < data->storageVersion() || version > data->version.get()) {
+		return results;
+	}
+	try {
+		data->checkTenantEntry(version,
+		                       pOriginalReq->tenantInfo,
+		                       pOriginalReq->options.present() && pOriginalReq->options.get().lockAware);
+	} catch (Error& e) {
+		// quickGetValue() reports the error for each key
+		tenantValid = false;
+	}
+	if (!tenantValid) {
+		return results;
+	}
+	if (pOriginalReq->tenantInfo.hasTenant()) {
+		for (auto& key : keys) {
+			key = key.withPrefix(pOriginalReq->tenantInfo.prefix.get());
+		}
+	}
+
+	{
+		auto view = data->data().at(version);
+		for (int i = 0; i < keys.size(); i++) {
+			if (!data->shards[keys[i]]->isReadable()) {
+				continue;
+			}
+			auto it = view.lastLessOrEqual(keys[i]);
+			if (it && it->isValue() && it.key() == keys[i]) {
+				results[i] = Optional<Value>((Value)it->getValue());
+			} else if (!it || !it->isClearTo() || it->getEndKey() <= keys[i]) {
+				diskIndexes.push_back(i);
+				diskKeys.emplace_back(keys[i], CLIENT_KNOBS->VALUE_SIZE_LIMIT);
+			} else {
+				results[i] = Optional<Value>();
+			}
+		}
+	}
+
+	if (!diskKeys.empty()) {
+		++data->counters.mappedRangeBatchedReads;
+		std::vector<Optional<Value>> values = wait(data->storage.readValuePrefixes(diskKeys, pOriginalReq->options));
+		// Values read after the version was lost, or from a shard that moved meanwhile, are left to the fallback
+		const bool versionValid = version >= data->storageVersion();
+		for (int j = 0; j < diskIndexes.size(); j++) {
+			data->counters.kvGetBytes += values[j].expectedSize();
+			if (versionValid && (changeCounter == data->shardChangeCounter ||
+			                     data->shards[keys[diskIndexes[j]]]->changeCounter <= changeCounter)) {
+				results[diskIndexes[j]] = values[j];
+			}
+		}
+	}
+
+	const double duration = g_network->timer() - getValuesStart;
+	for (int i = 0; i < keys.size(); i++) {
+		if (!results[i].present()) {
+			continue;
+		}
+		const Optional<Value>& v = results[i].get();
+		const int64_t resultSize = v.present() ? v.get().size() : 0;
+		++data->counters.quickGetValueHit;
+		data->counters.mappedRangeLocalSample.addMeasurement(duration);
+		if (v.present()) {
+			++data->counters.rowsQueried;
+			data->counters.bytesQueried += resultSize;
+		} else {
+			++data->counters.emptyQueries;
+		}
+		if (SERVER_KNOBS->READ_SAMPLING_ENABLED) {
+			data->metrics.notifyBytesReadPerKSecond(
+			    keys[i],
+			    v.present() ? std::max((int64_t)keys[i].size() + resultSize, SERVER_KNOBS->EMPTY_READ_PENALTY)
+			                : SERVER_KNOBS->EMPTY_READ_PENALTY);
+		}
+		data->transactionTagCounter.addRequest(pOriginalReq->tags, keys[i].size() + resultSize);
+	}
+	return results;
+}
+
 // If limit>=0, it returns the first rows in the range (sorted ascending), otherwise the last rows (sorted descending).
 // readRange has O(|result|) + O(log |data|) cost
+// If keysOnly, the values of the rows may be empty and *pLimitBytes is mostly spent on keys.
 ACTOR Future<GetKeyValuesReply> readRange(StorageServer* data,
                                           Version version,
                                           KeyRange range,
@@ -4178,7 +5061,10 @@ ACTOR Future<GetKeyValuesReply> readRange(StorageServer* data,
                                           int* pLimitBytes,
                                           SpanContext parentSpan,
                                           Optional<ReadOptions> options,
-                                          Optional<KeyRef> tenantPrefix) {
+                                          Optional<KeyRef> tenantPrefix,
+                                          ReadEngineCost* engineCost = nullptr,
+                                          ReadCpuTimer* cpuTimer = nullptr,
+                                          bool keysOnly = false) {
 	state GetKeyValuesReply result;
 	state StorageServer::VersionedData::ViewAtVersion view = data->data().at(version);
 	state StorageServer::VersionedData::iterator vCurrent = view.end();
@@ -4247,7 +5133,8 @@ ACTOR Future<GetKeyValuesReply> readRange(StorageServer* data,
 				while (vCurrent && vCurrent.key() < range.end && !vCurrent->isClearTo() && vCount < limit &&
 				       vSize < *pLimitBytes) {
 					// Store the versionedData results in resultCache
-					resultCache.emplace_back(result.arena, vCurrent.key(), vCurrent->getValue());
+					resultCache.emplace_back(
+					    result.arena, vCurrent.key(), keysOnly ? ValueRef() : vCurrent->getValue());
 					vSize += sizeof(KeyValueRef) + resultCache.cback().expectedSize() -
 					         (tenantPrefix.present() ? tenantPrefix.get().size() : 0);
 					++vCount;
@@ -4257,11 +5144,23 @@ ACTOR Future<GetKeyValuesReply> readRange(StorageServer* data,
 
 			// Read the data on disk up to vCurrent (or the end of the range)
 			readEnd = vCurrent ? std::min(vCurrent.key(), range.end) : range.end;
-			RangeResult atStorageVersion =
-			    wait(data->storage.readRange(KeyRangeRef(readBegin, readEnd), limit, *pLimitBytes, options));
+			Future<RangeResult> fRange =
+			    keysOnly ? data->storage.readKeys(KeyRangeRef(readBegin, readEnd), limit, *pLimitBytes, options)
+			             : data->storage.readRange(KeyRangeRef(readBegin, readEnd), limit, *pLimitBytes, options);
+			if (cpuTimer) {
+				cpuTimer->stop();
+			}
+			RangeResult atStorageVersion = wait(fRange);
+			if (cpuTimer) {
+				cpuTimer->start();
+			}
 			logicalSize = atStorageVersion.logicalSize();
 			data->counters.kvScanBytes += logicalSize;
 			resultLogicalSize += logicalSize;
+			if (engineCost) {
+				engineCost->bytesScanned += logicalSize;
+				++engineCost->reads;
+			}
 			data->readRangeBytesLimitHistogram->sample(*pLimitBytes);
 
 			ASSERT(atStorageVersion.size() <= limit);
@@ -4349,7 +5248,8 @@ ACTOR Future<GetKeyValuesReply> readRange(StorageServer* data,
 				while (vCurrent && vCurrent.key() >= range.begin && !vCurrent->isClearTo() && vCount < -limit &&
 				       vSize < *pLimitBytes) {
 					// Store the versionedData results in resultCache
-					resultCache.emplace_back(result.arena, vCurrent.key(), vCurrent->getValue());
+					resultCache.emplace_back(
+					    result.arena, vCurrent.key(), keysOnly ? ValueRef() : vCurrent->getValue());
 					vSize += sizeof(KeyValueRef) + resultCache.cback().expectedSize() -
 					         (tenantPrefix.present() ? tenantPrefix.get().size() : 0);
 					++vCount;
@@ -4359,11 +5259,23 @@ ACTOR Future<GetKeyValuesReply> readRange(StorageServer* data,
 
 			readBegin = vCurrent ? std::max(vCurrent->isClearTo() ? vCurrent->getEndKey() : vCurrent.key(), range.begin)
 			                     : range.begin;
-			RangeResult atStorageVersion =
-			    wait(data->storage.readRange(KeyRangeRef(readBegin, readEnd), limit, *pLimitBytes, options));
+			Future<RangeResult> fRange =
+			    keysOnly ? data->storage.readKeys(KeyRangeRef(readBegin, readEnd), limit, *pLimitBytes, options)
+			             : data->storage.readRange(KeyRangeRef(readBegin, readEnd), limit, *pLimitBytes, options);
+			if (cpuTimer) {
+				cpuTimer->stop();
+			}
+			RangeResult atStorageVersion = wait(fRange);
+			if (cpuTimer) {
+				cpuTimer->start();
+			}
 			logicalSize = atStorageVersion.logicalSize();
 			data->counters.kvScanBytes += logicalSize;
 			resultLogicalSize += logicalSize;
+			if (engineCost) {
+				engineCost->bytesScanned += logicalSize;
+				++engineCost->reads;
+			}
 			data->readRangeBytesLimitHistogram->sample(*pLimitBytes);
 
 			ASSERT(atStorageVersion.size() <= -limit);
@@ -4462,6 +5374,8 @@ ACTOR Future<Key> findKey(StorageServer* data,
 		               ? SERVER_KNOBS->BUGGIFY_LIMIT_BYTES
 		               : SERVER_KNOBS->STORAGE_LIMIT_BYTES;
 
+	// Only the keys are needed, so the values skipped over aren't read where the engine can avoid it, and don't count
+	// towards maxBytes: a large offset is resolved with fewer reads, and fewer round trips from the client.
 	state GetKeyValuesReply rep = wait(
 	    readRange(data,
 	              version,
@@ -4470,7 +5384,10 @@ ACTOR Future<Key> findKey(StorageServer* data,
 	              &maxBytes,
 	              span.context,
 	              options,
-	              {}));
+	              {},
+	              nullptr,
+	              nullptr,
+	              true));
 	state bool more = rep.more && rep.data.size() != distance + skipEqualKey;
 
 	// If we get only one result in the reverse direction as a result of the data being too large, we could get stuck in
@@ -4478,8 +5395,17 @@ ACTOR Future<Key> findKey(StorageServer* data,
 	if (more && !forward && rep.data.size() == 1) {
 		CODE_PROBE(true, "Reverse key selector returned only one result in range read");
 		maxBytes = std::numeric_limits<int>::max();
-		GetKeyValuesReply rep2 = wait(readRange(
-		    data, version, KeyRangeRef(range.begin, keyAfter(sel.getKey())), -2, &maxBytes, span.context, options, {}));
+		GetKeyValuesReply rep2 = wait(readRange(data,
+		                                        version,
+		                                        KeyRangeRef(range.begin, keyAfter(sel.getKey())),
+		                                        -2,
+		                                        &maxBytes,
+		                                        span.context,
+		                                        options,
+		                                        {},
+		                                        nullptr,
+		                                        nullptr,
+		                                        true));
 		rep = rep2;
 		more = rep.more && rep.data.size() != distance + skipEqualKey;
 		ASSERT(rep.data.size() == 2 || !more);
@@ -4634,6 +5560,8 @@ ACTOR Future<Void> getKeyValuesQ(StorageServer* data, GetKeyValuesRequest req)
 {
 	state Span span("SS:getKeyValues"_loc, req.spanContext);
 	state int64_t resultSize = 0;
+	state ReadEngineCost engineCost;
+	state ReadCpuTimer cpuTimer(data->readResourceCounter.sampleRead());
 
 	getCurrentLineage()->modify(&TransactionLineage::txID) = req.spanContext.traceID;
 
@@ -4649,19 +5577,32 @@ ACTOR Future<Void> getKeyValuesQ(StorageServer* data, GetKeyValuesRequest req)
 	// Active load balancing runs at a very high priority (to obtain accurate queue lengths)
 	// so we need to downgrade here
 	wait(data->getQueryDelay());
-	state PriorityMultiLock::Lock readLock = wait(data->getReadLock(req.options));
+	state PriorityMultiLock::Lock readLock = wait(data->getReadLock(
+	    req.options, data->expectedReadBytes(req.tenantInfo, req.begin.getKey(), req.end.getKey(), req.limitBytes)));
+	cpuTimer.start();
 
 	// Track time from requestTime through now as read queueing wait time
 	state double queueWaitEnd = g_network->timer();
-	data->counters.readQueueWaitSample.addMeasurement(queueWaitEnd - req.requestTime());
+	data->recordReadQueueWait(req.options, queueWaitEnd - req.requestTime());
 
 	try {
+		data->checkReadBudget(req.options, queueWaitEnd - req.requestTime());
 		if (req.options.present() && req.options.get().debugID.present())
 			g_traceBatch.addEvent(
 			    "TransactionDebug", req.options.get().debugID.get().first(), "storageserver.getKeyValues.Before");
 
 		Version commitVersion = getLatestCommitVersion(req.ssLatestCommitVersions, data->tag);
-		state Version version = wait(waitForVersion(data, commitVersion, req.version, span.context));
+		state Version readLag = getReadVersionLag(data, commitVersion, req.version);
+		// Only reads of the keys between two keys are served from old versions
+		state bool oldVersion = req.begin.isFirstGreaterOrEqual() && req.end.isFirstGreaterOrEqual() &&
+		                        readsOldVersion(data, req.version, req.options);
+		cpuTimer.stop();
+		state Version version = wait(oldVersion ? waitForOldVersion(data, req.version)
+		                                        : waitForVersion(data, commitVersion, req.version, span.context));
+		// Reads of old versions don't hold back the discarding of versions from memory, which they don't read
+		state ActiveReadVersions::Read activeRead =
+		    oldVersion ? ActiveReadVersions::Read() : ActiveReadVersions::Read(data->activeReads, version);
+		cpuTimer.start();
 		DisabledTraceEvent("VVV", data->thisServerID)
 		    .detail("Version", version)
 		    .detail("ReqVersion", req.version)
@@ -4672,13 +5613,17 @@ ACTOR Future<Void> getKeyValuesQ(StorageServer* data, GetKeyValuesRequest req)
 		                                                                         : UID());
 		data->counters.readVersionWaitSample.addMeasurement(g_network->timer() - queueWaitEnd);
 
-		data->checkTenantEntry(version, req.tenantInfo, req.options.present() ? req.options.get().lockAware : false);
+		// The tenant map doesn't go back as far as an old version, so its tenant is checked at the latest version
+		data->checkTenantEntry(oldVersion ? latestVersion : version,
+		                       req.tenantInfo,
+		                       req.options.present() ? req.options.get().lockAware : false);
 		if (req.tenantInfo.hasTenant()) {
 			req.begin.setKeyUnlimited(req.begin.getKey().withPrefix(req.tenantInfo.prefix.get(), req.arena));
 			req.end.setKeyUnlimited(req.end.getKey().withPrefix(req.tenantInfo.prefix.get(), req.arena));
 		}
 
-		state uint64_t changeCounter = data->shardChangeCounter;
+		// The shards of an old version must not have changed since
+		state uint64_t changeCounter = oldVersion ? data->changeCounterAt(version) : data->shardChangeCounter;
 		//		try {
 		state KeyRange shard = getShardKeyRange(data, req.begin);
 
@@ -4709,8 +5654,10 @@ ACTOR Future<Void> getKeyValuesQ(StorageServer* data, GetKeyValuesRequest req)
 		    req.end.isFirstGreaterOrEqual()
 		        ? Future<Key>(req.end.getKey())
 		        : findKey(data, req.end, version, searchRange, &offset2, span.context, req.options);
+		cpuTimer.stop();
 		state Key begin = wait(fBegin);
 		state Key end = wait(fEnd);
+		cpuTimer.start();
 
 		if (req.options.present() && req.options.get().debugID.present())
 			g_traceBatch.addEvent(
@@ -4741,6 +5688,7 @@ ACTOR Future<Void> getKeyValuesQ(StorageServer* data, GetKeyValuesRequest req)
 			none.version = version;
 			none.more = false;
 			none.penalty = data->getPenalty();
+			none.versionLag = readLag;
 
 			data->checkChangeCounter(changeCounter,
 			                         KeyRangeRef(std::min<KeyRef>(req.begin.getKey(), req.end.getKey()),
@@ -4754,14 +5702,25 @@ ACTOR Future<Void> getKeyValuesQ(StorageServer* data, GetKeyValuesRequest req)
 			state int remainingLimitBytes = req.limitBytes;
 
 			state double kvReadRange = g_network->timer();
-			GetKeyValuesReply _r = wait(readRange(data,
-			                                      version,
-			                                      KeyRangeRef(begin, end),
-			                                      req.limit,
-			                                      &remainingLimitBytes,
-			                                      span.context,
-			                                      req.options,
-			                                      req.tenantInfo.prefix));
+			GetKeyValuesReply _r = wait(oldVersion ? readRangeAtOldVersion(data,
+			                                                               version,
+			                                                               KeyRangeRef(begin, end),
+			                                                               req.limit,
+			                                                               &remainingLimitBytes,
+			                                                               req.options,
+			                                                               req.tenantInfo.prefix,
+			                                                               &engineCost,
+			                                                               &cpuTimer)
+			                                       : readRange(data,
+			                                                   version,
+			                                                   KeyRangeRef(begin, end),
+			                                                   req.limit,
+			                                                   &remainingLimitBytes,
+			                                                   span.context,
+			                                                   req.options,
+			                                                   req.tenantInfo.prefix,
+			                                                   &engineCost,
+			                                                   &cpuTimer));
 			const double duration = g_network->timer() - kvReadRange;
 			data->counters.kvReadRangeLatencySample.addMeasurement(duration);
 			GetKeyValuesReply r = _r;
@@ -4801,10 +5760,17 @@ ACTOR Future<Void> getKeyValuesQ(StorageServer* data, GetKeyValuesRequest req)
 			}
 
 			r.penalty = data->getPenalty();
+			r.versionLag = readLag;
 			if (g_network->isSimulated()) {
 				maybeInjectConsistencyScanCorruption(data->thisServerID, req, r);
 			}
-			req.reply.send(r);
+			if (req.prefixCompressReply) {
+				GetKeyValuesReply compressed = r;
+				compressed.prefixCompressData();
+				req.reply.send(compressed);
+			} else {
+				req.reply.send(r);
+			}
 
 			resultSize = req.limitBytes - remainingLimitBytes;
 			data->counters.bytesQueried += resultSize;
@@ -4819,7 +5785,16 @@ ACTOR Future<Void> getKeyValuesQ(StorageServer* data, GetKeyValuesRequest req)
 		data->sendErrorWithPenalty(req.reply, e, data->getPenalty());
 	}
 
-	data->transactionTagCounter.addRequest(req.tags, resultSize);
+	data->transactionTagCounter.addRequest(req.tags, resultSize, engineCost);
+	cpuTimer.stop();
+	if (cpuTimer.isSampled()) {
+		data->readResourceCounter.addRequest(ReadRequestType::GET_KEY_VALUES,
+		                                     req.tenantInfo.tenantId,
+		                                     req.tags,
+		                                     cpuTimer.getSeconds(),
+		                                     engineCost,
+		                                     resultSize);
+	}
 	++data->counters.finishedQueries;
 
 	double duration = g_network->timer() - req.requestTime();
@@ -4840,6 +5815,83 @@ ACTOR Future<Void> getKeyValuesQ(StorageServer* data, GetKeyValuesRequest req)
 	return Void();
 }
 
+// Replies with a checksum of each of req.ranges at its version, so replicas can be compared without sending their data.
+// The ranges are checksummed in order until CONSISTENCY_SCAN_CHECKSUM_BYTES of data are covered, so the last checksum
+// can cover only the beginning of its range and the reply can have fewer checksums than req has ranges.
+ACTOR Future<Void> getStorageCheckSumQ(StorageServer* data, GetStorageCheckSumRequest req) {
+	state Span span("SS:getCheckSum"_loc);
+	state ReadOptions options;
+	options.type = ReadType::LOW;
+	options.cacheResult = CacheResult::False;
+	state GetStorageCheckSumReply reply;
+	reply.checkSumMethod = req.checkSumMethod;
+	if (req.checkSumMethod != static_cast<uint8_t>(CheckSumMethod::XXHash3)) {
+		req.reply.sendError(not_implemented());
+		return Void();
+	}
+
+	wait(data->getQueryDelay());
+	state PriorityMultiLock::Lock readLock = wait(data->getReadLock(options));
+	try {
+		state int remainingBytes = SERVER_KNOBS->CONSISTENCY_SCAN_CHECKSUM_BYTES;
+		state int i = 0;
+		for (; i < req.ranges.size() && remainingBytes > 0; ++i) {
+			state KeyRange range = req.ranges[i].first;
+			state Version version =
+			    wait(waitForVersion(data, req.ranges[i].second.orDefault(latestVersion), span.context));
+			state uint64_t changeCounter = data->shardChangeCounter;
+			if (!getShardKeyRange(data, firstGreaterOrEqual(range.begin)).contains(range)) {
+				throw wrong_shard_server();
+			}
+
+			state uint64_t hash = 0;
+			state int64_t checkedBytes = 0;
+			state Key end = range.begin;
+			loop {
+				state int limitBytes = remainingBytes;
+				GetKeyValuesReply r = wait(readRange(data,
+				                                     version,
+				                                     KeyRangeRef(end, range.end),
+				                                     std::numeric_limits<int>::max(),
+				                                     &limitBytes,
+				                                     span.context,
+				                                     options,
+				                                     Optional<KeyRef>()));
+				data->checkChangeCounter(changeCounter, range);
+				for (const auto& kv : r.data) {
+					hash = XXH3_64bits_withSeed(kv.key.begin(), kv.key.size(), hash);
+					hash = XXH3_64bits_withSeed(kv.value.begin(), kv.value.size(), hash);
+					checkedBytes += kv.expectedSize();
+				}
+				remainingBytes = limitBytes;
+				if (!r.more) {
+					end = range.end;
+					break;
+				}
+				ASSERT(!r.data.empty());
+				end = keyAfter(r.data.back().key);
+				if (remainingBytes <= 0) {
+					break;
+				}
+			}
+
+			uint64_t value = bigEndian64(hash);
+			reply.checkSums.emplace_back(KeyRangeRef(range.begin, end),
+			                             version,
+			                             StringRef(reply.arena, (const uint8_t*)&value, sizeof(value)),
+			                             checkedBytes);
+		}
+		reply.penalty = data->getPenalty();
+		req.reply.send(reply);
+	} catch (Error& e) {
+		if (!canReplyWith(e)) {
+			throw;
+		}
+		req.reply.sendError(e);
+	}
+	return Void();
+}
+
 ACTOR Future<GetRangeReqAndResultRef> quickGetKeyValues(
     StorageServer* data,
     StringRef prefix,
@@ -4931,7 +5983,7 @@ void unpackKeyTuple(Tuple** referenceTuple, Optional<Tuple>& keyTuple, KeyValueR
 	if (!keyTuple.present()) {
 		// May throw exception if the key is not parsable as a tuple.
 		try {
-			keyTuple = Tuple::unpack(keyValue->key);
+			keyTuple = Tuple::unpackView(keyValue->key);
 		} catch (Error& e) {
 			TraceEvent("KeyNotTuple").error(e).detail("Key", keyValue->key.printable());
 			throw key_not_tuple();
@@ -4944,7 +5996,7 @@ void unpackValueTuple(Tuple** referenceTuple, Optional<Tuple>& valueTuple, KeyVa
 	if (!valueTuple.present()) {
 		// May throw exception if the value is not parsable as a tuple.
 		try {
-			valueTuple = Tuple::unpack(keyValue->value);
+			valueTuple = Tuple::unpackView(keyValue->value);
 		} catch (Error& e) {
 			TraceEvent("ValueNotTuple").error(e).detail("Value", keyValue->value.printable());
 			throw value_not_tuple();
@@ -5018,7 +6070,8 @@ void preprocessMappedKey(Tuple& mappedKeyFormatTuple, std::vector<Optional<Tuple
 }
 
 Key constructMappedKey(KeyValueRef* keyValue, std::vector<Optional<Tuple>>& vec, Tuple& mappedKeyFormatTuple) {
-	// Lazily parse key and/or value to tuple because they may not need to be a tuple if not used.
+	// Lazily parse key and/or value to tuple because they may not need to be a tuple if not used. The tuples view
+	// keyValue rather than copying it, and only their elements copied into mappedKeyTuple outlive this function.
 	Optional<Tuple> keyTuple;
 	Optional<Tuple> valueTuple;
 	Tuple mappedKeyTuple;
@@ -5150,8 +6203,6 @@ ACTOR Future<Void> auditStorageServerShardQ(StorageServer* data, AuditStorageReq
 	state int retryCount = 0;
 	state int64_t cumulatedValidatedLocalShardsNum = 0;
 	state int64_t cumulatedValidatedServerKeysNum = 0;
-	state Reference<IRateControl> rateLimiter =
-	    Reference<IRateControl>(new SpeedLimit(SERVER_KNOBS->AUDIT_STORAGE_RATE_PER_SERVER_MAX, 1));
 	state int64_t remoteReadBytes = 0;
 	state double startTime = now();
 	state double lastRateLimiterWaitTime = 0;
@@ -5213,7 +6264,7 @@ ACTOR Future<Void> auditStorageServerShardQ(StorageServer* data, AuditStorageReq
 						failureReason = "Read serverKeys retry count exceeds the max";
 						throw audit_storage_failed();
 					}
-					wait(rateLimiter->getAllowance(remoteReadBytes)); // RateKeeping
+					wait(data->auditStorageRateLimiter->getAllowance(remoteReadBytes)); // RateKeeping
 					retryCount++;
 					wait(delay(0.5));
 					tr.reset();
@@ -5482,7 +6533,7 @@ ACTOR Future<Void> auditStorageServerShardQ(StorageServer* data, AuditStorageReq
 			}
 
 			rateLimiterBeforeWaitTime = now();
-			wait(rateLimiter->getAllowance(remoteReadBytes)); // RateKeeping
+			wait(data->auditStorageRateLimiter->getAllowance(remoteReadBytes)); // RateKeeping
 			lastRateLimiterWaitTime = now() - rateLimiterBeforeWaitTime;
 			rateLimiterTotalWaitTime = rateLimiterTotalWaitTime + lastRateLimiterWaitTime;
 		}
@@ -5521,8 +6572,8 @@ ACTOR Future<Void> auditStorageServerShardQ(StorageServer* data, AuditStorageReq
 
 ACTOR Future<Void> auditStorageShardReplicaQ(StorageServer* data, AuditStorageRequest req) {
 	ASSERT(req.getType() == AuditType::ValidateHA || req.getType() == AuditType::ValidateReplica);
-	wait(data->serveAuditStorageParallelismLock.take(TaskPriority::DefaultYield));
-	state FlowLock::Releaser holder(data->serveAuditStorageParallelismLock);
+	wait(data->serveAuditStorageReplicaParallelismLock.take(TaskPriority::DefaultYield));
+	state FlowLock::Releaser holder(data->serveAuditStorageReplicaParallelismLock);
 
 	TraceEvent(SevInfo, "SSAuditStorageShardReplicaBegin", data->thisServerID)
 	    .detail("AuditID", req.id)
@@ -5550,8 +6601,6 @@ ACTOR Future<Void> auditStorageShardReplicaQ(StorageServer* data, AuditStorageRe
 	state double lastRateLimiterWaitTime = 0;
 	state double rateLimiterBeforeWaitTime = 0;
 	state double rateLimiterTotalWaitTime = 0;
-	state Reference<IRateControl> rateLimiter =
-	    Reference<IRateControl>(new SpeedLimit(SERVER_KNOBS->AUDIT_STORAGE_RATE_PER_SERVER_MAX, 1));
 
 	try {
 		loop {
@@ -5585,130 +6634,244 @@ ACTOR Future<Void> auditStorageShardReplicaQ(StorageServer* data, AuditStorageRe
 				// Decide version to compare
 				wait(store(version, tr.getReadVersion()));
 
-				// Read remote servers
-				for (const auto& v : serverListValues) {
-					if (!v.present()) {
-						TraceEvent(SevWarn, "SSAuditStorageShardReplicaRemoteServerNotFound", data->thisServerID)
-						    .detail("AuditID", req.id)
-						    .detail("AuditRange", req.range)
-						    .detail("AuditType", req.type);
-						throw audit_storage_failed();
+				// Compare checksums of the range from all replicas first, and only read and compare the data of the
+				// range when they differ
+				state bool checkSumsMatch = false;
+				if (SERVER_KNOBS->AUDIT_STORAGE_USE_CHECKSUMS && !SERVER_KNOBS->ENABLE_VERSION_VECTOR &&
+				    !serverListValues.empty() &&
+				    std::all_of(serverListValues.begin(), serverListValues.end(), [](const Optional<Value>& v) {
+					    return v.present();
+				    })) {
+					state std::vector<Future<ErrorOr<GetStorageCheckSumReply>>> checkSumReplies;
+					GetStorageCheckSumRequest checkSumReq(
+					    { { rangeToRead, version } }, req.id, CheckSumMethod::XXHash3);
+					for (const auto& v : serverListValues) {
+						resetReply(checkSumReq);
+						checkSumReplies.push_back(
+						    decodeServerListValue(v.get()).getCheckSum.getReplyUnlessFailedFor(checkSumReq, 2, 0));
 					}
-					StorageServerInterface remoteServer = decodeServerListValue(v.get());
-
-					GetKeyValuesRequest req;
-					req.begin = firstGreaterOrEqual(rangeToRead.begin);
-					req.end = firstGreaterOrEqual(rangeToRead.end);
-					req.limit = limit;
-					req.limitBytes = limitBytes;
-					req.version = version;
-					req.tags = TagSet();
-					fs.push_back(remoteServer.getKeyValues.getReplyUnlessFailedFor(req, 2, 0));
-				}
-
-				// Read local server
-				GetKeyValuesRequest localReq;
-				localReq.begin = firstGreaterOrEqual(rangeToRead.begin);
-				localReq.end = firstGreaterOrEqual(rangeToRead.end);
-				localReq.limit = limit;
-				localReq.limitBytes = limitBytes;
-				localReq.version = version;
-				localReq.tags = TagSet();
-				data->actors.add(getKeyValuesQ(data, localReq));
-				fs.push_back(errorOr(localReq.reply.getFuture()));
-				std::vector<ErrorOr<GetKeyValuesReply>> reps = wait(getAll(fs));
-				// Note: getAll() must keep the order of fs
-
-				// Check read result
-				for (int i = 0; i < reps.size(); ++i) {
-					if (reps[i].isError()) {
-						TraceEvent(SevWarn, "SSAuditStorageShardReplicaGetKeyValuesError", data->thisServerID)
-						    .errorUnsuppressed(reps[i].getError())
-						    .detail("AuditID", req.id)
-						    .detail("AuditRange", req.range)
-						    .detail("AuditType", req.type)
-						    .detail("ReplyIndex", i)
-						    .detail("RangeRead", rangeToRead);
-						throw reps[i].getError();
+					resetReply(checkSumReq);
+					data->actors.add(getStorageCheckSumQ(data, checkSumReq));
+					checkSumReplies.push_back(errorOr(checkSumReq.reply.getFuture()));
+					wait(waitForAll(checkSumReplies));
+
+					// Replicas that fail to checksum the range are left to the data comparison to report
+					checkSumsMatch = std::all_of(
+					    checkSumReplies.begin(),
+					    checkSumReplies.end(),
+					    [](const Future<ErrorOr<GetStorageCheckSumReply>>& reply) {
+						    return reply.get().present() && reply.get().get().checkSums.size() == 1;
+					    });
+					int64_t checkedBytes = 0;
+					for (int i = 0; checkSumsMatch && i < checkSumReplies.size(); ++i) {
+						const CheckSumMetaData& checkSum = checkSumReplies[i].get().get().checkSums[0];
+						const CheckSumMetaData& local = checkSumReplies.back().get().get().checkSums[0];
+						checkSumsMatch = checkSum.range == local.range && checkSum.checkSumValue == local.checkSumValue;
+						checkedBytes += checkSum.checkedBytes;
 					}
-					if (reps[i].get().error.present()) {
-						TraceEvent(SevWarn, "SSAuditStorageShardReplicaGetKeyValuesError", data->thisServerID)
-						    .errorUnsuppressed(reps[i].get().error.get())
+					if (checkSumsMatch) {
+						claimRange = checkSumReplies.back().get().get().checkSums[0].range;
+						complete = claimRange.end == req.range.end;
+						readBytes += checkedBytes;
+						validatedBytes += checkedBytes;
+					} else {
+						CODE_PROBE(true, "Audit storage replica checksums differ");
+						TraceEvent(SevInfo, "SSAuditStorageShardReplicaCheckSumMismatch", data->thisServerID)
+						    .suppressFor(10.0)
 						    .detail("AuditID", req.id)
 						    .detail("AuditRange", req.range)
-						    .detail("AuditType", req.type)
-						    .detail("ReplyIndex", i)
-						    .detail("RangeRead", rangeToRead);
-						throw reps[i].get().error.get();
-					}
-					readBytes = readBytes + reps[i].get().data.expectedSize();
-					validatedBytes = validatedBytes + reps[i].get().data.expectedSize();
-					// If any of reps finishes read, we think we complete
-					// Even some rep does not finish read, this unfinished rep has more key than
-					// the complete rep, which will lead to missKey inconsistency in
-					// this round of check
-					if (!reps[i].get().more) {
-						complete = true;
+						    .detail("RangeRead", rangeToRead)
+						    .detail("Version", version);
 					}
 				}
 
-				// Validation
-				claimRange = rangeToRead;
-				const GetKeyValuesReply& local = reps.back().get();
-				if (serverListValues.size() != reps.size() - 1) {
-					TraceEvent(g_network->isSimulated() ? SevError : SevWarnAlways,
-					           "SSAuditStorageShardReplicaRepsLengthWrong",
-					           data->thisServerID)
-					    .detail("ServerListValuesSize", serverListValues.size())
-					    .detail("RepsSize", reps.size());
-					throw audit_storage_cancelled();
-				}
-				if (reps.size() == 1) {
-					// if no other server to compare
-					TraceEvent(SevWarn, "SSAuditStorageShardReplicaNothingToCompare", data->thisServerID)
-					    .detail("AuditID", req.id)
-					    .detail("AuditRange", req.range)
-					    .detail("AuditType", req.type)
-					    .detail("TargetServers", describe(req.targetServers));
-					complete = true;
-				}
-				// Compare local and each remote one by one
-				// The last one of reps is local, so skip it
-				for (int repIdx = 0; repIdx < reps.size() - 1; repIdx++) {
-					const GetKeyValuesReply& remote = reps[repIdx].get();
-					// serverListValues and reps should be same order
-					if (!serverListValues[repIdx].present()) { // if not, already throw audit_storage_failed
+				if (!checkSumsMatch) {
+					// Read remote servers
+					for (const auto& v : serverListValues) {
+						if (!v.present()) {
+							TraceEvent(SevWarn, "SSAuditStorageShardReplicaRemoteServerNotFound", data->thisServerID)
+							    .detail("AuditID", req.id)
+							    .detail("AuditRange", req.range)
+							    .detail("AuditType", req.type);
+							throw audit_storage_failed();
+						}
+						StorageServerInterface remoteServer = decodeServerListValue(v.get());
+
+						GetKeyValuesRequest req;
+						req.begin = firstGreaterOrEqual(rangeToRead.begin);
+						req.end = firstGreaterOrEqual(rangeToRead.end);
+						req.limit = limit;
+						req.limitBytes = limitBytes;
+						req.version = version;
+						req.tags = TagSet();
+						fs.push_back(remoteServer.getKeyValues.getReplyUnlessFailedFor(req, 2, 0));
+					}
+
+					// Read local server
+					GetKeyValuesRequest localReq;
+					localReq.begin = firstGreaterOrEqual(rangeToRead.begin);
+					localReq.end = firstGreaterOrEqual(rangeToRead.end);
+					localReq.limit = limit;
+					localReq.limitBytes = limitBytes;
+					localReq.version = version;
+					localReq.tags = TagSet();
+					data->actors.add(getKeyValuesQ(data, localReq));
+					fs.push_back(errorOr(localReq.reply.getFuture()));
+					std::vector<ErrorOr<GetKeyValuesReply>> reps = wait(getAll(fs));
+					// Note: getAll() must keep the order of fs
+
+					// Check read result
+					for (int i = 0; i < reps.size(); ++i) {
+						if (reps[i].isError()) {
+							TraceEvent(SevWarn, "SSAuditStorageShardReplicaGetKeyValuesError", data->thisServerID)
+							    .errorUnsuppressed(reps[i].getError())
+							    .detail("AuditID", req.id)
+							    .detail("AuditRange", req.range)
+							    .detail("AuditType", req.type)
+							    .detail("ReplyIndex", i)
+							    .detail("RangeRead", rangeToRead);
+							throw reps[i].getError();
+						}
+						if (reps[i].get().error.present()) {
+							TraceEvent(SevWarn, "SSAuditStorageShardReplicaGetKeyValuesError", data->thisServerID)
+							    .errorUnsuppressed(reps[i].get().error.get())
+							    .detail("AuditID", req.id)
+							    .detail("AuditRange", req.range)
+							    .detail("AuditType", req.type)
+							    .detail("ReplyIndex", i)
+							    .detail("RangeRead", rangeToRead);
+							throw reps[i].get().error.get();
+						}
+						readBytes = readBytes + reps[i].get().data.expectedSize();
+						validatedBytes = validatedBytes + reps[i].get().data.expectedSize();
+						// If any of reps finishes read, we think we complete
+						// Even some rep does not finish read, this unfinished rep has more key than
+						// the complete rep, which will lead to missKey inconsistency in
+						// this round of check
+						if (!reps[i].get().more) {
+							complete = true;
+						}
+					}
+
+					// Validation
+					claimRange = rangeToRead;
+					const GetKeyValuesReply& local = reps.back().get();
+					if (serverListValues.size() != reps.size() - 1) {
 						TraceEvent(g_network->isSimulated() ? SevError : SevWarnAlways,
-						           "SSAuditStorageShardReplicaRepIdxNotPresent",
+						           "SSAuditStorageShardReplicaRepsLengthWrong",
 						           data->thisServerID)
-						    .detail("RepIdx", repIdx);
+						    .detail("ServerListValuesSize", serverListValues.size())
+						    .detail("RepsSize", reps.size());
 						throw audit_storage_cancelled();
 					}
-					const StorageServerInterface& remoteServer = decodeServerListValue(serverListValues[repIdx].get());
-					Key lastKey = rangeToRead.begin;
-					const int end = std::min(local.data.size(), remote.data.size());
-					bool missingKey = local.data.size() != remote.data.size();
-					// Compare each key one by one
-					std::string error;
-					int i = 0;
-					for (; i < end; ++i) {
-						KeyValueRef remoteKV = remote.data[i];
-						KeyValueRef localKV = local.data[i];
-						if (!req.range.contains(remoteKV.key) || !req.range.contains(localKV.key)) {
-							TraceEvent(SevWarn, "SSAuditStorageShardReplicaKeyOutOfRange", data->thisServerID)
-							    .detail("AuditRange", req.range)
-							    .detail("RemoteServer", remoteServer.toString())
-							    .detail("LocalKey", localKV.key)
-							    .detail("RemoteKey", remoteKV.key);
-							throw wrong_shard_server();
+					if (reps.size() == 1) {
+						// if no other server to compare
+						TraceEvent(SevWarn, "SSAuditStorageShardReplicaNothingToCompare", data->thisServerID)
+						    .detail("AuditID", req.id)
+						    .detail("AuditRange", req.range)
+						    .detail("AuditType", req.type)
+						    .detail("TargetServers", describe(req.targetServers));
+						complete = true;
+					}
+					// Compare local and each remote one by one
+					// The last one of reps is local, so skip it
+					for (int repIdx = 0; repIdx < reps.size() - 1; repIdx++) {
+						const GetKeyValuesReply& remote = reps[repIdx].get();
+						// serverListValues and reps should be same order
+						if (!serverListValues[repIdx].present()) { // if not, already throw audit_storage_failed
+							TraceEvent(g_network->isSimulated() ? SevError : SevWarnAlways,
+							           "SSAuditStorageShardReplicaRepIdxNotPresent",
+							           data->thisServerID)
+							    .detail("RepIdx", repIdx);
+							throw audit_storage_cancelled();
+						}
+						const StorageServerInterface& remoteServer =
+						    decodeServerListValue(serverListValues[repIdx].get());
+						Key lastKey = rangeToRead.begin;
+						const int end = std::min(local.data.size(), remote.data.size());
+						bool missingKey = local.data.size() != remote.data.size();
+						// Compare each key one by one
+						std::string error;
+						int i = 0;
+						for (; i < end; ++i) {
+							KeyValueRef remoteKV = remote.data[i];
+							KeyValueRef localKV = local.data[i];
+							if (!req.range.contains(remoteKV.key) || !req.range.contains(localKV.key)) {
+								TraceEvent(SevWarn, "SSAuditStorageShardReplicaKeyOutOfRange", data->thisServerID)
+								    .detail("AuditRange", req.range)
+								    .detail("RemoteServer", remoteServer.toString())
+								    .detail("LocalKey", localKV.key)
+								    .detail("RemoteKey", remoteKV.key);
+								throw wrong_shard_server();
+							}
+							// Check if mismatch
+							if (remoteKV.key != localKV.key) {
+								error = format("Key Mismatch: local server (%016llx): %s, remote server(%016llx) %s",
+								               data->thisServerID.first(),
+								               Traceable<StringRef>::toString(localKV.key).c_str(),
+								               remoteServer.uniqueID.first(),
+								               Traceable<StringRef>::toString(remoteKV.key).c_str());
+								TraceEvent(SevError, "SSAuditStorageShardReplicaError", data->thisServerID)
+								    .setMaxFieldLength(-1)
+								    .setMaxEventLength(-1)
+								    .detail("AuditId", req.id)
+								    .detail("AuditRange", req.range)
+								    .detail("ErrorMessage", error)
+								    .detail("Version", version)
+								    .detail("ClaimRange", claimRange);
+								errors.push_back(error);
+								break;
+							} else if (remoteKV.value != localKV.value) {
+								error = format(
+								    "Value Mismatch for Key %s: local server (%016llx): %s, remote server(%016llx) %s",
+								    Traceable<StringRef>::toString(localKV.key).c_str(),
+								    data->thisServerID.first(),
+								    Traceable<StringRef>::toString(localKV.value).c_str(),
+								    remoteServer.uniqueID.first(),
+								    Traceable<StringRef>::toString(remoteKV.value).c_str());
+								TraceEvent(SevError, "SSAuditStorageShardReplicaError", data->thisServerID)
+								    .setMaxFieldLength(-1)
+								    .setMaxEventLength(-1)
+								    .detail("AuditId", req.id)
+								    .detail("AuditRange", req.range)
+								    .detail("ErrorMessage", error)
+								    .detail("Version", version)
+								    .detail("ClaimRange", claimRange);
+								errors.push_back(error);
+								break;
+							} else {
+								TraceEvent(SevVerbose, "SSAuditStorageShardReplicaValidatedKey", data->thisServerID)
+								    .detail("Key", localKV.key);
+							}
+							++numValidatedKeys;
+							lastKey = localKV.key;
+						}
+						KeyRange completeRange = Standalone(KeyRangeRef(rangeToRead.begin, keyAfter(lastKey)));
+						if (completeRange.empty() || claimRange.begin != completeRange.begin) {
+							TraceEvent(g_network->isSimulated() ? SevError : SevWarnAlways,
+							           "SSAuditStorageShardReplicaCompleteRangeUnexpected",
+							           data->thisServerID)
+							    .detail("ClaimRange", claimRange)
+							    .detail("CompleteRange", completeRange);
+							throw audit_storage_cancelled();
+						}
+						claimRange = claimRange & completeRange;
+						if (!error.empty()) { // if key or value mismatch detected
+							continue; // check next remote server
 						}
-						// Check if mismatch
-						if (remoteKV.key != localKV.key) {
-							error = format("Key Mismatch: local server (%016llx): %s, remote server(%016llx) %s",
-							               data->thisServerID.first(),
-							               Traceable<StringRef>::toString(localKV.key).c_str(),
-							               remoteServer.uniqueID.first(),
-							               Traceable<StringRef>::toString(remoteKV.key).c_str());
+						if (!local.more && !remote.more && local.data.size() == remote.data.size()) {
+							continue; // check next remote server
+						} else if (i >= local.data.size() && !local.more && i < remote.data.size()) {
+							if (!missingKey) {
+								TraceEvent(g_network->isSimulated() ? SevError : SevWarnAlways,
+								           "SSAuditStorageShardReplicaMissingKeyUnexpected",
+								           data->thisServerID);
+							}
+							std::string error =
+							    format("Missing key(s) form local server (%lld), next key: %s, remote server(%016llx) ",
+							           data->thisServerID.first(),
+							           Traceable<StringRef>::toString(remote.data[i].key).c_str(),
+							           remoteServer.uniqueID.first());
 							TraceEvent(SevError, "SSAuditStorageShardReplicaError", data->thisServerID)
 							    .setMaxFieldLength(-1)
 							    .setMaxEventLength(-1)
@@ -5718,15 +6881,18 @@ ACTOR Future<Void> auditStorageShardReplicaQ(StorageServer* data, AuditStorageRe
 							    .detail("Version", version)
 							    .detail("ClaimRange", claimRange);
 							errors.push_back(error);
-							break;
-						} else if (remoteKV.value != localKV.value) {
-							error = format(
-							    "Value Mismatch for Key %s: local server (%016llx): %s, remote server(%016llx) %s",
-							    Traceable<StringRef>::toString(localKV.key).c_str(),
-							    data->thisServerID.first(),
-							    Traceable<StringRef>::toString(localKV.value).c_str(),
-							    remoteServer.uniqueID.first(),
-							    Traceable<StringRef>::toString(remoteKV.value).c_str());
+							continue; // check next remote server
+						} else if (i >= remote.data.size() && !remote.more && i < local.data.size()) {
+							if (!missingKey) {
+								TraceEvent(g_network->isSimulated() ? SevError : SevWarnAlways,
+								           "SSAuditStorageShardReplicaMissingKeyUnexpected",
+								           data->thisServerID);
+							}
+							std::string error =
+							    format("Missing key(s) form remote server (%lld), next local server(%016llx) key: %s",
+							           remoteServer.uniqueID.first(),
+							           data->thisServerID.first(),
+							           Traceable<StringRef>::toString(local.data[i].key).c_str());
 							TraceEvent(SevError, "SSAuditStorageShardReplicaError", data->thisServerID)
 							    .setMaxFieldLength(-1)
 							    .setMaxEventLength(-1)
@@ -5736,71 +6902,8 @@ ACTOR Future<Void> auditStorageShardReplicaQ(StorageServer* data, AuditStorageRe
 							    .detail("Version", version)
 							    .detail("ClaimRange", claimRange);
 							errors.push_back(error);
-							break;
-						} else {
-							TraceEvent(SevVerbose, "SSAuditStorageShardReplicaValidatedKey", data->thisServerID)
-							    .detail("Key", localKV.key);
+							continue; // check next remote server
 						}
-						++numValidatedKeys;
-						lastKey = localKV.key;
-					}
-					KeyRange completeRange = Standalone(KeyRangeRef(rangeToRead.begin, keyAfter(lastKey)));
-					if (completeRange.empty() || claimRange.begin != completeRange.begin) {
-						TraceEvent(g_network->isSimulated() ? SevError : SevWarnAlways,
-						           "SSAuditStorageShardReplicaCompleteRangeUnexpected",
-						           data->thisServerID)
-						    .detail("ClaimRange", claimRange)
-						    .detail("CompleteRange", completeRange);
-						throw audit_storage_cancelled();
-					}
-					claimRange = claimRange & completeRange;
-					if (!error.empty()) { // if key or value mismatch detected
-						continue; // check next remote server
-					}
-					if (!local.more && !remote.more && local.data.size() == remote.data.size()) {
-						continue; // check next remote server
-					} else if (i >= local.data.size() && !local.more && i < remote.data.size()) {
-						if (!missingKey) {
-							TraceEvent(g_network->isSimulated() ? SevError : SevWarnAlways,
-							           "SSAuditStorageShardReplicaMissingKeyUnexpected",
-							           data->thisServerID);
-						}
-						std::string error =
-						    format("Missing key(s) form local server (%lld), next key: %s, remote server(%016llx) ",
-						           data->thisServerID.first(),
-						           Traceable<StringRef>::toString(remote.data[i].key).c_str(),
-						           remoteServer.uniqueID.first());
-						TraceEvent(SevError, "SSAuditStorageShardReplicaError", data->thisServerID)
-						    .setMaxFieldLength(-1)
-						    .setMaxEventLength(-1)
-						    .detail("AuditId", req.id)
-						    .detail("AuditRange", req.range)
-						    .detail("ErrorMessage", error)
-						    .detail("Version", version)
-						    .detail("ClaimRange", claimRange);
-						errors.push_back(error);
-						continue; // check next remote server
-					} else if (i >= remote.data.size() && !remote.more && i < local.data.size()) {
-						if (!missingKey) {
-							TraceEvent(g_network->isSimulated() ? SevError : SevWarnAlways,
-							           "SSAuditStorageShardReplicaMissingKeyUnexpected",
-							           data->thisServerID);
-						}
-						std::string error =
-						    format("Missing key(s) form remote server (%lld), next local server(%016llx) key: %s",
-						           remoteServer.uniqueID.first(),
-						           data->thisServerID.first(),
-						           Traceable<StringRef>::toString(local.data[i].key).c_str());
-						TraceEvent(SevError, "SSAuditStorageShardReplicaError", data->thisServerID)
-						    .setMaxFieldLength(-1)
-						    .setMaxEventLength(-1)
-						    .detail("AuditId", req.id)
-						    .detail("AuditRange", req.range)
-						    .detail("ErrorMessage", error)
-						    .detail("Version", version)
-						    .detail("ClaimRange", claimRange);
-						errors.push_back(error);
-						continue; // check next remote server
 					}
 				}
 
@@ -5816,6 +6919,10 @@ ACTOR Future<Void> auditStorageShardReplicaQ(StorageServer* data, AuditStorageRe
 				    .detail("CurrentValidatedInclusiveRange", claimRange)
 				    .detail("CumulatedValidatedInclusiveRange", KeyRangeRef(req.range.begin, claimRange.end));
 
+				// Report the audit's throughput with its progress
+				res.validatedBytes = validatedBytes;
+				res.validationSeconds = now() - startTime;
+
 				// Return result
 				if (!errors.empty()) {
 					TraceEvent(SevError, "SSAuditStorageShardReplicaError", data->thisServerID)
@@ -5896,7 +7003,7 @@ ACTOR Future<Void> auditStorageShardReplicaQ(StorageServer* data, AuditStorageRe
 			}
 
 			rateLimiterBeforeWaitTime = now();
-			wait(rateLimiter->getAllowance(readBytes)); // RateKeeping
+			wait(data->auditStorageRateLimiter->getAllowance(readBytes)); // RateKeeping
 			lastRateLimiterWaitTime = now() - rateLimiterBeforeWaitTime;
 			rateLimiterTotalWaitTime = rateLimiterTotalWaitTime + lastRateLimiterWaitTime;
 			++checkTimes;
@@ -6042,6 +7149,52 @@ ACTOR Future<Void> mapSubquery(StorageServer* data,
 	return Void();
 }
 
+// Issues the point reads of one batch of rows, filling a result into kvms[i] for mappedKeys[i]. Rows mapping to the
+// same secondary key share one lookup, and all distinct keys are first read together by localGetValues(); only the
+// keys it leaves unanswered go through quickGetValue() one by one.
+ACTOR Future<Void> mapPointSubqueries(StorageServer* data,
+                                      Version version,
+                                      GetMappedKeyValuesRequest* pOriginalReq,
+                                      Arena* pArena,
+                                      std::vector<Key> mappedKeys,
+                                      MappedKeyValueRef* kvms) {
+	state std::vector<Key> keys = mappedKeys;
+	state std::vector<int> keyIndexes(mappedKeys.size());
+	state std::vector<Future<GetValueReqAndResultRef>> fallbacks;
+	state std::vector<Future<GetValueReqAndResultRef>> pending;
+
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+	for (int i = 0; i < mappedKeys.size(); i++) {
+		keyIndexes[i] = std::lower_bound(keys.begin(), keys.end(), mappedKeys[i]) - keys.begin();
+	}
+	data->counters.mappedRangePointLookups += keys.size();
+	data->counters.mappedRangeDuplicateLookups += mappedKeys.size() - keys.size();
+
+	state std::vector<Optional<Optional<Value>>> values = wait(localGetValues(data, keys, version, pOriginalReq));
+	fallbacks.resize(keys.size());
+	for (int i = 0; i < keys.size(); i++) {
+		if (!values[i].present()) {
+			fallbacks[i] = quickGetValue(data, keys[i], version, pArena, pOriginalReq);
+			pending.push_back(fallbacks[i]);
+		}
+	}
+	wait(waitForAll(pending));
+
+	for (int i = 0; i < mappedKeys.size(); i++) {
+		const int k = keyIndexes[i];
+		if (values[k].present()) {
+			GetValueReqAndResultRef getValue;
+			getValue.key = keys[k];
+			copyOptionalValue(pArena, getValue, values[k].get());
+			kvms[i].reqAndResult = getValue;
+		} else {
+			kvms[i].reqAndResult = fallbacks[k].get();
+		}
+	}
+	return Void();
+}
+
 int getMappedKeyValueSize(MappedKeyValueRef mappedKeyValue) {
 	auto& reqAndResult = mappedKeyValue.reqAndResult;
 	int bytes = 0;
@@ -6088,6 +7241,8 @@ ACTOR Future<GetMappedKeyValuesReply> mapKeyValues(StorageServer* data,
 	const int k = std::min(sz, SERVER_KNOBS->MAX_PARALLEL_QUICK_GET_VALUE);
 	state std::vector<MappedKeyValueRef> kvms(k);
 	state std::vector<Future<Void>> subqueries;
+	state std::vector<Key> mappedKeys;
+	state bool batchPointQueries = !isRangeQuery && SERVER_KNOBS->QUICK_GET_VALUE_BATCHED;
 	state int offset = 0;
 	if (pOriginalReq->options.present() && pOriginalReq->options.get().debugID.present())
 		g_traceBatch.addEvent("TransactionDebug",
@@ -6109,8 +7264,17 @@ ACTOR Future<GetMappedKeyValuesReply> mapKeyValues(StorageServer* data,
 			// std::cout << "key:" << printable(kvm->key) << ", value:" << printable(kvm->value)
 			//          << ", mappedKey:" << printable(mappedKey) << std::endl;
 
+			if (batchPointQueries) {
+				mappedKeys.push_back(mappedKey);
+			} else {
+				subqueries.push_back(
+				    mapSubquery(data, input.version, pOriginalReq, &result.arena, isRangeQuery, it, kvm, mappedKey));
+			}
+		}
+		if (batchPointQueries) {
 			subqueries.push_back(
-			    mapSubquery(data, input.version, pOriginalReq, &result.arena, isRangeQuery, it, kvm, mappedKey));
+			    mapPointSubqueries(data, input.version, pOriginalReq, &result.arena, mappedKeys, kvms.data()));
+			mappedKeys.clear();
 		}
 		wait(waitForAll(subqueries));
 		if (pOriginalReq->options.present() && pOriginalReq->options.get().debugID.present())
@@ -6330,6 +7494,7 @@ ACTOR Future<Void> getMappedKeyValuesQ(StorageServer* data, GetMappedKeyValuesRe
 {
 	state Span span("SS:getMappedKeyValues"_loc, req.spanContext);
 	state int64_t resultSize = 0;
+	state ReadEngineCost engineCost;
 
 	getCurrentLineage()->modify(&TransactionLineage::txID) = req.spanContext.traceID;
 
@@ -6344,19 +7509,23 @@ ACTOR Future<Void> getMappedKeyValuesQ(StorageServer* data, GetMappedKeyValuesRe
 	// Active load balancing runs at a very high priority (to obtain accurate queue lengths)
 	// so we need to downgrade here
 	wait(data->getQueryDelay());
-	state PriorityMultiLock::Lock readLock = wait(data->getReadLock(req.options));
+	state PriorityMultiLock::Lock readLock = wait(data->getReadLock(
+	    req.options, data->expectedReadBytes(req.tenantInfo, req.begin.getKey(), req.end.getKey(), req.limitBytes)));
 
 	// Track time from requestTime through now as read queueing wait time
 	state double queueWaitEnd = g_network->timer();
-	data->counters.readQueueWaitSample.addMeasurement(queueWaitEnd - req.requestTime());
+	data->recordReadQueueWait(req.options, queueWaitEnd - req.requestTime());
 
 	try {
+		data->checkReadBudget(req.options, queueWaitEnd - req.requestTime());
 		if (req.options.present() && req.options.get().debugID.present())
 			g_traceBatch.addEvent(
 			    "TransactionDebug", req.options.get().debugID.get().first(), "storageserver.getMappedKeyValues.Before");
 		// VERSION_VECTOR change
 		Version commitVersion = getLatestCommitVersion(req.ssLatestCommitVersions, data->tag);
+		state Version readLag = getReadVersionLag(data, commitVersion, req.version);
 		state Version version = wait(waitForVersion(data, commitVersion, req.version, span.context));
+		state ActiveReadVersions::Read activeRead(data->activeReads, version);
 		data->counters.readVersionWaitSample.addMeasurement(g_network->timer() - queueWaitEnd);
 
 		data->checkTenantEntry(
@@ -6445,6 +7614,7 @@ ACTOR Future<Void> getMappedKeyValuesQ(StorageServer* data, GetMappedKeyValuesRe
 			none.version = version;
 			none.more = false;
 			none.penalty = data->getPenalty();
+			none.versionLag = readLag;
 
 			data->checkChangeCounter(changeCounter,
 			                         KeyRangeRef(std::min<KeyRef>(req.begin.getKey(), req.end.getKey()),
@@ -6463,7 +7633,8 @@ ACTOR Future<Void> getMappedKeyValuesQ(StorageServer* data, GetMappedKeyValuesRe
 			                                                     &bytesForIndex,
 			                                                     span.context,
 			                                                     req.options,
-			                                                     req.tenantInfo.prefix));
+			                                                     req.tenantInfo.prefix,
+			                                                     &engineCost));
 
 			// Unlock read lock before the subqueries because each
 			// subquery will route back to getValueQ or getKeyValuesQ with a new request having the same
@@ -6497,6 +7668,7 @@ ACTOR Future<Void> getMappedKeyValuesQ(StorageServer* data, GetMappedKeyValuesRe
 			}
 
 			r.penalty = data->getPenalty();
+			r.versionLag = readLag;
 			req.reply.send(r);
 
 			resultSize = req.limitBytes - remainingLimitBytes;
@@ -6512,7 +7684,7 @@ ACTOR Future<Void> getMappedKeyValuesQ(StorageServer* data, GetMappedKeyValuesRe
 		data->sendErrorWithPenalty(req.reply, e, data->getPenalty());
 	}
 
-	data->transactionTagCounter.addRequest(req.tags, resultSize);
+	data->transactionTagCounter.addRequest(req.tags, resultSize, engineCost);
 	++data->counters.finishedQueries;
 	++data->counters.finishedGetMappedRangeQueries;
 
@@ -6534,12 +7706,79 @@ ACTOR Future<Void> getMappedKeyValuesQ(StorageServer* data, GetMappedKeyValuesRe
 	return Void();
 }
 
+// Reads the chunks of a range stream ahead of the replies sent for them, so that the storage engine keeps reading while
+// earlier chunks are still being sent or are held back by the stream's flow control. Each chunk takes a permit from
+// readAhead that the sender returns once the chunk is sent, which bounds the chunks read but not yet sent.
+ACTOR Future<Void> readRangeStreamChunks(StorageServer* data,
+                                         Version version,
+                                         Key begin,
+                                         Key end,
+                                         int limit,
+                                         SpanContext spanContext,
+                                         Optional<ReadOptions> options,
+                                         Optional<Key> tenantPrefix,
+                                         FlowLock* readAhead,
+                                         PromiseStream<GetKeyValuesReply> chunks) {
+	try {
+		loop {
+			wait(readAhead->take());
+			state PriorityMultiLock::Lock readLock = wait(data->getReadLock(options));
+
+			if (version < data->oldestVersion.get()) {
+				throw transaction_too_old();
+			}
+
+			// Even if TSS mode is Disabled, this may be the second test in a restarting test where the first run
+			// had it enabled.
+			state int byteLimit =
+			    (BUGGIFY && g_network->isSimulated() && g_simulator->tssMode == ISimulator::TSSMode::Disabled &&
+			     !data->isTss() && !data->isSSWithTSSPair())
+			        ? 1
+			        : CLIENT_KNOBS->REPLY_BYTE_LIMIT;
+			TraceEvent(SevDebug, "SSGetKeyValueStreamLimits")
+			    .detail("ByteLimit", byteLimit)
+			    .detail("ReqLimit", limit)
+			    .detail("Begin", begin.printable())
+			    .detail("End", end.printable());
+
+			state GetKeyValuesReply r = wait(readRange(data,
+			                                           version,
+			                                           KeyRangeRef(begin, end),
+			                                           limit,
+			                                           &byteLimit,
+			                                           spanContext,
+			                                           options,
+			                                           tenantPrefix.castTo<KeyRef>()));
+			readLock.release();
+			chunks.send(r);
+			if (!r.more) {
+				return Void();
+			}
+			ASSERT(r.data.size());
+
+			KeyRef lastKey = addPrefix(r.data.back().key, tenantPrefix.castTo<KeyRef>(), r.arena);
+			if (limit >= 0) {
+				begin = keyAfter(lastKey);
+			} else {
+				end = Key(lastKey, r.arena);
+			}
+		}
+	} catch (Error& e) {
+		if (e.code() == error_code_actor_cancelled) {
+			throw;
+		}
+		chunks.sendError(e);
+	}
+	return Void();
+}
+
 ACTOR Future<Void> getKeyValuesStreamQ(StorageServer* data, GetKeyValuesStreamRequest req)
 // Throws a wrong_shard_server if the keys in the request or result depend on data outside this server OR if a large
 // selector offset prevents all data from being read in one range read
 {
 	state Span span("SS:getKeyValuesStream"_loc, req.spanContext);
 	state int64_t resultSize = 0;
+	state FlowLock readAhead(SERVER_KNOBS->RANGESTREAM_READ_AHEAD_CHUNKS);
 
 	req.reply.setByteLimit(SERVER_KNOBS->RANGESTREAM_LIMIT_BYTES);
 	++data->counters.getRangeStreamQueries;
@@ -6561,6 +7800,7 @@ ACTOR Future<Void> getKeyValuesStreamQ(StorageServer* data, GetKeyValuesStreamRe
 
 		Version commitVersion = getLatestCommitVersion(req.ssLatestCommitVersions, data->tag);
 		state Version version = wait(waitForVersion(data, commitVersion, req.version, span.context));
+		state ActiveReadVersions::Read activeRead(data->activeReads, version);
 
 		data->checkTenantEntry(version, req.tenantInfo, req.options.present() ? req.options.get().lockAware : false);
 		if (req.tenantInfo.hasTenant()) {
@@ -6639,37 +7879,21 @@ ACTOR Future<Void> getKeyValuesStreamQ(StorageServer* data, GetKeyValuesStreamRe
 			req.reply.send(none);
 			req.reply.sendError(end_of_stream());
 		} else {
+			state PromiseStream<GetKeyValuesReply> chunks;
+			state Future<Void> reader = readRangeStreamChunks(data,
+			                                                  version,
+			                                                  begin,
+			                                                  end,
+			                                                  req.limit,
+			                                                  span.context,
+			                                                  req.options,
+			                                                  req.tenantInfo.prefix.castTo<Key>(),
+			                                                  &readAhead,
+			                                                  chunks);
 			loop {
+				state GetKeyValuesReply chunk = waitNext(chunks.getFuture());
 				wait(req.reply.onReady());
-				state PriorityMultiLock::Lock readLock = wait(data->getReadLock(req.options));
-
-				if (version < data->oldestVersion.get()) {
-					throw transaction_too_old();
-				}
-
-				// Even if TSS mode is Disabled, this may be the second test in a restarting test where the first run
-				// had it enabled.
-				state int byteLimit =
-				    (BUGGIFY && g_network->isSimulated() && g_simulator->tssMode == ISimulator::TSSMode::Disabled &&
-				     !data->isTss() && !data->isSSWithTSSPair())
-				        ? 1
-				        : CLIENT_KNOBS->REPLY_BYTE_LIMIT;
-				TraceEvent(SevDebug, "SSGetKeyValueStreamLimits")
-				    .detail("ByteLimit", byteLimit)
-				    .detail("ReqLimit", req.limit)
-				    .detail("Begin", begin.printable())
-				    .detail("End", end.printable());
-
-				GetKeyValuesReply _r = wait(readRange(data,
-				                                      version,
-				                                      KeyRangeRef(begin, end),
-				                                      req.limit,
-				                                      &byteLimit,
-				                                      span.context,
-				                                      req.options,
-				                                      req.tenantInfo.prefix));
-				readLock.release();
-				GetKeyValuesStreamReply r(_r);
+				GetKeyValuesStreamReply r(chunk);
 
 				if (req.options.present() && req.options.get().debugID.present())
 					g_traceBatch.addEvent("TransactionDebug",
@@ -6710,7 +7934,14 @@ ACTOR Future<Void> getKeyValuesStreamQ(StorageServer* data, GetKeyValuesStreamRe
 					data->metrics.notifyBytesReadPerKSecond(lastKey, bytesReadPerKSecond);
 				}
 
-				req.reply.send(r);
+				if (req.prefixCompressReply) {
+					GetKeyValuesStreamReply compressed = r;
+					compressed.prefixCompressData();
+					req.reply.send(compressed);
+				} else {
+					req.reply.send(r);
+				}
+				readAhead.release();
 
 				data->counters.rowsQueried += r.data.size();
 				if (r.data.size() == 0) {
@@ -6764,11 +7995,14 @@ ACTOR Future<Void> getKeyQ(StorageServer* data, GetKeyRequest req) {
 
 	// Track time from requestTime through now as read queueing wait time
 	state double queueWaitEnd = g_network->timer();
-	data->counters.readQueueWaitSample.addMeasurement(queueWaitEnd - req.requestTime());
+	data->recordReadQueueWait(req.options, queueWaitEnd - req.requestTime());
 
 	try {
+		data->checkReadBudget(req.options, queueWaitEnd - req.requestTime());
 		Version commitVersion = getLatestCommitVersion(req.ssLatestCommitVersions, data->tag);
+		state Version readLag = getReadVersionLag(data, commitVersion, req.version);
 		state Version version = wait(waitForVersion(data, commitVersion, req.version, req.spanContext));
+		state ActiveReadVersions::Read activeRead(data->activeReads, version);
 		data->counters.readVersionWaitSample.addMeasurement(g_network->timer() - queueWaitEnd);
 
 		data->checkTenantEntry(version, req.tenantInfo, req.options.map(&ReadOptions::lockAware).orDefault(false));
@@ -6815,6 +8049,7 @@ ACTOR Future<Void> getKeyQ(StorageServer* data, GetKeyRequest req) {
 
 		GetKeyReply reply(updated, cached);
 		reply.penalty = data->getPenalty();
+		reply.versionLag = readLag;
 
 		req.reply.send(reply);
 	} catch (Error& e) {
@@ -6861,8 +8096,16 @@ void getQueuingMetrics(StorageServer* self, StorageQueuingMetricsRequest const&
 	reply.cpuUsage = self->cpuUsage;
 	reply.diskUsage = self->diskUsage;
 	reply.durableVersion = self->durableVersion.get();
+	reply.mvccWindowVersions = self->mvccWindowVersions;
 
 	reply.busiestTags = self->transactionTagCounter.getBusiestTags();
+	reply.compactionDebtBytes = self->storage.getCompactionDebt();
+
+	for (int type = 0; type <= (int)ReadType::MAX; ++type) {
+		reply.readLaneWaiters.push_back(self->ssLock->getWaitersCount(self->readPriorityRanks[type]));
+	}
+	reply.readLaneQueueWaits = self->readLaneQueueWaits;
+	std::fill(self->readLaneQueueWaits.begin(), self->readLaneQueueWaits.end(), 0.0);
 
 	req.reply.send(reply);
 }
@@ -6894,11 +8137,7 @@ ACTOR Future<Void> doEagerReads(StorageServer* data, UpdateEagerReadInfo* eager)
 		eager->keyEnd = keyEndVal;
 	}
 
-	std::vector<Future<Optional<Value>>> value(eager->keys.size());
-	for (int i = 0; i < value.size(); i++)
-		value[i] = data->storage.readValuePrefix(eager->keys[i].first, eager->keys[i].second, options);
-
-	state Future<std::vector<Optional<Value>>> futureValues = getAll(value);
+	state Future<std::vector<Optional<Value>>> futureValues = data->storage.readValuePrefixes(eager->keys, options);
 	std::vector<Optional<Value>> optionalValues = wait(futureValues);
 	for (const auto& value : optionalValues) {
 		if (value.present()) {
@@ -7115,6 +8354,102 @@ void expandClear(MutationRef& m,
 	}
 }
 
+// Inserts set mutation m into data. Keys needed to split a clear are added to arena.
+void applySet(StorageServer* self, MutationRef const& m, Arena& arena, StorageServer::VersionedData& data) {
+	// VersionedMap (data) is bookkeeping all empty ranges. If the key to be set is new, it is supposed to be in a
+	// range what was empty. Break the empty range into halves.
+	auto prev = data.atLatest().lastLessOrEqual(m.param1);
+	if (prev && prev->isClearTo() && prev->getEndKey() > m.param1) {
+		ASSERT(prev.key() <= m.param1);
+		KeyRef end = prev->getEndKey();
+		// the insert version of the previous clear is preserved for the "left half", because in
+		// changeDurableVersion() the previous clear is still responsible for removing it insert() invalidates prev,
+		// so prev.key() is not safe to pass to it by reference
+		data.insert(KeyRef(prev.key()),
+		            ValueOrClearToRef::clearTo(m.param1),
+		            prev.insertVersion()); // overwritten by below insert if empty
+		KeyRef nextKey = keyAfter(m.param1, arena);
+		if (end != nextKey) {
+			ASSERT(end > nextKey);
+			// the insert version of the "right half" is not preserved, because in changeDurableVersion() this set
+			// is responsible for removing it
+			// FIXME: This copy is technically an asymptotic problem, definitely a waste of memory (copy of keyAfter
+			// is a waste, but not asymptotic)
+			data.insert(nextKey, ValueOrClearToRef::clearTo(KeyRef(arena, end)));
+		}
+		++self->counters.pTreeClearSplits;
+	}
+	data.insert(m.param1, ValueOrClearToRef::value(m.param2));
+}
+
+// Inserts the pending set mutations into versionedData. A run of at least STORAGE_SERVER_SORTED_SET_BATCH of them is
+// sorted by key, and the resulting items, including the pieces of the clears they split, are inserted with
+// insertSorted() a chunk of keys at a time, so that the search paths looked up for a chunk are still cached when it is
+// inserted. Only the last set of each key matters, and sets of different keys commute, so the result is the same as
+// applying them one by one.
+void StorageServer::applyPendingSets() {
+	constexpr int chunkSize = 64;
+
+	if (pendingSets.empty()) {
+		return;
+	}
+	auto& data = mutableData();
+	if (SERVER_KNOBS->STORAGE_SERVER_SORTED_SET_BATCH <= 0 ||
+	    pendingSets.size() < SERVER_KNOBS->STORAGE_SERVER_SORTED_SET_BATCH) {
+		for (const auto& m : pendingSets) {
+			applySet(this, m, pendingSetsArena, data);
+		}
+	} else {
+		std::stable_sort(pendingSets.begin(), pendingSets.end(), [](MutationRef const& a, MutationRef const& b) {
+			return a.param1 < b.param1;
+		});
+		const Version latestVersion = data.getLatestVersion();
+		std::vector<MapPair<KeyRef, std::pair<ValueOrClearToRef, Version>>> items;
+		for (int i = 0; i < pendingSets.size(); ++i) {
+			const MutationRef& m = pendingSets[i];
+			if (i + 1 < pendingSets.size() && pendingSets[i + 1].param1 == m.param1) {
+				continue;
+			}
+			// The same split as applySet(), except that the previous item is looked up in the tree without the
+			// items of this chunk
+			auto prev = data.atLatest().lastLessOrEqual(m.param1);
+			if (prev && prev->isClearTo() && prev->getEndKey() > m.param1) {
+				KeyRef end = prev->getEndKey();
+				if (!items.empty() && prev.key() < items.back().key) {
+					// The clear has already been split by an earlier key of this chunk, and its right half is last
+					ASSERT(items.back().value.first.isClearTo() && items.back().value.first.getEndKey() == end);
+					if (items.back().key == m.param1) {
+						items.pop_back();
+					} else {
+						items.back().value.first = ValueOrClearToRef::clearTo(m.param1);
+					}
+				} else if (prev.key() != m.param1) {
+					items.emplace_back(prev.key(),
+					                   std::make_pair(ValueOrClearToRef::clearTo(m.param1), prev.insertVersion()));
+				}
+				items.emplace_back(m.param1, std::make_pair(ValueOrClearToRef::value(m.param2), latestVersion));
+				KeyRef nextKey = keyAfter(m.param1, pendingSetsArena);
+				if (end != nextKey) {
+					ASSERT(end > nextKey);
+					items.emplace_back(nextKey,
+					                   std::make_pair(ValueOrClearToRef::clearTo(KeyRef(pendingSetsArena, end)),
+					                                  latestVersion));
+				}
+				++counters.pTreeClearSplits;
+			} else {
+				items.emplace_back(m.param1, std::make_pair(ValueOrClearToRef::value(m.param2), latestVersion));
+			}
+			if (items.size() >= chunkSize || i + 1 == pendingSets.size()) {
+				data.insertSorted(items);
+				items.clear();
+			}
+		}
+		++counters.pTreeSortedSetBatches;
+	}
+	pendingSets.clear();
+	pendingSetsArena = Arena();
+}
+
 void applyMutation(StorageServer* self,
                    MutationRef const& m,
                    Arena& arena,
@@ -7129,31 +8464,19 @@ void applyMutation(StorageServer* self,
 	self->metrics.notify(m.param1, metrics);
 
 	if (m.type == MutationRef::SetValue) {
-		// VersionedMap (data) is bookkeeping all empty ranges. If the key to be set is new, it is supposed to be in a
-		// range what was empty. Break the empty range into halves.
-		auto prev = data.atLatest().lastLessOrEqual(m.param1);
-		if (prev && prev->isClearTo() && prev->getEndKey() > m.param1) {
-			ASSERT(prev.key() <= m.param1);
-			KeyRef end = prev->getEndKey();
-			// the insert version of the previous clear is preserved for the "left half", because in
-			// changeDurableVersion() the previous clear is still responsible for removing it insert() invalidates prev,
-			// so prev.key() is not safe to pass to it by reference
-			data.insert(KeyRef(prev.key()),
-			            ValueOrClearToRef::clearTo(m.param1),
-			            prev.insertVersion()); // overwritten by below insert if empty
-			KeyRef nextKey = keyAfter(m.param1, arena);
-			if (end != nextKey) {
-				ASSERT(end > nextKey);
-				// the insert version of the "right half" is not preserved, because in changeDurableVersion() this set
-				// is responsible for removing it
-				// FIXME: This copy is technically an asymptotic problem, definitely a waste of memory (copy of keyAfter
-				// is a waste, but not asymptotic)
-				data.insert(nextKey, ValueOrClearToRef::clearTo(KeyRef(arena, end)));
-			}
-			++self->counters.pTreeClearSplits;
-		}
-		data.insert(m.param1, ValueOrClearToRef::value(m.param2));
-		self->watches.trigger(m.param1);
+		if (self->batchPendingSets) {
+			if (self->pendingSets.empty()) {
+				self->pendingSetsArena = arena;
+			}
+			self->pendingSets.push_back(m);
+		} else {
+			applySet(self, m, arena, data);
+		}
+		if (!SERVER_KNOBS->STORAGE_SERVER_BATCH_WATCH_TRIGGERS) {
+			self->watches.trigger(m.param1);
+		} else if (!self->watches.empty()) {
+			self->pendingWatchKeys.push_back(m.param1);
+		}
 		++self->counters.pTreeSets;
 	} else if (m.type == MutationRef::ClearRange) {
 		data.erase(m.param1, m.param2);
@@ -7162,14 +8485,21 @@ void applyMutation(StorageServer* self,
 			ASSERT(!data.isClearContaining(data.atLatest(), m.param1));
 		}
 		data.insert(m.param1, ValueOrClearToRef::clearTo(m.param2));
-		self->watches.triggerRange(m.param1, m.param2);
+		if (!SERVER_KNOBS->STORAGE_SERVER_BATCH_WATCH_TRIGGERS) {
+			self->watches.triggerRange(m.param1, m.param2);
+		} else if (!self->watches.empty()) {
+			self->pendingWatchRanges.push_back(KeyRangeRef(m.param1, m.param2));
+		}
 		++self->counters.pTreeClears;
 	}
 }
 
+// A set mutation m must live in mutationArena, the storage server's mutation log arena for version. Feeds reference it
+// there instead of copying it, so a key covered by several feeds costs its bytes only once.
 void applyChangeFeedMutation(StorageServer* self,
                              MutationRef const& m,
                              MutationRefAndCipherKeys const& encryptedMutation,
+                             Arena const& mutationArena,
                              Version version,
                              KeyRangeRef const& shard) {
 	ASSERT(self->encryptionMode.present());
@@ -7181,6 +8511,7 @@ void applyChangeFeedMutation(StorageServer* self,
 				if (it->mutations.empty() || it->mutations.back().version != version) {
 					it->mutations.push_back(
 					    EncryptedMutationsAndVersionRef(version, self->knownCommittedVersion.get()));
+					it->mutations.back().arena().dependsOn(mutationArena);
 				}
 				if (encryptedMutation.mutation.isValid()) {
 					if (!it->mutations.back().encrypted.present()) {
@@ -7194,7 +8525,7 @@ void applyChangeFeedMutation(StorageServer* self,
 					it->mutations.back().encrypted.get().push_back_deep(it->mutations.back().arena(), m);
 					it->mutations.back().cipherKeys.push_back(TextAndHeaderCipherKeys());
 				}
-				it->mutations.back().mutations.push_back_deep(it->mutations.back().arena(), m);
+				it->mutations.back().mutations.push_back(it->mutations.back().arena(), m);
 
 				self->currentChangeFeeds.insert(it->id);
 				self->addFeedBytesAtVersion(m.totalSize(), version);
@@ -7240,6 +8571,8 @@ void applyChangeFeedMutation(StorageServer* self,
 					if (it->mutations.empty() || it->mutations.back().version != version) {
 						it->mutations.push_back(
 						    EncryptedMutationsAndVersionRef(version, self->knownCommittedVersion.get()));
+						// so sets at this version can reference the mutation log
+						it->mutations.back().arena().dependsOn(mutationArena);
 					}
 					if (encryptedMutation.mutation.isEncrypted()) {
 						if (!it->mutations.back().encrypted.present()) {
@@ -7537,6 +8870,206 @@ ACTOR Future<Void> tryGetRange(PromiseStream<RangeResult> results, Transaction*
 	}
 }
 
+// Fetches keys as sub-ranges of about FETCH_KEYS_SUBRANGE_BYTES, split at the points returned by getRangeSplitPoints().
+// Up to parallelism sub-ranges are read at once, each load balanced on its own so they can be served by different
+// source replicas, and their blocks are sent to results in key order. Every block but the last has more set, with its
+// readThrough at the end of its sub-range when it finishes one.
+ACTOR Future<Void> tryGetRangeInParallel(PromiseStream<RangeResult> results,
+                                         Transaction* tr,
+                                         KeyRange keys,
+                                         int parallelism) {
+	state std::vector<KeyRange> subranges;
+	state std::vector<Future<Void>> readers;
+	state std::deque<PromiseStream<RangeResult>> streams;
+	state int current = 0;
+	state RangeResult block;
+
+	try {
+		Standalone<VectorRef<KeyRef>> splitPoints =
+		    wait(tr->getRangeSplitPoints(keys, SERVER_KNOBS->FETCH_KEYS_SUBRANGE_BYTES));
+		for (int i = 0; i + 1 < splitPoints.size(); i++) {
+			if (splitPoints[i] < splitPoints[i + 1]) {
+				subranges.push_back(KeyRangeRef(splitPoints[i], splitPoints[i + 1]));
+			}
+		}
+		if (subranges.empty()) {
+			subranges.push_back(keys);
+		}
+
+		for (; current < subranges.size(); current++) {
+			while (readers.size() < subranges.size() && readers.size() < current + parallelism) {
+				streams.emplace_back();
+				readers.push_back(tryGetRange(streams.back(), tr, subranges[readers.size()]));
+			}
+			try {
+				loop {
+					RangeResult _block = waitNext(streams.front().getFuture());
+					block = _block;
+					if (!block.more && current + 1 < subranges.size()) {
+						if (block.empty()) {
+							// The next sub-range's first block covers this one's unread end
+							continue;
+						}
+						block.more = true;
+						block.readThrough = KeyRef(block.arena(), subranges[current].end);
+					}
+					results.send(block);
+				}
+			} catch (Error& e) {
+				if (e.code() != error_code_end_of_stream) {
+					throw;
+				}
+			}
+			streams.pop_front();
+		}
+		results.sendError(end_of_stream());
+	} catch (Error& e) {
+		if (e.code() == error_code_actor_cancelled) {
+			throw;
+		}
+		results.sendError(e);
+		throw;
+	}
+	return Void();
+}
+
+// Reads keys from the range files of the running pieces of bulk loads that cover it. The files of the pieces are in
+// key order and don't overlap. Every result but the last has more set, with its readThrough at the end of the keys of
+// a block of a file. A failure to read a file is retried by the fetch after FETCH_KEYS_BULK_LOAD_RETRY_DELAY, until
+// the bulk load is cleared.
+ACTOR Future<Void> tryGetRangeFromBulkLoad(PromiseStream<RangeResult> results,
+                                           Database cx,
+                                           KeyRange keys,
+                                           std::vector<BulkLoadState> pieces) {
+	state std::vector<std::pair<std::string, BulkLoadFile>> files; // with the URLs of their containers
+	state Reference<IBackupContainer> bc;
+	state Reference<IAsyncFile> file;
+	state Key readThrough = keys.begin;
+	state int i = 0;
+	state int64_t offset;
+
+	try {
+		for (const auto& piece : pieces) {
+			for (const auto& pieceFile : piece.files) {
+				// A file can be in adjacent pieces
+				if (pieceFile.range.intersects(keys) &&
+				    (files.empty() || files.back().first != piece.url || !(files.back().second == pieceFile))) {
+					files.emplace_back(piece.url, pieceFile);
+				}
+			}
+		}
+
+		for (; i < files.size(); ++i) {
+			if (!bc.isValid() || bc->getURL() != files[i].first) {
+				bc = IBackupContainer::openContainer(files[i].first, {}, {});
+			}
+			Reference<IAsyncFile> _file = wait(bc->readFile(files[i].second.fileName));
+			file = _file;
+			for (offset = 0; offset < files[i].second.fileSize; offset += files[i].second.blockSize) {
+				state Standalone<VectorRef<KeyValueRef>> blockData = wait(fileBackup::decodeRangeFileBlock(
+				    file,
+				    offset,
+				    std::min<int64_t>(files[i].second.blockSize, files[i].second.fileSize - offset),
+				    cx));
+				if (blockData.size() < 2) {
+					throw restore_corrupted_data();
+				}
+
+				// The first and last keys of a block are the bounds of its keys
+				RangeResult rows;
+				rows.arena().dependsOn(blockData.arena());
+				for (int j = 1; j + 1 < blockData.size(); ++j) {
+					if (keys.contains(blockData[j].key) && blockData[j].key >= readThrough) {
+						rows.push_back(rows.arena(), blockData[j]);
+					}
+				}
+				Key blockEnd = std::max<KeyRef>(readThrough, std::min<KeyRef>(blockData.back().key, keys.end));
+				if (rows.empty() && blockEnd == readThrough) {
+					continue;
+				}
+				readThrough = blockEnd;
+				rows.more = true;
+				rows.readThrough = KeyRef(rows.arena(), readThrough);
+				results.send(rows);
+			}
+		}
+
+		results.send(RangeResult());
+		results.sendError(end_of_stream());
+	} catch (Error& e) {
+		if (e.code() == error_code_actor_cancelled) {
+			throw;
+		}
+		TraceEvent(SevWarnAlways, "FetchKeysBulkLoadError")
+		    .error(e)
+		    .detail("Keys", keys)
+		    .detail("ReadThrough", readThrough)
+		    .detail("File", i < files.size() ? files[i].second.fileName : std::string());
+		wait(delay(SERVER_KNOBS->FETCH_KEYS_BULK_LOAD_RETRY_DELAY));
+		results.sendError(bulk_load_file_read_failed());
+	}
+	return Void();
+}
+
+// Loads keys from the files of bulk loads when all of it is in running pieces of them, and fetches it from the source
+// servers otherwise. A move into a running piece is to servers that haven't got it, which load it rather than fetch
+// the empty range. The map of bulk loads is checked whatever the reason of the move, as the reason isn't kept by a
+// restarted server.
+ACTOR Future<Void> tryGetRangeOrBulkLoad(PromiseStream<RangeResult> results,
+                                         Transaction* tr,
+                                         Database cx,
+                                         KeyRange keys,
+                                         int parallelism) {
+	state std::vector<BulkLoadState> pieces;
+	state bool bulkLoad = true;
+	state Transaction mapTr(cx);
+	state Key begin;
+
+	loop {
+		try {
+			mapTr.setOption(FDBTransactionOptions::PRIORITY_SYSTEM_IMMEDIATE);
+			mapTr.setOption(FDBTransactionOptions::READ_SYSTEM_KEYS);
+			mapTr.setOption(FDBTransactionOptions::LOCK_AWARE);
+			pieces.clear();
+			bulkLoad = true;
+			begin = keys.begin;
+			while (bulkLoad && begin < keys.end) {
+				RangeResult entries = wait(krmGetRanges(&mapTr, bulkLoadPrefix, KeyRangeRef(begin, keys.end)));
+				for (int i = 0; i < entries.size() - 1 && bulkLoad; ++i) {
+					if (entries[i].value.empty()) {
+						bulkLoad = false;
+					} else {
+						pieces.push_back(decodeBulkLoadState(entries[i].value));
+						bulkLoad = pieces.back().getPhase() == BulkLoadPhase::Running;
+					}
+				}
+				begin = entries.back().key;
+			}
+			break;
+		} catch (Error& e) {
+			if (e.code() == error_code_actor_cancelled) {
+				throw;
+			}
+			try {
+				wait(mapTr.onError(e));
+			} catch (Error& err) {
+				results.sendError(err);
+				throw;
+			}
+		}
+	}
+
+	if (bulkLoad) {
+		TraceEvent("FetchKeysBulkLoad").detail("Keys", keys).detail("TaskID", pieces.front().taskId);
+		wait(tryGetRangeFromBulkLoad(results, cx, keys, pieces));
+	} else if (parallelism > 1 && !SERVER_KNOBS->FETCH_USING_STREAMING) {
+		wait(tryGetRangeInParallel(results, tr, keys, parallelism));
+	} else {
+		wait(tryGetRange(results, tr, keys));
+	}
+	return Void();
+}
+
 // Read blob granules metadata. It keeps retrying until reaching maxRetryCount.
 // The key range should not cross tenant boundary.
 ACTOR Future<Standalone<VectorRef<BlobGranuleChunkRef>>> tryReadBlobGranuleChunks(Transaction* tr,
@@ -8416,6 +9949,7 @@ bool fetchKeyCanRetry(const Error& e) {
 	case error_code_server_overloaded:
 	case error_code_blob_granule_request_failed:
 	case error_code_blob_granule_transaction_too_old:
+	case error_code_bulk_load_file_read_failed:
 	case error_code_grv_proxy_memory_limit_exceeded:
 	case error_code_commit_proxy_memory_limit_exceeded:
 		return true;
@@ -8623,7 +10157,11 @@ ACTOR Future<Void> fetchKeys(StorageServer* data, AddingShard* shard) {
 					rangeEnd = keys.end;
 				}
 			} else {
-				hold = tryGetRange(results, &tr, keys);
+				// Share the budget of parallel sub-range reads between the fetches holding fetchKeysParallelismLock;
+				// streaming reads are already split and run in parallel by the client.
+				const int parallelism = std::max<int>(
+				    1, SERVER_KNOBS->FETCH_KEYS_SUBRANGE_PARALLELISM / data->fetchKeysParallelismLock.activePermits());
+				hold = tryGetRangeOrBulkLoad(results, &tr, data->cx, keys, parallelism);
 				rangeEnd = keys.end;
 			}
 
@@ -8681,8 +10219,7 @@ ACTOR Future<Void> fetchKeys(StorageServer* data, AddingShard* shard) {
 
 					// Write this_block to storage
 					state Standalone<VectorRef<KeyValueRef>> blockData(this_block, this_block.arena());
-					state Key blockEnd =
-					    this_block.size() > 0 && this_block.more ? keyAfter(this_block.back().key) : keys.end;
+					state Key blockEnd = this_block.more ? this_block.getReadThrough() : keys.end;
 					state KeyRange blockRange(KeyRangeRef(blockBegin, blockEnd));
 					wait(data->storage.replaceRange(blockRange, blockData));
 
@@ -9080,6 +10617,7 @@ ACTOR Future<Void> fallBackToAddingShard(StorageServer* data, MoveInShard* moveI
 	if (moveInShard->failed()) {
 		return Void();
 	}
+	++data->counters.physicalShardMoveFallbacks;
 	auto& mLV = data->addVersionToMutationLog(data->data().getLatestVersion());
 	TraceEvent(SevInfo, "FallBackToAddingShardBegin", data->thisServerID)
 	    .detail("Version", mLV.version)
@@ -9191,6 +10729,7 @@ ACTOR Future<Void> fetchShardCheckpoint(StorageServer* data, MoveInShard* moveIn
 	    .detail("Duration", duration)
 	    .detail("TotalBytes", totalBytes)
 	    .detail("Rate", (double)totalBytes / duration);
+	data->counters.checkpointBytesFetched += totalBytes;
 
 	moveInShard->meta->checkpoints = std::move(localRecords);
 	moveInShard->setPhase(MoveInPhase::Ingesting);
@@ -10501,6 +12040,9 @@ void StorageServer::addMutation(Version version,
 	    nonExpanded; // need to keep non-expanded but atomic converted version of clear mutations for change feeds
 	auto& mLog = addVersionToMutationLog(version);
 
+	if (mutation.type != MutationRef::SetValue) {
+		applyPendingSets();
+	}
 	if (!convertAtomicOp(expanded, data(), eagerReads, mLog.arena())) {
 		return;
 	}
@@ -10523,8 +12065,12 @@ void StorageServer::addMutation(Version version,
 			encrypt.mutation = expanded.encrypt(encrypt.cipherKeys, mLog.arena(), BlobCipherMetrics::TLOG);
 		}
 
-		applyChangeFeedMutation(
-		    this, expanded.type == MutationRef::ClearRange ? nonExpanded : expanded, encrypt, version, shard);
+		applyChangeFeedMutation(this,
+		                        expanded.type == MutationRef::ClearRange ? nonExpanded : expanded,
+		                        encrypt,
+		                        mLog.arena(),
+		                        version,
+		                        shard);
 	}
 	applyMutation(this, expanded, mLog.arena(), mutableData(), version);
 
@@ -10559,12 +12105,14 @@ public:
 		//TraceEvent("SSNewVersion", data->thisServerID).detail("VerWas", data->mutableData().latestVersion).detail("ChVer", ver);
 
 		if (currentVersion != ver) {
+			data->applyPendingSets();
 			fromVersion = currentVersion;
 			currentVersion = ver;
 			data->mutableData().createNewVersion(ver);
 		}
 
 		if (m.param1.startsWith(systemKeys.end)) {
+			data->applyPendingSets();
 			if ((m.type == MutationRef::SetValue) && m.param1.substr(1).startsWith(storageCachePrefix)) {
 				applyPrivateCacheData(data, m);
 			} else if ((m.type == MutationRef::SetValue) && m.param1.substr(1).startsWith(checkpointPrefix)) {
@@ -10683,6 +12231,8 @@ private:
 			for (auto& it : data->uidChangeFeed) {
 				if (!it.second->removing && currentVersion < it.second->stopVersion) {
 					it.second->mutations.push_back(EncryptedMutationsAndVersionRef(currentVersion, rollbackVersion));
+					it.second->mutations.back().arena().dependsOn(
+					    data->addVersionToMutationLog(currentVersion).arena());
 					it.second->mutations.back().mutations.push_back_deep(it.second->mutations.back().arena(), m);
 					data->currentChangeFeeds.insert(it.first);
 				}
@@ -11364,6 +12914,7 @@ ACTOR Future<Void> update(StorageServer* data, bool* pReceivedUpdate) {
 
 		data->updateEagerReads = &eager;
 		data->debug_inApplyUpdate = true;
+		data->batchPendingSets = SERVER_KNOBS->STORAGE_SERVER_SORTED_SET_BATCH > 0;
 
 		state StorageUpdater updater(data->lastVersionWithData, data->restoredVersion);
 
@@ -11387,6 +12938,7 @@ ACTOR Future<Void> update(StorageServer* data, bool* pReceivedUpdate) {
 				injectedChanges = true;
 				if (mutationBytes > SERVER_KNOBS->DESIRED_UPDATE_BYTES) {
 					mutationBytes = 0;
+					data->applyPendingSets();
 					wait(delay(SERVER_KNOBS->UPDATE_DELAY));
 				}
 			}
@@ -11401,6 +12953,7 @@ ACTOR Future<Void> update(StorageServer* data, bool* pReceivedUpdate) {
 		for (; cloneCursor2->hasMessage(); cloneCursor2->nextMessage()) {
 			if (mutationBytes > SERVER_KNOBS->DESIRED_UPDATE_BYTES) {
 				mutationBytes = 0;
+				data->applyPendingSets();
 				// Instead of just yielding, leave time for the storage server to respond to reads
 				wait(delay(SERVER_KNOBS->UPDATE_DELAY));
 			}
@@ -11555,6 +13108,8 @@ ACTOR Future<Void> update(StorageServer* data, bool* pReceivedUpdate) {
 			}
 		}
 
+		data->applyPendingSets();
+		data->batchPendingSets = false;
 		data->tLogMsgsPTreeUpdatesLatencyHistogram->sampleSeconds(now() - beforeTLogMsgsUpdates);
 		if (data->currentChangeFeeds.size()) {
 			data->changeFeedVersions.emplace_back(
@@ -11573,6 +13128,7 @@ ACTOR Future<Void> update(StorageServer* data, bool* pReceivedUpdate) {
 
 		data->updateEagerReads = nullptr;
 		data->debug_inApplyUpdate = false;
+		data->triggerPendingWatches();
 
 		if (ver == invalidVersion && !fii.changes.empty()) {
 			ver = updater.currentVersion;
@@ -11630,6 +13186,19 @@ ACTOR Future<Void> update(StorageServer* data, bool* pReceivedUpdate) {
 			if (data->primaryLocality == tagLocalitySpecial || data->tag.locality == data->primaryLocality) {
 				proposedOldestVersion = std::max(proposedOldestVersion, data->lastTLogVersion - maxVersionsInMemory);
 			}
+			// Under memory pressure, discard versions early, but only ones known to be committed, as durable versions
+			// can't be rolled back, and older than every read in progress. An engine which keeps versions serves the
+			// older ones, so only the newest have to stay in memory.
+			Version mvccWindow = data->mvccWindow(maxVersionsInMemory);
+			if (data->storage.keepsVersions()) {
+				mvccWindow = std::min(mvccWindow, SERVER_KNOBS->STORAGE_VERSIONED_ENGINE_MVCC_WINDOW_VERSIONS);
+			}
+			if (mvccWindow < maxVersionsInMemory) {
+				proposedOldestVersion = std::max(proposedOldestVersion,
+				                                 std::min({ data->version.get() - mvccWindow,
+				                                            cursor->getMinKnownCommittedVersion(),
+				                                            data->activeReads->oldest() }));
+			}
 			proposedOldestVersion = std::min(proposedOldestVersion, data->version.get() - 1);
 			proposedOldestVersion = std::max(proposedOldestVersion, data->oldestVersion.get());
 			proposedOldestVersion = std::max(proposedOldestVersion, data->desiredOldestVersion.get());
@@ -11647,6 +13216,7 @@ ACTOR Future<Void> update(StorageServer* data, bool* pReceivedUpdate) {
 				data->recoveryVersionSkips.pop_front();
 			}
 			data->desiredOldestVersion.set(proposedOldestVersion);
+			data->mvccWindowVersions = data->version.get() - proposedOldestVersion;
 		}
 
 		validate(data);
@@ -11886,13 +13456,15 @@ struct UpdateStorageCommitStats {
 	double duration;
 	double commitDuration;
 	double incompleteCommitDuration;
+	double stagingDuration; // Time spent writing the mutations of the next commit while this one was in flight
 	uint64_t mutationBytes;
 	uint64_t fetchKeyBytes;
+	uint64_t stagedMutationBytes; // Mutation bytes of the next commit written while this one was in flight
 	int64_t seqId;
 
 	UpdateStorageCommitStats()
 	  : seqId(0), whenCommit(0), beforeStorageUpdates(0), beforeStorageCommit(0), duration(0), commitDuration(0),
-	    incompleteCommitDuration(0), mutationBytes(0), fetchKeyBytes(0) {}
+	    incompleteCommitDuration(0), stagingDuration(0), mutationBytes(0), fetchKeyBytes(0), stagedMutationBytes(0) {}
 
 	void log(UID ssid, std::string reason) const {
 		TraceEvent(SevInfo, "UpdateStorageCommitStats", ssid)
@@ -11905,14 +13477,126 @@ struct UpdateStorageCommitStats {
 		    .detail("BeforeStorageCommit", beforeStorageCommit)
 		    .detail("WhenCommit", whenCommit)
 		    .detail("MutationBytes", mutationBytes)
-		    .detail("FetchKeyBytes", fetchKeyBytes);
+		    .detail("FetchKeyBytes", fetchKeyBytes)
+		    .detail("StagedMutationBytes", stagedMutationBytes)
+		    .detail("StagingDuration", stagingDuration);
 	}
 };
 
+// Writes the mutations of versions (startVersion, desiredVersion] to storage until bytesLeft is used up, and returns
+// the last version written. The versions written are forgotten from versionedData, but their entries remain in its
+// latest version until changeDurableVersion() removes them.
+ACTOR Future<Version> writeMutationsToStorage(StorageServer* data,
+                                              Version startVersion,
+                                              Version desiredVersion,
+                                              int64_t* bytesLeft,
+                                              UnlimitedCommitBytes unlimitedCommitBytes) {
+	state Version newOldestVersion = startVersion;
+	loop {
+		state bool done = data->storage.makeVersionMutationsDurable(
+		    newOldestVersion, desiredVersion, *bytesLeft, unlimitedCommitBytes);
+		if (data->tenantMap.getLatestVersion() < newOldestVersion) {
+			data->tenantMap.createNewVersion(newOldestVersion);
+		}
+		// We want to forget things from these data structures atomically with changing oldestVersion (and
+		// "before", since oldestVersion.set() may trigger waiting actors) forgetVersionsBeforeAsync visibly
+		// forgets immediately (without waiting) but asynchronously frees memory.
+		Future<Void> finishedForgetting =
+		    data->mutableData().forgetVersionsBeforeAsync(newOldestVersion, TaskPriority::UpdateStorage) &&
+		    data->tenantMap.forgetVersionsBeforeAsync(newOldestVersion, TaskPriority::UpdateStorage);
+		data->oldestVersion.set(newOldestVersion);
+		wait(finishedForgetting);
+		wait(yield(TaskPriority::UpdateStorage));
+		if (done)
+			return newOldestVersion;
+	}
+}
+
+// Drops the long snapshot at it, failing the requests waiting for it to be pinned with e
+void dropLongSnapshot(StorageServer* data, std::map<Version, StorageServer::LongSnapshot>::iterator it, Error e) {
+	if (it->second.engineSnapshot >= 0) {
+		data->storage.unpinSnapshot(it->second.engineSnapshot);
+	} else if (it->second.pinned.canBeSet()) {
+		it->second.pinned.sendError(e);
+	}
+	data->longSnapshots.erase(it);
+}
+
+ACTOR Future<Void> expireLongSnapshot(StorageServer* data, Version version) {
+	wait(delay(SERVER_KNOBS->STORAGE_LONG_SNAPSHOT_MAX_AGE));
+	auto it = data->longSnapshots.find(version);
+	if (it != data->longSnapshots.end()) {
+		TraceEvent(SevDebug, "StorageLongSnapshotExpired", data->thisServerID)
+		    .detail("Version", version)
+		    .detail("Pinned", it->second.engineSnapshot >= 0);
+		dropLongSnapshot(data, it, transaction_too_old());
+	}
+	return Void();
+}
+
+// Registers a long snapshot at req.version, which updateStorage() pins once the version is durable, for
+// STORAGE_LONG_SNAPSHOT_MAX_AGE seconds. Requests for a version that's already registered share its snapshot.
+ACTOR Future<Void> longSnapshotQ(StorageServer* data, LongSnapshotRequest req) {
+	state Future<Void> pinned;
+	auto it = data->longSnapshots.find(req.version);
+	if (it == data->longSnapshots.end()) {
+		if (req.version <= data->storageVersion() || data->longSnapshotsUnsupported) {
+			req.reply.sendError(transaction_too_old());
+			return Void();
+		}
+		if ((int)data->longSnapshots.size() >= SERVER_KNOBS->STORAGE_LONG_SNAPSHOT_MAX_COUNT) {
+			req.reply.sendError(server_overloaded());
+			return Void();
+		}
+		it = data->longSnapshots.emplace(req.version, StorageServer::LongSnapshot()).first;
+		it->second.changeCounter = data->shardChangeCounter;
+		data->actors.add(expireLongSnapshot(data, req.version));
+	}
+	pinned = it->second.pinned.getFuture();
+
+	try {
+		wait(pinned);
+		req.reply.send(Void());
+	} catch (Error& e) {
+		if (e.code() == error_code_actor_cancelled) {
+			throw;
+		}
+		req.reply.sendError(e);
+	}
+	return Void();
+}
+
+// The version of the oldest long snapshot that isn't pinned yet, or invalidVersion if there's none
+Version oldestUnpinnedLongSnapshot(StorageServer* data) {
+	for (const auto& [version, snapshot] : data->longSnapshots) {
+		if (snapshot.engineSnapshot < 0) {
+			return version;
+		}
+	}
+	return invalidVersion;
+}
+
+// Returns true if updateStorage() may write the mutations of the next commit while the previous one is in flight.
+// Redwood and RocksDB move the writes made so far into the commit when it starts, so later writes go into the next
+// commit, and reads don't see them until then. Versions at which key ranges are added or removed, a checkpoint is
+// created or a long snapshot is pinned, need the previous commit to be durable first, so there's no pipelining while
+// any are pending.
+bool canPipelineStorageCommits(StorageServer* data) {
+	const KeyValueStoreType type = data->storage.getKeyValueStoreType();
+	return SERVER_KNOBS->STORAGE_PIPELINED_COMMIT &&
+	       (type == KeyValueStoreType::SSD_REDWOOD_V1 || type == KeyValueStoreType::SSD_ROCKSDB_V1) &&
+	       data->pendingCheckpoints.empty() && data->pendingAddRanges.empty() && data->pendingRemoveRanges.empty() &&
+	       oldestUnpinnedLongSnapshot(data) == invalidVersion &&
+	       data->desiredOldestVersion.get() > data->storageVersion();
+}
+
 ACTOR Future<Void> updateStorage(StorageServer* data) {
 	state UnlimitedCommitBytes unlimitedCommitBytes = UnlimitedCommitBytes::False;
 	state Future<Void> durableDelay = Void();
 	state std::deque<UpdateStorageCommitStats> recentCommitStats;
+	// Mutation bytes of versions (durableVersion, storageVersion()] written while the previous commit was in flight
+	state int64_t stagedBytes = 0;
+	state bool staged = false;
 
 	loop {
 		while (recentCommitStats.size() > SERVER_KNOBS->LOGGING_RECENT_STORAGE_COMMIT_SIZE) {
@@ -11920,7 +13604,8 @@ ACTOR Future<Void> updateStorage(StorageServer* data) {
 		}
 		recentCommitStats.push_back(UpdateStorageCommitStats());
 		unlimitedCommitBytes = UnlimitedCommitBytes::False;
-		ASSERT(data->durableVersion.get() == data->storageVersion());
+		ASSERT(staged ? data->durableVersion.get() < data->storageVersion()
+		              : data->durableVersion.get() == data->storageVersion());
 		if (g_network->isSimulated()) {
 			double endTime =
 			    g_simulator->checkDisabled(format("%s/updateStorage", data->thisServerID.toString().c_str()));
@@ -11931,8 +13616,8 @@ ACTOR Future<Void> updateStorage(StorageServer* data) {
 
 		// If the fetch keys budget is not used up then we have already waited for the storage commit delay so
 		// wait for either a new mutation version or the budget to be used up.
-		// Otherwise, don't wait at all.
-		if (!data->fetchKeysBudgetUsed.get()) {
+		// Otherwise, don't wait at all. Nor if there are already staged mutations to commit.
+		if (!staged && !data->fetchKeysBudgetUsed.get()) {
 			wait(data->desiredOldestVersion.whenAtLeast(data->storageVersion() + 1) ||
 			     data->fetchKeysBudgetUsed.onChange());
 		}
@@ -11946,10 +13631,10 @@ ACTOR Future<Void> updateStorage(StorageServer* data) {
 		state Promise<Void> durableInProgress;
 		data->durableInProgress = durableInProgress.getFuture();
 
-		state Version startOldestVersion = data->storageVersion();
+		state Version startOldestVersion = data->durableVersion.get();
 		state Version newOldestVersion = data->storageVersion();
 		state Version desiredVersion = data->desiredOldestVersion.get();
-		state int64_t bytesLeft = SERVER_KNOBS->STORAGE_COMMIT_BYTES;
+		state int64_t bytesLeft = SERVER_KNOBS->STORAGE_COMMIT_BYTES - stagedBytes;
 
 		// Clean up stale checkpoint requests, this is not supposed to happen, since checkpoints are cleaned up on
 		// failures. This is kept as a safeguard.
@@ -11964,6 +13649,24 @@ ACTOR Future<Void> updateStorage(StorageServer* data) {
 			data->pendingCheckpoints.erase(data->pendingCheckpoints.begin());
 		}
 
+		// Long snapshots whose versions were written past before they could be pinned, e.g. by staged mutations
+		for (auto it = data->longSnapshots.begin(); it != data->longSnapshots.end() && it->first < newOldestVersion;) {
+			auto next = std::next(it);
+			if (it->second.engineSnapshot < 0) {
+				CODE_PROBE(true, "Long snapshot version written past before it was pinned");
+				dropLongSnapshot(data, it, transaction_too_old());
+			}
+			it = next;
+		}
+
+		// Stop at the version of the oldest long snapshot waiting to be pinned, which is pinned once it's durable
+		state bool requireLongSnapshot = false;
+		const Version lsVer = oldestUnpinnedLongSnapshot(data);
+		if (lsVer != invalidVersion && lsVer <= desiredVersion) {
+			desiredVersion = lsVer;
+			requireLongSnapshot = true;
+		}
+
 		// Create checkpoint if the pending request version is within (startOldestVersion, desiredVersion].
 		// Versions newer than the checkpoint version won't be committed before the checkpoint is created.
 		state bool requireCheckpoint = false;
@@ -12026,23 +13729,10 @@ ACTOR Future<Void> updateStorage(StorageServer* data) {
 
 		// Write mutations to storage until we reach the desiredVersion or have written too much (bytesleft)
 		state double beforeStorageUpdates = now();
-		loop {
-			state bool done = data->storage.makeVersionMutationsDurable(
-			    newOldestVersion, desiredVersion, bytesLeft, unlimitedCommitBytes);
-			if (data->tenantMap.getLatestVersion() < newOldestVersion) {
-				data->tenantMap.createNewVersion(newOldestVersion);
-			}
-			// We want to forget things from these data structures atomically with changing oldestVersion (and
-			// "before", since oldestVersion.set() may trigger waiting actors) forgetVersionsBeforeAsync visibly
-			// forgets immediately (without waiting) but asynchronously frees memory.
-			Future<Void> finishedForgetting =
-			    data->mutableData().forgetVersionsBeforeAsync(newOldestVersion, TaskPriority::UpdateStorage) &&
-			    data->tenantMap.forgetVersionsBeforeAsync(newOldestVersion, TaskPriority::UpdateStorage);
-			data->oldestVersion.set(newOldestVersion);
-			wait(finishedForgetting);
-			wait(yield(TaskPriority::UpdateStorage));
-			if (done)
-				break;
+		if (desiredVersion > newOldestVersion) {
+			wait(store(
+			    newOldestVersion,
+			    writeMutationsToStorage(data, newOldestVersion, desiredVersion, &bytesLeft, unlimitedCommitBytes)));
 		}
 
 		recentCommitStats.back().mutationBytes = SERVER_KNOBS->STORAGE_COMMIT_BYTES - bytesLeft;
@@ -12170,6 +13860,19 @@ ACTOR Future<Void> updateStorage(StorageServer* data) {
 			curFeed++;
 		}
 
+		if (data->storage.keepsVersions()) {
+			// The engine only has to keep the versions which reads may still want
+			data->engineOldestVersion =
+			    std::max(data->engineOldestVersion,
+			             std::min(newOldestVersion,
+			                      data->version.get() - SERVER_KNOBS->MAX_READ_TRANSACTION_LIFE_VERSIONS));
+			data->storage.setOldestReadableVersion(data->engineOldestVersion);
+			auto after = data->shardChangeCounters.upper_bound(data->engineOldestVersion);
+			if (after != data->shardChangeCounters.begin()) {
+				data->shardChangeCounters.erase(data->shardChangeCounters.begin(), std::prev(after));
+			}
+		}
+
 		// Set the new durable version as part of the outstanding change set, before commit
 		if (startOldestVersion != newOldestVersion)
 			data->storage.makeVersionDurable(newOldestVersion);
@@ -12191,6 +13894,24 @@ ACTOR Future<Void> updateStorage(StorageServer* data) {
 		    (bytesLeft > 0) ? delay(SERVER_KNOBS->STORAGE_COMMIT_INTERVAL, TaskPriority::UpdateStorage) : Void();
 
 		recentCommitStats.back().whenCommit = now();
+
+		// In pipelined mode, write the mutations of the next commit to the engine while this one is in flight.
+		staged = false;
+		stagedBytes = 0;
+		if (canPipelineStorageCommits(data)) {
+			state int64_t stagingBytesLeft = SERVER_KNOBS->STORAGE_COMMIT_BYTES;
+			state double beforeStaging = now();
+			Version stagedVersion = wait(writeMutationsToStorage(data,
+			                                                     newOldestVersion,
+			                                                     data->desiredOldestVersion.get(),
+			                                                     &stagingBytesLeft,
+			                                                     UnlimitedCommitBytes::False));
+			staged = stagedVersion > newOldestVersion;
+			stagedBytes = SERVER_KNOBS->STORAGE_COMMIT_BYTES - stagingBytesLeft;
+			recentCommitStats.back().stagedMutationBytes = stagedBytes;
+			recentCommitStats.back().stagingDuration = now() - beforeStaging;
+		}
+
 		try {
 			loop {
 				choose {
@@ -12286,6 +14007,26 @@ ACTOR Future<Void> updateStorage(StorageServer* data) {
 			requireCheckpoint = false;
 		}
 
+		if (requireLongSnapshot) {
+			// newOldestVersion could be smaller than the long snapshot's version due to the byte limit
+			auto it = data->longSnapshots.find(newOldestVersion);
+			if (it != data->longSnapshots.end() && it->second.engineSnapshot < 0) {
+				const int64_t engineSnapshot = data->storage.pinSnapshot();
+				if (engineSnapshot < 0) {
+					TraceEvent(SevWarnAlways, "StorageLongSnapshotUnsupported", data->thisServerID)
+					    .detail("StorageEngine", data->storage.getKeyValueStoreType().toString());
+					data->longSnapshotsUnsupported = true;
+					dropLongSnapshot(data, it, transaction_too_old());
+				} else {
+					TraceEvent(SevDebug, "StorageLongSnapshotPinned", data->thisServerID)
+					    .detail("Version", newOldestVersion);
+					it->second.engineSnapshot = engineSnapshot;
+					it->second.pinned.send(Void());
+				}
+			}
+			requireLongSnapshot = false;
+		}
+
 		if (newOldestVersion > data->rebootAfterDurableVersion) {
 			TraceEvent("RebootWhenDurableTriggered", data->thisServerID)
 			    .detail("NewOldestVersion", newOldestVersion)
@@ -12516,6 +14257,7 @@ void setAssignedStatus(StorageServer* self, KeyRangeRef keys, bool nowAssigned)
 }
 
 void StorageServerDisk::clearRange(KeyRangeRef keys) {
+	hotValues.invalidate(keys);
 	storage->clear(keys);
 	++(*kvClearRanges);
 	if (keys.singleKeyRange()) {
@@ -12524,15 +14266,18 @@ void StorageServerDisk::clearRange(KeyRangeRef keys) {
 }
 
 void StorageServerDisk::writeKeyValue(KeyValueRef kv) {
+	hotValues.invalidate(kv.key);
 	storage->set(kv);
 	*kvCommitLogicalBytes += kv.expectedSize();
 }
 
 void StorageServerDisk::writeMutation(MutationRef mutation) {
 	if (mutation.type == MutationRef::SetValue) {
+		hotValues.invalidate(mutation.param1);
 		storage->set(KeyValueRef(mutation.param1, mutation.param2));
 		*kvCommitLogicalBytes += mutation.expectedSize();
 	} else if (mutation.type == MutationRef::ClearRange) {
+		hotValues.invalidate(KeyRangeRef(mutation.param1, mutation.param2));
 		storage->clear(KeyRangeRef(mutation.param1, mutation.param2));
 		++(*kvClearRanges);
 		if (KeyRangeRef(mutation.param1, mutation.param2).singleKeyRange()) {
@@ -12572,9 +14317,11 @@ void StorageServerDisk::writeMutations(const VectorRef<MutationRef>& mutations,
 		DEBUG_MUTATION(debugContext, debugVersion, m, data->thisServerID);
 		ASSERT(m.validateChecksum());
 		if (m.type == MutationRef::SetValue) {
+			hotValues.invalidate(m.param1);
 			storage->set(KeyValueRef(m.param1, m.param2));
 			*kvCommitLogicalBytes += m.expectedSize();
 		} else if (m.type == MutationRef::ClearRange) {
+			hotValues.invalidate(KeyRangeRef(m.param1, m.param2));
 			storage->clear(KeyRangeRef(m.param1, m.param2));
 			++(*kvClearRanges);
 			if (KeyRangeRef(m.param1, m.param2).singleKeyRange()) {
@@ -12598,6 +14345,7 @@ bool StorageServerDisk::makeVersionMutationsDurable(Version& prevStorageVersion,
 		ASSERT(v.version > prevStorageVersion && v.version <= newStorageVersion);
 		// TODO(alexmiller): Update to version tracking.
 		// DEBUG_KEY_RANGE("makeVersionMutationsDurable", v.version, KeyRangeRef());
+		storage->setWriteVersion(v.version);
 		if (!SimBugInjector().isEnabled()) {
 			writeMutations(v.mutations, v.version, "makeVersionDurable");
 		} else {
@@ -12747,6 +14495,51 @@ ACTOR Future<Void> restoreByteSample(StorageServer* data,
 	return Void();
 }
 
+// Checkpoints and tenants don't depend on the shards or the feeds of the server, so they are restored as soon as they
+// are read, while the shards still are
+ACTOR Future<Void> restoreCheckpoints(StorageServer* data,
+                                      Version version,
+                                      Future<RangeResult> fPendingCheckpoints,
+                                      Future<RangeResult> fCheckpoints) {
+	state RangeResult pendingCheckpoints = wait(fPendingCheckpoints);
+	state int pCLoc;
+	for (pCLoc = 0; pCLoc < pendingCheckpoints.size(); ++pCLoc) {
+		CheckpointMetaData metaData = decodeCheckpointValue(pendingCheckpoints[pCLoc].value);
+		data->pendingCheckpoints[metaData.version].push_back(metaData);
+		wait(yield());
+	}
+
+	state RangeResult checkpoints = wait(fCheckpoints);
+	state int cLoc;
+	for (cLoc = 0; cLoc < checkpoints.size(); ++cLoc) {
+		CheckpointMetaData metaData = decodeCheckpointValue(checkpoints[cLoc].value);
+		data->checkpoints[metaData.checkpointID] = metaData;
+		if (metaData.getState() == CheckpointMetaData::Deleting) {
+			data->actors.add(deleteCheckpointQ(data, version, metaData));
+		}
+		wait(yield());
+	}
+	return Void();
+}
+
+ACTOR Future<Void> restoreTenantMap(StorageServer* data, Future<RangeResult> fTenantMap) {
+	state RangeResult tenantMap = wait(fTenantMap);
+	state int tenantMapLoc;
+	for (tenantMapLoc = 0; tenantMapLoc < tenantMap.size(); tenantMapLoc++) {
+		auto const& result = tenantMap[tenantMapLoc];
+		int64_t tenantId = TenantAPI::prefixToId(result.key.substr(persistTenantMapKeys.begin.size()));
+
+		data->tenantMap.insert(tenantId, ObjectReader::fromStringRef<TenantSSInfo>(result.value, IncludeVersion()));
+
+		TraceEvent("RestoringTenant", data->thisServerID)
+		    .detail("Key", tenantMap[tenantMapLoc].key)
+		    .detail("Tenant", tenantId);
+
+		wait(yield());
+	}
+	return Void();
+}
+
 ACTOR Future<bool> restoreDurableState(StorageServer* data, IKeyValueStore* storage) {
 	state Future<Optional<Value>> fFormat = storage->readValue(persistFormat.key);
 	state Future<Optional<Value>> fID = storage->readValue(persistID);
@@ -12774,20 +14567,20 @@ ACTOR Future<bool> restoreDurableState(StorageServer* data, IKeyValueStore* stor
 	TraceEvent("ReadingDurableState", data->thisServerID).log();
 	wait(waitForAll(
 	    std::vector{ fFormat, fID, ftssPairID, fssPairID, fTssQuarantine, fVersion, fLogProtocol, fPrimaryLocality }));
-	wait(waitForAll(std::vector{ fShardAssigned,
-	                             fShardAvailable,
-	                             fChangeFeeds,
-	                             fPendingCheckpoints,
-	                             fCheckpoints,
-	                             fMoveInShards,
-	                             fTenantMap,
-	                             fStorageShards,
-	                             fAccumulativeChecksum }));
-	wait(byteSampleSampleRecovered.getFuture());
 	TraceEvent("RestoringDurableState", data->thisServerID).log();
 
 	if (!fFormat.get().present()) {
-		// The DB was never initialized
+		// The DB was never initialized. Let the reads finish before the store is disposed of.
+		wait(waitForAll(std::vector{ fShardAssigned,
+		                             fShardAvailable,
+		                             fChangeFeeds,
+		                             fPendingCheckpoints,
+		                             fCheckpoints,
+		                             fMoveInShards,
+		                             fTenantMap,
+		                             fStorageShards,
+		                             fAccumulativeChecksum }));
+		wait(byteSampleSampleRecovered.getFuture());
 		TraceEvent("DBNeverInitialized", data->thisServerID).log();
 		TraceEvent("KVSRemoved", data->thisServerID).detail("Reason", "DBNeverInitialized");
 		storage->dispose();
@@ -12844,36 +14637,27 @@ ACTOR Future<bool> restoreDurableState(StorageServer* data, IKeyValueStore* stor
 	data->setInitialVersion(version);
 	data->bytesRestored += fVersion.get().expectedSize();
 
-	state RangeResult pendingCheckpoints = fPendingCheckpoints.get();
-	state int pCLoc;
-	for (pCLoc = 0; pCLoc < pendingCheckpoints.size(); ++pCLoc) {
-		CheckpointMetaData metaData = decodeCheckpointValue(pendingCheckpoints[pCLoc].value);
-		data->pendingCheckpoints[metaData.version].push_back(metaData);
-		wait(yield());
-	}
-
-	state RangeResult checkpoints = fCheckpoints.get();
-	state int cLoc;
-	for (cLoc = 0; cLoc < checkpoints.size(); ++cLoc) {
-		CheckpointMetaData metaData = decodeCheckpointValue(checkpoints[cLoc].value);
-		data->checkpoints[metaData.checkpointID] = metaData;
-		if (metaData.getState() == CheckpointMetaData::Deleting) {
-			data->actors.add(deleteCheckpointQ(data, version, metaData));
-		}
-		wait(yield());
-	}
+	// Each range is restored once it has been read, while the ones after it may still be read. The shards are restored
+	// before the feeds, since unassigned shards clean up the feeds they intersect.
+	state Future<Void> checkpointsRestored = restoreCheckpoints(data, version, fPendingCheckpoints, fCheckpoints);
+	state Future<Void> tenantMapRestored = restoreTenantMap(data, fTenantMap);
 
-	state RangeResult available = fShardAvailable.get();
+	state RangeResult available = wait(fShardAvailable);
 	data->bytesRestored += available.logicalSize();
 	state int availableLoc;
 	for (availableLoc = 0; availableLoc < available.size(); availableLoc++) {
-		KeyRangeRef keys(available[availableLoc].key.removePrefix(persistShardAvailableKeys.begin),
+		KeyRef begin = available[availableLoc].key.removePrefix(persistShardAvailableKeys.begin);
+		bool nowAvailable = available[availableLoc].value != "0"_sr;
+		// Insert runs of ranges with the same availability at once, since the map coalesces them anyway
+		while (availableLoc + 1 < available.size() && (available[availableLoc + 1].value != "0"_sr) == nowAvailable) {
+			availableLoc++;
+		}
+		KeyRangeRef keys(begin,
 		                 availableLoc + 1 == available.size()
 		                     ? allKeys.end
 		                     : available[availableLoc + 1].key.removePrefix(persistShardAvailableKeys.begin));
 		ASSERT(!keys.empty());
 
-		bool nowAvailable = available[availableLoc].value != "0"_sr;
 		/*if(nowAvailable)
 		TraceEvent("AvailableShard", data->thisServerID).detail("RangeBegin", keys.begin).detail("RangeEnd", keys.end);*/
 		data->newestAvailableVersion.insert(keys, nowAvailable ? latestVersion : invalidVersion);
@@ -12882,6 +14666,7 @@ ACTOR Future<bool> restoreDurableState(StorageServer* data, IKeyValueStore* stor
 
 	// Restore acs validator from persisted disk
 	if (data->acsValidator != nullptr) {
+		wait(success(fAccumulativeChecksum));
 		RangeResult accumulativeChecksums = fAccumulativeChecksum.get();
 		data->bytesRestored += accumulativeChecksums.logicalSize();
 		for (int acsLoc = 0; acsLoc < accumulativeChecksums.size(); acsLoc++) {
@@ -12892,7 +14677,8 @@ ACTOR Future<bool> restoreDurableState(StorageServer* data, IKeyValueStore* stor
 		}
 	}
 
-	state RangeResult assigned = fShardAssigned.get();
+	wait(success(fStorageShards) && success(fMoveInShards));
+	state RangeResult assigned = wait(fShardAssigned);
 	data->bytesRestored += assigned.logicalSize();
 	data->bytesRestored += fStorageShards.get().logicalSize();
 	data->bytesRestored += fMoveInShards.get().logicalSize();
@@ -12918,7 +14704,7 @@ ACTOR Future<bool> restoreDurableState(StorageServer* data, IKeyValueStore* stor
 		}
 	}
 
-	state RangeResult changeFeeds = fChangeFeeds.get();
+	state RangeResult changeFeeds = wait(fChangeFeeds);
 	data->bytesRestored += changeFeeds.logicalSize();
 	state int feedLoc;
 	for (feedLoc = 0; feedLoc < changeFeeds.size(); feedLoc++) {
@@ -12950,20 +14736,7 @@ ACTOR Future<bool> restoreDurableState(StorageServer* data, IKeyValueStore* stor
 	}
 	data->keyChangeFeed.coalesce(allKeys);
 
-	state RangeResult tenantMap = fTenantMap.get();
-	state int tenantMapLoc;
-	for (tenantMapLoc = 0; tenantMapLoc < tenantMap.size(); tenantMapLoc++) {
-		auto const& result = tenantMap[tenantMapLoc];
-		int64_t tenantId = TenantAPI::prefixToId(result.key.substr(persistTenantMapKeys.begin.size()));
-
-		data->tenantMap.insert(tenantId, ObjectReader::fromStringRef<TenantSSInfo>(result.value, IncludeVersion()));
-
-		TraceEvent("RestoringTenant", data->thisServerID)
-		    .detail("Key", tenantMap[tenantMapLoc].key)
-		    .detail("Tenant", tenantId);
-
-		wait(yield());
-	}
+	wait(checkpointsRestored && tenantMapRestored);
 
 	// TODO: why is this seemingly random delay here?
 	wait(delay(0.0001));
@@ -12986,6 +14759,8 @@ ACTOR Future<bool> restoreDurableState(StorageServer* data, IKeyValueStore* stor
 	}
 
 	validate(data, true);
+	// The byte sample doesn't block serving, so it is restored in the background from here on, once the sample of it
+	// has been read
 	startByteSampleRestore.send(Void());
 
 	return true;
@@ -13141,7 +14916,7 @@ void StorageServer::byteSampleApplyClear(KeyRangeRef range, Version ver) {
 	}
 
 	if (any) {
-		byteSample.eraseAsync(range.begin, range.end);
+		byteSample.erase(range.begin, range.end);
 		auto diskRange = range.withPrefix(persistByteSampleKeys.begin);
 		addMutationToMutationLogOrStorage(ver, MutationRef(MutationRef::ClearRange, diskRange.begin, diskRange.end));
 		++counters.kvSystemClearRanges;
@@ -13600,6 +15375,15 @@ ACTOR Future<Void> serveChangeFeedStreamRequests(StorageServer* self,
 	}
 }
 
+ACTOR Future<Void> serveChangeFeedMultiStreamRequests(
+    StorageServer* self,
+    FutureStream<ChangeFeedMultiStreamRequest> changeFeedMultiStream) {
+	loop {
+		ChangeFeedMultiStreamRequest req = waitNext(changeFeedMultiStream);
+		self->actors.add(changeFeedMultiStreamQ(self, req));
+	}
+}
+
 ACTOR Future<Void> serveOverlappingChangeFeedsRequests(
     StorageServer* self,
     FutureStream<OverlappingChangeFeedsRequest> overlappingChangeFeeds) {
@@ -13742,6 +15526,7 @@ ACTOR Future<Void> storageServerCore(StorageServer* self, StorageServerInterface
 	self->actors.add(serveGetKeyRequests(self, ssi.getKey.getFuture()));
 	self->actors.add(serveWatchValueRequests(self, ssi.watchValue.getFuture()));
 	self->actors.add(serveChangeFeedStreamRequests(self, ssi.changeFeedStream.getFuture()));
+	self->actors.add(serveChangeFeedMultiStreamRequests(self, ssi.changeFeedMultiStream.getFuture()));
 	self->actors.add(serveOverlappingChangeFeedsRequests(self, ssi.overlappingChangeFeeds.getFuture()));
 	self->actors.add(serveChangeFeedPopRequests(self, ssi.changeFeedPop.getFuture()));
 	self->actors.add(serveChangeFeedVersionUpdateRequests(self, ssi.changeFeedVersionUpdate.getFuture()));
@@ -13750,8 +15535,13 @@ ACTOR Future<Void> storageServerCore(StorageServer* self, StorageServerInterface
 	self->actors.add(storageEngineConsistencyCheck(self));
 
 	self->transactionTagCounter.startNewInterval();
-	self->actors.add(
-	    recurring([&]() { self->transactionTagCounter.startNewInterval(); }, SERVER_KNOBS->TAG_MEASUREMENT_INTERVAL));
+	self->readResourceCounter.startNewInterval();
+	self->actors.add(recurring(
+	    [&]() {
+		    self->transactionTagCounter.startNewInterval();
+		    self->readResourceCounter.startNewInterval();
+	    },
+	    SERVER_KNOBS->TAG_MEASUREMENT_INTERVAL));
 
 	self->coreStarted.send(Void());
 
@@ -13840,6 +15630,9 @@ ACTOR Future<Void> storageServerCore(StorageServer* self, StorageServerInterface
 			when(FetchCheckpointRequest req = waitNext(ssi.fetchCheckpoint.getFuture())) {
 				self->actors.add(fetchCheckpointQ(self, req));
 			}
+			when(LongSnapshotRequest req = waitNext(ssi.longSnapshot.getFuture())) {
+				self->actors.add(longSnapshotQ(self, req));
+			}
 			when(UpdateCommitCostRequest req = waitNext(ssi.updateCommitCostRequest.getFuture())) {
 				// Ratekeeper might change with a new ID. In this case, always accept the data.
 				if (req.ratekeeperID != self->busiestWriteTagContext.ratekeeperID) {
@@ -13937,8 +15730,7 @@ ACTOR Future<Void> storageServerCore(StorageServer* self, StorageServerInterface
 				req.reply.send(reply);
 			}
 			when(GetStorageCheckSumRequest req = waitNext(ssi.getCheckSum.getFuture())) {
-				TraceEvent(SevError, "GetStorageCheckSumHasNotImplemented", ssi.id());
-				req.reply.sendError(not_implemented());
+				self->actors.add(getStorageCheckSumQ(self, req));
 			}
 			when(wait(self->actors.getResult())) {}
 		}
@@ -38,6 +38,7 @@
 #include "flow/ActorCollection.h"
 #include "flow/Error.h"
 #include "flow/FileIdentifier.h"
+#include "flow/HeapProfiler.h"
 #include "flow/IRandom.h"
 #include "flow/Knobs.h"
 #include "flow/ObjectSerializer.h"
@@ -168,6 +169,77 @@ ACTOR Future<std::vector<Endpoint>> broadcastDBInfoRequest(UpdateServerDBInfoReq
 	return notUpdated;
 }
 
+uint8_t clearUnchangedDBInfoFields(ServerDBInfo& info, ServerDBInfo const& base) {
+	uint8_t unchangedFields = 0;
+	if (info.client == base.client) {
+		info.client = ClientDBInfo();
+		unchangedFields |= DBINFO_FIELD_CLIENT;
+	}
+	if (info.logSystemConfig == base.logSystemConfig) {
+		info.logSystemConfig = LogSystemConfig(0);
+		unchangedFields |= DBINFO_FIELD_LOG_SYSTEM_CONFIG;
+	}
+	if (info.resolvers == base.resolvers) {
+		info.resolvers.clear();
+		unchangedFields |= DBINFO_FIELD_RESOLVERS;
+	}
+	if (info.priorCommittedLogServers == base.priorCommittedLogServers) {
+		info.priorCommittedLogServers.clear();
+		unchangedFields |= DBINFO_FIELD_PRIOR_COMMITTED_LOG_SERVERS;
+	}
+	return unchangedFields;
+}
+
+void restoreUnchangedDBInfoFields(ServerDBInfo& info, ServerDBInfo const& base, uint8_t unchangedFields) {
+	if (unchangedFields & DBINFO_FIELD_CLIENT) {
+		info.client = base.client;
+	}
+	if (unchangedFields & DBINFO_FIELD_LOG_SYSTEM_CONFIG) {
+		info.logSystemConfig = base.logSystemConfig;
+	}
+	if (unchangedFields & DBINFO_FIELD_RESOLVERS) {
+		info.resolvers = base.resolvers;
+	}
+	if (unchangedFields & DBINFO_FIELD_PRIOR_COMMITTED_LOG_SERVERS) {
+		info.priorCommittedLogServers = base.priorCommittedLogServers;
+	}
+}
+
+namespace {
+
+TEST_CASE("/fdbserver/worker/dbInfoDelta") {
+	ServerDBInfo base;
+	base.id = deterministicRandom()->randomUniqueID();
+	base.client.id = deterministicRandom()->randomUniqueID();
+	base.client.commitProxies.push_back(CommitProxyInterface());
+	base.logSystemConfig.tLogs.push_back(TLogSet());
+	base.resolvers.push_back(ResolverInterface());
+	base.priorCommittedLogServers.push_back(deterministicRandom()->randomUniqueID());
+
+	// Only the resolvers changed, so the delta leaves out the other large fields
+	ServerDBInfo info = base;
+	info.id = deterministicRandom()->randomUniqueID();
+	info.resolvers.push_back(ResolverInterface());
+	info.infoGeneration = 1;
+	ServerDBInfo delta = info;
+	uint8_t unchangedFields = clearUnchangedDBInfoFields(delta, base);
+	ASSERT_EQ(unchangedFields,
+	          DBINFO_FIELD_CLIENT | DBINFO_FIELD_LOG_SYSTEM_CONFIG | DBINFO_FIELD_PRIOR_COMMITTED_LOG_SERVERS);
+	ASSERT(delta.client.commitProxies.empty() && delta.logSystemConfig.tLogs.empty());
+	ASSERT(delta.priorCommittedLogServers.empty() && delta.resolvers.size() == 2);
+
+	ServerDBInfo received = delta;
+	restoreUnchangedDBInfoFields(received, base, unchangedFields);
+	ASSERT(received.id == info.id && received.infoGeneration == info.infoGeneration);
+	ASSERT(received.client.id == info.client.id && received.client.commitProxies.size() == 1);
+	ASSERT(received.logSystemConfig == info.logSystemConfig);
+	ASSERT(received.resolvers == info.resolvers);
+	ASSERT(received.priorCommittedLogServers == info.priorCommittedLogServers);
+	return Void();
+}
+
+} // namespace
+
 ACTOR static Future<Void> extractClientInfo(Reference<AsyncVar<ServerDBInfo> const> db,
                                             Reference<AsyncVar<ClientDBInfo>> info) {
 	state std::vector<UID> lastCommitProxyUIDs;
@@ -2067,6 +2139,65 @@ void cleanupStorageDisks(Reference<AsyncVar<ServerDBInfo>> dbInfo,
 	}
 }
 
+// The bytes of the files of a store, or 0 if they can't be found, e.g. for the memory engines, whose filename is only
+// the prefix of their files
+static int64_t diskStoreBytes(const DiskStore& store) {
+	if (fileExists(store.filename)) {
+		return fileSize(store.filename);
+	}
+	int64_t bytes = 0;
+	if (directoryExists(store.filename)) {
+		for (const auto& file : platform::listFiles(store.filename)) {
+			bytes += fileSize(joinPath(store.filename, file));
+		}
+	}
+	return bytes;
+}
+
+// Orders the stores found at startup so that TLogs, which a recovery of the cluster may be waiting for, are opened
+// first, and then the storage servers from the smallest, which are the quickest to recover, to the largest. The TLogs
+// keep their order, since the last one of each kind becomes the active shared TLog.
+static void orderDiskStoresForStartup(std::vector<DiskStore>& stores) {
+	std::vector<std::pair<int64_t, DiskStore>> sized;
+	for (const auto& store : stores) {
+		sized.emplace_back(store.storedComponent == DiskStore::Storage ? diskStoreBytes(store) : 0, store);
+	}
+	auto rank = [](const DiskStore& s) {
+		return s.storedComponent == DiskStore::TLogData ? 0 : s.storedComponent == DiskStore::Storage ? 1 : 2;
+	};
+	std::stable_sort(sized.begin(), sized.end(), [&rank](const auto& a, const auto& b) {
+		return std::make_pair(rank(a.second), a.first) < std::make_pair(rank(b.second), b.first);
+	});
+	for (int i = 0; i < stores.size(); i++) {
+		stores[i] = sized[i].second;
+	}
+}
+
+// Traces how long the role of a store found at startup took to recover its files, and so to be ready to serve, and
+// returns its permits to startLock
+ACTOR static Future<Void> storeRecovered(Future<Void> recovery,
+                                         Role role,
+                                         UID id,
+                                         KeyValueStoreType storeType,
+                                         double workerStartTime,
+                                         double openTime,
+                                         Reference<FlowLock> startLock,
+                                         int permits) {
+	state ErrorOr<Void> result = wait(errorOr(recovery));
+	startLock->release(permits);
+	TraceEvent("WorkerStoreRecovered", id)
+	    .detail("Role", role.roleName)
+	    .detail("StorageEngine", storeType.toString())
+	    .detail("QueueTime", openTime - workerStartTime)
+	    .detail("RecoveryTime", now() - openTime)
+	    .detail("TimeToServe", now() - workerStartTime)
+	    .detail("Error", result.isError() ? result.getError().name() : "None");
+	if (result.isError()) {
+		throw result.getError();
+	}
+	return Void();
+}
+
 ACTOR Future<Void> workerServer(Reference<IClusterConnectionRecord> connRecord,
                                 Reference<AsyncVar<Optional<ClusterControllerFullInterface>> const> ccInterface,
                                 LocalityData locality,
@@ -2220,6 +2351,13 @@ ACTOR Future<Void> workerServer(Reference<IClusterConnectionRecord> connRecord,
 		state std::vector<DiskStore> stores = getDiskStores(folder);
 		state bool validateDataFiles = deleteFile(joinPath(folder, validationFilename));
 		state int index = 0;
+		// Bounds the storage servers recovering their files at once, since they compete for the disk and the
+		// network thread
+		state int storageRecoveryPermits = SERVER_KNOBS->WORKER_STORAGE_RECOVERY_PARALLELISM > 0 ? 1 : 0;
+		state Reference<FlowLock> storageRecoveryLock =
+		    makeReference<FlowLock>(std::max(1, SERVER_KNOBS->WORKER_STORAGE_RECOVERY_PARALLELISM));
+		state double startTime = now();
+		orderDiskStoresForStartup(stores);
 		for (; index < stores.size(); ++index) {
 			state DiskStore s = stores[index];
 			// FIXME: Error handling
@@ -2229,6 +2367,9 @@ ACTOR Future<Void> workerServer(Reference<IClusterConnectionRecord> connRecord,
 				if (index >= 2 && SERVER_KNOBS->WORKER_START_STORAGE_DELAY > 0.0) {
 					wait(delay(SERVER_KNOBS->WORKER_START_STORAGE_DELAY));
 				}
+				if (storageRecoveryPermits > 0) {
+					wait(storageRecoveryLock->take(TaskPriority::DefaultYield, storageRecoveryPermits));
+				}
 				LocalLineage _;
 				getCurrentLineage()->modify(&RoleLineage::role) = ProcessClass::ClusterRole::Storage;
 
@@ -2299,7 +2440,14 @@ ACTOR Future<Void> workerServer(Reference<IClusterConnectionRecord> connRecord,
 				Future<ErrorOr<Void>> storeError = errorOr(kv->getError());
 				Promise<Void> recovery;
 				Future<Void> f = storageServer(kv, recruited, dbInfo, folder, recovery, connRecord, encryptionMonitor);
-				recoveries.push_back(recovery.getFuture());
+				recoveries.push_back(storeRecovered(recovery.getFuture(),
+				                                    ssRole,
+				                                    recruited.id(),
+				                                    s.storeType,
+				                                    startTime,
+				                                    now(),
+				                                    storageRecoveryLock,
+				                                    storageRecoveryPermits));
 
 				f = handleIOErrors(f, storeError, s.storeID, kvClosed);
 				f = storageServerRollbackRebooter(&runningStorages,
@@ -2339,7 +2487,8 @@ ACTOR Future<Void> workerServer(Reference<IClusterConnectionRecord> connRecord,
 				                                 false,
 				                                 false,
 				                                 dbInfo,
-				                                 EncryptionAtRestMode());
+				                                 EncryptionAtRestMode(),
+				                                 FLOW_KNOBS->TLOG_PAGE_CACHE);
 				const DiskQueueVersion dqv = s.tLogOptions.getDiskQueueVersion();
 				const int64_t diskQueueWarnSize =
 				    s.tLogOptions.spillType == TLogSpillType::VALUE ? 10 * SERVER_KNOBS->TARGET_BYTES_PER_TLOG : -1;
@@ -2376,7 +2525,14 @@ ACTOR Future<Void> workerServer(Reference<IClusterConnectionRecord> connRecord,
 				                         degraded,
 				                         activeSharedTLog,
 				                         enablePrimaryTxnSystemHealthCheck);
-				recoveries.push_back(recovery.getFuture());
+				recoveries.push_back(storeRecovered(recovery.getFuture(),
+				                                    Role::SHARED_TRANSACTION_LOG,
+				                                    s.storeID,
+				                                    s.storeType,
+				                                    startTime,
+				                                    now(),
+				                                    storageRecoveryLock,
+				                                    0));
 				activeSharedTLog->set(s.storeID);
 
 				tl = handleIOErrors(tl, kv, s.storeID);
@@ -2522,6 +2678,12 @@ ACTOR Future<Void> workerServer(Reference<IClusterConnectionRecord> connRecord,
 				ServerDBInfo localInfo = BinaryReader::fromStringRef<ServerDBInfo>(
 				    req.serializedDbInfo, AssumeVersion(g_network->protocolVersion()));
 				localInfo.myLocality = locality;
+				// A delta can only be applied to the ServerDBInfo it was made against
+				bool missingDeltaBase = req.deltaBaseID.isValid() && req.deltaBaseID != dbInfo->get().id &&
+				                        localInfo.id != dbInfo->get().id;
+				if (req.deltaBaseID.isValid() && !missingDeltaBase) {
+					restoreUnchangedDBInfoFields(localInfo, dbInfo->get(), req.unchangedFields);
+				}
 
 				if (localInfo.infoGeneration < dbInfo->get().infoGeneration &&
 				    localInfo.clusterInterface == dbInfo->get().clusterInterface) {
@@ -2530,7 +2692,8 @@ ACTOR Future<Void> workerServer(Reference<IClusterConnectionRecord> connRecord,
 					req.reply.send(rep);
 				} else {
 					Optional<Endpoint> notUpdated;
-					if (!ccInterface->get().present() || localInfo.clusterInterface != ccInterface->get().get()) {
+					if (!ccInterface->get().present() || localInfo.clusterInterface != ccInterface->get().get() ||
+					    missingDeltaBase) {
 						notUpdated = interf.updateServerDBInfo.getEndpoint();
 					} else if (localInfo.infoGeneration > dbInfo->get().infoGeneration ||
 					           dbInfo->get().clusterInterface != ccInterface->get().get()) {
@@ -2905,7 +3068,8 @@ ACTOR Future<Void> workerServer(Reference<IClusterConnectionRecord> connRecord,
 					                                   false,
 					                                   false,
 					                                   dbInfo,
-					                                   EncryptionAtRestMode());
+					                                   EncryptionAtRestMode(),
+					                                   FLOW_KNOBS->TLOG_PAGE_CACHE);
 					const DiskQueueVersion dqv = tLogOptions.getDiskQueueVersion();
 					IDiskQueue* queue = openDiskQueue(
 					    joinPath(folder,
@@ -4085,6 +4249,21 @@ ACTOR Future<Void> serveProtocolInfo() {
 	}
 }
 
+#ifdef ENABLE_SAMPLING
+// The abbreviation of the role of the running actor, for the heap profiler
+const char* currentRoleAbbreviation() {
+	if (!currentLineage->isValid()) {
+		return nullptr;
+	}
+	auto role = (*currentLineage)->get(&RoleLineage::role);
+	return role.has_value() ? Role::get(role.value()).abbreviation.c_str() : nullptr;
+}
+#endif
+
+void startHeapProfiler() {
+	startHeapProfiler();
+}
+
 // Handles requests from ProcessInterface, an interface meant for direct
 // communication between the client and FDB processes.
 ACTOR Future<Void> serveProcess() {
@@ -4112,6 +4291,23 @@ ACTOR Future<Void> serveProcess() {
 				ActorLineageReply reply{ serializedSamples };
 				req.reply.send(reply);
 			}
+			when(HeapProfileRequest req = waitNext(process.heapProfile.getFuture())) {
+				HeapProfileReply reply;
+				reply.sampleBytes = heap_profiler::getSampleBytes();
+				for (auto const& site : heap_profiler::getLiveSites()) {
+					if (reply.sites.size() >= req.limit) {
+						break;
+					}
+					HeapProfileSite& out = reply.sites.emplace_back();
+					out.role = site.role;
+					out.backtrace =
+					    platform::format_backtrace(const_cast<void**>(site.backtrace.data()), site.backtrace.size());
+					out.liveSamples = site.liveSamples;
+					out.liveBytes = site.liveBytes;
+					out.allocatedBytes = site.allocatedBytes;
+				}
+				req.reply.send(reply);
+			}
 		}
 	}
 }
@@ -4149,6 +4345,7 @@ ACTOR Future<Void> fdbd(Reference<IClusterConnectionRecord> connRecord,
 	}
 	// setupStackSignal();
 	getCurrentLineage()->modify(&RoleLineage::role) = ProcessClass::Worker;
+	startHeapProfiler();
 
 	if (configDBType != ConfigDBType::DISABLED) {
 		configNode = makeReference<ConfigNode>(dataFolder);
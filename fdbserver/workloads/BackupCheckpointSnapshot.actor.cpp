@@ -0,0 +1,189 @@
+/*
+ * BackupCheckpointSnapshot.actor.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbclient/BackupCheckpointSnapshot.actor.h"
+#include "fdbclient/ManagementAPI.actor.h"
+#include "fdbclient/NativeAPI.actor.h"
+#include "fdbserver/IKeyValueStore.h"
+#include "fdbserver/workloads/workloads.actor.h"
+#include "flow/Platform.h"
+
+#include "flow/actorcompiler.h" // This must be the last #include.
+
+// Writes two checkpoint snapshots of a range, checks that the second one reuses the SST files of the first, and
+// restores a RocksDB store from the files of the second one to compare it with the database.
+struct BackupCheckpointSnapshotWorkload : TestWorkload {
+	static constexpr auto NAME = "BackupCheckpointSnapshot";
+	const bool enabled;
+	bool pass;
+
+	BackupCheckpointSnapshotWorkload(WorkloadContext const& wcx)
+	  : TestWorkload(wcx), enabled(!clientId), pass(true) {}
+
+	Future<Void> setup(Database const& cx) override { return Void(); }
+
+	Future<Void> start(Database const& cx) override {
+		if (!enabled) {
+			return Void();
+		}
+		return _start(this, cx);
+	}
+
+	void disableFailureInjectionWorkloads(std::set<std::string>& out) const override {
+		out.insert("RandomMoveKeys");
+		out.insert("Attrition");
+	}
+
+	ACTOR static Future<Void> writeKeys(Database cx, KeyRange range, int count) {
+		state Transaction tr(cx);
+		loop {
+			try {
+				for (int i = 0; i < count; ++i) {
+					tr.set(range.begin.withSuffix(format("%08d", i)),
+					       deterministicRandom()->randomAlphaNumeric(deterministicRandom()->randomInt(10, 100)));
+				}
+				wait(tr.commit());
+				return Void();
+			} catch (Error& e) {
+				wait(tr.onError(e));
+			}
+		}
+	}
+
+	// Copies the container file path into dir, and returns the local path
+	ACTOR static Future<std::string> downloadFile(Reference<IBackupContainer> bc, std::string path, std::string dir) {
+		state std::string localFile = joinPath(dir, path.substr(path.find_last_of('/') + 1));
+		state Reference<IAsyncFile> inFile = wait(bc->readFile(path));
+		state int64_t size = wait(inFile->size());
+		state Standalone<StringRef> buf = makeString(size);
+		int bytes = wait(inFile->read(mutateString(buf), size, 0));
+		ASSERT(bytes == size);
+
+		const int64_t flags = IAsyncFile::OPEN_ATOMIC_WRITE_AND_CREATE | IAsyncFile::OPEN_READWRITE |
+		                      IAsyncFile::OPEN_CREATE | IAsyncFile::OPEN_UNCACHED | IAsyncFile::OPEN_NO_AIO;
+		state Reference<IAsyncFile> outFile = wait(IAsyncFileSystem::filesystem()->open(localFile, flags, 0666));
+		wait(outFile->write(buf.begin(), buf.size(), 0));
+		wait(outFile->sync());
+		return localFile;
+	}
+
+	// Downloads the SST files of checkpoint into dir, and returns the checkpoint with the files' paths set to dir
+	ACTOR static Future<CheckpointMetaData> downloadCheckpoint(Reference<IBackupContainer> bc,
+	                                                           CheckpointMetaData checkpoint,
+	                                                           std::string dir) {
+		state RocksDBColumnFamilyCheckpoint rocksCF =
+		    ObjectReader::fromStringRef<RocksDBColumnFamilyCheckpoint>(checkpoint.serializedCheckpoint,
+		                                                               IncludeVersion());
+		state int i = 0;
+		for (; i < rocksCF.sstFiles.size(); ++i) {
+			wait(success(downloadFile(bc, rocksCF.sstFiles[i].db_path + rocksCF.sstFiles[i].name, dir)));
+			rocksCF.sstFiles[i].directory = dir;
+			rocksCF.sstFiles[i].db_path = dir;
+			rocksCF.sstFiles[i].fetched = true;
+		}
+		checkpoint.serializedCheckpoint = ObjectWriter::toValue(rocksCF, IncludeVersion());
+		return checkpoint;
+	}
+
+	ACTOR static Future<Void> _start(BackupCheckpointSnapshotWorkload* self, Database cx) {
+		state KeyRange testRange = KeyRangeRef("BackupCheckpoint/"_sr, "BackupCheckpoint0"_sr);
+		state Reference<IBackupContainer> bc = IBackupContainer::openContainer(
+		    "file://simfdb/backups/checkpoint-" + deterministicRandom()->randomUniqueID().toString(), {}, {});
+		wait(bc->create());
+
+		int ignore = wait(setDDMode(cx, 0));
+		wait(writeKeys(cx, testRange, 1000));
+
+		state CheckpointSnapshotManifest first = wait(writeCheckpointSnapshot(cx, bc, { testRange }));
+		state CheckpointSnapshotManifest second = wait(writeCheckpointSnapshot(cx, bc, { testRange }));
+		TraceEvent("BackupCheckpointSnapshotWritten")
+		    .detail("FirstVersion", first.version)
+		    .detail("FirstUploadedBytes", first.uploadedBytes)
+		    .detail("SecondVersion", second.version)
+		    .detail("SecondUploadedBytes", second.uploadedBytes)
+		    .detail("SecondReusedBytes", second.reusedBytes);
+		if (first.checkpoints.empty() || first.reusedBytes != 0 || second.reusedBytes == 0) {
+			TraceEvent(SevError, "BackupCheckpointSnapshotNotIncremental")
+			    .detail("FirstCheckpoints", first.checkpoints.size())
+			    .detail("FirstReusedBytes", first.reusedBytes)
+			    .detail("SecondReusedBytes", second.reusedBytes);
+			self->pass = false;
+		}
+
+		state std::string folder = joinPath(platform::getWorkingDirectory(), "checkpoint-snapshot");
+		platform::eraseDirectoryRecursive(folder);
+		ASSERT(platform::createDirectory(folder));
+		state std::vector<CheckpointMetaData> checkpoints;
+		state int i = 0;
+		for (; i < second.checkpoints.size(); ++i) {
+			CheckpointMetaData checkpoint = wait(downloadCheckpoint(bc, second.checkpoints[i], folder));
+			checkpoints.push_back(checkpoint);
+		}
+
+		state std::string rocksDBTestDir = "rocksdb-checkpoint-snapshot-db";
+		platform::eraseDirectoryRecursive(rocksDBTestDir);
+		state IKeyValueStore* kvStore = keyValueStoreRocksDB(
+		    rocksDBTestDir, deterministicRandom()->randomUniqueID(), KeyValueStoreType::SSD_ROCKSDB_V1);
+		wait(kvStore->init());
+		wait(kvStore->restore(checkpoints));
+
+		state Transaction tr(cx);
+		state RangeResult res;
+		loop {
+			try {
+				wait(store(res, tr.getRange(testRange, CLIENT_KNOBS->TOO_MANY)));
+				break;
+			} catch (Error& e) {
+				wait(tr.onError(e));
+			}
+		}
+		RangeResult kvRange = wait(kvStore->readRange(testRange));
+		if (res.size() != kvRange.size()) {
+			TraceEvent(SevError, "BackupCheckpointSnapshotMismatch")
+			    .detail("Expected", res.size())
+			    .detail("Restored", kvRange.size());
+			self->pass = false;
+		} else {
+			for (int k = 0; k < res.size(); ++k) {
+				if (res[k] != kvRange[k]) {
+					TraceEvent(SevError, "BackupCheckpointSnapshotMismatch").detail("Key", res[k].key);
+					self->pass = false;
+					break;
+				}
+			}
+		}
+
+		Future<Void> close = kvStore->onClosed();
+		kvStore->dispose();
+		wait(close);
+
+		{
+			int ignore = wait(setDDMode(cx, 1));
+			(void)ignore;
+		}
+		return Void();
+	}
+
+	Future<bool> check(Database const& cx) override { return pass; }
+
+	void getMetrics(std::vector<PerfMetric>& m) override {}
+};
+
+WorkloadFactory<BackupCheckpointSnapshotWorkload> BackupCheckpointSnapshotWorkloadFactory;
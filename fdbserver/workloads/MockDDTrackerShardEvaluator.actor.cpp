@@ -33,6 +33,7 @@ public:
 	PromiseStream<GetMetricsListRequest> getShardMetricsList;
 	PromiseStream<Promise<int64_t>> getAverageShardBytes;
 	PromiseStream<RebalanceStorageQueueRequest> triggerStorageQueueRebalance;
+	PromiseStream<BulkLoadShardRequest> bulkLoadShards;
 
 	KeyRangeMap<ShardTrackedData> shards;
 
@@ -114,7 +115,8 @@ public:
 		                                        getTopKMetrics.getFuture(),
 		                                        getShardMetricsList.getFuture(),
 		                                        getAverageShardBytes.getFuture(),
-		                                        triggerStorageQueueRebalance.getFuture()));
+		                                        triggerStorageQueueRebalance.getFuture(),
+		                                        bulkLoadShards.getFuture()));
 
 		actors.add(relocateShardReporter(this, output.getFuture()));
 
@@ -19,7 +19,7 @@
  */
 #include <vector>
 
-#include "fdbrpc/DDSketch.h"
+#include "flow/DDSketch.h"
 #include "fdbclient/NativeAPI.actor.h"
 #include "fdbserver/TesterInterface.actor.h"
 #include "fdbserver/workloads/workloads.actor.h"
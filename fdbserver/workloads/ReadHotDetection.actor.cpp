@@ -18,7 +18,7 @@
  * limitations under the License.
  */
 
-#include "fdbrpc/DDSketch.h"
+#include "flow/DDSketch.h"
 #include "fdbclient/NativeAPI.actor.h"
 #include "fdbserver/TesterInterface.actor.h"
 #include "fdbserver/workloads/BulkSetup.actor.h"
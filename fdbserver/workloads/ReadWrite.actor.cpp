@@ -23,7 +23,7 @@
 #include <vector>
 
 #include "fdbclient/FDBTypes.h"
-#include "fdbrpc/DDSketch.h"
+#include "flow/DDSketch.h"
 #include "fdbclient/NativeAPI.actor.h"
 #include "fdbserver/TesterInterface.actor.h"
 #include "fdbserver/WorkerInterface.actor.h"
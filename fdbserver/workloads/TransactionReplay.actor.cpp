@@ -0,0 +1,493 @@
+/*
+ * TransactionReplay.actor.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <map>
+#include <vector>
+
+#include "fdbclient/ClientLogEvents.h"
+#include "fdbclient/NativeAPI.actor.h"
+#include "fdbclient/SystemData.h"
+#include "flow/DDSketch.h"
+#include "fdbserver/workloads/workloads.actor.h"
+#include "flow/actorcompiler.h" // This must be the last #include.
+
+namespace {
+
+// The keys of sampled transactions are
+//   \xff\x02/fdbClientInfo/client_latency/SSSSSSSSSS/RRRRRRRRRRRRRRRR/NNNNTTTT/XXXX/
+// with a versionstamp S, the transaction id R, the big endian chunk number N of the T chunks of the entry and an
+// identifier X. Offsets are relative to the end of the prefix.
+const KeyRef clientLatencyInfoPrefix = "client_latency/"_sr;
+constexpr int trIdOffset = 11;
+constexpr int trIdSize = 16;
+constexpr int chunkNumOffset = trIdOffset + trIdSize + 1;
+constexpr int numChunksOffset = chunkNumOffset + 4;
+
+// The first protocol version storing EventGetVersion_V3 and EventCommit_V2, which are the only versions replayed
+constexpr uint64_t minReplayProtocolVersion = 0x0FDB00B063010001LL;
+
+enum class ReplayOpType { GET, GET_RANGE, COMMIT };
+
+struct ReplayOp {
+	ReplayOpType type;
+	double offset; // from the start of the transaction, in seconds as captured
+	double latency; // as captured
+	KeyRef begin, end; // the key read, or the range read
+	int bytes = 0; // of the value or the range read
+	VectorRef<MutationRef> mutations;
+};
+
+// A sampled transaction, as the operations it issued after getting its read version
+struct ReplayTransaction {
+	double startTs = 0;
+	double grvLatency = 0; // as captured
+	std::vector<ReplayOp> ops;
+};
+
+} // namespace
+
+// Replays the transactions sampled by client transaction profiling (see transactionInfoCommitActor), with the keys,
+// sizes and mutations they were captured with, at the rate they arrived times scale and with their inter-arrival and
+// think times divided by speedup. Reports the latency distributions of each type of operation and of whole
+// transactions.
+//
+// Captures are typically taken from a production cluster and replayed against a test cluster of the same data. Writes
+// are replayed under keyPrefix, which is empty by default, and writes and reads of system keys are skipped. Profiling
+// should be disabled on the cluster replayed against, or the replay samples itself into the capture.
+struct TransactionReplayWorkload : TestWorkload {
+	static constexpr auto NAME = "TransactionReplay";
+
+	double testDuration;
+	double speedup;
+	double scale;
+	int maxTransactions;
+	bool loopCapture;
+	Key keyPrefix;
+
+	Arena arena;
+	std::vector<ReplayTransaction> transactions; // of this client, in order of their start
+	int skippedEntries = 0;
+
+	DDSketch<double> grvLatencies, getLatencies, getRangeLatencies, commitLatencies, transactionLatencies;
+	DDSketch<double> capturedGetLatencies, capturedGetRangeLatencies, capturedCommitLatencies;
+	int64_t transactionsStarted = 0, transactionsCompleted = 0, retries = 0;
+	int64_t bytesRead = 0, bytesWritten = 0;
+	double lag = 0; // the largest delay of a transaction past its scheduled start
+
+	TransactionReplayWorkload(WorkloadContext const& wcx) : TestWorkload(wcx) {
+		testDuration = getOption(options, "testDuration"_sr, 60.0);
+		speedup = getOption(options, "speedup"_sr, 1.0);
+		scale = getOption(options, "scale"_sr, 1.0);
+		maxTransactions = getOption(options, "maxTransactions"_sr, 100000);
+		loopCapture = getOption(options, "loopCapture"_sr, true);
+		keyPrefix = getOption(options, "keyPrefix"_sr, ""_sr);
+		ASSERT(speedup > 0 && scale >= 0);
+	}
+
+	Future<Void> setup(Database const& cx) override { return loadCapture(cx, this); }
+
+	Future<Void> start(Database const& cx) override { return _start(cx, this); }
+
+	Future<bool> check(Database const& cx) override { return true; }
+
+	void getMetrics(std::vector<PerfMetric>& m) override {
+		m.emplace_back("Captured Transactions", transactions.size(), Averaged::False);
+		m.emplace_back("Skipped Entries", skippedEntries, Averaged::False);
+		m.emplace_back("Transactions Started", transactionsStarted, Averaged::False);
+		m.emplace_back("Transactions Completed", transactionsCompleted, Averaged::False);
+		m.emplace_back("Transactions/sec", transactionsCompleted / testDuration, Averaged::False);
+		m.emplace_back("Retries", retries, Averaged::False);
+		m.emplace_back("Bytes read/sec", bytesRead / testDuration, Averaged::False);
+		m.emplace_back("Bytes written/sec", bytesWritten / testDuration, Averaged::False);
+		m.emplace_back("Max Schedule Lag (ms)", 1000 * lag, Averaged::True);
+		addLatencyMetrics(m, "GRV", grvLatencies);
+		addLatencyMetrics(m, "Get", getLatencies);
+		addLatencyMetrics(m, "GetRange", getRangeLatencies);
+		addLatencyMetrics(m, "Commit", commitLatencies);
+		addLatencyMetrics(m, "Transaction", transactionLatencies);
+		addCapturedLatencyMetric(m, "Get", capturedGetLatencies);
+		addCapturedLatencyMetric(m, "GetRange", capturedGetRangeLatencies);
+		addCapturedLatencyMetric(m, "Commit", capturedCommitLatencies);
+	}
+
+	// The captured latencies, to compare the replay with
+	static void addCapturedLatencyMetric(std::vector<PerfMetric>& m,
+	                                     const std::string& name,
+	                                     DDSketch<double>& latencies) {
+		if (latencies.getPopulationSize() > 0) {
+			m.emplace_back("Captured Median " + name + " Latency (ms)", 1000 * latencies.median(), Averaged::True);
+		}
+	}
+
+	static void addLatencyMetrics(std::vector<PerfMetric>& m, const std::string& name, DDSketch<double>& latencies) {
+		m.emplace_back(name + " Count", latencies.getPopulationSize(), Averaged::False);
+		if (latencies.getPopulationSize() == 0) {
+			return;
+		}
+		m.emplace_back("Mean " + name + " Latency (ms)", 1000 * latencies.mean(), Averaged::True);
+		m.emplace_back("Median " + name + " Latency (ms, averaged)", 1000 * latencies.median(), Averaged::True);
+		m.emplace_back(
+		    "90% " + name + " Latency (ms, averaged)", 1000 * latencies.percentile(0.90), Averaged::True);
+		m.emplace_back(
+		    "99% " + name + " Latency (ms, averaged)", 1000 * latencies.percentile(0.99), Averaged::True);
+		m.emplace_back("Max " + name + " Latency (ms, averaged)", 1000 * latencies.max(), Averaged::True);
+	}
+
+	// Decodes one transaction info entry, or returns false if it can't be replayed
+	bool parseEntry(StringRef entry) {
+		BinaryReader reader(entry, Unversioned());
+		ProtocolVersion protocolVersion;
+		reader >> protocolVersion;
+		if (protocolVersion.version() < minReplayProtocolVersion) {
+			return false;
+		}
+		reader.setProtocolVersion(protocolVersion);
+
+		ReplayTransaction tr;
+		bool started = false;
+		while (!reader.empty()) {
+			FdbClientLogEvents::Event event;
+			reader >> event;
+			if (!started) {
+				tr.startTs = event.startTs;
+				started = true;
+			}
+			ReplayOp op;
+			op.offset = std::max(0.0, event.startTs - tr.startTs);
+			switch (event.type) {
+			case FdbClientLogEvents::EventType::GET_VERSION_LATENCY: {
+				FdbClientLogEvents::EventGetVersion_V3 gv;
+				reader >> gv;
+				tr.grvLatency = gv.latency;
+				continue;
+			}
+			case FdbClientLogEvents::EventType::GET_LATENCY: {
+				FdbClientLogEvents::EventGet g;
+				reader >> g;
+				op.type = ReplayOpType::GET;
+				op.latency = g.latency;
+				op.begin = KeyRef(arena, g.key);
+				op.bytes = g.valueSize;
+				break;
+			}
+			case FdbClientLogEvents::EventType::GET_RANGE_LATENCY: {
+				FdbClientLogEvents::EventGetRange gr;
+				reader >> gr;
+				op.type = ReplayOpType::GET_RANGE;
+				op.latency = gr.latency;
+				op.begin = KeyRef(arena, gr.startKey);
+				op.end = KeyRef(arena, gr.endKey);
+				op.bytes = gr.rangeSize;
+				break;
+			}
+			case FdbClientLogEvents::EventType::COMMIT_LATENCY: {
+				FdbClientLogEvents::EventCommit_V2 c;
+				reader >> c;
+				op.type = ReplayOpType::COMMIT;
+				op.latency = c.latency;
+				op.bytes = c.commitBytes;
+				op.mutations = VectorRef<MutationRef>(arena, c.req.transaction.mutations);
+				break;
+			}
+			// Failed operations are not replayed, since whether they fail depends on the cluster replayed against
+			case FdbClientLogEvents::EventType::ERROR_GET: {
+				FdbClientLogEvents::EventGetError ge;
+				reader >> ge;
+				continue;
+			}
+			case FdbClientLogEvents::EventType::ERROR_GET_RANGE: {
+				FdbClientLogEvents::EventGetRangeError gre;
+				reader >> gre;
+				continue;
+			}
+			case FdbClientLogEvents::EventType::ERROR_COMMIT: {
+				FdbClientLogEvents::EventCommitError ce;
+				reader >> ce;
+				continue;
+			}
+			default:
+				return false;
+			}
+			tr.ops.push_back(op);
+		}
+		if (!started) {
+			return false;
+		}
+		transactions.push_back(std::move(tr));
+		return true;
+	}
+
+	// Reassembles the chunks of the entries in kvs, which are in key order, and parses the complete entries
+	void parseEntries(const RangeResult& kvs, int prefixSize) {
+		std::map<StringRef, std::vector<StringRef>> chunks;
+		for (auto& kv : kvs) {
+			KeyRef suffix = kv.key.substr(prefixSize);
+			if (suffix.size() < numChunksOffset + 4) {
+				++skippedEntries;
+				continue;
+			}
+			StringRef trId = suffix.substr(trIdOffset, trIdSize);
+			int chunkNum = bigEndian32(
+			    BinaryReader::fromStringRef<int>(suffix.substr(chunkNumOffset, sizeof(int)), Unversioned()));
+			int numChunks = bigEndian32(
+			    BinaryReader::fromStringRef<int>(suffix.substr(numChunksOffset, sizeof(int)), Unversioned()));
+			if (chunkNum == 1) {
+				// An entry can be logged more than once, e.g. after commit_unknown_result
+				chunks[trId] = { kv.value };
+			} else {
+				auto it = chunks.find(trId);
+				if (it == chunks.end()) {
+					continue;
+				}
+				if (chunkNum != it->second.size() + 1) {
+					chunks.erase(it);
+					++skippedEntries;
+					continue;
+				}
+				it->second.push_back(kv.value);
+			}
+			if (chunkNum == numChunks) {
+				auto it = chunks.find(trId);
+				BinaryWriter bw(Unversioned());
+				for (auto& chunk : it->second) {
+					bw.serializeBytes(chunk);
+				}
+				try {
+					if (!parseEntry(bw.toValue())) {
+						++skippedEntries;
+					}
+				} catch (Error& e) {
+					if (e.code() == error_code_actor_cancelled) {
+						throw;
+					}
+					++skippedEntries;
+				}
+				chunks.erase(it);
+			}
+		}
+	}
+
+	ACTOR static Future<Void> loadCapture(Database cx, TransactionReplayWorkload* self) {
+		state Key prefix = clientLatencyInfoPrefix.withPrefix(fdbClientInfoPrefixRange.begin);
+		state KeySelector begin = firstGreaterOrEqual(prefix);
+		state KeySelector end = firstGreaterOrEqual(strinc(prefix));
+		state RangeResult entries;
+		state int keysLimit = 100;
+		state Transaction tr(cx);
+		loop {
+			try {
+				tr.setOption(FDBTransactionOptions::ACCESS_SYSTEM_KEYS);
+				tr.setOption(FDBTransactionOptions::LOCK_AWARE);
+				RangeResult kvs = wait(tr.getRange(begin, end, keysLimit));
+				if (kvs.empty()) {
+					break;
+				}
+				entries.arena().dependsOn(kvs.arena());
+				entries.append(entries.arena(), kvs.begin(), kvs.size());
+				begin = firstGreaterThan(kvs.back().key);
+				tr.reset();
+				// An entry is at most a few chunks, so this bounds how many are read past maxTransactions
+				if (entries.size() >= self->maxTransactions * 2) {
+					break;
+				}
+			} catch (Error& e) {
+				if (e.code() == error_code_transaction_too_old) {
+					keysLimit = std::max(1, keysLimit / 2);
+				}
+				wait(tr.onError(e));
+			}
+		}
+
+		self->parseEntries(entries, prefix.size());
+		std::stable_sort(self->transactions.begin(),
+		                 self->transactions.end(),
+		                 [](const ReplayTransaction& a, const ReplayTransaction& b) { return a.startTs < b.startTs; });
+		if (self->transactions.size() > self->maxTransactions) {
+			self->transactions.resize(self->maxTransactions);
+		}
+		for (auto& t : self->transactions) {
+			for (auto& op : t.ops) {
+				if (op.type == ReplayOpType::GET) {
+					self->capturedGetLatencies.addSample(op.latency);
+				} else if (op.type == ReplayOpType::GET_RANGE) {
+					self->capturedGetRangeLatencies.addSample(op.latency);
+				} else {
+					self->capturedCommitLatencies.addSample(op.latency);
+				}
+			}
+		}
+		TraceEvent("TransactionReplayCaptureLoaded")
+		    .detail("ClientId", self->clientId)
+		    .detail("Entries", entries.size())
+		    .detail("Transactions", self->transactions.size())
+		    .detail("Skipped", self->skippedEntries)
+		    .detail("CaptureSeconds",
+		            self->transactions.empty()
+		                ? 0.0
+		                : self->transactions.back().startTs - self->transactions.front().startTs);
+		return Void();
+	}
+
+	// Applies a captured mutation under keyPrefix, and returns its size, or 0 if it was skipped
+	int applyMutation(Transaction* tr, const MutationRef& m) const {
+		if (m.param1.startsWith(systemKeys.begin)) {
+			return 0;
+		}
+		if (m.type == MutationRef::SetValue) {
+			tr->set(m.param1.withPrefix(keyPrefix), m.param2);
+		} else if (m.type == MutationRef::ClearRange) {
+			KeyRef end = std::min(m.param2, systemKeys.begin);
+			tr->clear(KeyRangeRef(m.param1.withPrefix(keyPrefix), end.withPrefix(keyPrefix)));
+		} else if (m.type == MutationRef::SetVersionstampedKey) {
+			// The last four bytes of the key are the little endian offset of the versionstamp within it
+			if (m.param1.size() < sizeof(int32_t)) {
+				return 0;
+			}
+			Key key = m.param1.withPrefix(keyPrefix);
+			int32_t pos;
+			memcpy(&pos, key.end() - sizeof(int32_t), sizeof(int32_t));
+			pos = littleEndian32(littleEndian32(pos) + static_cast<int32_t>(keyPrefix.size()));
+			memcpy(mutateString(key) + key.size() - sizeof(int32_t), &pos, sizeof(int32_t));
+			tr->atomicOp(key, m.param2, static_cast<MutationRef::Type>(m.type));
+		} else if (m.isAtomicOp()) {
+			tr->atomicOp(m.param1.withPrefix(keyPrefix), m.param2, static_cast<MutationRef::Type>(m.type));
+		} else {
+			return 0;
+		}
+		return m.expectedSize();
+	}
+
+	ACTOR static Future<Void> replayTransaction(Database cx, TransactionReplayWorkload* self, ReplayTransaction* t) {
+		state Transaction tr(cx);
+		state double start = now();
+		state int i;
+		state int64_t written = 0;
+		++self->transactionsStarted;
+		loop {
+			try {
+				state double begin = now();
+				state double opStart = now();
+				wait(success(tr.getReadVersion()));
+				self->grvLatencies.addSample(now() - opStart);
+				for (i = 0; i < t->ops.size(); ++i) {
+					state ReplayOp* op = &t->ops[i];
+					// Keep the think time between the operations of the transaction
+					double thinkTime = begin + op->offset / self->speedup - now();
+					if (thinkTime > 0) {
+						wait(delay(thinkTime));
+					}
+					opStart = now();
+					if (op->type == ReplayOpType::GET) {
+						if (op->begin.startsWith(systemKeys.begin)) {
+							continue;
+						}
+						Optional<Value> value = wait(tr.get(op->begin));
+						self->getLatencies.addSample(now() - opStart);
+						self->bytesRead += value.present() ? value.get().size() : 0;
+					} else if (op->type == ReplayOpType::GET_RANGE) {
+						if (op->begin >= systemKeys.begin) {
+							continue;
+						}
+						// The captured range size bounds the bytes read, since the row limit wasn't captured
+						state KeyRange range = KeyRangeRef(op->begin, std::min(op->end, systemKeys.begin));
+						state GetRangeLimits limits(GetRangeLimits::ROW_LIMIT_UNLIMITED, op->bytes + 1);
+						RangeResult kvs = wait(tr.getRange(range, limits));
+						self->getRangeLatencies.addSample(now() - opStart);
+						self->bytesRead += kvs.expectedSize();
+					} else {
+						written = 0;
+						for (auto& m : op->mutations) {
+							written += self->applyMutation(&tr, m);
+						}
+						wait(tr.commit());
+						self->commitLatencies.addSample(now() - opStart);
+						self->bytesWritten += written;
+					}
+				}
+				break;
+			} catch (Error& e) {
+				++self->retries;
+				wait(tr.onError(e));
+			}
+		}
+		self->transactionLatencies.addSample(now() - start);
+		++self->transactionsCompleted;
+		return Void();
+	}
+
+	// Starts the transactions of this client at their captured times, divided by speedup, from now
+	ACTOR static Future<Void> replayCapture(Database cx, TransactionReplayWorkload* self) {
+		state ActorCollection inFlight(false);
+		state double captureStart = self->transactions.front().startTs;
+		state double captureEnd = self->transactions.back().startTs;
+		state double replayStart = now();
+		// A pass ends the mean inter-arrival time after its last transaction
+		state double period = self->transactions.size() > 1
+		                          ? (captureEnd - captureStart) * self->transactions.size() /
+		                                (self->transactions.size() - 1) / self->speedup
+		                          : 1.0 / self->speedup;
+		state int i;
+		loop {
+			for (i = 0; i < self->transactions.size(); ++i) {
+				state double scheduled = replayStart + (self->transactions[i].startTs - captureStart) / self->speedup;
+				if (scheduled > now()) {
+					wait(delay(scheduled - now()));
+				}
+				self->lag = std::max(self->lag, now() - scheduled);
+				// Each transaction is started scale times on average
+				int copies = static_cast<int>(self->scale);
+				if (deterministicRandom()->random01() < self->scale - copies) {
+					++copies;
+				}
+				for (int c = 0; c < copies; ++c) {
+					inFlight.add(replayTransaction(cx, self, &self->transactions[i]));
+				}
+			}
+			if (!self->loopCapture) {
+				break;
+			}
+			replayStart += std::max(period, 1e-3);
+		}
+		wait(inFlight.getResult());
+		return Void();
+	}
+
+	ACTOR static Future<Void> _start(Database cx, TransactionReplayWorkload* self) {
+		if (self->transactions.empty()) {
+			TraceEvent(SevWarnAlways, "TransactionReplayEmptyCapture").detail("ClientId", self->clientId);
+			return Void();
+		}
+		// Clients replay interleaved shares of the capture, so that together they replay all of it
+		if (self->clientCount > 1) {
+			std::vector<ReplayTransaction> share;
+			for (int i = self->clientId; i < self->transactions.size(); i += self->clientCount) {
+				share.push_back(std::move(self->transactions[i]));
+			}
+			self->transactions = std::move(share);
+			if (self->transactions.empty()) {
+				return Void();
+			}
+		}
+		wait(timeout(replayCapture(cx, self), self->testDuration, Void()));
+		return Void();
+	}
+};
+
+WorkloadFactory<TransactionReplayWorkload> TransactionReplayWorkloadFactory;
@@ -20,11 +20,14 @@
 
 #include "flow/Arena.h"
 
+#include "flow/HeapProfiler.h"
 #include "flow/UnitTest.h"
 #include "flow/ScopeExit.h"
 
 #include "flow/config.h"
 
+#include <bit>
+
 // We don't align memory properly, and we need to tell lsan about that.
 extern "C" const char* __lsan_default_options(void) {
 	return "use_unaligned=1";
@@ -105,6 +108,67 @@ void makeNoAccess(void*, size_t) {}
 void makeDefined(void*, size_t) {}
 void makeUndefined(void*, size_t) {}
 #endif
+
+// Arena blocks of 512 bytes and more are allocated with new[]. Each thread keeps up to ARENA_RECYCLED_BLOCKS freed
+// blocks of each power of two size up to 64KB, so that arenas which are created and destroyed over and over reuse their
+// blocks instead of going to malloc each time. The cache is plain data so that it stays usable while other thread local
+// objects are destroyed, and the blocks it holds when its thread exits are leaked.
+constexpr int recycledBlockClasses = 8;
+constexpr int maxRecycledBlockSize = 512 << (recycledBlockClasses - 1);
+constexpr int maxRecycledBlocks = 16;
+
+struct RecycledArenaBlocks {
+	void* blocks[recycledBlockClasses][maxRecycledBlocks];
+	int count[recycledBlockClasses];
+};
+thread_local RecycledArenaBlocks recycledArenaBlocks;
+
+// Returns how many blocks of each size the cache may hold, which is zero when memory checkers need to see every free
+int recycledBlockLimit() {
+#ifdef ADDRESS_SANITIZER
+	return 0;
+#else
+#if VALGRIND
+	if (valgrindPrecise()) {
+		return 0;
+	}
+#endif
+	if (!FLOW_KNOBS || keepalive_allocator::isActive()) {
+		return 0;
+	}
+	return std::min(FLOW_KNOBS->ARENA_RECYCLED_BLOCKS, maxRecycledBlocks);
+#endif
+}
+
+// Returns the index in recycledArenaBlocks of blocks of size bytes, or -1 if they aren't recycled
+int recycledBlockClass(int size) {
+	if (size < 512 || size > maxRecycledBlockSize || !std::has_single_bit(unsigned(size))) {
+		return -1;
+	}
+	return std::countr_zero(unsigned(size)) - 9;
+}
+
+uint8_t* allocateBlock(int size) {
+	int c = recycledBlockClass(size);
+	uint8_t* block;
+	if (c >= 0 && recycledArenaBlocks.count[c] > 0 && recycledBlockLimit() > 0) {
+		block = static_cast<uint8_t*>(recycledArenaBlocks.blocks[c][--recycledArenaBlocks.count[c]]);
+	} else {
+		block = allocateAndMaybeKeepalive(size);
+	}
+	heap_profiler::onAllocate(block, size);
+	return block;
+}
+
+void freeBlock(void* block, int size) {
+	heap_profiler::onRelease(block);
+	int c = recycledBlockClass(size);
+	if (c >= 0 && recycledArenaBlocks.count[c] < recycledBlockLimit()) {
+		recycledArenaBlocks.blocks[c][recycledArenaBlocks.count[c]++] = block;
+		return;
+	}
+	freeOrMaybeKeepalive(block);
+}
 } // namespace
 
 Arena::Arena() : impl(nullptr) {}
@@ -132,8 +196,8 @@ void Arena::dependsOn(const Arena& p) {
 	}
 }
 
-void* Arena::allocate4kAlignedBuffer(uint32_t size) {
-	return ArenaBlock::dependOn4kAlignedBuffer(impl, size);
+void* Arena::allocate4kAlignedBuffer(uint32_t size, FromPageSlab fromPageSlab) {
+	return ArenaBlock::dependOn4kAlignedBuffer(impl, size, fromPageSlab);
 }
 
 size_t Arena::getSize(FastInaccurateEstimate fastInaccurateEstimate) const {
@@ -294,11 +358,14 @@ void ArenaBlock::makeReference(ArenaBlock* next) {
 	totalSizeEstimate += next->estimatedTotalSize();
 }
 
-void* ArenaBlock::make4kAlignedBuffer(uint32_t size) {
+void* ArenaBlock::make4kAlignedBuffer(uint32_t size, FromPageSlab fromPageSlab) {
 	ArenaBlockRef* r = (ArenaBlockRef*)((char*)getData() + bigUsed);
 	makeDefined(r, sizeof(ArenaBlockRef));
 	r->aligned4kBufferSize = size;
-	r->aligned4kBuffer = allocateFast4kAligned(size);
+	r->aligned4kBuffer = fromPageSlab ? PageSlab::allocate(size) : nullptr;
+	if (r->aligned4kBuffer == nullptr) {
+		r->aligned4kBuffer = allocateFast4kAligned(size);
+	}
 	// printf("Arena::aligned4kBuffer alloc size=%u ptr=%p\n", size, r->aligned4kBuffer);
 	r->nextBlockOffset = nextBlockOffset;
 	auto result = r->aligned4kBuffer;
@@ -319,11 +386,11 @@ void ArenaBlock::dependOn(Reference<ArenaBlock>& self, ArenaBlock* other) {
 	}
 }
 
-void* ArenaBlock::dependOn4kAlignedBuffer(Reference<ArenaBlock>& self, uint32_t size) {
+void* ArenaBlock::dependOn4kAlignedBuffer(Reference<ArenaBlock>& self, uint32_t size, FromPageSlab fromPageSlab) {
 	if (!self || self->isTiny() || self->unused() < sizeof(ArenaBlockRef)) {
-		return create(SMALL, self)->make4kAlignedBuffer(size);
+		return create(SMALL, self)->make4kAlignedBuffer(size, fromPageSlab);
 	} else {
-		return self->make4kAlignedBuffer(size);
+		return self->make4kAlignedBuffer(size, fromPageSlab);
 	}
 }
 
@@ -386,23 +453,23 @@ ArenaBlock* ArenaBlock::create(int dataSize, Reference<ArenaBlock>& next) {
 				b->bigSize = 256;
 				INSTRUMENT_ALLOCATE("Arena256");
 			} else if (reqSize <= 512) {
-				b = (ArenaBlock*)allocateAndMaybeKeepalive(512);
+				b = (ArenaBlock*)allocateBlock(512);
 				b->bigSize = 512;
 				INSTRUMENT_ALLOCATE("Arena512");
 			} else if (reqSize <= 1024) {
-				b = (ArenaBlock*)allocateAndMaybeKeepalive(1024);
+				b = (ArenaBlock*)allocateBlock(1024);
 				b->bigSize = 1024;
 				INSTRUMENT_ALLOCATE("Arena1024");
 			} else if (reqSize <= 2048) {
-				b = (ArenaBlock*)allocateAndMaybeKeepalive(2048);
+				b = (ArenaBlock*)allocateBlock(2048);
 				b->bigSize = 2048;
 				INSTRUMENT_ALLOCATE("Arena2048");
 			} else if (reqSize <= 4096) {
-				b = (ArenaBlock*)allocateAndMaybeKeepalive(4096);
+				b = (ArenaBlock*)allocateBlock(4096);
 				b->bigSize = 4096;
 				INSTRUMENT_ALLOCATE("Arena4096");
 			} else {
-				b = (ArenaBlock*)allocateAndMaybeKeepalive(8192);
+				b = (ArenaBlock*)allocateBlock(8192);
 				b->bigSize = 8192;
 				INSTRUMENT_ALLOCATE("Arena8192");
 			}
@@ -411,10 +478,14 @@ ArenaBlock* ArenaBlock::create(int dataSize, Reference<ArenaBlock>& next) {
 			b->bigUsed = sizeof(ArenaBlock);
 			b->secure = 0;
 		} else {
+			// Huge blocks that can be recycled are rounded up to a power of two, so that similar arenas share them
+			if (reqSize <= maxRecycledBlockSize && recycledBlockLimit() > 0) {
+				reqSize = std::bit_ceil(unsigned(reqSize));
+			}
 #ifdef ALLOC_INSTRUMENTATION
 			allocInstr["ArenaHugeKB"].alloc((reqSize + 1023) >> 10);
 #endif
-			b = (ArenaBlock*)allocateAndMaybeKeepalive(reqSize);
+			b = (ArenaBlock*)allocateBlock(reqSize);
 			b->tinySize = b->tinyUsed = NOT_TINY;
 			b->bigSize = reqSize;
 			b->totalSizeEstimate = b->bigSize;
@@ -506,30 +577,38 @@ void ArenaBlock::destroyLeaf() {
 			FastAllocator<256>::release(this);
 			INSTRUMENT_RELEASE("Arena256");
 		} else if (bigSize <= 512) {
-			freeOrMaybeKeepalive(this);
+			freeBlock(this, bigSize);
 			INSTRUMENT_RELEASE("Arena512");
 		} else if (bigSize <= 1024) {
-			freeOrMaybeKeepalive(this);
+			freeBlock(this, bigSize);
 			INSTRUMENT_RELEASE("Arena1024");
 		} else if (bigSize <= 2048) {
-			freeOrMaybeKeepalive(this);
+			freeBlock(this, bigSize);
 			INSTRUMENT_RELEASE("Arena2048");
 		} else if (bigSize <= 4096) {
-			freeOrMaybeKeepalive(this);
+			freeBlock(this, bigSize);
 			INSTRUMENT_RELEASE("Arena4096");
 		} else if (bigSize <= 8192) {
-			freeOrMaybeKeepalive(this);
+			freeBlock(this, bigSize);
 			INSTRUMENT_RELEASE("Arena8192");
 		} else {
 #ifdef ALLOC_INSTRUMENTATION
 			allocInstr["ArenaHugeKB"].dealloc((bigSize + 1023) >> 10);
 #endif
 			g_hugeArenaMemory.fetch_sub(bigSize);
-			freeOrMaybeKeepalive(this);
+			freeBlock(this, bigSize);
 		}
 	}
 }
 
+void ArenaSizeProfile::observe(const Arena& arena) {
+	// The first block's header isn't counted, so that an arena created with the estimate gets a block of the same size
+	size_t size = std::min(arena.getSize(FastInaccurateEstimate::True), MAX_RESERVED_SIZE + sizeof(ArenaBlock));
+	size = size > sizeof(ArenaBlock) ? size - sizeof(ArenaBlock) : 0;
+	size_t current = estimate.load(std::memory_order_relaxed);
+	estimate.store(size >= current ? size : current - (current - size) / 8, std::memory_order_relaxed);
+}
+
 namespace {
 template <template <class> class VectorRefLike>
 void testRangeBasedForLoop() {
@@ -1039,3 +1118,48 @@ TEST_CASE("/flow/Arena/Secure") {
 	}
 	return Void();
 }
+
+TEST_CASE("/flow/Arena/SizeProfile") {
+	ArenaSizeProfile profile;
+	ASSERT(profile.reservedSize() == 0);
+	for (int i = 0; i < 3; i++) {
+		Arena arena = profile.create();
+		for (int j = 0; j < 100; j++) {
+			new (arena) uint8_t[100];
+		}
+		profile.observe(arena);
+	}
+	// Once it has learned the size, an arena holds everything in its first block
+	size_t reserved = profile.reservedSize();
+	ASSERT(reserved >= 100 * 100);
+	{
+		Arena arena = profile.create();
+		size_t size = arena.getSize();
+		for (int j = 0; j < 100; j++) {
+			new (arena) uint8_t[100];
+		}
+		ASSERT(arena.getSize() == size);
+		profile.observe(arena);
+		ASSERT(profile.reservedSize() == reserved);
+	}
+	// Smaller arenas only bring the estimate down gradually
+	profile.observe(Arena(100));
+	ASSERT(profile.reservedSize() < reserved && profile.reservedSize() > reserved / 2);
+	return Void();
+}
+
+TEST_CASE("/flow/Arena/RecycledBlocks") {
+	if (recycledBlockLimit() == 0) {
+		return Void();
+	}
+	for (int size : { 1000, 5000, 20000 }) {
+		uint8_t* first;
+		{
+			Arena arena(size);
+			first = new (arena) uint8_t[size];
+		}
+		Arena arena(size);
+		ASSERT(new (arena) uint8_t[size] == first);
+	}
+	return Void();
+}
@@ -20,6 +20,7 @@
 
 #include "flow/UnitTest.h"
 #include "flow/Deque.h"
+#include <deque>
 
 TEST_CASE("/flow/Deque/12345") {
 	Deque<int> q;
@@ -53,6 +54,30 @@ TEST_CASE("/flow/Deque/queue") {
 	return Void();
 }
 
+TEST_CASE("/flow/Deque/emplace_front") {
+	Deque<int> q;
+	std::deque<int> expected;
+	for (int i = 0; i < 1000; i++) {
+		double r = deterministicRandom()->random01();
+		if (r < 0.35) {
+			q.emplace_front(i);
+			expected.push_front(i);
+		} else if (r < 0.7) {
+			q.push_back(i);
+			expected.push_back(i);
+		} else if (!expected.empty()) {
+			ASSERT(q.front() == expected.front());
+			q.pop_front();
+			expected.pop_front();
+		}
+		ASSERT(q.size() == expected.size());
+	}
+	for (int i = 0; i < expected.size(); i++) {
+		ASSERT(q[i] == expected[i]);
+	}
+	return Void();
+}
+
 TEST_CASE("/flow/Deque/max_size") {
 	Deque<uint8_t> q;
 	for (int i = 0; i < 10; i++)
@@ -20,6 +20,8 @@
 
 #include "flow/FastAlloc.h"
 
+#include "flow/HeapProfiler.h"
+
 #include "flow/ThreadPrimitives.h"
 #include "flow/Trace.h"
 #include "flow/Error.h"
@@ -30,6 +32,7 @@
 
 #include <atomic>
 #include <cstdint>
+#include <thread>
 #include <unordered_map>
 
 #ifdef WIN32
@@ -113,6 +116,7 @@ template <int Size>
 void* FastAllocator<Size>::freelist = nullptr;
 
 std::atomic<int64_t> g_hugeArenaMemory(0);
+std::atomic<int64_t> g_fastAllocHugeChunkMemory(0);
 
 double hugeArenaLastLogged = 0;
 std::map<std::string, std::pair<int, int64_t>> hugeArenaTraces;
@@ -239,6 +243,23 @@ void recordDeallocation(void* ptr) {
 #endif
 }
 
+// Full magazines released by one thread are usually taken by another. Rather than each exchange taking mutex, they are
+// passed through a few slots that each hold one full magazine, and only go to the magazines list under mutex when the
+// slots a thread tries are all full, or come from it when they are all empty.
+static constexpr int fastAllocExchangeSlots = 16;
+static constexpr int fastAllocExchangeProbes = 4;
+
+struct alignas(64) FastAllocExchangeSlot {
+	std::atomic<void*> magazine{ nullptr };
+};
+
+// The slot a thread tries first, so that threads mostly use different slots
+static int fastAllocExchangeStart() {
+	static std::atomic<int> nextThread(0);
+	static thread_local int start = nextThread.fetch_add(1, std::memory_order_relaxed) % fastAllocExchangeSlots;
+	return start;
+}
+
 template <int Size>
 struct FastAllocator<Size>::GlobalData {
 	CRITICAL_SECTION mutex;
@@ -248,7 +269,9 @@ struct FastAllocator<Size>::GlobalData {
 	std::atomic<long long> totalMemory;
 	long long partialMagazineUnallocatedMemory;
 	std::atomic<long long> activeThreads;
-	GlobalData() : totalMemory(0), partialMagazineUnallocatedMemory(0), activeThreads(0) {
+	FastAllocExchangeSlot exchange[fastAllocExchangeSlots];
+	std::atomic<long long> exchangeMagazines; // Number of magazines in exchange
+	GlobalData() : totalMemory(0), partialMagazineUnallocatedMemory(0), activeThreads(0), exchangeMagazines(0) {
 		InitializeCriticalSection(&mutex);
 	}
 };
@@ -265,7 +288,7 @@ long long FastAllocator<Size>::getApproximateMemoryUnused() {
 	long long unused =
 	    globalData()->magazines.size() * magazine_size * Size + globalData()->partialMagazineUnallocatedMemory;
 	LeaveCriticalSection(&globalData()->mutex);
-	return unused;
+	return unused + globalData()->exchangeMagazines.load(std::memory_order_relaxed) * magazine_size * Size;
 }
 
 template <int Size>
@@ -420,6 +443,7 @@ void* FastAllocator<Size>::allocate() {
 #if defined(ALLOC_INSTRUMENTATION) || defined(ALLOC_INSTRUMENTATION_STDOUT)
 	recordAllocation(p, Size);
 #endif
+	heap_profiler::onAllocate(p, Size);
 	return p;
 }
 
@@ -438,6 +462,8 @@ void FastAllocator<Size>::release(void* ptr) {
 	}
 #endif
 
+	heap_profiler::onRelease(ptr);
+
 #if FASTALLOC_THREAD_SAFE
 	ThreadData& thr = threadData();
 	if (thr.count == magazine_size) {
@@ -532,6 +558,18 @@ void FastAllocator<Size>::getMagazine() {
 	ThreadData& thr = threadData();
 	ASSERT(!thr.freelist && !thr.alternate && thr.count == 0);
 
+	const int start = fastAllocExchangeStart();
+	for (int i = 0; i < fastAllocExchangeProbes; ++i) {
+		auto& slot = globalData()->exchange[(start + i) % fastAllocExchangeSlots].magazine;
+		void* m = slot.load(std::memory_order_relaxed);
+		if (m && slot.compare_exchange_strong(m, nullptr, std::memory_order_acquire)) {
+			globalData()->exchangeMagazines.fetch_sub(1, std::memory_order_relaxed);
+			thr.freelist = m;
+			thr.count = magazine_size;
+			return;
+		}
+	}
+
 	EnterCriticalSection(&globalData()->mutex);
 	if (globalData()->magazines.size()) {
 		void* m = globalData()->magazines.back();
@@ -549,7 +587,8 @@ void FastAllocator<Size>::getMagazine() {
 		thr.count = p.first;
 		return;
 	}
-	globalData()->totalMemory.fetch_add(magazine_size * Size);
+	const bool hugeChunk = FLOW_KNOBS && FLOW_KNOBS->FAST_ALLOC_HUGE_PAGES && !FAST_ALLOCATOR_DEBUG;
+	globalData()->totalMemory.fetch_add(hugeChunk ? kFastAllocHugeChunkBytes : magazine_size * Size);
 	LeaveCriticalSection(&globalData()->mutex);
 
 // Allocate a new page of data from the system allocator
@@ -592,7 +631,11 @@ void FastAllocator<Size>::getMagazine() {
 #else
 	const bool includeGuardPages = true;
 #endif
-	block = (void**)::allocate(magazine_size * Size, /*allowLargePages*/ false, includeGuardPages);
+	if (hugeChunk) {
+		block = (void**)allocateHugeChunk();
+	} else {
+		block = (void**)::allocate(magazine_size * Size, /*allowLargePages*/ false, includeGuardPages);
+	}
 #endif
 
 	// void** block = new void*[ magazine_size * PSize ];
@@ -606,8 +649,46 @@ void FastAllocator<Size>::getMagazine() {
 	thr.freelist = block;
 	thr.count = magazine_size;
 }
+
+// Returns a chunk of kFastAllocHugeChunkBytes, backed by huge pages if the system allows. The first magazine of the
+// chunk is left to the caller to initialize, and the rest are added to the magazines list.
+template <int Size>
+void* FastAllocator<Size>::allocateHugeChunk() {
+	static_assert(kFastAllocHugeChunkBytes % kFastAllocMagazineBytes == 0);
+	// Uses pages reserved for the hugetlb pool if there are any, and otherwise asks for transparent huge pages
+	void* chunk = ::allocate(kFastAllocHugeChunkBytes, /*allowLargePages*/ true, /*includeGuardPages*/ false);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	madvise(chunk, kFastAllocHugeChunkBytes, MADV_HUGEPAGE);
+#endif
+	g_fastAllocHugeChunkMemory.fetch_add(kFastAllocHugeChunkBytes);
+
+	std::vector<void*> magazines;
+	for (int m = 1; m < kFastAllocHugeChunkBytes / kFastAllocMagazineBytes; ++m) {
+		void** block = (void**)((uint8_t*)chunk + m * kFastAllocMagazineBytes);
+		for (int i = 0; i < magazine_size - 1; i++) {
+			block[i * PSize + 1] = block[i * PSize] = &block[(i + 1) * PSize];
+		}
+		block[(magazine_size - 1) * PSize + 1] = block[(magazine_size - 1) * PSize] = nullptr;
+		magazines.push_back(block);
+	}
+	EnterCriticalSection(&globalData()->mutex);
+	globalData()->magazines.insert(globalData()->magazines.end(), magazines.begin(), magazines.end());
+	LeaveCriticalSection(&globalData()->mutex);
+	return chunk;
+}
 template <int Size>
 void FastAllocator<Size>::releaseMagazine(void* mag) {
+	const int start = fastAllocExchangeStart();
+	for (int i = 0; i < fastAllocExchangeProbes; ++i) {
+		auto& slot = globalData()->exchange[(start + i) % fastAllocExchangeSlots].magazine;
+		void* empty = nullptr;
+		if (!slot.load(std::memory_order_relaxed) &&
+		    slot.compare_exchange_strong(empty, mag, std::memory_order_release, std::memory_order_relaxed)) {
+			globalData()->exchangeMagazines.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+
 	EnterCriticalSection(&globalData()->mutex);
 	globalData()->magazines.push_back(mag);
 	LeaveCriticalSection(&globalData()->mutex);
@@ -650,6 +731,129 @@ int64_t getTotalUnusedAllocatedMemory() {
 	return unusedMemory;
 }
 
+std::atomic<const uint8_t*> PageSlab::regionBegin(nullptr);
+std::atomic<const uint8_t*> PageSlab::regionEnd(nullptr);
+
+namespace {
+
+struct PageSlabState {
+	std::atomic<bool> reserving{ false };
+	uint8_t* begin = nullptr;
+	int slotSize = 0;
+	uint32_t slots = 0;
+	bool hugePages = false;
+	// For each free slot, the index plus one of the next free slot, or 0 for the last
+	std::atomic<uint32_t>* nextFree = nullptr;
+	// The first free slot's index plus one, or 0 if there are none, in the low 32 bits, and a count of changes in
+	// the high 32 bits so that a pop which started before other pops and pushes cannot succeed
+	std::atomic<uint64_t> freeHead{ 0 };
+	// Slots from this one on have never been handed out, so their memory was never touched
+	std::atomic<uint32_t> untouched{ 0 };
+	std::atomic<int64_t> used{ 0 };
+};
+
+PageSlabState pageSlab;
+
+} // namespace
+
+bool PageSlab::reserve(int64_t bytes, int slotSize) {
+	constexpr int64_t hugePageSize = 2 << 20;
+	if (slotSize <= 0 || slotSize % 4096 != 0 || bytes <= 0 || pageSlab.reserving.exchange(true)) {
+		return getSlotSize() == slotSize;
+	}
+
+	bytes = std::min<int64_t>((bytes + hugePageSize - 1) / hugePageSize * hugePageSize,
+	                          (int64_t)(std::numeric_limits<uint32_t>::max() - 1) * slotSize);
+	void* region = nullptr;
+#ifdef __linux__
+	// Pages reserved for the hugetlb pool are used if there are enough, otherwise transparent huge pages are requested
+	region = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	pageSlab.hugePages = region != MAP_FAILED;
+	if (!pageSlab.hugePages) {
+		region = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (region == MAP_FAILED) {
+			TraceEvent(SevWarnAlways, "PageSlabReserveFailed").GetLastError().detail("Bytes", bytes);
+			pageSlab.reserving = false;
+			return false;
+		}
+#ifdef MADV_HUGEPAGE
+		madvise(region, bytes, MADV_HUGEPAGE);
+#endif
+	}
+#else
+	region = ::allocate(bytes, /*allowLargePages*/ false, /*includeGuardPages*/ false);
+#endif
+
+	pageSlab.begin = (uint8_t*)region;
+	pageSlab.slotSize = slotSize;
+	pageSlab.slots = bytes / slotSize;
+	pageSlab.nextFree = new std::atomic<uint32_t>[pageSlab.slots];
+	regionBegin.store(pageSlab.begin);
+	regionEnd.store(pageSlab.begin + bytes);
+
+	TraceEvent("PageSlabReserved")
+	    .detail("Bytes", bytes)
+	    .detail("SlotSize", slotSize)
+	    .detail("Slots", pageSlab.slots)
+	    .detail("HugePages", pageSlab.hugePages);
+	return true;
+}
+
+void* PageSlab::allocate(int size) {
+	if (size != pageSlab.slotSize || regionEnd.load(std::memory_order_acquire) == nullptr) {
+		return nullptr;
+	}
+
+	uint64_t head = pageSlab.freeHead.load(std::memory_order_acquire);
+	while (uint32_t top = (uint32_t)head) {
+		uint64_t next = ((head >> 32) + 1) << 32 | pageSlab.nextFree[top - 1].load(std::memory_order_relaxed);
+		if (pageSlab.freeHead.compare_exchange_weak(head, next, std::memory_order_acquire)) {
+			pageSlab.used.fetch_add(1, std::memory_order_relaxed);
+			return pageSlab.begin + (int64_t)(top - 1) * pageSlab.slotSize;
+		}
+	}
+
+	uint32_t slot = pageSlab.untouched.load(std::memory_order_relaxed);
+	while (slot < pageSlab.slots) {
+		if (pageSlab.untouched.compare_exchange_weak(slot, slot + 1, std::memory_order_relaxed)) {
+			pageSlab.used.fetch_add(1, std::memory_order_relaxed);
+			return pageSlab.begin + (int64_t)slot * pageSlab.slotSize;
+		}
+	}
+	return nullptr;
+}
+
+void PageSlab::release(void* ptr) {
+	uint32_t slot = ((uint8_t*)ptr - pageSlab.begin) / pageSlab.slotSize;
+	uint64_t head = pageSlab.freeHead.load(std::memory_order_relaxed);
+	uint64_t next;
+	do {
+		pageSlab.nextFree[slot].store((uint32_t)head, std::memory_order_relaxed);
+		next = ((head >> 32) + 1) << 32 | (slot + 1);
+	} while (!pageSlab.freeHead.compare_exchange_weak(head, next, std::memory_order_release));
+	pageSlab.used.fetch_sub(1, std::memory_order_relaxed);
+}
+
+int PageSlab::getSlotSize() {
+	return regionEnd.load() == nullptr ? 0 : pageSlab.slotSize;
+}
+
+bool PageSlab::usesHugePages() {
+	return regionEnd.load() != nullptr && pageSlab.hugePages;
+}
+
+int64_t PageSlab::getTotalMemory() {
+	return regionEnd.load() - regionBegin.load();
+}
+
+int64_t PageSlab::getUsedMemory() {
+	return pageSlab.used.load(std::memory_order_relaxed) * pageSlab.slotSize;
+}
+
+int64_t PageSlab::getTouchedMemory() {
+	return (int64_t)pageSlab.untouched.load(std::memory_order_relaxed) * pageSlab.slotSize;
+}
+
 template class FastAllocator<16>;
 template class FastAllocator<32>;
 template class FastAllocator<64>;
@@ -663,6 +867,78 @@ template class FastAllocator<4096>;
 template class FastAllocator<8192>;
 template class FastAllocator<16384>;
 
+TEST_CASE("/flow/FastAlloc/PageSlab") {
+	// The slab can be reserved only once per process, so this only runs if nothing else has reserved it
+	constexpr int slabBytes = 2 << 20;
+	if (!PageSlab::reserve(slabBytes, 4096) || PageSlab::getTotalMemory() != slabBytes) {
+		return Void();
+	}
+	ASSERT(PageSlab::allocate(8192) == nullptr);
+
+	std::vector<void*> slots;
+	while (void* p = PageSlab::allocate(4096)) {
+		ASSERT(PageSlab::owns(p) && (uintptr_t)p % 4096 == 0);
+		slots.push_back(p);
+	}
+	ASSERT(slots.size() == slabBytes / 4096);
+	ASSERT(PageSlab::getUsedMemory() == slabBytes && PageSlab::getTouchedMemory() == slabBytes);
+
+	// Released slots are reused, most recently released first
+	freeFast4kAligned(4096, slots[3]);
+	freeFast4kAligned(4096, slots[7]);
+	ASSERT(PageSlab::getUsedMemory() == slabBytes - 2 * 4096);
+	ASSERT(PageSlab::allocate(4096) == slots[7]);
+	ASSERT(PageSlab::allocate(4096) == slots[3]);
+
+	// Arena buffers fall back to the heap while the slab is full, and otherwise use and return slots
+	{
+		Arena arena;
+		ASSERT(!PageSlab::owns(arena.allocate4kAlignedBuffer(4096, FromPageSlab::True)));
+	}
+	freeFast4kAligned(4096, slots[0]);
+	{
+		Arena arena;
+		ASSERT(arena.allocate4kAlignedBuffer(4096, FromPageSlab::True) == slots[0]);
+		ASSERT(!PageSlab::owns(arena.allocate4kAlignedBuffer(4096)));
+	}
+	ASSERT(PageSlab::getUsedMemory() == slabBytes - 4096);
+	slots[0] = nullptr;
+
+	for (void* p : slots) {
+		if (p != nullptr) {
+			freeFast4kAligned(4096, p);
+		}
+	}
+	ASSERT(PageSlab::getUsedMemory() == 0 && PageSlab::getTouchedMemory() == slabBytes);
+	return Void();
+}
+
+TEST_CASE("/flow/FastAlloc/CrossThreadMagazines") {
+	// Objects allocated on one thread and freed on another are reused rather than adding memory
+	using Allocator = FastAllocator<16384>;
+	constexpr int objects = 8 * kFastAllocMagazineBytes / 16384;
+	std::vector<void*> allocated(objects);
+	std::thread([&allocated]() {
+		for (auto& p : allocated) {
+			p = Allocator::allocate();
+		}
+	}).join();
+	for (auto p : allocated) {
+		Allocator::release(p);
+	}
+
+	const long long totalMemory = Allocator::getTotalMemory();
+	for (auto& p : allocated) {
+		p = Allocator::allocate();
+	}
+	// Allow for another thread taking a magazine in the meantime
+	ASSERT(Allocator::getTotalMemory() - totalMemory <= kFastAllocMagazineBytes);
+	for (auto p : allocated) {
+		Allocator::release(p);
+	}
+	return Void();
+}
+
 #ifdef USE_JEMALLOC
 #include <jemalloc/jemalloc.h>
 TEST_CASE("/jemalloc/4k_aligned_usable_size") {
@@ -0,0 +1,217 @@
+/*
+ * HeapProfiler.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flow/HeapProfiler.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "flow/Platform.h"
+#include "flow/UnitTest.h"
+
+namespace heap_profiler {
+
+namespace detail {
+std::atomic<int64_t> sampleBytes(0);
+std::atomic<int64_t> liveSamples(0);
+std::atomic<uint8_t> filter[1 << filterBits];
+constinit thread_local int64_t untilSample = 0;
+} // namespace detail
+
+namespace {
+constexpr int maxFrames = 32;
+
+struct LiveSample {
+	Site* site;
+	int64_t bytes;
+};
+
+// The profiler's own containers use the system allocator, so they don't sample themselves. They are never destroyed,
+// since memory may still be released while static objects are destroyed.
+struct Profile {
+	std::mutex mutex;
+	// Sites by the bytes of their role pointer followed by their backtrace
+	std::unordered_map<std::string, Site> sites;
+	std::unordered_map<const void*, LiveSample> live;
+};
+
+Profile& profile() {
+	static Profile* p = new Profile;
+	return *p;
+}
+
+std::atomic<RoleFunction> roleFunction(nullptr);
+
+// Set while a thread records a sample, so that anything it allocates or releases meanwhile is left alone
+constinit thread_local bool inProfiler = false;
+} // namespace
+
+void setSampleBytes(int64_t bytes) {
+	detail::sampleBytes.store(std::max<int64_t>(bytes, 0), std::memory_order_relaxed);
+}
+
+int64_t getSampleBytes() {
+	return detail::sampleBytes.load(std::memory_order_relaxed);
+}
+
+RoleFunction setRoleFunction(RoleFunction f) {
+	return roleFunction.exchange(f);
+}
+
+std::vector<Site> getLiveSites() {
+	std::vector<Site> result;
+	{
+		Profile& p = profile();
+		std::lock_guard<std::mutex> lock(p.mutex);
+		for (auto const& [key, site] : p.sites) {
+			if (site.liveSamples > 0) {
+				result.push_back(site);
+			}
+		}
+	}
+	std::sort(result.begin(), result.end(), [](Site const& a, Site const& b) { return a.liveBytes > b.liveBytes; });
+	return result;
+}
+
+void detail::sample(void* ptr, size_t size) {
+	const int64_t interval = sampleBytes.load(std::memory_order_relaxed);
+	if (interval <= 0 || inProfiler) {
+		return;
+	}
+	// The allocation stands for the sample bytes once for each multiple of them it crossed
+	const int64_t count = 1 - untilSample / interval;
+	untilSample += count * interval;
+	inProfiler = true;
+
+	void* frames[maxFrames];
+	const int numFrames = platform::raw_backtrace(frames, maxFrames);
+	auto f = roleFunction.load();
+	const char* role = f ? f() : nullptr;
+	std::string key(reinterpret_cast<const char*>(&role), sizeof(role));
+	key.append(reinterpret_cast<const char*>(frames), numFrames * sizeof(void*));
+
+	{
+		Profile& p = profile();
+		std::lock_guard<std::mutex> lock(p.mutex);
+		auto [it, added] = p.sites.try_emplace(std::move(key));
+		Site& site = it->second;
+		if (added) {
+			site.role = role ? role : "";
+			site.backtrace.assign(frames, frames + numFrames);
+		}
+		site.liveSamples++;
+		site.liveBytes += count * interval;
+		site.allocatedBytes += count * interval;
+
+		auto [liveIt, isNew] = p.live.try_emplace(ptr, LiveSample{ &site, count * interval });
+		if (isNew) {
+			filter[filterSlot(ptr)].fetch_add(1, std::memory_order_relaxed);
+			liveSamples.fetch_add(1, std::memory_order_relaxed);
+		} else {
+			// The memory was released while the profiler was recording another sample, so its release wasn't seen
+			liveIt->second.site->liveSamples--;
+			liveIt->second.site->liveBytes -= liveIt->second.bytes;
+			liveIt->second = LiveSample{ &site, count * interval };
+		}
+	}
+	inProfiler = false;
+}
+
+void detail::release(void* ptr) {
+	if (inProfiler) {
+		return;
+	}
+	Profile& p = profile();
+	std::lock_guard<std::mutex> lock(p.mutex);
+	auto it = p.live.find(ptr);
+	if (it == p.live.end()) {
+		return;
+	}
+	it->second.site->liveSamples--;
+	it->second.site->liveBytes -= it->second.bytes;
+	p.live.erase(it);
+	filter[filterSlot(ptr)].fetch_sub(1, std::memory_order_relaxed);
+	liveSamples.fetch_sub(1, std::memory_order_relaxed);
+}
+
+} // namespace heap_profiler
+
+namespace {
+constinit thread_local bool inHeapProfilerTest = false;
+heap_profiler::RoleFunction roleBeforeTest = nullptr;
+
+const char* heapProfilerTestRole() {
+	if (inHeapProfilerTest) {
+		return "HeapProfilerTest";
+	}
+	return roleBeforeTest ? roleBeforeTest() : nullptr;
+}
+
+int64_t heapProfilerTestBytes(int64_t* samples) {
+	int64_t bytes = 0;
+	*samples = 0;
+	for (auto const& site : heap_profiler::getLiveSites()) {
+		if (site.role == "HeapProfilerTest") {
+			bytes += site.liveBytes;
+			*samples += site.liveSamples;
+		}
+	}
+	return bytes;
+}
+} // namespace
+
+TEST_CASE("/flow/HeapProfiler/liveBytes") {
+	const int64_t sampleBytes = heap_profiler::getSampleBytes();
+	roleBeforeTest = heap_profiler::setRoleFunction(&heapProfilerTestRole);
+	inHeapProfilerTest = true;
+	heap_profiler::setSampleBytes(1000);
+
+	// The profiler only records addresses, so these stand for allocations of 100 bytes each
+	std::unique_ptr<char[]> memory(new char[100 * 1000]);
+	// Starts the count of this thread on a multiple of the sample bytes, whatever they were
+	heap_profiler::onAllocate(memory.get(), 1 << 30);
+	heap_profiler::onRelease(memory.get());
+	int64_t samples;
+	ASSERT(heapProfilerTestBytes(&samples) == 0);
+
+	for (int i = 0; i < 1000; i++) {
+		heap_profiler::onAllocate(memory.get() + 100 * i, 100);
+	}
+	const int64_t bytes = heapProfilerTestBytes(&samples);
+	ASSERT(bytes >= 99000 && bytes <= 101000);
+	ASSERT(bytes == samples * 1000);
+
+	for (int i = 0; i < 500; i++) {
+		heap_profiler::onRelease(memory.get() + 100 * i);
+	}
+	const int64_t halfBytes = heapProfilerTestBytes(&samples);
+	ASSERT(halfBytes >= 49000 && halfBytes <= 51000);
+	for (int i = 500; i < 1000; i++) {
+		heap_profiler::onRelease(memory.get() + 100 * i);
+	}
+	ASSERT(heapProfilerTestBytes(&samples) == 0 && samples == 0);
+
+	inHeapProfilerTest = false;
+	heap_profiler::setSampleBytes(sampleBytes);
+	heap_profiler::setRoleFunction(roleBeforeTest);
+	return Void();
+}
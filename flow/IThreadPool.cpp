@@ -21,6 +21,9 @@
 #include "flow/IThreadPool.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 // The ifndef's allow us to compile with pre-built boost.  Otherwise, we get
 // errors about double-defines.  As of this writing, the automatically downloaded
 // build of boost doesn't define these, but the pre-built version does.  (The old
@@ -129,4 +132,158 @@ Reference<IThreadPool> createGenericThreadPool(int stackSize, int pri) {
 	return Reference<IThreadPool>(new ThreadPool(stackSize, pri));
 }
 
+// Each thread has its own queue, which post() fills in turn. A thread with nothing left in its queue takes the oldest
+// action of another thread's queue, so that one long action doesn't hold up the actions queued behind it.
+class WorkStealingThreadPool final : public IThreadPool, public ReferenceCounted<WorkStealingThreadPool> {
+	static constexpr int maxThreads = 64;
+
+	struct Queue {
+		std::mutex mutex;
+		std::deque<PThreadAction> actions;
+
+		PThreadAction pop() {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (actions.empty()) {
+				return nullptr;
+			}
+			PThreadAction action = actions.front();
+			actions.pop_front();
+			return action;
+		}
+	};
+
+	struct Thread {
+		WorkStealingThreadPool* pool;
+		IThreadPoolReceiver* userObject;
+		int index;
+		THREAD_HANDLE handle; // Owned by main thread
+		Thread(WorkStealingThreadPool* pool, IThreadPoolReceiver* userObject, int index)
+		  : pool(pool), userObject(userObject), index(index) {}
+		~Thread() { ASSERT_ABORT(!userObject); }
+
+		void run() {
+			setThreadPriority(pool->pri);
+			try {
+				userObject->init();
+				while (PThreadAction action = pool->take(index)) {
+					(*action)(userObject);
+				}
+			} catch (Error& e) {
+				TraceEvent(SevError, "ThreadPoolError").error(e);
+			}
+			delete userObject;
+			userObject = nullptr;
+		}
+	};
+	THREAD_FUNC start(void* p) {
+		((Thread*)p)->run();
+		THREAD_RETURN;
+	}
+
+	// queues[i] belongs to threads[i]; queues[0] also holds actions posted before the first thread is added
+	std::array<Queue, maxThreads> queues;
+	std::vector<Thread*> threads;
+	std::atomic<int> threadCount = 0;
+	std::atomic<unsigned> nextQueue = 0;
+	int stackSize;
+	int pri;
+
+	std::mutex idleMutex;
+	std::condition_variable idle;
+	std::atomic<int64_t> queued = 0;
+	std::atomic<bool> stopping = false;
+
+	std::atomic<int64_t> posted = 0;
+	std::atomic<int64_t> stolen = 0;
+	std::atomic<int64_t> maxQueued = 0;
+
+	// Returns the next action for thread index to run, waiting for one, or nullptr once the pool is stopping
+	PThreadAction take(int index) {
+		loop {
+			if (stopping.load(std::memory_order_relaxed)) {
+				return nullptr;
+			}
+			if (PThreadAction action = queues[index].pop()) {
+				queued.fetch_sub(1, std::memory_order_relaxed);
+				return action;
+			}
+			int count = threadCount.load(std::memory_order_acquire);
+			for (int i = 1; i < count; i++) {
+				if (PThreadAction action = queues[(index + i) % count].pop()) {
+					queued.fetch_sub(1, std::memory_order_relaxed);
+					stolen.fetch_add(1, std::memory_order_relaxed);
+					return action;
+				}
+			}
+			std::unique_lock<std::mutex> lock(idleMutex);
+			idle.wait(lock, [this]() { return queued.load() > 0 || stopping.load(); });
+		}
+	}
+
+public:
+	WorkStealingThreadPool(int stackSize, int pri) : stackSize(stackSize), pri(pri) {}
+	~WorkStealingThreadPool() override {}
+	Future<Void> stop(Error const& e = success()) override {
+		if (stopping.exchange(true))
+			return Void();
+		ReferenceCounted<WorkStealingThreadPool>::addref();
+		{
+			std::lock_guard<std::mutex> lock(idleMutex);
+		}
+		idle.notify_all();
+		for (auto thread : threads) {
+			waitThread(thread->handle);
+			delete thread;
+		}
+		for (auto& queue : queues) {
+			while (PThreadAction action = queue.pop()) {
+				action->cancel();
+			}
+		}
+		TraceEvent("WorkStealingThreadPoolStopped")
+		    .detail("Threads", threads.size())
+		    .detail("Posted", posted.load())
+		    .detail("Stolen", stolen.load())
+		    .detail("MaxQueued", maxQueued.load());
+		ReferenceCounted<WorkStealingThreadPool>::delref();
+		return Void();
+	}
+
+	Future<Void> getError() const override { return Never(); } // FIXME
+	void addref() override { ReferenceCounted<WorkStealingThreadPool>::addref(); }
+	void delref() override {
+		if (ReferenceCounted<WorkStealingThreadPool>::delref_no_destroy()) {
+			stop();
+			delete this;
+		}
+	}
+	void addThread(IThreadPoolReceiver* userData, const char* name) override {
+		ASSERT(threads.size() < maxThreads);
+		threads.push_back(new Thread(this, userData, threads.size()));
+		threadCount.store(threads.size(), std::memory_order_release);
+		threads.back()->handle = g_network->startThread(start, threads.back(), stackSize, name);
+	}
+	void post(PThreadAction action) override {
+		int count = std::max(1, threadCount.load(std::memory_order_relaxed));
+		Queue& queue = queues[nextQueue.fetch_add(1, std::memory_order_relaxed) % count];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.actions.push_back(action);
+		}
+		int64_t depth = queued.fetch_add(1) + 1;
+		posted.fetch_add(1, std::memory_order_relaxed);
+		if (depth > maxQueued.load(std::memory_order_relaxed)) {
+			maxQueued.store(depth, std::memory_order_relaxed);
+		}
+		{
+			std::lock_guard<std::mutex> lock(idleMutex);
+		}
+		idle.notify_one();
+	}
+};
+
+Reference<IThreadPool> createWorkStealingThreadPool(int stackSize, int pri) {
+	return Reference<IThreadPool>(new WorkStealingThreadPool(stackSize, pri));
+}
+
 thread_local IThreadPoolReceiver* ThreadPool::Thread::threadUserObject;
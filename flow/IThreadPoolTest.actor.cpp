@@ -162,6 +162,62 @@ TEST_CASE("/flow/IThreadPool/ThreadReturnPromiseStream") {
 	return Void();
 }
 
+struct WorkStealingReceiver final : IThreadPoolReceiver {
+	explicit WorkStealingReceiver(std::atomic<bool>* release) : release(release) {}
+	void init() override {}
+
+	struct BlockAction final : TypedAction<WorkStealingReceiver, BlockAction> {
+		ThreadReturnPromise<Void> done;
+		double getTimeEstimate() const override { return 3.; }
+	};
+
+	void action(BlockAction& a) {
+		while (!release->load()) {
+			threadSleep(0.001);
+		}
+		a.done.send(Void());
+	}
+
+	struct RunAction final : TypedAction<WorkStealingReceiver, RunAction> {
+		ThreadReturnPromise<Void> done;
+		double getTimeEstimate() const override { return 0.; }
+	};
+
+	void action(RunAction& a) { a.done.send(Void()); }
+
+private:
+	std::atomic<bool>* release;
+};
+
+TEST_CASE("/flow/IThreadPool/WorkStealing") {
+	noUnseed = true;
+
+	state std::unique_ptr<std::atomic<bool>> release = std::make_unique<std::atomic<bool>>(false);
+	state Reference<IThreadPool> pool = createWorkStealingThreadPool();
+	for (int i = 0; i < 4; i++) {
+		pool->addThread(new WorkStealingReceiver(release.get()), "thread-steal");
+	}
+
+	// While one thread is blocked, the actions queued behind it are run by the others
+	auto* block = new WorkStealingReceiver::BlockAction();
+	state Future<Void> blocked = block->done.getFuture();
+	pool->post(block);
+	state std::vector<Future<Void>> done;
+	for (int i = 0; i < 100; i++) {
+		auto* a = new WorkStealingReceiver::RunAction();
+		done.push_back(a->done.getFuture());
+		pool->post(a);
+	}
+	wait(waitForAll(done));
+	ASSERT(!blocked.isReady());
+
+	release->store(true);
+	wait(blocked);
+	wait(pool->stop());
+
+	return Void();
+}
+
 #else
 void forceLinkIThreadPoolTests() {}
 #endif
@@ -70,11 +70,17 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	init( SATURATION_PROFILING_LOG_INTERVAL,                   0.5 ); // A value of 0 means use RUN_LOOP_PROFILING_INTERVAL
 	init( SATURATION_PROFILING_MAX_LOG_INTERVAL,               5.0 );
 	init( SATURATION_PROFILING_LOG_BACKOFF,                    2.0 );
+	init( CPU_SAMPLER_PERIOD,                                 0.01 ); // A value of 0 disables the continuous CPU sampler
+	init( CPU_SAMPLER_REPORT_INTERVAL,                        60.0 );
+	init( CPU_SAMPLER_TOP_ENTRIES,                              20 );
 
 	init( FAST_ALLOC_LOGGING_BYTES,                           10e6 );
 	init( FAST_ALLOC_ALLOW_GUARD_PAGES,                      false );
+	init( FAST_ALLOC_HUGE_PAGES,                             false );
 	init( HUGE_ARENA_LOGGING_BYTES,                          100e6 );
 	init( HUGE_ARENA_LOGGING_INTERVAL,                         5.0 );
+	init( ARENA_RECYCLED_BLOCKS,                                 4 ); if( randomize && BUGGIFY ) ARENA_RECYCLED_BLOCKS = deterministicRandom()->coinflip() ? 0 : 16;
+	init( HEAP_PROFILE_SAMPLE_BYTES,                             0 ); if( randomize && BUGGIFY ) HEAP_PROFILE_SAMPLE_BYTES = deterministicRandom()->randomInt(1, 1<<20); // A value of 0 disables the sampling heap profiler
 	init( ABORT_ON_FAILURE,                                  false );
 
 	init( MEMORY_USAGE_CHECK_INTERVAL,                         1.0 );
@@ -88,6 +94,13 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	init( TRACING_SAMPLE_RATE,                                 0.0 ); if (randomize && BUGGIFY) TRACING_SAMPLE_RATE = 0.01; // Fraction of distributed traces (not spans) to sample (0 means ignore all traces)
 	init( TRACING_UDP_LISTENER_ADDR,                   "127.0.0.1" ); // Only applicable if TracerType is set to a network option
 	init( TRACING_UDP_LISTENER_PORT,                          8889 ); // Only applicable if TracerType is set to a network option
+	init( TRACING_BATCH_SPANS,                                 256 ); // Only applicable to the network_batched tracer, as are the knobs below
+	init( TRACING_BATCH_INTERVAL,                              1.0 ); // Seconds after which a partial batch of spans is exported
+	init( TRACING_MAX_PENDING_BATCHES,                          64 ); // Batches are dropped while this many wait for the export thread
+	init( TRACING_TAIL_SAMPLING,                             false ); // Only export the spans of traces with a slow or failed span
+	init( TRACING_TAIL_LATENCY,                                0.5 ); // Seconds a span must last for its trace to be exported
+	init( TRACING_TAIL_BUFFER_TIME,                            5.0 ); // Seconds the spans of a trace wait for a slow or failed span
+	init( TRACING_TAIL_MAX_PENDING_SPANS,                   100000 ); // Spans beyond this many waiting for their trace are dropped
 
 	// Native metrics
 	init( METRICS_DATA_MODEL,                                "none"); if (randomize && BUGGIFY) METRICS_DATA_MODEL="otel";
@@ -97,6 +110,7 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	init( OTEL_UDP_EMISSION_ADDR,                       "127.0.0.1");
 	init( OTEL_UDP_EMISSION_PORT,                             8903 );
 	init( METRICS_EMIT_DDSKETCH,                             false ); // Determines if DDSketch buckets will get emitted
+	init( METRICS_PROMETHEUS_PORT,                               0 ); // With the otel data model, serve metrics to Prometheus on this port instead of pushing them, if non-zero
 
 	//connectionMonitor
 	init( CONNECTION_MONITOR_LOOP_TIME,   isSimulated ? 0.75 : 1.0 ); if( randomize && BUGGIFY ) CONNECTION_MONITOR_LOOP_TIME = 6.0;
@@ -121,6 +135,9 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	init( INCOMPATIBLE_PEER_DELAY_BEFORE_LOGGING,              5.0 );
 	init( PING_LOGGING_INTERVAL,                               3.0 );
 	init( PING_SKETCH_ACCURACY,                                0.1 );
+	init( RPC_LATENCY_SAMPLE_INTERVAL,                         100 ); if( randomize && BUGGIFY ) RPC_LATENCY_SAMPLE_INTERVAL = deterministicRandom()->randomInt(1, 10);
+	init( RPC_LATENCY_LOGGING_INTERVAL,                       30.0 );
+	init( RPC_LATENCY_STATUS_TYPES,                             10 );
 
 	init( TLS_CERT_REFRESH_DELAY_SECONDS,                 12*60*60 );
 	init( TLS_SERVER_CONNECTION_THROTTLE_TIMEOUT,              9.0 );
@@ -130,6 +147,8 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	init( TLS_CLIENT_HANDSHAKE_THREADS,                          0 );
 	init( TLS_SERVER_HANDSHAKE_THREADS,                         64 );
 	init( TLS_HANDSHAKE_THREAD_STACKSIZE,                64 * 1024 );
+	init( TLS_RECORD_THREADS,                                    0 );
+	init( TLS_RECORD_OFFLOAD_BYTES,                      64 * 1024 );
 	init( TLS_MALLOC_ARENA_MAX,                                  6 );
 	init( TLS_HANDSHAKE_LIMIT,                                1000 );
 
@@ -156,14 +175,17 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	init( BUGGIFY_SIM_PAGE_CACHE_4K,                           1e6 );
 	init( BUGGIFY_SIM_PAGE_CACHE_64K,                          1e6 );
 	init( BLOB_WORKER_PAGE_CACHE,                            500e6 );
+	init( TLOG_PAGE_CACHE,                                   200e6 ); if( randomize && BUGGIFY ) TLOG_PAGE_CACHE = 1e6;
 	init( MAX_EVICT_ATTEMPTS,                                  100 ); if( randomize && BUGGIFY ) MAX_EVICT_ATTEMPTS = 2;
 	init( CACHE_EVICTION_POLICY,                          "random" );
+	init( PAGE_CACHE_PROTECTED_FRACTION,                       0.8 ); if( randomize && BUGGIFY ) PAGE_CACHE_PROTECTED_FRACTION = deterministicRandom()->random01();
 	init( PAGE_CACHE_TRUNCATE_LOOKUP_FRACTION,                 0.1 ); if( randomize && BUGGIFY ) PAGE_CACHE_TRUNCATE_LOOKUP_FRACTION = 0.0; else if( randomize && BUGGIFY ) PAGE_CACHE_TRUNCATE_LOOKUP_FRACTION = 1.0;
 	init( FLOW_CACHEDFILE_WRITE_IO_SIZE,                         0 );
 	if ( randomize && BUGGIFY) {
 		// Choose 16KB to 64KB as I/O size
 		FLOW_CACHEDFILE_WRITE_IO_SIZE = deterministicRandom()->randomInt(16384, 65537);
 	}
+	init( FLOW_CACHEDFILE_PREFETCH_PAGES,                        0 ); if( randomize && BUGGIFY ) FLOW_CACHEDFILE_PREFETCH_PAGES = deterministicRandom()->randomInt(1, 5);
 
 	//AsyncFileEIO
 	init( EIO_MAX_PARALLELISM,                                  4  );
@@ -183,6 +205,10 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	init( PAGE_WRITE_CHECKSUM_HISTORY,                           0 ); if( randomize && BUGGIFY ) PAGE_WRITE_CHECKSUM_HISTORY = 10000000;
 	init( DISABLE_POSIX_KERNEL_AIO,                              0 );
 
+	//AsyncFileIOUring
+	init( USE_IO_URING,                                          0 );
+	init( IO_URING_QUEUE_DEPTH,                                128 );
+
 	//AsyncFileNonDurable
 	init( NON_DURABLE_MAX_WRITE_DELAY,                         2.0 ); if( randomize && BUGGIFY ) NON_DURABLE_MAX_WRITE_DELAY = 5.0;
 	init( MAX_PRIOR_MODIFICATION_DELAY,                        1.0 ); if( randomize && BUGGIFY ) MAX_PRIOR_MODIFICATION_DELAY = 10.0;
@@ -210,6 +236,8 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	//Net2 and FlowTransport
 	init( MIN_COALESCE_DELAY,                                10e-6 ); if( randomize && BUGGIFY ) MIN_COALESCE_DELAY = 0;
 	init( MAX_COALESCE_DELAY,                                20e-6 ); if( randomize && BUGGIFY ) MAX_COALESCE_DELAY = 0;
+	init( MAX_ADAPTIVE_COALESCE_DELAY,                           0 ); if( randomize && BUGGIFY ) MAX_ADAPTIVE_COALESCE_DELAY = deterministicRandom()->random01() * 500e-6;
+	init( COALESCE_TARGET_BYTES,                             16384 ); if( randomize && BUGGIFY ) COALESCE_TARGET_BYTES = deterministicRandom()->randomInt(1, 65536);
 	init( SLOW_LOOP_CUTOFF,                          15.0 / 1000.0 );
 	init( SLOW_LOOP_SAMPLING_RATE,                             0.1 );
 	init( TSC_YIELD_TIME,                                  1000000 );
@@ -217,10 +245,13 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	init( CERT_FILE_MAX_SIZE,                      5 * 1024 * 1024 );
 	init( READY_QUEUE_RESERVED_SIZE,                          8192 );
 	init( TASKS_PER_REACTOR_CHECK,                             100 );
+	init( READY_WAIT_SAMPLE_INTERVAL,                          100 ); if( randomize && BUGGIFY ) READY_WAIT_SAMPLE_INTERVAL = deterministicRandom()->coinflip() ? 1 : 0; // Every how many ready tasks one has its wait to run timed; 0 disables
 
 	//Network
 	init( PACKET_LIMIT,                                  100LL<<20 );
 	init( PACKET_WARNING,                                  2LL<<20 );  // 2MB packet warning quietly allows for 1MB system messages
+	init( PACKET_COMPRESSION_THRESHOLD,                          0 ); if( randomize && BUGGIFY ) PACKET_COMPRESSION_THRESHOLD = deterministicRandom()->randomInt(1, 10000); // Unreliable packets at least this big are compressed for peers that accept it; 0 disables
+	init( PACKET_COMPRESSION_LEVEL,                              1 );
 	init( TIME_OFFSET_LOGGING_INTERVAL,                       60.0 );
 	init( MAX_PACKET_SEND_BYTES,                        128 * 1024 );
 	init( MIN_PACKET_BUFFER_BYTES,                        4 * 1024 );
@@ -250,6 +281,7 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	init( MAX_TRACE_SUPPRESSIONS,                              1e4 );
 	init( TRACE_DATETIME_ENABLED,                             true ); // trace time in human readable format (always real time)
 	init( TRACE_SYNC_ENABLED,                                    0 );
+	init( TRACE_WRITER_MAX_PENDING_BYTES,                    100e6 ); // Events other than errors are dropped while the trace writer thread is further behind
 	init( TRACE_EVENT_METRIC_UNITS_PER_SAMPLE,                 500 );
 	init( TRACE_EVENT_THROTTLER_SAMPLE_EXPIRY,              1800.0 ); // 30 mins
 	init( TRACE_EVENT_THROTTLER_MSG_LIMIT,                   20000 );
@@ -271,6 +303,7 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	//Load Balancing
 	init( LOAD_BALANCE_ZONE_ID_LOCALITY_ENABLED,                 0 );
 	init( LOAD_BALANCE_DC_ID_LOCALITY_ENABLED,                   1 );
+	init( LOAD_BALANCE_ZONE_SPILLOVER_LATENCY,               0.005 ); if( randomize && BUGGIFY ) LOAD_BALANCE_ZONE_SPILLOVER_LATENCY = deterministicRandom()->coinflip() ? 0.0 : 1.0; // With LOAD_BALANCE_ZONE_ID_LOCALITY_ENABLED, how much longer a read is expected to take from the client's zone than from another zone of its DC before it is sent to the other zone
 	init( LOAD_BALANCE_MAX_BACKOFF,                            5.0 );
 	init( LOAD_BALANCE_START_BACKOFF,                         0.01 );
 	init( LOAD_BALANCE_BACKOFF_RATE,                           2.0 );
@@ -281,6 +314,7 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	init( SECOND_REQUEST_MULTIPLIER_DECAY,                 0.00025 );
 	init( SECOND_REQUEST_BUDGET_GROWTH,                       0.05 );
 	init( SECOND_REQUEST_MAX_BUDGET,                         100.0 );
+	init( LOAD_BALANCE_HEDGE_PERCENTILE,                         0 ); if( randomize && BUGGIFY ) LOAD_BALANCE_HEDGE_PERCENTILE = 0.9; // If set, a second request is sent once the first has taken longer than this percentile of its server's latencies
 	init( ALTERNATIVES_FAILURE_RESET_TIME,                     5.0 );
 	init( ALTERNATIVES_FAILURE_MIN_DELAY,                     0.05 );
 	init( ALTERNATIVES_FAILURE_DELAY_RATIO,                    0.2 );
@@ -293,6 +327,8 @@ void FlowKnobs::initialize(Randomize randomize, IsSimulated isSimulated) {
 	init( FUTURE_VERSION_BACKOFF_GROWTH,                       2.0 );
 	init( LOAD_BALANCE_MAX_BAD_OPTIONS,                          1 ); //should be the same as MAX_MACHINES_FALLING_BEHIND
 	init( LOAD_BALANCE_PENALTY_IS_BAD,                        true );
+	init( LOAD_BALANCE_LAGGING_REPLICA_VERSIONS,                 0 ); if( randomize && BUGGIFY ) LOAD_BALANCE_LAGGING_REPLICA_VERSIONS = deterministicRandom()->randomInt(0, 1000000); // If set, reads avoid a replica whose last reply was more than this many versions behind, if another replica is not
+	init( LOAD_BALANCE_LAGGING_REPLICA_TIME,                   1.0 ); // How long a replica is avoided for after a lagging reply
 	init( BASIC_LOAD_BALANCE_UPDATE_RATE,                     10.0 ); //should be longer than the rate we log network metrics
 	init( BASIC_LOAD_BALANCE_MAX_CHANGE,                      0.10 );
 	init( BASIC_LOAD_BALANCE_MAX_PROB,                         2.0 );
@@ -27,6 +27,7 @@
 #include "flow/swift.h"
 #include "flow/swift_concurrency_hooks.h"
 #include <algorithm>
+#include <deque>
 #include <memory>
 #include <string_view>
 #ifndef BOOST_SYSTEM_NO_LIB
@@ -230,6 +231,8 @@ public:
 	Reference<IThreadPool> sslHandshakerPool;
 	int sslHandshakerThreadsStarted;
 	int sslPoolHandshakesInProgress;
+	Reference<IThreadPool> sslRecordPool;
+	int sslRecordThreadsStarted;
 	TLSConfig tlsConfig;
 	Reference<TLSPolicy> activeTlsPolicy;
 	Future<Void> backgroundCertRefresh;
@@ -306,6 +309,8 @@ public:
 	Int64MetricHandle countUDPReads;
 	Int64MetricHandle countWouldBlock;
 	Int64MetricHandle countWrites;
+	Int64MetricHandle countWriteBytes;
+	Int64MetricHandle countWriteBuffers;
 	Int64MetricHandle countUDPWrites;
 	Int64MetricHandle countRunLoop;
 	Int64MetricHandle countTasks;
@@ -351,6 +356,20 @@ static udp::endpoint udpEndpoint(NetworkAddress const& n) {
 	return udp::endpoint(tcpAddress(n.ip), n.port);
 }
 
+// Counts the bytes written by one write call and the number of buffers of the chain they came from
+static void countWrite(SendBuffer const* data, size_t sent) {
+	g_net2->countWriteBytes += sent;
+	int64_t buffers = 0;
+	for (auto p = data; p && sent; p = p->next) {
+		const size_t unsent = p->bytes_written - p->bytes_sent;
+		if (unsent) {
+			++buffers;
+			sent -= std::min(sent, unsent);
+		}
+	}
+	g_net2->countWriteBuffers += buffers;
+}
+
 class BindPromise {
 	Promise<Void> p;
 	std::variant<const char*, AuditedEvent> errContext;
@@ -517,6 +536,7 @@ public:
 
 		ASSERT(sent); // Make sure data was sent, and also this check will fail if the buffer chain was empty or the
 		              // limit was not > 0.
+		countWrite(data, sent);
 		return sent;
 	}
 
@@ -859,21 +879,71 @@ struct SSLHandshakerThread final : IThreadPoolReceiver {
 	}
 };
 
+// Encrypts and sends large writes to TLS connections, so the network thread doesn't spend its time in OpenSSL. A
+// connection only has one write in flight and doesn't otherwise use its SSL stream until it completes, which keeps its
+// records in order and its stream single threaded.
+struct SSLRecordThread final : IThreadPoolReceiver {
+	SSLRecordThread() {}
+	void init() override {}
+
+	struct Write final : TypedAction<SSLRecordThread, Write> {
+		explicit Write(ssl_socket& socket) : socket(socket) {}
+		double getTimeEstimate() const override { return 0.001; }
+
+		ThreadReturnPromise<int> done;
+		ssl_socket& socket;
+		// The unsent data, which the network thread holds on to but doesn't modify until done is sent
+		std::vector<boost::asio::const_buffer> buffers;
+	};
+
+	// Sends as much of the data as the socket takes without blocking, and returns how much that is
+	void action(Write& w) {
+		int sent = 0;
+		boost::system::error_code err;
+		for (auto& buffer : w.buffers) {
+			while (buffer.size() && !err) {
+				size_t n = w.socket.write_some(buffer, err);
+				sent += n;
+				buffer += n;
+			}
+			if (err) {
+				break;
+			}
+		}
+		if (err && err != boost::asio::error::would_block) {
+			TraceEvent(SevWarn, "N2_WriteError")
+			    .suppressFor(1.0)
+			    .detail("ErrorCode", err.value())
+			    .detail("Message", err.message())
+			    .detail("BackgroundThread", true);
+			w.done.sendError(connection_failed());
+		} else {
+			w.done.send(sent);
+		}
+	}
+};
+
 class SSLConnection final : public IConnection, ReferenceCounted<SSLConnection> {
 public:
 	void addref() override { ReferenceCounted<SSLConnection>::addref(); }
 	void delref() override { ReferenceCounted<SSLConnection>::delref(); }
 
-	void close() override { closeSocket(); }
+	void close() override {
+		if (writeInFlight()) {
+			closeAfterWrite = true;
+		} else {
+			closeSocket();
+		}
+	}
 
 	explicit SSLConnection(boost::asio::io_service& io_service,
 	                       Reference<ReferencedObject<boost::asio::ssl::context>> context)
 	  : id(nondeterministicRandom()->randomUniqueID()), socket(io_service), ssl_sock(socket, context->mutate()),
-	    sslContext(context), has_trusted_peer(false) {}
+	    sslContext(context), has_trusted_peer(false), closeAfterWrite(false) {}
 
 	explicit SSLConnection(Reference<ReferencedObject<boost::asio::ssl::context>> context, tcp::socket* existingSocket)
 	  : id(nondeterministicRandom()->randomUniqueID()), socket(std::move(*existingSocket)),
-	    ssl_sock(socket, context->mutate()), sslContext(context) {}
+	    ssl_sock(socket, context->mutate()), sslContext(context), closeAfterWrite(false) {}
 
 	// This is not part of the IConnection interface, because it is wrapped by INetwork::connect()
 	ACTOR static Future<Reference<IConnection>> connect(boost::asio::io_service* ios,
@@ -1076,6 +1146,10 @@ public:
 
 	// returns when write() can write at least one byte
 	Future<Void> onWritable() override {
+		if (offloadedWrite.isValid()) {
+			// write() returns the result of the offloaded write once it is done
+			return success(offloadedWrite);
+		}
 		++g_net2->countWriteProbes;
 		BindPromise p("N2_WriteProbeError", id);
 		auto f = p.getFuture();
@@ -1085,6 +1159,9 @@ public:
 
 	// returns when read() can read at least one byte
 	Future<Void> onReadable() override {
+		if (writeInFlight()) {
+			return success(offloadedWrite);
+		}
 		++g_net2->countReadProbes;
 		BindPromise p("N2_ReadProbeError", id);
 		auto f = p.getFuture();
@@ -1095,6 +1172,9 @@ public:
 	// Reads as many bytes as possible from the read buffer into [begin,end) and returns the number of bytes read (might
 	// be 0)
 	int read(uint8_t* begin, uint8_t* end) override {
+		if (writeInFlight()) {
+			return 0;
+		}
 		boost::system::error_code err;
 		++g_net2->countReads;
 		size_t toRead = end - begin;
@@ -1122,6 +1202,13 @@ public:
 		// broken pipe error.
 		limit = std::min(limit, 2016);
 #endif
+		if (offloadedWrite.isValid()) {
+			return finishOffloadedWrite(data);
+		}
+		if (N2::g_net2->sslRecordThreadsStarted && limit >= FLOW_KNOBS->TLS_RECORD_OFFLOAD_BYTES &&
+		    offloadWrite(data, limit)) {
+			return 0;
+		}
 		boost::system::error_code err;
 		++g_net2->countWrites;
 
@@ -1150,6 +1237,7 @@ public:
 
 		ASSERT(sent); // Make sure data was sent, and also this check will fail if the buffer chain was empty or the
 		              // limit was not > 0.
+		countWrite(data, sent);
 		return sent;
 	}
 
@@ -1170,6 +1258,61 @@ private:
 	NetworkAddress peer_address;
 	Reference<ReferencedObject<boost::asio::ssl::context>> sslContext;
 	bool has_trusted_peer;
+	// The write being done on a TLS record thread, until write() returns its result
+	Future<int> offloadedWrite;
+	bool closeAfterWrite;
+
+	bool writeInFlight() const { return offloadedWrite.isValid() && !offloadedWrite.isReady(); }
+
+	// Posts the unsent data to a TLS record thread if there is enough of it, and returns whether it did
+	bool offloadWrite(SendBuffer const* data, int limit) {
+		auto w = std::make_unique<SSLRecordThread::Write>(ssl_sock);
+		int bytes = 0;
+		for (auto it = SendBufferIterator(data, limit); it != SendBufferIterator(); ++it) {
+			w->buffers.push_back(*it);
+			bytes += (*it).size();
+		}
+		if (bytes < FLOW_KNOBS->TLS_RECORD_OFFLOAD_BYTES) {
+			return false;
+		}
+		++g_net2->countWrites;
+		offloadedWrite = w->done.getFuture();
+		holdUntilWritten(Reference<SSLConnection>::addRef(this), offloadedWrite);
+		N2::g_net2->sslRecordPool->post(w.release());
+		return true;
+	}
+
+	// Returns the result of the offloaded write, given the same data as when it was posted
+	int finishOffloadedWrite(SendBuffer const* data) {
+		if (!offloadedWrite.isReady()) {
+			return 0;
+		}
+		Future<int> f = offloadedWrite;
+		offloadedWrite = Future<int>();
+		if (f.isError()) {
+			closeSocket();
+			throw connection_failed();
+		}
+		int sent = f.get();
+		if (!sent) {
+			++g_net2->countWouldBlock;
+			return 0;
+		}
+		countWrite(data, sent);
+		return sent;
+	}
+
+	// Keeps the connection alive while a TLS record thread uses its stream, and closes it then if close() was called
+	// in the meantime
+	ACTOR static void holdUntilWritten(Reference<SSLConnection> self, Future<int> write) {
+		try {
+			wait(success(write));
+		} catch (Error&) {
+		}
+		if (self->closeAfterWrite) {
+			self->closeSocket();
+		}
+	}
 
 	void init() {
 		// Socket settings that have to be set after connect or accept succeeds
@@ -1266,7 +1409,7 @@ Net2::Net2(const TLSConfig& tlsConfig, bool useThreadPool, bool useMetrics)
   : globals(enumGlobal::COUNT), useThreadPool(useThreadPool), reactor(this),
     sslContextVar({ ReferencedObject<boost::asio::ssl::context>::from(
         boost::asio::ssl::context(boost::asio::ssl::context::tls)) }),
-    sslHandshakerThreadsStarted(0), sslPoolHandshakesInProgress(0), tlsConfig(tlsConfig),
+    sslHandshakerThreadsStarted(0), sslPoolHandshakesInProgress(0), sslRecordThreadsStarted(0), tlsConfig(tlsConfig),
     tlsInitializedState(ETLSInitState::NONE), network(this), tscBegin(0), tscEnd(0), taskBegin(0),
     currentTaskID(TaskPriority::DefaultYield), stopped(false), started(false), numYields(0),
     lastPriorityStats(nullptr) {
@@ -1400,6 +1543,14 @@ void Net2::initTLS(ETLSInitState targetState) {
 				sslHandshakerPool->addThread(new SSLHandshakerThread(), "fdb-ssl-connect");
 			}
 		}
+
+		if (sslRecordThreadsStarted == 0 && FLOW_KNOBS->TLS_RECORD_THREADS > 0) {
+			sslRecordPool = createGenericThreadPool(FLOW_KNOBS->TLS_HANDSHAKE_THREAD_STACKSIZE);
+			for (int i = 0; i < FLOW_KNOBS->TLS_RECORD_THREADS; ++i) {
+				++sslRecordThreadsStarted;
+				sslRecordPool->addThread(new SSLRecordThread(), "fdb-ssl-record");
+			}
+		}
 	}
 
 	tlsInitializedState = targetState;
@@ -1424,6 +1575,8 @@ void Net2::initMetrics() {
 	countReads.init("Net2.CountReads"_sr);
 	countWouldBlock.init("Net2.CountWouldBlock"_sr);
 	countWrites.init("Net2.CountWrites"_sr);
+	countWriteBytes.init("Net2.CountWriteBytes"_sr);
+	countWriteBuffers.init("Net2.CountWriteBuffers"_sr);
 	countRunLoop.init("Net2.CountRunLoop"_sr);
 	countTasks.init("Net2.CountTasks"_sr);
 	countYields.init("Net2.CountYields"_sr);
@@ -1457,6 +1610,7 @@ void Net2::run() {
 	thread_network = this;
 
 	unsigned int tasksSinceReact = 0;
+	taskQueue.sampleReadyTimes(FLOW_KNOBS->READY_WAIT_SAMPLE_INTERVAL);
 
 #ifdef WIN32
 	if (timeBeginPeriod(1) != TIMERR_NOERROR)
@@ -1547,6 +1701,9 @@ void Net2::run() {
 			currentTaskID = taskQueue.getReadyTaskID();
 			priorityMetric = static_cast<int64_t>(currentTaskID);
 			PromiseTask* task = taskQueue.getReadyTask();
+			if (double readyTime = taskQueue.getReadyTaskReadyTime()) {
+				networkInfo.metrics.addReadyWait(currentTaskID, taskBegin - readyTime);
+			}
 			taskQueue.popReadyTask();
 
 			try {
@@ -2286,6 +2443,104 @@ TEST_CASE("noSim/flow/Net2/onMainThreadFIFO") {
 	return Void();
 }
 
+TEST_CASE("flow/Net2/TaskQueue/Timers") {
+	// Timers must become ready at exactly their time, whatever their delay, and in the priority order of the tasks
+	TaskQueue<int> queue;
+	std::deque<int> tasks;
+	// Time, priority, task for each pending timer in the order they were added
+	std::vector<std::tuple<double, int64_t, int*>> pending;
+	int64_t issued = 0;
+	double now = deterministicRandom()->random01() * 1e6;
+
+	for (int round = 0; round < 1000; ++round) {
+		const int added = deterministicRandom()->randomInt(0, 100);
+		for (int i = 0; i < added; ++i) {
+			double delay = deterministicRandom()->random01();
+			switch (deterministicRandom()->randomInt(0, 4)) {
+			case 0:
+				delay *= 1e-3;
+				break;
+			case 1:
+				delay *= 100;
+				break;
+			case 2:
+				delay = deterministicRandom()->coinflip() ? delay * 1e7 : INetwork::TIME_EPS / 2;
+				break;
+			}
+			const TaskPriority taskID = static_cast<TaskPriority>(deterministicRandom()->randomInt(0, 100));
+			tasks.push_back(tasks.size());
+			queue.addTimer(now + delay, taskID, &tasks.back());
+			pending.emplace_back(now + delay, (int64_t(taskID) << 32) - (++issued), &tasks.back());
+		}
+
+		if (pending.empty()) {
+			ASSERT(queue.getSleepTime(now) == 0);
+		} else {
+			const double next = std::get<0>(*std::min_element(pending.begin(), pending.end()));
+			ASSERT(queue.getSleepTime(now) == next - now);
+			if (deterministicRandom()->coinflip()) {
+				now = std::max(now, next);
+			}
+		}
+		now += deterministicRandom()->random01() * (deterministicRandom()->coinflip() ? 1e-2 : 10);
+
+		std::vector<std::tuple<double, int64_t, int*>> due;
+		auto notDue = std::partition(pending.begin(), pending.end(), [&](auto const& t) {
+			return std::get<0>(t) > now + INetwork::TIME_EPS;
+		});
+		due.assign(notDue, pending.end());
+		pending.erase(notDue, pending.end());
+		std::sort(due.begin(), due.end(), [](auto const& a, auto const& b) {
+			return std::get<1>(a) > std::get<1>(b);
+		});
+
+		queue.processReadyTimers(now);
+		for (auto const& t : due) {
+			ASSERT(queue.hasReadyTask());
+			ASSERT(queue.getReadyTaskPriority() == std::get<1>(t));
+			ASSERT(queue.getReadyTask() == std::get<2>(t));
+			queue.popReadyTask();
+		}
+		ASSERT(!queue.hasReadyTask());
+	}
+
+	queue.clear();
+	ASSERT(queue.getSleepTime(now) == 0);
+	return Void();
+}
+
+TEST_CASE("flow/Net2/TaskQueue/ReadyTimes") {
+	// One in every interval tasks which become ready has the time it did, and a timer is ready from its time on
+	TaskQueue<int> queue;
+	const int interval = deterministicRandom()->randomInt(1, 10);
+	queue.sampleReadyTimes(interval);
+	int tasks[100];
+	const double before = timer_monotonic();
+	for (int i = 0; i < 100; ++i) {
+		if (i % 2) {
+			queue.addReady(TaskPriority::DefaultEndpoint, &tasks[i]);
+		} else {
+			queue.addTimer(1 + i, TaskPriority::DefaultEndpoint, &tasks[i]);
+		}
+	}
+	queue.processReadyTimers(1e6);
+	// The timers were added first, but only become ready now
+	int readyCount = 0, sampled = 0;
+	const double after = timer_monotonic();
+	while (queue.hasReadyTask()) {
+		const int i = queue.getReadyTask() - tasks;
+		const double readyTime = queue.getReadyTaskReadyTime();
+		if (readyTime != 0) {
+			ASSERT(i % 2 ? readyTime >= before && readyTime <= after : readyTime == 1 + i);
+			++sampled;
+		}
+		++readyCount;
+		queue.popReadyTask();
+	}
+	ASSERT(readyCount == 100 && sampled == 100 / interval);
+	return Void();
+}
+
 void net2_test(){
 	/*
 	g_network = newNet2();  // for promise serialization below
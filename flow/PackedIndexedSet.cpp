@@ -0,0 +1,763 @@
+/*
+ * PackedIndexedSet.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flow/PackedIndexedSet.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "flow/Error.h"
+#include "flow/IndexedSet.h"
+#include "flow/IRandom.h"
+#include "flow/UnitTest.h"
+
+template <int Capacity>
+int PackedIndexedSet::PackedKeys<Capacity>::lowerBound(StringRef key) const {
+	int lo = 0, hi = count;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if ((*this)[mid] < key) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+template <int Capacity>
+int PackedIndexedSet::PackedKeys<Capacity>::upperBound(StringRef key) const {
+	int lo = 0, hi = count;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (key < (*this)[mid]) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return lo;
+}
+
+template <int Capacity>
+void PackedIndexedSet::PackedKeys<Capacity>::resize(int newCapacity) {
+	newCapacity = std::max(newCapacity, bytes());
+	if (newCapacity == capacity) {
+		return;
+	}
+	uint8_t* newData = newCapacity ? new uint8_t[newCapacity] : nullptr;
+	if (bytes()) {
+		memcpy(newData, data, bytes());
+	}
+	delete[] data;
+	data = newData;
+	capacity = newCapacity;
+}
+
+template <int Capacity>
+void PackedIndexedSet::PackedKeys<Capacity>::insert(int i, StringRef key) {
+	ASSERT(count < Capacity && i <= count);
+	const int at = begin(i);
+	const int used = bytes();
+	const int n = key.size();
+	if (used + n > capacity) {
+		resize(std::max({ used + n, capacity + capacity / 2, 32 }));
+	}
+	memmove(data + at + n, data + at, used - at);
+	if (n) {
+		memcpy(data + at, key.begin(), n);
+	}
+	for (int j = count; j > i; --j) {
+		ends[j] = ends[j - 1] + n;
+	}
+	ends[i] = at + n;
+	++count;
+}
+
+template <int Capacity>
+void PackedIndexedSet::PackedKeys<Capacity>::erase(int b, int e) {
+	if (b == e) {
+		return;
+	}
+	const int from = begin(e);
+	const int to = begin(b);
+	const int used = bytes();
+	memmove(data + to, data + from, used - from);
+	for (int j = e; j < count; ++j) {
+		ends[j - (e - b)] = ends[j] - (from - to);
+	}
+	count -= e - b;
+	// Give memory back once most of the buffer is unused
+	if (bytes() < capacity / 4) {
+		resize(bytes() + bytes() / 2);
+	}
+}
+
+template <int Capacity>
+void PackedIndexedSet::PackedKeys<Capacity>::append(const PackedKeys& other, int b, int e) {
+	ASSERT(count + e - b <= Capacity);
+	const int from = other.begin(b);
+	const int n = other.begin(e) - from;
+	const int used = bytes();
+	if (used + n > capacity) {
+		resize(used + n);
+	}
+	if (n) {
+		memcpy(data + used, other.data + from, n);
+	}
+	for (int j = b; j < e; ++j) {
+		ends[count++] = used + other.ends[j] - from;
+	}
+}
+
+int PackedIndexedSet::Internal::indexOf(const Node* child) const {
+	for (int i = 0; i < count(); ++i) {
+		if (children[i] == child) {
+			return i;
+		}
+	}
+	ASSERT(false);
+	return -1;
+}
+
+PackedIndexedSet::PackedIndexedSet() : root(new Leaf()) {
+	first = static_cast<Leaf*>(root);
+}
+
+PackedIndexedSet::~PackedIndexedSet() {
+	free(root);
+}
+
+PackedIndexedSet::PackedIndexedSet(PackedIndexedSet&& r) noexcept : root(r.root), first(r.first) {
+	r.root = r.first = new Leaf();
+}
+
+PackedIndexedSet& PackedIndexedSet::operator=(PackedIndexedSet&& r) noexcept {
+	if (this != &r) {
+		free(root);
+		root = r.root;
+		first = r.first;
+		r.root = r.first = new Leaf();
+	}
+	return *this;
+}
+
+void PackedIndexedSet::clear() {
+	free(root);
+	root = first = new Leaf();
+}
+
+void PackedIndexedSet::free(Node* node) {
+	if (node->isLeaf) {
+		delete static_cast<Leaf*>(node);
+		return;
+	}
+	Internal* n = static_cast<Internal*>(node);
+	for (int i = 0; i < n->count(); ++i) {
+		free(n->children[i]);
+	}
+	delete n;
+}
+
+int64_t PackedIndexedSet::getBytes() const {
+	return getBytes(root);
+}
+
+int64_t PackedIndexedSet::getBytes(const Node* node) {
+	if (node->isLeaf) {
+		return sizeof(Leaf) + static_cast<const Leaf*>(node)->keys.capacity;
+	}
+	const Internal* n = static_cast<const Internal*>(node);
+	int64_t bytes = sizeof(Internal) + n->separators.capacity;
+	for (int i = 0; i < n->count(); ++i) {
+		bytes += getBytes(n->children[i]);
+	}
+	return bytes;
+}
+
+PackedIndexedSet::Leaf* PackedIndexedSet::findLeaf(StringRef key) const {
+	Node* node = root;
+	while (!node->isLeaf) {
+		Internal* n = static_cast<Internal*>(node);
+		// The separator of child 0 is empty, so it is never greater than key
+		node = n->children[n->separators.upperBound(key) - 1];
+	}
+	return static_cast<Leaf*>(node);
+}
+
+PackedIndexedSet::const_iterator PackedIndexedSet::normalize(const Leaf* leaf, int index) {
+	while (leaf && index == leaf->count()) {
+		leaf = leaf->next;
+		index = 0;
+	}
+	return leaf ? const_iterator(leaf, index) : const_iterator();
+}
+
+void PackedIndexedSet::addToTotals(Node* node, int64_t delta) {
+	for (; node; node = node->parent) {
+		node->total += delta;
+	}
+}
+
+PackedIndexedSet::const_iterator PackedIndexedSet::find(StringRef key) const {
+	const Leaf* leaf = findLeaf(key);
+	int i = leaf->keys.lowerBound(key);
+	return i < leaf->count() && leaf->keys[i] == key ? const_iterator(leaf, i) : end();
+}
+
+PackedIndexedSet::const_iterator PackedIndexedSet::lower_bound(StringRef key) const {
+	const Leaf* leaf = findLeaf(key);
+	return normalize(leaf, leaf->keys.lowerBound(key));
+}
+
+PackedIndexedSet::const_iterator PackedIndexedSet::upper_bound(StringRef key) const {
+	const Leaf* leaf = findLeaf(key);
+	return normalize(leaf, leaf->keys.upperBound(key));
+}
+
+int64_t PackedIndexedSet::sumTo(const_iterator to) const {
+	if (!to.leaf) {
+		return root->total;
+	}
+	int64_t m = 0;
+	for (int i = 0; i < to.index; ++i) {
+		m += to.leaf->metrics[i];
+	}
+	const Node* node = to.leaf;
+	for (const Internal* p = node->parent; p; node = p, p = p->parent) {
+		for (int i = 0; p->children[i] != node; ++i) {
+			m += p->children[i]->total;
+		}
+	}
+	return m;
+}
+
+PackedIndexedSet::const_iterator PackedIndexedSet::insert(StringRef key, int64_t metric, bool replaceExisting) {
+	Leaf* leaf = findLeaf(key);
+	int i = leaf->keys.lowerBound(key);
+	if (i < leaf->count() && leaf->keys[i] == key) {
+		if (replaceExisting) {
+			addToTotals(leaf, metric - leaf->metrics[i]);
+			leaf->metrics[i] = metric;
+		}
+		return const_iterator(leaf, i);
+	}
+
+	const int count = leaf->count();
+	if (count == LeafCapacity || (count > 1 && leaf->keys.bytes() + key.size() > LeafKeyBytes)) {
+		// A key in the second half of the leaf ends the leaf, and a key after all of its keys starts a new one. Keys
+		// inserted in ascending order then leave full leaves behind, even when inserted in front of other keys such as
+		// those of a range being loaded in parallel.
+		const int at = i > count / 2 ? i : count / 2;
+		splitLeaf(leaf, at, key);
+		if (i == count) {
+			leaf = leaf->next;
+			i = 0;
+		}
+	}
+
+	leaf->keys.insert(i, key);
+	memmove(leaf->metrics + i + 1, leaf->metrics + i, (leaf->count() - 1 - i) * sizeof(int64_t));
+	leaf->metrics[i] = metric;
+	addToTotals(leaf, metric);
+	return const_iterator(leaf, i);
+}
+
+std::pair<int64_t, PackedIndexedSet::const_iterator> PackedIndexedSet::addMetric(StringRef key, int64_t metric) {
+	Leaf* leaf = findLeaf(key);
+	int i = leaf->keys.lowerBound(key);
+	if (i < leaf->count() && leaf->keys[i] == key) {
+		leaf->metrics[i] += metric;
+		addToTotals(leaf, metric);
+		return { leaf->metrics[i], const_iterator(leaf, i) };
+	}
+	return { metric, insert(key, metric) };
+}
+
+void PackedIndexedSet::growRoot() {
+	Internal* newRoot = new Internal();
+	newRoot->separators.insert(0, StringRef());
+	newRoot->children[0] = root;
+	newRoot->total = root->total;
+	root->parent = newRoot;
+	root = newRoot;
+}
+
+void PackedIndexedSet::splitLeaf(Leaf* leaf, int at, StringRef separator) {
+	if (leaf == root) {
+		growRoot();
+	}
+
+	Leaf* right = new Leaf();
+	right->keys.append(leaf->keys, at, leaf->count());
+	for (int j = at; j < leaf->count(); ++j) {
+		right->metrics[j - at] = leaf->metrics[j];
+		right->total += leaf->metrics[j];
+	}
+	leaf->keys.erase(at, leaf->count());
+	leaf->keys.resize(leaf->keys.bytes());
+	leaf->total -= right->total;
+
+	right->prev = leaf;
+	right->next = leaf->next;
+	if (leaf->next) {
+		leaf->next->prev = right;
+	}
+	leaf->next = right;
+
+	// The parent's total already includes the items moved to right
+	insertChild(leaf->parent, leaf, right, right->count() ? right->keys[0] : separator);
+}
+
+void PackedIndexedSet::insertChild(Internal* parent, Node* prev, Node* child, StringRef separator) {
+	int i = parent->indexOf(prev) + 1;
+	if (parent->count() == InternalCapacity) {
+		if (parent == root) {
+			growRoot();
+		}
+
+		const int at = InternalCapacity / 2;
+		Internal* left = parent;
+		Internal* right = new Internal();
+		// The separator of the first child of right becomes the separator of right
+		std::string rightSeparator = parent->separators[at].toString();
+		right->separators.insert(0, StringRef());
+		right->separators.append(parent->separators, at + 1, InternalCapacity);
+		for (int j = at; j < InternalCapacity; ++j) {
+			right->children[j - at] = parent->children[j];
+			right->children[j - at]->parent = right;
+			right->total += right->children[j - at]->total;
+		}
+		parent->separators.erase(at, InternalCapacity);
+		parent->total -= right->total;
+
+		if (i > at) {
+			// The total of child is included in the total of parent rather than right
+			right->total += child->total;
+			parent->total -= child->total;
+			parent = right;
+			i -= at;
+		}
+		// The total of right is included in the total of the parent of left
+		insertChild(left->parent, left, right, StringRef(rightSeparator));
+	}
+
+	parent->separators.insert(i, separator);
+	memmove(parent->children + i + 1, parent->children + i, (parent->count() - 1 - i) * sizeof(Node*));
+	parent->children[i] = child;
+	child->parent = parent;
+}
+
+void PackedIndexedSet::eraseItems(Leaf* leaf, int b, int e) {
+	int64_t delta = 0;
+	for (int j = b; j < e; ++j) {
+		delta -= leaf->metrics[j];
+	}
+	memmove(leaf->metrics + b, leaf->metrics + e, (leaf->count() - e) * sizeof(int64_t));
+	leaf->keys.erase(b, e);
+	addToTotals(leaf, delta);
+}
+
+void PackedIndexedSet::removeChild(Internal* parent, int i) {
+	const int count = parent->count();
+	// Child 0 keeps an empty separator
+	const int s = i == 0 && count > 1 ? 1 : i;
+	parent->separators.erase(s, s + 1);
+	memmove(parent->children + i, parent->children + i + 1, (count - 1 - i) * sizeof(Node*));
+}
+
+void PackedIndexedSet::removeLeaf(Leaf* leaf) {
+	ASSERT(leaf != root && !leaf->count());
+	if (leaf->prev) {
+		leaf->prev->next = leaf->next;
+	} else {
+		first = leaf->next;
+	}
+	if (leaf->next) {
+		leaf->next->prev = leaf->prev;
+	}
+	Internal* parent = leaf->parent;
+	removeChild(parent, parent->indexOf(leaf));
+	delete leaf;
+	mergeInternal(parent);
+}
+
+void PackedIndexedSet::mergeLeaf(Leaf* leaf) {
+	if (leaf == root || leaf->count() >= LeafCapacity / 4) {
+		return;
+	}
+	auto fits = [](const Leaf* left, const Leaf* right) {
+		return left->count() + right->count() <= LeafCapacity &&
+		       left->keys.bytes() + right->keys.bytes() <= LeafKeyBytes;
+	};
+	// Only siblings with the same parent are merged, so that no separator changes
+	Internal* parent = leaf->parent;
+	const int i = parent->indexOf(leaf);
+	Leaf* left;
+	Leaf* right;
+	int rightIndex;
+	if (i + 1 < parent->count() && fits(leaf, leaf->next)) {
+		left = leaf;
+		right = leaf->next;
+		rightIndex = i + 1;
+	} else if (i > 0 && fits(leaf->prev, leaf)) {
+		left = leaf->prev;
+		right = leaf;
+		rightIndex = i;
+	} else {
+		return;
+	}
+
+	const int n = left->count();
+	left->keys.append(right->keys, 0, right->count());
+	memcpy(left->metrics + n, right->metrics, right->count() * sizeof(int64_t));
+	left->total += right->total;
+	left->next = right->next;
+	if (right->next) {
+		right->next->prev = left;
+	}
+	removeChild(parent, rightIndex);
+	delete right;
+	mergeInternal(parent);
+}
+
+void PackedIndexedSet::mergeInternal(Internal* node) {
+	if (node == root) {
+		collapseRoot();
+		return;
+	}
+	Internal* parent = node->parent;
+	if (!node->count()) {
+		removeChild(parent, parent->indexOf(node));
+		delete node;
+		mergeInternal(parent);
+		return;
+	}
+	if (node->count() >= InternalCapacity / 4) {
+		return;
+	}
+
+	if (parent->count() == 1) {
+		// node is the only child of parent, which has too few children as well
+		mergeInternal(parent);
+		return;
+	}
+	auto fits = [](const Node* left, const Node* right) {
+		return static_cast<const Internal*>(left)->count() + static_cast<const Internal*>(right)->count() <=
+		       InternalCapacity;
+	};
+	const int i = parent->indexOf(node);
+	Internal* left;
+	Internal* right;
+	int rightIndex;
+	if (i + 1 < parent->count() && fits(node, parent->children[i + 1])) {
+		left = node;
+		right = static_cast<Internal*>(parent->children[i + 1]);
+		rightIndex = i + 1;
+	} else if (i > 0 && fits(parent->children[i - 1], node)) {
+		left = static_cast<Internal*>(parent->children[i - 1]);
+		right = node;
+		rightIndex = i;
+	} else {
+		return;
+	}
+
+	// The separator of right separates its first child from the last child of left
+	const int n = left->count();
+	left->separators.insert(n, parent->separators[rightIndex]);
+	left->separators.append(right->separators, 1, right->count());
+	for (int j = 0; j < right->count(); ++j) {
+		left->children[n + j] = right->children[j];
+		left->children[n + j]->parent = left;
+	}
+	left->total += right->total;
+	removeChild(parent, rightIndex);
+	delete right;
+	mergeInternal(parent);
+}
+
+void PackedIndexedSet::collapseRoot() {
+	while (!root->isLeaf) {
+		Internal* r = static_cast<Internal*>(root);
+		if (r->count() > 1) {
+			return;
+		}
+		if (!r->count()) {
+			delete r;
+			root = first = new Leaf();
+			return;
+		}
+		root = r->children[0];
+		root->parent = nullptr;
+		delete r;
+	}
+}
+
+void PackedIndexedSet::erase(const_iterator item) {
+	if (item == end()) {
+		return;
+	}
+	Leaf* leaf = const_cast<Leaf*>(item.leaf);
+	eraseItems(leaf, item.index, item.index + 1);
+	if (leaf != root && !leaf->count()) {
+		removeLeaf(leaf);
+	} else {
+		mergeLeaf(leaf);
+	}
+}
+
+void PackedIndexedSet::erase(const_iterator b, const_iterator e) {
+	if (b == e) {
+		return;
+	}
+	Leaf* beginLeaf = const_cast<Leaf*>(b.leaf);
+	Leaf* endLeaf = const_cast<Leaf*>(e.leaf);
+	if (beginLeaf == endLeaf) {
+		eraseItems(beginLeaf, b.index, e.index);
+		mergeLeaf(beginLeaf);
+		return;
+	}
+
+	// Leaves emptied by the erase are removed as soon as they are, and only the leaves at the ends of the range are
+	// left with fewer items. Internal nodes are merged as leaves are removed, which doesn't move any leaf.
+	bool beginRemoved = false;
+	Leaf* leaf = beginLeaf;
+	int from = b.index;
+	while (leaf != endLeaf) {
+		Leaf* next = leaf->next;
+		eraseItems(leaf, from, leaf->count());
+		if (leaf != root && !leaf->count()) {
+			beginRemoved = beginRemoved || leaf == beginLeaf;
+			removeLeaf(leaf);
+		}
+		from = 0;
+		leaf = next;
+	}
+	if (endLeaf) {
+		eraseItems(endLeaf, 0, e.index);
+		// Merging endLeaf may free endLeaf or the leaf after it, but not beginLeaf
+		mergeLeaf(endLeaf);
+	}
+	if (!beginRemoved) {
+		mergeLeaf(beginLeaf);
+	}
+}
+
+void PackedIndexedSet::testonly_assertValid() const {
+	ASSERT(!root->parent);
+	int leafDepth = -1;
+	const Leaf* prevLeaf = nullptr;
+	ASSERT_EQ(testonly_assertValid(root, StringRef(), nullptr, 0, leafDepth, prevLeaf), root->total);
+	ASSERT(!prevLeaf->next);
+	if (!root->isLeaf) {
+		ASSERT(static_cast<const Internal*>(root)->count() > 1);
+	}
+}
+
+int64_t PackedIndexedSet::testonly_assertValid(const Node* node,
+                                               StringRef lower,
+                                               const StringRef* upper,
+                                               int depth,
+                                               int& leafDepth,
+                                               const Leaf*& prevLeaf) const {
+	int64_t total = 0;
+	if (node->isLeaf) {
+		const Leaf* leaf = static_cast<const Leaf*>(node);
+		ASSERT(leaf->count() || leaf == root);
+		ASSERT(leafDepth == -1 || leafDepth == depth);
+		leafDepth = depth;
+		ASSERT(leaf->prev == prevLeaf);
+		ASSERT(prevLeaf ? prevLeaf->next == leaf : first == leaf);
+		prevLeaf = leaf;
+		for (int i = 0; i < leaf->count(); ++i) {
+			ASSERT(i ? leaf->keys[i - 1] < leaf->keys[i] : lower <= leaf->keys[i]);
+			ASSERT(!upper || leaf->keys[i] < *upper);
+			total += leaf->metrics[i];
+		}
+	} else {
+		const Internal* n = static_cast<const Internal*>(node);
+		ASSERT(n->count() > 0 && n->separators[0].empty());
+		for (int i = 0; i < n->count(); ++i) {
+			ASSERT(n->children[i]->parent == n);
+			StringRef childLower = i ? n->separators[i] : lower;
+			StringRef childUpper = i + 1 < n->count() ? n->separators[i + 1] : StringRef();
+			ASSERT(!i || lower < childLower);
+			const int64_t childTotal = testonly_assertValid(n->children[i],
+			                                                childLower,
+			                                                i + 1 < n->count() ? &childUpper : upper,
+			                                                depth + 1,
+			                                                leafDepth,
+			                                                prevLeaf);
+			ASSERT_EQ(childTotal, n->children[i]->total);
+			total += childTotal;
+		}
+	}
+	ASSERT_EQ(total, node->total);
+	return total;
+}
+
+namespace {
+
+// Checks that set holds the items of expected
+void checkSame(const PackedIndexedSet& set, const IndexedSet<Standalone<StringRef>, int64_t>& expected) {
+	set.testonly_assertValid();
+	auto it = set.begin();
+	for (auto e = expected.begin(); e != expected.end(); ++e) {
+		ASSERT(it != set.end());
+		ASSERT(*it == *e);
+		ASSERT_EQ(set.getMetric(it), expected.getMetric(e));
+		++it;
+	}
+	ASSERT(it == set.end());
+	ASSERT_EQ(set.sumTo(set.end()), expected.sumTo(expected.end()));
+}
+
+Standalone<StringRef> randomKey(int keySpace) {
+	int k = deterministicRandom()->randomInt(0, keySpace);
+	// Keys of many lengths, some of which are prefixes of others
+	return Standalone<StringRef>(format("%d", k).substr(0, deterministicRandom()->randomInt(1, 8)) +
+	                             std::string(deterministicRandom()->randomInt(0, 3) ? 0 : k % 100, 'k'));
+}
+
+} // namespace
+
+TEST_CASE("/flow/PackedIndexedSet/randomOps") {
+	for (int t = 0; t < 20; ++t) {
+		PackedIndexedSet set;
+		IndexedSet<Standalone<StringRef>, int64_t> expected;
+		const int keySpace = deterministicRandom()->randomInt(1, 100000);
+		const int ops = deterministicRandom()->randomInt(0, 20000);
+		for (int n = 0; n < ops; ++n) {
+			Standalone<StringRef> key = randomKey(keySpace);
+			int op = deterministicRandom()->randomInt(0, 100);
+			if (op < 50) {
+				int64_t metric = deterministicRandom()->randomInt(1, 1000);
+				bool replace = deterministicRandom()->coinflip();
+				set.insert(key, metric, replace);
+				expected.insert(key, metric, replace);
+			} else if (op < 60) {
+				// Metrics drop to 0 as the metrics of transient samples do, but are never negative
+				auto f = set.find(key);
+				int64_t metric = deterministicRandom()->randomInt(1, 10);
+				if (f != set.end() && deterministicRandom()->coinflip()) {
+					metric = -set.getMetric(f);
+				}
+				auto [m, it] = set.addMetric(key, metric);
+				auto [em, eit] = expected.addMetric(key, metric);
+				ASSERT_EQ(m, em);
+				ASSERT(*it == key);
+				if (m == 0) {
+					set.erase(it);
+					expected.erase(eit);
+				}
+			} else if (op < 85) {
+				set.erase(set.lower_bound(key));
+				expected.erase(expected.lower_bound(key));
+			} else if (op < 88) {
+				Standalone<StringRef> end = randomKey(keySpace);
+				if (end < key) {
+					std::swap(key, end);
+				}
+				set.erase(key, end);
+				expected.erase(key, end);
+			} else {
+				Standalone<StringRef> end = randomKey(keySpace);
+				auto lb = set.lower_bound(key);
+				auto elb = expected.lower_bound(key);
+				ASSERT(lb == set.end() ? elb == expected.end() : elb != expected.end() && *lb == *elb);
+				auto ub = set.upper_bound(key);
+				auto eub = expected.upper_bound(key);
+				ASSERT(ub == set.end() ? eub == expected.end() : eub != expected.end() && *ub == *eub);
+				auto f = set.find(key);
+				ASSERT((f == set.end()) == (expected.find(key) == expected.end()));
+				ASSERT_EQ(set.sumTo(lb), expected.sumTo(elb));
+				ASSERT_EQ(set.sumRange(key, end), expected.sumRange(key, end));
+
+				int64_t metric = deterministicRandom()->randomInt64(-1, set.sumTo(set.end()) + 2);
+				auto x = set.index(metric);
+				auto ex = expected.index(metric);
+				ASSERT(x == set.end() ? ex == expected.end() : ex != expected.end() && *x == *ex);
+				if (x != set.begin() && x != set.end()) {
+					auto prev = x;
+					prev.decrementNonEnd();
+					auto eprev = ex;
+					eprev.decrementNonEnd();
+					ASSERT(*prev == *eprev);
+				}
+			}
+			if (n % 1000 == 0) {
+				checkSame(set, expected);
+			}
+		}
+		checkSame(set, expected);
+
+		if (deterministicRandom()->coinflip()) {
+			set.erase(set.begin(), set.end());
+			ASSERT(set.empty());
+			set.testonly_assertValid();
+		}
+	}
+	return Void();
+}
+
+TEST_CASE("/flow/PackedIndexedSet/ascendingLoad") {
+	PackedIndexedSet set;
+	IndexedSet<Standalone<StringRef>, int64_t> expected;
+	const int count = deterministicRandom()->randomInt(1, 100000);
+	for (int i = 0; i < count; ++i) {
+		Standalone<StringRef> key(format("key/%08d", i));
+		set.insert(key, i);
+		expected.insert(key, i);
+	}
+	checkSame(set, expected);
+
+	// Leaves are filled before new ones are started, so a key takes little more than its own bytes
+	const int64_t leaves = (count + PackedIndexedSet::LeafCapacity - 1) / PackedIndexedSet::LeafCapacity;
+	ASSERT_LE(set.getBytes(), leaves * (sizeof(int64_t) * 2 + PackedIndexedSet::LeafCapacity * (12 * 2 + 12)));
+
+	// Loading the same keys in several interleaved ascending runs, as parallel loads of a persisted sample do, leaves
+	// only a few partially filled leaves for each run
+	PackedIndexedSet runs;
+	const int runCount = deterministicRandom()->randomInt(1, 10);
+	for (int i = 0; i < count; ++i) {
+		for (int r = 0; r < runCount; ++r) {
+			int k = r * (count / runCount) + i;
+			if (k < count && (r == runCount - 1 || k < (r + 1) * (count / runCount))) {
+				Standalone<StringRef> key(format("key/%08d", k));
+				runs.insert(key, k);
+			}
+		}
+	}
+	checkSame(runs, expected);
+	ASSERT_LE(runs.getBytes(), set.getBytes() + 16 * runCount * (set.getBytes() / leaves + 1));
+
+	// Erasing most of the keys merges the remaining ones into fewer leaves
+	for (int i = 0; i < count; ++i) {
+		if (i % 16) {
+			Standalone<StringRef> key(format("key/%08d", i));
+			set.erase(set.find(key));
+			expected.erase(key);
+		}
+	}
+	checkSame(set, expected);
+	ASSERT_LE(set.getBytes(), leaves * sizeof(int64_t) * PackedIndexedSet::LeafCapacity);
+	return Void();
+}
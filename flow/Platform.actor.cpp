@@ -118,6 +118,8 @@ static_assert(std::is_same<boost::asio::ip::address_v6::bytes_type, std::array<u
 #include <linux/mman.h>
 /* Needed for processor affinity */
 #include <sched.h>
+/* Needed for set_mempolicy */
+#include <linux/mempolicy.h>
 /* Needed for getProcessorTime* and setpriority */
 #include <sys/syscall.h>
 /* Needed for setpriority */
@@ -2255,6 +2257,91 @@ void setAffinity(int proc) {
 #endif
 }
 
+static int boundNumaNode = -1;
+
+bool bindToNumaNode(int node) {
+#if defined(__linux__)
+	std::ifstream cpuListFile(format("/sys/devices/system/node/node%d/cpulist", node));
+	std::string cpuList;
+	if (node < 0 || !cpuListFile || !std::getline(cpuListFile, cpuList)) {
+		TraceEvent(SevWarnAlways, "NumaNodeNotFound").detail("Node", node);
+		return false;
+	}
+
+	// cpulist is a comma separated list of CPUs and CPU ranges, e.g. 0-7,16-23
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	int cpus = 0;
+	std::istringstream ranges(cpuList);
+	std::string range;
+	while (std::getline(ranges, range, ',')) {
+		int first, last;
+		int matched = sscanf(range.c_str(), "%d-%d", &first, &last);
+		if (matched < 1) {
+			continue;
+		}
+		if (matched == 1) {
+			last = first;
+		}
+		for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+			CPU_SET(cpu, &set);
+			cpus++;
+		}
+	}
+	if (!cpus || sched_setaffinity(0, sizeof(cpu_set_t), &set)) {
+		TraceEvent(SevWarnAlways, "NumaBindCPUsFailed").GetLastError().detail("Node", node).detail("CPUs", cpuList);
+		return false;
+	}
+
+	// Memory is preferred from, rather than restricted to, the node so that allocations still succeed when the node is
+	// out of memory.
+	constexpr int bitsPerWord = 8 * sizeof(unsigned long);
+	std::vector<unsigned long> nodeMask(node / bitsPerWord + 1);
+	nodeMask[node / bitsPerWord] |= 1UL << (node % bitsPerWord);
+	if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, nodeMask.data(), nodeMask.size() * bitsPerWord + 1)) {
+		TraceEvent(SevWarnAlways, "NumaBindMemoryFailed").GetLastError().detail("Node", node);
+		return false;
+	}
+
+	boundNumaNode = node;
+	TraceEvent("NumaNodeBound").detail("Node", node).detail("CPUs", cpuList);
+	return true;
+#else
+	TraceEvent(SevWarnAlways, "NumaBindUnsupported").detail("Node", node);
+	return false;
+#endif
+}
+
+int getBoundNumaNode() {
+	return boundNumaNode;
+}
+
+bool getNumaNodeStatistics(int node, NumaNodeStatistics& stats) {
+#if defined(__linux__)
+	// numastat counts pages allocated on the node since boot, see the kernel's Documentation/admin-guide/numastat.rst
+	std::ifstream numastat(format("/sys/devices/system/node/node%d/numastat", node));
+	if (!numastat) {
+		return false;
+	}
+	std::string name;
+	int64_t value;
+	while (numastat >> name >> value) {
+		if (name == "local_node") {
+			stats.localNode = value;
+		} else if (name == "other_node") {
+			stats.otherNode = value;
+		} else if (name == "numa_miss") {
+			stats.numaMiss = value;
+		} else if (name == "numa_foreign") {
+			stats.numaForeign = value;
+		}
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
 namespace platform {
 
 int getRandomSeed() {
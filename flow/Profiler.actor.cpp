@@ -20,9 +20,12 @@
 
 #include "flow/flow.h"
 #include "flow/network.h"
+#include "flow/Profiler.h"
 
 #ifdef __linux__
 
+#include <algorithm>
+#include <atomic>
 #include <execinfo.h>
 #include <signal.h>
 #include <sys/time.h>
@@ -305,9 +308,194 @@ void stopProfiling() {
 	}
 }
 
+// Counts samples of which actor, at which priority, the network thread is running when a CPU time timer fires. The
+// counts go to one of two fixed size tables, so the signal handler neither allocates nor locks, and the reporting actor
+// swaps the tables before reading one. Since both run on the network thread, a handler never sees a table being read.
+//
+// A realtime signal is used rather than SIGPROF, which the run loop profiler and the flow profiler install their own
+// handlers for.
+struct CpuSampler {
+	enum { TABLE_SIZE = 1024, MAX_PROBES = 8 };
+
+	struct Slot {
+		std::atomic<const char*> actor;
+		std::atomic<int> priority;
+		std::atomic<uint32_t> count; // 0 if the slot is empty
+	};
+
+	struct Table {
+		Slot slots[TABLE_SIZE];
+		std::atomic<uint32_t> samples;
+		std::atomic<uint32_t> dropped; // Samples that found no free slot
+	};
+
+	Table tables[2];
+	std::atomic<Table*> active;
+	INetwork* network;
+	timer_t periodicTimer;
+	bool timerInitialized = false;
+	static std::atomic<CpuSampler*> active_sampler;
+
+	explicit CpuSampler(INetwork* network) : active(&tables[0]), network(network) {
+		for (auto& table : tables) {
+			clear(table);
+		}
+	}
+
+	~CpuSampler() {
+		if (active_sampler.load() == this) {
+			active_sampler.store(nullptr);
+		}
+		if (timerInitialized) {
+			timer_delete(periodicTimer);
+		}
+	}
+
+	static int samplingSignal() { return SIGRTMIN + 1; }
+
+	static void clear(Table& table) {
+		for (auto& slot : table.slots) {
+			slot.count.store(0, std::memory_order_relaxed);
+		}
+		table.samples.store(0, std::memory_order_relaxed);
+		table.dropped.store(0, std::memory_order_relaxed);
+	}
+
+	void sample() { // async signal safe!
+		Table* table = active.load(std::memory_order_relaxed);
+		const char* actor = currentLineage->actorName();
+		const int priority = static_cast<int>(network->getCurrentTask());
+		table->samples.fetch_add(1, std::memory_order_relaxed);
+
+		size_t index = (reinterpret_cast<uintptr_t>(actor) >> 3) * 31 + priority;
+		for (int probe = 0; probe < MAX_PROBES; ++probe, ++index) {
+			Slot& slot = table->slots[index % TABLE_SIZE];
+			if (slot.count.load(std::memory_order_relaxed) == 0) {
+				slot.actor.store(actor, std::memory_order_relaxed);
+				slot.priority.store(priority, std::memory_order_relaxed);
+				slot.count.store(1, std::memory_order_relaxed);
+				return;
+			}
+			if (slot.actor.load(std::memory_order_relaxed) == actor &&
+			    slot.priority.load(std::memory_order_relaxed) == priority) {
+				slot.count.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+		table->dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static void signal_handler(int, siginfo_t* si, void*) { // async signal safe!
+		CpuSampler* self = active_sampler.load(std::memory_order_relaxed);
+		if (self && si->si_code == SI_TIMER && si->si_value.sival_ptr == self) {
+			self->sample();
+		}
+	}
+
+	bool start(double period) {
+		CpuSampler* expected = nullptr;
+		if (!active_sampler.compare_exchange_strong(expected, this)) {
+			TraceEvent(SevWarn, "CpuSamplerAlreadyRunning").log();
+			return false;
+		}
+
+		struct sigaction act;
+		act.sa_sigaction = signal_handler;
+		sigemptyset(&act.sa_mask);
+		act.sa_flags = SA_SIGINFO | SA_RESTART;
+		if (sigaction(samplingSignal(), &act, nullptr) != 0) {
+			TraceEvent(SevWarn, "FailedToSetCpuSamplerHandler").GetLastError();
+			return false;
+		}
+
+		sigevent sev;
+		sev.sigev_notify = SIGEV_THREAD_ID;
+		sev.sigev_signo = samplingSignal();
+		sev.sigev_value.sival_ptr = this;
+		sev._sigev_un._tid = sys_gettid();
+		if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &periodicTimer) != 0) {
+			TraceEvent(SevWarn, "FailedToCreateCpuSamplerTimer").GetLastError();
+			return false;
+		}
+		timerInitialized = true;
+
+		const int64_t period_ns = std::max<int64_t>(period * 1e9, 1e5);
+		itimerspec tv;
+		tv.it_interval.tv_sec = period_ns / 1000000000;
+		tv.it_interval.tv_nsec = period_ns % 1000000000;
+		tv.it_value = tv.it_interval;
+		if (timer_settime(periodicTimer, 0, &tv, nullptr) != 0) {
+			TraceEvent(SevWarn, "FailedToSetCpuSamplerTimer").GetLastError();
+			return false;
+		}
+		return true;
+	}
+
+	// Traces the most frequent entries of the table filled since the last report, in folded form: entries are
+	// "priority;actor count" separated by commas, or just "priority count" when the actor isn't known
+	void report(int topEntries) {
+		Table* table = active.load();
+		active.store(table == &tables[0] ? &tables[1] : &tables[0]);
+
+		std::vector<std::pair<uint32_t, int>> entries;
+		for (int i = 0; i < TABLE_SIZE; ++i) {
+			const uint32_t count = table->slots[i].count.load(std::memory_order_relaxed);
+			if (count > 0) {
+				entries.emplace_back(count, i);
+			}
+		}
+		const int reported = std::min<int>(topEntries, entries.size());
+		std::partial_sort(
+		    entries.begin(), entries.begin() + reported, entries.end(), std::greater<std::pair<uint32_t, int>>());
+
+		std::string folded;
+		for (int i = 0; i < reported; ++i) {
+			Slot const& slot = table->slots[entries[i].second];
+			const char* actor = slot.actor.load(std::memory_order_relaxed);
+			if (!folded.empty()) {
+				folded += ',';
+			}
+			folded += std::to_string(slot.priority.load(std::memory_order_relaxed));
+			if (actor && actor[0]) {
+				folded += ';';
+				folded += actor;
+			}
+			folded += ' ';
+			folded += std::to_string(entries[i].first);
+		}
+
+		TraceEvent("CpuSamples")
+		    .detail("Samples", table->samples.load(std::memory_order_relaxed))
+		    .detail("Dropped", table->dropped.load(std::memory_order_relaxed))
+		    .detail("Distinct", entries.size())
+		    .detail("Folded", folded);
+		clear(*table);
+	}
+};
+
+std::atomic<CpuSampler*> CpuSampler::active_sampler = nullptr;
+
+ACTOR Future<Void> cpuSampler(INetwork* network) {
+	if (FLOW_KNOBS->CPU_SAMPLER_PERIOD <= 0) {
+		return Never();
+	}
+	state std::unique_ptr<CpuSampler> sampler = std::make_unique<CpuSampler>(network);
+	if (!sampler->start(FLOW_KNOBS->CPU_SAMPLER_PERIOD)) {
+		return Never();
+	}
+	TraceEvent("CpuSamplerStarted").detail("Period", FLOW_KNOBS->CPU_SAMPLER_PERIOD);
+	loop {
+		wait(network->delay(FLOW_KNOBS->CPU_SAMPLER_REPORT_INTERVAL, TaskPriority::DefaultDelay));
+		sampler->report(FLOW_KNOBS->CPU_SAMPLER_TOP_ENTRIES);
+	}
+}
+
 #else
 
 void startProfiling(INetwork* network, Optional<int> period, Optional<StringRef> outputFile) {}
 void stopProfiling() {}
+Future<Void> cpuSampler(INetwork* network) {
+	return Never();
+}
 
 #endif
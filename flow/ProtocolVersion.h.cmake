@@ -178,6 +178,7 @@ public: // introduced features
 	PROTOCOL_VERSION_FEATURE(@FDB_PV_BLOB_RANGE_CHANGE_LOG@, BlobRangeChangeLog);
 	PROTOCOL_VERSION_FEATURE(@FDB_PV_GC_TXN_GENERATIONS@, GcTxnGenerations);
 	PROTOCOL_VERSION_FEATURE(@FDB_PV_MUTATION_CHECKSUM@, MutationChecksum);
+	PROTOCOL_VERSION_FEATURE(@FDB_PV_COMPRESSED_COMMIT@, CompressedCommit);
 };
 
 template <>
@@ -93,4 +93,5 @@ set(FDB_PV_CLUSTER_ID_SPECIAL_KEY               "0x0FDB00B072000000LL")
 set(FDB_PV_BLOB_GRANULE_FILE_LOGICAL_SIZE       "0x0FDB00B072000000LL")
 set(FDB_PV_BLOB_RANGE_CHANGE_LOG                "0x0FDB00B072000000LL")
 set(FDB_PV_GC_TXN_GENERATIONS                   "0x0FDB00B073000000LL")
-set(FDB_PV_MUTATION_CHECKSUM                    "0x0FDB00B074000000LL")
\ No newline at end of file
+set(FDB_PV_MUTATION_CHECKSUM                    "0x0FDB00B074000000LL")
+set(FDB_PV_COMPRESSED_COMMIT                    "0x0FDB00B074000000LL")
\ No newline at end of file
@@ -198,6 +198,10 @@ SystemStatistics customSystemMonitor(std::string const& eventName, StatisticsSta
 			    .DETAILALLOCATORMEMUSAGE(8192)
 			    .DETAILALLOCATORMEMUSAGE(16384)
 			    .detail("HugeArenaMemory", g_hugeArenaMemory.load())
+			    .detail("FastAllocHugeChunkMemory", g_fastAllocHugeChunkMemory.load())
+			    .detail("PageSlabMemory", PageSlab::getTotalMemory())
+			    .detail("PageSlabUsedMemory", PageSlab::getUsedMemory())
+			    .detail("PageSlabResidentMemory", PageSlab::getTouchedMemory())
 			    .detail("DCID", machineState.dcId)
 			    .detail("ZoneID", machineState.zoneId)
 			    .detail("MachineID", machineState.machineId);
@@ -253,6 +257,8 @@ SystemStatistics customSystemMonitor(std::string const& eventName, StatisticsSta
 			    .detail("ASIOEventsProcessed", netData.countASIOEvents - statState->networkState.countASIOEvents)
 			    .detail("ReadCalls", netData.countReads - statState->networkState.countReads)
 			    .detail("WriteCalls", netData.countWrites - statState->networkState.countWrites)
+			    .detail("WriteBytes", netData.countWriteBytes - statState->networkState.countWriteBytes)
+			    .detail("WriteBuffers", netData.countWriteBuffers - statState->networkState.countWriteBuffers)
 			    .detail("ReadProbes", netData.countReadProbes - statState->networkState.countReadProbes)
 			    .detail("WriteProbes", netData.countWriteProbes - statState->networkState.countWriteProbes)
 			    .detail("PacketsRead", netData.countPacketsReceived - statState->networkState.countPacketsReceived)
@@ -316,7 +322,39 @@ SystemStatistics customSystemMonitor(std::string const& eventName, StatisticsSta
 				itr.maxDuration = 0;
 			}
 
+			// PriorityReadyWait*X: how long the sampled tasks at a priority at or above X, and below the next
+			// starvation bin, waited to run once they were ready
+			auto& readyWaits = g_network->networkInfo.metrics.readyWaits;
+			for (int i = 0; i < readyWaits.size(); i++) {
+				auto& sketch = readyWaits[i];
+				const int priority = NetworkMetrics::starvationBins[i];
+				const bool sampled = sketch.getPopulationSize() > 0;
+				n.detail(format("PriorityReadyWaitCount%d", priority).c_str(), sketch.getPopulationSize());
+				n.detail(format("PriorityReadyWaitMedian%d", priority).c_str(), sampled ? sketch.median() : 0.0);
+				n.detail(format("PriorityReadyWaitP99%d", priority).c_str(), sampled ? sketch.percentile(0.99) : 0.0);
+				n.detail(format("PriorityReadyWaitMax%d", priority).c_str(), sampled ? sketch.max() : 0.0);
+				sketch.clear();
+			}
+
 			n.trackLatest("NetworkMetrics");
+
+			NumaNodeStatistics numaStats;
+			const int numaNode = getBoundNumaNode();
+			if (numaNode >= 0 && getNumaNodeStatistics(numaNode, numaStats)) {
+				// The node's counters cover every process on the machine; OtherNode and Foreign count cross-node pages
+				TraceEvent("NumaMetrics")
+				    .detail("Elapsed", currentStats.elapsed)
+				    .detail("Node", numaNode)
+				    .detail("LocalNodePages", numaStats.localNode - statState->numaState.localNode)
+				    .detail("OtherNodePages", numaStats.otherNode - statState->numaState.otherNode)
+				    .detail("MissPages", numaStats.numaMiss - statState->numaState.numaMiss)
+				    .detail("ForeignPages", numaStats.numaForeign - statState->numaState.numaForeign)
+				    .detail("DCID", machineState.dcId)
+				    .detail("ZoneID", machineState.zoneId)
+				    .detail("MachineID", machineState.machineId)
+				    .trackLatest("NumaMetrics");
+				statState->numaState = numaStats;
+			}
 		}
 
 		if (machineMetrics) {
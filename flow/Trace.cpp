@@ -118,6 +118,10 @@ private:
 	std::vector<TraceEventFields> eventBuffer;
 	int loggedLength;
 	int bufferLength;
+	// Bytes of events posted to the writer thread that it hasn't written yet, and the events dropped because there
+	// were too many
+	std::atomic<int64_t> pendingWriteBytes;
+	std::atomic<int64_t> droppedEventCount;
 	std::atomic<bool> opened;
 	int64_t preopenOverflowCount;
 	std::string basename;
@@ -218,14 +222,16 @@ public:
 	struct WriterThread final : IThreadPoolReceiver {
 		WriterThread(Reference<BarrierList> barriers,
 		             Reference<ITraceLogWriter> logWriter,
-		             Reference<ITraceLogFormatter> formatter)
-		  : logWriter(logWriter), formatter(formatter), barriers(barriers) {}
+		             Reference<ITraceLogFormatter> formatter,
+		             std::atomic<int64_t>* pendingWriteBytes)
+		  : logWriter(logWriter), formatter(formatter), barriers(barriers), pendingWriteBytes(pendingWriteBytes) {}
 
 		void init() override {}
 
 		Reference<ITraceLogWriter> logWriter;
 		Reference<ITraceLogFormatter> formatter;
 		Reference<BarrierList> barriers;
+		std::atomic<int64_t>* pendingWriteBytes;
 
 		struct Open final : TypedAction<WriterThread, Open> {
 			double getTimeEstimate() const override { return 0; }
@@ -259,8 +265,10 @@ public:
 
 		struct WriteBuffer final : TypedAction<WriterThread, WriteBuffer> {
 			std::vector<TraceEventFields> events;
+			int64_t bytes;
 
-			WriteBuffer(std::vector<TraceEventFields> events) : events(events) {}
+			WriteBuffer(std::vector<TraceEventFields>&& events, int64_t bytes)
+			  : events(std::move(events)), bytes(bytes) {}
 			double getTimeEstimate() const override { return .001; }
 		};
 		void action(WriteBuffer& a) {
@@ -268,6 +276,7 @@ public:
 				event.validateFormat();
 				logWriter->write(formatter->formatEvent(event));
 			}
+			pendingWriteBytes->fetch_sub(a.bytes);
 
 			if (FLOW_KNOBS->TRACE_SYNC_ENABLED) {
 				logWriter->sync();
@@ -291,8 +300,9 @@ public:
 	};
 
 	TraceLog()
-	  : formatter(new XmlTraceLogFormatter()), loggedLength(0), bufferLength(0), opened(false), preopenOverflowCount(0),
-	    logTraceEventMetrics(false), issues(new IssuesList), barriers(new BarrierList) {}
+	  : formatter(new XmlTraceLogFormatter()), loggedLength(0), bufferLength(0), pendingWriteBytes(0),
+	    droppedEventCount(0), opened(false), preopenOverflowCount(0), logTraceEventMetrics(false),
+	    issues(new IssuesList), barriers(new BarrierList) {}
 
 	bool isOpen() const { return opened; }
 
@@ -331,7 +341,7 @@ public:
 			writer = Reference<IThreadPool>(new DummyThreadPool());
 		else
 			writer = createGenericThreadPool();
-		writer->addThread(new WriterThread(barriers, logWriter, formatter), "fdb-trace-log");
+		writer->addThread(new WriterThread(barriers, logWriter, formatter, &pendingWriteBytes), "fdb-trace-log");
 
 		rollsize = rs;
 
@@ -401,10 +411,25 @@ public:
 			return;
 		}
 
+		if (trackError) {
+			latestEventCache.setLatestError(fields);
+		}
+		if (!trackLatestKey.empty()) {
+			latestEventCache.set(trackLatestKey, fields);
+		}
+
+		// Rather than queue without bound for a writer thread that can't keep up, keep only errors until it catches up.
+		// The count of dropped events is traced by the next flush.
+		if (!trackError && isOpen() && FLOW_KNOBS &&
+		    pendingWriteBytes.load(std::memory_order_relaxed) > FLOW_KNOBS->TRACE_WRITER_MAX_PENDING_BYTES) {
+			droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
 		// FIXME: What if we are using way too much memory for buffer?
 		ASSERT(!isOpen() || fields.isAnnotated());
-		eventBuffer.push_back(fields);
 		bufferLength += fields.sizeBytes();
+		eventBuffer.push_back(std::move(fields));
 
 		if (g_network && g_network->isSimulated()) {
 			// Throw an error if we have queued up a large number of events in simulation. This makes it easier to
@@ -413,7 +438,7 @@ public:
 			// identify where the process is actually stuck.
 			if (bufferLength > 1e8) {
 				fprintf(stderr, "Trace log buffer overflow\n");
-				fprintf(stderr, "Last event: %s\n", fields.toString().c_str());
+				fprintf(stderr, "Last event: %s\n", eventBuffer.back().toString().c_str());
 				// Setting this to 0 avoids a recurse from the assertion trace event and also prevents a situation where
 				// we roll the trace log only to log the single assertion event when using --crash.
 				bufferLength = 0;
@@ -423,13 +448,6 @@ public:
 				failedLineOverflow = 1; // we only want to do this once
 			}
 		}
-
-		if (trackError) {
-			latestEventCache.setLatestError(fields);
-		}
-		if (!trackLatestKey.empty()) {
-			latestEventCache.set(trackLatestKey, fields);
-		}
 	}
 
 	void logMetrics(int severity, const char* name, UID id, uint64_t event_ts) {
@@ -465,6 +483,13 @@ public:
 	ThreadFuture<Void> flush() {
 		if (TraceEvent::isNetworkThread()) {
 			traceEventThrottlerCache->poll();
+
+			const int64_t dropped = droppedEventCount.exchange(0);
+			if (dropped > 0) {
+				TraceEvent(SevWarnAlways, "TraceEventsDropped")
+				    .detail("Count", dropped)
+				    .detail("PendingWriteBytes", pendingWriteBytes.load());
+			}
 		}
 
 		MutexHolder hold(mutex);
@@ -475,7 +500,8 @@ public:
 		if (rollsize && bufferLength + loggedLength > rollsize) // SOMEDAY: more conditions to roll
 			roll = true;
 
-		auto a = new WriterThread::WriteBuffer(std::move(eventBuffer));
+		auto a = new WriterThread::WriteBuffer(std::move(eventBuffer), bufferLength);
+		pendingWriteBytes += bufferLength;
 		loggedLength += bufferLength;
 		eventBuffer = std::vector<TraceEventFields>();
 		bufferLength = 0;
@@ -526,7 +552,8 @@ public:
 				MutexHolder hold(mutex);
 
 				// Write remaining contents
-				auto a = new WriterThread::WriteBuffer(std::move(eventBuffer));
+				auto a = new WriterThread::WriteBuffer(std::move(eventBuffer), bufferLength);
+				pendingWriteBytes += bufferLength;
 				loggedLength += bufferLength;
 				eventBuffer = std::vector<TraceEventFields>();
 				bufferLength = 0;
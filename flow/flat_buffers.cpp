@@ -99,6 +99,21 @@ TEST_CASE("flow/FlatBuffers/test") {
 	return Void();
 }
 
+TEST_CASE("flow/FlatBuffers/vtableLayout") {
+	// The layout computed at compile time matches the one the wire format was defined with
+	auto check = [](auto layout, std::vector<unsigned> sizesAndAlignments) {
+		detail::VTable expected = detail::generate_vtable(sizesAndAlignments.size() / 2, sizesAndAlignments);
+		ASSERT(detail::VTable(layout.begin(), layout.end()) == expected);
+	};
+	check(detail::vtable_layout<>(), {});
+	check(detail::vtable_layout<int>(), { 4, 4 });
+	check(detail::vtable_layout<uint8_t, uint8_t, int, int64_t, int>(), { 1, 1, 4, 8, 4, 1, 1, 4, 8, 4 });
+	check(detail::vtable_layout<bool, std::string, double, Void, int16_t, std::array<uint8_t, 3>>(),
+	      { 1, 4, 8, 0, 2, 3, 1, 4, 8, 0, 2, 1 });
+	static_assert(detail::vtable_layout<uint8_t, int64_t>()[1] == 4 + 8 + 1);
+	return Void();
+}
+
 TEST_CASE("flow/FlatBuffers/emptyVtable") {
 	auto* vtable = detail::get_vtable<>();
 	ASSERT((*vtable)[0] == 4);
@@ -510,6 +525,24 @@ TEST_CASE("/flow/FlatBuffers/Standalone") {
 	return Void();
 }
 
+TEST_CASE("/flow/FlatBuffers/ZeroCopyFromStringRef") {
+	Standalone<VectorRef<StringRef>> in;
+	for (int i = 0; i < 10; ++i) {
+		in.push_back_deep(in.arena(), StringRef(deterministicRandom()->randomAlphaNumeric(100)));
+	}
+	Standalone<StringRef> value = ObjectWriter::toValue(in, Unversioned());
+	auto out = ArenaObjectReader::fromStringRef<Standalone<VectorRef<StringRef>>>(value, Unversioned());
+	ASSERT(out.size() == in.size());
+	for (int i = 0; i < out.size(); ++i) {
+		ASSERT(out[i] == in[i]);
+		// The strings weren't copied, and stay valid for as long as out does
+		ASSERT(out[i].begin() >= value.begin() && out[i].end() <= value.end());
+	}
+	value = Standalone<StringRef>();
+	ASSERT(out[0] == in[0]);
+	return Void();
+}
+
 // Meant to be run with valgrind or asan, to catch heap buffer overflows
 TEST_CASE("/flow/FlatBuffers/Void") {
 	Standalone<StringRef> msg = ObjectWriter::toValue(Void(), Unversioned());
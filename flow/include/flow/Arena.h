@@ -34,6 +34,7 @@
 #include "flow/Traceable.h"
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <boost/functional/hash.hpp>
 #include <iterator>
 #include <stdint.h>
@@ -96,6 +97,7 @@ protected:
 };
 
 FDB_BOOLEAN_PARAM(FastInaccurateEstimate);
+FDB_BOOLEAN_PARAM(FromPageSlab);
 
 // Tag struct to indicate that the block containing allocated memory needs to be zero-ed out after use
 struct WipeAfterUse {};
@@ -116,7 +118,8 @@ public:
 	Arena& operator=(Arena&&) noexcept;
 
 	void dependsOn(const Arena& p);
-	void* allocate4kAlignedBuffer(uint32_t size);
+	// If fromPageSlab is true the buffer is a PageSlab slot when there is a free one of its size
+	void* allocate4kAlignedBuffer(uint32_t size, FromPageSlab fromPageSlab = FromPageSlab::False);
 
 	// If fastInaccurateEstimate is true this operation is O(1) but it is inaccurate in that it
 	// will omit memory added to this Arena's block tree using Arena handles which reference
@@ -138,6 +141,23 @@ private:
 	Reference<struct ArenaBlock> impl;
 };
 
+// Learns the typical final size of the arenas created at one call site, so that they can start with one block of about
+// that size instead of growing through several. A call site opts in by keeping a (usually static) profile, creating
+// its arenas with create() and passing each one to observe() once it is filled. The estimate follows increases at once
+// and decreases slowly, so an occasional small arena doesn't make the next large one grow again.
+class ArenaSizeProfile {
+public:
+	// Arenas larger than this only contribute this much to the estimate
+	static constexpr size_t MAX_RESERVED_SIZE = 1 << 20;
+
+	Arena create() const { return Arena(reservedSize()); }
+	void observe(const Arena& arena);
+	size_t reservedSize() const { return estimate.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<size_t> estimate = 0;
+};
+
 template <>
 struct scalar_traits<Arena> : std::true_type {
 	constexpr static size_t size = 0;
@@ -198,9 +218,9 @@ struct ArenaBlock : NonCopyable, ThreadSafeReferenceCounted<ArenaBlock> {
 	void getUniqueBlocks(std::set<ArenaBlock*>& a);
 	int addUsed(int bytes);
 	void makeReference(ArenaBlock* next);
-	void* make4kAlignedBuffer(uint32_t size);
+	void* make4kAlignedBuffer(uint32_t size, FromPageSlab fromPageSlab);
 	static void dependOn(Reference<ArenaBlock>& self, ArenaBlock* other);
-	static void* dependOn4kAlignedBuffer(Reference<ArenaBlock>& self, uint32_t size);
+	static void* dependOn4kAlignedBuffer(Reference<ArenaBlock>& self, uint32_t size, FromPageSlab fromPageSlab);
 	static void* allocate(Reference<ArenaBlock>& self, int bytes, IsSecureMem isSecure = IsSecureMem::False);
 	// Return an appropriately-sized ArenaBlock to store the given data
 	static ArenaBlock* create(int dataSize, Reference<ArenaBlock>& next);
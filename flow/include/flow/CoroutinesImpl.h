@@ -87,6 +87,67 @@ struct GetFutureType<FutureStream<T> const&> {
 template <class F>
 inline constexpr FutureType GetFutureTypeV = GetFutureType<F>::value;
 
+// Coroutine frames are allocated with the size the compiler computed for the coroutine, which is the same for every
+// call of it, so frames up to 8192 bytes are taken from the FastAllocator of their size class and reused like actors
+// are. allocateFast() only does this up to 256 bytes, which is smaller than the frame of most coroutines that wait.
+[[nodiscard]] inline void* allocateFrame(size_t size) {
+	if (size > 8192)
+		return new uint8_t[size];
+	switch (nextFastAllocatedSize(size)) {
+	case 16:
+		return FastAllocator<16>::allocate();
+	case 32:
+		return FastAllocator<32>::allocate();
+	case 64:
+		return FastAllocator<64>::allocate();
+	case 96:
+		return FastAllocator<96>::allocate();
+	case 128:
+		return FastAllocator<128>::allocate();
+	case 256:
+		return FastAllocator<256>::allocate();
+	case 512:
+		return FastAllocator<512>::allocate();
+	case 1024:
+		return FastAllocator<1024>::allocate();
+	case 2048:
+		return FastAllocator<2048>::allocate();
+	case 4096:
+		return FastAllocator<4096>::allocate();
+	default:
+		return FastAllocator<8192>::allocate();
+	}
+}
+
+inline void freeFrame(void* ptr, size_t size) {
+	if (size > 8192)
+		return delete[] (uint8_t*)ptr;
+	switch (nextFastAllocatedSize(size)) {
+	case 16:
+		return FastAllocator<16>::release(ptr);
+	case 32:
+		return FastAllocator<32>::release(ptr);
+	case 64:
+		return FastAllocator<64>::release(ptr);
+	case 96:
+		return FastAllocator<96>::release(ptr);
+	case 128:
+		return FastAllocator<128>::release(ptr);
+	case 256:
+		return FastAllocator<256>::release(ptr);
+	case 512:
+		return FastAllocator<512>::release(ptr);
+	case 1024:
+		return FastAllocator<1024>::release(ptr);
+	case 2048:
+		return FastAllocator<2048>::release(ptr);
+	case 4096:
+		return FastAllocator<4096>::release(ptr);
+	default:
+		return FastAllocator<8192>::release(ptr);
+	}
+}
+
 template <class T, bool IsCancellable>
 struct CoroActor final : Actor<std::conditional_t<std::is_void_v<T>, Void, T>> {
 	using ValType = std::conditional_t<std::is_void_v<T>, Void, T>;
@@ -316,8 +377,8 @@ struct CoroPromise : CoroReturn<T, CoroPromise<T, IsCancellable>> {
 		return n_coroutine::coroutine_handle<promise_type>::from_promise(*this);
 	}
 
-	static void* operator new(size_t s) { return allocateFast(int(s)); }
-	static void operator delete(void* p, size_t s) { freeFast(int(s), p); }
+	static void* operator new(size_t s) { return allocateFrame(s); }
+	static void operator delete(void* p, size_t s) { freeFrame(p, s); }
 
 	ReturnFutureType get_return_object() noexcept { return ReturnFutureType(coroActor); }
 
@@ -378,8 +439,8 @@ struct CoroPromise : CoroReturn<T, CoroPromise<T, IsCancellable>> {
 template <class T>
 struct GeneratorPromise {
 	using handle_type = n_coroutine::coroutine_handle<GeneratorPromise<T>>;
-	static void* operator new(size_t s) { return allocateFast(int(s)); }
-	static void operator delete(void* p, size_t s) { freeFast(int(s), p); }
+	static void* operator new(size_t s) { return allocateFrame(s); }
+	static void operator delete(void* p, size_t s) { freeFrame(p, s); }
 
 	Error error;
 	std::optional<T> value;
@@ -422,8 +483,8 @@ template <class T>
 struct AsyncGeneratorPromise {
 	using promise_type = AsyncGeneratorPromise<T>;
 
-	static void* operator new(size_t s) { return allocateFast(int(s)); }
-	static void operator delete(void* p, size_t s) { freeFast(int(s), p); }
+	static void* operator new(size_t s) { return allocateFrame(s); }
+	static void operator delete(void* p, size_t s) { freeFrame(p, s); }
 
 	n_coroutine::coroutine_handle<promise_type> handle() {
 		return n_coroutine::coroutine_handle<promise_type>::from_promise(*this);
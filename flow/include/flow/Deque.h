@@ -133,6 +133,19 @@ public:
 		return result;
 	}
 
+	template <class... U>
+	reference emplace_front(U&&... val) {
+		if (full())
+			grow();
+		if (begin == 0) {
+			begin += mask;
+			end += mask + 1;
+		} else
+			begin--;
+		new (&arr[begin]) T(std::forward<U>(val)...);
+		return arr[begin];
+	}
+
 	void pop_back() {
 		ASSERT(!empty());
 		end--;
@@ -103,6 +103,8 @@ void recordDeallocation(void* ptr);
 #endif
 
 inline constexpr auto kFastAllocMagazineBytes = 128 << 10;
+// With FAST_ALLOC_HUGE_PAGES, memory is taken from the system in chunks of this many bytes, each split into magazines
+inline constexpr auto kFastAllocHugeChunkBytes = 2 << 20;
 
 template <int Size>
 class FastAllocator {
@@ -169,13 +171,49 @@ private:
 
 	static void getMagazine();
 	static void releaseMagazine(void*);
+	static void* allocateHugeChunk();
 };
 
 extern std::atomic<int64_t> g_hugeArenaMemory;
+extern std::atomic<int64_t> g_fastAllocHugeChunkMemory;
 void hugeArenaSample(int size);
 void releaseAllThreadMagazines();
 int64_t getTotalUnusedAllocatedMemory();
 
+// A region of memory reserved once per process, backed by huge pages where the system allows, and carved into
+// 4k-aligned slots of a single size for buffers with long and unpredictable lifetimes such as cached storage engine
+// pages. Slots are handed out and returned through a lock-free free list, so the region does not fragment and the
+// memory it holds stays the same however its buffers churn. Slot memory is never returned to the system.
+class PageSlab {
+public:
+	// Reserves bytes, rounded up to whole huge pages, of slots of slotSize, a multiple of 4096.  Only the first
+	// successful call has an effect.  Returns whether the slab is reserved with slotSize.
+	static bool reserve(int64_t bytes, int slotSize);
+
+	// Returns a free slot if size is the slot size, otherwise or if no slot is free returns nullptr
+	static void* allocate(int size);
+
+	// Returns whether ptr is in a slot, which must be freed with release()
+	static bool owns(const void* ptr) {
+		// regionBegin is set before regionEnd, so it is seen whenever regionEnd is
+		auto p = (const uint8_t*)ptr;
+		return p < regionEnd.load(std::memory_order_acquire) && p >= regionBegin.load(std::memory_order_relaxed);
+	}
+	static void release(void* ptr);
+
+	static int getSlotSize();
+	static bool usesHugePages();
+	static int64_t getTotalMemory();
+	// Memory in slots handed out and not yet returned
+	static int64_t getUsedMemory();
+	// Memory in slots ever handed out, which is all the slab's memory that can be resident
+	static int64_t getTouchedMemory();
+
+private:
+	static std::atomic<const uint8_t*> regionBegin;
+	static std::atomic<const uint8_t*> regionEnd;
+};
+
 // Allow temporary overriding of default allocators used by arena to let memory survive deallocation and test
 // correctness of memory policy (e.g. zeroing out sensitive contents after use)
 namespace keepalive_allocator {
@@ -332,8 +370,11 @@ inline void freeFast(int size, void* ptr) {
 	return result;
 }
 
-// Free a pointer returned from allocateFast4kAligned(size)
+// Free a pointer returned from allocateFast4kAligned(size) or PageSlab::allocate(size)
 inline void freeFast4kAligned(int size, void* ptr) {
+	if (PageSlab::owns(ptr)) {
+		return PageSlab::release(ptr);
+	}
 #if !defined(USE_JEMALLOC)
 	// Sizes supported by FastAllocator must be release via FastAllocator
 	if (size <= 4096)
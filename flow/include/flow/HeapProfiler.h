@@ -0,0 +1,91 @@
+/*
+ * HeapProfiler.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLOW_HEAP_PROFILER_H
+#define FLOW_HEAP_PROFILER_H
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A sampling profiler of the memory FastAllocator and arena blocks hand out, which unlike ALLOC_INSTRUMENTATION can be
+// turned on in any build. Each thread samples the allocation which crosses each multiple of the sample bytes it has
+// allocated, recording its backtrace and the role of the running actor, and counts it as holding the sample bytes for
+// each multiple it crosses until it is released. Sampled allocations are told apart when released by a counting filter
+// on their addresses, so that while some are live, releasing one which isn't sampled only reads a byte of the filter.
+namespace heap_profiler {
+
+// The live sampled allocations of one backtrace and role
+struct Site {
+	std::string role; // Empty if unknown
+	std::vector<void*> backtrace;
+	int64_t liveSamples = 0;
+	int64_t liveBytes = 0; // Estimated from the samples
+	int64_t allocatedBytes = 0; // Estimated from the samples, including those since released
+};
+
+// 0 stops sampling. Allocations already sampled are tracked until they are released.
+void setSampleBytes(int64_t bytes);
+int64_t getSampleBytes();
+
+// Returns the role of the running actor, or nullptr, as a string which stays valid. It is called on whatever thread
+// makes a sampled allocation.
+using RoleFunction = const char* (*)();
+// Returns the previous role function
+RoleFunction setRoleFunction(RoleFunction f);
+
+// The sites with live samples, by decreasing live bytes
+std::vector<Site> getLiveSites();
+
+namespace detail {
+constexpr int filterBits = 16;
+
+extern std::atomic<int64_t> sampleBytes;
+extern std::atomic<int64_t> liveSamples;
+extern std::atomic<uint8_t> filter[1 << filterBits];
+extern constinit thread_local int64_t untilSample;
+
+void sample(void* ptr, size_t size);
+void release(void* ptr);
+
+inline int filterSlot(const void* ptr) {
+	return (reinterpret_cast<uintptr_t>(ptr) * uint64_t(0x9E3779B97F4A7C15)) >> (64 - filterBits);
+}
+} // namespace detail
+
+inline void onAllocate(void* ptr, size_t size) {
+	if (detail::sampleBytes.load(std::memory_order_relaxed) > 0 && (detail::untilSample -= size) <= 0) [[unlikely]] {
+		detail::sample(ptr, size);
+	}
+}
+
+inline void onRelease(void* ptr) {
+	if (detail::liveSamples.load(std::memory_order_relaxed) > 0 &&
+	    detail::filter[detail::filterSlot(ptr)].load(std::memory_order_relaxed) > 0) [[unlikely]] {
+		detail::release(ptr);
+	}
+}
+
+} // namespace heap_profiler
+
+#endif
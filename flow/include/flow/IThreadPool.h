@@ -146,6 +146,11 @@ private:
 
 Reference<IThreadPool> createGenericThreadPool(int stackSize = 0, int pri = 10);
 
+// A drop-in alternative to createGenericThreadPool for pools whose receivers can all run any action posted to the pool.
+// Each thread has its own queue, and takes actions from the others' when its own is empty, instead of all threads
+// contending for one queue. The number of actions posted and stolen is traced when the pool stops.
+Reference<IThreadPool> createWorkStealingThreadPool(int stackSize = 0, int pri = 10);
+
 class DummyThreadPool final : public IThreadPool, ReferenceCounted<DummyThreadPool> {
 public:
 	~DummyThreadPool() override {}
@@ -131,8 +131,11 @@ public:
 
 	double FAST_ALLOC_LOGGING_BYTES;
 	bool FAST_ALLOC_ALLOW_GUARD_PAGES;
+	bool FAST_ALLOC_HUGE_PAGES; // Take FastAllocator memory from the system in huge page sized chunks
 	double HUGE_ARENA_LOGGING_BYTES;
 	double HUGE_ARENA_LOGGING_INTERVAL;
+	int ARENA_RECYCLED_BLOCKS; // Freed arena blocks of each size from 512 bytes to 64KB that a thread keeps for reuse
+	int64_t HEAP_PROFILE_SAMPLE_BYTES; // Every how many bytes FastAllocator and arena blocks hand out one is sampled
 	// This setting allows to let the fdbserver abort instead of exit to generate coredumps
 	// in case of a failure.
 	bool ABORT_ON_FAILURE;
@@ -147,6 +150,13 @@ public:
 	double TRACING_SAMPLE_RATE;
 	std::string TRACING_UDP_LISTENER_ADDR;
 	int TRACING_UDP_LISTENER_PORT;
+	int TRACING_BATCH_SPANS;
+	double TRACING_BATCH_INTERVAL;
+	int TRACING_MAX_PENDING_BATCHES;
+	bool TRACING_TAIL_SAMPLING;
+	double TRACING_TAIL_LATENCY;
+	double TRACING_TAIL_BUFFER_TIME;
+	int TRACING_TAIL_MAX_PENDING_SPANS;
 
 	// Metrics
 	std::string METRICS_DATA_MODEL;
@@ -156,6 +166,7 @@ public:
 	int STATSD_UDP_EMISSION_PORT;
 	int OTEL_UDP_EMISSION_PORT;
 	bool METRICS_EMIT_DDSKETCH;
+	int METRICS_PROMETHEUS_PORT;
 
 	// run loop profiling
 	double RUN_LOOP_PROFILING_INTERVAL;
@@ -166,6 +177,9 @@ public:
 	double SATURATION_PROFILING_LOG_INTERVAL;
 	double SATURATION_PROFILING_MAX_LOG_INTERVAL;
 	double SATURATION_PROFILING_LOG_BACKOFF;
+	double CPU_SAMPLER_PERIOD;
+	double CPU_SAMPLER_REPORT_INTERVAL;
+	int CPU_SAMPLER_TOP_ENTRIES;
 
 	// connectionMonitor
 	double CONNECTION_MONITOR_LOOP_TIME;
@@ -187,6 +201,9 @@ public:
 	double INCOMPATIBLE_PEER_DELAY_BEFORE_LOGGING;
 	double PING_LOGGING_INTERVAL;
 	double PING_SKETCH_ACCURACY;
+	int RPC_LATENCY_SAMPLE_INTERVAL; // One in this many messages received has its latency sampled, or none if 0
+	double RPC_LATENCY_LOGGING_INTERVAL;
+	int RPC_LATENCY_STATUS_TYPES; // The most common message types whose latencies are reported in status
 
 	int TLS_CERT_REFRESH_DELAY_SECONDS;
 	double TLS_SERVER_CONNECTION_THROTTLE_TIMEOUT;
@@ -196,6 +213,8 @@ public:
 	int TLS_CLIENT_HANDSHAKE_THREADS;
 	int TLS_SERVER_HANDSHAKE_THREADS;
 	int TLS_HANDSHAKE_THREAD_STACKSIZE;
+	int TLS_RECORD_THREADS; // Threads encrypting large TLS writes off the network thread, or 0 to not
+	int TLS_RECORD_OFFLOAD_BYTES; // The smallest write encrypted on a TLS record thread
 	int TLS_MALLOC_ARENA_MAX;
 	int TLS_HANDSHAKE_LIMIT;
 
@@ -222,13 +241,16 @@ public:
 	int64_t BUGGIFY_SIM_PAGE_CACHE_4K;
 	int64_t BUGGIFY_SIM_PAGE_CACHE_64K;
 	int64_t BLOB_WORKER_PAGE_CACHE;
-	std::string CACHE_EVICTION_POLICY; // for now, "random", "lru", are supported
+	int64_t TLOG_PAGE_CACHE; // Of the TLog's spilled data store, for engines with their own page cache
+	std::string CACHE_EVICTION_POLICY; // for now, "random", "lru" and "slru" are supported
+	double PAGE_CACHE_PROTECTED_FRACTION;
 	int MAX_EVICT_ATTEMPTS;
 	double PAGE_CACHE_TRUNCATE_LOOKUP_FRACTION;
 	double TOO_MANY_CONNECTIONS_CLOSED_RESET_DELAY;
 	int TOO_MANY_CONNECTIONS_CLOSED_TIMEOUT;
 	int PEER_UNAVAILABLE_FOR_LONG_TIME_TIMEOUT;
 	int FLOW_CACHEDFILE_WRITE_IO_SIZE;
+	int FLOW_CACHEDFILE_PREFETCH_PAGES; // Pages read ahead of a sequential read that misses the page cache
 
 	// AsyncFileEIO
 	int EIO_MAX_PARALLELISM;
@@ -248,6 +270,10 @@ public:
 	int PAGE_WRITE_CHECKSUM_HISTORY;
 	int DISABLE_POSIX_KERNEL_AIO;
 
+	// AsyncFileIOUring
+	int USE_IO_URING; // Use io_uring instead of kernel AIO for unbuffered files, if the kernel supports it
+	int IO_URING_QUEUE_DEPTH;
+
 	// AsyncFileNonDurable
 	double NON_DURABLE_MAX_WRITE_DELAY;
 	double MAX_PRIOR_MODIFICATION_DELAY;
@@ -275,6 +301,8 @@ public:
 	// Net2
 	double MIN_COALESCE_DELAY;
 	double MAX_COALESCE_DELAY;
+	double MAX_ADAPTIVE_COALESCE_DELAY; // Writes to a busy connection are delayed up to this long while they are small
+	int COALESCE_TARGET_BYTES; // Writes smaller than this make the adaptive coalesce delay grow
 	double SLOW_LOOP_CUTOFF;
 	double SLOW_LOOP_SAMPLING_RATE;
 	int64_t TSC_YIELD_TIME;
@@ -283,10 +311,13 @@ public:
 	int CERT_FILE_MAX_SIZE;
 	int READY_QUEUE_RESERVED_SIZE;
 	int TASKS_PER_REACTOR_CHECK;
+	int READY_WAIT_SAMPLE_INTERVAL;
 
 	// Network
 	int64_t PACKET_LIMIT;
 	int64_t PACKET_WARNING; // 2MB packet warning quietly allows for 1MB system messages
+	int PACKET_COMPRESSION_THRESHOLD;
+	int PACKET_COMPRESSION_LEVEL;
 	double TIME_OFFSET_LOGGING_INTERVAL;
 	int MAX_PACKET_SEND_BYTES;
 	int MIN_PACKET_BUFFER_BYTES;
@@ -319,6 +350,7 @@ public:
 	int MAX_TRACE_SUPPRESSIONS;
 	bool TRACE_DATETIME_ENABLED;
 	int TRACE_SYNC_ENABLED;
+	int64_t TRACE_WRITER_MAX_PENDING_BYTES;
 	int TRACE_EVENT_METRIC_UNITS_PER_SAMPLE;
 	int TRACE_EVENT_THROTTLER_SAMPLE_EXPIRY;
 	int TRACE_EVENT_THROTTLER_MSG_LIMIT;
@@ -338,6 +370,7 @@ public:
 	// Load Balancing
 	int LOAD_BALANCE_ZONE_ID_LOCALITY_ENABLED;
 	int LOAD_BALANCE_DC_ID_LOCALITY_ENABLED;
+	double LOAD_BALANCE_ZONE_SPILLOVER_LATENCY;
 	double LOAD_BALANCE_MAX_BACKOFF;
 	double LOAD_BALANCE_START_BACKOFF;
 	double LOAD_BALANCE_BACKOFF_RATE;
@@ -348,6 +381,7 @@ public:
 	double SECOND_REQUEST_MULTIPLIER_DECAY;
 	double SECOND_REQUEST_BUDGET_GROWTH;
 	double SECOND_REQUEST_MAX_BUDGET;
+	double LOAD_BALANCE_HEDGE_PERCENTILE;
 	double ALTERNATIVES_FAILURE_RESET_TIME;
 	double ALTERNATIVES_FAILURE_MIN_DELAY;
 	double ALTERNATIVES_FAILURE_DELAY_RATIO;
@@ -360,6 +394,8 @@ public:
 	double FUTURE_VERSION_BACKOFF_GROWTH;
 	int LOAD_BALANCE_MAX_BAD_OPTIONS;
 	bool LOAD_BALANCE_PENALTY_IS_BAD;
+	int64_t LOAD_BALANCE_LAGGING_REPLICA_VERSIONS;
+	double LOAD_BALANCE_LAGGING_REPLICA_TIME;
 	double BASIC_LOAD_BALANCE_UPDATE_RATE;
 	double BASIC_LOAD_BALANCE_MAX_CHANGE;
 	double BASIC_LOAD_BALANCE_MAX_PROB;
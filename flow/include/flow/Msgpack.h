@@ -113,6 +113,34 @@ inline void serialize_string(const std::string& str, MsgpackBuffer& buf) {
 	serialize_string(reinterpret_cast<const uint8_t*>(str.data()), str.size(), buf);
 }
 
+// Writes the header of an array of size elements, which the caller writes next
+inline void serialize_array_header(size_t size, MsgpackBuffer& buf) {
+	if (size <= 15) {
+		buf.write_byte(static_cast<uint8_t>(size) | 0b10010000);
+	} else if (size <= 65535) {
+		buf.write_byte(0xdc);
+		buf.write_byte(reinterpret_cast<const uint8_t*>(&size)[1]);
+		buf.write_byte(reinterpret_cast<const uint8_t*>(&size)[0]);
+	} else {
+		TraceEvent(SevWarn, "MsgPackSerializeArray").detail("Failed to MessagePack encode large array", size);
+		ASSERT_WE_THINK(false);
+	}
+}
+
+// Writes the header of a map of size key/value pairs, which the caller writes next
+inline void serialize_map_header(size_t size, MsgpackBuffer& buf) {
+	if (size <= 15) {
+		buf.write_byte(static_cast<uint8_t>(size) | 0b10000000);
+	} else if (size <= 65535) {
+		buf.write_byte(0xde);
+		buf.write_byte(reinterpret_cast<const uint8_t*>(&size)[1]);
+		buf.write_byte(reinterpret_cast<const uint8_t*>(&size)[0]);
+	} else {
+		TraceEvent(SevWarn, "MsgPackSerializeMap").detail("Failed to MessagePack encode large map", size);
+		ASSERT_WE_THINK(false);
+	}
+}
+
 template <typename T, typename F>
 inline void serialize_vector(const std::vector<T>& vec, MsgpackBuffer& buf, F f) {
 	size_t size = vec.size();
@@ -147,6 +147,16 @@ public:
 		vo.read(*this);
 	}
 
+	// Unlike ObjectReader::fromStringRef, the strings and byte vectors of the result point into sr instead of being
+	// copied, and the result keeps sr's arena alive through its own arena members.
+	template <class T, class VersionOptions>
+	static T fromStringRef(Standalone<StringRef> const& sr, VersionOptions vo) {
+		T t;
+		ArenaObjectReader reader(sr.arena(), sr, vo);
+		reader.deserialize(t);
+		return t;
+	}
+
 	const uint8_t* data() { return _data; }
 
 	Arena& arena() { return _arena; }
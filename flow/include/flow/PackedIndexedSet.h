@@ -0,0 +1,265 @@
+/*
+ * PackedIndexedSet.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLOW_PACKEDINDEXEDSET_H
+#define FLOW_PACKEDINDEXEDSET_H
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+#include "flow/Arena.h"
+
+// PackedIndexedSet is a set of StringRef keys, each associated with an int64_t metric, with the interface of
+// IndexedSet<Key, int64_t> used by storage metric samples: sumTo(), sumRange() and index() take O(lg N) time.
+//
+// IndexedSet allocates a tree node and a separate copy of the key for every item, which for small keys is several
+// times the size of the key itself. PackedIndexedSet is a B+tree instead. Each leaf holds up to LeafCapacity items,
+// with their keys packed back to back into a single buffer and their metrics in an array, and each node keeps the sum
+// of the metrics below it. Items inserted in ascending order, e.g. when loading a persisted sample, fill leaves
+// completely rather than splitting them in half.
+//
+// Unlike IndexedSet, iterators and the keys they point to are invalidated by any change to the set.
+class PackedIndexedSet {
+public:
+	static constexpr int LeafCapacity = 64;
+	static constexpr int InternalCapacity = 32;
+	// A leaf holding at least two items is split rather than grow its key buffer beyond this size
+	static constexpr int LeafKeyBytes = 4096;
+
+private:
+	// Keys packed back to back into a buffer, which are the items of a leaf or the separators of an internal node
+	template <int Capacity>
+	struct PackedKeys {
+		int count = 0;
+		int capacity = 0; // bytes allocated for data
+		uint8_t* data = nullptr;
+		uint32_t ends[Capacity]; // key i is data[begin(i), ends[i])
+
+		PackedKeys() = default;
+		PackedKeys(const PackedKeys&) = delete;
+		PackedKeys& operator=(const PackedKeys&) = delete;
+		~PackedKeys() { delete[] data; }
+
+		int begin(int i) const { return i ? ends[i - 1] : 0; }
+		int bytes() const { return begin(count); }
+		StringRef operator[](int i) const { return StringRef(data + begin(i), ends[i] - begin(i)); }
+
+		// Returns the first i such that (*this)[i] >= key, or count
+		int lowerBound(StringRef key) const;
+		// Returns the first i such that (*this)[i] > key, or count
+		int upperBound(StringRef key) const;
+
+		void insert(int i, StringRef key);
+		// Removes keys [b, e)
+		void erase(int b, int e);
+		// Appends keys [b, e) of other
+		void append(const PackedKeys& other, int b, int e);
+		// Reallocates data to hold bytes bytes, or at least the keys in it
+		void resize(int bytes);
+	};
+
+	struct Internal;
+
+	struct Node {
+		Internal* parent = nullptr;
+		int64_t total = 0; // Sum of the metrics of the items below this node
+		const bool isLeaf;
+
+		explicit Node(bool isLeaf) : isLeaf(isLeaf) {}
+	};
+
+	struct Leaf : Node {
+		Leaf* prev = nullptr;
+		Leaf* next = nullptr;
+		PackedKeys<LeafCapacity> keys;
+		int64_t metrics[LeafCapacity];
+
+		Leaf() : Node(true) {}
+		int count() const { return keys.count; }
+	};
+
+	struct Internal : Node {
+		// The separator of child i > 0 is no greater than any key below it and greater than any key below child i-1.
+		// The separator of child 0 is empty.
+		PackedKeys<InternalCapacity> separators;
+		Node* children[InternalCapacity];
+
+		Internal() : Node(false) {}
+		int count() const { return separators.count; }
+		int indexOf(const Node* child) const;
+	};
+
+public:
+	class const_iterator {
+	public:
+		const_iterator() : leaf(nullptr), index(0) {}
+
+		StringRef operator*() const { return leaf->keys[index]; }
+
+		void operator++() {
+			if (++index == leaf->count()) {
+				leaf = leaf->next;
+				index = 0;
+			}
+		}
+		void decrementNonEnd() {
+			if (index-- == 0) {
+				leaf = leaf->prev;
+				index = leaf->count() - 1;
+			}
+		}
+
+		bool operator==(const const_iterator& r) const { return leaf == r.leaf && index == r.index; }
+		bool operator!=(const const_iterator& r) const { return !(*this == r); }
+
+	private:
+		friend class PackedIndexedSet;
+		const Leaf* leaf;
+		int index;
+
+		const_iterator(const Leaf* leaf, int index) : leaf(leaf), index(index) {}
+	};
+	using iterator = const_iterator;
+
+	PackedIndexedSet();
+	~PackedIndexedSet();
+	PackedIndexedSet(PackedIndexedSet&& r) noexcept;
+	PackedIndexedSet& operator=(PackedIndexedSet&& r) noexcept;
+	PackedIndexedSet(const PackedIndexedSet&) = delete;
+	PackedIndexedSet& operator=(const PackedIndexedSet&) = delete;
+
+	const_iterator begin() const { return first->count() ? const_iterator(first, 0) : end(); }
+	const_iterator end() const { return const_iterator(); }
+
+	bool empty() const { return !first->count(); }
+	void clear();
+
+	// Places key in the set with the given metric. If key is already in the set and replaceExisting is true, its
+	// metric is replaced.
+	const_iterator insert(StringRef key, int64_t metric, bool replaceExisting = true);
+
+	// Adds metric to the metric of key, inserting key if it isn't in the set. Returns the new metric and the item.
+	std::pair<int64_t, const_iterator> addMetric(StringRef key, int64_t metric);
+
+	// Erases the indicated item. No effect if item == end().
+	void erase(const_iterator item);
+	// Erases the items in [begin, end)
+	void erase(const_iterator begin, const_iterator end);
+	// Erases all keys x for which begin <= x < end. Whole leaves are freed at once, so unlike IndexedSet this doesn't
+	// need to be done asynchronously for large ranges.
+	void erase(StringRef begin, StringRef end) { erase(lower_bound(begin), lower_bound(end)); }
+
+	// Returns x such that key == *x, or end()
+	const_iterator find(StringRef key) const;
+	// Returns the smallest x such that *x >= key, or end()
+	const_iterator lower_bound(StringRef key) const;
+	// Returns the smallest x such that *x > key, or end()
+	const_iterator upper_bound(StringRef key) const;
+
+	// Returns the smallest x such that sumTo(x+1) > metric, or end()
+	template <class M>
+	const_iterator index(M metric) const;
+
+	// Returns the metric inserted with item x
+	int64_t getMetric(const_iterator x) const { return x.leaf->metrics[x.index]; }
+
+	// Returns the sum of getMetric(x) for begin() <= x < to
+	int64_t sumTo(const_iterator to) const;
+
+	// Returns the sum of getMetric(x) for begin <= x < end
+	int64_t sumRange(const_iterator begin, const_iterator end) const { return sumTo(end) - sumTo(begin); }
+	// Returns the sum of getMetric(x) for all x such that begin <= *x && *x < end
+	int64_t sumRange(StringRef begin, StringRef end) const { return sumRange(lower_bound(begin), lower_bound(end)); }
+
+	// Returns the bytes allocated by the set, in O(N / LeafCapacity) time
+	int64_t getBytes() const;
+
+	// Checks the invariants of the tree, for tests
+	void testonly_assertValid() const;
+
+private:
+	Node* root;
+	Leaf* first; // The leftmost leaf, which is the root if the set is empty
+
+	Leaf* findLeaf(StringRef key) const;
+	// Returns the iterator at position index of leaf, which may be leaf->count()
+	static const_iterator normalize(const Leaf* leaf, int index);
+	static void addToTotals(Node* node, int64_t delta);
+	static void free(Node* node);
+	static int64_t getBytes(const Node* node);
+
+	// Removes items [b, e) of leaf, leaving it in the tree
+	static void eraseItems(Leaf* leaf, int b, int e);
+	// Makes the root the only child of a new root
+	void growRoot();
+	// Moves the items of leaf from position at on into a new leaf following it. The separator of the new leaf is its
+	// first key, or separator if it has no items.
+	void splitLeaf(Leaf* leaf, int at, StringRef separator);
+	// Inserts child after the child prev of parent, with the given separator, splitting parent if it is full
+	void insertChild(Internal* parent, Node* prev, Node* child, StringRef separator);
+	// Removes leaf, which has no items, from the tree
+	void removeLeaf(Leaf* leaf);
+	// Removes child i of parent, without freeing it
+	void removeChild(Internal* parent, int i);
+	// Merges leaf with a sibling if it has too few items
+	void mergeLeaf(Leaf* leaf);
+	// Merges node, which has too few children, with a sibling, and removes node if it has no children
+	void mergeInternal(Internal* node);
+	void collapseRoot();
+
+	// Checks the subtree of node, whose keys are >= lower and < *upper if upper isn't null, and returns its total
+	int64_t testonly_assertValid(const Node* node,
+	                             StringRef lower,
+	                             const StringRef* upper,
+	                             int depth,
+	                             int& leafDepth,
+	                             const Leaf*& prevLeaf) const;
+};
+
+template <class M>
+PackedIndexedSet::const_iterator PackedIndexedSet::index(M metric) const {
+	M m = metric;
+	const Node* node = root;
+	while (!node->isLeaf) {
+		const Internal* n = static_cast<const Internal*>(node);
+		int i = 0;
+		for (; i < n->count() - 1; ++i) {
+			if (m < n->children[i]->total) {
+				break;
+			}
+			m = m - n->children[i]->total;
+		}
+		if (i == n->count() - 1 && !(m < n->children[i]->total)) {
+			return end();
+		}
+		node = n->children[i];
+	}
+	const Leaf* leaf = static_cast<const Leaf*>(node);
+	for (int i = 0; i < leaf->count(); ++i) {
+		m = m - leaf->metrics[i];
+		if (m < M()) {
+			return const_iterator(leaf, i);
+		}
+	}
+	return normalize(leaf, leaf->count());
+}
+
+#endif
@@ -315,6 +315,24 @@ void* allocate(size_t length, bool allowLargePages, bool includeGuardPages);
 
 void setAffinity(int proc);
 
+// Restricts the process to the CPUs of a NUMA node and prefers memory from that node for its allocations. Only threads
+// and memory created afterwards are placed, so this should be called before the process starts any threads. Returns
+// false if the node does not exist or the platform does not support it.
+bool bindToNumaNode(int node);
+
+// The NUMA node passed to a successful bindToNumaNode(), or -1
+int getBoundNumaNode();
+
+// Page allocation counters of a NUMA node, for all processes on the machine
+struct NumaNodeStatistics {
+	int64_t localNode = 0; // Allocated on the node by a process running on the node
+	int64_t otherNode = 0; // Allocated on the node by a process running on another node
+	int64_t numaMiss = 0; // Allocated on the node although another node was preferred
+	int64_t numaForeign = 0; // Preferred on the node but allocated on another node
+};
+
+bool getNumaNodeStatistics(int node, NumaNodeStatistics& stats);
+
 void threadSleep(double seconds);
 
 void threadYield(); // Attempt to yield to other processes or threads
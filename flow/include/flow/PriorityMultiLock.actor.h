@@ -65,6 +65,18 @@
 // For improved memory locality the properties mentioned above are stored as priorities[n].<property>
 // in the actual implementation.
 //
+// A waiter may ask for several slots at once, which it is granted together as one Lock and which count as that many
+// runners of its priority.  While the waiter at the front of the next priority to run needs more slots than are
+// available, the slots that are released are held for it rather than given to smaller requests.
+//
+// Waiters of a priority are granted their slots in increasing order of the order they were requested with, and first
+// come first served among waiters of the same order.  By default every waiter has order 0, so each priority is served
+// first come first served; a caller can instead order its waiters by e.g. their expected cost or their deadline.
+//
+// Work done on behalf of a lock holder, which the holder waits on, can be requested with lockFor().  It queues ahead
+// of the other waiters of its priority, or of the holder's priority if that is weighted more, so that it isn't held up
+// behind work that doesn't hold slots yet.
+//
 // The interface is similar to FlowMutex except that lock holders can just drop the lock to release it.
 //
 // Usage:
@@ -77,18 +89,22 @@ public:
 	// Calling release() is not necessary, it exists in case the Lock holder wants to explicitly release
 	// the Lock before it goes out of scope.
 	struct Lock {
-		void release() { promise.send(Void()); }
+		void release() const { promise.send(Void()); }
 		bool isLocked() const { return promise.canBeSet(); }
 
 		// This is exposed in case the caller wants to use/copy it directly
 		Promise<Void> promise;
+		// The priority the lock was granted at, and the number of slots it holds
+		int priority = -1;
+		int slots = 0;
 	};
 
 	PriorityMultiLock(int concurrency, std::string weights)
 	  : PriorityMultiLock(concurrency, parseStringToVector<int>(weights, ',')) {}
 
 	PriorityMultiLock(int concurrency, std::vector<int> weightsByPriority)
-	  : concurrency(concurrency), available(concurrency), waiting(0), totalPendingWeights(0), killed(false) {
+	  : concurrency(concurrency), available(concurrency), waiting(0), totalPendingWeights(0), reservedSlots(0),
+	    sequence(0), killed(false) {
 
 		priorities.resize(weightsByPriority.size());
 		for (int i = 0; i < priorities.size(); ++i) {
@@ -101,41 +117,21 @@ public:
 
 	~PriorityMultiLock() { kill(); }
 
-	Future<Lock> lock(int priority = 0) {
-		if (killed)
-			throw broken_promise();
-
-		Priority& p = priorities[priority];
-		Queue& q = p.queue;
-
-		// If this priority currently has no waiters
-		if (q.empty()) {
-			// Add this priority's weight to the total for priorities with pending work.  This must be done
-			// so that currenctCapacity() below will assign capacaity to this priority.
-			totalPendingWeights += p.weight;
-
-			// If there are slots available and the priority has capacity then don't make the caller wait
-			if (available > 0 && p.runners < currentCapacity(p.weight)) {
-				// Remove this priority's weight from the total since it will remain empty
-				totalPendingWeights -= p.weight;
-
-				// Return a Lock to the caller
-				Lock lock;
-				addRunner(lock, &p);
-
-				pml_debug_printf("lock nowait priority %d  %s\n", priority, toString().c_str());
-				return lock;
-			}
+	// Requests slots slots at priority, which are granted together, ahead of the waiters of priority with a greater
+	// order.  A request for more slots than the concurrency limit is granted all of them.
+	Future<Lock> lock(int priority = 0, int slots = 1, double order = 0) {
+		return acquire(priority, slots, false, order);
+	}
 
-			// If we didn't return above then add the priority to the waitingPriorities list
-			waitingPriorities.push_back(p);
+	// Requests slots slots for work that the holder of parent, a Lock from this PriorityMultiLock, is waiting on.  The
+	// request queues ahead of the other waiters of priority, or of parent's priority if parent still holds its slots
+	// and its priority is weighted more.
+	Future<Lock> lockFor(const Lock& parent, int priority, int slots = 1) {
+		if (parent.isLocked() && parent.priority >= 0 &&
+		    priorities[parent.priority].weight > priorities[priority].weight) {
+			priority = parent.priority;
 		}
-
-		Waiter& w = q.emplace_back();
-		++waiting;
-
-		pml_debug_printf("lock wait priority %d  %s\n", priority, toString().c_str());
-		return w.lockPromise.getFuture();
+		return acquire(priority, slots, true, 0);
 	}
 
 	// Halt stops the PML from handing out any new locks but leaves waiters and runners alone.
@@ -170,13 +166,14 @@ public:
 
 	std::string toString() const {
 		std::string s = format("{ ptr=%p concurrency=%d available=%d running=%d waiting=%d "
-		                       "pendingWeights=%d ",
+		                       "pendingWeights=%d reservedSlots=%d ",
 		                       this,
 		                       concurrency,
 		                       available,
 		                       concurrency - available,
 		                       waiting,
-		                       totalPendingWeights);
+		                       totalPendingWeights,
+		                       reservedSlots);
 
 		for (auto& p : priorities) {
 			s += format("{%s} ", p.toString(this).c_str());
@@ -205,6 +202,23 @@ public:
 private:
 	struct Waiter {
 		Promise<Lock> lockPromise;
+		int slots = 1;
+		// Waiters queued for a lock holder go ahead of the others, and the last of them first
+		bool first = false;
+		double order = 0;
+		int64_t sequence = 0;
+
+		// Whether this waiter is granted after other, which orders each priority's queue as a heap
+		bool grantedAfter(const Waiter& other) const {
+			if (first != other.first) {
+				return other.first;
+			}
+			if (!first && order != other.order) {
+				return order > other.order;
+			}
+			return first ? sequence < other.sequence : sequence > other.sequence;
+		}
+		static bool heapCompare(const Waiter& a, const Waiter& b) { return a.grantedAfter(b); }
 	};
 
 	// Total execution slots allowed across all priorities
@@ -215,15 +229,20 @@ private:
 	int waiting;
 	// Sum of weights for all priorities with 1 or more waiters
 	int totalPendingWeights;
+	// Slots needed by the waiter the runner is holding released slots for, or 0
+	int reservedSlots;
+	// Number of waiters queued so far, which orders waiters of the same order
+	int64_t sequence;
 
-	typedef Deque<Waiter> Queue;
+	// A heap of waiters, with the next one to be granted at the front
+	typedef std::vector<Waiter> Queue;
 
 	struct Priority : boost::intrusive::list_base_hook<> {
 		Priority() : runners(0), weight(0), priority(-1) {}
 
 		// Queue of waiters at this priority
 		Queue queue;
-		// Number of runners at this priority
+		// Number of slots held by runners at this priority
 		int runners;
 		// Configured weight for this priority
 		int weight;
@@ -252,7 +271,60 @@ private:
 	Promise<Void> brokenOnDestruct;
 	bool killed;
 
-	ACTOR static void handleRelease(Reference<PriorityMultiLock> self, Priority* priority, Future<Void> holder) {
+	// Queues a waiter for slots at priority, at the front of its queue if first, unless it can run now
+	Future<Lock> acquire(int priority, int slots, bool first, double order) {
+		if (killed)
+			throw broken_promise();
+
+		Priority& p = priorities[priority];
+		Queue& q = p.queue;
+		slots = std::max(1, std::min(slots, concurrency));
+
+		// If this priority currently has no waiters, add its weight to the total for priorities with pending work.
+		// This must be done so that currentCapacity() below will assign capacity to this priority.
+		const bool wasEmpty = q.empty();
+		if (wasEmpty) {
+			totalPendingWeights += p.weight;
+		}
+
+		// If the waiter would be first in line, there are enough slots available and not held for another waiter, and
+		// the priority has capacity, then don't make the caller wait
+		if ((wasEmpty || first) && available >= slots && reservedSlots == 0 && p.runners < currentCapacity(p.weight)) {
+			// Remove this priority's weight from the total if it will remain empty
+			if (wasEmpty) {
+				totalPendingWeights -= p.weight;
+			}
+
+			// Return a Lock to the caller
+			Lock lock;
+			addRunner(lock, &p, slots);
+
+			pml_debug_printf("lock nowait priority %d  %s\n", priority, toString().c_str());
+			return lock;
+		}
+
+		// If we didn't return above then add the priority to the waitingPriorities list
+		if (wasEmpty) {
+			waitingPriorities.push_back(p);
+		}
+
+		Waiter& w = q.emplace_back();
+		w.slots = slots;
+		w.first = first;
+		w.order = order;
+		w.sequence = ++sequence;
+		Future<Lock> lock = w.lockPromise.getFuture();
+		std::push_heap(q.begin(), q.end(), Waiter::heapCompare);
+		++waiting;
+
+		pml_debug_printf("lock wait priority %d  %s\n", priority, toString().c_str());
+		return lock;
+	}
+
+	ACTOR static void handleRelease(Reference<PriorityMultiLock> self,
+	                                Priority* priority,
+	                                int slots,
+	                                Future<Void> holder) {
 		pml_debug_printf("%f handleRelease self=%p start\n", now(), self.getPtr());
 		try {
 			wait(holder);
@@ -264,19 +336,22 @@ private:
 		pml_debug_printf("lock release priority %d  %s\n", (int)(priority->priority), self->toString().c_str());
 
 		pml_debug_printf("%f handleRelease self=%p releasing\n", now(), self.getPtr());
-		++self->available;
-		priority->runners -= 1;
+		self->available += slots;
+		priority->runners -= slots;
 
-		// If there are any waiters or if the runners array is getting large, trigger the runner loop
-		if (self->waiting > 0) {
+		// If there are any waiters, and enough slots for the one the runner is holding slots for, trigger the runner
+		// loop
+		if (self->waiting > 0 && self->available >= self->reservedSlots) {
 			self->wakeRunner.trigger();
 		}
 	}
 
-	void addRunner(Lock& lock, Priority* priority) {
-		priority->runners += 1;
-		--available;
-		handleRelease(Reference<PriorityMultiLock>::addRef(this), priority, lock.promise.getFuture());
+	void addRunner(Lock& lock, Priority* priority, int slots) {
+		lock.priority = priority->priority;
+		lock.slots = slots;
+		priority->runners += slots;
+		available -= slots;
+		handleRelease(Reference<PriorityMultiLock>::addRef(this), priority, slots, lock.promise.getFuture());
 	}
 
 	// Current maximum running tasks for the specified priority, which must have waiters
@@ -319,9 +394,22 @@ private:
 					++p;
 				}
 
+				// If the waiter needs more slots than are available, hold the slots that are released for it until
+				// there are enough
 				Queue& queue = p->queue;
-				Waiter w = queue.front();
-				queue.pop_front();
+				if (queue.front().slots > self->available) {
+					self->reservedSlots = queue.front().slots;
+					pml_debug_printf("    reserve slots=%d priority=%d  %s\n",
+					                 self->reservedSlots,
+					                 p->priority,
+					                 self->toString().c_str());
+					break;
+				}
+				self->reservedSlots = 0;
+
+				std::pop_heap(queue.begin(), queue.end(), Waiter::heapCompare);
+				Waiter w = std::move(queue.back());
+				queue.pop_back();
 
 				// If this priority is now empty, subtract its weight from the total pending weights an remove it
 				// from the waitingPriorities list
@@ -336,6 +424,8 @@ private:
 
 				--self->waiting;
 				Lock lock;
+				lock.priority = pPriority->priority;
+				lock.slots = w.slots;
 
 				w.lockPromise.send(lock);
 
@@ -346,7 +436,7 @@ private:
 
 				// If the lock was not already released, add it to the runners future queue
 				if (lock.promise.canBeSet()) {
-					self->addRunner(lock, pPriority);
+					self->addRunner(lock, pPriority, w.slots);
 				}
 
 				pml_debug_printf("    launched alreadyDone=%d priority=%d  %s\n",
@@ -29,4 +29,9 @@ class INetwork;
 void startProfiling(INetwork* network, Optional<int> period = {}, Optional<StringRef> outputFile = {});
 void stopProfiling();
 
+// Samples the actor and task priority the calling (network) thread is running every FLOW_KNOBS->CPU_SAMPLER_PERIOD
+// seconds of its CPU time, and traces the most frequent as CpuSamples events every CPU_SAMPLER_REPORT_INTERVAL seconds.
+// Actors are only known in builds with ENABLE_SAMPLING. Sampling stops when the returned future is cancelled.
+Future<Void> cpuSampler(INetwork* network);
+
 #endif // _FDB_FLOW_PROFILER_H_
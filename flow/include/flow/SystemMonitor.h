@@ -64,6 +64,8 @@ struct NetworkData {
 	int64_t countReads;
 	int64_t countWouldBlock;
 	int64_t countWrites;
+	int64_t countWriteBytes;
+	int64_t countWriteBuffers;
 	int64_t countRunLoop;
 	int64_t countCantSleep;
 	int64_t countWontSleep;
@@ -106,6 +108,8 @@ struct NetworkData {
 		countReads = Int64Metric::getValueOrDefault("Net2.CountReads"_sr);
 		countWouldBlock = Int64Metric::getValueOrDefault("Net2.CountWouldBlock"_sr);
 		countWrites = Int64Metric::getValueOrDefault("Net2.CountWrites"_sr);
+		countWriteBytes = Int64Metric::getValueOrDefault("Net2.CountWriteBytes"_sr);
+		countWriteBuffers = Int64Metric::getValueOrDefault("Net2.CountWriteBuffers"_sr);
 		countRunLoop = Int64Metric::getValueOrDefault("Net2.CountRunLoop"_sr);
 		countCantSleep = Int64Metric::getValueOrDefault("Net2.CountCantSleep"_sr);
 		countWontSleep = Int64Metric::getValueOrDefault("Net2.CountWontSleep"_sr);
@@ -144,6 +148,7 @@ struct StatisticsState {
 	SystemStatisticsState* systemState;
 	NetworkData networkState;
 	NetworkMetrics networkMetricsState;
+	NumaNodeStatistics numaState;
 
 	StatisticsState() : systemState(nullptr) {}
 };
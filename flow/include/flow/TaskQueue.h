@@ -36,7 +36,13 @@ public:
 	TaskQueue() : tasksIssued(0), ready(FLOW_KNOBS->READY_QUEUE_RESERVED_SIZE) {}
 
 	// Add a task that is ready to be executed.
-	void addReady(TaskPriority taskId, Task* t) { this->ready.push(OrderedTask(getFIFOPriority(taskId), taskId, t)); }
+	void addReady(TaskPriority taskId, Task* t) {
+		OrderedTask task(getFIFOPriority(taskId), taskId, t);
+		if (sampleReadyTime()) {
+			task.readyTime = timer_monotonic();
+		}
+		this->ready.push(task);
+	}
 	// Add a task to be executed at a given future time instant (a "timer").
 	void addTimer(double at, TaskPriority taskId, Task* t) {
 		this->timers.push(DelayedTask(at, getFIFOPriority(taskId), taskId, t));
@@ -67,7 +73,7 @@ public:
 	// Returns a time interval a caller should sleep from now until the next timer.
 	double getSleepTime(double now) const {
 		if (!timers.empty()) {
-			return timers.top().at - now;
+			return timers.top() - now;
 		}
 		return 0;
 	}
@@ -75,12 +81,16 @@ public:
 	// Moves all timers that are scheduled to be executed at or before now to the ready queue.
 	void processReadyTimers(double now) {
 		[[maybe_unused]] int numTimers = 0;
-		while (!timers.empty() && timers.top().at <= now + INetwork::TIME_EPS) {
+		timers.popUntil(now + INetwork::TIME_EPS, [&](DelayedTask const& t) {
 			++numTimers;
 			++countTimers;
-			ready.push(timers.top());
-			timers.pop();
-		}
+			OrderedTask task = t;
+			if (sampleReadyTime()) {
+				// A timer is ready from its time on, not from when the run loop got to it
+				task.readyTime = t.at;
+			}
+			ready.push(task);
+		});
 		FDB_TRACE_PROBE(run_loop_ready_timers, numTimers);
 	}
 
@@ -103,8 +113,17 @@ public:
 	TaskPriority getReadyTaskID() const { return ready.top().taskID; }
 	int64_t getReadyTaskPriority() const { return ready.top().priority; }
 	Task* getReadyTask() const { return ready.top().task; }
+	// The time the task became ready to run, if its wait is sampled, or 0
+	double getReadyTaskReadyTime() const { return ready.top().readyTime; }
 	void popReadyTask() { ready.pop(); }
 
+	// Times when one in every interval tasks becomes ready, on the clock of timer_monotonic(), which must also be the
+	// clock timers are added on. 0 disables it.
+	void sampleReadyTimes(int interval) {
+		readyTimeSampleInterval = interval;
+		untilReadyTimeSample = interval;
+	}
+
 	void initMetrics() {
 		countTimers.init("Net2.CountTimers"_sr);
 		countCantSleep.init("Net2.CountCantSleep"_sr);
@@ -114,8 +133,7 @@ public:
 	void clear() {
 		decltype(ready) _1;
 		ready.swap(_1);
-		decltype(timers) _2;
-		timers.swap(_2);
+		timers.clear();
 	}
 
 private:
@@ -123,6 +141,7 @@ private:
 		int64_t priority;
 		TaskPriority taskID;
 		Task* task;
+		double readyTime = 0; // Not part of the ordering
 		OrderedTask(int64_t priority, TaskPriority taskID, Task* task)
 		  : priority(priority), taskID(taskID), task(task) {}
 		bool operator<(OrderedTask const& rhs) const { return priority < rhs.priority; }
@@ -143,15 +162,153 @@ private:
 		void reserve(size_type capacity) { this->c.reserve(capacity); }
 	};
 
+	// A hierarchical timer wheel, which adds a timer in constant time however many are pending. Time is divided into
+	// ticks, and level L of the wheel has 64 slots of 64^L ticks each. A timer after the current tick is kept in the
+	// lowest level whose slot for it doesn't also hold the current tick, and moves down a level each time the current
+	// tick reaches the beginning of its slot. Timers at or before the current tick are kept in a heap, so that they
+	// are removed at exactly their time.
+	class TimerWheel {
+	public:
+		bool empty() const { return near.empty() && wheelCount == 0; }
+
+		void push(DelayedTask const& t) { insert(t); }
+
+		// Returns the earliest time of a timer. The wheel must not be empty.
+		double top() const {
+			if (!near.empty()) {
+				return near.top().at;
+			}
+			// Every timer in a level is earlier than those in higher levels, and within a level the slots after the
+			// current tick's slot are in time order
+			for (int level = 0; level < levels; ++level) {
+				if (occupied[level]) {
+					return wheel[level][ctzll(occupied[level])].earliest;
+				}
+			}
+			UNREACHABLE();
+		}
+
+		// Removes each timer at or before limit, in time order, and passes it to f
+		template <class F>
+		void popUntil(double limit, F const& f) {
+			advance(tickOf(limit));
+			while (!near.empty() && near.top().at <= limit) {
+				f(near.top());
+				near.pop();
+			}
+		}
+
+		void clear() {
+			for (int level = 0; level < levels; ++level) {
+				for (auto& slot : wheel[level]) {
+					slot.tasks.clear();
+				}
+				occupied[level] = 0;
+			}
+			wheelCount = 0;
+			decltype(near) _;
+			near.swap(_);
+		}
+
+	private:
+		static constexpr int slotBits = 6;
+		static constexpr int slots = 1 << slotBits;
+		static constexpr int levels = 9;
+		static constexpr double ticksPerSecond = 1024;
+		// Later timers share the last tick, and are ordered by the heap once it is reached
+		static constexpr int64_t maxTick = (int64_t(1) << (slotBits * levels)) - 1;
+
+		struct Slot {
+			std::vector<DelayedTask> tasks;
+			double earliest;
+		};
+
+		Slot wheel[levels][slots];
+		uint64_t occupied[levels] = {}; // Bit i is set if wheel[level][i] is not empty
+		int64_t wheelCount = 0;
+		int64_t currentTick = 0;
+		std::priority_queue<DelayedTask, std::vector<DelayedTask>> near;
+		std::vector<DelayedTask> cascading;
+
+		static int64_t tickOf(double at) {
+			if (!(at < maxTick / ticksPerSecond)) {
+				return maxTick;
+			}
+			return at > 0 ? int64_t(at * ticksPerSecond) : 0;
+		}
+		static int slotOf(int64_t tick, int level) { return (tick >> (slotBits * level)) & (slots - 1); }
+
+		void insert(DelayedTask const& t) {
+			const int64_t tick = tickOf(t.at);
+			if (tick <= currentTick) {
+				near.push(t);
+				return;
+			}
+			// The highest bit in which the ticks differ gives the lowest level at which they are in different slots
+			const int level = (63 - clzll(tick ^ currentTick)) / slotBits;
+			const int index = slotOf(tick, level);
+			Slot& slot = wheel[level][index];
+			slot.earliest = slot.tasks.empty() ? t.at : std::min(slot.earliest, t.at);
+			slot.tasks.push_back(t);
+			occupied[level] |= uint64_t(1) << index;
+			++wheelCount;
+		}
+
+		// Moves the current tick forward to tick, jumping between the beginnings of occupied slots
+		void advance(int64_t tick) {
+			while (currentTick < tick) {
+				int64_t next = tick;
+				for (int level = 0; level < levels; ++level) {
+					const uint64_t later = occupied[level] & ~((uint64_t(2) << slotOf(currentTick, level)) - 1);
+					if (later) {
+						const int shift = slotBits * level;
+						const int64_t blockBegin = (currentTick >> (shift + slotBits)) << (shift + slotBits);
+						next = std::min(next, blockBegin + (int64_t(ctzll(later)) << shift));
+						break;
+					}
+				}
+				currentTick = next;
+				for (int level = levels - 1; level >= 0; --level) {
+					cascade(level);
+				}
+			}
+		}
+
+		// Moves the timers in the slot that begins at the current tick to lower levels, or to the heap
+		void cascade(int level) {
+			const int index = slotOf(currentTick, level);
+			if (!(occupied[level] & (uint64_t(1) << index))) {
+				return;
+			}
+			occupied[level] &= ~(uint64_t(1) << index);
+			cascading.swap(wheel[level][index].tasks);
+			wheelCount -= cascading.size();
+			for (auto const& t : cascading) {
+				insert(t);
+			}
+			cascading.clear();
+		}
+	};
+
 	// Returns a unique priority value for a task which preserves FIFO ordering
 	// for tasks with the same priority.
 	int64_t getFIFOPriority(TaskPriority taskId) { return (int64_t(taskId) << 32) - (++tasksIssued); }
 	uint64_t tasksIssued;
 
+	bool sampleReadyTime() {
+		if (readyTimeSampleInterval <= 0 || --untilReadyTimeSample > 0) {
+			return false;
+		}
+		untilReadyTimeSample = readyTimeSampleInterval;
+		return true;
+	}
+	int readyTimeSampleInterval = 0;
+	int untilReadyTimeSample = 0;
+
 	ReadyQueue<OrderedTask> ready;
 	ThreadSafeQueue<std::pair<TaskPriority, Task*>> threadReady;
 
-	std::priority_queue<DelayedTask, std::vector<DelayedTask>> timers;
+	TimerWheel timers;
 
 	Int64MetricHandle countTimers;
 	Int64MetricHandle countCantSleep;
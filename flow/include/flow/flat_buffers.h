@@ -663,18 +663,63 @@ using Fields = decltype(fields_helper<Member>());
 // |numMembers| elements are alignments.
 extern VTable generate_vtable(size_t numMembers, const std::vector<unsigned>& sizesAndAlignments);
 
+// The same vtable as generate_vtable, computed at compile time so that a table can be written at constant offsets
+template <unsigned... MembersAndAlignments>
+constexpr auto vtable_layout3() {
+	constexpr size_t numMembers = sizeof...(MembersAndAlignments) / 2;
+	constexpr std::array<unsigned, sizeof...(MembersAndAlignments)> sizesAlignments{ MembersAndAlignments... };
+	std::array<uint16_t, numMembers + 2> result{};
+	if constexpr (numMembers == 0) {
+		result[0] = result[1] = 4;
+	} else {
+		// Members in order of decreasing size, keeping the order of members of equal size, as std::stable_sort does
+		std::array<unsigned, numMembers> indexed{};
+		size_t count = 0;
+		for (unsigned i = 0; i < numMembers; ++i) {
+			if (sizesAlignments[i] > 0) {
+				size_t j = count++;
+				for (; j > 0 && sizesAlignments[indexed[j - 1]] < sizesAlignments[i]; --j) {
+					indexed[j] = indexed[j - 1];
+				}
+				indexed[j] = i;
+			}
+		}
+		result[0] = 2 * numMembers + 4;
+		unsigned offset = 0;
+		for (size_t j = 0; j < count; ++j) {
+			unsigned i = indexed[j];
+			unsigned align = sizesAlignments[numMembers + i];
+			unsigned res = offset % align == 0 ? offset : ((offset / align) + 1) * align;
+			offset = res + sizesAlignments[i];
+			result[i + 2] = res + 4;
+		}
+		result[1] = offset + 4;
+	}
+	return result;
+}
+
 template <unsigned... MembersAndAlignments>
 const VTable* gen_vtable3() {
-	static thread_local VTable table =
-	    generate_vtable(sizeof...(MembersAndAlignments) / 2, std::vector<unsigned>{ MembersAndAlignments... });
+	static constexpr auto layout = vtable_layout3<MembersAndAlignments...>();
+	static thread_local VTable table(layout.begin(), layout.end());
 	return &table;
 }
 
+template <class... Members>
+constexpr auto vtable_layout2(pack<Members...>) {
+	return vtable_layout3<_SizeOf<Members>::size..., _SizeOf<Members>::align...>();
+}
+
 template <class... Members>
 const VTable* gen_vtable2(pack<Members...> p) {
 	return gen_vtable3<_SizeOf<Members>::size..., _SizeOf<Members>::align...>();
 }
 
+template <class... Members>
+constexpr auto vtable_layout() {
+	return vtable_layout2(concat_t<Fields<Members>...>{});
+}
+
 template <class... Members>
 const VTable* get_vtable() {
 	return gen_vtable2(concat_t<Fields<Members>...>{});
@@ -899,7 +944,7 @@ struct SaveVisitorLambda : Context {
 
 	template <class... Members>
 	void operator()(const Members&... members) {
-		const auto& vtable = *get_vtable<Members...>();
+		static constexpr auto vtable = vtable_layout<Members...>();
 		auto self = writer.getMessageWriter(/*length*/ vtable[1], /*zeroed*/ true);
 		int i = 2;
 		for_each(
@@ -966,7 +1011,7 @@ struct SaveVisitorLambda : Context {
 			    }
 		    },
 		    members...);
-		int vtable_offset = writer.vtable_start - vtableset->getOffset(&vtable);
+		int vtable_offset = writer.vtable_start - vtableset->getOffset(get_vtable<Members...>());
 		int padding = 0;
 		int start =
 		    RightAlign(writer.current_buffer_size + vtable[1] - 4, std::max({ 4, fb_align<Members>... }), &padding) + 4;
@@ -604,11 +604,13 @@ public:
 		send(ps);
 	}
 
-	void triggerRange(K const& begin, K const& end) {
+	// Returns the number of items triggered
+	int triggerRange(K const& begin, K const& end) {
 		if (begin >= end)
-			return;
+			return 0;
 		std::vector<Promise<Void>> ps = swapRangePromises(items.lower_bound(begin), items.lower_bound(end));
 		send(ps);
+		return ps.size();
 	}
 
 	void trigger(K const& key) {
@@ -624,7 +626,38 @@ public:
 			trigger.send(Void());
 		}
 	}
+	// Triggers each of keys, which must be sorted and unique, in a single pass over the map. Keys between two items
+	// share one lookup, so this is much cheaper than calling trigger() for each key when few of them are waited on.
+	// Returns the number of items triggered.
+	template <class Keys>
+	int triggerSorted(Keys const& keys) {
+		std::vector<Promise<Void>> ps;
+		auto it = items.begin();
+		for (auto const& key : keys) {
+			if (it == items.end()) {
+				break;
+			}
+			if (it->first < key) {
+				it = items.lower_bound(K(key));
+				if (it == items.end()) {
+					break;
+				}
+			}
+			if (!(key < it->first)) {
+				ps.resize(ps.size() + 1);
+				ps.back().swap(it->second.change);
+				if (it->second.value == defaultValue) {
+					it = items.erase(it);
+				} else {
+					++it;
+				}
+			}
+		}
+		send(ps);
+		return ps.size();
+	}
 	void clear(K const& k) { set(k, V()); }
+	bool empty() const { return items.empty(); }
 	V const& get(K const& k) const {
 		auto it = items.find(k);
 		if (it != items.end())
@@ -33,6 +33,7 @@
 #include <stdint.h>
 #include <atomic>
 #include <unordered_map>
+#include "flow/DDSketch.h"
 #include "flow/IRandom.h"
 #include "flow/ProtocolVersion.h"
 #include "flow/WriteOnlySet.h"
@@ -79,11 +80,23 @@ struct NetworkMetrics {
 
 	static const std::vector<int> starvationBins;
 
+	// The seconds sampled tasks waited from becoming ready until they ran, for each of starvationBins, of the tasks at
+	// or above its priority and below the next one's. Cleared each time they are logged, and not copied.
+	std::vector<DDSketch<double>> readyWaits;
+
 	NetworkMetrics()
 	  : lastRunLoopBusyness(0), networkBusyness(0),
 	    starvationTrackerNetworkBusyness(PriorityStats(static_cast<TaskPriority>(starvationBins.at(0)))) {
 		for (int priority : starvationBins) { // initialize starvation trackers with given priorities
 			starvationTrackers.emplace_back(static_cast<TaskPriority>(priority));
+			readyWaits.emplace_back(0.05);
+		}
+	}
+
+	void addReadyWait(TaskPriority priority, double seconds) {
+		auto bin = std::upper_bound(starvationBins.begin(), starvationBins.end(), static_cast<int>(priority));
+		if (bin != starvationBins.begin()) {
+			readyWaits[bin - starvationBins.begin() - 1].addSample(std::max(seconds, 0.0));
 		}
 	}
 
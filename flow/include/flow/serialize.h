@@ -444,6 +444,20 @@ public:
 	}
 	void* getData() { return data; }
 	int getLength() const { return size; }
+	// Makes room for at least s more bytes, so that a writer whose final size is known up front is not copied as it
+	// grows
+	void reserve(int s) {
+		if (size + s > allocated) {
+			allocated = size + s;
+			Arena newArena;
+			uint8_t* newData = new (newArena) uint8_t[allocated];
+			if (size > 0) {
+				memcpy(newData, data, size);
+			}
+			arena = newArena;
+			data = newData;
+		}
+	}
 	Standalone<StringRef> toValue() const { return Standalone<StringRef>(StringRef(data, size), arena); }
 	StringRef toValue(Arena& arena) const { return StringRef(arena, StringRef(data, size)); }
 	template <class VersionOptions>
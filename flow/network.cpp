@@ -381,6 +381,24 @@ IUDPSocket::~IUDPSocket() {}
 
 const std::vector<int> NetworkMetrics::starvationBins = { 1, 3500, 7000, 7500, 8500, 8900, 10500 };
 
+TEST_CASE("/flow/network/readyWaits") {
+	NetworkMetrics metrics;
+	metrics.addReadyWait(TaskPriority::Zero, 1.0); // Below the lowest bin
+	metrics.addReadyWait(static_cast<TaskPriority>(1), 0.5);
+	metrics.addReadyWait(static_cast<TaskPriority>(3499), 0.25);
+	metrics.addReadyWait(static_cast<TaskPriority>(7000), -1.0);
+	metrics.addReadyWait(TaskPriority::Max, 2.0);
+	ASSERT(metrics.readyWaits[0].getPopulationSize() == 2 && metrics.readyWaits[0].max() == 0.5);
+	ASSERT(metrics.readyWaits[2].getPopulationSize() == 1 && metrics.readyWaits[2].max() == 0.0);
+	ASSERT(metrics.readyWaits.back().getPopulationSize() == 1);
+	int64_t total = 0;
+	for (auto const& sketch : metrics.readyWaits) {
+		total += sketch.getPopulationSize();
+	}
+	ASSERT(total == 4);
+	return Void();
+}
+
 TEST_CASE("/flow/network/ipaddress") {
 	ASSERT(NetworkAddress::parse("[::1]:4800").toString() == "[::1]:4800");
 
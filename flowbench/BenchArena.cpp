@@ -0,0 +1,85 @@
+/*
+ * BenchArena.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include "flow/Arena.h"
+#include "flowbench/GlobalData.h"
+
+// Allocates Arg1 blocks of Arg0 bytes from a new arena, which grows by chaining larger and larger blocks
+static void bench_arena_allocate(benchmark::State& state) {
+	const int size = state.range(0);
+	const int count = state.range(1);
+	for (auto _ : state) {
+		Arena arena;
+		for (int i = 0; i < count; ++i) {
+			benchmark::DoNotOptimize(new (arena) uint8_t[size]);
+		}
+	}
+	state.SetItemsProcessed(count * static_cast<long>(state.iterations()));
+	state.SetBytesProcessed(static_cast<long>(size) * count * state.iterations());
+}
+
+// Appends Arg0 key-value pairs to a VectorRef, which reallocates into its arena as it grows unless Arg1 reserves it
+static void bench_vectorref_push_back(benchmark::State& state) {
+	const int count = state.range(0);
+	const bool reserve = state.range(1);
+	KeyValueRef kv = getKV(16, 100);
+	for (auto _ : state) {
+		Standalone<VectorRef<KeyValueRef>> v;
+		if (reserve) {
+			v.reserve(v.arena(), count);
+		}
+		for (int i = 0; i < count; ++i) {
+			v.push_back(v.arena(), kv);
+		}
+		benchmark::DoNotOptimize(v.size());
+	}
+	state.SetItemsProcessed(count * static_cast<long>(state.iterations()));
+}
+
+// Appends Arg0 copies of a key-value pair of Arg1 byte keys and values, copying their bytes into the arena
+static void bench_vectorref_push_back_deep(benchmark::State& state) {
+	const int count = state.range(0);
+	const int size = state.range(1);
+	KeyValueRef kv = getKV(size, size);
+	for (auto _ : state) {
+		Standalone<VectorRef<KeyValueRef>> v;
+		for (int i = 0; i < count; ++i) {
+			v.push_back_deep(v.arena(), kv);
+		}
+		benchmark::DoNotOptimize(v.size());
+	}
+	state.SetItemsProcessed(count * static_cast<long>(state.iterations()));
+	state.SetBytesProcessed(2L * size * count * state.iterations());
+}
+
+BENCHMARK(bench_arena_allocate)
+    ->ArgNames({ "size", "count" })
+    ->ArgsProduct({ { 16, 256, 4096 }, { 16, 1024 } })
+    ->ReportAggregatesOnly(true);
+BENCHMARK(bench_vectorref_push_back)
+    ->ArgNames({ "count", "reserve" })
+    ->ArgsProduct({ { 16, 1 << 10, 1 << 16 }, { 0, 1 } })
+    ->ReportAggregatesOnly(true);
+BENCHMARK(bench_vectorref_push_back_deep)
+    ->ArgNames({ "count", "size" })
+    ->ArgsProduct({ { 16, 1 << 10 }, { 16, 1024 } })
+    ->ReportAggregatesOnly(true);
@@ -175,6 +175,45 @@ static void bench_sort_deltas(benchmark::State& state) {
 	state.SetBytesProcessed(static_cast<long>(state.iterations()) * targetBytes);
 }
 
+// Benchmark materializing a granule from deltas split into Arg1 delta files, with the last part of them in memory.
+// The main CPU cost should be mergeDeltaStreams
+static void bench_materialize_deltas(benchmark::State& state) {
+	int targetBytes = state.range(0);
+	int fileCount = state.range(1);
+	Standalone<GranuleDeltas> delta = deltaGen.getDelta(targetBytes);
+	KeyRange range = deltaGen.getRange();
+
+	// each file and the memory deltas get an equal part of the versions
+	int partSize = delta.size() / (fileCount + 1);
+	Standalone<BlobGranuleChunkRef> chunk;
+	std::vector<Value> files;
+	std::vector<StringRef> fileData;
+	for (int i = 0; i < fileCount; i++) {
+		Standalone<GranuleDeltas> part;
+		part.append(part.arena(), delta.begin() + i * partSize, partSize);
+		part.arena().dependsOn(delta.arena());
+		files.push_back(serializeChunkedDeltaFile("testdelta"_sr, part, range, 32 * 1024, {}, {}));
+		fileData.push_back(files.back());
+		chunk.deltaFiles.emplace_back_deep(
+		    chunk.arena(), "testdelta", 0, files.back().size(), files.back().size(), part.back().version);
+	}
+	chunk.newDeltas.append(chunk.arena(), delta.begin() + fileCount * partSize, delta.size() - fileCount * partSize);
+	chunk.arena().dependsOn(delta.arena());
+	chunk.keyRange = range;
+	chunk.includedVersion = delta.back().version;
+	chunk.snapshotVersion = invalidVersion;
+
+	int64_t rows = 0;
+	for (auto _ : state) {
+		GranuleMaterializeStats stats;
+		RangeResult result = materializeBlobGranule(chunk, range, 0, chunk.includedVersion, {}, fileData, stats);
+		rows += result.size();
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetBytesProcessed(static_cast<long>(state.iterations()) * targetBytes);
+	state.SetItemsProcessed(rows);
+}
+
 // Benchmark serialization for granule deltas 128KB, 512KB and 1024KB. Chunk size 32KB
 BENCHMARK(bench_serialize_deltas)
     ->Args({ 128 * 1024, 32 * 1024, false })
@@ -185,4 +224,10 @@ BENCHMARK(bench_serialize_deltas)
     ->Args({ 1024 * 1024, 32 * 1024, true });
 
 // Benchmark sorting for granule deltas 128KB, 512KB and 1024KB. Chunk size 32KB
-BENCHMARK(bench_sort_deltas)->Args({ 128 * 1024 })->Args({ 512 * 1024 })->Args({ 1024 * 1024 });
\ No newline at end of file
+BENCHMARK(bench_sort_deltas)->Args({ 128 * 1024 })->Args({ 512 * 1024 })->Args({ 1024 * 1024 });
+// Benchmark materializing granule deltas 128KB, 512KB and 1024KB, from 1 and 8 delta files plus memory deltas
+BENCHMARK(bench_materialize_deltas)
+    ->Args({ 128 * 1024, 1 })
+    ->Args({ 128 * 1024, 8 })
+    ->Args({ 512 * 1024, 8 })
+    ->Args({ 1024 * 1024, 8 });
@@ -0,0 +1,205 @@
+/*
+ * BenchConflictSet.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include "flow/Arena.h"
+#include "flow/IRandom.h"
+#include "fdbclient/CommitTransaction.h"
+#include "fdbclient/zipf.h"
+#include "fdbrpc/PerfMetric.h"
+#include "fdbserver/ConflictSet.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Timer the resolver already keeps around ConflictBatch::detectConflicts' call to removeBefore
+extern PerfDoubleCounter g_removeBefore;
+
+namespace {
+
+constexpr int transactionsPerBatch = 500;
+constexpr int keySpace = 1 << 20;
+// Pre-generated batches are replayed round robin, so generating keys is kept out of the measured loop
+constexpr int batchPoolSize = 64;
+
+struct ConflictBenchParams {
+	int readRanges;
+	int writeRanges;
+	int keyLength;
+	int prefixLength;
+	int skewPercent; // Zipfian constant * 100, or 0 for uniformly distributed keys
+	int historyDepth; // Number of batches kept in the conflict history
+	int checkThreads;
+
+	explicit ConflictBenchParams(const benchmark::State& state)
+	  : readRanges(state.range(0)), writeRanges(state.range(1)), keyLength(state.range(2)),
+	    prefixLength(state.range(3)), skewPercent(state.range(4)), historyDepth(state.range(5)),
+	    checkThreads(state.range(6)) {}
+};
+
+class ConflictKeyGenerator {
+public:
+	explicit ConflictKeyGenerator(const ConflictBenchParams& params)
+	  : keyLength(std::max<int>(params.keyLength, params.prefixLength + sizeof(uint32_t))),
+	    prefixLength(params.prefixLength), zipfian(params.skewPercent > 0) {
+		if (zipfian) {
+			zipfian_generator3(0, keySpace - 1, params.skewPercent / 100.0);
+		}
+	}
+
+	int nextIndex() {
+		return zipfian ? std::min(zipfian_next(), keySpace - 1) : deterministicRandom()->randomInt(0, keySpace);
+	}
+
+	// Keys share a fixed prefix, followed by the big endian index so that key order matches index order
+	KeyRef key(Arena& arena, int index) const {
+		uint8_t* buf = new (arena) uint8_t[keyLength];
+		memset(buf, 'p', prefixLength);
+		for (int i = 0; i < sizeof(uint32_t); i++) {
+			buf[prefixLength + i] = (index >> (8 * (sizeof(uint32_t) - 1 - i))) & 0xff;
+		}
+		memset(buf + prefixLength + sizeof(uint32_t), 0, keyLength - prefixLength - sizeof(uint32_t));
+		return KeyRef(buf, keyLength);
+	}
+
+	KeyRangeRef range(Arena& arena) {
+		const int begin = nextIndex();
+		const int end = std::min(begin + 1 + deterministicRandom()->randomInt(0, 4), keySpace);
+		return KeyRangeRef(key(arena, begin), key(arena, end));
+	}
+
+private:
+	int keyLength;
+	int prefixLength;
+	bool zipfian;
+};
+
+struct ConflictBenchBatch {
+	Arena arena;
+	std::vector<CommitTransactionRef> transactions;
+	// How far behind the batch's commit version each transaction's read snapshot is
+	std::vector<int> snapshotLag;
+};
+
+std::vector<ConflictBenchBatch> makeBatches(const ConflictBenchParams& params) {
+	ConflictKeyGenerator keys(params);
+	std::vector<ConflictBenchBatch> batches(batchPoolSize);
+	for (auto& batch : batches) {
+		for (int t = 0; t < transactionsPerBatch; t++) {
+			CommitTransactionRef tr;
+			for (int r = 0; r < params.readRanges; r++) {
+				tr.read_conflict_ranges.push_back(batch.arena, keys.range(batch.arena));
+			}
+			for (int w = 0; w < params.writeRanges; w++) {
+				tr.write_conflict_ranges.push_back(batch.arena, keys.range(batch.arena));
+			}
+			batch.transactions.push_back(tr);
+			batch.snapshotLag.push_back(1 + deterministicRandom()->randomInt(0, std::max(1, params.historyDepth / 2)));
+		}
+	}
+	return batches;
+}
+
+// Resolves one batch at version, keeping historyDepth versions of history. Returns the number of committed
+// transactions.
+int resolveBatch(ConflictSet* cs, ConflictBenchBatch& batch, Version version, int historyDepth) {
+	const Version newOldestVersion = std::max<Version>(0, version - historyDepth);
+	ConflictBatch conflictBatch(cs);
+	for (int t = 0; t < batch.transactions.size(); t++) {
+		batch.transactions[t].read_snapshot = std::max(newOldestVersion, version - batch.snapshotLag[t]);
+		conflictBatch.addTransaction(batch.transactions[t], newOldestVersion);
+	}
+	std::vector<int> nonConflicting;
+	conflictBatch.detectConflicts(version, newOldestVersion, nonConflicting);
+	return nonConflicting.size();
+}
+
+void addConflictBenchCounters(benchmark::State& state, int64_t committed, int64_t resolved) {
+	state.SetItemsProcessed(resolved);
+	state.counters.insert({ { "CommitFraction", resolved ? (double)committed / resolved : 0.0 } });
+}
+
+} // namespace
+
+// Throughput of resolving batches (addTransaction + detectConflicts) against a steady state history
+template <bool UseART>
+static void bench_conflict_batch(benchmark::State& state) {
+	const ConflictBenchParams params(state);
+	std::vector<ConflictBenchBatch> batches = makeBatches(params);
+	ConflictSet* cs = newConflictSet(UseART, params.checkThreads);
+
+	Version version = 0;
+	for (int i = 0; i < params.historyDepth; i++) {
+		resolveBatch(cs, batches[i % batches.size()], ++version, params.historyDepth);
+	}
+
+	int64_t committed = 0, resolved = 0;
+	for (auto _ : state) {
+		auto& batch = batches[version % batches.size()];
+		committed += resolveBatch(cs, batch, ++version, params.historyDepth);
+		resolved += batch.transactions.size();
+	}
+	addConflictBenchCounters(state, committed, resolved);
+	destroyConflictSet(cs);
+}
+
+// Time spent expiring history older than the MVCC window, measured with the resolver's own removeBefore timer
+template <bool UseART>
+static void bench_conflict_remove_before(benchmark::State& state) {
+	const ConflictBenchParams params(state);
+	std::vector<ConflictBenchBatch> batches = makeBatches(params);
+	ConflictSet* cs = newConflictSet(UseART, params.checkThreads);
+
+	Version version = 0;
+	for (int i = 0; i < params.historyDepth; i++) {
+		resolveBatch(cs, batches[i % batches.size()], ++version, params.historyDepth);
+	}
+
+	int64_t committed = 0, resolved = 0;
+	for (auto _ : state) {
+		auto& batch = batches[version % batches.size()];
+		const double before = g_removeBefore.getValue();
+		committed += resolveBatch(cs, batch, ++version, params.historyDepth);
+		resolved += batch.transactions.size();
+		state.SetIterationTime(g_removeBefore.getValue() - before);
+	}
+	addConflictBenchCounters(state, committed, resolved);
+	destroyConflictSet(cs);
+}
+
+static void conflict_set_args(benchmark::internal::Benchmark* b) {
+	b->ArgNames({ "reads", "writes", "keyLen", "prefixLen", "zipfPct", "history", "threads" });
+	// Range counts and key shape
+	b->ArgsProduct({ { 1, 5 }, { 1, 5 }, { 16, 64 }, { 0, 12 }, { 0 }, { 50 }, { 0 } });
+	// Contention and history depth
+	b->ArgsProduct({ { 5 }, { 2 }, { 32 }, { 8 }, { 0, 50, 99 }, { 10, 100, 500 }, { 0 } });
+}
+
+static void conflict_set_thread_args(benchmark::internal::Benchmark* b) {
+	b->ArgNames({ "reads", "writes", "keyLen", "prefixLen", "zipfPct", "history", "threads" });
+	b->ArgsProduct({ { 10 }, { 2 }, { 32 }, { 8 }, { 0, 99 }, { 100 }, { 0, 2, 4 } });
+}
+
+BENCHMARK_TEMPLATE(bench_conflict_batch, false)->Apply(conflict_set_args)->Apply(conflict_set_thread_args);
+BENCHMARK_TEMPLATE(bench_conflict_batch, true)->Apply(conflict_set_args);
+BENCHMARK_TEMPLATE(bench_conflict_remove_before, false)->Apply(conflict_set_args)->UseManualTime();
+BENCHMARK_TEMPLATE(bench_conflict_remove_before, true)->Apply(conflict_set_args)->UseManualTime();
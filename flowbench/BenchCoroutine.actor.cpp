@@ -0,0 +1,102 @@
+/*
+ * BenchCoroutine.actor.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include <array>
+#include <vector>
+
+#include "flow/flow.h"
+#include "flow/ThreadHelper.actor.h"
+
+#include "flow/actorcompiler.h" // This must be the last #include.
+
+// The same work as an actor and as a coroutine, each holding Size bytes across the wait
+
+ACTOR template <size_t Size>
+static Future<Void> incrementActor(Future<Void> f, uint32_t* sum) {
+	state std::array<uint8_t, Size> arr;
+	wait(f);
+	benchmark::DoNotOptimize(arr);
+	++(*sum);
+	return Void();
+}
+
+template <size_t Size>
+static Future<Void> incrementCoroutine(Future<Void> f, uint32_t* sum) {
+	std::array<uint8_t, Size> arr;
+	co_await f;
+	benchmark::DoNotOptimize(arr);
+	++(*sum);
+}
+
+// Starts Arg1 actors or coroutines per iteration.  If Ready they run to completion as they are started, which measures
+// the cost of allocating and freeing them.  Otherwise they all wait on a promise and are resumed by it.
+ACTOR template <size_t Size, bool IsCoroutine, bool Ready>
+static Future<Void> benchIncrement(benchmark::State* benchState) {
+	state size_t count = benchState->range(0);
+	state uint32_t sum;
+	while (benchState->KeepRunning()) {
+		sum = 0;
+		Promise<Void> trigger;
+		Future<Void> f = Ready ? Future<Void>(Void()) : trigger.getFuture();
+		std::vector<Future<Void>> futures;
+		futures.reserve(count);
+		for (int i = 0; i < count; ++i) {
+			futures.push_back(IsCoroutine ? incrementCoroutine<Size>(f, &sum) : incrementActor<Size>(f, &sum));
+		}
+		trigger.send(Void());
+		wait(waitForAll(futures));
+		benchmark::DoNotOptimize(sum);
+	}
+	benchState->SetItemsProcessed(count * static_cast<long>(benchState->iterations()));
+	return Void();
+}
+
+template <size_t Size, bool IsCoroutine, bool Ready>
+static void bench_increment(benchmark::State& benchState) {
+	onMainThread([&benchState]() { return benchIncrement<Size, IsCoroutine, Ready>(&benchState); }).blockUntilReady();
+}
+
+template <size_t Size>
+static void bench_actor_ready(benchmark::State& benchState) {
+	bench_increment<Size, false, true>(benchState);
+}
+template <size_t Size>
+static void bench_coroutine_ready(benchmark::State& benchState) {
+	bench_increment<Size, true, true>(benchState);
+}
+template <size_t Size>
+static void bench_actor_resume(benchmark::State& benchState) {
+	bench_increment<Size, false, false>(benchState);
+}
+template <size_t Size>
+static void bench_coroutine_resume(benchmark::State& benchState) {
+	bench_increment<Size, true, false>(benchState);
+}
+
+BENCHMARK_TEMPLATE(bench_actor_ready, 32)->Range(1, 1 << 8)->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_coroutine_ready, 32)->Range(1, 1 << 8)->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_actor_ready, 1024)->Range(1, 1 << 8)->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_coroutine_ready, 1024)->Range(1, 1 << 8)->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_actor_resume, 32)->Range(1, 1 << 8)->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_coroutine_resume, 32)->Range(1, 1 << 8)->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_actor_resume, 1024)->Range(1, 1 << 8)->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_coroutine_resume, 1024)->Range(1, 1 << 8)->ReportAggregatesOnly(true);
@@ -0,0 +1,76 @@
+/*
+ * BenchDeque.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include <deque>
+
+#include "flow/flow.h"
+
+// Uses a deque as a queue holding about Arg0 items, as flow uses Deque for the queues of network and disk requests
+template <class DequeType>
+static void bench_deque_queue(benchmark::State& state) {
+	const int size = state.range(0);
+	DequeType queue;
+	for (int i = 0; i < size; ++i) {
+		queue.push_back(i);
+	}
+	int64_t next = size;
+	for (auto _ : state) {
+		queue.push_back(next++);
+		benchmark::DoNotOptimize(queue.front());
+		queue.pop_front();
+	}
+	state.SetItemsProcessed(static_cast<long>(state.iterations()));
+}
+
+// Fills an empty deque with Arg0 items and empties it again, which reallocates it as it grows
+template <class DequeType>
+static void bench_deque_fill(benchmark::State& state) {
+	const int size = state.range(0);
+	for (auto _ : state) {
+		DequeType queue;
+		for (int i = 0; i < size; ++i) {
+			queue.push_back(i);
+		}
+		while (!queue.empty()) {
+			benchmark::DoNotOptimize(queue.front());
+			queue.pop_front();
+		}
+	}
+	state.SetItemsProcessed(size * static_cast<long>(state.iterations()));
+}
+
+BENCHMARK_TEMPLATE(bench_deque_queue, Deque<int64_t>)
+    ->ArgNames({ "size" })
+    ->Range(1, 1 << 16)
+    ->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_deque_queue, std::deque<int64_t>)
+    ->ArgNames({ "size" })
+    ->Range(1, 1 << 16)
+    ->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_deque_fill, Deque<int64_t>)
+    ->ArgNames({ "size" })
+    ->Range(16, 1 << 16)
+    ->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_deque_fill, std::deque<int64_t>)
+    ->ArgNames({ "size" })
+    ->Range(16, 1 << 16)
+    ->ReportAggregatesOnly(true);
@@ -235,3 +235,54 @@ static void blob_chipher_args(benchmark::internal::Benchmark* b) {
 
 BENCHMARK(blob_chipher_encrypt)->Apply(blob_chipher_args);
 BENCHMARK(blob_chipher_decrypt)->Apply(blob_chipher_args);
+
+// Encrypts and decrypts payloads of the sizes of mutations and of storage engine pages, with a new encryptor and
+// decryptor for each operation and the auth token mode and algorithm of each argument
+static void blob_cipher_encrypt_decrypt(benchmark::State& state) {
+	const EncryptCipherDomainId minDomainId = 1;
+	const int payloadLen = state.range(0);
+	const EncryptAuthTokenMode mode = (EncryptAuthTokenMode)state.range(1);
+	const EncryptAuthTokenAlgo algo = (EncryptAuthTokenAlgo)state.range(2);
+
+	SetupEncryptCipher();
+
+	Reference<BlobCipherKeyCache> cipherKeyCache = BlobCipherKeyCache::getInstance();
+	Reference<BlobCipherKey> cipherKey = cipherKeyCache->getLatestCipherKey(minDomainId);
+	Reference<BlobCipherKey> headerCipherKey = cipherKeyCache->getLatestCipherKey(ENCRYPT_HEADER_DOMAIN_ID);
+	uint8_t iv[AES_256_IV_LENGTH];
+	deterministicRandom()->randomBytes(&iv[0], AES_256_IV_LENGTH);
+	uint8_t orgData[payloadLen];
+	deterministicRandom()->randomBytes(&orgData[0], payloadLen);
+
+	for (auto _ : state) {
+		Arena arena;
+		EncryptBlobCipherAes265Ctr encryptor(
+		    cipherKey, headerCipherKey, iv, AES_256_IV_LENGTH, mode, algo, BlobCipherMetrics::TEST);
+		BlobCipherEncryptHeaderRef headerRef;
+		StringRef ciphertext = encryptor.encrypt(&orgData[0], payloadLen, &headerRef, arena);
+
+		DecryptBlobCipherAes256Ctr decryptor(cipherKey, headerCipherKey, headerRef.getIV(), BlobCipherMetrics::TEST);
+		benchmark::DoNotOptimize(decryptor.decrypt(ciphertext.begin(), payloadLen, headerRef, arena));
+	}
+	state.SetBytesProcessed(payloadLen * static_cast<long>(state.iterations()));
+}
+
+static void blob_cipher_encrypt_decrypt_args(benchmark::internal::Benchmark* b) {
+	const std::vector<std::pair<EncryptAuthTokenMode, EncryptAuthTokenAlgo>> authTokens = {
+		{ EncryptAuthTokenMode::ENCRYPT_HEADER_AUTH_TOKEN_MODE_NONE,
+		  EncryptAuthTokenAlgo::ENCRYPT_HEADER_AUTH_TOKEN_ALGO_NONE },
+		{ EncryptAuthTokenMode::ENCRYPT_HEADER_AUTH_TOKEN_MODE_SINGLE,
+		  EncryptAuthTokenAlgo::ENCRYPT_HEADER_AUTH_TOKEN_ALGO_HMAC_SHA },
+		{ EncryptAuthTokenMode::ENCRYPT_HEADER_AUTH_TOKEN_MODE_SINGLE,
+		  EncryptAuthTokenAlgo::ENCRYPT_HEADER_AUTH_TOKEN_ALGO_AES_CMAC },
+	};
+	// Mutations, then pages
+	for (int payloadLen : { 64, 256, 1024, 4096, 8192, 16384 }) {
+		for (const auto& [mode, algo] : authTokens) {
+			b->Args({ payloadLen, (int)mode, (int)algo });
+		}
+	}
+	b->ArgNames({ "payloadLen", "authTokenMode", "authTokenAlgo" });
+}
+
+BENCHMARK(blob_cipher_encrypt_decrypt)->Apply(blob_cipher_encrypt_decrypt_args);
@@ -0,0 +1,77 @@
+/*
+ * BenchIndexedSet.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include "flow/IndexedSet.h"
+#include "flow/IRandom.h"
+#include "flowbench/GlobalData.h"
+
+// An IndexedSet of Arg0 random keys, each with a metric, as the storage server's byte sample keeps sampled keys
+// weighted by their size
+static int64_t randomKey() {
+	return deterministicRandom()->randomInt64(0, std::numeric_limits<int64_t>::max());
+}
+
+static void fill(IndexedSet<int64_t, int64_t>& set, int size) {
+	for (int i = 0; i < size; ++i) {
+		set.insert(randomKey(), deterministicRandom()->randomInt64(1, 1000));
+	}
+}
+
+static void bench_indexed_set_insert_erase(benchmark::State& state) {
+	const int size = state.range(0);
+	IndexedSet<int64_t, int64_t> set;
+	fill(set, size);
+	InputGenerator<int64_t> keys(1 << 16, randomKey);
+	for (auto _ : state) {
+		int64_t key = keys.next();
+		set.insert(key, int64_t(100));
+		set.erase(key);
+	}
+	state.SetItemsProcessed(2 * static_cast<long>(state.iterations()));
+}
+
+static void bench_indexed_set_lower_bound(benchmark::State& state) {
+	const int size = state.range(0);
+	IndexedSet<int64_t, int64_t> set;
+	fill(set, size);
+	InputGenerator<int64_t> keys(1 << 16, randomKey);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(set.lower_bound(keys.next()));
+	}
+	state.SetItemsProcessed(static_cast<long>(state.iterations()));
+}
+
+// The sum of the metrics before a key, as the byte sample estimates the bytes of a range
+static void bench_indexed_set_sum_to(benchmark::State& state) {
+	const int size = state.range(0);
+	IndexedSet<int64_t, int64_t> set;
+	fill(set, size);
+	InputGenerator<int64_t> keys(1 << 16, randomKey);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(set.sumTo(set.lower_bound(keys.next())));
+	}
+	state.SetItemsProcessed(static_cast<long>(state.iterations()));
+}
+
+BENCHMARK(bench_indexed_set_insert_erase)->ArgNames({ "size" })->Range(1 << 10, 1 << 20)->ReportAggregatesOnly(true);
+BENCHMARK(bench_indexed_set_lower_bound)->ArgNames({ "size" })->Range(1 << 10, 1 << 20)->ReportAggregatesOnly(true);
+BENCHMARK(bench_indexed_set_sum_to)->ArgNames({ "size" })->Range(1 << 10, 1 << 20)->ReportAggregatesOnly(true);
@@ -0,0 +1,79 @@
+/*
+ * BenchKeyRangeMap.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+#include "fdbclient/FlatKeyRangeMap.h"
+#include "fdbclient/KeyRangeMap.h"
+#include "flow/IRandom.h"
+#include "flowbench/GlobalData.h"
+
+// Shard boundaries of a tenant keyspace, which share a prefix longer than eight bytes, and a range of system keys
+static void fillShards(KeyRangeMap<int>& map, int shards) {
+	for (int i = 0; i < shards; ++i) {
+		map.insert(KeyRangeRef(Key(format("\x02tenant/%012d", i * 10)), Key(format("\x02tenant/%012d", i * 10 + 10))),
+		           i);
+	}
+	map.insert(KeyRangeRef("\xff"_sr, "\xff\xff"_sr), shards);
+}
+
+static Key randomShardKey(int shards) {
+	return Key(format("\x02tenant/%012d", deterministicRandom()->randomInt(0, shards * 10)));
+}
+
+static void bench_keyrangemap_lookup(benchmark::State& state) {
+	const int shards = state.range(0);
+	KeyRangeMap<int> map;
+	fillShards(map, shards);
+	InputGenerator<Key> keys(1e5, [shards]() { return randomShardKey(shards); });
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(map.rangeContaining(keys.next()).value());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void bench_flat_keyrangemap_lookup(benchmark::State& state) {
+	const int shards = state.range(0);
+	KeyRangeMap<int> map;
+	fillShards(map, shards);
+	FlatKeyRangeMap<int> flat(map);
+	InputGenerator<Key> keys(1e5, [shards]() { return randomShardKey(shards); });
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(flat.rangeContaining(keys.next()).value());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void bench_flat_keyrangemap_build(benchmark::State& state) {
+	const int shards = state.range(0);
+	KeyRangeMap<int> map;
+	fillShards(map, shards);
+
+	for (auto _ : state) {
+		FlatKeyRangeMap<int> flat(map);
+		benchmark::DoNotOptimize(flat.size());
+	}
+	state.SetItemsProcessed(shards * static_cast<long>(state.iterations()));
+}
+
+BENCHMARK(bench_keyrangemap_lookup)->Range(1 << 10, 1 << 20)->ReportAggregatesOnly(true);
+BENCHMARK(bench_flat_keyrangemap_lookup)->Range(1 << 10, 1 << 20)->ReportAggregatesOnly(true);
+BENCHMARK(bench_flat_keyrangemap_build)->Range(1 << 10, 1 << 20)->ReportAggregatesOnly(true);
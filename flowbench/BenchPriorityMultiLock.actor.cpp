@@ -27,9 +27,10 @@
 #include "flow/actorcompiler.h" // This must be the last #include.
 #include "fmt/printf.h"
 
-ACTOR static Future<Void> benchPriorityMultiLock(benchmark::State* benchState) {
+ACTOR static Future<Void> benchPriorityMultiLock(benchmark::State* benchState, int slots) {
 	// Arg1 is the number of active priorities to use
 	// Arg2 is the number of inactive priorities to use
+	// Each lock holds slots slots
 	state int active = benchState->range(0);
 	state int inactive = benchState->range(1);
 
@@ -42,10 +43,10 @@ ACTOR static Future<Void> benchPriorityMultiLock(benchmark::State* benchState) {
 	state int concurrency = priorities.size() * 10;
 	state Reference<PriorityMultiLock> pml = makeReference<PriorityMultiLock>(concurrency, priorities);
 
-	// Clog the lock buy taking n=concurrency locks
+	// Clog the lock buy taking n=concurrency/slots locks
 	state std::deque<Future<PriorityMultiLock::Lock>> lockFutures;
-	for (int j = 0; j < concurrency; ++j) {
-		lockFutures.push_back(pml->lock(j % active));
+	for (int j = 0; j < concurrency / slots; ++j) {
+		lockFutures.push_back(pml->lock(j % active, slots));
 	}
 	// Wait for all of the initial locks to be taken
 	// This will work regardless of their priorities as there are only n = concurrency of them
@@ -61,7 +62,7 @@ ACTOR static Future<Void> benchPriorityMultiLock(benchmark::State* benchState) {
 	while (benchState->KeepRunning()) {
 		// Get and replace the i'th lock future with a new lock waiter
 		Future<PriorityMultiLock::Lock> f = lockFutures[i];
-		lockFutures[i] = pml->lock(p);
+		lockFutures[i] = pml->lock(p, slots);
 
 		PriorityMultiLock::Lock lock = wait(f);
 
@@ -76,13 +77,24 @@ ACTOR static Future<Void> benchPriorityMultiLock(benchmark::State* benchState) {
 		}
 	}
 
-	benchState->SetItemsProcessed(static_cast<long>(benchState->iterations()));
+	benchState->SetItemsProcessed(slots * static_cast<long>(benchState->iterations()));
 
 	return Void();
 }
 
 static void bench_priorityMultiLock(benchmark::State& benchState) {
-	onMainThread([&benchState]() { return benchPriorityMultiLock(&benchState); }).blockUntilReady();
+	onMainThread([&benchState]() { return benchPriorityMultiLock(&benchState, 1); }).blockUntilReady();
+}
+
+// Takes the same slots as bench_priorityMultiLock in locks of Arg3 slots each
+static void bench_priorityMultiLockSlots(benchmark::State& benchState) {
+	onMainThread([&benchState]() { return benchPriorityMultiLock(&benchState, benchState.range(2)); })
+	    .blockUntilReady();
 }
 
 BENCHMARK(bench_priorityMultiLock)->Args({ 5, 0 })->Ranges({ { 1, 64 }, { 0, 128 } })->ReportAggregatesOnly(true);
+BENCHMARK(bench_priorityMultiLockSlots)
+    ->Args({ 5, 0, 1 })
+    ->Args({ 5, 0, 4 })
+    ->Args({ 5, 0, 16 })
+    ->ReportAggregatesOnly(true);
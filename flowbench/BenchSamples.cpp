@@ -22,7 +22,7 @@
 #include "flow/IRandom.h"
 #include "flowbench/GlobalData.h"
 #include "fdbrpc/Stats.h"
-#include "fdbrpc/DDSketch.h"
+#include "flow/DDSketch.h"
 #include "fdbrpc/ContinuousSample.h"
 #include "flow/Histogram.h"
 
@@ -78,6 +78,38 @@ static void bench_ddsketchLatency(benchmark::State& state) {
 // Try with 10%, 5% and 1% error margins
 BENCHMARK(bench_ddsketchLatency)->Arg(10)->Arg(5)->Arg(1)->ReportAggregatesOnly(true);
 
+static void bench_ddsketchLatencyBulk(benchmark::State& state) {
+	DDSketch<double> dds((double)state.range(0) / 100);
+	InputGenerator<double> data(1e6, []() { return deterministicRandom()->random01() * 2.0; });
+	std::vector<double> samples(state.range(1));
+
+	for (auto _ : state) {
+		for (auto& sample : samples) {
+			sample = data.next();
+		}
+		dds.addSamples(samples);
+	}
+
+	state.SetItemsProcessed(state.iterations() * samples.size());
+}
+// The same as bench_ddsketchLatency, adding the samples 64 or 1024 at a time
+BENCHMARK(bench_ddsketchLatencyBulk)->ArgsProduct({ { 10, 5, 1 }, { 64, 1024 } })->ReportAggregatesOnly(true);
+
+static void bench_ddsketchMerge(benchmark::State& state) {
+	DDSketch<double> dds((double)state.range(0) / 100), other((double)state.range(0) / 100);
+	for (int i = 0; i < 1000; i++) {
+		other.addSample(deterministicRandom()->random01() * 2.0);
+	}
+
+	for (auto _ : state) {
+		dds.mergeWith(other);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(state.iterations() * other.getBucketSize() * sizeof(uint32_t));
+}
+BENCHMARK(bench_ddsketchMerge)->Arg(10)->Arg(5)->Arg(1)->ReportAggregatesOnly(true);
+
 static void bench_continuousSampleInt(benchmark::State& state) {
 	ContinuousSample<int64_t> cs(state.range(0));
 	InputGenerator<int64_t> data(1e6, []() { return deterministicRandom()->randomInt64(0, 1e9); });
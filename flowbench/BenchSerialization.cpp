@@ -0,0 +1,109 @@
+/*
+ * BenchSerialization.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include "fdbclient/CommitProxyInterface.h"
+#include "fdbclient/StorageServerInterface.h"
+#include "fdbserver/TLogInterface.h"
+#include "flow/ObjectSerializer.h"
+#include "flow/ThreadHelper.actor.h"
+#include "flowbench/GlobalData.h"
+
+// Builds a message of type T, where size scales the parts of the message that vary in size in practice
+template <class T>
+T makeMessage(int size);
+
+template <>
+GetValueRequest makeMessage<GetValueRequest>(int size) {
+	GetValueRequest request;
+	request.key = getKey(size);
+	request.version = 100000;
+	return request;
+}
+
+template <>
+GetReadVersionReply makeMessage<GetReadVersionReply>(int size) {
+	GetReadVersionReply reply;
+	reply.version = 100000;
+	reply.locked = false;
+	reply.metadataVersion = Value(getKey(size));
+	reply.midShardSize = 100 << 20;
+	return reply;
+}
+
+template <>
+CommitTransactionRequest makeMessage<CommitTransactionRequest>(int size) {
+	CommitTransactionRequest request;
+	for (int i = 0; i < size; ++i) {
+		KeyValueRef kv = getKV(16, 100);
+		request.transaction.mutations.push_back_deep(request.arena, MutationRef(MutationRef::SetValue, kv.key, kv.value));
+		request.transaction.write_conflict_ranges.push_back_deep(request.arena, singleKeyRange(kv.key));
+	}
+	request.transaction.read_snapshot = 100000;
+	return request;
+}
+
+template <>
+TLogCommitRequest makeMessage<TLogCommitRequest>(int size) {
+	Arena arena;
+	StringRef messages = StringRef(arena, getKey(size));
+	return TLogCommitRequest(SpanContext(), arena, 99999, 100000, 99000, 98000, messages, 3, Optional<UID>());
+}
+
+// The messages are built, serialized and destroyed on the network thread, because request messages register and
+// unregister the endpoint of their ReplyPromise with FlowTransport.
+template <class T>
+static void bench_serialize(benchmark::State& state) {
+	onMainThread([&state]() {
+		T message = makeMessage<T>(state.range(0));
+		size_t size = 0;
+		for (auto _ : state) {
+			Standalone<StringRef> serialized =
+			    ObjectWriter::toValue(message, AssumeVersion(g_network->protocolVersion()));
+			size = serialized.size();
+			benchmark::DoNotOptimize(serialized);
+		}
+		state.SetItemsProcessed(static_cast<long>(state.iterations()));
+		state.SetBytesProcessed(static_cast<long>(state.iterations() * size));
+		return Future<Void>(Void());
+	}).blockUntilReady();
+}
+
+// Only replies are deserialized, since deserializing a request starts an actor for its ReplyPromise
+template <class T>
+static void bench_deserialize(benchmark::State& state) {
+	Standalone<StringRef> serialized =
+	    ObjectWriter::toValue(makeMessage<T>(state.range(0)), AssumeVersion(g_network->protocolVersion()));
+	for (auto _ : state) {
+		ArenaObjectReader reader(serialized.arena(), serialized, AssumeVersion(g_network->protocolVersion()));
+		T message;
+		reader.deserialize(message);
+		benchmark::DoNotOptimize(message);
+	}
+	state.SetItemsProcessed(static_cast<long>(state.iterations()));
+	state.SetBytesProcessed(static_cast<long>(state.iterations() * serialized.size()));
+}
+
+BENCHMARK_TEMPLATE(bench_serialize, GetValueRequest)->Arg(16)->Arg(256)->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_serialize, GetReadVersionReply)->Arg(8)->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_deserialize, GetReadVersionReply)->Arg(8)->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_serialize, CommitTransactionRequest)->Arg(1)->Arg(10)->Arg(100)->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_serialize, TLogCommitRequest)->Arg(1 << 10)->Arg(1 << 16)->ReportAggregatesOnly(true);
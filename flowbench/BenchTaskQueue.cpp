@@ -0,0 +1,87 @@
+/*
+ * BenchTaskQueue.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include "flow/DeterministicRandom.h"
+#include "flow/TaskQueue.h"
+
+#include <queue>
+#include <vector>
+
+// Each benchmark keeps Arg0 timers pending, with delays of up to 10 seconds, and advances time by about a millisecond
+// per iteration. The timers that become ready are replaced so the number pending stays the same.
+static constexpr double maxDelay = 10;
+
+static void bench_task_queue_timers(benchmark::State& state) {
+	const int timerCount = state.range(0);
+	DeterministicRandom rand(1);
+	TaskQueue<int> queue;
+	int task = 0;
+	double now = 1e6;
+	for (int i = 0; i < timerCount; ++i) {
+		queue.addTimer(now + rand.random01() * maxDelay, TaskPriority::DefaultDelay, &task);
+	}
+
+	int64_t timers = 0;
+	for (auto _ : state) {
+		now += rand.random01() * 2e-3;
+		queue.processReadyTimers(now);
+		while (queue.hasReadyTask()) {
+			queue.popReadyTask();
+			queue.addTimer(now + rand.random01() * maxDelay, TaskPriority::DefaultDelay, &task);
+			++timers;
+		}
+	}
+	state.SetItemsProcessed(timers);
+}
+
+// Timers in a binary heap, as TaskQueue used to keep them, for comparison. Unlike bench_task_queue_timers this doesn't
+// pay for moving timers to a ready queue.
+static void bench_timer_heap(benchmark::State& state) {
+	struct Timer {
+		double at;
+		int* task;
+		bool operator<(Timer const& rhs) const { return at > rhs.at; }
+	};
+	const int timerCount = state.range(0);
+	DeterministicRandom rand(1);
+	std::priority_queue<Timer, std::vector<Timer>> timers;
+	int task = 0;
+	double now = 1e6;
+	for (int i = 0; i < timerCount; ++i) {
+		timers.push(Timer{ now + rand.random01() * maxDelay, &task });
+	}
+
+	int64_t processed = 0;
+	for (auto _ : state) {
+		now += rand.random01() * 2e-3;
+		while (timers.top().at <= now) {
+			benchmark::DoNotOptimize(timers.top().task);
+			timers.pop();
+			timers.push(Timer{ now + rand.random01() * maxDelay, &task });
+			++processed;
+		}
+	}
+	state.SetItemsProcessed(processed);
+}
+
+BENCHMARK(bench_task_queue_timers)->RangeMultiplier(8)->Range(1 << 10, 1 << 19)->ReportAggregatesOnly(true);
+BENCHMARK(bench_timer_heap)->RangeMultiplier(8)->Range(1 << 10, 1 << 19)->ReportAggregatesOnly(true);
@@ -0,0 +1,83 @@
+/*
+ * BenchTuple.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include "fdbclient/Tuple.h"
+#include "flow/DeterministicRandom.h"
+
+// Tuples of Arg0 strings of Arg1 bytes and as many integers, like the keys layers build. Arg2 is the percentage of
+// string bytes that are nulls and have to be escaped.
+static Tuple makeTuple(benchmark::State& state,
+                       Arena& arena,
+                       std::vector<StringRef>& strings,
+                       std::vector<int64_t>& ints) {
+	DeterministicRandom rand(1);
+	Tuple t;
+	for (int i = 0; i < state.range(0); ++i) {
+		StringRef s = makeString(state.range(1), arena);
+		for (int j = 0; j < s.size(); ++j) {
+			mutateString(s)[j] = rand.randomInt(0, 100) < state.range(2) ? 0 : rand.randomInt(1, 256);
+		}
+		strings.push_back(s);
+		ints.push_back(rand.randomInt64(0, std::numeric_limits<int64_t>::max()));
+		t.append(s).append(ints.back());
+	}
+	return t;
+}
+
+static void bench_tuple_pack(benchmark::State& state) {
+	Arena arena;
+	std::vector<StringRef> strings;
+	std::vector<int64_t> ints;
+	Tuple tuple = makeTuple(state, arena, strings, ints);
+	for (auto _ : state) {
+		Tuple t;
+		for (int i = 0; i < strings.size(); ++i) {
+			t.append(strings[i]).append(ints[i]);
+		}
+		benchmark::DoNotOptimize(t.pack());
+	}
+	state.SetBytesProcessed(static_cast<long>(state.iterations() * tuple.pack().size()));
+}
+
+template <bool View>
+static void bench_tuple_unpack(benchmark::State& state) {
+	Arena arena;
+	std::vector<StringRef> strings;
+	std::vector<int64_t> ints;
+	Standalone<StringRef> packed = makeTuple(state, arena, strings, ints).pack();
+	for (auto _ : state) {
+		Tuple t = View ? Tuple::unpackView(packed) : Tuple::unpack(packed);
+		for (int i = 0; i < t.size(); i += 2) {
+			benchmark::DoNotOptimize(t.getString(i));
+			benchmark::DoNotOptimize(t.getInt(i + 1));
+		}
+	}
+	state.SetBytesProcessed(static_cast<long>(state.iterations() * packed.size()));
+}
+
+BENCHMARK(bench_tuple_pack)->ArgsProduct({ { 1, 8 }, { 16, 256 }, { 0, 5 } })->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_tuple_unpack, false)
+    ->ArgsProduct({ { 1, 8 }, { 16, 256 }, { 0, 5 } })
+    ->ReportAggregatesOnly(true);
+BENCHMARK_TEMPLATE(bench_tuple_unpack, true)
+    ->ArgsProduct({ { 1, 8 }, { 16, 256 }, { 0, 5 } })
+    ->ReportAggregatesOnly(true);
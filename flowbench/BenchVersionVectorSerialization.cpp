@@ -84,5 +84,5 @@ static void bench_dynamic_size_traits_version(benchmark::State& state) {
 	state.counters.insert({ { "Tags", tagCount }, { "Size", size } });
 }
 
-BENCHMARK(bench_serializable_traits_version)->Ranges({ { 1 << 4, 1 << 10 } })->ReportAggregatesOnly(true);
-BENCHMARK(bench_dynamic_size_traits_version)->Ranges({ { 1 << 4, 1 << 10 } })->ReportAggregatesOnly(true);
+BENCHMARK(bench_serializable_traits_version)->Ranges({ { 1 << 4, 1 << 12 } })->ReportAggregatesOnly(true);
+BENCHMARK(bench_dynamic_size_traits_version)->Ranges({ { 1 << 4, 1 << 12 } })->ReportAggregatesOnly(true);
@@ -0,0 +1,97 @@
+/*
+ * BenchVersionedMap.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2024 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include "fdbclient/VersionedMap.h"
+#include "flow/IRandom.h"
+
+// The storage server keeps its window of MVCC versions in a VersionedMap. These benchmarks use a map with Arg0 keys to
+// which each version adds Arg1 random keys, forgetting versions more than kVersionWindow old as the storage server
+// forgets versions once they are durable.
+static constexpr int kVersionWindow = 100;
+
+static Standalone<VectorRef<KeyRef>> makeKeys(int count) {
+	Standalone<VectorRef<KeyRef>> keys;
+	for (int i = 0; i < count; ++i) {
+		keys.push_back_deep(keys.arena(), KeyRef(format("key/%016llx", deterministicRandom()->randomUInt64())));
+	}
+	return keys;
+}
+
+static void populate(VersionedMap<KeyRef, int64_t>& map, Standalone<VectorRef<KeyRef>> const& keys, Version& version) {
+	map.createNewVersion(++version);
+	for (int i = 0; i < keys.size(); ++i) {
+		map.insert(keys[i], i);
+	}
+}
+
+static void bench_versioned_map_insert(benchmark::State& state) {
+	const int size = state.range(0);
+	const int perVersion = state.range(1);
+	Standalone<VectorRef<KeyRef>> keys = makeKeys(size);
+	Standalone<VectorRef<KeyRef>> newKeys = makeKeys(1 << 16);
+	VersionedMap<KeyRef, int64_t> map;
+	Version version = 0;
+	populate(map, keys, version);
+	int next = 0;
+	for (auto _ : state) {
+		map.createNewVersion(++version);
+		for (int i = 0; i < perVersion; ++i) {
+			map.insert(newKeys[next], version);
+			next = (next + 1) % newKeys.size();
+		}
+		if (version > kVersionWindow) {
+			map.forgetVersionsBefore(version - kVersionWindow);
+		}
+	}
+	state.SetItemsProcessed(perVersion * static_cast<long>(state.iterations()));
+}
+
+// Point reads at a random version of the window, as storage server reads look up the value at their read version
+static void bench_versioned_map_read(benchmark::State& state) {
+	const int size = state.range(0);
+	const int perVersion = state.range(1);
+	Standalone<VectorRef<KeyRef>> keys = makeKeys(size);
+	VersionedMap<KeyRef, int64_t> map;
+	Version version = 0;
+	populate(map, keys, version);
+	for (int v = 0; v < kVersionWindow; ++v) {
+		map.createNewVersion(++version);
+		for (int i = 0; i < perVersion; ++i) {
+			map.insert(keys[deterministicRandom()->randomInt(0, size)], version);
+		}
+	}
+	for (auto _ : state) {
+		Version at = version - deterministicRandom()->randomInt(0, kVersionWindow);
+		auto i = map.at(at).lastLessOrEqual(keys[deterministicRandom()->randomInt(0, size)]);
+		benchmark::DoNotOptimize(i);
+	}
+	state.SetItemsProcessed(static_cast<long>(state.iterations()));
+}
+
+BENCHMARK(bench_versioned_map_insert)
+    ->ArgNames({ "size", "perVersion" })
+    ->ArgsProduct({ { 1 << 10, 1 << 17 }, { 1, 100 } })
+    ->ReportAggregatesOnly(true);
+BENCHMARK(bench_versioned_map_read)
+    ->ArgNames({ "size", "perVersion" })
+    ->ArgsProduct({ { 1 << 10, 1 << 17 }, { 1, 100 } })
+    ->ReportAggregatesOnly(true);